@@ -0,0 +1,39 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_ALLOCATION_COUNTER_H
+#define CURAENGINE_BENCHMARK_ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "utils/AllocationStatistics.h"
+
+namespace cura
+{
+
+/*!
+ * \brief How many times memory was allocated with operator new in the benchmarks so far, in all threads.
+ *
+ * The global operator new is replaced in main.cpp to count them, so that benchmarks can report how many allocations the
+ * code they measure makes. In a build with ENABLE_ALLOCATION_STATS, the engine replaces it already.
+ */
+inline std::atomic<size_t> allocation_count{ 0 };
+
+//! How many times memory was allocated so far, in all threads.
+inline size_t getAllocationCount()
+{
+    if constexpr (AllocationStatistics::enabled())
+    {
+        size_t count = 0;
+        for (const AllocationStatistics::Counts& counts : AllocationStatistics::getStageCounts())
+        {
+            count += counts.allocations;
+        }
+        return count;
+    }
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_ALLOCATION_COUNTER_H
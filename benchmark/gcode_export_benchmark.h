@@ -0,0 +1,199 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <streambuf>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Application.h"
+#include "PrintFeature.h"
+#include "Slice.h"
+#include "communication/CommandLine.h"
+#include "gcodeExport.h"
+#include "settings/types/Velocity.h"
+#include "utils/Coord_t.h"
+#include "utils/Point2LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Writes the moves of synthetic layers into GCodeExport, reporting how many lines and bytes of g-code it writes
+ * per second.
+ *
+ * Each layer has the walls of a round part, with the short segments of a curve, and zigzag infill with long lines and
+ * short connections in between. The argument chooses where the g-code goes: 0 throws it away after counting it, so
+ * only the formatting counts, and 1 writes it to a file as well.
+ */
+class GCodeExportBenchmark : public benchmark::Fixture
+{
+public:
+    //! Counts the g-code that passes through it, and passes it on to another buffer, if any.
+    class CountingBuffer : public std::streambuf
+    {
+    public:
+        explicit CountingBuffer(std::streambuf* target)
+            : target_(target)
+        {
+        }
+
+        size_t bytes = 0;
+        size_t lines = 0;
+
+    protected:
+        std::streamsize xsputn(const char* s, std::streamsize count) override
+        {
+            bytes += static_cast<size_t>(count);
+            lines += static_cast<size_t>(std::count(s, s + count, '\n'));
+            return target_ == nullptr ? count : target_->sputn(s, count);
+        }
+
+        int_type overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                return traits_type::not_eof(c);
+            }
+            const char character = traits_type::to_char_type(c);
+            return xsputn(&character, 1) == 1 ? c : traits_type::eof();
+        }
+
+        int sync() override
+        {
+            return target_ == nullptr ? 0 : target_->pubsync();
+        }
+
+    private:
+        std::streambuf* target_;
+    };
+
+    //! A series of moves of one kind.
+    struct SyntheticPath
+    {
+        PrintFeatureType feature;
+        Velocity speed;
+        double mm3_per_mm;
+        std::vector<Point2LL> points;
+    };
+
+    static constexpr size_t LAYER_COUNT = 50;
+    static constexpr coord_t LAYER_THICKNESS = MM2INT(0.2);
+    static constexpr coord_t LINE_WIDTH = MM2INT(0.4);
+
+    std::vector<SyntheticPath> layer_paths; //!< The paths of every layer. Only the height differs between layers.
+    std::filesystem::path gcode_file;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        Application::getInstance().current_slice_ = new Slice(1);
+        Application::getInstance().current_slice_->scene.settings.add("layer_height", "0.2");
+        Application::getInstance().communication_ = new CommandLine({}); // Which doesn't show the moves anywhere.
+        gcode_file = std::filesystem::temp_directory_path() / "gcode_export_benchmark.gcode";
+
+        const Point2LL center(MM2INT(110), MM2INT(110));
+        const coord_t radius = MM2INT(40);
+        const double mm3_per_mm = INT2MM(LINE_WIDTH) * INT2MM(LAYER_THICKNESS);
+        std::mt19937 random(42); // Always the same, so that every run writes the same g-code.
+        std::uniform_real_distribution<double> jitter(-0.02, 0.02); // A little noise, as sliced curves have.
+
+        // The walls, with segments of about half a millimetre.
+        for (const auto& [wall_idx, feature, speed] : { std::tuple{ 0, PrintFeatureType::OuterWall, 30.0 }, std::tuple{ 1, PrintFeatureType::InnerWall, 60.0 } })
+        {
+            const double wall_radius = INT2MM(radius - LINE_WIDTH / 2 - wall_idx * LINE_WIDTH);
+            const size_t segment_count = static_cast<size_t>(2.0 * std::numbers::pi * wall_radius / 0.5);
+            SyntheticPath& wall = layer_paths.emplace_back(SyntheticPath{ .feature = feature, .speed = speed, .mm3_per_mm = mm3_per_mm, .points = {} });
+            for (size_t point_idx = 0; point_idx <= segment_count; point_idx++)
+            {
+                const double angle = 2.0 * std::numbers::pi * static_cast<double>(point_idx % segment_count) / static_cast<double>(segment_count);
+                const double point_radius = wall_radius + jitter(random);
+                wall.points.emplace_back(center.X + MM2INT(point_radius * std::cos(angle)), center.Y + MM2INT(point_radius * std::sin(angle)));
+            }
+        }
+
+        // Zigzag infill inside the walls, 2 mm apart.
+        SyntheticPath& infill = layer_paths.emplace_back(SyntheticPath{ .feature = PrintFeatureType::Infill, .speed = 80.0, .mm3_per_mm = mm3_per_mm, .points = {} });
+        const coord_t infill_radius = radius - 2 * LINE_WIDTH;
+        for (coord_t y = -infill_radius + MM2INT(1); y < infill_radius; y += MM2INT(2))
+        {
+            const auto half_width = static_cast<coord_t>(std::sqrt(static_cast<double>(infill_radius * infill_radius - y * y)));
+            const bool forward = infill.points.size() % 4 == 0;
+            infill.points.emplace_back(center.X + (forward ? -half_width : half_width), center.Y + y);
+            infill.points.emplace_back(center.X + (forward ? half_width : -half_width), center.Y + y);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        layer_paths.clear();
+        delete Application::getInstance().communication_;
+        Application::getInstance().communication_ = nullptr;
+        delete Application::getInstance().current_slice_;
+        Application::getInstance().current_slice_ = nullptr;
+        std::error_code error;
+        std::filesystem::remove(gcode_file, error);
+    }
+
+    //! Write all layers, the way that LayerPlan writes its paths.
+    void writeLayers(GCodeExport& gcode) const
+    {
+        for (size_t layer_nr = 0; layer_nr < LAYER_COUNT; layer_nr++)
+        {
+            const coord_t z = LAYER_THICKNESS * static_cast<coord_t>(layer_nr + 1);
+            gcode.setLayerNr(static_cast<LayerIndex::value_type>(layer_nr));
+            gcode.writeLayerComment(static_cast<LayerIndex::value_type>(layer_nr));
+            gcode.setZ(static_cast<int>(z));
+            gcode.writeTravel(Point3LL(layer_paths.front().points.front().X, layer_paths.front().points.front().Y, z), 150.0);
+            for (const SyntheticPath& path : layer_paths)
+            {
+                gcode.writeTypeComment(path.feature);
+                gcode.writeTravel(path.points.front(), 150.0);
+                for (auto point = path.points.begin() + 1; point != path.points.end(); point++)
+                {
+                    gcode.writeExtrusion(*point, path.speed, path.mm3_per_mm, path.feature);
+                }
+            }
+            gcode.submitOutput();
+        }
+    }
+};
+
+BENCHMARK_DEFINE_F(GCodeExportBenchmark, writeLayers)(benchmark::State& st)
+{
+    std::ofstream file;
+    if (st.range(0) != 0)
+    {
+        file.open(gcode_file);
+    }
+    CountingBuffer counter(st.range(0) != 0 ? file.rdbuf() : nullptr);
+    std::ostream sink(&counter);
+
+    GCodeExport gcode;
+    gcode.setOutputStream(&sink);
+    gcode.setFileHeaderPatchable(false);
+    gcode.setFilamentDiameter(0, MM2INT(1.75));
+    for (auto _ : st)
+    {
+        writeLayers(gcode);
+        gcode.flushOutput(); // Until everything is written.
+    }
+
+    st.SetBytesProcessed(static_cast<int64_t>(counter.bytes));
+    st.counters["lines/s"] = benchmark::Counter(static_cast<double>(counter.lines), benchmark::Counter::kIsRate);
+    st.counters["lines"] = benchmark::Counter(static_cast<double>(counter.lines), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(GCodeExportBenchmark, writeLayers)->ArgName("file")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_GCODE_EXPORT_BENCHMARK_H
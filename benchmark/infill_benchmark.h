@@ -22,6 +22,7 @@ public:
 
 
     Polygons outline_polygons;
+    Polygons large_outline_polygons; // A bed-sized area with many holes in it, for dense infill with many lines to connect.
     EFillMethod pattern{ EFillMethod::LINES };
     bool zig_zagify{ true };
     bool connect_polygons{ true };
@@ -61,6 +62,23 @@ public:
         outline_polygons.add(square_shape);
         outline_polygons.add(ff_holes);
 
+        large_outline_polygons.emplace_back();
+        large_outline_polygons.back().emplace_back(0, 0);
+        large_outline_polygons.back().emplace_back(MM2INT(250), 0);
+        large_outline_polygons.back().emplace_back(MM2INT(250), MM2INT(250));
+        large_outline_polygons.back().emplace_back(0, MM2INT(250));
+        for (coord_t hole_x = MM2INT(20); hole_x < MM2INT(230); hole_x += MM2INT(30))
+        {
+            for (coord_t hole_y = MM2INT(20); hole_y < MM2INT(230); hole_y += MM2INT(30))
+            {
+                large_outline_polygons.emplace_back();
+                large_outline_polygons.back().emplace_back(hole_x, hole_y);
+                large_outline_polygons.back().emplace_back(hole_x, hole_y + MM2INT(10));
+                large_outline_polygons.back().emplace_back(hole_x + MM2INT(10), hole_y + MM2INT(10));
+                large_outline_polygons.back().emplace_back(hole_x + MM2INT(10), hole_y);
+            }
+        }
+
         settings.add("fill_outline_gaps", "false");
         settings.add("meshfix_maximum_deviation", "0.1");
         settings.add("meshfix_maximum_extrusion_area_deviation", "0.01");
@@ -117,5 +135,60 @@ BENCHMARK_DEFINE_F(InfillTest, Infill_generate_connect)(benchmark::State& st)
 }
 
 BENCHMARK_REGISTER_F(InfillTest, Infill_generate_connect)->ArgsProduct({{true, false}, {400, 800, 1200}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(InfillTest, Infill_generate_gyroid)(benchmark::State& st)
+{
+    const bool connect_gyroid = connect_polygons; // For gyroid, zig-zaggifying is what connects the lines.
+    Infill infill(EFillMethod::GYROID,
+                  connect_gyroid,
+                  connect_polygons,
+                  outline_polygons,
+                  INFILL_LINE_WIDTH,
+                  line_distance,
+                  INFILL_OVERLAP,
+                  INFILL_MULTIPLIER,
+                  FILL_ANGLE,
+                  Z,
+                  SHIFT,
+                  MAX_RESOLUTION,
+                  MAX_DEVIATION);
+
+    for (auto _ : st)
+    {
+        std::vector<VariableWidthLines> result_paths;
+        Polygons result_polygons;
+        Polygons result_lines;
+        infill.generate(result_paths, result_polygons, result_lines, settings, 0, SectionType::INFILL, nullptr, nullptr);
+    }
+}
+
+BENCHMARK_REGISTER_F(InfillTest, Infill_generate_gyroid)->ArgsProduct({{true, false}, {400, 800, 1200}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(InfillTest, Infill_generate_connect_dense)(benchmark::State& st)
+{
+    Infill infill(pattern,
+                  zig_zagify,
+                  connect_polygons,
+                  large_outline_polygons,
+                  INFILL_LINE_WIDTH,
+                  line_distance,
+                  INFILL_OVERLAP,
+                  INFILL_MULTIPLIER,
+                  FILL_ANGLE,
+                  Z,
+                  SHIFT,
+                  MAX_RESOLUTION,
+                  MAX_DEVIATION);
+
+    for (auto _ : st)
+    {
+        std::vector<VariableWidthLines> result_paths;
+        Polygons result_polygons;
+        Polygons result_lines;
+        infill.generate(result_paths, result_polygons, result_lines, settings, 0, SectionType::INFILL, nullptr, nullptr);
+    }
+}
+
+BENCHMARK_REGISTER_F(InfillTest, Infill_generate_connect_dense)->ArgsProduct({{true}, {350, 400}})->Unit(benchmark::kMillisecond);
 } // namespace cura
 #endif // CURAENGINE_INFILL_BENCHMARK_H
@@ -1,10 +1,44 @@
 
 // Copyright (c) 2023 UltiMaker
 // CuraEngine is released under the terms of the AGPLv3 or higher
+#include "allocation_counter.h"
+#include "gcode_export_benchmark.h"
 #include "infill_benchmark.h"
+#include "offset_benchmark.h"
 #include "wall_benchmark.h"
+#include "wall_stages_benchmark.h"
 #include "simplify_benchmark.h"
+#include "slicer_benchmark.h"
+#include "sparse_grid_benchmark.h"
+#include "threadpool_benchmark.h"
+#include "tree_support_benchmark.h"
 #include <benchmark/benchmark.h>
 
+#include <cstdlib>
+#include <new>
+
+#ifndef ENABLE_ALLOCATION_STATS // Which replaces these already.
+// Count the allocations, for the benchmarks that report them. The array and nothrow versions go through this one.
+void* operator new(std::size_t size)
+{
+    cura::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
+
 // Run the benchmark
-BENCHMARK_MAIN();
\ No newline at end of file
+BENCHMARK_MAIN();
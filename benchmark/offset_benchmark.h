@@ -0,0 +1,77 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_OFFSET_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_OFFSET_BENCHMARK_H
+
+#include <filesystem>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../tests/ReadTestPolygons.h"
+#include "utils/MultiOffset.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+// The lines of a brim around sliced models: the same outline offset by a growing distance for each line.
+class BrimOffsetFixture : public benchmark::Fixture
+{
+public:
+    const std::vector<std::string> POLYGON_FILENAMES = { std::filesystem::path(__FILE__).parent_path().parent_path().append("tests/resources/slice_polygon_1.txt").string(),
+                                                         std::filesystem::path(__FILE__).parent_path().parent_path().append("tests/resources/slice_polygon_2.txt").string(),
+                                                         std::filesystem::path(__FILE__).parent_path().parent_path().append("tests/resources/slice_polygon_3.txt").string(),
+                                                         std::filesystem::path(__FILE__).parent_path().parent_path().append("tests/resources/slice_polygon_4.txt").string() };
+
+    std::vector<Polygons> shapes;
+    std::vector<coord_t> distances;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        shapes.clear();
+        readTestPolygons(POLYGON_FILENAMES, shapes);
+        constexpr coord_t line_width = MM2INT(0.4);
+        distances.clear();
+        for (int64_t line_idx = 0; line_idx < state.range(0); line_idx++)
+        {
+            distances.push_back(line_width / 2 + line_idx * line_width);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+    }
+};
+
+BENCHMARK_DEFINE_F(BrimOffsetFixture, brim_offset_repeated)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        for (const Polygons& shape : shapes)
+        {
+            for (const coord_t distance : distances)
+            {
+                benchmark::DoNotOptimize(shape.offset(distance, ClipperLib::jtRound));
+            }
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(BrimOffsetFixture, brim_offset_repeated)->Arg(20)->Arg(40);
+
+BENCHMARK_DEFINE_F(BrimOffsetFixture, brim_offset_multi)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        for (const Polygons& shape : shapes)
+        {
+            benchmark::DoNotOptimize(MultiOffset(shape, ClipperLib::jtRound).offset(distances));
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(BrimOffsetFixture, brim_offset_multi)->Arg(20)->Arg(40);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_OFFSET_BENCHMARK_H
@@ -11,7 +11,9 @@
 #include <fmt/format.h>
 
 #include <benchmark/benchmark.h>
+#include <cmath>
 #include <filesystem>
+#include <numbers>
 
 #ifdef ENABLE_PLUGINS
 #include "plugins/slots.h"
@@ -61,6 +63,30 @@ BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_local)(benchmark::State& st)
 
 BENCHMARK_REGISTER_F(SimplifyTestFixture, simplify_local);
 
+/*!
+ * A finely tessellated circle, of which nearly all vertices get removed. That used to take quadratic time, because
+ * finding the neighbours of a vertex scanned past all of the vertices removed next to it.
+ */
+static void simplify_dense_circle(benchmark::State& st)
+{
+    const auto vertex_count = static_cast<size_t>(st.range(0));
+    Polygon circle;
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        const double angle = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(vertex_count);
+        circle.emplace_back(std::llrint(std::cos(angle) * MM2INT(20.0)), std::llrint(std::sin(angle) * MM2INT(20.0)));
+    }
+    const Simplify simplify(MM2INT(0.25), MM2INT(0.025), 50000);
+    Simplify::Scratch scratch;
+    for (auto _ : st)
+    {
+        benchmark::DoNotOptimize(simplify.polygon(circle, scratch));
+    }
+    st.SetComplexityN(st.range(0));
+}
+
+BENCHMARK(simplify_dense_circle)->RangeMultiplier(4)->Range(1 << 10, 1 << 18)->Complexity();
+
 #ifdef ENABLE_PLUGINS
 BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_slot_noplugin)(benchmark::State& st)
 {
@@ -75,6 +101,67 @@ BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_slot_noplugin)(benchmark::State
 }
 
 BENCHMARK_REGISTER_F(SimplifyTestFixture, simplify_slot_noplugin);
+
+BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_slot_noplugin_batched)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        std::vector<Polygons> simplified;
+        benchmark::DoNotOptimize(simplified = slots::instance().modifyBatch<plugins::v0::SlotID::SIMPLIFY_MODIFY>(shapes, MM2INT(0.25), MM2INT(0.025), 50000));
+    }
+}
+
+BENCHMARK_REGISTER_F(SimplifyTestFixture, simplify_slot_noplugin_batched);
+
+/*!
+ * Connect the simplify slot to a plugin listening on localhost:33700, or skip the benchmark if there is none.
+ */
+inline bool connectSimplifyPlugin(benchmark::State& st)
+{
+    try
+    {
+        slots::instance().connect(plugins::v0::SlotID::SIMPLIFY_MODIFY, "CuraEngine_benchmark", "0.1.0-alpha", grpc::CreateChannel("localhost:33700", grpc::InsecureChannelCredentials()));
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        st.SkipWithError(fmt::format("No simplify plugin running at localhost:33700: {}", e.what()).c_str());
+        return false;
+    }
+}
+
+BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_slot_localplugin)(benchmark::State& st)
+{
+    if (! connectSimplifyPlugin(st))
+    {
+        return;
+    }
+    for (auto _ : st)
+    {
+        Polygons simplified;
+        for (const auto& polys : shapes)
+        {
+            benchmark::DoNotOptimize(simplified = slots::instance().modify<plugins::v0::SlotID::SIMPLIFY_MODIFY>(polys, MM2INT(0.25), MM2INT(0.025), 50000));
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(SimplifyTestFixture, simplify_slot_localplugin);
+
+BENCHMARK_DEFINE_F(SimplifyTestFixture, simplify_slot_localplugin_batched)(benchmark::State& st)
+{
+    if (! connectSimplifyPlugin(st))
+    {
+        return;
+    }
+    for (auto _ : st)
+    {
+        std::vector<Polygons> simplified;
+        benchmark::DoNotOptimize(simplified = slots::instance().modifyBatch<plugins::v0::SlotID::SIMPLIFY_MODIFY>(shapes, MM2INT(0.25), MM2INT(0.025), 50000));
+    }
+}
+
+BENCHMARK_REGISTER_F(SimplifyTestFixture, simplify_slot_localplugin_batched);
 #endif
 
 } // namespace cura
@@ -0,0 +1,233 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
+
+#include <cmath>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Application.h"
+#include "mesh.h"
+#include "settings/EnumSettings.h"
+#include "slicer.h"
+#include "utils/Coord_t.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Times the steps of the slicer separately, on spheres with more and more faces.
+ *
+ * The first argument is the number of rings of the sphere, which has twice as many faces around. With the second
+ * argument set, some of the faces are left out, so that the layers have gaps that the stitching has to close.
+ *
+ * Each benchmark starts from what the step before it would leave behind, which is prepared outside of the timing.
+ */
+class SlicerBenchmark : public benchmark::Fixture
+{
+public:
+    static constexpr coord_t RADIUS = MM2INT(25);
+    static constexpr coord_t LAYER_THICKNESS = MM2INT(0.2);
+    static constexpr size_t BROKEN_FACE_INTERVAL = 97; //!< When broken, one in this many faces is left out.
+
+    Mesh mesh;
+    std::vector<std::pair<size_t, size_t>> face_layer_ranges;
+    std::vector<SlicerLayer> empty_layers; //!< Only the heights of the layers.
+    std::vector<SlicerLayer> segmented_layers; //!< After creating the segments.
+    std::vector<SlicerLayer> looped_layers; //!< After connecting the segments into loops.
+    std::vector<Polygons> looped_open_polylines; //!< What couldn't be connected into loops.
+    std::vector<SlicerLayer> stitched_layers; //!< After connecting and stitching the open polylines, up to the extensive stitching.
+    std::vector<Polygons> stitched_open_polylines; //!< What couldn't be stitched into loops.
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        Application::getInstance().startThreadPool(1); // Time the steps themselves, not how well they run in parallel.
+
+        addSphere(static_cast<size_t>(state.range(0)), state.range(1) != 0);
+        mesh.settings_.add("magic_mesh_surface_mode", "normal");
+        mesh.settings_.add("meshfix_extensive_stitching", "true");
+        mesh.settings_.add("meshfix_keep_open_polygons", "false");
+        mesh.settings_.add("minimum_polygon_circumference", "1");
+        mesh.settings_.add("meshfix_maximum_resolution", "0.5");
+        mesh.settings_.add("meshfix_maximum_deviation", "0.025");
+        mesh.settings_.add("meshfix_maximum_extrusion_area_deviation", "50000");
+
+        empty_layers.resize(static_cast<size_t>(2 * RADIUS / LAYER_THICKNESS));
+        for (size_t layer_nr = 0; layer_nr < empty_layers.size(); layer_nr++)
+        {
+            empty_layers[layer_nr].z = static_cast<int>(LAYER_THICKNESS / 2 + static_cast<coord_t>(layer_nr) * LAYER_THICKNESS);
+        }
+        face_layer_ranges = Slicer::buildLayerRangesForFaces(Slicer::buildZHeightsForFaces(mesh), empty_layers);
+
+        segmented_layers = empty_layers;
+        buildSegments(segmented_layers);
+
+        looped_layers = segmented_layers;
+        looped_open_polylines.resize(looped_layers.size());
+        for (size_t layer_nr = 0; layer_nr < looped_layers.size(); layer_nr++)
+        {
+            looped_layers[layer_nr].makeBasicPolygonLoops(looped_open_polylines[layer_nr]);
+        }
+
+        stitched_layers = looped_layers;
+        stitched_open_polylines = looped_open_polylines;
+        for (size_t layer_nr = 0; layer_nr < stitched_layers.size(); layer_nr++)
+        {
+            stitched_layers[layer_nr].connectOpenPolylines(stitched_open_polylines[layer_nr]);
+            stitched_layers[layer_nr].stitch(stitched_open_polylines[layer_nr]);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        mesh.clear();
+        face_layer_ranges.clear();
+        empty_layers.clear();
+        segmented_layers.clear();
+        looped_layers.clear();
+        looped_open_polylines.clear();
+        stitched_layers.clear();
+        stitched_open_polylines.clear();
+    }
+
+    /*!
+     * Add a sphere that stands on the build plate to the mesh, optionally with holes in it.
+     */
+    void addSphere(const size_t rings, const bool broken)
+    {
+        const size_t sectors = rings * 2;
+        const auto vertex = [rings, sectors](const size_t ring, const size_t sector)
+        {
+            const double polar = std::numbers::pi * static_cast<double>(ring) / static_cast<double>(rings);
+            const double azimuth = 2.0 * std::numbers::pi * static_cast<double>(sector % sectors) / static_cast<double>(sectors);
+            const double radius = static_cast<double>(RADIUS);
+            return Point3LL(
+                std::llround(radius * std::sin(polar) * std::cos(azimuth)),
+                std::llround(radius * std::sin(polar) * std::sin(azimuth)),
+                std::llround(radius - radius * std::cos(polar)));
+        };
+
+        std::vector<Point3LL> corners;
+        size_t face_count = 0;
+        const auto add_face = [&](const Point3LL& a, const Point3LL& b, const Point3LL& c)
+        {
+            if (broken && ++face_count % BROKEN_FACE_INTERVAL == 0)
+            {
+                return;
+            }
+            corners.insert(corners.end(), { a, b, c });
+        };
+        for (size_t ring = 0; ring < rings; ring++)
+        {
+            for (size_t sector = 0; sector < sectors; sector++)
+            {
+                // The faces at the poles have two corners in the same place, so adding them skips them.
+                add_face(vertex(ring, sector), vertex(ring + 1, sector + 1), vertex(ring, sector + 1));
+                add_face(vertex(ring, sector), vertex(ring + 1, sector), vertex(ring + 1, sector + 1));
+            }
+        }
+        mesh.addFaces(corners);
+        mesh.finish();
+    }
+
+    void buildSegments(std::vector<SlicerLayer>& layers) const
+    {
+        Slicer::buildSegments(mesh, face_layer_ranges, SlicingTolerance::MIDDLE, layers, 0, layers.size());
+    }
+
+    static void connectOpenPolylines(SlicerLayer& layer, Polygons& open_polylines)
+    {
+        layer.connectOpenPolylines(open_polylines);
+    }
+
+    static void stitchExtensive(SlicerLayer& layer, Polygons& open_polylines)
+    {
+        layer.stitch_extensive(open_polylines);
+    }
+};
+
+BENCHMARK_DEFINE_F(SlicerBenchmark, buildSegments)(benchmark::State& st)
+{
+    std::vector<SlicerLayer> layers;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        layers = empty_layers;
+        st.ResumeTiming();
+        buildSegments(layers);
+        benchmark::DoNotOptimize(layers.data());
+    }
+    st.counters["faces"] = static_cast<double>(mesh.faces_.size());
+}
+
+BENCHMARK_REGISTER_F(SlicerBenchmark, buildSegments)->ArgsProduct({ { 16, 64, 256 }, { false, true } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerBenchmark, makePolygons)(benchmark::State& st)
+{
+    std::vector<SlicerLayer> layers;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        layers = segmented_layers;
+        st.ResumeTiming();
+        for (SlicerLayer& layer : layers)
+        {
+            layer.makePolygons(&mesh);
+        }
+        benchmark::DoNotOptimize(layers.data());
+    }
+    st.counters["faces"] = static_cast<double>(mesh.faces_.size());
+}
+
+BENCHMARK_REGISTER_F(SlicerBenchmark, makePolygons)->ArgsProduct({ { 16, 64, 256 }, { false, true } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerBenchmark, connectOpenPolylines)(benchmark::State& st)
+{
+    std::vector<SlicerLayer> layers;
+    std::vector<Polygons> open_polylines;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        layers = looped_layers;
+        open_polylines = looped_open_polylines;
+        st.ResumeTiming();
+        for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+        {
+            connectOpenPolylines(layers[layer_nr], open_polylines[layer_nr]);
+        }
+        benchmark::DoNotOptimize(layers.data());
+    }
+    st.counters["faces"] = static_cast<double>(mesh.faces_.size());
+}
+
+BENCHMARK_REGISTER_F(SlicerBenchmark, connectOpenPolylines)->ArgsProduct({ { 16, 64, 256 }, { false, true } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SlicerBenchmark, stitchExtensive)(benchmark::State& st)
+{
+    std::vector<SlicerLayer> layers;
+    std::vector<Polygons> open_polylines;
+    for (auto _ : st)
+    {
+        st.PauseTiming();
+        layers = stitched_layers;
+        open_polylines = stitched_open_polylines;
+        st.ResumeTiming();
+        for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+        {
+            stitchExtensive(layers[layer_nr], open_polylines[layer_nr]);
+        }
+        benchmark::DoNotOptimize(layers.data());
+    }
+    st.counters["faces"] = static_cast<double>(mesh.faces_.size());
+}
+
+BENCHMARK_REGISTER_F(SlicerBenchmark, stitchExtensive)->ArgsProduct({ { 16, 64, 256 }, { false, true } })->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_SLICER_BENCHMARK_H
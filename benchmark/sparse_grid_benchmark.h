@@ -0,0 +1,81 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_SPARSE_GRID_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_SPARSE_GRID_BENCHMARK_H
+
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "utils/SparsePointGridInclusive.h"
+
+namespace cura
+{
+// Points spread over a build plate, with about as many points per cell as the grids typically get.
+class SparseGridFixture : public benchmark::Fixture
+{
+public:
+    static constexpr coord_t cell_size = MM2INT(0.5);
+    std::vector<Point2LL> points;
+    std::vector<Point2LL> queries;
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<coord_t> coordinate(0, MM2INT(200));
+        points.clear();
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            points.emplace_back(coordinate(random), coordinate(random));
+        }
+        queries.clear();
+        for (size_t i = 0; i < 10000; i++)
+        {
+            queries.emplace_back(coordinate(random), coordinate(random));
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+    }
+};
+
+BENCHMARK_DEFINE_F(SparseGridFixture, sparse_grid_insert)(benchmark::State& st)
+{
+    for (auto _ : st)
+    {
+        SparsePointGridInclusive<size_t> grid(cell_size);
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            grid.insert(points[i], i);
+        }
+        benchmark::DoNotOptimize(grid);
+    }
+    st.SetItemsProcessed(st.iterations() * static_cast<int64_t>(points.size()));
+}
+
+BENCHMARK_REGISTER_F(SparseGridFixture, sparse_grid_insert)->Arg(10000)->Arg(1000000);
+
+BENCHMARK_DEFINE_F(SparseGridFixture, sparse_grid_get_nearby)(benchmark::State& st)
+{
+    SparsePointGridInclusive<size_t> grid(cell_size);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        grid.insert(points[i], i);
+    }
+    for (auto _ : st)
+    {
+        for (const Point2LL& query : queries)
+        {
+            benchmark::DoNotOptimize(grid.getNearby(query, cell_size));
+        }
+    }
+    st.SetItemsProcessed(st.iterations() * static_cast<int64_t>(queries.size()));
+}
+
+BENCHMARK_REGISTER_F(SparseGridFixture, sparse_grid_get_nearby)->Arg(10000)->Arg(1000000);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_SPARSE_GRID_BENCHMARK_H
@@ -0,0 +1,141 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_THREADPOOL_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_THREADPOOL_BENCHMARK_H
+
+#include <atomic>
+#include <cmath>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Application.h"
+#include "utils/ThreadPool.h"
+
+namespace cura
+{
+
+/*!
+ * Registers the thread counts to measure the scaling at: the powers of two up to the number of cores.
+ */
+inline void threadCounts(benchmark::internal::Benchmark* benchmark)
+{
+    const int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    for (int threads = 1; threads < max_threads; threads *= 2)
+    {
+        benchmark->Arg(threads);
+    }
+    benchmark->Arg(max_threads);
+    benchmark->UseRealTime();
+}
+
+// Many tiny loop bodies, where the scheduling overhead dominates.
+static void parallel_for_fine_grained(benchmark::State& st)
+{
+    Application::getInstance().startThreadPool(static_cast<int>(st.range(0)));
+    std::vector<double> values(1 << 16, 1.0);
+    for (auto _ : st)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            values.size(),
+            [&values](const size_t index)
+            {
+                values[index] = std::sqrt(values[index] + 1.0);
+            });
+        benchmark::DoNotOptimize(values.data());
+    }
+    st.SetItemsProcessed(st.iterations() * values.size());
+}
+
+BENCHMARK(parallel_for_fine_grained)->Apply(threadCounts);
+
+// Loop bodies of very different costs, where the load balancing dominates.
+static void parallel_for_unbalanced(benchmark::State& st)
+{
+    Application::getInstance().startThreadPool(static_cast<int>(st.range(0)));
+    constexpr size_t item_count = 4096;
+    std::vector<double> values(item_count, 1.0);
+    for (auto _ : st)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            item_count,
+            [&values](const size_t index)
+            {
+                const size_t work = index < item_count / 8 ? 2000 : 20; // The first items are a hundred times as expensive.
+                for (size_t i = 0; i < work; i++)
+                {
+                    values[index] = std::sqrt(values[index] + 1.0);
+                }
+            });
+        benchmark::DoNotOptimize(values.data());
+    }
+    st.SetItemsProcessed(st.iterations() * item_count);
+}
+
+BENCHMARK(parallel_for_unbalanced)->Apply(threadCounts);
+
+// Nested loops, like a parallel loop over layers that runs parallel loops over their parts.
+static void parallel_for_nested(benchmark::State& st)
+{
+    Application::getInstance().startThreadPool(static_cast<int>(st.range(0)));
+    std::vector<double> values(256 * 256, 1.0);
+    for (auto _ : st)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            256,
+            [&values](const size_t outer)
+            {
+                cura::parallel_for<size_t>(
+                    0,
+                    256,
+                    [&values, outer](const size_t inner)
+                    {
+                        double& value = values[outer * 256 + inner];
+                        value = std::sqrt(value + 1.0);
+                    });
+            });
+        benchmark::DoNotOptimize(values.data());
+    }
+    st.SetItemsProcessed(st.iterations() * values.size());
+}
+
+BENCHMARK(parallel_for_nested)->Apply(threadCounts);
+
+static void ordered_consumer(benchmark::State& st)
+{
+    Application::getInstance().startThreadPool(static_cast<int>(st.range(0)));
+    constexpr ptrdiff_t item_count = 4096;
+    for (auto _ : st)
+    {
+        double sum = 0.0;
+        run_multiple_producers_ordered_consumer(
+            0,
+            item_count,
+            [](const ptrdiff_t index)
+            {
+                double value = static_cast<double>(index);
+                for (size_t i = 0; i < 200; i++)
+                {
+                    value = std::sqrt(value + 1.0);
+                }
+                return std::optional<double>(value);
+            },
+            [&sum](std::optional<double> value)
+            {
+                sum += *value;
+            });
+        benchmark::DoNotOptimize(sum);
+    }
+    st.SetItemsProcessed(st.iterations() * item_count);
+}
+
+BENCHMARK(ordered_consumer)->Apply(threadCounts);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_THREADPOOL_BENCHMARK_H
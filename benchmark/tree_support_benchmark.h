@@ -0,0 +1,210 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_TREE_SUPPORT_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_TREE_SUPPORT_BENCHMARK_H
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <rapidjson/document.h>
+#include <spdlog/details/os.h>
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "communication/CommandLine.h"
+#include "progress/Progress.h"
+#include "utils/AllocationStatistics.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Slices models with a lot of overhang with tree support, reporting how long the tree support takes.
+ *
+ * The printer definition to slice with is taken from the environment variable CURA_ENGINE_BENCHMARK_DEFINITION, and
+ * its parents are looked up in CURA_ENGINE_SEARCH_PATH, as for CuraEngine itself. Without a definition, the benchmarks
+ * are skipped.
+ *
+ * Every iteration slices the model from start to end, but only the tree support counts towards its time. This is the
+ * precalculation of the volumes followed by the rest of the generation of the support areas, as TreeSupport reports in
+ * the file that CURA_ENGINE_TREE_SUPPORT_STATS names. Each of its stages gets a counter with its time per iteration, in
+ * seconds, and each count of elements is divided by the number of layers. In a build with ENABLE_ALLOCATION_STATS, the
+ * allocations of each stage of the slice are reported as well. The argument is the number of threads.
+ */
+class TreeSupportBenchmark : public benchmark::Fixture
+{
+public:
+    std::string definition;
+    std::filesystem::path statistics_file;
+    std::filesystem::path gcode_file;
+    spdlog::level::level_enum log_level{ spdlog::level::info };
+
+    void SetUp(const ::benchmark::State& state)
+    {
+        definition = spdlog::details::os::getenv("CURA_ENGINE_BENCHMARK_DEFINITION");
+        statistics_file = std::filesystem::temp_directory_path() / "tree_support_benchmark.jsonl";
+        gcode_file = std::filesystem::temp_directory_path() / "tree_support_benchmark.gcode";
+        setEnvironment("CURA_ENGINE_TREE_SUPPORT_STATS", statistics_file.string());
+        Progress::init();
+        log_level = spdlog::get_level();
+        spdlog::set_level(spdlog::level::warn); // Not the log of every slice.
+    }
+
+    void TearDown(const ::benchmark::State& state)
+    {
+        spdlog::set_level(log_level);
+        setEnvironment("CURA_ENGINE_TREE_SUPPORT_STATS", "");
+        std::error_code error;
+        std::filesystem::remove(statistics_file, error);
+        std::filesystem::remove(gcode_file, error);
+    }
+
+    static void setEnvironment(const std::string& name, const std::string& value)
+    {
+#ifdef _WIN32
+        _putenv_s(name.c_str(), value.c_str());
+#else
+        setenv(name.c_str(), value.c_str(), 1);
+#endif
+    }
+
+    /*!
+     * Slice a model with tree support, turned by \p rotation so that it overhangs, timing the tree support.
+     */
+    void sliceWithTreeSupport(benchmark::State& st, const std::filesystem::path& model, const std::string_view rotation)
+    {
+        if (definition.empty())
+        {
+            st.SkipWithError("Set CURA_ENGINE_BENCHMARK_DEFINITION to the printer definition to slice with.");
+            return;
+        }
+
+        std::map<std::string, double> stage_times;
+        std::map<std::string, double> elements_per_layer;
+        double avoidance_bytes = 0.0;
+        double hits = 0.0;
+        double misses = 0.0;
+        std::array<AllocationStatistics::Counts, N_PROGRESS_STAGES> stage_allocations{};
+        for (auto _ : st)
+        {
+            std::error_code error;
+            std::filesystem::remove(statistics_file, error); // Only read the statistics of this slice.
+
+            const std::vector<std::string> arguments{ "CuraEngine",
+                                                      "slice",
+                                                      fmt::format("-m{}", st.range(0)),
+                                                      "-j",
+                                                      definition,
+                                                      "-s",
+                                                      "support_enable=true",
+                                                      "-s",
+                                                      "support_structure=tree",
+                                                      "-s",
+                                                      "support_type=everywhere",
+                                                      "-s",
+                                                      fmt::format("mesh_rotation_matrix={}", rotation),
+                                                      "-o",
+                                                      gcode_file.string(),
+                                                      "-l",
+                                                      model.string(),
+                                                      "-s",
+                                                      "center_object=true" };
+            AllocationStatistics::reset();
+            CommandLine command_line(arguments);
+            Application& application = Application::getInstance();
+            application.communication_ = &command_line;
+            command_line.sliceNext();
+            application.communication_ = nullptr; // The command line only lived during this slice.
+            application.current_slice_ = nullptr; // The slice only lived during sliceNext.
+            const std::array<AllocationStatistics::Counts, N_PROGRESS_STAGES> slice_allocations = AllocationStatistics::getStageCounts();
+            for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+            {
+                stage_allocations[stage].allocations += slice_allocations[stage].allocations;
+                stage_allocations[stage].bytes += slice_allocations[stage].bytes;
+            }
+
+            double tree_support_time = 0.0;
+            std::ifstream file(statistics_file);
+            std::string line;
+            while (std::getline(file, line)) // One line per mesh group.
+            {
+                rapidjson::Document statistics;
+                statistics.Parse(line.c_str());
+                if (statistics.HasParseError() || ! statistics.IsObject())
+                {
+                    continue;
+                }
+                tree_support_time += statistics["total_time"].GetDouble();
+                for (const auto& stage : statistics["stages"].GetObject())
+                {
+                    stage_times[stage.name.GetString()] += stage.value.GetDouble();
+                }
+                const double layer_count = std::max(1.0, statistics["layers"].GetDouble());
+                for (const auto& phase : statistics["elements"].GetObject())
+                {
+                    elements_per_layer[phase.name.GetString()] += phase.value.GetDouble() / layer_count;
+                }
+                const auto& volumes = statistics["volumes"];
+                avoidance_bytes += volumes["avoidance_bytes"].GetDouble();
+                hits += volumes["hits"].GetDouble();
+                misses += volumes["misses"].GetDouble();
+            }
+            st.SetIterationTime(tree_support_time);
+        }
+
+        for (const auto& [stage, duration] : stage_times)
+        {
+            st.counters[stage] = benchmark::Counter(duration, benchmark::Counter::kAvgIterations);
+        }
+        for (const auto& [phase, count] : elements_per_layer)
+        {
+            st.counters[phase + " per layer"] = benchmark::Counter(count, benchmark::Counter::kAvgIterations);
+        }
+        st.counters["avoidance cache kB"] = benchmark::Counter(avoidance_bytes / 1024.0, benchmark::Counter::kAvgIterations);
+        st.counters["volume hits"] = benchmark::Counter(hits, benchmark::Counter::kAvgIterations);
+        st.counters["volume misses"] = benchmark::Counter(misses, benchmark::Counter::kAvgIterations);
+        // Of the whole process, over all slices so far.
+        const size_t peak_support_bytes = Progress::getStageTimes().at(static_cast<size_t>(Progress::Stage::SUPPORT)).peak_resident_bytes;
+        st.counters["peak support memory MB"] = static_cast<double>(peak_support_bytes) / (1024.0 * 1024.0);
+        if constexpr (AllocationStatistics::enabled())
+        {
+            for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+            {
+                const std::string name(Progress::getStageName(static_cast<Progress::Stage>(stage)));
+                st.counters[name + " allocations"] = benchmark::Counter(static_cast<double>(stage_allocations[stage].allocations), benchmark::Counter::kAvgIterations);
+                const double megabytes = static_cast<double>(stage_allocations[stage].bytes) / (1024.0 * 1024.0);
+                st.counters[name + " allocated MB"] = benchmark::Counter(megabytes, benchmark::Counter::kAvgIterations);
+            }
+        }
+    }
+};
+
+BENCHMARK_DEFINE_F(TreeSupportBenchmark, lying_cylinder)(benchmark::State& st)
+{
+    // On its side, so that the whole bottom half overhangs.
+    const auto model = std::filesystem::path(__FILE__).parent_path().parent_path().append("tests").append("integration").append("resources").append("cylinder1000.stl");
+    sliceWithTreeSupport(st, model, "[[1,0,0],[0,0,-1],[0,1,0]]");
+}
+
+BENCHMARK_REGISTER_F(TreeSupportBenchmark, lying_cylinder)->Arg(1)->Arg(4)->Arg(16)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(TreeSupportBenchmark, upside_down_test_model)(benchmark::State& st)
+{
+    const auto model = std::filesystem::path(__FILE__).parent_path().parent_path().append("tests").append("testModel.stl");
+    sliceWithTreeSupport(st, model, "[[1,0,0],[0,-1,0],[0,0,-1]]");
+}
+
+BENCHMARK_REGISTER_F(TreeSupportBenchmark, upside_down_test_model)->Arg(1)->Arg(4)->Arg(16)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_TREE_SUPPORT_BENCHMARK_H
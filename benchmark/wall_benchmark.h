@@ -9,7 +9,9 @@
 #include <benchmark/benchmark.h>
 #include <range/v3/view/join.hpp>
 
+#include "BeadingStrategy/BeadingStrategyFactory.h"
 #include "InsetOrderOptimizer.h"
+#include "SkeletalTrapezoidation.h"
 #include "WallsComputation.h"
 #include "settings/Settings.h"
 #include "sliceDataStorage.h"
@@ -146,7 +148,7 @@ public:
 
         SliceLayerPart& part = layer.parts.back();
         part.outline.add(shape.paths.front());
-        part.print_outline = shape;
+        part.print_outline = CompactPolygons(shape);
     }
 
     void TearDown(const ::benchmark::State& state)
@@ -154,6 +156,20 @@ public:
     }
 };
 
+/*!
+ * The whole holes.wkt shape, with all of its holes, rather than only the outside of it.
+ */
+class ManyHolesWallTestFixture : public HolesWallTestFixture
+{
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        HolesWallTestFixture::SetUp(state);
+        SliceLayerPart& part = layer.parts.back();
+        part.outline = PolygonsPart{ part.print_outline.toPolygons() };
+    }
+};
+
 BENCHMARK_DEFINE_F(WallTestFixture, generateWalls)(benchmark::State& st)
 {
     for (auto _ : st)
@@ -238,5 +254,50 @@ BENCHMARK_DEFINE_F(HolesWallTestFixture, InsetOrderOptimizer_getInsetOrder)(benc
 
 BENCHMARK_REGISTER_F(HolesWallTestFixture, InsetOrderOptimizer_getInsetOrder)->Arg(3)->Arg(15)->Arg(9999)->Unit(benchmark::kMillisecond);
 
+BENCHMARK_DEFINE_F(ManyHolesWallTestFixture, InsetOrderOptimizer_getRegionOrder)(benchmark::State& st)
+{
+    walls_computation.generateWalls(&layer, SectionType::WALL);
+    std::vector<ExtrusionLine> all_paths;
+    for (auto& line : layer.parts.back().wall_toolpaths | ranges::views::join)
+    {
+        all_paths.emplace_back(line);
+    }
+    for (auto _ : st)
+    {
+        auto order = InsetOrderOptimizer::getRegionOrder(all_paths, outer_to_inner);
+    }
+    st.counters["lines"] = static_cast<double>(all_paths.size());
+}
+
+BENCHMARK_REGISTER_F(ManyHolesWallTestFixture, InsetOrderOptimizer_getRegionOrder)->Arg(1)->Arg(3)->Unit(benchmark::kMillisecond);
+
+// The argument is the maximum deviation of the discretized parabolic edges of the skeleton, in microns. The fixture also
+// takes it as the wall count, which this doesn't use.
+BENCHMARK_DEFINE_F(HolesWallTestFixture, SkeletalTrapezoidation_discretize)(benchmark::State& st)
+{
+    const Polygons& outline = layer.parts.back().outline;
+    const auto beading_strategy = BeadingStrategyFactory::makeStrategy(MM2INT(0.4), MM2INT(0.4), MM2INT(1), 10 * std::numbers::pi / 180, false, 0, 0, 0.5_r, 0.5_r, 4);
+    size_t edge_count = 0;
+    for (auto _ : st)
+    {
+        SkeletalTrapezoidation skeleton(
+            outline,
+            *beading_strategy,
+            beading_strategy->getTransitioningAngle(),
+            MM2INT(0.8),
+            st.range(0),
+            MM2INT(1),
+            MM2INT(0.2),
+            MM2INT(1),
+            0,
+            SectionType::WALL);
+        edge_count = skeleton.graph_.edges.size();
+        benchmark::DoNotOptimize(edge_count);
+    }
+    st.counters["edges"] = static_cast<double>(edge_count);
+}
+
+BENCHMARK_REGISTER_F(HolesWallTestFixture, SkeletalTrapezoidation_discretize)->Arg(0)->Arg(25)->Arg(100)->Unit(benchmark::kMillisecond);
+
 } // namespace cura
 #endif // CURAENGINE_WALL_BENCHMARK_H
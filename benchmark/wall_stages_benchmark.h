@@ -0,0 +1,159 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef CURAENGINE_BENCHMARK_WALL_STAGES_BENCHMARK_H
+#define CURAENGINE_BENCHMARK_WALL_STAGES_BENCHMARK_H
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/geometry/geometries/multi_polygon.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+#include <boost/geometry/io/wkt/read.hpp>
+
+#include "WallToolPaths.h"
+#include "allocation_counter.h"
+#include "settings/Settings.h"
+#include "utils/gettime.h"
+#include "utils/polygon.h"
+#include "utils/section_type.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Replays the outlines of real slices through WallToolPaths::generate, reporting how long each stage takes.
+ *
+ * The outlines and their settings are those of the stress benchmark, so that is where to add any slice that Arachne
+ * should be measured on. Each stage of WallToolPaths gets a counter with its time per iteration, in seconds, so a
+ * regression shows in the stage that caused it. The allocations counter is the number of allocations per iteration.
+ */
+namespace wall_stages_benchmark
+{
+
+inline std::vector<Polygons> readParts(const std::filesystem::path& wkt_file)
+{
+    using point_type = boost::geometry::model::d2::point_xy<double>;
+    using polygon_type = boost::geometry::model::polygon<point_type>;
+    using multi_polygon_type = boost::geometry::model::multi_polygon<polygon_type>;
+
+    std::ifstream file{ wkt_file };
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    multi_polygon_type boost_polygons{};
+    boost::geometry::read_wkt(buffer.str(), boost_polygons);
+
+    std::vector<Polygons> parts;
+    for (const auto& boost_polygon : boost_polygons)
+    {
+        Polygons& part = parts.emplace_back();
+        Polygon outer;
+        for (const auto& point : boost_polygon.outer())
+        {
+            outer.add(Point2LL(point.x(), point.y()));
+        }
+        part.add(outer);
+        for (const auto& hole : boost_polygon.inners())
+        {
+            Polygon inner;
+            for (const auto& point : hole)
+            {
+                inner.add(Point2LL(point.x(), point.y()));
+            }
+            part.add(inner);
+        }
+    }
+    return parts;
+}
+
+inline Settings readSettings(const std::filesystem::path& settings_file)
+{
+    Settings settings;
+    std::ifstream file{ settings_file };
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string key;
+        std::string value;
+        if (std::getline(std::getline(iss, key, '='), value))
+        {
+            settings.add(key, value);
+        }
+    }
+    return settings;
+}
+
+inline void generateWalls(benchmark::State& st, const std::filesystem::path& wkt_file)
+{
+    std::filesystem::path settings_file = wkt_file;
+    settings_file.replace_extension(".settings");
+    const std::vector<Polygons> parts = readParts(wkt_file);
+    const Settings settings = readSettings(settings_file);
+
+    // As the walls of a layer that is not the first, and is not spiralized.
+    const coord_t line_width_0 = settings.get<coord_t>("wall_line_width_0");
+    const coord_t line_width_x = settings.get<coord_t>("wall_line_width_x");
+    const size_t wall_count = std::max(size_t(1), settings.get<size_t>("wall_line_count"));
+    const coord_t wall_0_inset = settings.get<coord_t>("wall_0_inset");
+    constexpr int layer_idx = 100;
+
+    std::map<std::string, double> stage_durations;
+    size_t allocations = 0;
+    for (auto _ : st)
+    {
+        TimeKeeper time_keeper;
+        const size_t allocations_before = getAllocationCount();
+        for (const Polygons& part : parts)
+        {
+            WallToolPaths wall_tool_paths(part, line_width_0, line_width_x, wall_count, wall_0_inset, settings, layer_idx, SectionType::WALL);
+            wall_tool_paths.setTimeKeeper(&time_keeper);
+            benchmark::DoNotOptimize(wall_tool_paths.generate());
+        }
+        allocations += getAllocationCount() - allocations_before;
+        for (const TimeKeeper::RegisteredTime& registered_time : time_keeper.getRegisteredTimes())
+        {
+            stage_durations[registered_time.stage] += registered_time.duration;
+        }
+    }
+
+    for (const auto& [stage, duration] : stage_durations)
+    {
+        st.counters[stage] = benchmark::Counter(duration, benchmark::Counter::kAvgIterations);
+    }
+    st.counters["allocations"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    st.counters["parts"] = static_cast<double>(parts.size());
+}
+
+inline bool registerBenchmarks()
+{
+    const std::filesystem::path resource_path = std::filesystem::path(__FILE__).parent_path().parent_path().append("stress_benchmark").append("resources");
+    std::vector<std::filesystem::path> wkt_files;
+    for (const auto& entry : std::filesystem::directory_iterator(resource_path))
+    {
+        if (entry.path().extension() == ".wkt")
+        {
+            wkt_files.push_back(entry.path());
+        }
+    }
+    std::sort(wkt_files.begin(), wkt_files.end());
+
+    for (const std::filesystem::path& wkt_file : wkt_files)
+    {
+        benchmark::RegisterBenchmark(("WallStages/generate/" + wkt_file.stem().string()).c_str(), generateWalls, wkt_file)->Unit(benchmark::kMillisecond);
+    }
+    return true;
+}
+
+static const bool registered = registerBenchmarks();
+
+} // namespace wall_stages_benchmark
+} // namespace cura
+#endif // CURAENGINE_BENCHMARK_WALL_STAGES_BENCHMARK_H
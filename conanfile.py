@@ -61,6 +61,7 @@ class CuraEngineConan(ConanFile):
         copy(self, "*", path.join(self.recipe_folder, "include"), path.join(self.export_sources_folder, "include"))
         copy(self, "*", path.join(self.recipe_folder, "benchmark"), path.join(self.export_sources_folder, "benchmark"))
         copy(self, "*", path.join(self.recipe_folder, "stress_benchmark"), path.join(self.export_sources_folder, "stress_benchmark"))
+        copy(self, "*", path.join(self.recipe_folder, "slice_benchmark"), path.join(self.export_sources_folder, "slice_benchmark"))
         copy(self, "*", path.join(self.recipe_folder, "tests"), path.join(self.export_sources_folder, "tests"))
 
     def config_options(self):
@@ -164,6 +165,7 @@ class CuraEngineConan(ConanFile):
             if self.options.enable_benchmarks:
                 folder_dists.append("benchmark")
                 folder_dists.append("stress_benchmark")
+                folder_dists.append("slice_benchmark")
 
             for dist_folder in folder_dists:
                 dist_path = path.join(self.build_folder, dist_folder)
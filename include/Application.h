@@ -90,6 +90,11 @@ public:
      * The thread pool is restarted when the number of thread differs from
      * previous invocations.
      *
+     * The threads are pinned to CPUs if the environment variable
+     * CURA_ENGINE_PIN_THREADS is set to anything but 0.
+     * The thread pool collects statistics if CURA_ENGINE_THREAD_STATS is set
+     * to anything but 0.
+     *
      * \param nworkers The number of workers (including the main thread) that are ran.
      */
     void startThreadPool(int nworkers = 0);
@@ -116,6 +121,17 @@ protected:
      */
     void slice();
 
+    /*!
+     * \brief Keep slicing jobs that are sent to a local socket, until a client
+     * stops the server.
+     */
+    void serve();
+
+    /*!
+     * \brief Slice all jobs in a manifest, several at a time.
+     */
+    void batch();
+
 private:
     /*
      * \brief The number of arguments that the application was called with.
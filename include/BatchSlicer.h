@@ -0,0 +1,79 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef BATCH_SLICER_H
+#define BATCH_SLICER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Slices a list of jobs, several at the same time.
+ *
+ * A slice keeps its state in process-wide singletons (the current slice of the
+ * Application, the FffProcessor), so slices can't run concurrently inside one
+ * process. Instead, each job is sliced by its own engine process. Each of them
+ * gets an equal share of the cores, so that the serial phases of one job
+ * overlap with the parallel phases of the others.
+ *
+ * The manifest lists one job per line, as the arguments that would follow
+ * \c "CuraEngine slice" on the command line. Arguments are separated by
+ * whitespace, and can be put in double quotes to include whitespace. Empty
+ * lines and lines starting with \c # are ignored.
+ */
+class BatchSlicer
+{
+public:
+    /*!
+     * \brief One job from a manifest.
+     */
+    struct Job
+    {
+        size_t line_nr; //!< Where the job is in the manifest, to report about it.
+        std::vector<std::string> arguments;
+    };
+
+    /*!
+     * \brief Create a batch slicer.
+     * \param executable The engine executable to slice each job with.
+     * \param max_concurrent_jobs How many jobs to slice at the same time.
+     * \param memory_budget How many bytes of memory each job may use, or 0 for
+     * no limit. Jobs that use more than this fail.
+     */
+    BatchSlicer(std::string executable, const size_t max_concurrent_jobs, const size_t memory_budget);
+
+    /*!
+     * \brief Read the jobs in a manifest.
+     * \param manifest_path The manifest file.
+     * \return The jobs, or nullopt if the manifest can't be read.
+     */
+    static std::optional<std::vector<Job>> readManifest(const std::filesystem::path& manifest_path);
+
+    /*!
+     * \brief Split one line of a manifest into its arguments.
+     */
+    static std::vector<std::string> splitArguments(std::string_view line);
+
+    /*!
+     * \brief Slice all jobs, and wait for them to finish.
+     * \param jobs The jobs to slice.
+     * \return How many of the jobs failed.
+     */
+    size_t run(const std::vector<Job>& jobs) const;
+
+private:
+    std::string executable_;
+    size_t max_concurrent_jobs_;
+    size_t memory_budget_;
+};
+
+} // namespace cura
+
+#endif // BATCH_SLICER_H
@@ -0,0 +1,92 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CACHED_BEADING_STRATEGY_H
+#define CACHED_BEADING_STRATEGY_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "BeadingStrategy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A bounded table of the beadings that a beading strategy computed, which many threads can use at once without
+ * locking.
+ *
+ * Every slot of the table is filled at most once and never changes after that, so a beading that was found in it can
+ * be read without any further synchronisation. When the slots where a beading could go are taken by other beadings, it
+ * is not remembered. That keeps the table at a fixed size, and in practice the thicknesses that come up most often
+ * are the ones computed first.
+ */
+class BeadingCache
+{
+public:
+    /*!
+     * \param slot_count The number of beadings that can be remembered. Rounded up to a power of two.
+     */
+    explicit BeadingCache(const size_t slot_count = 4096);
+
+    BeadingCache(const BeadingCache&) = delete;
+    BeadingCache& operator=(const BeadingCache&) = delete;
+
+    ~BeadingCache();
+
+    /*!
+     * \brief Gives the remembered beading for a thickness and bead count, or nullptr if it isn't remembered.
+     */
+    const BeadingStrategy::Beading* find(const coord_t thickness, const coord_t bead_count) const;
+
+    /*!
+     * \brief Remembers a beading, if there is a free slot for it.
+     */
+    void insert(const coord_t thickness, const coord_t bead_count, const BeadingStrategy::Beading& beading);
+
+private:
+    struct Entry
+    {
+        coord_t thickness;
+        coord_t bead_count;
+        BeadingStrategy::Beading beading;
+    };
+
+    //! How many slots after the one that a key hashes to are tried for it.
+    static constexpr size_t probe_count = 4;
+
+    std::vector<std::atomic<const Entry*>> slots_;
+
+    size_t firstSlot(const coord_t thickness, const coord_t bead_count) const;
+};
+
+/*!
+ * This is a meta-strategy that remembers the beadings that its parent computed, so that the many nodes of the skeleton
+ * that have the same thickness don't each compute the beading again through the whole chain of strategies.
+ *
+ * Several strategies can share one cache, as long as their parents compute the same beadings.
+ */
+class CachedBeadingStrategy : public BeadingStrategy
+{
+public:
+    CachedBeadingStrategy(BeadingStrategyPtr parent, std::shared_ptr<BeadingCache> cache);
+
+    virtual ~CachedBeadingStrategy() override = default;
+
+    Beading compute(coord_t thickness, coord_t bead_count) const override;
+    coord_t getOptimalThickness(coord_t bead_count) const override;
+    coord_t getTransitionThickness(coord_t lower_bead_count) const override;
+    coord_t getOptimalBeadCount(coord_t thickness) const override;
+    coord_t getTransitioningLength(coord_t lower_bead_count) const override;
+    double getTransitionAnchorPos(coord_t lower_bead_count) const override;
+    std::vector<coord_t> getNonlinearThicknesses(coord_t lower_bead_count) const override;
+    std::string toString() const override;
+
+protected:
+    const BeadingStrategyPtr parent_;
+    const std::shared_ptr<BeadingCache> cache_;
+};
+
+} // namespace cura
+#endif // CACHED_BEADING_STRATEGY_H
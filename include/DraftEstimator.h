@@ -0,0 +1,75 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_DRAFTESTIMATOR_H
+#define CURAENGINE_DRAFTESTIMATOR_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "settings/Settings.h" //For MAX_EXTRUDERS.
+#include "settings/types/Duration.h"
+
+namespace cura
+{
+
+class MeshGroup;
+
+/*!
+ * \brief Estimates the print time and material of a mesh group from its sliced outlines alone, much faster than a full
+ * slice.
+ *
+ * The meshes are sliced as usual, but none of the areas are generated. Instead, on a sample of the layers:
+ * - the walls are the classic offsets of the outlines, without any variable width walls,
+ * - the skin is the part of the area inside the walls that the layers above and below don't cover,
+ * - the infill is the rest of that area, extruded as the infill line distance asks for.
+ * Each of those is printed at its speed, and a layer takes at least the minimum layer time. Travel moves, support,
+ * platform adhesion and the prime tower aren't estimated. The layers in between the samples are interpolated.
+ */
+class DraftEstimator
+{
+public:
+    /*!
+     * \param layer_step Only look at every so many layers. The first two layers are always looked at, since they are
+     * printed differently.
+     */
+    explicit DraftEstimator(const size_t layer_step);
+
+    /*!
+     * Add the print time and material of a mesh group to the estimates.
+     * \param mesh_group The mesh group, which is the current mesh group of the current slice.
+     */
+    void estimate(MeshGroup& mesh_group);
+
+    /*!
+     * Get the estimated print time in seconds for each feature, of all mesh groups so far.
+     */
+    const std::vector<Duration>& getPrintTimePerFeature() const;
+
+    /*!
+     * Get the estimated extruded volume in mm^3 for an extruder, of all mesh groups so far.
+     */
+    double getMaterialUsed(const size_t extruder_nr) const;
+
+    /*!
+     * \brief Get which layers to look at, and how many layers each of them stands for.
+     *
+     * The layers in between two samples are interpolated linearly, so each sample stands for the layers up to halfway
+     * the next and previous samples. The weights add up to the layer count.
+     * \param layer_count The number of layers.
+     * \param layer_step Look at every so many layers, after the first one.
+     * \return The samples, as pairs of the layer number and its weight, in order of the layer number.
+     */
+    static std::vector<std::pair<size_t, double>> getSampleWeights(const size_t layer_count, const size_t layer_step);
+
+private:
+    size_t layer_step_;
+    std::vector<Duration> print_time_per_feature_; //!< The estimated print time for each PrintFeatureType.
+    std::array<double, MAX_EXTRUDERS> material_used_{}; //!< The estimated extruded volume in mm^3 for each extruder.
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_DRAFTESTIMATOR_H
@@ -4,8 +4,12 @@
 #ifndef GCODE_WRITER_H
 #define GCODE_WRITER_H
 
-#include <fstream>
+#include <filesystem>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
 
 #include "ExtruderUse.h"
 #include "FanSpeedLayerTime.h"
@@ -14,6 +18,8 @@
 #include "settings/MeshPathConfigs.h"
 #include "settings/PathConfigStorage.h" //For the MeshPathConfigs subclass.
 #include "utils/ExtrusionLine.h" //Processing variable-width paths.
+#include "utils/FileSink.h"
+#include "utils/NearestPointGrid.h"
 #include "utils/NoCopy.h"
 #include "utils/gettime.h"
 
@@ -50,16 +56,23 @@ private:
     LayerPlanBuffer layer_plan_buffer;
 
     /*!
-     * The class holding the current state of the gcode being written.
+     * The gcode file to write to when using CuraEngine as command line tool.
      *
-     * It holds information such as the last written position etc.
+     * Declared before \ref gcode, so that the output that \ref gcode still has when it is destroyed can be written.
      */
-    GCodeExport gcode;
+    FileSink output_file_sink;
 
     /*!
-     * The gcode file to write to when using CuraEngine as command line tool.
+     * The stream that writes to \ref output_file_sink.
      */
-    std::ofstream output_file;
+    std::ostream output_file{ &output_file_sink };
+
+    /*!
+     * The class holding the current state of the gcode being written.
+     *
+     * It holds information such as the last written position etc.
+     */
+    GCodeExport gcode;
 
     /*!
      * For each raft/filler layer, the extruders to be used in that layer in the order in which they are going to be used.
@@ -86,6 +99,12 @@ private:
 
     std::string slice_uuid; //!< The UUID of the current slice.
 
+    /*!
+     * The line configs of a layer at full speed of the current mesh group, which the layers above the first layer
+     * derive their line configs from.
+     */
+    std::optional<PathConfigStorage> base_path_configs;
+
 public:
     /*
      * \brief Construct a g-code writer.
@@ -113,6 +132,26 @@ public:
      */
     void setTargetStream(std::ostream* stream);
 
+    /*!
+     * Write the toolpaths of the layers to a directory as well, as described at \ref ToolpathExport, until the slice
+     * is finalized.
+     *
+     * \param directory The directory to write the toolpaths to.
+     * \return Whether the files in the directory could be opened.
+     */
+    bool setToolpathDirectory(const std::filesystem::path& directory);
+
+    /*!
+     * Don't generate any g-code, until a target is set again. The layers are still planned, and the print time and
+     * material are still estimated.
+     */
+    void disableOutput();
+
+    /*!
+     * Wait until all gcode is written to the target, before the target is read.
+     */
+    void flushTargetStream();
+
     /*!
      * Get the total extruded volume for a specific extruder in mm^3
      *
@@ -136,17 +175,31 @@ public:
      *
      * \param[in] storage The data storage from which to get the polygons to print and the areas to fill.
      * \param timeKeeper The stop watch to see how long it takes for each of the stages in the slicing process.
+     * \param keep_storage Whether to keep all areas in the \p storage, so that it can be written again. Otherwise the
+     * areas of the layers are freed once they are written.
      */
-    void writeGCode(SliceDataStorage& storage, TimeKeeper& timeKeeper);
+    void writeGCode(SliceDataStorage& storage, TimeKeeper& timeKeeper, const bool keep_storage = false);
 
 private:
     struct ProcessLayerResult
     {
-        LayerPlan* layer_plan;
+        std::unique_ptr<LayerPlan> layer_plan;
         double total_elapsed_time;
         TimeKeeper::RegisteredTimes stages_times;
     };
 
+    /*!
+     * The normal sparse infill of a part on a layer, generated but not added to a layer plan yet.
+     */
+    struct SingleLayerInfillPaths
+    {
+        Polygons infill_polygons;
+        std::vector<std::vector<VariableWidthLines>> wall_tool_paths; //!< All wall toolpaths binned by inset_idx (inner) and by density_idx (outer)
+        Polygons infill_lines;
+    };
+
+    using InfillPathsPerPart = std::unordered_map<const SliceLayerPart*, SingleLayerInfillPaths>;
+
     /*!
      * \brief Set the FffGcodeWriter::fan_speed_layer_time_settings by
      * retrieving all settings from the global/per-meshgroup settings.
@@ -339,13 +392,15 @@ private:
      * \param extruder_nr The extruder for which to print all features of the mesh which should be printed with this extruder
      * \param mesh_config the line config with which to print a print feature
      * \param gcode_layer The initial planning of the gcode of the layer.
+     * \param infill_per_part The sparse infill that was already generated for the parts of the layer.
      */
     void addMeshLayerToGCode(
         const SliceDataStorage& storage,
         const std::shared_ptr<SliceMeshStorage>& mesh_ptr,
         const size_t extruder_nr,
         const MeshPathConfigs& mesh_config,
-        LayerPlan& gcode_layer) const;
+        LayerPlan& gcode_layer,
+        const InfillPathsPerPart& infill_per_part) const;
 
     /*!
      * Add all features of the given extruder from a single part from a given layer of a mesh-volume to the layer plan \p gcode_layer.
@@ -358,6 +413,7 @@ private:
      * \param mesh_config the line config with which to print a print feature
      * \param part The part to add
      * \param gcode_layer The initial planning of the gcode of the layer.
+     * \param infill_per_part The sparse infill that was already generated for the parts of the layer.
      */
     void addMeshPartToGCode(
         const SliceDataStorage& storage,
@@ -365,7 +421,8 @@ private:
         const size_t extruder_nr,
         const MeshPathConfigs& mesh_config,
         const SliceLayerPart& part,
-        LayerPlan& gcode_layer) const;
+        LayerPlan& gcode_layer,
+        const InfillPathsPerPart& infill_per_part) const;
 
     /*!
      * \brief Add infill for a given part in a layer plan.
@@ -376,6 +433,7 @@ private:
      * mesh which should be printed with this extruder.
      * \param mesh_config the line config with which to print a print feature.
      * \param part The part for which to create gcode.
+     * \param infill_per_part The sparse infill that was already generated for the parts of the layer.
      * \return Whether this function added anything to the layer plan.
      */
     bool processInfill(
@@ -384,7 +442,8 @@ private:
         const SliceMeshStorage& mesh,
         const size_t extruder_nr,
         const MeshPathConfigs& mesh_config,
-        const SliceLayerPart& part) const;
+        const SliceLayerPart& part,
+        const InfillPathsPerPart& infill_per_part) const;
 
     /*!
      * \brief Add thicker (multiple layers) sparse infill for a given part in a
@@ -401,6 +460,34 @@ private:
     bool processMultiLayerInfill(LayerPlan& gcodeLayer, const SliceMeshStorage& mesh, const size_t extruder_nr, const MeshPathConfigs& mesh_config, const SliceLayerPart& part)
         const;
 
+    /*!
+     * Whether a part has normal sparse infill on its layer.
+     */
+    static bool hasSingleLayerInfill(const SliceMeshStorage& mesh, const SliceLayerPart& part);
+
+    /*!
+     * \brief Generate the normal sparse infill of all parts on a layer, in parallel.
+     *
+     * Generating the infill of a part doesn't depend on what was planned before it, so it is done for all parts at once
+     * rather than while planning them one after the other.
+     * \param storage The areas of the mesh group.
+     * \param gcode_layer The layer plan of the layer, which isn't changed.
+     * \param extruder_order The extruders that print on the layer. The infill of other extruders isn't generated.
+     * \return The infill of each part that has any.
+     */
+    static InfillPathsPerPart generateSingleLayerInfill(const SliceDataStorage& storage, const LayerPlan& gcode_layer, const std::vector<ExtruderUse>& extruder_order);
+
+    /*!
+     * \brief Generate the normal sparse infill of a part.
+     * \param mesh The mesh of the part.
+     * \param mesh_config The line config with which to print a print feature.
+     * \param part The part for which to generate the infill.
+     * \param layer_nr The layer of the part.
+     * \param z The height of the layer.
+     */
+    static SingleLayerInfillPaths
+        generateSingleLayerInfill(const SliceMeshStorage& mesh, const MeshPathConfigs& mesh_config, const SliceLayerPart& part, const LayerIndex layer_nr, const coord_t z);
+
     /*!
      * \brief Add normal sparse infill for a given part in a layer.
      * \param gcodeLayer The initial planning of the gcode of the layer.
@@ -409,6 +496,8 @@ private:
      * mesh which should be printed with this extruder
      * \param mesh_config The line config with which to print a print feature.
      * \param part The part for which to create gcode.
+     * \param infill_per_part The sparse infill that was already generated for
+     * the parts of the layer. If \p part isn't in it, its infill is generated.
      * \return Whether this function added anything to the layer plan.
      */
     bool processSingleLayerInfill(
@@ -417,7 +506,8 @@ private:
         const SliceMeshStorage& mesh,
         const size_t extruder_nr,
         const MeshPathConfigs& mesh_config,
-        const SliceLayerPart& part) const;
+        const SliceLayerPart& part,
+        const InfillPathsPerPart& infill_per_part) const;
 
     /*!
      * Generate the insets for the walls of a given layer part.
@@ -677,6 +767,9 @@ private:
 
     /*!
      * Calculate for each layer the index of the vertex that is considered to be the seam
+     *
+     * Which wall is spiralized on each layer, and a grid of the vertices of that wall, are found for a batch of layers
+     * at once. Only the seams themselves are chosen one layer after the other, since each continues from the one below.
      * \param storage where the slice data is stored.
      * \param total_layers The total number of layers
      */
@@ -688,9 +781,15 @@ private:
      * \param mesh the mesh containing the layer of interest
      * \param layer_nr layer number of the layer whose seam verted index is required
      * \param last_layer_nr layer number of the previous layer
+     * \param wall_vertices The vertices of the spiralized wall of the layer, with their indices.
      * \return layer seam vertex index
      */
-    unsigned int findSpiralizedLayerSeamVertexIndex(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const int layer_nr, const int last_layer_nr);
+    unsigned int findSpiralizedLayerSeamVertexIndex(
+        const SliceDataStorage& storage,
+        const SliceMeshStorage& mesh,
+        const int layer_nr,
+        const int last_layer_nr,
+        const NearestPointGrid<size_t>& wall_vertices);
 
     /*!
      * Partition the Infill regions by the skin at N layers above.
@@ -702,7 +801,7 @@ private:
      *
      * \param infill_below_skin [out] Polygons with infill below the skin
      * \param infill_not_below_skin [out] Polygons with infill outside of skin regions above
-     * \param gcode_layer The initial planning of the gcode of the layer
+     * \param layer_nr The layer of the part
      * \param mesh the mesh containing the layer of interest
      * \param part \param part The part for which to create gcode
      * \param infill_line_width line width of the infill
@@ -711,7 +810,7 @@ private:
     static bool partitionInfillBySkinAbove(
         Polygons& infill_below_skin,
         Polygons& infill_not_below_skin,
-        const LayerPlan& gcode_layer,
+        const LayerIndex layer_nr,
         const SliceMeshStorage& mesh,
         const SliceLayerPart& part,
         coord_t infill_line_width);
@@ -10,11 +10,14 @@
 namespace cura
 {
 
+class CompactPolygonsPool;
 class MeshGroup;
+class OutlineIntersectionCache;
 class ProgressStageEstimator;
 class SliceDataStorage;
 class SliceMeshStorage;
 class TimeKeeper;
+class WallToolPathsCache;
 
 /*!
  * Primary stage in Fused Filament Fabrication processing: Polygons are generated.
@@ -75,13 +78,14 @@ private:
      * \param storage Input and Output parameter: fetches the outline information (see SliceLayerPart::outline) and generates the other reachable field of the \p storage
      * \param mesh_order_idx The index of the mesh_idx in \p mesh_order to process in the vector of meshes in \p storage
      * \param mesh_order The order in which the meshes are processed (used for infill meshes)
-     * \param inset_skin_progress_estimate The progress stage estimate calculator
+     * \param inset_skin_progress_estimate The progress stage estimate calculator, or nullptr to not report the progress
+     * within this mesh, such as when multiple meshes are processed at the same time.
      */
     void processBasicWallsSkinInfill(
         SliceDataStorage& storage,
         const size_t mesh_order_idx,
         const std::vector<size_t>& mesh_order,
-        ProgressStageEstimator& inset_skin_progress_estimate);
+        ProgressStageEstimator* inset_skin_progress_estimate);
 
     /*!
      * Process the mesh to be an infill mesh: limit all outlines to within the infill of normal meshes and subtract their volume from the infill of those meshes
@@ -131,8 +135,10 @@ private:
     /*!
      * \brief Generate the inset polygons which form the walls.
      * \param layer_nr The layer for which to generate the insets.
+     * \param walls_cache The walls of earlier outlines of the same mesh, to reuse when an outline comes up again.
+     * \param outline_pool Where to share the print outlines with earlier ones of the same shape.
      */
-    void processWalls(SliceMeshStorage& mesh, size_t layer_nr);
+    void processWalls(SliceMeshStorage& mesh, size_t layer_nr, WallToolPathsCache& walls_cache, CompactPolygonsPool& outline_pool);
 
     /*!
      * Generate the outline of the ooze shield.
@@ -145,8 +151,9 @@ private:
      * \param mesh Input and Output parameter: fetches the outline information (see SliceLayerPart::outline) and generates the other reachable field of the \p storage
      * \param layer_nr The layer for which to generate the skin areas.
      * \param process_infill Generate infill areas
+     * \param outline_intersections The intersections of the outlines of ranges of layers of the same mesh.
      */
-    void processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill);
+    void processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill, OutlineIntersectionCache& outline_intersections);
 
     /*!
      * Generate the polygons where the draft screen should be.
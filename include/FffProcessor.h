@@ -4,6 +4,10 @@
 #ifndef FFF_PROCESSOR_H
 #define FFF_PROCESSOR_H
 
+#include <filesystem>
+#include <optional>
+
+#include "DraftEstimator.h"
 #include "FffGcodeWriter.h"
 #include "FffPolygonGenerator.h"
 #include "utils/gettime.h"
@@ -46,6 +50,11 @@ public:
      */
     TimeKeeper time_keeper; // TODO: use singleton time keeper
 
+    /*!
+     * The draft estimator, if the slices only make a draft estimate of the print time and material.
+     */
+    std::optional<DraftEstimator> draft_estimator;
+
     /*!
      * Set the target to write gcode to: to a file.
      * 
@@ -64,6 +73,39 @@ public:
      */
     void setTargetStream(std::ostream* stream);
 
+    /*!
+     * Write the toolpaths of the layers to a directory as well, for tools that
+     * analyse them.
+     *
+     * \param directory The directory to write the toolpaths to.
+     * \return Whether the files in the directory could be opened.
+     */
+    bool setToolpathDirectory(const std::filesystem::path& directory);
+
+    /*!
+     * Don't generate any g-code, only plan the layers to estimate the print
+     * time and material.
+     */
+    void disableOutput();
+
+    /*!
+     * Don't slice the mesh groups, only make a draft estimate of their print
+     * time and material, which is much faster.
+     *
+     * \param layer_step Only look at every so many layers.
+     */
+    void enableDraftEstimate(const size_t layer_step);
+
+    /*!
+     * Slice the mesh groups again, after a draft estimate.
+     */
+    void disableDraftEstimate();
+
+    /*!
+     * Wait until all gcode is written to the target, before the target is read.
+     */
+    void flushTargetStream();
+
     /*!
      * Get the total extruded volume for a specific extruder in mm^3
      * 
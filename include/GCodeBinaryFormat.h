@@ -0,0 +1,79 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef GCODE_BINARY_FORMAT_H
+#define GCODE_BINARY_FORMAT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "GCodeOutputWriter.h"
+
+namespace cura
+{
+
+/*
+ * A compact binary encoding of g-code, for printers and hosts that read it.
+ *
+ * The file starts with the magic bytes "CGCB" and the version of the format. Then follow blocks. Each block has a
+ * header with its type, its compression method and the size of its data before and after compression. It ends with the
+ * CRC-32 of the compressed data. All numbers in the file and block headers are little-endian.
+ *
+ * The metadata block holds the values of the file header as "KEY=VALUE" lines. A g-code block holds a sequence of
+ * records, one for each piece of text and one for each move. A text record is a zero byte, the length of the text and
+ * the text. A move record is a byte with the lowest bit set and in its next bits whether F, Z and E are written, the
+ * letter of the E axis if E is written, and the X, Y and, if written, Z, F and E values as their difference with the
+ * previous value in the block. X, Y and Z are in micrometres, F in tenths of mm/min and E in units of 10^-5, which is
+ * the precision of the text g-code, so that a decoded file reads the same as the text g-code would have.
+ *
+ * Lengths and differences are variable-length integers of 7 bits per byte, least significant group first, and the
+ * differences are zigzag-encoded, like in \ref encodeCoordinateDeltas.
+ */
+
+//! The version of the binary g-code format that is written.
+constexpr uint32_t binary_gcode_version = 1;
+
+/*!
+ * \brief The bytes that start a binary g-code file.
+ */
+std::string encodeBinaryGCodeFileHeader();
+
+/*!
+ * \brief Encode the file header of the g-code as a metadata block.
+ * \param file_header The file header like \ref GCodeExport::getFileHeader makes it, with one ";KEY:VALUE" comment per
+ * line. Lines without a value are left out.
+ * \return The metadata block.
+ */
+std::string encodeBinaryGCodeMetadata(const std::string_view file_header);
+
+/*!
+ * \brief Encode a chunk of g-code as a g-code block.
+ * \param text The g-code, without the moves.
+ * \param moves The moves, with the positions in \p text where they go.
+ * \return The g-code block.
+ */
+std::string encodeBinaryGCodeBlock(const std::string_view text, const std::vector<std::pair<size_t, GCodeOutputWriter::Move>>& moves);
+
+/*!
+ * \brief The contents of a binary g-code file.
+ */
+struct BinaryGCode
+{
+    std::vector<std::pair<std::string, std::string>> metadata; //!< The keys and values of the metadata blocks, in order.
+    std::string gcode; //!< The g-code blocks, as text g-code.
+};
+
+/*!
+ * \brief Decode a binary g-code file back into text g-code.
+ * \param data The whole file.
+ * \return The metadata and g-code in the file, or nothing if \p data is malformed or corrupted.
+ */
+std::optional<BinaryGCode> decodeBinaryGCode(const std::string_view data);
+
+} // namespace cura
+
+#endif // GCODE_BINARY_FORMAT_H
@@ -0,0 +1,182 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef GCODE_OUTPUT_WRITER_H
+#define GCODE_OUTPUT_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/Coord_t.h"
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+class GCodeLineBuilder;
+
+/*!
+ * \brief Formats g-code and writes it to its output stream on threads of its own.
+ *
+ * The g-code is written into an in-memory buffer. The coordinates of moves, which make up most of the g-code, aren't
+ * formatted into text right away. They are recorded with \ref writeMove, with their values already resolved. Once a
+ * chunk of g-code is complete, such as a layer, it is handed over with \ref submit. Formatter threads then put the
+ * moves into the text of the chunks, several chunks at once. The writer thread writes the formatted chunks to the
+ * output stream in the order in which they were submitted.
+ *
+ * Only a few chunks wait at once, so that a slow output stream holds back the g-code generation rather than letting
+ * the chunks pile up in memory.
+ *
+ * Only one thread at a time may write into the buffer and call the functions of this class. The output stream may only
+ * be read after \ref flush.
+ */
+class GCodeOutputWriter : public NoCopy
+{
+public:
+    /*!
+     * \brief The coordinates of a G0 or G1 move, to be formatted into text.
+     */
+    struct Move
+    {
+        coord_t x; //!< The X coordinate to write.
+        coord_t y; //!< The Y coordinate to write.
+        coord_t z; //!< The Z coordinate to write, if \ref write_z.
+        double f; //!< The speed in mm/min to write, if \ref write_f.
+        double e; //!< The E value to write, if \ref write_e.
+        char e_character; //!< The letter of the axis of the E value.
+        bool write_f;
+        bool write_z;
+        bool write_e;
+    };
+
+    /*!
+     * \param target The stream to write the g-code to.
+     * \param formatter_count How many chunks may be formatted at once.
+     */
+    explicit GCodeOutputWriter(std::ostream* target, const size_t formatter_count = defaultFormatterCount());
+
+    /*!
+     * Writes what is still in the buffer to the output stream before the threads are stopped.
+     */
+    ~GCodeOutputWriter();
+
+    //! The buffer to write g-code into.
+    std::ostream& buffer();
+
+    /*!
+     * \brief Write the coordinates of a move at the end of the buffer.
+     *
+     * They are formatted when the chunk is submitted, as \ref formatMove would do it.
+     */
+    void writeMove(const Move& move);
+
+    /*!
+     * \brief Format the coordinates of a move, like " F1500 X10.5 Y20 Z0.3 E1.23456".
+     */
+    static void formatMove(std::ostream& out, const Move& move);
+
+    /*!
+     * \brief Format the coordinates of a move at the end of a line that is being built.
+     */
+    static void formatMove(GCodeLineBuilder& line, const Move& move);
+
+    /*!
+     * \brief Change the stream to write the g-code to.
+     *
+     * What was written before goes to the previous stream. Without a stream, the g-code is dropped when it is
+     * submitted, without formatting it, such as when only the toolpaths are exported.
+     */
+    void setTarget(std::ostream* target);
+
+    /*!
+     * \brief Switch between writing text g-code and binary g-code, as encoded by \ref encodeBinaryGCodeBlock.
+     *
+     * What was written before is written the way it was. When switching to binary g-code, the header of a binary file
+     * is written first.
+     */
+    void setBinary(const bool binary);
+
+    //! Whether the g-code is written as binary g-code.
+    bool isBinary() const;
+
+    /*!
+     * \brief Write the file header of the g-code as a metadata block of binary g-code.
+     *
+     * What is in the buffer is submitted first, so that the metadata comes after it.
+     */
+    void submitMetadata(const std::string_view file_header);
+
+    /*!
+     * \brief Hand what is in the buffer to the threads that format and write it.
+     *
+     * This only waits when too many chunks wait for those threads already.
+     */
+    void submit();
+
+    /*!
+     * \brief Write everything that is in the buffer or waits for the threads to the output stream, and flush it.
+     */
+    void flush();
+
+    /*!
+     * \brief Drop everything that is in the buffer or waits for the threads, such as when the slice is cancelled.
+     *
+     * A chunk that the writer thread is writing already is finished first.
+     */
+    void discard();
+
+private:
+    //! A chunk of g-code, from being submitted until it is written.
+    struct Chunk
+    {
+        std::string text; //!< The g-code, without the moves.
+        std::vector<std::pair<size_t, Move>> moves; //!< The moves, with the positions in \ref text where they go.
+        bool formatting = false; //!< Whether a formatter thread took the chunk.
+        bool formatted = false; //!< Whether \ref text has the moves in it.
+        bool discarded = false; //!< Whether the chunk was discarded while it was being formatted.
+        bool binary = false; //!< Whether the chunk is encoded as binary g-code rather than formatted as text.
+    };
+
+    //! The default number of formatter threads: a few, since the rest of the machine is busy planning the layers.
+    static size_t defaultFormatterCount();
+
+    //! Put the moves of a chunk into its text, or encode the chunk as binary g-code.
+    static void format(Chunk& chunk);
+
+    //! Wait until there is room for another chunk and hand it to the threads.
+    void enqueue(std::shared_ptr<Chunk> chunk);
+
+    //! Start the threads, if they aren't running yet. The mutex must be locked.
+    void startThreads();
+
+    //! The loop of a formatter thread, which formats the chunks that are submitted until it is stopped.
+    void runFormatter();
+
+    //! The loop of the writer thread, which writes the formatted chunks in order until it is stopped.
+    void runWriter();
+
+    std::ostringstream buffer_; //!< The chunk that is being written. Only touched by the thread that writes g-code.
+    std::vector<std::pair<size_t, Move>> buffer_moves_; //!< The moves of the chunk that is being written.
+    std::ostream* target_; //!< The stream to write the g-code to, if any.
+    size_t formatter_count_; //!< How many formatter threads to start.
+    bool binary_ = false; //!< Whether the chunks that are submitted are encoded as binary g-code.
+
+    std::mutex mutex_; //!< Guards the members below.
+    std::condition_variable condition_; //!< Notified when a chunk is submitted, formatted or written, or when the threads have to stop.
+    std::deque<std::shared_ptr<Chunk>> chunks_; //!< The chunks that were submitted and aren't written yet, in order.
+    bool writing_ = false; //!< Whether the writer thread is writing a chunk.
+    bool stop_ = false; //!< Whether the threads have to stop.
+    std::vector<std::thread> threads_; //!< The formatter threads and the writer thread, started when the first chunk is submitted.
+};
+
+} // namespace cura
+
+#endif // GCODE_OUTPUT_WRITER_H
@@ -66,6 +66,11 @@ struct GCodePathConfig
 
     [[nodiscard]] PrintFeatureType getPrintFeatureType() const noexcept;
 
+    /*!
+     * Change the layer height, and the extrusion per mm of line that depends on it.
+     */
+    void setLayerThickness(const coord_t new_layer_thickness) noexcept;
+
 private:
     [[nodiscard]] double calculateExtrusion() const noexcept;
 };
@@ -10,13 +10,17 @@
 #include "PathOrderOptimizer.h"
 #include "SpaceFillType.h"
 #include "gcodeExport.h"
+#include "pathPlanning/CombBoundaryCache.h"
 #include "pathPlanning/GCodePath.h"
 #include "pathPlanning/NozzleTempInsert.h"
 #include "pathPlanning/TimeMaterialEstimates.h"
 #include "raft.h"
 #include "settings/PathConfigStorage.h"
 #include "settings/types/LayerIndex.h"
+#include "utils/CounterRandom.h"
 #include "utils/ExtrusionJunction.h"
+#include "utils/PolygonsSpatialIndex.h"
+#include "utils/ThreadArena.h"
 #include "utils/polygon.h"
 
 #ifdef BUILD_TESTS
@@ -35,6 +39,7 @@ namespace cura
 class Comb;
 class SliceDataStorage;
 class LayerPlanBuffer;
+class SolidBelow;
 
 
 /*!
@@ -81,6 +86,17 @@ private:
      */
     bool skirt_brim_is_processed_[MAX_EXTRUDERS];
 
+    /*!
+     * The memory for the points of the paths planned in this layer.
+     *
+     * A layer plans tens of thousands of small paths, which are all freed together when the layer is written. Taking
+     * their points from one arena saves an allocation for every path, and keeps the threads that plan layers from
+     * contending in the system allocator. Only the thread that is working on the layer plan uses it.
+     *
+     * Declared before the extruder plans, so that it outlives the paths in them.
+     */
+    Arena path_points_arena_{ 64 << 10 };
+
     std::vector<ExtruderPlan> extruder_plans_; //!< should always contain at least one ExtruderPlan
 
     size_t last_extruder_previous_layer_; //!< The last id of the extruder with which was printed in the previous layer
@@ -92,6 +108,7 @@ private:
     std::optional<std::pair<Acceleration, Velocity>> next_layer_acc_jerk_; //!< If there is a next layer, the first acceleration and jerk it starts with.
     bool was_inside_; //!< Whether the last planned (extrusion) move was inside a layer part
     bool is_inside_; //!< Whether the destination of the next planned travel move is inside a layer part
+    std::shared_ptr<const CombBoundaries> comb_boundaries_; //!< The comb boundaries of this layer, shared with other layers that have the same outlines.
     Polygons comb_boundary_minimum_; //!< The minimum boundary within which to comb, or to move into when performing a retraction.
     Polygons comb_boundary_preferred_; //!< The boundary preferably within which to comb, or to move into when performing a retraction.
     Comb* comb_;
@@ -99,6 +116,10 @@ private:
     Polygons bridge_wall_mask_; //!< The regions of a layer part that are not supported, used for bridging
     Polygons overhang_mask_; //!< The regions of a layer part where the walls overhang
     Polygons roofing_mask_; //!< The regions of a layer part where the walls are exposed to the air
+    std::unique_ptr<PolygonsSpatialIndex> bridge_wall_mask_index_; //!< To check wall lines against bridge_wall_mask_ without going over all of its segments
+    std::unique_ptr<PolygonsSpatialIndex> overhang_mask_index_; //!< To check wall lines against overhang_mask_ without going over all of its segments
+    std::unique_ptr<PolygonsSpatialIndex> roofing_mask_index_; //!< To check wall lines against roofing_mask_ without going over all of its segments
+    std::vector<std::unique_ptr<SolidBelow>> solid_below_; //!< What the skins of this layer could rest on, for each bridge layer and sparse infill density asked for
 
     const std::vector<FanSpeedLayerTimeSettings> fan_speed_layer_time_settings_per_extruder_;
 
@@ -156,6 +177,9 @@ public:
      * while combing.
      * \param travel_avoid_distance The distance by which to avoid other layer
      * parts when travelling through air.
+     * \param base_configs If given, the line configs of a layer at full speed
+     * to derive the line configs of this layer from, if it's above the first
+     * layer, instead of looking up all their settings.
      */
     LayerPlan(
         const SliceDataStorage& storage,
@@ -166,7 +190,8 @@ public:
         const std::vector<FanSpeedLayerTimeSettings>& fan_speed_layer_time_settings_per_extruder,
         coord_t comb_boundary_offset,
         coord_t comb_move_inside_distance,
-        coord_t travel_avoid_distance);
+        coord_t travel_avoid_distance,
+        const PathConfigStorage* base_configs = nullptr);
 
     ~LayerPlan();
 
@@ -182,6 +207,22 @@ public:
 
     LayerIndex getLayerNr() const;
 
+    /*!
+     * \brief Get a random number generator for choices in this layer.
+     *
+     * It's seeded with the layer number, so every generator of a layer gives the same numbers, on every run, no matter
+     * which other layers are planned at the same time.
+     */
+    CounterRandom getRandom() const;
+
+    /*!
+     * \brief Estimate how much memory this plan takes up.
+     *
+     * This counts the planned paths and the boundaries kept for planning, which make up nearly all of it.
+     * \return The estimated size in bytes.
+     */
+    size_t getMemoryFootprint() const;
+
     /*!
      * Get the last planned position, or if no position has been planned yet, the user specified layer start position.
      *
@@ -287,6 +328,20 @@ public:
      */
     void setRoofingMask(const Polygons& polys);
 
+    /*!
+     * \brief Get what the skins of this layer could rest on in a layer below.
+     *
+     * This is shared by all skins of the layer, so that the parts below are only processed once.
+     * \param bridge_layer The bridge layer number (1, 2 or 3).
+     * \param sparse_infill_max_density Infill up to this density doesn't support the first bridge layer.
+     */
+    SolidBelow& getSolidBelow(const unsigned bridge_layer, const Ratio sparse_infill_max_density);
+
+    /*!
+     * \brief Forget what the skins of this layer could rest on, once all of them are planned.
+     */
+    void clearSolidBelow();
+
     /*!
      * Travel to a certain point, with all of the procedures necessary to do so.
      *
@@ -561,6 +616,7 @@ public:
      * \param fan_speed optional fan speed override for this path
      * \param reverse_print_direction Whether to reverse the optimized order and their printing direction.
      * \param order_requirements Pairs where first needs to be printed before second. Pointers are pointing to elements of \p polygons
+     * \param travel_improvement_time How long to spend at most on shortening the travel moves after ordering the lines, see PathOrderOptimizer::improvement_time_
      */
     void addLinesByOptimizer(
         const Polygons& polygons,
@@ -572,7 +628,8 @@ public:
         const std::optional<Point2LL> near_start_location = std::optional<Point2LL>(),
         const double fan_speed = GCodePathConfig::FAN_SPEED_DEFAULT,
         const bool reverse_print_direction = false,
-        const std::unordered_multimap<ConstPolygonPointer, ConstPolygonPointer>& order_requirements = PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_);
+        const std::unordered_multimap<ConstPolygonPointer, ConstPolygonPointer>& order_requirements = PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_,
+        const Duration travel_improvement_time = 0);
 
     /*!
      * Add polygons to the g-code with monotonic order.
@@ -667,13 +724,14 @@ public:
         }
 
         const auto air_below = bridge_wall_mask_.unionPolygons(overhang_mask_);
+        const PolygonsSpatialIndex air_below_index(air_below);
 
         unsigned curr_idx = start_idx;
 
         while (true)
         {
             const Point2LL& vertex = cura::make_point(wall[curr_idx]);
-            if (! air_below.inside(vertex, true))
+            if (! air_below_index.inside(vertex, true))
             {
                 // vertex isn't above air so it's OK to use
                 return curr_idx;
@@ -780,6 +838,23 @@ private:
      * \return the combing boundary or an empty Polygons if no combing is required
      */
     Polygons computeCombBoundary(const CombBoundary boundary_type);
+
+    /*!
+     * \brief Get the comb boundaries of this layer, from the cache of the storage if a layer with the same outlines made
+     * them already.
+     *
+     * \param comb_boundary_offset The cell size of the grids of the comb boundaries.
+     * \return The comb boundaries of this layer.
+     */
+    std::shared_ptr<const CombBoundaries> getCombBoundaries(const coord_t comb_boundary_offset);
+
+    /*!
+     * \brief Collect what \ref LayerPlan::computeCombBoundary makes the comb boundaries of, to look them up in the cache.
+     *
+     * \param comb_boundary_offset The cell size of the grids of the comb boundaries.
+     * \return What the comb boundaries are made of, or nullopt if they shouldn't be cached, such as on raft layers.
+     */
+    std::optional<CombBoundaryCache::Key> computeCombBoundaryKey(const coord_t comb_boundary_offset) const;
 };
 
 } // namespace cura
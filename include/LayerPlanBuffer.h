@@ -5,6 +5,7 @@
 #define LAYER_PLAN_BUFFER_H
 
 #include <list>
+#include <optional>
 #include <vector>
 
 #include "ExtruderPlan.h"
@@ -59,6 +60,21 @@ class LayerPlanBuffer
      */
     std::list<LayerPlan*> buffer_;
 
+    /*!
+     * For the extruder plans in the buffer, in print order, when each one starts, counted from the start of the buffer.
+     * One more element holds when the last one ends.
+     *
+     * This is computed along with the list of extruder plans for each new layer, so that the time between two extruder
+     * plans doesn't need to be summed over all of the plans in between.
+     */
+    std::vector<Duration> extruder_plan_start_times_;
+
+    /*!
+     * For the extruder plans in the buffer, in print order, the index of the last plan before it with the same extruder,
+     * if there is one in the buffer.
+     */
+    std::vector<std::optional<size_t>> previous_plan_of_extruder_;
+
 public:
     LayerPlanBuffer(GCodeExport& gcode)
         : gcode_(gcode)
@@ -79,14 +95,26 @@ public:
      *
      * \param layer_plan The layer to handle
      * \param gcode The exporter with which to write a layer to gcode if the buffer is too large after pushing the new layer.
+     * \return The number of the layer that was written to gcode, if any.
      */
-    void handle(LayerPlan& layer_plan, GCodeExport& gcode);
+    std::optional<LayerIndex> handle(LayerPlan& layer_plan, GCodeExport& gcode);
 
     /*!
      * Write all remaining layer plans (LayerPlan) to gcode and empty the buffer.
      */
     void flush();
 
+    /*!
+     * Empty the buffer without writing the layer plans to gcode, such as when the slice is cancelled.
+     */
+    void discard();
+
+    /*!
+     * \brief Estimate how much memory the layer plans in the buffer take up.
+     * \return The estimated size in bytes.
+     */
+    size_t getMemoryFootprint() const;
+
 private:
     /*!
      * Process all layers in the buffer
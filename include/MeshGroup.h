@@ -44,6 +44,13 @@ public:
 /*!
  * Load a Mesh from file and store it in the \p meshgroup.
  *
+ * Files can be STL (.stl), or indexed meshes (.cmesh) of which the vertices
+ * are already welded. An indexed mesh is a little-endian binary file with the
+ * 8 characters "CURAMESH", then a uint32 version (1), a reserved uint32, a
+ * uint32 vertex count and a uint32 face count, followed by three floats (X, Y,
+ * Z in millimetres) per vertex and then three uint32 vertex indices per face,
+ * in counter-clockwise order.
+ *
  * \param meshgroup The meshgroup where to store the mesh
  * \param filename The filename of the mesh file
  * \param transformation The transformation applied to all vertices
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_MESHWALLSCACHE_H
+#define CURAENGINE_MESHWALLSCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+class Settings;
+class WallToolPathsCache;
+
+/*!
+ * \brief Keeps the walls of the meshes around between slices.
+ *
+ * When the front-end reslices a plate after one of its meshes was moved or edited, or after a modifier mesh was added,
+ * most meshes and most of their layers are unchanged. The SlicerCache already gives the unchanged meshes the same
+ * sliced layers, and the walls of those layers are the same as in the previous slice too, unless the outlines of a layer
+ * changed where another mesh overlaps it. This hands each mesh a WallToolPathsCache that remembers the walls of all of
+ * its layers, and that the next slice of a mesh with the same settings starts out with. Since that cache compares the
+ * outlines themselves, only the layers whose outlines changed get new walls, whatever changed them.
+ *
+ * Meshes with the same settings share a WallToolPathsCache, so that copies of a mesh on the same plate share their
+ * walls too.
+ *
+ * Like the SlicerCache, only the entries that were used by the previous slice are kept, and nothing is kept between
+ * slices unless the communication channel can request multiple slices from the same engine process.
+ */
+class MeshWallsCache : NoCopy
+{
+public:
+    /*!
+     * Get the cache shared by all slices of this engine process.
+     */
+    static MeshWallsCache& getInstance();
+
+    /*!
+     * \brief Get the walls cache for a mesh.
+     *
+     * \param mesh_settings The settings of the mesh, which the walls depend on.
+     * \param layer_count How many layers the mesh has, so that the cache can remember the walls of all of them.
+     * \return The walls cache, shared with the other meshes with the same settings in this slice and the previous one.
+     */
+    std::shared_ptr<WallToolPathsCache> get(const Settings& mesh_settings, const size_t layer_count);
+
+    /*!
+     * \brief Mark the start of a new slice.
+     *
+     * Entries created or used during the previous slice remain available. All older entries are dropped.
+     */
+    void startSlice();
+
+    /*!
+     * \brief Mark the end of a slice.
+     *
+     * Entries from before this slice that it didn't use are dropped.
+     */
+    void finishSlice();
+
+    /*!
+     * Drop all entries.
+     */
+    void clear();
+
+private:
+    //! The walls cache of the meshes with the same settings.
+    struct Entry
+    {
+        std::shared_ptr<WallToolPathsCache> cache;
+        size_t capacity; //!< The number of layers of the meshes that used the cache in the current slice.
+    };
+
+    /*!
+     * Hash all the settings of a mesh.
+     */
+    static uint64_t hashSettings(const Settings& mesh_settings);
+
+    std::mutex mutex_; //!< Guards the entries. Meshes may ask for their caches from different threads.
+    std::unordered_map<uint64_t, Entry> entries_; //!< The entries created or used by the current slice.
+    std::unordered_map<uint64_t, Entry> previous_entries_; //!< The entries of the previous slice that haven't been used yet.
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_MESHWALLSCACHE_H
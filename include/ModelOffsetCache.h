@@ -0,0 +1,108 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_MODELOFFSETCACHE_H
+#define CURAENGINE_MODELOFFSETCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "settings/types/LayerIndex.h"
+#include "utils/Coord_t.h"
+#include "utils/NoCopy.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+class SliceDataStorage;
+
+/*!
+ * \brief Remembers the outlines of the model on each layer, offset by the distances that support generation needs.
+ *
+ * Generating support for each mesh needs the outlines of all models on each layer, and offsets of those by the X/Y
+ * distance, by the distance that the overhang angle can bridge and so on. Those are the same for every mesh that has the
+ * same support settings, and for the layers around a layer, so they are computed once here and shared.
+ *
+ * The outlines are only valid while the models don't change, which is during support generation. Afterwards the cache
+ * should be released to free its memory.
+ *
+ * The cache can be used from several threads at once.
+ */
+class ModelOffsetCache : public NoCopy
+{
+public:
+    //! The mesh index that stands for the outlines of all models, as given by SliceDataStorage::getLayerOutlines.
+    static constexpr int all_meshes = -1;
+
+    /*!
+     * \param storage The storage to get the outlines from, which must outlive the cache.
+     */
+    explicit ModelOffsetCache(const SliceDataStorage& storage);
+
+    /*!
+     * \brief Gives the outlines of the model on a layer, offset by a distance.
+     *
+     * \param layer_nr The layer to get the outlines of. Only the outlines of all models exist below layer 0 (the raft),
+     * and those don't include any model there.
+     * \param mesh_idx The mesh to get the outlines of, or \ref all_meshes for the outlines of all models, without support
+     * and the prime tower.
+     * \param distance How far to offset the outlines. With a distance of 0, the outlines are given as they are, so
+     * overlapping outlines of different meshes are not merged.
+     * \param join_type How to join the offset segments at the corners.
+     * \return The offset outlines. They stay valid until the cache is released.
+     */
+    const Polygons& get(const LayerIndex layer_nr, const int mesh_idx, const coord_t distance = 0, const ClipperLib::JoinType join_type = ClipperLib::jtMiter) const;
+
+    //! How many bytes the remembered outlines take up.
+    size_t getMemoryUsage() const;
+
+    /*!
+     * \brief Forgets all remembered outlines, to free their memory.
+     *
+     * All outlines given by \ref get before become invalid, so no other thread may be using the cache.
+     */
+    void release();
+
+private:
+    struct Key
+    {
+        LayerIndex layer_nr;
+        int mesh_idx;
+        coord_t distance;
+        ClipperLib::JoinType join_type;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    //! The outlines for one key, computed by the first thread that needs them.
+    struct Entry
+    {
+        std::once_flag computed;
+        Polygons outlines;
+    };
+
+    //! Computes the outlines for a key that isn't remembered yet.
+    Polygons compute(const Key& key) const;
+
+    const SliceDataStorage& storage_;
+
+    //! Guards entries_. Each entry is computed at most once, so it can be read after the lock is released.
+    mutable std::mutex mutex_;
+
+    mutable std::unordered_map<Key, std::unique_ptr<Entry>, KeyHash> entries_;
+
+    mutable std::atomic<size_t> memory_usage_{ 0 };
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_MODELOFFSETCACHE_H
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_OUTLINEINTERSECTIONCACHE_H
+#define CURAENGINE_OUTLINEINTERSECTIONCACHE_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "settings/types/LayerIndex.h"
+#include "utils/NoCopy.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+class SliceLayer;
+
+/*!
+ * \brief Remembers the intersections of the outlines of ranges of consecutive layers of a mesh.
+ *
+ * The skin of a layer depends on where all of the layers above it, up to the number of top layers, or all of the layers
+ * below it, up to the number of bottom layers, have an outline. Neighboring layers need almost the same intersections.
+ * For each layer, this keeps the intersection of the outlines of 1, 2, 4 and so on consecutive layers from there. Any
+ * range of layers is then the intersection of at most two of those, which overlap.
+ *
+ * The intersections are computed when they are first needed, and then remembered. The outlines of a layer are read when
+ * the first intersection that includes the layer is computed, so they may still change until then.
+ *
+ * The cache can be used from several threads at once.
+ */
+class OutlineIntersectionCache : public NoCopy
+{
+public:
+    /*!
+     * \param layers The layers of the mesh, which must outlive the cache.
+     * \param max_layer_count The largest number of layers that will be intersected at once.
+     */
+    OutlineIntersectionCache(const std::vector<SliceLayer>& layers, const size_t max_layer_count);
+
+    /*!
+     * \brief Gives the area that is inside the outlines of all layers from \p first_layer_nr up to and including \p
+     * last_layer_nr.
+     *
+     * Layers above the mesh have no outline, so a range that includes them gives an empty area.
+     * \param first_layer_nr The lowest layer of the range. Must be at least 0.
+     * \param last_layer_nr The highest layer of the range. Must be at least \p first_layer_nr and may not span more than
+     * the maximum number of layers given to the constructor.
+     */
+    Polygons intersection(const LayerIndex first_layer_nr, const LayerIndex last_layer_nr);
+
+private:
+    //! The intersection of the outlines of a number of layers.
+    struct Entry
+    {
+        std::once_flag computed;
+        Polygons outline;
+    };
+
+    /*!
+     * \brief Gives the intersection of the outlines of the 2^\p level layers starting at \p layer_nr, computing it if
+     * needed.
+     */
+    const Polygons& get(const size_t level, const size_t layer_nr);
+
+    const std::vector<SliceLayer>& layers_;
+
+    //! For each level, the intersection of the outlines of 2^level layers starting at each layer.
+    std::vector<std::vector<Entry>> levels_;
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_OUTLINEINTERSECTIONCACHE_H
@@ -5,6 +5,9 @@
 #define PATHORDERMONOTONIC_H
 
 #include <cmath> //For std::sin() and std::cos().
+#include <map> //To index the perpendicular ranges of nearby lines.
+#include <queue> //To find when nearby lines drop out of range.
+#include <set> //To track the lengths of the perpendicular ranges of nearby lines.
 #include <unordered_map> //To track monotonic sequences.
 #include <unordered_set> //To track starting points of monotonic sequences.
 
@@ -125,6 +128,12 @@ public:
         // string of polylines. The ``connections`` map indicates, starting from each starting segment, the sequence of line segments to print in order. Note that for performance
         // reasons, the ``connections`` map will sometimes link the end of one segment to the start of the next segment. This link should be ignored.
         const Point2LL perpendicular = turn90CCW(monotonic_vector_); // To project on to detect adjacent lines.
+        const std::vector<std::vector<Path*>> overlapping_lines_per_polyline = getOverlappingLines(polylines, perpendicular); // In the same order as the sorted polylines.
+        std::unordered_map<Path*, size_t> polyline_indices; // Where each polyline is in the sorted list, to look up its overlapping lines.
+        for (size_t polyline_idx = 0; polyline_idx < polylines.size(); ++polyline_idx)
+        {
+            polyline_indices.emplace(polylines[polyline_idx], polyline_idx);
+        }
 
         std::unordered_set<Path*> connected_lines; // Lines that are reachable from one of the starting lines through its connections.
         std::unordered_set<Path*> starting_lines; // Starting points of a linearly connected segment.
@@ -152,7 +161,7 @@ public:
                     // The strings of polylines may still have weird shapes which interweave with other strings of polylines or loose lines.
                     // So when a polyline string comes into contact with other lines, we still want to guarantee their order.
                     // So here we will look for which lines they come into contact with, and thus mark those as possible starting points, so that they function as a new junction.
-                    const std::vector<Path*> overlapping_lines = getOverlappingLines(std::find(polylines.begin(), polylines.end(), polystring[i]), perpendicular, polylines);
+                    const std::vector<Path*>& overlapping_lines = overlapping_lines_per_polyline[polyline_indices[polystring[i]]];
                     for (Path* overlapping_line : overlapping_lines)
                     {
                         if (std::find(polystring.begin(), polystring.end(), overlapping_line)
@@ -170,7 +179,7 @@ public:
                 {
                     starting_lines.insert(*polyline_it); // This is a starting point then.
                 }
-                const std::vector<Path*> overlapping_lines = getOverlappingLines(polyline_it, perpendicular, polylines);
+                const std::vector<Path*>& overlapping_lines = overlapping_lines_per_polyline[polyline_it - polylines.begin()];
                 if (overlapping_lines.size() == 1) // If we're not a string of polylines, but adjacent to only one other polyline, create a sequence of polylines.
                 {
                     connections[*polyline_it] = overlapping_lines[0];
@@ -418,63 +427,79 @@ protected:
     }
 
     /*!
-     * Find which lines are overlapping with a certain line.
-     * \param polyline_it The line with which to find overlaps. Given as an
-     * iterator into the sorted polylines list, to cut down on the search space.
-     * If the lines don't have too much overlap, this should result in only a
-     * handful of lines being searched at all.
+     * Find which lines are overlapping with each line.
+     *
+     * A line overlaps with a later line in the sorted list if it is within
+     * max_adjacent_distance of it in the monotonic direction, and their
+     * ranges overlap in the perpendicular direction, padded by
+     * max_adjacent_distance.
+     *
+     * The lines are swept through in the sorted order. The earlier lines that
+     * are still within the maximum adjacent distance in the monotonic
+     * direction are kept in an index of their perpendicular ranges. Since the
+     * lines are sorted by their projection on the monotonic vector, a line
+     * never comes back in range once it has dropped out of the index. That
+     * way each line is only compared with the handful of lines around it, even
+     * if there are many lines side by side in the perpendicular direction.
+     * \param polylines The sorted list of polylines.
      * \param perpendicular A vector perpendicular to the monotonic vector, pre-
      * calculated.
-     * \param polylines The sorted list of polylines.
+     * \return For each polyline in the sorted list, the lines after it that it
+     * overlaps with, in the sorted order.
      */
-    std::vector<Path*> getOverlappingLines(const typename std::vector<Path*>::iterator polyline_it, const Point2LL perpendicular, const std::vector<Path*>& polylines)
+    std::vector<std::vector<Path*>> getOverlappingLines(const std::vector<Path*>& polylines, const Point2LL perpendicular) const
     {
         const coord_t max_adjacent_projected_distance = max_adjacent_distance_ * monotonic_vector_resolution_;
-        // How far this extends in the monotonic direction, to make sure we only go up to max_adjacent_distance in that direction.
-        const coord_t start_monotonic = dot((*polyline_it)->converted_->front(), monotonic_vector_);
-        const coord_t end_monotonic = dot((*polyline_it)->converted_->back(), monotonic_vector_);
-        const coord_t my_farthest_monotonic = std::max(start_monotonic, end_monotonic);
-        const coord_t my_closest_monotonic = std::min(start_monotonic, end_monotonic);
-        const coord_t my_farthest_monotonic_padded = my_farthest_monotonic + max_adjacent_projected_distance;
-        const coord_t my_closest_monotonic_padded = my_closest_monotonic - max_adjacent_projected_distance;
-        // How far this line reaches in the perpendicular direction -- the range at which the line overlaps other lines.
-        const coord_t my_start = dot((*polyline_it)->converted_->front(), perpendicular);
-        const coord_t my_end = dot((*polyline_it)->converted_->back(), perpendicular);
-        const coord_t my_farthest = std::max(my_start, my_end);
-        const coord_t my_closest = std::min(my_start, my_end);
-        const coord_t my_farthest_padded = my_farthest + max_adjacent_projected_distance;
-        const coord_t my_closest_padded = my_closest - max_adjacent_projected_distance;
-
-        std::vector<Path*> overlapping_lines;
-        for (auto overlapping_line = polyline_it + 1; overlapping_line != polylines.end(); overlapping_line++)
+
+        std::vector<std::vector<Path*>> overlapping_lines(polylines.size());
+        // The earlier lines that are still in range in the monotonic direction, by the start of their padded perpendicular range.
+        std::multimap<coord_t, size_t> active_lines;
+        std::vector<typename std::multimap<coord_t, size_t>::iterator> active_line_handles(polylines.size());
+        // The lengths of the padded perpendicular ranges of the active lines, to know how far back in the index a range could still reach.
+        std::multiset<coord_t> active_lengths;
+        // When each active line drops out of range: The end of its padded projection on the monotonic vector.
+        using Expiry = std::pair<coord_t, size_t>;
+        std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> expiries;
+        std::vector<coord_t> padded_farthest(polylines.size());
+
+        for (size_t line_idx = 0; line_idx < polylines.size(); ++line_idx)
         {
-            // Don't go beyond the maximum adjacent distance.
-            const coord_t start_their_projection = dot((*overlapping_line)->converted_->front(), monotonic_vector_);
-            const coord_t end_their_projection = dot((*overlapping_line)->converted_->back(), monotonic_vector_);
-            const coord_t their_farthest_projection = std::max(start_their_projection, end_their_projection);
-            const coord_t their_closest_projection = std::min(start_their_projection, end_their_projection);
-            // Multiply by the length of the vector since we need to compare actual distances here.
-            if (their_closest_projection > my_farthest_monotonic_padded || my_closest_monotonic_padded > their_farthest_projection)
+            const Path* polyline = polylines[line_idx];
+            const coord_t start_monotonic = dot(polyline->converted_->front(), monotonic_vector_);
+            const coord_t end_monotonic = dot(polyline->converted_->back(), monotonic_vector_);
+            const coord_t closest_monotonic = std::min(start_monotonic, end_monotonic);
+            // Drop the lines that are too far back. This line and all subsequent lines are not adjacent to them anymore, even though they might be side-by-side.
+            while (! expiries.empty() && expiries.top().first < closest_monotonic)
             {
-                break; // Too far. This line and all subsequent lines are not adjacent anymore, even though they might be side-by-side.
+                const size_t expired_idx = expiries.top().second;
+                expiries.pop();
+                active_lengths.erase(active_lengths.find(padded_farthest[expired_idx] - active_line_handles[expired_idx]->first));
+                active_lines.erase(active_line_handles[expired_idx]);
             }
 
-            // Does this one overlap?
-            const coord_t their_start = dot((*overlapping_line)->converted_->front(), perpendicular);
-            const coord_t their_end = dot((*overlapping_line)->converted_->back(), perpendicular);
-            const coord_t their_farthest = std::max(their_start, their_end);
-            const coord_t their_closest = std::min(their_start, their_end);
-            /*There are 5 possible cases of overlapping:
-            - We are behind them, partially overlapping. my_start is between their_start and their_end.
-            - We are in front of them, partially overlapping. my_end is between their_start and their_end.
-            - We are a smaller line, they completely overlap us. Both my_start and my_end are between their_start and their_end. (Caught with the first 2 conditions already.)
-            - We are a bigger line, and completely overlap them. Both their_start and their_end are between my_start and my_end.
-            - Lines are exactly equal. Start and end are the same. (Caught with the previous condition too.)*/
-            if ((my_closest_padded >= their_closest && my_closest_padded <= their_farthest) || (my_farthest_padded >= their_closest && my_farthest_padded <= their_farthest)
-                || (their_closest >= my_closest_padded && their_farthest <= my_farthest_padded))
+            // How far this line reaches in the perpendicular direction -- the range at which the line overlaps other lines.
+            const coord_t start = dot(polyline->converted_->front(), perpendicular);
+            const coord_t end = dot(polyline->converted_->back(), perpendicular);
+            const coord_t farthest = std::max(start, end);
+            const coord_t closest = std::min(start, end);
+            if (! active_lines.empty())
             {
-                overlapping_lines.push_back(*overlapping_line);
+                // An active range can only overlap if it starts before this range ends, and ends after this range starts.
+                const coord_t longest = *active_lengths.rbegin();
+                for (auto active = active_lines.lower_bound(closest - longest); active != active_lines.end() && active->first <= farthest; ++active)
+                {
+                    if (padded_farthest[active->second] >= closest)
+                    {
+                        overlapping_lines[active->second].push_back(polylines[line_idx]); // Lines come by in the sorted order, so each list stays sorted too.
+                    }
+                }
             }
+
+            const coord_t closest_padded = closest - max_adjacent_projected_distance;
+            padded_farthest[line_idx] = farthest + max_adjacent_projected_distance;
+            active_line_handles[line_idx] = active_lines.emplace(closest_padded, line_idx);
+            active_lengths.insert(padded_farthest[line_idx] - closest_padded);
+            expiries.emplace(std::max(start_monotonic, end_monotonic) + max_adjacent_projected_distance, line_idx);
         }
 
         return overlapping_lines;
@@ -4,6 +4,9 @@
 #ifndef PATHORDEROPTIMIZER_H
 #define PATHORDEROPTIMIZER_H
 
+#include <chrono>
+#include <cmath>
+#include <optional>
 #include <unordered_set>
 
 #include <range/v3/algorithm/partition_copy.hpp>
@@ -13,6 +16,7 @@
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/reverse.hpp>
+#include <range/v3/view/take.hpp>
 #include <spdlog/spdlog.h>
 
 #include "InsetOrderOptimizer.h" // for makeOrderIncludeTransitive
@@ -21,6 +25,9 @@
 #include "pathPlanning/LinePolygonsCrossings.h" //To prevent calculating combing distances if we don't cross the combing borders.
 #include "settings/EnumSettings.h" //To get the seam settings.
 #include "settings/ZSeamConfig.h" //To read the seam configuration.
+#include "settings/types/Duration.h"
+#include "utils/AABB.h"
+#include "utils/NearestPointGrid.h"
 #include "utils/linearAlg2D.h" //To find the angle of corners to hide seams.
 #include "utils/polygonUtils.h"
 #include "utils/views/dfs.h"
@@ -87,6 +94,15 @@ public:
      */
     ZSeamConfig seam_config_;
 
+    /*!
+     * How long to spend at most on shortening the travel moves between the
+     * paths after ordering them, by reversing parts of the order (2-opt).
+     *
+     * This is off by default, since the resulting order then depends on how
+     * fast the computer is. It is not used when there are order requirements.
+     */
+    Duration improvement_time_ = 0;
+
     static const std::unordered_multimap<Path, Path> no_order_requirements_;
 
     /*!
@@ -217,6 +233,7 @@ public:
         if (order_requirements_->empty())
         {
             optimized_order = getOptimizedOrder(line_bucket_grid, snap_radius);
+            improveOrder(optimized_order);
         }
         else
         {
@@ -235,6 +252,7 @@ public:
         }
 
         combing_grid_.reset();
+        corner_angles_.clear();
     }
 
 protected:
@@ -245,6 +263,13 @@ protected:
      */
     constexpr static coord_t _coincident_point_distance = 10;
 
+    /*!
+     * With at least this many paths, the closest path is looked up in a grid
+     * of the remaining paths when there are none within the snap radius,
+     * rather than checking all remaining paths.
+     */
+    constexpr static size_t _nearest_search_min_paths = 64;
+
     /*!
      * Bucket grid to store the locations of the combing boundary.
      *
@@ -254,6 +279,12 @@ protected:
      */
     std::unique_ptr<LocToLineGrid> combing_grid_;
 
+    /*!
+     * The corner angles of the vertices of the closed paths that a start
+     * location was looked for, see \ref getCornerAngles .
+     */
+    std::unordered_map<Path, std::vector<double>> corner_angles_;
+
     /*!
      * Boundary to avoid when making travel moves.
      */
@@ -299,6 +330,7 @@ protected:
         Point2LL current_position = start_point_;
 
         std::unordered_map<OrderablePath*, bool> picked(paths_.size()); // Fixed size boolean flag for whether each path is already in the optimized vector.
+        std::optional<NearestPointGrid<size_t>> remaining_paths; // The endpoints of the paths that are not picked yet, created once they are needed.
 
         auto notPicked = [&picked](OrderablePath* c)
         {
@@ -321,19 +353,41 @@ protected:
                 available_candidates.push_back(candidate);
             }
 
-            if (available_candidates.empty()) // We need to broaden our search through all candidates
+            OrderablePath* best_candidate = nullptr;
+            if (! available_candidates.empty())
+            {
+                best_candidate = findClosestPath(current_position, available_candidates);
+            }
+            else if (paths_.size() >= _nearest_search_min_paths) // Broaden our search to all remaining candidates, nearest first.
+            {
+                if (! remaining_paths)
+                {
+                    remaining_paths = createRemainingPathsGrid(picked);
+                }
+                best_candidate = findClosestRemainingPath(current_position, *remaining_paths);
+            }
+            if (best_candidate == nullptr) // We need to broaden our search through all candidates
             {
                 for (auto path : paths_ | ranges::views::addressof | ranges::views::filter(notPicked))
                 {
                     available_candidates.push_back(path);
                 }
+                best_candidate = findClosestPath(current_position, available_candidates);
             }
 
-            auto best_candidate = findClosestPath(current_position, available_candidates);
-
             auto best_path = best_candidate;
             optimized_order.push_back(*best_path);
             picked[best_path] = true;
+            if (remaining_paths)
+            {
+                const size_t path_idx = best_path - paths_.data();
+                forEachSearchPoint(
+                    *best_path,
+                    [&remaining_paths, path_idx](const Point2LL& point)
+                    {
+                        remaining_paths->remove(point, path_idx);
+                    });
+            }
 
             if (! best_path->converted_->empty()) // If all paths were empty, the best path is still empty. We don't upate the current position then.
             {
@@ -577,23 +631,7 @@ protected:
                 continue;
             }
 
-            const bool precompute_start
-                = seam_config_.type_ == EZSeamType::RANDOM || seam_config_.type_ == EZSeamType::USER_SPECIFIED || seam_config_.type_ == EZSeamType::SHARPEST_CORNER;
-            if (! path->is_closed_ || ! precompute_start) // Find the start location unless we've already precomputed it.
-            {
-                path->start_vertex_ = findStartLocation(*path, start_position);
-                if (! path->is_closed_) // Open polylines start at vertex 0 or vertex N-1. Indicate that they should be reversed if they start at N-1.
-                {
-                    path->backwards_ = path->start_vertex_ > 0;
-                }
-            }
-            const Point2LL candidate_position = (*path->converted_)[path->start_vertex_];
-            coord_t distance2 = getDirectDistance(start_position, candidate_position);
-            if (distance2 < best_distance2
-                && combing_boundary_) // If direct distance is longer than best combing distance, the combing distance can never be better, so only compute combing if necessary.
-            {
-                distance2 = getCombingDistance(start_position, candidate_position);
-            }
+            const coord_t distance2 = getPathDistance2(start_position, *path, best_distance2);
             if (distance2 < best_distance2) // Closer than the best candidate so far.
             {
                 best_candidate = path;
@@ -604,6 +642,227 @@ protected:
         return best_candidate;
     }
 
+    /*!
+     * Choose where to start a path when coming from a position, and find how
+     * far that is.
+     * \param start_position The position to move to the path from.
+     * \param path The path, which must have vertices. Its start vertex and
+     * direction are set.
+     * \param best_distance2 The squared distance to the best path so far. The
+     * combing distance is only computed if the direct distance is not longer.
+     * \return The squared distance to travel to the start of the path.
+     */
+    coord_t getPathDistance2(const Point2LL& start_position, OrderablePath& path, const coord_t best_distance2)
+    {
+        const bool precompute_start
+            = seam_config_.type_ == EZSeamType::RANDOM || seam_config_.type_ == EZSeamType::USER_SPECIFIED || seam_config_.type_ == EZSeamType::SHARPEST_CORNER;
+        if (! path.is_closed_ || ! precompute_start) // Find the start location unless we've already precomputed it.
+        {
+            path.start_vertex_ = findStartLocation(path, start_position);
+            if (! path.is_closed_) // Open polylines start at vertex 0 or vertex N-1. Indicate that they should be reversed if they start at N-1.
+            {
+                path.backwards_ = path.start_vertex_ > 0;
+            }
+        }
+        const Point2LL candidate_position = (*path.converted_)[path.start_vertex_];
+        coord_t distance2 = getDirectDistance(start_position, candidate_position);
+        if (distance2 <= best_distance2
+            && combing_boundary_) // If direct distance is longer than best combing distance, the combing distance can never be better, so only compute combing if necessary.
+        {
+            distance2 = getCombingDistance(start_position, candidate_position);
+        }
+        return distance2;
+    }
+
+    /*!
+     * Call a function for each vertex that a path could start at: All
+     * vertices of polygons, but only the endpoints of polylines.
+     */
+    template<typename F>
+    void forEachSearchPoint(const OrderablePath& path, F&& process_point) const
+    {
+        if (path.converted_->empty())
+        {
+            return;
+        }
+        if (path.is_closed_)
+        {
+            for (const Point2LL& point : *path.converted_)
+            {
+                process_point(point);
+            }
+        }
+        else
+        {
+            process_point(path.converted_->front());
+            process_point(path.converted_->back());
+        }
+    }
+
+    /*!
+     * Put the vertices that the paths which are not picked yet could start at
+     * in a grid, to find the closest one without checking all of them.
+     * \param picked Which paths are picked already.
+     * \return A grid with the path indices of the vertices.
+     */
+    NearestPointGrid<size_t> createRemainingPathsGrid(std::unordered_map<OrderablePath*, bool>& picked)
+    {
+        AABB bounds;
+        size_t point_count = 0;
+        for (const OrderablePath& path : paths_)
+        {
+            forEachSearchPoint(
+                path,
+                [&bounds, &point_count](const Point2LL& point)
+                {
+                    bounds.include(point);
+                    point_count++;
+                });
+        }
+        if (point_count == 0)
+        {
+            return NearestPointGrid<size_t>(1);
+        }
+        // Aim for about one point per cell.
+        const double area = static_cast<double>(bounds.max_.X - bounds.min_.X + 1) * static_cast<double>(bounds.max_.Y - bounds.min_.Y + 1);
+        NearestPointGrid<size_t> grid(static_cast<coord_t>(std::sqrt(area / static_cast<double>(point_count))));
+        for (size_t path_idx = 0; path_idx < paths_.size(); ++path_idx)
+        {
+            if (picked[&paths_[path_idx]])
+            {
+                continue;
+            }
+            forEachSearchPoint(
+                paths_[path_idx],
+                [&grid, path_idx](const Point2LL& point)
+                {
+                    grid.insert(point, path_idx);
+                });
+        }
+        return grid;
+    }
+
+    /*!
+     * Find the closest path among the paths that are not picked yet.
+     *
+     * The vertices of the paths are visited from nearest to furthest. A path
+     * can't be closer than its nearest vertex, and combing is never shorter
+     * than moving straight, so the search stops once the remaining vertices are
+     * further than the best path found. Between equally close paths, the first
+     * one in \ref paths_ is picked, like \ref findClosestPath does.
+     * \param start_position The position to move from.
+     * \param remaining_paths A grid with the vertices of the paths that are not
+     * picked yet.
+     * \return The closest path, or nullptr if only paths without vertices
+     * remain.
+     */
+    OrderablePath* findClosestRemainingPath(const Point2LL& start_position, const NearestPointGrid<size_t>& remaining_paths)
+    {
+        coord_t best_distance2 = std::numeric_limits<coord_t>::max();
+        size_t best_path_idx = std::numeric_limits<size_t>::max();
+        std::unordered_set<size_t> evaluated; // Polygons can have many vertices nearby.
+        remaining_paths.processNearestFirst(
+            start_position,
+            [this, &start_position, &best_distance2, &best_path_idx, &evaluated](const Point2LL&, const size_t path_idx)
+            {
+                if (! evaluated.insert(path_idx).second)
+                {
+                    return;
+                }
+                const coord_t distance2 = getPathDistance2(start_position, paths_[path_idx], best_distance2);
+                if (distance2 < best_distance2 || (distance2 == best_distance2 && path_idx < best_path_idx))
+                {
+                    best_distance2 = distance2;
+                    best_path_idx = path_idx;
+                }
+            },
+            [&best_distance2](const coord_t min_distance)
+            {
+                return min_distance * min_distance <= best_distance2;
+            });
+        if (best_path_idx == std::numeric_limits<size_t>::max())
+        {
+            return nullptr;
+        }
+        return &paths_[best_path_idx];
+    }
+
+    /*!
+     * Shorten the travel moves between the paths in an order by reversing
+     * parts of it, for at most \ref improvement_time_ (2-opt).
+     *
+     * Reversing a part of the order also reverses the direction in which its
+     * polylines are printed. Only direct distances are compared, not combing
+     * distances.
+     * \param order The order to improve. Paths without vertices must be at the
+     * end, as \ref getOptimizedOrder leaves them.
+     */
+    void improveOrder(std::vector<OrderablePath>& order) const
+    {
+        if (improvement_time_.value_ <= 0.0)
+        {
+            return;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(improvement_time_.value_);
+        const size_t count = std::find_if(
+                                 order.begin(),
+                                 order.end(),
+                                 [](const OrderablePath& path)
+                                 {
+                                     return path.converted_->empty();
+                                 })
+                           - order.begin();
+
+        std::vector<Point2LL> starts;
+        std::vector<Point2LL> ends;
+        starts.reserve(count);
+        ends.reserve(count);
+        for (const OrderablePath& path : order | ranges::views::take(count))
+        {
+            starts.push_back((*path.converted_)[path.start_vertex_]);
+            ends.push_back(path.is_closed_ ? starts.back() : (path.start_vertex_ == 0 ? path.converted_->back() : path.converted_->front()));
+        }
+
+        bool improved = true;
+        while (improved)
+        {
+            improved = false;
+            for (size_t first = 0; first < count; ++first)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return;
+                }
+                const Point2LL before = first == 0 ? start_point_ : ends[first - 1];
+                for (size_t last = first; last < count; ++last)
+                {
+                    // Printing the paths from first to last in reverse moves from before to the end of last, and from the start of first to the path after last.
+                    const bool has_after = last + 1 < count;
+                    const coord_t current_travel = vSize(before - starts[first]) + (has_after ? vSize(ends[last] - starts[last + 1]) : 0);
+                    const coord_t reversed_travel = vSize(before - ends[last]) + (has_after ? vSize(starts[first] - starts[last + 1]) : 0);
+                    if (reversed_travel >= current_travel)
+                    {
+                        continue;
+                    }
+                    std::reverse(order.begin() + first, order.begin() + last + 1);
+                    std::reverse(starts.begin() + first, starts.begin() + last + 1);
+                    std::reverse(ends.begin() + first, ends.begin() + last + 1);
+                    for (size_t path_idx = first; path_idx <= last; ++path_idx)
+                    {
+                        std::swap(starts[path_idx], ends[path_idx]);
+                        OrderablePath& path = order[path_idx];
+                        if (! path.is_closed_)
+                        {
+                            path.start_vertex_ = path.start_vertex_ == 0 ? path.converted_->size() - 1 : 0;
+                            path.backwards_ = path.start_vertex_ > 0;
+                        }
+                    }
+                    improved = true;
+                }
+            }
+        }
+    }
+
     /*!
      * Find the vertex which will be the starting point of printing a polygon or
      * polyline.
@@ -647,17 +906,7 @@ protected:
             return vert;
         }
 
-        // Precompute segments lengths because we are going to need them multiple times
-        std::vector<coord_t> segments_sizes(path.converted_->size());
-        coord_t total_length = 0;
-        for (size_t i = 0; i < path.converted_->size(); ++i)
-        {
-            const Point2LL& here = path.converted_->at(i);
-            const Point2LL& next = path.converted_->at((i + 1) % path.converted_->size());
-            const coord_t segment_size = vSize(next - here);
-            segments_sizes[i] = segment_size;
-            total_length += segment_size;
-        }
+        const std::vector<double>& corner_angles = getCornerAngles(path);
 
         size_t best_i;
         double best_score = std::numeric_limits<double>::infinity();
@@ -669,7 +918,7 @@ protected:
                                             ? MM2INT(10)
                                             : vSize2(here - target_pos);
 
-            double corner_angle = cornerAngle(path, i, segments_sizes, total_length);
+            const double corner_angle = corner_angles[i];
             // angles < 0 are concave (left turning)
             // angles > 0 are convex (right turning)
 
@@ -743,6 +992,58 @@ protected:
         return best_i;
     }
 
+    /*!
+     * Get the corner angle of each vertex of a closed path, see
+     * \ref cornerAngle .
+     *
+     * These don't depend on where the path is approached from, so they are
+     * only computed the first time that the start of the path is looked for.
+     * \param path The vertex data of a path
+     * \return The corner angle of each vertex of the path
+     */
+    const std::vector<double>& getCornerAngles(const OrderablePath& path)
+    {
+        auto [corner_angles, inserted] = corner_angles_.try_emplace(path.vertices_);
+        if (inserted)
+        {
+            corner_angles->second = computeCornerAngles(path);
+        }
+        return corner_angles->second;
+    }
+
+    /*!
+     * Compute the corner angle of each vertex of a closed path, see
+     * \ref cornerAngle .
+     * \param path The vertex data of a path
+     * \return The corner angle of each vertex of the path
+     */
+    static std::vector<double> computeCornerAngles(const OrderablePath& path)
+    {
+        const size_t size = path.converted_->size();
+        std::vector<coord_t> segments_sizes(size);
+        // The distance along the path from the first vertex to each vertex, going around twice, so that neighbour points can be found by a binary search.
+        std::vector<coord_t> perimeter(2 * size + 1, 0);
+        for (size_t i = 0; i < size; ++i)
+        {
+            const Point2LL& here = path.converted_->at(i);
+            const Point2LL& next = path.converted_->at((i + 1) % size);
+            segments_sizes[i] = vSize(next - here);
+            perimeter[i + 1] = perimeter[i] + segments_sizes[i];
+        }
+        const coord_t total_length = perimeter[size];
+        for (size_t i = size + 1; i <= 2 * size; ++i)
+        {
+            perimeter[i] = perimeter[i - size] + total_length;
+        }
+
+        std::vector<double> corner_angles(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            corner_angles[i] = cornerAngle(path, i, segments_sizes, perimeter, total_length);
+        }
+        return corner_angles;
+    }
+
     /*!
      * Finds a neighbour point on the path, located before or after the given reference point. The neighbour point
      * is computed by travelling on the path and stopping when the distance has been reached, For example:
@@ -755,33 +1056,54 @@ protected:
      * \param path The vertex data of a path
      * \param here The starting point index
      * \param distance The distance we want to travel on the path, which may be positive to go forward
-     * or negative to go backward
+     * or negative to go backward. It may not be longer than the path.
      * \param segments_sizes The pre-computed sizes of the segments
+     * \param perimeter The pre-computed distances along the path from the first vertex to each vertex, going around
+     * the path twice
      * \return The position of the path a the given distance from the reference point
      */
-    static Point2LL findNeighbourPoint(const OrderablePath& path, int here, coord_t distance, const std::vector<coord_t>& segments_sizes)
+    static Point2LL findNeighbourPoint(const OrderablePath& path, size_t here, coord_t distance, const std::vector<coord_t>& segments_sizes, const std::vector<coord_t>& perimeter)
     {
+        const size_t size = path.converted_->size();
         const int direction = distance > 0 ? 1 : -1;
-        const int size_delta = distance > 0 ? -1 : 0;
         distance = std::abs(distance);
+        if (distance == 0)
+        {
+            return path.converted_->at(here);
+        }
 
-        // Travel on the path until we reach the distance
-        int actual_delta = 0;
-        coord_t travelled_distance = 0;
-        coord_t segment_size = 0;
-        while (travelled_distance < distance)
+        // Find the first vertex that is at least the distance away along the path.
+        size_t actual_delta; // The number of vertices from here to that vertex.
+        coord_t travelled_distance;
+        coord_t segment_size; // The size of the segment that ends at that vertex.
+        if (direction > 0)
+        {
+            const auto reached = std::lower_bound(perimeter.begin() + here + 1, perimeter.begin() + here + size + 1, perimeter[here] + distance);
+            const size_t reached_idx = reached - perimeter.begin();
+            actual_delta = reached_idx - here;
+            travelled_distance = *reached - perimeter[here];
+            segment_size = segments_sizes[(reached_idx - 1) % size];
+        }
+        else
         {
-            actual_delta += direction;
-            segment_size = segments_sizes[(here + actual_delta + size_delta + path.converted_->size()) % path.converted_->size()];
-            travelled_distance += segment_size;
+            // Start from the second time around the path, to not go below the first vertex.
+            const size_t start_idx = here + size;
+            const size_t reached_idx = std::upper_bound(perimeter.begin() + start_idx - size, perimeter.begin() + start_idx, perimeter[start_idx] - distance) - perimeter.begin() - 1;
+            actual_delta = start_idx - reached_idx;
+            travelled_distance = perimeter[start_idx] - perimeter[reached_idx];
+            segment_size = segments_sizes[reached_idx % size];
         }
 
-        const Point2LL& next_pos = path.converted_->at((here + actual_delta + path.converted_->size()) % path.converted_->size());
+        const auto vertex_at_delta = [here, size, direction](const size_t delta)
+        {
+            return direction > 0 ? (here + delta) % size : (here + size - delta) % size;
+        };
+        const Point2LL& next_pos = path.converted_->at(vertex_at_delta(actual_delta));
 
         if (travelled_distance > distance) [[likely]]
         {
             // We have overtaken the required distance, go backward on the last segment
-            int prev = (here + actual_delta - direction + path.converted_->size()) % path.converted_->size();
+            const size_t prev = vertex_at_delta(actual_delta - 1);
             const Point2LL& prev_pos = path.converted_->at(prev);
 
             const Point2LL vector = next_pos - prev_pos;
@@ -805,16 +1127,23 @@ protected:
      * \param path The vertex data of a path
      * \param i index of the query point
      * \param segments_sizes The pre-computed sizes of the segments
+     * \param perimeter The pre-computed distances along the path to each vertex, see \ref findNeighbourPoint
      * \param total_length The path total length
      * \param angle_query_distance query range (default to 1mm)
      * \return angle between the reference point and the two sibling points, weighed to [-1.0 ; 1.0]
      */
-    static double cornerAngle(const OrderablePath& path, int i, const std::vector<coord_t>& segments_sizes, coord_t total_length, const coord_t angle_query_distance = 1000)
+    static double cornerAngle(
+        const OrderablePath& path,
+        size_t i,
+        const std::vector<coord_t>& segments_sizes,
+        const std::vector<coord_t>& perimeter,
+        coord_t total_length,
+        const coord_t angle_query_distance = 1000)
     {
         const coord_t bounded_distance = std::min(angle_query_distance, total_length / 2);
         const Point2LL& here = path.converted_->at(i);
-        const Point2LL next = findNeighbourPoint(path, i, bounded_distance, segments_sizes);
-        const Point2LL previous = findNeighbourPoint(path, i, -bounded_distance, segments_sizes);
+        const Point2LL next = findNeighbourPoint(path, i, bounded_distance, segments_sizes, perimeter);
+        const Point2LL previous = findNeighbourPoint(path, i, -bounded_distance, segments_sizes, perimeter);
 
         double angle = LinearAlg2D::getAngleLeft(previous, here, next) - std::numbers::pi;
 
@@ -43,6 +43,15 @@ private:
 
     MovesByExtruder prime_moves_; //!< For each extruder, the moves to be processed for actual priming.
 
+    std::vector<std::vector<Point2LL>> prime_starts_; //!< For each extruder and each start location, where to travel to before priming.
+
+    /*!
+     * For each extruder and each start location, the moves for actual priming in the order and from the seams that the
+     * path order optimizer picks when starting from \ref prime_starts_. These don't depend on the layer, so they're
+     * planned once and appended as they are.
+     */
+    std::vector<MovesByExtruder> planned_prime_moves_;
+
     /*
      *  The first index is a bitmask representing an extruder combination, e.g. 0x05 for extruders 1+3.
      *  The second index is the used extruder index, e.g. 1
@@ -174,6 +183,16 @@ private:
      */
     void generateStartLocations();
 
+    /*!
+     * Compute \ref prime_starts_ and \ref planned_prime_moves_ from the start locations and the prime moves.
+     */
+    void planPrimeMoves();
+
+    /*!
+     * Which of the start locations an extruder starts priming at on a layer, so that the start rotates around the tower.
+     */
+    size_t getStartLocationIdx(const LayerIndex& layer_nr, const size_t extruder_nr) const;
+
     /*!
      * \see PrimeTower::addToGcode
      *
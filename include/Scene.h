@@ -4,6 +4,9 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <memory>
+#include <thread>
+
 #include "ExtruderTrain.h" //To store the extruders in the scene.
 #include "MeshGroup.h" //To store the mesh groups in the scene.
 #include "settings/Settings.h" //To store the global settings.
@@ -11,6 +14,8 @@
 namespace cura
 {
 
+class SliceDataStorage;
+
 /*
  * Represents a scene that should be sliced.
  */
@@ -56,6 +61,11 @@ public:
      */
     Scene(const size_t num_mesh_groups);
 
+    /*
+     * \brief Wait until the data of the last mesh group is released.
+     */
+    ~Scene();
+
     /*
      * \brief Gets a string that contains all settings.
      *
@@ -71,7 +81,33 @@ public:
      */
     void processMeshGroup(MeshGroup& mesh_group);
 
+    /*
+     * \brief Wait until the data of the mesh group before is released.
+     *
+     * Once its g-code is written, the slice data of a mesh group is freed on a
+     * thread of its own while the next mesh group is generated.
+     */
+    void waitForReleasedStorage();
+
 private:
+    /*
+     * \brief Free the slice data of a mesh group whose g-code is written.
+     *
+     * Freeing all the polygons of a large mesh group takes a while, and none
+     * of it is needed for the next mesh group. If there is a next one and
+     * there is room in the memory budget, this happens on a thread of its own
+     * while the next mesh group is generated. Otherwise it happens right away.
+     * \param storage The slice data to free.
+     * \param is_last Whether this was the last mesh group of the scene.
+     */
+    void releaseStorage(std::unique_ptr<SliceDataStorage> storage, const bool is_last);
+
+    /*
+     * \brief The thread that frees the slice data of the mesh group before, if
+     * any.
+     */
+    std::thread storage_release_thread_;
+
     /*
      * \brief You are not allowed to copy the scene.
      */
@@ -5,6 +5,7 @@
 #define SKELETAL_TRAPEZOIDATION_H
 
 #include <memory> // smart pointers
+#include <memory_resource>
 #include <unordered_map>
 #include <utility> // pair
 
@@ -19,6 +20,8 @@
 #include "utils/ExtrusionLine.h"
 #include "utils/HalfEdgeGraph.h"
 #include "utils/PolygonsSegmentIndex.h"
+#include "utils/ThreadArena.h"
+#include "utils/gettime.h"
 #include "utils/polygon.h"
 #include "utils/section_type.h"
 
@@ -55,12 +58,27 @@ class SkeletalTrapezoidation
     using BeadingPropagation = SkeletalTrapezoidationJoint::BeadingPropagation;
     using TransitionMiddle = SkeletalTrapezoidationEdge::TransitionMiddle;
     using TransitionEnd = SkeletalTrapezoidationEdge::TransitionEnd;
+    using TransitionMiddles = SkeletalTrapezoidationEdge::TransitionMiddles;
+    using TransitionEnds = SkeletalTrapezoidationEdge::TransitionEnds;
 
     template<typename T>
     using ptr_vector_t = std::vector<std::shared_ptr<T>>;
 
+    /*!
+     * Create an element of the side tables of the graph (a ptr_vector_t) in the thread arena, like the graph itself.
+     *
+     * The object and its reference counts are one allocation from the arena, and containers in it that take a
+     * polymorphic allocator allocate from the arena as well.
+     */
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> makeShared(Args&&... args)
+    {
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(ThreadArena::resource()), std::forward<Args>(args)...);
+    }
+
     AngleRadians transitioning_angle_; //!< How pointy a region should be before we apply the method. Equals 180* - limit_bisector_angle
     coord_t discretization_step_size_; //!< approximate size of segments when parabolic VD edges get discretized (and vertex-vertex edges)
+    coord_t discretization_max_deviation_; //!< how far parabolic VD edges may deviate from their discretization, which lengthens the segments of flat ones
     coord_t transition_filter_dist_; //!< Filter transition mids (i.e. anchors) closer together than this
     coord_t allowed_filter_deviation_; //!< The allowed line width deviation induced by filtering
     coord_t beading_propagation_transition_dist_; //!< When there are different beadings propagated from below and from above, use this transitioning distance
@@ -68,6 +86,7 @@ class SkeletalTrapezoidation
     static constexpr coord_t snap_dist_ = 20; //!< Generic arithmatic inaccuracy. Only used to determine whether a transition really needs to insert an extra edge.
     int layer_idx_{};
     SectionType section_type_;
+    TimeKeeper* time_keeper_ = nullptr; //!< Where to register how long each stage of generating the toolpaths takes, if anywhere
 
     /*!
      * The strategy to use to fill a certain shape with lines.
@@ -103,6 +122,9 @@ public:
      * transitions in line width, the line width must change with discretized
      * steps. This indicates how long the line segments between those steps will
      * be.
+     * \param discretization_max_deviation How far the discretized edges may
+     * deviate from the parabolic edges. Where the edges are flat enough, they
+     * are discretized with longer steps than \p discretization_step_size.
      * \param transition_filter_dist The minimum length of transitions.
      * Transitions shorter than this will be considered for dissolution.
      * \param beading_propagation_transition_dist When there are different
@@ -114,6 +136,7 @@ public:
         const BeadingStrategy& beading_strategy,
         AngleRadians transitioning_angle,
         coord_t discretization_step_size,
+        coord_t discretization_max_deviation,
         coord_t transition_filter_dist,
         coord_t allowed_filter_deviation,
         coord_t beading_propagation_transition_dist,
@@ -127,8 +150,10 @@ public:
      * touch the outside of the polygon. If enabled, don't treat these as
      * "central" but as if it's a obtuse corner. As a result, sharp corners will
      * no longer end in a single line but will just loop.
+     * \param time_keeper If given, the time that the transitions, the beading
+     * and the junctions take is registered in it, as separate stages.
      */
-    void generateToolpaths(std::vector<VariableWidthLines>& generated_toolpaths, bool filter_outermost_central_edges = false);
+    void generateToolpaths(std::vector<VariableWidthLines>& generated_toolpaths, bool filter_outermost_central_edges = false, TimeKeeper* time_keeper = nullptr);
 
 protected:
     /*!
@@ -137,8 +162,8 @@ protected:
     struct TransitionMidRef
     {
         edge_t* edge_;
-        std::list<TransitionMiddle>::iterator transition_it_;
-        TransitionMidRef(edge_t* edge, std::list<TransitionMiddle>::iterator transition_it)
+        TransitionMiddles::iterator transition_it_;
+        TransitionMidRef(edge_t* edge, TransitionMiddles::iterator transition_it)
             : edge_(edge)
             , transition_it_(transition_it)
         {
@@ -349,7 +374,7 @@ protected:
      * returned via the output parameter.
      * \param[out] edge_transitions A list of transitions that were generated.
      */
-    void generateTransitionMids(ptr_vector_t<std::list<TransitionMiddle>>& edge_transitions);
+    void generateTransitionMids(ptr_vector_t<TransitionMiddles>& edge_transitions);
 
     /*!
      * Removes some transition middle points.
@@ -403,12 +428,12 @@ protected:
      * Generate the endpoints of all transitions for all edges in the graph.
      * \param[out] edge_transition_ends The resulting transition endpoints.
      */
-    void generateAllTransitionEnds(ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends);
+    void generateAllTransitionEnds(ptr_vector_t<TransitionEnds>& edge_transition_ends);
 
     /*!
      * Also set the rest values at nodes in between the transition ends
      */
-    void applyTransitions(ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends);
+    void applyTransitions(ptr_vector_t<TransitionEnds>& edge_transition_ends);
 
     /*!
      * Create extra edges along all edges, where it needs to transition from one
@@ -431,7 +456,7 @@ protected:
      * \param[out] edge_transition_ends A list of endpoints to add the new
      * endpoints to.
      */
-    void generateTransitionEnds(edge_t& edge, coord_t mid_R, coord_t transition_lower_bead_count, ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends);
+    void generateTransitionEnds(edge_t& edge, coord_t mid_R, coord_t transition_lower_bead_count, ptr_vector_t<TransitionEnds>& edge_transition_ends);
 
     /*!
      * Compute a single endpoint of a transition.
@@ -461,7 +486,7 @@ protected:
         Ratio start_rest,
         Ratio end_rest,
         coord_t transition_lower_bead_count,
-        ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends);
+        ptr_vector_t<TransitionEnds>& edge_transition_ends);
 
     /*!
      * Determines whether an edge is going downwards or upwards in the graph.
@@ -509,6 +534,12 @@ protected:
      */
     void generateSegments();
 
+    /*!
+     * Register the time since the previous stage in the time keeper, if there
+     * is one.
+     */
+    void registerTime(const std::string& stage);
+
     /*!
      * From a quad (a group of linked edges in one cell of the Voronoi), find
      * the edge pointing to the node that is furthest away from the border of the polygon.
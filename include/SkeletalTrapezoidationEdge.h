@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "utils/ExtrusionJunction.h"
+#include "utils/ThreadArena.h"
 
 namespace cura
 {
@@ -56,6 +57,10 @@ public:
         }
     };
 
+    //! The transitions of an edge. Their nodes come from the thread arena when created through an arena allocator.
+    using TransitionMiddles = arena_list<TransitionMiddle>;
+    using TransitionEnds = arena_list<TransitionEnd>;
+
     enum class EdgeType : int
     {
         NORMAL = 0, // from voronoi diagram
@@ -92,11 +97,11 @@ public:
     {
         return transitions_.use_count() > 0 && (ignore_empty || ! transitions_.lock()->empty());
     }
-    void setTransitions(std::shared_ptr<std::list<TransitionMiddle>>& storage)
+    void setTransitions(std::shared_ptr<TransitionMiddles>& storage)
     {
         transitions_ = storage;
     }
-    std::shared_ptr<std::list<TransitionMiddle>> getTransitions()
+    std::shared_ptr<TransitionMiddles> getTransitions()
     {
         return transitions_.lock();
     }
@@ -105,11 +110,11 @@ public:
     {
         return transition_ends_.use_count() > 0 && (ignore_empty || ! transition_ends_.lock()->empty());
     }
-    void setTransitionEnds(std::shared_ptr<std::list<TransitionEnd>>& storage)
+    void setTransitionEnds(std::shared_ptr<TransitionEnds>& storage)
     {
         transition_ends_ = storage;
     }
-    std::shared_ptr<std::list<TransitionEnd>> getTransitionEnds()
+    std::shared_ptr<TransitionEnds> getTransitionEnds()
     {
         return transition_ends_.lock();
     }
@@ -130,8 +135,8 @@ public:
     Central is_central; //! whether the edge is significant; whether the source segments have a sharp angle; -1 is unknown
 
 private:
-    std::weak_ptr<std::list<TransitionMiddle>> transitions_;
-    std::weak_ptr<std::list<TransitionEnd>> transition_ends_;
+    std::weak_ptr<TransitionMiddles> transitions_;
+    std::weak_ptr<TransitionEnds> transition_ends_;
     std::weak_ptr<LineJunctions> extrusion_junctions_;
 };
 
@@ -89,6 +89,8 @@ private:
     size_t first_used_extruder_nr_; //!< The first extruder which is used
     int skirt_brim_extruder_nr_; //!< The extruder with which the skirt/brim is printed or -1 if printed with both
     std::vector<ExtruderConfig> extruders_configs_; //!< The brim setup for each extruder
+    bool allowed_areas_exclude_covered_area_ = false; //!< Whether the allowed areas of all extruders are known to lie outside of the covered area, so that \ref generateOffset only
+                                                      //!< needs to subtract what it newly covers from them.
 
 public:
     /*!
@@ -0,0 +1,108 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_SLICEDATASTORAGECACHE_H
+#define CURAENGINE_SLICEDATASTORAGECACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+class MeshGroup;
+class SliceDataStorage;
+
+/*!
+ * \brief Keeps the areas of the mesh groups around between slices.
+ *
+ * When the front-end reslices a scene after changing only settings that the g-code writer reads (speeds, temperatures,
+ * retractions, fan speeds, start and end g-code, ...), the areas that FffPolygonGenerator generates are all the same
+ * as in the previous slice. The SliceDataStorage of the previous slice can then be written again, with the new
+ * settings, instead of generating the areas anew.
+ *
+ * The entries are keyed by a hash of the geometry of the meshes and of all settings, except for those that only the
+ * g-code writer reads. Only the entries that were used by the previous slice are kept.
+ *
+ * The cache is only used if the communication channel can request multiple slices from the same engine process.
+ */
+class SliceDataStorageCache : NoCopy
+{
+public:
+    /*!
+     * Get the cache shared by all slices of this engine process.
+     */
+    static SliceDataStorageCache& getInstance();
+
+    /*!
+     * Whether the current communication channel may ask for another slice in this process, i.e. whether it is worth
+     * keeping the areas after writing them.
+     */
+    static bool isEnabled();
+
+    /*!
+     * \brief Whether a setting is only read while writing the g-code, so that a different value doesn't change the
+     * areas of a mesh group.
+     *
+     * This errs on the safe side: any setting that isn't known to be read only by the g-code writer counts as one
+     * that changes the areas.
+     * \param key The key of the setting.
+     */
+    static bool onlyAffectsGCode(const std::string_view key);
+
+    /*!
+     * Hash all the input of FffPolygonGenerator that determines the areas of a mesh group.
+     */
+    static uint64_t hashAreasInput(const MeshGroup& mesh_group);
+
+    /*!
+     * \brief Take the areas of a mesh group out of the cache, if an earlier slice had the same input.
+     *
+     * The meshes in the storage are moved over to the meshes of \p mesh_group, so that they read the settings of this
+     * slice.
+     * \param key The hash of the input of the mesh group, see \ref hashAreasInput.
+     * \param mesh_group The mesh group of this slice.
+     * \return The areas, or nullptr if they have to be generated.
+     */
+    std::unique_ptr<SliceDataStorage> take(const uint64_t key, MeshGroup& mesh_group);
+
+    /*!
+     * \brief Keep the areas of a mesh group for the next slice.
+     *
+     * The storage must still hold all of its areas, i.e. it must have been written without releasing them.
+     * \param key The hash of the input of the mesh group, see \ref hashAreasInput.
+     * \param storage The areas.
+     */
+    void keep(const uint64_t key, std::unique_ptr<SliceDataStorage> storage);
+
+    /*!
+     * \brief Mark the start of a new slice.
+     *
+     * Entries created or used during the previous slice remain available. All older entries are dropped.
+     */
+    void startSlice();
+
+    /*!
+     * \brief Mark the end of a slice.
+     *
+     * Entries from before this slice that it didn't use are dropped.
+     */
+    void finishSlice();
+
+    /*!
+     * Drop all entries.
+     */
+    void clear();
+
+private:
+    std::unordered_map<uint64_t, std::unique_ptr<SliceDataStorage>> entries_; //!< The entries created or used by the current slice.
+    std::unordered_map<uint64_t, std::unique_ptr<SliceDataStorage>> previous_entries_; //!< The entries of the previous slice that haven't been used yet.
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_SLICEDATASTORAGECACHE_H
@@ -0,0 +1,126 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef SLICER_CACHE_H
+#define SLICER_CACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "slicer.h"
+#include "utils/Point2LL.h"
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+class AdaptiveLayer;
+class Mesh;
+
+/*!
+ * \brief Keeps the output of the Slicer around between slices.
+ *
+ * When the front-end reslices a scene after changing a setting that doesn't
+ * influence the slicing itself (a wall count, an infill density, ...), the
+ * meshes, their transformations and the layer heights are all unchanged. The
+ * sliced layers from the previous slice can then be reused instead of slicing
+ * the meshes again.
+ *
+ * The entries are keyed by a hash of the mesh geometry (after it has been
+ * transformed and positioned), the layer height schedule and the settings that
+ * influence slicing. Only the entries that were used by the previous slice are
+ * kept, so that the cache never holds more than two slices' worth of layers.
+ *
+ * The cache is only used if the communication channel can request multiple
+ * slices from the same engine process.
+ *
+ * Within a mesh group, a mesh that is a copy of a mesh that was sliced before,
+ * only moved horizontally, isn't sliced either. Its layers are those of the
+ * other mesh, moved as much. Only the slicing is shared this way. The copies
+ * get their own layers, since carving, support and everything after that
+ * depends on what is around each copy.
+ */
+class SlicerCache : NoCopy
+{
+public:
+    /*!
+     * Get the cache shared by all slices of this engine process.
+     */
+    static SlicerCache& getInstance();
+
+    /*!
+     * \brief Slice a mesh, reusing the layers of an earlier slice if possible.
+     *
+     * The parameters are the same as those of the Slicer constructor.
+     * \return A new slicer, owned by the caller.
+     */
+    Slicer* slice(Mesh* mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers);
+
+    /*!
+     * \brief Mark the start of a new slice.
+     *
+     * Entries created or used during the previous slice remain available. All
+     * older entries are dropped.
+     */
+    void startSlice();
+
+    /*!
+     * \brief Mark the end of a slice.
+     *
+     * Entries from before this slice that it didn't use are dropped.
+     */
+    void finishSlice();
+
+    /*!
+     * \brief Mark the end of slicing the meshes of a mesh group.
+     *
+     * Copies of the meshes that were sliced so far no longer reuse their
+     * layers, since the slicers of those meshes are changed and deleted after
+     * this.
+     */
+    void finishMeshGroup();
+
+    /*!
+     * Drop all entries.
+     */
+    void clear();
+
+private:
+    /*!
+     * \brief A mesh that was sliced in the current mesh group, which copies of it
+     * can reuse the layers of.
+     */
+    struct Instance
+    {
+        Point2LL origin; //!< The minimum X and Y of the mesh.
+        const Slicer* slicer; //!< The sliced layers of the mesh, owned by the caller of \ref SlicerCache::slice.
+    };
+
+    /*!
+     * Slice a mesh, reusing the layers of an earlier slice if possible.
+     */
+    Slicer* sliceOrReuse(Mesh* mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers);
+
+    /*!
+     * \brief Hash all the input of the Slicer that determines its output.
+     * \param origin The horizontal position that the vertices are hashed
+     * relative to, so that copies of the mesh moved by as much as their origin
+     * get the same hash.
+     */
+    static uint64_t hashSlicerInput(const Mesh& mesh, const Point2LL& origin, const coord_t thickness, const size_t slice_layer_count, std::vector<AdaptiveLayer>* adaptive_layers);
+
+    /*!
+     * Whether the current communication channel may ask for another slice in
+     * this process, i.e. whether it is worth keeping entries at all.
+     */
+    static bool isEnabled();
+
+    std::unordered_map<uint64_t, std::vector<SlicerLayer>> entries_; //!< The entries created or used by the current slice.
+    std::unordered_map<uint64_t, std::vector<SlicerLayer>> previous_entries_; //!< The entries of the previous slice that haven't been used yet.
+    std::unordered_map<uint64_t, Instance> instances_; //!< The meshes sliced in the current mesh group, by the hash of their input relative to their origin.
+};
+
+} // namespace cura
+
+#endif // SLICER_CACHE_H
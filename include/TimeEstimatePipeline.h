@@ -0,0 +1,99 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef TIME_ESTIMATE_PIPELINE_H
+#define TIME_ESTIMATE_PIPELINE_H
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "PrintFeature.h"
+#include "settings/types/Duration.h"
+#include "settings/types/Velocity.h"
+#include "timeEstimate.h"
+#include "utils/NoCopy.h"
+#include "utils/SpscQueue.h"
+
+namespace cura
+{
+
+class Settings;
+
+/*!
+ * \brief Estimates the print time on a thread of its own, while the g-code is being written.
+ *
+ * This has the interface of the \ref TimeEstimateCalculator that it wraps. The moves, and the changes to the
+ * acceleration and jerk between them, are handed to the estimation thread through a lock-free queue, so that planning
+ * them doesn't hold up the thread that writes the g-code. Only getting the estimate, resetting it and changing the
+ * firmware settings wait until the estimation thread has caught up.
+ *
+ * Only one thread at a time may call the functions of this class.
+ */
+class TimeEstimatePipeline : public NoCopy
+{
+public:
+    /*!
+     * Stops the estimation thread.
+     */
+    ~TimeEstimatePipeline();
+
+    /*!
+     * \brief Set the movement configuration of the firmware.
+     * \param settings Where to get the settings from.
+     */
+    void setFirmwareDefaults(const Settings& settings);
+
+    void plan(const TimeEstimateCalculator::Position& new_position, const Velocity& feedrate, const PrintFeatureType feature);
+    void addTime(const Duration& time);
+    void setAcceleration(const Acceleration& acceleration); //!< Set the default acceleration to \p acceleration
+    void setMaxXyJerk(const Velocity& jerk); //!< Set the max xy jerk to \p jerk
+
+    void reset();
+
+    /*!
+     * \brief Get the time of everything that was planned since the last reset, per feature.
+     *
+     * This waits until the estimation thread has planned everything.
+     */
+    std::vector<Duration> calculate();
+
+private:
+    //! How many records may wait for the estimation thread: enough for the moves of a few slow seconds of g-code.
+    static constexpr size_t record_capacity = 4096;
+
+    //! A call to the calculator that the estimation thread has to make.
+    struct Record
+    {
+        enum class Type : uint8_t
+        {
+            PLAN,
+            ADD_TIME,
+            SET_ACCELERATION,
+            SET_MAX_XY_JERK,
+            STOP,
+        };
+
+        Type type;
+        PrintFeatureType feature; //!< The feature of the move, for \ref Type::PLAN.
+        double value; //!< The feedrate, time, acceleration or jerk.
+        TimeEstimateCalculator::Position position; //!< Where the move goes, for \ref Type::PLAN.
+    };
+
+    //! Hand a record to the estimation thread, starting it if it isn't running yet.
+    void push(const Record& record);
+
+    //! Wait until the estimation thread has made all calls, so that the calculator may be used directly.
+    void waitUntilEstimated() const;
+
+    //! The loop of the estimation thread, which makes the calls to the calculator until it is stopped.
+    void run();
+
+    TimeEstimateCalculator calculator_; //!< Only touched by the estimation thread, unless it has caught up.
+    SpscQueue<Record, record_capacity> records_; //!< The calls that the estimation thread has yet to make, in order.
+    std::thread thread_; //!< The estimation thread, started when the first record is pushed.
+};
+
+} // namespace cura
+
+#endif // TIME_ESTIMATE_PIPELINE_H
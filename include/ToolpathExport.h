@@ -0,0 +1,156 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef TOOLPATH_EXPORT_H
+#define TOOLPATH_EXPORT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "PrintFeature.h"
+#include "settings/types/LayerIndex.h"
+#include "settings/types/Velocity.h"
+#include "utils/Coord_t.h"
+#include "utils/NoCopy.h"
+#include "utils/Point2LL.h"
+#include "utils/Point3LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Writes the toolpaths of the layers as flat binary columns, for tools that analyse or simulate them.
+ *
+ * Parsing g-code back is slow and loses the line widths and feature types, so this writes what the layer view gets
+ * in a PathSegment message, as one file per field in a directory. Every file is a plain array of numbers in the byte
+ * order of the machine (little-endian on every platform that Cura runs on), without a header, so that it can be
+ * memory-mapped and read as an array right away.
+ *
+ * Per layer, with one element for each layer in the order in which they were written:
+ * - layer_index.i32: the layer number, which is negative for raft layers.
+ * - layer_z.f32: the height of the layer in mm.
+ * - layer_thickness.f32: the thickness of the layer in mm.
+ * - layer_start.f32: the X, Y and Z in mm of where the nozzle is when the layer starts.
+ * - layer_segment_offset.u64: the index of the first segment of the layer. It has one more element than there are
+ *   layers, the last of which is the number of segments of all layers.
+ *
+ * Per segment, which is a straight move from the end of the previous segment of the layer, or from the start of the
+ * layer, to its own end:
+ * - points.f32: the X, Y and Z in mm of the end of the segment.
+ * - line_type.u8: the \ref PrintFeatureType of the segment. Travel moves are MoveCombing or MoveRetraction.
+ * - extruder.u8: the extruder that prints the segment.
+ * - line_width.f32: the width in mm of the line that is printed, or 0 for a travel move.
+ * - line_thickness.f32: the thickness in mm of the line that is printed.
+ * - line_feedrate.f32: the speed of the nozzle in mm/s.
+ * - line_flow.f32: the volume of material in mm³ that is extruded per mm of the segment.
+ *
+ * The segments are the paths as planned. Coasting and spiralizing change the g-code slightly afterwards.
+ *
+ * Only one thread at a time may use this.
+ */
+class ToolpathExport : public NoCopy
+{
+public:
+    /*!
+     * \brief Start writing the toolpaths to a directory, replacing what was there.
+     *
+     * The directory is created if it doesn't exist yet. Toolpaths that were being written before are finished first.
+     * \param directory The directory to write the files to.
+     * \return Whether all of the files could be opened.
+     */
+    bool open(const std::filesystem::path& directory);
+
+    //! Whether the toolpaths are being written.
+    [[nodiscard]] bool isOpen() const;
+
+    /*!
+     * \brief Write the last layer and close the files.
+     */
+    void close();
+
+    /*!
+     * \brief Start collecting the toolpaths of a layer.
+     *
+     * The layer that was collected before is written first.
+     * \param layer_nr The number of the layer.
+     * \param z The height of the layer.
+     * \param thickness The thickness of the layer.
+     * \param start Where the nozzle is when the layer starts.
+     */
+    void beginLayer(const LayerIndex layer_nr, const coord_t z, const coord_t thickness, const Point3LL& start);
+
+    /*!
+     * \brief Add the segments of a path to the layer, going from the end of the previous segment to each of the points.
+     * \param type The feature that the path prints, or the kind of travel move.
+     * \param extruder_nr The extruder that prints the path.
+     * \param points The points to go to, in order.
+     * \param z The height of the path.
+     * \param line_width The width of the line that is printed, or 0 for a travel move.
+     * \param line_thickness The thickness of the line that is printed.
+     * \param speed The speed of the nozzle.
+     * \param flow The volume of material in mm³ that is extruded per mm.
+     */
+    void addPath(
+        const PrintFeatureType type,
+        const size_t extruder_nr,
+        const std::vector<Point2LL>& points,
+        const coord_t z,
+        const coord_t line_width,
+        const coord_t line_thickness,
+        const Velocity& speed,
+        const double flow);
+
+private:
+    //! The columns that have one element per layer, for the layer that is being collected.
+    struct LayerColumns
+    {
+        std::vector<int32_t> index;
+        std::vector<float> z;
+        std::vector<float> thickness;
+        std::vector<float> start;
+    };
+
+    //! The columns that have one element per segment, for the layer that is being collected.
+    struct SegmentColumns
+    {
+        std::vector<float> points;
+        std::vector<uint8_t> line_type;
+        std::vector<uint8_t> extruder;
+        std::vector<float> line_width;
+        std::vector<float> line_thickness;
+        std::vector<float> line_feedrate;
+        std::vector<float> line_flow;
+    };
+
+    //! Append the values of a column to its file.
+    template<typename T>
+    void write(std::ofstream& file, const std::vector<T>& values);
+
+    //! Write the layer that was collected, if any, and start over.
+    void writeLayer();
+
+    bool open_ = false; //!< Whether the files are open.
+    bool layer_begun_ = false; //!< Whether a layer is being collected.
+    uint64_t segment_count_ = 0; //!< How many segments were written before the layer that is being collected.
+    LayerColumns layer_;
+    SegmentColumns segments_;
+
+    std::ofstream layer_index_file_;
+    std::ofstream layer_z_file_;
+    std::ofstream layer_thickness_file_;
+    std::ofstream layer_start_file_;
+    std::ofstream layer_segment_offset_file_;
+    std::ofstream points_file_;
+    std::ofstream line_type_file_;
+    std::ofstream extruder_file_;
+    std::ofstream line_width_file_;
+    std::ofstream line_thickness_file_;
+    std::ofstream line_feedrate_file_;
+    std::ofstream line_flow_file_;
+};
+
+} // namespace cura
+
+#endif // TOOLPATH_EXPORT_H
@@ -4,8 +4,15 @@
 #ifndef TREEMODELVOLUMES_H
 #define TREEMODELVOLUMES_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <future>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -13,6 +20,7 @@
 #include "settings/EnumSettings.h" //To store whether X/Y or Z distance gets priority.
 #include "settings/types/LayerIndex.h" //Part of the RadiusLayerPair.
 #include "sliceDataStorage.h"
+#include "utils/ShardedCache.h"
 #include "utils/Simplify.h"
 #include "utils/polygon.h" //For polygon parameters.
 
@@ -54,6 +62,8 @@ public:
      * This uses knowledge about branch angle to only calculate avoidances and collisions that could actually be needed.
      * Not calling this will cause the class to lazily calculate avoidances and collisions as needed, which will be a lot slower on systems with more then one or two cores!
      *
+     * The avoidances (apart from the collision avoidance) are only planned here: the avoidances of a radius are calculated up to the layer it could be needed on when that
+     * radius is first requested, see calculateAvoidanceOnDemand. Radii that no branch grows into are never calculated.
      */
     void precalculate(coord_t max_layer);
 
@@ -127,6 +137,43 @@ public:
      */
     const Polygons& getWallRestriction(coord_t radius, LayerIndex layer_idx, bool min_xy_dist);
 
+    /*!
+     * \brief Estimate how much memory the precalculated avoidance areas (apart from the collision avoidance) take up.
+     * \return The number of bytes taken up by the points of the areas.
+     */
+    size_t getAvoidanceFootprint() const;
+
+    /*!
+     * \brief Estimate how much memory the avoidances that were calculated when they were first requested take up, see precalculate.
+     * \return The number of bytes taken up by the points of the areas, not counting any that were dropped since.
+     */
+    size_t getOnDemandAvoidanceFootprint() const;
+
+    /*!
+     * \brief Drop the precalculated avoidance areas (apart from the collision avoidance) of a layer, to free their memory.
+     *
+     * If they are requested after all, they are calculated again. Any references to them become invalid, so this may only be
+     * called when no other thread is using these volumes.
+     * \param layer_idx The layer of which to drop the areas.
+     * \return The number of bytes that were freed, estimated the same way as getAvoidanceFootprint.
+     */
+    size_t evictAvoidance(LayerIndex layer_idx);
+
+    /*!
+     * \brief How the areas that were requested from these volumes were served.
+     */
+    struct CacheStatistics
+    {
+        size_t hits = 0; //!< Requests of areas that were already calculated.
+        size_t misses = 0; //!< Requests of areas that had to be calculated first, because precalculate did not cover them.
+        double compute_time = 0.0; //!< Seconds spent calculating the areas of the misses, including areas those depended on.
+    };
+
+    /*!
+     * \brief Get how the areas requested since construction were served.
+     */
+    CacheStatistics getCacheStatistics() const;
+
     /*!
      * \brief Round \p radius upwards to either a multiple of radius_sample_resolution_ or a exponentially increasing value
      *
@@ -308,6 +355,25 @@ private:
         calculateAvoidanceToModel(std::deque<RadiusLayerPair>{ RadiusLayerPair(key) });
     }
 
+    /*!
+     * \brief Calculate the avoidances of a radius that precalculate planned up to the requested layer, or wait for the thread that is calculating them.
+     *
+     * The avoidances of the next larger planned radius are calculated up to the same layer along with them, as branches grow into that radius on the layers below.
+     * \param radius The radius of the requested avoidance, as used in its key.
+     * \param layer_idx The layer of the requested avoidance.
+     * \return Whether the requested avoidance was planned and is now calculated. If not, it has to be calculated as usual.
+     */
+    bool calculateAvoidanceOnDemand(coord_t radius, LayerIndex layer_idx);
+
+    /*!
+     * \brief Estimate how much memory the avoidances of a radius take up on a range of layers.
+     * \param radius The radius of the avoidances.
+     * \param first_layer The first layer of the range.
+     * \param last_layer The last layer of the range, which is included.
+     * \return The number of bytes taken up by the points of the areas.
+     */
+    size_t getAvoidanceFootprint(coord_t radius, LayerIndex first_layer, LayerIndex last_layer) const;
+
     /*!
      * \brief Creates the areas that can not be passed when expanding an area downwards. As such these areas are an somewhat abstract representation of a wall (as in a printed
      * object).
@@ -331,15 +397,17 @@ private:
         calculateWallRestrictions(std::deque<RadiusLayerPair>{ RadiusLayerPair(key) });
     }
 
+    bool checkSettingsEquality(const Settings& me, const Settings& other) const;
+
     /*!
-     * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
-     * \param key RadiusLayerPair of the requested areas. The radius will be calculated up to the provided layer.
-     * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
+     * \brief Hash the outlines and the other input that the collision areas are calculated from, apart from the settings in collision_setting_keys.
      */
-    template<typename KEY>
-    const std::optional<std::reference_wrapper<const Polygons>> getArea(const std::unordered_map<KEY, Polygons>& cache, const KEY key) const;
+    uint64_t hashCollisionInput() const;
 
-    bool checkSettingsEquality(const Settings& me, const Settings& other) const;
+    /*!
+     * \brief Hash the outlines and the other input that the cached areas are calculated from, apart from the tree support settings.
+     */
+    uint64_t hashInput() const;
 
     /*!
      * \brief Get the highest already calculated layer in the cache.
@@ -348,7 +416,7 @@ private:
      *
      * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
      */
-    LayerIndex getMaxCalculatedLayer(coord_t radius, const std::unordered_map<RadiusLayerPair, Polygons>& map) const;
+    LayerIndex getMaxCalculatedLayer(coord_t radius, const ShardedCache<RadiusLayerPair, Polygons>& map) const;
 
     static Polygons calculateMachineBorderCollision(const Polygons&& machine_border);
 
@@ -452,6 +520,31 @@ private:
      */
     std::unordered_set<coord_t> ignorable_radii_;
 
+    /*!
+     * \brief The radii for which precalculate planned avoidance areas, so which evictAvoidance has to drop.
+     */
+    std::vector<coord_t> avoidance_radii_;
+
+    /*!
+     * \brief The avoidances of one radius that precalculate planned.
+     */
+    struct AvoidanceDemand
+    {
+        LayerIndex max_layer; //!< The layer up to which the avoidances could be needed.
+        LayerIndex calculated_layer = 0; //!< The layer up to which they were calculated on demand.
+        bool calculating = false; //!< Whether a thread is calculating more layers of them.
+    };
+
+    /*!
+     * \brief The planned avoidances by radius. Guarded by the lock of the thread pool, so that threads waiting for them can help with other tasks meanwhile.
+     */
+    std::map<coord_t, AvoidanceDemand> avoidance_demand_;
+
+    /*!
+     * \brief How much memory the avoidances calculated on demand take up, estimated like getAvoidanceFootprint. Guarded by the lock of the thread pool.
+     */
+    size_t on_demand_footprint_ = 0;
+
     /*!
      * \brief Smallest radius a branch can have. This is the radius of a SupportElement with DTT=0.
      */
@@ -462,64 +555,111 @@ private:
      */
     RestPreference support_rest_preference_;
 
+public:
+    /*!
+     * \brief Caches for the collision and areas on the model where support can be placed safely at given radius and layer indices.
+     *
+     * The branches look up areas from many threads at once, so each cache is sharded to keep them from waiting on each other.
+     *
+     * These areas only depend on the outlines and the distances between support and model, not on how the branches move or grow, so volumes constructed from the same
+     * outlines share them even if their branch settings differ, also between slices. See TreeModelVolumesCache.
+     */
+    struct CollisionCaches
+    {
+        ShardedCache<RadiusLayerPair, Polygons> collision_cache_;
+
+        ShardedCache<LayerIndex, Polygons> accumulated_placeables_cache_radius_0_;
+
+        ShardedCache<RadiusLayerPair, Polygons> placeable_areas_cache_;
+
+        /*!
+         * \brief Caches to represent walls not allowed to be passed over.
+         */
+        ShardedCache<RadiusLayerPair, Polygons> wall_restrictions_cache_;
+
+        // A different cache for min_xy_dist as the maximal safe distance an influence area can be increased(guaranteed overlap of two walls in consecutive layer) is much smaller when
+        // min_xy_dist is used. This causes the area of the wall restriction to be thinner and as such just using the min_xy_dist wall restriction would be slower.
+        ShardedCache<RadiusLayerPair, Polygons> wall_restrictions_cache_min_;
+    };
+
     /*!
-     * \brief Caches for the collision, avoidance and areas on the model where support can be placed safely
-     * at given radius and layer indices.
+     * \brief Caches for the avoidance at given radius and layer indices.
      *
-     * These are mutable to allow modification from const function. This is
-     * generally considered OK as the functions are still logically const
-     * (ie there is no difference in behaviour for the user between
-     * calculating the values each time vs caching the results).
+     * The areas depend on all outlines and settings that the volumes were constructed with, so only volumes constructed from the same ones share these caches, even
+     * between slices. See TreeModelVolumesCache.
      */
-    mutable std::unordered_map<RadiusLayerPair, Polygons> collision_cache_;
-    std::unique_ptr<std::mutex> critical_collision_cache_ = std::make_unique<std::mutex>();
+    struct Caches
+    {
+        ShardedCache<RadiusLayerPair, Polygons> collision_cache_holefree_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> collision_cache_holefree_;
-    std::unique_ptr<std::mutex> critical_collision_cache_holefree_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_collision_;
 
-    mutable std::unordered_map<LayerIndex, Polygons> accumulated_placeables_cache_radius_0_;
-    std::unique_ptr<std::mutex> critical_accumulated_placeables_cache_radius_0_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_collision_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_collision_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_slow_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_to_model_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_slow_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_slow_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_to_model_slow_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_to_model_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_to_model_ = std::make_unique<std::mutex>();
+        /*!
+         * \brief Caches to avoid holes smaller than the radius until which the radius is always increased, as they are free of holes. Also called safe avoidances, as they are safe
+         * regarding not running into holes.
+         */
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_hole_;
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_to_model_slow_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_to_model_slow_ = std::make_unique<std::mutex>();
+        ShardedCache<RadiusLayerPair, Polygons> avoidance_cache_hole_to_model_;
+    };
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> placeable_areas_cache_;
-    std::unique_ptr<std::mutex> critical_placeable_areas_cache_ = std::make_unique<std::mutex>();
+    /*!
+     * \brief The settings of a group of meshes that the collision areas depend on, apart from the values that the volumes derive from them.
+     */
+    static constexpr std::array<std::string_view, 8> collision_setting_keys{ "support_type",
+                                                                            "support_xy_distance",
+                                                                            "support_bottom_distance",
+                                                                            "support_top_distance",
+                                                                            "layer_height",
+                                                                            "meshfix_maximum_resolution",
+                                                                            "meshfix_maximum_deviation",
+                                                                            "meshfix_maximum_extrusion_area_deviation" };
 
+private:
     /*!
-     * \brief Caches to avoid holes smaller than the radius until which the radius is always increased, as they are free of holes. Also called safe avoidances, as they are safe
-     * regarding not running into holes.
+     * \brief The collision caches of these volumes, which may be shared with the volumes of other slices.
      */
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_hole_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_holefree_ = std::make_unique<std::mutex>();
+    std::shared_ptr<CollisionCaches> collision_caches_ = std::make_shared<CollisionCaches>();
 
-    mutable std::unordered_map<RadiusLayerPair, Polygons> avoidance_cache_hole_to_model_;
-    std::unique_ptr<std::mutex> critical_avoidance_cache_holefree_to_model_ = std::make_unique<std::mutex>();
+    /*!
+     * \brief The avoidance caches of these volumes, which may be shared with the volumes of other slices.
+     */
+    std::shared_ptr<Caches> caches_ = std::make_shared<Caches>();
+
+    std::unique_ptr<std::mutex> critical_progress_ = std::make_unique<std::mutex>();
 
     /*!
-     * \brief Caches to represent walls not allowed to be passed over.
+     * \brief The counters behind getCacheStatistics. An area that is found after it was calculated for a miss is counted as found as well.
      */
-    mutable std::unordered_map<RadiusLayerPair, Polygons> wall_restrictions_cache_;
-    std::unique_ptr<std::mutex> critical_wall_restrictions_cache_ = std::make_unique<std::mutex>();
+    struct CacheCounters
+    {
+        std::atomic<size_t> found{ 0 };
+        std::atomic<size_t> misses{ 0 };
+        std::atomic<int64_t> compute_nanoseconds{ 0 };
+    };
 
-    // A different cache for min_xy_dist as the maximal safe distance an influence area can be increased(guaranteed overlap of two walls in consecutive layer) is much smaller when
-    // min_xy_dist is used. This causes the area of the wall restriction to be thinner and as such just using the min_xy_dist wall restriction would be slower.
-    mutable std::unordered_map<RadiusLayerPair, Polygons> wall_restrictions_cache_min_;
-    std::unique_ptr<std::mutex> critical_wall_restrictions_cache_min_ = std::make_unique<std::mutex>();
+    std::unique_ptr<CacheCounters> cache_counters_ = std::make_unique<CacheCounters>();
 
-    std::unique_ptr<std::mutex> critical_progress_ = std::make_unique<std::mutex>();
+    /*!
+     * \brief Calculate an area that was requested but not found, counting it as a miss.
+     * \param calculate Calculates the area and saves it in its cache.
+     */
+    template<typename Calculate>
+    void calculateMissing(Calculate&& calculate)
+    {
+        cache_counters_->misses++;
+        const auto start = std::chrono::steady_clock::now();
+        calculate();
+        cache_counters_->compute_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
 
     Simplify simplifier_ = Simplify(0, 0, 0); // a simplifier to simplify polygons. Will be properly initialised in the constructor.
 };
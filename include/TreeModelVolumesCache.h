@@ -0,0 +1,117 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef TREE_MODEL_VOLUMES_CACHE_H
+#define TREE_MODEL_VOLUMES_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TreeModelVolumes.h"
+#include "TreeSupportSettings.h"
+#include "utils/NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Keeps the collision and avoidance areas of tree support around between slices.
+ *
+ * Precalculating the volumes that the branches of tree support have to avoid often takes longer than the rest of the
+ * slice. They only depend on the outlines of the models, the support blockers and the tree support settings, so when the
+ * front-end reslices a scene after changing an unrelated setting, like the infill density, the areas of the previous
+ * slice can be used again. When only the settings of the branches changed, like their angle or diameter, the collision
+ * areas can still be used again, as they only depend on the outlines and the distances between support and model.
+ *
+ * The entries are keyed by a hash of the outlines and of the other input of the volumes. For the avoidance, the tree
+ * support settings of each group of meshes are compared in full, the same way the volumes group meshes. For the
+ * collision, only the settings in TreeModelVolumes::collision_setting_keys are compared. Like the SlicerCache, only the
+ * entries that were used by the previous slice are kept, and nothing is kept between slices unless the communication
+ * channel can request multiple slices from the same engine process.
+ */
+class TreeModelVolumesCache : NoCopy
+{
+public:
+    /*!
+     * Get the cache shared by all slices of this engine process.
+     */
+    static TreeModelVolumesCache& getInstance();
+
+    /*!
+     * \brief Get the areas of volumes with the given input, or new empty caches if no volumes had that input before.
+     *
+     * \param key The hash of the input of the volumes, see TreeModelVolumes::hashInput.
+     * \param settings The settings of each group of meshes of the volumes.
+     * \return The caches, which are shared with any other volumes with the same input.
+     */
+    std::shared_ptr<TreeModelVolumes::Caches> get(const uint64_t key, const std::vector<Settings>& settings);
+
+    /*!
+     * \brief Get the collision areas of volumes with the given outlines, or new empty caches if no volumes had those outlines before.
+     *
+     * \param key The hash of the outlines of the volumes, see TreeModelVolumes::hashCollisionInput.
+     * \param settings The settings of each group of meshes of the volumes.
+     * \return The caches, which are shared with any other volumes with the same outlines.
+     */
+    std::shared_ptr<TreeModelVolumes::CollisionCaches> getCollisionCaches(const uint64_t key, const std::vector<Settings>& settings);
+
+    /*!
+     * \brief Mark the start of a new slice.
+     *
+     * Entries created or used during the previous slice remain available. All older entries are dropped.
+     */
+    void startSlice();
+
+    /*!
+     * \brief Mark the end of a slice.
+     *
+     * Entries from before this slice that it didn't use are dropped.
+     */
+    void finishSlice();
+
+    /*!
+     * Drop all entries.
+     */
+    void clear();
+
+private:
+    struct Entry
+    {
+        /*!
+         * The tree support settings of each group of meshes. Their settings containers are detached from the scene, so
+         * that they can still be compared after the scene they came from is gone.
+         */
+        std::vector<TreeSupportSettings> settings;
+        std::shared_ptr<TreeModelVolumes::Caches> caches;
+    };
+
+    struct CollisionEntry
+    {
+        std::vector<std::vector<std::string>> settings; //!< The values of TreeModelVolumes::collision_setting_keys of each group of meshes.
+        std::shared_ptr<TreeModelVolumes::CollisionCaches> caches;
+    };
+
+    /*!
+     * Whether the settings of an entry are those of the given groups of meshes.
+     */
+    static bool matches(const Entry& entry, const std::vector<Settings>& settings);
+
+    /*!
+     * The values of TreeModelVolumes::collision_setting_keys of each group of meshes.
+     */
+    static std::vector<std::vector<std::string>> collisionSettings(const std::vector<Settings>& settings);
+
+    std::mutex mutex_; //!< Guards the entries.
+    std::unordered_map<uint64_t, Entry> entries_; //!< The entries created or used by the current slice.
+    std::unordered_map<uint64_t, Entry> previous_entries_; //!< The entries of the previous slice that haven't been used yet.
+    std::unordered_map<uint64_t, CollisionEntry> collision_entries_; //!< The collision entries created or used by the current slice.
+    std::unordered_map<uint64_t, CollisionEntry> previous_collision_entries_; //!< The collision entries of the previous slice that haven't been used yet.
+};
+
+} // namespace cura
+
+#endif // TREE_MODEL_VOLUMES_CACHE_H
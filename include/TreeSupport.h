@@ -14,6 +14,8 @@
 #include "settings/EnumSettings.h"
 #include "sliceDataStorage.h"
 #include "utils/Coord_t.h"
+#include "utils/ShardedCache.h"
+#include "utils/gettime.h"
 #include "utils/polygon.h"
 
 namespace cura
@@ -41,10 +43,17 @@ constexpr coord_t SUPPORT_TREE_EXPONENTIAL_THRESHOLD = 1000;
 constexpr auto SUPPORT_TREE_EXPONENTIAL_FACTOR = 1.5;
 constexpr size_t SUPPORT_TREE_PRE_EXPONENTIAL_STEPS = 1;
 constexpr coord_t SUPPORT_TREE_COLLISION_RESOLUTION = 500; // Only has an effect if SUPPORT_TREE_USE_EXPONENTIAL_COLLISION_RESOLUTION is false
+constexpr coord_t SUPPORT_TREE_CLIPPING_TILE_SIZE = 10000; // Size of the tiles that influence areas near each other share when they are clipped with the same avoidance.
+constexpr size_t SUPPORT_TREE_AVOIDANCE_MEMORY_BUDGET = 2048UL * 1024 * 1024; // Above this many bytes, avoidance areas of layers that were already pathed are dropped.
 
 using PropertyAreasUnordered = std::unordered_map<TreeSupportElement, Polygons>;
 using PropertyAreas = std::map<TreeSupportElement, Polygons>;
 
+/*!
+ * Tiles cut from the avoidance and collision areas that the influence areas of a layer are clipped with, by the area they were cut from and the tile coordinates.
+ */
+using ClippingTiles = ShardedCache<std::pair<const Polygons*, Point2LL>, Polygons>;
+
 struct FakeRoofArea
 {
     FakeRoofArea(Polygons area, coord_t line_distance, bool fractional)
@@ -180,6 +189,7 @@ private:
      * user-supplied settings. \param overspeed[in] How much should the already offset area be offset again. Usually this is 0. \param mergelayer[in] Will the merge method be
      * called on this layer. This information is required as some calculation can be avoided if they are not required for merging. \return A valid support element for the next
      * layer regarding the calculated influence areas. Empty if no influence are can be created using the supplied influence area and settings.
+     * \param clipping_tiles[in,out] The tiles of the avoidances and collisions of this layer, shared by all influence areas of the layer. See getClippingTile.
      */
     std::optional<TreeSupportElement> increaseSingleArea(
         AreaIncreaseSettings settings,
@@ -190,7 +200,22 @@ private:
         Polygons& to_model_data,
         Polygons& increased,
         const coord_t overspeed,
-        const bool mergelayer);
+        const bool mergelayer,
+        ClippingTiles& clipping_tiles);
+
+    /*!
+     * \brief Get the part of an avoidance or collision that is relevant when clipping an influence area or branch area with it.
+     *
+     * Many influence areas of a layer have the same ceiled radius, so they are clipped with the same avoidance, which may cover the whole build plate. Instead of clipping
+     * each of them with all of it, the avoidance is cut into tiles, each of which is only cut out once and shared by all influence areas within it.
+     *
+     * \param area[in] The area that will be clipped.
+     * \param clipping_area[in] The avoidance or collision it will be clipped with. It has to stay valid for as long as \p clipping_tiles is used.
+     * \param clipping_tiles[in,out] The tiles that were cut so far.
+     * \return The tile of \p clipping_area around \p area, or all of \p clipping_area if \p area is too large for a tile. Clipping \p area with either gives the same result,
+     * apart from rounding.
+     */
+    static const Polygons& getClippingTile(const Polygons& area, const Polygons& clipping_area, ClippingTiles& clipping_tiles);
 
     /*!
      * \brief Increases influence areas as far as required.
@@ -310,6 +335,22 @@ private:
      */
     void drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bounds, SliceDataStorage& storage);
 
+    /*!
+     * \brief Count the influence areas of a phase, to report them with the time the phases took.
+     * \param phase The phase after which the areas are counted.
+     * \param move_bounds[in] All currently existing influence areas.
+     */
+    void countElements(const std::string& phase, const std::vector<std::set<TreeSupportElement*>>& move_bounds);
+
+    /*!
+     * \brief Log the time each phase took for a mesh group, with the element counts and how the volumes were served.
+     *
+     * If the environment variable CURA_ENGINE_TREE_SUPPORT_STATS names a file, the same is also appended to it as one line of JSON per mesh group.
+     * \param group_idx The index of the mesh group that was processed.
+     * \param layer_count The number of layers that the support of the mesh group spans.
+     */
+    void reportStatistics(size_t group_idx, size_t layer_count) const;
+
     /*!
      * \brief Settings with the indexes of meshes that use these settings.
      */
@@ -347,6 +388,16 @@ private:
      * Required for the progress bar the behave as expected when areas have to be calculated multiple times
      */
     double progress_offset = 0;
+
+    /*!
+     * \brief Measures the phases of the mesh group that is being processed.
+     */
+    TimeKeeper time_keeper_;
+
+    /*!
+     * \brief The number of influence areas after each phase of the mesh group that is being processed.
+     */
+    std::vector<std::pair<std::string, size_t>> element_counts_;
 };
 
 
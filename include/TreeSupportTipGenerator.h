@@ -56,6 +56,26 @@ private:
 
     using LineInformation = std::vector<std::pair<Point2LL, TreeSupportTipGenerator::LineStatus>>;
 
+    /*!
+     * \brief The tips and roof areas generated from the overhang of one layer.
+     *
+     * Each layer of overhang is processed by one thread, which adds what it generates to the buffer of that layer without locking. The buffers are added to the shared
+     * storage once all layers are processed.
+     */
+    struct TipBuffer
+    {
+        struct Tip
+        {
+            LayerIndex layer; //!< The layer the tip is inserted on.
+            Point2LL position; //!< The point the tip was generated for.
+            TreeSupportElement* element;
+        };
+
+        std::vector<Tip> tips;
+        std::vector<std::pair<LayerIndex, Polygons>> roof_tips; //!< Areas to add to roof_tips_drawn_.
+        std::vector<std::pair<LayerIndex, Polygons>> roof_tips_fractional; //!< Areas to add to support_roof_drawn_fractional_.
+    };
+
     /*!
      * \brief Converts a Polygons object representing a line into the internal format.
      *
@@ -131,7 +151,7 @@ private:
 
     /*!
      * \brief Add a point as a tip
-     * \param move_bounds[out] The storage for the tips.
+     * \param buffer[out] The buffer of the layer that is being processed.
      * \param p[in] The point that will be added and its LineStatus.
      * \param dtt[in] The distance to top the added tip will have.
      * \param insert_layer[in] The layer the tip will be on.
@@ -140,7 +160,7 @@ private:
      * \param skip_ovalisation[in] Whether the tip may be ovalized when drawn later.
      */
     void addPointAsInfluenceArea(
-        std::vector<std::set<TreeSupportElement*>>& move_bounds,
+        TipBuffer& buffer,
         std::pair<Point2LL, LineStatus> p,
         size_t dtt,
         LayerIndex insert_layer,
@@ -152,7 +172,7 @@ private:
 
     /*!
      * \brief Add all points of a line as a tip
-     * \param move_bounds[out] The storage for the tips.
+     * \param buffer[out] The buffer of the layer that is being processed.
      * \param lines[in] The lines of which points will be added.
      * \param roof_tip_layers[in] Amount of layers the tip should be drawn as roof.
      * \param insert_layer_idx[in] The layer the tip will be on.
@@ -160,7 +180,7 @@ private:
      * \param dont_move_until[in] Until which dtt the branch should not move if possible.
      */
     void addLinesAsInfluenceAreas(
-        std::vector<std::set<TreeSupportElement*>>& move_bounds,
+        TipBuffer& buffer,
         std::vector<TreeSupportTipGenerator::LineInformation> lines,
         size_t roof_tip_layers,
         LayerIndex insert_layer_idx,
@@ -307,9 +327,6 @@ private:
      * \brief Areas that will be saved as support roof, originating from tips being replaced with roof areas.
      */
     std::vector<Polygons> roof_tips_drawn_;
-
-    std::mutex critical_move_bounds_;
-    std::mutex critical_roof_tips_;
 };
 
 } // namespace cura
@@ -14,6 +14,9 @@
 
 namespace cura
 {
+class TimeKeeper;
+class WallToolPathsCache;
+
 class WallToolPaths
 {
 public:
@@ -99,6 +102,20 @@ public:
      */
     static bool removeEmptyToolPaths(std::vector<VariableWidthLines>& toolpaths);
 
+    /*!
+     * Take the toolpaths from, and add them to, a cache of the walls of earlier outlines. If the outline is in the cache,
+     * generating the toolpaths only copies them from the cache.
+     * \param cache The cache, which must only be used with the same settings as these toolpaths, or nullptr for none.
+     */
+    void setCache(WallToolPathsCache* cache);
+
+    /*!
+     * Register how long each stage of generating the toolpaths takes, such as the construction of the Voronoi diagram
+     * or the simplification, as a separate stage in a time keeper. Toolpaths found in the cache register no stages.
+     * \param time_keeper The time keeper, or nullptr to not keep time.
+     */
+    void setTimeKeeper(TimeKeeper* time_keeper);
+
 protected:
     /*!
      * Stitch the polylines together and form closed polygons.
@@ -121,6 +138,25 @@ protected:
      */
     static void simplifyToolPaths(std::vector<VariableWidthLines>& toolpaths, const Settings& settings);
 
+    /*!
+     * Whether the walls of an outline are the same as inward offsets of it. That is when the outline is thick enough
+     * everywhere to fit all walls at their nominal width on both sides, and has no convex corners so sharp that the
+     * walls would have to narrow down into them.
+     * \param outline The prepared outline to generate the walls in.
+     * \param beading_strategy The beading strategy to generate the walls with.
+     * \param inset_count The maximum number of walls.
+     * \param allowed_deviation How far the walls may be from the walls that the skeletal trapezoidation would make.
+     */
+    static bool hasUniformWalls(const Polygons& outline, const BeadingStrategy& beading_strategy, const size_t inset_count, const coord_t allowed_deviation);
+
+    /*!
+     * Generates the toolpaths as inward offsets of the outline, each with the constant width of its bead. Only gives
+     * the same walls as the skeletal trapezoidation if \ref hasUniformWalls is true for the outline.
+     * \param outline The prepared outline to generate the walls in.
+     * \param beading_strategy The beading strategy to generate the walls with.
+     */
+    void generateByOffsets(const Polygons& outline, const BeadingStrategy& beading_strategy);
+
 private:
     const Polygons& outline_; //<! A reference to the outline polygon that is the designated area
     coord_t bead_width_0_; //<! The nominal or first extrusion line width with which libArachne generates its walls
@@ -139,6 +175,13 @@ private:
     const Settings& settings_;
     int layer_idx_;
     SectionType section_type_;
+    WallToolPathsCache* cache_ = nullptr; //<! Where to look up and remember the toolpaths of outlines, if anywhere
+    TimeKeeper* time_keeper_ = nullptr; //<! Where to register how long each stage of generating the toolpaths takes, if anywhere
+
+    /*!
+     * Register the time since the previous stage in the time keeper, if there is one.
+     */
+    void registerTime(const std::string& stage);
 };
 } // namespace cura
 
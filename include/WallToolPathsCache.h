@@ -0,0 +1,135 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef CURAENGINE_WALLTOOLPATHSCACHE_H
+#define CURAENGINE_WALLTOOLPATHSCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "utils/Coord_t.h"
+#include "utils/ExtrusionLine.h"
+#include "utils/NoCopy.h"
+#include "utils/polygon.h"
+#include "utils/section_type.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Remembers the walls generated for recent outlines, so that the walls of an outline that comes up again don't
+ * have to be generated again.
+ *
+ * Many models have stretches of layers with the same cross section, like the sides of a box or a cylinder. Their walls
+ * are the same on every one of those layers, and generating them is one of the most expensive steps of slicing. An
+ * outline that is the same as an earlier one except for where it is gets the walls of the earlier one, moved along.
+ *
+ * The walls also depend on the settings that WallToolPaths reads, which are not part of what is compared. All
+ * WallToolPaths that use the same cache must therefore get the same settings, which is why there is a cache for each
+ * mesh.
+ *
+ * The cache can be used from several threads at once.
+ */
+class WallToolPathsCache : public NoCopy
+{
+public:
+    //! The parameters of WallToolPaths that differ between its uses for the same mesh.
+    struct Parameters
+    {
+        coord_t bead_width_0;
+        coord_t bead_width_x;
+        size_t inset_count;
+        coord_t wall_0_inset;
+        SectionType section_type;
+
+        bool operator==(const Parameters& other) const = default;
+    };
+
+    //! How many outlines to remember by default, enough for the stretches of layers that the walls are generated for at once.
+    static constexpr size_t default_capacity = 32;
+
+    /*!
+     * \param capacity How many outlines to remember. When it is full, the outline that was added first is forgotten.
+     */
+    explicit WallToolPathsCache(const size_t capacity = default_capacity);
+
+    /*!
+     * \brief Changes how many outlines to remember.
+     *
+     * If there are more, the ones that were added first are forgotten.
+     */
+    void setCapacity(const size_t capacity);
+
+    /*!
+     * \brief Looks up the walls of an outline.
+     *
+     * \param outline The outline to find the walls of.
+     * \param parameters The parameters to generate the walls with.
+     * \param[out] toolpaths The walls of the outline, if they were found. Binned by inset_idx.
+     * \param[out] inner_contour The inner contour of the walls, if they were found.
+     * \return Whether the walls were found.
+     */
+    bool find(const Polygons& outline, const Parameters& parameters, std::vector<VariableWidthLines>& toolpaths, Polygons& inner_contour);
+
+    /*!
+     * \brief Remembers the walls of an outline.
+     *
+     * \param outline The outline that the walls were generated for.
+     * \param parameters The parameters that the walls were generated with.
+     * \param toolpaths The walls of the outline. Binned by inset_idx.
+     * \param inner_contour The inner contour of the walls.
+     */
+    void insert(const Polygons& outline, const Parameters& parameters, const std::vector<VariableWidthLines>& toolpaths, const Polygons& inner_contour);
+
+    //! How many times find found the walls.
+    size_t hitCount() const;
+
+    //! How many times find didn't find the walls.
+    size_t missCount() const;
+
+private:
+    //! The walls of one outline, all moved so that the bounding box of the outline starts at the origin.
+    struct Entry
+    {
+        uint64_t hash;
+        Parameters parameters;
+        Polygons outline;
+        std::vector<VariableWidthLines> toolpaths;
+        Polygons inner_contour;
+    };
+
+    /*!
+     * \brief Gives the point that an outline is moved by to compare it, which is the lower left corner of its bounding
+     * box.
+     */
+    static Point2LL origin(const Polygons& outline);
+
+    //! Gives a hash of an outline, moved to the origin, and the parameters, to quickly skip most entries that differ.
+    static uint64_t hash(const Polygons& outline, const Point2LL& origin, const Parameters& parameters);
+
+    //! Whether \p outline, moved by \p -origin, is the same as \p normalized_outline.
+    static bool sameOutline(const Polygons& outline, const Point2LL& origin, const Polygons& normalized_outline);
+
+    //! Moves all junctions of the toolpaths by \p offset.
+    static void translate(std::vector<VariableWidthLines>& toolpaths, const Point2LL& offset);
+
+    size_t capacity_;
+
+    //! Guards entries_. The entries themselves never change, so they can be read after the lock is released.
+    std::mutex mutex_;
+
+    //! The remembered walls, from the oldest to the newest.
+    std::deque<std::shared_ptr<const Entry>> entries_;
+
+    std::atomic<size_t> hit_count_{ 0 };
+    std::atomic<size_t> miss_count_{ 0 };
+};
+
+} // namespace cura
+
+#endif // CURAENGINE_WALLTOOLPATHSCACHE_H
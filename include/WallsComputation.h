@@ -12,8 +12,11 @@
 namespace cura
 {
 
+class CompactPolygonsPool;
+class Polygons;
 class SliceLayer;
 class SliceLayerPart;
+class WallToolPathsCache;
 
 /*!
  * Function container for computing the outer walls / insets / perimeters polygons of a layer
@@ -27,8 +30,12 @@ public:
      *
      * \param settings The per-mesh settings object to get setting values from.
      * \param layer_nr The layer index that these walls are generated for.
+     * \param walls_cache Where to reuse the walls of earlier outlines from, if
+     * anywhere. It must only be used with the same settings.
+     * \param outline_pool Where to share the print outlines of the parts with
+     * earlier ones of the same shape, if anywhere.
      */
-    WallsComputation(const Settings& settings, const LayerIndex layer_nr);
+    WallsComputation(const Settings& settings, const LayerIndex layer_nr, WallToolPathsCache* walls_cache = nullptr, CompactPolygonsPool* outline_pool = nullptr);
 
     /*!
      * \brief Generates the walls / inner area for all parts in a layer.
@@ -52,6 +59,16 @@ private:
      */
     const LayerIndex layer_nr_;
 
+    /*!
+     * \brief Where to reuse the walls of earlier outlines from, or nullptr.
+     */
+    WallToolPathsCache* walls_cache_;
+
+    /*!
+     * \brief Where to share the print outlines with earlier ones from, or nullptr.
+     */
+    CompactPolygonsPool* outline_pool_;
+
     /*!
      * Generates the walls / inner area for a single layer part.
      *
@@ -59,6 +76,15 @@ private:
      */
     void generateWalls(SliceLayerPart* part, SectionType section);
 
+    /*!
+     * Stores the print outline of a part, sharing it with earlier ones of the
+     * same shape if there is an outline pool.
+     *
+     * \param part The part to set the print outline of.
+     * \param print_outline The print outline of the part.
+     */
+    void setPrintOutline(SliceLayerPart* part, const Polygons& print_outline);
+
     /*!
      * Generates the outer inset / perimeter used in spiralize mode for a single layer part. The spiral inset is
      * generated using offsets.
@@ -4,14 +4,63 @@
 #ifndef BRIDGE_H
 #define BRIDGE_H
 
+#include <optional>
+#include <vector>
+
+#include "settings/types/LayerIndex.h"
+#include "settings/types/Ratio.h"
+#include "utils/AABB.h"
+#include "utils/polygon.h"
+
 namespace cura
 {
 
-class Polygons;
 class Settings;
 class SliceDataStorage;
+class SliceLayerPart;
 class SupportLayer;
 
+/*!
+ * \brief The areas of a layer below that the skins of a layer could rest on,
+ * for \ref bridgeAngle.
+ *
+ * These are the outlines of the parts of all printed meshes, without their
+ * sparse infill right below a bridge. The area of a part is only computed once
+ * a skin comes near it, and is then shared by all skins of the layer.
+ */
+class SolidBelow
+{
+public:
+    /*!
+     * \param storage Where to find the parts of the layer below.
+     * \param layer_nr The layer of the skins.
+     * \param bridge_layer The bridge layer number (1, 2 or 3).
+     * \param sparse_infill_max_density Infill up to this density doesn't
+     * support the first bridge layer.
+     */
+    SolidBelow(const SliceDataStorage& storage, const LayerIndex layer_nr, const unsigned bridge_layer, const Ratio sparse_infill_max_density);
+
+    const unsigned bridge_layer_;
+    const Ratio sparse_infill_max_density_;
+
+    /*!
+     * \brief Get the areas of the parts below whose bounding box hits a box.
+     * \param box The region to get the areas in.
+     * \return For each part, in order of mesh and part, its area.
+     */
+    std::vector<const Polygons*> near(const AABB& box);
+
+private:
+    struct Part
+    {
+        const SliceLayerPart* part;
+        bool without_infill; //!< Whether the sparse infill of the part doesn't count as solid.
+        std::optional<Polygons> area; //!< Computed when first needed.
+    };
+
+    std::vector<Part> parts_;
+};
+
 /*!
  * \brief Computes the angle that lines have to take to bridge a certain shape
  * best.
@@ -19,22 +68,13 @@ class SupportLayer;
  * If the area should not be bridged, an angle of -1 is returned.
  * \param settings The settings container to get settings from.
  * \param skin_outline The shape to fill with lines.
- * \param storage The slice data storage where to find objects that the bridge
- * could rest on in previous layers.
- * \param layer_nr The layer currently being printed.
- * \param bridge_layer The bridge layer number (1, 2 or 3).
+ * \param solid_below The objects that the bridge could rest on in the layer
+ * below, shared by all skins of the layer.
  * \param support_layer Support that the bridge could rest on.
  * \param supported_regions Pre-computed regions that the support layer would
  * support.
  */
-double bridgeAngle(
-    const Settings& settings,
-    const Polygons& skin_outline,
-    const SliceDataStorage& storage,
-    const unsigned layer_nr,
-    const unsigned bridge_layer,
-    const SupportLayer* support_layer,
-    Polygons& supported_regions);
+double bridgeAngle(const Settings& settings, const Polygons& skin_outline, SolidBelow& solid_below, const SupportLayer* support_layer, Polygons& supported_regions);
 
 } // namespace cura
 
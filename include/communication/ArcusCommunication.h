@@ -54,6 +54,17 @@ public:
      */
     void connect(const std::string& ip, const uint16_t port);
 
+    /*
+     * \brief Send the optimised layer data of each layer as soon as the layer
+     * has been written, instead of all layers at the end of the slice.
+     *
+     * This lets the front-end show layers while the slice is still running, and
+     * the engine doesn't need to keep the layer data of the whole print in
+     * memory. The layers are then sent in print order, one at a time.
+     * \param stream_layers Whether to stream the layers.
+     */
+    void setLayerStreaming(const bool stream_layers);
+
     /*
      * \brief Indicate that we're beginning to send g-code.
      */
@@ -73,6 +84,12 @@ public:
      */
     bool isSequential() const override;
 
+    /*
+     * \brief Cura keeps the engine running and sends it a new slice every time
+     * the scene changes.
+     */
+    bool isPersistent() const override;
+
     /*
      * \brief Test if there are any more slices in the queue.
      */
@@ -174,6 +191,12 @@ public:
      */
     void sendPrintTimeMaterialEstimates() const override;
 
+    /*
+     * \brief Send the estimates of the whole print along with the next
+     * progress message, while the g-code is being written.
+     */
+    void sendRunningEstimates(const PrintEstimates& estimates) const override;
+
     /*
      * \brief Communicate to Arcus what our progress is.
      */
@@ -8,8 +8,11 @@
 #include "ArcusCommunication.h" //We're adding a subclass to this.
 #include "SliceDataStruct.h"
 #include "settings/types/LayerIndex.h"
+#include "utils/ChunkSink.h" //To send the g-code in chunks.
 
-#include <sstream> //For ostringstream.
+#include <mutex> //To guard the layer data, which the layer processing threads write to.
+#include <optional>
+#include <ostream>
 
 namespace cura
 {
@@ -29,6 +32,14 @@ public:
      */
     std::shared_ptr<proto::LayerOptimized> getOptimizedLayerById(LayerIndex::value_type layer_nr);
 
+    /*
+     * \brief Send the optimised layer data of one layer and forget about it.
+     *
+     * Nothing is sent if no data was buffered for this layer.
+     * \param layer_nr The layer number to send the optimised layer data of.
+     */
+    void sendOptimizedLayer(LayerIndex::value_type layer_nr);
+
     /*
      * Reads the global settings from a Protobuf message.
      *
@@ -46,16 +57,62 @@ public:
      */
     void readMeshGroupMessage(const proto::ObjectList& mesh_group_message);
 
+    /*
+     * \brief Send a chunk of g-code to the front-end as a GCodeLayer message.
+     *
+     * This is called on the thread that writes the g-code, whenever a chunk
+     * is full, and at the end of each layer. The buffer of the chunk goes back
+     * to the pool of the g-code sink afterwards.
+     * \param gcode The chunk of g-code, which ends at the end of a line.
+     */
+    void sendGCodeChunk(std::string&& gcode);
+
     Arcus::Socket* socket; //!< Socket to send data to.
     size_t object_count; //!< Number of objects that need to be sliced.
     std::string temp_gcode_file; //!< Temporary buffer for the g-code.
-    std::ostringstream gcode_output_stream; //!< The stream to write g-code to.
+
+    /*
+     * \brief Collects the g-code and sends it in messages of at most a chunk,
+     * reusing the buffers of the chunks, so that a big print doesn't collect a
+     * big layer of g-code in memory.
+     */
+    ChunkSink gcode_output_sink;
+    std::ostream gcode_output_stream; //!< The stream to write g-code to, which writes to gcode_output_sink.
 
     SliceDataStruct<cura::proto::Layer> sliced_layers;
     SliceDataStruct<cura::proto::LayerOptimized> optimized_layers;
+    std::mutex optimized_layers_mutex; //!< Guards optimized_layers.slice_data.
+
+    /*
+     * \brief Whether to send the optimised layer data of each layer as soon as
+     * it has been written, rather than all of it when the slice is done.
+     */
+    bool stream_layers;
+
+    /*
+     * \brief How to encode the payloads of the g-code and layer view messages,
+     * as negotiated with the front-end in the Slice message.
+     */
+    proto::PayloadCompression payload_compression;
+
+    /*
+     * \brief How far the layer view data may deviate from the toolpaths, as
+     * asked for by the front-end in the Slice message. Vertices of lines that
+     * print the same within this distance are left out.
+     */
+    coord_t preview_tolerance;
+
+    /*
+     * \brief When streaming, the layer that layer data is currently being
+     * written for. It is sent as soon as the next layer starts.
+     */
+    std::optional<LayerIndex::value_type> streamed_layer_nr;
 
     int last_sent_progress; //!< Last sent progress promille (1/1000th). Used to not send duplicate messages with the same promille.
 
+    std::shared_ptr<proto::PrintTimeMaterialEstimates> running_estimates; //!< The estimates to send along with the next progress message, if any.
+    std::mutex running_estimates_mutex; //!< Guards running_estimates, which the g-code writer sets while progress is sent from another thread.
+
     /*
      * \brief How often we've sliced so far during this run of CuraEngine.
      *
@@ -5,11 +5,13 @@
 #define COMMANDLINE_H
 
 #include <filesystem>
+#include <optional>
 #include <rapidjson/document.h> //Loading JSON documents to get settings from them.
 #include <string> //To store the command line arguments.
 #include <vector> //To store the command line arguments.
 
 #include "Communication.h" //The class we're implementing.
+#include "communication/DefinitionCache.h" //To skip parsing definition files that were loaded before.
 
 namespace cura
 {
@@ -48,6 +50,11 @@ public:
      */
     bool isSequential() const override;
 
+    /*
+     * \brief The command line slices what it was given once, and then exits.
+     */
+    bool isPersistent() const override;
+
     /*
      * \brief Test if there are any more slices to be made.
      */
@@ -119,9 +126,19 @@ public:
     /*
      * \brief Show an estimate of how long the print would take and how much
      * material it would use.
+     *
+     * When only the estimates were asked for, with --estimate-only, they are
+     * written to stdout as JSON, with the same fields as the
+     * PrintTimeMaterialEstimates message of the front-end.
      */
     void sendPrintTimeMaterialEstimates() const override;
 
+    /*
+     * \brief Log the estimates of the whole print while the g-code is being
+     * written.
+     */
+    void sendRunningEstimates(const PrintEstimates& estimates) const override;
+
     /*
      * \brief Show an update of our slicing progress.
      */
@@ -150,6 +167,32 @@ public:
      */
     void sliceNext() override;
 
+protected:
+    /*
+     * \brief Where to store the outcome of loading definition files, if the
+     * CURA_ENGINE_DEFINITION_CACHE environment variable is set.
+     */
+    std::optional<DefinitionCache> definition_cache_;
+
+    /*
+     * \brief Set the arguments for the next slice.
+     *
+     * The definition search paths are reset to the ones from the environment,
+     * so that the search paths of an earlier slice don't carry over.
+     * \param arguments The arguments, in the same form as the command line
+     * arguments passed to the application.
+     */
+    void setArguments(const std::vector<std::string>& arguments);
+
+    /*
+     * \brief Give up on the current slice, because its arguments are invalid
+     * or slicing failed.
+     *
+     * The command line has nothing else to do then, so it exits the
+     * application.
+     */
+    [[noreturn]] virtual void abortSlice();
+
 private:
 #ifdef __EMSCRIPTEN__
     std::string progressHandler;
@@ -157,6 +200,18 @@ private:
 
     std::vector<std::filesystem::path> search_directories_;
 
+    /*
+     * \brief While loading a definition file for the cache, the entry that
+     * records what loading does.
+     */
+    DefinitionCache::Entry* recording_ = nullptr;
+
+    /*
+     * \brief While recording, the settings that the definition file is loaded
+     * into.
+     */
+    const Settings* recording_settings_ = nullptr;
+
     /*
      * \brief The command line arguments that the application was called with.
      */
@@ -167,6 +222,17 @@ private:
      */
     unsigned int last_shown_progress_;
 
+    /*
+     * \brief Whether the current slice only estimates the print time and
+     * material, without generating any g-code.
+     */
+    bool estimate_only_ = false;
+
+    /*
+     * \brief Where to write the trace of the current slice, if it is traced.
+     */
+    std::optional<std::filesystem::path> trace_file_;
+
     /*
      * \brief Load a JSON file and store the settings inside it.
      * \param json_filename The location of the JSON file to load settings from.
@@ -179,6 +245,31 @@ private:
      */
     int loadJSON(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent = false, bool force_read_nondefault = false);
 
+    /*
+     * \brief Load a JSON file and store the settings inside it, without
+     * consulting the definition cache.
+     *
+     * The parameters and return value are the same as for \ref loadJSON.
+     */
+    int loadJSONFile(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault);
+
+    /*
+     * \brief Apply what loading a definition file did according to the
+     * definition cache.
+     * \param entry The cache entry to apply.
+     * \param settings The settings storage to store the settings in.
+     */
+    void applyCacheEntry(const DefinitionCache::Entry& entry, Settings& settings);
+
+    /*
+     * \brief Add a setting, recording it if a definition file is being loaded
+     * for the cache.
+     * \param settings The settings storage to store the setting in.
+     * \param key The key of the setting.
+     * \param value The value of the setting.
+     */
+    void addSetting(Settings& settings, const std::string& key, const std::string& value);
+
     /*
      * \brief Load a JSON document and store the settings inside it.
      * \param document The JSON document to load the settings from.
@@ -15,6 +15,7 @@ enum class PrintFeatureType : unsigned char;
 class Polygons;
 class ConstPolygonRef;
 class ExtruderTrain;
+struct PrintEstimates;
 
 /*
  * An abstract class to provide a common interface for all methods of
@@ -45,6 +46,16 @@ public:
      */
     virtual bool isSequential() const = 0;
 
+    /*
+     * \brief Whether the communication channel may request more slices from
+     * this process after the current one.
+     *
+     * If so, intermediate results of the current slice may be worth keeping
+     * around, since the next slice is often of the same scene with a few
+     * changed settings.
+     */
+    virtual bool isPersistent() const = 0;
+
     /*
      * \brief Indicate to the communication channel what the current progress of
      * slicing the current slice is.
@@ -143,6 +154,15 @@ public:
      */
     virtual void sendPrintTimeMaterialEstimates() const = 0;
 
+    /*
+     * \brief Send an estimate of how long the whole print will take and how
+     * much material it will use, while the g-code is still being written.
+     *
+     * The estimate is extrapolated from the layers that were written so far.
+     * It may be sent along with the next progress update.
+     */
+    virtual void sendRunningEstimates(const PrintEstimates& estimates) const = 0;
+
     /*
      * \brief Indicate that we're beginning to send g-code.
      */
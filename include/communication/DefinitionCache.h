@@ -0,0 +1,136 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef DEFINITION_CACHE_H
+#define DEFINITION_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Stores the outcome of loading a JSON definition file with all of its
+ * parents and extruders, so that a later run can apply it without parsing any
+ * JSON.
+ *
+ * Each entry is a file in the cache directory, named after a hash of what was
+ * loaded. An entry records the files that were read together with their size
+ * and modification time, and it is only used as long as none of those files
+ * changed.
+ *
+ * Entries are also kept in memory, so that a process that slices many times
+ * doesn't need to read them again either.
+ */
+class DefinitionCache
+{
+public:
+    /*!
+     * \brief Everything that loading a definition file did, in order.
+     */
+    struct Entry
+    {
+        /*!
+         * \brief A file that was read to create the entry.
+         */
+        struct Dependency
+        {
+            std::string path;
+            int64_t modified_time;
+            uint64_t size;
+        };
+
+        /*!
+         * \brief A change to the scene made while loading.
+         */
+        struct Operation
+        {
+            enum class Type : uint8_t
+            {
+                ADD_SETTING, //!< Add a setting to the settings that were loaded into, or to an extruder.
+                ADD_EXTRUDER, //!< Make sure that the scene has an extruder with this number.
+            };
+            Type type;
+            int32_t extruder_nr; //!< The extruder to change, or -1 for the settings that were loaded into.
+            std::string key;
+            std::string value;
+        };
+
+        std::vector<Dependency> dependencies;
+        std::vector<std::string> search_directories; //!< The search directories that were added while loading.
+        std::vector<Operation> operations;
+    };
+
+    /*!
+     * \brief Create a cache that only keeps its entries in memory.
+     */
+    DefinitionCache() = default;
+
+    /*!
+     * \brief Create a cache that stores its entries in a directory.
+     * \param directory The directory to store the entries in. It is created if
+     * it doesn't exist yet.
+     */
+    explicit DefinitionCache(std::filesystem::path directory);
+
+    /*!
+     * \brief Get an entry, if it exists and the files it was made from didn't
+     * change since.
+     * \param key A description of everything that influences what loading
+     * does, such as the file name and the search directories.
+     * \return The entry, or nullopt if there is no valid entry for this key.
+     */
+    std::optional<Entry> load(const std::string& key) const;
+
+    /*!
+     * \brief Store an entry, replacing any older entry with the same key.
+     *
+     * Failing to store the entry is not an error, since it only makes the next
+     * run slower.
+     * \param key A description of everything that influences what loading
+     * does, the same as what will be passed to \ref load.
+     * \param entry The entry to store.
+     */
+    void store(const std::string& key, const Entry& entry) const;
+
+    /*!
+     * \brief Describe the current state of a file, to record it as a
+     * dependency.
+     * \param path The file to describe.
+     * \return The dependency, or nullopt if the file can't be accessed.
+     */
+    static std::optional<Entry::Dependency> getDependency(const std::filesystem::path& path);
+
+private:
+    std::filesystem::path directory_; //!< The directory to store entries in, or empty to only keep them in memory.
+    mutable std::unordered_map<std::string, Entry> memory_entries_; //!< The entries that were loaded or stored by this process.
+
+    /*!
+     * \brief Get an entry from the cache directory.
+     */
+    std::optional<Entry> loadFile(const std::string& key) const;
+
+    /*!
+     * \brief Write an entry to the cache directory.
+     */
+    void storeFile(const std::string& key, const Entry& entry) const;
+
+    /*!
+     * \brief Check that none of the files that an entry was made from changed.
+     */
+    static bool isUpToDate(const Entry& entry);
+
+    /*!
+     * \brief Get the file an entry is stored in.
+     */
+    std::filesystem::path getEntryPath(const std::string& key) const;
+};
+
+} // namespace cura
+
+#endif // DEFINITION_CACHE_H
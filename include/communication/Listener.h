@@ -23,7 +23,9 @@ public:
     void stateChanged(Arcus::SocketState) override;
 
     /*
-     * Changes the ``messageReceived`` signal to do nothing.
+     * Cancels the running slice, if any. The front-end only sends a message
+     * while the engine is slicing to replace the slice with a newer one, and
+     * the message is processed once the running slice has stopped.
      */
     void messageReceived() override;
 
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef PAYLOAD_COMPRESSION_H
+#define PAYLOAD_COMPRESSION_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Compress a payload into a zlib stream.
+ * \param data The bytes to compress.
+ * \return The compressed bytes, which zlib's \c uncompress restores.
+ */
+std::string deflatePayload(const std::string_view data);
+
+/*!
+ * \brief Encode a flat array of coordinates compactly, ahead of compressing it.
+ *
+ * The coordinates are rounded to micrometres, which is the resolution that
+ * they were computed at. Each coordinate is then replaced by its difference
+ * with the same coordinate of the previous point, zigzag-encoded so that small
+ * negative differences are small too, and written as a variable-length
+ * integer of 7 bits per byte, least significant group first.
+ * \param coordinates The coordinates in millimetres, ordered per point.
+ * \param dimensions The number of coordinates per point.
+ * \return The encoded coordinates.
+ */
+std::string encodeCoordinateDeltas(const std::vector<float>& coordinates, const size_t dimensions);
+
+/*!
+ * \brief Decode coordinates that were encoded with \ref encodeCoordinateDeltas.
+ * \param data The encoded coordinates.
+ * \param dimensions The number of coordinates per point.
+ * \return The coordinates in millimetres, or an empty array if \p data is
+ * malformed.
+ */
+std::vector<float> decodeCoordinateDeltas(const std::string_view data, const size_t dimensions);
+
+} // namespace cura
+
+#endif // PAYLOAD_COMPRESSION_H
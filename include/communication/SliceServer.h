@@ -0,0 +1,86 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef SLICESERVER_H
+#define SLICESERVER_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include "communication/CommandLine.h" //The class we're extending.
+
+namespace cura
+{
+
+/*
+ * \brief Keeps the engine running to slice one job after another, each
+ * given with the same arguments as a command line slice.
+ *
+ * Clients connect to a local socket. A client sends the arguments that would
+ * follow \c "CuraEngine slice" on the command line, each terminated by a NUL
+ * character, and then an empty argument to finish the job. The server slices
+ * the job, answers \c "OK\n" or \c "ERROR\n" and closes the connection. A job
+ * without any arguments stops the server.
+ *
+ * Since the process stays alive, the thread pool, the definitions that were
+ * loaded and the sliced layers of unchanged meshes are all reused by the
+ * next job.
+ */
+class SliceServer : public CommandLine
+{
+public:
+    /*
+     * \brief Start listening for jobs.
+     * \param socket_path Where to create the socket. Any file that is already
+     * there is replaced.
+     * \throws boost::system::system_error If the socket can't be created.
+     */
+    explicit SliceServer(const std::filesystem::path& socket_path);
+
+    /*
+     * \brief Stops listening and removes the socket.
+     */
+    ~SliceServer() override;
+
+    /*
+     * \brief The server keeps processing jobs until a client stops it.
+     */
+    bool hasSlice() const override;
+
+    /*
+     * \brief The server slices many times in the same process.
+     */
+    bool isPersistent() const override;
+
+    /*
+     * \brief Wait for the next job and slice it.
+     */
+    void sliceNext() override;
+
+protected:
+    /*
+     * \brief Give up on the current job, but keep the server running.
+     */
+    [[noreturn]] void abortSlice() override;
+
+private:
+    std::filesystem::path socket_path_;
+    boost::asio::io_context io_context_;
+    boost::asio::local::stream_protocol::acceptor acceptor_;
+
+    /*
+     * \brief Read the arguments of a job from a client.
+     * \param connection The connection to the client.
+     * \param[out] arguments The arguments are appended to this.
+     * \return Whether the complete job was read.
+     */
+    static bool readJob(boost::asio::local::stream_protocol::socket& connection, std::vector<std::string>& arguments);
+};
+
+} // namespace cura
+
+#endif // SLICESERVER_H
@@ -5,12 +5,14 @@
 #define GCODEEXPORT_H
 
 #include <deque> // for extrusionAmountAtPreviousRetractions
+#include <optional>
 #ifdef BUILD_TESTS
 #include <gtest/gtest_prod.h> //To allow tests to use protected members.
 #endif
 #include <sstream> // for stream.str()
 #include <stdio.h>
 
+#include "GCodeOutputWriter.h"
 #include "settings/EnumSettings.h"
 #include "settings/Settings.h" //For MAX_EXTRUDERS.
 #include "settings/types/LayerIndex.h"
@@ -18,6 +20,8 @@
 #include "settings/types/Velocity.h"
 #include "sliceDataStorage.h"
 #include "timeEstimate.h"
+#include "TimeEstimatePipeline.h"
+#include "ToolpathExport.h"
 #include "utils/AABB3D.h" //To track the used build volume for the Griffin header.
 #include "utils/NoCopy.h"
 #include "utils/Point2LL.h"
@@ -117,9 +121,16 @@ private:
     std::string machine_name_;
     std::string slice_uuid_; //!< The UUID of the current slice.
 
-    std::ostream* output_stream_;
+    GCodeOutputWriter output_writer_; //!< Formats the moves and writes the g-code to the output stream on threads of its own.
+    std::ostream* output_stream_; //!< Where the g-code is written to. Normally the buffer of \ref output_writer_.
+    ToolpathExport toolpath_export_; //!< Writes the toolpaths of the layers for analysis, if that was asked for.
+    std::ostream null_stream_{ nullptr }; //!< A stream without a buffer, which drops everything written to it, for when no g-code is wanted.
     std::string new_line_;
 
+    bool file_header_patchable_ = false; //!< Whether the next file header is written with room to be overwritten at the end of the slice.
+    size_t file_header_size_ = 0; //!< The size of the file header that was written with room to be overwritten, or 0 if there was none.
+    size_t file_header_line_count_ = 0; //!< The number of lines of the file header that was written with room to be overwritten.
+
     double current_e_value_; //!< The last E value written to gcode (in mm or mm^3)
 
     // flow-rate compensation
@@ -153,9 +164,11 @@ private:
     double current_fan_speed_;
     unsigned fan_number_; // current print cooling fan number
     EGCodeFlavor flavor_;
+    void (GCodeExport::*write_travel_move_)(const Point3LL&, const Velocity&); //!< The travel move writer of the flavor, chosen in \ref setFlavor.
+    void (GCodeExport::*write_extrusion_move_)(const Point3LL&, const Velocity&, double, PrintFeatureType, bool); //!< The extrusion move writer of the flavor.
 
     std::vector<Duration> total_print_times_; //!< The total estimated print time in seconds for each feature
-    TimeEstimateCalculator estimate_calculator_;
+    TimeEstimatePipeline estimate_calculator_; //!< Estimates the print time on a thread of its own.
 
     LayerIndex layer_nr_; //!< for sending travel data
 
@@ -248,6 +261,54 @@ public:
 
     void setOutputStream(std::ostream* stream);
 
+    /*!
+     * Write the next file header with room to spare, so that the file header with the final print time, material use
+     * and bounding box can be written over it at the end of the slice, with \ref getPatchedFileHeader.
+     *
+     * Only use this when the file header is the first thing in the output stream and the output stream is a file that can
+     * be overwritten.
+     */
+    void setFileHeaderPatchable(const bool patchable);
+
+    /*!
+     * Get the final file header to write over the one at the start of the output, made just as long.
+     *
+     * \param file_header The final file header, from \ref getFileHeader.
+     * \return The file header to write over the one that was written, or nothing if no file header was written with room
+     * to spare or if the final one doesn't fit in it.
+     */
+    std::optional<std::string> getPatchedFileHeader(const std::string& file_header) const;
+
+    /*!
+     * Hand the g-code written so far to the output thread, which writes it to the output stream while the next g-code is
+     * being generated. Call this after each layer.
+     */
+    void submitOutput();
+
+    /*!
+     * Wait until all g-code written so far is in the output stream, before the output stream is read.
+     */
+    void flushOutput();
+
+    /*!
+     * Drop the g-code that isn't in the output stream yet, because the slice is cancelled.
+     */
+    void discardOutput();
+
+    /*!
+     * Don't generate any g-code until the output stream is set again, such as when only the print time and material
+     * are estimated.
+     *
+     * The g-code is written to a stream that drops it, and the moves aren't formatted at all. Everything else, such
+     * as the time estimate and the extruded volumes, is kept track of as before.
+     */
+    void disableOutput();
+
+    /*!
+     * Get what writes the toolpaths of the layers next to the g-code, if it is open.
+     */
+    ToolpathExport& getToolpathExport();
+
     bool getExtruderIsUsed(const int extruder_nr) const; //!< return whether the extruder has been used throughout printing all meshgroup up till now
 
     Point2LL getGcodePos(const coord_t x, const coord_t y, const int extruder_train) const;
@@ -384,6 +445,35 @@ public:
      */
     void writeExtrusion(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset = false);
 
+    /*!
+     * Go along a circular arc to a X/Y location with the extrusion Z, with a G2 or G3 move, instead of along the
+     * polyline that the arc was fitted to.
+     * Perform un-z-hop
+     * Perform unretraction
+     *
+     * As much is extruded as along the polyline. The time estimate plans the arc in segments of about a millimetre, as
+     * the firmware moves along it.
+     *
+     * Coordinates are build plate coordinates, which might be offsetted when extruder offsets are encoded in the gcode.
+     *
+     * \param p location to go to
+     * \param center the center of the circle that the arc is part of
+     * \param clockwise whether to go clockwise (G2) or counter-clockwise (G3)
+     * \param path_length the length in mm of the polyline that the arc replaces
+     * \param speed movement speed
+     * \param feature the feature that's currently printing
+     * \param update_extrusion_offset whether to update the extrusion offset to match the current flow rate
+     */
+    void writeArcExtrusion(
+        const Point2LL& p,
+        const Point2LL& center,
+        const bool clockwise,
+        const double path_length,
+        const Velocity& speed,
+        const double extrusion_mm3_per_mm,
+        const PrintFeatureType& feature,
+        const bool update_extrusion_offset = false);
+
     /*!
      * Initialize the extruder trains.
      *
@@ -454,6 +544,14 @@ private:
      */
     void writeFXYZE(const Velocity& speed, const coord_t x, const coord_t y, const coord_t z, const double e, const PrintFeatureType& feature);
 
+    /*!
+     * Compensate the extrusion of a move for the flow rate, if that is enabled, and write the new offset if it changed
+     * and \p update_extrusion_offset is set.
+     *
+     * \param length the length in mm of the move
+     */
+    void writeFlowRateCompensation(const double length, const Velocity& speed, const double extrusion_mm3_per_mm, const bool update_extrusion_offset);
+
     /*!
      * The writeTravel and/or writeExtrusion when flavor == BFB
      * \param x build plate x
@@ -465,6 +563,16 @@ private:
      */
     void writeMoveBFB(const int x, const int y, const int z, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature);
 
+    /*!
+     * The writeTravel and writeExtrusion of a Point3LL for a kind of g-code flavor. \ref setFlavor picks the
+     * instantiation once, so that the moves themselves don't need to check the flavor.
+     * \tparam rpm_extrusion Whether the flavor drives the extruder by its RPM instead of by E values, like BFB does.
+     */
+    template<bool rpm_extrusion>
+    void writeTravelMove(const Point3LL& p, const Velocity& speed);
+    template<bool rpm_extrusion>
+    void writeExtrusionMove(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset);
+
     /*!
      * Set bed temperature for the initial layer. Called by 'processInitialLayerTemperatures'.
      */
@@ -4,7 +4,10 @@
 #ifndef INFILL_H
 #define INFILL_H
 
+#include <limits>
 #include <numbers>
+#include <span>
+#include <vector>
 
 #include <range/v3/range/concepts.hpp>
 
@@ -23,6 +26,7 @@ namespace cura
 
 class SierpinskiFillProvider;
 class SliceMeshStorage;
+class WallToolPathsCache;
 
 class Infill
 {
@@ -222,6 +226,8 @@ public:
      * \param line_width [in] The optimum wall line width of the walls
      * \param infill_overlap [in] The overlap of the infill
      * \param settings [in] A settings storage to use for generating variable-width walls.
+     * \param walls_cache [in,out] Where to look up and remember the walls of infill areas, so that the walls of an area
+     * that comes up again are copied instead of generated again. It must only be used with the same \p settings.
      * \return The inner contour of the wall toolpaths
      */
     static Polygons generateWallToolPaths(
@@ -232,11 +238,15 @@ public:
         const coord_t infill_overlap,
         const Settings& settings,
         int layer_idx,
-        SectionType section_type);
+        SectionType section_type,
+        WallToolPathsCache* walls_cache = nullptr);
 
 private:
     struct InfillLineSegment
     {
+        //! Marks that a line segment is not connected to anything on that side.
+        static constexpr size_t no_segment = std::numeric_limits<size_t>::max();
+
         /*!
          * Creates a new infill line segment.
          *
@@ -254,8 +264,8 @@ private:
             , altered_end_(end)
             , end_segment_(end_segment)
             , end_polygon_(end_polygon)
-            , previous_(nullptr)
-            , next_(nullptr)
+            , previous_(no_segment)
+            , next_(no_segment)
         {
         }
 
@@ -328,15 +338,16 @@ private:
         std::optional<Point2LL> end_bend_;
 
         /*!
-         * The previous line segment that this line segment is connected to, if
-         * any.
+         * The index in infill_segments_ of the previous line segment that this
+         * line segment is connected to, if any.
          */
-        InfillLineSegment* previous_;
+        size_t previous_;
 
         /*!
-         * The next line segment that this line segment is connected to, if any.
+         * The index in infill_segments_ of the next line segment that this line
+         * segment is connected to, if any.
          */
-        InfillLineSegment* next_;
+        size_t next_;
 
         /*!
          * Compares two infill line segments for equality.
@@ -362,11 +373,120 @@ private:
     };
 
     /*!
-     * Stores the infill lines (a vector) for each line of a polygon (a vector)
-     * for each polygon in a Polygons object that we create a zig-zaggified
-     * infill pattern for.
+     * All infill line segments that connectLines joins together, including the
+     * ones it adds along the border. They refer to each other by their index in
+     * here, so that they don't each have to be allocated on their own.
+     */
+    std::vector<InfillLineSegment> infill_segments_;
+
+    /*!
+     * Where an infill line ends on an edge of the inner contour.
      */
-    std::vector<std::vector<std::vector<InfillLineSegment*>>> crossings_on_line_;
+    struct OutlineCrossing
+    {
+        size_t polygon_index_; //!< The polygon of the edge.
+        size_t vertex_index_; //!< The vertex that the edge ends in.
+        size_t segment_index_; //!< The infill line, as index in infill_segments_.
+    };
+
+    /*!
+     * Both ends of every infill line in infill_segments_, in the order that the
+     * lines were made in. connectLines groups them per edge of the inner
+     * contour.
+     */
+    std::vector<OutlineCrossing> crossings_on_line_;
+
+    /*!
+     * The inner contour turned so that the scanlines are vertical, with the points of all polygons in one buffer.
+     *
+     * The lines of every linear pattern are the same scanlines in the turned space, so all that a layer needs from its
+     * outline is where the edges cross them. Each thread keeps one of these like ScanlineCrossings, so that turning the
+     * outline for each direction of a pattern doesn't copy it into a new Polygons every time.
+     */
+    struct RotatedOutline
+    {
+        std::vector<Point2LL> points_; //!< The turned points of all polygons, one polygon after the other.
+        std::vector<size_t> polygon_starts_; //!< Where the points of each polygon start in points_, followed by the end of the last one.
+        AABB boundary_; //!< The bounding box of the turned points.
+
+        /*!
+         * Replace the contents with \p outline turned by \p rotation_matrix.
+         */
+        void assign(const Polygons& outline, const PointMatrix& rotation_matrix);
+
+        size_t polygonCount() const
+        {
+            return polygon_starts_.size() - 1;
+        }
+
+        //! The turned points of one polygon.
+        std::span<const Point2LL> polygon(const size_t polygon_idx) const
+        {
+            return std::span<const Point2LL>(points_.data() + polygon_starts_[polygon_idx], points_.data() + polygon_starts_[polygon_idx + 1]);
+        }
+    };
+
+    /*!
+     * A crossing of a scanline with an edge of the outline, in the space where the scanlines are vertical.
+     */
+    struct ScanlineCrossing
+    {
+        coord_t y_; //!< Where the edge crosses the scanline.
+        size_t polygon_index_; //!< The polygon of the edge.
+        size_t vertex_index_; //!< The vertex that the edge ends in.
+        size_t scanline_idx_; //!< The scanline, counted from the one through the lowest X of the outline.
+
+        bool operator<(const ScanlineCrossing& other) const // Crossings will be ordered by their Y coordinate so that they get ordered along the scanline.
+        {
+            return y_ < other.y_;
+        }
+    };
+
+    /*!
+     * The crossings of all scanlines with an outline, in one buffer rather than in a vector for each scanline.
+     *
+     * Each thread keeps one of these for all infill it generates, so that the buffers are only allocated when an
+     * outline comes along that has more crossings than any before it.
+     */
+    struct ScanlineCrossings
+    {
+        std::vector<ScanlineCrossing> found_; //!< The crossings in the order that they were found in.
+        std::vector<ScanlineCrossing> sorted_; //!< The crossings ordered by scanline, and along each scanline by Y.
+        std::vector<size_t> scanline_starts_; //!< Where the crossings of each scanline start in sorted_, followed by the end of the last one.
+
+        /*!
+         * Forget the crossings of the previous outline, to find those with \p scanline_count new scanlines.
+         */
+        void reset(const size_t scanline_count);
+
+        /*!
+         * Add a crossing to found_, counting it for its scanline.
+         */
+        void add(const ScanlineCrossing& crossing)
+        {
+            found_.push_back(crossing);
+            scanline_starts_[crossing.scanline_idx_ + 1]++;
+        }
+
+        /*!
+         * Order the crossings that were found by scanline and by Y into sorted_.
+         *
+         * The crossings of each scanline keep the order they were found in until they are sorted by Y, so that crossings
+         * with the same Y end up in the same order as they would by sorting each scanline on its own.
+         */
+        void sort();
+
+        size_t scanlineCount() const
+        {
+            return scanline_starts_.size() - 1;
+        }
+
+        //! The crossings of one scanline, sorted by Y.
+        std::span<const ScanlineCrossing> scanline(const size_t scanline_idx) const
+        {
+            return std::span<const ScanlineCrossing>(sorted_.data() + scanline_starts_[scanline_idx], sorted_.data() + scanline_starts_[scanline_idx + 1]);
+        }
+    };
 
     /*!
      * Generate the infill pattern without the infill_multiplier functionality
@@ -477,13 +597,13 @@ private:
     void generateCrossInfill(const SierpinskiFillProvider& cross_fill_provider, Polygons& result_polygons, Polygons& result_lines);
 
     /*!
-     * Convert a mapping from scanline to line_segment-scanline-intersections (\p cut_list) into line segments, using the even-odd rule
+     * Convert the sorted crossings of each scanline with the polygons (\p crossings) into line segments, using the even-odd rule
      * \param[out] result (output) The resulting lines
      * \param rotation_matrix The rotation matrix (un)applied to enforce the angle of the infill
      * \param scanline_min_idx The lowest index of all scanlines crossing the polygon
      * \param line_distance The distance between two lines which are in the same direction
      * \param boundary The axis aligned boundary box within which the polygon is
-     * \param cut_list A mapping of each scanline to all y-coordinates (in the space transformed by rotation_matrix) where the polygons are crossing the scanline
+     * \param crossings For each scanline, the crossings (in the space transformed by rotation_matrix) with the polygons, sorted along it
      * \param total_shift total shift of the scanlines in the direction perpendicular to the fill_angle.
      */
     void addLineInfill(
@@ -492,7 +612,7 @@ private:
         const int scanline_min_idx,
         const int line_distance,
         const AABB boundary,
-        std::vector<std::vector<coord_t>>& cut_list,
+        const ScanlineCrossings& crossings,
         coord_t total_shift);
 
     /*!
@@ -610,7 +730,7 @@ private:
      * \param a The first line-segment.
      * \param b The second line-segment.
      */
-    void resolveIntersection(const coord_t at_distance, const Point2LL& intersect, Point2LL& connect_start, Point2LL& connect_end, InfillLineSegment* a, InfillLineSegment* b);
+    void resolveIntersection(const coord_t at_distance, const Point2LL& intersect, Point2LL& connect_start, Point2LL& connect_end, InfillLineSegment& a, InfillLineSegment& b);
 
     /*!
      * Connects infill lines together so that they form polylines.
@@ -1,7 +1,10 @@
 //Copyright (c) 2020 Ultimaker B.V.
 //CuraEngine is released under the terms of the AGPLv3 or higher.
 
+#include <vector>
+
 #include "../utils/Coord_t.h"
+#include "../utils/Point2LL.h"
 
 namespace cura
 {
@@ -36,7 +39,18 @@ public:
     static void generateTotalGyroidInfill(Polygons& result_lines, bool zig_zaggify, coord_t line_distance, const Polygons& in_outline, coord_t z);
     
 private:
-
+    /*!
+     * Connect the chains of the pattern along the outline, joining alternate chain ends into a chain of chains.
+     *
+     * The chain ends are found on the segments of the outline through a grid of those segments, so that connecting
+     * takes one pass along the outline instead of testing every chain end for every segment of it.
+     * \param result The lines of the pattern, to which the connectors are added.
+     * \param in_outline The outline that the chain ends are on.
+     * \param chains The start points and the end points of all chains.
+     * \param line_numbers For each chain, which row or column line it is part of.
+     * \param cell_size The size of the cells of the grid of outline segments.
+     */
+    static void connectChains(Polygons& result, const Polygons& in_outline, const std::vector<Point2LL> (&chains)[2], const std::vector<int>& line_numbers, const coord_t cell_size);
 };
 
 } // namespace cura
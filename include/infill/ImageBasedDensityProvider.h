@@ -5,6 +5,9 @@
 #ifndef INFILL_IMAGE_BASED_DENSITY_PROVIDER_H
 #define INFILL_IMAGE_BASED_DENSITY_PROVIDER_H
 
+#include <cstdint>
+#include <vector>
+
 #include "../utils/AABB.h"
 #include "DensityProvider.h"
 
@@ -24,7 +27,21 @@ public:
 
 protected:
     Point3LL image_size; //!< dimensions of the image. Third dimension is the amount of channels.
-    unsigned char* image = nullptr; //!< image data: rows of channel data per pixel.
+
+    /*!
+     * Summed-area table of the image, so that the lightness of any rectangle of pixels can be looked up in constant time.
+     *
+     * The entry at (x, y) holds the total of all channels of all pixels left of column x and below row y, with row 0 at
+     * the bottom of the image. It has one more column and row than the image.
+     */
+    std::vector<uint64_t> summed_lightness;
+
+    /*!
+     * Get the total lightness of all channels of the pixels in a rectangle of the image.
+     * \param min_x, min_y The first column and row of the rectangle, with row 0 at the bottom of the image.
+     * \param max_x, max_y The last column and row of the rectangle, inclusive.
+     */
+    uint64_t getTotalLightness(const coord_t min_x, const coord_t min_y, const coord_t max_x, const coord_t max_y) const;
 
     AABB print_aabb; //!< bounding box of print coordinates in which to apply the image
 };
@@ -4,7 +4,9 @@
 #ifndef LIGHTNING_DISTANCE_FIELD_H
 #define LIGHTNING_DISTANCE_FIELD_H
 
-#include "../utils/SquareGrid.h" //Tracking for each location the distance to overhang.
+#include <cstdint>
+#include <vector>
+
 #include "../utils/polygon.h" //Using outlines to fill and tracking overhang.
 
 namespace cura
@@ -17,6 +19,10 @@ namespace cura
  * This field contains a set of "cells", spaced out in a grid. Each cell
  * maintains how far it is removed from the edge, which is used to determine
  * how it gets supported by Lightning Infill.
+ *
+ * The cells are spread out regularly, one per grid square, so which of them
+ * still need to be supported is tracked in a dense bitmap over the bounding
+ * box of the overhang.
  */
 class LightningDistanceField
 {
@@ -42,11 +48,9 @@ public:
     /*!
      * Update the distance field with a newly added branch.
      *
-     * The branch is a line extending from \p to_node to \p added_leaf . This
-     * function updates the grid cells so that the distance field knows how far
-     * off it is from being supported by the current pattern. Grid points are
-     * updated with sampling points spaced out by the supporting radius along
-     * the line.
+     * The branch is a line extending from \p to_node to \p added_leaf . The
+     * cells within the supporting radius of the leaf are supported by the new
+     * branch, so they no longer need to be considered.
      * \param to_node The node endpoint of the newly added branch.
      * \param added_leaf The location of the leaf of the newly added branch,
      * drawing a straight line to the node.
@@ -54,19 +58,11 @@ public:
     void update(const Point2LL& to_node, const Point2LL& added_leaf);
 
 protected:
-    using GridPoint = SquareGrid::GridPoint;
-
     /*!
      * Spacing between grid points to consider supporting.
      */
     coord_t cell_size_;
 
-    /*!
-     * Grid points to consider supporting, with each point maintaining its
-     * distance to the nearest support point.
-     */
-    SquareGrid grid_;
-
     /*!
      * The radius of the area of the layer above supported by a point on a
      * branch of a tree.
@@ -100,7 +96,7 @@ protected:
          */
         coord_t dist_to_boundary_;
 
-        UnsupCell(SquareGrid::GridPoint loc, coord_t dist_to_boundary)
+        UnsupCell(Point2LL loc, coord_t dist_to_boundary)
             : loc_(loc)
             , dist_to_boundary_(dist_to_boundary)
         {
@@ -108,15 +104,53 @@ protected:
     };
 
     /*!
-     * Cells which still need to be supported at some point.
+     * All cells that needed to be supported, in the order in which they are
+     * to be supported.
+     */
+    std::vector<UnsupCell> unsupported_points_;
+
+    /*!
+     * The first cell in \ref unsupported_points_ that may still need to be
+     * supported. All cells before it are supported.
+     */
+    size_t next_unsupported_point_ = 0;
+
+    /*!
+     * The position of the grid square in the bitmap with coordinates (0, 0).
+     */
+    Point2LL grid_origin_;
+
+    /*!
+     * The number of grid squares in each row of the bitmap.
+     */
+    size_t grid_width_ = 0;
+
+    /*!
+     * The number of rows of the bitmap.
+     */
+    size_t grid_height_ = 0;
+
+    /*!
+     * The number of words that each row of the bitmap takes up.
+     */
+    size_t words_per_row_ = 0;
+
+    /*!
+     * For each grid square, one bit which is set if its cell still needs to be
+     * supported. The rows are padded to whole words.
+     */
+    std::vector<uint64_t> unsupported_bits_;
+
+    /*!
+     * For each grid square, the index in \ref unsupported_points_ of the cell
+     * in that square.
      */
-    std::list<UnsupCell> unsupported_points_;
+    std::vector<uint32_t> square_points_;
 
     /*!
-     * Links the unsupported points to a grid point, so that we can quickly look
-     * up the cell belonging to a certain position in the grid.
+     * Whether a cell in \ref unsupported_points_ still needs to be supported.
      */
-    std::unordered_map<SquareGrid::GridPoint, std::list<UnsupCell>::iterator> unsupported_points_grid_;
+    bool isUnsupported(const size_t point_idx) const;
 };
 
 } // namespace cura
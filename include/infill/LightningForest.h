@@ -0,0 +1,281 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef LIGHTNING_FOREST_H
+#define LIGHTNING_FOREST_H
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "../utils/polygon.h"
+#include "../utils/polygonUtils.h"
+
+namespace cura
+{
+
+constexpr coord_t locator_cell_size = 4000;
+
+/*!
+ * The vertices of all Lightning Trees of one layer, the structures that
+ * determine the paths to be printed to form Lightning Infill.
+ *
+ * In essence these vertices are just positions linked to other positions in
+ * 2D. The vertices have a hierarchical structure of parents and children,
+ * forming trees. Each vertex is identified by its index, and its position and
+ * links are kept in arrays indexed by it, so that a whole layer of trees can be
+ * copied at once to propagate it to the next layer. The class also has some
+ * helper functions specific to Lightning Infill e.g. to straighten the paths
+ * around a vertex.
+ *
+ * Vertices are never removed from the arrays while a layer is being built.
+ * Vertices that are cut out of the trees when propagating to the next layer
+ * are left behind when the arrays of that layer are compacted.
+ */
+class LightningForest
+{
+public:
+    //! Marks that there is no node, e.g. as parent of a root.
+    static constexpr size_t no_node = std::numeric_limits<size_t>::max();
+
+    /*!
+     * Construct a new node as the root of a new tree.
+     * \param p The physical location in the 2D layer that this node represents.
+     * Connecting other nodes to this node indicates that a line segment should
+     * be drawn between those two physical positions.
+     * \param last_grounding_location See getLastGroundingLocation.
+     * \return The index of the new node.
+     */
+    size_t createRoot(const Point2LL& p, const std::optional<Point2LL>& last_grounding_location = std::nullopt);
+
+    /*!
+     * The number of nodes, including the ones that are no longer part of a
+     * tree.
+     */
+    size_t size() const
+    {
+        return locations_.size();
+    }
+
+    /*!
+     * Get the position on this layer that a node represents, a vertex of the
+     * path to print.
+     * \return The position that the node represents.
+     */
+    const Point2LL& getLocation(const size_t node) const
+    {
+        return locations_[node];
+    }
+
+    /*!
+     * Change the position on this layer that a node represents.
+     * \param p The position that the node needs to represent.
+     */
+    void setLocation(const size_t node, const Point2LL& p)
+    {
+        locations_[node] = p;
+    }
+
+    /*!
+     * Construct a new node and add it as the last child of a node.
+     * \param p The location of the new node.
+     * \return The index of the new node.
+     */
+    size_t addChild(const size_t node, const Point2LL& p);
+
+    /*!
+     * Add an existing root as the last child of a node.
+     * \param new_child The node that must be added as a child.
+     * \return Always returns \p new_child.
+     */
+    size_t addChild(const size_t node, const size_t new_child);
+
+    /*!
+     * Propagate the trees to the next layer.
+     *
+     * Creates a copy of all trees, realigns them to the new layer boundaries
+     * \p next_outlines and reduces (i.e. prunes and straightens) them. The
+     * copies of the nodes that are still in a tree afterwards make up the
+     * resulting forest.
+     * \param roots The roots of the trees to propagate.
+     * \param[out] next_roots The roots of the trees in the resulting forest.
+     * \param next_outlines The shape of the layer below, to make sure that the
+     * trees stay within the bounds of the infill area.
+     * \param prune_distance The maximum distance that a leaf node may be moved
+     * such that it still supports the current node.
+     * \param smooth_magnitude The maximum distance that a line may be shifted
+     * to straighten the tree's paths, such that it still supports the current
+     * paths.
+     * \param max_remove_colinear_dist The maximum distance of a line-segment
+     * from which straightening may remove a colinear point.
+     * \return The forest of the next layer.
+     */
+    LightningForest propagateToNextLayer(
+        const std::vector<size_t>& roots,
+        std::vector<size_t>& next_roots,
+        const Polygons& next_outlines,
+        const LocToLineGrid& outline_locator,
+        const coord_t prune_distance,
+        const coord_t smooth_magnitude,
+        const coord_t max_remove_colinear_dist) const;
+
+    /*!
+     * Execute a given function for every node in a node's sub-tree.
+     *
+     * The visitor function takes the index of a node as input. Nodes are
+     * visited in depth-first order. The node itself is visited as well
+     * (pre-order).
+     * \param visitor A function to execute for every node in the node's sub-
+     * tree.
+     */
+    template<typename Visitor>
+    void visitNodes(const size_t node, Visitor&& visitor) const
+    {
+        visitor(node);
+        for (size_t child = first_children_[node]; child != no_node; child = next_siblings_[child])
+        {
+            assert(parents_[child] == node);
+            visitNodes(child, visitor);
+        }
+    }
+
+    /*!
+     * Get a weighted distance from an unsupported point to a node (given the current supporting radius).
+     *
+     * When attaching a unsupported location to a node, not all nodes have the same priority.
+     * (Eucludian) closer nodes are prioritised, but that's not the whole story.
+     * For instance, we give some nodes a 'valence boost' depending on the nr. of branches.
+     * \param unsupported_location The (unsuppported) location of which the weighted distance needs to be calculated.
+     * \param supporting_radius The maximum distance which can be bridged without (infill) supporting it.
+     * \return The weighted distance.
+     */
+    coord_t getWeightedDistance(const size_t node, const Point2LL& unsupported_location, const coord_t& supporting_radius) const;
+
+    /*!
+     * Returns whether a node is the root of a lightning tree. It is the root
+     * if it has no parents.
+     * \return ``true`` if the node is the root (no parents) or ``false`` if it
+     * is a child node of some other node.
+     */
+    bool isRoot(const size_t node) const
+    {
+        return parents_[node] == no_node;
+    }
+
+    /*!
+     * Reverse the parent-child relationship all the way to the root, from a node onward.
+     * This has the effect of 're-rooting' the tree at the node if no immediate parent is given as argument.
+     * That is, the node will become the root, it's (former) parent if any, will become one of it's children.
+     * This is then recursively bubbled up until it reaches the (former) root, which then will become a leaf.
+     * \param new_parent The (new) parent-node of the root, useful for recursing or immediately attaching the node to another tree.
+     */
+    void reroot(const size_t node, const size_t new_parent = no_node);
+
+    /*!
+     * Retrieves the closest node to the specified location.
+     * \param loc The specified location.
+     * \result The node in the sub-tree of \p node that is closest to the location.
+     */
+    size_t closestNode(const size_t node, const Point2LL& loc) const;
+
+    /*!
+     * Returns whether a node is a descendant of another node.
+     *
+     * A node is also considered to be a descendant of itself.
+     * \param to_be_checked A node to find out whether it is a descendant of
+     * \p node.
+     * \return ``true`` if the given node is a descendant or the node itself,
+     * or ``false`` if it is not in the sub-tree.
+     */
+    bool hasOffspring(const size_t node, const size_t to_be_checked) const;
+
+    /*!
+     * Convert the tree of a root into polylines
+     *
+     * At each junction one line is chosen at random to continue
+     *
+     * The lines start at a leaf and end in a junction
+     *
+     * \param output all branches in this tree connected into polylines
+     */
+    void convertToPolylines(const size_t root, Polygons& output, const coord_t line_width) const;
+
+    /*! If a node was ever a direct child of the root, it'll have a previous grounding location.
+     *
+     * This needs to be known when roots are reconnected, so that the last (higher) layer is supported by the next one.
+     */
+    const std::optional<Point2LL>& getLastGroundingLocation(const size_t node) const
+    {
+        return last_grounding_locations_[node];
+    }
+
+protected:
+    /*! Reconnect trees from the layer above to the new outlines of the lower layer.
+     * \return Wether or not the root is kept (false is no, true is yes).
+     */
+    bool realign(const size_t node, const Polygons& outlines, const LocToLineGrid& outline_locator, std::vector<size_t>& rerooted_parts);
+
+    struct RectilinearJunction
+    {
+        coord_t total_recti_dist; //!< rectilinear distance along the tree from the last junction above to the junction below
+        Point2LL junction_loc; //!< junction location below
+    };
+
+    /*!
+     * Smoothen the tree to make it a bit more printable, while still supporting
+     * the trees above.
+     * \param magnitude The maximum allowed distance to move the node.
+     * \param max_remove_colinear_dist Maximum distance of the (compound) line-segment from which a co-linear point may be removed.
+     */
+    void straighten(const size_t node, const coord_t magnitude, const coord_t max_remove_colinear_dist);
+
+    /*! Recursive part of \ref straighten(.)
+     * \param junction_above The last seen junction with multiple children above
+     * \param accumulated_dist The distance along the tree from the last seen junction to this node
+     * \param max_remove_colinear_dist2 Maximum distance _squared_ of the (compound) line-segment from which a co-linear point may be removed.
+     * \return the total distance along the tree from the last junction above to the first next junction below and the location of the next junction below
+     */
+    RectilinearJunction straighten(const size_t node, const coord_t magnitude, const Point2LL& junction_above, const coord_t accumulated_dist, const coord_t max_remove_colinear_dist2);
+
+    /*! Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
+     * \return The distance that has been pruned. If less than \p distance, then the whole tree was puned away.
+     */
+    coord_t prune(const size_t node, const coord_t& distance);
+
+    /*!
+     * Convert the tree into polylines
+     *
+     * At each junction one line is chosen at random to continue
+     *
+     * The lines start at a leaf and end in a junction
+     *
+     * \param long_line a reference to a polyline in \p output which to continue building on in the recursion
+     * \param output all branches in this tree connected into polylines
+     */
+    void convertToPolylines(const size_t node, size_t long_line_idx, Polygons& output) const;
+
+    static void removeJunctionOverlap(Polygons& polylines, const coord_t line_width);
+
+    /*!
+     * The number of children of a node.
+     */
+    size_t childCount(const size_t node) const;
+
+    /*!
+     * Drop the nodes that are not in the trees of \p roots any more, and
+     * number the others anew.
+     * \param[in,out] roots The roots of the trees to keep, which are replaced
+     * by their new indices.
+     */
+    void compact(std::vector<size_t>& roots);
+
+    std::vector<Point2LL> locations_; //!< The position of each node.
+    std::vector<size_t> parents_; //!< The parent of each node, or no_node for roots.
+    std::vector<size_t> first_children_; //!< The first child of each node, or no_node for leaves.
+    std::vector<size_t> next_siblings_; //!< The next child of the parent of each node, or no_node for the last child.
+    std::vector<std::optional<Point2LL>> last_grounding_locations_; //!< The last known grounding location of each node, see 'getLastGroundingLocation()'.
+};
+
+} // namespace cura
+
+#endif // LIGHTNING_FOREST_H
@@ -58,6 +58,14 @@ public:
     const LightningLayer& getTreesForLayer(const size_t& layer_id) const;
 
 protected:
+    /*!
+     * Calculate the area of each layer that the pattern fills, i.e. the infill
+     * area of each part minus the extra infill walls.
+     *
+     * The layers are independent, so they are calculated in parallel.
+     */
+    static std::vector<Polygons> generateInfillOutlines(const SliceMeshStorage& mesh);
+
     /*!
      * Calculate the overhangs above the infill areas that need to be supported
      * by infill.
@@ -65,13 +73,21 @@ protected:
      * Normally, overhangs are only generated for the outside of the model and
      * only when support is generated. For this pattern, we also need to
      * generate overhang areas for the inside of the model.
+     * \param infill_outlines The infill area of each layer, see
+     * \ref generateInfillOutlines.
      */
-    void generateInitialInternalOverhangs(const SliceMeshStorage& mesh);
+    void generateInitialInternalOverhangs(const std::vector<Polygons>& infill_outlines);
 
     /*!
      * Calculate the tree structure of all layers.
+     *
+     * Each layer depends on the trees of the layer above, so the layers are
+     * processed one by one from the top down. Meanwhile the outline locators
+     * of the next layers are built in parallel.
+     * \param infill_outlines The infill area of each layer, see
+     * \ref generateInfillOutlines.
      */
-    void generateTrees(const SliceMeshStorage& mesh);
+    void generateTrees(const std::vector<Polygons>& infill_outlines);
 
     /*!
      * How far each piece of infill can support skin in the layer above.
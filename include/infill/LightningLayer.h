@@ -5,24 +5,22 @@
 #define LIGHTNING_LAYER_H
 
 #include <list>
-#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "../utils/SquareGrid.h"
 #include "../utils/polygonUtils.h"
-#include "infill/LightningTreeNode.h"
+#include "infill/LightningForest.h"
 
 namespace cura
 {
-using LightningTreeNodeSPtr = std::shared_ptr<LightningTreeNode>;
-using SparseLightningTreeNodeGrid = SparsePointGridInclusive<std::weak_ptr<LightningTreeNode>>;
+using SparseLightningTreeNodeGrid = SparsePointGridInclusive<size_t>;
 
 struct GroundingLocation
 {
-    LightningTreeNodeSPtr tree_node; //!< not null if the gounding location is on a tree
+    size_t tree_node; //!< not LightningForest::no_node if the gounding location is on a tree
     std::optional<ClosestPolygonPoint> boundary_location; //!< in case the gounding location is on the boundary
-    Point2LL p() const;
+    Point2LL p(const LightningForest& forest) const;
 };
 
 /*!
@@ -33,7 +31,8 @@ struct GroundingLocation
 class LightningLayer
 {
 public:
-    std::vector<LightningTreeNodeSPtr> tree_roots;
+    LightningForest forest; //!< The nodes of all trees of this layer.
+    std::vector<size_t> tree_roots; //!< The roots of the trees in \ref forest.
 
     void generateNewTrees(
         const Polygons& current_overhang,
@@ -52,17 +51,17 @@ public:
         const coord_t supporting_radius,
         const coord_t wall_supporting_radius,
         const SparseLightningTreeNodeGrid& tree_node_locator,
-        const LightningTreeNodeSPtr& exclude_tree = nullptr);
+        const size_t exclude_tree = LightningForest::no_node);
 
     /*!
      * \param[out] new_child The new child node introduced
-     * \param[out] new_root The new root node if one had been made
+     * \param[out] new_root The new root node if one had been made, otherwise left unchanged
      * \return Whether a new root was added
      */
-    bool attach(const Point2LL& unsupported_location, const GroundingLocation& ground, LightningTreeNodeSPtr& new_child, LightningTreeNodeSPtr& new_root);
+    bool attach(const Point2LL& unsupported_location, const GroundingLocation& ground, size_t& new_child, size_t& new_root);
 
     void reconnectRoots(
-        std::vector<LightningTreeNodeSPtr>& to_be_reconnected_tree_roots,
+        const std::vector<size_t>& to_be_reconnected_tree_roots,
         const Polygons& current_outlines,
         const LocToLineGrid& outline_locator,
         const coord_t supporting_radius,
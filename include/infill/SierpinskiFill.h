@@ -5,7 +5,8 @@
 #ifndef INFILL_SIERPINSKI_FILL_H
 #define INFILL_SIERPINSKI_FILL_H
 
-#include <list>
+#include <limits>
+#include <vector>
 
 #include "../utils/AABB.h"
 
@@ -334,16 +335,36 @@ protected:
 
     SierpinskiTriangle root_; //! The (root of the) tree containing all possible triangles of the subdivision.
 
+    //! Index used for the end of the \ref sequence_ in both directions.
+    static constexpr size_t no_sequence_idx = std::numeric_limits<size_t>::max();
+
+    /*!
+     * An element of the \ref sequence_, linked to its neighbors by their index.
+     */
+    struct SequenceNode
+    {
+        SierpinskiTriangle* triangle_; //!< The triangle crossed by the fractal at this point in the sequence.
+        size_t prev_; //!< The index of the previous element in the sequence, or \ref no_sequence_idx if this is the first.
+        size_t next_; //!< The index of the next element in the sequence, or \ref no_sequence_idx if this is the last.
+    };
+
     /*!
      * The triangles of the subdivision which are crossed by the fractal.
      * This sequence is created by \ref createLowerBoundSequence and updated by \ref diffuseError
+     *
+     * The elements are stored in one array, in the order in which they were inserted. Their order in the sequence is
+     * given by their links. A subdivided triangle is replaced in place by its first child.
      */
-    std::list<SierpinskiTriangle*> sequence_;
+    std::vector<SequenceNode> sequence_;
+
+    size_t sequence_first_ = no_sequence_idx; //!< The index of the first element of the \ref sequence_.
 
 
     /*!
      * Calculate all possible subdivision triangles and their statistics.
      * Fill in all fields of each SierpinskiTriangle created, except its \ref error_left and its \ref error_right
+     *
+     * The statistics of the subtrees below the top few levels of the tree are calculated in parallel.
      */
     void createTree();
 
@@ -353,12 +374,21 @@ protected:
     //! Calculate the area and realized length of all nodes in the subtree below this \p sub_root.
     void createTreeStatistics(SierpinskiTriangle& sub_root);
 
+    //! Calculate the area and realized length of this \p triangle only.
+    void createNodeStatistics(SierpinskiTriangle& triangle);
+
     /*!
      * Calculate the requested length of all nodes in the subtree below this \p sub_root from their children.
      * For root nodes, retrieve the requested length from the \ref density_provider.
      */
     void createTreeRequestedLengths(SierpinskiTriangle& sub_root);
 
+    /*!
+     * Calculate the requested length of this \p triangle from its children, of which the requested length must be known.
+     * For leaves, retrieve the requested length from the \ref density_provider.
+     */
+    void createNodeRequestedLength(SierpinskiTriangle& triangle);
+
 
     /*!
      * Create the sequence of triangles which have a density just below the requested density,
@@ -368,8 +398,10 @@ protected:
 
     /*!
      * Order the triangles on depth.
+     *
+     * \return For each recursion depth the indices in \ref sequence_ of the triangles at that depth, in sequence order.
      */
-    std::vector<std::vector<std::list<SierpinskiTriangle*>::iterator>> getDepthOrdered();
+    std::vector<std::vector<size_t>> getDepthOrdered();
 
     /*!
      * For each noe: subdivide if possible.
@@ -392,11 +424,18 @@ protected:
      * Subdivide a node into its children.
      * Redistribute leftover errors needed for this subdivision and account for errors needed to keep the children balanced.
      *
-     * \param it iterator to the node to subdivide
+     * \param first_idx The index of the first node to subdivide.
+     * \param last_idx The index of the last node to subdivide, inclusive.
      * \param redistribute_errors Whether to redistribute the accumulated errors to neighboring nodes and/or among children
-     * \return The last child, so that we can iterate further through the sequence on the input iterator.
+     * \return The index of the last child, so that we can iterate further through the sequence from there.
      */
-    std::list<SierpinskiTriangle*>::iterator subdivide(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end, bool redistribute_errors);
+    size_t subdivide(size_t first_idx, size_t last_idx, bool redistribute_errors);
+
+    /*!
+     * Insert a \p triangle into the sequence, right after the element at index \p idx .
+     * \return The index of the new element.
+     */
+    size_t insertAfter(size_t idx, SierpinskiTriangle* triangle);
 
 
     /*!
@@ -405,8 +444,11 @@ protected:
      * and pass along the error from whence it came.
      *
      * This is called just before performing a subdivision.
+     *
+     * \param first_idx The index of the first node of the range.
+     * \param last_idx The index of the last node of the range, inclusive.
      */
-    void redistributeLeftoverErrors(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end, bool distribute_subdivision_errors);
+    void redistributeLeftoverErrors(size_t first_idx, size_t last_idx, bool distribute_subdivision_errors);
 
     /*!
      * Balance child values such that they account for the minimum value of their recursion level.
@@ -418,9 +460,10 @@ protected:
      * In order to compensate for the error incurred, we more error value from the high child to the low child
      * such that the low child has an erroredValue of at least the density_value associated with the recusion depth.
      *
-     * \param node The parent node of the children to balance
+     * \param first_idx The index of the first child to balance.
+     * \param last_idx The index of the last child to balance, inclusive.
      */
-    void balanceErrors(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end);
+    void balanceErrors(size_t first_idx, size_t last_idx);
 
     /*!
      * Settle down unused errors which have been bubbled up, but haven't been used to subdivide any cell.
@@ -436,18 +479,18 @@ protected:
     void diffuseError();
 
     /*!
-     * \return whether a node \p it in the sequence is constrained by the previous node.
+     * \return whether the node at index \p idx in the sequence is constrained by the previous node.
      */
-    bool isConstrainedBackward(std::list<SierpinskiTriangle*>::iterator it);
+    bool isConstrainedBackward(size_t idx) const;
     /*!
-     * \return whether a node \p it in the sequence is constrained by the next node.
+     * \return whether the node at index \p idx in the sequence is constrained by the next node.
      */
-    bool isConstrainedForward(std::list<SierpinskiTriangle*>::iterator it);
+    bool isConstrainedForward(size_t idx) const;
 
     /*!
-     * \return the requested value left over if we would subdivide all nodes in the sequence from \p begin to \p end
+     * \return the requested value left over if we would subdivide all nodes in the sequence from \p first_idx to \p last_idx inclusive
      */
-    double getSubdivisionError(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end);
+    double getSubdivisionError(size_t first_idx, size_t last_idx) const;
 
     /*!
      * Check whether all properties which should hold at any time during the algorithm hold for the current sequence.
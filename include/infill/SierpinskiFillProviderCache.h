@@ -0,0 +1,83 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef INFILL_SIERPINSKI_FILL_PROVIDER_CACHE_H
+#define INFILL_SIERPINSKI_FILL_PROVIDER_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../utils/Coord_t.h"
+#include "../utils/NoCopy.h"
+
+namespace cura
+{
+
+struct AABB3D;
+class SierpinskiFillProvider;
+
+/*!
+ * \brief Keeps the cross infill fractals around between slices.
+ *
+ * Precomputing the Sierpinski fractal of the cross infill and cross support patterns takes a while, and only depends on
+ * the bounding box it has to cover, the line distance, the line width and the density image. When the front-end reslices
+ * a scene after changing some other setting, those are usually unchanged, so the fractals of the previous slice can be
+ * used again. Within a slice, meshes and support with the same inputs share one fractal too.
+ *
+ * Like the SlicerCache, only the entries that were used by the previous slice are kept, and nothing is kept between
+ * slices unless the communication channel can request multiple slices from the same engine process.
+ */
+class SierpinskiFillProviderCache : NoCopy
+{
+public:
+    /*!
+     * Get the cache shared by all slices of this engine process.
+     */
+    static SierpinskiFillProviderCache& getInstance();
+
+    /*!
+     * \brief Get the fractal for the given inputs, creating it if no slice created it before.
+     *
+     * The parameters are the same as those of the SierpinskiFillProvider constructors.
+     * \param density_image_file The image that determines the density, or empty for a uniform density.
+     * \return The fractal, which is shared with everyone who asked for the same inputs. It may only be used to generate
+     * patterns from.
+     */
+    std::shared_ptr<SierpinskiFillProvider> get(const AABB3D& aabb_3d, const coord_t min_line_distance, const coord_t line_width, const std::string& density_image_file = "");
+
+    /*!
+     * \brief Mark the start of a new slice.
+     *
+     * Entries created or used during the previous slice remain available. All older entries are dropped.
+     */
+    void startSlice();
+
+    /*!
+     * \brief Mark the end of a slice.
+     *
+     * Entries from before this slice that it didn't use are dropped.
+     */
+    void finishSlice();
+
+    /*!
+     * Drop all entries.
+     */
+    void clear();
+
+private:
+    /*!
+     * Hash all the input of the SierpinskiFillProvider that determines its output.
+     */
+    static uint64_t hashInput(const AABB3D& aabb_3d, const coord_t min_line_distance, const coord_t line_width, const std::string& density_image_file);
+
+    std::mutex mutex_; //!< Guards the entries. Meshes and support may ask for their fractals from different threads.
+    std::unordered_map<uint64_t, std::shared_ptr<SierpinskiFillProvider>> entries_; //!< The entries created or used by the current slice.
+    std::unordered_map<uint64_t, std::shared_ptr<SierpinskiFillProvider>> previous_entries_; //!< The entries of the previous slice that haven't been used yet.
+};
+
+} // namespace cura
+
+#endif // INFILL_SIERPINSKI_FILL_PROVIDER_CACHE_H
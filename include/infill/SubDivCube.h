@@ -4,6 +4,9 @@
 #ifndef INFILL_SUBDIVCUBE_H
 #define INFILL_SUBDIVCUBE_H
 
+#include <cstdint>
+#include <vector>
+
 #include "settings/types/LayerIndex.h"
 #include "settings/types/Ratio.h"
 #include "utils/Point2LL.h"
@@ -19,12 +22,11 @@ class SubDivCube
 {
 public:
     /*!
-     * Constructor for SubDivCube. Recursively calls itself eight times to flesh out the octree.
+     * Constructor for SubDivCube. Builds the octree of subdivided cubes one level after the other.
      * \param mesh contains infill layer data and settings
-     * \param my_center the center of the cube
-     * \param depth the recursion depth of the cube (0 is most recursed)
+     * \param infill_origin the center of the outermost cube
      */
-    SubDivCube(SliceMeshStorage& mesh, Point3LL& center, size_t depth);
+    SubDivCube(SliceMeshStorage& mesh, const Point2LL& infill_origin);
 
     /*!
      * Precompute the octree of subdivided cubes
@@ -33,21 +35,14 @@ public:
     static void precomputeOctree(SliceMeshStorage& mesh, const Point2LL& infill_origin);
 
     /*!
-     * Generates the lines of subdivision of the specific cube at the specific layer. It recursively calls itself, so it ends up drawing all the subdivision lines of sub-cubes too.
+     * Generates the lines of subdivision of all cubes at the specific layer. Only the cubes that touch the layer and
+     * their children are visited.
      * \param z the specified layer height
      * \param result (output) The resulting lines
      */
-    void generateSubdivisionLines(const coord_t z, Polygons& result);
+    void generateSubdivisionLines(const coord_t z, Polygons& result) const;
 
 private:
-    /*!
-     * Generates the lines of subdivision of the specific cube at the specific layer. It recursively calls itself, so it ends up drawing all the subdivision lines of sub-cubes too.
-     * \param z the specified layer height
-     * \param result (output) The resulting lines
-     * \param directional_line_groups Array of 3 times a polylines. Used to keep track of line segments that are all pointing the same direction for line segment combining
-     */
-    void generateSubdivisionLines(const coord_t z, Polygons (&directional_line_groups)[3]);
-
     struct CubeProperties
     {
         coord_t side_length; //!< side length of cubes
@@ -57,6 +52,25 @@ private:
         coord_t max_line_offset; //!< maximum line offsets. This is the maximum distance at which subdivision lines should be drawn from the 2d cube center.
     };
 
+    /*!
+     * A cube in the octree. The children of a cube are stored consecutively.
+     */
+    struct Cube
+    {
+        Point3LL center; //!< center location of the cube in absolute coordinates
+        uint32_t first_child; //!< index in \ref cubes_ of the first of this cube's children
+        uint8_t child_count; //!< number of octree children of this cube, up to eight
+    };
+
+    /*!
+     * Draws the subdivision lines of a single cube at the specific layer.
+     * \param cube the cube to draw the lines of
+     * \param cube_properties the properties of cubes at the recursion depth of the \p cube
+     * \param z the specified layer height
+     * \param directional_line_groups Array of 3 times a polylines. Used to keep track of line segments that are all pointing the same direction for line segment combining
+     */
+    void generateSubdivisionLines(const Cube& cube, const CubeProperties& cube_properties, const coord_t z, Polygons (&directional_line_groups)[3]) const;
+
     /*!
      * Rotates a point 120 degrees about the origin.
      * \param target the point to rotate.
@@ -67,41 +81,44 @@ private:
      * Rotates a point to align it with the orientation of the infill.
      * \param target the point to rotate.
      */
-    static void rotatePointInitial(Point2LL& target);
+    void rotatePointInitial(Point2LL& target) const;
 
     /*!
      * Determines if a described theoretical cube should be subdivided based on if a sphere that encloses the cube touches the infill mesh.
-     * \param mesh contains infill layer data and settings
+     * \param layer_infill_areas the infill areas of each layer of the mesh
+     * \param layer_height the layer height of the mesh
      * \param center the center of the described cube
      * \param radius the radius of the enclosing sphere
      * \return the described cube should be subdivided
      */
-    static bool isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, coord_t radius);
+    static bool isValidSubdivision(const std::vector<Polygons>& layer_infill_areas, const coord_t layer_height, const Point3LL& center, coord_t radius);
 
     /*!
      * Finds the distance to the infill border at the specified layer from the specified point.
-     * \param mesh contains infill layer data and settings
+     * \param layer_infill_areas the infill areas of each layer of the mesh
      * \param layer_nr the number of the specified layer
      * \param location the location of the specified point
      * \param[out] distance2 the squared distance to the infill border
      * \return Code 0: outside, 1: inside, 2: boundary does not exist at specified layer
      */
-    static coord_t distanceFromPointToMesh(SliceMeshStorage& mesh, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2);
+    static coord_t distanceFromPointToMesh(const std::vector<Polygons>& layer_infill_areas, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2);
 
     /*!
      * Adds the defined line to the specified polygons. It assumes that the specified polygons are all parallel lines. Combines line segments with touching ends closer than
      * epsilon. \param[out] group the polygons to add the line to \param from the first endpoint of the line \param to the second endpoint of the line
      */
-    void addLineAndCombine(Polygons& group, Point2LL from, Point2LL to);
-
-    size_t depth_; //!< the recursion depth of the cube (0 is most recursed)
-    Point3LL center_; //!< center location of the cube in absolute coordinates
-    std::array<std::shared_ptr<SubDivCube>, 8> children_; //!< pointers to this cube's eight octree children
-    static std::vector<CubeProperties> cube_properties_per_recursion_step_; //!< precomputed array of basic properties of cubes based on recursion depth.
-    static Ratio radius_multiplier_; //!< multiplier for the bounding radius when determining if a cube should be subdivided
-    static Point3Matrix rotation_matrix_; //!< The rotation matrix to get from axis aligned cubes to cubes standing on a corner point aligned with the infill_angle
-    static PointMatrix infill_rotation_matrix_; //!< Horizontal rotation applied to infill
-    static coord_t radius_addition_; //!< addition to the bounding radius when determining if a cube should be subdivided
+    static void addLineAndCombine(Polygons& group, Point2LL from, Point2LL to);
+
+    /*!
+     * All cubes of the octree, breadth-first. The outermost cube comes first, then the cubes of each next recursion
+     * depth.
+     */
+    std::vector<Cube> cubes_;
+    size_t root_depth_ = 0; //!< the recursion depth of the outermost cube (0 is most recursed)
+    std::vector<CubeProperties> cube_properties_per_recursion_step_; //!< precomputed array of basic properties of cubes based on recursion depth.
+    Point3Matrix rotation_matrix_; //!< The rotation matrix to get from axis aligned cubes to cubes standing on a corner point aligned with the infill_angle
+    PointMatrix infill_rotation_matrix_; //!< Horizontal rotation applied to infill
+    coord_t radius_addition_; //!< addition to the bounding radius when determining if a cube should be subdivided
 };
 
 } // namespace cura
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef INFILL_SUPPORT_INFILL_CACHE_H
+#define INFILL_SUPPORT_INFILL_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "settings/EnumSettings.h"
+#include "utils/Coord_t.h"
+#include "utils/ExtrusionLine.h"
+#include "utils/NoCopy.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+/*!
+ * \brief The infill that is generated for an area of support, with one density.
+ *
+ * These never change once made, so layers with the same support areas can share them.
+ */
+struct SupportInfillLines
+{
+    std::vector<VariableWidthLines> toolpaths; //!< The walls that the pattern generates, such as those of narrow areas. Binned by inset_idx.
+    Polygons polygons; //!< The closed lines of the pattern.
+    Polygons lines; //!< The open lines of the pattern.
+};
+
+/*!
+ * \brief Remembers the support infill of recent layers, so that layers with the same support area and pattern as one of
+ * them can share its lines.
+ *
+ * Support areas are often the same for long stretches of layers, such as under flat overhangs, and the support infill
+ * angle cycles through only a few angles. An area is looked up by the polygons that are filled and the parameters of the
+ * Infill that fills them. Only patterns that are the same on every layer may be cached, see \ref isCacheable.
+ *
+ * The cache can be used from several threads at once, so the layers that are processed at the same time share it.
+ */
+class SupportInfillCache : public NoCopy
+{
+public:
+    //! What the support infill of an area is made of.
+    struct Key
+    {
+        std::vector<coord_t> parameters; //!< The pattern, angle, line distance and the other parameters of the Infill.
+        Polygons area; //!< The area that is filled.
+
+        bool operator==(const Key& other) const;
+    };
+
+    /*!
+     * \param capacity How many areas to remember. When it is full, the area that was added first is forgotten.
+     */
+    explicit SupportInfillCache(const size_t capacity = 64);
+
+    /*!
+     * \brief Whether the infill of a pattern only depends on the area and the parameters in the key.
+     *
+     * Patterns that change with the height of the layer, or that need more than the area to be generated, can't be
+     * cached.
+     */
+    static bool isCacheable(const EFillMethod pattern);
+
+    /*!
+     * \brief Gives the support infill that is made of \p key, generating it if it is not remembered.
+     *
+     * \param key What the support infill is made of.
+     * \param compute Generates the support infill if it is not remembered. It is called without holding any lock, so two
+     * threads may generate the same infill at the same time.
+     * \return The support infill.
+     */
+    std::shared_ptr<const SupportInfillLines> get(Key key, const std::function<std::shared_ptr<const SupportInfillLines>()>& compute) const;
+
+    //! How many times the support infill was found.
+    size_t hitCount() const;
+
+    //! How many times the support infill had to be generated.
+    size_t missCount() const;
+
+private:
+    struct Entry
+    {
+        uint64_t hash;
+        Key key;
+        std::shared_ptr<const SupportInfillLines> lines;
+    };
+
+    //! Gives a hash of a key, to quickly skip most entries that differ.
+    static uint64_t hash(const Key& key);
+
+    size_t capacity_;
+
+    //! Guards entries_. The entries themselves never change, so they can be read after the lock is released.
+    mutable std::mutex mutex_;
+
+    //! The remembered support infill, from the oldest to the newest.
+    mutable std::deque<std::shared_ptr<const Entry>> entries_;
+
+    mutable std::atomic<size_t> hit_count_{ 0 };
+    mutable std::atomic<size_t> miss_count_{ 0 };
+};
+
+} // namespace cura
+
+#endif // INFILL_SUPPORT_INFILL_CACHE_H
@@ -4,6 +4,8 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <array>
+
 #include "settings/Settings.h"
 #include "utils/AABB3D.h"
 #include "utils/Matrix4x3D.h"
@@ -78,7 +80,44 @@ public:
     Mesh();
 
     void addFace(Point3LL& v0, Point3LL& v1, Point3LL& v2); //!< add a face to the mesh without settings it's connected_faces.
+
+    /*!
+     * Add a whole triangle soup to the mesh at once, without setting the connected_faces.
+     *
+     * This gives the same vertices and faces as calling addFace for every
+     * triangle in order, but the vertices are welded by sorting their
+     * quantized locations on the thread pool rather than by looking each of
+     * them up in the vertex hash map.
+     * \param corners The corners of the triangles, three consecutive corners
+     * per triangle.
+     */
+    void addFaces(const std::vector<Point3LL>& corners);
+
+    /*!
+     * Add a mesh of which the vertices have already been welded, without setting the connected_faces.
+     *
+     * The vertices are taken as they are: they are neither welded to each
+     * other nor to the vertices already in this mesh. Faces with a repeated
+     * vertex are skipped, like in addFace.
+     * \param vertices The vertices to add.
+     * \param face_vertex_indices For each face, the indices of its corners in
+     * \p vertices, in counter-clockwise order.
+     * \return False if a vertex index is out of range, in which case nothing
+     * is added.
+     */
+    bool addIndexedFaces(const std::vector<Point3LL>& vertices, const std::vector<std::array<uint32_t, 3>>& face_vertex_indices);
     void clear(); //!< clears all data
+
+    /*!
+     * \brief Free the faces and vertices, keeping the settings and the
+     * bounding box.
+     *
+     * Unlike \ref clear, this gives the memory of the faces and vertices back.
+     * It's meant for after slicing, when only the settings and the bounding
+     * box of the mesh are still used.
+     * \return The number of bytes that were freed.
+     */
+    size_t releaseGeometry();
     void finish(); //!< complete the model : set the connected_face_index fields of the faces.
 
     Point3LL min() const; //!< min (in x,y and z) vertex of the bounding box
@@ -137,9 +176,10 @@ private:
      * \param idx1 the second vertex index
      * \param notFaceIdx the index of a face which shouldn't be returned
      * \param notFaceVertexIdx should be the third vertex of face \p notFaceIdx.
+     * \param candidateFaces the other faces sharing the edge, in order of face index.
      * \return the face index of a face sharing the edge from \p idx0 to \p idx1
      */
-    int getFaceIdxWithPoints(int idx0, int idx1, int notFaceIdx, int notFaceVertexIdx) const;
+    int getFaceIdxWithPoints(int idx0, int idx1, int notFaceIdx, int notFaceVertexIdx, const std::vector<int>& candidateFaces) const;
 };
 
 } // namespace cura
@@ -6,10 +6,14 @@
 
 #include <limits> // To find the maximum for coord_t.
 #include <memory> // shared_ptr
+#include <optional>
+#include <unordered_map>
 
 #include "../settings/types/LayerIndex.h" // To store the layer on which we comb.
+#include "../utils/FlatPolygons.h"
 #include "../utils/polygon.h"
 #include "../utils/polygonUtils.h"
+#include "CombBoundaryCache.h"
 
 namespace cura
 {
@@ -134,12 +138,14 @@ private:
     static constexpr coord_t offset_dist_to_get_from_on_the_polygon_to_outside_ = 40; //!< in order to prevent on-boundary vs crossing boundary confusions (precision thing)
     static constexpr coord_t offset_extra_start_end_ = 100; //!< Distance to move start point and end point toward eachother to extra avoid collision with the boundaries.
 
-    Polygons boundary_inside_minimum_; //!< The boundary within which to comb. (Will be reordered by the partsView_inside_minimum)
-    Polygons boundary_inside_optimal_; //!< The boundary within which to comb. (Will be reordered by the partsView_inside_optimal)
-    const PartsView parts_view_inside_minimum_; //!< Structured indices onto boundary_inside_minimum which shows which polygons belong to which part.
-    const PartsView parts_view_inside_optimal_; //!< Structured indices onto boundary_inside_optimal which shows which polygons belong to which part.
-    std::unique_ptr<LocToLineGrid> inside_loc_to_line_minimum_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
-    std::unique_ptr<LocToLineGrid> inside_loc_to_line_optimal_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
+    std::shared_ptr<const CombBoundaries> boundaries_; //!< The comb boundaries of the layer, possibly shared with other layers that have the same outlines.
+    const Polygons& boundary_inside_minimum_; //!< The boundary within which to comb. (Reordered by the partsView_inside_minimum)
+    const Polygons& boundary_inside_optimal_; //!< The boundary within which to comb. (Reordered by the partsView_inside_optimal)
+    std::optional<FlatPolygons> flat_boundary_inside_optimal_; //!< A flat copy of boundary_inside_optimal for the inside tests of moveCombPathInside, made when first needed.
+    const PartsView& parts_view_inside_minimum_; //!< Structured indices onto boundary_inside_minimum which shows which polygons belong to which part.
+    const PartsView& parts_view_inside_optimal_; //!< Structured indices onto boundary_inside_optimal which shows which polygons belong to which part.
+    const LocToLineGrid& inside_loc_to_line_minimum_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
+    const LocToLineGrid& inside_loc_to_line_optimal_; //!< The SparsePointGridInclusive mapping locations to line segments of the inner boundary.
     std::unordered_map<size_t, Polygons> boundary_outside_; //!< The boundary outside of which to stay to avoid collision with other layer parts. This is a pointer cause we only
                                                             //!< compute it when we move outside the boundary (so not when there is only a single part in the layer)
     std::unordered_map<size_t, Polygons> model_boundary_; //!< The boundary of the model itself
@@ -149,6 +155,19 @@ private:
     coord_t move_inside_distance_; //!< When using comb_boundary_inside_minimum for combing it tries to move points inside by this amount after calculating the path to move it from
                                    //!< the border a bit.
 
+    /*!
+     * Where a travel endpoint ended up after moving it inside one of the inside boundaries.
+     */
+    struct MovedInside
+    {
+        Point2LL point; //!< The point after moving it inside.
+        size_t inside_poly; //!< The polygon in which the point has been moved, if \ref moved_inside.
+        bool moved_inside; //!< Whether the point could be moved inside.
+    };
+    std::unordered_map<Point2LL, MovedInside> moved_inside_minimum_; //!< Travel endpoints that were moved inside boundary_inside_minimum before. Many travels of a layer
+                                                                      //!< start or end at the same points, such as the seams of parts.
+    std::unordered_map<Point2LL, MovedInside> moved_inside_optimal_; //!< Travel endpoints that were moved inside boundary_inside_optimal before.
+
     /*!
      * Get the SparsePointGridInclusive mapping locations to line segments of the outside boundary. Calculate it when it hasn't been calculated yet.
      */
@@ -173,13 +192,25 @@ private:
      * Move the startPoint or endPoint inside when it should be inside
      * \param is_inside[in] Whether the \p dest_point should be inside
      * \param inside_loc_to_line[in] A SparseGrid mapping locations to line segments of \p polygons
+     * \param moved_inside[in,out] Where points were moved inside \p boundary_inside before, to reuse those results.
      * \param dest_point[in,out] The point to move
      * \param start_inside_poly[out] The polygon in which the point has been moved
      * \return Whether we have moved the point inside
      */
-    bool moveInside(Polygons& boundary_inside, bool is_inside, LocToLineGrid* inside_loc_to_line, Point2LL& dest_point, size_t& start_inside_poly);
+    bool moveInside(
+        const Polygons& boundary_inside,
+        bool is_inside,
+        const LocToLineGrid* inside_loc_to_line,
+        std::unordered_map<Point2LL, MovedInside>& moved_inside,
+        Point2LL& dest_point,
+        size_t& start_inside_poly);
+
+    /*!
+     * Get the flat copy of boundary_inside_optimal. Make it when it hasn't been made yet.
+     */
+    const FlatPolygons& getFlatBoundaryInsideOptimal();
 
-    void moveCombPathInside(Polygons& boundary_inside, Polygons& boundary_inside_optimal, CombPath& comb_path_input, CombPath& comb_path_output);
+    void moveCombPathInside(const Polygons& boundary_inside, const FlatPolygons& boundary_inside_optimal, CombPath& comb_path_input, CombPath& comb_path_output);
 
 public:
     /*!
@@ -212,6 +243,32 @@ public:
         coord_t travel_avoid_distance,
         coord_t move_inside_distance);
 
+    /*!
+     * Initialises the combing areas for every mesh in the layer (not support),
+     * from comb boundaries that were already prepared.
+     *
+     * \param storage Where the layer polygon data is stored.
+     * \param layer_nr The number of the layer for which to generate the combing
+     * areas.
+     * \param boundaries The comb boundaries within which to comb within layer
+     * parts. Their grids have to be made with \p offset_from_outlines as cell
+     * size.
+     * \param offset_from_outlines The offset from the outline polygon, to
+     * create the combing boundary in case there is no second wall.
+     * \param travel_avoid_distance The distance by which to avoid other layer
+     * parts when travelling through air.
+     * \param move_inside_distance When using comb_boundary_inside_minimum for
+     * combing it tries to move points inside by this amount after calculating
+     * the path to move it from the border a bit.
+     */
+    Comb(
+        const SliceDataStorage& storage,
+        const LayerIndex layer_nr,
+        std::shared_ptr<const CombBoundaries> boundaries,
+        coord_t offset_from_outlines,
+        coord_t travel_avoid_distance,
+        coord_t move_inside_distance);
+
     /*!
      * \brief Calculate the comb paths (if any), one for each polygon combed
      * alternated with travel paths.
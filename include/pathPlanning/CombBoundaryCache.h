@@ -0,0 +1,117 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef PATH_PLANNING_COMB_BOUNDARY_CACHE_H
+#define PATH_PLANNING_COMB_BOUNDARY_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "utils/Coord_t.h"
+#include "utils/NoCopy.h"
+#include "utils/polygon.h"
+#include "utils/polygonUtils.h"
+
+namespace cura
+{
+
+/*!
+ * \brief The comb boundaries of a layer, with what Comb prepares from them to comb within them.
+ *
+ * These never change once made, so layers with the same outlines can share them.
+ */
+struct CombBoundaries : public NoCopy
+{
+    /*!
+     * \param minimum The minimum boundary within which to comb.
+     * \param preferred The boundary preferably within which to comb.
+     * \param grid_cell_size The cell size of the grids that map locations to the line segments of the boundaries.
+     */
+    CombBoundaries(Polygons minimum, Polygons preferred, const coord_t grid_cell_size);
+
+    const Polygons minimum; //!< The minimum boundary within which to comb, as it was made.
+    const Polygons preferred; //!< The boundary preferably within which to comb, as it was made.
+
+    Polygons inside_minimum; //!< The minimum boundary, with its polygons reordered by \ref parts_view_inside_minimum.
+    Polygons inside_optimal; //!< The preferred boundary, with its polygons reordered by \ref parts_view_inside_optimal.
+    PartsView parts_view_inside_minimum; //!< Structured indices onto \ref inside_minimum which show which polygons belong to which part.
+    PartsView parts_view_inside_optimal; //!< Structured indices onto \ref inside_optimal which show which polygons belong to which part.
+    std::unique_ptr<LocToLineGrid> inside_loc_to_line_minimum; //!< Maps locations to the line segments of \ref inside_minimum.
+    std::unique_ptr<LocToLineGrid> inside_loc_to_line_optimal; //!< Maps locations to the line segments of \ref inside_optimal.
+};
+
+/*!
+ * \brief Remembers the comb boundaries of recent layers, so that layers with the same outlines as one of them can share
+ * its comb boundaries.
+ *
+ * The comb boundaries of a layer are the union of the offset outlines of all meshes, which is computed for every layer
+ * plan. On the straight stretches of most prints, many layers have the same outlines. A layer is looked up by what the
+ * boundaries are made of: the polygons that are offset and the parameters of the offsets.
+ *
+ * The cache can be used from several threads at once, so the layer plans that are made at the same time share it.
+ */
+class CombBoundaryCache : public NoCopy
+{
+public:
+    //! What the comb boundaries of a layer are made of.
+    struct Key
+    {
+        std::vector<coord_t> parameters; //!< The offsets, combing modes and the number of polygons that each step takes from \ref polygons.
+        Polygons polygons; //!< All polygons that the boundaries are made of, in the order in which they are used.
+
+        bool operator==(const Key& other) const;
+    };
+
+    /*!
+     * \param capacity How many layers to remember. When it is full, the layer that was added first is forgotten.
+     */
+    explicit CombBoundaryCache(const size_t capacity = 16);
+
+    /*!
+     * \brief Gives the comb boundaries that are made of \p key, computing them if they are not remembered.
+     *
+     * \param key What the comb boundaries are made of.
+     * \param compute Computes the comb boundaries if they are not remembered. It is called without holding any lock, so
+     * two threads may compute the same boundaries at the same time.
+     * \return The comb boundaries.
+     */
+    std::shared_ptr<const CombBoundaries> get(Key key, const std::function<std::shared_ptr<const CombBoundaries>()>& compute) const;
+
+    //! How many times the comb boundaries were found.
+    size_t hitCount() const;
+
+    //! How many times the comb boundaries had to be computed.
+    size_t missCount() const;
+
+private:
+    struct Entry
+    {
+        uint64_t hash;
+        Key key;
+        std::shared_ptr<const CombBoundaries> boundaries;
+    };
+
+    //! Gives a hash of a key, to quickly skip most entries that differ.
+    static uint64_t hash(const Key& key);
+
+    size_t capacity_;
+
+    //! Guards entries_. The entries themselves never change, so they can be read after the lock is released.
+    mutable std::mutex mutex_;
+
+    //! The remembered comb boundaries, from the oldest to the newest.
+    mutable std::deque<std::shared_ptr<const Entry>> entries_;
+
+    mutable std::atomic<size_t> hit_count_{ 0 };
+    mutable std::atomic<size_t> miss_count_{ 0 };
+};
+
+} // namespace cura
+
+#endif // PATH_PLANNING_COMB_BOUNDARY_CACHE_H
@@ -5,11 +5,18 @@
 #define PATH_PLANNING_COMB_PATH_H
 
 #include "../utils/Point2LL.h"
+#include "../utils/SmallVector.h"
 
 namespace cura
 {
 
-class CombPath : public std::vector<Point2LL> //!< A single path either inside or outise the parts
+/*!
+ * A single path either inside or outise the parts.
+ *
+ * Most travels comb along only a few points, and the order optimizers find one for every pair of paths that they
+ * consider, so the first points are kept inline rather than on the heap.
+ */
+class CombPath : public SmallVector<Point2LL, 4>
 {
 public:
     bool cross_boundary = false; //!< Whether the path crosses a boundary.
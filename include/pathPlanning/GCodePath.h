@@ -5,6 +5,7 @@
 #define PATH_PLANNING_G_CODE_PATH_H
 
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 #include "GCodePathConfig.h"
@@ -45,7 +46,8 @@ struct GCodePath
     bool perform_z_hop{ false }; //!< Whether to perform a z_hop in this path, which is assumed to be a travel path.
     bool perform_prime{ false }; //!< Whether this path is preceded by a prime (blob)
     bool skip_agressive_merge_hint{ false }; //!< Wheter this path needs to skip merging if any travel paths are in between the extrusions.
-    std::vector<Point2LL> points{}; //!< The points constituting this path.
+    std::pmr::vector<Point2LL> points{}; //!< The points constituting this path. The LayerPlan that plans the path takes these from its arena.
+    double length{ 0.0 }; //!< The length of the moves between the points of this path in mm, not counting the move to the first point. Kept up to date by \ref addPoint.
     bool done{ false }; //!< Path is finished, no more moves should be added, and a new path should be started instead of any appending done to this one.
     double fan_speed{ GCodePathConfig::FAN_SPEED_DEFAULT }; //!< fan speed override for this path, value should be within range 0-100 (inclusive) and ignored otherwise
     TimeMaterialEstimates estimates{}; //!< Naive time and material estimates
@@ -84,6 +86,13 @@ struct GCodePath
      * \return the value of fan_speed if it is in the range 0-100, otherwise the value from the config
      */
     [[nodiscard]] double getFanSpeed() const noexcept;
+
+    /*!
+     * Add a point at the end of this path, and add the move to it to the length of the path.
+     *
+     * \param point The point to move to.
+     */
+    void addPoint(const Point2LL& point);
 };
 
 } // namespace cura
@@ -46,9 +46,12 @@ private:
     };
 
     std::vector<Crossing> crossings_; //!< All crossings of polygons in the LinePolygonsCrossings::boundary with the scanline.
+    std::vector<PolygonsPointIndex> scanline_segments_; //!< The line segments of the boundary in the cells of \ref LinePolygonsCrossings::loc_to_line_grid along the scanline.
 
     const Polygons& boundary_; //!< The boundary not to cross during combing.
-    LocToLineGrid& loc_to_line_grid_; //!< Mapping from locations to line segments of \ref LinePolygonsCrossings::boundary
+    const LocToLineGrid& loc_to_line_grid_; //!< Mapping from locations to line segments of \ref LinePolygonsCrossings::boundary
+    const std::vector<size_t>* grid_poly_indices_; //!< When the boundary is a part assembled from the polygons of \ref LinePolygonsCrossings::loc_to_line_grid, the index
+                                                   //!< in those polygons of each polygon of the boundary. Otherwise nullptr.
     Point2LL start_point_; //!< The start point of the scanline.
     Point2LL end_point_; //!< The end point of the scanline.
 
@@ -65,11 +68,19 @@ private:
     /*!
      * Check if we are crossing the boundaries, and pre-calculate some values.
      *
-     * Sets Comb::transformation_matrix, Comb::transformed_startPoint and Comb::transformed_endPoint
+     * Sets Comb::transformation_matrix, Comb::transformed_startPoint, Comb::transformed_endPoint and LinePolygonsCrossings::scanline_segments
      * \return Whether the line segment from LinePolygonsCrossings::startPoint to LinePolygonsCrossings::endPoint collides with the boundary
      */
     bool lineSegmentCollidesWithBoundary();
 
+    /*!
+     * Find the line segments of the boundary that could cross the scanline, which are those in the cells of the grid that the scanline passes through.
+     *
+     * Only these have to be checked for crossings, rather than every line segment of the boundary.
+     * \return The line segments of the boundary, each once, ordered by polygon and point index like the boundary itself.
+     */
+    std::vector<PolygonsPointIndex> findScanlineSegments() const;
+
     /*!
      * Calculate Comb::crossings.
      * \param fail_on_unavoidable_obstacles When moving over other parts is inavoidable, stop calculation early and return false.
@@ -123,10 +134,18 @@ private:
      * \param start the starting point
      * \param end the end point
      * \param dist_to_move_boundary_point_outside Distance used to move a point from a boundary so that it doesn't intersect with it anymore. (Precision issue)
+     * \param grid_poly_indices When \p boundary is a part assembled from the polygons of \p loc_to_line_grid, the index in those polygons of each polygon of \p boundary.
      */
-    LinePolygonsCrossings(const Polygons& boundary, LocToLineGrid& loc_to_line_grid, Point2LL& start, Point2LL& end, int64_t dist_to_move_boundary_point_outside)
+    LinePolygonsCrossings(
+        const Polygons& boundary,
+        const LocToLineGrid& loc_to_line_grid,
+        Point2LL& start,
+        Point2LL& end,
+        int64_t dist_to_move_boundary_point_outside,
+        const std::vector<size_t>* grid_poly_indices)
         : boundary_(boundary)
         , loc_to_line_grid_(loc_to_line_grid)
+        , grid_poly_indices_(grid_poly_indices)
         , start_point_(start)
         , end_point_(end)
         , dist_to_move_boundary_point_outside_(dist_to_move_boundary_point_outside)
@@ -137,24 +156,29 @@ public:
     /*!
      * The main function of this class: calculate one combing path within the boundary.
      * \param boundary The polygons to follow when calculating the basic combing path
-     * \param loc_to_line_grid A sparse grid mapping cells to all line segments of (at least) \p boundary in those cells
+     * \param loc_to_line_grid A sparse grid mapping cells to all line segments of (at least) \p boundary in those cells. It has to be created from \p boundary itself, not
+     * from a copy, since only the crossings with its line segments are looked up in the grid. If \p boundary is a part assembled from the polygons of the grid, \p grid_poly_indices
+     * has to say which of them it is made of.
      * \param startPoint From where to start the combing move.
      * \param endPoint Where to end the combing move.
      * \param combPath Output parameter: the combing path generated.
      * \param fail_on_unavoidable_obstacles When moving over other parts is inavoidable, stop calculation early and return false.
+     * \param grid_poly_indices When \p boundary is a part assembled from the polygons of \p loc_to_line_grid, the index in those polygons of each polygon of \p boundary,
+     * like a part of a PartsView.
      * \return Whether combing succeeded, i.e. we didn't cross any gaps/other parts
      */
     static bool comb(
         const Polygons& boundary,
-        LocToLineGrid& loc_to_line_grid,
+        const LocToLineGrid& loc_to_line_grid,
         Point2LL startPoint,
         Point2LL endPoint,
         CombPath& combPath,
         int64_t dist_to_move_boundary_point_outside,
         int64_t max_comb_distance_ignored,
-        bool fail_on_unavoidable_obstacles)
+        bool fail_on_unavoidable_obstacles,
+        const std::vector<size_t>* grid_poly_indices = nullptr)
     {
-        LinePolygonsCrossings linePolygonsCrossings(boundary, loc_to_line_grid, startPoint, endPoint, dist_to_move_boundary_point_outside);
+        LinePolygonsCrossings linePolygonsCrossings(boundary, loc_to_line_grid, startPoint, endPoint, dist_to_move_boundary_point_outside, grid_poly_indices);
         return linePolygonsCrossings.generateCombingPath(combPath, max_comb_distance_ignored, fail_on_unavoidable_obstacles);
     };
 };
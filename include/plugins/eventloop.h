@@ -0,0 +1,58 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef PLUGINS_EVENTLOOP_H
+#define PLUGINS_EVENTLOOP_H
+
+#include <thread>
+
+#include <agrpc/grpc_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+namespace cura::plugins
+{
+
+/**
+ * @brief A gRPC event loop that runs on its own thread for as long as it exists.
+ *
+ * Calls to a plugin are spawned on this loop from any thread, so that the loop doesn't have to be set up for every
+ * call, and calls from different threads are in flight at the same time instead of one after the other.
+ */
+class EventLoop
+{
+public:
+    EventLoop()
+        : work_guard_{ grpc_context_.get_executor() }
+        , thread_{ [this]()
+                   {
+                       grpc_context_.run();
+                   } }
+    {
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Finishes the calls that are still in flight and stops the thread.
+     */
+    ~EventLoop()
+    {
+        work_guard_.reset();
+        thread_.join();
+    }
+
+    agrpc::GrpcContext& context() noexcept
+    {
+        return grpc_context_;
+    }
+
+private:
+    agrpc::GrpcContext grpc_context_{};
+    boost::asio::executor_work_guard<agrpc::GrpcContext::executor_type> work_guard_; ///< Keeps the loop running while there are no calls.
+    std::thread thread_;
+};
+
+} // namespace cura::plugins
+
+#endif // PLUGINS_EVENTLOOP_H
@@ -14,8 +14,11 @@
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/use_future.hpp>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <range/v3/utility/semiregular_box.hpp>
 #include <spdlog/spdlog.h>
 
@@ -26,8 +29,11 @@
 #include "cura/plugins/slots/handshake/v0/handshake.pb.h"
 #include "cura/plugins/v0/slot_id.pb.h"
 #include "plugins/broadcasts.h"
+#include "plugins/eventloop.h"
 #include "plugins/exception.h"
 #include "plugins/metadata.h"
+#include "plugins/responsecache.h"
+#include "utils/Trace.h"
 #include "utils/format/thread_id.h"
 #include "utils/types/char_range_literal.h"
 #include "utils/types/generic.h"
@@ -37,6 +43,7 @@
 #include <experimental/coroutine>
 #define USE_EXPERIMENTAL_COROUTINE
 #endif
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
@@ -70,6 +77,9 @@ class PluginProxy
     using invoke_stub_t = Stub;
     using broadcast_stub_t = slots::broadcast::v0::BroadcastService::Stub;
 
+    /// Whether the plugins of this slot answer the same request with the same response, so that the responses can be cached.
+    static constexpr bool is_cacheable{ SlotID == v0::SlotID::SIMPLIFY_MODIFY || SlotID == v0::SlotID::INFILL_GENERATE };
+
     ranges::semiregular_box<invoke_stub_t> invoke_stub_; ///< The gRPC Invoke stub for communication.
     ranges::semiregular_box<broadcast_stub_t> broadcast_stub_; ///< The gRPC Broadcast stub for communication.
 public:
@@ -89,6 +99,7 @@ public:
     PluginProxy(const std::string& name, const std::string& version, std::shared_ptr<grpc::Channel> channel)
         : invoke_stub_{ channel }
         , broadcast_stub_{ channel }
+        , event_loop_{ std::make_shared<EventLoop>() }
     {
         // Connect to the plugin and exchange a handshake
         agrpc::GrpcContext grpc_context;
@@ -145,6 +156,7 @@ public:
         {
             invoke_stub_ = other.invoke_stub_;
             broadcast_stub_ = other.broadcast_stub_;
+            event_loop_ = other.event_loop_;
             valid_ = other.valid_;
             plugin_info_ = other.plugin_info_;
             slot_info_ = other.slot_info_;
@@ -157,6 +169,7 @@ public:
         {
             invoke_stub_ = std::move(other.invoke_stub_);
             broadcast_stub_ = std::move(other.broadcast_stub_);
+            event_loop_ = std::move(other.event_loop_);
             valid_ = std::move(other.valid_);
             plugin_info_ = std::move(other.plugin_info_);
             slot_info_ = std::move(other.slot_info_);
@@ -167,68 +180,85 @@ public:
 
     value_type generate(auto&&... args)
     {
-        agrpc::GrpcContext grpc_context;
-        value_type ret_value{};
-        grpc::Status status;
+        // Blocks until the call is done, so the arguments can be passed by reference.
+        return boost::asio::co_spawn(
+                   event_loop_->context(),
+                   [this, &args...]() -> boost::asio::awaitable<value_type>
+                   {
+                       CURA_TRACE_SCOPE("plugin generate");
+                       grpc::Status status;
+                       value_type ret_value{};
+                       co_await this->generateCall(event_loop_->context(), status, ret_value, std::forward<decltype(args)>(args)...);
+                       throwOnError(status);
+                       co_return ret_value;
+                   },
+                   boost::asio::use_future)
+            .get();
+    }
 
-        boost::asio::co_spawn(
-            grpc_context,
-            [this, &grpc_context, &status, &ret_value, &args...]()
+    /**
+     * @brief Starts a generate call without waiting for it to finish.
+     *
+     * The arguments are copied, so that they don't need to outlive the call. Calls made this way, or from different
+     * threads, are in flight at the same time.
+     *
+     * @return The future result. It rethrows the RemoteException if the call failed.
+     */
+    std::future<value_type> generateAsync(auto&&... args)
+    {
+        return boost::asio::co_spawn(
+            event_loop_->context(),
+            [this, ... args = std::forward<decltype(args)>(args)]() mutable -> boost::asio::awaitable<value_type>
             {
-                return this->generateCall(grpc_context, status, ret_value, std::forward<decltype(args)>(args)...);
+                CURA_TRACE_SCOPE("plugin generate");
+                grpc::Status status;
+                value_type ret_value{};
+                co_await this->generateCall(event_loop_->context(), status, ret_value, args...);
+                throwOnError(status);
+                co_return ret_value;
             },
-            boost::asio::detached);
-        grpc_context.run();
-
-        if (! status.ok()) // TODO: handle different kind of status codes
-        {
-            if (plugin_info_.has_value())
-            {
-                spdlog::error(
-                    "Plugin '{}' running at [{}] for slot {} failed with error: {}",
-                    plugin_info_.value().plugin_name,
-                    plugin_info_.value().peer,
-                    slot_info_.slot_id,
-                    status.error_message());
-                throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
-            }
-            spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
-            throw exceptions::RemoteException(slot_info_, status.error_message());
-        }
-        return ret_value;
+            boost::asio::use_future);
     }
 
     value_type modify(auto& original_value, auto&&... args)
     {
-        agrpc::GrpcContext grpc_context;
-        value_type ret_value{};
-        grpc::Status status;
+        // Blocks until the call is done, so the arguments can be passed by reference.
+        return boost::asio::co_spawn(
+                   event_loop_->context(),
+                   [this, &original_value, &args...]() -> boost::asio::awaitable<value_type>
+                   {
+                       CURA_TRACE_SCOPE("plugin modify");
+                       grpc::Status status;
+                       value_type ret_value{};
+                       co_await this->modifyCall(event_loop_->context(), status, ret_value, original_value, std::forward<decltype(args)>(args)...);
+                       throwOnError(status);
+                       co_return ret_value;
+                   },
+                   boost::asio::use_future)
+            .get();
+    }
 
-        boost::asio::co_spawn(
-            grpc_context,
-            [this, &grpc_context, &status, &ret_value, &original_value, &args...]()
+    /**
+     * @brief Starts a modify call without waiting for it to finish.
+     *
+     * The original value and the arguments are copied, so that they don't need to outlive the call.
+     *
+     * @return The future result. It rethrows the RemoteException if the call failed.
+     */
+    std::future<value_type> modifyAsync(const auto& original_value, auto&&... args)
+    {
+        return boost::asio::co_spawn(
+            event_loop_->context(),
+            [this, original_value, ... args = std::forward<decltype(args)>(args)]() mutable -> boost::asio::awaitable<value_type>
             {
-                return this->modifyCall(grpc_context, status, ret_value, original_value, std::forward<decltype(args)>(args)...);
+                CURA_TRACE_SCOPE("plugin modify");
+                grpc::Status status;
+                value_type ret_value{};
+                co_await this->modifyCall(event_loop_->context(), status, ret_value, original_value, args...);
+                throwOnError(status);
+                co_return ret_value;
             },
-            boost::asio::detached);
-        grpc_context.run();
-
-        if (! status.ok()) // TODO: handle different kind of status codes
-        {
-            if (plugin_info_.has_value())
-            {
-                spdlog::error(
-                    "Plugin '{}' running at [{}] for slot {} failed with error: {}",
-                    plugin_info_.value().plugin_name,
-                    plugin_info_.value().peer,
-                    slot_info_.slot_id,
-                    status.error_message());
-                throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
-            }
-            spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
-            throw exceptions::RemoteException(slot_info_, status.error_message());
-        }
-        return ret_value;
+            boost::asio::use_future);
     }
 
     template<plugins::v0::SlotID Subscription>
@@ -238,33 +268,17 @@ public:
         {
             return;
         }
-        agrpc::GrpcContext grpc_context;
-        grpc::Status status;
-
         boost::asio::co_spawn(
-            grpc_context,
-            [this, &grpc_context, &status, &args...]()
+            event_loop_->context(),
+            [this, &args...]() -> boost::asio::awaitable<void>
             {
-                return this->broadcastCall<Subscription>(grpc_context, status, std::forward<decltype(args)>(args)...);
+                CURA_TRACE_SCOPE("plugin broadcast");
+                grpc::Status status;
+                co_await this->broadcastCall<Subscription>(event_loop_->context(), status, std::forward<decltype(args)>(args)...);
+                throwOnError(status);
             },
-            boost::asio::detached);
-        grpc_context.run();
-
-        if (! status.ok()) // TODO: handle different kind of status codes
-        {
-            if (plugin_info_.has_value())
-            {
-                spdlog::error(
-                    "Plugin '{}' running at [{}] for slot {} failed with error: {}",
-                    plugin_info_.value().plugin_name,
-                    plugin_info_.value().peer,
-                    slot_info_.slot_id,
-                    status.error_message());
-                throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
-            }
-            spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
-            throw exceptions::RemoteException(slot_info_, status.error_message());
-        }
+            boost::asio::use_future)
+            .get();
     }
 
 private:
@@ -278,6 +292,80 @@ private:
         client_context.AddMetadata("cura-thread-id", fmt::format("{}", std::this_thread::get_id()));
     }
 
+    /**
+     * @brief Reports a failed call to the plugin.
+     *
+     * @throws exceptions::RemoteException if the call failed.
+     */
+    void throwOnError(const grpc::Status& status) const
+    {
+        if (status.ok()) // TODO: handle different kind of status codes
+        {
+            return;
+        }
+        if (plugin_info_.has_value())
+        {
+            spdlog::error(
+                "Plugin '{}' running at [{}] for slot {} failed with error: {}",
+                plugin_info_.value().plugin_name,
+                plugin_info_.value().peer,
+                slot_info_.slot_id,
+                status.error_message());
+            throw exceptions::RemoteException(slot_info_, plugin_info_.value(), status.error_message());
+        }
+        spdlog::error("Plugin for slot {} failed with error: {}", slot_info_.slot_id, status.error_message());
+        throw exceptions::RemoteException(slot_info_, status.error_message());
+    }
+
+    /**
+     * @brief Makes the key of the response to a request in the ResponseCache.
+     *
+     * The request is serialized deterministically, so that equal requests give equal keys.
+     *
+     * @return The key, or nullopt if the response isn't cached.
+     */
+    std::optional<std::string> getCacheKey(const google::protobuf::Message& request) const
+    {
+        if (! is_cacheable || ! plugin_info_.has_value() || ! ResponseCache::getInstance().isEnabled())
+        {
+            return std::nullopt;
+        }
+        std::string key = fmt::format("{}\n{}\n{}\n", static_cast<int>(SlotID), plugin_info_.value().plugin_name, plugin_info_.value().plugin_version);
+        {
+            google::protobuf::io::StringOutputStream stream{ &key };
+            google::protobuf::io::CodedOutputStream coded_stream{ &stream };
+            coded_stream.SetSerializationDeterministic(true);
+            request.SerializeToCodedStream(&coded_stream);
+        }
+        return key;
+    }
+
+    /**
+     * @brief Looks up the response to a request in the ResponseCache.
+     *
+     * @return Whether the response was found.
+     */
+    static bool findCachedResponse(const std::optional<std::string>& cache_key, rsp_msg_type& response)
+    {
+        if (! cache_key.has_value())
+        {
+            return false;
+        }
+        const std::optional<std::string> cached_response = ResponseCache::getInstance().find(cache_key.value());
+        return cached_response.has_value() && response.ParseFromString(cached_response.value());
+    }
+
+    /**
+     * @brief Adds the response to a request to the ResponseCache, if the call succeeded.
+     */
+    static void cacheResponse(const std::optional<std::string>& cache_key, const grpc::Status& status, const rsp_msg_type& response)
+    {
+        if (cache_key.has_value() && status.ok())
+        {
+            ResponseCache::getInstance().insert(cache_key.value(), response.SerializeAsString());
+        }
+    }
+
     /**
      * @brief Executes the invokeCall operation with the plugin.
      *
@@ -298,9 +386,14 @@ private:
         // Construct request
         auto request{ req_(std::forward<decltype(args)>(args)...) };
 
-        // Make unary request
+        // Make unary request, unless the plugin answered the same before
         rsp_msg_type response;
-        status = co_await RPC::request(grpc_context, invoke_stub_, client_context, request, response, boost::asio::use_awaitable);
+        const std::optional<std::string> cache_key = getCacheKey(request);
+        if (! findCachedResponse(cache_key, response))
+        {
+            status = co_await RPC::request(grpc_context, invoke_stub_, client_context, request, response, boost::asio::use_awaitable);
+            cacheResponse(cache_key, status, response);
+        }
         ret_value = rsp_(response);
         co_return;
     }
@@ -314,9 +407,14 @@ private:
         // Construct request
         auto request{ req_(original_value, std::forward<decltype(args)>(args)...) };
 
-        // Make unary request
+        // Make unary request, unless the plugin answered the same before
         rsp_msg_type response;
-        status = co_await RPC::request(grpc_context, invoke_stub_, client_context, request, response, boost::asio::use_awaitable);
+        const std::optional<std::string> cache_key = getCacheKey(request);
+        if (! findCachedResponse(cache_key, response))
+        {
+            status = co_await RPC::request(grpc_context, invoke_stub_, client_context, request, response, boost::asio::use_awaitable);
+            cacheResponse(cache_key, status, response);
+        }
         ret_value = std::move(rsp_(original_value, response));
         co_return;
     }
@@ -336,6 +434,7 @@ private:
         co_return;
     }
 
+    std::shared_ptr<EventLoop> event_loop_{}; ///< The event loop that all calls to this plugin run on, shared between copies of this proxy.
     validator_type valid_{}; ///< The validator object for plugin validation.
     req_converter_type req_{}; ///< The Invoke request converter object.
     rsp_converter_type rsp_{}; ///< The Invoke response converter object.
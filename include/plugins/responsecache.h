@@ -0,0 +1,138 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#ifndef PLUGINS_RESPONSECACHE_H
+#define PLUGINS_RESPONSECACHE_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <spdlog/details/os.h>
+#include <spdlog/spdlog.h>
+
+namespace cura::plugins
+{
+
+/**
+ * @brief Remembers the responses of plugins to the requests they got, so that asking the same again skips the call.
+ *
+ * Only slots whose plugins answer the same request with the same response may use it. The key of a response holds the
+ * slot, the name and version of the plugin, and the serialized request, so a different plugin or a new version of it is
+ * asked again.
+ *
+ * The cache lives as long as the engine, so that the responses are reused when slicing again, such as when only a few
+ * settings changed. It holds on to at most the number of megabytes in the CURA_ENGINE_PLUGIN_CACHE_MB environment
+ * variable, forgetting the responses that were used longest ago first. Without that variable nothing is cached.
+ */
+class ResponseCache
+{
+public:
+    static ResponseCache& getInstance()
+    {
+        static ResponseCache instance{ getBudgetFromEnvironment() };
+        return instance;
+    }
+
+    explicit ResponseCache(const size_t budget_bytes)
+        : budget_bytes_{ budget_bytes }
+    {
+    }
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    /**
+     * @brief Whether anything is cached at all, so that callers can skip making the key.
+     */
+    [[nodiscard]] bool isEnabled() const noexcept
+    {
+        return budget_bytes_ > 0;
+    }
+
+    /**
+     * @brief Look up the serialized response to a request, and mark it as used most recently.
+     */
+    [[nodiscard]] std::optional<std::string> find(const std::string& key)
+    {
+        std::scoped_lock lock{ mutex_ };
+        const auto it = entries_.find(key);
+        if (it == entries_.end())
+        {
+            return std::nullopt;
+        }
+        recently_used_.splice(recently_used_.begin(), recently_used_, it->second);
+        return it->second->second;
+    }
+
+    /**
+     * @brief Remember the serialized response to a request, forgetting the least recently used ones beyond the budget.
+     *
+     * A response that is larger than the whole budget isn't remembered.
+     */
+    void insert(const std::string& key, std::string response)
+    {
+        const size_t entry_bytes = key.size() + response.size();
+        if (entry_bytes > budget_bytes_)
+        {
+            return;
+        }
+        std::scoped_lock lock{ mutex_ };
+        if (entries_.contains(key))
+        {
+            return; // Another call with the same request got its response in meanwhile.
+        }
+        recently_used_.emplace_front(key, std::move(response));
+        entries_.emplace(recently_used_.front().first, recently_used_.begin());
+        used_bytes_ += entry_bytes;
+        while (used_bytes_ > budget_bytes_)
+        {
+            const auto& [oldest_key, oldest_response] = recently_used_.back();
+            used_bytes_ -= oldest_key.size() + oldest_response.size();
+            entries_.erase(oldest_key);
+            recently_used_.pop_back();
+        }
+    }
+
+    /**
+     * @brief Forget all responses.
+     */
+    void clear()
+    {
+        std::scoped_lock lock{ mutex_ };
+        entries_.clear();
+        recently_used_.clear();
+        used_bytes_ = 0;
+    }
+
+private:
+    static size_t getBudgetFromEnvironment()
+    {
+        const std::string budget_megabytes = spdlog::details::os::getenv("CURA_ENGINE_PLUGIN_CACHE_MB");
+        if (budget_megabytes.empty())
+        {
+            return 0;
+        }
+        const size_t budget_bytes = std::strtoull(budget_megabytes.c_str(), nullptr, 10) * 1024 * 1024;
+        spdlog::info("Caching up to {} MB of plugin responses.", budget_bytes / (1024 * 1024));
+        return budget_bytes;
+    }
+
+    using entry_list = std::list<std::pair<std::string, std::string>>;
+
+    size_t budget_bytes_; ///< How many bytes of keys and responses the cache may hold on to.
+    size_t used_bytes_{ 0 }; ///< How many bytes of keys and responses the cache holds on to now.
+    entry_list recently_used_; ///< The keys and responses, the one used most recently first.
+    std::unordered_map<std::string_view, entry_list::iterator> entries_; ///< Where in the list each key is, viewing the key in the list.
+    std::mutex mutex_;
+};
+
+} // namespace cura::plugins
+
+#endif // PLUGINS_RESPONSECACHE_H
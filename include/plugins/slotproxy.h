@@ -14,9 +14,12 @@
 
 #include <concepts>
 #include <functional>
+#include <future>
 #include <grpcpp/channel.h>
 #include <memory>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 namespace cura::plugins
 {
@@ -27,6 +30,8 @@ namespace cura::plugins
  * The SlotProxy class template acts as a proxy for a plugin slot and provides an interface
  * for communication with plugins assigned to the slot. It delegates plugin requests to the
  * corresponding PluginProxy object and provides a default behavior when no plugin is available.
+ * The responses of the plugins of slots that answer the same request with the same response, such as simplify and
+ * infill generate, may come from the ResponseCache instead.
  *
  * @tparam SlotID The plugin slot ID.
  * @tparam SlotVersion The version of the indicated slot.
@@ -63,6 +68,16 @@ public:
     SlotProxy(const std::string& name, const std::string& version, std::shared_ptr<grpc::Channel> channel)
         : plugin_{ value_type{ name, version, channel } } {};
 
+    /**
+     * @brief Whether a plugin is assigned to the slot.
+     *
+     * Without one, callers can skip preparing the values that only the plugin would look at.
+     */
+    [[nodiscard]] constexpr bool isConnected() const noexcept
+    {
+        return plugin_.has_value();
+    }
+
     /**
      * @brief Executes the plugin operation.
      *
@@ -96,6 +111,87 @@ public:
         return std::invoke(default_process, original_value, std::forward<decltype(args)>(args)...);
     }
 
+    /**
+     * @brief Starts the plugin operation without waiting for it to finish.
+     *
+     * Calls that are started this way are in flight at the same time. Without a plugin, the default behavior runs
+     * when the result is requested.
+     *
+     * @return The future result of the plugin request or the default behavior.
+     */
+    auto generateAsync(auto&&... args)
+    {
+        if (plugin_.has_value())
+        {
+            return plugin_.value().generateAsync(std::forward<decltype(args)>(args)...);
+        }
+        return std::async(std::launch::deferred, default_process, std::forward<decltype(args)>(args)...);
+    }
+
+    auto modifyAsync(const auto& original_value, auto&&... args)
+    {
+        if (plugin_.has_value())
+        {
+            return plugin_.value().modifyAsync(original_value, std::forward<decltype(args)>(args)...);
+        }
+        return std::async(std::launch::deferred, default_process, original_value, std::forward<decltype(args)>(args)...);
+    }
+
+    /**
+     * @brief Executes the plugin operation for many parts at once.
+     *
+     * The requests for all parts are in flight at the same time, so a batch costs about one round trip to the plugin
+     * instead of one per part.
+     *
+     * @param original_values The parts to modify.
+     * @param args The arguments that are the same for every part.
+     * @return The modified parts, in the same order as \p original_values.
+     */
+    auto modifyBatch(const auto& original_values, const auto&... args)
+    {
+        using future_type = decltype(modifyAsync(*std::begin(original_values), args...));
+        std::vector<future_type> futures;
+        for (const auto& original_value : original_values)
+        {
+            futures.push_back(modifyAsync(original_value, args...));
+        }
+        std::vector<decltype(futures.front().get())> results;
+        results.reserve(futures.size());
+        for (future_type& future : futures)
+        {
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
+    /**
+     * @brief Executes the plugin operation for many parts at once.
+     *
+     * @param arguments For each part, a tuple with the arguments to generate it with.
+     * @return The generated parts, in the same order as \p arguments.
+     */
+    auto generateBatch(const auto& arguments)
+    {
+        using future_type = decltype(std::apply([this](const auto&... args) { return generateAsync(args...); }, *std::begin(arguments)));
+        std::vector<future_type> futures;
+        for (const auto& part_arguments : arguments)
+        {
+            futures.push_back(std::apply(
+                [this](const auto&... args)
+                {
+                    return generateAsync(args...);
+                },
+                part_arguments));
+        }
+        std::vector<decltype(futures.front().get())> results;
+        results.reserve(futures.size());
+        for (future_type& future : futures)
+        {
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
     template<v0::SlotID S>
     void broadcast(auto&&... args)
     {
@@ -150,6 +150,12 @@ public:
         return get_type<S>().proxy;
     }
 
+    template<v0::SlotID S>
+    [[nodiscard]] constexpr bool isConnected()
+    {
+        return get<S>().isConnected();
+    }
+
     template<v0::SlotID S>
     constexpr auto modify(auto& original_value, auto&&... args)
     {
@@ -162,6 +168,30 @@ public:
         return get<S>().generate(std::forward<decltype(args)>(args)...);
     }
 
+    template<v0::SlotID S>
+    auto modifyAsync(const auto& original_value, auto&&... args)
+    {
+        return get<S>().modifyAsync(original_value, std::forward<decltype(args)>(args)...);
+    }
+
+    template<v0::SlotID S>
+    auto generateAsync(auto&&... args)
+    {
+        return get<S>().generateAsync(std::forward<decltype(args)>(args)...);
+    }
+
+    template<v0::SlotID S>
+    auto modifyBatch(const auto& original_values, const auto&... args)
+    {
+        return get<S>().modifyBatch(original_values, args...);
+    }
+
+    template<v0::SlotID S>
+    auto generateBatch(const auto& arguments)
+    {
+        return get<S>().generateBatch(arguments);
+    }
+
     void connect(const v0::SlotID& slot_id, auto name, auto& version, auto&& channel)
     {
         if (slot_id == T::slot_id)
@@ -239,6 +269,8 @@ using slots = plugins::details::SingletonRegistry<plugins::SlotTypes, plugins::d
 } // namespace cura
 
 #else // No Engine plugin support
+#include <future>
+
 namespace cura
 {
 
@@ -265,12 +297,29 @@ namespace details
 {
 struct Slots
 {
+    template<plugins::v0::SlotID S>
+    [[nodiscard]] constexpr bool isConnected() const noexcept
+    {
+        return false;
+    }
+
     template<plugins::v0::SlotID S>
     constexpr auto modify(auto&& data, auto&&... args) noexcept
     {
         return std::forward<decltype(data)>(data);
     }
 
+    template<plugins::v0::SlotID S>
+    auto modifyAsync(const auto& data, auto&&... args)
+    {
+        return std::async(
+            std::launch::deferred,
+            [data]()
+            {
+                return data;
+            });
+    }
+
     template<plugins::v0::SlotID S>
     constexpr auto broadcast(auto&&... args) noexcept
     {
@@ -0,0 +1,71 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef PROGRESS_PRINT_ESTIMATE_EXTRAPOLATOR_H
+#define PROGRESS_PRINT_ESTIMATE_EXTRAPOLATOR_H
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "settings/types/Duration.h"
+#include "settings/types/LayerIndex.h"
+
+namespace cura
+{
+
+class SliceDataStorage;
+
+/*!
+ * An estimate of how long the whole print takes and how much material it uses.
+ */
+struct PrintEstimates
+{
+    std::vector<Duration> print_time_per_feature; //!< The print time in seconds for each PrintFeatureType.
+    std::vector<double> material_per_extruder; //!< The extruded volume in mm^3 for each extruder.
+};
+
+/*!
+ * \brief Extrapolates the print time and material of the layers of a mesh group that were written so far to all of its
+ * layers, so that the front-end can show them before the slice finishes.
+ *
+ * Each layer takes time and material in proportion to the area that is printed on it. That area is known for all
+ * layers before any g-code is written, since the areas are all generated by then.
+ */
+class PrintEstimateExtrapolator
+{
+public:
+    /*!
+     * \param layer_weights How much each layer of the mesh group prints, from the first layer up, such as its area.
+     * \param at_start The totals of the g-code from before the mesh group, i.e. those of the earlier mesh groups.
+     */
+    PrintEstimateExtrapolator(std::vector<double> layer_weights, PrintEstimates at_start);
+
+    /*!
+     * Get the areas that the layers of a mesh group print, for \ref PrintEstimateExtrapolator::PrintEstimateExtrapolator.
+     * \param storage The areas of the mesh group.
+     * \param layer_count The number of layers that are written.
+     * \return The area of the models and the support on each layer, in mm^2.
+     */
+    static std::vector<double> getLayerAreas(const SliceDataStorage& storage, const size_t layer_count);
+
+    /*!
+     * \brief Estimate the totals of the whole print, once some of the layers are written.
+     *
+     * The totals of the earlier mesh groups are exact. What the layers that were written so far add to that is scaled
+     * by how much more all layers print than those. Anything written before the first layer, such as a raft, is scaled
+     * along.
+     * \param written_layer_nr The last layer that was written. All layers below it were written too.
+     * \param written The totals of the g-code that was written so far.
+     * \return The estimates, or nullopt if nothing that is extrapolated from was written yet.
+     */
+    std::optional<PrintEstimates> extrapolate(const LayerIndex written_layer_nr, const PrintEstimates& written) const;
+
+private:
+    std::vector<double> written_weights_; //!< For each layer, how much the layers up to and including it print.
+    PrintEstimates at_start_;
+};
+
+} // namespace cura
+
+#endif // PROGRESS_PRINT_ESTIMATE_EXTRAPOLATOR_H
@@ -5,16 +5,21 @@
 #define PROGRESS_H
 
 #include <array>
+#include <chrono>
+#include <filesystem>
 #include <optional>
 #include <string>
 #include <string_view>
 
+#include "utils/MemoryUsage.h"
 #include "utils/gettime.h"
 
 namespace cura
 {
 
 struct LayerIndex;
+class Settings;
+class StageCostModel;
 
 static constexpr size_t N_PROGRESS_STAGES = 7;
 
@@ -41,7 +46,22 @@ public:
         FINISH = 6
     };
 
+    /*!
+     * How long a stage took, summed over the times that it ran since the last \ref resetStageTimes, and how much memory
+     * the process held during it.
+     *
+     * The memory is that of the whole process, as \ref MemoryUsage reports it.
+     */
+    struct StageTime
+    {
+        double wall_time = 0.0; //!< The time on the clock on the wall, in seconds.
+        double cpu_time = 0.0; //!< The processor time of all threads of the process together, in seconds.
+        size_t resident_bytes = 0; //!< The memory held at the end of the stage, the last time that it ran.
+        size_t peak_resident_bytes = 0; //!< The most memory held while the stage ran, over all times that it ran.
+    };
+
 private:
+    //! The relative time of each stage, when there is no \ref StageCostModel to tell better.
     static constexpr std::array<double, N_PROGRESS_STAGES> times{
         0.0, // START   = 0,
         5.269, // SLICING = 1,
@@ -53,9 +73,17 @@ private:
     };
 
     static constexpr std::array<std::string_view, N_PROGRESS_STAGES> names{ "start", "slice", "layerparts", "inset+skin", "support", "export", "process" };
+    static std::array<double, N_PROGRESS_STAGES> stage_weights; //!< The relative time of each stage in the current mesh group
     static std::array<double, N_PROGRESS_STAGES> accumulated_times; //!< Time past before each stage
     static double total_timing; //!< An estimate of the total time
     static std::optional<LayerIndex> first_skipped_layer; //!< The index of the layer for which we skipped time reporting
+    static std::array<StageTime, N_PROGRESS_STAGES> stage_times; //!< How long each stage took since the last reset
+    static std::optional<Stage> current_stage; //!< The stage that is running, if any
+    static StageTime current_stage_start; //!< The wall and processor time at which the current stage started
+    static StageCostModel cost_model; //!< The measured costs of the stages on the printer of the current mesh group
+    static std::optional<std::filesystem::path> cost_model_file; //!< Where to keep the cost model, if anywhere
+    static std::array<double, N_PROGRESS_STAGES> mesh_group_wall_times; //!< How long each stage took in the current mesh group
+    static size_t mesh_group_layer_count; //!< The number of layers of the current mesh group, or 0 if not known yet
     /*!
      * Give an estimate between 0 and 1 of how far the process is.
      *
@@ -66,10 +94,42 @@ private:
     static double calcOverallProgress(Stage stage, double stage_progress);
 
 public:
+    //! How often the progress is sent while a stage runs.
+    static constexpr std::chrono::milliseconds reporting_interval{ 100 };
+
     static void init(); //!< Initialize some values needed in a fast computation of the progress
+
+    /*!
+     * Start measuring the stages of a mesh group, and load the costs that were measured on earlier slices for its
+     * printer, if they are kept, see \ref StageCostModel::getFile.
+     *
+     * \param settings The settings of the mesh group.
+     */
+    static void startCostModel(const Settings& settings);
+
+    /*!
+     * Set the number of layers of the current mesh group. If the costs of all stages are known, the progress weighs
+     * the stages by their costs for this number of layers, and the time the slice will take is logged.
+     */
+    static void setLayerCount(size_t layer_count);
+
+    /*!
+     * Add how long the stages of the current mesh group took to the costs, and keep them for the next slice.
+     */
+    static void finishCostModel();
+
+    /*!
+     * Get the costs of the stages that were measured on earlier slices for the printer of the current mesh group, such
+     * as to size the chunks of a parallel loop over the layers.
+     */
+    static const StageCostModel& getCostModel();
+
     /*!
      * Message progress over the CommandSocket and to the terminal (if the command line arg '-p' is provided).
      *
+     * While a stage runs, this only keeps the furthest progress in an atomic, which a thread of its own sends every
+     * \ref reporting_interval. So it may be called from every iteration of a parallel loop.
+     *
      * \param stage The current stage of processing
      * \param progress_in_stage Any number giving the progress within the stage
      * \param progress_in_stage_max The maximal value of \p progress_in_stage
@@ -95,6 +155,24 @@ public:
      *                       because it is not relevant
      */
     static void messageProgressLayer(LayerIndex layer_nr, size_t total_layers, double total_time, const TimeKeeper::RegisteredTimes& stages, double skip_threshold = 0.1);
+
+    /*!
+     * Get how long each stage took since the last \ref resetStageTimes, in the order of \ref Stage.
+     *
+     * A stage runs from when it is messaged with \ref messageProgressStage until the next stage is, so a stage that
+     * is still running isn't counted yet.
+     */
+    static const std::array<StageTime, N_PROGRESS_STAGES>& getStageTimes();
+
+    /*!
+     * Forget how long the stages took, and stop timing the stage that is running.
+     */
+    static void resetStageTimes();
+
+    /*!
+     * Get the name of a stage, as it appears in the log.
+     */
+    static std::string_view getStageName(Stage stage);
 };
 
 
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef PROGRESS_STAGE_COST_MODEL_H
+#define PROGRESS_STAGE_COST_MODEL_H
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+#include "progress/Progress.h"
+
+namespace cura
+{
+
+class Settings;
+
+/*!
+ * \brief How long each stage of a slice takes per layer, as measured on earlier slices for the same printer.
+ *
+ * Each slice that is recorded moves the cost of its stages towards what it measured, so the model follows changes of
+ * the machine that slices and of the settings that are used, without jumping around on a single odd slice.
+ *
+ * Progress uses it to weigh the stages by how long they actually take, to estimate how long a slice will take, and to
+ * hint at how many layers a chunk of a parallel loop over the layers should have.
+ */
+class StageCostModel
+{
+public:
+    //! How much the newest slice counts towards the cost of a stage, compared to all slices before it.
+    static constexpr double newest_weight = 0.25;
+
+    //! How long a chunk of a parallel loop should take at least, for taking the chunk to be cheap compared to running it.
+    static constexpr double default_min_chunk_seconds = 0.001;
+
+    //! The measured cost of a stage.
+    struct StageCost
+    {
+        double seconds_per_layer = 0.0;
+        size_t samples = 0; //!< How many slices were recorded. Without any, the cost is unknown.
+    };
+
+    /*!
+     * \brief Get the file that keeps the model for a printer, if the model is to be kept.
+     *
+     * The models are kept in the directory that the environment variable CURA_ENGINE_COST_MODEL names, a file for each
+     * machine_name.
+     * \return The file, or nullopt if the environment variable is not set.
+     */
+    static std::optional<std::filesystem::path> getFile(const Settings& settings);
+
+    /*!
+     * \brief Read a model from a file.
+     * \return The model, which knows nothing if the file doesn't exist or can't be read.
+     */
+    static StageCostModel load(const std::filesystem::path& file);
+
+    /*!
+     * \brief Write the model to a file, replacing what it had.
+     *
+     * Failing to write it is not an error, since it only makes the estimates of the next slice worse.
+     */
+    void save(const std::filesystem::path& file) const;
+
+    /*!
+     * \brief Add what a stage took in a slice.
+     * \param seconds The wall time that the stage took.
+     * \param layer_count The number of layers of the slice.
+     */
+    void record(Progress::Stage stage, double seconds, size_t layer_count);
+
+    //! Get the measured cost of a stage.
+    const StageCost& getCost(Progress::Stage stage) const;
+
+    /*!
+     * \brief Estimate how long a stage will take for a number of layers.
+     * \return The estimate, or nullopt if the stage was never recorded.
+     */
+    std::optional<double> estimateSeconds(Progress::Stage stage, size_t layer_count) const;
+
+    /*!
+     * \brief Get how many layers a chunk of a parallel loop over the layers in a stage should have, so that a chunk
+     * takes at least \p min_chunk_seconds.
+     *
+     * The whole stage is timed, so a single loop in it takes less per layer, and this errs on the side of smaller chunks.
+     * \return The number of layers, at least 1. Also 1 if the stage was never recorded.
+     */
+    size_t getChunkSizeFactor(Progress::Stage stage, double min_chunk_seconds = default_min_chunk_seconds) const;
+
+private:
+    std::array<StageCost, N_PROGRESS_STAGES> costs_{};
+};
+
+} // namespace cura
+
+#endif // PROGRESS_STAGE_COST_MODEL_H
@@ -99,6 +99,12 @@ private:
     std::vector<double> face_slopes_;
     std::vector<int> face_min_z_values_;
     std::vector<int> face_max_z_values_;
+
+    /*!
+     * The indices of the faces, sorted by their lowest point.
+     */
+    std::vector<size_t> faces_by_min_z_;
+
     const MeshGroup* meshgroup_;
 
     /*!
@@ -114,6 +120,7 @@ private:
     /*!
      * Calculates the slopes for each triangle in the mesh.
      * These are uses later by calculateLayers to find the steepest triangle in a potential layer.
+     * It also sorts the triangles by their lowest point, so that calculateLayers can sweep over them.
      */
     void calculateMeshTriangleSlopes();
 };
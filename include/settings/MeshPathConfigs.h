@@ -29,6 +29,9 @@ struct MeshPathConfigs
 
     MeshPathConfigs(const SliceMeshStorage& mesh, const coord_t layer_thickness, const LayerIndex layer_nr, const std::vector<Ratio>& line_width_factor_per_extruder);
     void smoothAllSpeeds(const SpeedDerivatives& first_layer_config, const LayerIndex layer_nr, const LayerIndex max_speed_layer);
+
+    //! Change the layer height of all feature types.
+    void setLayerThickness(const coord_t layer_thickness);
 };
 
 } // namespace cura
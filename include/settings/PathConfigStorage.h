@@ -38,6 +38,9 @@ private:
     const std::vector<Ratio> line_width_factor_per_extruder;
     static std::vector<Ratio> getLineWidthFactorPerExtruder(const LayerIndex& layer_nr);
 
+    coord_t support_fractional_z_offset; //!< How far the fractional layer-height parts of the support are below the layer.
+    Ratio support_fractional_flow; //!< The flow of the fractional layer-height parts of the support, relative to a full layer.
+
 public:
     GCodePathConfig raft_base_config;
     GCodePathConfig raft_interface_config;
@@ -60,8 +63,25 @@ public:
      */
     PathConfigStorage(const SliceDataStorage& storage, const LayerIndex& layer_nr, const coord_t layer_thickness);
 
+    /*!
+     * Derive the configurations of a layer from those of another layer, without looking up all settings again.
+     *
+     * Above the first layer, the configurations only differ in their layer thickness and in the speeds of the initial
+     * speed-up layers, so only those are applied to a copy of \p base.
+     *
+     * \param base The configurations of a layer at full speed, see \ref getFirstFullSpeedLayer
+     * \param layer_nr The layer to derive the configurations for. Must be above the first layer.
+     */
+    PathConfigStorage(const PathConfigStorage& base, const SliceDataStorage& storage, const LayerIndex& layer_nr, const coord_t layer_thickness);
+
+    //! The first layer that isn't slowed down by the first layer or the initial speed-up layers, to build a base for the other layers from.
+    static LayerIndex getFirstFullSpeedLayer();
+
 private:
     void handleInitialLayerSpeedup(const SliceDataStorage& storage, const LayerIndex& layer_nr, const size_t initial_speedup_layer_count);
+
+    //! Copy the support configurations over to the fractional layer-height support configurations.
+    void setSupportFractionalConfigs();
 };
 
 } // namespace cura
@@ -0,0 +1,619 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef SETTINGS_SETTING_KEYS_H
+#define SETTINGS_SETTING_KEYS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace cura
+{
+
+/*!
+ * \brief The keys of all settings that the engine reads by name.
+ *
+ * This list is derived from the setting lookups in the engine's sources, and
+ * kept in alphabetical order. When the engine starts reading a new setting,
+ * add its key here in the right place. Settings that are only known to the
+ * front-end or to plug-ins don't need to be listed, since they can keep being
+ * looked up by their string key.
+ */
+#define CURA_SETTING_KEYS(X) \
+    X(acceleration_enabled) \
+    X(acceleration_infill) \
+    X(acceleration_ironing) \
+    X(acceleration_prime_tower) \
+    X(acceleration_print_layer_0) \
+    X(acceleration_roofing) \
+    X(acceleration_skirt_brim) \
+    X(acceleration_support_bottom) \
+    X(acceleration_support_infill) \
+    X(acceleration_support_roof) \
+    X(acceleration_topbottom) \
+    X(acceleration_travel) \
+    X(acceleration_travel_enabled) \
+    X(acceleration_travel_layer_0) \
+    X(acceleration_wall_0) \
+    X(acceleration_wall_0_roofing) \
+    X(acceleration_wall_x) \
+    X(acceleration_wall_x_roofing) \
+    X(adaptive_layer_height_enabled) \
+    X(adaptive_layer_height_threshold) \
+    X(adaptive_layer_height_variation) \
+    X(adaptive_layer_height_variation_step) \
+    X(adhesion_type) \
+    X(alternate_carve_order) \
+    X(alternate_extra_perimeter) \
+    X(anti_overhang_mesh) \
+    X(arc_fitting_enabled) \
+    X(bottom_layers) \
+    X(bottom_skin_expand_distance) \
+    X(bottom_skin_preshrink) \
+    X(bridge_enable_more_layers) \
+    X(bridge_fan_speed) \
+    X(bridge_fan_speed_2) \
+    X(bridge_fan_speed_3) \
+    X(bridge_settings_enabled) \
+    X(bridge_skin_density) \
+    X(bridge_skin_density_2) \
+    X(bridge_skin_density_3) \
+    X(bridge_skin_material_flow) \
+    X(bridge_skin_material_flow_2) \
+    X(bridge_skin_material_flow_3) \
+    X(bridge_skin_speed) \
+    X(bridge_skin_speed_2) \
+    X(bridge_skin_speed_3) \
+    X(bridge_skin_support_threshold) \
+    X(bridge_sparse_infill_max_density) \
+    X(bridge_wall_coast) \
+    X(bridge_wall_material_flow) \
+    X(bridge_wall_min_length) \
+    X(bridge_wall_speed) \
+    X(brim_inside_margin) \
+    X(brim_line_count) \
+    X(brim_location) \
+    X(brim_replaces_support) \
+    X(brim_smart_ordering) \
+    X(build_volume_temperature) \
+    X(bv_temp_anomaly_limit) \
+    X(bv_temp_warn_limit) \
+    X(carve_multiple_volumes) \
+    X(center_object) \
+    X(clean_between_layers) \
+    X(coasting_enable) \
+    X(coasting_min_volume) \
+    X(coasting_speed) \
+    X(coasting_volume) \
+    X(conical_overhang_angle) \
+    X(conical_overhang_enabled) \
+    X(conical_overhang_hole_size) \
+    X(connect_infill_polygons) \
+    X(connect_skin_polygons) \
+    X(cool_fan_enabled) \
+    X(cool_fan_full_layer) \
+    X(cool_fan_speed_0) \
+    X(cool_fan_speed_max) \
+    X(cool_fan_speed_min) \
+    X(cool_lift_head) \
+    X(cool_min_layer_time) \
+    X(cool_min_layer_time_fan_speed_max) \
+    X(cool_min_speed) \
+    X(cool_min_temperature) \
+    X(cross_infill_density_image) \
+    X(cross_infill_pocket_size) \
+    X(cross_support_density_image) \
+    X(cutting_mesh) \
+    X(draft_shield_dist) \
+    X(draft_shield_enabled) \
+    X(draft_shield_height) \
+    X(draft_shield_height_limitation) \
+    X(extruder_nr) \
+    X(extruder_prime_pos_abs) \
+    X(extruder_prime_pos_x) \
+    X(extruder_prime_pos_y) \
+    X(extruder_prime_pos_z) \
+    X(fill_outline_gaps) \
+    X(flow_anomaly_limit) \
+    X(flow_rate_extrusion_offset_factor) \
+    X(flow_rate_max_extrusion_offset) \
+    X(flow_warn_limit) \
+    X(gradual_infill_step_height) \
+    X(gradual_infill_steps) \
+    X(gradual_support_infill_step_height) \
+    X(gradual_support_infill_steps) \
+    X(group_outer_walls) \
+    X(hole_xy_offset) \
+    X(hole_xy_offset_max_diameter) \
+    X(infill_angles) \
+    X(infill_before_walls) \
+    X(infill_enable_travel_optimization) \
+    X(infill_extruder_nr) \
+    X(infill_line_distance) \
+    X(infill_line_width) \
+    X(infill_material_flow) \
+    X(infill_mesh) \
+    X(infill_mesh_order) \
+    X(infill_multiplier) \
+    X(infill_offset_x) \
+    X(infill_offset_y) \
+    X(infill_overlap_mm) \
+    X(infill_pattern) \
+    X(infill_randomize_start_location) \
+    X(infill_sparse_thickness) \
+    X(infill_support_angle) \
+    X(infill_support_enabled) \
+    X(infill_wall_line_count) \
+    X(infill_wipe_dist) \
+    X(initial_bottom_layers) \
+    X(initial_layer_line_width_factor) \
+    X(inset_direction) \
+    X(interlocking_beam_layer_count) \
+    X(interlocking_beam_width) \
+    X(interlocking_boundary_avoidance) \
+    X(interlocking_depth) \
+    X(interlocking_enable) \
+    X(interlocking_orientation) \
+    X(ironing_enabled) \
+    X(ironing_flow) \
+    X(ironing_inset) \
+    X(ironing_line_spacing) \
+    X(ironing_monotonic) \
+    X(ironing_only_highest_layer) \
+    X(ironing_pattern) \
+    X(jerk_enabled) \
+    X(jerk_infill) \
+    X(jerk_ironing) \
+    X(jerk_prime_tower) \
+    X(jerk_print_layer_0) \
+    X(jerk_roofing) \
+    X(jerk_skirt_brim) \
+    X(jerk_support_bottom) \
+    X(jerk_support_infill) \
+    X(jerk_support_roof) \
+    X(jerk_topbottom) \
+    X(jerk_travel) \
+    X(jerk_travel_enabled) \
+    X(jerk_travel_layer_0) \
+    X(jerk_wall_0) \
+    X(jerk_wall_0_roofing) \
+    X(jerk_wall_x) \
+    X(jerk_wall_x_roofing) \
+    X(layer_0_z_overlap) \
+    X(layer_height) \
+    X(layer_height_0) \
+    X(layer_start_x) \
+    X(layer_start_y) \
+    X(lightning_infill_overhang_angle) \
+    X(lightning_infill_prune_angle) \
+    X(lightning_infill_straightening_angle) \
+    X(line_width) \
+    X(machine_acceleration) \
+    X(machine_always_write_active_tool) \
+    X(machine_center_is_zero) \
+    X(machine_depth) \
+    X(machine_disallowed_areas) \
+    X(machine_end_gcode) \
+    X(machine_extruder_cooling_fan_number) \
+    X(machine_extruder_count) \
+    X(machine_extruder_end_code) \
+    X(machine_extruder_end_code_duration) \
+    X(machine_extruder_end_pos_abs) \
+    X(machine_extruder_end_pos_x) \
+    X(machine_extruder_end_pos_y) \
+    X(machine_extruder_start_code) \
+    X(machine_extruder_start_code_duration) \
+    X(machine_extruder_start_pos_abs) \
+    X(machine_extruder_start_pos_x) \
+    X(machine_extruder_start_pos_y) \
+    X(machine_extruders_share_heater) \
+    X(machine_extruders_share_nozzle) \
+    X(machine_extruders_shared_nozzle_initial_retraction) \
+    X(machine_firmware_retract) \
+    X(machine_gcode_binary) \
+    X(machine_gcode_flavor) \
+    X(machine_heated_bed) \
+    X(machine_heated_build_volume) \
+    X(machine_height) \
+    X(machine_max_acceleration_e) \
+    X(machine_max_acceleration_x) \
+    X(machine_max_acceleration_y) \
+    X(machine_max_acceleration_z) \
+    X(machine_max_feedrate_e) \
+    X(machine_max_feedrate_x) \
+    X(machine_max_feedrate_y) \
+    X(machine_max_feedrate_z) \
+    X(machine_max_jerk_e) \
+    X(machine_max_jerk_xy) \
+    X(machine_max_jerk_z) \
+    X(machine_min_cool_heat_time_window) \
+    X(machine_minimum_feedrate) \
+    X(machine_name) \
+    X(machine_nozzle_cool_down_speed) \
+    X(machine_nozzle_heat_up_speed) \
+    X(machine_nozzle_id) \
+    X(machine_nozzle_offset_x) \
+    X(machine_nozzle_offset_y) \
+    X(machine_nozzle_size) \
+    X(machine_nozzle_temp_enabled) \
+    X(machine_nozzle_tip_outer_diameter) \
+    X(machine_scale_fan_speed_zero_to_one) \
+    X(machine_shape) \
+    X(machine_start_gcode) \
+    X(machine_use_extruder_offset_to_offset_coords) \
+    X(machine_width) \
+    X(magic_fuzzy_skin_enabled) \
+    X(magic_fuzzy_skin_outside_only) \
+    X(magic_fuzzy_skin_point_dist) \
+    X(magic_fuzzy_skin_thickness) \
+    X(magic_mesh_surface_mode) \
+    X(magic_spiralize) \
+    X(material_adhesion_tendency) \
+    X(material_alternate_walls) \
+    X(material_bed_temp_prepend) \
+    X(material_bed_temp_wait) \
+    X(material_bed_temperature) \
+    X(material_bed_temperature_layer_0) \
+    X(material_diameter) \
+    X(material_extrusion_cool_down_speed) \
+    X(material_final_print_temperature) \
+    X(material_flow_layer_0) \
+    X(material_guid) \
+    X(material_initial_print_temperature) \
+    X(material_print_temp_prepend) \
+    X(material_print_temp_wait) \
+    X(material_print_temperature) \
+    X(material_print_temperature_layer_0) \
+    X(material_shrinkage_percentage_xy) \
+    X(material_shrinkage_percentage_z) \
+    X(material_standby_temperature) \
+    X(max_extrusion_before_wipe) \
+    X(mesh_position_x) \
+    X(mesh_position_y) \
+    X(mesh_position_z) \
+    X(mesh_rotation_matrix) \
+    X(meshfix_extensive_stitching) \
+    X(meshfix_fluid_motion_angle) \
+    X(meshfix_fluid_motion_enabled) \
+    X(meshfix_fluid_motion_shift_distance) \
+    X(meshfix_fluid_motion_small_distance) \
+    X(meshfix_keep_open_polygons) \
+    X(meshfix_maximum_deviation) \
+    X(meshfix_maximum_extrusion_area_deviation) \
+    X(meshfix_maximum_resolution) \
+    X(meshfix_maximum_travel_resolution) \
+    X(meshfix_union_all) \
+    X(meshfix_union_all_remove_holes) \
+    X(min_bead_width) \
+    X(min_even_wall_line_width) \
+    X(min_feature_size) \
+    X(min_infill_area) \
+    X(min_odd_wall_line_width) \
+    X(min_skin_width_for_expansion) \
+    X(min_wall_line_width) \
+    X(minimum_bottom_area) \
+    X(minimum_polygon_circumference) \
+    X(minimum_roof_area) \
+    X(minimum_support_area) \
+    X(mold_angle) \
+    X(mold_enabled) \
+    X(mold_roof_height) \
+    X(mold_width) \
+    X(multiple_mesh_overlap) \
+    X(nozzle_offsetting_for_disallowed_areas) \
+    X(ooze_shield_angle) \
+    X(ooze_shield_dist) \
+    X(ooze_shield_enabled) \
+    X(optimize_wall_printing_order) \
+    X(ppr_enable) \
+    X(prime_blob_enable) \
+    X(prime_tower_base_curve_magnitude) \
+    X(prime_tower_base_height) \
+    X(prime_tower_base_size) \
+    X(prime_tower_brim_enable) \
+    X(prime_tower_enable) \
+    X(prime_tower_flow) \
+    X(prime_tower_line_width) \
+    X(prime_tower_max_bridging_distance) \
+    X(prime_tower_min_volume) \
+    X(prime_tower_mode) \
+    X(prime_tower_position_x) \
+    X(prime_tower_position_y) \
+    X(prime_tower_raft_base_line_spacing) \
+    X(prime_tower_size) \
+    X(prime_tower_wipe_enabled) \
+    X(print_sequence) \
+    X(print_temp_anomaly_limit) \
+    X(print_temp_warn_limit) \
+    X(raft_airgap) \
+    X(raft_base_acceleration) \
+    X(raft_base_extruder_nr) \
+    X(raft_base_fan_speed) \
+    X(raft_base_jerk) \
+    X(raft_base_line_spacing) \
+    X(raft_base_line_width) \
+    X(raft_base_margin) \
+    X(raft_base_remove_inside_corners) \
+    X(raft_base_smoothing) \
+    X(raft_base_speed) \
+    X(raft_base_thickness) \
+    X(raft_base_wall_count) \
+    X(raft_interface_acceleration) \
+    X(raft_interface_extruder_nr) \
+    X(raft_interface_fan_speed) \
+    X(raft_interface_jerk) \
+    X(raft_interface_layers) \
+    X(raft_interface_line_spacing) \
+    X(raft_interface_line_width) \
+    X(raft_interface_margin) \
+    X(raft_interface_remove_inside_corners) \
+    X(raft_interface_smoothing) \
+    X(raft_interface_speed) \
+    X(raft_interface_thickness) \
+    X(raft_interface_wall_count) \
+    X(raft_surface_acceleration) \
+    X(raft_surface_extruder_nr) \
+    X(raft_surface_fan_speed) \
+    X(raft_surface_jerk) \
+    X(raft_surface_layers) \
+    X(raft_surface_line_spacing) \
+    X(raft_surface_line_width) \
+    X(raft_surface_margin) \
+    X(raft_surface_monotonic) \
+    X(raft_surface_remove_inside_corners) \
+    X(raft_surface_smoothing) \
+    X(raft_surface_speed) \
+    X(raft_surface_thickness) \
+    X(raft_surface_wall_count) \
+    X(relative_extrusion) \
+    X(remove_empty_first_layers) \
+    X(retract_at_layer_change) \
+    X(retraction_amount) \
+    X(retraction_combing) \
+    X(retraction_combing_max_distance) \
+    X(retraction_count_max) \
+    X(retraction_enable) \
+    X(retraction_extra_prime_amount) \
+    X(retraction_extrusion_window) \
+    X(retraction_hop) \
+    X(retraction_hop_after_extruder_switch) \
+    X(retraction_hop_after_extruder_switch_height) \
+    X(retraction_hop_enabled) \
+    X(retraction_hop_only_when_collides) \
+    X(retraction_min_travel) \
+    X(retraction_prime_speed) \
+    X(retraction_retract_speed) \
+    X(roofing_angles) \
+    X(roofing_extruder_nr) \
+    X(roofing_layer_count) \
+    X(roofing_line_width) \
+    X(roofing_material_flow) \
+    X(roofing_monotonic) \
+    X(roofing_pattern) \
+    X(skin_angles) \
+    X(skin_edge_support_layers) \
+    X(skin_line_width) \
+    X(skin_material_flow) \
+    X(skin_material_flow_layer_0) \
+    X(skin_monotonic) \
+    X(skin_no_small_gaps_heuristic) \
+    X(skin_outline_count) \
+    X(skin_overlap_mm) \
+    X(skirt_brim_extruder_nr) \
+    X(skirt_brim_line_width) \
+    X(skirt_brim_material_flow) \
+    X(skirt_brim_minimal_length) \
+    X(skirt_brim_speed) \
+    X(skirt_height) \
+    X(skirt_line_count) \
+    X(slicing_tolerance) \
+    X(small_feature_max_length) \
+    X(small_skin_on_surface) \
+    X(small_skin_width) \
+    X(smooth_spiralized_contours) \
+    X(speed_equalize_flow_width_factor) \
+    X(speed_infill) \
+    X(speed_ironing) \
+    X(speed_prime_tower) \
+    X(speed_print_layer_0) \
+    X(speed_roofing) \
+    X(speed_slowdown_layers) \
+    X(speed_support_bottom) \
+    X(speed_support_infill) \
+    X(speed_support_roof) \
+    X(speed_topbottom) \
+    X(speed_travel) \
+    X(speed_travel_layer_0) \
+    X(speed_wall_0) \
+    X(speed_wall_0_roofing) \
+    X(speed_wall_x) \
+    X(speed_wall_x_roofing) \
+    X(speed_z_hop) \
+    X(sub_div_rad_add) \
+    X(support_angle) \
+    X(support_bottom_distance) \
+    X(support_bottom_enable) \
+    X(support_bottom_extruder_nr) \
+    X(support_bottom_height) \
+    X(support_bottom_line_width) \
+    X(support_bottom_material_flow) \
+    X(support_bottom_offset) \
+    X(support_bottom_pattern) \
+    X(support_bottom_stair_step_height) \
+    X(support_bottom_stair_step_min_slope) \
+    X(support_bottom_stair_step_width) \
+    X(support_bottom_wall_count) \
+    X(support_brim_enable) \
+    X(support_brim_line_count) \
+    X(support_conical_angle) \
+    X(support_conical_enabled) \
+    X(support_conical_min_width) \
+    X(support_connect_zigzags) \
+    X(support_enable) \
+    X(support_extruder_nr_layer_0) \
+    X(support_fan_enable) \
+    X(support_infill_angles) \
+    X(support_infill_extruder_nr) \
+    X(support_infill_sparse_thickness) \
+    X(support_initial_layer_line_distance) \
+    X(support_interface_priority) \
+    X(support_join_distance) \
+    X(support_line_distance) \
+    X(support_line_width) \
+    X(support_material_flow) \
+    X(support_mesh) \
+    X(support_mesh_drop_down) \
+    X(support_offset) \
+    X(support_pattern) \
+    X(support_roof_angles) \
+    X(support_roof_enable) \
+    X(support_roof_extruder_nr) \
+    X(support_roof_height) \
+    X(support_roof_line_distance) \
+    X(support_roof_line_width) \
+    X(support_roof_material_flow) \
+    X(support_roof_offset) \
+    X(support_roof_pattern) \
+    X(support_roof_wall_count) \
+    X(support_skip_some_zags) \
+    X(support_structure) \
+    X(support_supported_skin_fan_speed) \
+    X(support_top_distance) \
+    X(support_tower_diameter) \
+    X(support_tower_maximum_supported_diameter) \
+    X(support_tower_roof_angle) \
+    X(support_tree_angle) \
+    X(support_tree_angle_slow) \
+    X(support_tree_bp_diameter) \
+    X(support_tree_branch_diameter) \
+    X(support_tree_branch_diameter_angle) \
+    X(support_tree_branch_reach_limit) \
+    X(support_tree_limit_branch_reach) \
+    X(support_tree_max_diameter) \
+    X(support_tree_max_diameter_increase_by_merges_when_support_to_model) \
+    X(support_tree_min_height_to_model) \
+    X(support_tree_rest_preference) \
+    X(support_tree_tip_diameter) \
+    X(support_tree_top_rate) \
+    X(support_type) \
+    X(support_use_towers) \
+    X(support_wall_count) \
+    X(support_xy_distance) \
+    X(support_xy_distance_overhang) \
+    X(support_xy_overrides_z) \
+    X(support_zag_skip_count) \
+    X(switch_extruder_extra_prime_amount) \
+    X(switch_extruder_prime_speed) \
+    X(switch_extruder_retraction_amount) \
+    X(switch_extruder_retraction_speed) \
+    X(top_bottom_extruder_nr) \
+    X(top_bottom_pattern) \
+    X(top_bottom_pattern_0) \
+    X(top_layers) \
+    X(top_skin_expand_distance) \
+    X(top_skin_preshrink) \
+    X(travel_avoid_distance) \
+    X(travel_avoid_other_parts) \
+    X(travel_avoid_supports) \
+    X(travel_retract_before_outer_wall) \
+    X(wall_0_extruder_nr) \
+    X(wall_0_inset) \
+    X(wall_0_material_flow) \
+    X(wall_0_material_flow_layer_0) \
+    X(wall_0_material_flow_roofing) \
+    X(wall_0_wipe_dist) \
+    X(wall_distribution_count) \
+    X(wall_line_count) \
+    X(wall_line_width_0) \
+    X(wall_line_width_x) \
+    X(wall_overhang_angle) \
+    X(wall_overhang_speed_factor) \
+    X(wall_transition_angle) \
+    X(wall_transition_filter_deviation) \
+    X(wall_transition_filter_distance) \
+    X(wall_transition_length) \
+    X(wall_x_extruder_nr) \
+    X(wall_x_material_flow) \
+    X(wall_x_material_flow_layer_0) \
+    X(wall_x_material_flow_roofing) \
+    X(wipe_brush_pos_x) \
+    X(wipe_hop_amount) \
+    X(wipe_hop_enable) \
+    X(wipe_hop_speed) \
+    X(wipe_move_distance) \
+    X(wipe_pause) \
+    X(wipe_repeat_count) \
+    X(wipe_retraction_amount) \
+    X(wipe_retraction_enable) \
+    X(wipe_retraction_extra_prime_amount) \
+    X(wipe_retraction_prime_speed) \
+    X(wipe_retraction_retract_speed) \
+    X(xy_offset) \
+    X(xy_offset_layer_0) \
+    X(z_seam_corner) \
+    X(z_seam_relative) \
+    X(z_seam_type) \
+    X(z_seam_x) \
+    X(z_seam_y) \
+    X(zig_zaggify_infill) \
+    X(zig_zaggify_support)
+
+/*!
+ * \brief Identifies a setting that the engine reads, resolved at compile time.
+ *
+ * Looking up a setting with a SettingKey instead of its name doesn't need to
+ * construct or hash a string, and a misspelled key fails to compile instead of
+ * failing the slice.
+ */
+enum class SettingKey : uint16_t
+{
+#define CURA_SETTING_KEY_ENUMERATOR(key) key,
+    CURA_SETTING_KEYS(CURA_SETTING_KEY_ENUMERATOR)
+#undef CURA_SETTING_KEY_ENUMERATOR
+};
+
+/*!
+ * \brief The names of the setting keys, indexed by their SettingKey.
+ */
+inline constexpr std::array setting_key_names{
+#define CURA_SETTING_KEY_NAME(key) std::string_view{ #key },
+    CURA_SETTING_KEYS(CURA_SETTING_KEY_NAME)
+#undef CURA_SETTING_KEY_NAME
+};
+static_assert(std::ranges::adjacent_find(setting_key_names, std::ranges::greater_equal{}) == setting_key_names.end(), "The setting keys must be unique and in alphabetical order.");
+
+/*!
+ * \brief The number of SettingKey values.
+ */
+inline constexpr size_t setting_key_count = setting_key_names.size();
+
+/*!
+ * \brief Get the name of a setting key.
+ */
+constexpr std::string_view settingKeyName(const SettingKey key)
+{
+    return setting_key_names[static_cast<size_t>(key)];
+}
+
+/*!
+ * \brief Find the SettingKey with a certain name.
+ *
+ * \param name The name of the setting.
+ * \return The key, or nullopt if the engine doesn't read this setting by name.
+ */
+constexpr std::optional<SettingKey> findSettingKey(const std::string_view name)
+{
+    const auto it = std::ranges::lower_bound(setting_key_names, name);
+    if (it == setting_key_names.end() || *it != name)
+    {
+        return std::nullopt;
+    }
+    return static_cast<SettingKey>(it - setting_key_names.begin());
+}
+
+} // namespace cura
+
+#endif // SETTINGS_SETTING_KEYS_H
@@ -14,10 +14,14 @@
 #define MAX_INFILL_COMBINE 8
 
 #include <map>
+#include <optional>
 #include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "settings/SettingKeys.h"
+
 namespace cura
 {
 
@@ -40,12 +44,30 @@ public:
 
     /*!
      * \brief Adds a new setting.
+     *
+     * If this container was frozen, it is thawed again.
      * \param key The name by which the setting is identified.
      * \param value The value of the setting. The value is always added and
      * stored in serialised form as a string.
      */
     void add(const std::string& key, const std::string value);
 
+    /*!
+     * \brief Take a snapshot of the values of all settings in this context.
+     *
+     * Every setting is evaluated once, through the parents and the limiting to
+     * extruders as described for ``get``, and stored together with its value
+     * parsed as the basic types. Until the container is thawed again, ``get``
+     * then costs one lookup instead of walking the inheritance chain and
+     * parsing the value again every time.
+     *
+     * The snapshot is not updated when the parents or the extruders change, so
+     * only freeze settings that are done loading, and freeze them again when
+     * their inheritance changes. Changing the parent or adding a setting
+     * thaws this container.
+     */
+    void freeze();
+
     /*!
      * \brief Get the value of a setting.
      *
@@ -67,6 +89,17 @@ public:
     template<typename A>
     A get(const std::string& key) const;
 
+    /*!
+     * \brief Get the value of a setting that the engine knows at compile time.
+     *
+     * This gives the same value as getting it by its name. If this container
+     * is frozen, no string is constructed or hashed to find it.
+     * \param key The key of the setting to get.
+     * \return The setting's value, cast to the desired type.
+     */
+    template<typename A>
+    A get(const SettingKey key) const;
+
     /*!
      * \brief Get a string containing all settings in this container.
      *
@@ -100,6 +133,12 @@ public:
 
     std::vector<std::string> getKeys() const;
 
+    /*!
+     * \brief Get the settings in this container itself, without those it would get from its parent.
+     * \return The values of the settings, by their keys.
+     */
+    const std::unordered_map<std::string, std::string>& getOwnSettings() const;
+
 private:
     /*!
      * Optionally, a parent setting container to ask for the value of a setting
@@ -112,6 +151,58 @@ private:
      */
     std::unordered_map<std::string, std::string> settings;
 
+    /*!
+     * \brief The value of a setting as it was evaluated when the container was
+     * frozen, and that value parsed as the types that are asked for most.
+     */
+    struct FrozenSetting
+    {
+        std::string value;
+        double as_double;
+        int as_int;
+        bool as_bool;
+        std::optional<size_t> as_size_t; //!< Not set if the value is not an unsigned integer, so that ``get`` reports the error as usual.
+    };
+
+    /*!
+     * \brief The snapshot taken by ``freeze``, or empty if this container is
+     * not frozen.
+     */
+    std::vector<FrozenSetting> frozen_;
+
+    /*!
+     * \brief Where to find each setting in the snapshot, by name.
+     */
+    std::unordered_map<std::string, size_t> frozen_index_;
+
+    /*!
+     * \brief Where to find each setting in the snapshot, by SettingKey. Keys
+     * that are unknown to this container are mapped to ``frozen_.size()``.
+     */
+    std::vector<uint32_t> frozen_key_index_;
+
+    /*!
+     * \brief Get the snapshot of a setting.
+     * \param key The key of the setting to get.
+     * \return The snapshot, or nullptr if this container is not frozen or the
+     * setting is unknown.
+     */
+    const FrozenSetting* getFrozen(const std::string& key) const;
+
+    /*!
+     * \brief Get the snapshot of a setting.
+     * \param key The key of the setting to get.
+     * \return The snapshot, or nullptr if this container is not frozen or the
+     * setting is unknown.
+     */
+    const FrozenSetting* getFrozen(const SettingKey key) const;
+
+    /*!
+     * \brief Drop the snapshot, so that settings are evaluated on every lookup
+     * again.
+     */
+    void thaw();
+
     /*!
      * \brief Get the value of a setting, but without looking at the limiting to
      * extruder.
@@ -10,6 +10,7 @@
 namespace cura
 {
 
+class OutlineIntersectionCache;
 class Polygons;
 class SkinPart;
 class SliceLayerPart;
@@ -30,8 +31,10 @@ public:
      * stored and where the skin insets and fill areas (output) are stored.
      * \param process_infill Whether to process infill, i.e. whether there's a
      * positive infill density or there are infill meshes modifying this mesh.
+     * \param outline_intersections The intersections of the outlines of the
+     * layers of the \p mesh, shared by the computations of all its layers.
      */
-    SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill);
+    SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill, OutlineIntersectionCache& outline_intersections);
 
     /*!
      * Generate the skin areas and its insets.
@@ -171,6 +174,7 @@ protected:
     size_t skin_inset_count_; //!< The number of perimeters to surround the skin
     bool no_small_gaps_heuristic_; //!< A heuristic which assumes there will be no small gaps between bottom and top skin with a z size smaller than the skin size itself
     bool process_infill_; //!< Whether to process infill, i.e. whether there's a positive infill density or there are infill meshes modifying this mesh.
+    OutlineIntersectionCache& outline_intersections_; //!< The intersections of the outlines of the layers of the mesh, shared by all layers.
 
     coord_t top_skin_preshrink_; //!< The top skin removal width, to remove thin strips of skin along nearly-vertical walls.
     coord_t bottom_skin_preshrink_; //!< The bottom skin removal width, to remove thin strips of skin along nearly-vertical walls.
@@ -192,6 +196,21 @@ private:
      * \param layer2_nr The layer index from which to gather the outlines.
      */
     Polygons getOutlineOnLayer(const SliceLayerPart& part_here, const LayerIndex layer2_nr);
+
+    /*!
+     * Helper function to get the area that is inside the outlines of all
+     * layers in a range, i.e. where none of those layers has air.
+     *
+     * A single layer gives the outline of each part which might intersect
+     * with \p part_here, like \ref getOutlineOnLayer. For more layers the
+     * intersection of the complete outlines of those layers is taken from
+     * the \ref outline_intersections_, which only differs outside of
+     * \p part_here .
+     * \param part_here The part for which to check.
+     * \param first_layer_nr The lowest layer of the range.
+     * \param last_layer_nr The highest layer of the range, inclusive.
+     */
+    Polygons getOutlineOnLayers(const SliceLayerPart& part_here, const LayerIndex first_layer_nr, const LayerIndex last_layer_nr);
 };
 
 } // namespace cura
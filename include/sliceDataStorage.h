@@ -8,16 +8,20 @@
 #include <memory>
 #include <optional>
 
+#include "ModelOffsetCache.h"
 #include "PrimeTower.h"
 #include "RetractionConfig.h"
 #include "SupportInfillPart.h"
 #include "TopSurface.h"
 #include "WipeScriptConfig.h"
+#include "infill/SupportInfillCache.h"
+#include "pathPlanning/CombBoundaryCache.h"
 #include "settings/Settings.h" //For MAX_EXTRUDERS.
 #include "settings/types/Angle.h" //Infill angles.
 #include "settings/types/LayerIndex.h"
 #include "utils/AABB.h"
 #include "utils/AABB3D.h"
+#include "utils/CompactPolygons.h"
 #include "utils/NoCopy.h"
 #include "utils/Point2LL.h"
 #include "utils/polygon.h"
@@ -62,8 +66,9 @@ public:
     PolygonsPart outline; //!< The outline is the first member that is filled, and it's filled with polygons that match
                           //!< a cross-section of the 3D model. The first polygon is the outer boundary polygon and the
                           //!< rest are holes.
-    Polygons print_outline; //!< An approximation to the outline of what's actually printed, based on the outer wall.
-                            //!< Too small parts will be omitted compared to the outline.
+    CompactPolygons print_outline; //!< An approximation to the outline of what's actually printed, based on the outer wall.
+                                   //!< Too small parts will be omitted compared to the outline. Kept compact, since it
+                                   //!< lives until the layer is written but is only read rarely.
     Polygons spiral_wall; //!< The centerline of the wall used by spiralize mode. Only computed if spiralize mode is enabled.
     Polygons inner_area; //!< The area of the outline, minus the walls. This will be filled with either skin or infill.
     std::vector<SkinPart> skin_parts; //!< The skin parts which are filled for 100% with lines and/or insets.
@@ -132,6 +137,9 @@ public:
      * infill_area[0] corresponds to the most dense infill area.
      * infill_area[x] will lie fully inside infill_area[x+1].
      * infill_area_per_combine_per_density.back()[0] == part.infill area initially
+     *
+     * Left empty for parts whose infill has a single density and isn't combined with other layers, since then it would
+     * only hold a copy of the infill_area. Use getInfillAreaPerCombinePerDensity to read it.
      */
     std::vector<std::vector<Polygons>> infill_area_per_combine_per_density;
 
@@ -155,6 +163,33 @@ public:
      * \return true if there is at least one ExtrusionLine at the specified wall index, false otherwise
      */
     bool hasWallAtInsetIndex(size_t inset_idx) const;
+
+    /*!
+     * Get the infill areas per density and per number of combined layers.
+     *
+     * If infill_area_per_combine_per_density was left empty, they are made from the infill_area the first time they
+     * are asked for, and kept until releaseInfillAreaPerCombinePerDensity. Only the thread that plans the layer of the
+     * part may call this.
+     * \see SliceLayerPart::infill_area_per_combine_per_density
+     * \return The infill areas per density and per number of combined layers
+     */
+    const std::vector<std::vector<Polygons>>& getInfillAreaPerCombinePerDensity() const;
+
+    /*!
+     * Fill infill_area_per_combine_per_density from the infill_area if it was left empty, so that it can be changed.
+     */
+    void materializeInfillAreaPerCombinePerDensity();
+
+    /*!
+     * Free the infill areas per density and per number of combined layers, once the layer of the part is planned.
+     * They can't be asked for anymore after this.
+     * \return How many bytes were freed.
+     */
+    size_t releaseInfillAreaPerCombinePerDensity();
+
+private:
+    //! The infill areas made by getInfillAreaPerCombinePerDensity, if infill_area_per_combine_per_density was left empty.
+    mutable std::vector<std::vector<Polygons>> lazy_infill_area_per_combine_per_density_;
 };
 
 /*!
@@ -200,6 +235,28 @@ public:
      */
     void getOutlines(Polygons& result, bool external_polys_only = false) const;
 
+    /*!
+     * \brief Estimate how much memory the areas and walls of this layer take up.
+     * \return The estimated size in bytes.
+     */
+    size_t getMemoryFootprint() const;
+
+    /*!
+     * \brief Free all areas and walls of this layer, once nothing needs them anymore.
+     *
+     * The layer stays in place with its height and thickness, but has no parts afterwards.
+     * \return How many bytes were freed, as estimated by \ref getMemoryFootprint.
+     */
+    size_t release();
+
+    /*!
+     * \brief Free the memory that the areas and walls of this layer reserved while they were generated, but didn't use.
+     *
+     * Nothing may read the layer while this runs, since it moves the areas and walls.
+     * \return How many bytes were freed.
+     */
+    size_t shrinkToFit();
+
     ~SliceLayer();
 };
 
@@ -227,6 +284,28 @@ public:
      */
     void excludeAreasFromSupportInfillAreas(const Polygons& exclude_polygons, const AABB& exclude_polygons_boundary_box);
 
+    /*!
+     * \brief Estimate how much memory the areas of this layer take up.
+     * \return The estimated size in bytes.
+     */
+    size_t getMemoryFootprint() const;
+
+    /*!
+     * \brief Free all areas of this layer, once nothing needs them anymore.
+     *
+     * The layer stays in place, but is empty afterwards.
+     * \return How many bytes were freed, as estimated by \ref getMemoryFootprint.
+     */
+    size_t release();
+
+    /*!
+     * \brief Free the memory that the areas of this layer reserved while they were generated, but didn't use.
+     *
+     * Nothing may read the layer while this runs, since it moves the areas.
+     * \return How many bytes were freed.
+     */
+    size_t shrinkToFit();
+
     /* Fill up the infill parts for the support with the given support polygons. The support polygons will be split into parts.
      *
      * \param area The support polygon to fill up with infill parts.
@@ -290,6 +369,7 @@ public:
 
     std::vector<SupportLayer> supportLayers;
     std::shared_ptr<SierpinskiFillProvider> cross_fill_provider; //!< the fractal pattern for the cross (3d) filling pattern
+    SupportInfillCache infill_cache; //!< The support infill of recent layers, shared by the layers that are processed at the same time.
 
     SupportStorage();
     ~SupportStorage();
@@ -333,6 +413,13 @@ public:
      */
     SliceMeshStorage(Mesh* mesh, const size_t slice_layer_count);
 
+    /*!
+     * \brief Moves the slice results of a mesh from an earlier slice to the same mesh in this slice.
+     * \param mesh The mesh of this slice that the storage space belongs to.
+     * \param previous The storage space of the mesh in the earlier slice, whose settings may be gone already.
+     */
+    SliceMeshStorage(Mesh* mesh, SliceMeshStorage&& previous);
+
     /*!
      * \param extruder_nr The extruder for which to check
      * \return whether a particular extruder is used by this mesh
@@ -380,6 +467,8 @@ public:
     std::vector<RetractionAndWipeConfig> retraction_wipe_config_per_extruder; //!< Config for retractions, extruder switch retractions, and wipes, per extruder.
 
     SupportStorage support;
+    ModelOffsetCache model_offsets; //!< The offset outlines of the models, shared by the support generation of all meshes. Released after support generation.
+    CombBoundaryCache comb_boundaries; //!< The comb boundaries of recent layers, shared by the layer plans that are made at the same time.
 
     std::vector<SkirtBrimLine> skirt_brim[MAX_EXTRUDERS]; //!< Skirt/brim polygons per extruder, ordered from inner to outer polygons.
     Polygons support_brim; //!< brim lines for support, going from the edge of the support inward. \note Not ordered by inset.
@@ -462,6 +551,32 @@ public:
      */
     Polygons getMachineBorder(int extruder_nr = -1) const;
 
+    /*!
+     * \brief Estimate how much memory the layers of the meshes and the support take up.
+     *
+     * This walks over all layers, so it is meant for reporting, not to be called for every layer.
+     * \return The estimated size in bytes.
+     */
+    size_t getMemoryFootprint() const;
+
+    /*!
+     * \brief Free the areas of all meshes and the ooze shield on a layer, once no layer that is still to be planned
+     * needs them anymore.
+     *
+     * The support is freed separately, since the layers above look back further at it.
+     * \return How many bytes were freed, as estimated by \ref SliceLayer::getMemoryFootprint.
+     */
+    size_t releaseMeshLayer(LayerIndex layer_nr);
+
+    /*!
+     * \brief Free the infill areas per density and per number of combined layers of all meshes on a layer, once the
+     * layer is planned.
+     *
+     * Only the layer itself reads them while it is planned, so they can go before the rest of the mesh layer.
+     * \return How many bytes were freed.
+     */
+    size_t releaseInfillAreaPerCombinePerDensity(LayerIndex layer_nr);
+
 private:
     /*!
      * Construct the retraction_wipe_config_per_extruder
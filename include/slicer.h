@@ -6,7 +6,7 @@
 
 #include <optional>
 #include <queue>
-#include <unordered_map>
+#include <span>
 
 #include "settings/EnumSettings.h"
 #include "utils/polygon.h"
@@ -55,9 +55,10 @@ public:
 
 class SlicerLayer
 {
+    friend class SlicerBenchmark; // To time the steps of connecting the segments separately.
+
 public:
-    std::vector<SlicerSegment> segments;
-    std::unordered_map<int, int> face_idx_to_segment_idx; // topology
+    std::vector<SlicerSegment> segments; //!< The segments of this layer, in order of the index of the face that created them.
 
     int z = -1;
     Polygons polygons;
@@ -71,6 +72,16 @@ public:
     void makePolygons(const Mesh* mesh);
 
 protected:
+    /*!
+     * The topology of the segments: the face index of every segment.
+     *
+     * Since the segments are created in order of face index, this is sorted and
+     * the segment created by a face can be found with a binary search. It is
+     * only set while the segments are connected into loops, and refers to a
+     * buffer that is reused between all layers connected by the same thread.
+     */
+    std::span<const int> segment_face_indices;
+
     /*!
      * Connect the segments into loops which correctly form polygons (don't perform stitching here)
      *
@@ -122,6 +133,10 @@ protected:
     /*!
      * Try to close up polylines into polygons while they have large gaps in them.
      *
+     * The polyline ends are connected by routing over a polygon that both ends
+     * touch. If this takes too much work for one layer, the remaining polylines
+     * are only stitched with \ref stitch.
+     *
      * Clears all open polylines which are used up in the process
      *
      * \param[in,out] open_polylines The polylines which are stiched, but couldn't be closed into a loop yet
@@ -391,6 +406,20 @@ private:
         std::vector<Terminus> m_terminus_cur_to_old_map;
     };
 
+    /*!
+     * Find the shortest way over a polygon to connect two polyline ends, given
+     * the polygon points that they are close to.
+     *
+     * \param ip0 The first polyline end.
+     * \param c1 The polygon point closest to \p ip0, as given by
+     * findPolygonPointClosestTo.
+     * \param ip1 The second polyline end.
+     * \param c2 The polygon point closest to \p ip1.
+     * \return The connection, or nullopt if the ends are not close to the same
+     * polygon.
+     */
+    std::optional<GapCloserResult> findPolygonGapCloser(Point2LL ip0, const std::optional<ClosePolygonResult>& c1, Point2LL ip1, const std::optional<ClosePolygonResult>& c2) const;
+
     /*!
      * Try to find a segment from face \p face_idx to continue \p segment.
      *
@@ -478,6 +507,8 @@ private:
 
 class Slicer
 {
+    friend class SlicerBenchmark; // To time the creation of the segments by itself.
+
 public:
     std::vector<SlicerLayer> layers;
 
@@ -485,6 +516,13 @@ public:
 
     Slicer(Mesh* mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers);
 
+    /*!
+     * Create a slicer from layers that were sliced earlier from the same mesh, see SlicerCache.
+     * \param mesh The sliced mesh.
+     * \param layers The sliced layers.
+     */
+    Slicer(const Mesh* mesh, std::vector<SlicerLayer> layers);
+
 
 private:
     /*!
@@ -521,7 +559,37 @@ private:
      */
     static std::vector<std::pair<int32_t, int32_t>> buildZHeightsForFaces(const Mesh& mesh);
 
-    /*! Creates the polygons in layers.
+    /*! Finds the range of layers that intersect each face.
+     * \param[in] zbboxes The z part of the bounding boxes of the faces of the mesh.
+     * \param[in] layers The layers to slice, sorted by ascending height.
+     * \return For each face, the [first, last) range of indices of the layers that intersect it.
+     */
+    static std::vector<std::pair<size_t, size_t>> buildLayerRangesForFaces(const std::vector<std::pair<int32_t, int32_t>>& zbboxes, const std::vector<SlicerLayer>& layers);
+
+    /*! Divides the layers into bands of consecutive layers that are sliced together.
+     *
+     * Every band is as large as possible while creating no more than
+     * max_band_segment_count segments, but contains at least one layer.
+     * \param[in] face_layer_ranges The range of layers that intersect each face.
+     * \param[in] layer_count The number of layers to slice.
+     * \return The (exclusive) end layer index of each band, in order.
+     */
+    static std::vector<size_t> buildBands(const std::vector<std::pair<size_t, size_t>>& face_layer_ranges, const size_t layer_count);
+
+    /*! Buckets the faces of the mesh by the layers of a band that intersect them.
+     *
+     * The faces active in layer \p first_layer + \p n are stored in \p active_faces,
+     * from index result[n] up to (but excluding) result[n + 1], in increasing face index.
+     * \param[in] face_layer_ranges The range of layers that intersect each face.
+     * \param[in] first_layer The first layer of the band.
+     * \param[in] last_layer The (exclusive) end of the band.
+     * \param[out] active_faces The face indices active per layer, concatenated.
+     * \return The offsets of each layer's faces in \p active_faces.
+     */
+    static std::vector<size_t>
+        buildActiveFacesPerLayer(const std::vector<std::pair<size_t, size_t>>& face_layer_ranges, const size_t first_layer, const size_t last_layer, std::vector<unsigned int>& active_faces);
+
+    /*! Post-processes the polygons in layers, after the segments of all layers have been connected.
      * \param[in] mesh The mesh which is analyzed.
      * \param[in] slicing_tolerance The way the slicing tolerance should be applied (MIDDLE/INCLUSIVE/EXCLUSIVE).
      * \param[in, out] layers The polygon are created here.
@@ -546,14 +614,21 @@ private:
         bool use_variable_layer_heights,
         const std::vector<AdaptiveLayer>* adaptive_layers);
 
-    /*! Creates the segments and write them into the layers.
+    /*! Creates the segments of a band of layers and write them into the layers.
      * \param[in] mesh The mesh which is analyzed.
-     * \param[in] zbboxes The z part of the bounding boxes of the faces of the mesh.
+     * \param[in] face_layer_ranges The range of layers that intersect each face of the mesh.
      * \param[in] slicing_tolderance Slicing tolerance in order to figure out what happens when vertices are exactly on the slicing boundary.
      * \param[in, out] layers The segments are created here.
+     * \param[in] first_layer The first layer of the band.
+     * \param[in] last_layer The (exclusive) end of the band.
      */
-    static void
-        buildSegments(const Mesh& mesh, const std::vector<std::pair<int32_t, int32_t>>& zbboxes, const SlicingTolerance& slicing_tolerance, std::vector<SlicerLayer>& layers);
+    static void buildSegments(
+        const Mesh& mesh,
+        const std::vector<std::pair<size_t, size_t>>& face_layer_ranges,
+        const SlicingTolerance& slicing_tolerance,
+        std::vector<SlicerLayer>& layers,
+        const size_t first_layer,
+        const size_t last_layer);
 };
 
 } // namespace cura
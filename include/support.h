@@ -13,6 +13,7 @@
 namespace cura
 {
 
+class ModelOffsetCache;
 class Settings;
 class SliceDataStorage;
 class SliceMeshStorage;
@@ -231,14 +232,14 @@ private:
      * the top half of the step will be as wide as the stair step width
      * and the bottom half will follow the model.
      *
-     * \param storage Where to get model outlines from
+     * \param model_offsets Where to get model outlines from
      * \param[in,out] stair_removal The polygons to be removed for stair stepping on the current layer (input) and for the next layer (output). Only changed every [step_height]
      * layers. \param[in,out] support_areas The support areas before and after this function \param layer_idx The layer number of the support layer we are processing \param
      * bottom_empty_layer_count The number of empty layers between the bottom of support and the top of the model on which support rests \param bottom_stair_step_layer_count The
      * max height (in nr of layers) of the support bottom stairs \param support_bottom_stair_step_width The max width of the support bottom stairs
      */
     static void moveUpFromModel(
-        const SliceDataStorage& storage,
+        const ModelOffsetCache& model_offsets,
         Polygons& stair_removal,
         Polygons& sloped_areas,
         Polygons& support_areas,
@@ -255,6 +256,19 @@ private:
      */
     static void detectOverhangPoints(const SliceDataStorage& storage, SliceMeshStorage& mesh);
 
+    /*!
+     * \brief Whether each part of a layer of a mesh lies within one part of the layer below it.
+     *
+     * Such a layer can't have any overhang as long as the overhang angle lets the layer stick out past the layer below.
+     * The check only compares the parts to the parts below with their bounding boxes and areas, and with one boolean
+     * operation per part when those can't tell. That is much cheaper than computing the overhang, and most layers of
+     * most models pass it.
+     * \param mesh The mesh to check the layer of.
+     * \param layer_idx The layer to check. Must be at least 1.
+     * \return Whether the layer is known to be supported. If not, it may or may not have overhang.
+     */
+    static bool isSupportedByLayerBelow(const SliceMeshStorage& mesh, const LayerIndex layer_idx);
+
     /*!
      * \brief Compute the basic overhang and full overhang of a layer.
      *
@@ -4,6 +4,7 @@
 #ifndef TIME_ESTIMATE_H
 #define TIME_ESTIMATE_H
 
+#include <deque>
 #include <stdint.h>
 #include <unordered_map>
 #include <vector>
@@ -32,6 +33,13 @@ public:
     constexpr static size_t Z_AXIS = 2;
     constexpr static size_t E_AXIS = 3;
 
+    /*!
+     * How many moves the planner looks ahead, like the block buffer of the firmware (BLOCK_BUFFER_SIZE in Marlin).
+     *
+     * A move that falls out of this window gets its final speed profile, as the firmware would start executing it.
+     */
+    constexpr static size_t planner_buffer_size = 16;
+
 
     class Position
     {
@@ -95,7 +103,9 @@ private:
 
     Position currentPosition;
 
-    std::vector<Block> blocks;
+    std::deque<Block> blocks; //!< The moves in the look-ahead window, at most \ref planner_buffer_size.
+    //! The time of the moves that left the look-ahead window, per feature.
+    std::vector<Duration> finalized_totals = std::vector<Duration>(static_cast<unsigned char>(PrintFeatureType::NumPrintFeatureTypes), 0.0);
 
 public:
     /*!
@@ -111,9 +121,24 @@ public:
 
     void reset();
 
+    /*!
+     * Get the time of everything that was planned since the last reset, per feature.
+     *
+     * The moves that are still in the look-ahead window are planned to come to a stop after the last one, but are kept
+     * in the window, so that planning can continue after this.
+     */
     std::vector<Duration> calculate();
 
 private:
+    /*!
+     * Plan the speeds of the moves in the look-ahead window, so that the oldest one gets its final speed profile, and
+     * then add its time to \ref finalized_totals and remove it from the window.
+     */
+    void finalizeOldestBlock();
+
+    //! Add the time that a move takes with its speed profile to the total of its feature.
+    static void addBlockTime(const Block& block, std::vector<Duration>& totals);
+
     void reversePass();
     void forwardPass();
 
@@ -0,0 +1,100 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_ALLOCATION_STATISTICS_H
+#define UTILS_ALLOCATION_STATISTICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+
+#include "progress/Progress.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Counts the allocations of each stage of the slice and each thread, attributed to the innermost tag that is
+ * open on the thread that allocates.
+ *
+ * Only when built with ENABLE_ALLOCATION_STATS, which replaces the global operator new to count every allocation.
+ * Otherwise nothing is counted, and the tags cost nothing. The tracing scopes of \ref Trace are tags as well, so that
+ * the allocations of the parallel loops are told apart by where the loop is.
+ *
+ * Only the allocations are counted, not how long the memory lives, since operator delete isn't told the size of what it
+ * frees in every case.
+ */
+class AllocationStatistics
+{
+public:
+    //! The number of distinct tags that can be told apart. The allocations under tags beyond these count as untagged.
+    static constexpr size_t max_tags = 64;
+
+    //! The number of threads that get counts of their own. Threads beyond these share the counts of the last one.
+    static constexpr size_t max_threads = 64;
+
+    //! How many allocations were made, and how many bytes they asked for.
+    struct Counts
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    /*!
+     * \brief Attributes the allocations of the calling thread to a tag while it lives.
+     */
+    class Tag
+    {
+    public:
+        /*!
+         * \param name What the allocations are for. Must outlive the statistics, such as a string literal.
+         */
+        explicit Tag(const char* name);
+
+        /*!
+         * \param name What the allocations are for. Must outlive the statistics, such as a string literal.
+         * \param site Where the tag was opened, to tell tags of the same name apart.
+         */
+        Tag(const char* name, const std::source_location& site);
+
+        ~Tag();
+
+        Tag(const Tag&) = delete;
+        Tag& operator=(const Tag&) = delete;
+
+#ifdef ENABLE_ALLOCATION_STATS
+    private:
+        size_t previous_tag_;
+#endif
+    };
+
+    //! Whether the allocations are counted in this build.
+    static constexpr bool enabled()
+    {
+#ifdef ENABLE_ALLOCATION_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //! Counts an allocation of the calling thread. Called by operator new.
+    static void countAllocation(size_t bytes);
+
+    //! Attributes the allocations from now on to a stage of the slice.
+    static void setStage(Progress::Stage stage);
+
+    //! Gets the allocations of each stage, of all threads and tags together, in the order of \ref Progress::Stage.
+    static std::array<Counts, N_PROGRESS_STAGES> getStageCounts();
+
+    //! Logs what was counted since the last report, per stage, per thread and the tags with the most allocations, and resets the counts.
+    static void report();
+
+    //! Forgets what was counted so far.
+    static void reset();
+};
+
+} // namespace cura
+
+#endif // UTILS_ALLOCATION_STATISTICS_H
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_ARC_FITTING_H
+#define UTILS_ARC_FITTING_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Coord_t.h"
+#include "Point2LL.h"
+
+namespace cura
+{
+
+//! The largest radius of an arc that \ref fitArcs makes: a metre.
+constexpr coord_t max_arc_radius = MM2INT(1000);
+
+/*!
+ * \brief A run of points of a polyline that can be printed as a single circular arc.
+ */
+struct FittedArc
+{
+    size_t first_idx; //!< The index of the first point that the arc replaces. The arc starts at the point before it.
+    size_t last_idx; //!< The index of the point where the arc ends.
+    Point2LL center; //!< The center of the circle that the arc is part of.
+    bool clockwise; //!< Whether the arc goes clockwise, as a G2 move, or counter-clockwise, as a G3 move.
+};
+
+/*!
+ * \brief Find the runs of points of a polyline that lie on circular arcs, so that they can be printed with G2 and G3
+ * moves instead of many short G1 moves.
+ *
+ * Runs are found greedily from the start of the polyline. An arc deviates from every point that it replaces, and from
+ * every line segment between them, by at most \p max_deviation. Each arc replaces at least three points, turns less
+ * than a full circle, and has a radius of at most \ref max_arc_radius, beyond which the points are practically on a
+ * straight line.
+ * \param start Where the polyline starts, such as the current position of the nozzle.
+ * \param points The points to go to from \p start, in order.
+ * \param max_deviation How far the arcs may be from the points and the segments between them.
+ * \return The arcs, in the order of the points. The points that aren't part of an arc are to be printed as lines.
+ */
+std::vector<FittedArc> fitArcs(const Point2LL& start, const std::vector<Point2LL>& points, const coord_t max_deviation);
+
+} // namespace cura
+
+#endif // UTILS_ARC_FITTING_H
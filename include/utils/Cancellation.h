@@ -0,0 +1,79 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_CANCELLATION_H
+#define UTILS_CANCELLATION_H
+
+#include <atomic>
+#include <exception>
+
+namespace cura
+{
+
+/*!
+ * \brief Thrown out of the slicing stages when the running slice is cancelled.
+ */
+class SliceCancelled : public std::exception
+{
+public:
+    const char* what() const noexcept override
+    {
+        return "The slice was cancelled.";
+    }
+};
+
+/*!
+ * \brief The token with which a front-end cancels the slice that is running, for instance because it sent a newer one.
+ *
+ * Cancelling is cooperative: the long running stages check the token at convenient points, such as between the chunks
+ * of a parallel_for, and throw SliceCancelled to unwind. The token may be requested from any thread.
+ */
+class Cancellation
+{
+public:
+    //! Marks the start of a slice, forgetting about any earlier request.
+    static void beginSlice()
+    {
+        requested_.store(false, std::memory_order_relaxed);
+        slicing_.store(true, std::memory_order_release);
+    }
+
+    //! Marks the end of the slice, after which requests are ignored until the next one begins.
+    static void endSlice()
+    {
+        slicing_.store(false, std::memory_order_release);
+        requested_.store(false, std::memory_order_relaxed);
+    }
+
+    //! Requests the running slice to be cancelled. Does nothing if no slice is running.
+    static void requestIfSlicing()
+    {
+        if (slicing_.load(std::memory_order_acquire))
+        {
+            requested_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    //! Whether the running slice should stop.
+    static bool isRequested()
+    {
+        return requested_.load(std::memory_order_relaxed);
+    }
+
+    //! Throws SliceCancelled if the running slice should stop.
+    static void throwIfRequested()
+    {
+        if (isRequested())
+        {
+            throw SliceCancelled();
+        }
+    }
+
+private:
+    static inline std::atomic<bool> slicing_{ false };
+    static inline std::atomic<bool> requested_{ false };
+};
+
+} // namespace cura
+
+#endif // UTILS_CANCELLATION_H
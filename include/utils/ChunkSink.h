@@ -0,0 +1,113 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_CHUNK_SINK_H
+#define UTILS_CHUNK_SINK_H
+
+#include <functional>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Buffers of a fixed capacity that are handed out again once they are given back, so that they don't have to
+ * be allocated for every use.
+ *
+ * It is safe to take and give back buffers from several threads at once.
+ */
+class BufferPool : public NoCopy
+{
+public:
+    /*!
+     * \param buffer_size The capacity that every buffer has.
+     * \param max_kept How many buffers to keep for reuse at most. Buffers that are given back beyond that are freed.
+     */
+    BufferPool(const size_t buffer_size, const size_t max_kept);
+
+    /*!
+     * \brief Take an empty buffer with at least the capacity of the pool.
+     */
+    std::string acquire();
+
+    /*!
+     * \brief Give a buffer back, to be handed out again.
+     */
+    void release(std::string&& buffer);
+
+    //! The capacity that every buffer has.
+    [[nodiscard]] size_t bufferSize() const;
+
+private:
+    const size_t buffer_size_;
+    const size_t max_kept_;
+    std::mutex mutex_; //!< Guards \ref buffers_.
+    std::vector<std::string> buffers_; //!< The buffers that are waiting to be handed out again.
+};
+
+/*!
+ * \brief A stream buffer that hands its output on in chunks of a fixed size, rather than letting it grow.
+ *
+ * The output is collected in a buffer from a \ref BufferPool. When that is full, everything up to its last line ending
+ * is handed to the consumer, and the rest is carried over into the next buffer. That way, no chunk ends halfway a
+ * line, unless a line is longer than a whole chunk. \ref flush hands on what was collected so far, such as at the end
+ * of a layer. Flushing the stream doesn't, like it doesn't empty a std::stringbuf either, so that a chunk is only
+ * sent early where that is intended.
+ *
+ * The consumer gets the chunk to keep. Once it is done with it, it may give it back to \ref getPool to have it reused.
+ *
+ * Like a std::stringbuf, it may only be used by one thread at a time. The consumer is called on the thread that writes.
+ */
+class ChunkSink : public std::streambuf, public NoCopy
+{
+public:
+    using Consumer = std::function<void(std::string&& chunk)>;
+
+    //! The default size of a chunk: enough for the g-code of a simple layer.
+    static constexpr size_t default_chunk_size = 256 * 1024;
+
+    /*!
+     * \param consumer What to hand the chunks to.
+     * \param chunk_size How much to collect before handing it on.
+     */
+    explicit ChunkSink(Consumer consumer, const size_t chunk_size = default_chunk_size);
+
+    /*!
+     * \brief Hand on what was collected so far, if anything.
+     */
+    void flush();
+
+    /*!
+     * \brief Forget what was collected so far, without handing it on.
+     */
+    void discard();
+
+    //! The pool of buffers that the chunks are collected in.
+    BufferPool& getPool();
+
+protected:
+    int_type overflow(int_type character) override;
+
+private:
+    //! How many buffers the pool keeps: the one being filled and a few that are still being sent.
+    static constexpr size_t kept_buffers = 4;
+
+    Consumer consumer_; //!< What the chunks are handed to.
+    BufferPool pool_; //!< Where the buffers come from.
+    std::string buffer_; //!< The buffer that is being filled, which has the size of a chunk.
+
+    /*!
+     * \brief Hand on the first part of the buffer, and carry the rest over into a new one.
+     * \param count How many characters to hand on.
+     */
+    void handOn(const size_t count);
+};
+
+} // namespace cura
+
+#endif // UTILS_CHUNK_SINK_H
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_COMPACT_POLYGONS_H
+#define UTILS_COMPACT_POLYGONS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "NoCopy.h"
+#include "Point2LL.h"
+
+namespace cura
+{
+
+class Polygons;
+
+/*!
+ * \brief Polygons to keep around for long, with their vertices stored as 32-bit offsets from the corner of their
+ * bounding box.
+ *
+ * A Point2LL has two 64-bit coordinates, while the shapes of a layer are never more than a few meters wide, which in
+ * microns fits in 32 bits. This keeps the vertices in half the memory, in one buffer like FlatPolygons. They are only
+ * expanded back into a Polygons when they are used. Polygons that are too wide for the offsets are kept at full width.
+ *
+ * The vertices never change once they are stored, so copies share them instead of copying them. Shapes that only differ
+ * by where they are share their vertices too, when they are interned in the same CompactPolygonsPool.
+ */
+class CompactPolygons
+{
+public:
+    CompactPolygons() = default;
+
+    /*!
+     * \brief Copies the vertices of the polygons into a single buffer, as offsets if they fit.
+     */
+    explicit CompactPolygons(const Polygons& polygons);
+
+    //! The number of polygons.
+    size_t size() const
+    {
+        return data_ ? data_->offsets.size() - 1 : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    //! The number of vertices of all polygons together.
+    size_t pointCount() const
+    {
+        return data_ ? data_->offsets.back() : 0;
+    }
+
+    //! Whether the vertices are stored as 32-bit offsets, rather than at full width.
+    bool isCompact() const
+    {
+        return ! data_ || data_->wide_points.empty();
+    }
+
+    //! Whether these polygons share their vertices with \p other.
+    bool sharesWith(const CompactPolygons& other) const
+    {
+        return data_ && data_ == other.data_;
+    }
+
+    /*!
+     * \brief Gets a vertex, expanded to its full coordinates.
+     * \param poly_idx The index of the polygon.
+     * \param point_idx The index of the vertex in that polygon.
+     */
+    Point2LL getPoint(size_t poly_idx, size_t point_idx) const;
+
+    /*!
+     * \brief Expands the polygons back into a Polygons, to do geometry with them.
+     */
+    Polygons toPolygons() const;
+
+    //! How many bytes the vertices and polygons take, including those that are shared with other polygons.
+    size_t getMemoryFootprint() const;
+
+private:
+    friend class CompactPolygonsPool;
+
+    //! A vertex relative to origin_.
+    struct Offset
+    {
+        uint32_t X;
+        uint32_t Y;
+
+        bool operator==(const Offset& other) const = default;
+    };
+
+    //! The vertices, which are shared between the copies.
+    struct Data
+    {
+        std::vector<Offset> compact_points;
+        std::vector<Point2LL> wide_points; //!< Only used for polygons that are too wide for the offsets.
+        std::vector<size_t> offsets{ 0 }; //!< Where each polygon starts in the vertices, plus where the last one ends.
+
+        bool operator==(const Data& other) const = default;
+    };
+
+    Point2LL origin_{ 0, 0 }; //!< The minimum corner of the bounding box of the polygons.
+    std::shared_ptr<const Data> data_; //!< Null for no polygons at all.
+};
+
+/*!
+ * \brief Makes the CompactPolygons with the same shape share their vertices, wherever they are.
+ *
+ * Many models have stretches of layers with the same cross section, which without the pool would each keep a copy of
+ * the same vertices. The pool doesn't keep the vertices alive itself, so they are freed along with the last polygons
+ * that use them.
+ *
+ * The pool can be used from several threads at once.
+ */
+class CompactPolygonsPool : public NoCopy
+{
+public:
+    /*!
+     * \brief Stores polygons, sharing the vertices of earlier polygons of the pool with the same shape if there are any.
+     */
+    CompactPolygons intern(const Polygons& polygons);
+
+    //! How many times intern could share the vertices of earlier polygons.
+    size_t hitCount() const;
+
+private:
+    //! Gives a hash of the vertices, to quickly skip most entries that differ.
+    static uint64_t hash(const CompactPolygons::Data& data);
+
+    //! Guards entries_ and prune_size_.
+    std::mutex mutex_;
+
+    //! The vertices of the polygons that were interned, by their hash.
+    std::unordered_multimap<uint64_t, std::weak_ptr<const CompactPolygons::Data>> entries_;
+
+    //! How many entries there may be before the ones whose vertices were freed are removed.
+    size_t prune_size_ = 64;
+
+    std::atomic<size_t> hit_count_{ 0 };
+};
+
+} // namespace cura
+
+#endif // UTILS_COMPACT_POLYGONS_H
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_COUNTER_RANDOM_H
+#define UTILS_COUNTER_RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+namespace cura
+{
+
+/*!
+ * \brief A random number generator whose numbers only depend on its seed and how many it gave before.
+ *
+ * Each number is a hash of the seed and a counter, with the mixing function of SplitMix64. Unlike rand(), there is
+ * no global state: a generator seeded with, for instance, the layer number gives the same numbers on every run and
+ * doesn't interfere with the generators of other layers processed at the same time.
+ *
+ * It is not suited for cryptography, or for statistics that need more than a well spread sequence.
+ */
+class CounterRandom
+{
+public:
+    using result_type = uint64_t;
+
+    /*!
+     * \brief Create a generator.
+     * \param seed The numbers are the same for the same seed.
+     */
+    constexpr explicit CounterRandom(const uint64_t seed)
+        : key_(mix(seed))
+    {
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    //! Get the next number.
+    constexpr result_type operator()()
+    {
+        return mix(key_ + golden_gamma * ++counter_);
+    }
+
+    /*!
+     * \brief Get the next number, below a bound.
+     *
+     * Like rand() % bound, this is slightly biased towards low numbers for large bounds.
+     * \param bound The number is in [0, bound). Must be positive.
+     */
+    constexpr int64_t below(const int64_t bound)
+    {
+        return static_cast<int64_t>((*this)() % static_cast<uint64_t>(bound));
+    }
+
+private:
+    //! The increment of SplitMix64, 2^64 divided by the golden ratio.
+    static constexpr uint64_t golden_gamma = 0x9E3779B97F4A7C15ull;
+
+    uint64_t key_;
+    uint64_t counter_ = 0; //!< How many numbers were given.
+
+    //! The output function of SplitMix64, which spreads every bit of the input over the output.
+    static constexpr uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+} // namespace cura
+
+#endif // UTILS_COUNTER_RANDOM_H
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_DEBUG_OUTPUT_H
+#define UTILS_DEBUG_OUTPUT_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+#include "settings/types/LayerIndex.h"
+
+namespace cura
+{
+
+class AABB;
+class SVG;
+
+/*!
+ * \brief Gates the debug output of hot code, so that it costs nothing when it isn't wanted.
+ *
+ * Use \ref CURA_LOG_DEBUG instead of spdlog::debug within loops, and \ref CURA_DEBUG_SVG to draw the geometry of a
+ * layer. Both only evaluate their arguments when the output is wanted, so the arguments may copy or compute geometry.
+ * When built without ENABLE_DEBUG_OUTPUT, they compile to nothing.
+ *
+ * The SVGs are written when the environment variable CURA_ENGINE_DEBUG_SVG_DIR names a directory to write them to.
+ * CURA_ENGINE_DEBUG_SVG_LAYERS limits them to some layers, such as "0,10-12". Each drawing gets a file of its own,
+ * named after what it shows and the layer.
+ */
+class DebugOutput
+{
+public:
+    //! Whether the debug output is compiled in.
+    static constexpr bool compiled()
+    {
+#ifdef ENABLE_DEBUG_OUTPUT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //! Whether debug messages are logged, which the verbosity of the log decides.
+    static bool logEnabled()
+    {
+        return compiled() && spdlog::should_log(spdlog::level::debug);
+    }
+
+    //! Whether the drawings of a layer are written.
+    static bool svgEnabled(LayerIndex layer_nr);
+
+    /*!
+     * \brief Write a drawing of a layer to a file of its own.
+     * \param name What the drawing shows, which the file is named after.
+     * \param layer_nr The layer that it shows.
+     * \param aabb The area that the drawing covers.
+     * \param draw Draws onto the SVG.
+     */
+    static void writeSvg(std::string_view name, LayerIndex layer_nr, const AABB& aabb, const std::function<void(SVG&)>& draw);
+
+    /*!
+     * \brief Replace the output of the drawings from the environment variables.
+     * \param directory Where to write the drawings, or empty to write none.
+     * \param layers Which layers to draw, in the format of CURA_ENGINE_DEBUG_SVG_LAYERS, or empty for all of them.
+     */
+    static void setSvgOutput(std::string directory, std::string_view layers);
+};
+
+} // namespace cura
+
+#ifdef ENABLE_DEBUG_OUTPUT
+//! Logs a debug message like spdlog::debug, but only evaluates the arguments if debug messages are logged.
+#define CURA_LOG_DEBUG(...) \
+    do \
+    { \
+        if (cura::DebugOutput::logEnabled()) \
+        { \
+            spdlog::debug(__VA_ARGS__); \
+        } \
+    } while (false)
+
+//! Draws a layer with \ref DebugOutput::writeSvg, but only evaluates the arguments if the layer is drawn. The drawing
+//! function comes last, so that the commas in a lambda don't split it.
+#define CURA_DEBUG_SVG(name, layer_nr, aabb, ...) \
+    do \
+    { \
+        if (cura::DebugOutput::svgEnabled(layer_nr)) \
+        { \
+            cura::DebugOutput::writeSvg(name, layer_nr, aabb, __VA_ARGS__); \
+        } \
+    } while (false)
+#else
+#define CURA_LOG_DEBUG(...) \
+    do \
+    { \
+    } while (false)
+#define CURA_DEBUG_SVG(name, layer_nr, aabb, ...) \
+    do \
+    { \
+    } while (false)
+#endif
+
+#endif // UTILS_DEBUG_OUTPUT_H
@@ -94,6 +94,14 @@ struct ExtrusionLine
     {
     }
 
+    ExtrusionLine(ExtrusionLine&& other) noexcept
+        : inset_idx_(other.inset_idx_)
+        , is_odd_(other.is_odd_)
+        , is_closed_(other.is_closed_)
+        , junctions_(std::move(other.junctions_))
+    {
+    }
+
     ExtrusionLine& operator=(ExtrusionLine&& other)
     {
         junctions_ = std::move(other.junctions_);
@@ -200,6 +208,12 @@ struct ExtrusionLine
         junctions_.clear();
     }
 
+    /*!
+     * Free the memory that was reserved for more junctions than there are.
+     * \return How many bytes were freed.
+     */
+    size_t shrinkToFit();
+
     void reverse()
     {
         std::reverse(junctions_.begin(), junctions_.end());
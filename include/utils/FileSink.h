@@ -0,0 +1,92 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_FILE_SINK_H
+#define UTILS_FILE_SINK_H
+
+#include <cstdio>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A stream buffer that writes to a file through a large buffer of its own.
+ *
+ * A std::ofstream goes through its locale and a small buffer, which splits the output into many small writes. This
+ * collects the output in a large buffer and hands it to the operating system in big writes. Writes that are larger than
+ * the buffer, such as the chunks of g-code of the output writer, go to the file directly.
+ *
+ * Like a std::filebuf, it may only be used by one thread at a time.
+ */
+class FileSink : public std::streambuf, public NoCopy
+{
+public:
+    //! The default size of the buffer: large enough that writing to slow storage takes few calls.
+    static constexpr size_t default_buffer_size = 4 * 1024 * 1024;
+
+    /*!
+     * \param buffer_size How much to collect before writing it to the file.
+     */
+    explicit FileSink(const size_t buffer_size = default_buffer_size);
+
+    //! Writes what is left in the buffer, and closes the file.
+    ~FileSink() override;
+
+    /*!
+     * \brief Open a file to write to, replacing its contents.
+     *
+     * A file that was open before is closed first.
+     * \param filename The file to write to.
+     * \return Whether the file could be opened.
+     */
+    bool open(const char* filename);
+
+    //! Whether a file is open.
+    [[nodiscard]] bool isOpen() const;
+
+    //! Write what is left in the buffer, and close the file.
+    void close();
+
+    /*!
+     * \brief Write over a part of what was written to the file already, such as a header with values that are only
+     * known at the end.
+     *
+     * What is in the buffer is written first, and the next output goes to the end of the file again.
+     * \param offset Where in the file to start writing over it. In text mode only the start of the file, offset 0, is
+     * portable.
+     * \param data What to write over the file with. In text mode, its line endings must be converted to the same size as
+     * those of what it writes over.
+     * \return Whether all of it was written.
+     */
+    bool overwrite(const size_t offset, const std::string_view data);
+
+protected:
+    int_type overflow(int_type character) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+
+private:
+    std::vector<char> buffer_; //!< Where the output is collected.
+    std::FILE* file_ = nullptr; //!< The file to write to. Its own buffering is turned off, since this buffers already.
+
+    /*!
+     * \brief Write data to the file.
+     * \return Whether all of it was written.
+     */
+    bool write(const char* data, size_t count);
+
+    /*!
+     * \brief Write what is in the buffer to the file, and empty it.
+     * \return Whether all of it was written.
+     */
+    bool writeBuffer();
+};
+
+} // namespace cura
+
+#endif // UTILS_FILE_SINK_H
@@ -0,0 +1,259 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_FLAT_GRID_MAP_H
+#define UTILS_FLAT_GRID_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Point2LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Multimap from the cells of a grid to the elements in them, without an allocation for every element.
+ *
+ * This can stand in for the std::unordered_multimap<Point2LL, ValueT> that the grids used before, as far as they use
+ * it. The cells are kept in an open addressing hash table with linear probing. Each cell in the table points to a
+ * chain of its elements, which are all stored together. Elements are never moved once inserted, so references to
+ * them stay valid.
+ *
+ * Like the std::unordered_multimap of libstdc++, equal_range gives the elements of a cell from the last inserted to
+ * the first.
+ *
+ * \tparam ValueT The type of the elements.
+ */
+template<class ValueT>
+class FlatGridMap
+{
+public:
+    using key_type = Point2LL;
+    using mapped_type = ValueT;
+    using value_type = std::pair<Point2LL, ValueT>;
+    using iterator = typename std::deque<value_type>::iterator;
+    using const_iterator = typename std::deque<value_type>::const_iterator;
+
+    /*!
+     * \brief Iterates over the elements of one cell.
+     */
+    class const_local_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatGridMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_local_iterator() = default;
+
+        const_local_iterator(const FlatGridMap* map, const size_t element_idx)
+            : map_(map)
+            , element_idx_(element_idx)
+        {
+        }
+
+        reference operator*() const
+        {
+            return map_->elements_[element_idx_];
+        }
+
+        pointer operator->() const
+        {
+            return &map_->elements_[element_idx_];
+        }
+
+        const_local_iterator& operator++()
+        {
+            element_idx_ = map_->next_in_cell_[element_idx_];
+            return *this;
+        }
+
+        const_local_iterator operator++(int)
+        {
+            const_local_iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const const_local_iterator& other) const
+        {
+            return element_idx_ == other.element_idx_;
+        }
+
+    private:
+        const FlatGridMap* map_ = nullptr;
+        size_t element_idx_ = none;
+    };
+
+    iterator begin()
+    {
+        return elements_.begin();
+    }
+
+    iterator end()
+    {
+        return elements_.end();
+    }
+
+    const_iterator begin() const
+    {
+        return elements_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return elements_.end();
+    }
+
+    size_t size() const
+    {
+        return elements_.size();
+    }
+
+    bool empty() const
+    {
+        return elements_.empty();
+    }
+
+    /*!
+     * \brief Sets how full the table of cells may get before it grows.
+     *
+     * Linear probing slows down a lot when the table gets nearly full, so this is limited to \ref max_max_load_factor.
+     *
+     * \param max_load_factor The maximum number of cells per slot of the table.
+     */
+    void max_load_factor(const double max_load_factor)
+    {
+        max_load_factor_ = std::clamp(max_load_factor, min_max_load_factor, max_max_load_factor);
+    }
+
+    /*!
+     * \brief Makes room for \p count elements, as if they would all end up in different cells.
+     */
+    void reserve(const size_t count)
+    {
+        next_in_cell_.reserve(count);
+        rehashFor(count);
+    }
+
+    /*!
+     * \brief Adds an element to a cell.
+     *
+     * \param cell The cell to add it to.
+     * \param value The element.
+     * \return The element as stored in the map.
+     */
+    iterator emplace(const Point2LL& cell, const ValueT& value)
+    {
+        rehashFor(cell_count_ + 1);
+        Slot& slot = findSlot(slots_, cell);
+        if (slot.first == none)
+        {
+            slot.cell = cell;
+            cell_count_++;
+        }
+        next_in_cell_.push_back(slot.first);
+        slot.first = elements_.size();
+        elements_.emplace_back(cell, value);
+        return std::prev(elements_.end());
+    }
+
+    /*!
+     * \brief Gives the elements of one cell.
+     *
+     * \param cell The cell to get the elements of.
+     * \return The begin and end of the elements in the cell.
+     */
+    std::pair<const_local_iterator, const_local_iterator> equal_range(const Point2LL& cell) const
+    {
+        if (slots_.empty())
+        {
+            return { const_local_iterator(this, none), const_local_iterator(this, none) };
+        }
+        const Slot& slot = findSlot(slots_, cell);
+        return { const_local_iterator(this, slot.first), const_local_iterator(this, none) };
+    }
+
+private:
+    static constexpr size_t none = std::numeric_limits<size_t>::max();
+    static constexpr double min_max_load_factor = 0.125;
+    static constexpr double max_max_load_factor = 0.75;
+
+    //! A slot of the hash table, which holds a cell if it has any elements.
+    struct Slot
+    {
+        Point2LL cell;
+        size_t first = none; //!< The last inserted element in the cell, or none if the slot is free.
+    };
+
+    //! The hash table of cells. Its size is always a power of two.
+    std::vector<Slot> slots_;
+
+    //! The number of slots that hold a cell.
+    size_t cell_count_ = 0;
+
+    //! All of the elements, in the order they were inserted. A deque doesn't move them when it grows.
+    std::deque<value_type> elements_;
+
+    //! For each element, the element that was inserted before it in the same cell, or none.
+    std::vector<size_t> next_in_cell_;
+
+    double max_load_factor_ = max_max_load_factor;
+
+    /*!
+     * \brief Gives the slot of the table that holds \p cell, or the free slot where it would go.
+     *
+     * The table must have at least one free slot.
+     */
+    template<typename Slots>
+    static auto& findSlot(Slots& slots, const Point2LL& cell)
+    {
+        const size_t mask = slots.size() - 1;
+        // Grid coordinates are small and consecutive, so mix them before taking the low bits.
+        uint64_t hash = (static_cast<uint64_t>(cell.X) * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(cell.Y) * 0xC2B2AE3D27D4EB4FULL);
+        hash ^= hash >> 32;
+        for (size_t slot_idx = static_cast<size_t>(hash) & mask;; slot_idx = (slot_idx + 1) & mask)
+        {
+            if (slots[slot_idx].first == none || slots[slot_idx].cell == cell)
+            {
+                return slots[slot_idx];
+            }
+        }
+    }
+
+    /*!
+     * \brief Grows the table, if needed, so that it can hold \p cell_count cells.
+     */
+    void rehashFor(const size_t cell_count)
+    {
+        constexpr size_t min_slot_count = 16;
+        const size_t required_slots = std::max(min_slot_count, static_cast<size_t>(static_cast<double>(cell_count) / max_load_factor_) + 1);
+        if (slots_.size() >= required_slots)
+        {
+            return;
+        }
+        std::vector<Slot> new_slots(std::bit_ceil(required_slots));
+        for (const Slot& slot : slots_)
+        {
+            if (slot.first != none)
+            {
+                findSlot(new_slots, slot.cell) = slot;
+            }
+        }
+        slots_ = std::move(new_slots);
+    }
+};
+
+} // namespace cura
+
+#endif // UTILS_FLAT_GRID_MAP_H
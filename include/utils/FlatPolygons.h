@@ -0,0 +1,210 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_FLAT_POLYGONS_H
+#define UTILS_FLAT_POLYGONS_H
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "Point2LL.h"
+
+namespace cura
+{
+
+class Polygons;
+
+/*!
+ * \brief A read-only friendly representation of polygons: the vertices of all polygons in one buffer, with the offset
+ * into it at which each polygon starts.
+ *
+ * A Polygons allocates every polygon separately, which scatters the vertices over the heap. This keeps them together,
+ * making it cheaper to keep around and faster to run over for consumers that only read the shapes, such as inside tests
+ * that are repeated for many points. Polygons remains the type to do geometry with, since that is what Clipper works on.
+ */
+class FlatPolygons
+{
+public:
+    //! An iterator over the polygons, which are handed out as spans of vertices.
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::span<const Point2LL>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        const_iterator() = default;
+
+        const_iterator(const FlatPolygons* polygons, size_t poly_idx)
+            : polygons_(polygons)
+            , poly_idx_(poly_idx)
+        {
+        }
+
+        value_type operator*() const
+        {
+            return (*polygons_)[poly_idx_];
+        }
+
+        const_iterator& operator++()
+        {
+            poly_idx_++;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator result = *this;
+            poly_idx_++;
+            return result;
+        }
+
+        difference_type operator-(const const_iterator& other) const
+        {
+            return static_cast<difference_type>(poly_idx_) - static_cast<difference_type>(other.poly_idx_);
+        }
+
+        bool operator==(const const_iterator& other) const = default;
+
+    private:
+        const FlatPolygons* polygons_ = nullptr;
+        size_t poly_idx_ = 0;
+    };
+
+    FlatPolygons() = default;
+
+    /*!
+     * \brief Copies the vertices of the polygons into a single buffer, allocating it once.
+     */
+    explicit FlatPolygons(const Polygons& polygons);
+
+    //! The number of polygons.
+    size_t size() const
+    {
+        return offsets_.size() - 1;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    //! The number of vertices of all polygons together.
+    size_t pointCount() const
+    {
+        return points_.size();
+    }
+
+    //! The vertices of the polygon with index \p poly_idx.
+    std::span<const Point2LL> operator[](size_t poly_idx) const
+    {
+        return std::span<const Point2LL>(points_.data() + offsets_[poly_idx], points_.data() + offsets_[poly_idx + 1]);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, size());
+    }
+
+    //! The vertices of all polygons, one polygon after the other.
+    std::span<const Point2LL> points() const
+    {
+        return points_;
+    }
+
+    /*!
+     * \brief Appends a polygon.
+     */
+    void add(std::span<const Point2LL> polygon);
+
+    /*!
+     * \brief Makes room for more polygons and vertices, to add them without reallocating.
+     */
+    void reserve(size_t polygon_count, size_t point_count);
+
+    void clear();
+
+    /*!
+     * \brief Copies the polygons back into a Polygons, to do geometry with them.
+     */
+    Polygons toPolygons() const;
+
+    /*!
+     * \brief Checks if the point is inside the polygons, with the same even-odd rule as Polygons::inside.
+     *
+     * \param p The point to check.
+     * \param border_result What to return when the point is exactly on the border.
+     * \return Whether the point is inside the polygons.
+     */
+    bool inside(Point2LL p, bool border_result = false) const;
+
+    /*!
+     * \brief Checks for many points at once whether they are inside the polygons, with the same rule as the single
+     * point version.
+     *
+     * This builds an EdgeBandIndex for the call. Keep an EdgeBandIndex around instead to test more batches of points
+     * against the same polygons.
+     *
+     * \param points The points to check.
+     * \param border_result What to return for the points that are exactly on the border.
+     * \return For each point, whether it is inside the polygons.
+     */
+    std::vector<bool> inside(std::span<const Point2LL> points, bool border_result = false) const;
+
+private:
+    std::vector<Point2LL> points_;
+    std::vector<size_t> offsets_{ 0 }; //!< Where each polygon starts in points_, plus where the last one ends.
+};
+
+/*!
+ * \brief The edges of some polygons sorted into horizontal bands, to test many points for being inside of them.
+ *
+ * A point can only be on or left of an edge that spans its Y coordinate, so a point only needs to be tested against the
+ * edges in its band rather than against the whole outline. The edges are stored as separate arrays of coordinates
+ * and are tested without branches, which the compiler can vectorize when the target has wide enough vector
+ * instructions, such as with -march=x86-64-v2.
+ */
+class EdgeBandIndex
+{
+public:
+    /*!
+     * \param polygons The polygons to test points against. Their edges are copied, so they don't need to outlive the
+     * index.
+     * \param band_count How many bands to divide the height of the polygons into. With 0, it depends on the number of
+     * edges.
+     */
+    explicit EdgeBandIndex(const FlatPolygons& polygons, size_t band_count = 0);
+
+    /*!
+     * \brief Checks if the point is inside the polygons, with the same even-odd rule as Polygons::inside.
+     */
+    bool inside(Point2LL p, bool border_result = false) const;
+
+    /*!
+     * \brief Checks for many points whether they are inside the polygons.
+     * \return For each point, whether it is inside the polygons.
+     */
+    std::vector<bool> inside(std::span<const Point2LL> points, bool border_result = false) const;
+
+private:
+    coord_t min_y_ = 0;
+    coord_t band_height_ = 1;
+    std::vector<size_t> band_starts_{ 0 }; //!< Where the edges of each band start in the coordinate arrays, plus where the last band ends.
+    std::vector<double> x0_;
+    std::vector<double> y0_;
+    std::vector<double> x1_;
+    std::vector<double> y1_;
+};
+
+} // namespace cura
+
+#endif // UTILS_FLAT_POLYGONS_H
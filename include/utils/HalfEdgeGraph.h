@@ -13,6 +13,7 @@
 #include "HalfEdge.h"
 #include "HalfEdgeNode.h"
 #include "SVG.h"
+#include "ThreadArena.h"
 
 namespace cura
 {
@@ -24,8 +25,22 @@ class HalfEdgeGraph
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    std::list<edge_t> edges;
-    std::list<node_t> nodes;
+    using edges_t = arena_list<edge_t>;
+    using nodes_t = arena_list<node_t>;
+
+    /*!
+     * The graph is a temporary of the task creating it, so its edges and nodes come from the task's thread arena.
+     */
+    HalfEdgeGraph()
+#ifdef ENABLE_THREAD_ARENA
+        : edges(ThreadArena::resource())
+        , nodes(ThreadArena::resource())
+#endif
+    {
+    }
+
+    edges_t edges;
+    nodes_t nodes;
 };
 
 } // namespace cura
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_MEMORY_BUDGET_H
+#define UTILS_MEMORY_BUDGET_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace cura
+{
+
+/*!
+ * \brief How much memory a slice may take, and how close the process is to it.
+ *
+ * The budget is set with the environment variable CURA_ENGINE_MEMORY_BUDGET_MB, for workers that are killed when they
+ * take more than their share. Without it, there is no budget and the pressure is always NONE.
+ *
+ * The engine keeps below the budget by holding back as it gets closer: under HIGH pressure the layer plans stop
+ * piling up and the caches that outlive a slice are dropped, and under CRITICAL pressure the parallel loops run on
+ * fewer threads, since each thread holds the temporary areas of the items it works on.
+ *
+ * What the process holds is sampled from the operating system, at most once per \ref sample_interval.
+ */
+class MemoryBudget
+{
+public:
+    enum class Pressure
+    {
+        NONE, //!< Well within the budget, or there is no budget.
+        HIGH, //!< Past \ref high_fraction of the budget.
+        CRITICAL //!< Past \ref critical_fraction of the budget.
+    };
+
+    //! The part of the budget past which the pressure is high.
+    static constexpr double high_fraction = 0.75;
+
+    //! The part of the budget past which the pressure is critical.
+    static constexpr double critical_fraction = 0.9;
+
+    //! How long a sample of the memory of the process is used for, since sampling it takes a system call or a file read.
+    static constexpr std::chrono::milliseconds sample_interval{ 50 };
+
+    /*!
+     * \brief Get the budget.
+     * \return The number of bytes the process may hold, or 0 if there is no budget.
+     */
+    static size_t getBudgetBytes();
+
+    /*!
+     * \brief Replace the budget from the environment variable.
+     * \param budget_bytes The number of bytes the process may hold, or 0 for no budget.
+     */
+    static void setBudgetBytes(size_t budget_bytes);
+
+    /*!
+     * \brief Get how close the process is to the budget, from a recent sample of what it holds.
+     */
+    static Pressure getPressure();
+
+    /*!
+     * \brief Get how close an amount of memory is to a budget.
+     * \param resident_bytes What the process holds.
+     * \param budget_bytes The budget, or 0 for no budget.
+     */
+    static Pressure getPressure(size_t resident_bytes, size_t budget_bytes);
+
+    /*!
+     * \brief Get how many threads a parallel loop may run on.
+     *
+     * Under critical pressure, this halves the number of threads.
+     * \param thread_count How many threads the loop would run on without a budget.
+     * \return How many threads it may run on, at least 1.
+     */
+    static size_t limitParallelism(size_t thread_count);
+};
+
+} // namespace cura
+
+#endif // UTILS_MEMORY_BUDGET_H
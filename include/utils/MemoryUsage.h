@@ -0,0 +1,35 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_MEMORY_USAGE_H
+#define UTILS_MEMORY_USAGE_H
+
+#include <cstddef>
+
+namespace cura
+{
+
+/*!
+ * \brief How much memory the process holds, as the operating system reports it.
+ *
+ * On platforms where this can't be found out, both are 0.
+ */
+struct MemoryUsage
+{
+    size_t resident_bytes = 0; //!< The memory that the process holds right now.
+    size_t peak_resident_bytes = 0; //!< The most memory that the process held since \ref resetPeak, or since it started.
+
+    //! Ask the operating system how much memory the process holds.
+    static MemoryUsage sample();
+
+    /*!
+     * \brief Start measuring the peak from what the process holds now, so that the peak of each stage can be told apart.
+     *
+     * Only Linux can do this. Elsewhere the peak stays the peak since the process started.
+     */
+    static void resetPeak();
+};
+
+} // namespace cura
+
+#endif // UTILS_MEMORY_USAGE_H
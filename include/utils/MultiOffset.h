@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_MULTI_OFFSET_H
+#define UTILS_MULTI_OFFSET_H
+
+#include <vector>
+
+#include <polyclipping/clipper.hpp>
+
+#include "Coord_t.h"
+
+namespace cura
+{
+
+class Polygons;
+
+/*!
+ * \brief Offsets the same polygons by several distances, preparing them for Clipper only once.
+ *
+ * Each call of Polygons::offset unions the polygons and hands them to Clipper again, which cleans the vertices up and
+ * orients the polygons before it can offset them. Loops that offset the same outline by growing distances, such as
+ * for the lines of a brim, can do that once with this instead. The results are the same as those of
+ * Polygons::offset.
+ */
+class MultiOffset
+{
+public:
+    /*!
+     * \param polygons The polygons to offset. They must outlive this object.
+     * \param join_type How to join the offset edges at the corners.
+     * \param miter_limit How far mitered corners may stick out, in multiples of the offset distance.
+     */
+    explicit MultiOffset(const Polygons& polygons, ClipperLib::JoinType join_type = ClipperLib::jtMiter, double miter_limit = 1.2);
+
+    /*!
+     * \brief Offsets the polygons by one distance, like `polygons.offset(distance, join_type, miter_limit)`.
+     */
+    Polygons offset(coord_t distance);
+
+    /*!
+     * \brief Offsets the polygons by each of the distances.
+     * \return The offset polygons, in the order of the distances.
+     */
+    std::vector<Polygons> offset(const std::vector<coord_t>& distances);
+
+private:
+    const Polygons& polygons_;
+    ClipperLib::ClipperOffset clipper_;
+};
+
+} // namespace cura
+
+#endif // UTILS_MULTI_OFFSET_H
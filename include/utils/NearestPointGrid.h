@@ -0,0 +1,230 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_NEAREST_POINT_GRID_H
+#define UTILS_NEAREST_POINT_GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "Point2LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A grid of points with values, to visit the points from nearest to furthest from a query point while points are
+ * being removed.
+ *
+ * The cells around the query point are visited ring by ring, so a search only looks at the cells up to the distance of
+ * what it is looking for, however far that is. Unlike SparsePointGridInclusive, which only looks within a fixed radius.
+ *
+ * When most points are removed, the cells are made larger so that a search doesn't go past ever more empty cells.
+ * \tparam Val The values stored with the points. Removing a point needs both its location and its value.
+ */
+template<typename Val>
+class NearestPointGrid
+{
+public:
+    /*!
+     * \brief Create an empty grid.
+     * \param cell_size The size of the cells. For fast searches, the cells should contain about one point each.
+     */
+    explicit NearestPointGrid(const coord_t cell_size)
+        : cell_size_(std::max(coord_t(1), cell_size))
+    {
+    }
+
+    //! The number of points in the grid.
+    size_t size() const
+    {
+        return size_;
+    }
+
+    //! Whether the grid has no points.
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    //! Add a point with a value.
+    void insert(const Point2LL& point, const Val& val)
+    {
+        const Point2LL cell = toGridPoint(point);
+        if (cells_.empty())
+        {
+            min_cell_ = cell;
+            max_cell_ = cell;
+        }
+        min_cell_ = Point2LL(std::min(min_cell_.X, cell.X), std::min(min_cell_.Y, cell.Y));
+        max_cell_ = Point2LL(std::max(max_cell_.X, cell.X), std::max(max_cell_.Y, cell.Y));
+        cells_[cell].push_back(Elem{ point, val });
+        size_++;
+        peak_size_ = std::max(peak_size_, size_);
+    }
+
+    /*!
+     * \brief Remove a point that was added with a value.
+     * \return Whether the point was in the grid with that value.
+     */
+    bool remove(const Point2LL& point, const Val& val)
+    {
+        const auto cell = cells_.find(toGridPoint(point));
+        if (cell == cells_.end())
+        {
+            return false;
+        }
+        std::vector<Elem>& elems = cell->second;
+        const auto elem = std::find_if(
+            elems.begin(),
+            elems.end(),
+            [&point, &val](const Elem& elem)
+            {
+                return elem.point == point && elem.val == val;
+            });
+        if (elem == elems.end())
+        {
+            return false;
+        }
+        *elem = std::move(elems.back());
+        elems.pop_back();
+        if (elems.empty())
+        {
+            cells_.erase(cell);
+        }
+        size_--;
+        if (size_ > 0 && size_ * 4 < peak_size_)
+        {
+            coarsen();
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Visit the points around a query point, nearest first.
+     *
+     * The points are visited a ring of cells at a time. Within a ring they are not ordered by their distance. After each
+     * ring, \p keep_searching gets the distance that all points not visited yet are at least away from the query point.
+     * \param query_pt The point to search around.
+     * \param process_elem Called as process_elem(point, value) for each point.
+     * \param keep_searching Called as keep_searching(distance) after each ring. Visiting stops when it returns false.
+     */
+    template<typename ProcessElem, typename KeepSearching>
+    void processNearestFirst(const Point2LL& query_pt, ProcessElem&& process_elem, KeepSearching&& keep_searching) const
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+        const Point2LL query_cell = toGridPoint(query_pt);
+        // Rings that are entirely outside of the occupied cells have nothing to visit.
+        const coord_t dist_x_to_bounds = std::max({ coord_t(0), min_cell_.X - query_cell.X, query_cell.X - max_cell_.X });
+        const coord_t dist_y_to_bounds = std::max({ coord_t(0), min_cell_.Y - query_cell.Y, query_cell.Y - max_cell_.Y });
+        const coord_t first_ring = std::max(dist_x_to_bounds, dist_y_to_bounds);
+        const coord_t last_ring = std::max({ query_cell.X - min_cell_.X, max_cell_.X - query_cell.X, query_cell.Y - min_cell_.Y, max_cell_.Y - query_cell.Y });
+
+        size_t visited = 0;
+        const auto process_cell = [this, &process_elem, &visited](const coord_t x, const coord_t y)
+        {
+            const auto cell = cells_.find(Point2LL(x, y));
+            if (cell == cells_.end())
+            {
+                return;
+            }
+            for (const Elem& elem : cell->second)
+            {
+                process_elem(elem.point, elem.val);
+            }
+            visited += cell->second.size();
+        };
+        for (coord_t ring = first_ring; ring <= last_ring; ring++)
+        {
+            const coord_t x_min = std::max(query_cell.X - ring, min_cell_.X);
+            const coord_t x_max = std::min(query_cell.X + ring, max_cell_.X);
+            const coord_t y_min = std::max(query_cell.Y - ring, min_cell_.Y);
+            const coord_t y_max = std::min(query_cell.Y + ring, max_cell_.Y);
+            if (query_cell.Y - ring >= min_cell_.Y) // Bottom row.
+            {
+                for (coord_t x = x_min; x <= x_max; x++)
+                {
+                    process_cell(x, query_cell.Y - ring);
+                }
+            }
+            if (ring > 0 && query_cell.Y + ring <= max_cell_.Y) // Top row.
+            {
+                for (coord_t x = x_min; x <= x_max; x++)
+                {
+                    process_cell(x, query_cell.Y + ring);
+                }
+            }
+            // The columns, without the corners that the rows already had.
+            for (coord_t y = std::max(y_min, query_cell.Y - ring + 1); y <= std::min(y_max, query_cell.Y + ring - 1); y++)
+            {
+                if (query_cell.X - ring >= min_cell_.X)
+                {
+                    process_cell(query_cell.X - ring, y);
+                }
+                if (ring > 0 && query_cell.X + ring <= max_cell_.X)
+                {
+                    process_cell(query_cell.X + ring, y);
+                }
+            }
+            // The query point lies somewhere in its own cell, so the cells of the next ring are at least this far away.
+            if (visited >= size_ || ! keep_searching(ring * cell_size_))
+            {
+                return;
+            }
+        }
+    }
+
+private:
+    struct Elem
+    {
+        Point2LL point;
+        Val val;
+    };
+
+    coord_t cell_size_;
+    std::unordered_map<Point2LL, std::vector<Elem>> cells_;
+    Point2LL min_cell_; //!< The lowest cell coordinates that were occupied since the cells last changed size.
+    Point2LL max_cell_; //!< The highest cell coordinates that were occupied since the cells last changed size.
+    size_t size_ = 0;
+    size_t peak_size_ = 0; //!< The most points there were since the cells last changed size.
+
+    /*!
+     * The cell of a point. Unlike SquareGrid, this rounds down rather than towards zero, so that all cells are equally
+     * large and the distance to a ring of cells is known.
+     */
+    Point2LL toGridPoint(const Point2LL& point) const
+    {
+        const auto floor_div = [this](const coord_t coord)
+        {
+            return coord / cell_size_ - (coord % cell_size_ < 0 ? 1 : 0);
+        };
+        return Point2LL(floor_div(point.X), floor_div(point.Y));
+    }
+
+    //! Double the size of the cells, to keep a few points in each as points get removed.
+    void coarsen()
+    {
+        std::unordered_map<Point2LL, std::vector<Elem>> old_cells;
+        std::swap(old_cells, cells_);
+        cell_size_ *= 2;
+        size_ = 0;
+        peak_size_ = 0;
+        for (auto& [cell, elems] : old_cells)
+        {
+            for (Elem& elem : elems)
+            {
+                insert(elem.point, elem.val);
+            }
+        }
+    }
+};
+
+} // namespace cura
+
+#endif // UTILS_NEAREST_POINT_GRID_H
@@ -0,0 +1,201 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_PACKED_EXTRUSION_LINE_H
+#define UTILS_PACKED_EXTRUSION_LINE_H
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "ExtrusionJunction.h"
+#include "Point2LL.h"
+
+namespace cura
+{
+
+struct ExtrusionLine;
+
+/*!
+ * \brief A variable-width line that keeps the positions, widths and perimeter indices of its junctions in separate
+ * arrays.
+ *
+ * An ExtrusionLine interleaves them, so an algorithm that only looks at where the junctions are drags their widths
+ * and perimeter indices through the cache as well. Here the positions are packed together, which halves the memory
+ * that such an algorithm runs over. ExtrusionLine remains the type that is passed around; Simplify can work on this
+ * directly, for code that keeps its lines packed. Converting reuses the memory of the arrays, so one packed line can
+ * serve many extrusion lines in turn.
+ */
+class PackedExtrusionLine
+{
+public:
+    /*!
+     * \brief Refers to one junction of a packed line, as a stand-in for a reference to an ExtrusionJunction.
+     *
+     * \tparam Line The packed line, which is const for a reference that can only be read through.
+     */
+    template<typename Line>
+    class BasicJunctionReference
+    {
+    public:
+        BasicJunctionReference(Line& line, size_t index)
+            : line_(&line)
+            , index_(index)
+        {
+        }
+
+        //! A read-only reference can be made from any reference.
+        template<typename OtherLine>
+        requires std::is_const_v<Line> BasicJunctionReference(const BasicJunctionReference<OtherLine>& other)
+            : line_(other.line_)
+            , index_(other.index_)
+        {
+        }
+
+        const Point2LL& position() const
+        {
+            return line_->points_[index_];
+        }
+
+        coord_t width() const
+        {
+            return line_->widths_[index_];
+        }
+
+        size_t perimeterIndex() const
+        {
+            return line_->perimeter_indices_[index_];
+        }
+
+        //! Gives a copy of the junction as an ExtrusionJunction.
+        ExtrusionJunction junction() const
+        {
+            return ExtrusionJunction(position(), width(), perimeterIndex());
+        }
+
+        //! Overwrites the junction that this refers to.
+        const BasicJunctionReference& operator=(const ExtrusionJunction& junction) const requires(! std::is_const_v<Line>)
+        {
+            line_->points_[index_] = junction.p_;
+            line_->widths_[index_] = junction.w_;
+            line_->perimeter_indices_[index_] = junction.perimeter_index_;
+            return *this;
+        }
+
+    private:
+        template<typename OtherLine>
+        friend class BasicJunctionReference;
+
+        Line* line_;
+        size_t index_;
+    };
+
+    using JunctionReference = BasicJunctionReference<PackedExtrusionLine>;
+    using ConstJunctionReference = BasicJunctionReference<const PackedExtrusionLine>;
+
+    /*!
+     * Which inset this path represents, counted from the outside inwards. See ExtrusionLine::inset_idx_.
+     */
+    size_t inset_idx_ = 0;
+
+    /*!
+     * Whether this is an odd wall through the middle of a thin piece. See ExtrusionLine::is_odd_.
+     */
+    bool is_odd_ = false;
+
+    /*!
+     * Whether this is a closed polygonal path.
+     */
+    bool is_closed_ = false;
+
+    PackedExtrusionLine() = default;
+
+    PackedExtrusionLine(size_t inset_idx, bool is_odd, bool is_closed);
+
+    /*!
+     * \brief Copies the junctions of an extrusion line into separate arrays.
+     */
+    explicit PackedExtrusionLine(const ExtrusionLine& line);
+
+    /*!
+     * \brief Replaces the contents with those of an extrusion line, reusing the memory that was allocated before.
+     */
+    void assign(const ExtrusionLine& line);
+
+    /*!
+     * \brief Copies the line back into an ExtrusionLine.
+     */
+    ExtrusionLine toExtrusionLine() const;
+
+    /*!
+     * \brief Copies the line back into an existing ExtrusionLine, reusing the memory of its junctions.
+     */
+    void toExtrusionLine(ExtrusionLine& line) const;
+
+    //! The number of junctions.
+    size_t size() const
+    {
+        return points_.size();
+    }
+
+    bool empty() const
+    {
+        return points_.empty();
+    }
+
+    ConstJunctionReference operator[](size_t index) const
+    {
+        return ConstJunctionReference(*this, index);
+    }
+
+    JunctionReference operator[](size_t index)
+    {
+        return JunctionReference(*this, index);
+    }
+
+    //! The positions of all junctions, in order.
+    std::span<const Point2LL> points() const
+    {
+        return points_;
+    }
+
+    //! The widths of all junctions, in order.
+    std::span<const coord_t> widths() const
+    {
+        return widths_;
+    }
+
+    //! The perimeter indices of all junctions, in order.
+    std::span<const size_t> perimeterIndices() const
+    {
+        return perimeter_indices_;
+    }
+
+    void push_back(const ExtrusionJunction& junction)
+    {
+        points_.push_back(junction.p_);
+        widths_.push_back(junction.w_);
+        perimeter_indices_.push_back(junction.perimeter_index_);
+    }
+
+    /*!
+     * \brief Makes room for more junctions, to add them without reallocating.
+     */
+    void reserve(size_t junction_count);
+
+    void clear();
+
+    /*!
+     * \brief The length of the path, with the closing segment if the line is closed. See ExtrusionLine::getLength.
+     */
+    coord_t getLength() const;
+
+private:
+    std::vector<Point2LL> points_;
+    std::vector<coord_t> widths_;
+    std::vector<size_t> perimeter_indices_;
+};
+
+} // namespace cura
+#endif // UTILS_PACKED_EXTRUSION_LINE_H
@@ -0,0 +1,160 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_POLYGONS_SPATIAL_INDEX_H
+#define UTILS_POLYGONS_SPATIAL_INDEX_H
+
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "Coord_t.h"
+#include "Point2LL.h"
+#include "utils/polygonUtils.h"
+
+namespace cura
+{
+
+class Polygons;
+
+/*!
+ * \brief A grid of the segments of some polygons, to find the closest point on them, or whether a point is inside of
+ * them, faster than by looking at every segment.
+ *
+ * The queries give the same results as the functions of PolygonUtils and Polygons that they are named after, except
+ * for which of several equally close points is found. Unlike PolygonUtils::findClose with a LocToLineGrid, they always find the
+ * closest point, however far away it is, by searching outward from the query point until no closer segment can remain.
+ *
+ * The grid is only built by the first query, so it costs nothing to create an index for polygons that might not get
+ * queried at all. Queries can be run from several threads at once.
+ */
+class PolygonsSpatialIndex
+{
+public:
+    /*!
+     * \param polygons The polygons to find points on. They must outlive the index and must not change while it is used.
+     */
+    explicit PolygonsSpatialIndex(const Polygons& polygons);
+
+    PolygonsSpatialIndex(const PolygonsSpatialIndex&) = delete;
+    PolygonsSpatialIndex& operator=(const PolygonsSpatialIndex&) = delete;
+
+    const Polygons& polygons() const
+    {
+        return polygons_;
+    }
+
+    /*!
+     * \brief Finds the closest point on the polygons, like PolygonUtils::findClosest without a penalty function.
+     *
+     * \param from The point to find the closest point to.
+     * \return The closest point, or an invalid ClosestPolygonPoint if the polygons have no points at all.
+     */
+    ClosestPolygonPoint findClosest(Point2LL from) const;
+
+    /*!
+     * \brief Finds the closest vertex of the polygons, like PolygonUtils::findNearestVert.
+     *
+     * \param from The point to find the closest vertex to.
+     * \return The index of the closest vertex, which is invalid if the polygons have no points at all.
+     */
+    PolygonsPointIndex findNearestVert(Point2LL from) const;
+
+    /*!
+     * \brief Moves a point to \p distance inside of the polygons, like PolygonUtils::moveInside2.
+     *
+     * \param from The point to move, in place.
+     * \param distance How far inside of the polygons to move it. Negative distances move it outside.
+     * \param max_dist2 The squared distance beyond which a point on the wrong side of the polygons is not moved.
+     * \return The point on the polygons that the point was moved from, or an invalid ClosestPolygonPoint if it wasn't
+     * moved.
+     */
+    ClosestPolygonPoint moveInside2(Point2LL& from, const int distance = 0, const int64_t max_dist2 = std::numeric_limits<int64_t>::max()) const;
+
+    /*!
+     * \brief Makes sure a point ends up inside or outside of the polygons, like PolygonUtils::ensureInsideOrOutside.
+     *
+     * \param from The point to move, in place.
+     * \param preferred_dist_inside How far inside of the polygons to move it. Negative distances move it outside.
+     * \param max_dist2 The squared distance beyond which a point on the wrong side of the polygons is not moved.
+     * \return The point on the polygons that the point was moved from, or an invalid ClosestPolygonPoint if it couldn't
+     * be moved.
+     */
+    ClosestPolygonPoint ensureInsideOrOutside(Point2LL& from, const int preferred_dist_inside, const int64_t max_dist2 = std::numeric_limits<int64_t>::max()) const;
+
+    /*!
+     * \brief Checks whether a point is inside of the polygons, like Polygons::inside.
+     *
+     * \param p The point to check.
+     * \param border_result What to return when the point is exactly on the border of the polygons.
+     * \return Whether the point is inside.
+     */
+    bool inside(Point2LL p, bool border_result = false) const;
+
+    /*!
+     * \brief Checks whether a line segment crosses the polygons, like PolygonUtils::polygonCollidesWithLineSegment.
+     *
+     * \param start The start of the line segment.
+     * \param end The end of the line segment.
+     * \return Whether the line segment crosses or touches any segment of the polygons.
+     */
+    bool collidesWithLineSegment(Point2LL start, Point2LL end) const;
+
+private:
+    //! A segment of the polygons, from the vertex with index point_idx to the next one.
+    struct Segment
+    {
+        Point2LL start;
+        Point2LL end;
+        size_t poly_idx;
+        size_t point_idx;
+    };
+
+    //! The cells of the grid, with the segments crossing each of them.
+    struct Grid
+    {
+        Point2LL origin; //!< The lower left corner of the grid.
+        coord_t cell_size = 1;
+        coord_t width = 0; //!< The number of cells in the X direction.
+        coord_t height = 0; //!< The number of cells in the Y direction.
+        std::vector<size_t> cell_starts; //!< Where the segments of each cell start in cell_segments, plus where the last cell ends.
+        std::vector<size_t> cell_segments; //!< For each cell, the indices in segments of the segments crossing it.
+        std::vector<Segment> segments;
+    };
+
+    const Polygons& polygons_;
+    mutable std::once_flag built_;
+    mutable Grid grid_;
+
+    /*!
+     * \brief Fills the grid, the first time that it is needed.
+     */
+    void ensureBuilt() const;
+
+    /*!
+     * \brief Calls \p function for the index of every cell that a line segment may cross.
+     *
+     * That's the cells of its bounding box in each column that it crosses, which is only a few more than the cells it
+     * actually crosses. Parts of the line segment outside of the grid are skipped.
+     */
+    template<typename Function>
+    static void forEachCell(const Grid& grid, const Point2LL& start, const Point2LL& end, Function&& function);
+
+    /*!
+     * \brief Calls \p visit for the segments of the cells around \p from, in rings of cells of growing size.
+     *
+     * After each ring, the search stops if \p visit has found a point closer than the distance to the cells that have
+     * not been visited yet.
+     *
+     * \param from The point to search around.
+     * \param visit Called for the index of each segment in the visited cells, which can be the same segment more than
+     * once. It returns the squared distance of the closest point that it found so far.
+     */
+    template<typename Visitor>
+    void visitOutward(const Point2LL& from, Visitor&& visit) const;
+};
+
+} // namespace cura
+
+#endif // UTILS_POLYGONS_SPATIAL_INDEX_H
@@ -64,7 +64,7 @@ public:
         // populate grid
         for (size_t line_idx = 0; line_idx < lines.size(); line_idx++)
         {
-            const auto line = lines[line_idx];
+            const auto& line = lines[line_idx];
             grid.insert(PathsPointIndex<Paths>(&lines, line_idx, 0));
             grid.insert(PathsPointIndex<Paths>(&lines, line_idx, line.size() - 1));
         }
@@ -78,10 +78,12 @@ public:
                 continue;
             }
             processed[line_idx] = true;
-            const auto line = lines[line_idx];
+            const auto& line = lines[line_idx];
             bool should_close = isOdd(line);
 
+            // The only copy of the points of the lines. The chain is moved into the result once it's complete.
             Path chain = line;
+            coord_t chain_length = chain.polylineLength(); // Kept up to date as lines are appended. Reversing doesn't change it.
             bool closest_is_closing_polygon = false;
             for (bool go_in_reverse_direction : { false, true }) // first go in the unreversed direction, to try to prevent the chain.reverse() operation.
             { // NOTE: Implementation only works for this order; we currently only re-reverse the chain when it's closed.
@@ -89,7 +91,6 @@ public:
                 { // try extending chain in the other direction
                     chain.reverse();
                 }
-                coord_t chain_length = chain.polylineLength();
 
                 while (true)
                 {
@@ -218,7 +219,7 @@ public:
             }
             if (closest_is_closing_polygon)
             {
-                result_polygons.emplace_back(chain);
+                result_polygons.emplace_back(std::move(chain));
             }
             else
             {
@@ -228,7 +229,7 @@ public:
                     // the polyline isn't allowed to be reversed, so we re-reverse it.
                     chain.reverse();
                 }
-                result_lines.emplace_back(chain);
+                result_lines.emplace_back(std::move(chain));
             }
         }
     }
@@ -0,0 +1,106 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_RADIX_SORT_H
+#define UTILS_RADIX_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "math.h" // round_up_divide
+
+namespace cura
+{
+
+/*!
+ * \brief Stable least-significant-digit radix sort, run on the thread pool.
+ *
+ * Sorts the items by an unsigned 64-bit key, 8 bits at a time. Every pass
+ * counts the digits per chunk in parallel and then scatters the chunks in
+ * parallel, so the relative order of items with equal keys is preserved.
+ * Passes in which all items share the same digit are skipped.
+ *
+ * \param items The items to sort. They are sorted in place.
+ * \param get_key Closure returning the uint64_t key of an item. It is called a
+ * couple of times per item per pass, so it should be cheap.
+ */
+template<typename T, typename F>
+void parallel_radix_sort(std::vector<T>& items, F&& get_key)
+{
+    constexpr size_t digit_bits = 8;
+    constexpr size_t digit_count = 1 << digit_bits;
+    using histogram_t = std::array<size_t, digit_count>;
+
+    const size_t nitems = items.size();
+    if (nitems <= 1)
+    {
+        return;
+    }
+
+    ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
+    assert(thread_pool);
+    const size_t nchunks = std::min(nitems, 4 * (thread_pool->thread_count() + 1));
+    const size_t chunk_size = round_up_divide(nitems, nchunks);
+
+    std::vector<T> buffer(nitems);
+    std::vector<histogram_t> histograms(nchunks);
+    for (size_t shift = 0; shift < 64; shift += digit_bits)
+    {
+        const auto digit = [&get_key, shift](const T& item)
+        {
+            return static_cast<size_t>((get_key(item) >> shift) & (digit_count - 1));
+        };
+
+        cura::parallel_for<size_t>(
+            0,
+            nchunks,
+            [&](size_t chunk_idx)
+            {
+                histogram_t& histogram = histograms[chunk_idx];
+                histogram.fill(0);
+                for (size_t item_idx = chunk_idx * chunk_size; item_idx < std::min(nitems, (chunk_idx + 1) * chunk_size); item_idx++)
+                {
+                    histogram[digit(items[item_idx])]++;
+                }
+            });
+
+        // Turn the counts into the position where each chunk starts writing each digit.
+        size_t offset = 0;
+        bool all_same_digit = false;
+        for (size_t digit_value = 0; digit_value < digit_count; digit_value++)
+        {
+            const size_t digit_start = offset;
+            for (histogram_t& histogram : histograms)
+            {
+                const size_t count = histogram[digit_value];
+                histogram[digit_value] = offset;
+                offset += count;
+            }
+            all_same_digit |= offset - digit_start == nitems;
+        }
+        if (all_same_digit)
+        {
+            continue; // This pass wouldn't change the order.
+        }
+
+        cura::parallel_for<size_t>(
+            0,
+            nchunks,
+            [&](size_t chunk_idx)
+            {
+                histogram_t& positions = histograms[chunk_idx];
+                for (size_t item_idx = chunk_idx * chunk_size; item_idx < std::min(nitems, (chunk_idx + 1) * chunk_size); item_idx++)
+                {
+                    buffer[positions[digit(items[item_idx])]++] = std::move(items[item_idx]);
+                }
+            });
+        items.swap(buffer);
+    }
+}
+
+} // namespace cura
+
+#endif // UTILS_RADIX_SORT_H
@@ -5,6 +5,7 @@
 #define SVG_H
 
 #include <concepts>
+#include <span>
 #include <stdio.h> // for file output
 
 #include <boost/polygon/voronoi.hpp>
@@ -17,6 +18,7 @@
 namespace cura
 {
 
+class FlatPolygons;
 class Point3D;
 
 class SVG : NoCopy
@@ -63,6 +65,9 @@ private:
     std::string toString(const Color color) const;
     std::string toString(const ColorObject& color) const;
 
+    //! Writes the edges of a closed polygon, for both writePolygon and the flat writePolygons.
+    void writeClosedPath(std::span<const Point2LL> poly, const ColorObject color, const double stroke_width) const;
+
     FILE* out_; // the output file
     const AABB aabb_; // the boundary box to display
     const Point2LL aabb_size_;
@@ -146,6 +151,8 @@ public:
 
     void writePolygons(const Polygons& polys, const ColorObject color = Color::BLACK, const double stroke_width = 1.0, const bool flush = true) const;
 
+    void writePolygons(const FlatPolygons& polys, const ColorObject color = Color::BLACK, const double stroke_width = 1.0, const bool flush = true) const;
+
     void writePolygon(ConstPolygonRef poly, const ColorObject color = Color::BLACK, const double stroke_width = 1.0, const bool flush = true) const;
 
     void writePolylines(const Polygons& polys, const ColorObject color = Color::BLACK, const double stroke_width = 1.0) const;
@@ -0,0 +1,121 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_SHARDED_CACHE_H
+#define UTILS_SHARDED_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace cura
+{
+
+/*!
+ * \brief A map that many threads can look up entries in and add entries to at the same time.
+ *
+ * The entries are spread over a number of shards by the hash of their key, each behind its own lock, so that threads
+ * adding different entries rarely wait for each other. Looking up an entry only takes the lock of its shard for reading,
+ * so lookups never wait for each other, only for a thread adding an entry to the same shard.
+ *
+ * Entries are never changed once they are added, and only removed by erase, so references to their values stay valid until
+ * their entry is erased.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedCache
+{
+public:
+    ShardedCache()
+        : shards_(std::make_unique<Shard[]>(shard_count))
+    {
+    }
+
+    //! Moving a cache is only allowed while no other thread uses it.
+    ShardedCache(ShardedCache&&) = default;
+    ShardedCache& operator=(ShardedCache&&) = default;
+
+    /*!
+     * \brief Look up the value of a key.
+     * \return The value, or an empty optional if the key has no entry yet.
+     */
+    std::optional<std::reference_wrapper<const Value>> find(const Key& key) const
+    {
+        const Shard& shard = getShard(key);
+        std::shared_lock lock(shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it == shard.entries.end())
+        {
+            return std::nullopt;
+        }
+        return std::cref(it->second);
+    }
+
+    //! Whether the key has an entry.
+    bool contains(const Key& key) const
+    {
+        return find(key).has_value();
+    }
+
+    /*!
+     * \brief Add entries to the cache.
+     *
+     * If a key already has an entry, because another thread added it meanwhile, that entry is kept. Both are computed
+     * the same way, and the existing one may already be in use.
+     * \param entries The key-value pairs to add. Their values are moved into the cache.
+     */
+    template<typename Entries>
+    void insert(Entries entries)
+    {
+        for (auto& [key, value] : entries)
+        {
+            Shard& shard = getShard(key);
+            std::unique_lock lock(shard.mutex);
+            shard.entries.try_emplace(key, std::move(value));
+        }
+    }
+
+    /*!
+     * \brief Remove the entry of a key.
+     *
+     * Any references to the value of the entry become invalid, so this may only be used when no thread holds on to them.
+     * \return The value of the removed entry, or an empty optional if the key had no entry.
+     */
+    std::optional<Value> erase(const Key& key)
+    {
+        Shard& shard = getShard(key);
+        std::unique_lock lock(shard.mutex);
+        auto node = shard.entries.extract(key);
+        if (node.empty())
+        {
+            return std::nullopt;
+        }
+        return std::move(node.mapped());
+    }
+
+private:
+    static constexpr size_t shard_count = 32;
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> entries;
+    };
+
+    //! Picks the shard of a key. The hash is mixed first, since keys that differ little often have hashes that differ little.
+    Shard& getShard(const Key& key) const
+    {
+        const uint64_t mixed = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+        return shards_[(mixed >> 32) % shard_count];
+    }
+
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace cura
+
+#endif // UTILS_SHARDED_CACHE_H
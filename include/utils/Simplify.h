@@ -4,8 +4,12 @@
 #ifndef UTILS_SIMPLIFY_H
 #define UTILS_SIMPLIFY_H
 
+#include <algorithm> //To keep a heap of vertices in reusable memory.
+#include <vector>
+
 #include "../settings/Settings.h" //To load the parameters from a Settings object.
 #include "ExtrusionLine.h"
+#include "PackedExtrusionLine.h"
 #include "linearAlg2D.h" //To calculate line deviations and intersecting lines.
 #include "polygon.h"
 
@@ -77,6 +81,41 @@ public:
      */
     Simplify(const Settings& settings);
 
+    /*!
+     * Memory that the simplification reuses from one polygon to the next.
+     *
+     * Simplifying a batch of polygons allocates this once for all of them. To
+     * simplify many separate polygons or extrusion lines without allocating
+     * for each of them, pass the same scratch to each call. A scratch must
+     * only be used by one thread at a time.
+     */
+    class Scratch
+    {
+        friend class Simplify;
+
+        //! For each vertex, whether it is removed.
+        std::vector<bool> deleted_;
+
+        //! For each vertex that's left, the index of the vertex before it that's left.
+        std::vector<size_t> previous_;
+
+        //! For each vertex that's left, the index of the vertex after it that's left.
+        std::vector<size_t> next_;
+
+        //! The heap of vertices to consider removing, with their importance.
+        std::vector<std::pair<size_t, coord_t>> by_importance_;
+
+        /*!
+         * Prepare for a polygonal chain with \p size vertices.
+         */
+        void reset(const size_t size);
+
+        /*!
+         * Mark a vertex as removed, unlinking it from its neighbours.
+         */
+        void erase(const size_t vertex);
+    };
+
     /*!
      * Simplify a batch of polygons.
      * \param polygons The polygons to simplify.
@@ -91,6 +130,14 @@ public:
      */
     Polygon polygon(const Polygon& polygon) const;
 
+    /*!
+     * Simplify a polygon, reusing the memory of an earlier call.
+     * \param polygon The polygon to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polygon.
+     */
+    Polygon polygon(const Polygon& polygon, Scratch& scratch) const;
+
     /*!
      * Simplify a variable-line-width polygon.
      * \param polygon The polygon to simplify.
@@ -98,6 +145,24 @@ public:
      */
     ExtrusionLine polygon(const ExtrusionLine& polygon) const;
 
+    /*!
+     * Simplify a variable-line-width polygon, reusing the memory of an earlier
+     * call.
+     * \param polygon The polygon to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polygon.
+     */
+    ExtrusionLine polygon(const ExtrusionLine& polygon, Scratch& scratch) const;
+
+    /*!
+     * Simplify a variable-line-width polygon that is already packed, reusing
+     * the memory of an earlier call.
+     * \param polygon The polygon to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polygon.
+     */
+    PackedExtrusionLine polygon(const PackedExtrusionLine& polygon, Scratch& scratch) const;
+
     /*!
      * Simplify a batch of polylines.
      *
@@ -116,6 +181,16 @@ public:
      */
     Polygon polyline(const Polygon& polyline) const;
 
+    /*!
+     * Simplify a polyline, reusing the memory of an earlier call.
+     *
+     * The endpoints of the polyline cannot be altered.
+     * \param polyline The polyline to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polyline.
+     */
+    Polygon polyline(const Polygon& polyline, Scratch& scratch) const;
+
     /*!
      * Simplify a variable-line-width polyline.
      *
@@ -125,6 +200,28 @@ public:
      */
     ExtrusionLine polyline(const ExtrusionLine& polyline) const;
 
+    /*!
+     * Simplify a variable-line-width polyline, reusing the memory of an
+     * earlier call.
+     *
+     * The endpoints of the polyline cannot be altered.
+     * \param polyline The polyline to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polyline.
+     */
+    ExtrusionLine polyline(const ExtrusionLine& polyline, Scratch& scratch) const;
+
+    /*!
+     * Simplify a variable-line-width polyline that is already packed, reusing
+     * the memory of an earlier call.
+     *
+     * The endpoints of the polyline cannot be altered.
+     * \param polyline The polyline to simplify.
+     * \param scratch Memory to work in.
+     * \return The simplified polyline.
+     */
+    PackedExtrusionLine polyline(const PackedExtrusionLine& polyline, Scratch& scratch) const;
+
 protected:
     /*!
      * Line segments smaller than this should not occur in the output.
@@ -156,13 +253,18 @@ protected:
 
     /*!
      * The main simplification algorithm starts here.
+     *
+     * The vertices that are left are kept in a doubly linked list, so finding
+     * the neighbours of a vertex takes constant time however many vertices
+     * around it were removed.
      * \tparam Polygonal A polygonal object, which is a list of vertices.
      * \param polygon The polygonal chain to simplify.
      * \param is_closed Whether this is a closed polygon or an open polyline.
+     * \param scratch Memory to work in.
      * \return A simplified polygonal chain.
      */
     template<typename Polygonal>
-    Polygonal simplify(const Polygonal& polygon, const bool is_closed) const
+    Polygonal simplify(const Polygonal& polygon, const bool is_closed, Scratch& scratch) const
     {
         const size_t min_size = is_closed ? 3 : 2;
         if (detectSmall(polygon, min_size))
@@ -174,12 +276,13 @@ protected:
             return polygon;
         }
 
-        std::vector<bool> to_delete(polygon.size(), false);
+        scratch.reset(polygon.size());
+        // A heap in the same order as a std::priority_queue with this comparator, but in memory that is reused.
         auto comparator = [](const std::pair<size_t, coord_t>& vertex_a, const std::pair<size_t, coord_t>& vertex_b)
         {
             return vertex_a.second > vertex_b.second || (vertex_a.second == vertex_b.second && vertex_a.first > vertex_b.first);
         };
-        std::priority_queue<std::pair<size_t, coord_t>, std::vector<std::pair<size_t, coord_t>>, decltype(comparator)> by_importance(comparator);
+        std::vector<std::pair<size_t, coord_t>>& by_importance = scratch.by_importance_;
 
         Polygonal result = polygon; // Make a copy so that we can also shift vertices.
         for (int64_t current_removed = -1; (polygon.size() - current_removed) > min_size && current_removed != 0;)
@@ -189,32 +292,35 @@ protected:
             // Add the initial points.
             for (size_t i = 0; i < result.size(); ++i)
             {
-                if (to_delete[i])
+                if (scratch.deleted_[i])
                 {
                     continue;
                 }
-                const coord_t vertex_importance = importance(result, to_delete, i, is_closed);
-                by_importance.emplace(i, vertex_importance);
+                const coord_t vertex_importance = importance(result, scratch, i, is_closed);
+                by_importance.emplace_back(i, vertex_importance);
+                std::push_heap(by_importance.begin(), by_importance.end(), comparator);
             }
 
             // Iteratively remove the least important point until a threshold.
             coord_t vertex_importance = 0;
             while (! by_importance.empty() && (polygon.size() - current_removed) > min_size)
             {
-                std::pair<size_t, coord_t> vertex = by_importance.top();
-                by_importance.pop();
+                std::pop_heap(by_importance.begin(), by_importance.end(), comparator);
+                const std::pair<size_t, coord_t> vertex = by_importance.back();
+                by_importance.pop_back();
                 // The importance may have changed since this vertex was inserted. Re-compute it now.
                 // If it doesn't change, it's safe to process.
-                vertex_importance = importance(result, to_delete, vertex.first, is_closed);
+                vertex_importance = importance(result, scratch, vertex.first, is_closed);
                 if (vertex_importance != vertex.second)
                 {
-                    by_importance.emplace(vertex.first, vertex_importance); // Re-insert with updated importance.
+                    by_importance.emplace_back(vertex.first, vertex_importance); // Re-insert with updated importance.
+                    std::push_heap(by_importance.begin(), by_importance.end(), comparator);
                     continue;
                 }
 
                 if (vertex_importance <= max_deviation_ * max_deviation_)
                 {
-                    current_removed += remove(result, to_delete, vertex.first, vertex_importance, is_closed) ? 1 : 0;
+                    current_removed += remove(result, scratch, vertex.first, vertex_importance, is_closed) ? 1 : 0;
                 }
             }
         }
@@ -223,7 +329,7 @@ protected:
         Polygonal filtered = createEmpty(polygon);
         for (size_t i = 0; i < result.size(); ++i)
         {
-            if (! to_delete[i])
+            if (! scratch.deleted_[i])
             {
                 appendVertex(filtered, result[i]);
             }
@@ -240,7 +346,7 @@ protected:
      * A measure of the importance of a vertex.
      * \tparam Polygonal A polygonal object, which is a list of vertices.
      * \param polygon The polygon or polyline the vertex is part of.
-     * \param to_delete For each vertex, whether it is set to be deleted.
+     * \param scratch Which vertices are left, and their neighbours.
      * \param index The vertex index to compute the importance of.
      * \param is_closed Whether the polygon is closed (a polygon) or open
      * (a polyline).
@@ -248,7 +354,7 @@ protected:
      * that the vertex should probably be retained in the output.
      */
     template<typename Polygonal>
-    coord_t importance(const Polygonal& polygon, const std::vector<bool>& to_delete, const size_t index, const bool is_closed) const
+    coord_t importance(const Polygonal& polygon, const Scratch& scratch, const size_t index, const bool is_closed) const
     {
         const size_t poly_size = polygon.size();
         if (! is_closed && (index == 0 || index == poly_size - 1))
@@ -258,8 +364,8 @@ protected:
         // From here on out we can safely look at the vertex neighbors and assume it's a polygon. We won't go out of bounds of the polyline.
 
         const Point2LL& vertex = getPosition(polygon[index]);
-        const size_t before_index = previousNotDeleted(index, to_delete);
-        const size_t after_index = nextNotDeleted(index, to_delete);
+        const size_t before_index = scratch.previous_[index];
+        const size_t after_index = scratch.next_[index];
 
         const coord_t area_deviation = getAreaDeviation(polygon[before_index], polygon[index], polygon[after_index]);
         if (area_deviation > max_area_deviation_) // Removing this line causes the variable line width to get flattened out too much.
@@ -289,8 +395,8 @@ protected:
      * to delete an edge, fusing two vertices together.
      * \tparam Polygonal A polygonal object, which is a list of vertices.
      * \param polygon The polygon to remove a vertex from.
-     * \param to_delete The vertices that have been marked for deletion so far.
-     * This will be edited in-place.
+     * \param scratch Which vertices are left, and their neighbours. This will be
+     * edited in-place.
      * \param vertex The index of the vertex to remove.
      * \param deviation2 The previously found deviation for this vertex.
      * \param is_closed Whether we're working on a closed polygon or an open
@@ -298,18 +404,18 @@ protected:
      * polyline.
      */
     template<typename Polygonal>
-    bool remove(Polygonal& polygon, std::vector<bool>& to_delete, const size_t vertex, const coord_t deviation2, const bool is_closed) const
+    bool remove(Polygonal& polygon, Scratch& scratch, const size_t vertex, const coord_t deviation2, const bool is_closed) const
     {
         if (deviation2 <= min_resolution * min_resolution)
         {
             // At less than the minimum resolution we're always allowed to delete the vertex.
             // Even if the adjacent line segments are very long.
-            to_delete[vertex] = true;
+            scratch.erase(vertex);
             return true;
         }
 
-        const size_t before = previousNotDeleted(vertex, to_delete);
-        const size_t after = nextNotDeleted(vertex, to_delete);
+        const size_t before = scratch.previous_[vertex];
+        const size_t after = scratch.next_[vertex];
         const Point2LL& vertex_position = getPosition(polygon[vertex]);
         const Point2LL& before_position = getPosition(polygon[before]);
         const Point2LL& after_position = getPosition(polygon[after]);
@@ -319,7 +425,7 @@ protected:
         if (length2_before <= max_resolution_ * max_resolution_ && length2_after <= max_resolution_ * max_resolution_) // Both adjacent line segments are short.
         {
             // Removing this vertex does little harm. No long lines will be shifted.
-            to_delete[vertex] = true;
+            scratch.erase(vertex);
             return true;
         }
 
@@ -333,7 +439,7 @@ protected:
             {
                 return false; // Edge cannot be deleted without shifting a long edge. Don't remove anything.
             }
-            const size_t before_before = previousNotDeleted(before, to_delete);
+            const size_t before_before = scratch.previous_[before];
             before_from = getPosition(polygon[before_before]);
             before_to = getPosition(polygon[before]);
             after_from = getPosition(polygon[vertex]);
@@ -345,7 +451,7 @@ protected:
             {
                 return false; // Edge cannot be deleted without shifting a long edge. Don't remove anything.
             }
-            const size_t after_after = nextNotDeleted(after, to_delete);
+            const size_t after_after = scratch.next_[after];
             before_from = getPosition(polygon[before]);
             before_to = getPosition(polygon[vertex]);
             after_from = getPosition(polygon[after]);
@@ -360,39 +466,13 @@ protected:
         const coord_t intersection_deviation = LinearAlg2D::getDist2FromLineSegment(before_to, intersection, after_from);
         if (intersection_deviation <= max_deviation_ * max_deviation_) // Intersection point doesn't deviate too much. Use it!
         {
-            to_delete[vertex] = true;
+            scratch.erase(vertex);
             polygon[length2_before <= length2_after ? before : after] = createIntersection(polygon[before], intersection, polygon[after]);
             return true;
         }
         return false;
     }
 
-    /*!
-     * Helper method to find the index of the next vertex that is not about to
-     * get deleted.
-     *
-     * This method assumes that the polygon is looping. If it is a polyline, the
-     * endpoints of the polyline may never be deleted so it should never be an
-     * issue.
-     * \param index The index of the current vertex.
-     * \param to_delete For each vertex, whether it is to be deleted.
-     * \return The index of the vertex afterwards.
-     */
-    size_t nextNotDeleted(size_t index, const std::vector<bool>& to_delete) const;
-
-    /*!
-     * Helper method to find the index of the previous vertex that is not about
-     * to get deleted.
-     *
-     * This method assumes that the polygon is looping. If it is a polyline, the
-     * endpoints of the polyline may never be deleted so it should never be an
-     * issue.
-     * \param index The index of the current vertex.
-     * \param to_delete For each vertex, whether it is to be deleted.
-     * \return The index of the vertex before it.
-     */
-    size_t previousNotDeleted(size_t index, const std::vector<bool>& to_delete) const;
-
     /*!
      * Create an empty polygon with the same properties as an original polygon,
      * but without the vertex data.
@@ -409,6 +489,14 @@ protected:
      */
     ExtrusionLine createEmpty(const ExtrusionLine& original) const;
 
+    /*!
+     * Create an empty packed extrusion line with the same properties as an
+     * original one, but without the vertex data.
+     * \param original The packed extrusion line to copy the properties from.
+     * \return An empty packed extrusion line.
+     */
+    PackedExtrusionLine createEmpty(const PackedExtrusionLine& original) const;
+
     /*!
      * Append a vertex to this polygon.
      *
@@ -427,6 +515,15 @@ protected:
      */
     void appendVertex(ExtrusionLine& extrusion_line, const ExtrusionJunction& vertex) const;
 
+    /*!
+     * Append a vertex to this packed extrusion line.
+     *
+     * This function overloads to allow adding to all supported polygonal types.
+     * \param extrusion_line The packed extrusion line to add to.
+     * \param vertex The vertex to add.
+     */
+    void appendVertex(PackedExtrusionLine& extrusion_line, const PackedExtrusionLine::ConstJunctionReference vertex) const;
+
     /*!
      * Get the coordinates of a vertex.
      *
@@ -446,6 +543,17 @@ protected:
      */
     const Point2LL& getPosition(const ExtrusionJunction& vertex) const;
 
+    /*!
+     * Get the coordinates of a vertex.
+     *
+     * This overload is for the vertices of a PackedExtrusionLine. The
+     * coordinates are those in the line itself, so they remain valid as long
+     * as the line is not resized.
+     * \param vertex A vertex to get the coordinates of.
+     * \return The coordinates of that vertex.
+     */
+    const Point2LL& getPosition(const PackedExtrusionLine::ConstJunctionReference vertex) const;
+
     /*!
      * Create an intersection vertex that can be placed in a polygon.
      * \param before One of the vertices of a removed edge. Unused in this
@@ -466,6 +574,18 @@ protected:
      */
     ExtrusionJunction createIntersection(const ExtrusionJunction& before, const Point2LL intersection, const ExtrusionJunction& after) const;
 
+    /*!
+     * Create an intersection vertex that can be placed in a
+     * PackedExtrusionLine. It gets the same width as in an ExtrusionLine.
+     * \param before One of the vertices of the edge that gets replaced by an
+     * intersection vertex.
+     * \param intersection The position of the new intersection vertex.
+     * \param after One of the vertices of the edge that gets replaced by an
+     * intersection vertex.
+     */
+    ExtrusionJunction
+        createIntersection(const PackedExtrusionLine::ConstJunctionReference before, const Point2LL intersection, const PackedExtrusionLine::ConstJunctionReference after) const;
+
     /*!
      * Get the extrusion area deviation that would be caused by removing this
      * vertex.
@@ -488,6 +608,19 @@ protected:
      * \return The area deviation that would be caused by removing the vertex.
      */
     coord_t getAreaDeviation(const ExtrusionJunction& before, const ExtrusionJunction& vertex, const ExtrusionJunction& after) const;
+
+    /*!
+     * Get the extrusion area deviation that would be caused by removing this
+     * vertex of a packed line. This is the same as for an ExtrusionLine.
+     * \param before The vertex before the one that is to be removed.
+     * \param vertex The vertex that is to be removed.
+     * \param after The vertex after the one that is to be removed.
+     * \return The area deviation that would be caused by removing the vertex.
+     */
+    coord_t getAreaDeviation(
+        const PackedExtrusionLine::ConstJunctionReference before,
+        const PackedExtrusionLine::ConstJunctionReference vertex,
+        const PackedExtrusionLine::ConstJunctionReference after) const;
 };
 
 } // namespace cura
@@ -0,0 +1,271 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_SMALL_VECTOR_H
+#define UTILS_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace cura
+{
+
+/*!
+ * \brief A vector that keeps its first few elements inside of itself, and only goes to the heap when it grows past
+ * them.
+ *
+ * For the many short sequences that are made and dropped in hot loops, such as the travel paths that combing finds,
+ * this saves the allocation that a std::vector needs for even a single element. Past the inline capacity it behaves
+ * like a std::vector, growing by doubling.
+ *
+ * Only for elements that can be copied as bytes, which keeps moving between the inline and the heap storage simple.
+ *
+ * \tparam T The type of the elements.
+ * \tparam N How many elements fit inside the vector itself.
+ */
+template<typename T, size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "The elements of a SmallVector are copied as bytes.");
+    static_assert(N > 0, "A SmallVector without inline capacity is a std::vector.");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> elements)
+    {
+        reserve(elements.size());
+        std::uninitialized_copy(elements.begin(), elements.end(), data());
+        size_ = elements.size();
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        reserve(other.size_);
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept
+    {
+        takeFrom(other);
+    }
+
+    ~SmallVector()
+    {
+        freeHeap();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            size_ = 0;
+            reserve(other.size_);
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            freeHeap();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    //! Whether the elements are kept inside of the vector itself.
+    bool isInline() const
+    {
+        return heap_ == nullptr;
+    }
+
+    T* data()
+    {
+        return isInline() ? inlineData() : heap_;
+    }
+
+    const T* data() const
+    {
+        return isInline() ? inlineData() : heap_;
+    }
+
+    iterator begin()
+    {
+        return data();
+    }
+
+    iterator end()
+    {
+        return data() + size_;
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    const_iterator end() const
+    {
+        return data() + size_;
+    }
+
+    T& operator[](const size_t index)
+    {
+        assert(index < size_);
+        return data()[index];
+    }
+
+    const T& operator[](const size_t index) const
+    {
+        assert(index < size_);
+        return data()[index];
+    }
+
+    T& front()
+    {
+        return (*this)[0];
+    }
+
+    const T& front() const
+    {
+        return (*this)[0];
+    }
+
+    T& back()
+    {
+        return (*this)[size_ - 1];
+    }
+
+    const T& back() const
+    {
+        return (*this)[size_ - 1];
+    }
+
+    void push_back(const T& element)
+    {
+        const T copy = element; // The element may be in this vector, which moves when it grows.
+        if (size_ == capacity_)
+        {
+            reserve(capacity_ * 2);
+        }
+        std::construct_at(data() + size_, copy);
+        size_++;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        push_back(T(std::forward<Args>(args)...));
+        return back();
+    }
+
+    void pop_back()
+    {
+        assert(size_ > 0);
+        size_--;
+    }
+
+    //! Removes the elements, but keeps the memory for the next ones.
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    void reserve(const size_t new_capacity)
+    {
+        if (new_capacity <= capacity_)
+        {
+            return;
+        }
+        T* new_heap = std::allocator<T>().allocate(new_capacity);
+        std::uninitialized_copy(begin(), end(), new_heap);
+        freeHeap();
+        heap_ = new_heap;
+        capacity_ = new_capacity;
+    }
+
+    bool operator==(const SmallVector& other) const
+    {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    alignas(T) std::byte inline_storage_[N * sizeof(T)];
+    T* heap_ = nullptr; //!< The elements, once they no longer fit inline.
+    size_t size_ = 0;
+    size_t capacity_ = N;
+
+    T* inlineData()
+    {
+        return std::launder(reinterpret_cast<T*>(inline_storage_));
+    }
+
+    const T* inlineData() const
+    {
+        return std::launder(reinterpret_cast<const T*>(inline_storage_));
+    }
+
+    void freeHeap()
+    {
+        if (heap_ != nullptr)
+        {
+            std::allocator<T>().deallocate(heap_, capacity_);
+            heap_ = nullptr;
+            capacity_ = N;
+        }
+    }
+
+    //! Take over the elements of \p other, which this must not hold memory of its own for, and leave it empty.
+    void takeFrom(SmallVector& other)
+    {
+        if (other.isInline())
+        {
+            std::uninitialized_copy(other.begin(), other.end(), inlineData());
+        }
+        else
+        {
+            heap_ = std::exchange(other.heap_, nullptr);
+            capacity_ = std::exchange(other.capacity_, N);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+};
+
+} // namespace cura
+
+#endif // UTILS_SMALL_VECTOR_H
@@ -7,9 +7,9 @@
 
 #include <cassert>
 #include <functional>
-#include <unordered_map>
 #include <vector>
 
+#include "FlatGridMap.h"
 #include "Point2LL.h"
 #include "SquareGrid.h"
 
@@ -31,7 +31,7 @@ public:
 
     using GridPoint = SquareGrid::GridPoint;
     using grid_coord_t = SquareGrid::grid_coord_t;
-    using GridMap = std::unordered_multimap<GridPoint, Elem>;
+    using GridMap = FlatGridMap<Elem>;
 
     using iterator = typename GridMap::iterator;
     using const_iterator = typename GridMap::const_iterator;
@@ -42,6 +42,7 @@ public:
      *    Typical values would be around 0.5-2x of expected query radius.
      * \param[in] elem_reserve Number of elements to research space for.
      * \param[in] max_load_factor Maximum average load factor before rehashing.
+     *    The map of cells limits this to what works with open addressing.
      */
     SparseGrid(coord_t cell_size, size_t elem_reserve = 0U, double max_load_factor = 1.0);
 
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_SPSC_QUEUE_H
+#define UTILS_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "NoCopy.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A lock-free queue of fixed capacity between one producer thread and one consumer thread.
+ *
+ * The producer waits while the queue is full, and the consumer waits while it is empty. Neither takes a lock: they
+ * only wait on the positions of each other in the ring of items.
+ *
+ * The consumer looks at the oldest item with \ref front and releases it with \ref pop once it is done with it, so that
+ * the producer can tell with \ref waitUntilEmpty when everything it pushed has been dealt with.
+ *
+ * \tparam T The type of the items.
+ * \tparam capacity How many items may wait at once.
+ */
+template<typename T, size_t capacity>
+class SpscQueue : public NoCopy
+{
+public:
+    /*!
+     * \brief Add an item at the end, waiting while the queue is full.
+     *
+     * Only the producer thread may call this.
+     */
+    void push(const T& item)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        while (head - tail == capacity)
+        {
+            tail_.wait(tail, std::memory_order_acquire);
+            tail = tail_.load(std::memory_order_acquire);
+        }
+        items_[head % capacity] = item;
+        head_.store(head + 1, std::memory_order_release);
+        head_.notify_one();
+    }
+
+    /*!
+     * \brief Wait until the consumer has popped every item that was pushed.
+     *
+     * Only the producer thread may call this. Afterwards, it sees everything that the consumer did before popping.
+     */
+    void waitUntilEmpty() const
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        while (tail != head)
+        {
+            tail_.wait(tail, std::memory_order_acquire);
+            tail = tail_.load(std::memory_order_acquire);
+        }
+    }
+
+    /*!
+     * \brief Get the oldest item, waiting while the queue is empty.
+     *
+     * Only the consumer thread may call this. The item stays in the queue until \ref pop.
+     */
+    T& front()
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        while (head == tail)
+        {
+            head_.wait(head, std::memory_order_acquire);
+            head = head_.load(std::memory_order_acquire);
+        }
+        return items_[tail % capacity];
+    }
+
+    /*!
+     * \brief Remove the oldest item, once the consumer is done with it.
+     *
+     * Only the consumer thread may call this, after \ref front.
+     */
+    void pop()
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        tail_.notify_one();
+    }
+
+private:
+    std::array<T, capacity> items_; //!< The ring of items.
+    alignas(64) std::atomic<size_t> head_{ 0 }; //!< How many items were pushed. Only written by the producer.
+    alignas(64) std::atomic<size_t> tail_{ 0 }; //!< How many items were popped. Only written by the consumer.
+};
+
+} // namespace cura
+
+#endif // UTILS_SPSC_QUEUE_H
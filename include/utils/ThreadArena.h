@@ -0,0 +1,131 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_THREAD_ARENA_H
+#define UTILS_THREAD_ARENA_H
+
+#include <cstddef>
+#include <list>
+#include <memory_resource>
+#include <vector>
+
+#include "NoCopy.h"
+#include "progress/Progress.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A memory resource that hands out memory by bumping a pointer through large blocks, and frees nothing until
+ * it is reset.
+ *
+ * Resetting keeps the blocks for the next use, up to a limit, so that a thread processing one layer after the other
+ * doesn't need to go back to the system allocator for its temporaries.
+ */
+class Arena : public std::pmr::memory_resource, NoCopy
+{
+public:
+    /*!
+     * \param block_size The size of the blocks to allocate from the system. Larger allocations get a block of their
+     * own.
+     * \param retained_size How much memory to keep for the next use when resetting.
+     */
+    explicit Arena(size_t block_size = 1 << 20, size_t retained_size = 64 << 20);
+
+    ~Arena() override;
+
+    /*!
+     * \brief Release everything that was allocated at once, invalidating all of it.
+     */
+    void reset();
+
+    //! The number of bytes of the blocks that this arena holds.
+    size_t capacity() const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    struct Block
+    {
+        std::byte* data;
+        size_t size;
+    };
+
+    size_t block_size_;
+    size_t retained_size_;
+    std::vector<Block> blocks_;
+    size_t current_block_ = 0; //!< The block that allocations are taken from.
+    size_t used_ = 0; //!< How much of the current block is taken.
+};
+
+/*!
+ * \brief The arena of each thread, for the temporaries of the task that the thread is running.
+ *
+ * A task opens a `Scope` while it runs. Containers that are created within it through `resource()` allocate from the
+ * thread's arena, which is reset when the outermost scope of the thread closes. `parallel_for` opens a scope for every
+ * item, so the temporaries of one layer task are released together when it completes.
+ *
+ * Only data that doesn't outlive the scope it was created in may come from the arena. Outside of any scope, and when
+ * built without ENABLE_THREAD_ARENA, `resource()` is the default resource.
+ *
+ * Whether the tasks use the arenas is a policy of each stage of the slice, since the stages allocate so differently.
+ * By default every stage uses them. The environment variable CURA_ENGINE_ARENA_STAGES limits them to the stages it
+ * lists by name, separated by commas, such as "slice,inset+skin", or to none with "none".
+ */
+class ThreadArena
+{
+public:
+    //! Where the temporaries of the tasks of a stage are taken from.
+    enum class Policy
+    {
+        SYSTEM, //!< The default resource, which frees each temporary on its own.
+        TASK_ARENA //!< The arena of the thread, which is released at once when the task completes.
+    };
+
+    /*!
+     * \brief Marks the lifetime of a task's temporaries on the calling thread.
+     */
+    class Scope : NoCopy
+    {
+    public:
+        Scope();
+        ~Scope();
+    };
+
+    /*!
+     * \brief The memory resource for temporaries created on the calling thread.
+     */
+    static std::pmr::memory_resource* resource();
+
+    /*!
+     * \brief Apply the policy of a stage to the temporaries created from now on. Called when the slice enters it.
+     */
+    static void setStage(Progress::Stage stage);
+
+    /*!
+     * \brief Get where the temporaries of the tasks of a stage are taken from.
+     */
+    static Policy getPolicy(Progress::Stage stage);
+
+    /*!
+     * \brief Replace the policy of a stage from the environment variable.
+     */
+    static void setPolicy(Progress::Stage stage, Policy policy);
+};
+
+#ifdef ENABLE_THREAD_ARENA
+template<typename T>
+using arena_list = std::pmr::list<T>; //!< A list whose nodes are taken from the thread arena when created with ThreadArena::resource().
+#else
+template<typename T>
+using arena_list = std::list<T>;
+#endif
+
+} // namespace cura
+
+#endif // UTILS_THREAD_ARENA_H
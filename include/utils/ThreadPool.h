@@ -4,15 +4,30 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <exception> // std::exception_ptr
 #include <functional> // std::function<>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <source_location>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "../Application.h" // accessing singleton's Application::thread_pool
+#include "../utils/Cancellation.h"
+#include "../utils/MemoryBudget.h"
+#include "../utils/ThreadArena.h"
+#include "../utils/ThreadPoolStatistics.h"
+#include "../utils/Trace.h"
 #include "../utils/math.h" // round_up_divide
 
 namespace cura
@@ -24,6 +39,10 @@ namespace cura
  * Consider using `parallel_for()` instead, interfacing directly with this class should be reserved to concurrency primitives.
  * ThreadPool can be described as a synchronized FIFO queue shared by a fleet of `std::thread`s.
  * Tasks have the responsibility of unlocking the queue's lock passed as an argument while they do asynchronous work.
+ *
+ * When the threads are pinned to CPUs on a machine with multiple NUMA nodes, the queue is split per node. Threads take
+ * the tasks of their own node first, so that the memory a task first touches is local to the threads that later use it,
+ * and only take the tasks of other nodes when their own node has none.
  */
 class ThreadPool
 {
@@ -31,8 +50,13 @@ public:
     using lock_t = std::unique_lock<std::mutex>;
     using task_t = std::function<void(lock_t&)>;
 
-    //! Spawns a thread pool with `nthreads` threads
-    ThreadPool(size_t nthreads);
+    /*!
+     * \brief Spawns a thread pool with `nthreads` threads.
+     * \param pin_threads Whether to pin every thread, including the calling one, to a CPU of its own. The CPUs are
+     * assigned one NUMA node after the other, starting with the calling thread. Pinning is only supported on Linux.
+     * \param collect_statistics Whether to measure how long tasks wait and run, see statistics().
+     */
+    ThreadPool(size_t nthreads, bool pin_threads = false, bool collect_statistics = false);
 
     ~ThreadPool()
     {
@@ -45,6 +69,48 @@ public:
         return threads.size();
     }
 
+    //! Returns the number of NUMA nodes that the tasks are split over, 1 unless the threads are pinned
+    size_t node_count() const
+    {
+        return tasks.size();
+    }
+
+    //! Returns whether the threads are pinned to CPUs
+    bool pinned() const
+    {
+        return pinned_;
+    }
+
+    //! Returns the NUMA node that the calling thread is pinned to, or 0 if it isn't pinned by a thread pool
+    static size_t current_node();
+
+    //! Returns the statistics that are being collected, or nullptr if they aren't. Only use them while the queue is locked.
+    ThreadPoolStatistics* statistics()
+    {
+        return statistics_.get();
+    }
+
+    //! Logs the statistics that were collected since the last report, if they are being collected, and resets them.
+    void reportStatistics()
+    {
+        if (statistics_)
+        {
+            lock_t lock = get_lock();
+            statistics_->report();
+            statistics_->reset();
+        }
+    }
+
+    //! Forgets the statistics that were collected so far, if they are being collected.
+    void resetStatistics()
+    {
+        if (statistics_)
+        {
+            lock_t lock = get_lock();
+            statistics_->reset();
+        }
+    }
+
     //! Gets a lock on the queue, stopping the queuing or execution of new tasks while held
     lock_t get_lock()
     {
@@ -55,13 +121,19 @@ public:
      * \brief Pushes a new task while the queue is locked.
      * \param func Closure that unlocks the local worker's lock passed as an argument while
      * doing asynchronous work.
+     * \param node The NUMA node whose threads should preferably execute the task. Defaults to the calling thread's.
      */
     template<typename F>
-    void push(const lock_t& lock [[maybe_unused]], F&& func)
+    void push(const lock_t& lock [[maybe_unused]], F&& func, const std::optional<size_t> node = std::nullopt)
     {
         assert(lock);
-        tasks.push_back(std::forward<F>(func));
+        tasks[node.value_or(current_node()) % tasks.size()].push_back(
+            QueuedTask{ std::forward<F>(func), statistics_ ? ThreadPoolStatistics::clock_t::now() : ThreadPoolStatistics::clock_t::time_point{} });
         condition.notify_one();
+        if (waiting_helpers > 0)
+        {
+            helper_condition.notify_one();
+        }
     }
     /*!
      * \brief Executes pending tasks while the predicates returns true
@@ -71,27 +143,124 @@ public:
     void work_while(lock_t& lock, P predicate)
     {
         assert(lock);
-        while (predicate() && ! tasks.empty()) // Order is important: predicate() might wait on an empty queue
+        QueuedTask task;
+        while (predicate() && pop_task(task)) // Order is important: predicate() might wait on an empty queue
         {
-            assert(! tasks.empty());
-            task_t task = std::move(tasks.front());
-            tasks.pop_front();
+            run_task(lock, task);
+        }
+    }
 
-            task(lock);
-            assert(lock);
+    /*!
+     * \brief Executes pending tasks while the predicate returns true, and waits for new tasks when there are none.
+     *
+     * This is how a thread waits for the tasks that it pushed itself: rather than blocking, it helps with whatever is
+     * queued, including tasks that are pushed while it waits. Since a waiting thread never holds back any queued task,
+     * nesting such waits can't deadlock.
+     *
+     * Whoever makes the predicate false must call notify_helpers() afterwards.
+     */
+    template<typename P>
+    void help_while(lock_t& lock, P predicate)
+    {
+        assert(lock);
+        QueuedTask task;
+        while (predicate())
+        {
+            if (pop_task(task))
+            {
+                run_task(lock, task);
+                continue;
+            }
+            waiting_helpers++;
+            const auto idle_start = statistics_ ? ThreadPoolStatistics::clock_t::now() : ThreadPoolStatistics::clock_t::time_point{};
+            helper_condition.wait(lock); // Signaled by ThreadPool::push() and ThreadPool::notify_helpers()
+            if (statistics_)
+            {
+                statistics_->addIdle(current_thread_index(), ThreadPoolStatistics::clock_t::now() - idle_start);
+            }
+            waiting_helpers--;
+        }
+    }
+
+    //! Wakes up the threads in help_while() to check their predicates again. The queue must be locked.
+    void notify_helpers(const lock_t& lock [[maybe_unused]])
+    {
+        assert(lock);
+        if (waiting_helpers > 0)
+        {
+            helper_condition.notify_all();
         }
     }
 
 private:
-    void worker();
+    //! A task with the time that it was pushed, if statistics are collected.
+    struct QueuedTask
+    {
+        task_t task;
+        ThreadPoolStatistics::clock_t::time_point queued_at;
+    };
+
+    void worker(std::optional<int> cpu, size_t node, size_t thread_idx);
 
     void join();
 
+    //! Returns the index of the calling thread among the threads of a thread pool, counting from 1, or 0 if it isn't one.
+    static size_t current_thread_index();
+
+    //! Runs a task that was taken from the queue, measuring it if statistics are collected.
+    void run_task(lock_t& lock, QueuedTask& task)
+    {
+        if (! statistics_)
+        {
+            task.task(lock);
+            assert(lock);
+            return;
+        }
+        const auto start = ThreadPoolStatistics::clock_t::now();
+        task.task(lock);
+        assert(lock);
+        statistics_->addTask(start - task.queued_at, ThreadPoolStatistics::clock_t::now() - start);
+    }
+
+    //! Whether any node has a queued task. The queue must be locked.
+    bool has_tasks() const
+    {
+        for (const std::deque<QueuedTask>& node_tasks : tasks)
+        {
+            if (! node_tasks.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Takes the next task, from the calling thread's node if it has any. The queue must be locked.
+    bool pop_task(QueuedTask& task)
+    {
+        const size_t own_node = current_node();
+        for (size_t offset = 0; offset < tasks.size(); offset++)
+        {
+            std::deque<QueuedTask>& node_tasks = tasks[(own_node + offset) % tasks.size()];
+            if (! node_tasks.empty())
+            {
+                task = std::move(node_tasks.front());
+                node_tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::mutex mutex;
     std::condition_variable condition;
-    std::deque<task_t> tasks;
+    std::condition_variable helper_condition; //!< For threads in help_while() that wait for new tasks or for their predicate.
+    size_t waiting_helpers = 0;
+    std::vector<std::deque<QueuedTask>> tasks; //!< The queued tasks of each NUMA node.
     std::vector<std::thread> threads;
     bool wait_for_new_tasks;
+    bool pinned_ = false;
+    std::unique_ptr<ThreadPoolStatistics> statistics_; //!< Guarded by the lock. Null unless statistics are collected.
 };
 
 
@@ -107,6 +276,276 @@ inline Signed distance(const Int& first, const Int& last)
 }
 
 
+namespace details
+{
+
+/*!
+ * \brief The chunks of a parallel_for that one of its participants still has to run.
+ *
+ * The owner takes chunks from the front, and participants that ran out of chunks steal from the back. Both ends are
+ * packed in one atomic, so that taking and stealing are a single compare-and-swap without any lock.
+ */
+class ChunkRange
+{
+public:
+    //! Sets the chunks of an owner that has none left. Other participants may only be trying to steal at this point.
+    void reset(const uint32_t first, const uint32_t last)
+    {
+        range_.store(pack(first, last), std::memory_order_release);
+    }
+
+    /*!
+     * \brief Takes chunks from the front into [first, last). Only called by the owner.
+     * \param take Given the chunks that are left, returns how many of them to take, at least 1.
+     */
+    template<typename Take>
+    bool pop_front(uint32_t& first, uint32_t& last, Take&& take)
+    {
+        uint64_t range = range_.load(std::memory_order_acquire);
+        while (true)
+        {
+            const uint32_t range_first = range >> 32;
+            const uint32_t range_last = range & 0xFFFFFFFF;
+            if (range_first >= range_last)
+            {
+                return false;
+            }
+            const uint32_t taken_last = range_first + take(range_first, range_last);
+            assert(taken_last > range_first && taken_last <= range_last);
+            if (range_.compare_exchange_weak(range, pack(taken_last, range_last), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                first = range_first;
+                last = taken_last;
+                return true;
+            }
+        }
+    }
+
+    /*!
+     * \brief Takes chunks from the back into [first, last).
+     * \param split Given the chunks that are left, returns the first of them to steal.
+     */
+    template<typename Split>
+    bool steal(uint32_t& first, uint32_t& last, Split&& split)
+    {
+        uint64_t range = range_.load(std::memory_order_acquire);
+        while (true)
+        {
+            const uint32_t victim_first = range >> 32;
+            const uint32_t victim_last = range & 0xFFFFFFFF;
+            if (victim_first >= victim_last)
+            {
+                return false;
+            }
+            const uint32_t middle = split(victim_first, victim_last);
+            assert(middle >= victim_first && middle < victim_last);
+            if (range_.compare_exchange_weak(range, pack(victim_first, middle), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                first = middle;
+                last = victim_last;
+                return true;
+            }
+        }
+    }
+
+private:
+    static uint64_t pack(const uint32_t first, const uint32_t last)
+    {
+        return (static_cast<uint64_t>(first) << 32) | last;
+    }
+
+    alignas(64) std::atomic<uint64_t> range_{ 0 }; // Aligned to a cache line, so that the participants don't slow each other down.
+};
+
+/*!
+ * \brief Runs the chunks of a parallel loop on the thread pool, see parallel_for().
+ *
+ * \param chunk_size The number of items per chunk.
+ * \param chunks The number of chunks.
+ * \param participants The number of threads to run the chunks on.
+ * \param partition Given a participant, returns its first chunk. Must be 0 for participant 0, `chunks` for
+ * `participants`, and not decrease in between.
+ * \param take See ChunkRange::pop_front().
+ * \param split See ChunkRange::steal().
+ */
+template<typename T, typename F, typename Partition, typename Take, typename Split>
+void run_chunks_in_parallel(
+    T first,
+    T last,
+    F&& loop_body,
+    const size_t chunk_size,
+    const size_t chunks,
+    const size_t participants,
+    Partition&& partition,
+    Take&& take,
+    Split&& split,
+    const std::source_location& site)
+{
+    using lock_t = ThreadPool::lock_t;
+    using difference_t = decltype(distance(first, last));
+
+    ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
+    assert(chunks <= std::numeric_limits<uint32_t>::max());
+    CURA_TRACE_SCOPE_AT("parallel_for", site);
+
+    ThreadPoolStatistics* const statistics = thread_pool->statistics();
+    const auto loop_start = statistics ? ThreadPoolStatistics::clock_t::now() : ThreadPoolStatistics::clock_t::time_point{};
+
+    // Packs state variables such that they can be referenced by the task closure through a single reference
+    struct
+    {
+        std::decay_t<F> loop_body; // User's closure data
+        size_t participants_remaining; // Guarded by the thread pool's lock.
+        std::unique_ptr<ChunkRange[]> ranges;
+        std::atomic<bool> stopped; // Whether the participants should stop taking chunks.
+        std::exception_ptr exception; // The first exception that the loop body threw. Guarded by the thread pool's lock.
+        std::vector<ThreadPoolStatistics::duration_t> busy_times; // How long each participant ran, if statistics are collected.
+    } shared_state = { std::forward<F>(loop_body),
+                       participants,
+                       std::make_unique<ChunkRange[]>(participants),
+                       false,
+                       nullptr,
+                       std::vector<ThreadPoolStatistics::duration_t>(statistics ? participants : 0) };
+    for (size_t participant = 0; participant < participants; participant++)
+    {
+        shared_state.ranges[participant].reset(static_cast<uint32_t>(partition(participant)), static_cast<uint32_t>(partition(participant + 1)));
+    }
+
+    // Runs chunks until there are none left to take or steal. Returns the exception that the loop body threw, if any.
+    const auto run_chunks = [&shared_state, &take, &split, &site, first, last, chunk_size, participants](const size_t participant) -> std::exception_ptr
+    {
+        const auto should_stop = [&shared_state]()
+        {
+            if (Cancellation::isRequested())
+            {
+                shared_state.stopped.store(true, std::memory_order_relaxed);
+            }
+            return shared_state.stopped.load(std::memory_order_relaxed);
+        };
+
+        ChunkRange& own_range = shared_state.ranges[participant];
+        while (true)
+        {
+            uint32_t taken_first;
+            uint32_t taken_last;
+            while (! should_stop() && own_range.pop_front(taken_first, taken_last, take))
+            {
+                const T items_first = first + static_cast<difference_t>(taken_first * chunk_size);
+                const difference_t items_count = static_cast<difference_t>((taken_last - taken_first) * chunk_size);
+                const T items_last = distance(items_first, last) > items_count ? items_first + items_count : last;
+                CURA_TRACE_SCOPE_AT("parallel_for chunk", site);
+                try
+                {
+                    for (T i = items_first; i < items_last; ++i)
+                    {
+                        ThreadArena::Scope arena_scope; // Releases the temporaries of this item at once.
+                        shared_state.loop_body(i);
+                    }
+                }
+                catch (...)
+                {
+                    shared_state.stopped.store(true, std::memory_order_relaxed);
+                    return std::current_exception();
+                }
+            }
+            if (shared_state.stopped.load(std::memory_order_relaxed))
+            {
+                return nullptr; // The chunks that are left are abandoned.
+            }
+
+            // Out of chunks: steal from the others, starting with the next one so that thieves spread out.
+            bool stole = false;
+            for (size_t offset = 1; offset < participants && ! stole; offset++)
+            {
+                uint32_t stolen_first;
+                uint32_t stolen_last;
+                if (shared_state.ranges[(participant + offset) % participants].steal(stolen_first, stolen_last, split))
+                {
+                    own_range.reset(stolen_first, stolen_last);
+                    stole = true;
+                }
+            }
+            if (! stole)
+            {
+                return nullptr; // Any chunks that are left are being run by their owners.
+            }
+        }
+    };
+    const auto participate = [&shared_state, &run_chunks](const size_t participant) -> std::exception_ptr
+    {
+        if (shared_state.busy_times.empty())
+        {
+            return run_chunks(participant);
+        }
+        const auto start = ThreadPoolStatistics::clock_t::now();
+        std::exception_ptr exception = run_chunks(participant);
+        shared_state.busy_times[participant] = ThreadPoolStatistics::clock_t::now() - start;
+        return exception;
+    };
+
+    // Schedules the other participants on the thread pool. The participants are spread over the NUMA nodes in order,
+    // starting with the caller's, so that a loop over the same range gets the same items to the same nodes every time.
+    const size_t first_node = ThreadPool::current_node();
+    lock_t lock = thread_pool->get_lock();
+    for (size_t participant = 1; participant < participants; participant++)
+    {
+        thread_pool->push(
+            lock,
+            [&shared_state, &participate, participant, thread_pool](lock_t& th_lock)
+            {
+                th_lock.unlock(); // Enter unsynchronized region
+                std::exception_ptr exception = participate(participant);
+                th_lock.lock();
+                if (exception && ! shared_state.exception)
+                {
+                    shared_state.exception = std::move(exception);
+                }
+                if (--shared_state.participants_remaining == 0)
+                {
+                    thread_pool->notify_helpers(th_lock);
+                }
+            },
+            first_node + participant * thread_pool->node_count() / participants);
+    }
+
+    // The calling thread participates too
+    lock.unlock();
+    std::exception_ptr exception = participate(0);
+    lock.lock();
+    if (exception && ! shared_state.exception)
+    {
+        shared_state.exception = std::move(exception);
+    }
+    --shared_state.participants_remaining;
+
+    // Until the other participants are done, help with the queued tasks, such as the participants that didn't get a
+    // thread yet or the tasks of parallel_for calls nested in this one.
+    thread_pool->help_while(
+        lock,
+        [&]
+        {
+            return shared_state.participants_remaining > 0;
+        });
+
+    if (statistics)
+    {
+        statistics->addLoop(site, ThreadPoolStatistics::clock_t::now() - loop_start, static_cast<size_t>(distance(first, last)), shared_state.busy_times);
+    }
+    if (shared_state.exception)
+    {
+        std::rethrow_exception(shared_state.exception);
+    }
+    if (shared_state.stopped.load(std::memory_order_relaxed))
+    {
+        throw SliceCancelled();
+    }
+}
+
+//! With guided scheduling, a participant takes this part of the items it has left at a time.
+constexpr uint32_t guided_chunk_divisor = 4;
+
+} // namespace details
+
 /*! An implementation of parallel for.
  * There are still a lot of compilers that claim to be fully C++17 compatible, but don't implement the Parallel Execution TS of the accompanying standard library.
  * This means that we mostly have to fall back to the things that C++11/14 provide when it comes to threading/parallelism/etc.
@@ -114,16 +553,32 @@ inline Signed distance(const Int& first, const Int& last)
  * The range of items is divided in chunks such that there is a maximum number of `chunks_per_worker` and such that
  * chunk size is a multiple of `chunk_size_factor`.
  *
+ * The chunks are divided evenly over the participating threads up front. A thread that finishes its own chunks steals
+ * half of the remaining chunks of another one. Only starting and finishing a participant touches the thread pool's
+ * lock, rather than every chunk.
+ *
+ * parallel_for may be called from within the body of another parallel_for. While a call waits for its participants, it
+ * executes queued tasks, so the nested loops share all threads and can't deadlock.
+ *
+ * The participants stop taking chunks when the slice is cancelled or when the body threw. Once all participants are
+ * done, the first exception that the body threw is rethrown on the calling thread, or SliceCancelled if the loop
+ * stopped early because of a cancellation.
+ *
  * \param from, to: The [inclusive, exclusive) range of iteration. Integers or random access iterators
  * \param body The loop-body, as a closure. Receives the index on invocation.
  * \param chunk_size_factor Chunk size will be a multiple of this number.
- * \param chunks_per_worker Maximum number of tasks that are queue at once (defaults to 4 times the number of workers).
+ * \param chunks_per_worker Maximum number of chunks per worker (defaults to 8).
+ * \param site Where the loop is, to tell the loops apart in the statistics of the thread pool.
  */
 template<typename T, typename F>
-void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1, const size_t chunks_per_worker = 8)
+void parallel_for(
+    T first,
+    T last,
+    F&& loop_body,
+    size_t chunk_size_factor = 1,
+    const size_t chunks_per_worker = 8,
+    const std::source_location site = std::source_location::current())
 {
-    using lock_t = ThreadPool::lock_t;
-
     // Computes the number of items (early out if needed)
     const auto dist = distance(first, last);
     if (dist <= 0)
@@ -151,60 +606,148 @@ void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1,
     const size_t max_chunks = std::min(chunks_per_worker * nworkers, blocks);
     const size_t chunk_size = chunk_size_factor * round_up_divide(blocks, max_chunks);
     const size_t chunks = round_up_divide(nitems, chunk_size);
-    const auto chunk_increment = static_cast<decltype(dist)>(chunk_size);
     assert(chunks * chunk_size >= nitems && (chunks - 1) * chunk_size < nitems);
     assert(chunks <= chunks_per_worker * nworkers && chunks <= blocks);
 
-    // Packs state variables such that they can be referenced by the task closure through a single reference
-    struct
-    {
-        std::decay_t<F> loop_body; // User's closure data
-        size_t chunks_remaining;
-        std::condition_variable work_done = {};
-    } shared_state = { std::forward<F>(loop_body), chunks };
+    const size_t participants = std::min(MemoryBudget::limitParallelism(nworkers), chunks);
+    details::run_chunks_in_parallel(
+        first,
+        last,
+        std::forward<F>(loop_body),
+        chunk_size,
+        chunks,
+        participants,
+        [chunks, participants](const size_t participant)
+        {
+            return chunks * participant / participants;
+        },
+        [](uint32_t, uint32_t)
+        {
+            return uint32_t(1);
+        },
+        [](const uint32_t victim_first, const uint32_t victim_last)
+        {
+            return victim_first + (victim_last - victim_first) / 2;
+        },
+        site);
+}
 
-    // Schedules a task per chunk on the thread pool
-    lock_t lock = thread_pool->get_lock();
-    T chunk_last;
-    for (T chunk_first = first; chunk_first < last; chunk_first = chunk_last)
+/*!
+ * \brief A parallel for with guided scheduling, for loops whose items take very different amounts of time.
+ *
+ * The items are divided evenly over the participating threads up front, like parallel_for() does. Rather than in
+ * chunks of a fixed size, each thread takes a quarter of the items it has left at a time, so the chunks get smaller
+ * as the range drains. A single slow item then only holds back the items that the thread took with it, while the other
+ * threads steal the rest.
+ *
+ * \param from, to: The [inclusive, exclusive) range of iteration. Integers or random access iterators
+ * \param body The loop-body, as a closure. Receives the index on invocation.
+ * \param site Where the loop is, to tell the loops apart in the statistics of the thread pool.
+ */
+template<typename T, typename F>
+void parallel_for_guided(T first, T last, F&& loop_body, const std::source_location site = std::source_location::current())
+{
+    const auto dist = distance(first, last);
+    if (dist <= 0)
     {
-        if (distance(chunk_first, last) > chunk_increment)
-        { // Full size chunk
-            chunk_last = chunk_first + chunk_increment;
-        }
-        else
-        { // Adjust for the size of the last chunk
-            chunk_last = last;
-        }
-
-        thread_pool->push(
-            lock,
-            [&shared_state, chunk_first, chunk_last](lock_t& th_lock)
-            {
-                th_lock.unlock(); // Enter unsynchronized region
-                for (T i = chunk_first; i < chunk_last; ++i)
-                {
-                    shared_state.loop_body(i);
-                }
-                th_lock.lock();
-                if (--shared_state.chunks_remaining == 0)
-                {
-                    shared_state.work_done.notify_one();
-                }
-            });
+        return;
     }
+    const size_t nitems = dist;
+    ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
+    assert(thread_pool);
+    const size_t participants = std::min(MemoryBudget::limitParallelism(thread_pool->thread_count() + 1), nitems);
 
-    // Do work while parallel_for's tasks are running
-    thread_pool->work_while(
-        lock,
-        [&]
+    details::run_chunks_in_parallel(
+        first,
+        last,
+        std::forward<F>(loop_body),
+        1,
+        nitems,
+        participants,
+        [nitems, participants](const size_t participant)
         {
-            return shared_state.chunks_remaining > 0;
-        });
-    while (shared_state.chunks_remaining > 0) // Wait until all the task are completed
+            return nitems * participant / participants;
+        },
+        [](const uint32_t range_first, const uint32_t range_last)
+        {
+            return static_cast<uint32_t>(round_up_divide(range_last - range_first, details::guided_chunk_divisor));
+        },
+        [](const uint32_t victim_first, const uint32_t victim_last)
+        {
+            return victim_first + (victim_last - victim_first) / 2;
+        },
+        site);
+}
+
+/*!
+ * \brief A parallel for with guided scheduling, dividing the items by their estimated cost rather than their number.
+ *
+ * Both the division over the threads up front and the chunks that the threads take and steal are balanced by the
+ * cost, so that the few expensive items of a loop spread over the threads from the start. The hint is evaluated once
+ * for every item before the loop starts, so it should be much cheaper than the loop body.
+ *
+ * \param from, to: The [inclusive, exclusive) range of iteration. Integers or random access iterators
+ * \param body The loop-body, as a closure. Receives the index on invocation.
+ * \param cost_hint Estimates the relative cost of an item, as a non-negative number. Receives the index.
+ * \param site Where the loop is, to tell the loops apart in the statistics of the thread pool.
+ */
+template<typename T, typename F, typename C>
+void parallel_for_guided(T first, T last, F&& loop_body, C&& cost_hint, const std::source_location site = std::source_location::current())
+{
+    const auto dist = distance(first, last);
+    if (dist <= 0)
     {
-        shared_state.work_done.wait(lock);
+        return;
+    }
+    const size_t nitems = dist;
+    ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
+    assert(thread_pool);
+    const size_t participants = std::min(MemoryBudget::limitParallelism(thread_pool->thread_count() + 1), nitems);
+
+    // The cost of the items before each item, so that the cost of any range is a subtraction.
+    std::vector<double> cost_before(nitems + 1, 0.0);
+    size_t item_idx = 0;
+    for (T i = first; i < last; ++i, ++item_idx)
+    {
+        cost_before[item_idx + 1] = cost_before[item_idx] + std::max(static_cast<double>(cost_hint(i)), 0.0);
+    }
+    if (cost_before[nitems] <= 0.0)
+    { // Nothing to balance by.
+        parallel_for_guided(first, last, std::forward<F>(loop_body), site);
+        return;
     }
+    // Finds the first item in (range_first, range_last] where the cost since range_first reaches a part of the total.
+    const auto find_cost = [&cost_before](const uint32_t range_first, const uint32_t range_last, const double part)
+    {
+        const double target = cost_before[range_first] + (cost_before[range_last] - cost_before[range_first]) * part;
+        return static_cast<uint32_t>(std::lower_bound(cost_before.begin() + range_first + 1, cost_before.begin() + range_last, target) - cost_before.begin());
+    };
+
+    details::run_chunks_in_parallel(
+        first,
+        last,
+        std::forward<F>(loop_body),
+        1,
+        nitems,
+        participants,
+        [&cost_before, nitems, participants](const size_t participant)
+        {
+            if (participant == participants)
+            {
+                return nitems;
+            }
+            const double target = cost_before[nitems] * participant / participants;
+            return static_cast<size_t>(std::lower_bound(cost_before.begin(), cost_before.end() - 1, target) - cost_before.begin());
+        },
+        [&find_cost](const uint32_t range_first, const uint32_t range_last)
+        {
+            return find_cost(range_first, range_last, 1.0 / details::guided_chunk_divisor) - range_first;
+        },
+        [&find_cost](const uint32_t victim_first, const uint32_t victim_last)
+        {
+            return victim_last - victim_first == 1 ? victim_first : std::min(find_cost(victim_first, victim_last, 0.5), victim_last - 1);
+        },
+        site);
 }
 
 /*!
@@ -212,20 +755,37 @@ void parallel_for(T first, T last, F&& loop_body, size_t chunk_size_factor = 1,
  *  Overload for iterating over containers with random access iterators.
  */
 template<typename Container, typename F>
-auto parallel_for(Container& container, F&& loop_body, size_t chunk_size_factor = 1, size_t chunks_per_worker = 8) -> std::void_t<decltype(container.end() - container.begin())>
+auto parallel_for(
+    Container& container,
+    F&& loop_body,
+    size_t chunk_size_factor = 1,
+    size_t chunks_per_worker = 8,
+    const std::source_location site = std::source_location::current()) -> std::void_t<decltype(container.end() - container.begin())>
 {
-    parallel_for(container.begin(), container.end(), std::forward<F>(loop_body), chunk_size_factor, chunks_per_worker);
+    parallel_for(container.begin(), container.end(), std::forward<F>(loop_body), chunk_size_factor, chunks_per_worker, site);
 }
 
 
+/*!
+ * \brief How much run_multiple_producers_ordered_consumer() held back its producers, to tune its limits by.
+ */
+struct OrderedConsumerStatistics
+{
+    size_t slot_stall_count = 0; //!< How often a producer waited because all slots of the buffer were taken.
+    size_t memory_stall_count = 0; //!< How often a producer waited because the buffered items exceeded the memory budget.
+    std::chrono::duration<double> stall_time{}; //!< The total time that producers spent waiting for the consumer.
+    size_t peak_pending_count = 0; //!< The largest number of items that were waiting to be consumed at once.
+    size_t peak_pending_bytes = 0; //!< The largest estimated footprint of the items that were waiting to be consumed at once.
+};
+
 //! \private Internal state for run_multiple_producers_ordered_consumer()
-template<typename Producer, typename Consumer>
+template<typename Producer, typename Consumer, typename Footprint>
 class MultipleProducersOrderedConsumer;
 
 /*!
  * \brief Runs parallel producers and buffers the results to be consumed serially in indices order.
  *
- * Producers run while there is available space in the buffer.
+ * Producers run while there is available space in the buffer, both in slots and in memory.
  * Only 0 or 1 consumer runs at any time.
  *
  * When a thread produces the item waited for consumption, it turns itself into a consumer.
@@ -235,38 +795,94 @@ class MultipleProducersOrderedConsumer;
  * Produced items are stored into a shared ring buffer.
  * The item type must be nullable in order to differentiate free (not yet produced) slots.
  *
+ * The memory budget only counts the items that were produced, not those that are being produced, so the buffer can
+ * exceed the budget by as many items as there are workers. Since producers only wait while items are buffered, an item
+ * larger than the whole budget doesn't stall the loop.
+ *
+ * When the process gets close to its MemoryBudget, the producers wait until no items are buffered at all, and fewer
+ * workers are started when it is already critically close.
+ *
+ * The workers stop when the slice is cancelled or when the producer or the consumer threw. Once they are all done, the
+ * first exception that was thrown is rethrown on the calling thread, or SliceCancelled if not all items were consumed
+ * because of a cancellation. The items that were produced but not consumed are destroyed.
+ *
  * \param fist,last The numerical range of elements to produce.
  * \param producer Given an index/iterator, produces a non-null value of a nullable type (eg pointer, optional, etc...).
  * \param consumer Consumes an item produced by `producer`.
+ * \param footprint Estimates the number of bytes that an item produced by `producer` takes up.
+ * \param max_pending_bytes Memory budget for the items waiting to be consumed, or 0 to only limit the number of items.
  * \param max_pending_per_worker Number of allocated slots per worker for items waiting to be consumed.
+ * \return How much the producers were held back by the consumer.
  */
-template<typename P, typename C>
-void run_multiple_producers_ordered_consumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, size_t max_pending_per_worker = 8)
+template<typename P, typename C, typename F>
+OrderedConsumerStatistics run_multiple_producers_ordered_consumer(
+    ptrdiff_t first,
+    ptrdiff_t last,
+    P&& producer,
+    C&& consumer,
+    F&& footprint,
+    size_t max_pending_bytes,
+    size_t max_pending_per_worker = 8)
 {
     ThreadPool* thread_pool = Application::getInstance().thread_pool_;
     assert(thread_pool);
     assert(max_pending_per_worker > 0);
     const size_t max_pending = max_pending_per_worker * (thread_pool->thread_count() + 1);
-    MultipleProducersOrderedConsumer<P, C>(first, last, std::forward<P>(producer), std::forward<C>(consumer), max_pending).run(*thread_pool);
+    return MultipleProducersOrderedConsumer<P, C, F>(
+               first,
+               last,
+               std::forward<P>(producer),
+               std::forward<C>(consumer),
+               std::forward<F>(footprint),
+               max_pending,
+               max_pending_bytes)
+        .run(*thread_pool);
+}
+
+/*!
+ * \brief Runs parallel producers and buffers the results to be consumed serially in indices order, limiting only the
+ * number of buffered items.
+ *
+ * \see run_multiple_producers_ordered_consumer
+ */
+template<typename P, typename C>
+OrderedConsumerStatistics run_multiple_producers_ordered_consumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, size_t max_pending_per_worker = 8)
+{
+    return run_multiple_producers_ordered_consumer(
+        first,
+        last,
+        std::forward<P>(producer),
+        std::forward<C>(consumer),
+        [](const auto&)
+        {
+            return size_t(0);
+        },
+        0,
+        max_pending_per_worker);
 }
 
-template<typename Producer, typename Consumer>
+template<typename Producer, typename Consumer, typename Footprint>
 class MultipleProducersOrderedConsumer
 {
     using item_t = std::invoke_result_t<Producer, ptrdiff_t>;
     using lock_t = ThreadPool::lock_t;
+    using stall_clock_t = Trace::clock_t; // So that the stalls can be traced.
 
 public:
     /*!
      * \see run_multiple_producers_ordered_consumer
      * \param max_pending Number of allocated slots for items waiting to be consumed.
+     * \param max_pending_bytes Memory budget for the items waiting to be consumed, or 0 for no budget.
      */
-    template<typename P, typename C>
-    MultipleProducersOrderedConsumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, size_t max_pending)
+    template<typename P, typename C, typename F>
+    MultipleProducersOrderedConsumer(ptrdiff_t first, ptrdiff_t last, P&& producer, C&& consumer, F&& footprint, size_t max_pending, size_t max_pending_bytes)
         : producer_(std::forward<P>(producer))
         , consumer_(std::forward<C>(consumer))
+        , footprint_(std::forward<F>(footprint))
         , max_pending_(max_pending)
+        , max_pending_bytes_(max_pending_bytes)
         , queue_(std::make_unique<item_t[]>(max_pending))
+        , footprints_(std::make_unique<size_t[]>(max_pending))
         , last_idx_(last)
         , write_idx_(first)
         , read_idx_(first)
@@ -275,13 +891,13 @@ public:
     }
 
     //! Schedules the tasks on thread_pool, then run one on the main thread until completion.
-    void run(ThreadPool& thread_pool)
+    OrderedConsumerStatistics run(ThreadPool& thread_pool)
     {
         if (write_idx_ >= last_idx_)
         {
-            return;
+            return statistics_;
         }
-        workers_count_ = thread_pool.thread_count() + 1;
+        workers_count_ = MemoryBudget::limitParallelism(thread_pool.thread_count() + 1);
         // Start thread_pool.thread_count() workers on the thread pool
         auto lock = thread_pool.get_lock();
         for (size_t i = 1; i < workers_count_; i++)
@@ -296,70 +912,162 @@ public:
         // Run a worker on the main thread
         worker(lock);
         // Wait for completion of all workers
-        if (workers_count_ > 0)
+        work_done_cond_.wait(
+            lock,
+            [this]()
+            {
+                return workers_count_ == 0;
+            });
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+        if (read_idx_ < last_idx_)
         {
-            work_done_cond_.wait(lock);
+            throw SliceCancelled();
         }
+        return statistics_;
     }
 
 protected:
-    //! Waits for free space in the ring. Returns false when work is completed.
+    //! Whether the items waiting to be consumed take up more memory than allowed, or the process is close to its memory budget while items wait.
+    bool overBudget() const
+    {
+        return (max_pending_bytes_ != 0 && pending_bytes_ >= max_pending_bytes_) || (memory_pressure_ && pending_count_ > 0);
+    }
+
+    //! Whether the process is close to its memory budget, sampled outside of the lock.
+    static bool underMemoryPressure()
+    {
+        return MemoryBudget::getPressure() != MemoryBudget::Pressure::NONE;
+    }
+
+    //! Whether the workers should stop before all items are consumed.
+    bool shouldStop()
+    {
+        if (Cancellation::isRequested())
+        {
+            stopped_ = true;
+        }
+        return stopped_;
+    }
+
+    //! Stops all workers because the producer or the consumer threw. Relocks the lock if the exception left it unlocked.
+    void fail(lock_t& lock, std::exception_ptr exception)
+    {
+        if (! lock.owns_lock())
+        {
+            lock.lock();
+        }
+        if (! exception_)
+        {
+            exception_ = std::move(exception);
+        }
+        stopped_ = true;
+        free_slot_cond_.notify_all();
+    }
+
+    //! Waits for free space in the ring. Returns false when work is completed or stopped.
     bool wait(lock_t& lock)
     {
+        std::optional<stall_clock_t::time_point> stall_start;
         while (true)
         {
-            if (write_idx_ >= last_idx_)
-            { // Work completed: stop worker
-                return false;
+            if (write_idx_ >= last_idx_ || shouldStop())
+            { // Work completed or stopped: stop worker
+                break;
             }
-            if (write_idx_ - read_idx_ < max_pending_)
+            const bool slot_available = write_idx_ - read_idx_ < max_pending_;
+            if (slot_available && ! overBudget())
             { // Continue as a producer
-                return true;
+                break;
             }
-            else
-            { // Queue is full, wait for consumer signal
-                free_slot_cond_.wait(lock); // Signaled by consume_many() and worker() completion
+            // Queue is full, wait for consumer signal
+            if (! stall_start)
+            {
+                stall_start = stall_clock_t::now();
+                (slot_available ? statistics_.memory_stall_count : statistics_.slot_stall_count)++;
+            }
+            free_slot_cond_.wait(lock); // Signaled by consume_many() and worker() completion
+        }
+        if (stall_start)
+        {
+            const stall_clock_t::time_point stall_end = stall_clock_t::now();
+            statistics_.stall_time += stall_end - *stall_start;
+            if (Trace::enabled())
+            {
+                Trace::record("wait for consumer", nullptr, 0, *stall_start, stall_end);
             }
         }
+        return write_idx_ < last_idx_ && ! stopped_;
     }
 
     //! Produces an item and store in in the ring buffer. Assumes that there is items to produce and free space in the ring
     ptrdiff_t produce(lock_t& lock)
     {
         ptrdiff_t produced_idx = write_idx_++;
-        item_t* slot = &queue_[(produced_idx + max_pending_) % max_pending_];
+        const size_t slot_idx = (produced_idx + max_pending_) % max_pending_;
+        item_t* slot = &queue_[slot_idx];
         assert(produced_idx < last_idx_);
 
         // Unlocks global mutex while producing an item
         lock.unlock();
-        item_t item = producer_(produced_idx);
+        item_t item;
+        {
+            CURA_TRACE_SCOPE("produce");
+            item = producer_(produced_idx);
+        }
+        const size_t item_bytes = footprint_(std::as_const(item));
+        const bool memory_pressure = underMemoryPressure();
         lock.lock();
 
         assert(! *slot);
         *slot = std::move(item);
         assert(*slot);
 
+        footprints_[slot_idx] = item_bytes;
+        memory_pressure_ = memory_pressure;
+        pending_bytes_ += item_bytes;
+        pending_count_++;
+        statistics_.peak_pending_bytes = std::max(statistics_.peak_pending_bytes, pending_bytes_);
+        statistics_.peak_pending_count = std::max(statistics_.peak_pending_count, pending_count_);
+
         return produced_idx;
     }
 
-    //! Consumes items, until an empty slot (not yet produced) is found.
+    //! Consumes items, until an empty slot (not yet produced) is found or the workers are stopped.
     void consume_many(lock_t& lock)
     {
         assert(read_idx_ < write_idx_);
-        for (item_t* slot = &queue_[(read_idx_ + max_pending_) % max_pending_]; *slot; slot = &queue_[(read_idx_ + max_pending_) % max_pending_])
+        for (size_t slot_idx = (read_idx_ + max_pending_) % max_pending_; queue_[slot_idx] && ! shouldStop(); slot_idx = (read_idx_ + max_pending_) % max_pending_)
         {
+            item_t* slot = &queue_[slot_idx];
+            const size_t item_bytes = footprints_[slot_idx];
+
             // Unlocks global mutex while consuming an item
             lock.unlock();
-            consumer_(std::move(*slot));
+            {
+                CURA_TRACE_SCOPE("consume");
+                consumer_(std::move(*slot));
+            }
             *slot = {};
+            const bool memory_pressure = underMemoryPressure(); // The consumer may have freed memory.
             lock.lock();
 
             // Increment read index and signal a waiting worker if there is one
             bool queue_was_full = write_idx_ - read_idx_ >= max_pending_;
             read_idx_++;
+            const bool was_over_budget = overBudget();
+            memory_pressure_ = memory_pressure;
+            pending_bytes_ -= item_bytes;
+            pending_count_--;
 
-            // Notify producers that are waiting for a queue slot
-            if (queue_was_full)
+            // Notify producers that are waiting for a queue slot or for memory
+            if (was_over_budget && ! overBudget())
+            {
+                free_slot_cond_.notify_all();
+            }
+            else if (queue_was_full)
             {
                 free_slot_cond_.notify_one();
             }
@@ -372,10 +1080,17 @@ protected:
     {
         while (wait(lock)) // While there is work to do
         {
-            ptrdiff_t produced_idx = produce(lock);
-            if (produced_idx == consumer_wait_idx_)
-            { // This thread just produced the item that was waited for by the consumer
-                consume_many(lock); // Consume a contiguous block starting at consumer_wait_idx
+            try
+            {
+                ptrdiff_t produced_idx = produce(lock);
+                if (produced_idx == consumer_wait_idx_)
+                { // This thread just produced the item that was waited for by the consumer
+                    consume_many(lock); // Consume a contiguous block starting at consumer_wait_idx
+                }
+            }
+            catch (...)
+            {
+                fail(lock, std::current_exception());
             }
         }
 
@@ -394,19 +1109,28 @@ protected:
 
     Producer producer_;
     Consumer consumer_;
+    Footprint footprint_;
     const ptrdiff_t max_pending_; // Number of produced items that can wait in the queue
+    const size_t max_pending_bytes_; // Memory budget of the produced items that wait in the queue, or 0 for no budget
     const std::unique_ptr<item_t[]> queue_; // Ring buffer mapping each intermediary result to a slot
+    const std::unique_ptr<size_t[]> footprints_; // The estimated size of the item in each slot of the ring buffer
     const ptrdiff_t last_idx_;
 
     ptrdiff_t write_idx_; // Next slot to produce
     ptrdiff_t read_idx_; // Next slot to consume
     ptrdiff_t consumer_wait_idx_; // First slot that is waited for by the consumer
+    size_t pending_bytes_ = 0; // Estimated size of the produced items that wait in the queue
+    size_t pending_count_ = 0; // Number of produced items that wait in the queue
+    bool memory_pressure_ = false; // Whether the process was close to its memory budget when last sampled
+    bool stopped_ = false; // Whether the workers stop before all items are consumed
+    std::exception_ptr exception_; // The first exception that the producer or the consumer threw
     std::condition_variable free_slot_cond_; // Condition to wait for available space in the buffer
+    OrderedConsumerStatistics statistics_;
 };
 
 //! \private Template deduction guide: defaults to inlining closures into the class layout
-template<typename P, typename C>
-MultipleProducersOrderedConsumer(ptrdiff_t, ptrdiff_t, P, C, size_t) -> MultipleProducersOrderedConsumer<P, C>;
+template<typename P, typename C, typename F>
+MultipleProducersOrderedConsumer(ptrdiff_t, ptrdiff_t, P, C, F, size_t, size_t) -> MultipleProducersOrderedConsumer<P, C, F>;
 
 } // namespace cura
 #endif // THREADPOOL_H
@@ -0,0 +1,92 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_THREAD_POOL_STATISTICS_H
+#define UTILS_THREAD_POOL_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace cura
+{
+
+/*!
+ * \brief Measurements of how well the work of a slice spreads over the threads of the thread pool, to tell serial
+ * sections and badly balanced loops apart.
+ *
+ * The thread pool only collects these when asked to, since taking the time around every task has a cost. All members
+ * are guarded by the lock of the thread pool that owns the statistics.
+ */
+class ThreadPoolStatistics
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+    using duration_t = std::chrono::duration<double>;
+
+    //! The number of buckets of the task duration histogram: up to 1µs, 2µs, 4µs and so on, the last one unbounded.
+    static constexpr size_t histogram_size = 24;
+
+    /*!
+     * \param thread_count The number of threads to track the idle time of: the worker threads plus one for all
+     * other threads.
+     */
+    explicit ThreadPoolStatistics(size_t thread_count);
+
+    //! Records a task that waited in the queue for `queue_wait` and then ran for `run_time`.
+    void addTask(duration_t queue_wait, duration_t run_time);
+
+    //! Records that a thread waited for work for `idle_time`. Thread 0 stands for all threads outside of the pool.
+    void addIdle(size_t thread_idx, duration_t idle_time);
+
+    /*!
+     * \brief Records a call of parallel_for.
+     * \param site Where parallel_for was called from.
+     * \param wall_time How long the call took.
+     * \param item_count The number of items of the loop.
+     * \param busy_times How long each participant of the call ran the loop body.
+     */
+    void addLoop(const std::source_location& site, duration_t wall_time, size_t item_count, const std::vector<duration_t>& busy_times);
+
+    //! The number of tasks that were recorded.
+    size_t taskCount() const
+    {
+        return task_count_;
+    }
+
+    //! The number of calls of parallel_for that were recorded, from all sites.
+    size_t loopCallCount() const;
+
+    //! Logs everything that was recorded since construction or the last reset.
+    void report() const;
+
+    //! Forgets everything that was recorded.
+    void reset();
+
+private:
+    //! The calls of parallel_for from one place in the code.
+    struct LoopSite
+    {
+        size_t call_count = 0;
+        size_t item_count = 0;
+        duration_t wall_time{};
+        double imbalance_sum = 0.0; //!< Sum over the calls of the longest busy time of a participant relative to the mean.
+        double worst_imbalance = 1.0;
+    };
+
+    clock_t::time_point start_;
+    size_t task_count_ = 0;
+    duration_t queue_wait_sum_{};
+    duration_t queue_wait_max_{};
+    std::array<size_t, histogram_size> task_duration_histogram_{};
+    std::vector<duration_t> idle_times_;
+    std::map<std::string, LoopSite> loop_sites_; //!< By file name and line.
+};
+
+} // namespace cura
+
+#endif // UTILS_THREAD_POOL_STATISTICS_H
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_TRACE_H
+#define UTILS_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <source_location>
+
+#include "utils/AllocationStatistics.h"
+
+namespace cura
+{
+
+/*!
+ * \brief Records when the parts of a slice run on which thread, to see how they overlap in time.
+ *
+ * Every thread records its events in a ring buffer of its own, so recording takes no lock. When a buffer is full, the
+ * oldest events of that thread are overwritten. While tracing is off, a scope only checks a flag.
+ *
+ * The events are written as a Chrome trace, which chrome://tracing and ui.perfetto.dev can show. Only write the trace
+ * while nothing is being recorded, such as after a slice.
+ */
+class Trace
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    //! The number of events that each thread keeps.
+    static constexpr size_t buffer_size = 1 << 16;
+
+    /*!
+     * \brief Marks an event from its construction to its destruction, on the calling thread.
+     *
+     * In a build with ENABLE_ALLOCATION_STATS, the allocations in the scope are attributed to it as well, whether tracing
+     * is on or not. Use CURA_TRACE_SCOPE rather than naming one.
+     */
+    class Scope
+    {
+    public:
+        /*!
+         * \param name What runs in the scope. Must outlive the trace, such as a string literal.
+         */
+        explicit Scope(const char* name)
+#ifdef ENABLE_ALLOCATION_STATS
+            : allocation_tag_(name)
+#endif
+        {
+            if (enabled())
+            {
+                name_ = name;
+                start_ = clock_t::now();
+            }
+        }
+
+        /*!
+         * \param name What runs in the scope. Must outlive the trace, such as a string literal.
+         * \param site Where it was started from, to tell events of the same name apart.
+         */
+        Scope(const char* name, const std::source_location& site)
+#ifdef ENABLE_ALLOCATION_STATS
+            : allocation_tag_(name, site)
+#endif
+        {
+            if (enabled())
+            {
+                name_ = name;
+                file_ = site.file_name();
+                line_ = site.line();
+                start_ = clock_t::now();
+            }
+        }
+
+        ~Scope()
+        {
+            if (name_ != nullptr)
+            {
+                record(name_, file_, line_, start_, clock_t::now());
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name_ = nullptr; //!< Null while tracing is off.
+        const char* file_ = nullptr;
+        uint_least32_t line_ = 0;
+        clock_t::time_point start_;
+#ifdef ENABLE_ALLOCATION_STATS
+        AllocationStatistics::Tag allocation_tag_;
+#endif
+    };
+
+    //! Whether events are being recorded.
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! Starts recording, forgetting about the events that were recorded before.
+    static void enable();
+
+    //! Stops recording. The events that were recorded are kept until they are written.
+    static void disable();
+
+    /*!
+     * \brief Records an event on the calling thread that ran from \p start to \p end.
+     * \param name What ran. Must outlive the trace, such as a string literal.
+     * \param file, line Where it was started from, or null if that doesn't matter. Must outlive the trace, like the file
+     * names of std::source_location.
+     */
+    static void record(const char* name, const char* file, uint_least32_t line, clock_t::time_point start, clock_t::time_point end);
+
+    /*!
+     * \brief Writes the events of all threads to a file as a Chrome trace, and forgets them.
+     * \return Whether the file could be written.
+     */
+    static bool write(const std::filesystem::path& file);
+
+private:
+    static inline std::atomic<bool> enabled_{ false };
+};
+
+} // namespace cura
+
+#define CURA_TRACE_CONCAT_IMPL(a, b) a##b
+#define CURA_TRACE_CONCAT(a, b) CURA_TRACE_CONCAT_IMPL(a, b)
+
+//! Traces the rest of the enclosing scope under a name, see Trace.
+#define CURA_TRACE_SCOPE(name) ::cura::Trace::Scope CURA_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+//! Traces the rest of the enclosing scope under a name, along with the std::source_location that it was started from.
+#define CURA_TRACE_SCOPE_AT(name, site) ::cura::Trace::Scope CURA_TRACE_CONCAT(trace_scope_, __LINE__)(name, site)
+
+#endif // UTILS_TRACE_H
@@ -38,9 +38,19 @@ public:
     /*!
      * Discretize a parabola based on (approximate) step size.
      * The \p approximate_step_size is measured parallel to the \p source_segment, not along the parabola.
+     *
+     * Where the parabola is so flat that longer steps stay within \p max_deviation of it, the steps are made longer.
+     * The distance to the source point deviates from the straight segments by as much as the parabola does, so the
+     * widths of the beads along the segments stay within \p max_deviation too.
      */
-    static std::vector<Point2LL>
-        discretizeParabola(const Point2LL& source_point, const Segment& source_segment, Point2LL start, Point2LL end, coord_t approximate_step_size, double transitioning_angle);
+    static std::vector<Point2LL> discretizeParabola(
+        const Point2LL& source_point,
+        const Segment& source_segment,
+        Point2LL start,
+        Point2LL end,
+        coord_t approximate_step_size,
+        double transitioning_angle,
+        coord_t max_deviation = 0);
 
 protected:
     /*!
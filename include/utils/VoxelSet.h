@@ -0,0 +1,220 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#ifndef UTILS_VOXEL_SET_H
+#define UTILS_VOXEL_SET_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+#include "utils/Point3LL.h"
+
+namespace cura
+{
+
+/*!
+ * \brief A run of voxels along the X axis, on one scanline of one layer of voxels.
+ */
+struct VoxelSpan
+{
+    coord_t x_min; //!< The first voxel of the run.
+    coord_t x_max; //!< The last voxel of the run, inclusive.
+    coord_t y;
+    coord_t z;
+
+    bool operator==(const VoxelSpan& other) const = default;
+};
+
+/*!
+ * \brief A set of voxels, kept as bits in dense blocks of 8x8x8 voxels.
+ *
+ * This stands in for the std::unordered_set<GridPoint3> of the voxel grids, which needs a node of its own for every
+ * voxel. Only the blocks that hold any voxels are stored, so it stays sparse on a large scale, while within a block
+ * each voxel is a single bit. Taking the union, intersection or difference of two sets works on whole words of 64
+ * voxels at a time.
+ */
+class VoxelSet
+{
+public:
+    //! Add a voxel to the set.
+    void insert(const Point3LL& voxel)
+    {
+        const auto [word_idx, bit] = locate(voxel);
+        blocks_[blockKey(voxel)][word_idx] |= bit;
+    }
+
+    //! Add a run of voxels to the set, a block at a time.
+    void insertSpan(const VoxelSpan& span)
+    {
+        const size_t word_idx = static_cast<size_t>(span.z & block_mask);
+        const coord_t row_bit_idx = (span.y & block_mask) << block_bits;
+        for (coord_t x = span.x_min; x <= span.x_max;)
+        {
+            const coord_t block_x_max = std::min(span.x_max, x | block_mask); // The last voxel of the span in this block.
+            const uint64_t row = ((uint64_t(1) << (block_x_max - x + 1)) - 1) << ((x & block_mask) | row_bit_idx);
+            blocks_[Point3LL(x >> block_bits, span.y >> block_bits, span.z >> block_bits)][word_idx] |= row;
+            x = block_x_max + 1;
+        }
+    }
+
+    //! Remove a voxel from the set, if it is in there.
+    void erase(const Point3LL& voxel)
+    {
+        const auto block = blocks_.find(blockKey(voxel));
+        if (block == blocks_.end())
+        {
+            return;
+        }
+        const auto [word_idx, bit] = locate(voxel);
+        block->second[word_idx] &= ~bit;
+        if (isEmpty(block->second))
+        {
+            blocks_.erase(block);
+        }
+    }
+
+    bool contains(const Point3LL& voxel) const
+    {
+        const auto block = blocks_.find(blockKey(voxel));
+        if (block == blocks_.end())
+        {
+            return false;
+        }
+        const auto [word_idx, bit] = locate(voxel);
+        return (block->second[word_idx] & bit) != 0;
+    }
+
+    bool empty() const
+    {
+        return blocks_.empty();
+    }
+
+    //! The number of voxels in the set.
+    size_t size() const
+    {
+        size_t count = 0;
+        for (const auto& [key, block] : blocks_)
+        {
+            for (const uint64_t word : block)
+            {
+                count += static_cast<size_t>(std::popcount(word));
+            }
+        }
+        return count;
+    }
+
+    //! Add all voxels of \p other to this set.
+    void unite(const VoxelSet& other)
+    {
+        for (const auto& [key, other_block] : other.blocks_)
+        {
+            Block& block = blocks_[key];
+            for (size_t word_idx = 0; word_idx < block.size(); word_idx++)
+            {
+                block[word_idx] |= other_block[word_idx];
+            }
+        }
+    }
+
+    //! Keep only the voxels that are in \p other too.
+    void intersect(const VoxelSet& other)
+    {
+        for (auto block = blocks_.begin(); block != blocks_.end();)
+        {
+            const auto other_block = other.blocks_.find(block->first);
+            if (other_block != other.blocks_.end())
+            {
+                for (size_t word_idx = 0; word_idx < block_size; word_idx++)
+                {
+                    block->second[word_idx] &= other_block->second[word_idx];
+                }
+            }
+            block = other_block == other.blocks_.end() || isEmpty(block->second) ? blocks_.erase(block) : std::next(block);
+        }
+    }
+
+    //! Remove all voxels of \p other from this set.
+    void subtract(const VoxelSet& other)
+    {
+        for (auto block = blocks_.begin(); block != blocks_.end();)
+        {
+            const auto other_block = other.blocks_.find(block->first);
+            if (other_block == other.blocks_.end())
+            {
+                ++block;
+                continue;
+            }
+            for (size_t word_idx = 0; word_idx < block_size; word_idx++)
+            {
+                block->second[word_idx] &= ~other_block->second[word_idx];
+            }
+            block = isEmpty(block->second) ? blocks_.erase(block) : std::next(block);
+        }
+    }
+
+    /*!
+     * \brief Call a function for every voxel in the set, in no particular order.
+     * \param process_voxel Takes the voxel as a Point3LL.
+     */
+    template<typename Func>
+    void forEach(Func&& process_voxel) const
+    {
+        for (const auto& [key, block] : blocks_)
+        {
+            for (size_t word_idx = 0; word_idx < block.size(); word_idx++)
+            {
+                for (uint64_t word = block[word_idx]; word != 0; word &= word - 1)
+                {
+                    const coord_t bit_idx = std::countr_zero(word);
+                    process_voxel(Point3LL(
+                        key.x_ * block_size + (bit_idx & block_mask),
+                        key.y_ * block_size + (bit_idx >> block_bits),
+                        key.z_ * block_size + static_cast<coord_t>(word_idx)));
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr coord_t block_bits = 3;
+    static constexpr coord_t block_size = coord_t(1) << block_bits; //!< The number of voxels along each side of a block.
+    static constexpr coord_t block_mask = block_size - 1;
+
+    //! A word for each layer of voxels in the block, with a bit for each voxel in that layer.
+    using Block = std::array<uint64_t, block_size>;
+
+    std::unordered_map<Point3LL, Block> blocks_; //!< Blocks without any voxels are removed.
+
+    static Point3LL blockKey(const Point3LL& voxel)
+    {
+        return Point3LL(voxel.x_ >> block_bits, voxel.y_ >> block_bits, voxel.z_ >> block_bits); // Rounds down for negative voxels too.
+    }
+
+    //! The word in a block and the bit in that word for a voxel.
+    static std::pair<size_t, uint64_t> locate(const Point3LL& voxel)
+    {
+        const auto bit_idx = static_cast<unsigned>((voxel.x_ & block_mask) | ((voxel.y_ & block_mask) << block_bits));
+        return { static_cast<size_t>(voxel.z_ & block_mask), uint64_t(1) << bit_idx };
+    }
+
+    static bool isEmpty(const Block& block)
+    {
+        return std::all_of(
+            block.begin(),
+            block.end(),
+            [](const uint64_t word)
+            {
+                return word == 0;
+            });
+    }
+};
+
+} // namespace cura
+
+#endif // UTILS_VOXEL_SET_H
@@ -6,8 +6,10 @@
 
 #include <functional>
 #include <unordered_set>
+#include <vector>
 
 #include "utils/Point2LL.h"
+#include "utils/VoxelSet.h"
 #include "utils/polygon.h"
 
 namespace cura
@@ -51,6 +53,7 @@ struct DilationKernel
     GridPoint3 kernel_size_; //!< Size of the kernel in number of voxel cells
     Type type_;
     std::vector<GridPoint3> relative_cells_; //!< All offset positions relative to some reference cell which is to be dilated
+    std::vector<VoxelSpan> relative_spans_; //!< The same offset positions, as runs along the X axis
 
     DilationKernel(GridPoint3 kernel_size, Type type);
 };
@@ -113,6 +116,15 @@ private:
      */
     bool _walkAreas(const Polygons& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const;
 
+    //! The voxels which \ref walkPolygons visits, each once.
+    std::vector<GridPoint3> polygonCells(const Polygons& polys, coord_t z) const;
+
+    /*!
+     * The voxels which \ref _walkAreas visits.
+     * \warning the \p polys is assumed to be translated by half the cell_size in xy already
+     */
+    std::vector<GridPoint3> areaCells(const Polygons& polys, coord_t z) const;
+
 public:
     /*!
      * Process all voxels inside the area of a polygons object.
@@ -139,6 +151,37 @@ public:
      */
     bool walkDilatedAreas(const Polygons& polys, coord_t z, const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const;
 
+    /*!
+     * The voxels which the line segments of a polygon cross, as \ref walkPolygons visits them.
+     *
+     * Unlike the walk functions, these rasterize functions don't call anything per voxel. They return the voxels as
+     * runs along each scanline, sorted by z, y and x, without overlap. They only read this object, so several layers
+     * may be rasterized in parallel.
+     *
+     * \param polys The polygons to rasterize
+     * \param z The height at which the polygons occur
+     * \return The runs of voxels
+     */
+    std::vector<VoxelSpan> rasterizePolygons(const Polygons& polys, coord_t z) const;
+
+    /*!
+     * The voxels near the line segments of a polygon, as \ref walkDilatedPolygons visits them.
+     * \see rasterizePolygons
+     */
+    std::vector<VoxelSpan> rasterizeDilatedPolygons(const Polygons& polys, coord_t z, const DilationKernel& kernel) const;
+
+    /*!
+     * The voxels inside the area of a polygons object, as \ref walkAreas visits them.
+     * \see rasterizePolygons
+     */
+    std::vector<VoxelSpan> rasterizeAreas(const Polygons& polys, coord_t z) const;
+
+    /*!
+     * The voxels inside the area of a polygons object, dilated by a kernel, as \ref walkDilatedAreas visits them.
+     * \see rasterizePolygons
+     */
+    std::vector<VoxelSpan> rasterizeDilatedAreas(const Polygons& polys, coord_t z, const DilationKernel& kernel) const;
+
     /*!
      * Dilate with a kernel.
      *
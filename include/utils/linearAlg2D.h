@@ -4,6 +4,8 @@
 #ifndef UTILS_LINEAR_ALG_2D_H
 #define UTILS_LINEAR_ALG_2D_H
 
+#include <span>
+
 #include "Point2LL.h"
 
 namespace cura
@@ -430,6 +432,22 @@ public:
      * \param vec_len The lenght of the resultant vector. It's not wise to set this to 1, since we do tend to do integer math here.
      */
     static Point2LL getBisectorVector(const Point2LL& intersect, const Point2LL& a, const Point2LL& b, const coord_t vec_len);
+
+    /*!
+     * \brief Give for a run of line segments a lower bound of the squared distance from a point to each of them.
+     *
+     * The bound is the squared distance to the bounding box of each segment. Since \ref getClosestOnLineSegment gives a
+     * point inside that box, it is never further away than the bound. Segments whose bound is already further than the
+     * best one found so far can so be skipped without computing their closest point, which needs a division.
+     *
+     * The bounds are computed without branches over contiguous arrays, so that the compiler can vectorize the loop.
+     *
+     * \param from The point to measure the distance from.
+     * \param points The points of a polyline. Segment \c i runs from \c points[i] to \c points[i+1].
+     * \param next_point The point that the last segment runs to, such as the first point of a polygon.
+     * \param[out] dist2 The lower bounds for each segment. Must have as many elements as \p points.
+     */
+    static void getDist2LowerBoundsToLineSegments(const Point2LL& from, std::span<const Point2LL> points, const Point2LL& next_point, std::span<coord_t> dist2);
 };
 
 
@@ -834,6 +834,12 @@ public:
 
     size_t pointCount() const; //!< Return the amount of points in all polygons
 
+    /*!
+     * Free the memory that was reserved for more polygons or points than there are, such as what growing them left.
+     * \return How many bytes were freed.
+     */
+    size_t shrinkToFit();
+
     PolygonRef operator[](size_t index)
     {
         POLY_ASSERT(index < size());
@@ -941,6 +947,11 @@ public:
         paths.emplace_back(*poly.path);
     }
 
+    void emplace_back(Polygon&& poly)
+    {
+        paths.emplace_back(std::move(*poly));
+    }
+
     void emplace_back(const ConstPolygonRef& poly)
     {
         paths.emplace_back(*poly.path);
@@ -1013,15 +1024,13 @@ public:
      */
     static Polygons toPolygons(ClipperLib::PolyTree& poly_tree);
 
-    Polygons difference(const Polygons& other) const
-    {
-        Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctDifference, ret.paths);
-        return ret;
-    }
+    /*!
+     * Subtract \p other from these polygons.
+     *
+     * Polygons of \p other of which the bounding box doesn't overlap with that of these polygons are left out of the
+     * operation, since they can't change the result.
+     */
+    Polygons difference(const Polygons& other) const;
     Polygons unionPolygons(const Polygons& other, ClipperLib::PolyFillType fill_type = ClipperLib::pftNonZero) const
     {
         Polygons ret;
@@ -1038,15 +1047,13 @@ public:
     {
         return unionPolygons(Polygons());
     }
-    Polygons intersection(const Polygons& other) const
-    {
-        Polygons ret;
-        ClipperLib::Clipper clipper(clipper_init);
-        clipper.AddPaths(paths, ClipperLib::ptSubject, true);
-        clipper.AddPaths(other.paths, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctIntersection, ret.paths);
-        return ret;
-    }
+    /*!
+     * Intersect these polygons with \p other.
+     *
+     * Polygons of either operand of which the bounding box doesn't overlap with that of the other operand are left out
+     * of the operation, since they can't change the result. If that leaves nothing, Clipper isn't run at all.
+     */
+    Polygons intersection(const Polygons& other) const;
 
 
     /*!
@@ -1359,6 +1366,19 @@ public:
      */
     void removeDegenerateVertsPolyline();
 
+    /*!
+     * Removes degenerate vertices, colinear edges and small polygons in one pass over the polygons.
+     *
+     * Each polygon gets the same treatment as by calling removeDegenerateVerts, removeColinearEdges and
+     * removeSmallAreas with \p remove_holes set one after the other, except that the remaining polygons keep their
+     * order. The polygons are changed in place, without copying their vertices.
+     *
+     * \param max_deviation_angle The angle by which adjacent edges may deviate from a straight line for the vertex
+     * between them to be removed.
+     * \param min_area_size The area below which polygons are removed, in mm^2. Holes are removed too.
+     */
+    void cleanUp(const AngleRadians max_deviation_angle = AngleRadians(0.0005), const double min_area_size = 0.0);
+
     /*!
      * Removes overlapping consecutive line segments which don't delimit a
      * positive area.
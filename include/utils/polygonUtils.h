@@ -116,8 +116,12 @@ struct GivenDistPoint
 
 typedef SparseLineGrid<PolygonsPointIndex, PolygonsPointIndexSegmentLocator> LocToLineGrid;
 
+class PolygonsSpatialIndex;
+
 class PolygonUtils
 {
+    friend class PolygonsSpatialIndex; // To move points inside after finding the closest point with the index, through _moveInside2.
+
 public:
     static const std::function<int(Point2LL)> no_penalty_function; //!< Function always returning zero
 
@@ -695,6 +699,16 @@ public:
 
     static void fixSelfIntersections(const coord_t epsilon, Polygons& thiss);
 
+    /*!
+     * Union many polygons, faster than with a single call of Polygons::unionPolygons but with the same result.
+     *
+     * The polygons are grouped by where they are, the groups are unioned on the thread pool and the unions of
+     * neighbouring groups are then merged pairwise, also in parallel, until one is left. Since that can only give the
+     * same result if no polygon subtracts from the others, polygons with holes are unioned all at once.
+     *
+     * \param p The polygons to union.
+     * \return The union.
+     */
     static Polygons unionManySmall(const Polygons& p);
 
 
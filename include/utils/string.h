@@ -4,9 +4,14 @@
 #ifndef UTILS_STRING_H
 #define UTILS_STRING_H
 
-#include <cstdio> // sprintf
+#include <algorithm> // std::copy
+#include <array>
+#include <charconv> // to_chars
+#include <cmath> // isfinite
 #include <ctype.h>
 #include <sstream> // ostringstream
+#include <string>
+#include <string_view>
 
 #include <spdlog/spdlog.h>
 
@@ -26,6 +31,16 @@ static inline int stringcasecompare(const char* a, const char* b)
     return *a - *b;
 }
 
+/*!
+ * The most characters that \ref writeInt2mm writes for one coordinate.
+ */
+constexpr size_t int2mm_max_chars = 16;
+
+/*!
+ * The most characters that \ref writeDoubleToChars writes for one value.
+ */
+constexpr size_t double_max_chars = 400;
+
 /*!
  * Efficient conversion of micron integer type to millimeter string.
  *
@@ -34,66 +49,58 @@ static inline int stringcasecompare(const char* a, const char* b)
  * so as to support multiplication within the same integer type.
  *
  * \param coord The micron unit to convert
- * \param ss The output stream to write the string to
+ * \param out The buffer to write the string to, with room for at least \ref int2mm_max_chars characters
+ * \return The end of the string that was written
  */
-static inline void writeInt2mm(const int32_t coord, std::ostream& ss)
+static inline char* writeInt2mm(const int32_t coord, char* out)
 {
-    constexpr size_t buffer_size = 24;
-    char buffer[buffer_size];
-    int char_count = sprintf(buffer, "%d", coord); // we haven't found any way for the windows compiler to accept formatting of a coord_t, so it has to be int32_t instead
-#ifdef DEBUG
-    if (char_count + 1 >= int(buffer_size)) // + 1 for the null character
-    {
-        spdlog::error("Cannot write {} to buffer of size {}", coord, buffer_size);
-    }
-    if (char_count < 0)
-    {
-        spdlog::error("Encoding error while writing {}", coord);
-    }
-#endif // DEBUG
-    int end_pos = char_count; // the first character not to write any more
+    std::array<char, int2mm_max_chars> digits;
+    digits[0] = '\0'; // Not a zero, so that counting the trailing zeros stops before the digits.
+    char* buffer = digits.data() + 1;
+    const int char_count = static_cast<int>(std::to_chars(buffer, digits.data() + digits.size(), coord).ptr - buffer);
     int trailing_zeros = 1;
     while (trailing_zeros < 4 && buffer[char_count - trailing_zeros] == '0')
     {
         trailing_zeros++;
     }
     trailing_zeros--;
-    end_pos = char_count - trailing_zeros;
+    const int end_pos = char_count - trailing_zeros; // the first character not to write any more
     if (trailing_zeros == 3)
     { // no need to write the decimal dot
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << buffer;
-        return;
+        return std::copy(buffer, buffer + end_pos, out);
     }
     if (char_count <= 3)
     {
         int start = 0; // where to start writing from the buffer
         if (coord < 0)
         {
-            ss << '-';
+            *out++ = '-';
             start = 1;
         }
-        ss << "0.";
+        *out++ = '0';
+        *out++ = '.';
         for (int nulls = char_count - start; nulls < 3; nulls++)
         { // fill up to 3 decimals with zeros
-            ss << '0';
+            *out++ = '0';
         }
-        buffer[char_count - trailing_zeros] = '\0';
-        ss << (static_cast<char*>(buffer) + start);
-    }
-    else
-    {
-        char prev = '.';
-        int pos;
-        for (pos = char_count - 3; pos <= end_pos; pos++)
-        { // shift all characters and insert the decimal dot
-            char next_prev = buffer[pos];
-            buffer[pos] = prev;
-            prev = next_prev;
-        }
-        buffer[pos] = '\0';
-        ss << buffer;
+        return std::copy(buffer + start, buffer + end_pos, out);
     }
+    // insert the decimal dot
+    out = std::copy(buffer, buffer + char_count - 3, out);
+    *out++ = '.';
+    return std::copy(buffer + char_count - 3, buffer + end_pos, out);
+}
+
+/*!
+ * Efficient conversion of micron integer type to millimeter string.
+ *
+ * \param coord The micron unit to convert
+ * \param ss The output stream to write the string to
+ */
+static inline void writeInt2mm(const int32_t coord, std::ostream& ss)
+{
+    char buffer[int2mm_max_chars];
+    ss.write(buffer, writeInt2mm(coord, buffer) - buffer);
 }
 
 /*!
@@ -111,7 +118,7 @@ struct MMtoStream
 };
 
 /*!
- * Efficient writing of a double to a stringstream
+ * Efficient writing of a double to a char buffer
  *
  * writes with \p precision digits after the decimal dot, but removes trailing zeros
  *
@@ -119,46 +126,59 @@ struct MMtoStream
  *
  * \param precision The number of (non-zero) digits after the decimal dot
  * \param coord double to output
- * \param ss The output stream to write the string to
+ * \param out The buffer to write the string to, with room for at least \ref double_max_chars characters
+ * \return The end of the string that was written
  */
-static inline void writeDoubleToStream(const uint8_t precision, const double coord, std::ostream& ss)
+static inline char* writeDoubleToChars(const uint8_t precision, const double coord, char* out)
 {
-    char format[5] = "%.xF"; // write a float with [x] digits after the dot
-    format[2] = '0' + static_cast<char>(precision); // set [x]
-    constexpr size_t buffer_size = 400;
-    char buffer[buffer_size];
-    int char_count = sprintf(buffer, format, coord);
-#ifdef DEBUG
-    if (char_count + 1 >= int(buffer_size)) // + 1 for the null character
-    {
-        spdlog::error("Cannot write {} to buffer of size {}", coord, buffer_size);
+    if (! std::isfinite(coord))
+    { // written the way printf writes them with %F
+        const std::string_view text = std::isnan(coord) ? (std::signbit(coord) ? "-NAN" : "NAN") : (coord < 0 ? "-INF" : "INF");
+        return std::copy(text.begin(), text.end(), out);
     }
-    if (char_count < 0)
+    const std::to_chars_result result = std::to_chars(out, out + double_max_chars, coord, std::chars_format::fixed, precision);
+#ifdef DEBUG
+    if (result.ec != std::errc())
     {
-        spdlog::error("Encoding error while writing {}", coord);
+        spdlog::error("Cannot write {} to buffer of size {}", coord, double_max_chars);
     }
 #endif // DEBUG
-    if (char_count <= 0)
+    const int char_count = static_cast<int>(result.ptr - out);
+    if (result.ec != std::errc() || char_count <= 0)
     {
-        return;
+        return out;
     }
-    if (buffer[char_count - precision - 1] == '.')
+    if (out[char_count - precision - 1] == '.')
     {
         int non_nul_pos = char_count - 1;
-        while (buffer[non_nul_pos] == '0')
+        while (out[non_nul_pos] == '0')
         {
             non_nul_pos--;
         }
-        if (buffer[non_nul_pos] == '.')
+        if (out[non_nul_pos] == '.')
         {
-            buffer[non_nul_pos] = '\0';
-        }
-        else
-        {
-            buffer[non_nul_pos + 1] = '\0';
+            return out + non_nul_pos;
         }
+        return out + non_nul_pos + 1;
     }
-    ss << buffer;
+    return result.ptr;
+}
+
+/*!
+ * Efficient writing of a double to a stringstream
+ *
+ * writes with \p precision digits after the decimal dot, but removes trailing zeros
+ *
+ * \warning only works with precision up to 9 and input up to 10^14
+ *
+ * \param precision The number of (non-zero) digits after the decimal dot
+ * \param coord double to output
+ * \param ss The output stream to write the string to
+ */
+static inline void writeDoubleToStream(const uint8_t precision, const double coord, std::ostream& ss)
+{
+    char buffer[double_max_chars];
+    ss.write(buffer, writeDoubleToChars(precision, coord, buffer) - buffer);
 }
 
 /*!
@@ -176,6 +196,85 @@ struct PrecisionedDouble
     }
 };
 
+/*!
+ * Builds a line of g-code in a buffer, to write it to a stream at once.
+ *
+ * The numbers are written the same as \ref MMtoStream and \ref PrecisionedDouble write them to a stream, but the
+ * stream is only involved once for the whole line.
+ */
+class GCodeLineBuilder
+{
+public:
+    GCodeLineBuilder& operator<<(const std::string_view text)
+    {
+        if (text.size() > buffer_.size())
+        {
+            spill();
+            spilled_.append(text);
+            return *this;
+        }
+        size_ = std::copy(text.begin(), text.end(), reserve(text.size())) - buffer_.data();
+        return *this;
+    }
+
+    GCodeLineBuilder& operator<<(const char character)
+    {
+        *reserve(1) = character;
+        size_++;
+        return *this;
+    }
+
+    GCodeLineBuilder& operator<<(const MMtoStream coord)
+    {
+        size_ = writeInt2mm(coord.value, reserve(int2mm_max_chars)) - buffer_.data();
+        return *this;
+    }
+
+    GCodeLineBuilder& operator<<(const PrecisionedDouble value)
+    {
+        size_ = writeDoubleToChars(value.precision, value.value, reserve(double_max_chars)) - buffer_.data();
+        return *this;
+    }
+
+    /*!
+     * Append the line to the end of a string.
+     */
+    void appendTo(std::string& out) const
+    {
+        out.append(spilled_);
+        out.append(buffer_.data(), size_);
+    }
+
+    friend inline std::ostream& operator<<(std::ostream& out, const GCodeLineBuilder& line)
+    {
+        out.write(line.spilled_.data(), static_cast<std::streamsize>(line.spilled_.size()));
+        out.write(line.buffer_.data(), static_cast<std::streamsize>(line.size_));
+        return out;
+    }
+
+private:
+    std::array<char, 2 * double_max_chars> buffer_; //!< The end of the line.
+    size_t size_ = 0; //!< How much of the buffer is in use.
+    std::string spilled_; //!< The start of a line that didn't fit in the buffer.
+
+    //! Move what is in the buffer to \ref spilled_.
+    void spill()
+    {
+        spilled_.append(buffer_.data(), size_);
+        size_ = 0;
+    }
+
+    //! Make room for \p count characters in the buffer, and get where to write them.
+    char* reserve(const size_t count)
+    {
+        if (size_ + count > buffer_.size())
+        {
+            spill();
+        }
+        return buffer_.data() + size_;
+    }
+};
+
 /*!
  * Struct for writing a string to a stream in an escaped form
  */
@@ -0,0 +1,245 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <docopt/docopt.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "communication/CommandLine.h"
+#include "progress/Progress.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+
+constexpr std::string_view USAGE = R"(Slice Benchmark.
+
+Slices a set of reference models from start to end with fixed settings, and reports how long each stage of slicing takes
+with 1, 4 and 16 threads.
+
+The reference models are the ones that the tests slice. Larger models can be added with -l, or by putting them in a
+directory that is given with --models, for instance after fetching them.
+
+Usage:
+  slice_benchmark -j FILE -o FILE [-d PATHS] [-l MODEL]... [--models DIR] [-r COUNT] [-v]
+  slice_benchmark (-h | --help)
+  slice_benchmark --version
+
+Options:
+  -h --help                      Show this screen.
+  --version                      Show version.
+  -j FILE                        The definition of the printer to slice for, such as fdmprinter.def.json.
+  -d PATHS                       Where to look for the parents of the definition, as for CuraEngine.
+  -o FILE                        Specify the output Json file.
+  -l MODEL                       Slice this model as well.
+  --models DIR                   Slice all STL files in this directory as well.
+  -r COUNT                       How many times to slice each model with each thread count [default: 1].
+  -v                             Show the log of the slices.
+)";
+
+//! The thread counts to slice each model with.
+constexpr std::array<size_t, 3> THREAD_COUNTS{ 1, 4, 16 };
+
+//! The settings that each model is sliced with, on top of the defaults of the definition, so that every stage has work.
+constexpr std::array<std::string_view, 4> SETTINGS{ "support_enable=true", "support_type=everywhere", "infill_sparse_density=20", "adhesion_type=skirt" };
+
+//! The stages to report, in the order that they run.
+constexpr std::array<cura::Progress::Stage, 5> STAGES{
+    cura::Progress::Stage::SLICING, cura::Progress::Stage::PARTS, cura::Progress::Stage::INSET_SKIN, cura::Progress::Stage::SUPPORT, cura::Progress::Stage::EXPORT,
+};
+
+struct Measurement
+{
+    std::string model;
+    size_t thread_count;
+    std::array<cura::Progress::StageTime, cura::N_PROGRESS_STAGES> stage_times;
+    double total_time; //!< The wall time of the whole slice, including loading the definition and the model.
+};
+
+std::vector<std::filesystem::path> getModels(const std::map<std::string, docopt::value>& args)
+{
+    const auto tests_path = std::filesystem::path(std::source_location::current().file_name()).parent_path().parent_path().append("tests");
+    std::vector<std::filesystem::path> models{ tests_path / "testModel.stl", tests_path / "integration" / "resources" / "cylinder1000.stl" };
+
+    for (const std::string& model : args.at("-l").asStringList())
+    {
+        models.emplace_back(model);
+    }
+    if (args.at("--models"))
+    {
+        std::vector<std::filesystem::path> directory_models;
+        for (const auto& p : std::filesystem::directory_iterator(args.at("--models").asString()))
+        {
+            if (p.path().extension() == ".stl")
+            {
+                directory_models.push_back(p.path());
+            }
+        }
+        std::sort(directory_models.begin(), directory_models.end()); // The directory isn't listed in any particular order.
+        models.insert(models.end(), directory_models.begin(), directory_models.end());
+    }
+    return models;
+}
+
+/*!
+ * Slice a model the way that CuraEngine slice does, measuring how long each stage takes.
+ */
+Measurement slice(const std::map<std::string, docopt::value>& args, const std::filesystem::path& model, const size_t thread_count, const std::filesystem::path& gcode_file)
+{
+    std::vector<std::string> arguments{ "CuraEngine", "slice", fmt::format("-m{}", thread_count), "-j", args.at("-j").asString() };
+    if (args.at("-d"))
+    {
+        arguments.emplace_back("-d");
+        arguments.emplace_back(args.at("-d").asString());
+    }
+    for (const std::string_view setting : SETTINGS)
+    {
+        arguments.emplace_back("-s");
+        arguments.emplace_back(setting);
+    }
+    arguments.emplace_back("-o");
+    arguments.emplace_back(gcode_file.string());
+    arguments.emplace_back("-l");
+    arguments.emplace_back(model.string());
+
+    cura::CommandLine command_line(arguments);
+    cura::Application& application = cura::Application::getInstance();
+    application.communication_ = &command_line;
+    cura::Progress::resetStageTimes();
+
+    const auto start = std::chrono::steady_clock::now();
+    command_line.sliceNext();
+    const std::chrono::duration<double> total_time = std::chrono::steady_clock::now() - start;
+
+    application.communication_ = nullptr; // The command line only lived during this slice.
+    application.current_slice_ = nullptr; // The slice only lived during sliceNext.
+    return Measurement{ .model = model.stem().string(), .thread_count = thread_count, .stage_times = cura::Progress::getStageTimes(), .total_time = total_time.count() };
+}
+
+rapidjson::Value
+    createRapidJSONObject(rapidjson::Document::AllocatorType& allocator, const std::string& test_name, const auto value, const std::string& unit, const std::string& extra_info)
+{
+    rapidjson::Value obj(rapidjson::kObjectType);
+    rapidjson::Value key("name", allocator);
+    rapidjson::Value val1(test_name.c_str(), test_name.length(), allocator);
+    obj.AddMember(key, val1, allocator);
+    key.SetString("unit", allocator);
+    rapidjson::Value val2(unit.c_str(), unit.length(), allocator);
+    obj.AddMember(key, val2, allocator);
+    key.SetString("value", allocator);
+    rapidjson::Value val3(value);
+    obj.AddMember(key, val3, allocator);
+    key.SetString("extra", allocator);
+    rapidjson::Value val4(extra_info.c_str(), extra_info.length(), allocator);
+    obj.AddMember(key, val4, allocator);
+    return obj;
+}
+
+void createAndWriteJson(const std::filesystem::path& out_file, const std::vector<Measurement>& measurements)
+{
+    rapidjson::Document doc;
+    doc.SetArray();
+    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+    for (const Measurement& measurement : measurements)
+    {
+        const std::string prefix = fmt::format("{} with {} threads", measurement.model, measurement.thread_count);
+        for (const cura::Progress::Stage stage : STAGES)
+        {
+            const cura::Progress::StageTime& stage_time = measurement.stage_times.at(static_cast<size_t>(stage));
+            const std::string stage_name(cura::Progress::getStageName(stage));
+            auto wall_obj = createRapidJSONObject(allocator, fmt::format("{}: {} wall time", prefix, stage_name), stage_time.wall_time, "s", "");
+            doc.PushBack(wall_obj, allocator);
+            const std::string cpu_name = fmt::format("{}: {} CPU time", prefix, stage_name);
+            auto cpu_obj = createRapidJSONObject(allocator, cpu_name, stage_time.cpu_time, "s", "The processor time of all threads together.");
+            doc.PushBack(cpu_obj, allocator);
+            const std::string memory_name = fmt::format("{}: {} peak memory", prefix, stage_name);
+            const double peak_megabytes = static_cast<double>(stage_time.peak_resident_bytes) / (1024.0 * 1024.0);
+            auto memory_obj = createRapidJSONObject(allocator, memory_name, peak_megabytes, "MB", "The most memory that the process held during the stage.");
+            doc.PushBack(memory_obj, allocator);
+        }
+        auto total_obj = createRapidJSONObject(allocator, fmt::format("{}: total wall time", prefix), measurement.total_time, "s", "Including loading the settings and the model.");
+        doc.PushBack(total_obj, allocator);
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+
+    spdlog::info("Writing Json results: {}", std::filesystem::absolute(out_file).string());
+    std::ofstream file{ out_file };
+    if (! file)
+    {
+        spdlog::critical("Failed to open the file: {}", out_file.string());
+        exit(EXIT_FAILURE);
+    }
+    file.write(buffer.GetString(), buffer.GetSize());
+    file.close();
+}
+
+int main(int argc, const char** argv)
+{
+    constexpr bool show_help = true;
+    constexpr std::string_view version = "0.1.0";
+    const std::map<std::string, docopt::value> args = docopt::docopt(fmt::format("{}", USAGE), { argv + 1, argv + argc }, show_help, fmt::format("{}", version));
+
+    cura::Progress::init();
+    const auto log_level = args.at("-v").asBool() ? spdlog::level::info : spdlog::level::warn;
+    const auto repeat_count = static_cast<size_t>(args.at("-r").asLong());
+    const auto gcode_file = std::filesystem::temp_directory_path() / "slice_benchmark.gcode"; // Written like a real slice would, but thrown away.
+
+    std::vector<Measurement> measurements;
+    for (const auto& model : getModels(args))
+    {
+        for (const size_t thread_count : THREAD_COUNTS)
+        {
+            spdlog::set_level(spdlog::level::info);
+            spdlog::info("Slicing {} with {} threads", model.stem().string(), thread_count);
+            spdlog::set_level(log_level);
+
+            // Keep the average of the repeats, and the highest peak of memory.
+            Measurement average{ .model = model.stem().string(), .thread_count = thread_count, .stage_times = {}, .total_time = 0.0 };
+            for (size_t repeat = 0; repeat < repeat_count; repeat++)
+            {
+                const Measurement measurement = slice(args, model, thread_count, gcode_file);
+                for (size_t stage = 0; stage < cura::N_PROGRESS_STAGES; stage++)
+                {
+                    average.stage_times[stage].wall_time += measurement.stage_times[stage].wall_time / static_cast<double>(repeat_count);
+                    average.stage_times[stage].cpu_time += measurement.stage_times[stage].cpu_time / static_cast<double>(repeat_count);
+                    average.stage_times[stage].peak_resident_bytes = std::max(average.stage_times[stage].peak_resident_bytes, measurement.stage_times[stage].peak_resident_bytes);
+                }
+                average.total_time += measurement.total_time / static_cast<double>(repeat_count);
+            }
+            measurements.push_back(average);
+
+            spdlog::set_level(spdlog::level::info);
+            for (const cura::Progress::Stage stage : STAGES)
+            {
+                const cura::Progress::StageTime& stage_time = average.stage_times.at(static_cast<size_t>(stage));
+                spdlog::info(
+                    "  {:<12} {:8.3f}s wall {:8.3f}s CPU {:6} MB peak",
+                    cura::Progress::getStageName(stage),
+                    stage_time.wall_time,
+                    stage_time.cpu_time,
+                    stage_time.peak_resident_bytes / (1024 * 1024));
+            }
+            spdlog::info("  {:<12} {:8.3f}s wall", "total", average.total_time);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove(gcode_file, error);
+    createAndWriteJson(args.at("-o").asString(), measurements);
+    return EXIT_SUCCESS;
+}
@@ -3,10 +3,15 @@
 
 #include "Application.h"
 
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 
+#include <boost/system/system_error.hpp> //To report when the slice server can't listen.
 #include <boost/uuid/random_generator.hpp> //For generating a UUID.
 #include <boost/uuid/uuid_io.hpp> //For generating a UUID.
 #include <fmt/format.h>
@@ -18,9 +23,11 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include "BatchSlicer.h"
 #include "FffProcessor.h"
 #include "communication/ArcusCommunication.h" //To connect via Arcus to the front-end.
 #include "communication/CommandLine.h" //To use the command line to slice stuff.
+#include "communication/SliceServer.h" //To slice many jobs in the same process.
 #include "plugins/slots.h"
 #include "progress/Progress.h"
 #include "utils/ThreadPool.h"
@@ -73,6 +80,7 @@ void Application::connect()
     }
 
     int n_threads;
+    bool stream_layers = false;
 
     for (size_t argn = 3; argn < argc_; argn++)
     {
@@ -92,6 +100,9 @@ void Application::connect()
                     str--;
                     startThreadPool(n_threads);
                     break;
+                case 'l':
+                    stream_layers = true;
+                    break;
                 default:
                     spdlog::error("Unknown option: {}", str);
                     printCall();
@@ -103,11 +114,117 @@ void Application::connect()
     }
 
     ArcusCommunication* arcus_communication = new ArcusCommunication();
+    arcus_communication->setLayerStreaming(stream_layers);
     arcus_communication->connect(ip, port);
     communication_ = arcus_communication;
 }
 #endif // ARCUS
 
+void Application::serve()
+{
+    if (argc_ < 3)
+    {
+        spdlog::error("Missing the socket path to serve slice jobs on.");
+        printCall();
+        printHelp();
+        exit(1);
+    }
+
+    for (size_t argn = 3; argn < argc_; argn++)
+    {
+        char* str = argv_[argn];
+        if (str[0] == '-')
+        {
+            for (str++; *str; str++)
+            {
+                switch (*str)
+                {
+                case 'v':
+                    spdlog::set_level(spdlog::level::debug);
+                    break;
+                case 'm':
+                    str++;
+                    startThreadPool(std::strtol(str, &str, 10));
+                    str--;
+                    break;
+                default:
+                    spdlog::error("Unknown option: {}", str);
+                    printCall();
+                    printHelp();
+                    break;
+                }
+            }
+        }
+    }
+
+    try
+    {
+        communication_ = new SliceServer(argv_[2]);
+    }
+    catch (const boost::system::system_error& error)
+    {
+        spdlog::error("Failed to listen on {}: {}", argv_[2], error.what());
+        exit(1);
+    }
+}
+
+void Application::batch()
+{
+    if (argc_ < 3)
+    {
+        spdlog::error("Missing the manifest with the jobs to slice.");
+        printCall();
+        printHelp();
+        exit(1);
+    }
+
+    size_t max_concurrent_jobs = std::max(std::thread::hardware_concurrency() / 4, 1U);
+    size_t memory_budget = 0;
+    for (size_t argn = 3; argn < argc_; argn++)
+    {
+        char* str = argv_[argn];
+        if (str[0] == '-')
+        {
+            for (str++; *str; str++)
+            {
+                switch (*str)
+                {
+                case 'v':
+                    spdlog::set_level(spdlog::level::debug);
+                    break;
+                case 'c':
+                    str++;
+                    max_concurrent_jobs = std::strtoul(str, &str, 10);
+                    str--;
+                    break;
+                case 'b':
+                    str++;
+                    memory_budget = std::strtoul(str, &str, 10) * 1024 * 1024;
+                    str--;
+                    break;
+                default:
+                    spdlog::error("Unknown option: {}", str);
+                    printCall();
+                    printHelp();
+                    break;
+                }
+            }
+        }
+    }
+
+    const std::optional<std::vector<BatchSlicer::Job>> jobs = BatchSlicer::readManifest(argv_[2]);
+    if (! jobs)
+    {
+        spdlog::error("Failed to read the manifest {}", argv_[2]);
+        exit(1);
+    }
+    std::error_code error;
+    const std::string executable = std::filesystem::exists("/proc/self/exe", error) ? "/proc/self/exe" : argv_[0];
+    const size_t failed = BatchSlicer(executable, max_concurrent_jobs, memory_budget).run(*jobs);
+    spdlog::info("Sliced {} of {} jobs.", jobs->size() - failed, jobs->size());
+    exit(failed == 0 ? 0 : 1);
+}
+
 void Application::printCall() const
 {
     spdlog::error("Command called: {}", *argv_);
@@ -125,20 +242,39 @@ void Application::printHelp() const
     fmt::print("  --connect <host>[:<port>]\n\tConnect to <host> via a command socket, \n\tinstead of passing information via the command line\n");
     fmt::print("  -v\n\tIncrease the verbose level (show log messages).\n");
     fmt::print("  -m<thread_count>\n\tSet the desired number of threads. Supports only a single digit.\n");
+    fmt::print("  -l\n\tSend the layer view data of each layer as soon as it is done, \n\tinstead of all layers at the end of the slice.\n");
     fmt::print("\n");
 #endif // ARCUS
-    fmt::print("CuraEngine slice [-v] [-p] [-j <settings.json>] [-s <settingkey>=<value>] [-g] [-e<extruder_nr>] [-o <output.gcode>] [-l <model.stl>] [--next]\n");
+    fmt::print("CuraEngine serve <socket_path> [-v] [-m<thread_count>]\n");
+    fmt::print("\tKeep running and slice the jobs sent to a local socket, reusing the threads, definitions\n\tand sliced meshes of earlier jobs.\n");
+    fmt::print("\tEach job is the list of arguments that would follow `CuraEngine slice`, each terminated by\n\ta NUL character, and then an empty argument. The reply is OK or ERROR. An empty job stops the server.\n");
+    fmt::print("\n");
+    fmt::print("CuraEngine batch <manifest> [-v] [-c<job_count>] [-b<megabytes>]\n");
+    fmt::print("\tSlice all jobs in the manifest, several at a time. Each line of the manifest holds the arguments that would\n\tfollow `CuraEngine slice` for one job.\n");
+    fmt::print("  -c<job_count>\n\tSet how many jobs to slice at the same time. The cores are shared between them.\n");
+    fmt::print("  -b<megabytes>\n\tLimit the memory that each job may use. Jobs that need more fail.\n");
+    fmt::print("\n");
+    fmt::print("CuraEngine slice [-v] [-p] [-j <settings.json>] [-s <settingkey>=<value>] [-g] [-e<extruder_nr>] [-o <output.gcode>] [--toolpaths <directory>] "
+               "[--trace <trace.json>] [-l <model.stl>] [--next]\n");
     fmt::print("  -v\n\tIncrease the verbose level (show log messages).\n");
     fmt::print("  -m<thread_count>\n\tSet the desired number of threads.\n");
     fmt::print("  -p\n\tLog progress information.\n");
     fmt::print("  -d Add definition search paths seperated by a `:` (Unix) or `;` (Windows)\n");
     fmt::print("  -j\n\tLoad settings.def.json file to register all settings and their defaults.\n");
     fmt::print("  -s <setting>=<value>\n\tSet a setting to a value for the last supplied object, \n\textruder train, or general settings.\n");
-    fmt::print("  -l <model_file>\n\tLoad an STL model. \n");
+    fmt::print("  -l <model_file>\n\tLoad an STL model, or an indexed .cmesh model. \n");
     fmt::print("  -g\n\tSwitch setting focus to the current mesh group only.\n\tUsed for one-at-a-time printing.\n");
     fmt::print("  -e<extruder_nr>\n\tSwitch setting focus to the extruder train with the given number.\n");
     fmt::print("  --next\n\tGenerate gcode for the previously supplied mesh group and append that to \n\tthe gcode of further models for one-at-a-time printing.\n");
     fmt::print("  -o <output_file>\n\tSpecify a file to which to write the generated gcode.\n");
+    fmt::print("  --toolpaths <directory>\n\tAlso write the toolpaths of each layer to a directory, as flat binary arrays per field.\n");
+    fmt::print("  --trace <trace_file>\n\tRecord when the stages, parallel loops, the planning and writing of layers and the plugin calls run on each thread, and "
+               "write that to a file as a Chrome trace, which chrome://tracing or ui.perfetto.dev can show.\n");
+    fmt::print("  --estimate-only\n\tDon't generate any g-code, only estimate the print time and material, and write those to stdout as JSON.\n");
+    fmt::print("  --draft-estimate <layer_step>\n\tDon't slice, only make a quick draft estimate of the print time and material from the outlines of every so many layers, "
+               "and write those to stdout as JSON, like --estimate-only. Walls are plain offsets, infill is estimated from its area, and travel moves, support and "
+               "adhesion are left out.\n");
+    fmt::print("  --toolpaths-only\n\tDon't write the g-code, only the toolpaths. Put this after -o.\n");
     fmt::print("\n");
     fmt::print("The settings are appended to the last supplied object:\n");
     fmt::print("CuraEngine slice [general settings] \n\t-g [current group settings] \n\t-e0 [extruder train 0 settings] \n\t-l obj_inheriting_from_last_extruder_train.stl [object "
@@ -147,6 +283,30 @@ void Application::printHelp() const
     fmt::print("In order to load machine definitions from custom locations, you need to create the environment variable CURA_ENGINE_SEARCH_PATH, which should contain all search "
                "paths delimited by a (semi-)colon.\n");
     fmt::print("\n");
+    fmt::print("To skip parsing the same machine definitions on every run, set the environment variable CURA_ENGINE_DEFINITION_CACHE to a directory in which the "
+               "loaded definitions can be cached.\n");
+    fmt::print("\n");
+    fmt::print("To weigh the progress of the stages by how long they took on earlier slices for the same printer, and to log how long a slice is expected to take, set "
+               "the environment variable CURA_ENGINE_COST_MODEL to a directory in which those times can be kept.\n");
+    fmt::print("\n");
+    fmt::print("Layers that are planned wait in memory until the g-code of the layers below them is written. To change how much memory they may take up (1024 MB by "
+               "default), set the environment variable CURA_ENGINE_LAYER_BUFFER_MB to the number of megabytes, or to 0 to only limit their number.\n");
+    fmt::print("\n");
+    fmt::print("To keep a slice within a number of megabytes of memory, set the environment variable CURA_ENGINE_MEMORY_BUDGET_MB to it. Close to the budget, the "
+               "engine holds back the layer plans, drops the caches of earlier slices and runs on fewer threads. It doesn't fail when the slice needs more.\n");
+    fmt::print("\n");
+    fmt::print("To take the temporaries of the parallel tasks from thread arenas only in some stages of the slice, set the environment variable CURA_ENGINE_ARENA_STAGES to "
+               "their names, separated by commas (start, slice, layerparts, inset+skin, support, export, process), or to none. By default all stages use them.\n");
+    fmt::print("\n");
+    fmt::print("To draw the walls of each layer as an SVG file, set the environment variable CURA_ENGINE_DEBUG_SVG_DIR to the directory to write them to. Set "
+               "CURA_ENGINE_DEBUG_SVG_LAYERS to only draw some layers, such as 0,10-12. Only in builds with ENABLE_DEBUG_OUTPUT.\n");
+    fmt::print("\n");
+    fmt::print("To pin each thread to a CPU of its own, and keep the work on the same layers on the same NUMA node, set the environment variable "
+               "CURA_ENGINE_PIN_THREADS to 1.\n");
+    fmt::print("\n");
+    fmt::print("To log how long the tasks of the thread pool wait and run, how long each thread is idle and how well each parallel loop is balanced at the end of "
+               "every mesh group, set the environment variable CURA_ENGINE_THREAD_STATS to 1.\n");
+    fmt::print("\n");
 }
 
 void Application::printLicense() const
@@ -205,6 +365,14 @@ void Application::run(const size_t argc, char** argv)
         {
             slice();
         }
+        else if (stringcasecompare(argv[1], "serve") == 0)
+        {
+            serve();
+        }
+        else if (stringcasecompare(argv[1], "batch") == 0)
+        {
+            batch();
+        }
         else if (stringcasecompare(argv[1], "help") == 0)
         {
             printHelp();
@@ -247,12 +415,16 @@ void Application::startThreadPool(int nworkers)
     {
         nthreads = nworkers - 1; // Minus one for the main thread
     }
-    if (thread_pool_ && thread_pool_->thread_count() == nthreads)
+    const std::string pin_threads_value = spdlog::details::os::getenv("CURA_ENGINE_PIN_THREADS");
+    const bool pin_threads = ! pin_threads_value.empty() && pin_threads_value != "0";
+    const std::string thread_statistics_value = spdlog::details::os::getenv("CURA_ENGINE_THREAD_STATS");
+    const bool collect_statistics = ! thread_statistics_value.empty() && thread_statistics_value != "0";
+    if (thread_pool_ && thread_pool_->thread_count() == nthreads && thread_pool_->pinned() == pin_threads && (thread_pool_->statistics() != nullptr) == collect_statistics)
     {
         return; // Keep the previous ThreadPool
     }
     delete thread_pool_;
-    thread_pool_ = new ThreadPool(nthreads);
+    thread_pool_ = new ThreadPool(nthreads, pin_threads, collect_statistics);
 }
 
 } // namespace cura
@@ -0,0 +1,171 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "BatchSlicer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+BatchSlicer::BatchSlicer(std::string executable, const size_t max_concurrent_jobs, const size_t memory_budget)
+    : executable_(std::move(executable))
+    , max_concurrent_jobs_(std::max(max_concurrent_jobs, size_t(1)))
+    , memory_budget_(memory_budget)
+{
+}
+
+std::optional<std::vector<BatchSlicer::Job>> BatchSlicer::readManifest(const std::filesystem::path& manifest_path)
+{
+    std::ifstream manifest(manifest_path);
+    if (! manifest)
+    {
+        return std::nullopt;
+    }
+    std::vector<Job> jobs;
+    std::string line;
+    for (size_t line_nr = 1; std::getline(manifest, line); line_nr++)
+    {
+        std::vector<std::string> arguments = splitArguments(line);
+        if (arguments.empty() || arguments.front().starts_with('#'))
+        {
+            continue;
+        }
+        jobs.push_back({ line_nr, std::move(arguments) });
+    }
+    return jobs;
+}
+
+std::vector<std::string> BatchSlicer::splitArguments(std::string_view line)
+{
+    std::vector<std::string> arguments;
+    std::string argument;
+    bool in_argument = false;
+    bool in_quotes = false;
+    for (const char character : line)
+    {
+        if (character == '"')
+        {
+            in_quotes = ! in_quotes;
+            in_argument = true; // Even "" is an argument.
+        }
+        else if (! in_quotes && std::isspace(static_cast<unsigned char>(character)))
+        {
+            if (in_argument)
+            {
+                arguments.push_back(std::move(argument));
+                argument.clear();
+                in_argument = false;
+            }
+        }
+        else
+        {
+            argument.push_back(character);
+            in_argument = true;
+        }
+    }
+    if (in_argument)
+    {
+        arguments.push_back(std::move(argument));
+    }
+    return arguments;
+}
+
+#ifndef _WIN32
+size_t BatchSlicer::run(const std::vector<Job>& jobs) const
+{
+    // Share the cores between the jobs that run at the same time, so that they don't compete for them.
+    const size_t concurrent_jobs = std::min(max_concurrent_jobs_, jobs.size());
+    const size_t threads_per_job = std::max(size_t(std::thread::hardware_concurrency()) / std::max(concurrent_jobs, size_t(1)), size_t(1));
+    const std::string thread_argument = fmt::format("-m{}", threads_per_job);
+
+    std::unordered_map<pid_t, const Job*> running;
+    size_t failed = 0;
+    const auto wait_for_job = [&running, &failed]()
+    {
+        int status;
+        const pid_t pid = wait(&status);
+        const auto job = running.find(pid);
+        if (job == running.end())
+        {
+            return;
+        }
+        if (! WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            spdlog::error("The job on line {} of the manifest failed.", job->second->line_nr);
+            failed++;
+        }
+        else
+        {
+            spdlog::info("The job on line {} of the manifest is done.", job->second->line_nr);
+        }
+        running.erase(job);
+    };
+
+    for (const Job& job : jobs)
+    {
+        while (running.size() >= max_concurrent_jobs_)
+        {
+            wait_for_job();
+        }
+
+        // Build the argument list before forking, since the child may only do async-signal-safe calls.
+        std::vector<std::string> arguments{ executable_, "slice", thread_argument };
+        arguments.insert(arguments.end(), job.arguments.begin(), job.arguments.end());
+        std::vector<char*> argv;
+        for (std::string& argument : arguments)
+        {
+            argv.push_back(argument.data());
+        }
+        argv.push_back(nullptr);
+
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            if (memory_budget_ > 0)
+            {
+                const rlimit limit{ memory_budget_, memory_budget_ };
+                setrlimit(RLIMIT_AS, &limit);
+            }
+            execvp(executable_.c_str(), argv.data());
+            _exit(127); // Couldn't start the engine.
+        }
+        if (pid < 0)
+        {
+            spdlog::error("Failed to start the job on line {} of the manifest.", job.line_nr);
+            failed++;
+            continue;
+        }
+        spdlog::info("Started the job on line {} of the manifest.", job.line_nr);
+        running.emplace(pid, &job);
+    }
+    while (! running.empty())
+    {
+        wait_for_job();
+    }
+    return failed;
+}
+#else
+size_t BatchSlicer::run(const std::vector<Job>& jobs) const
+{
+    spdlog::error("Batch slicing is not supported on this platform.");
+    return jobs.size();
+}
+#endif
+
+} // namespace cura
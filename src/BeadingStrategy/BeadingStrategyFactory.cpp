@@ -3,10 +3,14 @@
 
 #include "BeadingStrategy/BeadingStrategyFactory.h"
 
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <tuple>
 
 #include <spdlog/spdlog.h>
 
+#include "BeadingStrategy/CachedBeadingStrategy.h"
 #include "BeadingStrategy/DistributedBeadingStrategy.h"
 #include "BeadingStrategy/LimitedBeadingStrategy.h"
 #include "BeadingStrategy/OuterWallInsetBeadingStrategy.h"
@@ -16,6 +20,41 @@
 namespace cura
 {
 
+namespace
+{
+
+//! All parameters of BeadingStrategyFactory::makeStrategy, which together determine the beadings of the strategy.
+using StrategyParameters = std::tuple<coord_t, coord_t, coord_t, double, bool, coord_t, coord_t, double, double, coord_t, coord_t, int, double>;
+
+/*!
+ * Gives the cache of the beadings of the strategy with these parameters, which is shared by all strategies with the
+ * same parameters. Each WallToolPaths makes its own strategy, but the parameters are the same for all layers and
+ * parts of a mesh, except for the initial layer.
+ */
+std::shared_ptr<BeadingCache> sharedBeadingCache(const StrategyParameters& parameters)
+{
+    constexpr size_t max_cache_count = 16; // A few for each extruder and type of walls.
+    static std::mutex mutex;
+    static std::deque<std::pair<StrategyParameters, std::shared_ptr<BeadingCache>>> caches;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [cache_parameters, cache] : caches)
+    {
+        if (cache_parameters == parameters)
+        {
+            return cache;
+        }
+    }
+    if (caches.size() >= max_cache_count)
+    {
+        caches.pop_front(); // Strategies that still use it keep it alive.
+    }
+    caches.emplace_back(parameters, std::make_shared<BeadingCache>());
+    return caches.back().second;
+}
+
+} // namespace
+
 BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(
     const coord_t preferred_bead_width_outer,
     const coord_t preferred_bead_width_inner,
@@ -57,6 +96,22 @@ BeadingStrategyPtr BeadingStrategyFactory::makeStrategy(
     // Apply the LimitedBeadingStrategy last, since that adds a 0-width marker wall which other beading strategies shouldn't touch.
     spdlog::debug("Applying the Limited Beading meta-strategy with maximum bead count = {}", max_bead_count);
     ret = make_unique<LimitedBeadingStrategy>(max_bead_count, move(ret));
+
+    // The same thicknesses come up for many nodes of the skeleton, and for the same outlines on many layers.
+    const StrategyParameters parameters{ preferred_bead_width_outer,
+                                         preferred_bead_width_inner,
+                                         preferred_transition_length,
+                                         transitioning_angle,
+                                         print_thin_walls,
+                                         min_bead_width,
+                                         min_feature_size,
+                                         wall_split_middle_threshold,
+                                         wall_add_middle_threshold,
+                                         max_bead_count,
+                                         outer_wall_offset,
+                                         inward_distributed_center_wall_count,
+                                         minimum_variable_line_ratio };
+    ret = make_unique<CachedBeadingStrategy>(move(ret), sharedBeadingCache(parameters));
     return ret;
 }
 } // namespace cura
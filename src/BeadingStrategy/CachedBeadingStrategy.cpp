@@ -0,0 +1,125 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "BeadingStrategy/CachedBeadingStrategy.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace cura
+{
+
+BeadingCache::BeadingCache(const size_t slot_count)
+    : slots_(std::bit_ceil(std::max(slot_count, probe_count)))
+{
+}
+
+BeadingCache::~BeadingCache()
+{
+    for (std::atomic<const Entry*>& slot : slots_)
+    {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+size_t BeadingCache::firstSlot(const coord_t thickness, const coord_t bead_count) const
+{
+    uint64_t hash = (static_cast<uint64_t>(thickness) * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(bead_count) * 0xC2B2AE3D27D4EB4FULL);
+    hash ^= hash >> 32;
+    return static_cast<size_t>(hash) & (slots_.size() - 1);
+}
+
+const BeadingStrategy::Beading* BeadingCache::find(const coord_t thickness, const coord_t bead_count) const
+{
+    const size_t first_slot = firstSlot(thickness, bead_count);
+    for (size_t probe = 0; probe < probe_count; probe++)
+    {
+        const Entry* entry = slots_[(first_slot + probe) & (slots_.size() - 1)].load(std::memory_order_acquire);
+        if (entry == nullptr)
+        {
+            return nullptr; // Slots are filled in order, so it can't be in any of the next ones.
+        }
+        if (entry->thickness == thickness && entry->bead_count == bead_count)
+        {
+            return &entry->beading;
+        }
+    }
+    return nullptr;
+}
+
+void BeadingCache::insert(const coord_t thickness, const coord_t bead_count, const BeadingStrategy::Beading& beading)
+{
+    const Entry* new_entry = new Entry{ thickness, bead_count, beading };
+    const size_t first_slot = firstSlot(thickness, bead_count);
+    for (size_t probe = 0; probe < probe_count; probe++)
+    {
+        std::atomic<const Entry*>& slot = slots_[(first_slot + probe) & (slots_.size() - 1)];
+        const Entry* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, new_entry, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return;
+        }
+        if (expected->thickness == thickness && expected->bead_count == bead_count)
+        {
+            break; // Another thread remembered the same beading first.
+        }
+    }
+    delete new_entry;
+}
+
+CachedBeadingStrategy::CachedBeadingStrategy(BeadingStrategyPtr parent, std::shared_ptr<BeadingCache> cache)
+    : BeadingStrategy(*parent)
+    , parent_(std::move(parent))
+    , cache_(std::move(cache))
+{
+    name_ = "CachedBeadingStrategy";
+}
+
+BeadingStrategy::Beading CachedBeadingStrategy::compute(coord_t thickness, coord_t bead_count) const
+{
+    if (const Beading* cached = cache_->find(thickness, bead_count))
+    {
+        return *cached;
+    }
+    Beading ret = parent_->compute(thickness, bead_count);
+    cache_->insert(thickness, bead_count, ret);
+    return ret;
+}
+
+coord_t CachedBeadingStrategy::getOptimalThickness(coord_t bead_count) const
+{
+    return parent_->getOptimalThickness(bead_count);
+}
+
+coord_t CachedBeadingStrategy::getTransitionThickness(coord_t lower_bead_count) const
+{
+    return parent_->getTransitionThickness(lower_bead_count);
+}
+
+coord_t CachedBeadingStrategy::getOptimalBeadCount(coord_t thickness) const
+{
+    return parent_->getOptimalBeadCount(thickness);
+}
+
+coord_t CachedBeadingStrategy::getTransitioningLength(coord_t lower_bead_count) const
+{
+    return parent_->getTransitioningLength(lower_bead_count);
+}
+
+double CachedBeadingStrategy::getTransitionAnchorPos(coord_t lower_bead_count) const
+{
+    return parent_->getTransitionAnchorPos(lower_bead_count);
+}
+
+std::vector<coord_t> CachedBeadingStrategy::getNonlinearThicknesses(coord_t lower_bead_count) const
+{
+    return parent_->getNonlinearThicknesses(lower_bead_count);
+}
+
+std::string CachedBeadingStrategy::toString() const
+{
+    return std::string("CachedBeadingStrategy+") + parent_->toString();
+}
+
+} // namespace cura
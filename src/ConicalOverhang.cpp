@@ -4,11 +4,16 @@
 
 #include "ConicalOverhang.h"
 
+#include <utility>
+#include <vector>
+
 #include "mesh.h"
 #include "settings/types/Angle.h" //To process the overhang angle.
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
+#include "utils/AABB.h"
 #include "utils/Simplify.h" //Simplifying at every step to prevent getting lots of vertices from all the insets.
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -21,58 +26,90 @@ void ConicalOverhang::apply(Slicer* slicer, const Mesh& mesh)
     const coord_t layer_thickness = mesh.settings_.get<coord_t>("layer_height");
     coord_t max_dist_from_lower_layer = std::llround(tan_angle * static_cast<double>(layer_thickness)); // max dist which can be bridged
 
-    for (LayerIndex layer_nr = slicer->layers.size() - 2; static_cast<int>(layer_nr) >= 0; layer_nr--)
+    if (slicer->layers.size() < 2)
     {
-        SlicerLayer& layer = slicer->layers[static_cast<size_t>(layer_nr)];
-        SlicerLayer& layer_above = slicer->layers[static_cast<size_t>(layer_nr) + 1ul];
-        if (std::abs(max_dist_from_lower_layer) < 5)
-        { // magically nothing happens when max_dist_from_lower_layer == 0
-            // below magic code solves that
-            constexpr coord_t safe_dist = 20;
-            Polygons diff = layer_above.polygons.difference(layer.polygons.offset(-safe_dist));
+        return;
+    }
+    const size_t layer_count = slicer->layers.size() - 1; // The top layer is never changed.
+
+    // Each layer is only changed by the (changed) layer above it, so that part has to go from the top down. Everything that
+    // only depends on the original slice of a layer is computed for all layers in parallel beforehand.
+    if (std::abs(max_dist_from_lower_layer) < 5)
+    { // magically nothing happens when max_dist_from_lower_layer == 0
+        // below magic code solves that
+        constexpr coord_t safe_dist = 20;
+        std::vector<Polygons> shrunk_layers(layer_count);
+        cura::parallel_for<size_t>(
+            0,
+            layer_count,
+            [&](const size_t layer_nr)
+            {
+                shrunk_layers[layer_nr] = slicer->layers[layer_nr].polygons.offset(-safe_dist);
+            });
+        for (LayerIndex layer_nr = layer_count - 1; static_cast<int>(layer_nr) >= 0; layer_nr--)
+        {
+            SlicerLayer& layer = slicer->layers[static_cast<size_t>(layer_nr)];
+            const SlicerLayer& layer_above = slicer->layers[static_cast<size_t>(layer_nr) + 1ul];
+            Polygons diff = layer_above.polygons.difference(shrunk_layers[layer_nr]);
             layer.polygons = layer.polygons.unionPolygons(diff);
             layer.polygons = layer.polygons.smooth(safe_dist);
             layer.polygons = Simplify(safe_dist, safe_dist / 2, 0).polygon(layer.polygons);
             // somehow layer.polygons get really jagged lines with a lot of vertices
             // without the above steps slicing goes really slow
         }
-        else
-        {
-            // Get the current layer and split it into parts
-            std::vector<PolygonsPart> layerParts = layer.polygons.splitIntoParts();
-            // Get a copy of the layer above to prune away before we shrink it
-            Polygons above = layer_above.polygons;
+        return;
+    }
 
-            // Now go through all the holes in the current layer and check if they intersect anything in the layer above
-            // If not, then they're the top of a hole and should be cut from the layer above before the union
-            for (unsigned int part = 0; part < layerParts.size(); part++)
+    // Only the small holes of a layer can be cut from the layer above, so find those first.
+    std::vector<std::vector<std::pair<Polygons, AABB>>> small_holes_per_layer(layer_count);
+    if (maxHoleArea > 0.0)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            layer_count,
+            [&](const size_t layer_nr)
             {
-                if (layerParts[part].size() > 1) // first poly is the outer contour, 1..n are the holes
+                // Get the current layer and split it into parts
+                for (const PolygonsPart& part : slicer->layers[layer_nr].polygons.splitIntoParts())
                 {
-                    for (unsigned int hole_nr = 1; hole_nr < layerParts[part].size(); ++hole_nr)
+                    for (unsigned int hole_nr = 1; hole_nr < part.size(); ++hole_nr) // first poly is the outer contour, 1..n are the holes
                     {
                         Polygons holePoly;
-                        holePoly.add(layerParts[part][hole_nr]);
-                        if (maxHoleArea > 0.0 && INT2MM2(std::abs(holePoly.area())) < maxHoleArea)
+                        holePoly.add(part[hole_nr]);
+                        if (INT2MM2(std::abs(holePoly.area())) < maxHoleArea)
                         {
-                            Polygons holeWithAbove = holePoly.intersection(above);
-                            if (! holeWithAbove.empty())
-                            {
-                                // The hole had some intersection with the above layer, check if it's a complete overlap
-                                Polygons holeDifference = holePoly.xorPolygons(holeWithAbove);
-                                if (holeDifference.empty())
-                                {
-                                    // The hole was returned unchanged, so the layer above must completely cover it.  Remove the hole from the layer above.
-                                    above = above.difference(holePoly);
-                                }
-                            }
+                            const AABB hole_box(holePoly);
+                            small_holes_per_layer[layer_nr].emplace_back(std::move(holePoly), hole_box);
                         }
                     }
                 }
+            });
+    }
+
+    for (LayerIndex layer_nr = layer_count - 1; static_cast<int>(layer_nr) >= 0; layer_nr--)
+    {
+        SlicerLayer& layer = slicer->layers[static_cast<size_t>(layer_nr)];
+        const SlicerLayer& layer_above = slicer->layers[static_cast<size_t>(layer_nr) + 1ul];
+        // Get a copy of the layer above to prune away before we shrink it
+        Polygons above = layer_above.polygons;
+        const AABB above_box(above);
+
+        // Now go through all the holes in the current layer and check if they intersect anything in the layer above
+        // If not, then they're the top of a hole and should be cut from the layer above before the union
+        for (const auto& [holePoly, hole_box] : small_holes_per_layer[layer_nr])
+        {
+            if (! above_box.contains(hole_box))
+            { // The layer above can't cover the hole completely.
+                continue;
+            }
+            if (holePoly.difference(above).empty())
+            {
+                // The layer above completely covers the hole.  Remove the hole from the layer above.
+                above = above.difference(holePoly);
             }
-            // And now union with offset of the resulting above layer
-            layer.polygons = layer.polygons.unionPolygons(above.offset(-max_dist_from_lower_layer));
         }
+        // And now union with offset of the resulting above layer
+        layer.polygons = layer.polygons.unionPolygons(above.offset(-max_dist_from_lower_layer));
     }
 }
 
@@ -0,0 +1,242 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "DraftEstimator.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <spdlog/spdlog.h>
+
+#include "ExtruderTrain.h"
+#include "MeshGroup.h"
+#include "PrintFeature.h"
+#include "settings/types/Ratio.h"
+#include "settings/types/Velocity.h"
+#include "slicer.h"
+#include "utils/ThreadPool.h"
+#include "utils/math.h"
+
+namespace cura
+{
+
+namespace
+{
+
+//! The estimates of one layer.
+struct LayerEstimate
+{
+    std::vector<Duration> print_time_per_feature = std::vector<Duration>(static_cast<size_t>(PrintFeatureType::NumPrintFeatureTypes), 0.0);
+    std::array<double, MAX_EXTRUDERS> material_used{};
+
+    /*!
+     * Add lines to the estimate.
+     * \param feature What the lines print.
+     * \param extruder_nr The extruder that prints them.
+     * \param length The length of the lines in mm.
+     * \param width The width of the lines.
+     * \param thickness The thickness of the layer.
+     * \param speed The speed at which they are printed.
+     */
+    void add(const PrintFeatureType feature, const size_t extruder_nr, const double length, const coord_t width, const coord_t thickness, const Velocity& speed)
+    {
+        if (length <= 0.0 || speed <= 0.0)
+        {
+            return;
+        }
+        print_time_per_feature[static_cast<size_t>(feature)] += length / speed;
+        material_used[extruder_nr] += length * INT2MM(width) * INT2MM(thickness);
+    }
+
+    Duration getPrintTime() const
+    {
+        Duration print_time = 0.0;
+        for (const Duration& feature_time : print_time_per_feature)
+        {
+            print_time += feature_time;
+        }
+        return print_time;
+    }
+};
+
+/*!
+ * Estimate the walls, skin and infill of a mesh on a layer.
+ * \param slicer The sliced layers of the mesh.
+ * \param layer_nr The layer to estimate.
+ * \param thickness The thickness of the layer.
+ * \param estimate Where to add the estimate to.
+ */
+void estimateMeshLayer(const Slicer& slicer, const size_t layer_nr, const coord_t thickness, LayerEstimate& estimate)
+{
+    if (layer_nr >= slicer.layers.size() || slicer.layers[layer_nr].polygons.empty())
+    {
+        return;
+    }
+    const Settings& settings = slicer.mesh->settings_;
+    const Ratio width_factor = layer_nr == 0 ? settings.get<Ratio>(SettingKey::initial_layer_line_width_factor) : Ratio(1.0);
+    const auto speed = [&settings, layer_nr](const SettingKey speed_key)
+    {
+        return settings.get<Velocity>(layer_nr == 0 ? SettingKey::speed_print_layer_0 : speed_key);
+    };
+
+    // The walls are the classic offsets of the outline, each half a line width inside the one before.
+    Polygons inner_area = slicer.layers[layer_nr].polygons;
+    const size_t wall_count = settings.get<size_t>(SettingKey::wall_line_count);
+    for (size_t wall_idx = 0; wall_idx < wall_count && ! inner_area.empty(); wall_idx++)
+    {
+        const bool is_outer_wall = wall_idx == 0;
+        const coord_t width = settings.get<coord_t>(is_outer_wall ? SettingKey::wall_line_width_0 : SettingKey::wall_line_width_x) * width_factor;
+        const Polygons wall = inner_area.offset(-width / 2);
+        estimate.add(
+            is_outer_wall ? PrintFeatureType::OuterWall : PrintFeatureType::InnerWall,
+            settings.get<ExtruderTrain&>(is_outer_wall ? SettingKey::wall_0_extruder_nr : SettingKey::wall_x_extruder_nr).extruder_nr_,
+            INT2MM(wall.polygonLength()),
+            width,
+            thickness,
+            speed(is_outer_wall ? SettingKey::speed_wall_0 : SettingKey::speed_wall_x));
+        inner_area = wall.offset(-width / 2);
+    }
+    if (inner_area.empty())
+    {
+        return;
+    }
+
+    // What the layers as far above and below as the top and bottom skin reach cover is infill, the rest is skin.
+    const size_t top_layers = settings.get<size_t>(SettingKey::top_layers);
+    const size_t bottom_layers = settings.get<size_t>(SettingKey::bottom_layers);
+    Polygons infill_area;
+    if (layer_nr + top_layers < slicer.layers.size() && layer_nr >= bottom_layers)
+    {
+        infill_area = inner_area.intersection(slicer.layers[layer_nr + top_layers].polygons).intersection(slicer.layers[layer_nr - bottom_layers].polygons);
+    }
+    const double inner_area_mm2 = INT2MM2(inner_area.area());
+    const double infill_area_mm2 = INT2MM2(infill_area.area());
+
+    const coord_t skin_width = settings.get<coord_t>(SettingKey::skin_line_width) * width_factor;
+    estimate.add(
+        PrintFeatureType::Skin,
+        settings.get<ExtruderTrain&>(SettingKey::top_bottom_extruder_nr).extruder_nr_,
+        (inner_area_mm2 - infill_area_mm2) / INT2MM(skin_width),
+        skin_width,
+        thickness,
+        speed(SettingKey::speed_topbottom));
+
+    const coord_t infill_line_distance = settings.get<coord_t>(SettingKey::infill_line_distance);
+    if (infill_line_distance > 0)
+    {
+        estimate.add(
+            PrintFeatureType::Infill,
+            settings.get<ExtruderTrain&>(SettingKey::infill_extruder_nr).extruder_nr_,
+            infill_area_mm2 / INT2MM(infill_line_distance),
+            settings.get<coord_t>(SettingKey::infill_line_width) * width_factor,
+            thickness,
+            speed(SettingKey::speed_infill));
+    }
+}
+
+} // namespace
+
+DraftEstimator::DraftEstimator(const size_t layer_step)
+    : layer_step_(std::max(size_t(1), layer_step))
+    , print_time_per_feature_(static_cast<size_t>(PrintFeatureType::NumPrintFeatureTypes), 0.0)
+{
+}
+
+void DraftEstimator::estimate(MeshGroup& mesh_group)
+{
+    const Settings& mesh_group_settings = mesh_group.settings;
+    const coord_t layer_height = mesh_group_settings.get<coord_t>(SettingKey::layer_height);
+    const coord_t layer_height_0 = mesh_group_settings.get<coord_t>(SettingKey::layer_height_0);
+    if (layer_height <= 0 || layer_height_0 <= 0)
+    {
+        spdlog::error("Layer height {} or initial layer height {} is disallowed.", layer_height, layer_height_0);
+        return;
+    }
+
+    // Slice the printed meshes into the same layers, rounding the number of layers as the middle slicing tolerance does.
+    std::vector<std::unique_ptr<Slicer>> slicers;
+    size_t layer_count = 0;
+    for (Mesh& mesh : mesh_group.meshes)
+    {
+        if (! mesh.isPrinted() || mesh.settings_.get<bool>(SettingKey::support_mesh) || mesh.max().z_ <= layer_height_0 / 2)
+        {
+            continue;
+        }
+        const size_t mesh_layer_count = static_cast<size_t>(std::max(int64_t(0), round_divide_signed(mesh.max().z_ - layer_height_0, layer_height))) + 1;
+        slicers.push_back(std::make_unique<Slicer>(&mesh, layer_height, mesh_layer_count, false, nullptr));
+        layer_count = std::max(layer_count, mesh_layer_count);
+    }
+
+    const std::vector<std::pair<size_t, double>> samples = getSampleWeights(layer_count, layer_step_);
+    std::vector<LayerEstimate> sample_estimates(samples.size());
+    cura::parallel_for<size_t>(
+        0,
+        samples.size(),
+        [&](const size_t sample_idx)
+        {
+            const size_t layer_nr = samples[sample_idx].first;
+            for (const std::unique_ptr<Slicer>& slicer : slicers)
+            {
+                estimateMeshLayer(*slicer, layer_nr, layer_nr == 0 ? layer_height_0 : layer_height, sample_estimates[sample_idx]);
+            }
+        });
+
+    // Layers that are printed quicker than the minimum layer time are slowed down to it.
+    const Duration min_layer_time = mesh_group_settings.get<Duration>(SettingKey::cool_min_layer_time);
+    for (size_t sample_idx = 0; sample_idx < samples.size(); sample_idx++)
+    {
+        const LayerEstimate& estimate = sample_estimates[sample_idx];
+        const double weight = samples[sample_idx].second;
+        const Duration print_time = estimate.getPrintTime();
+        const double slowdown = print_time > 0.0 && print_time < min_layer_time ? min_layer_time / print_time : 1.0;
+        for (size_t feature_idx = 0; feature_idx < print_time_per_feature_.size(); feature_idx++)
+        {
+            print_time_per_feature_[feature_idx] += estimate.print_time_per_feature[feature_idx] * slowdown * weight;
+        }
+        for (size_t extruder_nr = 0; extruder_nr < MAX_EXTRUDERS; extruder_nr++)
+        {
+            material_used_[extruder_nr] += estimate.material_used[extruder_nr] * weight;
+        }
+    }
+    spdlog::info("Made a draft estimate from {} of the {} layers.", samples.size(), layer_count);
+}
+
+const std::vector<Duration>& DraftEstimator::getPrintTimePerFeature() const
+{
+    return print_time_per_feature_;
+}
+
+double DraftEstimator::getMaterialUsed(const size_t extruder_nr) const
+{
+    return extruder_nr < MAX_EXTRUDERS ? material_used_[extruder_nr] : 0.0;
+}
+
+std::vector<std::pair<size_t, double>> DraftEstimator::getSampleWeights(const size_t layer_count, const size_t layer_step)
+{
+    std::vector<std::pair<size_t, double>> samples;
+    if (layer_count == 0)
+    {
+        return samples;
+    }
+    samples.emplace_back(0, 0.0);
+    for (size_t layer_nr = 1; layer_nr < layer_count; layer_nr += std::max(size_t(1), layer_step))
+    {
+        samples.emplace_back(layer_nr, 0.0);
+    }
+    if (samples.back().first != layer_count - 1)
+    {
+        samples.emplace_back(layer_count - 1, 0.0);
+    }
+
+    // Interpolating linearly between two samples, the layers from the first up to the second sum up to these parts of them.
+    for (size_t sample_idx = 0; sample_idx + 1 < samples.size(); sample_idx++)
+    {
+        const double span = static_cast<double>(samples[sample_idx + 1].first - samples[sample_idx].first);
+        samples[sample_idx].second += (span + 1.0) / 2.0;
+        samples[sample_idx + 1].second += (span - 1.0) / 2.0;
+    }
+    samples.back().second += 1.0; // The last layer itself.
+    return samples;
+}
+
+} // namespace cura
@@ -4,6 +4,8 @@
 #include "FffGcodeWriter.h"
 
 #include <algorithm>
+#include <bit> // bit_cast
+#include <cstdlib> // strtoull
 #include <limits> // numeric_limits
 #include <list>
 #include <memory>
@@ -28,8 +30,12 @@
 #include "bridge.h"
 #include "communication/Communication.h" //To send layer view data.
 #include "infill.h"
+#include "progress/PrintEstimateExtrapolator.h"
 #include "progress/Progress.h"
 #include "raft.h"
+#include "utils/Cancellation.h"
+#include "utils/DebugOutput.h"
+#include "utils/MemoryBudget.h"
 #include "utils/Simplify.h" //Removing micro-segments created by offsetting.
 #include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h"
@@ -53,6 +59,22 @@ FffGcodeWriter::FffGcodeWriter()
 void FffGcodeWriter::setTargetStream(std::ostream* stream)
 {
     gcode.setOutputStream(stream);
+    gcode.setFileHeaderPatchable(false); // Only the file of setTargetFile can be written over.
+}
+
+bool FffGcodeWriter::setToolpathDirectory(const std::filesystem::path& directory)
+{
+    return gcode.getToolpathExport().open(directory);
+}
+
+void FffGcodeWriter::disableOutput()
+{
+    gcode.disableOutput();
+}
+
+void FffGcodeWriter::flushTargetStream()
+{
+    gcode.flushOutput();
 }
 
 double FffGcodeWriter::getTotalFilamentUsed(int extruder_nr)
@@ -67,16 +89,57 @@ std::vector<Duration> FffGcodeWriter::getTotalPrintTimePerFeature()
 
 bool FffGcodeWriter::setTargetFile(const char* filename)
 {
-    output_file.open(filename);
-    if (output_file.is_open())
+    if (output_file_sink.open(filename))
     {
         gcode.setOutputStream(&output_file);
+        gcode.setFileHeaderPatchable(true); // The header with the final values is written over the estimated one at the end.
         return true;
     }
     return false;
 }
 
-void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keeper)
+/*!
+ * \brief Get how long to spend at most on shortening the travel moves between the lines of a feature.
+ *
+ * These settings are optional. Without them, the lines are only ordered greedily.
+ */
+static Duration getTravelImprovementTime(const Settings& settings, const std::string& key)
+{
+    return settings.has(key) ? settings.get<Duration>(key) : Duration(0);
+}
+
+/*!
+ * \brief Find how many layers below a layer its support may still be looked at while planning that layer.
+ *
+ * Skins look at the support at the top distance below them, and up to two layers further down, to find bridges and to
+ * change the fan speed above support.
+ */
+static LayerIndex findSupportLayersLookedBack(const SliceDataStorage& storage)
+{
+    LayerIndex looked_back = 0;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+    {
+        // The top distance is converted to layers with the thickness of the layer being planned, so the thinnest layer looks back furthest.
+        coord_t min_layer_thickness = std::numeric_limits<coord_t>::max();
+        for (const SliceLayer& layer : mesh->layers)
+        {
+            if (layer.thickness > 0)
+            {
+                min_layer_thickness = std::min(min_layer_thickness, layer.thickness);
+            }
+        }
+        if (min_layer_thickness == std::numeric_limits<coord_t>::max())
+        {
+            continue;
+        }
+        constexpr LayerIndex bridge_layers_below = 2;
+        const LayerIndex z_distance_top_layers = mesh->settings.get<coord_t>(SettingKey::support_top_distance) / min_layer_thickness + 1;
+        looked_back = std::max(looked_back, z_distance_top_layers + bridge_layers_below);
+    }
+    return looked_back;
+}
+
+void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keeper, const bool keep_storage)
 {
     const size_t start_extruder_nr = getStartExtruder(storage);
     gcode.preSetup(start_extruder_nr);
@@ -143,24 +206,24 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
     const auto extruder_settings = Application::getInstance().current_slice_->scene.extruders[gcode.getExtruderNr()].settings_;
     // in case the prime blob is enabled the brim already starts from the closest start position which is blob location
     // also in case of one at a time printing the first move of every object shouldn't be start position of machine
-    if (! extruder_settings.get<bool>("prime_blob_enable") and ! (extruder_settings.get<std::string>("print_sequence") == "one_at_a_time"))
+    if (! extruder_settings.get<bool>(SettingKey::prime_blob_enable) and ! (extruder_settings.get<std::string>(SettingKey::print_sequence) == "one_at_a_time"))
     {
         // Setting first travel move of the first extruder to the machine start position
-        Point3LL p(extruder_settings.get<coord_t>("machine_extruder_start_pos_x"), extruder_settings.get<coord_t>("machine_extruder_start_pos_y"), gcode.getPositionZ());
-        gcode.writeTravel(p, extruder_settings.get<Velocity>("speed_travel"));
+        Point3LL p(extruder_settings.get<coord_t>(SettingKey::machine_extruder_start_pos_x), extruder_settings.get<coord_t>(SettingKey::machine_extruder_start_pos_y), gcode.getPositionZ());
+        gcode.writeTravel(p, extruder_settings.get<Velocity>(SettingKey::speed_travel));
     }
 
 
     calculateExtruderOrderPerLayer(storage);
     calculatePrimeLayerPerExtruder(storage);
 
-    if (scene.current_mesh_group->settings.get<bool>("magic_spiralize"))
+    if (scene.current_mesh_group->settings.get<bool>(SettingKey::magic_spiralize))
     {
         findLayerSeamsForSpiralize(storage, total_layers);
     }
 
     int process_layer_starting_layer_nr = 0;
-    const bool has_raft = scene.current_mesh_group->settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::RAFT;
+    const bool has_raft = scene.current_mesh_group->settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::RAFT;
     if (has_raft)
     {
         processRaft(storage);
@@ -176,19 +239,124 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
         }
     }
 
-    run_multiple_producers_ordered_consumer(
-        process_layer_starting_layer_nr,
-        total_layers,
-        [&storage, total_layers, this](int layer_nr)
-        {
-            return std::make_optional(processLayer(storage, layer_nr, total_layers));
-        },
-        [this, total_layers](std::optional<ProcessLayerResult> result_opt)
+    base_path_configs.emplace(storage, PathConfigStorage::getFirstFullSpeedLayer(), scene.current_mesh_group->settings.get<coord_t>(SettingKey::layer_height));
+
+    // Layer plans of dense multi-extruder prints can take up a lot of memory, so their number is limited by their size.
+    // With a memory budget, they may take up a part of it at most.
+    constexpr size_t memory_budget_divisor_for_layer_plans = 8;
+    size_t max_pending_layer_plan_bytes = size_t(1024) * 1024 * 1024;
+    if (const size_t budget_bytes = MemoryBudget::getBudgetBytes(); budget_bytes != 0)
+    {
+        max_pending_layer_plan_bytes = std::min(max_pending_layer_plan_bytes, budget_bytes / memory_budget_divisor_for_layer_plans);
+    }
+    if (const auto buffer_megabytes = spdlog::details::os::getenv("CURA_ENGINE_LAYER_BUFFER_MB"); ! buffer_megabytes.empty())
+    {
+        max_pending_layer_plan_bytes = std::strtoull(buffer_megabytes.c_str(), nullptr, 10) * 1024 * 1024;
+    }
+
+    // Once a layer is written, the support of the layers that no later layer looks at anymore can be freed, unless the storage is kept.
+    const LayerIndex support_layers_looked_back = findSupportLayersLookedBack(storage);
+    size_t released_support_bytes = 0;
+
+    // The same goes for the meshes. A layer looks at the outlines of the layer below it for overhanging walls, at the
+    // previous spiralized wall, and at up to three layers below its skin for bridges. Skin and infill windows were
+    // already applied while generating the areas, and only look further up while planning.
+    constexpr LayerIndex mesh_layers_looked_back = 3;
+    size_t released_mesh_bytes = 0;
+
+    // While the layers are written, the totals of the g-code so far are extrapolated to the whole print for the front-end.
+    const size_t extruder_count = scene.extruders.size();
+    const auto get_written_totals = [this, extruder_count]()
+    {
+        PrintEstimates totals{ .print_time_per_feature = gcode.getTotalPrintTimePerFeature(), .material_per_extruder = std::vector<double>(extruder_count) };
+        for (size_t extruder_nr = 0; extruder_nr < extruder_count; extruder_nr++)
         {
-            const ProcessLayerResult& result = result_opt.value();
-            Progress::messageProgressLayer(result.layer_plan->getLayerNr(), total_layers, result.total_elapsed_time, result.stages_times);
-            layer_plan_buffer.handle(*result.layer_plan, gcode);
-        });
+            totals.material_per_extruder[extruder_nr] = gcode.getTotalFilamentUsed(extruder_nr);
+        }
+        return totals;
+    };
+    const PrintEstimateExtrapolator estimate_extrapolator(PrintEstimateExtrapolator::getLayerAreas(storage, total_layers), get_written_totals());
+
+    OrderedConsumerStatistics buffer_statistics;
+    try
+    {
+        buffer_statistics = run_multiple_producers_ordered_consumer(
+            process_layer_starting_layer_nr,
+            total_layers,
+            [&storage, total_layers, keep_storage, this](int layer_nr)
+            {
+                std::optional<ProcessLayerResult> result = processLayer(storage, layer_nr, total_layers);
+                if (! keep_storage)
+                {
+                    storage.releaseInfillAreaPerCombinePerDensity(layer_nr); // Only the layer itself reads them.
+                }
+                return result;
+            },
+            [this,
+             total_layers,
+             &storage,
+             keep_storage,
+             support_layers_looked_back,
+             &released_support_bytes,
+             &released_mesh_bytes,
+             &estimate_extrapolator,
+             &get_written_totals](std::optional<ProcessLayerResult> result_opt)
+            {
+                ProcessLayerResult& result = result_opt.value();
+                const LayerIndex layer_nr = result.layer_plan->getLayerNr();
+                Progress::messageProgressLayer(layer_nr, total_layers, result.total_elapsed_time, result.stages_times);
+                if (const std::optional<LayerIndex> written_layer_nr = layer_plan_buffer.handle(*result.layer_plan.release(), gcode))
+                {
+                    if (const std::optional<PrintEstimates> estimates = estimate_extrapolator.extrapolate(*written_layer_nr, get_written_totals()))
+                    {
+                        Application::getInstance().communication_->sendRunningEstimates(*estimates);
+                    }
+                }
+                if (keep_storage)
+                {
+                    return;
+                }
+
+                // The layers are written in order, so all layers up to this one are planned. Layers that are still being planned
+                // are above it, and only look at the support down to the layers that are kept.
+                const LayerIndex release_layer_nr = layer_nr - support_layers_looked_back - 1;
+                if (release_layer_nr >= 0 && release_layer_nr < LayerIndex(storage.support.supportLayers.size()))
+                {
+                    released_support_bytes += storage.support.supportLayers[release_layer_nr].release();
+                }
+                const LayerIndex release_mesh_layer_nr = layer_nr - mesh_layers_looked_back - 1;
+                if (release_mesh_layer_nr >= 0)
+                {
+                    released_mesh_bytes += storage.releaseMeshLayer(release_mesh_layer_nr);
+                }
+            },
+            [](const std::optional<ProcessLayerResult>& result_opt)
+            {
+                return result_opt.value().layer_plan->getMemoryFootprint();
+            },
+            max_pending_layer_plan_bytes);
+    }
+    catch (const SliceCancelled&)
+    {
+        layer_plan_buffer.discard(); // The buffer outlives this slice, so the layers of the cancelled one mustn't be written into the next one.
+        gcode.discardOutput();
+        gcode.getToolpathExport().close();
+        throw;
+    }
+    spdlog::debug(
+        "Layer plans waited for g-code output {} times for a free slot and {} times for memory, {:.3f}s in total. At most {} layer plans of {} MB waited at once.",
+        buffer_statistics.slot_stall_count,
+        buffer_statistics.memory_stall_count,
+        buffer_statistics.stall_time.count(),
+        buffer_statistics.peak_pending_count,
+        buffer_statistics.peak_pending_bytes / (1024 * 1024));
+    spdlog::info(
+        "Layer plans waiting for g-code output took up at most {} MB, and the layer plan buffer {} MB.",
+        buffer_statistics.peak_pending_bytes / (1024 * 1024),
+        layer_plan_buffer.getMemoryFootprint() / (1024 * 1024));
+    spdlog::debug("Released {} MB of support areas and {} MB of mesh areas while writing g-code.", released_support_bytes / (1024 * 1024), released_mesh_bytes / (1024 * 1024));
+    spdlog::debug("Reused the comb boundaries of {} layers and computed {}.", storage.comb_boundaries.hitCount(), storage.comb_boundaries.missCount());
+    spdlog::debug("Reused the support infill of {} areas and generated {}.", storage.support.infill_cache.hitCount(), storage.support.infill_cache.missCount());
 
     layer_plan_buffer.flush();
 
@@ -202,7 +370,62 @@ void FffGcodeWriter::writeGCode(SliceDataStorage& storage, TimeKeeper& time_keep
     gcode.writeRetraction(storage.retraction_wipe_config_per_extruder[gcode.getExtruderNr()].retraction_config, force); // retract after finishing each meshgroup
 }
 
-unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const int layer_nr, const int last_layer_nr)
+namespace
+{
+
+/*!
+ * Put the vertices of a wall in a grid, to find the vertex closest to a point without checking all of them.
+ * \param wall The wall.
+ * \return A grid with the indices of the vertices in the wall.
+ */
+NearestPointGrid<size_t> createWallVerticesGrid(ConstPolygonRef wall)
+{
+    // Aim for about one vertex per cell along the wall.
+    NearestPointGrid<size_t> grid(wall.empty() ? 1 : wall.polygonLength() / static_cast<coord_t>(wall.size()));
+    for (size_t point_idx = 0; point_idx < wall.size(); point_idx++)
+    {
+        grid.insert(wall[point_idx], point_idx);
+    }
+    return grid;
+}
+
+/*!
+ * Find the vertex of a wall closest to a point. Between equally close vertices, the first one in the wall is picked,
+ * like PolygonUtils::findNearestVert does.
+ * \param from The point to find the closest vertex to.
+ * \param wall_vertices The vertices of the wall, with their indices.
+ * \return The index of the closest vertex in the wall.
+ */
+size_t findNearestWallVertex(const Point2LL& from, const NearestPointGrid<size_t>& wall_vertices)
+{
+    coord_t best_dist2 = std::numeric_limits<coord_t>::max();
+    size_t best_idx = 0;
+    wall_vertices.processNearestFirst(
+        from,
+        [&from, &best_dist2, &best_idx](const Point2LL& point, const size_t point_idx)
+        {
+            const coord_t dist2 = vSize2(point - from);
+            if (dist2 < best_dist2 || (dist2 == best_dist2 && point_idx < best_idx))
+            {
+                best_dist2 = dist2;
+                best_idx = point_idx;
+            }
+        },
+        [&best_dist2](const coord_t dist)
+        {
+            return dist * dist <= best_dist2;
+        });
+    return best_idx;
+}
+
+} // namespace
+
+unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(
+    const SliceDataStorage& storage,
+    const SliceMeshStorage& mesh,
+    const int layer_nr,
+    const int last_layer_nr,
+    const NearestPointGrid<size_t>& wall_vertices)
 {
     const SliceLayer& layer = mesh.layers[layer_nr];
 
@@ -213,7 +436,7 @@ unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(const SliceDataS
         // in the first layer that has a part with insets. This allows the user to alter the seam start location which
         // could be useful if the spiralization has a problem with a particular seam path.
         Point2LL seam_pos(0, 0);
-        if (mesh.settings.get<EZSeamType>("z_seam_type") == EZSeamType::USER_SPECIFIED)
+        if (mesh.settings.get<EZSeamType>(SettingKey::z_seam_type) == EZSeamType::USER_SPECIFIED)
         {
             seam_pos = mesh.getZSeamHint();
         }
@@ -234,12 +457,12 @@ unsigned int FffGcodeWriter::findSpiralizedLayerSeamVertexIndex(const SliceDataS
         // seam_vertex_idx is going to be the index of the seam vertex in the current wall polygon
         // initially we choose the vertex that is closest to the seam vertex in the last spiralized layer processed
 
-        int seam_vertex_idx = PolygonUtils::findNearestVert(last_wall_seam_vertex, wall);
+        int seam_vertex_idx = findNearestWallVertex(last_wall_seam_vertex, wall_vertices);
 
         // now we check that the vertex following the seam vertex is to the left of the seam vertex in the last layer
         // and if it isn't, we move forward
 
-        if (vSize(last_wall_seam_vertex - wall[seam_vertex_idx]) >= mesh.settings.get<coord_t>("meshfix_maximum_resolution"))
+        if (vSize(last_wall_seam_vertex - wall[seam_vertex_idx]) >= mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_resolution))
         {
             // get the inward normal of the last layer seam vertex
             Point2LL last_wall_seam_vertex_inward_normal = PolygonUtils::getVertexInwardNormal(last_wall, storage.spiralize_seam_vertex_indices[last_layer_nr]);
@@ -273,37 +496,52 @@ void FffGcodeWriter::findLayerSeamsForSpiralize(SliceDataStorage& storage, size_
 
     int last_layer_nr = -1; // layer number of the last non-empty layer processed (for any extruder or mesh)
 
-    for (unsigned layer_nr = 0; layer_nr < total_layers; ++layer_nr)
-    {
-        bool done_this_layer = false;
-
-        // iterate through extruders until we find a mesh that has a part with insets
-        const std::vector<ExtruderUse> extruder_order = getExtruderUse(layer_nr);
-        for (unsigned int extruder_idx = 0; ! done_this_layer && extruder_idx < extruder_order.size(); ++extruder_idx)
-        {
-            const size_t extruder_nr = extruder_order[extruder_idx].extruder_nr;
-            // iterate through this extruder's meshes until we find a part with insets
-            const std::vector<size_t>& mesh_order = mesh_order_per_extruder[extruder_nr];
-            for (unsigned int mesh_idx : mesh_order)
+    // The grids of a batch of layers are kept at once, rather than those of all layers, to bound the memory they take.
+    constexpr size_t layers_per_batch = 256;
+    std::vector<SliceMeshStorage*> spiralized_meshes(std::min(layers_per_batch, total_layers));
+    std::vector<std::optional<NearestPointGrid<size_t>>> wall_vertices(spiralized_meshes.size());
+    for (size_t batch_start = 0; batch_start < total_layers; batch_start += layers_per_batch)
+    {
+        const size_t batch_end = std::min(batch_start + layers_per_batch, total_layers);
+        cura::parallel_for<size_t>(
+            batch_start,
+            batch_end,
+            [&](const size_t layer_nr)
             {
-                SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
-                // if this mesh has layer data for this layer process it
-                if (! done_this_layer && mesh.layers.size() > layer_nr)
+                const size_t batch_idx = layer_nr - batch_start;
+                spiralized_meshes[batch_idx] = nullptr;
+                wall_vertices[batch_idx].reset();
+
+                // iterate through extruders until we find a mesh that has a part with insets
+                for (const ExtruderUse& extruder_use : getExtruderUse(layer_nr))
                 {
-                    SliceLayer& layer = mesh.layers[layer_nr];
-                    // if the first part in the layer (if any) has insets, process it
-                    if (! layer.parts.empty() && ! layer.parts[0].spiral_wall.empty())
+                    // iterate through this extruder's meshes until we find a part with insets
+                    for (const size_t mesh_idx : mesh_order_per_extruder[extruder_use.extruder_nr])
                     {
-                        // save the seam vertex index for this layer as we need it to determine the seam vertex index for the next layer
-                        storage.spiralize_seam_vertex_indices[layer_nr] = findSpiralizedLayerSeamVertexIndex(storage, mesh, layer_nr, last_layer_nr);
-                        // save the wall outline for this layer so it can be used in the spiralize interpolation calculation
-                        storage.spiralize_wall_outlines[layer_nr] = &layer.parts[0].spiral_wall;
-                        last_layer_nr = layer_nr;
-                        // ignore any further meshes/extruders for this layer
-                        done_this_layer = true;
+                        SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
+                        // if this mesh has layer data for this layer and the first part in the layer (if any) has insets, process it
+                        if (mesh.layers.size() > layer_nr && ! mesh.layers[layer_nr].parts.empty() && ! mesh.layers[layer_nr].parts[0].spiral_wall.empty())
+                        {
+                            spiralized_meshes[batch_idx] = &mesh;
+                            wall_vertices[batch_idx] = createWallVerticesGrid(mesh.layers[layer_nr].parts[0].spiral_wall[0]);
+                            return; // ignore any further meshes/extruders for this layer
+                        }
                     }
                 }
+            });
+
+        for (size_t layer_nr = batch_start; layer_nr < batch_end; ++layer_nr)
+        {
+            SliceMeshStorage* mesh = spiralized_meshes[layer_nr - batch_start];
+            if (mesh == nullptr)
+            {
+                continue;
             }
+            // save the seam vertex index for this layer as we need it to determine the seam vertex index for the next layer
+            storage.spiralize_seam_vertex_indices[layer_nr] = findSpiralizedLayerSeamVertexIndex(storage, *mesh, layer_nr, last_layer_nr, *wall_vertices[layer_nr - batch_start]);
+            // save the wall outline for this layer so it can be used in the spiralize interpolation calculation
+            storage.spiralize_wall_outlines[layer_nr] = &mesh->layers[layer_nr].parts[0].spiral_wall;
+            last_layer_nr = layer_nr;
         }
     }
 }
@@ -314,14 +552,14 @@ void FffGcodeWriter::setConfigFanSpeedLayerTime()
     {
         fan_speed_layer_time_settings_per_extruder.emplace_back();
         FanSpeedLayerTimeSettings& fan_speed_layer_time_settings = fan_speed_layer_time_settings_per_extruder.back();
-        fan_speed_layer_time_settings.cool_min_layer_time = train.settings_.get<Duration>("cool_min_layer_time");
-        fan_speed_layer_time_settings.cool_min_layer_time_fan_speed_max = train.settings_.get<Duration>("cool_min_layer_time_fan_speed_max");
-        fan_speed_layer_time_settings.cool_fan_speed_0 = train.settings_.get<Ratio>("cool_fan_speed_0") * 100.0;
-        fan_speed_layer_time_settings.cool_fan_speed_min = train.settings_.get<Ratio>("cool_fan_speed_min") * 100.0;
-        fan_speed_layer_time_settings.cool_fan_speed_max = train.settings_.get<Ratio>("cool_fan_speed_max") * 100.0;
-        fan_speed_layer_time_settings.cool_min_speed = train.settings_.get<Velocity>("cool_min_speed");
-        fan_speed_layer_time_settings.cool_fan_full_layer = train.settings_.get<LayerIndex>("cool_fan_full_layer");
-        if (! train.settings_.get<bool>("cool_fan_enabled"))
+        fan_speed_layer_time_settings.cool_min_layer_time = train.settings_.get<Duration>(SettingKey::cool_min_layer_time);
+        fan_speed_layer_time_settings.cool_min_layer_time_fan_speed_max = train.settings_.get<Duration>(SettingKey::cool_min_layer_time_fan_speed_max);
+        fan_speed_layer_time_settings.cool_fan_speed_0 = train.settings_.get<Ratio>(SettingKey::cool_fan_speed_0) * 100.0;
+        fan_speed_layer_time_settings.cool_fan_speed_min = train.settings_.get<Ratio>(SettingKey::cool_fan_speed_min) * 100.0;
+        fan_speed_layer_time_settings.cool_fan_speed_max = train.settings_.get<Ratio>(SettingKey::cool_fan_speed_max) * 100.0;
+        fan_speed_layer_time_settings.cool_min_speed = train.settings_.get<Velocity>(SettingKey::cool_min_speed);
+        fan_speed_layer_time_settings.cool_fan_full_layer = train.settings_.get<LayerIndex>(SettingKey::cool_fan_full_layer);
+        if (! train.settings_.get<bool>(SettingKey::cool_fan_enabled))
         {
             fan_speed_layer_time_settings.cool_fan_speed_0 = 0;
             fan_speed_layer_time_settings.cool_fan_speed_min = 0;
@@ -333,23 +571,23 @@ void FffGcodeWriter::setConfigFanSpeedLayerTime()
 static void retractionAndWipeConfigFromSettings(const Settings& settings, RetractionAndWipeConfig* config)
 {
     RetractionConfig& retraction_config = config->retraction_config;
-    retraction_config.distance = (settings.get<bool>("retraction_enable")) ? settings.get<double>("retraction_amount") : 0; // Retraction distance in mm.
-    retraction_config.prime_volume = settings.get<double>("retraction_extra_prime_amount"); // Extra prime volume in mm^3.
-    retraction_config.speed = settings.get<Velocity>("retraction_retract_speed");
-    retraction_config.primeSpeed = settings.get<Velocity>("retraction_prime_speed");
-    retraction_config.zHop = settings.get<coord_t>("retraction_hop");
-    retraction_config.retraction_min_travel_distance = settings.get<coord_t>("retraction_min_travel");
-    retraction_config.retraction_extrusion_window = settings.get<double>("retraction_extrusion_window"); // Window to count retractions in in mm of extruded filament.
-    retraction_config.retraction_count_max = settings.get<size_t>("retraction_count_max");
-
-    config->retraction_hop_after_extruder_switch = settings.get<bool>("retraction_hop_after_extruder_switch");
-    config->switch_extruder_extra_prime_amount = settings.get<double>("switch_extruder_extra_prime_amount");
+    retraction_config.distance = (settings.get<bool>(SettingKey::retraction_enable)) ? settings.get<double>(SettingKey::retraction_amount) : 0; // Retraction distance in mm.
+    retraction_config.prime_volume = settings.get<double>(SettingKey::retraction_extra_prime_amount); // Extra prime volume in mm^3.
+    retraction_config.speed = settings.get<Velocity>(SettingKey::retraction_retract_speed);
+    retraction_config.primeSpeed = settings.get<Velocity>(SettingKey::retraction_prime_speed);
+    retraction_config.zHop = settings.get<coord_t>(SettingKey::retraction_hop);
+    retraction_config.retraction_min_travel_distance = settings.get<coord_t>(SettingKey::retraction_min_travel);
+    retraction_config.retraction_extrusion_window = settings.get<double>(SettingKey::retraction_extrusion_window); // Window to count retractions in in mm of extruded filament.
+    retraction_config.retraction_count_max = settings.get<size_t>(SettingKey::retraction_count_max);
+
+    config->retraction_hop_after_extruder_switch = settings.get<bool>(SettingKey::retraction_hop_after_extruder_switch);
+    config->switch_extruder_extra_prime_amount = settings.get<double>(SettingKey::switch_extruder_extra_prime_amount);
     RetractionConfig& switch_retraction_config = config->extruder_switch_retraction_config;
-    switch_retraction_config.distance = settings.get<double>("switch_extruder_retraction_amount"); // Retraction distance in mm.
+    switch_retraction_config.distance = settings.get<double>(SettingKey::switch_extruder_retraction_amount); // Retraction distance in mm.
     switch_retraction_config.prime_volume = 0.0;
-    switch_retraction_config.speed = settings.get<Velocity>("switch_extruder_retraction_speed");
-    switch_retraction_config.primeSpeed = settings.get<Velocity>("switch_extruder_prime_speed");
-    switch_retraction_config.zHop = settings.get<coord_t>("retraction_hop_after_extruder_switch_height");
+    switch_retraction_config.speed = settings.get<Velocity>(SettingKey::switch_extruder_retraction_speed);
+    switch_retraction_config.primeSpeed = settings.get<Velocity>(SettingKey::switch_extruder_prime_speed);
+    switch_retraction_config.zHop = settings.get<coord_t>(SettingKey::retraction_hop_after_extruder_switch_height);
     switch_retraction_config.retraction_min_travel_distance = 0; // No limitation on travel distance for an extruder switch retract.
     switch_retraction_config.retraction_extrusion_window
         = 99999.9; // So that extruder switch retractions won't affect the retraction buffer (extruded_volume_at_previous_n_retractions).
@@ -357,27 +595,27 @@ static void retractionAndWipeConfigFromSettings(const Settings& settings, Retrac
 
     WipeScriptConfig& wipe_config = config->wipe_config;
 
-    wipe_config.retraction_enable = settings.get<bool>("wipe_retraction_enable");
-    wipe_config.retraction_config.distance = settings.get<double>("wipe_retraction_amount");
-    wipe_config.retraction_config.speed = settings.get<Velocity>("wipe_retraction_retract_speed");
-    wipe_config.retraction_config.primeSpeed = settings.get<Velocity>("wipe_retraction_prime_speed");
-    wipe_config.retraction_config.prime_volume = settings.get<double>("wipe_retraction_extra_prime_amount");
+    wipe_config.retraction_enable = settings.get<bool>(SettingKey::wipe_retraction_enable);
+    wipe_config.retraction_config.distance = settings.get<double>(SettingKey::wipe_retraction_amount);
+    wipe_config.retraction_config.speed = settings.get<Velocity>(SettingKey::wipe_retraction_retract_speed);
+    wipe_config.retraction_config.primeSpeed = settings.get<Velocity>(SettingKey::wipe_retraction_prime_speed);
+    wipe_config.retraction_config.prime_volume = settings.get<double>(SettingKey::wipe_retraction_extra_prime_amount);
     wipe_config.retraction_config.retraction_min_travel_distance = 0;
     wipe_config.retraction_config.retraction_extrusion_window = std::numeric_limits<double>::max();
     wipe_config.retraction_config.retraction_count_max = std::numeric_limits<size_t>::max();
 
-    wipe_config.pause = settings.get<Duration>("wipe_pause");
+    wipe_config.pause = settings.get<Duration>(SettingKey::wipe_pause);
 
-    wipe_config.hop_enable = settings.get<bool>("wipe_hop_enable");
-    wipe_config.hop_amount = settings.get<coord_t>("wipe_hop_amount");
-    wipe_config.hop_speed = settings.get<Velocity>("wipe_hop_speed");
+    wipe_config.hop_enable = settings.get<bool>(SettingKey::wipe_hop_enable);
+    wipe_config.hop_amount = settings.get<coord_t>(SettingKey::wipe_hop_amount);
+    wipe_config.hop_speed = settings.get<Velocity>(SettingKey::wipe_hop_speed);
 
-    wipe_config.brush_pos_x = settings.get<coord_t>("wipe_brush_pos_x");
-    wipe_config.repeat_count = settings.get<size_t>("wipe_repeat_count");
-    wipe_config.move_distance = settings.get<coord_t>("wipe_move_distance");
-    wipe_config.move_speed = settings.get<Velocity>("speed_travel");
-    wipe_config.max_extrusion_mm3 = settings.get<double>("max_extrusion_before_wipe");
-    wipe_config.clean_between_layers = settings.get<bool>("clean_between_layers");
+    wipe_config.brush_pos_x = settings.get<coord_t>(SettingKey::wipe_brush_pos_x);
+    wipe_config.repeat_count = settings.get<size_t>(SettingKey::wipe_repeat_count);
+    wipe_config.move_distance = settings.get<coord_t>(SettingKey::wipe_move_distance);
+    wipe_config.move_speed = settings.get<Velocity>(SettingKey::speed_travel);
+    wipe_config.max_extrusion_mm3 = settings.get<double>(SettingKey::max_extrusion_before_wipe);
+    wipe_config.clean_between_layers = settings.get<bool>(SettingKey::clean_between_layers);
 }
 
 void FffGcodeWriter::setConfigRetractionAndWipe(SliceDataStorage& storage)
@@ -397,32 +635,32 @@ void FffGcodeWriter::setConfigRetractionAndWipe(SliceDataStorage& storage)
 size_t FffGcodeWriter::getStartExtruder(const SliceDataStorage& storage) const
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    const EPlatformAdhesion adhesion_type = mesh_group_settings.get<EPlatformAdhesion>("adhesion_type");
-    const int skirt_brim_extruder_nr = mesh_group_settings.get<int>("skirt_brim_extruder_nr");
-    const ExtruderTrain* skirt_brim_extruder = (skirt_brim_extruder_nr < 0) ? nullptr : &mesh_group_settings.get<ExtruderTrain&>("skirt_brim_extruder_nr");
+    const EPlatformAdhesion adhesion_type = mesh_group_settings.get<EPlatformAdhesion>(SettingKey::adhesion_type);
+    const int skirt_brim_extruder_nr = mesh_group_settings.get<int>(SettingKey::skirt_brim_extruder_nr);
+    const ExtruderTrain* skirt_brim_extruder = (skirt_brim_extruder_nr < 0) ? nullptr : &mesh_group_settings.get<ExtruderTrain&>(SettingKey::skirt_brim_extruder_nr);
 
     size_t start_extruder_nr;
     if (adhesion_type == EPlatformAdhesion::SKIRT && skirt_brim_extruder
-        && (skirt_brim_extruder->settings_.get<int>("skirt_line_count") > 0 || skirt_brim_extruder->settings_.get<coord_t>("skirt_brim_minimal_length") > 0))
+        && (skirt_brim_extruder->settings_.get<int>(SettingKey::skirt_line_count) > 0 || skirt_brim_extruder->settings_.get<coord_t>(SettingKey::skirt_brim_minimal_length) > 0))
     {
         start_extruder_nr = skirt_brim_extruder->extruder_nr_;
     }
 
     else if (
-        (adhesion_type == EPlatformAdhesion::BRIM || mesh_group_settings.get<bool>("prime_tower_brim_enable")) && skirt_brim_extruder
-        && (skirt_brim_extruder->settings_.get<int>("brim_line_count") > 0 || skirt_brim_extruder->settings_.get<coord_t>("skirt_brim_minimal_length") > 0))
+        (adhesion_type == EPlatformAdhesion::BRIM || mesh_group_settings.get<bool>(SettingKey::prime_tower_brim_enable)) && skirt_brim_extruder
+        && (skirt_brim_extruder->settings_.get<int>(SettingKey::brim_line_count) > 0 || skirt_brim_extruder->settings_.get<coord_t>(SettingKey::skirt_brim_minimal_length) > 0))
     {
         start_extruder_nr = skirt_brim_extruder->extruder_nr_;
     }
     else if (adhesion_type == EPlatformAdhesion::RAFT && skirt_brim_extruder)
     {
-        start_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("raft_base_extruder_nr").extruder_nr_;
+        start_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_base_extruder_nr).extruder_nr_;
     }
     else // No adhesion.
     {
-        if (mesh_group_settings.get<bool>("support_enable") && mesh_group_settings.get<bool>("support_brim_enable"))
+        if (mesh_group_settings.get<bool>(SettingKey::support_enable) && mesh_group_settings.get<bool>(SettingKey::support_brim_enable))
         {
-            start_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr").extruder_nr_;
+            start_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_infill_extruder_nr).extruder_nr_;
         }
         else
         {
@@ -445,11 +683,11 @@ void FffGcodeWriter::setInfillAndSkinAngles(SliceMeshStorage& mesh)
 {
     if (mesh.infill_angles.size() == 0)
     {
-        mesh.infill_angles = mesh.settings.get<std::vector<AngleDegrees>>("infill_angles");
+        mesh.infill_angles = mesh.settings.get<std::vector<AngleDegrees>>(SettingKey::infill_angles);
         if (mesh.infill_angles.size() == 0)
         {
             // user has not specified any infill angles so use defaults
-            const EFillMethod infill_pattern = mesh.settings.get<EFillMethod>("infill_pattern");
+            const EFillMethod infill_pattern = mesh.settings.get<EFillMethod>(SettingKey::infill_pattern);
             if (infill_pattern == EFillMethod::CROSS || infill_pattern == EFillMethod::CROSS_3D)
             {
                 mesh.infill_angles.push_back(22); // put most infill lines in between 45 and 0 degrees
@@ -468,7 +706,7 @@ void FffGcodeWriter::setInfillAndSkinAngles(SliceMeshStorage& mesh)
 
     if (mesh.roofing_angles.size() == 0)
     {
-        mesh.roofing_angles = mesh.settings.get<std::vector<AngleDegrees>>("roofing_angles");
+        mesh.roofing_angles = mesh.settings.get<std::vector<AngleDegrees>>(SettingKey::roofing_angles);
         if (mesh.roofing_angles.size() == 0)
         {
             // user has not specified any infill angles so use defaults
@@ -479,7 +717,7 @@ void FffGcodeWriter::setInfillAndSkinAngles(SliceMeshStorage& mesh)
 
     if (mesh.skin_angles.size() == 0)
     {
-        mesh.skin_angles = mesh.settings.get<std::vector<AngleDegrees>>("skin_angles");
+        mesh.skin_angles = mesh.settings.get<std::vector<AngleDegrees>>(SettingKey::skin_angles);
         if (mesh.skin_angles.size() == 0)
         {
             // user has not specified any infill angles so use defaults
@@ -492,15 +730,15 @@ void FffGcodeWriter::setInfillAndSkinAngles(SliceMeshStorage& mesh)
 void FffGcodeWriter::setSupportAngles(SliceDataStorage& storage)
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    const ExtruderTrain& support_infill_extruder = mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr");
-    storage.support.support_infill_angles = support_infill_extruder.settings_.get<std::vector<AngleDegrees>>("support_infill_angles");
+    const ExtruderTrain& support_infill_extruder = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_infill_extruder_nr);
+    storage.support.support_infill_angles = support_infill_extruder.settings_.get<std::vector<AngleDegrees>>(SettingKey::support_infill_angles);
     if (storage.support.support_infill_angles.empty())
     {
         storage.support.support_infill_angles.push_back(0);
     }
 
-    const ExtruderTrain& support_extruder_nr_layer_0 = mesh_group_settings.get<ExtruderTrain&>("support_extruder_nr_layer_0");
-    storage.support.support_infill_angles_layer_0 = support_extruder_nr_layer_0.settings_.get<std::vector<AngleDegrees>>("support_infill_angles");
+    const ExtruderTrain& support_extruder_nr_layer_0 = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_extruder_nr_layer_0);
+    storage.support.support_infill_angles_layer_0 = support_extruder_nr_layer_0.settings_.get<std::vector<AngleDegrees>>(SettingKey::support_infill_angles);
     if (storage.support.support_infill_angles_layer_0.empty())
     {
         storage.support.support_infill_angles_layer_0.push_back(0);
@@ -525,7 +763,7 @@ void FffGcodeWriter::setSupportAngles(SliceDataStorage& storage)
                 for (const auto& mesh : storage.meshes)
                 {
                     if (mesh->settings.get<coord_t>(interface_height_setting)
-                        >= 2 * Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<coord_t>("layer_height"))
+                        >= 2 * Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<coord_t>(SettingKey::layer_height))
                     {
                         // Some roofs are quite thick.
                         // Alternate between the two kinds of diagonal: / and \ .
@@ -542,13 +780,13 @@ void FffGcodeWriter::setSupportAngles(SliceDataStorage& storage)
         return angles;
     };
 
-    const ExtruderTrain& roof_extruder = mesh_group_settings.get<ExtruderTrain&>("support_roof_extruder_nr");
+    const ExtruderTrain& roof_extruder = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_roof_extruder_nr);
     storage.support.support_roof_angles
-        = getInterfaceAngles(roof_extruder, "support_roof_angles", roof_extruder.settings_.get<EFillMethod>("support_roof_pattern"), "support_roof_height");
+        = getInterfaceAngles(roof_extruder, "support_roof_angles", roof_extruder.settings_.get<EFillMethod>(SettingKey::support_roof_pattern), "support_roof_height");
 
-    const ExtruderTrain& bottom_extruder = mesh_group_settings.get<ExtruderTrain&>("support_bottom_extruder_nr");
+    const ExtruderTrain& bottom_extruder = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_bottom_extruder_nr);
     storage.support.support_bottom_angles
-        = getInterfaceAngles(bottom_extruder, "support_bottom_angles", bottom_extruder.settings_.get<EFillMethod>("support_bottom_pattern"), "support_bottom_height");
+        = getInterfaceAngles(bottom_extruder, "support_bottom_angles", bottom_extruder.settings_.get<EFillMethod>(SettingKey::support_bottom_pattern), "support_bottom_height");
 }
 
 void FffGcodeWriter::processNextMeshGroupCode(const SliceDataStorage& storage)
@@ -557,9 +795,9 @@ void FffGcodeWriter::processNextMeshGroupCode(const SliceDataStorage& storage)
     gcode.setZ(max_object_height + MM2INT(5));
 
     Application::getInstance().communication_->sendCurrentPosition(gcode.getPositionXY());
-    gcode.writeTravel(gcode.getPositionXY(), Application::getInstance().current_slice_->scene.extruders[gcode.getExtruderNr()].settings_.get<Velocity>("speed_travel"));
+    gcode.writeTravel(gcode.getPositionXY(), Application::getInstance().current_slice_->scene.extruders[gcode.getExtruderNr()].settings_.get<Velocity>(SettingKey::speed_travel));
     Point2LL start_pos(storage.model_min.x_, storage.model_min.y_);
-    gcode.writeTravel(start_pos, Application::getInstance().current_slice_->scene.extruders[gcode.getExtruderNr()].settings_.get<Velocity>("speed_travel"));
+    gcode.writeTravel(start_pos, Application::getInstance().current_slice_->scene.extruders[gcode.getExtruderNr()].settings_.get<Velocity>(SettingKey::speed_travel));
 
     gcode.processInitialLayerTemperature(storage, gcode.getExtruderNr());
 }
@@ -567,17 +805,17 @@ void FffGcodeWriter::processNextMeshGroupCode(const SliceDataStorage& storage)
 void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
 {
     Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    const size_t base_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("raft_base_extruder_nr").extruder_nr_;
-    const size_t interface_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("raft_interface_extruder_nr").extruder_nr_;
-    const size_t surface_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("raft_surface_extruder_nr").extruder_nr_;
+    const size_t base_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_base_extruder_nr).extruder_nr_;
+    const size_t interface_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_interface_extruder_nr).extruder_nr_;
+    const size_t surface_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_surface_extruder_nr).extruder_nr_;
     const size_t prime_tower_extruder_nr = storage.primeTower.extruder_order_.front();
 
     coord_t z = 0;
     const LayerIndex initial_raft_layer_nr = -Raft::getTotalExtraLayers();
-    const Settings& interface_settings = mesh_group_settings.get<ExtruderTrain&>("raft_interface_extruder_nr").settings_;
-    const size_t num_interface_layers = interface_settings.get<size_t>("raft_interface_layers");
-    const Settings& surface_settings = mesh_group_settings.get<ExtruderTrain&>("raft_surface_extruder_nr").settings_;
-    const size_t num_surface_layers = surface_settings.get<size_t>("raft_surface_layers");
+    const Settings& interface_settings = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_interface_extruder_nr).settings_;
+    const size_t num_interface_layers = interface_settings.get<size_t>(SettingKey::raft_interface_layers);
+    const Settings& surface_settings = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_surface_extruder_nr).settings_;
+    const size_t num_surface_layers = surface_settings.get<size_t>(SettingKey::raft_surface_layers);
 
     // some infill config for all lines infill generation below
     constexpr double fill_overlap = 0; // raft line shouldn't be expanded - there is no boundary polygon printed
@@ -593,23 +831,23 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
     unsigned int current_extruder_nr = base_extruder_nr;
 
     { // raft base layer
-        const Settings& base_settings = mesh_group_settings.get<ExtruderTrain&>("raft_base_extruder_nr").settings_;
+        const Settings& base_settings = mesh_group_settings.get<ExtruderTrain&>(SettingKey::raft_base_extruder_nr).settings_;
         LayerIndex layer_nr = initial_raft_layer_nr;
-        const coord_t layer_height = base_settings.get<coord_t>("raft_base_thickness");
+        const coord_t layer_height = base_settings.get<coord_t>(SettingKey::raft_base_thickness);
         z += layer_height;
-        const coord_t comb_offset = std::max(base_settings.get<coord_t>("raft_base_line_spacing"), base_settings.get<coord_t>("raft_base_line_width"));
+        const coord_t comb_offset = std::max(base_settings.get<coord_t>(SettingKey::raft_base_line_spacing), base_settings.get<coord_t>(SettingKey::raft_base_line_width));
 
         std::vector<FanSpeedLayerTimeSettings> fan_speed_layer_time_settings_per_extruder_raft_base
             = fan_speed_layer_time_settings_per_extruder; // copy so that we change only the local copy
         for (FanSpeedLayerTimeSettings& fan_speed_layer_time_settings : fan_speed_layer_time_settings_per_extruder_raft_base)
         {
-            double regular_fan_speed = base_settings.get<Ratio>("raft_base_fan_speed") * 100.0;
+            double regular_fan_speed = base_settings.get<Ratio>(SettingKey::raft_base_fan_speed) * 100.0;
             fan_speed_layer_time_settings.cool_fan_speed_min = regular_fan_speed;
             fan_speed_layer_time_settings.cool_fan_speed_0 = regular_fan_speed; // ignore initial layer fan speed stuff
         }
 
-        const coord_t line_width = base_settings.get<coord_t>("raft_base_line_width");
-        const coord_t avoid_distance = base_settings.get<coord_t>("travel_avoid_distance");
+        const coord_t line_width = base_settings.get<coord_t>(SettingKey::raft_base_line_width);
+        const coord_t avoid_distance = base_settings.get<coord_t>(SettingKey::travel_avoid_distance);
         LayerPlan& gcode_layer
             = *new LayerPlan(storage, layer_nr, z, layer_height, base_extruder_nr, fan_speed_layer_time_settings_per_extruder_raft_base, comb_offset, line_width, avoid_distance);
         gcode_layer.setIsInside(true);
@@ -621,10 +859,10 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
         constexpr bool zig_zaggify_infill = false;
         constexpr bool connect_polygons = true; // causes less jerks, so better adhesion
 
-        const size_t wall_line_count = base_settings.get<size_t>("raft_base_wall_count");
+        const size_t wall_line_count = base_settings.get<size_t>(SettingKey::raft_base_wall_count);
         const coord_t small_area_width = 0; // A raft never has a small region due to the large horizontal expansion.
-        const coord_t line_spacing = base_settings.get<coord_t>("raft_base_line_spacing");
-        const coord_t line_spacing_prime_tower = base_settings.get<coord_t>("prime_tower_raft_base_line_spacing");
+        const coord_t line_spacing = base_settings.get<coord_t>(SettingKey::raft_base_line_spacing);
+        const coord_t line_spacing_prime_tower = base_settings.get<coord_t>(SettingKey::prime_tower_raft_base_line_spacing);
         const Point2LL& infill_origin = Point2LL();
         constexpr bool skip_stitching = false;
         constexpr bool connected_zigzags = false;
@@ -632,8 +870,8 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
         constexpr bool skip_some_zags = false;
         constexpr int zag_skip_count = 0;
         constexpr coord_t pocket_size = 0;
-        const coord_t max_resolution = base_settings.get<coord_t>("meshfix_maximum_resolution");
-        const coord_t max_deviation = base_settings.get<coord_t>("meshfix_maximum_deviation");
+        const coord_t max_resolution = base_settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+        const coord_t max_deviation = base_settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
 
         struct ParameterizedRaftPath
         {
@@ -747,13 +985,13 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
         layer_plan_buffer.handle(gcode_layer, gcode);
     }
 
-    const coord_t interface_layer_height = interface_settings.get<coord_t>("raft_interface_thickness");
-    const coord_t interface_line_spacing = interface_settings.get<coord_t>("raft_interface_line_spacing");
-    const Ratio interface_fan_speed = interface_settings.get<Ratio>("raft_interface_fan_speed");
-    const coord_t interface_line_width = interface_settings.get<coord_t>("raft_interface_line_width");
-    const coord_t interface_avoid_distance = interface_settings.get<coord_t>("travel_avoid_distance");
-    const coord_t interface_max_resolution = interface_settings.get<coord_t>("meshfix_maximum_resolution");
-    const coord_t interface_max_deviation = interface_settings.get<coord_t>("meshfix_maximum_deviation");
+    const coord_t interface_layer_height = interface_settings.get<coord_t>(SettingKey::raft_interface_thickness);
+    const coord_t interface_line_spacing = interface_settings.get<coord_t>(SettingKey::raft_interface_line_spacing);
+    const Ratio interface_fan_speed = interface_settings.get<Ratio>(SettingKey::raft_interface_fan_speed);
+    const coord_t interface_line_width = interface_settings.get<coord_t>(SettingKey::raft_interface_line_width);
+    const coord_t interface_avoid_distance = interface_settings.get<coord_t>(SettingKey::travel_avoid_distance);
+    const coord_t interface_max_resolution = interface_settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const coord_t interface_max_deviation = interface_settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
 
     for (LayerIndex raft_interface_layer = 1; static_cast<size_t>(raft_interface_layer) <= num_interface_layers; ++raft_interface_layer)
     { // raft interface layer
@@ -808,7 +1046,7 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
         constexpr bool zig_zaggify_infill = true;
         constexpr bool connect_polygons = true; // why not?
 
-        const size_t wall_line_count = interface_settings.get<size_t>("raft_interface_wall_count");
+        const size_t wall_line_count = interface_settings.get<size_t>(SettingKey::raft_interface_wall_count);
         const coord_t small_area_width = 0; // A raft never has a small region due to the large horizontal expansion.
         const Point2LL infill_origin = Point2LL();
         constexpr bool skip_stitching = false;
@@ -916,14 +1154,14 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
         last_planned_position = gcode_layer.getLastPlannedPositionOrStartingPosition();
     }
 
-    const coord_t surface_layer_height = surface_settings.get<coord_t>("raft_surface_thickness");
-    const coord_t surface_line_spacing = surface_settings.get<coord_t>("raft_surface_line_spacing");
-    const coord_t surface_max_resolution = surface_settings.get<coord_t>("meshfix_maximum_resolution");
-    const coord_t surface_max_deviation = surface_settings.get<coord_t>("meshfix_maximum_deviation");
-    const coord_t surface_line_width = surface_settings.get<coord_t>("raft_surface_line_width");
-    const coord_t surface_avoid_distance = surface_settings.get<coord_t>("travel_avoid_distance");
-    const Ratio surface_fan_speed = surface_settings.get<Ratio>("raft_surface_fan_speed");
-    const bool surface_monotonic = surface_settings.get<bool>("raft_surface_monotonic");
+    const coord_t surface_layer_height = surface_settings.get<coord_t>(SettingKey::raft_surface_thickness);
+    const coord_t surface_line_spacing = surface_settings.get<coord_t>(SettingKey::raft_surface_line_spacing);
+    const coord_t surface_max_resolution = surface_settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const coord_t surface_max_deviation = surface_settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
+    const coord_t surface_line_width = surface_settings.get<coord_t>(SettingKey::raft_surface_line_width);
+    const coord_t surface_avoid_distance = surface_settings.get<coord_t>(SettingKey::travel_avoid_distance);
+    const Ratio surface_fan_speed = surface_settings.get<Ratio>(SettingKey::raft_surface_fan_speed);
+    const bool surface_monotonic = surface_settings.get<bool>(SettingKey::raft_surface_monotonic);
 
     for (LayerIndex raft_surface_layer = 1; static_cast<size_t>(raft_surface_layer) <= num_surface_layers; raft_surface_layer++)
     { // raft surface layers
@@ -979,7 +1217,7 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
             = (num_surface_layers - raft_surface_layer) % 2 ? 45 : 135; // Alternate between -45 and +45 degrees, ending up 90 degrees rotated from the default skin angle.
         constexpr bool zig_zaggify_infill = true;
 
-        const size_t wall_line_count = surface_settings.get<size_t>("raft_surface_wall_count");
+        const size_t wall_line_count = surface_settings.get<size_t>(SettingKey::raft_surface_wall_count);
         const coord_t small_area_width = 0; // A raft never has a small region due to the large horizontal expansion.
         const Point2LL& infill_origin = Point2LL();
         const GCodePathConfig& config = gcode_layer.configs_storage_.raft_surface_config;
@@ -1108,18 +1346,18 @@ void FffGcodeWriter::processRaft(const SliceDataStorage& storage)
 
 FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataStorage& storage, LayerIndex layer_nr, const size_t total_layers) const
 {
-    spdlog::debug("GcodeWriter processing layer {} of {}", layer_nr, total_layers);
+    CURA_LOG_DEBUG("GcodeWriter processing layer {} of {}", layer_nr, total_layers);
     TimeKeeper time_keeper;
     spdlog::stopwatch timer_total;
 
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    coord_t layer_thickness = mesh_group_settings.get<coord_t>("layer_height");
+    coord_t layer_thickness = mesh_group_settings.get<coord_t>(SettingKey::layer_height);
     coord_t z;
     bool include_helper_parts = true;
     if (layer_nr < 0)
     {
 #ifdef DEBUG
-        assert(mesh_group_settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::RAFT && "negative layer_number means post-raft, pre-model layer!");
+        assert(mesh_group_settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::RAFT && "negative layer_number means post-raft, pre-model layer!");
 #endif // DEBUG
         const int filler_layer_count = Raft::getFillerLayerCount();
         layer_thickness = Raft::getFillerLayerHeight();
@@ -1132,8 +1370,8 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
         {
             const auto& mesh = *mesh_ptr;
-            if (layer_nr >= static_cast<int>(mesh.layers.size()) || mesh.settings.get<bool>("support_mesh") || mesh.settings.get<bool>("anti_overhang_mesh")
-                || mesh.settings.get<bool>("cutting_mesh") || mesh.settings.get<bool>("infill_mesh"))
+            if (layer_nr >= static_cast<int>(mesh.layers.size()) || mesh.settings.get<bool>(SettingKey::support_mesh) || mesh.settings.get<bool>(SettingKey::anti_overhang_mesh)
+                || mesh.settings.get<bool>(SettingKey::cutting_mesh) || mesh.settings.get<bool>(SettingKey::infill_mesh))
             {
                 continue;
             }
@@ -1142,7 +1380,7 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
             break;
         }
 
-        if (layer_nr < 0 && mesh_group_settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::RAFT)
+        if (layer_nr < 0 && mesh_group_settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::RAFT)
         {
             include_helper_parts = false;
         }
@@ -1158,9 +1396,9 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         {
             const ExtruderTrain& extruder = scene.extruders[extruder_nr];
 
-            if (extruder.settings_.get<bool>("travel_avoid_other_parts"))
+            if (extruder.settings_.get<bool>(SettingKey::travel_avoid_other_parts))
             {
-                avoid_distance = std::max(avoid_distance, extruder.settings_.get<coord_t>("travel_avoid_distance"));
+                avoid_distance = std::max(avoid_distance, extruder.settings_.get<coord_t>(SettingKey::travel_avoid_distance));
             }
         }
     }
@@ -1169,11 +1407,11 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
     for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
     {
         const auto& mesh = *mesh_ptr;
-        coord_t mesh_inner_wall_width = mesh.settings.get<coord_t>((mesh.settings.get<size_t>("wall_line_count") > 1) ? "wall_line_width_x" : "wall_line_width_0");
+        coord_t mesh_inner_wall_width = mesh.settings.get<coord_t>((mesh.settings.get<size_t>(SettingKey::wall_line_count) > 1) ? "wall_line_width_x" : "wall_line_width_0");
         if (layer_nr == 0)
         {
-            const ExtruderTrain& train = mesh.settings.get<ExtruderTrain&>((mesh.settings.get<size_t>("wall_line_count") > 1) ? "wall_0_extruder_nr" : "wall_x_extruder_nr");
-            mesh_inner_wall_width *= train.settings_.get<Ratio>("initial_layer_line_width_factor");
+            const ExtruderTrain& train = mesh.settings.get<ExtruderTrain&>((mesh.settings.get<size_t>(SettingKey::wall_line_count) > 1) ? "wall_0_extruder_nr" : "wall_x_extruder_nr");
+            mesh_inner_wall_width *= train.settings_.get<Ratio>(SettingKey::initial_layer_line_width_factor);
         }
         max_inner_wall_width = std::max(max_inner_wall_width, mesh_inner_wall_width);
     }
@@ -1186,7 +1424,7 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
 
     const std::vector<ExtruderUse> extruder_order = getExtruderUse(layer_nr);
 
-    const coord_t first_outer_wall_line_width = scene.extruders[first_extruder].settings_.get<coord_t>("wall_line_width_0");
+    const coord_t first_outer_wall_line_width = scene.extruders[first_extruder].settings_.get<coord_t>(SettingKey::wall_line_width_0);
     LayerPlan& gcode_layer = *new LayerPlan(
         storage,
         layer_nr,
@@ -1196,7 +1434,8 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         fan_speed_layer_time_settings_per_extruder,
         comb_offset_from_outlines,
         first_outer_wall_line_width,
-        avoid_distance);
+        avoid_distance,
+        &*base_path_configs);
     time_keeper.registerTime("Init");
 
     if (include_helper_parts)
@@ -1217,10 +1456,18 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         time_keeper.registerTime("Draft shield");
     }
 
-    const size_t support_roof_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("support_roof_extruder_nr").extruder_nr_;
-    const size_t support_bottom_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("support_bottom_extruder_nr").extruder_nr_;
-    const size_t support_infill_extruder_nr = (layer_nr <= 0) ? mesh_group_settings.get<ExtruderTrain&>("support_extruder_nr_layer_0").extruder_nr_
-                                                              : mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr").extruder_nr_;
+    // The sparse infill of the parts is generated for all of them at once, in parallel, and only added to the plan in print order afterwards.
+    InfillPathsPerPart infill_per_part;
+    if (layer_nr >= 0)
+    {
+        infill_per_part = generateSingleLayerInfill(storage, gcode_layer, extruder_order);
+        time_keeper.registerTime("Infill");
+    }
+
+    const size_t support_roof_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_roof_extruder_nr).extruder_nr_;
+    const size_t support_bottom_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_bottom_extruder_nr).extruder_nr_;
+    const size_t support_infill_extruder_nr = (layer_nr <= 0) ? mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_extruder_nr_layer_0).extruder_nr_
+                                                              : mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_infill_extruder_nr).extruder_nr_;
 
     for (const ExtruderUse& extruder_use : extruder_order)
     {
@@ -1250,16 +1497,16 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
             {
                 const std::shared_ptr<SliceMeshStorage>& mesh = storage.meshes[mesh_idx];
                 const MeshPathConfigs& mesh_config = gcode_layer.configs_storage_.mesh_configs[mesh_idx];
-                if (mesh->settings.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE
+                if (mesh->settings.get<ESurfaceMode>(SettingKey::magic_mesh_surface_mode) == ESurfaceMode::SURFACE
                     && extruder_nr
-                           == mesh->settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_ // mesh surface mode should always only be printed with the outer wall extruder!
+                           == mesh->settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_ // mesh surface mode should always only be printed with the outer wall extruder!
                 )
                 {
                     addMeshLayerToGCode_meshSurfaceMode(*mesh, mesh_config, gcode_layer);
                 }
                 else
                 {
-                    addMeshLayerToGCode(storage, mesh, extruder_nr, mesh_config, gcode_layer);
+                    addMeshLayerToGCode(storage, mesh, extruder_nr, mesh_config, gcode_layer, infill_per_part);
                 }
                 time_keeper.registerTime(fmt::format("Mesh {}", mesh_idx));
             }
@@ -1274,13 +1521,14 @@ FffGcodeWriter::ProcessLayerResult FffGcodeWriter::processLayer(const SliceDataS
         }
     }
 
+    gcode_layer.clearSolidBelow(); // All skins are planned.
     gcode_layer.applyModifyPlugin();
     time_keeper.registerTime("Modify plugin");
 
     gcode_layer.applyBackPressureCompensation();
     time_keeper.registerTime("Back pressure comp.");
 
-    return { &gcode_layer, timer_total.elapsed().count(), time_keeper.getRegisteredTimes() };
+    return { std::unique_ptr<LayerPlan>(&gcode_layer), timer_total.elapsed().count(), time_keeper.getRegisteredTimes() };
 }
 
 bool FffGcodeWriter::getExtruderNeedPrimeBlobDuringFirstLayer(const SliceDataStorage& storage, const size_t extruder_nr) const
@@ -1302,8 +1550,8 @@ bool FffGcodeWriter::getExtruderNeedPrimeBlobDuringFirstLayer(const SliceDataSto
 void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan& gcode_layer, unsigned int extruder_nr, LayerIndex layer_nr) const
 {
     const ExtruderTrain& train = Application::getInstance().current_slice_->scene.extruders[extruder_nr];
-    const int skirt_height = train.settings_.get<int>("skirt_height");
-    const bool is_skirt = train.settings_.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::SKIRT;
+    const int skirt_height = train.settings_.get<int>(SettingKey::skirt_height);
+    const bool is_skirt = train.settings_.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::SKIRT;
     // only create a multilayer SkirtBrim for a skirt for the height of skirt_height
     if (layer_nr != 0 && (layer_nr >= skirt_height || ! is_skirt))
     {
@@ -1323,10 +1571,10 @@ void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan
 
     // Start brim close to the prime location
     Point2LL start_close_to;
-    if (train.settings_.get<bool>("prime_blob_enable"))
+    if (train.settings_.get<bool>(SettingKey::prime_blob_enable))
     {
-        const auto prime_pos_is_abs = train.settings_.get<bool>("extruder_prime_pos_abs");
-        const auto prime_pos = Point2LL(train.settings_.get<coord_t>("extruder_prime_pos_x"), train.settings_.get<coord_t>("extruder_prime_pos_y"));
+        const auto prime_pos_is_abs = train.settings_.get<bool>(SettingKey::extruder_prime_pos_abs);
+        const auto prime_pos = Point2LL(train.settings_.get<coord_t>(SettingKey::extruder_prime_pos_x), train.settings_.get<coord_t>(SettingKey::extruder_prime_pos_y));
         start_close_to = prime_pos_is_abs ? prime_pos : gcode_layer.getLastPlannedPositionOrStartingPosition() + prime_pos;
     }
     else
@@ -1358,7 +1606,7 @@ void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan
 
     all_brim_lines.reserve(total_line_count);
 
-    const coord_t line_w = train.settings_.get<coord_t>("skirt_brim_line_width") * train.settings_.get<Ratio>("initial_layer_line_width_factor");
+    const coord_t line_w = train.settings_.get<coord_t>(SettingKey::skirt_brim_line_width) * train.settings_.get<Ratio>(SettingKey::initial_layer_line_width_factor);
     const coord_t searching_radius = line_w * 2;
     using GridT = SparsePointGridInclusive<BrimLineReference>;
     GridT grid(searching_radius);
@@ -1397,7 +1645,7 @@ void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan
         }
     }
 
-    const auto smart_brim_ordering = train.settings_.get<bool>("brim_smart_ordering") && train.settings_.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::BRIM;
+    const auto smart_brim_ordering = train.settings_.get<bool>(SettingKey::brim_smart_ordering) && train.settings_.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::BRIM;
     std::unordered_multimap<ConstPolygonPointer, ConstPolygonPointer> order_requirements;
     for (const std::pair<SquareGrid::GridPoint, SparsePointGridInclusiveImpl::SparsePointGridInclusiveElem<BrimLineReference>>& p : grid)
     {
@@ -1472,7 +1720,7 @@ void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan
     // Support brim is only added in layer 0
     // For support brim we don't care about the order, because support doesn't need to be accurate.
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    if ((layer_nr == 0) && (extruder_nr == mesh_group_settings.get<ExtruderTrain&>("support_extruder_nr_layer_0").extruder_nr_))
+    if ((layer_nr == 0) && (extruder_nr == mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_extruder_nr_layer_0).extruder_nr_))
     {
         total_line_count += storage.support_brim.size();
         Polygons support_brim_lines = storage.support_brim;
@@ -1494,7 +1742,7 @@ void FffGcodeWriter::processSkirtBrim(const SliceDataStorage& storage, LayerPlan
 void FffGcodeWriter::processOozeShield(const SliceDataStorage& storage, LayerPlan& gcode_layer) const
 {
     LayerIndex layer_nr = std::max(LayerIndex{ 0 }, gcode_layer.getLayerNr());
-    if (layer_nr == 0 && Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::BRIM)
+    if (layer_nr == 0 && Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::BRIM)
     {
         return; // ooze shield already generated by brim
     }
@@ -1512,20 +1760,20 @@ void FffGcodeWriter::processDraftShield(const SliceDataStorage& storage, LayerPl
     {
         return;
     }
-    if (! mesh_group_settings.get<bool>("draft_shield_enabled"))
+    if (! mesh_group_settings.get<bool>(SettingKey::draft_shield_enabled))
     {
         return;
     }
-    if (layer_nr == 0 && Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::BRIM)
+    if (layer_nr == 0 && Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) == EPlatformAdhesion::BRIM)
     {
         return; // draft shield already generated by brim
     }
 
-    if (mesh_group_settings.get<DraftShieldHeightLimitation>("draft_shield_height_limitation") == DraftShieldHeightLimitation::LIMITED)
+    if (mesh_group_settings.get<DraftShieldHeightLimitation>(SettingKey::draft_shield_height_limitation) == DraftShieldHeightLimitation::LIMITED)
     {
-        const coord_t draft_shield_height = mesh_group_settings.get<coord_t>("draft_shield_height");
-        const coord_t layer_height_0 = mesh_group_settings.get<coord_t>("layer_height_0");
-        const coord_t layer_height = mesh_group_settings.get<coord_t>("layer_height");
+        const coord_t draft_shield_height = mesh_group_settings.get<coord_t>(SettingKey::draft_shield_height);
+        const coord_t layer_height_0 = mesh_group_settings.get<coord_t>(SettingKey::layer_height_0);
+        const coord_t layer_height = mesh_group_settings.get<coord_t>(SettingKey::layer_height);
         const LayerIndex max_screen_layer = (draft_shield_height - layer_height_0) / layer_height + 1;
         if (layer_nr > max_screen_layer)
         {
@@ -1552,7 +1800,7 @@ void FffGcodeWriter::calculateExtruderOrderPerLayer(const SliceDataStorage& stor
 
     size_t extruder_count = Application::getInstance().current_slice_->scene.extruders.size();
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    PrimeTowerMethod prime_tower_mode = mesh_group_settings.get<PrimeTowerMethod>("prime_tower_mode");
+    PrimeTowerMethod prime_tower_mode = mesh_group_settings.get<PrimeTowerMethod>(SettingKey::prime_tower_mode);
     for (LayerIndex layer_nr = -Raft::getTotalExtraLayers(); layer_nr < static_cast<LayerIndex>(storage.print_layer_count); layer_nr++)
     {
         std::vector<std::vector<ExtruderUse>>& extruder_order_per_layer_here = (layer_nr < 0) ? extruder_order_per_layer_negative_layers : extruder_order_per_layer;
@@ -1588,8 +1836,8 @@ std::vector<ExtruderUse> FffGcodeWriter::getUsedExtrudersOnLayer(const SliceData
     assert(static_cast<int>(extruder_count) > 0);
     std::vector<ExtruderUse> ret;
     std::vector<bool> extruder_is_used_on_this_layer = storage.getExtrudersUsed(layer_nr);
-    const auto method = mesh_group_settings.get<PrimeTowerMethod>("prime_tower_mode");
-    const auto prime_tower_enable = mesh_group_settings.get<bool>("prime_tower_enable");
+    const auto method = mesh_group_settings.get<PrimeTowerMethod>(SettingKey::prime_tower_mode);
+    const auto prime_tower_enable = mesh_group_settings.get<bool>(SettingKey::prime_tower_enable);
 
     // check if we are on the first layer
     if (layer_nr == -static_cast<LayerIndex>(Raft::getTotalExtraLayers()))
@@ -1677,7 +1925,7 @@ std::vector<size_t> FffGcodeWriter::calculateMeshOrder(const SliceDataStorage& s
         }
     }
     const ExtruderTrain& train = Application::getInstance().current_slice_->scene.extruders[extruder_nr];
-    const Point2LL layer_start_position(train.settings_.get<coord_t>("layer_start_x"), train.settings_.get<coord_t>("layer_start_y"));
+    const Point2LL layer_start_position(train.settings_.get<coord_t>(SettingKey::layer_start_x), train.settings_.get<coord_t>(SettingKey::layer_start_y));
     std::list<size_t> mesh_indices_order = mesh_idx_order_optimizer.optimize(layer_start_position);
 
     std::vector<size_t> ret;
@@ -1698,7 +1946,7 @@ void FffGcodeWriter::addMeshLayerToGCode_meshSurfaceMode(const SliceMeshStorage&
         return;
     }
 
-    if (mesh.settings.get<bool>("anti_overhang_mesh") || mesh.settings.get<bool>("support_mesh"))
+    if (mesh.settings.get<bool>(SettingKey::anti_overhang_mesh) || mesh.settings.get<bool>(SettingKey::support_mesh))
     {
         return;
     }
@@ -1718,12 +1966,12 @@ void FffGcodeWriter::addMeshLayerToGCode_meshSurfaceMode(const SliceMeshStorage&
     polygons = Simplify(mesh.settings).polygon(polygons);
 
     ZSeamConfig z_seam_config(
-        mesh.settings.get<EZSeamType>("z_seam_type"),
+        mesh.settings.get<EZSeamType>(SettingKey::z_seam_type),
         mesh.getZSeamHint(),
-        mesh.settings.get<EZSeamCornerPrefType>("z_seam_corner"),
-        mesh.settings.get<coord_t>("wall_line_width_0") * 2);
-    const bool spiralize = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>("magic_spiralize");
-    gcode_layer.addPolygonsByOptimizer(polygons, mesh_config.inset0_config, z_seam_config, mesh.settings.get<coord_t>("wall_0_wipe_dist"), spiralize);
+        mesh.settings.get<EZSeamCornerPrefType>(SettingKey::z_seam_corner),
+        mesh.settings.get<coord_t>(SettingKey::wall_line_width_0) * 2);
+    const bool spiralize = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>(SettingKey::magic_spiralize);
+    gcode_layer.addPolygonsByOptimizer(polygons, mesh_config.inset0_config, z_seam_config, mesh.settings.get<coord_t>(SettingKey::wall_0_wipe_dist), spiralize);
 
     addMeshOpenPolyLinesToGCode(mesh, mesh_config, gcode_layer);
 }
@@ -1740,7 +1988,8 @@ void FffGcodeWriter::addMeshLayerToGCode(
     const std::shared_ptr<SliceMeshStorage>& mesh_ptr,
     const size_t extruder_nr,
     const MeshPathConfigs& mesh_config,
-    LayerPlan& gcode_layer) const
+    LayerPlan& gcode_layer,
+    const InfillPathsPerPart& infill_per_part) const
 {
     const auto& mesh = *mesh_ptr;
     if (gcode_layer.getLayerNr() > mesh.layer_nr_max_filled_layer)
@@ -1748,7 +1997,7 @@ void FffGcodeWriter::addMeshLayerToGCode(
         return;
     }
 
-    if (mesh.settings.get<bool>("anti_overhang_mesh") || mesh.settings.get<bool>("support_mesh"))
+    if (mesh.settings.get<bool>(SettingKey::anti_overhang_mesh) || mesh.settings.get<bool>(SettingKey::support_mesh))
     {
         return;
     }
@@ -1766,10 +2015,10 @@ void FffGcodeWriter::addMeshLayerToGCode(
     if (mesh.isPrinted()) //"normal" meshes with walls, skin, infill, etc. get the traditional part ordering based on the z-seam settings.
     {
         z_seam_config = ZSeamConfig(
-            mesh.settings.get<EZSeamType>("z_seam_type"),
+            mesh.settings.get<EZSeamType>(SettingKey::z_seam_type),
             mesh.getZSeamHint(),
-            mesh.settings.get<EZSeamCornerPrefType>("z_seam_corner"),
-            mesh.settings.get<coord_t>("wall_line_width_0") * 2);
+            mesh.settings.get<EZSeamCornerPrefType>(SettingKey::z_seam_corner),
+            mesh.settings.get<coord_t>(SettingKey::wall_line_width_0) * 2);
     }
     PathOrderOptimizer<const SliceLayerPart*> part_order_optimizer(gcode_layer.getLastPlannedPositionOrStartingPosition(), z_seam_config);
     for (const SliceLayerPart& part : layer.parts)
@@ -1785,15 +2034,15 @@ void FffGcodeWriter::addMeshLayerToGCode(
 
     for (const PathOrdering<const SliceLayerPart*>& path : part_order_optimizer.paths_)
     {
-        addMeshPartToGCode(storage, mesh, extruder_nr, mesh_config, *path.vertices_, gcode_layer);
+        addMeshPartToGCode(storage, mesh, extruder_nr, mesh_config, *path.vertices_, gcode_layer, infill_per_part);
     }
 
-    const std::string extruder_identifier = (mesh.settings.get<size_t>("roofing_layer_count") > 0) ? "roofing_extruder_nr" : "top_bottom_extruder_nr";
+    const std::string extruder_identifier = (mesh.settings.get<size_t>(SettingKey::roofing_layer_count) > 0) ? "roofing_extruder_nr" : "top_bottom_extruder_nr";
     if (extruder_nr == mesh.settings.get<ExtruderTrain&>(extruder_identifier).extruder_nr_)
     {
         processIroning(storage, mesh, layer, mesh_config.ironing_config, gcode_layer);
     }
-    if (mesh.settings.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::NORMAL && extruder_nr == mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_)
+    if (mesh.settings.get<ESurfaceMode>(SettingKey::magic_mesh_surface_mode) != ESurfaceMode::NORMAL && extruder_nr == mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_)
     {
         addMeshOpenPolyLinesToGCode(mesh, mesh_config, gcode_layer);
     }
@@ -1806,34 +2055,35 @@ void FffGcodeWriter::addMeshPartToGCode(
     const size_t extruder_nr,
     const MeshPathConfigs& mesh_config,
     const SliceLayerPart& part,
-    LayerPlan& gcode_layer) const
+    LayerPlan& gcode_layer,
+    const InfillPathsPerPart& infill_per_part) const
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
 
     bool added_something = false;
 
-    if (mesh.settings.get<bool>("infill_before_walls"))
+    if (mesh.settings.get<bool>(SettingKey::infill_before_walls))
     {
-        added_something = added_something | processInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
+        added_something = added_something | processInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part, infill_per_part);
     }
 
     added_something = added_something | processInsets(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
 
-    if (! mesh.settings.get<bool>("infill_before_walls"))
+    if (! mesh.settings.get<bool>(SettingKey::infill_before_walls))
     {
-        added_something = added_something | processInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
+        added_something = added_something | processInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part, infill_per_part);
     }
 
     added_something = added_something | processSkin(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
 
     // After a layer part, make sure the nozzle is inside the comb boundary, so we do not retract on the perimeter.
     if (added_something
-        && (! mesh_group_settings.get<bool>("magic_spiralize") || gcode_layer.getLayerNr() < static_cast<LayerIndex>(mesh.settings.get<size_t>("initial_bottom_layers"))))
+        && (! mesh_group_settings.get<bool>(SettingKey::magic_spiralize) || gcode_layer.getLayerNr() < static_cast<LayerIndex>(mesh.settings.get<size_t>(SettingKey::initial_bottom_layers))))
     {
-        coord_t innermost_wall_line_width = mesh.settings.get<coord_t>((mesh.settings.get<size_t>("wall_line_count") > 1) ? "wall_line_width_x" : "wall_line_width_0");
+        coord_t innermost_wall_line_width = mesh.settings.get<coord_t>((mesh.settings.get<size_t>(SettingKey::wall_line_count) > 1) ? "wall_line_width_x" : "wall_line_width_0");
         if (gcode_layer.getLayerNr() == 0)
         {
-            innermost_wall_line_width *= mesh.settings.get<Ratio>("initial_layer_line_width_factor");
+            innermost_wall_line_width *= mesh.settings.get<Ratio>(SettingKey::initial_layer_line_width_factor);
         }
         gcode_layer.moveInsideCombBoundary(innermost_wall_line_width, part);
     }
@@ -1847,14 +2097,15 @@ bool FffGcodeWriter::processInfill(
     const SliceMeshStorage& mesh,
     const size_t extruder_nr,
     const MeshPathConfigs& mesh_config,
-    const SliceLayerPart& part) const
+    const SliceLayerPart& part,
+    const InfillPathsPerPart& infill_per_part) const
 {
-    if (extruder_nr != mesh.settings.get<ExtruderTrain&>("infill_extruder_nr").extruder_nr_)
+    if (extruder_nr != mesh.settings.get<ExtruderTrain&>(SettingKey::infill_extruder_nr).extruder_nr_)
     {
         return false;
     }
     bool added_something = processMultiLayerInfill(gcode_layer, mesh, extruder_nr, mesh_config, part);
-    added_something = added_something | processSingleLayerInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part);
+    added_something = added_something | processSingleLayerInfill(storage, gcode_layer, mesh, extruder_nr, mesh_config, part, infill_per_part);
     return added_something;
 }
 
@@ -1865,45 +2116,45 @@ bool FffGcodeWriter::processMultiLayerInfill(
     const MeshPathConfigs& mesh_config,
     const SliceLayerPart& part) const
 {
-    if (extruder_nr != mesh.settings.get<ExtruderTrain&>("infill_extruder_nr").extruder_nr_)
+    if (extruder_nr != mesh.settings.get<ExtruderTrain&>(SettingKey::infill_extruder_nr).extruder_nr_)
     {
         return false;
     }
-    const coord_t infill_line_distance = mesh.settings.get<coord_t>("infill_line_distance");
+    const coord_t infill_line_distance = mesh.settings.get<coord_t>(SettingKey::infill_line_distance);
     if (infill_line_distance <= 0)
     {
         return false;
     }
-    coord_t max_resolution = mesh.settings.get<coord_t>("meshfix_maximum_resolution");
-    coord_t max_deviation = mesh.settings.get<coord_t>("meshfix_maximum_deviation");
+    coord_t max_resolution = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    coord_t max_deviation = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
     AngleDegrees infill_angle = 45; // Original default. This will get updated to an element from mesh->infill_angles.
     if (! mesh.infill_angles.empty())
     {
         const size_t combined_infill_layers
-            = std::max(uint64_t(1), round_divide(mesh.settings.get<coord_t>("infill_sparse_thickness"), std::max(mesh.settings.get<coord_t>("layer_height"), coord_t(1))));
+            = std::max(uint64_t(1), round_divide(mesh.settings.get<coord_t>(SettingKey::infill_sparse_thickness), std::max(mesh.settings.get<coord_t>(SettingKey::layer_height), coord_t(1))));
         infill_angle = mesh.infill_angles.at((gcode_layer.getLayerNr() / combined_infill_layers) % mesh.infill_angles.size());
     }
     const Point3LL mesh_middle = mesh.bounding_box.getMiddle();
-    const Point2LL infill_origin(mesh_middle.x_ + mesh.settings.get<coord_t>("infill_offset_x"), mesh_middle.y_ + mesh.settings.get<coord_t>("infill_offset_y"));
+    const Point2LL infill_origin(mesh_middle.x_ + mesh.settings.get<coord_t>(SettingKey::infill_offset_x), mesh_middle.y_ + mesh.settings.get<coord_t>(SettingKey::infill_offset_y));
 
     // Print the thicker infill lines first. (double or more layer thickness, infill combined with previous layers)
     bool added_something = false;
-    for (unsigned int combine_idx = 1; combine_idx < part.infill_area_per_combine_per_density[0].size(); combine_idx++)
+    for (unsigned int combine_idx = 1; combine_idx < part.getInfillAreaPerCombinePerDensity()[0].size(); combine_idx++)
     {
         const coord_t infill_line_width = mesh_config.infill_config[combine_idx].getLineWidth();
-        const EFillMethod infill_pattern = mesh.settings.get<EFillMethod>("infill_pattern");
-        const bool zig_zaggify_infill = mesh.settings.get<bool>("zig_zaggify_infill") || infill_pattern == EFillMethod::ZIG_ZAG;
-        const bool connect_polygons = mesh.settings.get<bool>("connect_infill_polygons");
-        const size_t infill_multiplier = mesh.settings.get<size_t>("infill_multiplier");
+        const EFillMethod infill_pattern = mesh.settings.get<EFillMethod>(SettingKey::infill_pattern);
+        const bool zig_zaggify_infill = mesh.settings.get<bool>(SettingKey::zig_zaggify_infill) || infill_pattern == EFillMethod::ZIG_ZAG;
+        const bool connect_polygons = mesh.settings.get<bool>(SettingKey::connect_infill_polygons);
+        const size_t infill_multiplier = mesh.settings.get<size_t>(SettingKey::infill_multiplier);
         Polygons infill_polygons;
         Polygons infill_lines;
         std::vector<VariableWidthLines> infill_paths = part.infill_wall_toolpaths;
-        for (size_t density_idx = part.infill_area_per_combine_per_density.size() - 1; (int)density_idx >= 0; density_idx--)
+        for (size_t density_idx = part.getInfillAreaPerCombinePerDensity().size() - 1; (int)density_idx >= 0; density_idx--)
         { // combine different density infill areas (for gradual infill)
             size_t density_factor = 2 << density_idx; // == pow(2, density_idx + 1)
             coord_t infill_line_distance_here = infill_line_distance * density_factor; // the highest density infill combines with the next to create a grid with density_factor 1
             coord_t infill_shift = infill_line_distance_here / 2;
-            if (density_idx == part.infill_area_per_combine_per_density.size() - 1 || infill_pattern == EFillMethod::CROSS || infill_pattern == EFillMethod::CROSS_3D)
+            if (density_idx == part.getInfillAreaPerCombinePerDensity().size() - 1 || infill_pattern == EFillMethod::CROSS || infill_pattern == EFillMethod::CROSS_3D)
             {
                 infill_line_distance_here /= 2;
             }
@@ -1927,7 +2178,7 @@ bool FffGcodeWriter::processMultiLayerInfill(
                 infill_pattern,
                 zig_zaggify_infill,
                 connect_polygons,
-                part.infill_area_per_combine_per_density[density_idx][combine_idx],
+                part.getInfillAreaPerCombinePerDensity()[density_idx][combine_idx],
                 infill_line_width,
                 infill_line_distance_here,
                 infill_overlap,
@@ -1946,7 +2197,7 @@ bool FffGcodeWriter::processMultiLayerInfill(
                 use_endpieces,
                 skip_some_zags,
                 zag_skip_count,
-                mesh.settings.get<coord_t>("cross_infill_pocket_size"));
+                mesh.settings.get<coord_t>(SettingKey::cross_infill_pocket_size));
             infill_comp.generate(
                 infill_paths,
                 infill_polygons,
@@ -1973,13 +2224,13 @@ bool FffGcodeWriter::processMultiLayerInfill(
             if (! infill_lines.empty())
             {
                 std::optional<Point2LL> near_start_location;
-                if (mesh.settings.get<bool>("infill_randomize_start_location"))
+                if (mesh.settings.get<bool>(SettingKey::infill_randomize_start_location))
                 {
-                    srand(gcode_layer.getLayerNr());
-                    near_start_location = infill_lines[rand() % infill_lines.size()][0];
+                    CounterRandom random = gcode_layer.getRandom();
+                    near_start_location = infill_lines[random.below(infill_lines.size())][0];
                 }
 
-                const bool enable_travel_optimization = mesh.settings.get<bool>("infill_enable_travel_optimization");
+                const bool enable_travel_optimization = mesh.settings.get<bool>(SettingKey::infill_enable_travel_optimization);
                 gcode_layer.addLinesByOptimizer(
                     infill_lines,
                     mesh_config.infill_config[combine_idx],
@@ -1987,56 +2238,111 @@ bool FffGcodeWriter::processMultiLayerInfill(
                     enable_travel_optimization,
                     /*wipe_dist = */ 0,
                     /* flow = */ 1.0,
-                    near_start_location);
+                    near_start_location,
+                    GCodePathConfig::FAN_SPEED_DEFAULT,
+                    /*reverse_print_direction = */ false,
+                    PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_,
+                    getTravelImprovementTime(mesh.settings, "infill_travel_improvement_time"));
             }
         }
     }
     return added_something;
 }
 
-bool FffGcodeWriter::processSingleLayerInfill(
-    const SliceDataStorage& storage,
-    LayerPlan& gcode_layer,
-    const SliceMeshStorage& mesh,
-    const size_t extruder_nr,
-    const MeshPathConfigs& mesh_config,
-    const SliceLayerPart& part) const
+bool FffGcodeWriter::hasSingleLayerInfill(const SliceMeshStorage& mesh, const SliceLayerPart& part)
 {
-    if (extruder_nr != mesh.settings.get<ExtruderTrain&>("infill_extruder_nr").extruder_nr_)
+    return mesh.settings.get<coord_t>(SettingKey::infill_line_distance) != 0 && ! part.getInfillAreaPerCombinePerDensity()[0].empty();
+}
+
+FffGcodeWriter::InfillPathsPerPart
+    FffGcodeWriter::generateSingleLayerInfill(const SliceDataStorage& storage, const LayerPlan& gcode_layer, const std::vector<ExtruderUse>& extruder_order)
+{
+    struct InfillTask
     {
-        return false;
+        size_t mesh_idx;
+        const SliceLayerPart* part;
+    };
+    std::vector<InfillTask> tasks;
+    for (size_t mesh_idx = 0; mesh_idx < storage.meshes.size(); mesh_idx++)
+    {
+        const SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
+        if (gcode_layer.getLayerNr() > mesh.layer_nr_max_filled_layer || mesh.settings.get<bool>(SettingKey::anti_overhang_mesh)
+            || mesh.settings.get<bool>(SettingKey::support_mesh) || mesh.settings.get<ESurfaceMode>(SettingKey::magic_mesh_surface_mode) == ESurfaceMode::SURFACE)
+        {
+            continue;
+        }
+        const size_t infill_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::infill_extruder_nr).extruder_nr_;
+        const auto is_infill_extruder = [infill_extruder_nr](const ExtruderUse& extruder_use)
+        {
+            return extruder_use.extruder_nr == infill_extruder_nr;
+        };
+        if (std::none_of(extruder_order.begin(), extruder_order.end(), is_infill_extruder))
+        {
+            continue;
+        }
+        for (const SliceLayerPart& part : mesh.layers[gcode_layer.getLayerNr()].parts)
+        {
+            if (! part.outline.empty() && hasSingleLayerInfill(mesh, part))
+            {
+                tasks.push_back({ mesh_idx, &part });
+            }
+        }
     }
-    const auto infill_line_distance = mesh.settings.get<coord_t>("infill_line_distance");
-    if (infill_line_distance == 0 || part.infill_area_per_combine_per_density[0].empty())
+
+    std::vector<SingleLayerInfillPaths> task_paths(tasks.size());
+    cura::parallel_for<size_t>(
+        0,
+        tasks.size(),
+        [&](const size_t task_idx)
+        {
+            const InfillTask& task = tasks[task_idx];
+            const MeshPathConfigs& mesh_config = gcode_layer.configs_storage_.mesh_configs[task.mesh_idx];
+            task_paths[task_idx] = generateSingleLayerInfill(*storage.meshes[task.mesh_idx], mesh_config, *task.part, gcode_layer.getLayerNr(), gcode_layer.z_);
+        });
+
+    InfillPathsPerPart infill_per_part;
+    infill_per_part.reserve(tasks.size());
+    for (size_t task_idx = 0; task_idx < tasks.size(); task_idx++)
     {
-        return false;
+        infill_per_part.emplace(tasks[task_idx].part, std::move(task_paths[task_idx]));
     }
-    bool added_something = false;
+    return infill_per_part;
+}
+
+FffGcodeWriter::SingleLayerInfillPaths FffGcodeWriter::generateSingleLayerInfill(
+    const SliceMeshStorage& mesh,
+    const MeshPathConfigs& mesh_config,
+    const SliceLayerPart& part,
+    const LayerIndex layer_nr,
+    const coord_t z)
+{
+    const auto infill_line_distance = mesh.settings.get<coord_t>(SettingKey::infill_line_distance);
     const coord_t infill_line_width = mesh_config.infill_config[0].getLineWidth();
 
     // Combine the 1 layer thick infill with the top/bottom skin and print that as one thing.
-    Polygons infill_polygons;
-    std::vector<std::vector<VariableWidthLines>> wall_tool_paths; // All wall toolpaths binned by inset_idx (inner) and by density_idx (outer)
-    Polygons infill_lines;
-
-    const auto pattern = mesh.settings.get<EFillMethod>("infill_pattern");
-    const bool zig_zaggify_infill = mesh.settings.get<bool>("zig_zaggify_infill") || pattern == EFillMethod::ZIG_ZAG;
-    const bool connect_polygons = mesh.settings.get<bool>("connect_infill_polygons");
-    const auto infill_overlap = mesh.settings.get<coord_t>("infill_overlap_mm");
-    const auto infill_multiplier = mesh.settings.get<size_t>("infill_multiplier");
-    const auto wall_line_count = mesh.settings.get<size_t>("infill_wall_line_count");
-    const size_t last_idx = part.infill_area_per_combine_per_density.size() - 1;
-    const auto max_resolution = mesh.settings.get<coord_t>("meshfix_maximum_resolution");
-    const auto max_deviation = mesh.settings.get<coord_t>("meshfix_maximum_deviation");
+    SingleLayerInfillPaths paths;
+    Polygons& infill_polygons = paths.infill_polygons;
+    std::vector<std::vector<VariableWidthLines>>& wall_tool_paths = paths.wall_tool_paths;
+    Polygons& infill_lines = paths.infill_lines;
+
+    const auto pattern = mesh.settings.get<EFillMethod>(SettingKey::infill_pattern);
+    const bool zig_zaggify_infill = mesh.settings.get<bool>(SettingKey::zig_zaggify_infill) || pattern == EFillMethod::ZIG_ZAG;
+    const bool connect_polygons = mesh.settings.get<bool>(SettingKey::connect_infill_polygons);
+    const auto infill_overlap = mesh.settings.get<coord_t>(SettingKey::infill_overlap_mm);
+    const auto infill_multiplier = mesh.settings.get<size_t>(SettingKey::infill_multiplier);
+    const auto wall_line_count = mesh.settings.get<size_t>(SettingKey::infill_wall_line_count);
+    const size_t last_idx = part.getInfillAreaPerCombinePerDensity().size() - 1;
+    const auto max_resolution = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const auto max_deviation = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
     AngleDegrees infill_angle = 45; // Original default. This will get updated to an element from mesh->infill_angles.
     if (! mesh.infill_angles.empty())
     {
         const size_t combined_infill_layers
-            = std::max(uint64_t(1), round_divide(mesh.settings.get<coord_t>("infill_sparse_thickness"), std::max(mesh.settings.get<coord_t>("layer_height"), coord_t(1))));
-        infill_angle = mesh.infill_angles.at((static_cast<size_t>(gcode_layer.getLayerNr()) / combined_infill_layers) % mesh.infill_angles.size());
+            = std::max(uint64_t(1), round_divide(mesh.settings.get<coord_t>(SettingKey::infill_sparse_thickness), std::max(mesh.settings.get<coord_t>(SettingKey::layer_height), coord_t(1))));
+        infill_angle = mesh.infill_angles.at((static_cast<size_t>(layer_nr) / combined_infill_layers) % mesh.infill_angles.size());
     }
     const Point3LL mesh_middle = mesh.bounding_box.getMiddle();
-    const Point2LL infill_origin(mesh_middle.x_ + mesh.settings.get<coord_t>("infill_offset_x"), mesh_middle.y_ + mesh.settings.get<coord_t>("infill_offset_y"));
+    const Point2LL infill_origin(mesh_middle.x_ + mesh.settings.get<coord_t>(SettingKey::infill_offset_x), mesh_middle.y_ + mesh.settings.get<coord_t>(SettingKey::infill_offset_y));
 
     auto get_cut_offset = [](const bool zig_zaggify, const coord_t line_width, const size_t line_count)
     {
@@ -2047,25 +2353,25 @@ bool FffGcodeWriter::processSingleLayerInfill(
         return -static_cast<coord_t>(line_count) * line_width;
     };
 
-    Polygons sparse_in_outline = part.infill_area_per_combine_per_density[last_idx][0];
+    Polygons sparse_in_outline = part.getInfillAreaPerCombinePerDensity()[last_idx][0];
 
     // if infill walls are required below the boundaries of skin regions above, partition the infill along the
     // boundary edge
     Polygons infill_below_skin;
     Polygons infill_not_below_skin;
-    const bool hasSkinEdgeSupport = partitionInfillBySkinAbove(infill_below_skin, infill_not_below_skin, gcode_layer, mesh, part, infill_line_width);
+    const bool hasSkinEdgeSupport = partitionInfillBySkinAbove(infill_below_skin, infill_not_below_skin, layer_nr, mesh, part, infill_line_width);
 
-    const auto pocket_size = mesh.settings.get<coord_t>("cross_infill_pocket_size");
+    const auto pocket_size = mesh.settings.get<coord_t>(SettingKey::cross_infill_pocket_size);
     constexpr bool skip_stitching = false;
     constexpr bool connected_zigzags = false;
-    const bool use_endpieces = part.infill_area_per_combine_per_density.size() == 1; // Only use endpieces when not using gradual infill, since they will then overlap.
+    const bool use_endpieces = part.getInfillAreaPerCombinePerDensity().size() == 1; // Only use endpieces when not using gradual infill, since they will then overlap.
     constexpr bool skip_some_zags = false;
     constexpr int zag_skip_count = 0;
 
     for (size_t density_idx = last_idx; static_cast<int>(density_idx) >= 0; density_idx--)
     {
         // Only process dense areas when they're initialized
-        if (part.infill_area_per_combine_per_density[density_idx][0].empty())
+        if (part.getInfillAreaPerCombinePerDensity()[density_idx][0].empty())
         {
             continue;
         }
@@ -2094,7 +2400,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
          */
 
         // All of that doesn't hold for the Cross patterns; they should just always be multiplied by 2.
-        if (density_idx == part.infill_area_per_combine_per_density.size() - 1 || pattern == EFillMethod::CROSS || pattern == EFillMethod::CROSS_3D)
+        if (density_idx == part.getInfillAreaPerCombinePerDensity().size() - 1 || pattern == EFillMethod::CROSS || pattern == EFillMethod::CROSS_3D)
         {
             /* the least dense infill should fill up all remaining gaps
              :       |       :       |       :       |       :       |       :  > furthest from top
@@ -2112,12 +2418,12 @@ bool FffGcodeWriter::processSingleLayerInfill(
             infill_line_distance_here /= 2;
         }
 
-        Polygons in_outline = part.infill_area_per_combine_per_density[density_idx][0];
+        Polygons in_outline = part.getInfillAreaPerCombinePerDensity()[density_idx][0];
 
         std::shared_ptr<LightningLayer> lightning_layer;
         if (mesh.lightning_generator)
         {
-            lightning_layer = std::make_shared<LightningLayer>(mesh.lightning_generator->getTreesForLayer(gcode_layer.getLayerNr()));
+            lightning_layer = std::make_shared<LightningLayer>(mesh.lightning_generator->getTreesForLayer(layer_nr));
         }
 
         const bool fill_gaps = density_idx == 0; // Only fill gaps in the lowest infill density pattern.
@@ -2139,7 +2445,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
                 overlap,
                 infill_multiplier,
                 infill_angle,
-                gcode_layer.z_,
+                z,
                 infill_shift,
                 max_resolution,
                 max_deviation,
@@ -2158,7 +2464,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
                 infill_polygons,
                 infill_lines,
                 mesh.settings,
-                gcode_layer.getLayerNr(),
+                layer_nr,
                 SectionType::INFILL,
                 mesh.cross_fill_provider,
                 lightning_layer,
@@ -2204,7 +2510,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
             overlap,
             infill_multiplier,
             infill_angle,
-            gcode_layer.z_,
+            z,
             infill_shift,
             max_resolution,
             max_deviation,
@@ -2223,7 +2529,7 @@ bool FffGcodeWriter::processSingleLayerInfill(
             infill_polygons,
             infill_lines,
             mesh.settings,
-            gcode_layer.getLayerNr(),
+            layer_nr,
             SectionType::INFILL,
             mesh.cross_fill_provider,
             lightning_layer,
@@ -2239,6 +2545,39 @@ bool FffGcodeWriter::processSingleLayerInfill(
     }
 
     wall_tool_paths.emplace_back(part.infill_wall_toolpaths); // The extra infill walls were generated separately. Add these too.
+    return paths;
+}
+
+bool FffGcodeWriter::processSingleLayerInfill(
+    const SliceDataStorage& storage,
+    LayerPlan& gcode_layer,
+    const SliceMeshStorage& mesh,
+    const size_t extruder_nr,
+    const MeshPathConfigs& mesh_config,
+    const SliceLayerPart& part,
+    const InfillPathsPerPart& infill_per_part) const
+{
+    if (extruder_nr != mesh.settings.get<ExtruderTrain&>(SettingKey::infill_extruder_nr).extruder_nr_)
+    {
+        return false;
+    }
+    if (! hasSingleLayerInfill(mesh, part))
+    {
+        return false;
+    }
+    bool added_something = false;
+
+    // The paths were usually generated for all parts of the layer at once. Otherwise they are generated here.
+    std::optional<SingleLayerInfillPaths> generated_paths;
+    const auto pregenerated_paths = infill_per_part.find(&part);
+    const SingleLayerInfillPaths& paths = pregenerated_paths != infill_per_part.end()
+                                            ? pregenerated_paths->second
+                                            : generated_paths.emplace(generateSingleLayerInfill(mesh, mesh_config, part, gcode_layer.getLayerNr(), gcode_layer.z_));
+    const Polygons& infill_polygons = paths.infill_polygons;
+    const std::vector<std::vector<VariableWidthLines>>& wall_tool_paths = paths.wall_tool_paths;
+    const Polygons& infill_lines = paths.infill_lines;
+    const auto pattern = mesh.settings.get<EFillMethod>(SettingKey::infill_pattern);
+
     const bool walls_generated = std::any_of(
         wall_tool_paths.cbegin(),
         wall_tool_paths.cend(),
@@ -2259,25 +2598,25 @@ bool FffGcodeWriter::processSingleLayerInfill(
         added_something = true;
         gcode_layer.setIsInside(true); // going to print stuff inside print object
         std::optional<Point2LL> near_start_location;
-        if (mesh.settings.get<bool>("infill_randomize_start_location"))
+        if (mesh.settings.get<bool>(SettingKey::infill_randomize_start_location))
         {
-            srand(gcode_layer.getLayerNr());
+            CounterRandom random = gcode_layer.getRandom();
             if (! infill_lines.empty())
             {
-                near_start_location = infill_lines[rand() % infill_lines.size()][0];
+                near_start_location = infill_lines[random.below(infill_lines.size())][0];
             }
             else if (! infill_polygons.empty())
             {
-                PolygonRef start_poly = infill_polygons[rand() % infill_polygons.size()];
-                near_start_location = start_poly[rand() % start_poly.size()];
+                ConstPolygonRef start_poly = infill_polygons[random.below(infill_polygons.size())];
+                near_start_location = start_poly[random.below(start_poly.size())];
             }
             else // So walls_generated must be true.
             {
-                std::vector<VariableWidthLines>* start_paths = &wall_tool_paths[rand() % wall_tool_paths.size()];
+                const std::vector<VariableWidthLines>* start_paths = &wall_tool_paths[random.below(wall_tool_paths.size())];
                 while (start_paths->empty() || (*start_paths)[0].empty()) // We know for sure (because walls_generated) that one of them is not empty. So randomise until we hit
                                                                           // it. Should almost always be very quick.
                 {
-                    start_paths = &wall_tool_paths[rand() % wall_tool_paths.size()];
+                    start_paths = &wall_tool_paths[random.below(wall_tool_paths.size())];
                 }
                 near_start_location = (*start_paths)[0][0].junctions_[0].p_;
             }
@@ -2289,9 +2628,9 @@ bool FffGcodeWriter::processSingleLayerInfill(
                 constexpr bool retract_before_outer_wall = false;
                 constexpr coord_t wipe_dist = 0;
                 const ZSeamConfig z_seam_config(
-                    mesh.settings.get<EZSeamType>("z_seam_type"),
+                    mesh.settings.get<EZSeamType>(SettingKey::z_seam_type),
                     mesh.getZSeamHint(),
-                    mesh.settings.get<EZSeamCornerPrefType>("z_seam_corner"),
+                    mesh.settings.get<EZSeamCornerPrefType>(SettingKey::z_seam_corner),
                     mesh_config.infill_config[0].getLineWidth() * 2);
                 InsetOrderOptimizer wall_orderer(
                     *this,
@@ -2322,7 +2661,8 @@ bool FffGcodeWriter::processSingleLayerInfill(
             gcode_layer.addTravel(PolygonUtils::findNearestVert(gcode_layer.getLastPlannedPositionOrStartingPosition(), infill_polygons).p(), force_comb_retract);
             gcode_layer.addPolygonsByOptimizer(infill_polygons, mesh_config.infill_config[0], ZSeamConfig(), 0, false, 1.0_r, false, false, near_start_location);
         }
-        const bool enable_travel_optimization = mesh.settings.get<bool>("infill_enable_travel_optimization");
+        const bool enable_travel_optimization = mesh.settings.get<bool>(SettingKey::infill_enable_travel_optimization);
+        const Duration travel_improvement_time = getTravelImprovementTime(mesh.settings, "infill_travel_improvement_time");
         if (pattern == EFillMethod::GRID || pattern == EFillMethod::LINES || pattern == EFillMethod::TRIANGLES || pattern == EFillMethod::CUBIC
             || pattern == EFillMethod::TETRAHEDRAL || pattern == EFillMethod::QUARTER_CUBIC || pattern == EFillMethod::CUBICSUBDIV || pattern == EFillMethod::LIGHTNING)
         {
@@ -2331,9 +2671,13 @@ bool FffGcodeWriter::processSingleLayerInfill(
                 mesh_config.infill_config[0],
                 SpaceFillType::Lines,
                 enable_travel_optimization,
-                mesh.settings.get<coord_t>("infill_wipe_dist"),
+                mesh.settings.get<coord_t>(SettingKey::infill_wipe_dist),
                 /*float_ratio = */ 1.0,
-                near_start_location);
+                near_start_location,
+                GCodePathConfig::FAN_SPEED_DEFAULT,
+                /*reverse_print_direction = */ false,
+                PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_,
+                travel_improvement_time);
         }
         else
         {
@@ -2344,7 +2688,11 @@ bool FffGcodeWriter::processSingleLayerInfill(
                 enable_travel_optimization,
                 /* wipe_dist = */ 0,
                 /*float_ratio = */ 1.0,
-                near_start_location);
+                near_start_location,
+                GCodePathConfig::FAN_SPEED_DEFAULT,
+                /*reverse_print_direction = */ false,
+                PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_,
+                travel_improvement_time);
         }
     }
     return added_something;
@@ -2353,13 +2701,13 @@ bool FffGcodeWriter::processSingleLayerInfill(
 bool FffGcodeWriter::partitionInfillBySkinAbove(
     Polygons& infill_below_skin,
     Polygons& infill_not_below_skin,
-    const LayerPlan& gcode_layer,
+    const LayerIndex layer_nr,
     const SliceMeshStorage& mesh,
     const SliceLayerPart& part,
     coord_t infill_line_width)
 {
     constexpr coord_t tiny_infill_offset = 20;
-    const auto skin_edge_support_layers = mesh.settings.get<size_t>("skin_edge_support_layers");
+    const auto skin_edge_support_layers = mesh.settings.get<size_t>(SettingKey::skin_edge_support_layers);
     Polygons skin_above_combined; // skin regions on the layers above combined with small gaps between
 
     // working from the highest layer downwards, combine the regions of skin on all the layers
@@ -2367,7 +2715,7 @@ bool FffGcodeWriter::partitionInfillBySkinAbove(
     // otherwise "terraced" skin regions on separate layers will look like a single region of unbroken skin
     for (size_t i = skin_edge_support_layers; i > 0; --i)
     {
-        const size_t skin_layer_nr = gcode_layer.getLayerNr() + i;
+        const size_t skin_layer_nr = layer_nr + i;
         if (skin_layer_nr < mesh.layers.size())
         {
             for (const SliceLayerPart& part_i : mesh.layers[skin_layer_nr].parts)
@@ -2443,7 +2791,7 @@ bool FffGcodeWriter::partitionInfillBySkinAbove(
 
         // the shrink/expand here is to remove regions of infill below skin that are narrower than the width of the infill walls otherwise the infill walls could merge and form
         // a bump
-        infill_below_skin = skin_above_combined.intersection(part.infill_area_per_combine_per_density.back().front()).offset(-infill_line_width).offset(infill_line_width);
+        infill_below_skin = skin_above_combined.intersection(part.getInfillAreaPerCombinePerDensity().back().front()).offset(-infill_line_width).offset(infill_line_width);
 
         constexpr bool remove_small_holes_from_infill_below_skin = true;
         constexpr double min_area_multiplier = 25;
@@ -2451,7 +2799,7 @@ bool FffGcodeWriter::partitionInfillBySkinAbove(
         infill_below_skin.removeSmallAreas(min_area, remove_small_holes_from_infill_below_skin);
 
         // there is infill below skin, is there also infill that isn't below skin?
-        infill_not_below_skin = part.infill_area_per_combine_per_density.back().front().difference(infill_below_skin);
+        infill_not_below_skin = part.getInfillAreaPerCombinePerDensity().back().front().difference(infill_below_skin);
         infill_not_below_skin.removeSmallAreas(min_area);
     }
 
@@ -2534,7 +2882,7 @@ void FffGcodeWriter::processSpiralizedWall(
             last_seam_vertex_idx = storage.spiralize_seam_vertex_indices[layer_nr - 1];
         }
     }
-    const bool is_bottom_layer = (layer_nr == mesh.settings.get<LayerIndex>("initial_bottom_layers"));
+    const bool is_bottom_layer = (layer_nr == mesh.settings.get<LayerIndex>(SettingKey::initial_bottom_layers));
     const bool is_top_layer = ((size_t)layer_nr == (storage.spiralize_wall_outlines.size() - 1) || storage.spiralize_wall_outlines[layer_nr + 1] == nullptr);
     const int seam_vertex_idx = storage.spiralize_seam_vertex_indices[layer_nr]; // use pre-computed seam vertex index for current layer
     // output a wall slice that is interpolated between the last and current walls
@@ -2554,19 +2902,19 @@ bool FffGcodeWriter::processInsets(
     const SliceLayerPart& part) const
 {
     bool added_something = false;
-    if (extruder_nr != mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_ && extruder_nr != mesh.settings.get<ExtruderTrain&>("wall_x_extruder_nr").extruder_nr_)
+    if (extruder_nr != mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_ && extruder_nr != mesh.settings.get<ExtruderTrain&>(SettingKey::wall_x_extruder_nr).extruder_nr_)
     {
         return added_something;
     }
-    if (mesh.settings.get<size_t>("wall_line_count") <= 0)
+    if (mesh.settings.get<size_t>(SettingKey::wall_line_count) <= 0)
     {
         return added_something;
     }
 
     bool spiralize = false;
-    if (Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>("magic_spiralize"))
+    if (Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>(SettingKey::magic_spiralize))
     {
-        const size_t initial_bottom_layers = mesh.settings.get<size_t>("initial_bottom_layers");
+        const size_t initial_bottom_layers = mesh.settings.get<size_t>(SettingKey::initial_bottom_layers);
         const int layer_nr = gcode_layer.getLayerNr();
         if ((layer_nr < static_cast<LayerIndex>(initial_bottom_layers)
              && part.wall_toolpaths.empty()) // The bottom layers in spiralize mode are generated using the variable width paths
@@ -2580,7 +2928,7 @@ bool FffGcodeWriter::processInsets(
             spiralize = true;
         }
         if (spiralize && gcode_layer.getLayerNr() == static_cast<LayerIndex>(initial_bottom_layers)
-            && extruder_nr == mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_)
+            && extruder_nr == mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_)
         { // on the last normal layer first make the outer wall normally and then start a second outer wall from the same hight, but gradually moving upward
             added_something = true;
             gcode_layer.setIsInside(true); // going to print stuff inside print object
@@ -2622,9 +2970,9 @@ bool FffGcodeWriter::processInsets(
         // if support is enabled, add the support outlines also so we don't generate bridges over support
 
         const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-        if (mesh_group_settings.get<bool>("support_enable"))
+        if (mesh_group_settings.get<bool>(SettingKey::support_enable))
         {
-            const coord_t z_distance_top = mesh.settings.get<coord_t>("support_top_distance");
+            const coord_t z_distance_top = mesh.settings.get<coord_t>(SettingKey::support_top_distance);
             const size_t z_distance_top_layers = (z_distance_top / layer_height) + 1;
             const int support_layer_nr = gcode_layer.getLayerNr() - z_distance_top_layers;
 
@@ -2660,7 +3008,7 @@ bool FffGcodeWriter::processInsets(
 
         outlines_below = outlines_below.offset(-half_outer_wall_width).offset(half_outer_wall_width);
 
-        if (mesh.settings.get<bool>("bridge_settings_enabled"))
+        if (mesh.settings.get<bool>(SettingKey::bridge_settings_enabled))
         {
             // max_air_gap is the max allowed width of the unsupported region below the wall line
             // if the unsupported region is wider than max_air_gap, the wall line will be printed using bridge settings
@@ -2684,7 +3032,7 @@ bool FffGcodeWriter::processInsets(
             gcode_layer.setBridgeWallMask(Polygons());
         }
 
-        const AngleDegrees overhang_angle = mesh.settings.get<AngleDegrees>("wall_overhang_angle");
+        const AngleDegrees overhang_angle = mesh.settings.get<AngleDegrees>(SettingKey::wall_overhang_angle);
         if (overhang_angle >= 90)
         {
             // clear to disable overhang detection
@@ -2703,16 +3051,16 @@ bool FffGcodeWriter::processInsets(
 
         const auto roofing_mask = [&]() -> Polygons
         {
-            const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>("roofing_layer_count"), mesh.settings.get<size_t>("top_layers"));
+            const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>(SettingKey::roofing_layer_count), mesh.settings.get<size_t>(SettingKey::top_layers));
 
-            auto roofing_mask = storage.getMachineBorder(mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_);
+            auto roofing_mask = storage.getMachineBorder(mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_);
 
             if (gcode_layer.getLayerNr() + roofing_layer_count >= mesh.layers.size())
             {
                 return roofing_mask;
             }
 
-            const auto wall_line_width_0 = mesh.settings.get<coord_t>("wall_line_width_0");
+            const auto wall_line_width_0 = mesh.settings.get<coord_t>(SettingKey::wall_line_width_0);
             for (const auto& layer_part : mesh.layers[gcode_layer.getLayerNr() + roofing_layer_count].parts)
             {
                 if (boundaryBox.hit(layer_part.boundaryBox))
@@ -2735,7 +3083,7 @@ bool FffGcodeWriter::processInsets(
         gcode_layer.setRoofingMask(Polygons());
     }
 
-    if (spiralize && extruder_nr == mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_ && ! part.spiral_wall.empty())
+    if (spiralize && extruder_nr == mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_ && ! part.spiral_wall.empty())
     {
         added_something = true;
         gcode_layer.setIsInside(true); // going to print stuff inside print object
@@ -2758,10 +3106,10 @@ bool FffGcodeWriter::processInsets(
         // Main case: Optimize the insets with the InsetOrderOptimizer.
         const coord_t wall_x_wipe_dist = 0;
         const ZSeamConfig z_seam_config(
-            mesh.settings.get<EZSeamType>("z_seam_type"),
+            mesh.settings.get<EZSeamType>(SettingKey::z_seam_type),
             mesh.getZSeamHint(),
-            mesh.settings.get<EZSeamCornerPrefType>("z_seam_corner"),
-            mesh.settings.get<coord_t>("wall_line_width_0") * 2);
+            mesh.settings.get<EZSeamCornerPrefType>(SettingKey::z_seam_corner),
+            mesh.settings.get<coord_t>(SettingKey::wall_line_width_0) * 2);
         InsetOrderOptimizer wall_orderer(
             *this,
             storage,
@@ -2774,11 +3122,11 @@ bool FffGcodeWriter::processInsets(
             mesh_config.insetX_roofing_config,
             mesh_config.bridge_inset0_config,
             mesh_config.bridge_insetX_config,
-            mesh.settings.get<bool>("travel_retract_before_outer_wall"),
-            mesh.settings.get<coord_t>("wall_0_wipe_dist"),
+            mesh.settings.get<bool>(SettingKey::travel_retract_before_outer_wall),
+            mesh.settings.get<coord_t>(SettingKey::wall_0_wipe_dist),
             wall_x_wipe_dist,
-            mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_,
-            mesh.settings.get<ExtruderTrain&>("wall_x_extruder_nr").extruder_nr_,
+            mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_,
+            mesh.settings.get<ExtruderTrain&>(SettingKey::wall_x_extruder_nr).extruder_nr_,
             z_seam_config,
             part.wall_toolpaths);
         added_something |= wall_orderer.addToLayer();
@@ -2827,10 +3175,10 @@ bool FffGcodeWriter::processSkin(
     const MeshPathConfigs& mesh_config,
     const SliceLayerPart& part) const
 {
-    const size_t top_bottom_extruder_nr = mesh.settings.get<ExtruderTrain&>("top_bottom_extruder_nr").extruder_nr_;
-    const size_t roofing_extruder_nr = mesh.settings.get<ExtruderTrain&>("roofing_extruder_nr").extruder_nr_;
-    const size_t wall_0_extruder_nr = mesh.settings.get<ExtruderTrain&>("wall_0_extruder_nr").extruder_nr_;
-    const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>("roofing_layer_count"), mesh.settings.get<size_t>("top_layers"));
+    const size_t top_bottom_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::top_bottom_extruder_nr).extruder_nr_;
+    const size_t roofing_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::roofing_extruder_nr).extruder_nr_;
+    const size_t wall_0_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::wall_0_extruder_nr).extruder_nr_;
+    const size_t roofing_layer_count = std::min(mesh.settings.get<size_t>(SettingKey::roofing_layer_count), mesh.settings.get<size_t>(SettingKey::top_layers));
     if (extruder_nr != top_bottom_extruder_nr && extruder_nr != wall_0_extruder_nr && (extruder_nr != roofing_extruder_nr || roofing_layer_count <= 0))
     {
         return false;
@@ -2882,13 +3230,13 @@ void FffGcodeWriter::processRoofing(
     const SkinPart& skin_part,
     bool& added_something) const
 {
-    const size_t roofing_extruder_nr = mesh.settings.get<ExtruderTrain&>("roofing_extruder_nr").extruder_nr_;
+    const size_t roofing_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::roofing_extruder_nr).extruder_nr_;
     if (extruder_nr != roofing_extruder_nr)
     {
         return;
     }
 
-    const EFillMethod pattern = mesh.settings.get<EFillMethod>("roofing_pattern");
+    const EFillMethod pattern = mesh.settings.get<EFillMethod>(SettingKey::roofing_pattern);
     AngleDegrees roofing_angle = 45;
     if (mesh.roofing_angles.size() > 0)
     {
@@ -2897,7 +3245,7 @@ void FffGcodeWriter::processRoofing(
 
     const Ratio skin_density = 1.0;
     const coord_t skin_overlap = 0; // skinfill already expanded over the roofing areas; don't overlap with perimeters
-    const bool monotonic = mesh.settings.get<bool>("roofing_monotonic");
+    const bool monotonic = mesh.settings.get<bool>(SettingKey::roofing_monotonic);
     processSkinPrintFeature(
         storage,
         gcode_layer,
@@ -2926,7 +3274,7 @@ void FffGcodeWriter::processTopBottom(
     {
         return; // bridgeAngle requires a non-empty skin_fill.
     }
-    const size_t top_bottom_extruder_nr = mesh.settings.get<ExtruderTrain&>("top_bottom_extruder_nr").extruder_nr_;
+    const size_t top_bottom_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::top_bottom_extruder_nr).extruder_nr_;
     if (extruder_nr != top_bottom_extruder_nr)
     {
         return;
@@ -2935,7 +3283,7 @@ void FffGcodeWriter::processTopBottom(
 
     const size_t layer_nr = gcode_layer.getLayerNr();
 
-    EFillMethod pattern = (layer_nr == 0) ? mesh.settings.get<EFillMethod>("top_bottom_pattern_0") : mesh.settings.get<EFillMethod>("top_bottom_pattern");
+    EFillMethod pattern = (layer_nr == 0) ? mesh.settings.get<EFillMethod>(SettingKey::top_bottom_pattern_0) : mesh.settings.get<EFillMethod>(SettingKey::top_bottom_pattern);
 
     AngleDegrees skin_angle = 45;
     if (mesh.skin_angles.size() > 0)
@@ -2947,20 +3295,20 @@ void FffGcodeWriter::processTopBottom(
     const GCodePathConfig* skin_config = &mesh_config.skin_config;
     Ratio skin_density = 1.0;
     const coord_t skin_overlap = 0; // Skin overlap offset is applied in skin.cpp more overlap might be beneficial for curved bridges, but makes it worse in general.
-    const bool bridge_settings_enabled = mesh.settings.get<bool>("bridge_settings_enabled");
-    const bool bridge_enable_more_layers = bridge_settings_enabled && mesh.settings.get<bool>("bridge_enable_more_layers");
-    const Ratio support_threshold = bridge_settings_enabled ? mesh.settings.get<Ratio>("bridge_skin_support_threshold") : 0.0_r;
-    const size_t bottom_layers = mesh.settings.get<size_t>("bottom_layers");
+    const bool bridge_settings_enabled = mesh.settings.get<bool>(SettingKey::bridge_settings_enabled);
+    const bool bridge_enable_more_layers = bridge_settings_enabled && mesh.settings.get<bool>(SettingKey::bridge_enable_more_layers);
+    const Ratio support_threshold = bridge_settings_enabled ? mesh.settings.get<Ratio>(SettingKey::bridge_skin_support_threshold) : 0.0_r;
+    const size_t bottom_layers = mesh.settings.get<size_t>(SettingKey::bottom_layers);
 
     // if support is enabled, consider the support outlines so we don't generate bridges over support
 
     int support_layer_nr = -1;
     const SupportLayer* support_layer = nullptr;
 
-    if (mesh_group_settings.get<bool>("support_enable"))
+    if (mesh_group_settings.get<bool>(SettingKey::support_enable))
     {
         const coord_t layer_height = mesh_config.inset0_config.getLayerThickness();
-        const coord_t z_distance_top = mesh.settings.get<coord_t>("support_top_distance");
+        const coord_t z_distance_top = mesh.settings.get<coord_t>(SettingKey::support_top_distance);
         const size_t z_distance_top_layers = (z_distance_top / layer_height) + 1;
         support_layer_nr = layer_nr - z_distance_top_layers;
     }
@@ -2976,7 +3324,8 @@ void FffGcodeWriter::processTopBottom(
 
         Polygons supported_skin_part_regions;
 
-        const double angle = bridgeAngle(mesh.settings, skin_part.skin_fill, storage, layer_nr, bridge_layer, support_layer, supported_skin_part_regions);
+        SolidBelow& solid_below = gcode_layer.getSolidBelow(bridge_layer, mesh.settings.get<Ratio>(SettingKey::bridge_sparse_infill_max_density));
+        const double angle = bridgeAngle(mesh.settings, skin_part.skin_fill, solid_below, support_layer, supported_skin_part_regions);
 
         if (angle > -1 || (support_threshold > 0 && (supported_skin_part_regions.area() / (skin_part.skin_fill.area() + 1) < support_threshold)))
         {
@@ -3023,21 +3372,21 @@ void FffGcodeWriter::processTopBottom(
     bool is_bridge_skin = false;
     if (layer_nr > 0)
     {
-        is_bridge_skin = handle_bridge_skin(1, &mesh_config.bridge_skin_config, mesh.settings.get<Ratio>("bridge_skin_density"));
+        is_bridge_skin = handle_bridge_skin(1, &mesh_config.bridge_skin_config, mesh.settings.get<Ratio>(SettingKey::bridge_skin_density));
     }
     if (bridge_enable_more_layers && ! is_bridge_skin && layer_nr > 1 && bottom_layers > 1)
     {
-        is_bridge_skin = handle_bridge_skin(2, &mesh_config.bridge_skin_config2, mesh.settings.get<Ratio>("bridge_skin_density_2"));
+        is_bridge_skin = handle_bridge_skin(2, &mesh_config.bridge_skin_config2, mesh.settings.get<Ratio>(SettingKey::bridge_skin_density_2));
 
         if (! is_bridge_skin && layer_nr > 2 && bottom_layers > 2)
         {
-            is_bridge_skin = handle_bridge_skin(3, &mesh_config.bridge_skin_config3, mesh.settings.get<Ratio>("bridge_skin_density_3"));
+            is_bridge_skin = handle_bridge_skin(3, &mesh_config.bridge_skin_config3, mesh.settings.get<Ratio>(SettingKey::bridge_skin_density_3));
         }
     }
 
     double fan_speed = GCodePathConfig::FAN_SPEED_DEFAULT;
 
-    if (layer_nr > 0 && skin_config == &mesh_config.skin_config && support_layer_nr >= 0 && mesh.settings.get<bool>("support_fan_enable"))
+    if (layer_nr > 0 && skin_config == &mesh_config.skin_config && support_layer_nr >= 0 && mesh.settings.get<bool>(SettingKey::support_fan_enable))
     {
         // skin isn't a bridge but is it above support and we need to modify the fan speed?
 
@@ -3074,10 +3423,10 @@ void FffGcodeWriter::processTopBottom(
 
         if (supported)
         {
-            fan_speed = mesh.settings.get<Ratio>("support_supported_skin_fan_speed") * 100.0;
+            fan_speed = mesh.settings.get<Ratio>(SettingKey::support_supported_skin_fan_speed) * 100.0;
         }
     }
-    const bool monotonic = mesh.settings.get<bool>("skin_monotonic");
+    const bool monotonic = mesh.settings.get<bool>(SettingKey::skin_monotonic);
     processSkinPrintFeature(
         storage,
         gcode_layer,
@@ -3115,12 +3464,12 @@ void FffGcodeWriter::processSkinPrintFeature(
 
     constexpr int infill_multiplier = 1;
     constexpr int extra_infill_shift = 0;
-    const size_t wall_line_count = mesh.settings.get<size_t>("skin_outline_count");
-    const coord_t small_area_width = mesh.settings.get<coord_t>("small_skin_width");
+    const size_t wall_line_count = mesh.settings.get<size_t>(SettingKey::skin_outline_count);
+    const coord_t small_area_width = mesh.settings.get<coord_t>(SettingKey::small_skin_width);
     const bool zig_zaggify_infill = pattern == EFillMethod::ZIG_ZAG;
-    const bool connect_polygons = mesh.settings.get<bool>("connect_skin_polygons");
-    coord_t max_resolution = mesh.settings.get<coord_t>("meshfix_maximum_resolution");
-    coord_t max_deviation = mesh.settings.get<coord_t>("meshfix_maximum_deviation");
+    const bool connect_polygons = mesh.settings.get<bool>(SettingKey::connect_skin_polygons);
+    coord_t max_resolution = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    coord_t max_deviation = mesh.settings.get<coord_t>(SettingKey::meshfix_maximum_deviation);
     const Point2LL infill_origin;
     const bool skip_line_stitching = monotonic;
     constexpr bool fill_gaps = true;
@@ -3129,7 +3478,7 @@ void FffGcodeWriter::processSkinPrintFeature(
     constexpr bool skip_some_zags = false;
     constexpr int zag_skip_count = 0;
     constexpr coord_t pocket_size = 0;
-    const bool small_areas_on_surface = mesh.settings.get<bool>("small_skin_on_surface");
+    const bool small_areas_on_surface = mesh.settings.get<bool>(SettingKey::small_skin_on_surface);
     const auto& current_layer = mesh.layers[gcode_layer.getLayerNr()];
     const auto& exposed_to_air = current_layer.top_surface.areas.unionPolygons(current_layer.bottom_surface);
 
@@ -3177,15 +3526,15 @@ void FffGcodeWriter::processSkinPrintFeature(
         if (! skin_paths.empty())
         {
             // Add skin-walls a.k.a. skin-perimeters, skin-insets.
-            const size_t skin_extruder_nr = mesh.settings.get<ExtruderTrain&>("top_bottom_extruder_nr").extruder_nr_;
+            const size_t skin_extruder_nr = mesh.settings.get<ExtruderTrain&>(SettingKey::top_bottom_extruder_nr).extruder_nr_;
             if (extruder_nr == skin_extruder_nr)
             {
                 constexpr bool retract_before_outer_wall = false;
                 constexpr coord_t wipe_dist = 0;
                 const ZSeamConfig z_seam_config(
-                    mesh.settings.get<EZSeamType>("z_seam_type"),
+                    mesh.settings.get<EZSeamType>(SettingKey::z_seam_type),
                     mesh.getZSeamHint(),
-                    mesh.settings.get<EZSeamCornerPrefType>("z_seam_corner"),
+                    mesh.settings.get<EZSeamCornerPrefType>(SettingKey::z_seam_corner),
                     config.getLineWidth() * 2);
                 InsetOrderOptimizer wall_orderer(
                     *this,
@@ -3236,7 +3585,7 @@ void FffGcodeWriter::processSkinPrintFeature(
                     monotonic_direction,
                     max_adjacent_distance,
                     exclude_distance,
-                    mesh.settings.get<coord_t>("infill_wipe_dist"),
+                    mesh.settings.get<coord_t>(SettingKey::infill_wipe_dist),
                     flow,
                     fan_speed);
             }
@@ -3251,7 +3600,7 @@ void FffGcodeWriter::processSkinPrintFeature(
         {
             std::optional<Point2LL> near_start_location;
             const EFillMethod actual_pattern
-                = (gcode_layer.getLayerNr() == 0) ? mesh.settings.get<EFillMethod>("top_bottom_pattern_0") : mesh.settings.get<EFillMethod>("top_bottom_pattern");
+                = (gcode_layer.getLayerNr() == 0) ? mesh.settings.get<EFillMethod>(SettingKey::top_bottom_pattern_0) : mesh.settings.get<EFillMethod>(SettingKey::top_bottom_pattern);
             if (actual_pattern == EFillMethod::LINES || actual_pattern == EFillMethod::ZIG_ZAG)
             { // update near_start_location to a location which tries to avoid seams in skin
                 near_start_location = getSeamAvoidingLocation(area, skin_angle, gcode_layer.getLastPlannedPositionOrStartingPosition());
@@ -3268,7 +3617,7 @@ void FffGcodeWriter::processSkinPrintFeature(
                     config,
                     SpaceFillType::Lines,
                     enable_travel_optimization,
-                    mesh.settings.get<coord_t>("infill_wipe_dist"),
+                    mesh.settings.get<coord_t>(SettingKey::infill_wipe_dist),
                     flow,
                     near_start_location,
                     fan_speed);
@@ -3291,8 +3640,8 @@ bool FffGcodeWriter::processIroning(
     LayerPlan& gcode_layer) const
 {
     bool added_something = false;
-    const bool ironing_enabled = mesh.settings.get<bool>("ironing_enabled");
-    const bool ironing_only_highest_layer = mesh.settings.get<bool>("ironing_only_highest_layer");
+    const bool ironing_enabled = mesh.settings.get<bool>(SettingKey::ironing_enabled);
+    const bool ironing_only_highest_layer = mesh.settings.get<bool>(SettingKey::ironing_only_highest_layer);
     if (ironing_enabled && (! ironing_only_highest_layer || mesh.layer_nr_max_filled_layer == gcode_layer.getLayerNr()))
     {
         // Since we are ironing after all the parts are completed, it believes that it is outside.
@@ -3315,10 +3664,10 @@ bool FffGcodeWriter::addSupportToGCode(const SliceDataStorage& storage, LayerPla
     }
 
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    const size_t support_roof_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("support_roof_extruder_nr").extruder_nr_;
-    const size_t support_bottom_extruder_nr = mesh_group_settings.get<ExtruderTrain&>("support_bottom_extruder_nr").extruder_nr_;
-    size_t support_infill_extruder_nr = (gcode_layer.getLayerNr() <= 0) ? mesh_group_settings.get<ExtruderTrain&>("support_extruder_nr_layer_0").extruder_nr_
-                                                                        : mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr").extruder_nr_;
+    const size_t support_roof_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_roof_extruder_nr).extruder_nr_;
+    const size_t support_bottom_extruder_nr = mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_bottom_extruder_nr).extruder_nr_;
+    size_t support_infill_extruder_nr = (gcode_layer.getLayerNr() <= 0) ? mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_extruder_nr_layer_0).extruder_nr_
+                                                                        : mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_infill_extruder_nr).extruder_nr_;
 
     const SupportLayer& support_layer = storage.support.supportLayers[std::max(LayerIndex{ 0 }, gcode_layer.getLayerNr())];
     if (support_layer.support_bottom.empty() && support_layer.support_roof.empty() && support_layer.support_infill_parts.empty())
@@ -3362,19 +3711,19 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
     }
 
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    const size_t extruder_nr = (gcode_layer.getLayerNr() <= 0) ? mesh_group_settings.get<ExtruderTrain&>("support_extruder_nr_layer_0").extruder_nr_
-                                                               : mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr").extruder_nr_;
+    const size_t extruder_nr = (gcode_layer.getLayerNr() <= 0) ? mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_extruder_nr_layer_0).extruder_nr_
+                                                               : mesh_group_settings.get<ExtruderTrain&>(SettingKey::support_infill_extruder_nr).extruder_nr_;
     const ExtruderTrain& infill_extruder = Application::getInstance().current_slice_->scene.extruders[extruder_nr];
 
-    coord_t default_support_line_distance = infill_extruder.settings_.get<coord_t>("support_line_distance");
+    coord_t default_support_line_distance = infill_extruder.settings_.get<coord_t>(SettingKey::support_line_distance);
 
     // To improve adhesion for the "support initial layer" the first layer might have different properties
     if (gcode_layer.getLayerNr() == 0)
     {
-        default_support_line_distance = infill_extruder.settings_.get<coord_t>("support_initial_layer_line_distance");
+        default_support_line_distance = infill_extruder.settings_.get<coord_t>(SettingKey::support_initial_layer_line_distance);
     }
 
-    const coord_t default_support_infill_overlap = infill_extruder.settings_.get<coord_t>("infill_overlap_mm");
+    const coord_t default_support_infill_overlap = infill_extruder.settings_.get<coord_t>(SettingKey::infill_overlap_mm);
 
     // Helper to get the support infill angle
     const auto get_support_infill_angle = [](const SupportStorage& support_storage, const int layer_nr)
@@ -3391,13 +3740,13 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
     const AngleDegrees support_infill_angle = get_support_infill_angle(storage.support, gcode_layer.getLayerNr());
 
     constexpr size_t infill_multiplier = 1; // there is no frontend setting for this (yet)
-    const size_t wall_line_count = infill_extruder.settings_.get<size_t>("support_wall_count");
-    const coord_t max_resolution = infill_extruder.settings_.get<coord_t>("meshfix_maximum_resolution");
-    const coord_t max_deviation = infill_extruder.settings_.get<coord_t>("meshfix_maximum_deviation");
-    coord_t default_support_line_width = infill_extruder.settings_.get<coord_t>("support_line_width");
-    if (gcode_layer.getLayerNr() == 0 && mesh_group_settings.get<EPlatformAdhesion>("adhesion_type") != EPlatformAdhesion::RAFT)
+    const size_t wall_line_count = infill_extruder.settings_.get<size_t>(SettingKey::support_wall_count);
+    const coord_t max_resolution = infill_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const coord_t max_deviation = infill_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_deviation);
+    coord_t default_support_line_width = infill_extruder.settings_.get<coord_t>(SettingKey::support_line_width);
+    if (gcode_layer.getLayerNr() == 0 && mesh_group_settings.get<EPlatformAdhesion>(SettingKey::adhesion_type) != EPlatformAdhesion::RAFT)
     {
-        default_support_line_width *= infill_extruder.settings_.get<Ratio>("initial_layer_line_width_factor");
+        default_support_line_width *= infill_extruder.settings_.get<Ratio>(SettingKey::initial_layer_line_width_factor);
     }
 
     // Helper to get the support pattern
@@ -3409,11 +3758,11 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
         }
         return pattern;
     };
-    const EFillMethod support_pattern = get_support_pattern(infill_extruder.settings_.get<EFillMethod>("support_pattern"), gcode_layer.getLayerNr());
+    const EFillMethod support_pattern = get_support_pattern(infill_extruder.settings_.get<EFillMethod>(SettingKey::support_pattern), gcode_layer.getLayerNr());
 
-    const auto zig_zaggify_infill = infill_extruder.settings_.get<bool>("zig_zaggify_support");
-    const auto skip_some_zags = infill_extruder.settings_.get<bool>("support_skip_some_zags");
-    const auto zag_skip_count = infill_extruder.settings_.get<size_t>("support_zag_skip_count");
+    const auto zig_zaggify_infill = infill_extruder.settings_.get<bool>(SettingKey::zig_zaggify_support);
+    const auto skip_some_zags = infill_extruder.settings_.get<bool>(SettingKey::support_skip_some_zags);
+    const auto zag_skip_count = infill_extruder.settings_.get<size_t>(SettingKey::support_zag_skip_count);
 
     // create a list of outlines and use PathOrderOptimizer to optimize the travel move
     PathOrderOptimizer<const SupportInfillPart*> island_order_optimizer_initial(gcode_layer.getLastPlannedPositionOrStartingPosition());
@@ -3425,8 +3774,8 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
     island_order_optimizer_initial.optimize();
     island_order_optimizer.optimize();
 
-    const auto support_connect_zigzags = infill_extruder.settings_.get<bool>("support_connect_zigzags");
-    const auto support_structure = infill_extruder.settings_.get<ESupportStructure>("support_structure");
+    const auto support_connect_zigzags = infill_extruder.settings_.get<bool>(SettingKey::support_connect_zigzags);
+    const auto support_structure = infill_extruder.settings_.get<ESupportStructure>(SettingKey::support_structure);
     const Point2LL infill_origin;
 
     constexpr bool use_endpieces = true;
@@ -3510,46 +3859,79 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
                 const coord_t small_area_width = 0;
                 constexpr bool skip_stitching = false;
                 const bool fill_gaps = density_idx == 0; // Only fill gaps for one of the densities.
-                Infill infill_comp(
-                    support_pattern,
-                    zig_zaggify_infill,
-                    connect_polygons,
-                    area,
-                    support_line_width,
-                    support_line_distance_here,
-                    current_support_infill_overlap - (density_idx == max_density_idx ? 0 : wall_line_count * support_line_width),
-                    infill_multiplier,
-                    support_infill_angle,
-                    gcode_layer.z_ + configs[combine_idx].z_offset,
-                    support_shift,
-                    max_resolution,
-                    max_deviation,
-                    wall_count,
-                    small_area_width,
-                    infill_origin,
-                    skip_stitching,
-                    fill_gaps,
-                    support_connect_zigzags,
-                    use_endpieces,
-                    skip_some_zags,
-                    zag_skip_count,
-                    pocket_size);
-                infill_comp.generate(
-                    wall_toolpaths_here,
-                    support_polygons,
-                    support_lines,
-                    infill_extruder.settings_,
-                    gcode_layer.getLayerNr(),
-                    SectionType::SUPPORT,
-                    storage.support.cross_fill_provider);
+                const coord_t infill_overlap = current_support_infill_overlap - (density_idx == max_density_idx ? 0 : wall_line_count * support_line_width);
+                const auto generate_infill = [&]()
+                {
+                    Infill infill_comp(
+                        support_pattern,
+                        zig_zaggify_infill,
+                        connect_polygons,
+                        area,
+                        support_line_width,
+                        support_line_distance_here,
+                        infill_overlap,
+                        infill_multiplier,
+                        support_infill_angle,
+                        gcode_layer.z_ + configs[combine_idx].z_offset,
+                        support_shift,
+                        max_resolution,
+                        max_deviation,
+                        wall_count,
+                        small_area_width,
+                        infill_origin,
+                        skip_stitching,
+                        fill_gaps,
+                        support_connect_zigzags,
+                        use_endpieces,
+                        skip_some_zags,
+                        zag_skip_count,
+                        pocket_size);
+                    auto generated = std::make_shared<SupportInfillLines>();
+                    infill_comp.generate(
+                        generated->toolpaths,
+                        generated->polygons,
+                        generated->lines,
+                        infill_extruder.settings_,
+                        gcode_layer.getLayerNr(),
+                        SectionType::SUPPORT,
+                        storage.support.cross_fill_provider);
+                    return std::shared_ptr<const SupportInfillLines>(std::move(generated));
+                };
+
+                // The same area is often filled the same way on many layers, so reuse what was generated for those.
+                std::shared_ptr<const SupportInfillLines> infill;
+                if (SupportInfillCache::isCacheable(support_pattern))
+                {
+                    SupportInfillCache::Key key{ .parameters = { static_cast<coord_t>(support_pattern),
+                                                                 static_cast<coord_t>(extruder_nr),
+                                                                 support_line_width,
+                                                                 support_line_distance_here,
+                                                                 infill_overlap,
+                                                                 std::bit_cast<coord_t>(static_cast<double>(support_infill_angle)),
+                                                                 support_shift,
+                                                                 zig_zaggify_infill,
+                                                                 fill_gaps,
+                                                                 support_connect_zigzags,
+                                                                 skip_some_zags,
+                                                                 static_cast<coord_t>(zag_skip_count) },
+                                                 .area = area };
+                    infill = storage.support.infill_cache.get(std::move(key), generate_infill);
+                }
+                else
+                {
+                    infill = generate_infill();
+                }
+                wall_toolpaths_here.insert(wall_toolpaths_here.end(), infill->toolpaths.begin(), infill->toolpaths.end());
+                support_polygons.add(infill->polygons);
+                support_lines.add(infill->lines);
             }
 
-            if (need_travel_to_end_of_last_spiral && infill_extruder.settings_.get<bool>("magic_spiralize"))
+            if (need_travel_to_end_of_last_spiral && infill_extruder.settings_.get<bool>(SettingKey::magic_spiralize))
             {
                 if ((! wall_toolpaths.empty() || ! support_polygons.empty() || ! support_lines.empty()))
                 {
                     int layer_nr = gcode_layer.getLayerNr();
-                    if (layer_nr > (int)infill_extruder.settings_.get<size_t>("initial_bottom_layers"))
+                    if (layer_nr > (int)infill_extruder.settings_.get<size_t>(SettingKey::initial_bottom_layers))
                     {
                         // bit of subtlety here... support is being used on a spiralized model and to ensure the travel move from the end of the last spiral
                         // to the start of the support does not go through the model we have to tell the slicer what the current location of the nozzle is
@@ -3567,7 +3949,7 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
 
             gcode_layer.setIsInside(false); // going to print stuff outside print object, i.e. support
 
-            const bool alternate_inset_direction = infill_extruder.settings_.get<bool>("material_alternate_walls");
+            const bool alternate_inset_direction = infill_extruder.settings_.get<bool>(SettingKey::material_alternate_walls);
             const bool alternate_layer_print_direction = alternate_inset_direction && gcode_layer.getLayerNr() % 2 == 1;
 
             if (! support_polygons.empty())
@@ -3612,7 +3994,9 @@ bool FffGcodeWriter::processSupportInfill(const SliceDataStorage& storage, Layer
                     flow_ratio,
                     near_start_location,
                     fan_speed,
-                    alternate_layer_print_direction);
+                    alternate_layer_print_direction,
+                    PathOrderOptimizer<ConstPolygonPointer>::no_order_requirements_,
+                    getTravelImprovementTime(infill_extruder.settings_, "support_travel_improvement_time"));
 
                 added_something = true;
             }
@@ -3671,10 +4055,10 @@ bool FffGcodeWriter::addSupportRoofsToGCode(
         return false; // No need to generate support roof if there's no support.
     }
 
-    const size_t roof_extruder_nr = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<ExtruderTrain&>("support_roof_extruder_nr").extruder_nr_;
+    const size_t roof_extruder_nr = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<ExtruderTrain&>(SettingKey::support_roof_extruder_nr).extruder_nr_;
     const ExtruderTrain& roof_extruder = Application::getInstance().current_slice_->scene.extruders[roof_extruder_nr];
 
-    const EFillMethod pattern = roof_extruder.settings_.get<EFillMethod>("support_roof_pattern");
+    const EFillMethod pattern = roof_extruder.settings_.get<EFillMethod>(SettingKey::support_roof_pattern);
     AngleDegrees fill_angle = 0;
     if (! storage.support.support_roof_angles.empty())
     {
@@ -3688,8 +4072,8 @@ bool FffGcodeWriter::addSupportRoofsToGCode(
     constexpr coord_t support_roof_overlap = 0; // the roofs should never be expanded outwards
     constexpr size_t infill_multiplier = 1;
     constexpr coord_t extra_infill_shift = 0;
-    const auto wall_line_count = roof_extruder.settings_.get<size_t>("support_roof_wall_count");
-    const coord_t small_area_width = roof_extruder.settings_.get<coord_t>("min_even_wall_line_width") * 2; // Maximum width of a region that can still be filled with one wall.
+    const auto wall_line_count = roof_extruder.settings_.get<size_t>(SettingKey::support_roof_wall_count);
+    const coord_t small_area_width = roof_extruder.settings_.get<coord_t>(SettingKey::min_even_wall_line_width) * 2; // Maximum width of a region that can still be filled with one wall.
     const Point2LL infill_origin;
     constexpr bool skip_stitching = false;
     constexpr bool fill_gaps = true;
@@ -3698,14 +4082,14 @@ bool FffGcodeWriter::addSupportRoofsToGCode(
     constexpr bool skip_some_zags = false;
     constexpr size_t zag_skip_count = 0;
     constexpr coord_t pocket_size = 0;
-    const coord_t max_resolution = roof_extruder.settings_.get<coord_t>("meshfix_maximum_resolution");
-    const coord_t max_deviation = roof_extruder.settings_.get<coord_t>("meshfix_maximum_deviation");
+    const coord_t max_resolution = roof_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const coord_t max_deviation = roof_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_deviation);
 
-    coord_t support_roof_line_distance = roof_extruder.settings_.get<coord_t>("support_roof_line_distance");
-    const coord_t support_roof_line_width = roof_extruder.settings_.get<coord_t>("support_roof_line_width");
+    coord_t support_roof_line_distance = roof_extruder.settings_.get<coord_t>(SettingKey::support_roof_line_distance);
+    const coord_t support_roof_line_width = roof_extruder.settings_.get<coord_t>(SettingKey::support_roof_line_width);
     if (gcode_layer.getLayerNr() == 0 && support_roof_line_distance < 2 * support_roof_line_width)
     { // if roof is dense
-        support_roof_line_distance *= roof_extruder.settings_.get<Ratio>("initial_layer_line_width_factor");
+        support_roof_line_distance *= roof_extruder.settings_.get<Ratio>(SettingKey::initial_layer_line_width_factor);
     }
 
     Polygons infill_outline = support_roof_outlines;
@@ -3802,10 +4186,10 @@ bool FffGcodeWriter::addSupportBottomsToGCode(const SliceDataStorage& storage, L
         return false; // No need to generate support bottoms if there's no support.
     }
 
-    const size_t bottom_extruder_nr = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<ExtruderTrain&>("support_bottom_extruder_nr").extruder_nr_;
+    const size_t bottom_extruder_nr = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<ExtruderTrain&>(SettingKey::support_bottom_extruder_nr).extruder_nr_;
     const ExtruderTrain& bottom_extruder = Application::getInstance().current_slice_->scene.extruders[bottom_extruder_nr];
 
-    const EFillMethod pattern = bottom_extruder.settings_.get<EFillMethod>("support_bottom_pattern");
+    const EFillMethod pattern = bottom_extruder.settings_.get<EFillMethod>(SettingKey::support_bottom_pattern);
     AngleDegrees fill_angle = 0;
     if (! storage.support.support_bottom_angles.empty())
     {
@@ -3819,8 +4203,8 @@ bool FffGcodeWriter::addSupportBottomsToGCode(const SliceDataStorage& storage, L
     constexpr coord_t support_bottom_overlap = 0; // the bottoms should never be expanded outwards
     constexpr size_t infill_multiplier = 1;
     constexpr coord_t extra_infill_shift = 0;
-    const auto wall_line_count = bottom_extruder.settings_.get<size_t>("support_bottom_wall_count");
-    const coord_t small_area_width = bottom_extruder.settings_.get<coord_t>("min_even_wall_line_width") * 2; // Maximum width of a region that can still be filled with one wall.
+    const auto wall_line_count = bottom_extruder.settings_.get<size_t>(SettingKey::support_bottom_wall_count);
+    const coord_t small_area_width = bottom_extruder.settings_.get<coord_t>(SettingKey::min_even_wall_line_width) * 2; // Maximum width of a region that can still be filled with one wall.
 
     const Point2LL infill_origin;
     constexpr bool skip_stitching = false;
@@ -3830,8 +4214,8 @@ bool FffGcodeWriter::addSupportBottomsToGCode(const SliceDataStorage& storage, L
     constexpr bool skip_some_zags = false;
     constexpr int zag_skip_count = 0;
     constexpr coord_t pocket_size = 0;
-    const coord_t max_resolution = bottom_extruder.settings_.get<coord_t>("meshfix_maximum_resolution");
-    const coord_t max_deviation = bottom_extruder.settings_.get<coord_t>("meshfix_maximum_deviation");
+    const coord_t max_resolution = bottom_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_resolution);
+    const coord_t max_deviation = bottom_extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_deviation);
 
     const coord_t support_bottom_line_distance = bottom_extruder.settings_.get<coord_t>(
         "support_bottom_line_distance"); // note: no need to apply initial line width factor; support bottoms cannot exist on the first layer
@@ -3922,10 +4306,10 @@ void FffGcodeWriter::setExtruder_addPrime(const SliceDataStorage& storage, Layer
 
             // We always prime an extruder, but whether it will be a prime blob/poop depends on if prime blob is enabled.
             // This is decided in GCodeExport::writePrimeTrain().
-            if (train.settings_.get<bool>("prime_blob_enable")) // Don't travel to the prime-blob position if not enabled though.
+            if (train.settings_.get<bool>(SettingKey::prime_blob_enable)) // Don't travel to the prime-blob position if not enabled though.
             {
-                bool prime_pos_is_abs = train.settings_.get<bool>("extruder_prime_pos_abs");
-                Point2LL prime_pos = Point2LL(train.settings_.get<coord_t>("extruder_prime_pos_x"), train.settings_.get<coord_t>("extruder_prime_pos_y"));
+                bool prime_pos_is_abs = train.settings_.get<bool>(SettingKey::extruder_prime_pos_abs);
+                Point2LL prime_pos = Point2LL(train.settings_.get<coord_t>(SettingKey::extruder_prime_pos_x), train.settings_.get<coord_t>(SettingKey::extruder_prime_pos_y));
                 gcode_layer.addTravel(prime_pos_is_abs ? prime_pos : gcode_layer.getLastPlannedPositionOrStartingPosition() + prime_pos);
                 gcode_layer.planPrime();
             }
@@ -3960,12 +4344,12 @@ void FffGcodeWriter::addPrimeTower(const SliceDataStorage& storage, LayerPlan& g
 void FffGcodeWriter::finalize()
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
-    if (mesh_group_settings.get<bool>("machine_heated_bed"))
+    if (mesh_group_settings.get<bool>(SettingKey::machine_heated_bed))
     {
         gcode.writeBedTemperatureCommand(0); // Cool down the bed (M140).
         // Nozzles are cooled down automatically after the last time they are used (which might be earlier than the end of the print).
     }
-    if (mesh_group_settings.get<bool>("machine_heated_build_volume") && mesh_group_settings.get<Temperature>("build_volume_temperature") != 0)
+    if (mesh_group_settings.get<bool>(SettingKey::machine_heated_build_volume) && mesh_group_settings.get<Temperature>(SettingKey::build_volume_temperature) != 0)
     {
         gcode.writeBuildVolumeTemperatureCommand(0); // Cool down the build volume.
     }
@@ -3978,7 +4362,7 @@ void FffGcodeWriter::finalize()
     for (size_t extruder_nr = 0; extruder_nr < scene.extruders.size(); extruder_nr++)
     {
         filament_used.emplace_back(gcode.getTotalFilamentUsed(extruder_nr));
-        material_ids.emplace_back(scene.extruders[extruder_nr].settings_.get<std::string>("material_guid"));
+        material_ids.emplace_back(scene.extruders[extruder_nr].settings_.get<std::string>(SettingKey::material_guid));
         extruder_is_used.push_back(gcode.getExtruderIsUsed(extruder_nr));
     }
     std::string prefix = gcode.getFileHeader(extruder_is_used, &print_time, filament_used, material_ids);
@@ -3991,19 +4375,19 @@ void FffGcodeWriter::finalize()
     {
         spdlog::info("Gcode header after slicing: {}", prefix);
     }
-    if (mesh_group_settings.get<bool>("acceleration_enabled"))
+    if (mesh_group_settings.get<bool>(SettingKey::acceleration_enabled))
     {
-        gcode.writePrintAcceleration(mesh_group_settings.get<Acceleration>("machine_acceleration"));
-        gcode.writeTravelAcceleration(mesh_group_settings.get<Acceleration>("machine_acceleration"));
+        gcode.writePrintAcceleration(mesh_group_settings.get<Acceleration>(SettingKey::machine_acceleration));
+        gcode.writeTravelAcceleration(mesh_group_settings.get<Acceleration>(SettingKey::machine_acceleration));
     }
-    if (mesh_group_settings.get<bool>("jerk_enabled"))
+    if (mesh_group_settings.get<bool>(SettingKey::jerk_enabled))
     {
-        gcode.writeJerk(mesh_group_settings.get<Velocity>("machine_max_jerk_xy"));
+        gcode.writeJerk(mesh_group_settings.get<Velocity>(SettingKey::machine_max_jerk_xy));
     }
 
-    const auto end_gcode = mesh_group_settings.get<std::string>("machine_end_gcode");
+    const auto end_gcode = mesh_group_settings.get<std::string>(SettingKey::machine_end_gcode);
 
-    if (end_gcode.length() > 0 && mesh_group_settings.get<bool>("relative_extrusion"))
+    if (end_gcode.length() > 0 && mesh_group_settings.get<bool>(SettingKey::relative_extrusion))
     {
         gcode.writeExtrusionMode(false); // ensure absolute extrusion mode is set before the end gcode
     }
@@ -4018,6 +4402,13 @@ void FffGcodeWriter::finalize()
     }
 
     gcode.writeComment("End of Gcode");
+
+    if (const std::optional<std::string> patched_prefix = gcode.getPatchedFileHeader(prefix))
+    {
+        gcode.flushOutput();
+        output_file_sink.overwrite(0, *patched_prefix);
+    }
+    gcode.getToolpathExport().close();
     /*
     the profile string below can be executed since the M25 doesn't end the gcode on an UMO and when printing via USB.
     gcode.writeCode("M25 ;Stop reading from this point on.");
@@ -19,7 +19,9 @@
 #include "InterlockingGenerator.h"
 #include "layerPart.h"
 #include "MeshGroup.h"
+#include "MeshWallsCache.h"
 #include "Mold.h"
+#include "OutlineIntersectionCache.h"
 #include "multiVolumes.h"
 #include "PrintFeature.h"
 #include "raft.h"
@@ -28,14 +30,17 @@
 #include "Slice.h"
 #include "sliceDataStorage.h"
 #include "slicer.h"
+#include "SlicerCache.h"
 #include "support.h"
 #include "TopSurface.h"
 #include "TreeSupport.h"
+#include "WallToolPathsCache.h"
 #include "WallsComputation.h"
 #include "infill/DensityProvider.h"
 #include "infill/ImageBasedDensityProvider.h"
 #include "infill/LightningGenerator.h"
 #include "infill/SierpinskiFillProvider.h"
+#include "infill/SierpinskiFillProviderCache.h"
 #include "infill/SubDivCube.h"
 #include "infill/UniformDensityProvider.h"
 #include "progress/Progress.h"
@@ -45,6 +50,12 @@
 #include "settings/AdaptiveLayerHeights.h"
 #include "settings/types/Angle.h"
 #include "settings/types/LayerIndex.h"
+#include "utils/AABB.h"
+#include "utils/Cancellation.h"
+#include "utils/CompactPolygons.h"
+#include "utils/CounterRandom.h"
+#include "utils/DebugOutput.h"
+#include "utils/SVG.h"
 #include "utils/algorithm.h"
 #include "utils/ThreadPool.h"
 #include "utils/gettime.h"
@@ -62,6 +73,7 @@ bool FffPolygonGenerator::generateAreas(SliceDataStorage& storage, MeshGroup* me
     {
         return false;
     }
+    Cancellation::throwIfRequested();
 
     slices2polygons(storage, timeKeeper);
 
@@ -195,8 +207,10 @@ bool FffPolygonGenerator::sliceModel(MeshGroup* meshgroup, TimeKeeper& timeKeepe
     {
         return true; // This is NOT an error state!
     }
+    Progress::setLayerCount(slice_layer_count);
 
     std::vector<Slicer*> slicerList;
+    size_t released_mesh_bytes = 0;
     for (unsigned int mesh_idx = 0; mesh_idx < meshgroup->meshes.size(); mesh_idx++)
     {
         // Check if adaptive layers is populated to prevent accessing a method on NULL
@@ -207,10 +221,14 @@ bool FffPolygonGenerator::sliceModel(MeshGroup* meshgroup, TimeKeeper& timeKeepe
         }
 
         Mesh& mesh = meshgroup->meshes[mesh_idx];
-        Slicer* slicer = new Slicer(&mesh, layer_thickness, slice_layer_count, use_variable_layer_heights, adaptive_layer_height_values);
+        Slicer* slicer = SlicerCache::getInstance().slice(&mesh, layer_thickness, slice_layer_count, use_variable_layer_heights, adaptive_layer_height_values);
 
         slicerList.push_back(slicer);
 
+        // The faces and vertices of this mesh are no longer needed, since the adaptive layer heights were already computed and the slicer cache took its hash.
+        // Freeing them now rather than after all meshes are sliced lowers the peak memory while the other meshes are sliced.
+        released_mesh_bytes += mesh.releaseGeometry();
+
         /*
         for(SlicerLayer& layer : slicer->layers)
         {
@@ -223,8 +241,8 @@ bool FffPolygonGenerator::sliceModel(MeshGroup* meshgroup, TimeKeeper& timeKeepe
         Progress::messageProgress(Progress::Stage::SLICING, mesh_idx + 1, meshgroup->meshes.size());
     }
 
-    // Clear the mesh face and vertex data, it is no longer needed after this point, and it saves a lot of memory.
-    meshgroup->clear();
+    SlicerCache::getInstance().finishMeshGroup(); // The slicers are changed from here on.
+    spdlog::debug("Released {} MB of mesh faces and vertices after slicing.", released_mesh_bytes / (1024 * 1024));
 
     Mold::process(slicerList);
 
@@ -357,13 +375,6 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
     }
 
     // handle meshes
-    std::vector<double> mesh_timings;
-    for (unsigned int mesh_idx = 0; mesh_idx < storage.meshes.size(); mesh_idx++)
-    {
-        mesh_timings.push_back(1.0); // TODO: have a more accurate estimate of the relative time it takes per mesh, based on the height and number of polygons
-    }
-    ProgressStageEstimator inset_skin_progress_estimate(mesh_timings);
-
     Progress::messageProgressStage(Progress::Stage::INSET_SKIN, &time_keeper);
     std::vector<size_t> mesh_order;
     { // compute mesh order
@@ -377,10 +388,64 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
             mesh_order.push_back(order_and_mesh_idx.second);
         }
     }
+
+    // An infill mesh changes the infill of the meshes before it in the mesh order, and it needs to be processed after
+    // those are complete. The other meshes only depend on themselves, so they are processed first and all at the same
+    // time. That keeps the threads busy on a build plate with many small meshes, which are too small to fill the thread
+    // pool with their layers alone. Cutting meshes have already been carved out of the other meshes while slicing.
+    std::vector<size_t> independent_mesh_order_idxs;
+    std::vector<size_t> infill_mesh_order_idxs;
     for (size_t mesh_order_idx = 0; mesh_order_idx < mesh_order.size(); ++mesh_order_idx)
     {
-        processBasicWallsSkinInfill(storage, mesh_order_idx, mesh_order, inset_skin_progress_estimate);
-        Progress::messageProgress(Progress::Stage::INSET_SKIN, mesh_order_idx + 1, storage.meshes.size());
+        if (storage.meshes[mesh_order[mesh_order_idx]]->settings.get<bool>("infill_mesh"))
+        {
+            infill_mesh_order_idxs.push_back(mesh_order_idx);
+        }
+        else
+        {
+            independent_mesh_order_idxs.push_back(mesh_order_idx);
+        }
+    }
+    const bool process_concurrently = independent_mesh_order_idxs.size() > 1;
+
+    // TODO: have a more accurate estimate of the relative time it takes per mesh, based on the height and number of polygons
+    std::vector<double> mesh_timings;
+    if (process_concurrently)
+    {
+        mesh_timings.push_back(static_cast<double>(independent_mesh_order_idxs.size())); // All of them in a single stage.
+    }
+    else
+    {
+        mesh_timings.resize(independent_mesh_order_idxs.size(), 1.0);
+    }
+    mesh_timings.resize(mesh_timings.size() + infill_mesh_order_idxs.size(), 1.0);
+    ProgressStageEstimator inset_skin_progress_estimate(mesh_timings);
+
+    std::atomic<size_t> processed_mesh_count = 0;
+    if (process_concurrently)
+    {
+        inset_skin_progress_estimate.nextStage(new ProgressEstimatorLinear(independent_mesh_order_idxs.size()));
+        cura::parallel_for<size_t>(
+            0,
+            independent_mesh_order_idxs.size(),
+            [&](size_t idx)
+            {
+                processBasicWallsSkinInfill(storage, independent_mesh_order_idxs[idx], mesh_order, nullptr);
+                Progress::messageProgress(Progress::Stage::INSET_SKIN, ++processed_mesh_count, storage.meshes.size());
+            });
+    }
+    else
+    {
+        for (const size_t mesh_order_idx : independent_mesh_order_idxs)
+        {
+            processBasicWallsSkinInfill(storage, mesh_order_idx, mesh_order, &inset_skin_progress_estimate);
+            Progress::messageProgress(Progress::Stage::INSET_SKIN, ++processed_mesh_count, storage.meshes.size());
+        }
+    }
+    for (const size_t mesh_order_idx : infill_mesh_order_idxs)
+    {
+        processBasicWallsSkinInfill(storage, mesh_order_idx, mesh_order, &inset_skin_progress_estimate);
+        Progress::messageProgress(Progress::Stage::INSET_SKIN, ++processed_mesh_count, storage.meshes.size());
     }
 
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
@@ -402,12 +467,15 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
         return;
     }
 
+    Cancellation::throwIfRequested();
     Progress::messageProgressStage(Progress::Stage::SUPPORT, &time_keeper);
 
     AreaSupport::generateOverhangAreas(storage);
     AreaSupport::generateSupportAreas(storage);
     TreeSupport tree_support_generator(storage);
     tree_support_generator.generateSupportAreas(storage);
+    spdlog::debug("Releasing {} kB of model outlines cached for support generation", storage.model_offsets.getMemoryUsage() / 1024);
+    storage.model_offsets.release();
 
     computePrintHeightStatistics(storage);
 
@@ -439,13 +507,23 @@ void FffPolygonGenerator::slices2polygons(SliceDataStorage& storage, TimeKeeper&
     spdlog::debug("Processing gradual support");
     // generate gradual support
     AreaSupport::generateSupportInfillFeatures(storage);
+
+    std::atomic<size_t> trimmed_support_bytes{ 0 };
+    cura::parallel_for<size_t>(
+        0,
+        storage.support.supportLayers.size(),
+        [&storage, &trimmed_support_bytes](size_t layer_nr)
+        {
+            trimmed_support_bytes.fetch_add(storage.support.supportLayers[layer_nr].shrinkToFit(), std::memory_order_relaxed);
+        });
+    spdlog::debug("Trimmed {} kB of unused capacity from the support layers.", trimmed_support_bytes.load() / 1024);
 }
 
 void FffPolygonGenerator::processBasicWallsSkinInfill(
     SliceDataStorage& storage,
     const size_t mesh_order_idx,
     const std::vector<size_t>& mesh_order,
-    ProgressStageEstimator& inset_skin_progress_estimate)
+    ProgressStageEstimator* inset_skin_progress_estimate)
 {
     size_t mesh_idx = mesh_order[mesh_order_idx];
     SliceMeshStorage& mesh = *storage.meshes[mesh_idx];
@@ -455,56 +533,6 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
         processInfillMesh(storage, mesh_order_idx, mesh_order);
     }
 
-    // TODO: make progress more accurate!!
-    // note: estimated time for     insets : skins = 22.953 : 48.858
-    std::vector<double> walls_vs_skin_timing({ 22.953, 48.858 });
-    ProgressStageEstimator* mesh_inset_skin_progress_estimator = new ProgressStageEstimator(walls_vs_skin_timing);
-
-    inset_skin_progress_estimate.nextStage(mesh_inset_skin_progress_estimator); // the stage of this function call
-
-    ProgressEstimatorLinear* inset_estimator = new ProgressEstimatorLinear(mesh_layer_count);
-    mesh_inset_skin_progress_estimator->nextStage(inset_estimator);
-
-    struct
-    {
-        ProgressStageEstimator& progress_estimator;
-        std::mutex mutex{};
-        std::atomic<size_t> processed_layer_count = 0;
-
-        void operator++(int)
-        {
-            std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
-            if (lock)
-            { // progress estimation is done only in one thread so that no two threads message progress at the same time
-                size_t processed_layer_count_ = processed_layer_count.fetch_add(1, std::memory_order_relaxed);
-                double progress = progress_estimator.progress(processed_layer_count_);
-                Progress::messageProgress(Progress::Stage::INSET_SKIN, progress * 100, 100);
-            }
-            else
-            {
-                processed_layer_count.fetch_add(1, std::memory_order_release);
-            }
-        }
-        void reset()
-        {
-            processed_layer_count.store(0, std::memory_order_relaxed);
-        }
-    } guarded_progress = { inset_skin_progress_estimate };
-
-    // walls
-    cura::parallel_for<size_t>(
-        0,
-        mesh_layer_count,
-        [&](size_t layer_number)
-        {
-            spdlog::debug("Processing insets for layer {} of {}", layer_number, mesh.layers.size());
-            processWalls(mesh, layer_number);
-            guarded_progress++;
-        });
-
-    ProgressEstimatorLinear* skin_estimator = new ProgressEstimatorLinear(mesh_layer_count);
-    mesh_inset_skin_progress_estimator->nextStage(skin_estimator);
-
     bool process_infill = mesh.settings.get<coord_t>("infill_line_distance") > 0;
     if (! process_infill)
     { // do process infill anyway if it's modified by modifier meshes
@@ -534,19 +562,117 @@ void FffPolygonGenerator::processBasicWallsSkinInfill(
         mesh_max_initial_bottom_layer_count = std::max(mesh_max_initial_bottom_layer_count, mesh.settings.get<size_t>("initial_bottom_layers"));
     }
 
-    guarded_progress.reset();
-    cura::parallel_for<size_t>(
+    // The walls and the skin of a layer are progress steps alike, since they are generated at the same time.
+    ProgressEstimatorLinear* inset_skin_estimator = nullptr;
+    if (inset_skin_progress_estimate != nullptr)
+    {
+        inset_skin_estimator = new ProgressEstimatorLinear(2 * mesh_layer_count);
+        inset_skin_progress_estimate->nextStage(inset_skin_estimator); // the stage of this function call
+    }
+
+    struct
+    {
+        ProgressStageEstimator* progress_estimator;
+        std::atomic<size_t> processed_step_count = 0;
+
+        void operator++(int)
+        {
+            const size_t processed_step_count_ = processed_step_count.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (progress_estimator != nullptr)
+            { // Messaging progress only keeps it until it is sent, so every thread can.
+                const double progress = progress_estimator->progress(processed_step_count_);
+                Progress::messageProgress(Progress::Stage::INSET_SKIN, progress * 100, 100);
+            }
+        }
+    } guarded_progress = { inset_skin_progress_estimate };
+
+    // The skin and infill of a layer depend on the walls of the layers around it, as many as there are top and bottom
+    // layers, since the walls can remove parts and change their outlines. Rather than waiting for the walls of all
+    // layers, the skin of a layer is generated right away by the thread that completes the last walls it depends on.
+    const size_t skin_layers_below = std::max(size_t(1), mesh.settings.get<size_t>("bottom_layers"));
+    const size_t skin_layers_above = std::max(size_t(1), mesh.settings.get<size_t>("top_layers"));
+    std::vector<std::atomic<size_t>> pending_wall_counts(mesh_layer_count); // For each layer, the walls its skin still waits for.
+    for (size_t layer_number = 0; layer_number < mesh_layer_count; layer_number++)
+    {
+        const size_t window_start = layer_number - std::min(layer_number, skin_layers_below);
+        const size_t window_end = std::min(mesh_layer_count, layer_number + skin_layers_above + 1);
+        pending_wall_counts[layer_number].store(window_end - window_start, std::memory_order_relaxed);
+    }
+
+    // Many models have stretches of layers with the same outlines, whose walls only need to be generated once. The layers
+    // of this mesh that are the same as in the previous slice don't need new walls either.
+    const std::shared_ptr<WallToolPathsCache> walls_cache = MeshWallsCache::getInstance().get(mesh.settings, mesh_layer_count);
+    CompactPolygonsPool outline_pool;
+
+    // The skin of neighboring layers depends on the intersections of the outlines of almost the same layers.
+    OutlineIntersectionCache outline_intersections(mesh.layers, std::max(skin_layers_below, skin_layers_above));
+
+    // The cost of the walls and skin of a layer grows with the size of its outlines, which differs a lot between the
+    // layers of most models, so the layers are divided over the threads by their number of vertices.
+    cura::parallel_for_guided<size_t>(
         0,
         mesh_layer_count,
         [&](size_t layer_number)
         {
-            spdlog::debug("Processing skins and infill layer {} of {}", layer_number, mesh.layers.size());
-            if (! magic_spiralize || layer_number < mesh_max_initial_bottom_layer_count) // Only generate up/downskin and infill for the first X layers when spiralize is choosen.
+            CURA_LOG_DEBUG("Processing insets for layer {} of {}", layer_number, mesh.layers.size());
+            processWalls(mesh, layer_number, *walls_cache, outline_pool);
+            CURA_DEBUG_SVG(
+                "walls",
+                layer_number,
+                AABB(mesh.layers[layer_number].getOutlines()),
+                [&mesh, layer_number](SVG& svg)
+                {
+                    for (const SliceLayerPart& part : mesh.layers[layer_number].parts)
+                    {
+                        svg.writePolygons(part.outline, SVG::Color::BLACK);
+                        for (const VariableWidthLines& wall : part.wall_toolpaths)
+                        {
+                            svg.writeLines(wall, SVG::Color::BLUE);
+                        }
+                    }
+                });
+            guarded_progress++;
+
+            // The layers whose skin depends on the walls of this layer.
+            const size_t dependent_start = layer_number - std::min(layer_number, skin_layers_above);
+            const size_t dependent_end = std::min(mesh_layer_count, layer_number + skin_layers_below + 1);
+            for (size_t skin_layer_number = dependent_start; skin_layer_number < dependent_end; skin_layer_number++)
+            {
+                if (pending_wall_counts[skin_layer_number].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    continue;
+                }
+                CURA_LOG_DEBUG("Processing skins and infill layer {} of {}", skin_layer_number, mesh.layers.size());
+                if (! magic_spiralize || skin_layer_number < mesh_max_initial_bottom_layer_count) // Only generate up/downskin and infill for the first X layers when spiralize is choosen.
+                {
+                    processSkinsAndInfill(mesh, skin_layer_number, process_infill, outline_intersections);
+                }
+                guarded_progress++;
+            }
+        },
+        [&mesh](size_t layer_number)
+        {
+            size_t vertex_count = 1; // Even an empty layer costs a bit.
+            for (const SliceLayerPart& part : mesh.layers[layer_number].parts)
             {
-                processSkinsAndInfill(mesh, layer_number, process_infill);
+                vertex_count += part.outline.pointCount();
             }
-            guarded_progress++;
+            return vertex_count;
+        });
+    spdlog::debug("Reused the walls of {} outlines of mesh {} and generated {}.", walls_cache->hitCount(), mesh.mesh_name, walls_cache->missCount());
+    spdlog::debug("Shared the print outlines of {} parts of mesh {} with earlier ones.", outline_pool.hitCount(), mesh.mesh_name);
+
+    // Growing the areas and walls while generating them leaves up to half of their memory unused, and they live until
+    // the layers are written. Now that no layer reads the others anymore, they can be moved into buffers of their size.
+    std::atomic<size_t> trimmed_bytes{ 0 };
+    cura::parallel_for<size_t>(
+        0,
+        mesh_layer_count,
+        [&mesh, &trimmed_bytes](size_t layer_number)
+        {
+            trimmed_bytes.fetch_add(mesh.layers[layer_number].shrinkToFit(), std::memory_order_relaxed);
         });
+    spdlog::debug("Trimmed {} kB of unused capacity from the layers of mesh {}.", trimmed_bytes.load() / 1024, mesh.mesh_name);
 }
 
 void FffPolygonGenerator::processInfillMesh(SliceDataStorage& storage, const size_t mesh_order_idx, const std::vector<size_t>& mesh_order)
@@ -683,25 +809,21 @@ void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh)
     if (mesh.settings.get<coord_t>("infill_line_distance") > 0
         && (mesh.settings.get<EFillMethod>("infill_pattern") == EFillMethod::CROSS || mesh.settings.get<EFillMethod>("infill_pattern") == EFillMethod::CROSS_3D))
     {
-        const std::string cross_subdivision_spec_image_file = mesh.settings.get<std::string>("cross_infill_density_image");
+        std::string cross_subdivision_spec_image_file = mesh.settings.get<std::string>("cross_infill_density_image");
         std::ifstream cross_fs(cross_subdivision_spec_image_file.c_str());
-        if (! cross_subdivision_spec_image_file.empty() && cross_fs.good())
+        if (! cross_subdivision_spec_image_file.empty() && ! cross_fs.good())
         {
-            mesh.cross_fill_provider = std::make_shared<SierpinskiFillProvider>(
-                mesh.bounding_box,
-                mesh.settings.get<coord_t>("infill_line_distance"),
-                mesh.settings.get<coord_t>("infill_line_width"),
-                cross_subdivision_spec_image_file);
-        }
-        else
-        {
-            if (! cross_subdivision_spec_image_file.empty() && cross_subdivision_spec_image_file != " ")
+            if (cross_subdivision_spec_image_file != " ")
             {
                 spdlog::error("Cannot find density image: {}.", cross_subdivision_spec_image_file);
             }
-            mesh.cross_fill_provider
-                = std::make_shared<SierpinskiFillProvider>(mesh.bounding_box, mesh.settings.get<coord_t>("infill_line_distance"), mesh.settings.get<coord_t>("infill_line_width"));
+            cross_subdivision_spec_image_file.clear();
         }
+        mesh.cross_fill_provider = SierpinskiFillProviderCache::getInstance().get(
+            mesh.bounding_box,
+            mesh.settings.get<coord_t>("infill_line_distance"),
+            mesh.settings.get<coord_t>("infill_line_width"),
+            cross_subdivision_spec_image_file);
     }
 
     // Pre-compute lightning fill (aka minfill, aka ribbed support vaults)
@@ -727,10 +849,10 @@ void FffPolygonGenerator::processDerivedWallsSkinInfill(SliceMeshStorage& mesh)
  *
  * processInsets only reads and writes data for the current layer
  */
-void FffPolygonGenerator::processWalls(SliceMeshStorage& mesh, size_t layer_nr)
+void FffPolygonGenerator::processWalls(SliceMeshStorage& mesh, size_t layer_nr, WallToolPathsCache& walls_cache, CompactPolygonsPool& outline_pool)
 {
     SliceLayer* layer = &mesh.layers[layer_nr];
-    WallsComputation walls_computation(mesh.settings, layer_nr);
+    WallsComputation walls_computation(mesh.settings, layer_nr, &walls_cache, &outline_pool);
     walls_computation.generateWalls(layer, SectionType::WALL);
 }
 
@@ -758,7 +880,7 @@ bool FffPolygonGenerator::isEmptyLayer(SliceDataStorage& storage, const LayerInd
         }
         for (const SliceLayerPart& part : layer.parts)
         {
-            if (part.print_outline.size() > 0)
+            if (! part.print_outline.empty())
             {
                 return false;
             }
@@ -828,14 +950,14 @@ void FffPolygonGenerator::removeEmptyFirstLayers(SliceDataStorage& storage, size
  * processSkinsAndInfill read (depend on) mesh.layers[*].parts[*].{insets,boundingBox}.
  *                       write mesh.layers[n].parts[*].{skin_parts,infill_area}.
  */
-void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill)
+void FffPolygonGenerator::processSkinsAndInfill(SliceMeshStorage& mesh, const LayerIndex layer_nr, bool process_infill, OutlineIntersectionCache& outline_intersections)
 {
     if (mesh.settings.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
     {
         return;
     }
 
-    SkinInfillAreaComputation skin_infill_area_computation(layer_nr, mesh, process_infill);
+    SkinInfillAreaComputation skin_infill_area_computation(layer_nr, mesh, process_infill, outline_intersections);
     skin_infill_area_computation.generateSkinsAndInfill();
 
     if (((mesh.settings.get<bool>("ironing_enabled") && (! mesh.settings.get<bool>("ironing_only_highest_layer"))) || mesh.layer_nr_max_filled_layer == layer_nr)
@@ -1100,110 +1222,116 @@ void FffPolygonGenerator::processFuzzyWalls(SliceMeshStorage& mesh)
     unsigned int start_layer_nr
         = (mesh.settings.get<EPlatformAdhesion>("adhesion_type") == EPlatformAdhesion::BRIM) ? 1 : 0; // don't make fuzzy skin on first layer if there's a brim
 
-    auto hole_area = Polygons();
-    std::function<bool(const bool&, const ExtrusionJunction&)> accumulate_is_in_hole
-        = []([[maybe_unused]] const bool& prev_result, [[maybe_unused]] const ExtrusionJunction& junction)
-    {
-        return false;
-    };
-
-    for (LayerIndex layer_nr = start_layer_nr; layer_nr < mesh.layers.size(); layer_nr++)
-    {
-        SliceLayer& layer = mesh.layers[layer_nr];
-        for (SliceLayerPart& part : layer.parts)
+    // Each layer draws its random numbers from a generator seeded with its layer number, so that the layers can be processed in parallel and give the same result every time.
+    cura::parallel_for<size_t>(
+        start_layer_nr,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
         {
-            std::vector<VariableWidthLines> result_paths;
-            for (auto& toolpath : part.wall_toolpaths)
+            CounterRandom random(layer_nr);
+            SliceLayer& layer = mesh.layers[layer_nr];
+            for (SliceLayerPart& part : layer.parts)
             {
-                if (toolpath.front().inset_idx_ != 0)
-                {
-                    result_paths.push_back(toolpath);
-                    continue;
-                }
-
-                auto& result_lines = result_paths.emplace_back();
-
+                Polygons hole_area;
                 if (apply_outside_only)
                 {
-                    hole_area = part.print_outline.getOutsidePolygons().offset(-line_width);
-                    accumulate_is_in_hole = [&hole_area](const bool& prev_result, const ExtrusionJunction& junction)
-                    {
-                        return prev_result || hole_area.inside(junction.p_);
-                    };
+                    hole_area = part.print_outline.toPolygons().getOutsidePolygons().offset(-line_width);
                 }
-                for (auto& line : toolpath)
+                const auto is_in_hole = [&hole_area](const ExtrusionLine& line)
                 {
-                    if (apply_outside_only && std::accumulate(line.begin(), line.end(), false, accumulate_is_in_hole))
+                    return std::any_of(
+                        line.begin(),
+                        line.end(),
+                        [&hole_area](const ExtrusionJunction& junction)
+                        {
+                            return hole_area.inside(junction.p_);
+                        });
+                };
+
+                std::vector<VariableWidthLines> result_paths;
+                for (auto& toolpath : part.wall_toolpaths)
+                {
+                    if (toolpath.front().inset_idx_ != 0)
                     {
-                        result_lines.push_back(line);
+                        result_paths.push_back(toolpath);
                         continue;
                     }
 
-                    auto& result = result_lines.emplace_back(line.inset_idx_, line.is_odd_, line.is_closed_);
+                    auto& result_lines = result_paths.emplace_back();
 
-                    // generate points in between p0 and p1
-                    int64_t dist_left_over
-                        = (min_dist_between_points / 4) + rand() % (min_dist_between_points / 4); // the distance to be traversed on the line before making the first new point
-                    auto* p0 = &line.front();
-                    for (auto& p1 : line)
+                    for (auto& line : toolpath)
                     {
-                        if (p0->p_ == p1.p_) // avoid seams
+                        if (apply_outside_only && is_in_hole(line))
                         {
-                            result.emplace_back(p1.p_, p1.w_, p1.perimeter_index_);
+                            result_lines.push_back(line);
                             continue;
                         }
 
-                        // 'a' is the (next) new point between p0 and p1
-                        const Point2LL p0p1 = p1.p_ - p0->p_;
-                        const int64_t p0p1_size = vSize(p0p1);
-                        int64_t p0pa_dist = dist_left_over;
-                        if (p0pa_dist >= p0p1_size)
+                        auto& result = result_lines.emplace_back(line.inset_idx_, line.is_odd_, line.is_closed_);
+
+                        // generate points in between p0 and p1
+                        // the distance to be traversed on the line before making the first new point
+                        int64_t dist_left_over = (min_dist_between_points / 4) + random.below(min_dist_between_points / 4);
+                        auto* p0 = &line.front();
+                        for (auto& p1 : line)
                         {
-                            const Point2LL p = p1.p_ - (p0p1 / 2);
-                            const double width = (p1.w_ * vSize(p1.p_ - p) + p0->w_ * vSize(p0->p_ - p)) / p0p1_size;
-                            result.emplace_back(p, width, p1.perimeter_index_);
+                            if (p0->p_ == p1.p_) // avoid seams
+                            {
+                                result.emplace_back(p1.p_, p1.w_, p1.perimeter_index_);
+                                continue;
+                            }
+
+                            // 'a' is the (next) new point between p0 and p1
+                            const Point2LL p0p1 = p1.p_ - p0->p_;
+                            const int64_t p0p1_size = vSize(p0p1);
+                            int64_t p0pa_dist = dist_left_over;
+                            if (p0pa_dist >= p0p1_size)
+                            {
+                                const Point2LL p = p1.p_ - (p0p1 / 2);
+                                const double width = (p1.w_ * vSize(p1.p_ - p) + p0->w_ * vSize(p0->p_ - p)) / p0p1_size;
+                                result.emplace_back(p, width, p1.perimeter_index_);
+                            }
+                            for (; p0pa_dist < p0p1_size; p0pa_dist += min_dist_between_points + random.below(range_random_point_dist))
+                            {
+                                const coord_t r = random.below(fuzziness * 2) - fuzziness;
+                                const Point2LL perp_to_p0p1 = turn90CCW(p0p1);
+                                const Point2LL fuzz = normal(perp_to_p0p1, r);
+                                const Point2LL pa = p0->p_ + normal(p0p1, p0pa_dist);
+                                const double width = (p1.w_ * vSize(p1.p_ - pa) + p0->w_ * vSize(p0->p_ - pa)) / p0p1_size;
+                                result.emplace_back(pa + fuzz, width, p1.perimeter_index_);
+                            }
+                            // p0pa_dist > p0p1_size now because we broke out of the for-loop
+                            dist_left_over = p0pa_dist - p0p1_size;
+
+                            p0 = &p1;
                         }
-                        for (; p0pa_dist < p0p1_size; p0pa_dist += min_dist_between_points + rand() % range_random_point_dist)
+                        while (result.size() < 3)
                         {
-                            const int r = rand() % (fuzziness * 2) - fuzziness;
-                            const Point2LL perp_to_p0p1 = turn90CCW(p0p1);
-                            const Point2LL fuzz = normal(perp_to_p0p1, r);
-                            const Point2LL pa = p0->p_ + normal(p0p1, p0pa_dist);
-                            const double width = (p1.w_ * vSize(p1.p_ - pa) + p0->w_ * vSize(p0->p_ - pa)) / p0p1_size;
-                            result.emplace_back(pa + fuzz, width, p1.perimeter_index_);
+                            size_t point_idx = line.size() - 2;
+                            result.emplace_back(line[point_idx].p_, line[point_idx].w_, line[point_idx].perimeter_index_);
+                            if (point_idx == 0)
+                            {
+                                break;
+                            }
+                            point_idx--;
                         }
-                        // p0pa_dist > p0p1_size now because we broke out of the for-loop
-                        dist_left_over = p0pa_dist - p0p1_size;
-
-                        p0 = &p1;
-                    }
-                    while (result.size() < 3)
-                    {
-                        size_t point_idx = line.size() - 2;
-                        result.emplace_back(line[point_idx].p_, line[point_idx].w_, line[point_idx].perimeter_index_);
-                        if (point_idx == 0)
+                        if (result.size() < 3)
                         {
-                            break;
+                            result.clear();
+                            for (auto& p : line)
+                            {
+                                result.emplace_back(p.p_, p.w_, p.perimeter_index_);
+                            }
                         }
-                        point_idx--;
-                    }
-                    if (result.size() < 3)
-                    {
-                        result.clear();
-                        for (auto& p : line)
+                        if (line.back().p_ == line.front().p_) // avoid seams
                         {
-                            result.emplace_back(p.p_, p.w_, p.perimeter_index_);
+                            result.back().p_ = result.front().p_;
                         }
                     }
-                    if (line.back().p_ == line.front().p_) // avoid seams
-                    {
-                        result.back().p_ = result.front().p_;
-                    }
                 }
+                part.wall_toolpaths = result_paths;
             }
-            part.wall_toolpaths = result_paths;
-        }
-    }
+        });
 }
 
 
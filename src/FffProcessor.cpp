@@ -18,18 +18,55 @@ void FffProcessor::setTargetStream(std::ostream* stream)
     return gcode_writer.setTargetStream(stream);
 }
 
+bool FffProcessor::setToolpathDirectory(const std::filesystem::path& directory)
+{
+    return gcode_writer.setToolpathDirectory(directory);
+}
+
+void FffProcessor::disableOutput()
+{
+    gcode_writer.disableOutput();
+}
+
+void FffProcessor::enableDraftEstimate(const size_t layer_step)
+{
+    draft_estimator.emplace(layer_step);
+}
+
+void FffProcessor::disableDraftEstimate()
+{
+    draft_estimator.reset();
+}
+
+void FffProcessor::flushTargetStream()
+{
+    gcode_writer.flushTargetStream();
+}
+
 double FffProcessor::getTotalFilamentUsed(int extruder_nr)
 {
+    if (draft_estimator)
+    {
+        return draft_estimator->getMaterialUsed(extruder_nr);
+    }
     return gcode_writer.getTotalFilamentUsed(extruder_nr);
 }
 
 std::vector<Duration> FffProcessor::getTotalPrintTimePerFeature()
 {
+    if (draft_estimator)
+    {
+        return draft_estimator->getPrintTimePerFeature();
+    }
     return gcode_writer.getTotalPrintTimePerFeature();
 }
 
 void FffProcessor::finalize()
 {
+    if (draft_estimator)
+    {
+        return; // No g-code was written.
+    }
     gcode_writer.finalize();
 }
 
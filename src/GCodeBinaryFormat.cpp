@@ -0,0 +1,458 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "GCodeBinaryFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+
+#include <zlib.h>
+
+#include "communication/PayloadCompression.h"
+#include "utils/string.h" // GCodeLineBuilder, writeDoubleToChars, writeInt2mm
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr std::string_view magic = "CGCB";
+
+enum class BlockType : uint16_t
+{
+    METADATA = 0,
+    GCODE = 1,
+};
+
+enum class Compression : uint16_t
+{
+    NONE = 0,
+    DEFLATE = 1,
+};
+
+constexpr size_t block_header_size = 12;
+constexpr size_t block_footer_size = 4;
+
+constexpr uint8_t record_text = 0;
+constexpr uint8_t record_move = 1;
+constexpr uint8_t move_writes_f = 1 << 1;
+constexpr uint8_t move_writes_z = 1 << 2;
+constexpr uint8_t move_writes_e = 1 << 3;
+
+constexpr uint8_t f_precision = 1; //!< The number of decimals that F is written with, as in GCodeOutputWriter::formatMove.
+constexpr uint8_t e_precision = 5; //!< The number of decimals that E is written with, as in GCodeOutputWriter::formatMove.
+
+void appendUint16(std::string& out, const uint16_t value)
+{
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void appendUint32(std::string& out, const uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+uint32_t readUint(const std::string_view data, const size_t position, const size_t byte_count)
+{
+    uint32_t value = 0;
+    for (size_t byte_idx = 0; byte_idx < byte_count; byte_idx++)
+    {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[position + byte_idx])) << (8 * byte_idx);
+    }
+    return value;
+}
+
+void appendVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void appendDelta(std::string& out, int64_t& previous, const int64_t value)
+{
+    const int64_t delta = value - previous;
+    previous = value;
+    appendVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+}
+
+std::optional<uint64_t> readVarint(const std::string_view data, size_t& position)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && position < data.size(); shift += 7)
+    {
+        const uint8_t byte = static_cast<uint8_t>(data[position++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (! (byte & 0x80))
+        {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+bool readDelta(const std::string_view data, size_t& position, int64_t& previous)
+{
+    const std::optional<uint64_t> zigzag = readVarint(data, position);
+    if (! zigzag)
+    {
+        return false;
+    }
+    previous += static_cast<int64_t>(*zigzag >> 1) ^ -static_cast<int64_t>(*zigzag & 1);
+    return true;
+}
+
+/*!
+ * Get a value as a whole number of units of 10^-precision, rounded the same way as the text g-code writes it.
+ *
+ * Returns nothing if the value can't be stored that way, such as when it isn't finite or when the text would have a
+ * minus sign in front of a zero.
+ */
+std::optional<int64_t> quantize(const double value, const uint8_t precision)
+{
+    std::array<char, double_max_chars> buffer;
+    const char* const end = writeDoubleToChars(precision, value, buffer.data());
+    const char* start = buffer.data();
+    const bool negative = start != end && *start == '-';
+    if (negative)
+    {
+        start++;
+    }
+    const char* const dot = std::find(start, end, '.');
+    const size_t decimal_count = dot == end ? 0 : static_cast<size_t>(end - dot - 1);
+    if (static_cast<size_t>(dot - start) + precision > 18) // More digits than an int64_t holds.
+    {
+        return std::nullopt;
+    }
+    int64_t whole = 0;
+    int64_t decimals = 0;
+    if (std::from_chars(start, dot, whole).ptr != dot || (dot != end && std::from_chars(dot + 1, end, decimals).ptr != end))
+    {
+        return std::nullopt; // Not a plain number, such as INF.
+    }
+    for (size_t decimal_idx = decimal_count; decimal_idx < precision; decimal_idx++)
+    {
+        decimals *= 10;
+    }
+    int64_t scale = 1;
+    for (uint8_t decimal_idx = 0; decimal_idx < precision; decimal_idx++)
+    {
+        scale *= 10;
+    }
+    const int64_t units = whole * scale + decimals;
+    if (negative && units == 0)
+    {
+        return std::nullopt;
+    }
+    return negative ? -units : units;
+}
+
+//! Write a whole number of units of 10^-precision the way \ref writeDoubleToChars writes the value.
+void appendQuantized(std::string& out, const int64_t units, const uint8_t precision)
+{
+    uint64_t scale = 1;
+    for (uint8_t decimal_idx = 0; decimal_idx < precision; decimal_idx++)
+    {
+        scale *= 10;
+    }
+    const uint64_t magnitude = units < 0 ? -static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+    std::array<char, 24> buffer;
+    char* end = buffer.data();
+    if (units < 0)
+    {
+        *end++ = '-';
+    }
+    end = std::to_chars(end, buffer.data() + buffer.size(), magnitude / scale).ptr;
+    uint64_t decimals = magnitude % scale;
+    if (decimals != 0)
+    {
+        *end++ = '.';
+        for (uint64_t digit = scale / 10; digit > 0 && decimals != 0; digit /= 10)
+        {
+            *end++ = static_cast<char>('0' + decimals / digit);
+            decimals %= digit;
+        }
+    }
+    out.append(buffer.data(), end);
+}
+
+std::string encodeBlock(const BlockType type, const std::string_view payload)
+{
+    std::string compressed = deflatePayload(payload);
+    Compression compression = Compression::DEFLATE;
+    if (compressed.empty() && ! payload.empty())
+    {
+        compressed = payload; // Compressing failed, which deflatePayload already reported.
+        compression = Compression::NONE;
+    }
+    std::string block;
+    block.reserve(block_header_size + compressed.size() + block_footer_size);
+    appendUint16(block, static_cast<uint16_t>(type));
+    appendUint16(block, static_cast<uint16_t>(compression));
+    appendUint32(block, static_cast<uint32_t>(payload.size()));
+    appendUint32(block, static_cast<uint32_t>(compressed.size()));
+    block += compressed;
+    appendUint32(block, crc32(0, reinterpret_cast<const Bytef*>(compressed.data()), static_cast<uInt>(compressed.size())));
+    return block;
+}
+
+void appendText(std::string& out, const std::string_view text)
+{
+    if (text.empty())
+    {
+        return;
+    }
+    out.push_back(static_cast<char>(record_text));
+    appendVarint(out, text.size());
+    out += text;
+}
+
+bool decodeMetadata(const std::string_view payload, std::vector<std::pair<std::string, std::string>>& metadata)
+{
+    size_t line_start = 0;
+    while (line_start < payload.size())
+    {
+        const size_t line_end = payload.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+        {
+            return false;
+        }
+        const std::string_view line = payload.substr(line_start, line_end - line_start);
+        const size_t separator = line.find('=');
+        if (separator == std::string_view::npos)
+        {
+            return false;
+        }
+        metadata.emplace_back(line.substr(0, separator), line.substr(separator + 1));
+        line_start = line_end + 1;
+    }
+    return true;
+}
+
+bool decodeGCode(const std::string_view payload, std::string& gcode)
+{
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t z = 0;
+    int64_t f = 0;
+    int64_t e = 0;
+    size_t position = 0;
+    while (position < payload.size())
+    {
+        const uint8_t tag = static_cast<uint8_t>(payload[position++]);
+        if (tag == record_text)
+        {
+            const std::optional<uint64_t> length = readVarint(payload, position);
+            if (! length || *length > payload.size() - position)
+            {
+                return false;
+            }
+            gcode += payload.substr(position, *length);
+            position += *length;
+            continue;
+        }
+        if (! (tag & record_move))
+        {
+            return false;
+        }
+        char e_character = 'E';
+        if (tag & move_writes_e)
+        {
+            if (position >= payload.size())
+            {
+                return false;
+            }
+            e_character = payload[position++];
+        }
+        if (! readDelta(payload, position, x) || ! readDelta(payload, position, y) || ((tag & move_writes_z) && ! readDelta(payload, position, z))
+            || ((tag & move_writes_f) && ! readDelta(payload, position, f)) || ((tag & move_writes_e) && ! readDelta(payload, position, e)))
+        {
+            return false;
+        }
+        std::array<char, int2mm_max_chars> coordinate;
+        if (tag & move_writes_f)
+        {
+            gcode += " F";
+            appendQuantized(gcode, f, f_precision);
+        }
+        gcode += " X";
+        gcode.append(coordinate.data(), writeInt2mm(static_cast<int32_t>(x), coordinate.data()));
+        gcode += " Y";
+        gcode.append(coordinate.data(), writeInt2mm(static_cast<int32_t>(y), coordinate.data()));
+        if (tag & move_writes_z)
+        {
+            gcode += " Z";
+            gcode.append(coordinate.data(), writeInt2mm(static_cast<int32_t>(z), coordinate.data()));
+        }
+        if (tag & move_writes_e)
+        {
+            gcode += ' ';
+            gcode += e_character;
+            appendQuantized(gcode, e, e_precision);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::string encodeBinaryGCodeFileHeader()
+{
+    std::string header(magic);
+    appendUint32(header, binary_gcode_version);
+    return header;
+}
+
+std::string encodeBinaryGCodeMetadata(const std::string_view file_header)
+{
+    std::string payload;
+    size_t line_start = 0;
+    while (line_start < file_header.size())
+    {
+        size_t line_end = file_header.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+        {
+            line_end = file_header.size();
+        }
+        std::string_view line = file_header.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+        if (! line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        const size_t separator = line.find(':');
+        if (! line.starts_with(';') || separator == std::string_view::npos)
+        {
+            continue; // Not a key with a value, such as ";START_OF_HEADER".
+        }
+        payload.append(line.substr(1, separator - 1));
+        payload.push_back('=');
+        payload.append(line.substr(separator + 1));
+        payload.push_back('\n');
+    }
+    return encodeBlock(BlockType::METADATA, payload);
+}
+
+std::string encodeBinaryGCodeBlock(const std::string_view text, const std::vector<std::pair<size_t, GCodeOutputWriter::Move>>& moves)
+{
+    constexpr size_t estimated_move_size = 8;
+    std::string payload;
+    payload.reserve(text.size() + moves.size() * estimated_move_size);
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t z = 0;
+    int64_t f = 0;
+    int64_t e = 0;
+    size_t text_start = 0;
+    for (const auto& [position, move] : moves)
+    {
+        appendText(payload, text.substr(text_start, position - text_start));
+        text_start = position;
+
+        const std::optional<int64_t> move_f = move.write_f ? quantize(move.f, f_precision) : 0;
+        const std::optional<int64_t> move_e = move.write_e ? quantize(move.e, e_precision) : 0;
+        if (! move_f || ! move_e)
+        {
+            GCodeLineBuilder line;
+            GCodeOutputWriter::formatMove(line, move);
+            std::string move_text;
+            line.appendTo(move_text);
+            appendText(payload, move_text);
+            continue;
+        }
+        payload.push_back(static_cast<char>(record_move | (move.write_f ? move_writes_f : 0) | (move.write_z ? move_writes_z : 0) | (move.write_e ? move_writes_e : 0)));
+        if (move.write_e)
+        {
+            payload.push_back(move.e_character);
+        }
+        appendDelta(payload, x, static_cast<int32_t>(move.x)); // Rounded the same way as the text g-code.
+        appendDelta(payload, y, static_cast<int32_t>(move.y));
+        if (move.write_z)
+        {
+            appendDelta(payload, z, static_cast<int32_t>(move.z));
+        }
+        if (move.write_f)
+        {
+            appendDelta(payload, f, *move_f);
+        }
+        if (move.write_e)
+        {
+            appendDelta(payload, e, *move_e);
+        }
+    }
+    appendText(payload, text.substr(text_start));
+    return encodeBlock(BlockType::GCODE, payload);
+}
+
+std::optional<BinaryGCode> decodeBinaryGCode(const std::string_view data)
+{
+    if (data.size() < magic.size() + 4 || ! data.starts_with(magic) || readUint(data, magic.size(), 4) != binary_gcode_version)
+    {
+        return std::nullopt;
+    }
+    BinaryGCode result;
+    size_t position = magic.size() + 4;
+    while (position < data.size())
+    {
+        if (data.size() - position < block_header_size + block_footer_size)
+        {
+            return std::nullopt;
+        }
+        const uint32_t type = readUint(data, position, 2);
+        const uint32_t compression = readUint(data, position + 2, 2);
+        const uint32_t size = readUint(data, position + 4, 4);
+        const uint32_t compressed_size = readUint(data, position + 8, 4);
+        position += block_header_size;
+        if (data.size() - position - block_footer_size < compressed_size)
+        {
+            return std::nullopt;
+        }
+        const std::string_view compressed = data.substr(position, compressed_size);
+        position += compressed_size;
+        if (crc32(0, reinterpret_cast<const Bytef*>(compressed.data()), static_cast<uInt>(compressed.size())) != readUint(data, position, 4))
+        {
+            return std::nullopt;
+        }
+        position += block_footer_size;
+
+        std::string payload;
+        if (compression == static_cast<uint16_t>(Compression::DEFLATE))
+        {
+            payload.resize(size);
+            uLongf uncompressed_size = size;
+            if (uncompress(reinterpret_cast<Bytef*>(payload.data()), &uncompressed_size, reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()) != Z_OK
+                || uncompressed_size != size)
+            {
+                return std::nullopt;
+            }
+        }
+        else if (compression == static_cast<uint16_t>(Compression::NONE) && compressed_size == size)
+        {
+            payload = compressed;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        const bool decoded = type == static_cast<uint16_t>(BlockType::METADATA) ? decodeMetadata(payload, result.metadata)
+                           : type == static_cast<uint16_t>(BlockType::GCODE)  ? decodeGCode(payload, result.gcode)
+                                                                               : false;
+        if (! decoded)
+        {
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+} // namespace cura
@@ -0,0 +1,299 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "GCodeOutputWriter.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "GCodeBinaryFormat.h"
+#include "utils/string.h" // GCodeLineBuilder, MMtoStream, PrecisionedDouble
+
+namespace cura
+{
+
+GCodeOutputWriter::GCodeOutputWriter(std::ostream* target, const size_t formatter_count)
+    : target_(target)
+    , formatter_count_(std::max(size_t(1), formatter_count))
+{
+}
+
+GCodeOutputWriter::~GCodeOutputWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+size_t GCodeOutputWriter::defaultFormatterCount()
+{
+    return std::clamp(size_t(std::thread::hardware_concurrency() / 4), size_t(1), size_t(4));
+}
+
+std::ostream& GCodeOutputWriter::buffer()
+{
+    return buffer_;
+}
+
+void GCodeOutputWriter::writeMove(const Move& move)
+{
+    buffer_moves_.emplace_back(static_cast<size_t>(buffer_.tellp()), move);
+}
+
+void GCodeOutputWriter::formatMove(std::ostream& out, const Move& move)
+{
+    GCodeLineBuilder line;
+    formatMove(line, move);
+    out << line;
+}
+
+void GCodeOutputWriter::formatMove(GCodeLineBuilder& line, const Move& move)
+{
+    if (move.write_f)
+    {
+        line << " F" << PrecisionedDouble{ 1, move.f };
+    }
+    line << " X" << MMtoStream{ move.x } << " Y" << MMtoStream{ move.y };
+    if (move.write_z)
+    {
+        line << " Z" << MMtoStream{ move.z };
+    }
+    if (move.write_e)
+    {
+        line << ' ' << move.e_character << PrecisionedDouble{ 5, move.e };
+    }
+}
+
+void GCodeOutputWriter::setTarget(std::ostream* target)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    target_ = target;
+}
+
+void GCodeOutputWriter::submit()
+{
+    auto chunk = std::make_shared<Chunk>();
+    chunk->text = std::move(buffer_).str();
+    if (chunk->text.empty() && buffer_moves_.empty())
+    {
+        return;
+    }
+    buffer_.str("");
+    std::swap(chunk->moves, buffer_moves_);
+    chunk->binary = binary_;
+    chunk->formatted = chunk->moves.empty() && ! binary_;
+    enqueue(std::move(chunk));
+}
+
+void GCodeOutputWriter::setBinary(const bool binary)
+{
+    if (binary == binary_)
+    {
+        return;
+    }
+    submit();
+    binary_ = binary;
+    if (binary_)
+    {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->text = encodeBinaryGCodeFileHeader();
+        chunk->formatted = true;
+        enqueue(std::move(chunk));
+    }
+}
+
+bool GCodeOutputWriter::isBinary() const
+{
+    return binary_;
+}
+
+void GCodeOutputWriter::submitMetadata(const std::string_view file_header)
+{
+    submit();
+    auto chunk = std::make_shared<Chunk>();
+    chunk->text = encodeBinaryGCodeMetadata(file_header);
+    chunk->formatted = true;
+    enqueue(std::move(chunk));
+}
+
+void GCodeOutputWriter::enqueue(std::shared_ptr<Chunk> chunk)
+{
+    if (target_ == nullptr)
+    {
+        return; // Nobody reads the g-code, so don't bother formatting it.
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        startThreads();
+        condition_.wait(
+            lock,
+            [this]()
+            {
+                return chunks_.size() <= formatter_count_;
+            });
+        chunks_.push_back(std::move(chunk));
+    }
+    condition_.notify_all();
+}
+
+void GCodeOutputWriter::flush()
+{
+    submit();
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(
+        lock,
+        [this]()
+        {
+            return chunks_.empty() && ! writing_;
+        });
+    if (target_ != nullptr)
+    {
+        target_->flush();
+    }
+}
+
+void GCodeOutputWriter::discard()
+{
+    buffer_.str("");
+    buffer_moves_.clear();
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Chunks that are being formatted are dropped by the writer thread once they are formatted.
+    std::erase_if(
+        chunks_,
+        [](const std::shared_ptr<Chunk>& chunk)
+        {
+            return ! chunk->formatting || chunk->formatted;
+        });
+    for (const std::shared_ptr<Chunk>& chunk : chunks_)
+    {
+        chunk->discarded = true;
+    }
+    condition_.notify_all();
+    condition_.wait(
+        lock,
+        [this]()
+        {
+            return chunks_.empty() && ! writing_;
+        });
+}
+
+void GCodeOutputWriter::format(Chunk& chunk)
+{
+    if (chunk.binary)
+    {
+        chunk.text = encodeBinaryGCodeBlock(chunk.text, chunk.moves);
+        chunk.moves.clear();
+        return;
+    }
+    constexpr size_t estimated_move_size = 32;
+    std::string out;
+    out.reserve(chunk.text.size() + chunk.moves.size() * estimated_move_size);
+    size_t text_start = 0;
+    for (const auto& [position, move] : chunk.moves)
+    {
+        out.append(chunk.text, text_start, position - text_start);
+        GCodeLineBuilder line;
+        formatMove(line, move);
+        line.appendTo(out);
+        text_start = position;
+    }
+    out.append(chunk.text, text_start);
+    chunk.text = std::move(out);
+    chunk.moves.clear();
+}
+
+void GCodeOutputWriter::startThreads()
+{
+    if (! threads_.empty())
+    {
+        return;
+    }
+    for (size_t formatter_idx = 0; formatter_idx < formatter_count_; formatter_idx++)
+    {
+        threads_.emplace_back(&GCodeOutputWriter::runFormatter, this);
+    }
+    threads_.emplace_back(&GCodeOutputWriter::runWriter, this);
+}
+
+void GCodeOutputWriter::runFormatter()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        std::shared_ptr<Chunk> chunk;
+        condition_.wait(
+            lock,
+            [this, &chunk]()
+            {
+                const auto unclaimed = std::find_if(
+                    chunks_.begin(),
+                    chunks_.end(),
+                    [](const std::shared_ptr<Chunk>& candidate)
+                    {
+                        return ! candidate->formatting && ! candidate->formatted;
+                    });
+                if (unclaimed != chunks_.end())
+                {
+                    chunk = *unclaimed;
+                }
+                return chunk != nullptr || stop_;
+            });
+        if (! chunk)
+        {
+            return;
+        }
+        chunk->formatting = true;
+        lock.unlock();
+
+        format(*chunk);
+
+        lock.lock();
+        chunk->formatted = true;
+        condition_.notify_all();
+    }
+}
+
+void GCodeOutputWriter::runWriter()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        condition_.wait(
+            lock,
+            [this]()
+            {
+                return (! chunks_.empty() && chunks_.front()->formatted) || stop_;
+            });
+        if (chunks_.empty() || ! chunks_.front()->formatted)
+        {
+            return;
+        }
+        const std::shared_ptr<Chunk> chunk = std::move(chunks_.front());
+        chunks_.pop_front();
+        if (chunk->discarded)
+        {
+            condition_.notify_all();
+            continue;
+        }
+        writing_ = true;
+        std::ostream* target = target_;
+        lock.unlock();
+        condition_.notify_all(); // There is room for the next chunk.
+
+        target->write(chunk->text.data(), static_cast<std::streamsize>(chunk->text.size()));
+
+        lock.lock();
+        writing_ = false;
+        condition_.notify_all();
+    }
+}
+
+} // namespace cura
@@ -63,6 +63,12 @@ namespace cura
     return flow;
 }
 
+void GCodePathConfig::setLayerThickness(const coord_t new_layer_thickness) noexcept
+{
+    layer_thickness = new_layer_thickness;
+    extrusion_mm3_per_mm = calculateExtrusion();
+}
+
 [[nodiscard]] double GCodePathConfig::calculateExtrusion() const noexcept
 {
     return INT2MM(line_width) * INT2MM(layer_thickness) * double(flow);
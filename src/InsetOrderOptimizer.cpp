@@ -3,7 +3,9 @@
 
 #include "InsetOrderOptimizer.h"
 
+#include <algorithm>
 #include <functional>
+#include <map>
 #include <tuple>
 
 #include <range/v3/algorithm/max.hpp>
@@ -23,6 +25,7 @@
 #include "ExtruderTrain.h"
 #include "FffGcodeWriter.h"
 #include "LayerPlan.h"
+#include "utils/AABB.h"
 #include "utils/views/convert.h"
 #include "utils/views/dfs.h"
 
@@ -163,79 +166,72 @@ InsetOrderOptimizer::value_type InsetOrderOptimizer::getRegionOrder(const std::v
         return {};
     }
 
-    // view on the extrusion lines, sorted by area
-    const std::vector<const ExtrusionLine*> sorted_extrusion_lines = [&extrusion_lines]()
+    // The extrusion lines, sorted by the area of their bounding boxes, together with their polygons.
+    struct SortedLine
     {
-        auto extrusion_lines_area = extrusion_lines | ranges::views::addressof
-                                  | ranges::views::transform(
-                                        [](const ExtrusionLine* line)
-                                        {
-                                            const auto poly = line->toPolygon();
-                                            AABB aabb;
-                                            aabb.include(poly);
-                                            return std::make_pair(line, aabb.area());
-                                        })
-                                  | ranges::to_vector;
-
-        ranges::sort(
-            extrusion_lines_area,
-            [](const auto& lhs, const auto& rhs)
-            {
-                return std::get<1>(lhs) < std::get<1>(rhs);
-            });
-
-        return extrusion_lines_area
-             | ranges::views::transform(
-                   [](const auto& pair)
-                   {
-                       return std::get<0>(pair);
-                   })
-             | ranges::to_vector;
-    }();
+        const ExtrusionLine* line;
+        Polygons polygons;
+        AABB aabb;
+    };
+    std::vector<SortedLine> sorted_extrusion_lines;
+    sorted_extrusion_lines.reserve(extrusion_lines.size());
+    for (const ExtrusionLine& line : extrusion_lines)
+    {
+        SortedLine& sorted_line = sorted_extrusion_lines.emplace_back(SortedLine{ &line, Polygons(), AABB() });
+        sorted_line.polygons.add(line.toPolygon());
+        sorted_line.aabb.include(sorted_line.polygons);
+    }
+    std::stable_sort(
+        sorted_extrusion_lines.begin(),
+        sorted_extrusion_lines.end(),
+        [](const SortedLine& lhs, const SortedLine& rhs)
+        {
+            return lhs.aabb.area() < rhs.aabb.area();
+        });
 
     // graph will contain the parent-child relationships between the extrusion lines
     // an edge is added for both the parent to child and child to parent relationship
     std::unordered_multimap<const ExtrusionLine*, const ExtrusionLine*> graph;
     // during the loop we maintain a list of invariant parents; these are the parents
-    // that we have found so far
-    std::unordered_set<const ExtrusionLine*> invariant_outer_parents;
-    for (const auto& extrusion_line : sorted_extrusion_lines)
+    // that we have found so far. They are kept by the X coordinate of their first junction, so
+    // that only the parents that can be inside the bounding box of a line need to be tested.
+    std::multimap<coord_t, const ExtrusionLine*> invariant_outer_parents;
+    for (const SortedLine& sorted_line : sorted_extrusion_lines)
     {
-        // Create a polygon representing the inner area of the extrusion line; any
-        // point inside this polygon is considered to the child of the extrusion line.
-        Polygons hole_polygons;
-        if (extrusion_line->is_closed_)
-        {
-            hole_polygons.add(extrusion_line->toPolygon());
-        }
-
-        if (hole_polygons.empty())
+        const ExtrusionLine* extrusion_line = sorted_line.line;
+        if (! extrusion_line->is_closed_)
         {
-            invariant_outer_parents.emplace(extrusion_line);
+            invariant_outer_parents.emplace(extrusion_line->junctions_[0].p_.X, extrusion_line);
             continue;
         }
 
+        // Create a polygon representing the inner area of the extrusion line; any
+        // point inside this polygon is considered to the child of the extrusion line.
+        const Polygons& hole_polygons = sorted_line.polygons;
+
         // go through all the invariant parents and see if they are inside the hole polygon
         // if they are, then that means we have found a child for this extrusion line
-        std::vector<const ExtrusionLine*> removed_parent_invariants;
-        for (const ExtrusionLine* invariant_parent : invariant_outer_parents)
+        const AABB& aabb = sorted_line.aabb;
+        for (auto invariant_parent = invariant_outer_parents.lower_bound(aabb.min_.X);
+             invariant_parent != invariant_outer_parents.end() && invariant_parent->first <= aabb.max_.X;)
         {
-            if (hole_polygons.inside(invariant_parent->junctions_[0].p_, false))
+            const Point2LL& first_point = invariant_parent->second->junctions_[0].p_;
+            if (first_point.Y >= aabb.min_.Y && first_point.Y <= aabb.max_.Y && hole_polygons.inside(first_point, false))
             {
                 // The root polygon is inside the location polygon. It is no longer a root in the graph we are building.
                 // Add this relationship (locator <-> root) to the graph, and remove root from roots.
-                graph.emplace(extrusion_line, invariant_parent);
-                graph.emplace(invariant_parent, extrusion_line);
-                removed_parent_invariants.emplace_back(invariant_parent);
+                graph.emplace(extrusion_line, invariant_parent->second);
+                graph.emplace(invariant_parent->second, extrusion_line);
+                invariant_parent = invariant_outer_parents.erase(invariant_parent);
+            }
+            else
+            {
+                ++invariant_parent;
             }
-        }
-        for (const auto& node : removed_parent_invariants)
-        {
-            invariant_outer_parents.erase(node);
         }
 
         // the current extrusion line is now an invariant parent
-        invariant_outer_parents.emplace(extrusion_line);
+        invariant_outer_parents.emplace(extrusion_line->junctions_[0].p_.X, extrusion_line);
     }
 
     const std::vector<const ExtrusionLine*> outer_walls = extrusion_lines | ranges::views::filter(&ExtrusionLine::is_outer_wall) | ranges::views::addressof | ranges::to_vector;
@@ -14,6 +14,7 @@
 #include "Slice.h"
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
+#include "utils/ThreadPool.h"
 #include "utils/VoxelUtils.h"
 #include "utils/polygonUtils.h"
 
@@ -89,7 +90,7 @@ std::pair<Polygons, Polygons> InterlockingGenerator::growBorderAreasPerpendicula
     return { from_border_a, from_border_b };
 }
 
-void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>& has_all_meshes) const
+void InterlockingGenerator::handleThinAreas(const VoxelSet& has_all_meshes) const
 {
     Settings& global_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     const coord_t boundary_avoidance = global_settings.get<int>("interlocking_boundary_avoidance");
@@ -106,14 +107,15 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
     // Make an inclusionary polygon, to only actually handle thin areas near actual microstructures (so not in skin for example).
     std::vector<Polygons> near_interlock_per_layer;
     near_interlock_per_layer.assign(std::min(mesh_a_.layers.size(), mesh_b_.layers.size()), Polygons());
-    for (const auto& cell : has_all_meshes)
-    {
-        const Point3LL bottom_corner = vu_.toLowerCorner(cell);
-        for (coord_t layer_nr = bottom_corner.z_; layer_nr < bottom_corner.z_ + cell_size_.z_ && layer_nr < static_cast<coord_t>(near_interlock_per_layer.size()); ++layer_nr)
+    has_all_meshes.forEach(
+        [&](const GridPoint3& cell)
         {
-            near_interlock_per_layer[static_cast<size_t>(layer_nr)].add(vu_.toPolygon(cell));
-        }
-    }
+            const Point3LL bottom_corner = vu_.toLowerCorner(cell);
+            for (coord_t layer_nr = bottom_corner.z_; layer_nr < bottom_corner.z_ + cell_size_.z_ && layer_nr < static_cast<coord_t>(near_interlock_per_layer.size()); ++layer_nr)
+            {
+                near_interlock_per_layer[static_cast<size_t>(layer_nr)].add(vu_.toPolygon(cell));
+            }
+        });
     for (auto& near_interlock : near_interlock_per_layer)
     {
         near_interlock = near_interlock.offset(rounding_errors).offset(-rounding_errors).unionPolygons().offset(detect);
@@ -149,23 +151,18 @@ void InterlockingGenerator::handleThinAreas(const std::unordered_set<GridPoint3>
 
 void InterlockingGenerator::generateInterlockingStructure() const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh = getShellVoxels(interface_dilation_);
+    std::vector<VoxelSet> voxels_per_mesh = getShellVoxels(interface_dilation_);
 
-    std::unordered_set<GridPoint3>& has_any_mesh = voxels_per_mesh[0];
-    std::unordered_set<GridPoint3>& has_all_meshes = voxels_per_mesh[1];
-    has_any_mesh.merge(has_all_meshes); // perform union and intersection simultaneously. Cannibalizes voxels_per_mesh
+    VoxelSet& has_all_meshes = voxels_per_mesh[1];
+    has_all_meshes.intersect(voxels_per_mesh[0]);
 
     const std::vector<Polygons> layer_regions = computeUnionedVolumeRegions();
 
     if (air_filtering_)
     {
-        std::unordered_set<GridPoint3> air_cells;
+        VoxelSet air_cells;
         addBoundaryCells(layer_regions, air_dilation_, air_cells);
-
-        for (const GridPoint3& p : air_cells)
-        {
-            has_all_meshes.erase(p);
-        }
+        has_all_meshes.subtract(air_cells);
 
         handleThinAreas(has_all_meshes);
     }
@@ -173,15 +170,15 @@ void InterlockingGenerator::generateInterlockingStructure() const
     applyMicrostructureToOutlines(has_all_meshes, layer_regions);
 }
 
-std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
+std::vector<VoxelSet> InterlockingGenerator::getShellVoxels(const DilationKernel& kernel) const
 {
-    std::vector<std::unordered_set<GridPoint3>> voxels_per_mesh(2);
+    std::vector<VoxelSet> voxels_per_mesh(2);
 
     // mark all cells which contain some boundary
     for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++)
     {
         Slicer* mesh = (mesh_idx == 0) ? &mesh_a_ : &mesh_b_;
-        std::unordered_set<GridPoint3>& mesh_voxels = voxels_per_mesh[mesh_idx];
+        VoxelSet& mesh_voxels = voxels_per_mesh[mesh_idx];
 
         std::vector<Polygons> rotated_polygons_per_layer(mesh->layers.size());
         for (size_t layer_nr = 0; layer_nr < mesh->layers.size(); layer_nr++)
@@ -197,25 +194,35 @@ std::vector<std::unordered_set<GridPoint3>> InterlockingGenerator::getShellVoxel
     return voxels_per_mesh;
 }
 
-void InterlockingGenerator::addBoundaryCells(const std::vector<Polygons>& layers, const DilationKernel& kernel, std::unordered_set<GridPoint3>& cells) const
+void InterlockingGenerator::addBoundaryCells(const std::vector<Polygons>& layers, const DilationKernel& kernel, VoxelSet& cells) const
 {
-    auto voxel_emplacer = [&cells](GridPoint3 p)
-    {
-        cells.emplace(p);
-        return true;
-    };
+    // Each layer is rasterized on its own, and the runs of cells are added to the set afterwards. The dilation reaches
+    // into the cells of neighbouring layers, so the runs of different layers overlap a bit.
+    std::vector<std::vector<VoxelSpan>> spans_per_layer(layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        layers.size(),
+        [&](const size_t layer_nr)
+        {
+            const coord_t z = static_cast<coord_t>(layer_nr);
+            std::vector<VoxelSpan>& spans = spans_per_layer[layer_nr];
+            spans = vu_.rasterizeDilatedPolygons(layers[layer_nr], z, kernel);
+            Polygons skin = layers[layer_nr];
+            if (layer_nr > 0)
+            {
+                skin = skin.xorPolygons(layers[layer_nr - 1]);
+            }
+            skin = skin.offset(-cell_size_.x_ / 2).offset(cell_size_.x_ / 2); // remove superfluous small areas, which would anyway be included because of walkPolygons
+            const std::vector<VoxelSpan> skin_spans = vu_.rasterizeDilatedAreas(skin, z, kernel);
+            spans.insert(spans.end(), skin_spans.begin(), skin_spans.end());
+        });
 
-    for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+    for (const std::vector<VoxelSpan>& spans : spans_per_layer)
     {
-        const coord_t z = static_cast<coord_t>(layer_nr);
-        vu_.walkDilatedPolygons(layers[layer_nr], z, kernel, voxel_emplacer);
-        Polygons skin = layers[layer_nr];
-        if (layer_nr > 0)
+        for (const VoxelSpan& span : spans)
         {
-            skin = skin.xorPolygons(layers[layer_nr - 1]);
+            cells.insertSpan(span);
         }
-        skin = skin.offset(-cell_size_.x_ / 2).offset(cell_size_.x_ / 2); // remove superfluous small areas, which would anyway be included because of walkPolygons
-        vu_.walkDilatedAreas(skin, z, kernel, voxel_emplacer);
     }
 }
 
@@ -275,7 +282,7 @@ std::vector<std::vector<Polygons>> InterlockingGenerator::generateMicrostructure
     return cell_area_per_mesh_per_layer;
 }
 
-void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_set<GridPoint3>& cells, const std::vector<Polygons>& layer_regions) const
+void InterlockingGenerator::applyMicrostructureToOutlines(const VoxelSet& cells, const std::vector<Polygons>& layer_regions) const
 {
     std::vector<std::vector<Polygons>> cell_area_per_mesh_per_layer = generateMicrostructure();
 
@@ -292,19 +299,20 @@ void InterlockingGenerator::applyMicrostructureToOutlines(const std::unordered_s
     structure_per_layer[1].resize(num_interlocking_layers);
 
     // Only compute cell structure for half the layers, because since our beams are two layers high, every odd layer of the structure will be the same as the layer below.
-    for (const GridPoint3& grid_loc : cells)
-    {
-        Point3LL bottom_corner = vu_.toLowerCorner(grid_loc);
-        for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++)
+    cells.forEach(
+        [&](const GridPoint3& grid_loc)
         {
-            for (LayerIndex layer_nr = bottom_corner.z_; layer_nr < bottom_corner.z_ + cell_size_.z_ && layer_nr < max_layer_count; layer_nr += beam_layer_count_)
+            Point3LL bottom_corner = vu_.toLowerCorner(grid_loc);
+            for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++)
             {
-                Polygons areas_here = cell_area_per_mesh_per_layer[static_cast<size_t>(layer_nr / beam_layer_count_) % cell_area_per_mesh_per_layer.size()][mesh_idx];
-                areas_here.translate(Point2LL(bottom_corner.x_, bottom_corner.y_));
-                structure_per_layer[mesh_idx][static_cast<size_t>(layer_nr / beam_layer_count_)].add(areas_here);
+                for (LayerIndex layer_nr = bottom_corner.z_; layer_nr < bottom_corner.z_ + cell_size_.z_ && layer_nr < max_layer_count; layer_nr += beam_layer_count_)
+                {
+                    Polygons areas_here = cell_area_per_mesh_per_layer[static_cast<size_t>(layer_nr / beam_layer_count_) % cell_area_per_mesh_per_layer.size()][mesh_idx];
+                    areas_here.translate(Point2LL(bottom_corner.x_, bottom_corner.y_));
+                    structure_per_layer[mesh_idx][static_cast<size_t>(layer_nr / beam_layer_count_)].add(areas_here);
+                }
             }
-        }
-    }
+        });
 
     for (size_t mesh_idx = 0; mesh_idx < 2; mesh_idx++)
     {
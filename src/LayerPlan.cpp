@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <future>
 #include <numeric>
 #include <optional>
 
@@ -17,6 +18,7 @@
 #include "PathOrderMonotonic.h" //Monotonic ordering of skin lines.
 #include "Slice.h"
 #include "WipeScriptConfig.h"
+#include "bridge.h"
 #include "communication/Communication.h"
 #include "pathPlanning/Comb.h"
 #include "pathPlanning/CombPaths.h"
@@ -24,6 +26,8 @@
 #include "raft.h" // getTotalExtraLayers
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
+#include "utils/ArcFitting.h"
+#include "utils/PolygonsSpatialIndex.h"
 #include "utils/Simplify.h"
 #include "utils/linearAlg2D.h"
 #include "utils/polygonUtils.h"
@@ -59,7 +63,8 @@ GCodePath* LayerPlan::getLatestPathWithConfig(
                                   .flow = flow,
                                   .width_factor = width_factor,
                                   .spiralize = spiralize,
-                                  .speed_factor = speed_factor });
+                                  .speed_factor = speed_factor,
+                                  .points = std::pmr::vector<Point2LL>(&path_points_arena_) });
 
     GCodePath* ret = &paths.back();
     ret->skip_agressive_merge_hint = mode_skip_agressive_merge_;
@@ -87,8 +92,10 @@ LayerPlan::LayerPlan(
     const std::vector<FanSpeedLayerTimeSettings>& fan_speed_layer_time_settings_per_extruder,
     coord_t comb_boundary_offset,
     coord_t comb_move_inside_distance,
-    coord_t travel_avoid_distance)
-    : configs_storage_(storage, layer_nr, layer_thickness)
+    coord_t travel_avoid_distance,
+    const PathConfigStorage* base_configs)
+    : configs_storage_(
+        base_configs != nullptr && layer_nr > 0 ? PathConfigStorage(*base_configs, storage, layer_nr, layer_thickness) : PathConfigStorage(storage, layer_nr, layer_thickness))
     , z_(z)
     , final_travel_z_(z)
     , mode_skip_agressive_merge_(false)
@@ -105,17 +112,21 @@ LayerPlan::LayerPlan(
     , last_planned_extruder_(&Application::getInstance().current_slice_->scene.extruders[start_extruder])
     , first_travel_destination_is_inside_(false)
     , // set properly when addTravel is called for the first time (otherwise not set properly)
-    comb_boundary_minimum_(computeCombBoundary(CombBoundary::MINIMUM))
-    , comb_boundary_preferred_(computeCombBoundary(CombBoundary::PREFERRED))
+    comb_boundaries_(getCombBoundaries(comb_boundary_offset))
+    , comb_boundary_minimum_(comb_boundaries_->minimum)
+    , comb_boundary_preferred_(comb_boundaries_->preferred)
     , comb_move_inside_distance_(comb_move_inside_distance)
+    , bridge_wall_mask_index_(std::make_unique<PolygonsSpatialIndex>(bridge_wall_mask_))
+    , overhang_mask_index_(std::make_unique<PolygonsSpatialIndex>(overhang_mask_))
+    , roofing_mask_index_(std::make_unique<PolygonsSpatialIndex>(roofing_mask_))
     , fan_speed_layer_time_settings_per_extruder_(fan_speed_layer_time_settings_per_extruder)
 {
     size_t current_extruder = start_extruder;
     was_inside_ = true; // not used, because the first travel move is bogus
     is_inside_ = false; // assumes the next move will not be to inside a layer part (overwritten just before going into a layer part)
-    if (Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>("retraction_combing") != CombingMode::OFF)
+    if (Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>(SettingKey::retraction_combing) != CombingMode::OFF)
     {
-        comb_ = new Comb(storage, layer_nr, comb_boundary_minimum_, comb_boundary_preferred_, comb_boundary_offset, travel_avoid_distance, comb_move_inside_distance);
+        comb_ = new Comb(storage, layer_nr, comb_boundaries_, comb_boundary_offset, travel_avoid_distance, comb_move_inside_distance);
     }
     else
     {
@@ -123,7 +134,7 @@ LayerPlan::LayerPlan(
     }
     for (const ExtruderTrain& extruder : Application::getInstance().current_slice_->scene.extruders)
     {
-        layer_start_pos_per_extruder_.emplace_back(extruder.settings_.get<coord_t>("layer_start_x"), extruder.settings_.get<coord_t>("layer_start_y"));
+        layer_start_pos_per_extruder_.emplace_back(extruder.settings_.get<coord_t>(SettingKey::layer_start_x), extruder.settings_.get<coord_t>(SettingKey::layer_start_y));
     }
     extruder_plans_.reserve(Application::getInstance().current_slice_->scene.extruders.size());
     const auto is_raft_layer = layer_type_ == Raft::LayerType::RaftBase || layer_type_ == Raft::LayerType::RaftInterface || layer_type_ == Raft::LayerType::RaftSurface;
@@ -156,7 +167,7 @@ ExtruderTrain* LayerPlan::getLastPlannedExtruderTrain()
 Polygons LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
 {
     Polygons comb_boundary;
-    const CombingMode mesh_combing_mode = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>("retraction_combing");
+    const CombingMode mesh_combing_mode = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>(SettingKey::retraction_combing);
     if (mesh_combing_mode != CombingMode::OFF && (layer_nr_ >= 0 || mesh_combing_mode != CombingMode::NO_SKIN))
     {
         switch (layer_type_)
@@ -183,7 +194,7 @@ Polygons LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
                 const auto& mesh = *mesh_ptr;
                 const SliceLayer& layer = mesh.layers[static_cast<size_t>(layer_nr_)];
                 // don't process infill_mesh or anti_overhang_mesh
-                if (mesh.settings.get<bool>("infill_mesh") || mesh.settings.get<bool>("anti_overhang_mesh"))
+                if (mesh.settings.get<bool>(SettingKey::infill_mesh) || mesh.settings.get<bool>(SettingKey::anti_overhang_mesh))
                 {
                     continue;
                 }
@@ -191,10 +202,10 @@ Polygons LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
                 switch (boundary_type)
                 {
                 case CombBoundary::MINIMUM:
-                    offset = -mesh.settings.get<coord_t>("machine_nozzle_size") / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
+                    offset = -mesh.settings.get<coord_t>(SettingKey::machine_nozzle_size) / 2 - mesh.settings.get<coord_t>(SettingKey::wall_line_width_0) / 2;
                     break;
                 case CombBoundary::PREFERRED:
-                    offset = -mesh.settings.get<coord_t>("machine_nozzle_size") * 3 / 2 - mesh.settings.get<coord_t>("wall_line_width_0") / 2;
+                    offset = -mesh.settings.get<coord_t>(SettingKey::machine_nozzle_size) * 3 / 2 - mesh.settings.get<coord_t>(SettingKey::wall_line_width_0) / 2;
                     break;
                 default:
                     offset = 0;
@@ -202,7 +213,7 @@ Polygons LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
                     break;
                 }
 
-                const CombingMode combing_mode = mesh.settings.get<CombingMode>("retraction_combing");
+                const CombingMode combing_mode = mesh.settings.get<CombingMode>(SettingKey::retraction_combing);
                 for (const SliceLayerPart& part : layer.parts)
                 {
                     if (combing_mode == CombingMode::ALL) // Add the increased outline offset (skin, infill and part of the inner walls)
@@ -238,6 +249,85 @@ Polygons LayerPlan::computeCombBoundary(const CombBoundary boundary_type)
     return comb_boundary;
 }
 
+std::shared_ptr<const CombBoundaries> LayerPlan::getCombBoundaries(const coord_t comb_boundary_offset)
+{
+    const auto compute = [this, comb_boundary_offset]()
+    {
+        return std::make_shared<const CombBoundaries>(computeCombBoundary(CombBoundary::MINIMUM), computeCombBoundary(CombBoundary::PREFERRED), comb_boundary_offset);
+    };
+    std::optional<CombBoundaryCache::Key> key = computeCombBoundaryKey(comb_boundary_offset);
+    if (! key)
+    {
+        return compute();
+    }
+    return storage_.comb_boundaries.get(std::move(*key), compute);
+}
+
+std::optional<CombBoundaryCache::Key> LayerPlan::computeCombBoundaryKey(const coord_t comb_boundary_offset) const
+{
+    const CombingMode mesh_combing_mode = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<CombingMode>(SettingKey::retraction_combing);
+    if (mesh_combing_mode == CombingMode::OFF || layer_type_ != Raft::LayerType::Model)
+    {
+        return std::nullopt; // Either there are no comb boundaries, or they are just the outline of a raft layer.
+    }
+
+    CombBoundaryCache::Key key;
+    key.parameters = { static_cast<coord_t>(mesh_combing_mode), layer_nr_ >= 0, comb_boundary_offset };
+    const auto add = [&key](const Polygons& polygons)
+    {
+        key.parameters.push_back(static_cast<coord_t>(polygons.size()));
+        key.polygons.add(polygons);
+    };
+    for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage_.meshes)
+    {
+        const auto& mesh = *mesh_ptr;
+        // don't process infill_mesh or anti_overhang_mesh, like computeCombBoundary
+        if (mesh.settings.get<bool>(SettingKey::infill_mesh) || mesh.settings.get<bool>(SettingKey::anti_overhang_mesh))
+        {
+            continue;
+        }
+        const CombingMode combing_mode = mesh.settings.get<CombingMode>(SettingKey::retraction_combing);
+        key.parameters.push_back(static_cast<coord_t>(combing_mode));
+        key.parameters.push_back(mesh.settings.get<coord_t>(SettingKey::machine_nozzle_size));
+        key.parameters.push_back(mesh.settings.get<coord_t>(SettingKey::wall_line_width_0));
+
+        const SliceLayer& layer = mesh.layers[static_cast<size_t>(layer_nr_)];
+        key.parameters.push_back(static_cast<coord_t>(layer.parts.size()));
+        for (const SliceLayerPart& part : layer.parts)
+        {
+            switch (combing_mode)
+            {
+            case CombingMode::ALL:
+            case CombingMode::NO_OUTER_SURFACES:
+                add(part.outline);
+                break;
+            case CombingMode::NO_SKIN:
+                add(part.outline);
+                add(part.inner_area);
+                add(part.infill_area);
+                break;
+            case CombingMode::INFILL:
+                add(part.infill_area);
+                break;
+            default:
+                break;
+            }
+        }
+        if (combing_mode == CombingMode::NO_OUTER_SURFACES)
+        {
+            for (const SliceLayerPart& part : layer.parts)
+            {
+                for (const SkinPart& skin_part : part.skin_parts)
+                {
+                    add(skin_part.top_most_surface_fill);
+                    add(skin_part.bottom_most_surface_fill);
+                }
+            }
+        }
+    }
+    return key;
+}
+
 void LayerPlan::setIsInside(bool _is_inside)
 {
     is_inside_ = _is_inside;
@@ -252,15 +342,15 @@ bool LayerPlan::setExtruder(const size_t extruder_nr)
     setIsInside(false);
     { // handle end position of the prev extruder
         ExtruderTrain* extruder = getLastPlannedExtruderTrain();
-        const bool end_pos_absolute = extruder->settings_.get<bool>("machine_extruder_end_pos_abs");
-        Point2LL end_pos(extruder->settings_.get<coord_t>("machine_extruder_end_pos_x"), extruder->settings_.get<coord_t>("machine_extruder_end_pos_y"));
+        const bool end_pos_absolute = extruder->settings_.get<bool>(SettingKey::machine_extruder_end_pos_abs);
+        Point2LL end_pos(extruder->settings_.get<coord_t>(SettingKey::machine_extruder_end_pos_x), extruder->settings_.get<coord_t>(SettingKey::machine_extruder_end_pos_y));
         if (! end_pos_absolute)
         {
             end_pos += getLastPlannedPositionOrStartingPosition();
         }
         else
         {
-            const Point2LL extruder_offset(extruder->settings_.get<coord_t>("machine_nozzle_offset_x"), extruder->settings_.get<coord_t>("machine_nozzle_offset_y"));
+            const Point2LL extruder_offset(extruder->settings_.get<coord_t>(SettingKey::machine_nozzle_offset_x), extruder->settings_.get<coord_t>(SettingKey::machine_nozzle_offset_y));
             end_pos += extruder_offset; // absolute end pos is given as a head position
         }
         if (end_pos_absolute || last_planned_position_)
@@ -287,15 +377,15 @@ bool LayerPlan::setExtruder(const size_t extruder_nr)
 
     { // handle starting pos of the new extruder
         ExtruderTrain* extruder = getLastPlannedExtruderTrain();
-        const bool start_pos_absolute = extruder->settings_.get<bool>("machine_extruder_start_pos_abs");
-        Point2LL start_pos(extruder->settings_.get<coord_t>("machine_extruder_start_pos_x"), extruder->settings_.get<coord_t>("machine_extruder_start_pos_y"));
+        const bool start_pos_absolute = extruder->settings_.get<bool>(SettingKey::machine_extruder_start_pos_abs);
+        Point2LL start_pos(extruder->settings_.get<coord_t>(SettingKey::machine_extruder_start_pos_x), extruder->settings_.get<coord_t>(SettingKey::machine_extruder_start_pos_y));
         if (! start_pos_absolute)
         {
             start_pos += getLastPlannedPositionOrStartingPosition();
         }
         else
         {
-            Point2LL extruder_offset(extruder->settings_.get<coord_t>("machine_nozzle_offset_x"), extruder->settings_.get<coord_t>("machine_nozzle_offset_y"));
+            Point2LL extruder_offset(extruder->settings_.get<coord_t>(SettingKey::machine_nozzle_offset_x), extruder->settings_.get<coord_t>(SettingKey::machine_nozzle_offset_y));
             start_pos += extruder_offset; // absolute start pos is given as a head position
         }
         if (start_pos_absolute || last_planned_position_)
@@ -385,16 +475,16 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
 
     const bool is_first_travel_of_extruder_after_switch
         = extruder_plans_.back().paths_.size() == 1 && (extruder_plans_.size() > 1 || last_extruder_previous_layer_ != getExtruder());
-    bool bypass_combing = is_first_travel_of_extruder_after_switch && mesh_or_extruder_settings.get<bool>("retraction_hop_after_extruder_switch");
+    bool bypass_combing = is_first_travel_of_extruder_after_switch && mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_after_extruder_switch);
 
     const bool is_first_travel_of_layer = ! static_cast<bool>(last_planned_position_);
-    const bool retraction_enable = mesh_or_extruder_settings.get<bool>("retraction_enable");
+    const bool retraction_enable = mesh_or_extruder_settings.get<bool>(SettingKey::retraction_enable);
     if (is_first_travel_of_layer)
     {
         bypass_combing = true; // first travel move is bogus; it is added after this and the previous layer have been planned in LayerPlanBuffer::addConnectingTravelMove
         first_travel_destination_ = p;
         first_travel_destination_is_inside_ = is_inside_;
-        if (layer_nr_ == 0 && retraction_enable && mesh_or_extruder_settings.get<bool>("retraction_hop_enabled"))
+        if (layer_nr_ == 0 && retraction_enable && mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_enabled))
         {
             path->retract = true;
             path->perform_z_hop = true;
@@ -407,7 +497,7 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
         path->retract = true;
         if (comb_ == nullptr)
         {
-            path->perform_z_hop = mesh_or_extruder_settings.get<bool>("retraction_hop_enabled");
+            path->perform_z_hop = mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_enabled);
         }
     }
 
@@ -417,11 +507,11 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
 
         // Divide by 2 to get the radius
         // Multiply by 2 because if two lines start and end points places very close then will be applied combing with retractions. (Ex: for brim)
-        const coord_t max_distance_ignored = mesh_or_extruder_settings.get<coord_t>("machine_nozzle_tip_outer_diameter") / 2 * 2;
+        const coord_t max_distance_ignored = mesh_or_extruder_settings.get<coord_t>(SettingKey::machine_nozzle_tip_outer_diameter) / 2 * 2;
 
         bool unretract_before_last_travel_move = false; // Decided when calculating the combing
-        const bool perform_z_hops = mesh_or_extruder_settings.get<bool>("retraction_hop_enabled");
-        const bool perform_z_hops_only_when_collides = mesh_or_extruder_settings.get<bool>("retraction_hop_only_when_collides");
+        const bool perform_z_hops = mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_enabled);
+        const bool perform_z_hops_only_when_collides = mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_only_when_collides);
         combed = comb_->calc(
             perform_z_hops,
             perform_z_hops_only_when_collides,
@@ -455,7 +545,7 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
                 }
             }
 
-            const coord_t maximum_travel_resolution = mesh_or_extruder_settings.get<coord_t>("meshfix_maximum_travel_resolution");
+            const coord_t maximum_travel_resolution = mesh_or_extruder_settings.get<coord_t>(SettingKey::meshfix_maximum_travel_resolution);
             coord_t distance = 0;
             Point2LL last_point((last_planned_position_) ? *last_planned_position_ : Point2LL(0, 0));
             for (CombPath& combPath : combPaths)
@@ -468,13 +558,13 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
                 {
                     if (path->points.empty() || vSize2(path->points.back() - comb_point) > maximum_travel_resolution * maximum_travel_resolution)
                     {
-                        path->points.push_back(comb_point);
+                        path->addPoint(comb_point);
                         distance += vSize(last_point - comb_point);
                         last_point = comb_point;
                     }
                 }
                 distance += vSize(last_point - p);
-                const coord_t retract_threshold = mesh_or_extruder_settings.get<coord_t>("retraction_combing_max_distance");
+                const coord_t retract_threshold = mesh_or_extruder_settings.get<coord_t>(SettingKey::retraction_combing_max_distance);
                 path->retract = retract || (retract_threshold > 0 && distance > retract_threshold && retraction_enable);
                 // don't perform a z-hop
             }
@@ -502,15 +592,15 @@ GCodePath& LayerPlan::addTravel(const Point2LL& p, const bool force_retract, con
         { // then move inside the printed part, so that we don't ooze on the outer wall while retraction, but on the inside of the print.
             assert(extruder != nullptr);
             coord_t innermost_wall_line_width
-                = mesh_or_extruder_settings.get<coord_t>((mesh_or_extruder_settings.get<size_t>("wall_line_count") > 1) ? "wall_line_width_x" : "wall_line_width_0");
+                = mesh_or_extruder_settings.get<coord_t>((mesh_or_extruder_settings.get<size_t>(SettingKey::wall_line_count) > 1) ? "wall_line_width_x" : "wall_line_width_0");
             if (layer_nr_ == 0)
             {
-                innermost_wall_line_width *= mesh_or_extruder_settings.get<Ratio>("initial_layer_line_width_factor");
+                innermost_wall_line_width *= mesh_or_extruder_settings.get<Ratio>(SettingKey::initial_layer_line_width_factor);
             }
             moveInsideCombBoundary(innermost_wall_line_width, std::nullopt, path);
         }
         path->retract = retraction_enable;
-        path->perform_z_hop = retraction_enable && mesh_or_extruder_settings.get<bool>("retraction_hop_enabled");
+        path->perform_z_hop = retraction_enable && mesh_or_extruder_settings.get<bool>(SettingKey::retraction_hop_enabled);
     }
 
     // must start new travel path as retraction can be enabled or not depending on path length, etc.
@@ -533,7 +623,7 @@ GCodePath& LayerPlan::addTravel_simple(const Point2LL& p, GCodePath* path)
     {
         path = getLatestPathWithConfig(configs_storage_.travel_config_per_extruder[getExtruder()], SpaceFillType::None);
     }
-    path->points.push_back(p);
+    path->addPoint(p);
     last_planned_position_ = p;
     return *path;
 }
@@ -559,7 +649,7 @@ void LayerPlan::addExtrusionMove(
     const double fan_speed)
 {
     GCodePath* path = getLatestPathWithConfig(config, space_fill_type, config.z_offset, flow, width_factor, spiralize, speed_factor);
-    path->points.push_back(p);
+    path->addPoint(p);
     path->setFanSpeed(fan_speed);
     if (! static_cast<bool>(first_extrusion_acc_jerk_))
     {
@@ -684,9 +774,9 @@ void LayerPlan::addWallLine(
     const double acceleration_factor = 0.75; // must be < 1, the larger the value, the slower the acceleration
     const bool spiralize = false;
 
-    const coord_t min_bridge_line_len = settings.get<coord_t>("bridge_wall_min_length");
-    const Ratio bridge_wall_coast = settings.get<Ratio>("bridge_wall_coast");
-    const Ratio overhang_speed_factor = settings.get<Ratio>("wall_overhang_speed_factor");
+    const coord_t min_bridge_line_len = settings.get<coord_t>(SettingKey::bridge_wall_min_length);
+    const Ratio bridge_wall_coast = settings.get<Ratio>(SettingKey::bridge_wall_coast);
+    const Ratio overhang_speed_factor = settings.get<Ratio>(SettingKey::wall_overhang_speed_factor);
 
     Point2LL cur_point = p0;
 
@@ -757,7 +847,7 @@ void LayerPlan::addWallLine(
                         segment_flow,
                         width_factor,
                         spiralize,
-                        (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? speed_factor : overhang_speed_factor);
+                        (overhang_mask_.empty() || (! overhang_mask_index_->inside(p0, true) && ! overhang_mask_index_->inside(p1, true))) ? speed_factor : overhang_speed_factor);
                 }
 
                 distance_to_bridge_start -= len;
@@ -772,7 +862,7 @@ void LayerPlan::addWallLine(
                     segment_flow,
                     width_factor,
                     spiralize,
-                    (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? speed_factor : overhang_speed_factor);
+                    (overhang_mask_.empty() || (! overhang_mask_index_->inside(p0, true) && ! overhang_mask_index_->inside(p1, true))) ? speed_factor : overhang_speed_factor);
             }
             non_bridge_line_volume += vSize(cur_point - segment_end) * segment_flow * width_factor * speed_factor * default_config.getSpeed();
             cur_point = segment_end;
@@ -793,7 +883,7 @@ void LayerPlan::addWallLine(
             // what part of the line segment will be printed with what config.
             return false;
         }
-        return PolygonUtils::polygonCollidesWithLineSegment(roofing_mask_, p0, p1) || roofing_mask_.inside(p1, true);
+        return roofing_mask_index_->collidesWithLineSegment(p0, p1) || roofing_mask_index_->inside(p1, true);
     }();
 
     if (use_roofing_config)
@@ -866,12 +956,12 @@ void LayerPlan::addWallLine(
             flow,
             width_factor,
             spiralize,
-            (overhang_mask_.empty() || (! overhang_mask_.inside(p0, true) && ! overhang_mask_.inside(p1, true))) ? 1.0_r : overhang_speed_factor);
+            (overhang_mask_.empty() || (! overhang_mask_index_->inside(p0, true) && ! overhang_mask_index_->inside(p1, true))) ? 1.0_r : overhang_speed_factor);
     }
     else
     {
         // bridges may be required
-        if (PolygonUtils::polygonCollidesWithLineSegment(bridge_wall_mask_, p0, p1))
+        if (bridge_wall_mask_index_->collidesWithLineSegment(p0, p1))
         {
             // the line crosses the boundary between supported and non-supported regions so one or more bridges are required
 
@@ -944,7 +1034,7 @@ void LayerPlan::addWallLine(
             // if we haven't yet reached p1, fill the gap with default_config line
             addNonBridgeLine(p1);
         }
-        else if (bridge_wall_mask_.inside(p0, true) && vSize(p0 - p1) >= min_bridge_line_len)
+        else if (bridge_wall_mask_index_->inside(p0, true) && vSize(p0 - p1) >= min_bridge_line_len)
         {
             // both p0 and p1 must be above air (the result will be ugly!)
             addExtrusionMove(p1, bridge_config, SpaceFillType::Polygons, flow, width_factor);
@@ -1023,12 +1113,23 @@ void LayerPlan::addWall(
     double speed_factor = 1.0; // start first line at normal speed
     coord_t distance_to_bridge_start = 0; // will be updated before each line is processed
 
-    const coord_t min_bridge_line_len = settings.get<coord_t>("bridge_wall_min_length");
+    const coord_t min_bridge_line_len = settings.get<coord_t>(SettingKey::bridge_wall_min_length);
 
     const Ratio nominal_line_width_multiplier{
         1.0 / Ratio{ static_cast<Ratio::value_type>(default_config.getLineWidth()) }
     }; // we multiply the flow with the actual wanted line width (for that junction), and then multiply with this
 
+    // How each line of the wall lies with respect to the bridge wall mask. This is computed for every line that is added, over the lines that follow it, so each
+    // line is classified only once.
+    enum class OverAir : uint8_t
+    {
+        UNKNOWN,
+        CROSSES, //!< The line crosses the border of the mask.
+        INSIDE, //!< The line is entirely over air.
+        OUTSIDE //!< The line is entirely supported.
+    };
+    std::vector<OverAir> line_over_air(bridge_wall_mask_.empty() ? 0 : wall.size(), OverAir::UNKNOWN);
+
     // helper function to calculate the distance from the start of the current wall line to the first bridge segment
 
     auto computeDistanceToBridgeStart = [&](unsigned current_index)
@@ -1043,7 +1144,16 @@ void LayerPlan::addWall(
                 const ExtrusionJunction& p0 = wall[point_idx];
                 const ExtrusionJunction& p1 = wall[(point_idx + 1) % wall.size()];
 
-                if (PolygonUtils::polygonCollidesWithLineSegment(bridge_wall_mask_, p0.p_, p1.p_))
+                OverAir& over_air = line_over_air[point_idx];
+                if (over_air == OverAir::UNKNOWN && bridge_wall_mask_index_->collidesWithLineSegment(p0.p_, p1.p_))
+                {
+                    over_air = OverAir::CROSSES;
+                }
+                else if (over_air == OverAir::UNKNOWN)
+                {
+                    over_air = bridge_wall_mask_index_->inside(p0.p_, true) ? OverAir::INSIDE : OverAir::OUTSIDE;
+                }
+                if (over_air == OverAir::CROSSES)
                 {
                     // the line crosses the boundary between supported and non-supported regions so it will contain one or more bridge segments
 
@@ -1097,7 +1207,7 @@ void LayerPlan::addWall(
                         line_polys.remove(nearest);
                     }
                 }
-                else if (! bridge_wall_mask_.inside(p0.p_, true))
+                else if (over_air == OverAir::OUTSIDE)
                 {
                     // none of the line is over air
                     distance_to_bridge_start += vSize(p1.p_ - p0.p_);
@@ -1111,13 +1221,13 @@ void LayerPlan::addWall(
     };
 
     bool first_line = true;
-    const coord_t small_feature_max_length = settings.get<coord_t>("small_feature_max_length");
+    const coord_t small_feature_max_length = settings.get<coord_t>(SettingKey::small_feature_max_length);
     const bool is_small_feature = (small_feature_max_length > 0) && (layer_nr_ == 0 || wall.inset_idx_ == 0) && cura::shorterThan(wall, small_feature_max_length);
     Ratio small_feature_speed_factor = settings.get<Ratio>((layer_nr_ == 0) ? "small_feature_speed_factor_0" : "small_feature_speed_factor");
     const Velocity min_speed = fan_speed_layer_time_settings_per_extruder_[getLastPlannedExtruderTrain()->extruder_nr_].cool_min_speed;
     small_feature_speed_factor = std::max((double)small_feature_speed_factor, (double)(min_speed / default_config.getSpeed()));
-    const coord_t max_area_deviation = std::max(settings.get<int>("meshfix_maximum_extrusion_area_deviation"), 1); // Square micrometres!
-    const coord_t max_resolution = std::max(settings.get<coord_t>("meshfix_maximum_resolution"), coord_t(1));
+    const coord_t max_area_deviation = std::max(settings.get<int>(SettingKey::meshfix_maximum_extrusion_area_deviation), 1); // Square micrometres!
+    const coord_t max_resolution = std::max(settings.get<coord_t>(SettingKey::meshfix_maximum_resolution), coord_t(1));
 
     ExtrusionJunction p0 = wall[start_idx];
 
@@ -1298,7 +1408,8 @@ void LayerPlan::addLinesByOptimizer(
     const std::optional<Point2LL> near_start_location,
     const double fan_speed,
     const bool reverse_print_direction,
-    const std::unordered_multimap<ConstPolygonPointer, ConstPolygonPointer>& order_requirements)
+    const std::unordered_multimap<ConstPolygonPointer, ConstPolygonPointer>& order_requirements,
+    const Duration travel_improvement_time)
 {
     Polygons boundary;
     if (enable_travel_optimization && ! comb_boundary_minimum_.empty())
@@ -1310,7 +1421,7 @@ void LayerPlan::addLinesByOptimizer(
             // determine how much the skin/infill lines overlap the combing boundary
             for (const std::shared_ptr<SliceMeshStorage>& mesh : storage_.meshes)
             {
-                const coord_t overlap = std::max(mesh->settings.get<coord_t>("skin_overlap_mm"), mesh->settings.get<coord_t>("infill_overlap_mm"));
+                const coord_t overlap = std::max(mesh->settings.get<coord_t>(SettingKey::skin_overlap_mm), mesh->settings.get<coord_t>(SettingKey::infill_overlap_mm));
                 if (overlap > dist)
                 {
                     dist = overlap;
@@ -1330,6 +1441,7 @@ void LayerPlan::addLinesByOptimizer(
         &boundary,
         reverse_print_direction,
         order_requirements);
+    order_optimizer.improvement_time_ = travel_improvement_time;
     for (size_t line_idx = 0; line_idx < polygons.size(); line_idx++)
     {
         order_optimizer.addPolyline(polygons[line_idx]);
@@ -1509,7 +1621,7 @@ void LayerPlan::spiralizeWallSlice(
     const bool is_top_layer,
     const bool is_bottom_layer)
 {
-    const bool smooth_contours = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>("smooth_spiralized_contours");
+    const bool smooth_contours = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>(SettingKey::smooth_spiralized_contours);
     constexpr bool spiralize = true; // In addExtrusionMove calls, enable spiralize and use nominal line width.
     constexpr Ratio width_factor = 1.0_r;
 
@@ -1535,6 +1647,7 @@ void LayerPlan::spiralizeWallSlice(
     const int n_points = wall.size();
     Polygons last_wall_polygons;
     last_wall_polygons.add(last_wall);
+    const PolygonsSpatialIndex last_wall_index(last_wall_polygons); // Only built if smooth_contours needs it.
     const int max_dist2 = config.getLineWidth() * config.getLineWidth() * 4; // (2 * lineWidth)^2;
 
     double total_length = 0.0; // determine the length of the complete wall
@@ -1605,7 +1718,7 @@ void LayerPlan::spiralizeWallSlice(
         if (smooth_contours && ! is_bottom_layer && wall_point_idx < n_points)
         {
             // now find the point on the last wall that is closest to p
-            ClosestPolygonPoint cpp = PolygonUtils::findClosest(p, last_wall_polygons);
+            ClosestPolygonPoint cpp = last_wall_index.findClosest(p);
 
             // if we found a point and it's not further away than max_dist2, use it
             if (cpp.isValid() && vSize2(cpp.location_ - p) <= max_dist2)
@@ -1797,21 +1910,18 @@ TimeMaterialEstimates ExtruderPlan::computeNaiveTimeEstimates(Point2LL starting_
                 path.estimates.unretracted_travel_time += 0.5 * retract_unretract_time;
             }
         }
-        for (Point2LL& p1 : path.points)
+        if (! path.points.empty())
         {
-            double length = vSizeMM(p0 - p1);
+            // The moves between the points of the path are summed up as they are planned, so only the move onto the path is measured here.
+            const double length = vSizeMM(p0 - path.points.front()) + path.length;
             if (is_extrusion_path)
             {
-                if (length > 0)
-                {
-                    path.estimates.extrude_time_at_minimum_speed += length / min_path_speed;
-                    path.estimates.extrude_time_at_slowest_path_speed += length / slowest_path_speed_;
-                }
+                path.estimates.extrude_time_at_minimum_speed += length / min_path_speed;
+                path.estimates.extrude_time_at_slowest_path_speed += length / slowest_path_speed_;
                 material_estimate += length * INT2MM(layer_thickness_) * INT2MM(path.config.getLineWidth());
             }
-            double thisTime = length / (path.config.getSpeed() * path.speed_factor);
-            *path_time_estimate += thisTime;
-            p0 = p1;
+            *path_time_estimate += length / (path.config.getSpeed() * path.speed_factor);
+            p0 = path.points.back();
         }
         estimates_ += path.estimates;
     }
@@ -1939,20 +2049,26 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
     communication->setLayerForSend(layer_nr_);
     communication->sendCurrentPosition(gcode.getPositionXY());
     gcode.setLayerNr(layer_nr_);
+    ToolpathExport& toolpath_export = gcode.getToolpathExport();
+    const bool export_toolpaths = toolpath_export.isOpen();
+    if (export_toolpaths)
+    {
+        toolpath_export.beginLayer(layer_nr_, z_, layer_thickness_, gcode.getPosition());
+    }
 
     gcode.writeLayerComment(layer_nr_);
 
     // flow-rate compensation
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     gcode.setFlowRateExtrusionSettings(
-        mesh_group_settings.get<double>("flow_rate_max_extrusion_offset"),
-        mesh_group_settings.get<Ratio>("flow_rate_extrusion_offset_factor")); // Offset is in mm.
+        mesh_group_settings.get<double>(SettingKey::flow_rate_max_extrusion_offset),
+        mesh_group_settings.get<Ratio>(SettingKey::flow_rate_extrusion_offset_factor)); // Offset is in mm.
 
     static LayerIndex layer_1{ 1 - static_cast<LayerIndex>(Raft::getTotalExtraLayers()) };
-    if (layer_nr_ == layer_1 && mesh_group_settings.get<bool>("machine_heated_bed"))
+    if (layer_nr_ == layer_1 && mesh_group_settings.get<bool>(SettingKey::machine_heated_bed))
     {
         constexpr bool wait = false;
-        gcode.writeBedTemperatureCommand(mesh_group_settings.get<Temperature>("material_bed_temperature"), wait);
+        gcode.writeBedTemperatureCommand(mesh_group_settings.get<Temperature>(SettingKey::material_bed_temperature), wait);
     }
 
     gcode.setZ(z_);
@@ -1960,10 +2076,12 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
     std::optional<GCodePathConfig> last_extrusion_config = std::nullopt; // used to check whether we need to insert a TYPE comment in the gcode.
 
     size_t extruder_nr = gcode.getExtruderNr();
-    const bool acceleration_enabled = mesh_group_settings.get<bool>("acceleration_enabled");
-    const bool acceleration_travel_enabled = mesh_group_settings.get<bool>("acceleration_travel_enabled");
-    const bool jerk_enabled = mesh_group_settings.get<bool>("jerk_enabled");
-    const bool jerk_travel_enabled = mesh_group_settings.get<bool>("jerk_travel_enabled");
+    const bool acceleration_enabled = mesh_group_settings.get<bool>(SettingKey::acceleration_enabled);
+    const bool acceleration_travel_enabled = mesh_group_settings.get<bool>(SettingKey::acceleration_travel_enabled);
+    const bool jerk_enabled = mesh_group_settings.get<bool>(SettingKey::jerk_enabled);
+    const bool jerk_travel_enabled = mesh_group_settings.get<bool>(SettingKey::jerk_travel_enabled);
+    const bool arc_fitting_enabled
+        = mesh_group_settings.has("arc_fitting_enabled") && mesh_group_settings.get<bool>("arc_fitting_enabled") && gcode.getFlavor() != EGCodeFlavor::BFB;
     std::shared_ptr<const SliceMeshStorage> current_mesh;
 
     for (size_t extruder_plan_idx = 0; extruder_plan_idx < extruder_plans_.size(); extruder_plan_idx++)
@@ -2025,10 +2143,10 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 gcode.insertWipeScript(wipe_config);
                 gcode.ResetLastEValueAfterWipe(extruder_nr);
             }
-            else if (layer_nr_ != 0 && Application::getInstance().current_slice_->scene.extruders[extruder_nr].settings_.get<bool>("retract_at_layer_change"))
+            else if (layer_nr_ != 0 && Application::getInstance().current_slice_->scene.extruders[extruder_nr].settings_.get<bool>(SettingKey::retract_at_layer_change))
             {
                 // only do the retract if the paths are not spiralized
-                if (! mesh_group_settings.get<bool>("magic_spiralize"))
+                if (! mesh_group_settings.get<bool>(SettingKey::magic_spiralize))
                 {
                     gcode.writeRetraction(retraction_config->retraction_config);
                 }
@@ -2059,7 +2177,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
 
             if (path.perform_prime)
             {
-                gcode.writePrimeTrain(extruder.settings_.get<Velocity>("speed_travel"));
+                gcode.writePrimeTrain(extruder.settings_.get<Velocity>(SettingKey::speed_travel));
                 // Don't update cumulative path time, as ComputeNaiveTimeEstimates also doesn't.
                 gcode.writeRetraction(retraction_config->retraction_config);
             }
@@ -2192,6 +2310,20 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 gcode.writeTravel(Point3LL(gcode.getPosition().x_, gcode.getPosition().y_, z_ + path.z_offset), speed);
             }
 
+            if (export_toolpaths)
+            {
+                const bool travel = path.config.isTravelPath();
+                toolpath_export.addPath(
+                    path.config.type,
+                    extruder_plan.extruder_nr_,
+                    path.points,
+                    z_ + path.z_offset,
+                    travel ? 0 : path.getLineWidthForLayerView(),
+                    path.config.getLayerThickness(),
+                    travel ? speed : speed * path.speed_back_pressure_factor,
+                    travel ? 0.0 : path.getExtrusionMM3perMM());
+            }
+
             if (path.config.isTravelPath())
             { // early comp for travel paths, which are handled more simply
                 if (! path.perform_z_hop && final_travel_z_ != z_ && extruder_plan_idx == (extruder_plans_.size() - 1) && path_idx == (paths.size() - 1))
@@ -2199,7 +2331,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                     // Before the final travel, move up to the next layer height, on the current spot, with a sensible speed.
                     Point3LL current_position = gcode.getPosition();
                     current_position.z_ = final_travel_z_;
-                    gcode.writeTravel(current_position, extruder.settings_.get<Velocity>("speed_z_hop"));
+                    gcode.writeTravel(current_position, extruder.settings_.get<Velocity>(SettingKey::speed_z_hop));
 
                     // Prevent the final travel(s) from resetting to the 'previous' layer height.
                     gcode.setZ(final_travel_z_);
@@ -2227,7 +2359,7 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 const double path_fan_speed = path.getFanSpeed();
                 gcode.writeFanCommand(path_fan_speed != GCodePathConfig::FAN_SPEED_DEFAULT ? path_fan_speed : extruder_plan.getFanSpeed());
 
-                bool coasting = extruder.settings_.get<bool>("coasting_enable");
+                bool coasting = extruder.settings_.get<bool>(SettingKey::coasting_enable);
                 if (coasting)
                 {
                     coasting = writePathWithCoasting(gcode, extruder_plan_idx, path_idx, layer_thickness_, insertTempOnTime);
@@ -2235,6 +2367,11 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
                 if (! coasting) // not same as 'else', cause we might have changed [coasting] in the line above...
                 { // normal path to gcode algorithm
                     Point2LL prev_point = gcode.getPositionXY();
+                    // Runs of points on a circle are written as a single arc, ending at the last point of the run.
+                    const std::vector<FittedArc> arcs
+                        = arc_fitting_enabled ? fitArcs(prev_point, path.points, extruder.settings_.get<coord_t>(SettingKey::meshfix_maximum_deviation)) : std::vector<FittedArc>{};
+                    auto next_arc = arcs.begin();
+                    double arc_length = 0.0;
                     for (unsigned int point_idx = 0; point_idx < path.points.size(); point_idx++)
                     {
                         const auto [_, time] = extruder_plan.getPointToPointTime(prev_point, path.points[point_idx], path);
@@ -2242,7 +2379,29 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
 
                         const double extrude_speed = speed * path.speed_back_pressure_factor;
                         communication->sendLineTo(path.config.type, path.points[point_idx], path.getLineWidthForLayerView(), path.config.getLayerThickness(), extrude_speed);
-                        gcode.writeExtrusion(path.points[point_idx], extrude_speed, path.getExtrusionMM3perMM(), path.config.type, update_extrusion_offset);
+                        if (next_arc != arcs.end() && point_idx >= next_arc->first_idx)
+                        {
+                            // Extrude as much as the lines that the arc replaces would have.
+                            arc_length += vSizeMM(path.points[point_idx] - prev_point);
+                            if (point_idx == next_arc->last_idx)
+                            {
+                                gcode.writeArcExtrusion(
+                                    path.points[point_idx],
+                                    next_arc->center,
+                                    next_arc->clockwise,
+                                    arc_length,
+                                    extrude_speed,
+                                    path.getExtrusionMM3perMM(),
+                                    path.config.type,
+                                    update_extrusion_offset);
+                                ++next_arc;
+                                arc_length = 0.0;
+                            }
+                        }
+                        else
+                        {
+                            gcode.writeExtrusion(path.points[point_idx], extrude_speed, path.getExtrusionMM3perMM(), path.config.type, update_extrusion_offset);
+                        }
 
                         prev_point = path.points[point_idx];
                     }
@@ -2302,13 +2461,13 @@ void LayerPlan::writeGCode(GCodeExport& gcode)
             }
         } // paths for this extruder /\  .
 
-        if (extruder.settings_.get<bool>("cool_lift_head") && extruder_plan.extra_time_ > 0.0)
+        if (extruder.settings_.get<bool>(SettingKey::cool_lift_head) && extruder_plan.extra_time_ > 0.0)
         {
             gcode.writeComment("Small layer, adding delay");
             const RetractionAndWipeConfig& actual_retraction_config
                 = current_mesh ? current_mesh->retraction_wipe_config : storage_.retraction_wipe_config_per_extruder[gcode.getExtruderNr()];
             gcode.writeRetraction(actual_retraction_config.retraction_config);
-            if (extruder_plan_idx == extruder_plans_.size() - 1 || ! extruder.settings_.get<bool>("machine_extruder_end_pos_abs"))
+            if (extruder_plan_idx == extruder_plans_.size() - 1 || ! extruder.settings_.get<bool>(SettingKey::machine_extruder_end_pos_abs))
             { // only do the z-hop if it's the last extruder plan; otherwise it's already at the switching bay area
                 // or do it anyway when we switch extruder in-place
                 gcode.writeZhopStart(MM2INT(3.0));
@@ -2384,7 +2543,7 @@ bool LayerPlan::writePathWithCoasting(
 {
     ExtruderPlan& extruder_plan = extruder_plans_[extruder_plan_idx];
     const ExtruderTrain& extruder = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_];
-    const double coasting_volume = extruder.settings_.get<double>("coasting_volume");
+    const double coasting_volume = extruder.settings_.get<double>(SettingKey::coasting_volume);
     if (coasting_volume <= 0)
     {
         return false;
@@ -2402,7 +2561,7 @@ bool LayerPlan::writePathWithCoasting(
 
     const coord_t coasting_dist
         = MM2INT(MM2_2INT(coasting_volume) / layer_thickness) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
-    const double coasting_min_volume = extruder.settings_.get<double>("coasting_min_volume");
+    const double coasting_min_volume = extruder.settings_.get<double>(SettingKey::coasting_min_volume);
     const coord_t coasting_min_dist
         = MM2INT(MM2_2INT(coasting_min_volume + coasting_volume) / layer_thickness) / path.config.getLineWidth(); // closing brackets of MM2INT at weird places for precision issues
     //           /\ the minimal distance when coasting will coast the full coasting volume instead of linearly less with linearly smaller paths
@@ -2497,7 +2656,7 @@ bool LayerPlan::writePathWithCoasting(
         auto [_, time] = extruder_plan.getPointToPointTime(prev_pt, path.points[point_idx], path);
         insertTempOnTime(time, path_idx);
 
-        const Ratio coasting_speed_modifier = extruder.settings_.get<Ratio>("coasting_speed");
+        const Ratio coasting_speed_modifier = extruder.settings_.get<Ratio>(SettingKey::coasting_speed);
         const Velocity speed = Velocity(coasting_speed_modifier * path.config.getSpeed());
         gcode.writeTravel(path.points[point_idx], speed);
 
@@ -2527,9 +2686,26 @@ void LayerPlan::applyModifyPlugin()
             scripta::CellVDI{ "fan_speed", &GCodePath::getFanSpeed },
             scripta::CellVDI{ "is_travel_path", &GCodePath::isTravelPath },
             scripta::CellVDI{ "extrusion_mm3_per_mm", &GCodePath::getExtrusionMM3perMM });
+    }
 
-        extruder_plan.paths_ = slots::instance().modify<plugins::v0::SlotID::GCODE_PATHS_MODIFY>(extruder_plan.paths_, extruder_plan.extruder_nr_, layer_nr_);
+    // Without a plugin the paths would only be copied. With one, the paths of all extruder plans of the layer are sent to it at
+    // once, so the layer waits for a single round trip rather than one per extruder plan.
+    if (slots::instance().isConnected<plugins::v0::SlotID::GCODE_PATHS_MODIFY>())
+    {
+        std::vector<std::future<std::vector<GCodePath>>> modified_paths;
+        modified_paths.reserve(extruder_plans_.size());
+        for (const auto& extruder_plan : extruder_plans_)
+        {
+            modified_paths.push_back(slots::instance().modifyAsync<plugins::v0::SlotID::GCODE_PATHS_MODIFY>(extruder_plan.paths_, extruder_plan.extruder_nr_, layer_nr_));
+        }
+        for (size_t extruder_plan_idx = 0; extruder_plan_idx < extruder_plans_.size(); extruder_plan_idx++)
+        {
+            extruder_plans_[extruder_plan_idx].paths_ = modified_paths[extruder_plan_idx].get();
+        }
+    }
 
+    for (auto& extruder_plan : extruder_plans_)
+    {
         scripta::log(
             "extruder_plan_1",
             extruder_plan.paths_,
@@ -2555,7 +2731,7 @@ void LayerPlan::applyBackPressureCompensation()
     for (auto& extruder_plan : extruder_plans_)
     {
         const Ratio back_pressure_compensation
-            = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_].settings_.get<Ratio>("speed_equalize_flow_width_factor");
+            = Application::getInstance().current_slice_->scene.extruders[extruder_plan.extruder_nr_].settings_.get<Ratio>(SettingKey::speed_equalize_flow_width_factor);
         if (back_pressure_compensation != 0.0)
         {
             extruder_plan.applyBackPressureCompensation(back_pressure_compensation);
@@ -2568,6 +2744,32 @@ LayerIndex LayerPlan::getLayerNr() const
     return layer_nr_;
 }
 
+CounterRandom LayerPlan::getRandom() const
+{
+    return CounterRandom(static_cast<uint64_t>(layer_nr_.value));
+}
+
+size_t LayerPlan::getMemoryFootprint() const
+{
+    size_t footprint = sizeof(LayerPlan) + extruder_plans_.capacity() * sizeof(ExtruderPlan) + path_points_arena_.capacity();
+    for (const ExtruderPlan& extruder_plan : extruder_plans_)
+    {
+        footprint += extruder_plan.paths_.capacity() * sizeof(GCodePath);
+        for (const GCodePath& path : extruder_plan.paths_)
+        {
+            if (path.points.get_allocator().resource() != &path_points_arena_) // Copied paths, or ones that a plugin replaced.
+            {
+                footprint += path.points.capacity() * sizeof(Point2LL);
+            }
+        }
+    }
+    for (const Polygons* boundary : { &comb_boundary_minimum_, &comb_boundary_preferred_, &bridge_wall_mask_, &overhang_mask_, &roofing_mask_ })
+    {
+        footprint += boundary->pointCount() * sizeof(Point2LL);
+    }
+    return footprint;
+}
+
 Point2LL LayerPlan::getLastPlannedPositionOrStartingPosition() const
 {
     return last_planned_position_.value_or(layer_start_pos_per_extruder_[getExtruder()]);
@@ -2596,16 +2798,36 @@ size_t LayerPlan::getExtruder() const
 void LayerPlan::setBridgeWallMask(const Polygons& polys)
 {
     bridge_wall_mask_ = polys;
+    bridge_wall_mask_index_ = std::make_unique<PolygonsSpatialIndex>(bridge_wall_mask_);
 }
 
 void LayerPlan::setOverhangMask(const Polygons& polys)
 {
     overhang_mask_ = polys;
+    overhang_mask_index_ = std::make_unique<PolygonsSpatialIndex>(overhang_mask_);
 }
 
 void LayerPlan::setRoofingMask(const Polygons& polys)
 {
     roofing_mask_ = polys;
+    roofing_mask_index_ = std::make_unique<PolygonsSpatialIndex>(roofing_mask_);
+}
+
+SolidBelow& LayerPlan::getSolidBelow(const unsigned bridge_layer, const Ratio sparse_infill_max_density)
+{
+    for (std::unique_ptr<SolidBelow>& solid_below : solid_below_)
+    {
+        if (solid_below->bridge_layer_ == bridge_layer && solid_below->sparse_infill_max_density_ == sparse_infill_max_density)
+        {
+            return *solid_below;
+        }
+    }
+    return *solid_below_.emplace_back(std::make_unique<SolidBelow>(storage_, layer_nr_, bridge_layer, sparse_infill_max_density));
+}
+
+void LayerPlan::clearSolidBelow()
+{
+    solid_below_.clear();
 }
 
 } // namespace cura
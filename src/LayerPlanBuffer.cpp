@@ -3,6 +3,8 @@
 
 #include "LayerPlanBuffer.h"
 
+#include <algorithm>
+
 #include <spdlog/spdlog.h>
 
 #include "Application.h" //To flush g-code through the communication channel.
@@ -24,16 +26,30 @@ void LayerPlanBuffer::push(LayerPlan& layer_plan)
     buffer_.push_back(&layer_plan);
 }
 
-void LayerPlanBuffer::handle(LayerPlan& layer_plan, GCodeExport& gcode)
+std::optional<LayerIndex> LayerPlanBuffer::handle(LayerPlan& layer_plan, GCodeExport& gcode)
 {
     push(layer_plan);
 
     LayerPlan* to_be_written = processBuffer();
-    if (to_be_written)
+    if (! to_be_written)
     {
-        to_be_written->writeGCode(gcode);
-        delete to_be_written;
+        return std::nullopt;
     }
+    const LayerIndex written_layer_nr = to_be_written->getLayerNr();
+    to_be_written->writeGCode(gcode);
+    gcode.submitOutput(); // Written to the output stream while the next layer is processed.
+    delete to_be_written;
+    return written_layer_nr;
+}
+
+size_t LayerPlanBuffer::getMemoryFootprint() const
+{
+    size_t footprint = 0;
+    for (const LayerPlan* layer_plan : buffer_)
+    {
+        footprint += layer_plan->getMemoryFootprint();
+    }
+    return footprint;
 }
 
 LayerPlan* LayerPlanBuffer::processBuffer()
@@ -72,12 +88,22 @@ void LayerPlanBuffer::flush()
     while (! buffer_.empty())
     {
         buffer_.front()->writeGCode(gcode_);
+        gcode_.submitOutput();
         Application::getInstance().communication_->flushGCode();
         delete buffer_.front();
         buffer_.pop_front();
     }
 }
 
+void LayerPlanBuffer::discard()
+{
+    for (LayerPlan* layer_plan : buffer_)
+    {
+        delete layer_plan;
+    }
+    buffer_.clear();
+}
+
 void LayerPlanBuffer::addConnectingTravelMove(LayerPlan* prev_layer, const LayerPlan* newest_layer)
 {
     std::optional<std::pair<Point2LL, bool>> new_layer_destination_state = newest_layer->getFirstTravelDestinationState();
@@ -171,29 +197,28 @@ Preheat::WarmUpResult LayerPlanBuffer::computeStandbyTempPlan(std::vector<Extrud
     Settings& extruder_settings = Application::getInstance().current_slice_->scene.extruders[extruder].settings_;
     double initial_print_temp = extruder_plan.required_start_temperature_;
 
-    Duration in_between_time = 0.0_s; // the duration during which the extruder isn't used
-    for (size_t extruder_plan_before_idx = extruder_plan_idx - 1; int(extruder_plan_before_idx) >= 0; extruder_plan_before_idx--)
-    { // find a previous extruder plan where the same extruder is used to see what time this extruder wasn't used
-        ExtruderPlan& extruder_plan_before = *extruder_plans[extruder_plan_before_idx];
-        if (extruder_plan_before.extruder_nr_ == extruder)
+    // find a previous extruder plan where the same extruder is used to see what time this extruder wasn't used
+    const std::optional<size_t> previous_plan_idx = previous_plan_of_extruder_[extruder_plan_idx];
+    const Duration previous_plan_end = previous_plan_idx ? extruder_plan_start_times_[*previous_plan_idx + 1] : 0.0_s;
+    const Duration in_between_time = extruder_plan_start_times_[extruder_plan_idx] - previous_plan_end; // the duration during which the extruder isn't used
+    if (previous_plan_idx)
+    {
+        ExtruderPlan& extruder_plan_before = *extruder_plans[*previous_plan_idx];
+        Temperature temp_before = extruder_settings.get<Temperature>("material_final_print_temperature");
+        if (temp_before == 0)
         {
-            Temperature temp_before = extruder_settings.get<Temperature>("material_final_print_temperature");
-            if (temp_before == 0)
-            {
-                temp_before = extruder_plan_before.extrusion_temperature_.value_or(initial_print_temp);
-            }
-            constexpr bool during_printing = false;
-            Preheat::WarmUpResult warm_up = preheat_config_.getWarmUpPointAfterCoolDown(
-                in_between_time,
-                extruder,
-                temp_before,
-                extruder_settings.get<Temperature>("material_standby_temperature"),
-                initial_print_temp,
-                during_printing);
-            warm_up.heating_time = std::min(in_between_time, warm_up.heating_time + extra_preheat_time_);
-            return warm_up;
+            temp_before = extruder_plan_before.extrusion_temperature_.value_or(initial_print_temp);
         }
-        in_between_time += extruder_plan_before.estimates_.getTotalTime();
+        constexpr bool during_printing = false;
+        Preheat::WarmUpResult warm_up = preheat_config_.getWarmUpPointAfterCoolDown(
+            in_between_time,
+            extruder,
+            temp_before,
+            extruder_settings.get<Temperature>("material_standby_temperature"),
+            initial_print_temp,
+            during_printing);
+        warm_up.heating_time = std::min(in_between_time, warm_up.heating_time + extra_preheat_time_);
+        return warm_up;
     }
     // The last extruder plan with the same extruder falls outside of the buffer
     // assume the nozzle has cooled down to strandby temperature already.
@@ -231,13 +256,11 @@ void LayerPlanBuffer::handleStandbyTemp(std::vector<ExtruderPlan*>& extruder_pla
 {
     ExtruderPlan& extruder_plan = *extruder_plans[extruder_plan_idx];
     size_t extruder = extruder_plan.extruder_nr_;
-    for (size_t extruder_plan_before_idx = extruder_plan_idx - 2; int(extruder_plan_before_idx) >= 0; extruder_plan_before_idx--)
+    const std::optional<size_t> previous_plan_idx = previous_plan_of_extruder_[extruder_plan_idx];
+    if (previous_plan_idx && *previous_plan_idx + 2 <= extruder_plan_idx)
     {
-        if (extruder_plans[extruder_plan_before_idx]->extruder_nr_ == extruder)
-        {
-            extruder_plans[extruder_plan_before_idx + 1]->prev_extruder_standby_temp_ = standby_temp;
-            return;
-        }
+        extruder_plans[*previous_plan_idx + 1]->prev_extruder_standby_temp_ = standby_temp;
+        return;
     }
     spdlog::warn("Couldn't find previous extruder plan so as to set the standby temperature. Inserting temp command in earliest available layer.");
     ExtruderPlan& earliest_extruder_plan = *extruder_plans[0];
@@ -269,19 +292,18 @@ void LayerPlanBuffer::insertPreheatCommand_multiExtrusion(std::vector<ExtruderPl
     }
 
     // handle preheat command
-    double time_before_extruder_plan_to_insert = heating_time_and_from_temp.heating_time;
-    for (unsigned int extruder_plan_before_idx = extruder_plan_idx - 1; int(extruder_plan_before_idx) >= 0; extruder_plan_before_idx--)
+    // The heating starts during the last extruder plan before this one that starts no later than that.
+    const Duration heating_start_time = extruder_plan_start_times_[extruder_plan_idx] - heating_time_and_from_temp.heating_time;
+    const auto plan_starts_end = extruder_plan_start_times_.begin() + extruder_plan_idx;
+    const auto later_plan_start = std::upper_bound(extruder_plan_start_times_.begin(), plan_starts_end, heating_start_time);
+    if (later_plan_start != extruder_plan_start_times_.begin())
     {
+        const size_t extruder_plan_before_idx = std::distance(extruder_plan_start_times_.begin(), later_plan_start) - 1;
         ExtruderPlan& extruder_plan_before = *extruder_plans[extruder_plan_before_idx];
         assert(extruder_plan_before.extruder_nr_ != extruder);
-
-        double time_here = extruder_plan_before.estimates_.getTotalTime();
-        if (time_here >= time_before_extruder_plan_to_insert)
-        {
-            insertPreheatCommand(extruder_plan_before, time_before_extruder_plan_to_insert, extruder, initial_print_temp);
-            return;
-        }
-        time_before_extruder_plan_to_insert -= time_here;
+        const double time_before_extruder_plan_to_insert = extruder_plan_start_times_[extruder_plan_before_idx + 1] - heating_start_time;
+        insertPreheatCommand(extruder_plan_before, time_before_extruder_plan_to_insert, extruder, initial_print_temp);
+        return;
     }
 
     // time_before_extruder_plan_to_insert falls before all plans in the buffer
@@ -499,18 +521,24 @@ void LayerPlanBuffer::insertTempCommands()
         return;
     }
 
+    Scene& scene = Application::getInstance().current_slice_->scene;
     std::vector<ExtruderPlan*> extruder_plans; // sorted in print order
     extruder_plans.reserve(buffer_.size() * 2);
+    extruder_plan_start_times_.assign(1, 0.0_s);
+    previous_plan_of_extruder_.clear();
+    std::vector<std::optional<size_t>> last_plan_of_extruder(scene.extruders.size());
     for (LayerPlan* layer_plan : buffer_)
     {
         for (ExtruderPlan& extr_plan : layer_plan->extruder_plans_)
         {
+            previous_plan_of_extruder_.push_back(last_plan_of_extruder[extr_plan.extruder_nr_]);
+            last_plan_of_extruder[extr_plan.extruder_nr_] = extruder_plans.size();
+            extruder_plan_start_times_.push_back(extruder_plan_start_times_.back() + extr_plan.estimates_.getTotalTime());
             extruder_plans.push_back(&extr_plan);
         }
     }
 
     // insert commands for all extruder plans on this layer
-    Scene& scene = Application::getInstance().current_slice_->scene;
     LayerPlan& layer_plan = *buffer_.back();
     for (size_t extruder_plan_idx = 0; extruder_plan_idx < layer_plan.extruder_plans_.size(); extruder_plan_idx++)
     {
@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <fmt/format.h>
 #include <range/v3/view/enumerate.hpp>
 #include <scripta/logger.h>
@@ -15,6 +17,7 @@
 #include "settings/types/Ratio.h" //For the shrinkage percentage and scale factor.
 #include "utils/Matrix4x3D.h" //To transform the input meshes for shrinkage compensation and to align in command line mode.
 #include "utils/Point3F.h" //To accept incoming meshes with floating point vertices.
+#include "utils/ThreadPool.h"
 #include "utils/gettime.h"
 #include "utils/section_type.h"
 #include "utils/string.h"
@@ -171,53 +174,54 @@ bool loadMeshSTL_ascii(Mesh* mesh, const char* filename, const Matrix4x3D& matri
 
 bool loadMeshSTL_binary(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
 {
-    FILE* f = fopen(filename, "rb");
-
-    fseek(f, 0L, SEEK_END);
-    long long file_size = ftell(f); // The file size is the position of the cursor after seeking to the end.
-    rewind(f); // Seek back to start.
-    size_t face_count = (file_size - 80 - sizeof(uint32_t)) / 50; // Subtract the size of the header. Every face uses exactly 50 bytes.
+    constexpr size_t header_size = 80 + sizeof(uint32_t); // 80 bytes of header followed by the face count.
+    constexpr size_t face_size = 50; // Normal(3*float), Vertices(9*float), 2 Bytes Spacer.
 
-    char buffer[80];
-    // Skip the header
-    if (fread(buffer, 80, 1, f) != 1)
+    // Map the whole file into memory, so that the faces can be decoded in parallel without any intermediate copies.
+    boost::interprocess::mapped_region region;
+    try
     {
-        fclose(f);
+        const boost::interprocess::file_mapping file(filename, boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Unable to map '{}' into memory: {}", filename, exception.what());
         return false;
     }
-
-    uint32_t reported_face_count;
-    // Read the face count. We'll use it as a sort of redundancy code to check for file corruption.
-    if (fread(&reported_face_count, sizeof(uint32_t), 1, f) != 1)
+    const size_t file_size = region.get_size();
+    if (file_size < header_size)
     {
-        fclose(f);
         return false;
     }
+    const auto* data = static_cast<const char*>(region.get_address());
+    const size_t face_count = (file_size - header_size) / face_size; // Subtract the size of the header. Every face uses exactly 50 bytes.
+
+    uint32_t reported_face_count;
+    // Read the face count. We'll use it as a sort of redundancy code to check for file corruption.
+    memcpy(&reported_face_count, data + 80, sizeof(uint32_t));
     if (reported_face_count != face_count)
     {
         spdlog::warn("Face count reported by file ({}) is not equal to actual face count ({}). File could be corrupt!", reported_face_count, face_count);
     }
 
-    // For each face read:
-    // float(x,y,z) = normal, float(X,Y,Z)*3 = vertexes, uint16_t = flags
-    //  Every Face is 50 Bytes: Normal(3*float), Vertices(9*float), 2 Bytes Spacer
-    mesh->faces_.reserve(face_count);
-    mesh->vertices_.reserve(face_count);
-    for (size_t i = 0; i < face_count; i++)
-    {
-        if (fread(buffer, 50, 1, f) != 1)
+    // Decode and transform all the vertices in parallel chunks, straight into a pre-allocated buffer.
+    std::vector<Point3LL> corners(face_count * 3);
+    cura::parallel_for<size_t>(
+        0,
+        face_count,
+        [&](size_t face_idx)
         {
-            fclose(f);
-            return false;
-        }
-        float* v = reinterpret_cast<float*>(buffer) + 3;
+            float v[9];
+            memcpy(v, data + header_size + face_idx * face_size + 3 * sizeof(float), sizeof(v)); // Skip the normal. The data is not guaranteed to be aligned.
+            for (size_t corner_idx = 0; corner_idx < 3; corner_idx++)
+            {
+                corners[face_idx * 3 + corner_idx] = matrix.apply(Point3F(v[corner_idx * 3], v[corner_idx * 3 + 1], v[corner_idx * 3 + 2]).toPoint3d());
+            }
+        },
+        1024);
 
-        Point3LL v0 = matrix.apply(Point3F(v[0], v[1], v[2]).toPoint3d());
-        Point3LL v1 = matrix.apply(Point3F(v[3], v[4], v[5]).toPoint3d());
-        Point3LL v2 = matrix.apply(Point3F(v[6], v[7], v[8]).toPoint3d());
-        mesh->addFace(v0, v1, v2);
-    }
-    fclose(f);
+    mesh->addFaces(corners);
     mesh->finish();
     return true;
 }
@@ -279,6 +283,74 @@ bool loadMeshSTL(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
     return loadMeshSTL_binary(mesh, filename, matrix);
 }
 
+bool loadMeshIndexed(Mesh* mesh, const char* filename, const Matrix4x3D& matrix)
+{
+    // Layout (little-endian): "CURAMESH", uint32 version, uint32 reserved, uint32 vertex count, uint32 face count,
+    // followed by float(X,Y,Z) per vertex, in millimetres, followed by uint32(v0,v1,v2) per face, counter-clockwise.
+    constexpr char magic[8] = { 'C', 'U', 'R', 'A', 'M', 'E', 'S', 'H' };
+    constexpr uint32_t supported_version = 1;
+    constexpr size_t header_size = sizeof(magic) + 4 * sizeof(uint32_t);
+
+    boost::interprocess::mapped_region region;
+    try
+    {
+        const boost::interprocess::file_mapping file(filename, boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::error("Unable to map '{}' into memory: {}", filename, exception.what());
+        return false;
+    }
+    const size_t file_size = region.get_size();
+    const auto* data = static_cast<const char*>(region.get_address());
+    if (file_size < header_size || memcmp(data, magic, sizeof(magic)) != 0)
+    {
+        spdlog::error("'{}' is not an indexed mesh file.", filename);
+        return false;
+    }
+
+    uint32_t header[4]; // version, reserved, vertex count, face count
+    memcpy(header, data + sizeof(magic), sizeof(header));
+    const uint32_t version = header[0];
+    const size_t vertex_count = header[2];
+    const size_t face_count = header[3];
+    if (version != supported_version)
+    {
+        spdlog::error("Indexed mesh file '{}' has version {}, but only version {} is supported.", filename, version, supported_version);
+        return false;
+    }
+    const size_t vertices_size = vertex_count * 3 * sizeof(float);
+    const size_t faces_size = face_count * 3 * sizeof(uint32_t);
+    if (file_size < header_size + vertices_size + faces_size)
+    {
+        spdlog::error("Indexed mesh file '{}' is truncated: expected {} vertices and {} faces.", filename, vertex_count, face_count);
+        return false;
+    }
+
+    std::vector<Point3LL> vertices(vertex_count);
+    cura::parallel_for<size_t>(
+        0,
+        vertex_count,
+        [&](size_t vertex_idx)
+        {
+            float v[3];
+            memcpy(v, data + header_size + vertex_idx * sizeof(v), sizeof(v));
+            vertices[vertex_idx] = matrix.apply(Point3F(v[0], v[1], v[2]).toPoint3d());
+        },
+        1024);
+    std::vector<std::array<uint32_t, 3>> face_vertex_indices(face_count);
+    memcpy(face_vertex_indices.data(), data + header_size + vertices_size, faces_size);
+
+    if (! mesh->addIndexedFaces(vertices, face_vertex_indices))
+    {
+        spdlog::error("Indexed mesh file '{}' refers to vertices that don't exist.", filename);
+        return false;
+    }
+    mesh->finish();
+    return true;
+}
+
 bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Matrix4x3D& transformation, Settings& object_parent_settings)
 {
     TimeKeeper load_timer;
@@ -294,7 +366,17 @@ bool loadMeshIntoMeshGroup(MeshGroup* meshgroup, const char* filename, const Mat
             return true;
         }
     }
-    spdlog::warn("Unable to recognize the extension of the file. Currently only .stl and .STL are supported.");
+    else if (ext && (strcmp(ext, ".cmesh") == 0 || strcmp(ext, ".CMESH") == 0))
+    {
+        Mesh mesh(object_parent_settings);
+        if (loadMeshIndexed(&mesh, filename, transformation))
+        {
+            meshgroup->meshes.push_back(mesh);
+            spdlog::info("loading '{}' took {:03.3f} seconds", filename, load_timer.restart());
+            return true;
+        }
+    }
+    spdlog::warn("Unable to recognize the extension of the file. Currently only .stl, .STL and .cmesh are supported.");
     return false;
 }
 
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "MeshWallsCache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "WallToolPathsCache.h"
+#include "communication/Communication.h"
+#include "settings/Settings.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * Whether the current communication channel may ask for another slice in this process, i.e. whether it is worth keeping
+ * entries after a slice.
+ */
+bool isPersistent()
+{
+    const Communication* communication = Application::getInstance().communication_;
+    return communication != nullptr && communication->isPersistent();
+}
+
+} // namespace
+
+MeshWallsCache& MeshWallsCache::getInstance()
+{
+    static MeshWallsCache instance;
+    return instance;
+}
+
+std::shared_ptr<WallToolPathsCache> MeshWallsCache::get(const Settings& mesh_settings, const size_t layer_count)
+{
+    if (! isPersistent())
+    {
+        // Remembering the walls of all layers only pays off in a next slice.
+        return std::make_shared<WallToolPathsCache>();
+    }
+
+    const uint64_t key = hashSettings(mesh_settings);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = entries_.find(key);
+    if (entry == entries_.end())
+    {
+        const auto previous_entry = previous_entries_.find(key);
+        if (previous_entry != previous_entries_.end())
+        { // Reused in this slice, so keep it for the next one.
+            spdlog::info("Reusing the walls of the unchanged layers from an earlier slice.");
+            entry = entries_.emplace(key, Entry{ .cache = std::move(previous_entry->second.cache), .capacity = 0 }).first;
+            previous_entries_.erase(previous_entry);
+        }
+        else
+        {
+            entry = entries_.emplace(key, Entry{ .cache = std::make_shared<WallToolPathsCache>(), .capacity = 0 }).first;
+        }
+    }
+
+    // A layer may have several parts, but most layers of most meshes have one.
+    entry->second.capacity += layer_count;
+    entry->second.cache->setCapacity(std::max(WallToolPathsCache::default_capacity, entry->second.capacity));
+    return entry->second.cache;
+}
+
+void MeshWallsCache::startSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_ = std::move(entries_);
+    entries_.clear();
+}
+
+void MeshWallsCache::finishSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_.clear();
+}
+
+void MeshWallsCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    previous_entries_.clear();
+}
+
+uint64_t MeshWallsCache::hashSettings(const Settings& mesh_settings)
+{
+    // 64-bit FNV-1a style hash, mixing in whole words at a time.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const auto add = [&hash](const uint64_t value)
+    {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+    const auto add_string = [&add](const std::string& value)
+    {
+        for (const char character : value)
+        {
+            add(static_cast<uint64_t>(character));
+        }
+        add(value.size());
+    };
+
+    // Every setting as the mesh sees it, including those it gets from its extruder and the mesh group.
+    std::vector<std::string> keys = mesh_settings.getKeys();
+    std::sort(keys.begin(), keys.end());
+    for (const std::string& key : keys)
+    {
+        add_string(key);
+        add_string(mesh_settings.get<std::string>(key));
+    }
+
+    return hash;
+}
+
+} // namespace cura
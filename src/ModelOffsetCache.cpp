@@ -0,0 +1,89 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "ModelOffsetCache.h"
+
+#include <cassert>
+#include <functional>
+
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+ModelOffsetCache::ModelOffsetCache(const SliceDataStorage& storage)
+    : storage_(storage)
+{
+}
+
+const Polygons& ModelOffsetCache::get(const LayerIndex layer_nr, const int mesh_idx, const coord_t distance, const ClipperLib::JoinType join_type) const
+{
+    // Without an offset, the join type makes no difference.
+    const Key key{ layer_nr, mesh_idx, distance, distance == 0 ? ClipperLib::jtMiter : join_type };
+
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<Entry>& found = entries_[key];
+        if (! found)
+        {
+            found = std::make_unique<Entry>();
+        }
+        entry = found.get();
+    }
+    // Compute the outlines outside of the lock, so that other threads can get other outlines meanwhile.
+    std::call_once(
+        entry->computed,
+        [&]()
+        {
+            entry->outlines = compute(key);
+            size_t bytes = sizeof(Entry);
+            for (const ClipperLib::Path& path : entry->outlines.paths)
+            {
+                bytes += sizeof(ClipperLib::Path) + path.capacity() * sizeof(ClipperLib::IntPoint);
+            }
+            memory_usage_.fetch_add(bytes, std::memory_order_relaxed);
+        });
+    return entry->outlines;
+}
+
+size_t ModelOffsetCache::getMemoryUsage() const
+{
+    return memory_usage_.load(std::memory_order_relaxed);
+}
+
+void ModelOffsetCache::release()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    memory_usage_.store(0, std::memory_order_relaxed);
+}
+
+size_t ModelOffsetCache::KeyHash::operator()(const Key& key) const
+{
+    size_t result = std::hash<LayerIndex>()(key.layer_nr);
+    result = result * 31 + std::hash<int>()(key.mesh_idx);
+    result = result * 31 + std::hash<coord_t>()(key.distance);
+    result = result * 31 + std::hash<int>()(static_cast<int>(key.join_type));
+    return result;
+}
+
+Polygons ModelOffsetCache::compute(const Key& key) const
+{
+    if (key.distance != 0)
+    {
+        // Offsets of the same outlines by different distances all start from the same remembered outlines.
+        return get(key.layer_nr, key.mesh_idx, 0).offset(key.distance, key.join_type);
+    }
+    if (key.mesh_idx == all_meshes)
+    {
+        constexpr bool no_support = false;
+        constexpr bool no_prime_tower = false;
+        return storage_.getLayerOutlines(key.layer_nr, no_support, no_prime_tower);
+    }
+    assert(key.mesh_idx >= 0 && static_cast<size_t>(key.mesh_idx) < storage_.meshes.size() && "The mesh must exist.");
+    assert(key.layer_nr >= 0 && "Meshes have no outlines below the first layer.");
+    return storage_.meshes[key.mesh_idx]->layers[key.layer_nr].getOutlines();
+}
+
+} // namespace cura
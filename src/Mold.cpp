@@ -3,6 +3,9 @@
 
 #include "Mold.h"
 
+#include <numbers>
+#include <utility>
+
 #include "Application.h" //To get settings.
 #include "ExtruderTrain.h"
 #include "Scene.h"
@@ -11,6 +14,7 @@
 #include "sliceDataStorage.h"
 #include "slicer.h"
 #include "utils/Point2LL.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -46,78 +50,94 @@ void Mold::process(std::vector<Slicer*>& slicer_list)
     }
 
     const coord_t layer_height = scene.current_mesh_group->settings.get<coord_t>("layer_height");
-    std::vector<Polygons> mold_outline_above_per_mesh; // the outer outlines of the layer above without the original model(s) being cut out
-    mold_outline_above_per_mesh.resize(slicer_list.size());
-    for (int layer_nr = layer_count - 1; layer_nr >= 0; layer_nr--)
+    std::vector<Polygons> all_original_mold_outlines(layer_count); // outlines of all models for which to generate a mold (insides of all molds)
+    for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
     {
-        Polygons all_original_mold_outlines; // outlines of all models for which to generate a mold (insides of all molds)
-
-        // first generate outlines
-        for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+        const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
+        Slicer& slicer = *slicer_list[mesh_idx];
+        if (! mesh.settings_.get<bool>("mold_enabled"))
         {
-            const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
-            Slicer& slicer = *slicer_list[mesh_idx];
-            if (! mesh.settings_.get<bool>("mold_enabled") || layer_nr >= static_cast<int>(slicer.layers.size()))
-            {
-                continue;
-            }
-            coord_t width = mesh.settings_.get<coord_t>("mold_width");
-            coord_t open_polyline_width = mesh.settings_.get<coord_t>("wall_line_width_0");
-            if (layer_nr == 0)
-            {
-                const ExtruderTrain& train_wall_0 = mesh.settings_.get<ExtruderTrain&>("wall_0_extruder_nr");
-                open_polyline_width *= train_wall_0.settings_.get<Ratio>("initial_layer_line_width_factor");
-            }
-            const AngleDegrees angle = mesh.settings_.get<AngleDegrees>("mold_angle");
-            const coord_t roof_height = mesh.settings_.get<coord_t>("mold_roof_height");
-
-            const coord_t inset = tan(angle / 180 * std::numbers::pi) * layer_height;
-            const size_t roof_layer_count = roof_height / layer_height;
-
-
-            SlicerLayer& layer = slicer.layers[layer_nr];
-            Polygons model_outlines = layer.polygons.unionPolygons(layer.openPolylines.offsetPolyLine(open_polyline_width / 2));
-            layer.openPolylines.clear();
-            all_original_mold_outlines.add(model_outlines);
-
-            if (angle >= 90)
-            {
-                layer.polygons = model_outlines.offset(width, ClipperLib::jtRound);
-            }
-            else
+            continue;
+        }
+        const coord_t width = mesh.settings_.get<coord_t>("mold_width");
+        const coord_t wall_line_width_0 = mesh.settings_.get<coord_t>("wall_line_width_0");
+        const Ratio initial_layer_line_width_factor = mesh.settings_.get<ExtruderTrain&>("wall_0_extruder_nr").settings_.get<Ratio>("initial_layer_line_width_factor");
+        const AngleDegrees angle = mesh.settings_.get<AngleDegrees>("mold_angle");
+        const coord_t roof_height = mesh.settings_.get<coord_t>("mold_roof_height");
+
+        const coord_t inset = tan(angle / 180 * std::numbers::pi) * layer_height;
+        const size_t roof_layer_count = roof_height / layer_height;
+
+        // Apart from the slope of the mold angle, the mold of each layer only depends on the original model, so that
+        // part is generated for all layers in parallel.
+        const size_t mesh_layer_count = slicer.layers.size();
+        std::vector<Polygons> model_outlines(mesh_layer_count);
+        std::vector<Polygons> mold_outlines(mesh_layer_count); // the outer outlines of each layer without the original model(s) being cut out
+        cura::parallel_for<size_t>(
+            0,
+            mesh_layer_count,
+            [&](const size_t layer_nr)
             {
-                Polygons& mold_outline_above = mold_outline_above_per_mesh[mesh_idx]; // the outside of the mold on the layer above
-                layer.polygons = mold_outline_above.offset(-inset).unionPolygons(model_outlines.offset(width, ClipperLib::jtRound));
-            }
-
-            // add roofs
-            if (roof_layer_count > 0 && layer_nr > 0)
+                coord_t open_polyline_width = wall_line_width_0;
+                if (layer_nr == 0)
+                {
+                    open_polyline_width *= initial_layer_line_width_factor;
+                }
+                const SlicerLayer& layer = slicer.layers[layer_nr];
+                model_outlines[layer_nr] = layer.polygons.unionPolygons(layer.openPolylines.offsetPolyLine(open_polyline_width / 2));
+                mold_outlines[layer_nr] = model_outlines[layer_nr].offset(width, ClipperLib::jtRound);
+
+                // add roofs
+                if (roof_layer_count > 0 && layer_nr > 0)
+                {
+                    const size_t layer_nr_below = layer_nr > roof_layer_count ? layer_nr - roof_layer_count : 0;
+                    Polygons roofs = slicer.layers[layer_nr_below].polygons.offset(width, ClipperLib::jtRound); // TODO: don't compute offset twice!
+                    mold_outlines[layer_nr] = mold_outlines[layer_nr].unionPolygons(roofs);
+                }
+            });
+
+        // The slope: each layer of the mold also covers the outside of the mold on the layer above, inset by the angle.
+        if (angle < 90)
+        {
+            for (size_t layer_nr = mesh_layer_count - 1; layer_nr-- > 0;)
             {
-                LayerIndex layer_nr_below = std::max(0, static_cast<int>(layer_nr - roof_layer_count));
-                Polygons roofs = slicer.layers[layer_nr_below].polygons.offset(width, ClipperLib::jtRound); // TODO: don't compute offset twice!
-                layer.polygons = layer.polygons.unionPolygons(roofs);
+                mold_outlines[layer_nr] = mold_outlines[layer_nr + 1].offset(-inset).unionPolygons(mold_outlines[layer_nr]);
             }
-
-            mold_outline_above_per_mesh[mesh_idx] = layer.polygons;
         }
-        all_original_mold_outlines = all_original_mold_outlines.unionPolygons();
 
-        // cut out molds from all objects after generating mold outlines for all objects so that molds won't overlap into the casting cutout of another mold
+        cura::parallel_for<size_t>(
+            0,
+            mesh_layer_count,
+            [&](const size_t layer_nr)
+            {
+                SlicerLayer& layer = slicer.layers[layer_nr];
+                layer.polygons = std::move(mold_outlines[layer_nr]);
+                layer.openPolylines.clear();
+                all_original_mold_outlines[layer_nr].add(model_outlines[layer_nr]);
+            });
+    }
 
-        // carve molds out of all other models
-        for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
+    // cut out molds from all objects after generating mold outlines for all objects so that molds won't overlap into the casting cutout of another mold
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&](const size_t layer_nr)
         {
-            const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
-            if (! mesh.settings_.get<bool>("mold_enabled"))
+            const Polygons original_mold_outlines = all_original_mold_outlines[layer_nr].unionPolygons();
+
+            // carve molds out of all other models
+            for (unsigned int mesh_idx = 0; mesh_idx < slicer_list.size(); mesh_idx++)
             {
-                continue; // only cut original models out of all molds
+                const Mesh& mesh = scene.current_mesh_group->meshes[mesh_idx];
+                Slicer& slicer = *slicer_list[mesh_idx];
+                if (! mesh.settings_.get<bool>("mold_enabled") || layer_nr >= slicer.layers.size())
+                {
+                    continue; // only cut original models out of all molds
+                }
+                SlicerLayer& layer = slicer.layers[layer_nr];
+                layer.polygons = layer.polygons.difference(original_mold_outlines);
             }
-            Slicer& slicer = *slicer_list[mesh_idx];
-            SlicerLayer& layer = slicer.layers[layer_nr];
-            layer.polygons = layer.polygons.difference(all_original_mold_outlines);
-        }
-    }
+        });
 }
 
-
 } // namespace cura
@@ -0,0 +1,66 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "OutlineIntersectionCache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+OutlineIntersectionCache::OutlineIntersectionCache(const std::vector<SliceLayer>& layers, const size_t max_layer_count)
+    : layers_(layers)
+{
+    const size_t level_count = std::bit_width(std::max(size_t(1), max_layer_count));
+    levels_.reserve(level_count);
+    for (size_t level = 0; level < level_count && (size_t(1) << level) <= layers_.size(); level++)
+    {
+        levels_.emplace_back(layers_.size() - (size_t(1) << level) + 1);
+    }
+}
+
+Polygons OutlineIntersectionCache::intersection(const LayerIndex first_layer_nr, const LayerIndex last_layer_nr)
+{
+    assert(first_layer_nr >= 0 && first_layer_nr <= last_layer_nr);
+    if (last_layer_nr >= LayerIndex(layers_.size()))
+    {
+        return {}; // There's air above the mesh.
+    }
+    const size_t layer_count = last_layer_nr - first_layer_nr + 1;
+    const size_t level = std::bit_width(layer_count) - 1;
+    assert(level < levels_.size());
+    const size_t level_layer_count = size_t(1) << level;
+    const Polygons& lower = get(level, first_layer_nr);
+    if (level_layer_count == layer_count)
+    {
+        return lower;
+    }
+    return lower.intersection(get(level, last_layer_nr - level_layer_count + 1));
+}
+
+const Polygons& OutlineIntersectionCache::get(const size_t level, const size_t layer_nr)
+{
+    Entry& entry = levels_[level][layer_nr];
+    std::call_once(
+        entry.computed,
+        [this, &entry, level, layer_nr]()
+        {
+            if (level == 0)
+            {
+                for (const SliceLayerPart& part : layers_[layer_nr].parts)
+                {
+                    entry.outline.add(part.outline);
+                }
+                return;
+            }
+            const size_t half_layer_count = size_t(1) << (level - 1);
+            entry.outline = get(level - 1, layer_nr).intersection(get(level - 1, layer_nr + half_layer_count));
+        });
+    return entry.outline;
+}
+
+} // namespace cura
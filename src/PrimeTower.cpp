@@ -11,6 +11,7 @@
 #include "Application.h" //To get settings.
 #include "ExtruderTrain.h"
 #include "LayerPlan.h"
+#include "PathOrderOptimizer.h"
 #include "PrintFeature.h"
 #include "Scene.h"
 #include "Slice.h"
@@ -18,6 +19,7 @@
 #include "infill.h"
 #include "raft.h"
 #include "sliceDataStorage.h"
+#include "utils/MultiOffset.h"
 
 #define CIRCLE_RESOLUTION 32 // The number of vertices in each circle.
 #define ARC_RESOLUTION 4 // The number of segments in each arc of a wheel
@@ -121,6 +123,7 @@ void PrimeTower::generatePaths(const SliceDataStorage& storage)
         generatePaths_denseInfill(cumulative_insets);
 
         generateStartLocations();
+        planPrimeMoves();
 
         generatePaths_sparseInfill(cumulative_insets);
     }
@@ -142,6 +145,7 @@ void PrimeTower::generatePaths_denseInfill(std::vector<coord_t>& cumulative_inse
     base_extra_moves_.resize(extruder_count_);
     inset_extra_moves_.resize(extruder_count_);
 
+    MultiOffset outer_poly_offsets(outer_poly_); // All walls and base rings are offsets of the outer polygon.
     coord_t cumulative_inset = 0; // Each tower shape is going to be printed inside the other. This is the inset we're doing for each extruder.
     for (size_t extruder_nr : extruder_order_)
     {
@@ -156,7 +160,7 @@ void PrimeTower::generatePaths_denseInfill(std::vector<coord_t>& cumulative_inse
         for (; current_volume < required_volume; wall_nr++)
         {
             // Create a new polygon with an offset from the outer polygon.
-            Polygons polygons = outer_poly_.offset(-cumulative_inset - wall_nr * line_width - line_width / 2);
+            Polygons polygons = outer_poly_offsets.offset(-cumulative_inset - wall_nr * line_width - line_width / 2);
             prime_moves.add(polygons);
             current_volume += polygons.polygonLength() * line_width * layer_height * flow;
             if (polygons.empty()) // Don't continue. We won't ever reach the required volume because it doesn't fit.
@@ -179,7 +183,7 @@ void PrimeTower::generatePaths_denseInfill(std::vector<coord_t>& cumulative_inse
                     break;
                 }
                 extra_radius = line_width * extra_rings;
-                outer_poly_base_.push_back(outer_poly_.offset(extra_radius));
+                outer_poly_base_.push_back(outer_poly_offsets.offset(extra_radius));
 
                 base_extra_moves_[extruder_nr].push_back(PolygonUtils::generateOutset(outer_poly_, extra_rings, line_width));
             }
@@ -317,6 +321,46 @@ void PrimeTower::generateStartLocations()
     PolygonUtils::spreadDots(segment_start, segment_end, number_of_prime_tower_start_locations_, prime_tower_start_locations_);
 }
 
+void PrimeTower::planPrimeMoves()
+{
+    prime_starts_.assign(extruder_count_, {});
+    planned_prime_moves_.assign(extruder_count_, {});
+    for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
+    {
+        const ExtruderTrain& train = Application::getInstance().current_slice_->scene.extruders[extruder_nr];
+        const coord_t inward_dist = train.settings_.get<coord_t>("machine_nozzle_size") * 3 / 2;
+        const coord_t start_dist = train.settings_.get<coord_t>("machine_nozzle_size") * 2;
+        for (const ClosestPolygonPoint& wipe_location : prime_tower_start_locations_)
+        {
+            const Point2LL prime_end = PolygonUtils::moveInsideDiagonally(wipe_location, inward_dist);
+            const Point2LL outward_dir = wipe_location.location_ - prime_end;
+            const Point2LL prime_start = wipe_location.location_ + normal(outward_dir, start_dist);
+            prime_starts_[extruder_nr].push_back(prime_start);
+
+            // Order the moves the way LayerPlan::addPolygonsByOptimizer would after travelling to the start.
+            PathOrderOptimizer<ConstPolygonPointer> order_optimizer(prime_start);
+            for (ConstPolygonRef polygon : prime_moves_[extruder_nr])
+            {
+                order_optimizer.addPolygon(polygon);
+            }
+            order_optimizer.optimize();
+
+            Polygons& planned_moves = planned_prime_moves_[extruder_nr].emplace_back();
+            for (const PathOrdering<ConstPolygonPointer>& path : order_optimizer.paths_)
+            {
+                ConstPolygonRef polygon = *path.vertices_;
+                const coord_t vertex_count = static_cast<coord_t>(polygon.size());
+                const coord_t direction = path.backwards_ ? -1 : 1;
+                PolygonRef planned_polygon = planned_moves.newPoly();
+                for (coord_t point_idx = 0; point_idx < vertex_count; point_idx++)
+                {
+                    planned_polygon.add(polygon[((static_cast<coord_t>(path.start_vertex_) + point_idx * direction) % vertex_count + vertex_count) % vertex_count]);
+                }
+            }
+        }
+    }
+}
+
 void PrimeTower::addToGcode(
     const SliceDataStorage& storage,
     LayerPlan& gcode_layer,
@@ -444,8 +488,21 @@ void PrimeTower::addToGcode_denseInfill(LayerPlan& gcode_layer, const size_t ext
     {
         // Actual prime pattern
         const GCodePathConfig& config = gcode_layer.configs_storage_.prime_tower_config_per_extruder[extruder_nr];
-        const Polygons& pattern = prime_moves_[extruder_nr];
-        gcode_layer.addPolygonsByOptimizer(pattern, config);
+        if (gcode_layer.getLayerNr() != 0)
+        {
+            // We travelled to the start location of this layer, so the moves have been planned already.
+            for (ConstPolygonRef polygon : planned_prime_moves_[extruder_nr][getStartLocationIdx(gcode_layer.getLayerNr(), extruder_nr)])
+            {
+                constexpr int start_idx = 0;
+                constexpr bool backwards = false;
+                gcode_layer.addPolygon(polygon, start_idx, backwards, config);
+            }
+        }
+        else
+        {
+            const Polygons& pattern = prime_moves_[extruder_nr];
+            gcode_layer.addPolygonsByOptimizer(pattern, config);
+        }
     }
 }
 
@@ -622,23 +679,17 @@ const Polygons& PrimeTower::getGroundPoly() const
     return getOuterPoly(-Raft::getTotalExtraLayers());
 }
 
+size_t PrimeTower::getStartLocationIdx(const LayerIndex& layer_nr, const size_t extruder_nr) const
+{
+    const int location_count = static_cast<int>(number_of_prime_tower_start_locations_);
+    return static_cast<size_t>((((static_cast<int>(extruder_nr) + 1) * layer_nr.value) % location_count + location_count) % location_count);
+}
+
 void PrimeTower::gotoStartLocation(LayerPlan& gcode_layer, const int extruder_nr) const
 {
     if (gcode_layer.getLayerNr() != 0)
     {
-        int current_start_location_idx = ((((extruder_nr + 1) * gcode_layer.getLayerNr()) % number_of_prime_tower_start_locations_) + number_of_prime_tower_start_locations_)
-                                       % number_of_prime_tower_start_locations_;
-
-        const ClosestPolygonPoint wipe_location = prime_tower_start_locations_[current_start_location_idx];
-
-        const ExtruderTrain& train = Application::getInstance().current_slice_->scene.extruders[extruder_nr];
-        const coord_t inward_dist = train.settings_.get<coord_t>("machine_nozzle_size") * 3 / 2;
-        const coord_t start_dist = train.settings_.get<coord_t>("machine_nozzle_size") * 2;
-        const Point2LL prime_end = PolygonUtils::moveInsideDiagonally(wipe_location, inward_dist);
-        const Point2LL outward_dir = wipe_location.location_ - prime_end;
-        const Point2LL prime_start = wipe_location.location_ + normal(outward_dir, start_dist);
-
-        gcode_layer.addTravel(prime_start);
+        gcode_layer.addTravel(prime_starts_[extruder_nr][getStartLocationIdx(gcode_layer.getLayerNr(), extruder_nr)]);
     }
 }
 
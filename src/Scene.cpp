@@ -7,9 +7,14 @@
 
 #include "Application.h"
 #include "FffProcessor.h" //To start a slice.
+#include "SliceDataStorageCache.h"
 #include "communication/Communication.h" //To flush g-code and layer view when we're done.
 #include "progress/Progress.h"
 #include "sliceDataStorage.h"
+#include "utils/AllocationStatistics.h"
+#include "utils/Cancellation.h"
+#include "utils/MemoryBudget.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -24,6 +29,11 @@ Scene::Scene(const size_t num_mesh_groups)
     }
 }
 
+Scene::~Scene()
+{
+    waitForReleasedStorage();
+}
+
 const std::string Scene::getAllSettingsString() const
 {
     std::stringstream output;
@@ -66,6 +76,21 @@ void Scene::processMeshGroup(MeshGroup& mesh_group)
 {
     FffProcessor* fff_processor = FffProcessor::getInstance();
     fff_processor->time_keeper.restart();
+    if (fff_processor->draft_estimator)
+    {
+        TimeKeeper time_keeper_draft;
+        fff_processor->draft_estimator->estimate(mesh_group);
+        Progress::messageProgress(Progress::Stage::FINISH, 1, 1); // 100% on this meshgroup
+        spdlog::info("Draft estimate took {:03.3f}s", time_keeper_draft.restart());
+        return;
+    }
+    Application::getInstance().thread_pool_->resetStatistics();
+    Progress::startCostModel(mesh_group.settings);
+    if (MemoryBudget::getPressure() != MemoryBudget::Pressure::NONE)
+    {
+        // Don't generate this mesh group while the one before still takes up its share.
+        waitForReleasedStorage();
+    }
 
     TimeKeeper time_keeper_total;
 
@@ -85,19 +110,63 @@ void Scene::processMeshGroup(MeshGroup& mesh_group)
         return;
     }
 
-    SliceDataStorage storage;
-    if (! fff_processor->polygon_generator.generateAreas(storage, &mesh_group, fff_processor->time_keeper))
+    // If only settings of the g-code changed since an earlier slice, its areas can be written again.
+    SliceDataStorageCache& storage_cache = SliceDataStorageCache::getInstance();
+    const uint64_t storage_key = SliceDataStorageCache::isEnabled() ? SliceDataStorageCache::hashAreasInput(mesh_group) : 0;
+    std::unique_ptr<SliceDataStorage> storage = SliceDataStorageCache::isEnabled() ? storage_cache.take(storage_key, mesh_group) : nullptr;
+    if (storage == nullptr)
     {
-        return;
+        storage = std::make_unique<SliceDataStorage>();
+        if (! fff_processor->polygon_generator.generateAreas(*storage, &mesh_group, fff_processor->time_keeper))
+        {
+            return;
+        }
     }
 
+    Cancellation::throwIfRequested();
+    spdlog::info("The layers of the meshes and the support take up about {} MB.", storage->getMemoryFootprint() / (1024 * 1024));
     Progress::messageProgressStage(Progress::Stage::EXPORT, &fff_processor->time_keeper);
-    fff_processor->gcode_writer.writeGCode(storage, fff_processor->time_keeper);
+    const bool keep_storage = SliceDataStorageCache::isEnabled() && MemoryBudget::getPressure() == MemoryBudget::Pressure::NONE;
+    fff_processor->gcode_writer.writeGCode(*storage, fff_processor->time_keeper, keep_storage);
+    if (keep_storage)
+    {
+        storage_cache.keep(storage_key, std::move(storage));
+    }
+    else
+    {
+        releaseStorage(std::move(storage), &mesh_group == &mesh_groups.back());
+    }
+    Progress::finishCostModel();
 
     Progress::messageProgress(Progress::Stage::FINISH, 1, 1); // 100% on this meshgroup
     Application::getInstance().communication_->flushGCode();
     Application::getInstance().communication_->sendOptimizedLayerData();
+    Application::getInstance().thread_pool_->reportStatistics();
+    AllocationStatistics::report();
     spdlog::info("Total time elapsed {:03.3f}s\n", time_keeper_total.restart());
 }
 
+void Scene::waitForReleasedStorage()
+{
+    if (storage_release_thread_.joinable())
+    {
+        storage_release_thread_.join();
+    }
+}
+
+void Scene::releaseStorage(std::unique_ptr<SliceDataStorage> storage, const bool is_last)
+{
+    waitForReleasedStorage(); // Only ever one mesh group in the background.
+    if (is_last || MemoryBudget::getPressure() != MemoryBudget::Pressure::NONE)
+    {
+        storage.reset();
+        return;
+    }
+    storage_release_thread_ = std::thread(
+        [storage = std::move(storage)]() mutable
+        {
+            storage.reset();
+        });
+}
+
 } // namespace cura
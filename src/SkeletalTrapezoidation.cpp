@@ -14,6 +14,7 @@
 
 #include "BoostInterface.hpp"
 #include "settings/types/Ratio.h"
+#include "utils/Cancellation.h"
 #include "utils/VoronoiUtils.h"
 #include "utils/linearAlg2D.h"
 #include "utils/macros.h"
@@ -179,7 +180,7 @@ std::vector<Point2LL> SkeletalTrapezoidation::discretize(const vd_t::edge_type&
     {
         Point2LL p = VoronoiUtils::getSourcePoint(*(point_left ? left_cell : right_cell), points, segments);
         const Segment& s = VoronoiUtils::getSourceSegment(*(point_left ? right_cell : left_cell), points, segments);
-        return VoronoiUtils::discretizeParabola(p, s, start, end, discretization_step_size_, transitioning_angle_);
+        return VoronoiUtils::discretizeParabola(p, s, start, end, discretization_step_size_, transitioning_angle_, discretization_max_deviation_);
     }
     else // This is a straight edge between two points.
     {
@@ -374,6 +375,7 @@ SkeletalTrapezoidation::SkeletalTrapezoidation(
     const BeadingStrategy& beading_strategy,
     AngleRadians transitioning_angle,
     coord_t discretization_step_size,
+    coord_t discretization_max_deviation,
     coord_t transition_filter_dist,
     coord_t allowed_filter_deviation,
     coord_t beading_propagation_transition_dist,
@@ -381,6 +383,7 @@ SkeletalTrapezoidation::SkeletalTrapezoidation(
     SectionType section_type)
     : transitioning_angle_(transitioning_angle)
     , discretization_step_size_(discretization_step_size)
+    , discretization_max_deviation_(discretization_max_deviation)
     , transition_filter_dist_(transition_filter_dist)
     , allowed_filter_deviation_(allowed_filter_deviation)
     , beading_propagation_transition_dist_(beading_propagation_transition_dist)
@@ -399,7 +402,11 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
 
     std::vector<Point2LL> points; // Remains empty
 
-    std::vector<Segment> segments;
+    // The segments, the builder and the diagram are reused for all parts that this thread constructs, keeping their memory.
+    thread_local std::vector<Segment> segments;
+    thread_local boost::polygon::default_voronoi_builder voronoi_builder;
+    thread_local vd_t vonoroi_diagram;
+    segments.clear();
     for (size_t poly_idx = 0; poly_idx < polys.size(); poly_idx++)
     {
         ConstPolygonRef poly = polys[poly_idx];
@@ -409,8 +416,11 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
         }
     }
 
-    vd_t vonoroi_diagram;
-    construct_voronoi(segments.begin(), segments.end(), &vonoroi_diagram);
+    voronoi_builder.clear();
+    vonoroi_diagram.clear();
+    boost::polygon::insert(segments.begin(), segments.end(), &voronoi_builder);
+    voronoi_builder.construct(&vonoroi_diagram);
+    Cancellation::throwIfRequested(); // Constructing the diagram is the most expensive step, so check right after it.
 
     for (vd_t::cell_type cell : vonoroi_diagram.cells())
     {
@@ -522,10 +532,12 @@ void SkeletalTrapezoidation::separatePointyQuadEndNodes()
 // vvvvvvvvvvvvvvvvvvvvv
 //
 
-void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>& generated_toolpaths, bool filter_outermost_central_edges)
+void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>& generated_toolpaths, bool filter_outermost_central_edges, TimeKeeper* time_keeper)
 {
     p_generated_toolpaths = &generated_toolpaths;
+    time_keeper_ = time_keeper;
 
+    Cancellation::throwIfRequested();
     updateIsCentral();
 
     filterCentral(central_filter_dist_);
@@ -567,6 +579,7 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>&
                                return node->data_.transition_ratio_;
                            } });
 
+    Cancellation::throwIfRequested();
     filterNoncentralRegions();
     scripta::log(
         "st_graph_1",
@@ -599,7 +612,9 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>&
                                return node->data_.transition_ratio_;
                            } });
 
+    Cancellation::throwIfRequested();
     generateTransitioningRibs();
+    registerTime("Transitions");
     scripta::log(
         "st_graph_2",
         graph_,
@@ -631,6 +646,7 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>&
                                return node->data_.transition_ratio_;
                            } });
 
+    Cancellation::throwIfRequested();
     generateExtraRibs();
     scripta::log(
         "st_graph_3",
@@ -663,6 +679,7 @@ void SkeletalTrapezoidation::generateToolpaths(std::vector<VariableWidthLines>&
                                return node->data_.transition_ratio_;
                            } });
 
+    Cancellation::throwIfRequested();
     generateSegments();
     scripta::log(
         "st_graph_4",
@@ -892,7 +909,7 @@ void SkeletalTrapezoidation::generateTransitioningRibs()
 {
     // Store the upward edges to the transitions.
     // We only store the halfedge for which the distance_to_boundary is higher at the end than at the beginning.
-    ptr_vector_t<std::list<TransitionMiddle>> edge_transitions;
+    ptr_vector_t<TransitionMiddles> edge_transitions;
     generateTransitionMids(edge_transitions);
 
     for (edge_t& edge : graph_.edges)
@@ -905,7 +922,7 @@ void SkeletalTrapezoidation::generateTransitioningRibs()
 
     filterTransitionMids();
 
-    ptr_vector_t<std::list<TransitionEnd>> edge_transition_ends; // We only map the half edge in the upward direction. mapped items are not sorted
+    ptr_vector_t<TransitionEnds> edge_transition_ends; // We only map the half edge in the upward direction. mapped items are not sorted
     generateAllTransitionEnds(edge_transition_ends);
 
     applyTransitions(edge_transition_ends);
@@ -913,7 +930,7 @@ void SkeletalTrapezoidation::generateTransitioningRibs()
 }
 
 
-void SkeletalTrapezoidation::generateTransitionMids(ptr_vector_t<std::list<TransitionMiddle>>& edge_transitions)
+void SkeletalTrapezoidation::generateTransitionMids(ptr_vector_t<TransitionMiddles>& edge_transitions)
 {
     for (edge_t& edge : graph_.edges)
     {
@@ -981,7 +998,7 @@ void SkeletalTrapezoidation::generateTransitionMids(ptr_vector_t<std::list<Trans
             assert((! edge.data_.hasTransitions(ignore_empty)) || mid_pos >= transitions->back().pos_);
             if (! edge.data_.hasTransitions(ignore_empty))
             {
-                edge_transitions.emplace_back(std::make_shared<std::list<TransitionMiddle>>());
+                edge_transitions.emplace_back(makeShared<TransitionMiddles>());
                 edge.data_.setTransitions(edge_transitions.back()); // initialization
                 transitions = edge.data_.getTransitions();
             }
@@ -1188,7 +1205,7 @@ bool SkeletalTrapezoidation::filterEndOfCentralTransition(edge_t* edge_to_start,
     return should_dissolve;
 }
 
-void SkeletalTrapezoidation::generateAllTransitionEnds(ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends)
+void SkeletalTrapezoidation::generateAllTransitionEnds(ptr_vector_t<TransitionEnds>& edge_transition_ends)
 {
     for (edge_t& edge : graph_.edges)
     {
@@ -1208,7 +1225,7 @@ void SkeletalTrapezoidation::generateAllTransitionEnds(ptr_vector_t<std::list<Tr
     }
 }
 
-void SkeletalTrapezoidation::generateTransitionEnds(edge_t& edge, coord_t mid_pos, coord_t lower_bead_count, ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends)
+void SkeletalTrapezoidation::generateTransitionEnds(edge_t& edge, coord_t mid_pos, coord_t lower_bead_count, ptr_vector_t<TransitionEnds>& edge_transition_ends)
 {
     const Point2LL a = edge.from_->p_;
     const Point2LL b = edge.to_->p_;
@@ -1253,7 +1270,7 @@ bool SkeletalTrapezoidation::generateTransitionEnd(
     Ratio start_rest,
     Ratio end_rest,
     coord_t lower_bead_count,
-    ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends)
+    ptr_vector_t<TransitionEnds>& edge_transition_ends)
 {
     Point2LL a = edge.from_->p_;
     Point2LL b = edge.to_->p_;
@@ -1339,7 +1356,7 @@ bool SkeletalTrapezoidation::generateTransitionEnd(
         if (! upward_edge->data_.hasTransitionEnds())
         {
             // This edge doesn't have a data structure yet for the transition ends. Make one.
-            edge_transition_ends.emplace_back(std::make_shared<std::list<TransitionEnd>>());
+            edge_transition_ends.emplace_back(makeShared<TransitionEnds>());
             upward_edge->data_.setTransitionEnds(edge_transition_ends.back());
         }
         auto transitions = upward_edge->data_.getTransitionEnds();
@@ -1413,7 +1430,7 @@ bool SkeletalTrapezoidation::isGoingDown(edge_t* outgoing, coord_t traveled_dist
     return has_recursed && is_only_going_down;
 }
 
-void SkeletalTrapezoidation::applyTransitions(ptr_vector_t<std::list<TransitionEnd>>& edge_transition_ends)
+void SkeletalTrapezoidation::applyTransitions(ptr_vector_t<TransitionEnds>& edge_transition_ends)
 {
     for (edge_t& edge : graph_.edges)
     {
@@ -1423,7 +1440,7 @@ void SkeletalTrapezoidation::applyTransitions(ptr_vector_t<std::list<TransitionE
             auto& twin_transition_ends = *edge.twin_->data_.getTransitionEnds();
             if (! edge.data_.hasTransitionEnds())
             {
-                edge_transition_ends.emplace_back(std::make_shared<std::list<TransitionEnd>>());
+                edge_transition_ends.emplace_back(makeShared<TransitionEnds>());
                 edge.data_.setTransitionEnds(edge_transition_ends.back());
             }
             auto& transition_ends = *edge.data_.getTransitionEnds();
@@ -1624,7 +1641,7 @@ void SkeletalTrapezoidation::generateSegments()
             }
             if (node.data_.transition_ratio_ == 0)
             {
-                node_beadings.emplace_back(new BeadingPropagation(beading_strategy_.compute(node.data_.distance_to_boundary_ * 2, node.data_.bead_count_)));
+                node_beadings.emplace_back(makeShared<BeadingPropagation>(beading_strategy_.compute(node.data_.distance_to_boundary_ * 2, node.data_.bead_count_)));
                 node.data_.setBeading(node_beadings.back());
                 assert(node_beadings.back()->beading_.total_thickness == node.data_.distance_to_boundary_ * 2);
                 if (node_beadings.back()->beading_.total_thickness != node.data_.distance_to_boundary_ * 2)
@@ -1637,7 +1654,7 @@ void SkeletalTrapezoidation::generateSegments()
                 Beading low_count_beading = beading_strategy_.compute(node.data_.distance_to_boundary_ * 2, node.data_.bead_count_);
                 Beading high_count_beading = beading_strategy_.compute(node.data_.distance_to_boundary_ * 2, node.data_.bead_count_ + 1);
                 Beading merged = interpolate(low_count_beading, 1.0 - node.data_.transition_ratio_, high_count_beading);
-                node_beadings.emplace_back(new BeadingPropagation(merged));
+                node_beadings.emplace_back(makeShared<BeadingPropagation>(merged));
                 node.data_.setBeading(node_beadings.back());
                 assert(merged.total_thickness == node.data_.distance_to_boundary_ * 2);
                 if (merged.total_thickness != node.data_.distance_to_boundary_ * 2)
@@ -1651,6 +1668,7 @@ void SkeletalTrapezoidation::generateSegments()
     propagateBeadingsUpward(upward_quad_mids, node_beadings);
 
     propagateBeadingsDownward(upward_quad_mids, node_beadings);
+    registerTime("Beading");
 
     ptr_vector_t<LineJunctions> edge_junctions; // junctions ordered high R to low R
     generateJunctions(node_beadings, edge_junctions);
@@ -1658,6 +1676,15 @@ void SkeletalTrapezoidation::generateSegments()
     connectJunctions(edge_junctions);
 
     generateLocalMaximaSingleBeads();
+    registerTime("Junctions");
+}
+
+void SkeletalTrapezoidation::registerTime(const std::string& stage)
+{
+    if (time_keeper_ != nullptr)
+    {
+        time_keeper_->registerTime(stage, 0.0);
+    }
 }
 
 SkeletalTrapezoidation::edge_t* SkeletalTrapezoidation::getQuadMaxRedgeTo(edge_t* quad_start_edge)
@@ -1710,7 +1737,7 @@ void SkeletalTrapezoidation::propagateBeadingsUpward(std::vector<edge_t*>& upwar
         BeadingPropagation upper_beading = lower_beading;
         upper_beading.dist_to_bottom_source_ += length;
         upper_beading.is_upward_propagated_only_ = true;
-        node_beadings.emplace_back(new BeadingPropagation(upper_beading));
+        node_beadings.emplace_back(makeShared<BeadingPropagation>(upper_beading));
         upward_edge->to_->data_.setBeading(node_beadings.back());
         assert(upper_beading.beading_.total_thickness <= upward_edge->to_->data_.distance_to_boundary_ * 2);
     }
@@ -1752,7 +1779,7 @@ void SkeletalTrapezoidation::propagateBeadingsDownward(edge_t* edge_to_peak, ptr
     { // Set new beading if there is no beading associated with the node yet
         BeadingPropagation propagated_beading = top_beading;
         propagated_beading.dist_from_top_source_ += length;
-        node_beadings.emplace_back(new BeadingPropagation(propagated_beading));
+        node_beadings.emplace_back(makeShared<BeadingPropagation>(propagated_beading));
         edge_to_peak->from_->data_.setBeading(node_beadings.back());
         assert(propagated_beading.beading_.total_thickness >= edge_to_peak->from_->data_.distance_to_boundary_ * 2);
         if (propagated_beading.beading_.total_thickness < edge_to_peak->from_->data_.distance_to_boundary_ * 2)
@@ -1870,7 +1897,7 @@ void SkeletalTrapezoidation::generateJunctions(ptr_vector_t<BeadingPropagation>&
         }
 
         Beading* beading = &getOrCreateBeading(edge->to_, node_beadings)->beading_;
-        edge_junctions.emplace_back(std::make_shared<LineJunctions>());
+        edge_junctions.emplace_back(makeShared<LineJunctions>());
         edge_.data_.setExtrusionJunctions(edge_junctions.back()); // initialization
         LineJunctions& ret = *edge_junctions.back();
 
@@ -1957,7 +1984,7 @@ std::shared_ptr<SkeletalTrapezoidationJoint::BeadingPropagation> SkeletalTrapezo
             node->data_.bead_count_ = beading_strategy_.getOptimalBeadCount(dist * 2);
         }
         assert(node->data_.bead_count_ != -1);
-        node_beadings.emplace_back(new BeadingPropagation(beading_strategy_.compute(node->data_.distance_to_boundary_ * 2, node->data_.bead_count_)));
+        node_beadings.emplace_back(makeShared<BeadingPropagation>(beading_strategy_.compute(node->data_.distance_to_boundary_ * 2, node->data_.bead_count_)));
         node->data_.setBeading(node_beadings.back());
     }
     assert(node->data_.hasBeading());
@@ -2092,14 +2119,14 @@ void SkeletalTrapezoidation::connectJunctions(ptr_vector_t<LineJunctions>& edge_
 
             if (! edge_to_peak->data_.hasExtrusionJunctions())
             {
-                edge_junctions.emplace_back(std::make_shared<LineJunctions>());
+                edge_junctions.emplace_back(makeShared<LineJunctions>());
                 edge_to_peak->data_.setExtrusionJunctions(edge_junctions.back());
             }
             // The junctions on the edge(s) from the start of the quad to the node with highest R
             LineJunctions from_junctions = *edge_to_peak->data_.getExtrusionJunctions();
             if (! edge_from_peak->twin_->data_.hasExtrusionJunctions())
             {
-                edge_junctions.emplace_back(std::make_shared<LineJunctions>());
+                edge_junctions.emplace_back(makeShared<LineJunctions>());
                 edge_from_peak->twin_->data_.setExtrusionJunctions(edge_junctions.back());
             }
             // The junctions on the edge(s) from the end of the quad to the node with highest R
@@ -12,7 +12,9 @@
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
 #include "support.h"
+#include "utils/MultiOffset.h"
 #include "utils/PolylineStitcher.h"
+#include "utils/ThreadPool.h"
 #include "utils/Simplify.h" //Simplifying the brim/skirt at every inset.
 
 namespace cura
@@ -149,6 +151,7 @@ void SkirtBrim::generate()
         {
             allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(covered_area);
         }
+        allowed_areas_exclude_covered_area_ = true;
     }
 
     // Secondary brim of all other materials which don't meet minimum length constraint yet
@@ -279,14 +282,22 @@ coord_t SkirtBrim::generateOffset(const Offset& offset, Polygons& covered_area,
     }
 
     // update allowed_areas_per_extruder
-    covered_area = covered_area.unionPolygons(newly_covered.unionPolygons());
-    for (size_t extruder_nr = 0; extruder_nr < extruder_count_; extruder_nr++)
-    {
-        if (extruders_configs_[extruder_nr].extruder_is_used_)
+    newly_covered = newly_covered.unionPolygons();
+    covered_area = covered_area.unionPolygons(newly_covered);
+    // Once the allowed areas lie outside of the covered area, only the newly covered part needs to be subtracted from
+    // them, which doesn't grow with the number of brim lines. The extruders are independent of each other.
+    const Polygons& subtracted_area = allowed_areas_exclude_covered_area_ ? newly_covered : covered_area;
+    cura::parallel_for<size_t>(
+        0,
+        extruder_count_,
+        [&](const size_t extruder_nr)
         {
-            allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(covered_area);
-        }
-    }
+            if (extruders_configs_[extruder_nr].extruder_is_used_)
+            {
+                allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(subtracted_area);
+            }
+        });
+    allowed_areas_exclude_covered_area_ = true;
 
     return length_added;
 }
@@ -463,6 +474,7 @@ void SkirtBrim::generateShieldBrim(Polygons& brim_covered_area, std::vector<Poly
         const Polygons covered_area = shield_brim.offset(primary_extruder_skirt_brim_line_width / 2);
         brim_covered_area = brim_covered_area.unionPolygons(covered_area);
         allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(covered_area);
+        allowed_areas_exclude_covered_area_ = false; // Only the primary extruder avoids the shield brim.
 
         // generate brim within shield_brim
         storage_.skirt_brim[extruder_nr].emplace_back();
@@ -482,12 +494,14 @@ void SkirtBrim::generateShieldBrim(Polygons& brim_covered_area, std::vector<Poly
             const Polygons covered_area = storage_.oozeShield[0].offset(extruder_config.line_width_ / 2);
             brim_covered_area = brim_covered_area.unionPolygons(covered_area);
             allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(covered_area);
+            allowed_areas_exclude_covered_area_ = false;
         }
         if (has_draft_shield_)
         {
             const Polygons covered_area = storage_.draft_protection_shield.offset(extruder_config.line_width_ / 2);
             brim_covered_area = brim_covered_area.unionPolygons(covered_area);
             allowed_areas_per_extruder[extruder_nr] = allowed_areas_per_extruder[extruder_nr].difference(covered_area);
+            allowed_areas_exclude_covered_area_ = false;
         }
     }
 }
@@ -687,12 +701,13 @@ void SkirtBrim::generateSupportBrim()
     const Polygons brim_area = support_outline.difference(support_outline.offset(-brim_width));
     support_layer.excludeAreasFromSupportInfillAreas(brim_area, AABB(brim_area));
 
+    MultiOffset support_outline_offsets(support_outline, ClipperLib::jtRound);
     coord_t offset_distance = brim_line_width / 2;
     for (size_t skirt_brim_number = 0; skirt_brim_number < line_count; skirt_brim_number++)
     {
         offset_distance -= brim_line_width;
 
-        Polygons brim_line = support_outline.offset(offset_distance, ClipperLib::jtRound);
+        Polygons brim_line = support_outline_offsets.offset(offset_distance);
 
         // Remove small inner skirt and brim holes. Holes have a negative area, remove anything smaller then multiplier x extrusion "area"
         for (size_t n = 0; n < brim_line.size(); n++)
@@ -9,6 +9,12 @@
 #endif
 
 #include "ExtruderTrain.h"
+#include "MeshWallsCache.h"
+#include "SliceDataStorageCache.h"
+#include "SlicerCache.h"
+#include "TreeModelVolumesCache.h"
+#include "infill/SierpinskiFillProviderCache.h"
+#include "utils/MemoryBudget.h"
 
 namespace cura
 {
@@ -27,15 +33,50 @@ void Slice::compute()
     }
 #endif
 
+    SlicerCache::getInstance().startSlice();
+    SierpinskiFillProviderCache::getInstance().startSlice();
+    MeshWallsCache::getInstance().startSlice();
+    SliceDataStorageCache::getInstance().startSlice();
+    TreeModelVolumesCache::getInstance().startSlice();
     for (std::vector<MeshGroup>::iterator mesh_group = scene.mesh_groups.begin(); mesh_group != scene.mesh_groups.end(); mesh_group++)
     {
         scene.current_mesh_group = mesh_group;
+        if (MemoryBudget::getPressure() != MemoryBudget::Pressure::NONE)
+        {
+            // What is kept for later slices makes room for this one. The entries in use by this slice stay alive where they are used.
+            spdlog::warn("Close to the memory budget of {} MB, dropping the caches of earlier slices.", MemoryBudget::getBudgetBytes() / (1024 * 1024));
+            SlicerCache::getInstance().clear();
+            SierpinskiFillProviderCache::getInstance().clear();
+            MeshWallsCache::getInstance().clear();
+            SliceDataStorageCache::getInstance().clear();
+            TreeModelVolumesCache::getInstance().clear();
+        }
         for (ExtruderTrain& extruder : scene.extruders)
         {
             extruder.settings_.setParent(&scene.current_mesh_group->settings);
         }
+
+        // The settings don't change any more while slicing this mesh group, so resolve them all once instead of at every lookup.
+        // Parents are frozen before their children, so that the children can use their snapshots.
+        scene.settings.freeze();
+        mesh_group->settings.freeze();
+        for (ExtruderTrain& extruder : scene.extruders)
+        {
+            extruder.settings_.freeze();
+        }
+        for (Mesh& mesh : mesh_group->meshes)
+        {
+            mesh.settings_.freeze();
+        }
+
         scene.processMeshGroup(*mesh_group);
     }
+    scene.waitForReleasedStorage();
+    SlicerCache::getInstance().finishSlice();
+    SierpinskiFillProviderCache::getInstance().finishSlice();
+    MeshWallsCache::getInstance().finishSlice();
+    SliceDataStorageCache::getInstance().finishSlice();
+    TreeModelVolumesCache::getInstance().finishSlice();
 }
 
 void Slice::reset()
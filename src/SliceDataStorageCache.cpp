@@ -0,0 +1,245 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "SliceDataStorageCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "ExtruderTrain.h"
+#include "MeshGroup.h"
+#include "Scene.h"
+#include "Slice.h"
+#include "communication/Communication.h"
+#include "sliceDataStorage.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * The settings that only the g-code writer reads, by the start of their keys: the speeds, accelerations and jerks,
+ * the temperatures, the retractions and wipes, the fan speeds and the start and end g-code.
+ */
+constexpr std::array gcode_setting_prefixes = {
+    "acceleration_",
+    "build_volume_temperature",
+    "cool_",
+    "jerk_",
+    "machine_end_gcode",
+    "machine_extruder_end_code",
+    "machine_extruder_start_code",
+    "machine_max_acceleration_",
+    "machine_max_jerk_",
+    "machine_nozzle_cool_down_speed",
+    "machine_nozzle_heat_up_speed",
+    "machine_scale_fan_speed_zero_to_one",
+    "machine_start_gcode",
+    "material_bed_temp",
+    "material_extrusion_cool_down_speed",
+    "material_final_print_temperature",
+    "material_initial_print_temperature",
+    "material_print_temp",
+    "material_standby_temperature",
+    "retract_at_layer_change",
+    "retraction_",
+    "speed_",
+    "support_supported_skin_fan_speed",
+    "switch_extruder_",
+    "wipe_",
+};
+
+/*!
+ * The settings of the raft and the bridges that only the g-code writer reads, by the end of their keys. The other
+ * settings of the raft and the bridges change their areas.
+ */
+constexpr std::array gcode_raft_and_bridge_setting_suffixes = {
+    "_acceleration",
+    "_fan_speed",
+    "_jerk",
+    "_speed",
+};
+
+/*!
+ * Incrementally computed 64-bit FNV-1a style hash, mixing in whole words at a time.
+ */
+class Hasher
+{
+public:
+    void add(const uint64_t value)
+    {
+        hash_ = (hash_ ^ value) * 0x100000001b3ULL;
+    }
+
+    void add(const std::string& value)
+    {
+        for (const char character : value)
+        {
+            add(static_cast<uint64_t>(character));
+        }
+        add(value.size());
+    }
+
+    /*!
+     * Add the settings of a container itself that may change the areas. They are hashed on their own and summed, so
+     * that the order in which the container lists them doesn't matter.
+     */
+    void add(const Settings& settings)
+    {
+        uint64_t settings_hash = 0;
+        for (const auto& [key, value] : settings.getOwnSettings())
+        {
+            if (SliceDataStorageCache::onlyAffectsGCode(key))
+            {
+                continue;
+            }
+            Hasher setting_hasher;
+            setting_hasher.add(key);
+            setting_hasher.add(value);
+            settings_hash += setting_hasher.get();
+        }
+        add(settings_hash);
+    }
+
+    uint64_t get() const
+    {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+} // namespace
+
+SliceDataStorageCache& SliceDataStorageCache::getInstance()
+{
+    static SliceDataStorageCache instance;
+    return instance;
+}
+
+bool SliceDataStorageCache::isEnabled()
+{
+    const Communication* communication = Application::getInstance().communication_;
+    return communication != nullptr && communication->isPersistent();
+}
+
+bool SliceDataStorageCache::onlyAffectsGCode(const std::string_view key)
+{
+    const auto starts_key = [key](const std::string_view prefix)
+    {
+        return key.starts_with(prefix);
+    };
+    if (std::any_of(gcode_setting_prefixes.begin(), gcode_setting_prefixes.end(), starts_key))
+    {
+        return true;
+    }
+    if (key.starts_with("raft_") || key.starts_with("bridge_"))
+    {
+        const auto ends_key = [key](const std::string_view suffix)
+        {
+            return key.ends_with(suffix);
+        };
+        return std::any_of(gcode_raft_and_bridge_setting_suffixes.begin(), gcode_raft_and_bridge_setting_suffixes.end(), ends_key);
+    }
+    return false;
+}
+
+uint64_t SliceDataStorageCache::hashAreasInput(const MeshGroup& mesh_group)
+{
+    Hasher hasher;
+
+    // The geometry. The vertices have already been transformed and put in place at this point.
+    hasher.add(mesh_group.meshes.size());
+    for (const Mesh& mesh : mesh_group.meshes)
+    {
+        hasher.add(mesh.mesh_name_);
+        hasher.add(mesh.vertices_.size());
+        for (const MeshVertex& vertex : mesh.vertices_)
+        {
+            hasher.add(vertex.p_.x_);
+            hasher.add(vertex.p_.y_);
+            hasher.add(vertex.p_.z_);
+        }
+        hasher.add(mesh.faces_.size());
+        for (const MeshFace& face : mesh.faces_)
+        {
+            hasher.add(face.vertex_index_[0]);
+            hasher.add(face.vertex_index_[1]);
+            hasher.add(face.vertex_index_[2]);
+        }
+        hasher.add(mesh.settings_);
+    }
+
+    // The settings that the meshes inherit.
+    const Scene& scene = Application::getInstance().current_slice_->scene;
+    hasher.add(mesh_group.settings);
+    hasher.add(scene.extruders.size());
+    for (const ExtruderTrain& extruder : scene.extruders)
+    {
+        hasher.add(extruder.settings_);
+    }
+    hasher.add(scene.settings);
+
+    return hasher.get();
+}
+
+std::unique_ptr<SliceDataStorage> SliceDataStorageCache::take(const uint64_t key, MeshGroup& mesh_group)
+{
+    std::unique_ptr<SliceDataStorage> storage;
+    for (std::unordered_map<uint64_t, std::unique_ptr<SliceDataStorage>>* entries : { &entries_, &previous_entries_ })
+    {
+        if (const auto entry = entries->find(key); entry != entries->end())
+        {
+            storage = std::move(entry->second);
+            entries->erase(entry);
+            break;
+        }
+    }
+    if (storage == nullptr)
+    {
+        return nullptr;
+    }
+
+    // The meshes of the earlier slice are gone, so hand their areas to the meshes of this one.
+    assert(storage->meshes.size() == mesh_group.meshes.size() && "The meshes have the same geometry, so there are as many.");
+    for (size_t mesh_idx = 0; mesh_idx < storage->meshes.size(); mesh_idx++)
+    {
+        Mesh& mesh = mesh_group.meshes[mesh_idx];
+        mesh.expandXY(mesh.settings_.get<coord_t>("xy_offset")); // Register the horizontal expansion, the same as when the mesh is sliced.
+        storage->meshes[mesh_idx] = std::make_shared<SliceMeshStorage>(&mesh, std::move(*storage->meshes[mesh_idx]));
+    }
+    spdlog::info("Only settings of the g-code changed, reusing the areas of an earlier slice.");
+    return storage;
+}
+
+void SliceDataStorageCache::keep(const uint64_t key, std::unique_ptr<SliceDataStorage> storage)
+{
+    entries_[key] = std::move(storage);
+}
+
+void SliceDataStorageCache::startSlice()
+{
+    previous_entries_ = std::move(entries_);
+    entries_.clear();
+}
+
+void SliceDataStorageCache::finishSlice()
+{
+    previous_entries_.clear();
+}
+
+void SliceDataStorageCache::clear()
+{
+    entries_.clear();
+    previous_entries_.clear();
+}
+
+} // namespace cura
@@ -0,0 +1,213 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "SlicerCache.h"
+
+#include <array>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "Scene.h"
+#include "Slice.h"
+#include "communication/Communication.h"
+#include "mesh.h"
+#include "settings/AdaptiveLayerHeights.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * The settings of a mesh that influence the output of the Slicer.
+ */
+constexpr std::array slicing_settings = {
+    "slicing_tolerance",
+    "magic_mesh_surface_mode",
+    "meshfix_extensive_stitching",
+    "meshfix_keep_open_polygons",
+    "minimum_polygon_circumference",
+    "meshfix_maximum_resolution",
+    "meshfix_maximum_deviation",
+    "meshfix_maximum_extrusion_area_deviation",
+    "xy_offset",
+    "xy_offset_layer_0",
+    "hole_xy_offset",
+    "hole_xy_offset_max_diameter",
+    "support_mesh",
+    "anti_overhang_mesh",
+    "cutting_mesh",
+    "infill_mesh",
+};
+
+/*!
+ * Incrementally computed 64-bit FNV-1a style hash, mixing in whole words at a time.
+ */
+class Hasher
+{
+public:
+    void add(const uint64_t value)
+    {
+        hash_ = (hash_ ^ value) * 0x100000001b3ULL;
+    }
+
+    void add(const std::string& value)
+    {
+        for (const char character : value)
+        {
+            add(static_cast<uint64_t>(character));
+        }
+        add(value.size());
+    }
+
+    uint64_t get() const
+    {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+} // namespace
+
+SlicerCache& SlicerCache::getInstance()
+{
+    static SlicerCache instance;
+    return instance;
+}
+
+Slicer* SlicerCache::slice(Mesh* mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers)
+{
+    const Point2LL origin(mesh->min().x_, mesh->min().y_);
+    const uint64_t instance_key = hashSlicerInput(*mesh, origin, thickness, slice_layer_count, use_variable_layer_heights ? adaptive_layers : nullptr);
+    const auto instance = instances_.find(instance_key);
+    if (instance != instances_.end())
+    {
+        spdlog::info("Mesh '{}' is a moved copy of mesh '{}', moving its sliced layers along.", mesh->mesh_name_, instance->second.slicer->mesh->mesh_name_);
+        mesh->expandXY(mesh->settings_.get<coord_t>("xy_offset")); // Register the horizontal expansion, the same as when the mesh is sliced.
+        Slicer* slicer = new Slicer(mesh, instance->second.slicer->layers);
+        const Point2LL translation = origin - instance->second.origin;
+        for (SlicerLayer& layer : slicer->layers)
+        {
+            layer.polygons.translate(translation);
+            layer.openPolylines.translate(translation);
+        }
+        return slicer;
+    }
+
+    Slicer* slicer = sliceOrReuse(mesh, thickness, slice_layer_count, use_variable_layer_heights, adaptive_layers);
+    instances_.emplace(instance_key, Instance{ .origin = origin, .slicer = slicer });
+    return slicer;
+}
+
+Slicer* SlicerCache::sliceOrReuse(Mesh* mesh, const coord_t thickness, const size_t slice_layer_count, bool use_variable_layer_heights, std::vector<AdaptiveLayer>* adaptive_layers)
+{
+    if (! isEnabled())
+    {
+        return new Slicer(mesh, thickness, slice_layer_count, use_variable_layer_heights, adaptive_layers);
+    }
+
+    const uint64_t key = hashSlicerInput(*mesh, Point2LL(0, 0), thickness, slice_layer_count, use_variable_layer_heights ? adaptive_layers : nullptr);
+    auto entry = entries_.find(key);
+    if (entry == entries_.end())
+    {
+        const auto previous_entry = previous_entries_.find(key);
+        if (previous_entry != previous_entries_.end())
+        { // Reused in this slice, so keep it for the next one.
+            entry = entries_.emplace(key, std::move(previous_entry->second)).first;
+            previous_entries_.erase(previous_entry);
+        }
+    }
+    if (entry != entries_.end())
+    {
+        spdlog::info("Reusing the sliced layers of mesh '{}' from an earlier slice.", mesh->mesh_name_);
+        mesh->expandXY(mesh->settings_.get<coord_t>("xy_offset")); // Register the horizontal expansion, the same as when the mesh is sliced.
+        return new Slicer(mesh, entry->second);
+    }
+
+    Slicer* slicer = new Slicer(mesh, thickness, slice_layer_count, use_variable_layer_heights, adaptive_layers);
+    entries_.emplace(key, slicer->layers);
+    return slicer;
+}
+
+void SlicerCache::startSlice()
+{
+    instances_.clear(); // In case the previous slice was cancelled while slicing.
+    previous_entries_ = std::move(entries_);
+    entries_.clear();
+}
+
+void SlicerCache::finishSlice()
+{
+    previous_entries_.clear();
+}
+
+void SlicerCache::finishMeshGroup()
+{
+    instances_.clear();
+}
+
+void SlicerCache::clear()
+{
+    instances_.clear();
+    entries_.clear();
+    previous_entries_.clear();
+}
+
+uint64_t SlicerCache::hashSlicerInput(
+    const Mesh& mesh,
+    const Point2LL& origin,
+    const coord_t thickness,
+    const size_t slice_layer_count,
+    std::vector<AdaptiveLayer>* adaptive_layers)
+{
+    Hasher hasher;
+
+    // The geometry. The vertices have already been transformed and put in place at this point.
+    hasher.add(mesh.vertices_.size());
+    for (const MeshVertex& vertex : mesh.vertices_)
+    {
+        hasher.add(vertex.p_.x_ - origin.X);
+        hasher.add(vertex.p_.y_ - origin.Y);
+        hasher.add(vertex.p_.z_);
+    }
+    hasher.add(mesh.faces_.size());
+    for (const MeshFace& face : mesh.faces_)
+    {
+        hasher.add(face.vertex_index_[0]);
+        hasher.add(face.vertex_index_[1]);
+        hasher.add(face.vertex_index_[2]);
+    }
+
+    // The layer heights.
+    hasher.add(thickness);
+    hasher.add(slice_layer_count);
+    hasher.add(Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<std::string>("layer_height_0"));
+    if (adaptive_layers != nullptr)
+    {
+        for (const AdaptiveLayer& layer : *adaptive_layers)
+        {
+            hasher.add(layer.z_position_);
+        }
+    }
+
+    // The settings.
+    for (const char* setting_key : slicing_settings)
+    {
+        hasher.add(mesh.settings_.get<std::string>(setting_key));
+    }
+
+    return hasher.get();
+}
+
+bool SlicerCache::isEnabled()
+{
+    const Communication* communication = Application::getInstance().communication_;
+    return communication != nullptr && communication->isPersistent();
+}
+
+} // namespace cura
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "TimeEstimatePipeline.h"
+
+namespace cura
+{
+
+TimeEstimatePipeline::~TimeEstimatePipeline()
+{
+    if (thread_.joinable())
+    {
+        push(Record{ .type = Record::Type::STOP, .feature = PrintFeatureType::NoneType, .value = 0.0, .position = {} });
+        thread_.join();
+    }
+}
+
+void TimeEstimatePipeline::setFirmwareDefaults(const Settings& settings)
+{
+    waitUntilEstimated();
+    calculator_.setFirmwareDefaults(settings);
+}
+
+void TimeEstimatePipeline::plan(const TimeEstimateCalculator::Position& new_position, const Velocity& feedrate, const PrintFeatureType feature)
+{
+    push(Record{ .type = Record::Type::PLAN, .feature = feature, .value = feedrate, .position = new_position });
+}
+
+void TimeEstimatePipeline::addTime(const Duration& time)
+{
+    push(Record{ .type = Record::Type::ADD_TIME, .feature = PrintFeatureType::NoneType, .value = time, .position = {} });
+}
+
+void TimeEstimatePipeline::setAcceleration(const Acceleration& acceleration)
+{
+    push(Record{ .type = Record::Type::SET_ACCELERATION, .feature = PrintFeatureType::NoneType, .value = acceleration, .position = {} });
+}
+
+void TimeEstimatePipeline::setMaxXyJerk(const Velocity& jerk)
+{
+    push(Record{ .type = Record::Type::SET_MAX_XY_JERK, .feature = PrintFeatureType::NoneType, .value = jerk, .position = {} });
+}
+
+void TimeEstimatePipeline::reset()
+{
+    waitUntilEstimated();
+    calculator_.reset();
+}
+
+std::vector<Duration> TimeEstimatePipeline::calculate()
+{
+    waitUntilEstimated();
+    return calculator_.calculate();
+}
+
+void TimeEstimatePipeline::push(const Record& record)
+{
+    if (! thread_.joinable())
+    {
+        thread_ = std::thread(&TimeEstimatePipeline::run, this);
+    }
+    records_.push(record);
+}
+
+void TimeEstimatePipeline::waitUntilEstimated() const
+{
+    records_.waitUntilEmpty();
+}
+
+void TimeEstimatePipeline::run()
+{
+    while (true)
+    {
+        Record& record = records_.front();
+        switch (record.type)
+        {
+        case Record::Type::PLAN:
+            calculator_.plan(record.position, record.value, record.feature);
+            break;
+        case Record::Type::ADD_TIME:
+            calculator_.addTime(record.value);
+            break;
+        case Record::Type::SET_ACCELERATION:
+            calculator_.setAcceleration(record.value);
+            break;
+        case Record::Type::SET_MAX_XY_JERK:
+            calculator_.setMaxXyJerk(record.value);
+            break;
+        case Record::Type::STOP:
+            records_.pop();
+            return;
+        }
+        records_.pop();
+    }
+}
+
+} // namespace cura
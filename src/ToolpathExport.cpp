@@ -0,0 +1,172 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "ToolpathExport.h"
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+bool ToolpathExport::open(const std::filesystem::path& directory)
+{
+    close();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        spdlog::error("Failed to create the directory {} for the toolpaths: {}", directory.string(), error.message());
+        return false;
+    }
+    open_ = true;
+    const auto open_column = [this, &directory](std::ofstream& file, const char* filename)
+    {
+        file.open(directory / filename, std::ios::binary | std::ios::trunc);
+        if (! file.is_open())
+        {
+            spdlog::error("Failed to open {} to write the toolpaths to.", (directory / filename).string());
+            open_ = false;
+        }
+    };
+    open_column(layer_index_file_, "layer_index.i32");
+    open_column(layer_z_file_, "layer_z.f32");
+    open_column(layer_thickness_file_, "layer_thickness.f32");
+    open_column(layer_start_file_, "layer_start.f32");
+    open_column(layer_segment_offset_file_, "layer_segment_offset.u64");
+    open_column(points_file_, "points.f32");
+    open_column(line_type_file_, "line_type.u8");
+    open_column(extruder_file_, "extruder.u8");
+    open_column(line_width_file_, "line_width.f32");
+    open_column(line_thickness_file_, "line_thickness.f32");
+    open_column(line_feedrate_file_, "line_feedrate.f32");
+    open_column(line_flow_file_, "line_flow.f32");
+    if (! open_)
+    {
+        close();
+        return false;
+    }
+    segment_count_ = 0;
+    write(layer_segment_offset_file_, std::vector<uint64_t>{ segment_count_ });
+    return true;
+}
+
+bool ToolpathExport::isOpen() const
+{
+    return open_;
+}
+
+void ToolpathExport::close()
+{
+    if (open_)
+    {
+        writeLayer();
+    }
+    for (std::ofstream* file : { &layer_index_file_,
+                                 &layer_z_file_,
+                                 &layer_thickness_file_,
+                                 &layer_start_file_,
+                                 &layer_segment_offset_file_,
+                                 &points_file_,
+                                 &line_type_file_,
+                                 &extruder_file_,
+                                 &line_width_file_,
+                                 &line_thickness_file_,
+                                 &line_feedrate_file_,
+                                 &line_flow_file_ })
+    {
+        if (file->is_open())
+        {
+            file->close();
+        }
+    }
+    open_ = false;
+    layer_begun_ = false;
+}
+
+void ToolpathExport::beginLayer(const LayerIndex layer_nr, const coord_t z, const coord_t thickness, const Point3LL& start)
+{
+    if (! open_)
+    {
+        return;
+    }
+    writeLayer();
+    layer_.index.push_back(static_cast<int32_t>(layer_nr.value));
+    layer_.z.push_back(static_cast<float>(INT2MM(z)));
+    layer_.thickness.push_back(static_cast<float>(INT2MM(thickness)));
+    layer_.start.insert(layer_.start.end(), { static_cast<float>(INT2MM(start.x_)), static_cast<float>(INT2MM(start.y_)), static_cast<float>(INT2MM(start.z_)) });
+    layer_begun_ = true;
+}
+
+void ToolpathExport::addPath(
+    const PrintFeatureType type,
+    const size_t extruder_nr,
+    const std::vector<Point2LL>& points,
+    const coord_t z,
+    const coord_t line_width,
+    const coord_t line_thickness,
+    const Velocity& speed,
+    const double flow)
+{
+    if (! layer_begun_)
+    {
+        return;
+    }
+    for (const Point2LL& point : points)
+    {
+        segments_.points.insert(segments_.points.end(), { static_cast<float>(INT2MM(point.X)), static_cast<float>(INT2MM(point.Y)), static_cast<float>(INT2MM(z)) });
+    }
+    const size_t count = points.size();
+    segments_.line_type.insert(segments_.line_type.end(), count, static_cast<uint8_t>(type));
+    segments_.extruder.insert(segments_.extruder.end(), count, static_cast<uint8_t>(extruder_nr));
+    segments_.line_width.insert(segments_.line_width.end(), count, static_cast<float>(INT2MM(line_width)));
+    segments_.line_thickness.insert(segments_.line_thickness.end(), count, static_cast<float>(INT2MM(line_thickness)));
+    segments_.line_feedrate.insert(segments_.line_feedrate.end(), count, static_cast<float>(speed));
+    segments_.line_flow.insert(segments_.line_flow.end(), count, static_cast<float>(flow));
+}
+
+template<typename T>
+void ToolpathExport::write(std::ofstream& file, const std::vector<T>& values)
+{
+    file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+void ToolpathExport::writeLayer()
+{
+    if (! layer_begun_)
+    {
+        return;
+    }
+    write(layer_index_file_, layer_.index);
+    write(layer_z_file_, layer_.z);
+    write(layer_thickness_file_, layer_.thickness);
+    write(layer_start_file_, layer_.start);
+    write(points_file_, segments_.points);
+    write(line_type_file_, segments_.line_type);
+    write(extruder_file_, segments_.extruder);
+    write(line_width_file_, segments_.line_width);
+    write(line_thickness_file_, segments_.line_thickness);
+    write(line_feedrate_file_, segments_.line_feedrate);
+    write(line_flow_file_, segments_.line_flow);
+    segment_count_ += segments_.line_type.size();
+    write(layer_segment_offset_file_, std::vector<uint64_t>{ segment_count_ });
+    if (! points_file_.good())
+    {
+        spdlog::error("Failed to write the toolpaths of layer {}.", layer_.index.front());
+    }
+
+    // Keep the memory of the columns for the next layer.
+    layer_.index.clear();
+    layer_.z.clear();
+    layer_.thickness.clear();
+    layer_.start.clear();
+    segments_.points.clear();
+    segments_.line_type.clear();
+    segments_.extruder.clear();
+    segments_.line_width.clear();
+    segments_.line_thickness.clear();
+    segments_.line_feedrate.clear();
+    segments_.line_flow.clear();
+    layer_begun_ = false;
+}
+
+} // namespace cura
@@ -3,15 +3,20 @@
 
 #include "TreeModelVolumes.h"
 
+#include <string>
+
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/reverse.hpp>
 #include <spdlog/spdlog.h>
 
+#include "Application.h"
+#include "TreeModelVolumesCache.h"
 #include "TreeSupport.h"
 #include "TreeSupportEnums.h"
 #include "progress/Progress.h"
 #include "sliceDataStorage.h"
+#include "utils/DebugOutput.h"
 #include "utils/ThreadPool.h"
 #include "utils/algorithm.h"
 
@@ -167,6 +172,16 @@ TreeModelVolumes::TreeModelVolumes(
     radius_0_ = config.getRadius(0);
     support_rest_preference_ = config.support_rest_preference;
     simplifier_ = Simplify(min_maximum_resolution, min_maximum_deviation, min_maximum_area_deviation);
+
+    // Volumes with the same input, for instance those of a reslice where only unrelated settings changed, can share their areas. Volumes with the same outlines and
+    // distances to the model, for instance those of a reslice where only the branch settings changed, can still share their collision areas.
+    std::vector<Settings> layer_outline_settings;
+    for (const auto& layer_outline : layer_outlines_)
+    {
+        layer_outline_settings.push_back(layer_outline.first);
+    }
+    collision_caches_ = TreeModelVolumesCache::getInstance().getCollisionCaches(hashCollisionInput(), layer_outline_settings);
+    caches_ = TreeModelVolumesCache::getInstance().get(hashInput(), layer_outline_settings);
 }
 
 void TreeModelVolumes::precalculate(coord_t max_layer)
@@ -230,6 +245,10 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
     std::deque<RadiusLayerPair> relevant_avoidance_radiis_to_model;
     relevant_avoidance_radiis.insert(relevant_avoidance_radiis.end(), radius_until_layer.begin(), radius_until_layer.end());
     relevant_avoidance_radiis_to_model.insert(relevant_avoidance_radiis_to_model.end(), radius_until_layer.begin(), radius_until_layer.end());
+    for (const RadiusLayerPair& key : relevant_avoidance_radiis)
+    {
+        avoidance_radii_.push_back(key.first);
+    }
 
     // Append additional radiis needed for collision.
 
@@ -255,7 +274,7 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
     std::deque<RadiusLayerPair> relevant_hole_collision_radiis;
     for (RadiusLayerPair key : relevant_avoidance_radiis)
     {
-        spdlog::debug("Calculating avoidance of radius {} up to layer {}", key.first, key.second);
+        CURA_LOG_DEBUG("Calculating avoidance of radius {} up to layer {}", key.first, key.second);
         if (key.first < increase_until_radius_ + current_min_xy_dist_delta_)
         {
             relevant_hole_collision_radiis.emplace_back(key);
@@ -275,32 +294,17 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
         t_acc = std::chrono::high_resolution_clock::now();
     }
 
-    // ### Calculate the relevant avoidances in parallel as far as possible
+    // ### Calculate what the avoidances depend on, and plan the avoidances themselves. They are calculated when their radius is first requested.
     {
-        std::future<void> placeable_waiter;
-        std::future<void> avoidance_waiter;
-
         if (support_rests_on_model_)
         {
             calculatePlaceables(relevant_avoidance_radiis_to_model);
         }
-        if (support_rest_preference_ == RestPreference::BUILDPLATE)
-        {
-            calculateAvoidance(relevant_avoidance_radiis);
-        }
-
         calculateWallRestrictions(relevant_avoidance_radiis);
-        if (support_rests_on_model_)
-        {
-            // FIXME: When nowait (parellel-for) is implemented, ensure here the following is calculated: calculatePlaceables.
-            calculateAvoidanceToModel(relevant_avoidance_radiis_to_model);
-            // FIXME: When nowait (parellel-for) is implemented, ensure here the following is calculated: calculateAvoidanceToModel.
-        }
-        if (support_rest_preference_ == RestPreference::BUILDPLATE)
+        for (const RadiusLayerPair& key : relevant_avoidance_radiis)
         {
-            // FIXME: When nowait (parellel-for) is implemented, ensure here the following is calculated: calculateAvoidance.
+            avoidance_demand_[key.first] = AvoidanceDemand{ .max_layer = key.second };
         }
-        // FIXME: When nowait (parellel-for) is implemented, ensure here the following is calculated: calculateWallRestrictions.
     }
     const auto t_avo = std::chrono::high_resolution_clock::now();
 
@@ -313,6 +317,9 @@ void TreeModelVolumes::precalculate(coord_t max_layer)
     }
 
     precalculation_finished_ = true;
+    // The planned avoidances are calculated along with the influence areas, so the progress of precalculating them is reported now.
+    precalculation_progress_ = TREE_PROGRESS_PRECALC_COLL + TREE_PROGRESS_PRECALC_AVO;
+    Progress::messageProgress(Progress::Stage::SUPPORT, precalculation_progress_ * progress_multiplier_ + progress_offset_, TREE_PROGRESS_TOTAL);
     const auto dur_col = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_coll - t_start).count();
     const auto dur_acc = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_acc - t_coll).count();
     const auto dur_avo = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_avo - t_acc).count();
@@ -345,19 +352,21 @@ const Polygons& TreeModelVolumes::getCollision(coord_t radius, LayerIndex layer_
     }
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_avoidance_cache_);
-        result = getArea(collision_cache_, key);
-    }
+    result = collision_caches_->collision_cache_.find(key);
     if (result)
     {
+        cache_counters_->found++;
         return result.value().get();
     }
     if (precalculated_)
     {
         spdlog::warn("Had to calculate collision at radius {} and layer {}, but precalculate was called. Performance may suffer!", key.first, key.second);
     }
-    calculateCollision(key);
+    calculateMissing(
+        [&]()
+        {
+            calculateCollision(key);
+        });
     return getCollision(orig_radius, layer_idx, min_xy_dist);
 }
 
@@ -375,32 +384,36 @@ const Polygons& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerInde
     }
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_collision_cache_holefree_);
-        result = getArea(collision_cache_holefree_, key);
-    }
+    result = caches_->collision_cache_holefree_.find(key);
     if (result)
     {
+        cache_counters_->found++;
         return result.value().get();
     }
     if (precalculated_)
     {
         spdlog::warn("Had to calculate collision holefree at radius {} and layer {}, but precalculate was called. Performance may suffer!", key.first, key.second);
     }
-    calculateCollisionHolefree(key);
+    calculateMissing(
+        [&]()
+        {
+            calculateCollisionHolefree(key);
+        });
     return getCollisionHolefree(orig_radius, layer_idx, min_xy_dist);
 }
 
 const Polygons& TreeModelVolumes::getAccumulatedPlaceable0(LayerIndex layer_idx)
 {
+    if (const auto result = collision_caches_->accumulated_placeables_cache_radius_0_.find(layer_idx))
     {
-        std::lock_guard<std::mutex> critical_section_support_max_layer_nr(*critical_accumulated_placeables_cache_radius_0_);
-        if (accumulated_placeables_cache_radius_0_.count(layer_idx))
-        {
-            return accumulated_placeables_cache_radius_0_[layer_idx];
-        }
+        cache_counters_->found++;
+        return result.value().get();
     }
-    calculateAccumulatedPlaceable0(layer_idx);
+    calculateMissing(
+        [&]()
+        {
+            calculateAccumulatedPlaceable0(layer_idx);
+        });
     return getAccumulatedPlaceable0(layer_idx);
 }
 
@@ -425,21 +438,17 @@ const Polygons& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_
 
     const RadiusLayerPair key{ radius, layer_idx };
 
-    std::unordered_map<RadiusLayerPair, Polygons>* cache_ptr = nullptr;
-    std::mutex* mutex_ptr = nullptr;
+    ShardedCache<RadiusLayerPair, Polygons>* cache_ptr = nullptr;
     switch (type)
     {
     case AvoidanceType::FAST:
-        cache_ptr = to_model ? &avoidance_cache_to_model_ : &avoidance_cache_;
-        mutex_ptr = to_model ? critical_avoidance_cache_to_model_.get() : critical_avoidance_cache_.get();
+        cache_ptr = to_model ? &caches_->avoidance_cache_to_model_ : &caches_->avoidance_cache_;
         break;
     case AvoidanceType::SLOW:
-        cache_ptr = to_model ? &avoidance_cache_to_model_slow_ : &avoidance_cache_slow_;
-        mutex_ptr = to_model ? critical_avoidance_cache_to_model_slow_.get() : critical_avoidance_cache_slow_.get();
+        cache_ptr = to_model ? &caches_->avoidance_cache_to_model_slow_ : &caches_->avoidance_cache_slow_;
         break;
     case AvoidanceType::FAST_SAFE:
-        cache_ptr = to_model ? &avoidance_cache_hole_to_model_ : &avoidance_cache_hole_;
-        mutex_ptr = to_model ? critical_avoidance_cache_holefree_to_model_.get() : critical_avoidance_cache_holefree_.get();
+        cache_ptr = to_model ? &caches_->avoidance_cache_hole_to_model_ : &caches_->avoidance_cache_hole_;
         break;
     case AvoidanceType::COLLISION:
         if (layer_idx <= max_layer_idx_without_blocker_)
@@ -448,8 +457,7 @@ const Polygons& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_
         }
         else
         {
-            cache_ptr = &avoidance_cache_collision_;
-            mutex_ptr = critical_avoidance_cache_collision_.get();
+            cache_ptr = &caches_->avoidance_cache_collision_;
         }
         break;
     default:
@@ -457,14 +465,16 @@ const Polygons& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_
         break;
     }
 
-    {
-        std::lock_guard<std::mutex> critical_section(*mutex_ptr);
-        result = getArea(*cache_ptr, key);
-    }
+    result = cache_ptr->find(key);
     if (result)
     {
+        cache_counters_->found++;
         return result.value().get();
     }
+    if (type != AvoidanceType::COLLISION && calculateAvoidanceOnDemand(key.first, key.second))
+    {
+        return getAvoidance(orig_radius, layer_idx, type, to_model, min_xy_dist);
+    }
     if (precalculated_)
     {
         spdlog::warn(
@@ -474,18 +484,22 @@ const Polygons& TreeModelVolumes::getAvoidance(coord_t radius, LayerIndex layer_
             key.second,
             coord_t(type));
     }
-    if (type == AvoidanceType::COLLISION)
-    {
-        calculateCollisionAvoidance(key);
-    }
-    else if (to_model)
-    {
-        calculateAvoidanceToModel(key);
-    }
-    else
-    {
-        calculateAvoidance(key);
-    }
+    calculateMissing(
+        [&]()
+        {
+            if (type == AvoidanceType::COLLISION)
+            {
+                calculateCollisionAvoidance(key);
+            }
+            else if (to_model)
+            {
+                calculateAvoidanceToModel(key);
+            }
+            else
+            {
+                calculateAvoidance(key);
+            }
+        });
     return getAvoidance(orig_radius, layer_idx, type, to_model, min_xy_dist); // retrive failed and correct result was calculated. Now it has to be retrived.
 }
 
@@ -496,26 +510,28 @@ const Polygons& TreeModelVolumes::getPlaceableAreas(coord_t radius, LayerIndex l
     radius = ceilRadius(radius);
     RadiusLayerPair key{ radius, layer_idx };
 
-    {
-        std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-        result = getArea(placeable_areas_cache_, key);
-    }
+    result = collision_caches_->placeable_areas_cache_.find(key);
     if (result)
     {
+        cache_counters_->found++;
         return result.value().get();
     }
     if (precalculated_)
     {
         spdlog::warn("Had to calculate Placeable Areas at radius {} and layer {}, but precalculate was called. Performance may suffer!", radius, layer_idx);
     }
-    if (radius != 0)
-    {
-        calculatePlaceables(key);
-    }
-    else
-    {
-        getCollision(0, layer_idx, true);
-    }
+    calculateMissing(
+        [&]()
+        {
+            if (radius != 0)
+            {
+                calculatePlaceables(key);
+            }
+            else
+            {
+                getCollision(0, layer_idx, true);
+            }
+        });
     return getPlaceableAreas(orig_radius, layer_idx);
 }
 
@@ -535,13 +551,11 @@ const Polygons& TreeModelVolumes::getWallRestriction(coord_t radius, LayerIndex
     radius = ceilRadius(radius);
     const RadiusLayerPair key{ radius, layer_idx };
 
-    std::unordered_map<RadiusLayerPair, Polygons>* cache_ptr = min_xy_dist ? &wall_restrictions_cache_min_ : &wall_restrictions_cache_;
-    {
-        std::lock_guard<std::mutex> critical_section(min_xy_dist ? *critical_wall_restrictions_cache_min_ : *critical_wall_restrictions_cache_);
-        result = getArea(*cache_ptr, key);
-    }
+    const ShardedCache<RadiusLayerPair, Polygons>& cache = min_xy_dist ? collision_caches_->wall_restrictions_cache_min_ : collision_caches_->wall_restrictions_cache_;
+    result = cache.find(key);
     if (result)
     {
+        cache_counters_->found++;
         return result.value().get();
     }
     if (precalculated_)
@@ -549,7 +563,11 @@ const Polygons& TreeModelVolumes::getWallRestriction(coord_t radius, LayerIndex
         spdlog::warn("Had to calculate Wall restrictions at radius {} and layer {}, but precalculate was called. Performance may suffer!", key.first, key.second);
     }
 
-    calculateWallRestrictions(key);
+    calculateMissing(
+        [&]()
+        {
+            calculateWallRestrictions(key);
+        });
     return getWallRestriction(orig_radius, layer_idx, min_xy_dist); // Retrieve failed and correct result was calculated. Now it has to be retrieved.
 }
 
@@ -563,11 +581,246 @@ coord_t TreeModelVolumes::getRadiusNextCeil(coord_t radius, bool min_xy_dist) co
     return ceilRadius(radius, min_xy_dist) - (min_xy_dist ? 0 : current_min_xy_dist_delta_);
 }
 
+size_t TreeModelVolumes::getAvoidanceFootprint() const
+{
+    size_t footprint = 0;
+    for (const coord_t radius : avoidance_radii_)
+    {
+        footprint += getAvoidanceFootprint(radius, 1, LayerIndex(anti_overhang_.size()) - 1);
+    }
+    return footprint;
+}
+
+size_t TreeModelVolumes::getAvoidanceFootprint(coord_t radius, LayerIndex first_layer, LayerIndex last_layer) const
+{
+    size_t footprint = 0;
+    for (const ShardedCache<RadiusLayerPair, Polygons>* cache : { &caches_->avoidance_cache_,
+                                                                  &caches_->avoidance_cache_slow_,
+                                                                  &caches_->avoidance_cache_to_model_,
+                                                                  &caches_->avoidance_cache_to_model_slow_,
+                                                                  &caches_->avoidance_cache_hole_,
+                                                                  &caches_->avoidance_cache_hole_to_model_ })
+    {
+        for (LayerIndex layer_idx = first_layer; layer_idx <= last_layer; layer_idx++)
+        {
+            const std::optional<std::reference_wrapper<const Polygons>> area = cache->find(RadiusLayerPair(radius, layer_idx));
+            if (area)
+            {
+                footprint += area.value().get().pointCount() * sizeof(Point2LL);
+            }
+        }
+    }
+    return footprint;
+}
+
+size_t TreeModelVolumes::getOnDemandAvoidanceFootprint() const
+{
+    ThreadPool::lock_t lock = Application::getInstance().thread_pool_->get_lock();
+    return on_demand_footprint_;
+}
+
+size_t TreeModelVolumes::evictAvoidance(LayerIndex layer_idx)
+{
+    size_t released = 0;
+    for (ShardedCache<RadiusLayerPair, Polygons>* cache : { &caches_->avoidance_cache_,
+                                                            &caches_->avoidance_cache_slow_,
+                                                            &caches_->avoidance_cache_to_model_,
+                                                            &caches_->avoidance_cache_to_model_slow_,
+                                                            &caches_->avoidance_cache_hole_,
+                                                            &caches_->avoidance_cache_hole_to_model_ })
+    {
+        for (const coord_t radius : avoidance_radii_)
+        {
+            const std::optional<Polygons> area = cache->erase(RadiusLayerPair(radius, layer_idx));
+            if (area)
+            {
+                released += area->pointCount() * sizeof(Point2LL);
+            }
+        }
+    }
+    return released;
+}
+
+bool TreeModelVolumes::calculateAvoidanceOnDemand(coord_t radius, LayerIndex layer_idx)
+{
+    // How many planned avoidances the current thread is calculating, further down its stack.
+    thread_local size_t calculating_on_thread = 0;
+
+    ThreadPool* const thread_pool = Application::getInstance().thread_pool_;
+    std::vector<std::pair<RadiusLayerPair, LayerIndex>> claimed; // The requested layer of each claimed radius, with the layer it was calculated up to before.
+    {
+        ThreadPool::lock_t lock = thread_pool->get_lock();
+        const auto demand = avoidance_demand_.find(radius);
+        if (demand == avoidance_demand_.end() || layer_idx > demand->second.max_layer)
+        {
+            return false;
+        }
+        bool waited = false;
+        while (demand->second.calculating)
+        {
+            if (calculating_on_thread > 0)
+            {
+                // The thread calculating them may be this one, further down the stack, or one that waits for this one. Calculate the requested avoidance as usual instead.
+                return false;
+            }
+            thread_pool->help_while(
+                lock,
+                [&]()
+                {
+                    return demand->second.calculating;
+                });
+            waited = true;
+        }
+        if (layer_idx <= demand->second.calculated_layer)
+        {
+            // Either it was calculated while waiting, or it was calculated before and dropped since.
+            return waited;
+        }
+        demand->second.calculating = true;
+        claimed.emplace_back(RadiusLayerPair(radius, layer_idx), demand->second.calculated_layer);
+        if (const auto next = std::next(demand); next != avoidance_demand_.end() && ! next->second.calculating)
+        {
+            const LayerIndex next_layer = std::min(layer_idx, next->second.max_layer);
+            if (next_layer > next->second.calculated_layer)
+            {
+                next->second.calculating = true;
+                claimed.emplace_back(RadiusLayerPair(next->first, next_layer), next->second.calculated_layer);
+            }
+        }
+    }
+
+    std::deque<RadiusLayerPair> keys;
+    for (const auto& [key, previous_layer] : claimed)
+    {
+        keys.emplace_back(key);
+    }
+    calculating_on_thread++;
+    try
+    {
+        calculateMissing(
+            [&]()
+            {
+                if (support_rest_preference_ == RestPreference::BUILDPLATE)
+                {
+                    calculateAvoidance(keys);
+                }
+                if (support_rests_on_model_)
+                {
+                    calculateAvoidanceToModel(keys);
+                }
+            });
+    }
+    catch (...)
+    {
+        calculating_on_thread--;
+        ThreadPool::lock_t lock = thread_pool->get_lock();
+        for (const auto& [key, previous_layer] : claimed)
+        {
+            avoidance_demand_[key.first].calculating = false;
+        }
+        thread_pool->notify_helpers(lock);
+        throw;
+    }
+    calculating_on_thread--;
+
+    size_t footprint = 0;
+    for (const auto& [key, previous_layer] : claimed)
+    {
+        footprint += getAvoidanceFootprint(key.first, previous_layer + 1, key.second);
+    }
+    ThreadPool::lock_t lock = thread_pool->get_lock();
+    for (const auto& [key, previous_layer] : claimed)
+    {
+        AvoidanceDemand& demand = avoidance_demand_[key.first];
+        demand.calculated_layer = key.second;
+        demand.calculating = false;
+    }
+    on_demand_footprint_ += footprint;
+    thread_pool->notify_helpers(lock);
+    return true;
+}
+
+TreeModelVolumes::CacheStatistics TreeModelVolumes::getCacheStatistics() const
+{
+    const size_t misses = cache_counters_->misses;
+    const size_t found = cache_counters_->found;
+    return CacheStatistics{ .hits = found - std::min(found, misses), .misses = misses, .compute_time = 1e-9 * double(cache_counters_->compute_nanoseconds) };
+}
+
 bool TreeModelVolumes::checkSettingsEquality(const Settings& me, const Settings& other) const
 {
     return TreeSupportSettings(me) == TreeSupportSettings(other);
 }
 
+uint64_t TreeModelVolumes::hashCollisionInput() const
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const auto add = [&hash](const uint64_t value)
+    {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+    const auto add_polygons = [&add](const Polygons& polygons)
+    {
+        add(polygons.size());
+        for (ConstPolygonRef polygon : polygons)
+        {
+            add(polygon.size());
+            for (const Point2LL& point : polygon)
+            {
+                add(point.X);
+                add(point.Y);
+            }
+        }
+    };
+
+    for (const auto& [settings, layers] : layer_outlines_)
+    {
+        add(layers.size());
+        for (const Polygons& layer : layers)
+        {
+            add_polygons(layer);
+        }
+    }
+    add(anti_overhang_.size());
+    for (const Polygons& layer : anti_overhang_)
+    {
+        add_polygons(layer);
+    }
+    add_polygons(machine_border_);
+
+    add(current_outline_idx_);
+    add(current_min_xy_dist_);
+    add(current_min_xy_dist_delta_);
+    add(support_rests_on_model_);
+    return hash;
+}
+
+uint64_t TreeModelVolumes::hashInput() const
+{
+    uint64_t hash = hashCollisionInput();
+    const auto add = [&hash](const uint64_t value)
+    {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+
+    // The tree support settings are compared in full by the cache, but the outlines also depend on some other ones.
+    for (const auto& [settings, layers] : layer_outlines_)
+    {
+        for (const std::string_view key : collision_setting_keys)
+        {
+            add(std::hash<std::string>()(settings.get<std::string>(std::string(key))));
+        }
+    }
+    add(max_move_);
+    add(max_move_slow_);
+    add(min_offset_per_step_);
+    add(increase_until_radius_);
+    add(radius_0_);
+    add(static_cast<uint64_t>(support_rest_preference_));
+    add(max_layer_idx_without_blocker_.value);
+    return hash;
+}
+
 Polygons TreeModelVolumes::extractOutlineFromMesh(const SliceMeshStorage& mesh, LayerIndex layer_idx) const
 {
     // Similar to SliceDataStorage.getLayerOutlines but only for one mesh instead of for all of them.
@@ -592,18 +845,18 @@ Polygons TreeModelVolumes::extractOutlineFromMesh(const SliceMeshStorage& mesh,
     return Simplify(maximum_resolution, maximum_deviation, maximum_area_deviation).polygon(total);
 }
 
-LayerIndex TreeModelVolumes::getMaxCalculatedLayer(coord_t radius, const std::unordered_map<RadiusLayerPair, Polygons>& map) const
+LayerIndex TreeModelVolumes::getMaxCalculatedLayer(coord_t radius, const ShardedCache<RadiusLayerPair, Polygons>& map) const
 {
     LayerIndex max_layer = -1;
 
     // the placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
     const RadiusLayerPair key_layer_1(radius, 1);
-    if (getArea(map, key_layer_1))
+    if (map.contains(key_layer_1))
     {
         max_layer = 1;
     }
 
-    while (map.count(RadiusLayerPair(radius, max_layer + 1)))
+    while (map.contains(RadiusLayerPair(radius, max_layer + 1)))
     {
         max_layer++;
     }
@@ -639,11 +892,7 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                 // be added at request time. Avoiding this would require saving each collision for each outline_idx separately,
                 //   and later for each avoidance... But avoidance calculation has to be for the whole scene and can NOT be done for each outline_idx separately and combined later.
                 // So avoiding this inaccuracy seems infeasible as it would require 2x the avoidance calculations => 0.5x the performance.
-                coord_t min_layer_bottom;
-                {
-                    std::lock_guard<std::mutex> critical_section(*critical_collision_cache_);
-                    min_layer_bottom = getMaxCalculatedLayer(radius, collision_cache_) - z_distance_bottom_layers;
-                }
+                coord_t min_layer_bottom = getMaxCalculatedLayer(radius, collision_caches_->collision_cache_) - z_distance_bottom_layers;
 
                 if (min_layer_bottom < 0)
                 {
@@ -754,16 +1003,10 @@ void TreeModelVolumes::calculateCollision(const std::deque<RadiusLayerPair>& key
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_collision_cache_);
-                collision_cache_.insert(data_outer.begin(), data_outer.end());
-            }
+            collision_caches_->collision_cache_.insert(std::move(data_outer));
             if (radius == 0)
             {
-                {
-                    std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                    placeable_areas_cache_.insert(data_placeable_outer.begin(), data_placeable_outer.end());
-                }
+                collision_caches_->placeable_areas_cache_.insert(std::move(data_placeable_outer));
             }
         });
 }
@@ -786,6 +1029,10 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::deque<RadiusLayerPa
             {
                 // Logically increase the collision by increase_until_radius
                 const coord_t radius = key.first;
+                if (caches_->collision_cache_holefree_.contains(RadiusLayerPair(radius, layer_idx)))
+                { // Another request already calculated it.
+                    continue;
+                }
                 const coord_t increase_radius_ceil = ceilRadius(increase_until_radius_, false) - ceilRadius(radius, true);
                 Polygons col = getCollision(increase_until_radius_, layer_idx, false).offset(EPSILON - increase_radius_ceil, ClipperLib::jtRound).unionPolygons();
                 // ^^^ That last 'unionPolygons' is important as otherwise holes(in form of lines that will increase to holes in a later step) can get unioned onto the area.
@@ -793,10 +1040,7 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::deque<RadiusLayerPa
                 data[RadiusLayerPair(radius, layer_idx)] = col;
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_collision_cache_holefree_);
-                collision_cache_holefree_.insert(data.begin(), data.end());
-            }
+            caches_->collision_cache_holefree_.insert(std::move(data));
         });
 }
 
@@ -805,14 +1049,11 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
     LayerIndex start_layer = -1;
 
     // the placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
+    while (collision_caches_->accumulated_placeables_cache_radius_0_.contains(start_layer + 1))
     {
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
-        while (accumulated_placeables_cache_radius_0_.count(start_layer + 1))
-        {
-            start_layer++;
-        }
-        start_layer = std::max(LayerIndex{ start_layer + 1 }, LayerIndex{ 1 });
+        start_layer++;
     }
+    start_layer = std::max(LayerIndex{ start_layer + 1 }, LayerIndex{ 1 });
     if (start_layer > max_layer)
     {
         spdlog::debug("Requested calculation for value already calculated ?");
@@ -828,7 +1069,6 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
     for (LayerIndex layer = start_layer; layer <= max_layer; layer++)
     {
         accumulated_placeable_0 = accumulated_placeable_0.unionPolygons(getPlaceableAreas(0, layer).offset(FUDGE_LENGTH)).difference(anti_overhang_[layer]);
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
         accumulated_placeable_0 = simplifier_.polygon(accumulated_placeable_0);
         data[layer] = std::pair(layer, accumulated_placeable_0);
     }
@@ -839,10 +1079,7 @@ void TreeModelVolumes::calculateAccumulatedPlaceable0(const LayerIndex max_layer
         {
             data[layer_idx].second = data[layer_idx].second.offset(-(current_min_xy_dist_ + current_min_xy_dist_delta_));
         });
-    {
-        std::lock_guard<std::mutex> critical_section(*critical_accumulated_placeables_cache_radius_0_);
-        accumulated_placeables_cache_radius_0_.insert(data.begin(), data.end());
-    }
+    collision_caches_->accumulated_placeables_cache_radius_0_.insert(std::move(data));
 }
 
 
@@ -856,11 +1093,7 @@ void TreeModelVolumes::calculateCollisionAvoidance(const std::deque<RadiusLayerP
             const coord_t radius = keys[key_idx].first;
             const LayerIndex max_required_layer = keys[key_idx].second;
             const coord_t max_step_move = std::max(1.9 * radius, current_min_xy_dist_ * 1.9);
-            LayerIndex start_layer = 0;
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_avoidance_cache_collision_);
-                start_layer = 1 + std::max(getMaxCalculatedLayer(radius, avoidance_cache_collision_), max_layer_idx_without_blocker_);
-            }
+            LayerIndex start_layer = 1 + std::max(getMaxCalculatedLayer(radius, caches_->avoidance_cache_collision_), max_layer_idx_without_blocker_);
 
             if (start_layer > max_required_layer)
             {
@@ -889,10 +1122,7 @@ void TreeModelVolumes::calculateCollisionAvoidance(const std::deque<RadiusLayerP
                 data[layer] = std::pair<RadiusLayerPair, Polygons>(key, latest_avoidance);
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_avoidance_cache_collision_);
-                avoidance_cache_collision_.insert(data.begin(), data.end());
-            }
+            caches_->avoidance_cache_collision_.insert(std::move(data));
         });
 }
 
@@ -945,11 +1175,8 @@ void TreeModelVolumes::calculateAvoidance(const std::deque<RadiusLayerPair>& key
             const coord_t max_step_move = std::max(1.9 * radius, current_min_xy_dist_ * 1.9);
             RadiusLayerPair key(radius, 0);
             Polygons latest_avoidance;
-            LayerIndex start_layer;
-            {
-                std::lock_guard<std::mutex> critical_section(*(slow ? critical_avoidance_cache_slow_ : holefree ? critical_avoidance_cache_holefree_ : critical_avoidance_cache_));
-                start_layer = 1 + getMaxCalculatedLayer(radius, slow ? avoidance_cache_slow_ : holefree ? avoidance_cache_hole_ : avoidance_cache_);
-            }
+            ShardedCache<RadiusLayerPair, Polygons>& cache = slow ? caches_->avoidance_cache_slow_ : holefree ? caches_->avoidance_cache_hole_ : caches_->avoidance_cache_;
+            LayerIndex start_layer = 1 + getMaxCalculatedLayer(radius, cache);
             if (start_layer > max_required_layer)
             {
                 spdlog::debug("Requested calculation for value already calculated ?");
@@ -995,10 +1222,7 @@ void TreeModelVolumes::calculateAvoidance(const std::deque<RadiusLayerPair>& key
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*(slow ? critical_avoidance_cache_slow_ : holefree ? critical_avoidance_cache_holefree_ : critical_avoidance_cache_));
-                (slow ? avoidance_cache_slow_ : holefree ? avoidance_cache_hole_ : avoidance_cache_).insert(data.begin(), data.end());
-            }
+            cache.insert(std::move(data));
         });
 }
 
@@ -1016,11 +1240,7 @@ void TreeModelVolumes::calculatePlaceables(const std::deque<RadiusLayerPair>& ke
             std::vector<std::pair<RadiusLayerPair, Polygons>> data(max_required_layer + 1, std::pair<RadiusLayerPair, Polygons>(RadiusLayerPair(radius, -1), Polygons()));
             RadiusLayerPair key(radius, 0);
 
-            LayerIndex start_layer;
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                start_layer = 1 + getMaxCalculatedLayer(radius, placeable_areas_cache_);
-            }
+            LayerIndex start_layer = 1 + getMaxCalculatedLayer(radius, collision_caches_->placeable_areas_cache_);
             if (start_layer > max_required_layer)
             {
                 spdlog::debug("Requested calculation for value already calculated ?");
@@ -1052,10 +1272,7 @@ void TreeModelVolumes::calculatePlaceables(const std::deque<RadiusLayerPair>& ke
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_placeable_areas_cache_);
-                placeable_areas_cache_.insert(data.begin(), data.end());
-            }
+            collision_caches_->placeable_areas_cache_.insert(std::move(data));
         });
 }
 
@@ -1090,15 +1307,8 @@ void TreeModelVolumes::calculateAvoidanceToModel(const std::deque<RadiusLayerPai
             std::vector<std::pair<RadiusLayerPair, Polygons>> data(max_required_layer + 1, std::pair<RadiusLayerPair, Polygons>(RadiusLayerPair(radius, -1), Polygons()));
             RadiusLayerPair key(radius, 0);
 
-            LayerIndex start_layer;
-
-            {
-                std::lock_guard<std::mutex> critical_section(
-                    *(slow       ? critical_avoidance_cache_to_model_slow_
-                      : holefree ? critical_avoidance_cache_holefree_to_model_
-                                 : critical_avoidance_cache_to_model_));
-                start_layer = 1 + getMaxCalculatedLayer(radius, slow ? avoidance_cache_to_model_slow_ : holefree ? avoidance_cache_hole_to_model_ : avoidance_cache_to_model_);
-            }
+            ShardedCache<RadiusLayerPair, Polygons>& cache = slow ? caches_->avoidance_cache_to_model_slow_ : holefree ? caches_->avoidance_cache_hole_to_model_ : caches_->avoidance_cache_to_model_;
+            LayerIndex start_layer = 1 + getMaxCalculatedLayer(radius, cache);
             start_layer = std::max(start_layer, LayerIndex(1));
             if (start_layer > max_required_layer)
             {
@@ -1144,13 +1354,7 @@ void TreeModelVolumes::calculateAvoidanceToModel(const std::deque<RadiusLayerPai
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(
-                    *(slow       ? critical_avoidance_cache_to_model_slow_
-                      : holefree ? critical_avoidance_cache_holefree_to_model_
-                                 : critical_avoidance_cache_to_model_));
-                (slow ? avoidance_cache_to_model_slow_ : holefree ? avoidance_cache_hole_to_model_ : avoidance_cache_to_model_).insert(data.begin(), data.end());
-            }
+            cache.insert(std::move(data));
         });
 }
 
@@ -1201,15 +1405,10 @@ void TreeModelVolumes::calculateWallRestrictions(const std::deque<RadiusLayerPai
         {
             const coord_t radius = keys[key_idx].first;
             RadiusLayerPair key(radius, 0);
-            coord_t min_layer_bottom;
+            coord_t min_layer_bottom = getMaxCalculatedLayer(radius, collision_caches_->wall_restrictions_cache_);
             std::unordered_map<RadiusLayerPair, Polygons> data;
             std::unordered_map<RadiusLayerPair, Polygons> data_min;
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_);
-                min_layer_bottom = getMaxCalculatedLayer(radius, wall_restrictions_cache_);
-            }
-
             if (min_layer_bottom < 1)
             {
                 min_layer_bottom = 1;
@@ -1228,15 +1427,8 @@ void TreeModelVolumes::calculateWallRestrictions(const std::deque<RadiusLayerPai
                 }
             }
 
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_);
-                wall_restrictions_cache_.insert(data.begin(), data.end());
-            }
-
-            {
-                std::lock_guard<std::mutex> critical_section(*critical_wall_restrictions_cache_min_);
-                wall_restrictions_cache_min_.insert(data_min.begin(), data_min.end());
-            }
+            collision_caches_->wall_restrictions_cache_.insert(std::move(data));
+            collision_caches_->wall_restrictions_cache_min_.insert(std::move(data_min));
         });
 }
 
@@ -1270,20 +1462,6 @@ coord_t TreeModelVolumes::ceilRadius(coord_t radius) const
     return exponential_result;
 }
 
-template<typename KEY>
-const std::optional<std::reference_wrapper<const Polygons>> TreeModelVolumes::getArea(const std::unordered_map<KEY, Polygons>& cache, const KEY key) const
-{
-    const auto it = cache.find(key);
-    if (it != cache.end())
-    {
-        return std::optional<std::reference_wrapper<const Polygons>>{ it->second };
-    }
-    else
-    {
-        return std::optional<std::reference_wrapper<const Polygons>>();
-    }
-}
-
 Polygons TreeModelVolumes::calculateMachineBorderCollision(const Polygons&& machine_border)
 {
     Polygons machine_volume_border = machine_border.offset(MM2INT(1000.0)); // Put a border of 1 meter around the print volume so that we don't collide.
@@ -0,0 +1,162 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "TreeModelVolumesCache.h"
+
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "communication/Communication.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * Whether the current communication channel may ask for another slice in this process, i.e. whether it is worth keeping
+ * entries after a slice.
+ */
+bool isPersistent()
+{
+    const Communication* communication = Application::getInstance().communication_;
+    return communication != nullptr && communication->isPersistent();
+}
+
+/*!
+ * Copy the values of all settings of a container into a new container, so that it doesn't depend on its parents or the
+ * extruders of the scene anymore.
+ */
+Settings detach(const Settings& settings)
+{
+    Settings detached;
+    for (const auto& [key, value] : settings.getFlattendSettings())
+    {
+        detached.add(key, value);
+    }
+    return detached;
+}
+
+} // namespace
+
+TreeModelVolumesCache& TreeModelVolumesCache::getInstance()
+{
+    static TreeModelVolumesCache instance;
+    return instance;
+}
+
+std::shared_ptr<TreeModelVolumes::Caches> TreeModelVolumesCache::get(const uint64_t key, const std::vector<Settings>& settings)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = entries_.find(key);
+    if (entry != entries_.end() && matches(entry->second, settings))
+    {
+        return entry->second.caches;
+    }
+    const auto previous_entry = previous_entries_.find(key);
+    if (previous_entry != previous_entries_.end() && matches(previous_entry->second, settings))
+    { // Reused in this slice, so keep it for the next one.
+        spdlog::info("Reusing the tree support collision and avoidance areas from an earlier slice.");
+        std::shared_ptr<TreeModelVolumes::Caches> caches = previous_entry->second.caches;
+        entries_.insert_or_assign(key, std::move(previous_entry->second));
+        previous_entries_.erase(previous_entry);
+        return caches;
+    }
+
+    Entry new_entry{ {}, std::make_shared<TreeModelVolumes::Caches>() };
+    for (const Settings& group_settings : settings)
+    {
+        TreeSupportSettings& config = new_entry.settings.emplace_back(group_settings);
+        config.settings = detach(group_settings);
+    }
+    std::shared_ptr<TreeModelVolumes::Caches> caches = new_entry.caches;
+    entries_.insert_or_assign(key, std::move(new_entry));
+    return caches;
+}
+
+std::shared_ptr<TreeModelVolumes::CollisionCaches> TreeModelVolumesCache::getCollisionCaches(const uint64_t key, const std::vector<Settings>& settings)
+{
+    std::vector<std::vector<std::string>> collision_settings = collisionSettings(settings);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = collision_entries_.find(key);
+    if (entry != collision_entries_.end() && entry->second.settings == collision_settings)
+    {
+        return entry->second.caches;
+    }
+    const auto previous_entry = previous_collision_entries_.find(key);
+    if (previous_entry != previous_collision_entries_.end() && previous_entry->second.settings == collision_settings)
+    { // Reused in this slice, so keep it for the next one.
+        spdlog::info("Reusing the tree support collision areas from an earlier slice.");
+        std::shared_ptr<TreeModelVolumes::CollisionCaches> caches = previous_entry->second.caches;
+        collision_entries_.insert_or_assign(key, std::move(previous_entry->second));
+        previous_collision_entries_.erase(previous_entry);
+        return caches;
+    }
+
+    std::shared_ptr<TreeModelVolumes::CollisionCaches> caches = std::make_shared<TreeModelVolumes::CollisionCaches>();
+    collision_entries_.insert_or_assign(key, CollisionEntry{ std::move(collision_settings), caches });
+    return caches;
+}
+
+void TreeModelVolumesCache::startSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_ = isPersistent() ? std::move(entries_) : decltype(entries_)();
+    entries_.clear();
+    previous_collision_entries_ = isPersistent() ? std::move(collision_entries_) : decltype(collision_entries_)();
+    collision_entries_.clear();
+}
+
+void TreeModelVolumesCache::finishSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_.clear();
+    previous_collision_entries_.clear();
+    if (! isPersistent())
+    {
+        entries_.clear();
+        collision_entries_.clear();
+    }
+}
+
+void TreeModelVolumesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    previous_entries_.clear();
+    collision_entries_.clear();
+    previous_collision_entries_.clear();
+}
+
+bool TreeModelVolumesCache::matches(const Entry& entry, const std::vector<Settings>& settings)
+{
+    if (entry.settings.size() != settings.size())
+    {
+        return false;
+    }
+    for (size_t group_idx = 0; group_idx < settings.size(); group_idx++)
+    {
+        if (! (TreeSupportSettings(settings[group_idx]) == entry.settings[group_idx]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::vector<std::string>> TreeModelVolumesCache::collisionSettings(const std::vector<Settings>& settings)
+{
+    std::vector<std::vector<std::string>> values;
+    for (const Settings& group_settings : settings)
+    {
+        std::vector<std::string>& group_values = values.emplace_back();
+        for (const std::string_view key : TreeModelVolumes::collision_setting_keys)
+        {
+            group_values.push_back(group_settings.get<std::string>(std::string(key)));
+        }
+    }
+    return values;
+}
+
+} // namespace cura
@@ -3,18 +3,24 @@
 
 #include "TreeSupport.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <optional>
 #include <stdio.h>
 #include <string>
 #include <thread>
 
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #include <range/v3/view/drop_last.hpp>
 #include <range/v3/view/enumerate.hpp>
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/reverse.hpp>
 #include <scripta/logger.h>
+#include <spdlog/details/os.h>
 #include <spdlog/spdlog.h>
 
 #include "Application.h" //To get settings.
@@ -25,6 +31,9 @@
 #include "progress/Progress.h"
 #include "settings/EnumSettings.h"
 #include "support.h" //For precomputeCrossInfillTree
+#include "utils/AABB.h"
+#include "utils/Cancellation.h"
+#include "utils/DebugOutput.h"
 #include "utils/Simplify.h"
 #include "utils/ThreadPool.h"
 #include "utils/algorithm.h"
@@ -122,7 +131,8 @@ void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
 
         spdlog::info("Processing support tree mesh group {} of {} containing {} meshes.", counter + 1, grouped_meshes.size(), grouped_meshes[counter].second.size());
         std::vector<Polygons> exclude(storage.support.supportLayers.size());
-        auto t_start = std::chrono::high_resolution_clock::now();
+        time_keeper_ = TimeKeeper();
+        element_counts_.clear();
 
         // get all already existing support areas and exclude them
         cura::parallel_for<coord_t>(
@@ -154,60 +164,63 @@ void TreeSupport::generateSupportAreas(SliceDataStorage& storage)
             progress_offset,
             exclude);
 
-        // ### Precalculate avoidances, collision etc.
-        const LayerIndex max_required_layer = precalculate(storage, processing.second);
-        if (max_required_layer < 0)
+        const auto delete_elements = [&move_bounds]()
         {
-            spdlog::info("Support tree mesh group {} does not have any overhang. Skipping tree support generation for this support tree mesh group.", counter + 1);
-            continue; // If there is no overhang to support, skip these meshes
-        }
-        const auto t_precalc = std::chrono::high_resolution_clock::now();
+            for (auto& layer : move_bounds)
+            {
+                for (auto elem : layer)
+                {
+                    delete elem->area_;
+                    delete elem;
+                }
+            }
+        };
 
-        // ### Place tips of the support tree
-        for (size_t mesh_idx : processing.second)
+        try
         {
-            generateInitialAreas(*storage.meshes[mesh_idx], move_bounds, storage);
-        }
-        const auto t_gen = std::chrono::high_resolution_clock::now();
-
-        // ### Propagate the influence areas downwards.
-        createLayerPathing(move_bounds);
-        const auto t_path = std::chrono::high_resolution_clock::now();
-
-        // ### Set a point in each influence area
-        createNodesFromArea(move_bounds);
-        const auto t_place = std::chrono::high_resolution_clock::now();
+            // ### Precalculate avoidances, collision etc.
+            const LayerIndex max_required_layer = precalculate(storage, processing.second);
+            if (max_required_layer < 0)
+            {
+                spdlog::info("Support tree mesh group {} does not have any overhang. Skipping tree support generation for this support tree mesh group.", counter + 1);
+                continue; // If there is no overhang to support, skip these meshes
+            }
+            time_keeper_.registerTime("Precalculate", 0.0);
+            Cancellation::throwIfRequested();
 
-        // ### draw these points as circles
-        drawAreas(move_bounds, storage);
+            // ### Place tips of the support tree
+            for (size_t mesh_idx : processing.second)
+            {
+                generateInitialAreas(*storage.meshes[mesh_idx], move_bounds, storage);
+            }
+            time_keeper_.registerTime("Generate tips", 0.0);
+            countElements("Tips", move_bounds);
+            Cancellation::throwIfRequested();
 
-        const auto t_draw = std::chrono::high_resolution_clock::now();
-        const auto dur_pre_gen = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_precalc - t_start).count();
-        const auto dur_gen = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_gen - t_precalc).count();
-        const auto dur_path = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_path - t_gen).count();
-        const auto dur_place = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_place - t_path).count();
-        const auto dur_draw = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_draw - t_place).count();
-        const auto dur_total = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_draw - t_start).count();
-        spdlog::info(
-            "Total time used creating Tree support for the currently grouped meshes: {} ms. Different subtasks:\n"
-            "Calculating Avoidance: {} ms Creating inital influence areas: {} ms Influence area creation: {} ms Placement of Points in InfluenceAreas: {} ms Drawing result as "
-            "support {} ms",
-            dur_total,
-            dur_pre_gen,
-            dur_gen,
-            dur_path,
-            dur_place,
-            dur_draw);
+            // ### Propagate the influence areas downwards.
+            createLayerPathing(move_bounds);
+            time_keeper_.registerTime("Layer pathing", 0.0);
+            countElements("Influence areas", move_bounds);
+            Cancellation::throwIfRequested();
 
+            // ### Set a point in each influence area
+            createNodesFromArea(move_bounds);
+            time_keeper_.registerTime("Nodes from areas", 0.0);
+            countElements("Nodes", move_bounds);
+            Cancellation::throwIfRequested();
 
-        for (auto& layer : move_bounds)
+            // ### draw these points as circles
+            drawAreas(move_bounds, storage);
+        }
+        catch (const SliceCancelled&)
         {
-            for (auto elem : layer)
-            {
-                delete elem->area_;
-                delete elem;
-            }
+            delete_elements(); // The elements are owned by move_bounds, which is only cleaned up at the end of the group.
+            throw;
         }
+
+        reportStatistics(counter, move_bounds.size());
+
+        delete_elements();
     }
 
     storage.support.generated = true;
@@ -276,14 +289,57 @@ void TreeSupport::mergeHelper(
     {
         return config.getRadius(distance_to_top, buildplate_radius_increases);
     };
+
+    // As every area has to be checked for overlaps with other areas, the bounding boxes of the already processed elements are kept in an R-tree, so that each element is only
+    // checked against those whose bounding box it hits. The R-tree is updated as elements are merged or added.
+    using ReducedIndexPoint = boost::geometry::model::point<coord_t, 2, boost::geometry::cs::cartesian>;
+    using ReducedIndexBox = boost::geometry::model::box<ReducedIndexPoint>;
+    using ReducedIndexValue = std::pair<ReducedIndexBox, const TreeSupportElement*>;
+    using ReducedIndex = boost::geometry::index::rtree<ReducedIndexValue, boost::geometry::index::rstar<16>>;
+    ReducedIndex reduced_index;
+    const auto indexValue = [](const TreeSupportElement& element, const AABB& aabb)
+    {
+        return ReducedIndexValue(ReducedIndexBox(ReducedIndexPoint(aabb.min_.X, aabb.min_.Y), ReducedIndexPoint(aabb.max_.X, aabb.max_.Y)), &element);
+    };
+    const auto addToIndex = [&](const TreeSupportElement& element, const AABB& aabb)
+    {
+        if (aabb.min_.X <= aabb.max_.X && aabb.min_.Y <= aabb.max_.Y) // Empty areas don't hit anything.
+        {
+            reduced_index.insert(indexValue(element, aabb));
+        }
+    };
+    {
+        std::vector<ReducedIndexValue> initial_values;
+        for (const auto& [element, aabb] : reduced_aabb)
+        {
+            if (aabb.min_.X <= aabb.max_.X && aabb.min_.Y <= aabb.max_.Y)
+            {
+                initial_values.push_back(indexValue(element, aabb));
+            }
+        }
+        reduced_index = ReducedIndex(initial_values); // Bulk loading builds a better tree than inserting one by one.
+    }
+
+    std::vector<ReducedIndexValue> candidates;
     for (auto& influence : input_aabb)
     {
         bool merged = false;
         AABB influence_aabb = influence.second;
-        for (const auto& reduced_check : reduced_aabb)
+
+        // The candidates are checked in the same order as the elements in reduced_aabb, as which merge happens first depends on it.
+        candidates.clear();
+        reduced_index.query(boost::geometry::index::intersects(indexValue(influence.first, influence_aabb).first), std::back_inserter(candidates));
+        std::sort(
+            candidates.begin(),
+            candidates.end(),
+            [](const ReducedIndexValue& a, const ReducedIndexValue& b)
+            {
+                return *a.second < *b.second;
+            });
+
+        for (const ReducedIndexValue& candidate : candidates)
         {
-            // As every area has to be checked for overlaps with other areas, some fast heuristic is needed to abort early if clearly possible
-            // This is so performance critical that using a map lookup instead of the direct access of the cached AABBs can have a surprisingly large performance impact
+            const auto& reduced_check = *reduced_aabb.find(*candidate.second);
             AABB aabb = reduced_check.second;
             if (aabb.hit(influence_aabb))
             {
@@ -479,8 +535,13 @@ void TreeSupport::mergeHelper(
                     // negative area.).
                     //     And if this area disappears because of rounding errors, the only downside is that it can not merge again on this layer.
 
+                    reduced_index.remove(candidate);
                     reduced_aabb.erase(reduced_check.first); // This invalidates reduced_check.
-                    reduced_aabb.emplace(key, AABB(merge));
+                    const auto [merged_it, inserted] = reduced_aabb.emplace(key, AABB(merge));
+                    if (inserted)
+                    {
+                        addToIndex(merged_it->first, merged_it->second);
+                    }
 
                     merged = true;
                     break;
@@ -490,7 +551,18 @@ void TreeSupport::mergeHelper(
 
         if (! merged)
         {
-            reduced_aabb[influence.first] = influence_aabb;
+            const auto existing = reduced_aabb.find(influence.first);
+            if (existing != reduced_aabb.end())
+            {
+                reduced_index.remove(indexValue(existing->first, existing->second));
+                existing->second = influence_aabb;
+                addToIndex(existing->first, existing->second);
+            }
+            else
+            {
+                const auto added = reduced_aabb.emplace(influence.first, influence_aabb).first;
+                addToIndex(added->first, added->second);
+            }
         }
     }
 }
@@ -645,8 +717,14 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
     Polygons& to_model_data,
     Polygons& increased,
     const coord_t overspeed,
-    const bool mergelayer)
+    const bool mergelayer,
+    ClippingTiles& clipping_tiles)
 {
+    const auto clip = [&clipping_tiles](const Polygons& area, const Polygons& clipping_area)
+    {
+        return area.difference(getClippingTile(area, clipping_area, clipping_tiles));
+    };
+
     TreeSupportElement current_elem(parent); // Also increases DTT by one.
     Polygons check_layer_data;
     if (settings.increase_radius_)
@@ -686,18 +764,18 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
 
     if ((mergelayer || current_elem.to_buildplate_) && config.support_rest_preference == RestPreference::BUILDPLATE)
     {
-        to_bp_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
+        to_bp_data = TreeSupportUtils::safeUnion(clip(increased, volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
         if (! current_elem.to_buildplate_ && to_bp_data.area() > 1) // mostly happening in the tip, but with merges one should check every time, just to be sure.
         {
             current_elem.to_buildplate_ = true; // sometimes nodes that can reach the buildplate are marked as cant reach, tainting subtrees. This corrects it.
-            spdlog::debug("Corrected taint leading to a wrong to model value on layer {} targeting {} with radius {}", layer_idx - 1, current_elem.target_height_, radius);
+            CURA_LOG_DEBUG("Corrected taint leading to a wrong to model value on layer {} targeting {} with radius {}", layer_idx - 1, current_elem.target_height_, radius);
         }
     }
     if (config.support_rests_on_model)
     {
         if (mergelayer || current_elem.to_model_gracious_)
         {
-            to_model_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, true, settings.use_min_distance_)));
+            to_model_data = TreeSupportUtils::safeUnion(clip(increased, volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, true, settings.use_min_distance_)));
         }
 
         if (! current_elem.to_model_gracious_)
@@ -705,12 +783,12 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
             if (mergelayer && to_model_data.area() >= 1)
             {
                 current_elem.to_model_gracious_ = true;
-                spdlog::debug("Corrected taint leading to a wrong non gracious value on layer {} targeting {} with radius {}", layer_idx - 1, current_elem.target_height_, radius);
+                CURA_LOG_DEBUG("Corrected taint leading to a wrong non gracious value on layer {} targeting {} with radius {}", layer_idx - 1, current_elem.target_height_, radius);
             }
             else
             {
                 to_model_data
-                    = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, AvoidanceType::COLLISION, true, settings.use_min_distance_)));
+                    = TreeSupportUtils::safeUnion(clip(increased, volumes_.getAvoidance(radius, layer_idx - 1, AvoidanceType::COLLISION, true, settings.use_min_distance_)));
             }
         }
     }
@@ -730,13 +808,14 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
             if (current_elem.to_buildplate_)
             {
                 // Regular union as output will not be used later => this area should always be a subset of the safeUnion one.
-                to_bp_data_2 = increased.difference(volumes_.getAvoidance(next_radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)).unionPolygons();
+                to_bp_data_2 = clip(increased, volumes_.getAvoidance(next_radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)).unionPolygons();
             }
             Polygons to_model_data_2;
             if (config.support_rests_on_model && ! current_elem.to_buildplate_)
             {
-                to_model_data_2 = increased
-                                      .difference(volumes_.getAvoidance(
+                to_model_data_2 = clip(
+                                      increased,
+                                      volumes_.getAvoidance(
                                           next_radius,
                                           layer_idx - 1,
                                           current_elem.to_model_gracious_ ? settings.type_ : AvoidanceType::COLLISION,
@@ -778,7 +857,7 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
 
                 if (current_elem.to_buildplate_)
                 {
-                    new_to_bp_data = to_bp_data.difference(volumes_.getCollision(config.getRadius(current_elem), layer_idx - 1, current_elem.use_min_xy_dist_));
+                    new_to_bp_data = clip(to_bp_data, volumes_.getCollision(config.getRadius(current_elem), layer_idx - 1, current_elem.use_min_xy_dist_));
                     if (new_to_bp_data.area() > EPSILON)
                     {
                         to_bp_data = new_to_bp_data;
@@ -786,7 +865,7 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
                 }
                 if (config.support_rests_on_model && (! current_elem.to_buildplate_ || mergelayer))
                 {
-                    new_to_model_data = to_model_data.difference(volumes_.getCollision(config.getRadius(current_elem), layer_idx - 1, current_elem.use_min_xy_dist_));
+                    new_to_model_data = clip(to_model_data, volumes_.getCollision(config.getRadius(current_elem), layer_idx - 1, current_elem.use_min_xy_dist_));
                     if (new_to_model_data.area() > EPSILON)
                     {
                         to_model_data = new_to_model_data;
@@ -826,11 +905,12 @@ std::optional<TreeSupportElement> TreeSupport::increaseSingleArea(
         {
             if (current_elem.to_buildplate_)
             {
-                to_bp_data = TreeSupportUtils::safeUnion(increased.difference(volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
+                to_bp_data = TreeSupportUtils::safeUnion(clip(increased, volumes_.getAvoidance(radius, layer_idx - 1, settings.type_, false, settings.use_min_distance_)));
             }
             if (config.support_rests_on_model && (! current_elem.to_buildplate_ || mergelayer))
             {
-                to_model_data = TreeSupportUtils::safeUnion(increased.difference(
+                to_model_data = TreeSupportUtils::safeUnion(clip(
+                    increased,
                     volumes_.getAvoidance(radius, layer_idx - 1, current_elem.to_model_gracious_ ? settings.type_ : AvoidanceType::COLLISION, true, settings.use_min_distance_)));
             }
             check_layer_data = current_elem.to_buildplate_ ? to_bp_data : to_model_data;
@@ -900,6 +980,7 @@ void TreeSupport::increaseAreas(
     const bool mergelayer)
 {
     std::mutex critical_sections;
+    ClippingTiles clipping_tiles; // The avoidance and collision of this layer are the same for all elements with the same ceiled radius, so their tiles are shared.
     cura::parallel_for<size_t>(
         0,
         last_layer.size(),
@@ -1156,7 +1237,17 @@ void TreeSupport::increaseAreas(
                     // it still actually has an area that can be increased
                     Polygons lines_offset = TreeSupportUtils::toPolylines(*parent->area_).offsetPolyLine(EPSILON);
                     Polygons base_error_area = parent->area_->unionPolygons(lines_offset);
-                    result = increaseSingleArea(settings, layer_idx, parent, base_error_area, to_bp_data, to_model_data, inc_wo_collision, settings.increase_speed_, mergelayer);
+                    result = increaseSingleArea(
+                        settings,
+                        layer_idx,
+                        parent,
+                        base_error_area,
+                        to_bp_data,
+                        to_model_data,
+                        inc_wo_collision,
+                        settings.increase_speed_,
+                        mergelayer,
+                        clipping_tiles);
 
                     if (fast_speed < settings.increase_speed_)
                     {
@@ -1200,7 +1291,8 @@ void TreeSupport::increaseAreas(
                         to_model_data,
                         inc_wo_collision,
                         std::max(settings.increase_speed_ - fast_speed, coord_t(0)),
-                        mergelayer);
+                        mergelayer,
+                        clipping_tiles);
                 }
 
                 if (result)
@@ -1243,7 +1335,7 @@ void TreeSupport::increaseAreas(
             if (add)
             {
                 Polygons max_influence_area = TreeSupportUtils::safeUnion(
-                    inc_wo_collision.difference(volumes_.getCollision(radius, layer_idx - 1, elem.use_min_xy_dist_)),
+                    inc_wo_collision.difference(getClippingTile(inc_wo_collision, volumes_.getCollision(radius, layer_idx - 1, elem.use_min_xy_dist_), clipping_tiles)),
                     TreeSupportUtils::safeUnion(to_bp_data, to_model_data));
                 // ^^^ Note: union seems useless, but some rounding errors somewhere can cause to_bp_data to be slightly bigger than it should be
 
@@ -1279,6 +1371,44 @@ void TreeSupport::increaseAreas(
         });
 }
 
+const Polygons& TreeSupport::getClippingTile(const Polygons& area, const Polygons& clipping_area, ClippingTiles& clipping_tiles)
+{
+    // The tile is cut out with a margin around it, so that areas around its border still fit in it. Areas are only clipped with a tile if they stay a bit away from where it
+    // was cut, as the vertices there are rounded.
+    constexpr coord_t tile_margin = SUPPORT_TREE_CLIPPING_TILE_SIZE;
+    constexpr coord_t rounding_margin = 10;
+
+    if (area.empty() || clipping_area.empty())
+    {
+        return clipping_area;
+    }
+    const AABB area_bounds(area);
+    const Point2LL middle = area_bounds.getMiddle();
+    const Point2LL tile(
+        static_cast<coord_t>(std::floor(static_cast<double>(middle.X) / SUPPORT_TREE_CLIPPING_TILE_SIZE)),
+        static_cast<coord_t>(std::floor(static_cast<double>(middle.Y) / SUPPORT_TREE_CLIPPING_TILE_SIZE)));
+    AABB tile_bounds(
+        Point2LL(tile.X * SUPPORT_TREE_CLIPPING_TILE_SIZE - tile_margin, tile.Y * SUPPORT_TREE_CLIPPING_TILE_SIZE - tile_margin),
+        Point2LL((tile.X + 1) * SUPPORT_TREE_CLIPPING_TILE_SIZE + tile_margin, (tile.Y + 1) * SUPPORT_TREE_CLIPPING_TILE_SIZE + tile_margin));
+    AABB usable_bounds = tile_bounds;
+    usable_bounds.expand(-rounding_margin);
+    if (! usable_bounds.contains(area_bounds))
+    {
+        return clipping_area; // Too large for a tile.
+    }
+
+    const std::pair<const Polygons*, Point2LL> key(&clipping_area, tile);
+    const std::optional<std::reference_wrapper<const Polygons>> cached = clipping_tiles.find(key);
+    if (cached)
+    {
+        return cached.value().get();
+    }
+    Polygons tile_polygon;
+    tile_polygon.add(tile_bounds.toPolygon());
+    clipping_tiles.insert(std::vector<std::pair<std::pair<const Polygons*, Point2LL>, Polygons>>{ { key, clipping_area.intersection(tile_polygon) } });
+    return clipping_tiles.find(key).value().get();
+}
+
 void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>& move_bounds)
 {
     const double data_size_inverse = 1 / double(move_bounds.size());
@@ -1299,10 +1429,20 @@ void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>&
         3000 / config.layer_height);
 
     size_t merge_every_x_layers = 1;
+
+    // The influence areas of a layer only look at the avoidance of the layer below, so layers that were pathed already don't need their avoidance anymore.
+    // If the avoidance takes up more memory than is allowed, it is dropped for those layers. Avoidance calculated on demand while pathing adds to it.
+    const size_t avoidance_footprint = volumes_.getAvoidanceFootprint();
+    const size_t on_demand_footprint = volumes_.getOnDemandAvoidanceFootprint();
+    size_t released_avoidance_bytes = 0;
+    LayerIndex evicted_down_to = move_bounds.size();
+
     // Calculate the influence areas for each layer below (Top down)
     // This is done by first increasing the influence area by the allowed movement distance, and merging them with other influence areas if possible
     for (const auto layer_idx : ranges::views::iota(1UL, move_bounds.size()) | ranges::views::reverse)
     {
+        Cancellation::throwIfRequested(); // Every element created so far is in move_bounds, to be deleted by the caller.
+
         // Merging is expensive and only parallelized to a max speedup of 2. As such it may be useful in some cases to only merge every few layers to improve performance.
         bool merge_this_layer = size_t(last_merge - layer_idx) >= merge_every_x_layers;
         if (new_element)
@@ -1371,11 +1511,23 @@ void TreeSupport::createLayerPathing(std::vector<std::set<TreeSupportElement*>>&
             move_bounds[layer_idx - 1].emplace(elem);
         }
 
+        if (avoidance_footprint + volumes_.getOnDemandAvoidanceFootprint() - on_demand_footprint > SUPPORT_TREE_AVOIDANCE_MEMORY_BUDGET + released_avoidance_bytes)
+        {
+            for (; evicted_down_to > LayerIndex(layer_idx); evicted_down_to--)
+            {
+                released_avoidance_bytes += volumes_.evictAvoidance(evicted_down_to - 1);
+            }
+        }
+
         progress_total += data_size_inverse * TREE_PROGRESS_AREA_CALC;
         Progress::messageProgress(Progress::Stage::SUPPORT, progress_total * progress_multiplier + progress_offset, TREE_PROGRESS_TOTAL);
     }
 
     spdlog::info("Time spent with creating influence areas' subtasks: Increasing areas {} ms merging areas: {} ms", dur_inc.count() / 1000000, dur_merge.count() / 1000000);
+    if (released_avoidance_bytes > 0)
+    {
+        spdlog::debug("Released {} of {} bytes of tree support avoidance while creating influence areas.", released_avoidance_bytes, avoidance_footprint);
+    }
 }
 
 void TreeSupport::setPointsOnAreas(const TreeSupportElement* elem)
@@ -1496,7 +1648,7 @@ bool TreeSupport::setToModelContact(std::vector<std::set<TreeSupportElement*>>&
         }
 
         checked[last_successfull_layer - layer_idx]->result_on_layer_ = best;
-        spdlog::debug("Added gracious Support On Model Point ({},{}). The current layer is {}", best.X, best.Y, last_successfull_layer);
+        CURA_LOG_DEBUG("Added gracious Support On Model Point ({},{}). The current layer is {}", best.X, best.Y, last_successfull_layer);
 
         return last_successfull_layer != layer_idx;
     }
@@ -1541,7 +1693,7 @@ bool TreeSupport::setToModelContact(std::vector<std::set<TreeSupportElement*>>&
         }
         first_elem->result_on_layer_ = best;
         first_elem->to_model_gracious_ = false;
-        spdlog::debug("Added NON gracious Support On Model Point ({},{}). The current layer is {}", best.X, best.Y, layer_idx);
+        CURA_LOG_DEBUG("Added NON gracious Support On Model Point ({},{}). The current layer is {}", best.X, best.Y, layer_idx);
         return false;
     }
 }
@@ -1663,7 +1815,9 @@ void TreeSupport::generateBranchAreas(
     const size_t progress_inserts_check_interval = std::max(linear_data.size() / progress_report_steps, size_t(1));
 
     std::mutex critical_sections;
-    cura::parallel_for<size_t>(
+    ClippingTiles clipping_tiles; // Branches near each other on the same layer share the tiles of its collision.
+    // Elements with many parents and children and a large radius take far longer than the tips of the branches.
+    cura::parallel_for_guided<size_t>(
         0,
         linear_data.size(),
         [&](const size_t idx)
@@ -1719,18 +1873,20 @@ void TreeSupport::generateBranchAreas(
                         used_scale * (0 + moveX * moveY * vsize_inv),
                         used_scale * (1 + moveY * moveY * vsize_inv),
                     };
+                    // The matrix is symmetric and positive definite, so the ellipse keeps the orientation of the circle and doesn't need to be fixed up before the union.
                     Polygon circle;
+                    circle.reserve(branch_circle.size());
                     for (Point2LL vertex : branch_circle)
                     {
                         vertex = Point2LL(matrix[0] * vertex.X + matrix[1] * vertex.Y, matrix[2] * vertex.X + matrix[3] * vertex.Y);
                         circle.add(center_position + vertex);
                     }
-                    poly.add(circle.offset(0));
+                    poly.add(circle);
                 }
 
-                poly = poly.unionPolygons()
-                           .offset(std::min(static_cast<coord_t>(FUDGE_LENGTH), config.support_line_width / 4))
-                           .difference(volumes_.getCollision(0, linear_data[idx].first, parent_uses_min || elem->use_min_xy_dist_));
+                poly = poly.unionPolygons().offset(std::min(static_cast<coord_t>(FUDGE_LENGTH), config.support_line_width / 4));
+                poly = poly.difference(
+                    getClippingTile(poly, volumes_.getCollision(0, linear_data[idx].first, parent_uses_min || elem->use_min_xy_dist_), clipping_tiles));
                 // ^^^ There seem to be some rounding errors, causing a branch to be a tiny bit further away from the model that it has to be. This can cause the tip to be slightly
                 // further away front the overhang (x/y wise) than optimal.
                 //     This fixes it, and for every other part, 0.05mm will not be noticed.
@@ -1966,8 +2122,8 @@ void TreeSupport::filterFloatingLines(std::vector<Polygons>& support_layer_stora
 
 
     std::vector<Polygons> support_holes(support_layer_storage.size(), Polygons());
-    // Extract all holes as polygon objects
-    cura::parallel_for<coord_t>(
+    // Extract all holes as polygon objects. The support areas differ a lot in size between layers, so balance by it.
+    cura::parallel_for_guided<coord_t>(
         0,
         support_layer_storage.size(),
         [&](const LayerIndex layer_idx)
@@ -1993,6 +2149,10 @@ void TreeSupport::filterFloatingLines(std::vector<Polygons>& support_layer_stora
                 holes_original.add(area);
             }
             support_holes[layer_idx] = holes_original;
+        },
+        [&support_layer_storage](const LayerIndex layer_idx)
+        {
+            return support_layer_storage[layer_idx].pointCount() + 1;
         });
 
     const auto t_union = std::chrono::high_resolution_clock::now();
@@ -2227,9 +2387,7 @@ void TreeSupport::finalizeInterfaceAndSupportAreas(
                     // One sample at 0 layers below, another at config.support_bottom_layers. In-between samples at 1-layer distance from each other.
                     const size_t sample_layer
                         = static_cast<size_t>(std::max(0, (static_cast<int>(layer_idx) - static_cast<int>(layers_below)) - static_cast<int>(config.z_distance_bottom_layers)));
-                    constexpr bool no_support = false;
-                    constexpr bool no_prime_tower = false;
-                    floor_layer.add(layer_outset.intersection(storage.getLayerOutlines(sample_layer, no_support, no_prime_tower)));
+                    floor_layer.add(layer_outset.intersection(storage.model_offsets.get(sample_layer, ModelOffsetCache::all_meshes)));
                     if (layers_below < config.support_bottom_layers)
                     {
                         layers_below = std::min(layers_below + 1UL, config.support_bottom_layers);
@@ -2334,21 +2492,20 @@ void TreeSupport::drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bou
 
     // Reorder the processed data by layers again. The map also could be a vector<pair<SupportElement*,Polygons>>:
     std::vector<std::unordered_map<TreeSupportElement*, Polygons>> layer_tree_polygons(move_bounds.size());
-    const auto t_start = std::chrono::high_resolution_clock::now();
 
     // Generate the circles that will be the branches.
     generateBranchAreas(linear_data, layer_tree_polygons, inverse_tree_order);
-    const auto t_generate = std::chrono::high_resolution_clock::now();
+    time_keeper_.registerTime("Generate branch areas", 0.0);
 
     // In some edge-cases a branch may go through a hole, where the regular radius does not fit. This can result in an apparent jump in branch radius. As such this cases need to be
     // caught and smoothed out.
     smoothBranchAreas(layer_tree_polygons);
-    const auto t_smooth = std::chrono::high_resolution_clock::now();
+    time_keeper_.registerTime("Smooth branch areas", 0.0);
 
     // Drop down all trees that connect non gracefully with the model.
     std::vector<std::vector<std::pair<LayerIndex, Polygons>>> dropped_down_areas(linear_data.size());
     dropNonGraciousAreas(layer_tree_polygons, linear_data, dropped_down_areas, inverse_tree_order);
-    const auto t_drop = std::chrono::high_resolution_clock::now();
+    time_keeper_.registerTime("Drop non gracious areas", 0.0);
 
     // single threaded combining all dropped down support areas to the right layers. ONLY COPYS DATA!
     for (const coord_t i : ranges::views::iota(0UL, dropped_down_areas.size()))
@@ -2427,25 +2584,84 @@ void TreeSupport::drawAreas(std::vector<std::set<TreeSupportElement*>>& move_bou
         scripta::log("tree_support_layer_storage", support_layer_storage[layer_idx], SectionType::SUPPORT, layer_idx);
     }
 
+    time_keeper_.registerTime("Sort into layers", 0.0);
+
     filterFloatingLines(support_layer_storage);
-    const auto t_filter = std::chrono::high_resolution_clock::now();
+    time_keeper_.registerTime("Filter floating lines", 0.0);
 
     finalizeInterfaceAndSupportAreas(support_layer_storage, support_roof_storage, support_layer_storage_fractional, storage);
-    const auto t_end = std::chrono::high_resolution_clock::now();
+    time_keeper_.registerTime("Finalize interface and support areas", 0.0);
+}
+
+void TreeSupport::countElements(const std::string& phase, const std::vector<std::set<TreeSupportElement*>>& move_bounds)
+{
+    size_t count = 0;
+    for (const std::set<TreeSupportElement*>& layer : move_bounds)
+    {
+        count += layer.size();
+    }
+    element_counts_.emplace_back(phase, count);
+}
+
+void TreeSupport::reportStatistics(size_t group_idx, size_t layer_count) const
+{
+    const TimeKeeper::RegisteredTimes& stages = time_keeper_.getRegisteredTimes();
+    double total_time = 0.0;
+    for (const TimeKeeper::RegisteredTime& stage : stages)
+    {
+        total_time += stage.duration;
+    }
+    const TreeModelVolumes::CacheStatistics volume_statistics = volumes_.getCacheStatistics();
+    const size_t avoidance_bytes = volumes_.getAvoidanceFootprint() + volumes_.getOnDemandAvoidanceFootprint();
 
-    const auto dur_gen_tips = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_generate - t_start).count();
-    const auto dur_smooth = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_smooth - t_generate).count();
-    const auto dur_drop = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_drop - t_smooth).count();
-    const auto dur_filter = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_filter - t_drop).count();
-    const auto dur_finalize = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_filter).count();
+    spdlog::info("┌ Tree support of mesh group {} generated in {:03.3f}s", group_idx + 1, total_time);
+    for (const TimeKeeper::RegisteredTime& stage : stages)
+    {
+        spdlog::info("├── {}: {:03.3f}s", stage.stage, stage.duration);
+    }
+    for (const auto& [phase, count] : element_counts_)
+    {
+        spdlog::info("├── {}: {} elements", phase, count);
+    }
     spdlog::info(
-        "Time used for drawing subfuctions: generateBranchAreas: {} ms smoothBranchAreas: {} ms dropNonGraciousAreas: {} ms filterFloatingLines: {} ms "
-        "finalizeInterfaceAndSupportAreas {} ms",
-        dur_gen_tips,
-        dur_smooth,
-        dur_drop,
-        dur_filter,
-        dur_finalize);
+        "└── Volumes: {} hits, {} misses calculated in {:03.3f}s, {} kB of avoidance cached",
+        volume_statistics.hits,
+        volume_statistics.misses,
+        volume_statistics.compute_time,
+        avoidance_bytes / 1024);
+
+    const std::string statistics_file = spdlog::details::os::getenv("CURA_ENGINE_TREE_SUPPORT_STATS");
+    if (statistics_file.empty())
+    {
+        return;
+    }
+    std::string stages_json;
+    for (const TimeKeeper::RegisteredTime& stage : stages)
+    {
+        stages_json += fmt::format("{}\"{}\":{}", stages_json.empty() ? "" : ",", stage.stage, stage.duration);
+    }
+    std::string elements_json;
+    for (const auto& [phase, count] : element_counts_)
+    {
+        elements_json += fmt::format("{}\"{}\":{}", elements_json.empty() ? "" : ",", phase, count);
+    }
+    std::ofstream file(statistics_file, std::ios::app);
+    file << fmt::format(
+        R"({{"mesh_group":{},"layers":{},"total_time":{},"stages":{{{}}},"elements":{{{}}},"volumes":{{"hits":{},"misses":{},"compute_time":{},"avoidance_bytes":{}}}}})",
+        group_idx,
+        layer_count,
+        total_time,
+        stages_json,
+        elements_json,
+        volume_statistics.hits,
+        volume_statistics.misses,
+        volume_statistics.compute_time,
+        avoidance_bytes)
+         << '\n';
+    if (! file)
+    {
+        spdlog::warn("Could not write the tree support statistics to {}", statistics_file);
+    }
 }
 
 } // namespace cura
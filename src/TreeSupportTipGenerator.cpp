@@ -17,6 +17,7 @@
 #include "Application.h" //To get settings.
 #include "TreeSupportUtils.h"
 #include "infill/SierpinskiFillProvider.h"
+#include "infill/SierpinskiFillProviderCache.h"
 #include "settings/EnumSettings.h"
 #include "utils/Simplify.h"
 #include "utils/ThreadPool.h"
@@ -400,9 +401,9 @@ std::shared_ptr<SierpinskiFillProvider> TreeSupportTipGenerator::generateCrossFi
         std::ifstream cross_fs(cross_subdisivion_spec_image_file.c_str());
         if (cross_subdisivion_spec_image_file != "" && cross_fs.good())
         {
-            return std::make_shared<SierpinskiFillProvider>(aabb, line_distance, line_width, cross_subdisivion_spec_image_file);
+            return SierpinskiFillProviderCache::getInstance().get(aabb, line_distance, line_width, cross_subdisivion_spec_image_file);
         }
-        return std::make_shared<SierpinskiFillProvider>(aabb, line_distance, line_width);
+        return SierpinskiFillProviderCache::getInstance().get(aabb, line_distance, line_width);
     }
     return nullptr;
 }
@@ -623,7 +624,7 @@ void TreeSupportTipGenerator::calculateRoofAreas(const cura::SliceMeshStorage& m
 
 
 void TreeSupportTipGenerator::addPointAsInfluenceArea(
-    std::vector<std::set<TreeSupportElement*>>& move_bounds,
+    TipBuffer& buffer,
     std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> p,
     size_t dtt,
     LayerIndex insert_layer,
@@ -647,41 +648,33 @@ void TreeSupportTipGenerator::addPointAsInfluenceArea(
         circle.add(p.first + corner);
     }
     Polygons area = circle.offset(0);
+    TreeSupportElement* elem = new TreeSupportElement(
+        dtt,
+        insert_layer,
+        p.first,
+        to_bp,
+        gracious,
+        ! xy_overrides_,
+        dont_move_until,
+        roof,
+        safe_radius,
+        ! roof && force_tip_to_roof_,
+        skip_ovalisation,
+        support_tree_limit_branch_reach_,
+        support_tree_branch_reach_limit_);
+    elem->area_ = new Polygons(area);
+
+    for (Point2LL target : additional_ovalization_targets)
     {
-        std::lock_guard<std::mutex> critical_section_movebounds(critical_move_bounds_);
-        if (! already_inserted_[insert_layer].count(p.first / ((config_.min_radius + 1) / 10)))
-        {
-            // Normalize the point a bit to also catch points which are so close that inserting it would achieve nothing.
-            already_inserted_[insert_layer].emplace(p.first / ((config_.min_radius + 1) / 10));
-            TreeSupportElement* elem = new TreeSupportElement(
-                dtt,
-                insert_layer,
-                p.first,
-                to_bp,
-                gracious,
-                ! xy_overrides_,
-                dont_move_until,
-                roof,
-                safe_radius,
-                ! roof && force_tip_to_roof_,
-                skip_ovalisation,
-                support_tree_limit_branch_reach_,
-                support_tree_branch_reach_limit_);
-            elem->area_ = new Polygons(area);
-
-            for (Point2LL target : additional_ovalization_targets)
-            {
-                elem->additional_ovalization_targets_.emplace_back(target);
-            }
-
-            move_bounds[insert_layer].emplace(elem);
-        }
+        elem->additional_ovalization_targets_.emplace_back(target);
     }
+
+    buffer.tips.push_back(TipBuffer::Tip{ insert_layer, p.first, elem }); // Whether it is too close to another tip is checked when the buffers are added.
 }
 
 
 void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
-    std::vector<std::set<TreeSupportElement*>>& move_bounds,
+    TipBuffer& buffer,
     std::vector<TreeSupportTipGenerator::LineInformation> lines,
     size_t roof_tip_layers,
     LayerIndex insert_layer_idx,
@@ -715,7 +708,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
             {
                 for (std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> point_data : line)
                 {
-                    addPointAsInfluenceArea(move_bounds, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
+                    addPointAsInfluenceArea(buffer, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
                 }
             }
 
@@ -727,7 +720,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
             {
                 for (std::pair<Point2LL, TreeSupportTipGenerator::LineStatus> point_data : line)
                 {
-                    addPointAsInfluenceArea(move_bounds, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
+                    addPointAsInfluenceArea(buffer, point_data, 0, insert_layer_idx - dtt_roof_tip, roof_tip_layers - dtt_roof_tip, dtt_roof_tip != 0, false);
                 }
             }
 
@@ -746,15 +739,11 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
                 }
             }
             added_roofs = added_roofs.unionPolygons();
+            if (dtt_roof_tip == 0)
             {
-                std::lock_guard<std::mutex> critical_section_roof(critical_roof_tips_);
-                roof_tips_drawn_[insert_layer_idx - dtt_roof_tip].add(added_roofs);
-
-                if (dtt_roof_tip == 0)
-                {
-                    support_roof_drawn_fractional_[insert_layer_idx].add(added_roofs);
-                }
+                buffer.roof_tips_fractional.emplace_back(insert_layer_idx, added_roofs);
             }
+            buffer.roof_tips.emplace_back(insert_layer_idx - dtt_roof_tip, std::move(added_roofs));
         }
     }
 
@@ -779,7 +768,7 @@ void TreeSupportTipGenerator::addLinesAsInfluenceAreas(
                 }
             }
             addPointAsInfluenceArea(
-                move_bounds,
+                buffer,
                 point_data,
                 0,
                 insert_layer_idx - dtt_roof_tip,
@@ -867,6 +856,7 @@ void TreeSupportTipGenerator::generateTips(
         calculateRoofAreas(mesh);
     }
 
+    std::vector<TipBuffer> tip_buffers(mesh.overhang_areas.size());
     cura::parallel_for<coord_t>(
         1,
         mesh.overhang_areas.size() - z_distance_delta_,
@@ -1041,7 +1031,7 @@ void TreeSupportTipGenerator::generateTips(
                         // ^^^ Set all now valid lines to their correct LineStatus. Easiest way is to just discard Avoidance information for each point and evaluate them again.
 
                         addLinesAsInfluenceAreas(
-                            new_tips,
+                            tip_buffers[layer_idx],
                             fresh_valid_points,
                             (force_tip_to_roof_ && lag_ctr <= support_roof_layers_) ? support_roof_layers_ : 0,
                             layer_idx - lag_ctr,
@@ -1130,7 +1120,7 @@ void TreeSupportTipGenerator::generateTips(
 
                 size_t dont_move_for_layers = support_roof_layers_ ? (force_tip_to_roof_ ? support_roof_layers_ : (roof_allowed_for_this_part ? 0 : support_roof_layers_)) : 0;
                 addLinesAsInfluenceAreas(
-                    new_tips,
+                    tip_buffers[layer_idx],
                     overhang_lines,
                     force_tip_to_roof_ ? support_roof_layers_ : 0,
                     layer_idx,
@@ -1140,6 +1130,34 @@ void TreeSupportTipGenerator::generateTips(
             }
         });
 
+    // The buffers are added in the order of the layers they were generated from, so that which of two tips that are too close together is kept doesn't depend on the order
+    // in which the threads finished.
+    for (TipBuffer& buffer : tip_buffers)
+    {
+        for (const TipBuffer::Tip& tip : buffer.tips)
+        {
+            // Normalize the point a bit to also catch points which are so close that inserting it would achieve nothing.
+            if (already_inserted_[tip.layer].emplace(tip.position / ((config_.min_radius + 1) / 10)).second)
+            {
+                new_tips[tip.layer].emplace(tip.element);
+            }
+            else
+            {
+                delete tip.element->area_;
+                delete tip.element;
+            }
+        }
+        for (auto& [layer_idx, roof_tips] : buffer.roof_tips)
+        {
+            roof_tips_drawn_[layer_idx].add(roof_tips);
+        }
+        for (auto& [layer_idx, roof_tips] : buffer.roof_tips_fractional)
+        {
+            support_roof_drawn_fractional_[layer_idx].add(roof_tips);
+        }
+        buffer = TipBuffer();
+    }
+
     cura::parallel_for<coord_t>(
         0,
         support_roof_drawn_.size(),
@@ -4,6 +4,7 @@
 #include "WallToolPaths.h"
 
 #include <algorithm> //For std::partition_copy and std::min_element.
+#include <cmath>
 #include <unordered_set>
 
 #include <range/v3/range/conversion.hpp>
@@ -13,10 +14,12 @@
 
 #include "ExtruderTrain.h"
 #include "SkeletalTrapezoidation.h"
+#include "WallToolPathsCache.h"
 #include "utils/PolylineStitcher.h"
 #include "utils/Simplify.h"
 #include "utils/SparsePointGrid.h" //To stitch the inner contour.
 #include "utils/actions/smooth.h"
+#include "utils/gettime.h"
 #include "utils/polygonUtils.h"
 
 namespace cura
@@ -73,6 +76,17 @@ WallToolPaths::WallToolPaths(
 
 const std::vector<VariableWidthLines>& WallToolPaths::generate()
 {
+    const WallToolPathsCache::Parameters cache_parameters{ bead_width_0_, bead_width_x_, inset_count_, wall_0_inset_, section_type_ };
+    if (cache_ != nullptr && cache_->find(outline_, cache_parameters, toolpaths_, inner_contour_))
+    {
+        toolpaths_generated_ = true;
+        return toolpaths_;
+    }
+    if (time_keeper_ != nullptr)
+    {
+        time_keeper_->restart();
+    }
+
     const coord_t allowed_distance = settings_.get<coord_t>("meshfix_maximum_deviation");
 
     // Sometimes small slivers of polygons mess up the prepared_outline. By performing an open-close operation
@@ -102,8 +116,7 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
     }
 
     PolygonUtils::fixSelfIntersections(epsilon_offset, prepared_outline);
-    prepared_outline.removeDegenerateVerts();
-    prepared_outline.removeColinearEdges(AngleRadians(0.005));
+    prepared_outline.cleanUp(AngleRadians(0.005));
     // Removing collinear edges may introduce self intersections, so we need to fix them again
     PolygonUtils::fixSelfIntersections(epsilon_offset, prepared_outline);
     prepared_outline.removeDegenerateVerts();
@@ -117,6 +130,7 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
     }
 
     prepared_outline = prepared_outline.removeNearSelfIntersections();
+    registerTime("Prepare outline");
 
     const coord_t wall_transition_length = settings_.get<coord_t>("wall_transition_length");
 
@@ -145,55 +159,69 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
         max_bead_count,
         wall_0_inset_,
         wall_distribution_count);
-    const auto transition_filter_dist = settings_.get<coord_t>("wall_transition_filter_distance");
-    const auto allowed_filter_deviation = settings_.get<coord_t>("wall_transition_filter_deviation");
-    SkeletalTrapezoidation wall_maker(
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length,
-        layer_idx_,
-        section_type_);
-    wall_maker.generateToolpaths(toolpaths_);
-    scripta::log(
-        "toolpaths_0",
-        toolpaths_,
-        section_type_,
-        layer_idx_,
-        scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
-        scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
-        scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
-        scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
-        scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
-
-    stitchToolPaths(toolpaths_, settings_);
-    scripta::log(
-        "toolpaths_1",
-        toolpaths_,
-        section_type_,
-        layer_idx_,
-        scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
-        scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
-        scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
-        scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
-        scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
-
-    removeSmallLines(toolpaths_);
-    scripta::log(
-        "toolpaths_2",
-        toolpaths_,
-        section_type_,
-        layer_idx_,
-        scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
-        scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
-        scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
-        scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
-        scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
+    if (hasUniformWalls(prepared_outline, *beading_strat, inset_count_, allowed_distance))
+    {
+        // Skip the skeletal trapezoidation, which would only find the same walls at much higher cost.
+        generateByOffsets(prepared_outline, *beading_strat);
+        registerTime("Offsets");
+    }
+    else
+    {
+        const auto transition_filter_dist = settings_.get<coord_t>("wall_transition_filter_distance");
+        const auto allowed_filter_deviation = settings_.get<coord_t>("wall_transition_filter_deviation");
+        SkeletalTrapezoidation wall_maker(
+            prepared_outline,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            allowed_distance,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length,
+            layer_idx_,
+            section_type_);
+        registerTime("Voronoi construction");
+        wall_maker.generateToolpaths(toolpaths_, false, time_keeper_);
+        scripta::log(
+            "toolpaths_0",
+            toolpaths_,
+            section_type_,
+            layer_idx_,
+            scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
+            scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
+            scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
+            scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
+            scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
+
+        stitchToolPaths(toolpaths_, settings_);
+        registerTime("Stitching");
+        scripta::log(
+            "toolpaths_1",
+            toolpaths_,
+            section_type_,
+            layer_idx_,
+            scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
+            scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
+            scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
+            scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
+            scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
+
+        removeSmallLines(toolpaths_);
+        registerTime("Remove small lines");
+        scripta::log(
+            "toolpaths_2",
+            toolpaths_,
+            section_type_,
+            layer_idx_,
+            scripta::CellVDI{ "is_closed", &ExtrusionLine::is_closed_ },
+            scripta::CellVDI{ "is_odd", &ExtrusionLine::is_odd_ },
+            scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
+            scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
+            scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
+    }
 
     simplifyToolPaths(toolpaths_, settings_);
+    registerTime("Simplification");
     scripta::log(
         "toolpaths_3",
         toolpaths_,
@@ -208,6 +236,7 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
     separateOutInnerContour();
 
     removeEmptyToolPaths(toolpaths_);
+    registerTime("Inner contour");
     scripta::log(
         "toolpaths_4",
         toolpaths_,
@@ -238,10 +267,70 @@ const std::vector<VariableWidthLines>& WallToolPaths::generate()
         scripta::CellVDI{ "inset_idx", &ExtrusionLine::inset_idx_ },
         scripta::PointVDI{ "width", &ExtrusionJunction::w_ },
         scripta::PointVDI{ "perimeter_index", &ExtrusionJunction::perimeter_index_ });
+    if (cache_ != nullptr)
+    {
+        cache_->insert(outline_, cache_parameters, toolpaths_, inner_contour_);
+    }
     return toolpaths_;
 }
 
 
+bool WallToolPaths::hasUniformWalls(const Polygons& outline, const BeadingStrategy& beading_strategy, const size_t inset_count, const coord_t allowed_deviation)
+{
+    constexpr size_t max_inset_count = 64; // More walls than this are for filling areas, which will hardly ever be thick enough.
+    if (inset_count == 0 || inset_count > max_inset_count)
+    {
+        return false;
+    }
+
+    // Where the outline is thicker than this, the beading strategy gives all walls their nominal width, and leaves the rest for infill.
+    // An extra line width keeps the skeleton clear of the transitions to fewer walls.
+    const coord_t max_bead_count = 2 * inset_count;
+    const coord_t min_thickness = beading_strategy.getTransitionThickness(max_bead_count) + beading_strategy.getOptimalWidth();
+    const coord_t radius = min_thickness / 2;
+
+    // Opening the outline with a disc of that radius leaves it the same where it is thick enough, except that it rounds the convex corners. Those are
+    // restored by the miter, up to the corners that are so sharp that the walls would have to narrow down into them.
+    const Polygons eroded = outline.offset(-radius, ClipperLib::jtRound);
+    if (eroded.empty())
+    {
+        return false;
+    }
+    const double miter_limit = std::min(2.0, 1.0 / std::sin(beading_strategy.getTransitioningAngle() / 2));
+    const Polygons opened = eroded.offset(radius, ClipperLib::jtMiter, miter_limit);
+
+    // Only slivers may be lost, from the rounding of both offsets.
+    return outline.difference(opened).offset(-allowed_deviation).empty();
+}
+
+void WallToolPaths::generateByOffsets(const Polygons& outline, const BeadingStrategy& beading_strategy)
+{
+    // Each wall follows the outline at the distance of its bead in the beading of any thickness that is thick enough, up to and including the 0-width
+    // bead at the edge of the walled area.
+    const coord_t max_bead_count = 2 * inset_count_;
+    const BeadingStrategy::Beading beading = beading_strategy.compute(beading_strategy.getOptimalThickness(max_bead_count) * 2, max_bead_count + 1);
+    toolpaths_.resize(inset_count_ + 1);
+    for (size_t bead_idx = 0; bead_idx <= inset_count_; bead_idx++)
+    {
+        // Round joins, since the walls around concave corners are arcs at a constant distance from the corner.
+        const Polygons wall = outline.offset(-beading.toolpath_locations[bead_idx], ClipperLib::jtRound);
+        for (const ClipperLib::Path& path : wall.paths)
+        {
+            if (path.size() < 3)
+            {
+                continue;
+            }
+            ExtrusionLine& line = toolpaths_[bead_idx].emplace_back(bead_idx, false, true);
+            line.junctions_.reserve(path.size() + 1);
+            for (const Point2LL& point : path)
+            {
+                line.emplace_back(point, beading.bead_widths[bead_idx], bead_idx);
+            }
+            line.emplace_back(line.front());
+        }
+    }
+}
+
 void WallToolPaths::stitchToolPaths(std::vector<VariableWidthLines>& toolpaths, const Settings& settings)
 {
     const coord_t stitch_distance
@@ -299,13 +388,14 @@ void WallToolPaths::removeSmallLines(std::vector<VariableWidthLines>& toolpaths)
 void WallToolPaths::simplifyToolPaths(std::vector<VariableWidthLines>& toolpaths, const Settings& settings)
 {
     const Simplify simplifier(settings);
+    Simplify::Scratch scratch; // Shared by all lines, so that simplifying them doesn't allocate for each of them.
     for (auto& toolpath : toolpaths)
     {
         toolpath = toolpath
                  | ranges::views::transform(
-                       [&simplifier](auto& line)
+                       [&simplifier, &scratch](auto& line)
                        {
-                           auto line_ = line.is_closed_ ? simplifier.polygon(line) : simplifier.polyline(line);
+                           auto line_ = line.is_closed_ ? simplifier.polygon(line, scratch) : simplifier.polyline(line, scratch);
 
                            if (line_.is_closed_ && line_.size() >= 2 && line_.front() != line_.back())
                            {
@@ -430,6 +520,24 @@ const Polygons& WallToolPaths::getInnerContour()
     return inner_contour_;
 }
 
+void WallToolPaths::setCache(WallToolPathsCache* cache)
+{
+    cache_ = cache;
+}
+
+void WallToolPaths::setTimeKeeper(TimeKeeper* time_keeper)
+{
+    time_keeper_ = time_keeper;
+}
+
+void WallToolPaths::registerTime(const std::string& stage)
+{
+    if (time_keeper_ != nullptr)
+    {
+        time_keeper_->registerTime(stage, 0.0);
+    }
+}
+
 bool WallToolPaths::removeEmptyToolPaths(std::vector<VariableWidthLines>& toolpaths)
 {
     toolpaths.erase(
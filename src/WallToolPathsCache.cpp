@@ -0,0 +1,173 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "WallToolPathsCache.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cura
+{
+
+WallToolPathsCache::WallToolPathsCache(const size_t capacity)
+    : capacity_(std::max(size_t(1), capacity))
+{
+}
+
+void WallToolPathsCache::setCapacity(const size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max(size_t(1), capacity);
+    while (entries_.size() > capacity_)
+    {
+        entries_.pop_front();
+    }
+}
+
+bool WallToolPathsCache::find(const Polygons& outline, const Parameters& parameters, std::vector<VariableWidthLines>& toolpaths, Polygons& inner_contour)
+{
+    const Point2LL outline_origin = origin(outline);
+    const uint64_t outline_hash = hash(outline, outline_origin, parameters);
+
+    std::shared_ptr<const Entry> found;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The newest entries are the most likely to match, since they are of the layers just below.
+        for (auto entry = entries_.rbegin(); entry != entries_.rend(); ++entry)
+        {
+            if ((*entry)->hash == outline_hash && (*entry)->parameters == parameters)
+            {
+                found = *entry;
+                break;
+            }
+        }
+    }
+    // Compare and copy the walls outside of the lock, so that other threads don't have to wait for that.
+    if (! found || ! sameOutline(outline, outline_origin, found->outline))
+    {
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    toolpaths = found->toolpaths;
+    translate(toolpaths, outline_origin);
+    inner_contour = found->inner_contour;
+    inner_contour.translate(outline_origin);
+    hit_count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void WallToolPathsCache::insert(const Polygons& outline, const Parameters& parameters, const std::vector<VariableWidthLines>& toolpaths, const Polygons& inner_contour)
+{
+    const Point2LL outline_origin = origin(outline);
+    auto entry = std::make_shared<Entry>();
+    entry->hash = hash(outline, outline_origin, parameters);
+    entry->parameters = parameters;
+    entry->outline = outline;
+    entry->outline.translate(-outline_origin);
+    entry->toolpaths = toolpaths;
+    translate(entry->toolpaths, -outline_origin);
+    entry->inner_contour = inner_contour;
+    entry->inner_contour.translate(-outline_origin);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= capacity_)
+    {
+        entries_.pop_front();
+    }
+    entries_.push_back(std::move(entry));
+}
+
+size_t WallToolPathsCache::hitCount() const
+{
+    return hit_count_.load(std::memory_order_relaxed);
+}
+
+size_t WallToolPathsCache::missCount() const
+{
+    return miss_count_.load(std::memory_order_relaxed);
+}
+
+Point2LL WallToolPathsCache::origin(const Polygons& outline)
+{
+    Point2LL min(std::numeric_limits<coord_t>::max(), std::numeric_limits<coord_t>::max());
+    for (const ClipperLib::Path& path : outline.paths)
+    {
+        for (const Point2LL& point : path)
+        {
+            min.X = std::min(min.X, point.X);
+            min.Y = std::min(min.Y, point.Y);
+        }
+    }
+    return outline.paths.empty() ? Point2LL(0, 0) : min;
+}
+
+uint64_t WallToolPathsCache::hash(const Polygons& outline, const Point2LL& origin, const Parameters& parameters)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    };
+    combine(static_cast<uint64_t>(parameters.bead_width_0));
+    combine(static_cast<uint64_t>(parameters.bead_width_x));
+    combine(static_cast<uint64_t>(parameters.inset_count));
+    combine(static_cast<uint64_t>(parameters.wall_0_inset));
+    combine(static_cast<uint64_t>(parameters.section_type));
+    combine(outline.paths.size());
+    for (const ClipperLib::Path& path : outline.paths)
+    {
+        combine(path.size());
+        for (const Point2LL& point : path)
+        {
+            combine(static_cast<uint64_t>(point.X - origin.X));
+            combine(static_cast<uint64_t>(point.Y - origin.Y));
+        }
+    }
+    return hash;
+}
+
+bool WallToolPathsCache::sameOutline(const Polygons& outline, const Point2LL& origin, const Polygons& normalized_outline)
+{
+    if (outline.paths.size() != normalized_outline.paths.size())
+    {
+        return false;
+    }
+    for (size_t path_idx = 0; path_idx < outline.paths.size(); path_idx++)
+    {
+        const ClipperLib::Path& path = outline.paths[path_idx];
+        const ClipperLib::Path& normalized_path = normalized_outline.paths[path_idx];
+        if (path.size() != normalized_path.size())
+        {
+            return false;
+        }
+        for (size_t point_idx = 0; point_idx < path.size(); point_idx++)
+        {
+            if (path[point_idx] - origin != normalized_path[point_idx])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void WallToolPathsCache::translate(std::vector<VariableWidthLines>& toolpaths, const Point2LL& offset)
+{
+    if (offset == Point2LL(0, 0))
+    {
+        return;
+    }
+    for (VariableWidthLines& lines : toolpaths)
+    {
+        for (ExtrusionLine& line : lines)
+        {
+            for (ExtrusionJunction& junction : line)
+            {
+                junction.p_ += offset;
+            }
+        }
+    }
+}
+
+} // namespace cura
@@ -18,14 +18,18 @@
 #include "WallToolPaths.h"
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
+#include "utils/CompactPolygons.h"
 #include "utils/Simplify.h" // We're simplifying the spiralized insets.
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
 
-WallsComputation::WallsComputation(const Settings& settings, const LayerIndex layer_nr)
+WallsComputation::WallsComputation(const Settings& settings, const LayerIndex layer_nr, WallToolPathsCache* walls_cache, CompactPolygonsPool* outline_pool)
     : settings_(settings)
     , layer_nr_(layer_nr)
+    , walls_cache_(walls_cache)
+    , outline_pool_(outline_pool)
 {
 }
 
@@ -40,7 +44,7 @@ void WallsComputation::generateWalls(SliceLayerPart* part, SectionType section_t
     size_t wall_count = settings_.get<size_t>("wall_line_count");
     if (wall_count == 0) // Early out if no walls are to be generated
     {
-        part->print_outline = part->outline;
+        setPrintOutline(part, part->outline);
         part->inner_area = part->outline;
         return;
     }
@@ -74,6 +78,7 @@ void WallsComputation::generateWalls(SliceLayerPart* part, SectionType section_t
         if (layer_nr_ <= static_cast<LayerIndex>(settings_.get<size_t>("initial_bottom_layers")))
         {
             WallToolPaths wall_tool_paths(part->outline, line_width_0, line_width_x, wall_count, wall_0_inset, settings_, layer_nr_, section_type);
+            wall_tool_paths.setCache(walls_cache_);
             part->wall_toolpaths = wall_tool_paths.getToolPaths();
             part->inner_area = wall_tool_paths.getInnerContour();
         }
@@ -81,24 +86,46 @@ void WallsComputation::generateWalls(SliceLayerPart* part, SectionType section_t
     else
     {
         WallToolPaths wall_tool_paths(part->outline, line_width_0, line_width_x, wall_count, wall_0_inset, settings_, layer_nr_, section_type);
+        wall_tool_paths.setCache(walls_cache_);
         part->wall_toolpaths = wall_tool_paths.getToolPaths();
         part->inner_area = wall_tool_paths.getInnerContour();
     }
     part->outline = PolygonsPart{ Simplify(settings_).polygon(part->outline) };
-    part->print_outline = part->outline;
+    setPrintOutline(part, part->outline);
 }
 
 /*
  * This function is executed in a parallel region based on layer_nr.
  * When modifying make sure any changes does not introduce data races.
  *
- * generateWalls only reads and writes data for the current layer
+ * generateWalls only reads and writes data for the current layer, and for each part only the data of that part, so
+ * the parts are processed in parallel too. That way a layer with many parts doesn't hold up the other layers.
  */
 void WallsComputation::generateWalls(SliceLayer* layer, SectionType section)
 {
-    for (SliceLayerPart& part : layer->parts)
+    if (layer->parts.size() > 1)
     {
-        generateWalls(&part, section);
+        // A layer often has one big part and many small ones, like a plate with pegs on it, so the parts are divided
+        // over the threads by their number of vertices. Each part only writes its own walls, so the result doesn't
+        // depend on which thread did which part.
+        cura::parallel_for_guided<size_t>(
+            0,
+            layer->parts.size(),
+            [&](const size_t part_idx)
+            {
+                generateWalls(&layer->parts[part_idx], section);
+            },
+            [&layer](const size_t part_idx)
+            {
+                return layer->parts[part_idx].outline.pointCount() + 1;
+            });
+    }
+    else
+    {
+        for (SliceLayerPart& part : layer->parts)
+        {
+            generateWalls(&part, section);
+        }
     }
 
     // Remove the parts which did not generate a wall. As these parts are too small to print,
@@ -130,12 +157,17 @@ void WallsComputation::generateSpiralInsets(SliceLayerPart* part, coord_t line_w
     part->spiral_wall.removeDegenerateVerts();
     if (recompute_outline_based_on_outer_wall)
     {
-        part->print_outline = part->spiral_wall.offset(line_width_0 / 2, ClipperLib::jtSquare);
+        setPrintOutline(part, part->spiral_wall.offset(line_width_0 / 2, ClipperLib::jtSquare));
     }
     else
     {
-        part->print_outline = part->outline;
+        setPrintOutline(part, part->outline);
     }
 }
 
+void WallsComputation::setPrintOutline(SliceLayerPart* part, const Polygons& print_outline)
+{
+    part->print_outline = outline_pool_ ? outline_pool_->intern(print_outline) : CompactPolygons(print_outline);
+}
+
 } // namespace cura
@@ -11,26 +11,10 @@
 namespace cura
 {
 
-double bridgeAngle(
-    const Settings& settings,
-    const Polygons& skin_outline,
-    const SliceDataStorage& storage,
-    const unsigned layer_nr,
-    const unsigned bridge_layer,
-    const SupportLayer* support_layer,
-    Polygons& supported_regions)
+SolidBelow::SolidBelow(const SliceDataStorage& storage, const LayerIndex layer_nr, const unsigned bridge_layer, const Ratio sparse_infill_max_density)
+    : bridge_layer_(bridge_layer)
+    , sparse_infill_max_density_(sparse_infill_max_density)
 {
-    assert(! skin_outline.empty());
-    AABB boundary_box(skin_outline);
-
-    // To detect if we have a bridge, first calculate the intersection of the current layer with the previous layer.
-    //  This gives us the islands that the layer rests on.
-    Polygons islands;
-
-    Polygons prev_layer_outline; // we also want the complete outline of the previous layer
-
-    const Ratio sparse_infill_max_density = settings.get<Ratio>("bridge_sparse_infill_max_density");
-
     // include parts from all meshes
     for (const std::shared_ptr<SliceMeshStorage>& mesh_ptr : storage.meshes)
     {
@@ -44,20 +28,45 @@ double bridgeAngle(
 
             for (const SliceLayerPart& prev_layer_part : mesh.layers[layer_nr - bridge_layer].parts)
             {
-                Polygons solid_below(prev_layer_part.outline);
-                if (bridge_layer == 1 && part_has_sparse_infill)
-                {
-                    solid_below = solid_below.difference(prev_layer_part.getOwnInfillArea());
-                }
-                prev_layer_outline.add(solid_below); // not intersected with skin
-
-                if (! boundary_box.hit(prev_layer_part.boundaryBox))
-                    continue;
-
-                islands.add(skin_outline.intersection(solid_below));
+                parts_.push_back(Part{ &prev_layer_part, bridge_layer == 1 && part_has_sparse_infill, std::nullopt });
             }
         }
     }
+}
+
+std::vector<const Polygons*> SolidBelow::near(const AABB& box)
+{
+    std::vector<const Polygons*> result;
+    for (Part& part : parts_)
+    {
+        if (! box.hit(part.part->boundaryBox))
+        {
+            continue;
+        }
+        if (! part.area.has_value())
+        {
+            part.area = part.without_infill ? part.part->outline.difference(part.part->getOwnInfillArea()) : Polygons(part.part->outline);
+        }
+        result.push_back(&part.area.value());
+    }
+    return result;
+}
+
+double bridgeAngle(const Settings& settings, const Polygons& skin_outline, SolidBelow& solid_below, const SupportLayer* support_layer, Polygons& supported_regions)
+{
+    assert(! skin_outline.empty());
+    AABB boundary_box(skin_outline);
+
+    // To detect if we have a bridge, first calculate the intersection of the current layer with the previous layer.
+    //  This gives us the islands that the layer rests on.
+    Polygons islands;
+
+    Polygons support_below; // we also want the support of the previous layer, as part of its complete outline
+
+    for (const Polygons* solid_part_below : solid_below.near(boundary_box))
+    {
+        islands.add(skin_outline.intersection(*solid_part_below));
+    }
     supported_regions = islands;
 
     if (support_layer)
@@ -73,7 +82,7 @@ double bridgeAngle(
             AABB support_roof_bb(support_layer->support_roof);
             if (boundary_box.hit(support_roof_bb))
             {
-                prev_layer_outline.add(support_layer->support_roof); // not intersected with skin
+                support_below.add(support_layer->support_roof); // not intersected with skin
 
                 Polygons supported_skin(skin_outline.intersection(support_layer->support_roof));
                 if (! supported_skin.empty())
@@ -89,7 +98,7 @@ double bridgeAngle(
                 AABB support_part_bb(support_part.getInfillArea());
                 if (boundary_box.hit(support_part_bb))
                 {
-                    prev_layer_outline.add(support_part.getInfillArea()); // not intersected with skin
+                    support_below.add(support_part.getInfillArea()); // not intersected with skin
 
                     Polygons supported_skin(skin_outline.intersection(support_part.getInfillArea()));
                     if (! supported_skin.empty())
@@ -119,6 +128,14 @@ double bridgeAngle(
         // the air boundary do appear to be supported
 
         const coord_t bb_max_dim = std::max(boundary_box.max_.X - boundary_box.min_.X, boundary_box.max_.Y - boundary_box.min_.Y);
+        // Only the parts of the previous layer within reach of the grown bounding box can make a difference.
+        AABB air_box = boundary_box;
+        air_box.expand(bb_max_dim);
+        Polygons prev_layer_outline = support_below;
+        for (const Polygons* solid_part_below : solid_below.near(air_box))
+        {
+            prev_layer_outline.add(*solid_part_below); // not intersected with skin
+        }
         const Polygons air_below(bb_poly.offset(bb_max_dim).difference(prev_layer_outline).offset(-10));
 
         Polygons skin_perimeter_lines;
@@ -17,6 +17,7 @@
 #include <sentry.h>
 #endif
 
+#include <algorithm> //To check the points left out of the layer view data.
 #include <thread> //To sleep while waiting for the connection.
 #include <unordered_map> //To map settings to their extruder numbers for limit_to_extruder.
 
@@ -32,11 +33,16 @@
 #include "Slice.h" //To process slices.
 #include "communication/ArcusCommunicationPrivate.h" //Our PIMPL.
 #include "communication/Listener.h" //To listen to the Arcus socket.
+#include "communication/PayloadCompression.h" //To compress the g-code and layer view data, if the front-end supports it.
 #include "communication/SliceDataStruct.h" //To store sliced layer data.
 #include "plugins/slots.h"
+#include "progress/PrintEstimateExtrapolator.h" //To send the estimates while slicing.
 #include "settings/types/LayerIndex.h" //To point to layers.
 #include "settings/types/Velocity.h" //To send to layer view how fast stuff is printing.
+#include "utils/Cancellation.h" //To stop a slice when the front-end sends a new one.
+#include "utils/MemoryUsage.h" //To report how much memory the engine holds along with the progress.
 #include "utils/channel.h"
+#include "utils/linearAlg2D.h" //To check how far the layer view data deviates from the toolpaths.
 #include "utils/polygon.h"
 
 namespace cura
@@ -68,6 +74,11 @@ class ArcusCommunication::PathCompiler
                                //!< the dimensionality of the point.
 
     Point2LL last_point;
+    Point2LL last_segment_start; //!< Where the last line segment starts, i.e. the point before last_point.
+    std::vector<Point2LL> merged_points; //!< The points that were left out of the last line segment, because they are within the preview tolerance of it.
+
+    //! The most points that are left out of a single line segment, to bound the time spent checking them.
+    static constexpr size_t max_merged_points = 32;
 
     PathCompiler(const PathCompiler&) = delete;
     PathCompiler& operator=(const PathCompiler&) = delete;
@@ -87,6 +98,7 @@ public:
         , line_velocities()
         , points()
         , last_point{ 0, 0 }
+        , last_segment_start{ 0, 0 }
     {
     }
 
@@ -171,31 +183,40 @@ public:
         proto::PathSegment* path_segment = proto_layer->add_path_segment();
         path_segment->set_extruder(extruder);
         path_segment->set_point_type(data_point_type);
+        const bool compress = _cs_private_data.payload_compression == proto::Deflate;
+        path_segment->set_compression(_cs_private_data.payload_compression);
 
         std::string line_type_data;
         line_type_data.append(reinterpret_cast<const char*>(line_types.data()), line_types.size() * sizeof(PrintFeatureType));
         line_types.clear();
-        path_segment->set_line_type(line_type_data);
+        path_segment->set_line_type(compress ? deflatePayload(line_type_data) : line_type_data);
 
         std::string polygon_data;
-        polygon_data.append(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(float));
+        if (compress)
+        {
+            polygon_data = deflatePayload(encodeCoordinateDeltas(points, data_point_type == proto::PathSegment::Point3D ? 3 : 2));
+        }
+        else
+        {
+            polygon_data.append(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(float));
+        }
         points.clear();
         path_segment->set_points(polygon_data);
 
         std::string line_width_data;
         line_width_data.append(reinterpret_cast<const char*>(line_widths.data()), line_widths.size() * sizeof(float));
         line_widths.clear();
-        path_segment->set_line_width(line_width_data);
+        path_segment->set_line_width(compress ? deflatePayload(line_width_data) : line_width_data);
 
         std::string line_thickness_data;
         line_thickness_data.append(reinterpret_cast<const char*>(line_thicknesses.data()), line_thicknesses.size() * sizeof(float));
         line_thicknesses.clear();
-        path_segment->set_line_thickness(line_thickness_data);
+        path_segment->set_line_thickness(compress ? deflatePayload(line_thickness_data) : line_thickness_data);
 
         std::string line_velocity_data;
         line_velocity_data.append(reinterpret_cast<const char*>(line_velocities.data()), line_velocities.size() * sizeof(float));
         line_velocities.clear();
-        path_segment->set_line_feedrate(line_velocity_data);
+        path_segment->set_line_feedrate(compress ? deflatePayload(line_velocity_data) : line_velocity_data);
     }
 
     /*!
@@ -291,12 +312,56 @@ private:
      */
     void addLineSegment(const PrintFeatureType& print_feature_type, const Point2LL& point, const coord_t& width, const coord_t& thickness, const Velocity& velocity)
     {
+        if (canExtendLastSegment(print_feature_type, point, width, thickness, velocity))
+        {
+            // Move the end of the last line segment to the new point instead.
+            merged_points.push_back(last_point);
+            points.resize(points.size() - 2);
+            addPoint2D(point);
+            return;
+        }
+        merged_points.clear();
+        last_segment_start = last_point;
         addPoint2D(point);
         line_types.push_back(print_feature_type);
         line_widths.push_back(INT2MM(width));
         line_thicknesses.push_back(INT2MM(thickness));
         line_velocities.push_back(velocity);
     }
+
+    /*!
+     * \brief Whether a line segment to \p point can be sent by extending the
+     * last line segment to it instead, leaving out the point in between.
+     *
+     * That is the case if the front-end asked for a preview tolerance, the line
+     * segments print the same, and the points that are left out of the
+     * extended line segment are all within the tolerance of it.
+     */
+    bool canExtendLastSegment(const PrintFeatureType& print_feature_type, const Point2LL& point, const coord_t& width, const coord_t& thickness, const Velocity& velocity) const
+    {
+        const coord_t tolerance = _cs_private_data.preview_tolerance;
+        if (tolerance <= 0 || line_types.empty() || merged_points.size() >= max_merged_points)
+        {
+            return false;
+        }
+        if (line_types.back() != print_feature_type || line_widths.back() != static_cast<float>(INT2MM(width))
+            || line_thicknesses.back() != static_cast<float>(INT2MM(thickness)) || line_velocities.back() != static_cast<float>(velocity))
+        {
+            return false;
+        }
+        const coord_t max_dist2 = tolerance * tolerance;
+        if (LinearAlg2D::getDist2FromLineSegment(last_segment_start, last_point, point) > max_dist2)
+        {
+            return false;
+        }
+        return std::all_of(
+            merged_points.begin(),
+            merged_points.end(),
+            [this, &point, max_dist2](const Point2LL& merged_point)
+            {
+                return LinearAlg2D::getDist2FromLineSegment(last_segment_start, merged_point, point) <= max_dist2;
+            });
+    }
 };
 
 ArcusCommunication::ArcusCommunication()
@@ -305,6 +370,11 @@ ArcusCommunication::ArcusCommunication()
 {
 }
 
+void ArcusCommunication::setLayerStreaming(const bool stream_layers)
+{
+    private_data->stream_layers = stream_layers;
+}
+
 ArcusCommunication::~ArcusCommunication()
 {
     spdlog::info("Closing connection.");
@@ -355,19 +425,9 @@ void ArcusCommunication::beginGCode()
 
 void ArcusCommunication::flushGCode()
 {
-    std::string gcode_output_stream = private_data->gcode_output_stream.str();
-    auto message_str = slots::instance().modify<plugins::v0::SlotID::POSTPROCESS_MODIFY>(gcode_output_stream);
-    if (message_str.size() == 0)
-    {
-        return;
-    }
-    std::shared_ptr<proto::GCodeLayer> message = std::make_shared<proto::GCodeLayer>();
-    message->set_data(message_str);
-
-    // Send the g-code to the front-end! Yay!
-    private_data->socket->sendMessage(message);
-
-    private_data->gcode_output_stream.str("");
+    FffProcessor::getInstance()->flushTargetStream(); // The g-code is written to the stream on another thread.
+    // Full chunks were sent while the g-code was written already. Send the rest of the layer.
+    private_data->gcode_output_sink.flush();
 }
 
 bool ArcusCommunication::isSequential() const
@@ -375,6 +435,11 @@ bool ArcusCommunication::isSequential() const
     return false; // We don't necessarily need to send the start g-code before the rest. We can send it afterwards when we have more accurate print statistics.
 }
 
+bool ArcusCommunication::isPersistent() const
+{
+    return true;
+}
+
 bool ArcusCommunication::hasSlice() const
 {
     return private_data->socket->getState() != Arcus::SocketState::Closed && private_data->socket->getState() != Arcus::SocketState::Error
@@ -425,23 +490,29 @@ void ArcusCommunication::sendOptimizedLayerData()
     path_compiler->flushPathSegments(); // Make sure the last path segment has been flushed from the compiler.
 
     SliceDataStruct<proto::LayerOptimized>& data = private_data->optimized_layers;
+    std::lock_guard<std::mutex> lock(private_data->optimized_layers_mutex);
     data.sliced_objects++;
     data.current_layer_offset = data.current_layer_count;
-    if (data.sliced_objects < private_data->object_count) // Nothing to send.
+    private_data->streamed_layer_nr.reset();
+    if (data.sliced_objects < private_data->object_count && ! private_data->stream_layers) // Nothing to send.
     {
         return;
     }
-    spdlog::info("Sending {} layers.", data.current_layer_count);
+    spdlog::info("Sending {} layers.", data.slice_data.size());
 
     for (const auto& entry : data.slice_data) // Note: This is in no particular order!
     {
         spdlog::debug("Sending layer data for layer {} of {}.", entry.first, data.slice_data.size());
         private_data->socket->sendMessage(entry.second); // Send the actual layers.
     }
+    data.slice_data.clear();
+    if (data.sliced_objects < private_data->object_count) // When streaming, the layers of the next object follow the ones that were just sent.
+    {
+        return;
+    }
     data.sliced_objects = 0;
     data.current_layer_count = 0;
     data.current_layer_offset = 0;
-    data.slice_data.clear();
 }
 
 void ArcusCommunication::sendPolygon(
@@ -462,25 +533,36 @@ void ArcusCommunication::sendPolygons(const PrintFeatureType& type, const Polygo
     }
 }
 
+namespace
+{
+
+/*!
+ * Fill in the print time for each feature of an estimates message.
+ */
+void setPrintTimeEstimates(proto::PrintTimeMaterialEstimates& message, const std::vector<Duration>& time_estimates)
+{
+    message.set_time_infill(time_estimates[static_cast<unsigned char>(PrintFeatureType::Infill)]);
+    message.set_time_inset_0(time_estimates[static_cast<unsigned char>(PrintFeatureType::OuterWall)]);
+    message.set_time_inset_x(time_estimates[static_cast<unsigned char>(PrintFeatureType::InnerWall)]);
+    message.set_time_none(time_estimates[static_cast<unsigned char>(PrintFeatureType::NoneType)]);
+    message.set_time_retract(time_estimates[static_cast<unsigned char>(PrintFeatureType::MoveRetraction)]);
+    message.set_time_skin(time_estimates[static_cast<unsigned char>(PrintFeatureType::Skin)]);
+    message.set_time_skirt(time_estimates[static_cast<unsigned char>(PrintFeatureType::SkirtBrim)]);
+    message.set_time_support(time_estimates[static_cast<unsigned char>(PrintFeatureType::Support)]);
+    message.set_time_support_infill(time_estimates[static_cast<unsigned char>(PrintFeatureType::SupportInfill)]);
+    message.set_time_support_interface(time_estimates[static_cast<unsigned char>(PrintFeatureType::SupportInterface)]);
+    message.set_time_travel(time_estimates[static_cast<unsigned char>(PrintFeatureType::MoveCombing)]);
+    message.set_time_prime_tower(time_estimates[static_cast<unsigned char>(PrintFeatureType::PrimeTower)]);
+}
+
+} // namespace
+
 void ArcusCommunication::sendPrintTimeMaterialEstimates() const
 {
     spdlog::debug("Sending print time and material estimates.");
     std::shared_ptr<proto::PrintTimeMaterialEstimates> message = std::make_shared<proto::PrintTimeMaterialEstimates>();
 
-    std::vector<Duration> time_estimates = FffProcessor::getInstance()->getTotalPrintTimePerFeature();
-    message->set_time_infill(time_estimates[static_cast<unsigned char>(PrintFeatureType::Infill)]);
-    message->set_time_inset_0(time_estimates[static_cast<unsigned char>(PrintFeatureType::OuterWall)]);
-    message->set_time_inset_x(time_estimates[static_cast<unsigned char>(PrintFeatureType::InnerWall)]);
-    message->set_time_none(time_estimates[static_cast<unsigned char>(PrintFeatureType::NoneType)]);
-    message->set_time_retract(time_estimates[static_cast<unsigned char>(PrintFeatureType::MoveRetraction)]);
-    message->set_time_skin(time_estimates[static_cast<unsigned char>(PrintFeatureType::Skin)]);
-    message->set_time_skirt(time_estimates[static_cast<unsigned char>(PrintFeatureType::SkirtBrim)]);
-    message->set_time_support(time_estimates[static_cast<unsigned char>(PrintFeatureType::Support)]);
-    message->set_time_support_infill(time_estimates[static_cast<unsigned char>(PrintFeatureType::SupportInfill)]);
-    message->set_time_support_interface(time_estimates[static_cast<unsigned char>(PrintFeatureType::SupportInterface)]);
-    message->set_time_travel(time_estimates[static_cast<unsigned char>(PrintFeatureType::MoveCombing)]);
-    message->set_time_prime_tower(time_estimates[static_cast<unsigned char>(PrintFeatureType::PrimeTower)]);
-
+    setPrintTimeEstimates(*message, FffProcessor::getInstance()->getTotalPrintTimePerFeature());
     for (size_t extruder_nr = 0; extruder_nr < Application::getInstance().current_slice_->scene.extruders.size(); extruder_nr++)
     {
         proto::MaterialEstimates* material_message = message->add_materialestimates();
@@ -488,10 +570,29 @@ void ArcusCommunication::sendPrintTimeMaterialEstimates() const
         material_message->set_material_amount(FffProcessor::getInstance()->getTotalFilamentUsed(extruder_nr));
     }
 
+    {
+        std::lock_guard<std::mutex> lock(private_data->running_estimates_mutex);
+        private_data->running_estimates.reset(); // These are final.
+    }
     private_data->socket->sendMessage(message);
     spdlog::debug("Done sending print time and material estimates.");
 }
 
+void ArcusCommunication::sendRunningEstimates(const PrintEstimates& estimates) const
+{
+    std::shared_ptr<proto::PrintTimeMaterialEstimates> message = std::make_shared<proto::PrintTimeMaterialEstimates>();
+    setPrintTimeEstimates(*message, estimates.print_time_per_feature);
+    for (size_t extruder_nr = 0; extruder_nr < estimates.material_per_extruder.size(); extruder_nr++)
+    {
+        proto::MaterialEstimates* material_message = message->add_materialestimates();
+        material_message->set_id(extruder_nr);
+        material_message->set_material_amount(estimates.material_per_extruder[extruder_nr]);
+    }
+
+    std::lock_guard<std::mutex> lock(private_data->running_estimates_mutex);
+    private_data->running_estimates = std::move(message);
+}
+
 void ArcusCommunication::sendProgress(double progress) const
 {
     const int rounded_amount = 1000 * progress;
@@ -504,6 +605,17 @@ void ArcusCommunication::sendProgress(double progress) const
     double progress_all_objects = progress / private_data->object_count;
     progress_all_objects += private_data->optimized_layers.sliced_objects * (1.0 / private_data->object_count);
     message->set_amount(progress_all_objects);
+    const MemoryUsage memory = MemoryUsage::sample();
+    message->set_resident_bytes(memory.resident_bytes);
+    message->set_peak_resident_bytes(memory.peak_resident_bytes);
+    {
+        std::lock_guard<std::mutex> lock(private_data->running_estimates_mutex);
+        if (private_data->running_estimates)
+        {
+            message->mutable_estimates()->Swap(private_data->running_estimates.get());
+            private_data->running_estimates.reset();
+        }
+    }
     private_data->socket->sendMessage(message);
 
     private_data->last_sent_progress = rounded_amount;
@@ -511,7 +623,17 @@ void ArcusCommunication::sendProgress(double progress) const
 
 void ArcusCommunication::setLayerForSend(const LayerIndex::value_type& layer_nr)
 {
-    path_compiler->setLayer(layer_nr);
+    path_compiler->setLayer(layer_nr); // Flushes the path segments of the previous layer.
+    if (! private_data->stream_layers)
+    {
+        return;
+    }
+    if (private_data->streamed_layer_nr && *private_data->streamed_layer_nr != layer_nr)
+    {
+        // Layers are written in order, so the previous layer is complete. Send it right away rather than keeping it until the end of the slice.
+        private_data->sendOptimizedLayer(*private_data->streamed_layer_nr);
+    }
+    private_data->streamed_layer_nr = layer_nr;
 }
 
 void ArcusCommunication::setExtruderForSend(const ExtruderTrain& extruder)
@@ -560,6 +682,10 @@ void ArcusCommunication::sliceNext()
 
     Slice slice(slice_message->object_lists().size());
     Application::getInstance().current_slice_ = &slice;
+    // Only compress what the front-end told us it can decompress. Older front-ends don't set this at all.
+    private_data->payload_compression = slice_message->accepted_compression() == proto::Deflate ? proto::Deflate : proto::Uncompressed;
+    // Likewise, only leave out vertices of the layer view if the front-end asked for it.
+    private_data->preview_tolerance = std::max(coord_t(0), MM2INT(slice_message->preview_tolerance()));
 
     private_data->readGlobalSettingsMessage(slice_message->global_settings());
     private_data->readExtruderSettingsMessage(slice_message->extruders());
@@ -589,18 +715,50 @@ void ArcusCommunication::sliceNext()
     }
     spdlog::debug("Done reading Slice message.");
 
+    bool cancelled = false;
     if (! slice.scene.mesh_groups.empty())
     {
-        slice.compute();
-        FffProcessor::getInstance()->finalize();
-        flushGCode();
-        sendPrintTimeMaterialEstimates();
-        sendFinishedSlicing();
+        // A message that arrives from now on replaces this slice, so it should stop as soon as possible.
+        Cancellation::beginSlice();
+        try
+        {
+            slice.compute();
+            FffProcessor::getInstance()->finalize();
+            flushGCode();
+            sendPrintTimeMaterialEstimates();
+            sendFinishedSlicing();
+            private_data->slice_count++;
+        }
+        catch (const SliceCancelled&)
+        {
+            // The cancelled slice didn't finish, so it doesn't count towards the slices of this run and the new message is sliced next.
+            spdlog::info("Cancelled the slice, since the front-end sent a new message.");
+            // Nothing of the cancelled slice may end up in the output of the next one.
+            path_compiler->flushPathSegments();
+            {
+                std::lock_guard<std::mutex> lock(private_data->optimized_layers_mutex);
+                SliceDataStruct<proto::LayerOptimized>& data = private_data->optimized_layers;
+                data.slice_data.clear();
+                data.sliced_objects = 0;
+                data.current_layer_count = 0;
+                data.current_layer_offset = 0;
+                private_data->streamed_layer_nr.reset();
+            }
+            {
+                std::lock_guard<std::mutex> lock(private_data->running_estimates_mutex);
+                private_data->running_estimates.reset();
+            }
+            private_data->gcode_output_sink.discard();
+            cancelled = true;
+        }
+        Cancellation::endSlice();
         slice.reset();
-        private_data->slice_count++;
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(250)); // Pause before checking again for a slice message.
+    if (! cancelled) // The message that cancelled the slice is waiting already.
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250)); // Pause before checking again for a slice message.
+    }
 }
 
 } // namespace cura
@@ -5,14 +5,21 @@
 
 #include "communication/ArcusCommunicationPrivate.h"
 
+#include <cstring> //For memcpy.
+#include <vector>
+
+#include <Arcus/Socket.h> //To send the g-code.
 #include <spdlog/spdlog.h>
 
 #include "Application.h"
 #include "ExtruderTrain.h"
 #include "Slice.h"
+#include "communication/PayloadCompression.h" //To compress the g-code, if the front-end supports it.
+#include "plugins/slots.h"
 #include "settings/types/LayerIndex.h"
 #include "utils/Matrix4x3D.h" //To convert vertices to integer-points.
 #include "utils/Point3F.h" //To accept vertices (which are provided in floating point).
+#include "utils/ThreadPool.h" //To decode the vertices in parallel.
 
 namespace cura
 {
@@ -20,6 +27,15 @@ namespace cura
 ArcusCommunication::Private::Private()
     : socket(nullptr)
     , object_count(0)
+    , gcode_output_sink(
+          [this](std::string&& gcode)
+          {
+              sendGCodeChunk(std::move(gcode));
+          })
+    , gcode_output_stream(&gcode_output_sink)
+    , stream_layers(false)
+    , payload_compression(proto::Uncompressed)
+    , preview_tolerance(0)
     , last_sent_progress(-1)
     , slice_count(0)
     , millisecUntilNextTry(100)
@@ -28,6 +44,7 @@ ArcusCommunication::Private::Private()
 
 std::shared_ptr<proto::LayerOptimized> ArcusCommunication::Private::getOptimizedLayerById(LayerIndex::value_type layer_nr)
 {
+    std::lock_guard<std::mutex> lock(optimized_layers_mutex);
     layer_nr += optimized_layers.current_layer_offset;
     std::unordered_map<int, std::shared_ptr<proto::LayerOptimized>>::iterator find_result = optimized_layers.slice_data.find(layer_nr);
 
@@ -45,6 +62,23 @@ std::shared_ptr<proto::LayerOptimized> ArcusCommunication::Private::getOptimized
     }
 }
 
+void ArcusCommunication::Private::sendOptimizedLayer(LayerIndex::value_type layer_nr)
+{
+    std::shared_ptr<proto::LayerOptimized> layer;
+    {
+        std::lock_guard<std::mutex> lock(optimized_layers_mutex);
+        const auto find_result = optimized_layers.slice_data.find(layer_nr + optimized_layers.current_layer_offset);
+        if (find_result == optimized_layers.slice_data.end())
+        {
+            return;
+        }
+        layer = std::move(find_result->second);
+        optimized_layers.slice_data.erase(find_result);
+    }
+    spdlog::debug("Sending layer data for layer {}.", layer->id());
+    socket->sendMessage(layer);
+}
+
 void ArcusCommunication::Private::readGlobalSettingsMessage(const proto::SettingList& global_settings_message)
 {
     Slice* slice = Application::getInstance().current_slice_;
@@ -122,17 +156,20 @@ void ArcusCommunication::Private::readMeshGroupMessage(const proto::ObjectList&
         ExtruderTrain& extruder = mesh.settings_.get<ExtruderTrain&>("extruder_nr"); // Set the parent setting to the correct extruder.
         mesh.settings_.setParent(&extruder.settings_);
 
-        for (size_t face = 0; face < face_count; face++)
-        {
-            const std::string data = object.vertices().substr(face * bytes_per_face, bytes_per_face);
-            const Point3F* float_vertices = reinterpret_cast<const Point3F*>(data.data());
-
-            Point3LL verts[3];
-            verts[0] = matrix.apply(float_vertices[0].toPoint3d());
-            verts[1] = matrix.apply(float_vertices[1].toPoint3d());
-            verts[2] = matrix.apply(float_vertices[2].toPoint3d());
-            mesh.addFace(verts[0], verts[1], verts[2]);
-        }
+        // Decode and transform the triangle soup in parallel chunks, straight from the message's buffer.
+        const char* data = object.vertices().data();
+        std::vector<Point3LL> corners(face_count * 3);
+        cura::parallel_for<size_t>(
+            0,
+            face_count * 3,
+            [&](size_t corner_idx)
+            {
+                float v[3];
+                memcpy(v, data + corner_idx * sizeof(v), sizeof(v)); // The buffer is not guaranteed to be aligned.
+                corners[corner_idx] = matrix.apply(Point3F(v[0], v[1], v[2]).toPoint3d());
+            },
+            4096);
+        mesh.addFaces(corners);
 
         mesh.mesh_name_ = object.name();
         mesh.finish();
@@ -141,6 +178,21 @@ void ArcusCommunication::Private::readMeshGroupMessage(const proto::ObjectList&
     mesh_group.finalize();
 }
 
+void ArcusCommunication::Private::sendGCodeChunk(std::string&& gcode)
+{
+    auto message_str = slots::instance().modify<plugins::v0::SlotID::POSTPROCESS_MODIFY>(gcode);
+    if (message_str.size() > 0)
+    {
+        std::shared_ptr<proto::GCodeLayer> message = std::make_shared<proto::GCodeLayer>();
+        message->set_compression(payload_compression);
+        message->set_data(payload_compression == proto::Deflate ? deflatePayload(message_str) : std::move(message_str));
+
+        // Send the g-code to the front-end! Yay!
+        socket->sendMessage(message);
+    }
+    gcode_output_sink.getPool().release(std::move(gcode));
+}
+
 } // namespace cura
 
 #endif // ARCUS
@@ -3,7 +3,10 @@
 
 #include "communication/CommandLine.h"
 
+#include <algorithm> //For std::find_if.
 #include <cerrno> // error number when trying to read file
+#include <cstdio> //To flush the estimates to stdout.
+#include <cstdlib> //For strtoul.
 #include <cstring> //For strtok and strcopy.
 #include <filesystem>
 #include <fstream> //To check if files exist.
@@ -15,6 +18,7 @@
 #include <string>
 #include <unordered_set>
 
+#include <fmt/format.h>
 #include <range/v3/all.hpp>
 #include <spdlog/details/os.h>
 #include <spdlog/spdlog.h>
@@ -22,8 +26,11 @@
 #include "Application.h" //To get the extruders for material estimates.
 #include "ExtruderTrain.h"
 #include "FffProcessor.h" //To start a slice and get time estimates.
+#include "PrintFeature.h" //To name the features in the time estimates.
 #include "Slice.h"
+#include "progress/PrintEstimateExtrapolator.h" //To log the estimates while slicing.
 #include "utils/Matrix4x3D.h" //For the mesh_rotation_matrix setting.
+#include "utils/Trace.h" //To trace the slice when asked to.
 #include "utils/format/filesystem_path.h"
 #include "utils/views/split_paths.h"
 
@@ -35,15 +42,30 @@ namespace cura
 {
 
 CommandLine::CommandLine(const std::vector<std::string>& arguments)
-    : arguments_{ arguments }
-    , last_shown_progress_{ 0 }
+    : last_shown_progress_{ 0 }
 {
+    setArguments(arguments);
+    if (auto cache_directory = spdlog::details::os::getenv("CURA_ENGINE_DEFINITION_CACHE"); ! cache_directory.empty())
+    {
+        definition_cache_.emplace(cache_directory);
+    }
+}
+
+void CommandLine::setArguments(const std::vector<std::string>& arguments)
+{
+    arguments_ = arguments;
+    search_directories_.clear();
     if (auto search_paths = spdlog::details::os::getenv("CURA_ENGINE_SEARCH_PATH"); ! search_paths.empty())
     {
         search_directories_ = search_paths | views::split_paths | ranges::to<std::vector<std::filesystem::path>>();
     };
 }
 
+void CommandLine::abortSlice()
+{
+    exit(1);
+}
+
 // These are not applicable to command line slicing.
 void CommandLine::beginGCode()
 {
@@ -89,6 +111,11 @@ bool CommandLine::isSequential() const
     return true; // We have to receive the g-code in sequential order. Start g-code before the rest and so on.
 }
 
+bool CommandLine::isPersistent() const
+{
+    return false;
+}
+
 void CommandLine::sendGCodePrefix(const std::string&) const
 {
     // TODO: Right now this is done directly in the g-code writer. For consistency it should be moved here?
@@ -110,6 +137,54 @@ void CommandLine::sendPrintTimeMaterialEstimates() const
     {
         sum += FffProcessor::getInstance()->getTotalFilamentUsed(static_cast<int>(extruder_nr));
     }
+
+    if (estimate_only_)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("time_total");
+        writer.Double(std::accumulate(time_estimates.begin(), time_estimates.end(), 0.0));
+        for (const auto& [key, feature] : { std::make_pair("time_infill", PrintFeatureType::Infill),
+                                            std::make_pair("time_inset_0", PrintFeatureType::OuterWall),
+                                            std::make_pair("time_inset_x", PrintFeatureType::InnerWall),
+                                            std::make_pair("time_none", PrintFeatureType::NoneType),
+                                            std::make_pair("time_retract", PrintFeatureType::MoveRetraction),
+                                            std::make_pair("time_skin", PrintFeatureType::Skin),
+                                            std::make_pair("time_skirt", PrintFeatureType::SkirtBrim),
+                                            std::make_pair("time_support", PrintFeatureType::Support),
+                                            std::make_pair("time_support_infill", PrintFeatureType::SupportInfill),
+                                            std::make_pair("time_support_interface", PrintFeatureType::SupportInterface),
+                                            std::make_pair("time_travel", PrintFeatureType::MoveCombing),
+                                            std::make_pair("time_prime_tower", PrintFeatureType::PrimeTower) })
+        {
+            writer.Key(key);
+            writer.Double(time_estimates[static_cast<unsigned char>(feature)]);
+        }
+        writer.Key("materialEstimates");
+        writer.StartArray();
+        for (size_t extruder_nr = 0; extruder_nr < Application::getInstance().current_slice_->scene.extruders.size(); extruder_nr++)
+        {
+            writer.StartObject();
+            writer.Key("id");
+            writer.Uint64(extruder_nr);
+            writer.Key("material_amount");
+            writer.Double(FffProcessor::getInstance()->getTotalFilamentUsed(static_cast<int>(extruder_nr)));
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        fmt::print("{}\n", buffer.GetString());
+        std::fflush(stdout);
+    }
+}
+
+void CommandLine::sendRunningEstimates(const PrintEstimates& estimates) const
+{
+    spdlog::debug(
+        "Estimating the print to take {:.0f}s and {:.0f}mm^3 of material so far.",
+        std::accumulate(estimates.print_time_per_feature.begin(), estimates.print_time_per_feature.end(), 0.0),
+        std::accumulate(estimates.material_per_extruder.begin(), estimates.material_per_extruder.end(), 0.0));
 }
 
 void CommandLine::sendProgress(double progress) const
@@ -131,6 +206,9 @@ void CommandLine::sendProgress(double progress) const
 void CommandLine::sliceNext()
 {
     FffProcessor::getInstance()->time_keeper.restart();
+    estimate_only_ = false;
+    FffProcessor::getInstance()->disableDraftEstimate();
+    trace_file_.reset();
 
     // Count the number of mesh groups to slice for.
     size_t num_mesh_groups = 1;
@@ -178,7 +256,7 @@ void CommandLine::sliceNext()
                         // This prevents the "something went wrong" dialogue on Windows to pop up on a thrown exception.
                         // Only ClipperLib currently throws exceptions. And only in the case that it makes an internal error.
                         spdlog::error("Unknown exception!");
-                        exit(1);
+                        abortSlice();
                     }
                 }
                 else if (argument.starts_with("--force-read-parent") || argument.starts_with("--force_read_parent"))
@@ -198,6 +276,55 @@ void CommandLine::sliceNext()
                     force_read_parent = false;
                     force_read_nondefault = false;
                 }
+                else if (argument == "--toolpaths")
+                {
+                    argument_index++;
+                    if (argument_index >= arguments_.size())
+                    {
+                        spdlog::error("Missing output directory with --toolpaths argument.");
+                        abortSlice();
+                    }
+                    argument = arguments_[argument_index];
+                    if (! FffProcessor::getInstance()->setToolpathDirectory(argument))
+                    {
+                        spdlog::error("Failed to open {} for the toolpaths.", argument);
+                        abortSlice();
+                    }
+                }
+                else if (argument == "--trace")
+                {
+                    argument_index++;
+                    if (argument_index >= arguments_.size())
+                    {
+                        spdlog::error("Missing output file with --trace argument.");
+                        abortSlice();
+                    }
+                    trace_file_ = arguments_[argument_index];
+                    Trace::enable();
+                }
+                else if (argument == "--estimate-only")
+                {
+                    spdlog::info("Only estimating the print time and material, not writing any g-code.");
+                    estimate_only_ = true;
+                }
+                else if (argument == "--draft-estimate")
+                {
+                    argument_index++;
+                    if (argument_index >= arguments_.size())
+                    {
+                        spdlog::error("Missing layer step with --draft-estimate argument.");
+                        abortSlice();
+                    }
+                    const size_t layer_step = std::strtoul(arguments_[argument_index].c_str(), nullptr, 10);
+                    spdlog::info("Only making a draft estimate of the print time and material from every {} layers, not slicing.", layer_step);
+                    FffProcessor::getInstance()->enableDraftEstimate(layer_step);
+                    estimate_only_ = true;
+                }
+                else if (argument == "--toolpaths-only")
+                {
+                    spdlog::info("Only writing the toolpaths, not the g-code.");
+                    FffProcessor::getInstance()->setTargetStream(nullptr);
+                }
 #ifdef __EMSCRIPTEN__
                 else if (argument.find("--progress") == 0)
                 {
@@ -239,7 +366,7 @@ void CommandLine::sliceNext()
                     if (argument_index >= arguments_.size())
                     {
                         spdlog::error("Missing definition search paths");
-                        exit(1);
+                        abortSlice();
                     }
                     argument = arguments_[argument_index];
                     search_directories_ = argument | views::split_paths | ranges::to<std::vector<std::filesystem::path>>();
@@ -251,13 +378,13 @@ void CommandLine::sliceNext()
                     if (argument_index >= arguments_.size())
                     {
                         spdlog::error("Missing JSON file with -j argument.");
-                        exit(1);
+                        abortSlice();
                     }
                     argument = arguments_[argument_index];
                     if (loadJSON(std::filesystem::path{ argument }, *last_settings, force_read_parent, force_read_nondefault) != 0)
                     {
                         spdlog::error("Failed to load JSON file: {}", argument);
-                        exit(1);
+                        abortSlice();
                     }
 
                     // If this was the global stack, create extruders for the machine_extruder_count setting.
@@ -294,7 +421,7 @@ void CommandLine::sliceNext()
                     if (argument_index >= arguments_.size())
                     {
                         spdlog::error("Missing model file with -l argument.");
-                        exit(1);
+                        abortSlice();
                     }
                     argument = arguments_[argument_index];
 
@@ -303,7 +430,7 @@ void CommandLine::sliceNext()
                     if (! loadMeshIntoMeshGroup(&slice.scene.mesh_groups[mesh_group_index], argument.c_str(), transformation, last_extruder->settings_))
                     {
                         spdlog::error("Failed to load model: {}. (error number {})", argument, errno);
-                        exit(1);
+                        abortSlice();
                     }
                     else
                     {
@@ -317,13 +444,13 @@ void CommandLine::sliceNext()
                     if (argument_index >= arguments_.size())
                     {
                         spdlog::error("Missing output file with -o argument.");
-                        exit(1);
+                        abortSlice();
                     }
                     argument = arguments_[argument_index];
                     if (! FffProcessor::getInstance()->setTargetFile(argument.c_str()))
                     {
                         spdlog::error("Failed to open {} for output.", argument.c_str());
-                        exit(1);
+                        abortSlice();
                     }
                     break;
                 }
@@ -340,7 +467,7 @@ void CommandLine::sliceNext()
                     if (argument_index >= arguments_.size())
                     {
                         spdlog::error("Missing setting name and value with -s argument.");
-                        exit(1);
+                        abortSlice();
                     }
                     argument = arguments_[argument_index];
                     const size_t value_position = argument.find('=');
@@ -348,7 +475,7 @@ void CommandLine::sliceNext()
                     if (value_position == std::string::npos)
                     {
                         spdlog::error("Missing value in setting argument: -s {}", argument);
-                        exit(1);
+                        abortSlice();
                     }
                     std::string value = argument.substr(value_position + 1);
                     last_settings->add(key, value);
@@ -359,7 +486,7 @@ void CommandLine::sliceNext()
                     spdlog::error("Unknown option: -{}", argument[1]);
                     Application::getInstance().printCall();
                     Application::getInstance().printHelp();
-                    exit(1);
+                    abortSlice();
                 }
                 }
             }
@@ -369,12 +496,18 @@ void CommandLine::sliceNext()
             spdlog::error("Unknown option: {}", argument);
             Application::getInstance().printCall();
             Application::getInstance().printHelp();
-            exit(1);
+            abortSlice();
         }
     }
 
     arguments_.clear(); // We've processed all arguments now.
 
+    if (estimate_only_)
+    {
+        // After all arguments, so that an output file given with -o doesn't bring the g-code back.
+        FffProcessor::getInstance()->disableOutput();
+    }
+
 #ifndef DEBUG
     try
     {
@@ -392,16 +525,67 @@ void CommandLine::sliceNext()
         // This prevents the "something went wrong" dialogue on Windows to pop up on a thrown exception.
         // Only ClipperLib currently throws exceptions. And only in the case that it makes an internal error.
         spdlog::error("Unknown exception.");
-        exit(1);
+        abortSlice();
     }
 #endif // DEBUG
 
     // Finalize the processor. This adds the end g-code and reports statistics.
     FffProcessor::getInstance()->finalize();
+    if (estimate_only_)
+    {
+        sendPrintTimeMaterialEstimates();
+    }
+    if (trace_file_)
+    {
+        Trace::disable();
+        Trace::write(*trace_file_);
+    }
 }
 
 int CommandLine::loadJSON(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault)
 {
+    if (! definition_cache_ || recording_ != nullptr) // Without a cache, or while loading the parents of a file for the cache.
+    {
+        return loadJSONFile(json_filename, settings, force_read_parent, force_read_nondefault);
+    }
+
+    // The outcome depends on where the parents are found, so the search directories are part of the key.
+    std::error_code error;
+    std::string key = fmt::format("{}|{}|{}", std::filesystem::absolute(json_filename, error).string(), force_read_parent, force_read_nondefault);
+    for (const std::filesystem::path& search_directory : search_directories_)
+    {
+        key += "|" + std::filesystem::absolute(search_directory, error).string();
+    }
+
+    if (const std::optional<DefinitionCache::Entry> entry = definition_cache_->load(key))
+    {
+        spdlog::debug("Loading {} from the definition cache.", json_filename);
+        applyCacheEntry(*entry, settings);
+        return 0;
+    }
+
+    DefinitionCache::Entry entry;
+    recording_ = &entry;
+    recording_settings_ = &settings;
+    const int error_code = loadJSONFile(json_filename, settings, force_read_parent, force_read_nondefault);
+    recording_ = nullptr;
+    recording_settings_ = nullptr;
+    if (error_code == 0)
+    {
+        definition_cache_->store(key, entry);
+    }
+    return error_code;
+}
+
+int CommandLine::loadJSONFile(const std::filesystem::path& json_filename, Settings& settings, bool force_read_parent, bool force_read_nondefault)
+{
+    if (recording_ != nullptr)
+    {
+        if (std::optional<DefinitionCache::Entry::Dependency> dependency = DefinitionCache::getDependency(json_filename))
+        {
+            recording_->dependencies.push_back(std::move(*dependency));
+        }
+    }
     std::ifstream file(json_filename, std::ios::binary);
     if (! file)
     {
@@ -421,9 +605,59 @@ int CommandLine::loadJSON(const std::filesystem::path& json_filename, Settings&
     }
 
     search_directories_.push_back(std::filesystem::path(json_filename).parent_path());
+    if (recording_ != nullptr)
+    {
+        recording_->search_directories.push_back(search_directories_.back().string());
+    }
     return loadJSON(json_document, search_directories_, settings, force_read_parent, force_read_nondefault);
 }
 
+void CommandLine::applyCacheEntry(const DefinitionCache::Entry& entry, Settings& settings)
+{
+    for (const std::string& search_directory : entry.search_directories)
+    {
+        search_directories_.emplace_back(search_directory);
+    }
+    Scene& scene = Application::getInstance().current_slice_->scene;
+    for (const DefinitionCache::Entry::Operation& operation : entry.operations)
+    {
+        switch (operation.type)
+        {
+        case DefinitionCache::Entry::Operation::Type::ADD_EXTRUDER:
+            while (scene.extruders.size() <= static_cast<size_t>(operation.extruder_nr))
+            {
+                scene.extruders.emplace_back(scene.extruders.size(), &scene.settings);
+            }
+            break;
+        case DefinitionCache::Entry::Operation::Type::ADD_SETTING:
+            (operation.extruder_nr < 0 ? settings : scene.extruders[operation.extruder_nr].settings_).add(operation.key, operation.value);
+            break;
+        }
+    }
+}
+
+void CommandLine::addSetting(Settings& settings, const std::string& key, const std::string& value)
+{
+    if (recording_ != nullptr)
+    {
+        int32_t extruder_nr = -1;
+        if (&settings != recording_settings_)
+        {
+            const std::vector<ExtruderTrain>& extruders = Application::getInstance().current_slice_->scene.extruders;
+            const auto extruder = std::find_if(
+                extruders.begin(),
+                extruders.end(),
+                [&settings](const ExtruderTrain& train)
+                {
+                    return &train.settings_ == &settings;
+                });
+            extruder_nr = extruder - extruders.begin();
+        }
+        recording_->operations.push_back({ DefinitionCache::Entry::Operation::Type::ADD_SETTING, extruder_nr, key, value });
+    }
+    settings.add(key, value);
+}
+
 int CommandLine::loadJSON(
     const rapidjson::Document& document,
     const std::vector<std::filesystem::path>& search_directories,
@@ -468,6 +702,10 @@ int CommandLine::loadJSON(
                 {
                     scene.extruders.emplace_back(scene.extruders.size(), &scene.settings);
                 }
+                if (recording_ != nullptr)
+                {
+                    recording_->operations.push_back({ DefinitionCache::Entry::Operation::Type::ADD_EXTRUDER, extruder_nr, {}, {} });
+                }
                 const rapidjson::Value& extruder_id = extruder_train->value;
                 if (! extruder_id.IsString())
                 {
@@ -582,7 +820,7 @@ void CommandLine::loadJSONSettings(const rapidjson::Value& element, Settings& se
             spdlog::warn("Unrecognized data type in JSON setting {}", name);
             continue;
         }
-        settings.add(name, value_string);
+        addSetting(settings, name, value_string);
     }
 }
 
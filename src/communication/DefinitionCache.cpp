@@ -0,0 +1,313 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "communication/DefinitionCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr char magic[8] = { 'C', 'U', 'R', 'A', 'D', 'E', 'F', 'C' };
+constexpr uint32_t format_version = 1;
+
+/*!
+ * Appends values to an entry file in the format that EntryReader reads.
+ */
+class EntryWriter
+{
+public:
+    explicit EntryWriter(std::ofstream& file)
+        : file_(file)
+    {
+    }
+
+    template<typename T>
+    void write(const T value)
+    {
+        file_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void write(const std::string& value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        file_.write(value.data(), value.size());
+    }
+
+private:
+    std::ofstream& file_;
+};
+
+/*!
+ * Reads values from a memory-mapped entry file, checking that they don't run
+ * past the end of it.
+ */
+class EntryReader
+{
+public:
+    EntryReader(const char* data, const size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    template<typename T>
+    bool read(T& value)
+    {
+        if (size_ - position_ < sizeof(value))
+        {
+            return false;
+        }
+        memcpy(&value, data_ + position_, sizeof(value));
+        position_ += sizeof(value);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint32_t length;
+        if (! read(length) || size_ - position_ < length)
+        {
+            return false;
+        }
+        value.assign(data_ + position_, length);
+        position_ += length;
+        return true;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_ = 0;
+};
+
+} // namespace
+
+DefinitionCache::DefinitionCache(std::filesystem::path directory)
+    : directory_(std::move(directory))
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error)
+    {
+        spdlog::warn("Couldn't create the definition cache directory {}: {}", directory_, error.message());
+    }
+}
+
+std::optional<DefinitionCache::Entry> DefinitionCache::load(const std::string& key) const
+{
+    if (const auto memory_entry = memory_entries_.find(key); memory_entry != memory_entries_.end())
+    {
+        if (isUpToDate(memory_entry->second))
+        {
+            return memory_entry->second;
+        }
+        memory_entries_.erase(memory_entry);
+    }
+    if (directory_.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::optional<Entry> entry = loadFile(key);
+    if (entry && isUpToDate(*entry))
+    {
+        memory_entries_[key] = *entry;
+        return entry;
+    }
+    return std::nullopt;
+}
+
+void DefinitionCache::store(const std::string& key, const Entry& entry) const
+{
+    memory_entries_[key] = entry;
+    if (! directory_.empty())
+    {
+        storeFile(key, entry);
+    }
+}
+
+bool DefinitionCache::isUpToDate(const Entry& entry)
+{
+    for (const Entry::Dependency& dependency : entry.dependencies)
+    {
+        const std::optional<Entry::Dependency> current = getDependency(dependency.path);
+        if (! current || current->modified_time != dependency.modified_time || current->size != dependency.size)
+        {
+            spdlog::debug("Definition cache entry is outdated, since {} changed.", dependency.path);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<DefinitionCache::Entry> DefinitionCache::loadFile(const std::string& key) const
+{
+    const std::filesystem::path entry_path = getEntryPath(key);
+    std::error_code error;
+    if (! std::filesystem::exists(entry_path, error))
+    {
+        return std::nullopt;
+    }
+
+    boost::interprocess::mapped_region region;
+    try
+    {
+        const boost::interprocess::file_mapping file(entry_path.string().c_str(), boost::interprocess::read_only);
+        region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception& exception)
+    {
+        spdlog::warn("Unable to map the definition cache entry {} into memory: {}", entry_path, exception.what());
+        return std::nullopt;
+    }
+    EntryReader reader(static_cast<const char*>(region.get_address()), region.get_size());
+
+    char file_magic[sizeof(magic)];
+    uint32_t version;
+    std::string entry_key;
+    if (! reader.read(file_magic) || memcmp(file_magic, magic, sizeof(magic)) != 0 || ! reader.read(version) || version != format_version || ! reader.read(entry_key)
+        || entry_key != key)
+    {
+        return std::nullopt; // Different format, or a hash collision.
+    }
+
+    Entry entry;
+    uint32_t count;
+    if (! reader.read(count))
+    {
+        return std::nullopt;
+    }
+    entry.dependencies.resize(count);
+    for (Entry::Dependency& dependency : entry.dependencies)
+    {
+        if (! reader.read(dependency.path) || ! reader.read(dependency.modified_time) || ! reader.read(dependency.size))
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (! reader.read(count))
+    {
+        return std::nullopt;
+    }
+    entry.search_directories.resize(count);
+    for (std::string& search_directory : entry.search_directories)
+    {
+        if (! reader.read(search_directory))
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (! reader.read(count))
+    {
+        return std::nullopt;
+    }
+    entry.operations.resize(count);
+    for (Entry::Operation& operation : entry.operations)
+    {
+        if (! reader.read(operation.type) || ! reader.read(operation.extruder_nr) || ! reader.read(operation.key) || ! reader.read(operation.value))
+        {
+            return std::nullopt;
+        }
+    }
+    return entry;
+}
+
+void DefinitionCache::storeFile(const std::string& key, const Entry& entry) const
+{
+    // Write to a temporary file first, so that concurrent runs never see a partially written entry.
+    const std::filesystem::path entry_path = getEntryPath(key);
+    std::filesystem::path temporary_path = entry_path;
+    temporary_path += fmt::format(".{:08x}.tmp", std::random_device{}());
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (! file)
+        {
+            spdlog::warn("Couldn't write definition cache entry {}", entry_path);
+            return;
+        }
+        EntryWriter writer(file);
+        file.write(magic, sizeof(magic));
+        writer.write(format_version);
+        writer.write(key);
+        writer.write(static_cast<uint32_t>(entry.dependencies.size()));
+        for (const Entry::Dependency& dependency : entry.dependencies)
+        {
+            writer.write(dependency.path);
+            writer.write(dependency.modified_time);
+            writer.write(dependency.size);
+        }
+        writer.write(static_cast<uint32_t>(entry.search_directories.size()));
+        for (const std::string& search_directory : entry.search_directories)
+        {
+            writer.write(search_directory);
+        }
+        writer.write(static_cast<uint32_t>(entry.operations.size()));
+        for (const Entry::Operation& operation : entry.operations)
+        {
+            writer.write(operation.type);
+            writer.write(operation.extruder_nr);
+            writer.write(operation.key);
+            writer.write(operation.value);
+        }
+        if (! file)
+        {
+            spdlog::warn("Couldn't write definition cache entry {}", entry_path);
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary_path, entry_path, error);
+    if (error)
+    {
+        spdlog::warn("Couldn't store definition cache entry {}: {}", entry_path, error.message());
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+std::optional<DefinitionCache::Entry::Dependency> DefinitionCache::getDependency(const std::filesystem::path& path)
+{
+    std::error_code error;
+    const auto modified_time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    return Entry::Dependency{ path.string(), static_cast<int64_t>(modified_time.time_since_epoch().count()), static_cast<uint64_t>(size) };
+}
+
+std::filesystem::path DefinitionCache::getEntryPath(const std::string& key) const
+{
+    // 64-bit FNV-1a, which unlike std::hash is the same in every build.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char character : key)
+    {
+        hash = (hash ^ static_cast<uint8_t>(character)) * 0x100000001b3ULL;
+    }
+    return directory_ / fmt::format("{:016x}.defcache", hash);
+}
+
+} // namespace cura
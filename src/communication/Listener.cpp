@@ -7,6 +7,7 @@
 #include <spdlog/spdlog.h>
 
 #include "communication/Listener.h"
+#include "utils/Cancellation.h"
 
 namespace cura
 {
@@ -18,7 +19,7 @@ void Listener::stateChanged(Arcus::SocketState)
 
 void Listener::messageReceived()
 {
-    // Do nothing.
+    Cancellation::requestIfSlicing();
 }
 
 void Listener::error(const Arcus::Error& error)
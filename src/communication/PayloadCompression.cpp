@@ -0,0 +1,85 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "communication/PayloadCompression.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+
+namespace cura
+{
+
+std::string deflatePayload(const std::string_view data)
+{
+    uLongf compressed_size = compressBound(data.size());
+    std::string compressed(compressed_size, '\0');
+    // Fast compression is plenty: the payloads are compressed while slicing, and most of the gain is in the first few levels.
+    const int result = compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size, reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_SPEED);
+    if (result != Z_OK)
+    {
+        spdlog::error("Failed to compress a payload of {} bytes (zlib error {}).", data.size(), result);
+        return std::string();
+    }
+    compressed.resize(compressed_size);
+    return compressed;
+}
+
+std::string encodeCoordinateDeltas(const std::vector<float>& coordinates, const size_t dimensions)
+{
+    std::string result;
+    result.reserve(coordinates.size() * 2); // Most travel and extrusion moves are short, so most differences fit in two bytes.
+    std::vector<int64_t> previous(dimensions, 0);
+    for (size_t coordinate_idx = 0; coordinate_idx < coordinates.size(); coordinate_idx++)
+    {
+        const int64_t micrometres = std::llround(static_cast<double>(coordinates[coordinate_idx]) * 1000.0);
+        int64_t& previous_micrometres = previous[coordinate_idx % dimensions];
+        const int64_t delta = micrometres - previous_micrometres;
+        previous_micrometres = micrometres;
+
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (zigzag >= 0x80)
+        {
+            result.push_back(static_cast<char>((zigzag & 0x7F) | 0x80));
+            zigzag >>= 7;
+        }
+        result.push_back(static_cast<char>(zigzag));
+    }
+    return result;
+}
+
+std::vector<float> decodeCoordinateDeltas(const std::string_view data, const size_t dimensions)
+{
+    std::vector<float> result;
+    std::vector<int64_t> previous(dimensions, 0);
+    uint64_t zigzag = 0;
+    int shift = 0;
+    for (const char byte : data)
+    {
+        if (shift >= 64)
+        {
+            return {};
+        }
+        zigzag |= static_cast<uint64_t>(static_cast<uint8_t>(byte) & 0x7F) << shift;
+        shift += 7;
+        if (static_cast<uint8_t>(byte) & 0x80)
+        {
+            continue;
+        }
+        const int64_t delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        int64_t& previous_micrometres = previous[result.size() % dimensions];
+        previous_micrometres += delta;
+        result.push_back(static_cast<float>(static_cast<double>(previous_micrometres) / 1000.0));
+        zigzag = 0;
+        shift = 0;
+    }
+    if (shift != 0 || result.size() % dimensions != 0)
+    {
+        return {}; // Truncated.
+    }
+    return result;
+}
+
+} // namespace cura
@@ -0,0 +1,147 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "communication/SliceServer.h"
+
+#include <array>
+#include <exception>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/write.hpp>
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "utils/format/filesystem_path.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * Thrown to leave a job that can't be sliced, without exiting the server.
+ */
+struct SliceAborted : std::exception
+{
+};
+
+} // namespace
+
+SliceServer::SliceServer(const std::filesystem::path& socket_path)
+    : CommandLine({})
+    , socket_path_(socket_path)
+    , acceptor_(io_context_)
+{
+    std::error_code error;
+    std::filesystem::remove(socket_path_, error); // A socket left behind by an earlier server would make binding fail.
+
+    const boost::asio::local::stream_protocol::endpoint endpoint(socket_path_.string());
+    acceptor_.open(endpoint.protocol());
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+    spdlog::info("Waiting for slice jobs on {}", socket_path_);
+
+    if (! definition_cache_)
+    {
+        definition_cache_.emplace(); // Keep the loaded definitions in memory for the next jobs, even without a cache directory.
+    }
+}
+
+SliceServer::~SliceServer()
+{
+    boost::system::error_code error;
+    acceptor_.close(error);
+    std::error_code remove_error;
+    std::filesystem::remove(socket_path_, remove_error);
+}
+
+bool SliceServer::hasSlice() const
+{
+    return acceptor_.is_open();
+}
+
+bool SliceServer::isPersistent() const
+{
+    return true;
+}
+
+void SliceServer::sliceNext()
+{
+    boost::asio::local::stream_protocol::socket connection(io_context_);
+    boost::system::error_code error;
+    acceptor_.accept(connection, error);
+    if (error)
+    {
+        spdlog::error("Failed to accept a slice job: {}", error.message());
+        return;
+    }
+
+    std::vector<std::string> arguments{ "CuraEngine", "slice" };
+    if (! readJob(connection, arguments))
+    {
+        spdlog::error("Received an incomplete slice job.");
+        return;
+    }
+    if (arguments.size() == 2)
+    {
+        spdlog::info("Stopping the slice server.");
+        boost::asio::write(connection, boost::asio::buffer(std::string_view("OK\n")), error);
+        acceptor_.close(error);
+        return;
+    }
+
+    spdlog::info("Received a slice job with {} arguments.", arguments.size() - 2);
+    setArguments(arguments);
+    bool success = true;
+    try
+    {
+        CommandLine::sliceNext();
+    }
+    catch (const SliceAborted&)
+    {
+        success = false;
+    }
+    Application::getInstance().current_slice_ = nullptr; // The slice only lived during sliceNext.
+
+    boost::asio::write(connection, boost::asio::buffer(success ? std::string_view("OK\n") : std::string_view("ERROR\n")), error);
+    if (error)
+    {
+        spdlog::warn("Failed to report the result of a slice job: {}", error.message());
+    }
+}
+
+void SliceServer::abortSlice()
+{
+    setArguments({});
+    throw SliceAborted();
+}
+
+bool SliceServer::readJob(boost::asio::local::stream_protocol::socket& connection, std::vector<std::string>& arguments)
+{
+    std::string data;
+    size_t argument_start = 0;
+    std::array<char, 4096> chunk;
+    while (true)
+    {
+        boost::system::error_code error;
+        const size_t read_size = connection.read_some(boost::asio::buffer(chunk), error);
+        if (error)
+        {
+            return false;
+        }
+        data.append(chunk.data(), read_size);
+
+        for (size_t argument_end = data.find('\0', argument_start); argument_end != std::string::npos; argument_end = data.find('\0', argument_start))
+        {
+            if (argument_end == argument_start) // The empty argument that ends the job.
+            {
+                return true;
+            }
+            arguments.emplace_back(data, argument_start, argument_end - argument_start);
+            argument_start = argument_end + 1;
+        }
+    }
+}
+
+} // namespace cura
@@ -3,9 +3,11 @@
 
 #include "gcodeExport.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <cmath>
 #include <iomanip>
+#include <numbers>
 #include <stdarg.h>
 
 #include <spdlog/spdlog.h>
@@ -37,7 +39,8 @@ std::string transliterate(const std::string& text)
 }
 
 GCodeExport::GCodeExport()
-    : output_stream_(&std::cout)
+    : output_writer_(&std::cout)
+    , output_stream_(&output_writer_.buffer())
     , current_position_(0, 0, MM2INT(20))
     , layer_nr_(0)
     , relative_extrusion_(false)
@@ -83,6 +86,13 @@ void GCodeExport::preSetup(const size_t start_extruder)
     const Scene& scene = Application::getInstance().current_slice_->scene;
     std::vector<MeshGroup>::iterator mesh_group = scene.current_mesh_group;
     setFlavor(mesh_group->settings.get<EGCodeFlavor>("machine_gcode_flavor"));
+    bool binary_output = mesh_group->settings.has("machine_gcode_binary") && mesh_group->settings.get<bool>("machine_gcode_binary");
+    if (binary_output && ! Application::getInstance().communication_->isSequential())
+    {
+        spdlog::warn("Binary g-code is only written to files. The front-end gets text g-code.");
+        binary_output = false;
+    }
+    output_writer_.setBinary(binary_output);
     use_extruder_offset_to_offset_coords_ = mesh_group->settings.get<bool>("machine_use_extruder_offset_to_offset_coords");
     const size_t extruder_count = Application::getInstance().current_slice_->scene.extruders.size();
     ppr_enable_ = mesh_group->settings.get<bool>("ppr_enable");
@@ -347,10 +357,88 @@ void GCodeExport::setLayerNr(const LayerIndex& layer_nr)
 
 void GCodeExport::setOutputStream(std::ostream* stream)
 {
-    output_stream_ = stream;
+    output_writer_.setTarget(stream);
+    output_stream_ = &output_writer_.buffer();
     *output_stream_ << std::fixed;
 }
 
+void GCodeExport::setFileHeaderPatchable(const bool patchable)
+{
+    file_header_patchable_ = patchable;
+}
+
+/*!
+ * Pad a file header with comment lines to a fixed size and number of lines.
+ *
+ * The last line of padding has no line ending, since the file header is written with \ref GCodeExport::writeCode.
+ * Keeping the number of lines the same keeps the size of the file header the same when the line endings are converted.
+ * \return The padded file header, or nothing if the file header doesn't fit.
+ */
+static std::optional<std::string> padFileHeader(const std::string& file_header, const size_t size, const size_t line_count, const std::string& new_line)
+{
+    const size_t header_line_count = std::count(file_header.begin(), file_header.end(), '\n');
+    if (header_line_count > line_count)
+    {
+        return std::nullopt;
+    }
+    const size_t padding_line_count = line_count - header_line_count;
+    const size_t padding_lines_size = padding_line_count * (1 + new_line.size());
+    if (file_header.size() + padding_lines_size + 1 > size)
+    {
+        return std::nullopt;
+    }
+    std::string padded = file_header;
+    padded.reserve(size);
+    for (size_t line_idx = 0; line_idx < padding_line_count; line_idx++)
+    {
+        padded += ";" + new_line;
+    }
+    padded += ';';
+    padded.resize(size, ' ');
+    return padded;
+}
+
+std::optional<std::string> GCodeExport::getPatchedFileHeader(const std::string& file_header) const
+{
+    if (file_header_size_ == 0)
+    {
+        return std::nullopt;
+    }
+    std::optional<std::string> patched = padFileHeader(file_header, file_header_size_, file_header_line_count_, new_line_);
+    if (! patched)
+    {
+        spdlog::warn("The final g-code header of {} bytes doesn't fit in the {} bytes reserved for it. The header keeps its estimates.", file_header.size(), file_header_size_);
+    }
+    return patched;
+}
+
+void GCodeExport::submitOutput()
+{
+    output_writer_.submit();
+}
+
+void GCodeExport::flushOutput()
+{
+    output_writer_.flush();
+}
+
+void GCodeExport::discardOutput()
+{
+    output_writer_.discard();
+}
+
+void GCodeExport::disableOutput()
+{
+    output_writer_.setTarget(nullptr);
+    output_stream_ = &null_stream_;
+    file_header_patchable_ = false;
+}
+
+ToolpathExport& GCodeExport::getToolpathExport()
+{
+    return toolpath_export_;
+}
+
 bool GCodeExport::getExtruderIsUsed(const int extruder_nr) const
 {
     assert(extruder_nr >= 0);
@@ -388,6 +476,16 @@ void GCodeExport::setFlavor(EGCodeFlavor flavor)
     {
         is_volumetric_ = false;
     }
+    if (flavor == EGCodeFlavor::BFB)
+    {
+        write_travel_move_ = &GCodeExport::writeTravelMove<true>;
+        write_extrusion_move_ = &GCodeExport::writeExtrusionMove<true>;
+    }
+    else
+    {
+        write_travel_move_ = &GCodeExport::writeTravelMove<false>;
+        write_extrusion_move_ = &GCodeExport::writeExtrusionMove<false>;
+    }
 }
 
 EGCodeFlavor GCodeExport::getFlavor() const
@@ -677,7 +775,25 @@ bool GCodeExport::initializeExtruderTrains(const SliceDataStorage& storage, cons
                                                                    // the exact time/material usages yet.
     {
         std::string prefix = getFileHeader(storage.getExtrudersUsed());
-        writeCode(prefix.c_str());
+        file_header_size_ = 0;
+        if (output_writer_.isBinary())
+        {
+            output_writer_.submitMetadata(prefix);
+        }
+        else if (file_header_patchable_)
+        {
+            // The final header has the material use and GUID of each extruder that is used, and larger numbers.
+            const size_t extra_line_count = 2 + 2 * Application::getInstance().current_slice_->scene.extruders.size();
+            constexpr size_t extra_size_per_line = 96;
+            file_header_line_count_ = std::count(prefix.begin(), prefix.end(), '\n') + extra_line_count;
+            file_header_size_ = prefix.size() + extra_line_count * extra_size_per_line;
+            writeCode(padFileHeader(prefix, file_header_size_, file_header_line_count_, new_line_).value().c_str());
+        }
+        else
+        {
+            writeCode(prefix.c_str());
+        }
+        file_header_patchable_ = false; // Anything after this isn't at the start of the file.
     }
 
     writeComment("Generated with Cura_SteamEngine " CURA_ENGINE_VERSION);
@@ -862,22 +978,38 @@ void GCodeExport::writeExtrusion(const Point2LL& p, const Velocity& speed, doubl
 
 void GCodeExport::writeTravel(const Point3LL& p, const Velocity& speed)
 {
-    if (flavor_ == EGCodeFlavor::BFB)
+    (this->*write_travel_move_)(p, speed);
+}
+
+void GCodeExport::writeExtrusion(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset)
+{
+    (this->*write_extrusion_move_)(p, speed, extrusion_mm3_per_mm, feature, update_extrusion_offset);
+}
+
+template<bool rpm_extrusion>
+void GCodeExport::writeTravelMove(const Point3LL& p, const Velocity& speed)
+{
+    if constexpr (rpm_extrusion)
     {
         writeMoveBFB(p.x_, p.y_, p.z_ + is_z_hopped_, speed, 0.0, PrintFeatureType::MoveCombing);
-        return;
     }
-    writeTravel(p.x_, p.y_, p.z_ + is_z_hopped_, speed);
+    else
+    {
+        writeTravel(p.x_, p.y_, p.z_ + is_z_hopped_, speed);
+    }
 }
 
-void GCodeExport::writeExtrusion(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset)
+template<bool rpm_extrusion>
+void GCodeExport::writeExtrusionMove(const Point3LL& p, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature, bool update_extrusion_offset)
 {
-    if (flavor_ == EGCodeFlavor::BFB)
+    if constexpr (rpm_extrusion)
     {
         writeMoveBFB(p.x_, p.y_, p.z_, speed, extrusion_mm3_per_mm, feature);
-        return;
     }
-    writeExtrusion(p.x_, p.y_, p.z_, speed, extrusion_mm3_per_mm, feature, update_extrusion_offset);
+    else
+    {
+        writeExtrusion(p.x_, p.y_, p.z_, speed, extrusion_mm3_per_mm, feature, update_extrusion_offset);
+    }
 }
 
 void GCodeExport::writeMoveBFB(const int x, const int y, const int z, const Velocity& speed, double extrusion_mm3_per_mm, PrintFeatureType feature)
@@ -1024,10 +1156,118 @@ void GCodeExport::writeExtrusion(
     const double diff_length = diff.vSizeMM();
 
     writeUnretractionAndPrime();
+    writeFlowRateCompensation(diff_length, speed, extrusion_mm3_per_mm, update_extrusion_offset);
+
+    extruder_attr_[current_extruder_].last_e_value_after_wipe_ += extrusion_per_mm * diff_length;
+    const double new_e_value = current_e_value_ + extrusion_per_mm * diff_length;
+
+    *output_stream_ << "G1";
+    writeFXYZE(speed, x, y, z, new_e_value, feature);
+}
+
+void GCodeExport::writeArcExtrusion(
+    const Point2LL& p,
+    const Point2LL& center,
+    const bool clockwise,
+    const double path_length,
+    const Velocity& speed,
+    const double extrusion_mm3_per_mm,
+    const PrintFeatureType& feature,
+    const bool update_extrusion_offset)
+{
+    const coord_t z = current_layer_z_;
+    if (current_position_.x_ == p.X && current_position_.y_ == p.Y && current_position_.z_ == z)
+    {
+        return;
+    }
+
+    const double extrusion_per_mm = mm3ToE(extrusion_mm3_per_mm);
+
+    if (is_z_hopped_ > 0)
+    {
+        writeZhopEnd();
+    }
+
+    writeUnretractionAndPrime();
+    writeFlowRateCompensation(path_length, speed, extrusion_mm3_per_mm, update_extrusion_offset);
+
+    extruder_attr_[current_extruder_].last_e_value_after_wipe_ += extrusion_per_mm * path_length;
+    const double new_e_value = current_e_value_ + extrusion_per_mm * path_length;
+
+    const bool write_f = current_speed_ != speed;
+    current_speed_ = speed;
+
+    const Point2LL start(current_position_.x_, current_position_.y_);
+    const Point2LL gcode_start = getGcodePos(start.X, start.Y, current_extruder_);
+    const Point2LL gcode_end = getGcodePos(p.X, p.Y, current_extruder_);
+    const Point2LL gcode_center = getGcodePos(center.X, center.Y, current_extruder_);
+
+    // The arc goes from the start angle over the sweep, which is negative when going clockwise.
+    const double radius = vSizeMM(start - center);
+    const double start_angle = std::atan2(static_cast<double>(start.Y - center.Y), static_cast<double>(start.X - center.X));
+    double sweep = std::atan2(static_cast<double>(p.Y - center.Y), static_cast<double>(p.X - center.X)) - start_angle;
+    if (clockwise && sweep >= 0.0)
+    {
+        sweep -= 2.0 * std::numbers::pi;
+    }
+    else if (! clockwise && sweep <= 0.0)
+    {
+        sweep += 2.0 * std::numbers::pi;
+    }
+
+    // The arc can bulge out beyond its ends where it passes the axes of its circle.
+    total_bounding_box_.include(Point3LL(gcode_end.X, gcode_end.Y, z));
+    for (int quarter = -6; quarter <= 6; quarter++)
+    {
+        const double angle = quarter * std::numbers::pi / 2.0;
+        const double along = clockwise ? start_angle - angle : angle - start_angle;
+        if (along > 0.0 && along < std::abs(sweep))
+        {
+            total_bounding_box_.include(Point3LL(gcode_center.X + MM2INT(radius * std::cos(angle)), gcode_center.Y + MM2INT(radius * std::sin(angle)), z));
+        }
+    }
+
+    *output_stream_ << (clockwise ? "G2" : "G3");
+    if (write_f)
+    {
+        *output_stream_ << " F" << PrecisionedDouble{ 1, speed * 60 };
+    }
+    *output_stream_ << " X" << MMtoStream{ gcode_end.X } << " Y" << MMtoStream{ gcode_end.Y };
+    if (z != current_position_.z_)
+    {
+        *output_stream_ << " Z" << MMtoStream{ z };
+    }
+    *output_stream_ << " I" << MMtoStream{ gcode_center.X - gcode_start.X } << " J" << MMtoStream{ gcode_center.Y - gcode_start.Y };
+    const double e = (relative_extrusion_) ? new_e_value + current_e_offset_ - current_e_value_ : new_e_value + current_e_offset_;
+    *output_stream_ << " " << extruder_attr_[current_extruder_].extruder_character_ << PrecisionedDouble{ 5, e } << new_line_;
+
+    // Plan the time of the arc in segments of about a millimetre, like the firmware moves along it (MM_PER_ARC_SEGMENT in Marlin).
+    constexpr double segment_length = 1.0;
+    const size_t segment_count = std::max(size_t(1), static_cast<size_t>(std::ceil(std::abs(sweep) * radius / segment_length)));
+    const double start_e = current_e_value_;
+    const coord_t start_z = current_position_.z_;
+    for (size_t segment_idx = 1; segment_idx <= segment_count; segment_idx++)
+    {
+        const double fraction = static_cast<double>(segment_idx) / segment_count;
+        const double angle = start_angle + sweep * fraction;
+        const Point2LL segment_end = segment_idx == segment_count
+                                       ? p
+                                       : center + Point2LL(MM2INT(radius * std::cos(angle)), MM2INT(radius * std::sin(angle)));
+        const double segment_z = INT2MM(start_z) + INT2MM(z - start_z) * fraction;
+        estimate_calculator_.plan(
+            TimeEstimateCalculator::Position(INT2MM(segment_end.X), INT2MM(segment_end.Y), segment_z, eToMm(start_e + (new_e_value - start_e) * fraction)),
+            speed,
+            feature);
+    }
+
+    current_position_ = Point3LL(p.X, p.Y, z);
+    current_e_value_ = new_e_value;
+}
 
-    // flow rate compensation
+void GCodeExport::writeFlowRateCompensation(const double length, const Velocity& speed, const double extrusion_mm3_per_mm, const bool update_extrusion_offset)
+{
     double extrusion_offset = 0;
-    if (diff_length)
+    if (length)
     {
         extrusion_offset = speed * extrusion_mm3_per_mm * extrusion_offset_factor_;
         if (extrusion_offset > max_extrusion_offset_)
@@ -1041,34 +1281,32 @@ void GCodeExport::writeExtrusion(
         current_e_offset_ = extrusion_offset;
         *output_stream_ << ";FLOW_RATE_COMPENSATED_OFFSET = " << current_e_offset_ << new_line_;
     }
-
-    extruder_attr_[current_extruder_].last_e_value_after_wipe_ += extrusion_per_mm * diff_length;
-    const double new_e_value = current_e_value_ + extrusion_per_mm * diff_length;
-
-    *output_stream_ << "G1";
-    writeFXYZE(speed, x, y, z, new_e_value, feature);
 }
 
 void GCodeExport::writeFXYZE(const Velocity& speed, const coord_t x, const coord_t y, const coord_t z, const double e, const PrintFeatureType& feature)
 {
-    if (current_speed_ != speed)
-    {
-        *output_stream_ << " F" << PrecisionedDouble{ 1, speed * 60 };
-        current_speed_ = speed;
-    }
+    const bool write_f = current_speed_ != speed;
+    current_speed_ = speed;
 
     Point2LL gcode_pos = getGcodePos(x, y, current_extruder_);
     total_bounding_box_.include(Point3LL(gcode_pos.X, gcode_pos.Y, z));
 
-    *output_stream_ << " X" << MMtoStream{ gcode_pos.X } << " Y" << MMtoStream{ gcode_pos.Y };
-    if (z != current_position_.z_)
+    const GCodeOutputWriter::Move move{ .x = gcode_pos.X,
+                                       .y = gcode_pos.Y,
+                                       .z = z,
+                                       .f = speed * 60,
+                                       .e = (relative_extrusion_) ? e + current_e_offset_ - current_e_value_ : e + current_e_offset_,
+                                       .e_character = extruder_attr_[current_extruder_].extruder_character_,
+                                       .write_f = write_f,
+                                       .write_z = z != current_position_.z_,
+                                       .write_e = e + current_e_offset_ != current_e_value_ };
+    if (output_stream_ == &output_writer_.buffer())
     {
-        *output_stream_ << " Z" << MMtoStream{ z };
+        output_writer_.writeMove(move); // Formatted on the threads of the output writer.
     }
-    if (e + current_e_offset_ != current_e_value_)
+    else if (output_stream_ != &null_stream_)
     {
-        const double output_e = (relative_extrusion_) ? e + current_e_offset_ - current_e_value_ : e + current_e_offset_;
-        *output_stream_ << " " << extruder_attr_[current_extruder_].extruder_character_ << PrecisionedDouble{ 5, output_e };
+        GCodeOutputWriter::formatMove(*output_stream_, move);
     }
     *output_stream_ << new_line_;
 
@@ -1685,7 +1923,7 @@ void GCodeExport::finalize(const char* endCode)
     for (int n = 1; n < MAX_EXTRUDERS; n++)
         if (getTotalFilamentUsed(n) > 0)
             spdlog::info("Filament {}: {}", n + 1, int(getTotalFilamentUsed(n)));
-    output_stream_->flush();
+    output_writer_.flush();
 }
 
 double GCodeExport::getExtrudedVolumeAfterLastWipe(size_t extruder)
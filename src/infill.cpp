@@ -5,7 +5,7 @@
 
 #include <algorithm> //For std::sort.
 #include <functional>
-#include <unordered_set>
+#include <numeric> //For std::iota and std::partial_sum.
 
 #include <scripta/logger.h>
 #include <spdlog/spdlog.h>
@@ -24,7 +24,6 @@
 #include "utils/PolygonConnector.h"
 #include "utils/PolylineStitcher.h"
 #include "utils/Simplify.h"
-#include "utils/UnionFind.h"
 #include "utils/linearAlg2D.h"
 #include "utils/polygonUtils.h"
 
@@ -60,7 +59,8 @@ Polygons Infill::generateWallToolPaths(
     const coord_t infill_overlap,
     const Settings& settings,
     int layer_idx,
-    SectionType section_type)
+    SectionType section_type,
+    WallToolPathsCache* walls_cache)
 {
     outer_contour = outer_contour.offset(infill_overlap);
     scripta::log("infill_outer_contour", outer_contour, section_type, layer_idx, scripta::CellVDI{ "infill_overlap", infill_overlap });
@@ -70,6 +70,7 @@ Polygons Infill::generateWallToolPaths(
     {
         constexpr coord_t wall_0_inset = 0; // Don't apply any outer wall inset for these. That's just for the outer wall.
         WallToolPaths wall_toolpaths(outer_contour, line_width, wall_line_count, wall_0_inset, settings, layer_idx, section_type);
+        wall_toolpaths.setCache(walls_cache);
         wall_toolpaths.pushToolPaths(toolpaths);
         inner_contour = wall_toolpaths.getInnerContour();
     }
@@ -320,7 +321,7 @@ void Infill::_generate(
 #ifdef ENABLE_PLUGINS // FIXME: I don't like this conditional block outside of the plugin scope.
         auto [toolpaths_, generated_result_polygons_, generated_result_lines_] = slots::instance().generate<plugins::v0::SlotID::INFILL_GENERATE>(
             inner_contour_,
-            mesh ? mesh->settings.get<std::string>("infill_pattern") : settings.get<std::string>("infill_pattern"),
+            mesh ? mesh->settings.get<std::string>(SettingKey::infill_pattern) : settings.get<std::string>(SettingKey::infill_pattern),
             mesh ? mesh->settings : settings);
         toolpaths.insert(toolpaths.end(), toolpaths_.begin(), toolpaths_.end());
         result_polygons.add(generated_result_polygons_);
@@ -556,13 +557,64 @@ void Infill::generateCrossInfill(const SierpinskiFillProvider& cross_fill_provid
     }
 }
 
+void Infill::RotatedOutline::assign(const Polygons& outline, const PointMatrix& rotation_matrix)
+{
+    points_.clear();
+    polygon_starts_.clear();
+    boundary_ = AABB();
+    for (ConstPolygonRef polygon : outline)
+    {
+        polygon_starts_.push_back(points_.size());
+        for (const Point2LL& point : polygon)
+        {
+            points_.push_back(rotation_matrix.apply(point));
+            boundary_.include(points_.back());
+        }
+    }
+    polygon_starts_.push_back(points_.size());
+}
+
+void Infill::ScanlineCrossings::reset(const size_t scanline_count)
+{
+    found_.clear();
+    scanline_starts_.assign(scanline_count + 1, 0);
+}
+
+void Infill::ScanlineCrossings::sort()
+{
+    if (found_.empty())
+    {
+        sorted_.clear();
+        return; // All scanlines start at 0 already.
+    }
+
+    // Count sort by scanline, which keeps the order in which the crossings of each scanline were found.
+    for (size_t scanline_idx = 1; scanline_idx < scanline_starts_.size(); scanline_idx++)
+    {
+        scanline_starts_[scanline_idx] += scanline_starts_[scanline_idx - 1];
+    }
+    sorted_.resize(found_.size(), ScanlineCrossing{ 0, 0, 0, 0 });
+    for (const ScanlineCrossing& crossing : found_)
+    {
+        sorted_[scanline_starts_[crossing.scanline_idx_]++] = crossing;
+    }
+    // Each start was moved to the start of the next scanline while filling it in, so move them back.
+    std::copy_backward(scanline_starts_.begin(), scanline_starts_.end() - 2, scanline_starts_.end() - 1);
+    scanline_starts_[0] = 0;
+
+    for (size_t scanline_idx = 0; scanline_idx < scanlineCount(); scanline_idx++)
+    {
+        std::sort(sorted_.begin() + scanline_starts_[scanline_idx], sorted_.begin() + scanline_starts_[scanline_idx + 1]); // sort by increasing Y coordinates
+    }
+}
+
 void Infill::addLineInfill(
     Polygons& result,
     const PointMatrix& rotation_matrix,
     const int scanline_min_idx,
     const int line_distance,
     const AABB boundary,
-    std::vector<std::vector<coord_t>>& cut_list,
+    const ScanlineCrossings& crossings,
     coord_t shift)
 {
     assert(! connect_lines_ && "connectLines() should add the infill lines, not addLineInfill");
@@ -570,19 +622,20 @@ void Infill::addLineInfill(
     unsigned int scanline_idx = 0;
     for (coord_t x = scanline_min_idx * line_distance + shift; x < boundary.max_.X; x += line_distance)
     {
-        if (scanline_idx >= cut_list.size())
+        if (scanline_idx >= crossings.scanlineCount())
         {
             break;
         }
-        std::vector<coord_t>& crossings = cut_list[scanline_idx];
-        std::sort(crossings.begin(), crossings.end()); // sort by increasing Y coordinates
-        for (unsigned int crossing_idx = 0; crossing_idx + 1 < crossings.size(); crossing_idx += 2)
+        const std::span<const ScanlineCrossing> scanline_crossings = crossings.scanline(scanline_idx);
+        for (unsigned int crossing_idx = 0; crossing_idx + 1 < scanline_crossings.size(); crossing_idx += 2)
         {
-            if (crossings[crossing_idx + 1] - crossings[crossing_idx] < infill_line_width_ / 5)
+            if (scanline_crossings[crossing_idx + 1].y_ - scanline_crossings[crossing_idx].y_ < infill_line_width_ / 5)
             { // segment is too short to create infill
                 continue;
             }
-            result.addLine(rotation_matrix.unapply(Point2LL(x, crossings[crossing_idx])), rotation_matrix.unapply(Point2LL(x, crossings[crossing_idx + 1])));
+            result.addLine(
+                rotation_matrix.unapply(Point2LL(x, scanline_crossings[crossing_idx].y_)),
+                rotation_matrix.unapply(Point2LL(x, scanline_crossings[crossing_idx + 1].y_)));
         }
         scanline_idx += 1;
     }
@@ -653,8 +706,9 @@ void Infill::generateLinearBasedInfill(
         return;
     }
 
-    Polygons outline = inner_contour_; // Make a copy. We'll be rotating this outline to make intersections always horizontal, for better performance.
-    outline.applyMatrix(rotation_matrix);
+    // We'll be rotating the outline to make intersections always horizontal, for better performance.
+    thread_local RotatedOutline outline; // Reused for all infill generated by this thread.
+    outline.assign(inner_contour_, rotation_matrix);
 
     coord_t shift = extra_shift + this->shift_;
     if (shift < 0)
@@ -666,49 +720,19 @@ void Infill::generateLinearBasedInfill(
         shift = shift % line_distance;
     }
 
-    AABB boundary(outline);
+    const AABB& boundary = outline.boundary_;
 
     int scanline_min_idx = computeScanSegmentIdx(boundary.min_.X - shift, line_distance);
     int line_count = computeScanSegmentIdx(boundary.max_.X - shift, line_distance) + 1 - scanline_min_idx;
 
-    std::vector<std::vector<coord_t>> cut_list(line_count); // mapping from scanline to all intersections with polygon segments
-
     // When we find crossings, keep track of which crossing belongs to which scanline and to which polygon line segment.
     // Then we can later join two crossings together to form lines and still know what polygon line segments that infill line connected to.
-    struct Crossing
-    {
-        Point2LL coordinate_;
-        size_t polygon_index_;
-        size_t vertex_index_;
-
-        Crossing(Point2LL coordinate, size_t polygon_index, size_t vertex_index)
-            : coordinate_(coordinate)
-            , polygon_index_(polygon_index)
-            , vertex_index_(vertex_index)
-        {
-        }
+    thread_local ScanlineCrossings crossings; // Reused for all infill generated by this thread.
+    crossings.reset(line_count);
 
-        bool operator<(const Crossing& other) const // Crossings will be ordered by their Y coordinate so that they get ordered along the scanline.
-        {
-            return coordinate_.Y < other.coordinate_.Y;
-        }
-    };
-    std::vector<std::vector<Crossing>> crossings_per_scanline; // For each scanline, a list of crossings.
-    const int min_scanline_index = computeScanSegmentIdx(boundary.min_.X - shift, line_distance) + 1;
-    const int max_scanline_index = computeScanSegmentIdx(boundary.max_.X - shift, line_distance) + 1;
-    crossings_per_scanline.resize(max_scanline_index - min_scanline_index);
-    if (connect_lines_)
-    {
-        crossings_on_line_.resize(outline.size()); // One for each polygon.
-    }
-
-    for (size_t poly_idx = 0; poly_idx < outline.size(); poly_idx++)
+    for (size_t poly_idx = 0; poly_idx < outline.polygonCount(); poly_idx++)
     {
-        PolygonRef poly = outline[poly_idx];
-        if (connect_lines_)
-        {
-            crossings_on_line_[poly_idx].resize(poly.size()); // One for each line in this polygon.
-        }
+        const std::span<const Point2LL> poly = outline.polygon(poly_idx);
         Point2LL p0 = poly.back();
         zigzag_connector_processor.registerVertex(p0); // always adds the first point to ZigzagConnectorProcessorEndPieces::first_zigzag_connector when using a zigzag infill type
 
@@ -748,11 +772,10 @@ void Infill::generateLinearBasedInfill(
             {
                 int x = scanline_idx * line_distance + shift;
                 int y = p1.Y + (p0.Y - p1.Y) * (x - p1.X) / (p0.X - p1.X);
-                assert(scanline_idx - scanline_min_idx >= 0 && scanline_idx - scanline_min_idx < int(cut_list.size()) && "reading infill cutlist index out of bounds!");
-                cut_list[scanline_idx - scanline_min_idx].push_back(y);
+                assert(scanline_idx - scanline_min_idx >= 0 && scanline_idx - scanline_min_idx < line_count && "reading infill cutlist index out of bounds!");
+                crossings.add(ScanlineCrossing{ y, poly_idx, point_idx, static_cast<size_t>(scanline_idx - scanline_min_idx) });
                 Point2LL scanline_linesegment_intersection(x, y);
                 zigzag_connector_processor.registerScanlineSegmentIntersection(scanline_linesegment_intersection, scanline_idx);
-                crossings_per_scanline[scanline_idx - min_scanline_index].emplace_back(scanline_linesegment_intersection, poly_idx, point_idx);
             }
             zigzag_connector_processor.registerVertex(p1);
             p0 = p1;
@@ -760,59 +783,61 @@ void Infill::generateLinearBasedInfill(
         zigzag_connector_processor.registerPolyFinished();
     }
 
+    // Sorts them by scanline and by Y coordinate.
+    crossings.sort();
+
     if (connect_lines_)
     {
         // Gather all crossings per scanline and find out which crossings belong together, then store them in crossings_on_line.
-        for (int scanline_index = min_scanline_index; scanline_index < max_scanline_index; scanline_index++)
+        for (int scanline_index = scanline_min_idx; scanline_index < scanline_min_idx + line_count; scanline_index++)
         {
-            auto& crossings = crossings_per_scanline[scanline_index - min_scanline_index];
-            // Sorts them by Y coordinate.
-            std::sort(crossings.begin(), crossings.end());
+            const std::span<const ScanlineCrossing> scanline_crossings = crossings.scanline(scanline_index - scanline_min_idx);
+            const int x = scanline_index * line_distance + shift;
             // Combine each 2 subsequent crossings together.
-            for (long crossing_index = 0; crossing_index < static_cast<long>(crossings.size()) - 1; crossing_index += 2)
+            for (long crossing_index = 0; crossing_index < static_cast<long>(scanline_crossings.size()) - 1; crossing_index += 2)
             {
-                const Crossing& first = crossings[crossing_index];
-                const Crossing& second = crossings[crossing_index + 1];
+                const ScanlineCrossing& first = scanline_crossings[crossing_index];
+                const ScanlineCrossing& second = scanline_crossings[crossing_index + 1];
                 // Avoid creating zero length crossing lines
-                const Point2LL unrotated_first = rotation_matrix.unapply(first.coordinate_);
-                const Point2LL unrotated_second = rotation_matrix.unapply(second.coordinate_);
+                const Point2LL unrotated_first = rotation_matrix.unapply(Point2LL(x, first.y_));
+                const Point2LL unrotated_second = rotation_matrix.unapply(Point2LL(x, second.y_));
                 if (unrotated_first == unrotated_second)
                 {
                     continue;
                 }
-                InfillLineSegment* new_segment
-                    = new InfillLineSegment(unrotated_first, first.vertex_index_, first.polygon_index_, unrotated_second, second.vertex_index_, second.polygon_index_);
-                // Put the same line segment in the data structure twice: Once for each of the polygon line segment that it crosses.
-                crossings_on_line_[first.polygon_index_][first.vertex_index_].push_back(new_segment);
-                crossings_on_line_[second.polygon_index_][second.vertex_index_].push_back(new_segment);
+                const size_t segment_index = infill_segments_.size();
+                infill_segments_.emplace_back(unrotated_first, first.vertex_index_, first.polygon_index_, unrotated_second, second.vertex_index_, second.polygon_index_);
+                // Remember the same line segment twice: Once for each of the polygon line segment that it crosses.
+                crossings_on_line_.push_back(OutlineCrossing{ first.polygon_index_, first.vertex_index_, segment_index });
+                crossings_on_line_.push_back(OutlineCrossing{ second.polygon_index_, second.vertex_index_, segment_index });
             }
         }
     }
     else
     {
-        if (cut_list.size() == 0)
+        if (crossings.scanlineCount() == 0)
         {
             return;
         }
-        if (connected_zigzags && cut_list.size() == 1 && cut_list[0].size() <= 2)
+        if (connected_zigzags && crossings.scanlineCount() == 1 && crossings.scanline(0).size() <= 2)
         {
             return; // don't add connection if boundary already contains whole outline!
         }
 
         // We have to create our own lines when they are not created by the method connectLines.
-        addLineInfill(result, rotation_matrix, scanline_min_idx, line_distance, boundary, cut_list, shift);
+        addLineInfill(result, rotation_matrix, scanline_min_idx, line_distance, boundary, crossings, shift);
     }
 }
 
-void Infill::resolveIntersection(const coord_t at_distance, const Point2LL& intersect, Point2LL& connect_start, Point2LL& connect_end, InfillLineSegment* a, InfillLineSegment* b)
+void Infill::resolveIntersection(const coord_t at_distance, const Point2LL& intersect, Point2LL& connect_start, Point2LL& connect_end, InfillLineSegment& a, InfillLineSegment& b)
 {
     // Select wich ends of the line need to 'bend'.
-    const bool forward_line_a = a->end_ == connect_start;
-    const bool forward_line_b = b->start_ == connect_end;
-    auto& bend_a = forward_line_a ? a->end_bend_ : a->start_bend_;
-    auto& bend_b = forward_line_b ? b->start_bend_ : b->end_bend_;
-    auto& end_a = forward_line_a ? a->altered_end_ : a->altered_start_;
-    auto& end_b = forward_line_b ? b->altered_start_ : b->altered_end_;
+    const bool forward_line_a = a.end_ == connect_start;
+    const bool forward_line_b = b.start_ == connect_end;
+    auto& bend_a = forward_line_a ? a.end_bend_ : a.start_bend_;
+    auto& bend_b = forward_line_b ? b.start_bend_ : b.end_bend_;
+    auto& end_a = forward_line_a ? a.altered_end_ : a.altered_start_;
+    auto& end_b = forward_line_b ? b.altered_start_ : b.altered_end_;
 
     // Set values ('pre existing' values are needed when feeding these as reference parameters to functions that need a value).
     assert(! bend_a.has_value());
@@ -833,8 +858,8 @@ void Infill::resolveIntersection(const coord_t at_distance, const Point2LL& inte
     bool is_resolved = true;
 
     // Use both of the resulting lines to place the 'bends' by intersecting with the original line-segments.
-    is_resolved &= LinearAlg2D::lineLineIntersection(q, r, a->start_, a->end_, bend_a.value()) && LinearAlg2D::pointIsProjectedBeyondLine(bend_a.value(), a->start_, a->end_) == 0;
-    is_resolved &= LinearAlg2D::lineLineIntersection(s, t, b->start_, b->end_, bend_b.value()) && LinearAlg2D::pointIsProjectedBeyondLine(bend_b.value(), b->start_, b->end_) == 0;
+    is_resolved &= LinearAlg2D::lineLineIntersection(q, r, a.start_, a.end_, bend_a.value()) && LinearAlg2D::pointIsProjectedBeyondLine(bend_a.value(), a.start_, a.end_) == 0;
+    is_resolved &= LinearAlg2D::lineLineIntersection(s, t, b.start_, b.end_, bend_b.value()) && LinearAlg2D::pointIsProjectedBeyondLine(bend_b.value(), b.start_, b.end_) == 0;
 
     // Also set the new end-points
     is_resolved &= LinearAlg2D::lineLineIntersection(connect_start, connect_end, q, r, end_a) && LinearAlg2D::pointIsProjectedBeyondLine(end_a, connect_start, connect_end) == 0;
@@ -856,21 +881,60 @@ void Infill::resolveIntersection(const coord_t at_distance, const Point2LL& inte
 
 void Infill::connectLines(Polygons& result_lines)
 {
-    UnionFind<InfillLineSegment*> connected_lines; // Keeps track of which lines are connected to which.
-    for (const std::vector<std::vector<InfillLineSegment*>>& crossings_on_polygon : crossings_on_line_)
+    // Group the ends of the infill lines per edge of the inner contour, in the order in which the lines were made.
+    std::vector<size_t> first_edge_of_polygon(inner_contour_.size() + 1, 0);
+    for (size_t polygon_index = 0; polygon_index < inner_contour_.size(); polygon_index++)
+    {
+        first_edge_of_polygon[polygon_index + 1] = first_edge_of_polygon[polygon_index] + inner_contour_[polygon_index].size();
+    }
+    std::vector<size_t> edge_crossing_starts(first_edge_of_polygon.back() + 1, 0); // Where the crossings of each edge start in edge_crossings, followed by the end of the last one.
+    for (const OutlineCrossing& crossing : crossings_on_line_)
     {
-        for (const std::vector<InfillLineSegment*>& crossings_on_polygon_segment : crossings_on_polygon)
+        assert(crossing.polygon_index_ < inner_contour_.size() && crossing.vertex_index_ < inner_contour_[crossing.polygon_index_].size());
+        edge_crossing_starts[first_edge_of_polygon[crossing.polygon_index_] + crossing.vertex_index_ + 1]++;
+    }
+    std::partial_sum(edge_crossing_starts.begin(), edge_crossing_starts.end(), edge_crossing_starts.begin());
+    std::vector<size_t> edge_crossings(crossings_on_line_.size()); // The infill line of each crossing, as index in infill_segments_.
+    {
+        std::vector<size_t> next_crossing_of_edge(edge_crossing_starts.begin(), edge_crossing_starts.end() - 1);
+        for (const OutlineCrossing& crossing : crossings_on_line_)
         {
-            for (InfillLineSegment* infill_line : crossings_on_polygon_segment)
+            edge_crossings[next_crossing_of_edge[first_edge_of_polygon[crossing.polygon_index_] + crossing.vertex_index_]++] = crossing.segment_index_;
+        }
+    }
+
+    // Keeps track of which lines are connected to which. Every line starts out as a separate set.
+    const size_t infill_line_count = infill_segments_.size();
+    std::vector<size_t> connected_lines(infill_line_count);
+    std::iota(connected_lines.begin(), connected_lines.end(), 0);
+    const auto find_connected = [&connected_lines](size_t line_index)
+    {
+        while (connected_lines[line_index] != line_index)
+        {
+            connected_lines[line_index] = connected_lines[connected_lines[line_index]]; // Halve the path to the root, so that later searches are shorter.
+            line_index = connected_lines[line_index];
+        }
+        return line_index;
+    };
+
+    // The lines are output in the order that they are first met along the inner contour.
+    std::vector<size_t> output_order;
+    output_order.reserve(infill_line_count);
+    {
+        std::vector<bool> is_ordered(infill_line_count, false);
+        for (const size_t line_index : edge_crossings)
+        {
+            if (! is_ordered[line_index])
             {
-                if (connected_lines.find(infill_line) == (size_t)-1)
-                {
-                    connected_lines.add(infill_line); // Put every line in there as a separate set.
-                }
+                is_ordered[line_index] = true;
+                output_order.push_back(line_index);
             }
         }
     }
 
+    // Every connection joins two sets of lines and every vertex of the contour adds at most one segment along it, so this is all the room that connecting will take.
+    infill_segments_.reserve(2 * infill_line_count + first_edge_of_polygon.back());
+
     const auto half_line_distance_squared = (line_distance_ * line_distance_) / 4;
     for (size_t polygon_index = 0; polygon_index < inner_contour_.size(); polygon_index++)
     {
@@ -879,44 +943,42 @@ void Infill::connectLines(Polygons& result_lines)
         {
             continue;
         }
-        assert(crossings_on_line_.size() > polygon_index && "crossings dimension should be bigger then polygon index");
-        std::vector<std::vector<InfillLineSegment*>>& crossings_on_polygon = crossings_on_line_[polygon_index];
-        InfillLineSegment* previous_crossing = nullptr; // The crossing that we should connect to. If nullptr, we have been skipping until we find the next crossing.
-        InfillLineSegment* previous_segment = nullptr; // The last segment we were connecting while drawing a line along the border.
+        size_t previous_crossing = InfillLineSegment::no_segment; // The crossing that we should connect to. If no_segment, we have been skipping until we find the next crossing.
+        size_t previous_segment = InfillLineSegment::no_segment; // The last segment we were connecting while drawing a line along the border.
         Point2LL vertex_before = inner_contour_polygon.back();
         for (size_t vertex_index = 0; vertex_index < inner_contour_polygon.size(); vertex_index++)
         {
-            assert(crossings_on_polygon.size() > vertex_index && "crossings on line for the current polygon should be bigger then vertex index");
-            std::vector<InfillLineSegment*>& crossings_on_polygon_segment = crossings_on_polygon[vertex_index];
+            const size_t edge_index = first_edge_of_polygon[polygon_index] + vertex_index;
+            const std::span<size_t> crossings_on_polygon_segment(edge_crossings.begin() + edge_crossing_starts[edge_index], edge_crossings.begin() + edge_crossing_starts[edge_index + 1]);
             Point2LL vertex_after = inner_contour_polygon[vertex_index];
 
             // Sort crossings on every line by how far they are from their initial point.
             std::sort(
                 crossings_on_polygon_segment.begin(),
                 crossings_on_polygon_segment.end(),
-                [&vertex_before, polygon_index, vertex_index](InfillLineSegment* left_hand_side, InfillLineSegment* right_hand_side)
+                [this, &vertex_before, polygon_index, vertex_index](const size_t left_hand_index, const size_t right_hand_index)
                 {
                     // Find the two endpoints that are relevant.
-                    const bool choose_left = (left_hand_side->start_segment_ == vertex_index && left_hand_side->start_polygon_ == polygon_index);
-                    const bool choose_right = (right_hand_side->start_segment_ == vertex_index && right_hand_side->start_polygon_ == polygon_index);
-                    const Point2LL left_hand_point = choose_left ? left_hand_side->start_ : left_hand_side->end_;
-                    const Point2LL right_hand_point = choose_right ? right_hand_side->start_ : right_hand_side->end_;
+                    const InfillLineSegment& left_hand_side = infill_segments_[left_hand_index];
+                    const InfillLineSegment& right_hand_side = infill_segments_[right_hand_index];
+                    const bool choose_left = (left_hand_side.start_segment_ == vertex_index && left_hand_side.start_polygon_ == polygon_index);
+                    const bool choose_right = (right_hand_side.start_segment_ == vertex_index && right_hand_side.start_polygon_ == polygon_index);
+                    const Point2LL left_hand_point = choose_left ? left_hand_side.start_ : left_hand_side.end_;
+                    const Point2LL right_hand_point = choose_right ? right_hand_side.start_ : right_hand_side.end_;
                     return vSize(left_hand_point - vertex_before) < vSize(right_hand_point - vertex_before);
                 });
 
-            for (InfillLineSegment* crossing : crossings_on_polygon_segment)
+            for (const size_t crossing_index : crossings_on_polygon_segment)
             {
-                if (! previous_crossing) // If we're not yet drawing, then we have been trying to find the next vertex. We found it! Let's start drawing.
+                if (previous_crossing == InfillLineSegment::no_segment) // If we're not yet drawing, then we have been trying to find the next vertex. We found it! Let's start drawing.
                 {
-                    previous_crossing = crossing;
-                    previous_segment = crossing;
+                    previous_crossing = crossing_index;
+                    previous_segment = crossing_index;
                 }
                 else
                 {
-                    const size_t crossing_handle = connected_lines.find(crossing);
-                    assert(crossing_handle != (size_t)-1);
-                    const size_t previous_crossing_handle = connected_lines.find(previous_crossing);
-                    assert(previous_crossing_handle != (size_t)-1);
+                    const size_t crossing_handle = find_connected(crossing_index);
+                    const size_t previous_crossing_handle = find_connected(previous_crossing);
                     if (crossing_handle == previous_crossing_handle)
                     {
                         // These two infill lines are already connected. Don't create a loop now. Continue connecting with the next crossing.
@@ -925,16 +987,18 @@ void Infill::connectLines(Polygons& result_lines)
 
                     // Join two infill lines together with a connecting line.
                     // Here the InfillLineSegments function as a linked list, so that they can easily be joined.
-                    const bool previous_forward = (previous_segment->start_segment_ == vertex_index && previous_segment->start_polygon_ == polygon_index);
-                    const bool next_forward = (crossing->start_segment_ == vertex_index && crossing->start_polygon_ == polygon_index);
-                    Point2LL& previous_point = previous_forward ? previous_segment->start_ : previous_segment->end_;
-                    Point2LL& next_point = next_forward ? crossing->start_ : crossing->end_;
-
-                    InfillLineSegment* new_segment;
+                    InfillLineSegment& previous = infill_segments_[previous_segment];
+                    InfillLineSegment& crossing = infill_segments_[crossing_index];
+                    const bool previous_forward = (previous.start_segment_ == vertex_index && previous.start_polygon_ == polygon_index);
+                    const bool next_forward = (crossing.start_segment_ == vertex_index && crossing.start_polygon_ == polygon_index);
+                    Point2LL& previous_point = previous_forward ? previous.start_ : previous.end_;
+                    Point2LL& next_point = next_forward ? crossing.start_ : crossing.end_;
+
+                    size_t new_segment;
                     // If the segment is near length, we avoid creating it but still want to connect the crossing with the previous segment.
                     if (previous_point == next_point)
                     {
-                        (previous_forward ? previous_segment->previous_ : previous_segment->next_) = crossing;
+                        (previous_forward ? previous.previous_ : previous.next_) = crossing_index;
                         new_segment = previous_segment;
                     }
                     else
@@ -942,107 +1006,111 @@ void Infill::connectLines(Polygons& result_lines)
                         // Resolve any intersections of the fill lines close to the boundary, by inserting extra points so the lines don't create a tiny 'loop'.
                         Point2LL intersect;
                         if (vSize2(previous_point - next_point) < half_line_distance_squared
-                            && LinearAlg2D::lineLineIntersection(previous_segment->start_, previous_segment->end_, crossing->start_, crossing->end_, intersect)
-                            && LinearAlg2D::pointIsProjectedBeyondLine(intersect, previous_segment->start_, previous_segment->end_) == 0
-                            && LinearAlg2D::pointIsProjectedBeyondLine(intersect, crossing->start_, crossing->end_) == 0)
+                            && LinearAlg2D::lineLineIntersection(previous.start_, previous.end_, crossing.start_, crossing.end_, intersect)
+                            && LinearAlg2D::pointIsProjectedBeyondLine(intersect, previous.start_, previous.end_) == 0
+                            && LinearAlg2D::pointIsProjectedBeyondLine(intersect, crossing.start_, crossing.end_) == 0)
                         {
-                            resolveIntersection(infill_line_width_, intersect, previous_point, next_point, previous_segment, crossing);
+                            resolveIntersection(infill_line_width_, intersect, previous_point, next_point, previous, crossing);
                         }
 
                         // A connecting line between them.
-                        new_segment = new InfillLineSegment(previous_point, vertex_index, polygon_index, next_point, vertex_index, polygon_index);
-                        new_segment->altered_start_ = previous_point;
-                        new_segment->altered_end_ = next_point;
-                        new_segment->previous_ = previous_segment;
-                        (previous_forward ? previous_segment->previous_ : previous_segment->next_) = new_segment;
-                        new_segment->next_ = crossing;
+                        new_segment = infill_segments_.size();
+                        (previous_forward ? previous.previous_ : previous.next_) = new_segment;
+                        const Point2LL connection_start = previous_point; // Adding the connection could move the segments that these points are in.
+                        const Point2LL connection_end = next_point;
+                        InfillLineSegment& connection = infill_segments_.emplace_back(connection_start, vertex_index, polygon_index, connection_end, vertex_index, polygon_index);
+                        connection.altered_start_ = connection_start;
+                        connection.altered_end_ = connection_end;
+                        connection.previous_ = previous_segment;
+                        connection.next_ = crossing_index;
                     }
 
-                    (next_forward ? crossing->previous_ : crossing->next_) = new_segment;
-                    connected_lines.unite(crossing_handle, previous_crossing_handle);
-                    previous_crossing = nullptr;
-                    previous_segment = nullptr;
+                    InfillLineSegment& next = infill_segments_[crossing_index];
+                    (next_forward ? next.previous_ : next.next_) = new_segment;
+                    connected_lines[previous_crossing_handle] = crossing_handle;
+                    previous_crossing = InfillLineSegment::no_segment;
+                    previous_segment = InfillLineSegment::no_segment;
                 }
             }
 
             // Upon going to the next vertex, if we're drawing, put an extra vertex in our infill lines.
-            if (previous_crossing)
+            if (previous_crossing != InfillLineSegment::no_segment)
             {
-                InfillLineSegment* new_segment;
-
-                const bool choose_side = (vertex_index == previous_segment->start_segment_ && polygon_index == previous_segment->start_polygon_);
-                const auto& previous_side = choose_side ? previous_segment->start_ : previous_segment->end_;
+                const InfillLineSegment& previous = infill_segments_[previous_segment];
+                const bool choose_side = (vertex_index == previous.start_segment_ && polygon_index == previous.start_polygon_);
+                const Point2LL previous_side = choose_side ? previous.start_ : previous.end_;
                 if (previous_side == vertex_after)
                 {
                     // Edge case when an infill line ends directly on top of vertex_after: We skip the extra connecting line segment, as that would be 0-length.
-                    previous_segment = nullptr;
-                    previous_crossing = nullptr;
+                    previous_segment = InfillLineSegment::no_segment;
+                    previous_crossing = InfillLineSegment::no_segment;
                 }
                 else
                 {
-                    new_segment
-                        = new InfillLineSegment(previous_side, vertex_index, polygon_index, vertex_after, (vertex_index + 1) % inner_contour_[polygon_index].size(), polygon_index);
-                    (choose_side ? previous_segment->previous_ : previous_segment->next_) = new_segment;
-                    new_segment->previous_ = previous_segment;
+                    const size_t new_segment = infill_segments_.size();
+                    infill_segments_.emplace_back(previous_side, vertex_index, polygon_index, vertex_after, (vertex_index + 1) % inner_contour_polygon.size(), polygon_index);
+                    InfillLineSegment& previous_after_adding = infill_segments_[previous_segment];
+                    (choose_side ? previous_after_adding.previous_ : previous_after_adding.next_) = new_segment;
+                    infill_segments_[new_segment].previous_ = previous_segment;
                     previous_segment = new_segment;
                 }
             }
 
             vertex_before = vertex_after;
-            crossings_on_polygon_segment.clear();
         }
     }
 
     // Save all lines, now connected, to the output.
-    std::unordered_set<size_t> completed_groups;
-    for (InfillLineSegment* infill_line : connected_lines)
+    std::vector<bool> completed_groups(infill_line_count, false);
+    for (const size_t infill_line : output_order)
     {
-        const size_t group = connected_lines.find(infill_line);
-        if (completed_groups.find(group) != completed_groups.end()) // We already completed this group.
+        const size_t group = find_connected(infill_line);
+        if (completed_groups[group]) // We already completed this group.
         {
             continue;
         }
 
         // Find where the polyline ends by searching through previous and next lines.
         // Note that the "previous" and "next" lines don't necessarily match up though, because the direction while connecting infill lines was not yet known.
-        Point2LL previous_vertex = infill_line->start_; // Take one side arbitrarily to start from. This variable indicates the vertex that connects to the previous line.
-        InfillLineSegment* current_infill_line = infill_line;
-        while (current_infill_line->next_ && current_infill_line->previous_) // Until we reached an endpoint.
+        Point2LL previous_vertex = infill_segments_[infill_line].start_; // Take one side arbitrarily to start from. This variable indicates the vertex that connects to the previous line.
+        size_t current_infill_line = infill_line;
+        while (infill_segments_[current_infill_line].next_ != InfillLineSegment::no_segment
+               && infill_segments_[current_infill_line].previous_ != InfillLineSegment::no_segment) // Until we reached an endpoint.
         {
-            const bool choose_side = (previous_vertex == current_infill_line->start_);
-            const Point2LL next_vertex = choose_side ? current_infill_line->end_ : current_infill_line->start_;
-            current_infill_line = choose_side ? current_infill_line->next_ : current_infill_line->previous_;
-            previous_vertex = next_vertex;
+            const InfillLineSegment& current = infill_segments_[current_infill_line];
+            const bool choose_side = (previous_vertex == current.start_);
+            previous_vertex = choose_side ? current.end_ : current.start_;
+            current_infill_line = choose_side ? current.next_ : current.previous_;
         }
 
         // Now go along the linked list of infill lines and output the infill lines to the actual result.
         PolygonRef result_line = result_lines.newPoly();
-        InfillLineSegment* old_line = current_infill_line;
-        if (current_infill_line->previous_)
+        InfillLineSegment& first = infill_segments_[current_infill_line];
+        if (first.previous_ != InfillLineSegment::no_segment)
         {
-            current_infill_line->swapDirection();
+            first.swapDirection();
         }
-        current_infill_line->appendTo(result_line);
-        previous_vertex = current_infill_line->end_;
-        current_infill_line = current_infill_line->next_;
-        delete old_line;
-        while (current_infill_line)
+        first.appendTo(result_line);
+        previous_vertex = first.end_;
+        current_infill_line = first.next_;
+        while (current_infill_line != InfillLineSegment::no_segment)
         {
-            old_line = current_infill_line; // We'll delete this after we've traversed to the next line.
-            if (previous_vertex != current_infill_line->start_)
+            InfillLineSegment& current = infill_segments_[current_infill_line];
+            if (previous_vertex != current.start_)
             {
-                current_infill_line->swapDirection();
+                current.swapDirection();
             }
-            const Point2LL next_vertex = current_infill_line->end_; // Opposite side of the line.
             constexpr bool polyline_break = false;
-            current_infill_line->appendTo(result_line, polyline_break);
-            current_infill_line = current_infill_line->next_;
-            previous_vertex = next_vertex;
-            delete old_line;
+            current.appendTo(result_line, polyline_break);
+            previous_vertex = current.end_; // Opposite side of the line.
+            current_infill_line = current.next_;
         }
 
-        completed_groups.insert(group);
+        completed_groups[group] = true;
     }
+
+    infill_segments_.clear();
+    crossings_on_line_.clear();
 }
 
 bool Infill::InfillLineSegment::operator==(const InfillLineSegment& other) const
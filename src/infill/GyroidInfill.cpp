@@ -3,9 +3,15 @@
 
 #include "infill/GyroidInfill.h"
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
 #include "utils/AABB.h"
+#include "utils/FlatPolygons.h"
 #include "utils/linearAlg2D.h"
 #include "utils/polygon.h"
+#include "utils/polygonUtils.h"
 
 namespace cura
 {
@@ -24,6 +30,7 @@ void GyroidInfill::generateTotalGyroidInfill(Polygons& result_lines, bool zig_za
     // kudos to the author of the Slic3r implementation equation code, the equation code here is based on that
 
     const AABB aabb(in_outline);
+    const EdgeBandIndex outline_index{ FlatPolygons(in_outline) }; // Tests the points of each line against the outline at once.
 
     int pitch = line_distance * 2.41; // this produces similar density to the "line" infill pattern
     int num_steps = 4;
@@ -41,8 +48,8 @@ void GyroidInfill::generateTotalGyroidInfill(Polygons& result_lines, bool zig_za
     std::vector<coord_t> even_line_coords;
     Polygons result;
     std::vector<Point2LL> chains[2]; // [start_points[], end_points[]]
-    std::vector<unsigned> connected_to[2]; // [chain_indices[], chain_indices[]]
     std::vector<int> line_numbers; // which row/column line a chain is part of
+    std::vector<Point2LL> line_points; // the points of the row/column line that is being generated
     if (std::abs(sin_z) <= std::abs(cos_z))
     {
         // "vertical" lines
@@ -69,68 +76,70 @@ void GyroidInfill::generateTotalGyroidInfill(Polygons& result_lines, bool zig_za
             bool last_inside = false;
             unsigned chain_end_index = 0;
             Point2LL chain_end[2];
+            line_points.clear();
             for (coord_t y = (std::floor(aabb.min_.Y / pitch) - 1) * pitch; y <= aabb.max_.Y + pitch; y += pitch)
             {
                 for (unsigned i = 0; i < num_coords; ++i)
                 {
-                    Point2LL current(x + ((num_columns & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2 + pitch, y + (coord_t)(i * step));
-                    bool current_inside = in_outline.inside(current, true);
-                    if (! is_first_point)
+                    line_points.emplace_back(x + ((num_columns & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2 + pitch, y + (coord_t)(i * step));
+                }
+            }
+            const std::vector<bool> line_inside = outline_index.inside(line_points, true);
+            for (size_t point_idx = 0; point_idx < line_points.size(); point_idx++)
+            {
+                const Point2LL current = line_points[point_idx];
+                const bool current_inside = line_inside[point_idx];
+                if (! is_first_point)
+                {
+                    if (last_inside && current_inside)
                     {
-                        if (last_inside && current_inside)
-                        {
-                            // line doesn't hit the boundary, add the whole line
-                            result.addLine(last, current);
-                        }
-                        else if (last_inside != current_inside)
+                        // line doesn't hit the boundary, add the whole line
+                        result.addLine(last, current);
+                    }
+                    else if (last_inside != current_inside)
+                    {
+                        // line hits the boundary, add the part that's inside the boundary
+                        Polygons line;
+                        line.addLine(last, current);
+                        constexpr bool restitch = false; // only a single line doesn't need stitching
+                        line = in_outline.intersectionPolyLines(line, restitch);
+                        if (line.size() > 0)
                         {
-                            // line hits the boundary, add the part that's inside the boundary
-                            Polygons line;
-                            line.addLine(last, current);
-                            constexpr bool restitch = false; // only a single line doesn't need stitching
-                            line = in_outline.intersectionPolyLines(line, restitch);
-                            if (line.size() > 0)
+                            // some of the line is inside the boundary
+                            result.addLine(line[0][0], line[0][1]);
+                            if (zig_zaggify)
                             {
-                                // some of the line is inside the boundary
-                                result.addLine(line[0][0], line[0][1]);
-                                if (zig_zaggify)
+                                chain_end[chain_end_index] = line[0][(line[0][0] != last && line[0][0] != current) ? 0 : 1];
+                                if (++chain_end_index == 2)
                                 {
-                                    chain_end[chain_end_index] = line[0][(line[0][0] != last && line[0][0] != current) ? 0 : 1];
-                                    if (++chain_end_index == 2)
-                                    {
-                                        chains[0].push_back(chain_end[0]);
-                                        chains[1].push_back(chain_end[1]);
-                                        chain_end_index = 0;
-                                        connected_to[0].push_back(std::numeric_limits<unsigned>::max());
-                                        connected_to[1].push_back(std::numeric_limits<unsigned>::max());
-                                        line_numbers.push_back(num_columns);
-                                    }
+                                    chains[0].push_back(chain_end[0]);
+                                    chains[1].push_back(chain_end[1]);
+                                    chain_end_index = 0;
+                                    line_numbers.push_back(num_columns);
                                 }
                             }
-                            else
+                        }
+                        else
+                        {
+                            // none of the line is inside the boundary so the point that's actually on the boundary
+                            // is the chain end
+                            if (zig_zaggify)
                             {
-                                // none of the line is inside the boundary so the point that's actually on the boundary
-                                // is the chain end
-                                if (zig_zaggify)
+                                chain_end[chain_end_index] = (last_inside) ? last : current;
+                                if (++chain_end_index == 2)
                                 {
-                                    chain_end[chain_end_index] = (last_inside) ? last : current;
-                                    if (++chain_end_index == 2)
-                                    {
-                                        chains[0].push_back(chain_end[0]);
-                                        chains[1].push_back(chain_end[1]);
-                                        chain_end_index = 0;
-                                        connected_to[0].push_back(std::numeric_limits<unsigned>::max());
-                                        connected_to[1].push_back(std::numeric_limits<unsigned>::max());
-                                        line_numbers.push_back(num_columns);
-                                    }
+                                    chains[0].push_back(chain_end[0]);
+                                    chains[1].push_back(chain_end[1]);
+                                    chain_end_index = 0;
+                                    line_numbers.push_back(num_columns);
                                 }
                             }
                         }
                     }
-                    last = current;
-                    last_inside = current_inside;
-                    is_first_point = false;
                 }
+                last = current;
+                last_inside = current_inside;
+                is_first_point = false;
             }
             ++num_columns;
         }
@@ -161,68 +170,70 @@ void GyroidInfill::generateTotalGyroidInfill(Polygons& result_lines, bool zig_za
             bool last_inside = false;
             unsigned chain_end_index = 0;
             Point2LL chain_end[2];
+            line_points.clear();
             for (coord_t x = (std::floor(aabb.min_.X / pitch) - 1) * pitch; x <= aabb.max_.X + pitch; x += pitch)
             {
                 for (unsigned i = 0; i < num_coords; ++i)
                 {
-                    Point2LL current(x + (coord_t)(i * step), y + ((num_rows & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2);
-                    bool current_inside = in_outline.inside(current, true);
-                    if (! is_first_point)
+                    line_points.emplace_back(x + (coord_t)(i * step), y + ((num_rows & 1) ? odd_line_coords[i] : even_line_coords[i]) / 2);
+                }
+            }
+            const std::vector<bool> line_inside = outline_index.inside(line_points, true);
+            for (size_t point_idx = 0; point_idx < line_points.size(); point_idx++)
+            {
+                const Point2LL current = line_points[point_idx];
+                const bool current_inside = line_inside[point_idx];
+                if (! is_first_point)
+                {
+                    if (last_inside && current_inside)
                     {
-                        if (last_inside && current_inside)
-                        {
-                            // line doesn't hit the boundary, add the whole line
-                            result.addLine(last, current);
-                        }
-                        else if (last_inside != current_inside)
+                        // line doesn't hit the boundary, add the whole line
+                        result.addLine(last, current);
+                    }
+                    else if (last_inside != current_inside)
+                    {
+                        // line hits the boundary, add the part that's inside the boundary
+                        Polygons line;
+                        line.addLine(last, current);
+                        constexpr bool restitch = false; // only a single line doesn't need stitching
+                        line = in_outline.intersectionPolyLines(line, restitch);
+                        if (line.size() > 0)
                         {
-                            // line hits the boundary, add the part that's inside the boundary
-                            Polygons line;
-                            line.addLine(last, current);
-                            constexpr bool restitch = false; // only a single line doesn't need stitching
-                            line = in_outline.intersectionPolyLines(line, restitch);
-                            if (line.size() > 0)
+                            // some of the line is inside the boundary
+                            result.addLine(line[0][0], line[0][1]);
+                            if (zig_zaggify)
                             {
-                                // some of the line is inside the boundary
-                                result.addLine(line[0][0], line[0][1]);
-                                if (zig_zaggify)
+                                chain_end[chain_end_index] = line[0][(line[0][0] != last && line[0][0] != current) ? 0 : 1];
+                                if (++chain_end_index == 2)
                                 {
-                                    chain_end[chain_end_index] = line[0][(line[0][0] != last && line[0][0] != current) ? 0 : 1];
-                                    if (++chain_end_index == 2)
-                                    {
-                                        chains[0].push_back(chain_end[0]);
-                                        chains[1].push_back(chain_end[1]);
-                                        chain_end_index = 0;
-                                        connected_to[0].push_back(std::numeric_limits<unsigned>::max());
-                                        connected_to[1].push_back(std::numeric_limits<unsigned>::max());
-                                        line_numbers.push_back(num_rows);
-                                    }
+                                    chains[0].push_back(chain_end[0]);
+                                    chains[1].push_back(chain_end[1]);
+                                    chain_end_index = 0;
+                                    line_numbers.push_back(num_rows);
                                 }
                             }
-                            else
+                        }
+                        else
+                        {
+                            // none of the line is inside the boundary so the point that's actually on the boundary
+                            // is the chain end
+                            if (zig_zaggify)
                             {
-                                // none of the line is inside the boundary so the point that's actually on the boundary
-                                // is the chain end
-                                if (zig_zaggify)
+                                chain_end[chain_end_index] = (last_inside) ? last : current;
+                                if (++chain_end_index == 2)
                                 {
-                                    chain_end[chain_end_index] = (last_inside) ? last : current;
-                                    if (++chain_end_index == 2)
-                                    {
-                                        chains[0].push_back(chain_end[0]);
-                                        chains[1].push_back(chain_end[1]);
-                                        chain_end_index = 0;
-                                        connected_to[0].push_back(std::numeric_limits<unsigned>::max());
-                                        connected_to[1].push_back(std::numeric_limits<unsigned>::max());
-                                        line_numbers.push_back(num_rows);
-                                    }
+                                    chains[0].push_back(chain_end[0]);
+                                    chains[1].push_back(chain_end[1]);
+                                    chain_end_index = 0;
+                                    line_numbers.push_back(num_rows);
                                 }
                             }
                         }
                     }
-                    last = current;
-                    last_inside = current_inside;
-                    is_first_point = false;
                 }
+                last = current;
+                last_inside = current_inside;
+                is_first_point = false;
             }
             ++num_rows;
         }
@@ -230,178 +241,238 @@ void GyroidInfill::generateTotalGyroidInfill(Polygons& result_lines, bool zig_za
 
     if (zig_zaggify && chains[0].size() > 0)
     {
-        // zig-zaggification consists of joining alternate chain ends to make a chain of chains
-        // the basic algorithm is that we follow the infill area boundary and as we progress we are either drawing a connector or not
-        // whenever we come across the end of a chain we toggle the connector drawing state
-        // things are made more complicated by the fact that we want to avoid generating loops and so we need to keep track
-        // of the indentity of the first chain in a connected sequence
+        connectChains(result, in_outline, chains, line_numbers, pitch);
+    }
+
+    result_lines = result;
+}
 
-        int chain_ends_remaining = chains[0].size() * 2;
+void GyroidInfill::connectChains(Polygons& result, const Polygons& in_outline, const std::vector<Point2LL> (&chains)[2], const std::vector<int>& line_numbers, const coord_t cell_size)
+{
+    // zig-zaggification consists of joining alternate chain ends to make a chain of chains
+    // the basic algorithm is that we follow the infill area boundary and as we progress we are either drawing a connector or not
+    // whenever we come across the end of a chain we toggle the connector drawing state
+    // things are made more complicated by the fact that we want to avoid generating loops and so we need to keep track
+    // of the indentity of the first chain in a connected sequence
 
-        for (ConstPolygonRef outline_poly : in_outline)
+    std::vector<unsigned> connected_to[2]; // [chain_indices[], chain_indices[]]
+    connected_to[0].assign(chains[0].size(), std::numeric_limits<unsigned>::max());
+    connected_to[1].assign(chains[0].size(), std::numeric_limits<unsigned>::max());
+
+    // find the segments of the outline that each chain end meets in one pass, rather than testing all chain ends for every segment
+    // the chain ends of each segment are kept in the order of chain index and then point index, in which they are found
+    struct ChainEndOnOutline
+    {
+        size_t segment_index; // index of the outline segment, counting the segments of all polygons one after the other
+        unsigned chain_index;
+        unsigned point_index;
+    };
+    std::vector<size_t> first_segment_of_polygon(in_outline.size() + 1, 0);
+    for (size_t poly_idx = 0; poly_idx < in_outline.size(); ++poly_idx)
+    {
+        first_segment_of_polygon[poly_idx + 1] = first_segment_of_polygon[poly_idx] + in_outline[poly_idx].size();
+    }
+    constexpr coord_t chain_end_search_radius = 10; // chain ends are on the outline, within sqrt(10) of a segment
+    const std::unique_ptr<LocToLineGrid> outline_grid = PolygonUtils::createLocToLineGrid(in_outline, cell_size);
+    std::vector<ChainEndOnOutline> chain_ends_on_outline;
+    std::vector<size_t> segments_of_chain_end; // the same segment can be found in more than one cell of the grid
+    for (unsigned chain_index = 0; chain_index < chains[0].size(); ++chain_index)
+    {
+        for (unsigned point_index = 0; point_index < 2; ++point_index)
+        {
+            const Point2LL chain_end = chains[point_index][chain_index];
+            segments_of_chain_end.clear();
+            outline_grid->processNearby(
+                chain_end,
+                chain_end_search_radius,
+                [&](const PolygonsPointIndex& outline_point)
+                {
+                    const size_t segment_index = first_segment_of_polygon[outline_point.poly_idx_] + outline_point.point_idx_;
+                    // don't include chain ends that are close to the segment but are beyond the segment ends
+                    short beyond = 0;
+                    if (std::find(segments_of_chain_end.begin(), segments_of_chain_end.end(), segment_index) == segments_of_chain_end.end()
+                        && LinearAlg2D::getDist2FromLineSegment(outline_point.p(), chain_end, outline_point.next().p(), &beyond) < 10 && ! beyond)
+                    {
+                        segments_of_chain_end.push_back(segment_index);
+                        chain_ends_on_outline.push_back(ChainEndOnOutline{ segment_index, chain_index, point_index });
+                    }
+                    return true;
+                });
+        }
+    }
+    std::vector<size_t> segment_starts(first_segment_of_polygon.back() + 1, 0); // where the chain ends of each segment start in segment_chain_ends
+    for (const ChainEndOnOutline& chain_end : chain_ends_on_outline)
+    {
+        ++segment_starts[chain_end.segment_index + 1];
+    }
+    std::partial_sum(segment_starts.begin(), segment_starts.end(), segment_starts.begin());
+    std::vector<ChainEndOnOutline> segment_chain_ends(chain_ends_on_outline.size());
+    {
+        std::vector<size_t> next_of_segment(segment_starts.begin(), segment_starts.end() - 1);
+        for (const ChainEndOnOutline& chain_end : chain_ends_on_outline)
         {
-            std::vector<Point2LL> connector_points; // the points that make up a connector line
+            segment_chain_ends[next_of_segment[chain_end.segment_index]++] = chain_end;
+        }
+    }
 
-            // we need to remember the first chain processed and the path to it from the first outline point
-            // so that later we can possibly connect to it from the last chain processed
-            unsigned first_chain_chain_index = std::numeric_limits<unsigned>::max();
-            std::vector<Point2LL> path_to_first_chain;
+    int chain_ends_remaining = chains[0].size() * 2;
 
-            bool drawing = false; // true when a connector line is being (potentially) created
+    std::vector<unsigned> points_on_outline_chain_index;
+    std::vector<unsigned> points_on_outline_point_index;
+    for (size_t poly_idx = 0; poly_idx < in_outline.size(); ++poly_idx)
+    {
+        ConstPolygonRef outline_poly = in_outline[poly_idx];
+        std::vector<Point2LL> connector_points; // the points that make up a connector line
+
+        // we need to remember the first chain processed and the path to it from the first outline point
+        // so that later we can possibly connect to it from the last chain processed
+        unsigned first_chain_chain_index = std::numeric_limits<unsigned>::max();
+        std::vector<Point2LL> path_to_first_chain;
+
+        bool drawing = false; // true when a connector line is being (potentially) created
 
-            // keep track of the chain+point that a connector line started at
-            unsigned connector_start_chain_index = std::numeric_limits<unsigned>::max();
-            unsigned connector_start_point_index = std::numeric_limits<unsigned>::max();
+        // keep track of the chain+point that a connector line started at
+        unsigned connector_start_chain_index = std::numeric_limits<unsigned>::max();
+        unsigned connector_start_point_index = std::numeric_limits<unsigned>::max();
 
-            Point2LL cur_point; // current point of interest - either an outline point or a chain end
+        Point2LL cur_point; // current point of interest - either an outline point or a chain end
 
-            // go round all of the region's outline and find the chain ends that meet it
-            // quit the loop early if we have seen all the chain ends and are not currently drawing a connector
-            for (unsigned outline_point_index = 0; (chain_ends_remaining > 0 || drawing) && outline_point_index < outline_poly.size(); ++outline_point_index)
+        // go round all of the region's outline and find the chain ends that meet it
+        // quit the loop early if we have seen all the chain ends and are not currently drawing a connector
+        for (unsigned outline_point_index = 0; (chain_ends_remaining > 0 || drawing) && outline_point_index < outline_poly.size(); ++outline_point_index)
+        {
+            Point2LL op0 = outline_poly[outline_point_index];
+
+            // the chain ends that meet this segment of the outline
+            const size_t segment_index = first_segment_of_polygon[poly_idx] + outline_point_index;
+            points_on_outline_chain_index.clear();
+            points_on_outline_point_index.clear();
+            for (size_t chain_end_index = segment_starts[segment_index]; chain_end_index < segment_starts[segment_index + 1]; ++chain_end_index)
             {
-                Point2LL op0 = outline_poly[outline_point_index];
-                Point2LL op1 = outline_poly[(outline_point_index + 1) % outline_poly.size()];
-                std::vector<unsigned> points_on_outline_chain_index;
-                std::vector<unsigned> points_on_outline_point_index;
+                points_on_outline_point_index.push_back(segment_chain_ends[chain_end_index].point_index);
+                points_on_outline_chain_index.push_back(segment_chain_ends[chain_end_index].chain_index);
+            }
 
-                // collect the chain ends that meet this segment of the outline
-                for (unsigned chain_index = 0; chain_index < chains[0].size(); ++chain_index)
+            if (outline_point_index == 0 || vSize2(op0 - cur_point) > MM2INT(0.1))
+            {
+                // this is either the first outline point or it is another outline point that is not too close to cur_point
+
+                if (first_chain_chain_index == std::numeric_limits<unsigned>::max())
                 {
-                    for (unsigned point_index = 0; point_index < 2; ++point_index)
-                    {
-                        // don't include chain ends that are close to the segment but are beyond the segment ends
-                        short beyond = 0;
-                        if (LinearAlg2D::getDist2FromLineSegment(op0, chains[point_index][chain_index], op1, &beyond) < 10 && ! beyond)
-                        {
-                            points_on_outline_point_index.push_back(point_index);
-                            points_on_outline_chain_index.push_back(chain_index);
-                        }
-                    }
+                    // include the outline point in the path to the first chain
+                    path_to_first_chain.push_back(op0);
                 }
 
-                if (outline_point_index == 0 || vSize2(op0 - cur_point) > MM2INT(0.1))
+                cur_point = op0;
+                if (drawing)
                 {
-                    // this is either the first outline point or it is another outline point that is not too close to cur_point
-
-                    if (first_chain_chain_index == std::numeric_limits<unsigned>::max())
-                    {
-                        // include the outline point in the path to the first chain
-                        path_to_first_chain.push_back(op0);
-                    }
+                    // include the start point of this outline segment in the connector
+                    connector_points.push_back(op0);
+                }
+            }
 
-                    cur_point = op0;
-                    if (drawing)
+            // iterate through each of the chain ends that meet the current outline segment
+            while (points_on_outline_chain_index.size() > 0)
+            {
+                // find the nearest chain end to the current point
+                unsigned nearest_point_index = 0;
+                double nearest_point_dist2 = std::numeric_limits<float>::infinity();
+                for (unsigned pi = 0; pi < points_on_outline_chain_index.size(); ++pi)
+                {
+                    double dist2 = vSize2f(chains[points_on_outline_point_index[pi]][points_on_outline_chain_index[pi]] - cur_point);
+                    if (dist2 < nearest_point_dist2)
                     {
-                        // include the start point of this outline segment in the connector
-                        connector_points.push_back(op0);
+                        nearest_point_dist2 = dist2;
+                        nearest_point_index = pi;
                     }
                 }
+                const unsigned point_index = points_on_outline_point_index[nearest_point_index];
+                const unsigned chain_index = points_on_outline_chain_index[nearest_point_index];
 
-                // iterate through each of the chain ends that meet the current outline segment
-                while (points_on_outline_chain_index.size() > 0)
+                // make the chain end the current point and add it to the connector line
+                cur_point = chains[point_index][chain_index];
+
+                if (drawing && connector_points.size() > 0 && vSize2(cur_point - connector_points.back()) < MM2INT(0.1))
                 {
-                    // find the nearest chain end to the current point
-                    unsigned nearest_point_index = 0;
-                    double nearest_point_dist2 = std::numeric_limits<float>::infinity();
-                    for (unsigned pi = 0; pi < points_on_outline_chain_index.size(); ++pi)
-                    {
-                        double dist2 = vSize2f(chains[points_on_outline_point_index[pi]][points_on_outline_chain_index[pi]] - cur_point);
-                        if (dist2 < nearest_point_dist2)
-                        {
-                            nearest_point_dist2 = dist2;
-                            nearest_point_index = pi;
-                        }
-                    }
-                    const unsigned point_index = points_on_outline_point_index[nearest_point_index];
-                    const unsigned chain_index = points_on_outline_chain_index[nearest_point_index];
+                    // this chain end will be too close to the last connector point so throw away the last connector point
+                    connector_points.pop_back();
+                }
+                connector_points.push_back(cur_point);
 
-                    // make the chain end the current point and add it to the connector line
-                    cur_point = chains[point_index][chain_index];
+                if (first_chain_chain_index == std::numeric_limits<unsigned>::max())
+                {
+                    // this is the first chain to be processed, remember it
+                    first_chain_chain_index = chain_index;
+                    path_to_first_chain.push_back(cur_point);
+                }
 
-                    if (drawing && connector_points.size() > 0 && vSize2(cur_point - connector_points.back()) < MM2INT(0.1))
-                    {
-                        // this chain end will be too close to the last connector point so throw away the last connector point
-                        connector_points.pop_back();
-                    }
-                    connector_points.push_back(cur_point);
+                if (drawing)
+                {
+                    // add the connector line segments but only if
+                    //  1 - the start/end points are not the opposite ends of the same chain
+                    //  2 - the other end of the current chain is not connected to the chain the connector line is coming from
 
-                    if (first_chain_chain_index == std::numeric_limits<unsigned>::max())
+                    if (chain_index != connector_start_chain_index && connected_to[(point_index + 1) % 2][chain_index] != connector_start_chain_index)
                     {
-                        // this is the first chain to be processed, remember it
-                        first_chain_chain_index = chain_index;
-                        path_to_first_chain.push_back(cur_point);
+                        result.add(connector_points);
+                        drawing = false;
+                        connector_points.clear();
+                        // remember the connection
+                        connected_to[point_index][chain_index] = connector_start_chain_index;
+                        connected_to[connector_start_point_index][connector_start_chain_index] = chain_index;
                     }
-
-                    if (drawing)
+                    else
                     {
-                        // add the connector line segments but only if
-                        //  1 - the start/end points are not the opposite ends of the same chain
-                        //  2 - the other end of the current chain is not connected to the chain the connector line is coming from
+                        // start a new connector from the current location
+                        connector_points.clear();
+                        connector_points.push_back(cur_point);
 
-                        if (chain_index != connector_start_chain_index && connected_to[(point_index + 1) % 2][chain_index] != connector_start_chain_index)
-                        {
-                            result.add(connector_points);
-                            drawing = false;
-                            connector_points.clear();
-                            // remember the connection
-                            connected_to[point_index][chain_index] = connector_start_chain_index;
-                            connected_to[connector_start_point_index][connector_start_chain_index] = chain_index;
-                        }
-                        else
-                        {
-                            // start a new connector from the current location
-                            connector_points.clear();
-                            connector_points.push_back(cur_point);
-
-                            // remember the chain+point that the connector started from
-                            connector_start_chain_index = chain_index;
-                            connector_start_point_index = point_index;
-                        }
+                        // remember the chain+point that the connector started from
+                        connector_start_chain_index = chain_index;
+                        connector_start_point_index = point_index;
                     }
-                    else
-                    {
-                        // we have just jumped a gap so now we want to start drawing again
-                        drawing = true;
+                }
+                else
+                {
+                    // we have just jumped a gap so now we want to start drawing again
+                    drawing = true;
 
-                        // if this connector is the first to be created or we are not connecting chains from the same row/column,
-                        // remember the chain+point that this connector is starting from
-                        if (connector_start_chain_index == std::numeric_limits<unsigned>::max() || line_numbers[chain_index] != line_numbers[connector_start_chain_index])
-                        {
-                            connector_start_chain_index = chain_index;
-                            connector_start_point_index = point_index;
-                        }
+                    // if this connector is the first to be created or we are not connecting chains from the same row/column,
+                    // remember the chain+point that this connector is starting from
+                    if (connector_start_chain_index == std::numeric_limits<unsigned>::max() || line_numbers[chain_index] != line_numbers[connector_start_chain_index])
+                    {
+                        connector_start_chain_index = chain_index;
+                        connector_start_point_index = point_index;
                     }
+                }
 
-                    // done with this chain end
-                    points_on_outline_chain_index.erase(points_on_outline_chain_index.begin() + nearest_point_index);
-                    points_on_outline_point_index.erase(points_on_outline_point_index.begin() + nearest_point_index);
+                // done with this chain end
+                points_on_outline_chain_index.erase(points_on_outline_chain_index.begin() + nearest_point_index);
+                points_on_outline_point_index.erase(points_on_outline_point_index.begin() + nearest_point_index);
 
-                    // decrement total amount of work to do
-                    --chain_ends_remaining;
-                }
+                // decrement total amount of work to do
+                --chain_ends_remaining;
             }
+        }
 
-            // we have now visited all the points in the outline, if a connector was (potentially) being drawn
-            // check whether the first chain is already connected to the last chain and, if not, draw the
-            // connector between
-            if (drawing && first_chain_chain_index != std::numeric_limits<unsigned>::max() && first_chain_chain_index != connector_start_chain_index
-                && connected_to[0][first_chain_chain_index] != connector_start_chain_index && connected_to[1][first_chain_chain_index] != connector_start_chain_index)
-            {
-                // output the connector line segments from the last chain to the first point in the outline
-                connector_points.push_back(outline_poly[0]);
-                result.add(connector_points);
-                // output the connector line segments from the first point in the outline to the first chain
-                result.add(path_to_first_chain);
-            }
+        // we have now visited all the points in the outline, if a connector was (potentially) being drawn
+        // check whether the first chain is already connected to the last chain and, if not, draw the
+        // connector between
+        if (drawing && first_chain_chain_index != std::numeric_limits<unsigned>::max() && first_chain_chain_index != connector_start_chain_index
+            && connected_to[0][first_chain_chain_index] != connector_start_chain_index && connected_to[1][first_chain_chain_index] != connector_start_chain_index)
+        {
+            // output the connector line segments from the last chain to the first point in the outline
+            connector_points.push_back(outline_poly[0]);
+            result.add(connector_points);
+            // output the connector line segments from the first point in the outline to the first chain
+            result.add(path_to_first_chain);
+        }
 
-            if (chain_ends_remaining < 1)
-            {
-                break;
-            }
+        if (chain_ends_remaining < 1)
+        {
+            break;
         }
     }
-
-    result_lines = result;
 }
 
 } // namespace cura
@@ -22,7 +22,7 @@ ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename,
 {
     int desired_channel_count = 0; // keep original amount of channels
     int img_x, img_y, img_z; // stbi requires pointer to int rather than to coord_t
-    image = stbi_load(filename.c_str(), &img_x, &img_y, &img_z, desired_channel_count);
+    unsigned char* image = stbi_load(filename.c_str(), &img_x, &img_y, &img_z, desired_channel_count);
     image_size = Point3LL(img_x, img_y, img_z);
     if (! image)
     {
@@ -52,15 +52,36 @@ ImageBasedDensityProvider::ImageBasedDensityProvider(const std::string filename,
         print_aabb = AABB(middle - aabb_size / 2, middle + aabb_size / 2);
         assert(aabb_size.X >= model_aabb_size.X && aabb_size.Y >= model_aabb_size.Y);
     }
+    { // compute summed-area table, flipping the rows so that row 0 is at the bottom
+        const size_t table_width = img_x + 1;
+        summed_lightness.assign(table_width * (img_y + 1), 0);
+        for (int y = 0; y < img_y; y++)
+        {
+            const unsigned char* row = image + static_cast<size_t>(img_y - 1 - y) * img_x * img_z;
+            uint64_t row_lightness = 0;
+            for (int x = 0; x < img_x; x++)
+            {
+                for (int z = 0; z < img_z; z++)
+                {
+                    row_lightness += row[x * img_z + z];
+                }
+                summed_lightness[(y + 1) * table_width + x + 1] = summed_lightness[y * table_width + x + 1] + row_lightness;
+            }
+        }
+    }
+    stbi_image_free(image);
 }
 
 
 ImageBasedDensityProvider::~ImageBasedDensityProvider()
 {
-    if (image)
-    {
-        stbi_image_free(image);
-    }
+}
+
+uint64_t ImageBasedDensityProvider::getTotalLightness(const coord_t min_x, const coord_t min_y, const coord_t max_x, const coord_t max_y) const
+{
+    const size_t table_width = image_size.x_ + 1;
+    return summed_lightness[(max_y + 1) * table_width + max_x + 1] - summed_lightness[min_y * table_width + max_x + 1] - summed_lightness[(max_y + 1) * table_width + min_x]
+         + summed_lightness[min_y * table_width + min_x];
 }
 
 double ImageBasedDensityProvider::operator()(const AABB3D& query_cube) const
@@ -68,30 +89,24 @@ double ImageBasedDensityProvider::operator()(const AABB3D& query_cube) const
     AABB query_box(Point2LL(query_cube.min_.x_, query_cube.min_.y_), Point2LL(query_cube.max_.x_, query_cube.max_.y_));
     Point2LL img_min = (query_box.min_ - print_aabb.min_ - Point2LL(1, 1)) * image_size.x_ / (print_aabb.max_.X - print_aabb.min_.X);
     Point2LL img_max = (query_box.max_ - print_aabb.min_ + Point2LL(1, 1)) * image_size.y_ / (print_aabb.max_.Y - print_aabb.min_.Y);
-    long total_lightness = 0;
-    int value_count = 0;
-    for (int x = std::max((coord_t)0, img_min.X); x <= std::min((coord_t)image_size.x_ - 1, img_max.X); x++)
+    const coord_t min_x = std::max((coord_t)0, img_min.X);
+    const coord_t min_y = std::max((coord_t)0, img_min.Y);
+    const coord_t max_x = std::min((coord_t)image_size.x_ - 1, img_max.X);
+    const coord_t max_y = std::min((coord_t)image_size.y_ - 1, img_max.Y);
+    uint64_t total_lightness;
+    coord_t value_count;
+    if (min_x <= max_x && min_y <= max_y)
     {
-        for (int y = std::max((coord_t)0, img_min.Y); y <= std::min((coord_t)image_size.y_ - 1, img_max.Y); y++)
-        {
-            for (int z = 0; z < image_size.z_; z++)
-            {
-                total_lightness += image[((image_size.y_ - 1 - y) * image_size.x_ + x) * image_size.z_ + z];
-                value_count++;
-            }
-        }
+        total_lightness = getTotalLightness(min_x, min_y, max_x, max_y);
+        value_count = (max_x - min_x + 1) * (max_y - min_y + 1) * image_size.z_;
     }
-    if (value_count == 0)
+    else
     { // triangle falls outside of image or in between pixels, so we return the closest pixel
         Point2LL closest_pixel = (img_min + img_max) / 2;
         closest_pixel.X = std::max((coord_t)0, std::min((coord_t)image_size.x_ - 1, (coord_t)closest_pixel.X));
         closest_pixel.Y = std::max((coord_t)0, std::min((coord_t)image_size.y_ - 1, (coord_t)closest_pixel.Y));
-        assert(total_lightness == 0);
-        for (int z = 0; z < image_size.z_; z++)
-        {
-            total_lightness += image[((image_size.y_ - 1 - closest_pixel.Y) * image_size.x_ + closest_pixel.X) * image_size.z_ + z];
-            value_count++;
-        }
+        total_lightness = getTotalLightness(closest_pixel.X, closest_pixel.Y, closest_pixel.X, closest_pixel.Y);
+        value_count = image_size.z_;
     }
     return 1.0 - ((double)total_lightness) / value_count / 255.0;
 }
@@ -3,28 +3,36 @@
 
 #include "infill/LightningDistanceField.h" //Class we're implementing.
 
+#include <algorithm>
+#include <bit>
+#include <list>
+
+#include "utils/PolygonsSpatialIndex.h"
 #include "utils/polygonUtils.h" //For spreadDotsArea helper function.
 
 namespace cura
 {
 
 constexpr coord_t radius_per_cell_size = 6; // The cell-size should be small compared to the radius, but not so small as to be inefficient.
+constexpr size_t bits_per_word = 64;
 
 LightningDistanceField::LightningDistanceField(const coord_t& radius, const Polygons& current_outline, const Polygons& current_overhang)
     : cell_size_(radius / radius_per_cell_size)
-    , grid_(cell_size_)
     , supporting_radius_(radius)
     , current_outline_(current_outline)
     , current_overhang_(current_overhang)
 {
     std::vector<Point2LL> regular_dots = PolygonUtils::spreadDotsArea(current_overhang, cell_size_);
+    const PolygonsSpatialIndex outline_index(current_outline);
+    // The comparison below is not a strict weak ordering, so the resulting order depends on the sorting algorithm. Sort as a list to keep it.
+    std::list<UnsupCell> sorted_points;
     for (const auto& p : regular_dots)
     {
-        const ClosestPolygonPoint cpp = PolygonUtils::findClosest(p, current_outline);
+        const ClosestPolygonPoint cpp = outline_index.findClosest(p);
         const coord_t dist_to_boundary = vSize(p - cpp.p());
-        unsupported_points_.emplace_back(p, dist_to_boundary);
+        sorted_points.emplace_back(p, dist_to_boundary);
     }
-    unsupported_points_.sort(
+    sorted_points.sort(
         [&radius](const UnsupCell& a, const UnsupCell& b)
         {
             constexpr coord_t prime_for_hash = 191;
@@ -32,54 +40,108 @@ LightningDistanceField::LightningDistanceField(const coord_t& radius, const Poly
                      ? a.dist_to_boundary_ < b.dist_to_boundary_
                      : (std::hash<Point2LL>{}(a.loc_) % prime_for_hash) < (std::hash<Point2LL>{}(b.loc_) % prime_for_hash);
         });
-    for (auto it = unsupported_points_.begin(); it != unsupported_points_.end(); ++it)
+    unsupported_points_.assign(sorted_points.begin(), sorted_points.end());
+    if (unsupported_points_.empty())
+    {
+        return;
+    }
+
+    Point2LL grid_max = unsupported_points_.front().loc_;
+    grid_origin_ = grid_max;
+    for (const UnsupCell& cell : unsupported_points_)
+    {
+        grid_origin_ = Point2LL(std::min(grid_origin_.X, cell.loc_.X), std::min(grid_origin_.Y, cell.loc_.Y));
+        grid_max = Point2LL(std::max(grid_max.X, cell.loc_.X), std::max(grid_max.Y, cell.loc_.Y));
+    }
+    grid_width_ = static_cast<size_t>((grid_max.X - grid_origin_.X) / cell_size_) + 1;
+    grid_height_ = static_cast<size_t>((grid_max.Y - grid_origin_.Y) / cell_size_) + 1;
+    words_per_row_ = (grid_width_ + bits_per_word - 1) / bits_per_word;
+    unsupported_bits_.assign(words_per_row_ * grid_height_, 0);
+    square_points_.assign(grid_width_ * grid_height_, 0);
+    for (size_t point_idx = 0; point_idx < unsupported_points_.size(); point_idx++)
     {
-        UnsupCell& cell = *it;
-        unsupported_points_grid_.emplace(grid_.toGridPoint(cell.loc_), it);
+        const Point2LL& loc = unsupported_points_[point_idx].loc_;
+        const size_t x = static_cast<size_t>((loc.X - grid_origin_.X) / cell_size_);
+        const size_t y = static_cast<size_t>((loc.Y - grid_origin_.Y) / cell_size_);
+        uint64_t& word = unsupported_bits_[y * words_per_row_ + x / bits_per_word];
+        const uint64_t bit = uint64_t(1) << (x % bits_per_word);
+        if (word & bit)
+        {
+            continue; // The dots are spread one per grid square, so this shouldn't happen. Only the first one is tracked, like in a map of squares.
+        }
+        word |= bit;
+        square_points_[y * grid_width_ + x] = static_cast<uint32_t>(point_idx);
     }
 }
 
+bool LightningDistanceField::isUnsupported(const size_t point_idx) const
+{
+    const Point2LL& loc = unsupported_points_[point_idx].loc_;
+    const size_t x = static_cast<size_t>((loc.X - grid_origin_.X) / cell_size_);
+    const size_t y = static_cast<size_t>((loc.Y - grid_origin_.Y) / cell_size_);
+    const bool is_set = (unsupported_bits_[y * words_per_row_ + x / bits_per_word] >> (x % bits_per_word)) & 1;
+    return is_set && square_points_[y * grid_width_ + x] == point_idx;
+}
+
 bool LightningDistanceField::tryGetNextPoint(Point2LL* p) const
 {
-    if (unsupported_points_.empty())
+    if (next_unsupported_point_ >= unsupported_points_.size())
     {
         return false;
     }
-    *p = unsupported_points_.front().loc_;
+    *p = unsupported_points_[next_unsupported_point_].loc_;
     return true;
 }
 
-void LightningDistanceField::update(const Point2LL& to_node, const Point2LL& added_leaf)
+void LightningDistanceField::update(const Point2LL& /*to_node*/, const Point2LL& added_leaf)
 {
-    auto process_func = [added_leaf, this](const SquareGrid::GridPoint& grid_loc)
+    if (unsupported_points_.empty())
     {
-        auto it = unsupported_points_grid_.find(grid_loc);
-        if (it != unsupported_points_grid_.end())
+        return;
+    }
+
+    // Only the squares that overlap the bounding box of the supporting radius around the leaf can have cells that get supported.
+    const coord_t max_x = added_leaf.X + supporting_radius_ - grid_origin_.X;
+    const coord_t max_y = added_leaf.Y + supporting_radius_ - grid_origin_.Y;
+    if (max_x < 0 || max_y < 0)
+    {
+        return;
+    }
+    const size_t min_square_x = static_cast<size_t>(std::max(coord_t(0), added_leaf.X - supporting_radius_ - grid_origin_.X) / cell_size_);
+    const size_t min_square_y = static_cast<size_t>(std::max(coord_t(0), added_leaf.Y - supporting_radius_ - grid_origin_.Y) / cell_size_);
+    const size_t max_square_x = std::min(grid_width_ - 1, static_cast<size_t>(max_x / cell_size_));
+    const size_t max_square_y = std::min(grid_height_ - 1, static_cast<size_t>(max_y / cell_size_));
+    if (min_square_x > max_square_x || min_square_y > max_square_y)
+    {
+        return;
+    }
+
+    for (size_t y = min_square_y; y <= max_square_y; y++)
+    {
+        uint64_t* row = &unsupported_bits_[y * words_per_row_];
+        for (size_t word_idx = min_square_x / bits_per_word; word_idx <= max_square_x / bits_per_word; word_idx++)
         {
-            std::list<UnsupCell>::iterator& list_it = it->second;
-            UnsupCell& cell = *list_it;
-            if (shorterThen(cell.loc_ - added_leaf, supporting_radius_))
+            const size_t first_bit = word_idx == min_square_x / bits_per_word ? min_square_x % bits_per_word : 0;
+            const size_t last_bit = word_idx == max_square_x / bits_per_word ? max_square_x % bits_per_word : bits_per_word - 1;
+            uint64_t candidates = row[word_idx] & (~uint64_t(0) << first_bit) & (~uint64_t(0) >> (bits_per_word - 1 - last_bit));
+            while (candidates != 0)
             {
-                unsupported_points_.erase(list_it);
-                unsupported_points_grid_.erase(it);
+                const size_t bit_idx = std::countr_zero(candidates);
+                candidates &= candidates - 1;
+                const size_t x = word_idx * bits_per_word + bit_idx;
+                const UnsupCell& cell = unsupported_points_[square_points_[y * grid_width_ + x]];
+                if (shorterThen(cell.loc_ - added_leaf, supporting_radius_))
+                {
+                    row[word_idx] &= ~(uint64_t(1) << bit_idx);
+                }
             }
         }
-        return true;
-    };
-    const Point2LL a = to_node;
-    const Point2LL b = added_leaf;
-    Point2LL ab = b - a;
-    Point2LL ab_T = turn90CCW(ab);
-    Point2LL extent = normal(ab_T, supporting_radius_);
-    // TODO: process cells only once; make use of PolygonUtils::spreadDotsArea
-    grid_.processLineCells(
-        std::make_pair(a + extent, a - extent),
-        [this, ab, extent, &process_func](const SquareGrid::GridPoint& p)
-        {
-            grid_.processLineCells(std::make_pair(p, p + ab), process_func);
-            return true;
-        });
-    grid_.processNearby(added_leaf, supporting_radius_, process_func);
+    }
+
+    while (next_unsupported_point_ < unsupported_points_.size() && ! isUnsupported(next_unsupported_point_))
+    {
+        next_unsupported_point_++;
+    }
 }
 
-} // namespace cura
\ No newline at end of file
+} // namespace cura
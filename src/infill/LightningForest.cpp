@@ -0,0 +1,511 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher
+
+#include "infill/LightningForest.h"
+
+#include <algorithm>
+
+#include "utils/linearAlg2D.h"
+
+using namespace cura;
+
+size_t LightningForest::createRoot(const Point2LL& p, const std::optional<Point2LL>& last_grounding_location /*= std::nullopt*/)
+{
+    locations_.push_back(p);
+    parents_.push_back(no_node);
+    first_children_.push_back(no_node);
+    next_siblings_.push_back(no_node);
+    last_grounding_locations_.push_back(last_grounding_location);
+    return locations_.size() - 1;
+}
+
+coord_t LightningForest::getWeightedDistance(const size_t node, const Point2LL& unsupported_location, const coord_t& supporting_radius) const
+{
+    constexpr coord_t min_valence_for_boost = 0;
+    constexpr coord_t max_valence_for_boost = 4;
+    constexpr coord_t valence_boost_multiplier = 4;
+
+    const size_t valence = (! isRoot(node)) + childCount(node);
+    const coord_t valence_boost = (min_valence_for_boost < valence && valence < max_valence_for_boost) ? valence_boost_multiplier * supporting_radius : 0;
+    const coord_t dist_here = vSize(getLocation(node) - unsupported_location);
+    return dist_here - valence_boost;
+}
+
+bool LightningForest::hasOffspring(const size_t node, const size_t to_be_checked) const
+{
+    for (size_t ancestor = to_be_checked; ancestor != no_node; ancestor = parents_[ancestor])
+    {
+        if (ancestor == node)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t LightningForest::addChild(const size_t node, const Point2LL& child_loc)
+{
+    assert(locations_[node] != child_loc);
+    const size_t child = createRoot(child_loc);
+    return addChild(node, child);
+}
+
+size_t LightningForest::addChild(const size_t node, const size_t new_child)
+{
+    assert(new_child != node);
+    assert(isRoot(new_child) && next_siblings_[new_child] == no_node);
+    // assert(p != new_child->p); // NOTE: No problem for now. Issue to solve later. Maybe even afetr final. Low prio.
+    if (first_children_[node] == no_node)
+    {
+        first_children_[node] = new_child;
+    }
+    else
+    {
+        size_t last_child = first_children_[node];
+        while (next_siblings_[last_child] != no_node)
+        {
+            last_child = next_siblings_[last_child];
+        }
+        next_siblings_[last_child] = new_child;
+    }
+    parents_[new_child] = node;
+    return new_child;
+}
+
+size_t LightningForest::childCount(const size_t node) const
+{
+    size_t count = 0;
+    for (size_t child = first_children_[node]; child != no_node; child = next_siblings_[child])
+    {
+        count++;
+    }
+    return count;
+}
+
+LightningForest LightningForest::propagateToNextLayer(
+    const std::vector<size_t>& roots,
+    std::vector<size_t>& next_roots,
+    const Polygons& next_outlines,
+    const LocToLineGrid& outline_locator,
+    const coord_t prune_distance,
+    const coord_t smooth_magnitude,
+    const coord_t max_remove_colinear_dist) const
+{
+    // Copy all trees at once. Only the roots of the copies remember where they were grounded.
+    LightningForest forest_below = *this;
+    std::fill(forest_below.last_grounding_locations_.begin(), forest_below.last_grounding_locations_.end(), std::nullopt);
+    for (const size_t root : roots)
+    {
+        if (isRoot(root))
+        {
+            forest_below.last_grounding_locations_[root] = last_grounding_locations_[root].value_or(locations_[root]);
+        }
+    }
+
+    next_roots.clear();
+    for (const size_t root : roots)
+    {
+        forest_below.prune(root, prune_distance);
+        forest_below.straighten(root, smooth_magnitude, max_remove_colinear_dist);
+        if (forest_below.realign(root, next_outlines, outline_locator, next_roots))
+        {
+            next_roots.push_back(root);
+        }
+    }
+    forest_below.compact(next_roots);
+    return forest_below;
+}
+
+void LightningForest::compact(std::vector<size_t>& roots)
+{
+    // Mark the nodes that are still in a tree, then number them in the order they were made.
+    std::vector<size_t> new_indices(size(), no_node);
+    for (const size_t root : roots)
+    {
+        visitNodes(
+            root,
+            [&new_indices](const size_t node)
+            {
+                new_indices[node] = 0;
+            });
+    }
+    size_t node_count = 0;
+    for (size_t& new_index : new_indices)
+    {
+        if (new_index != no_node)
+        {
+            new_index = node_count++;
+        }
+    }
+    const auto renumber = [&new_indices](const size_t node)
+    {
+        return node == no_node ? no_node : new_indices[node];
+    };
+
+    // Every node moves to an index that is no higher than its own, so the arrays can be moved down in place.
+    for (size_t node = 0; node < new_indices.size(); node++)
+    {
+        const size_t new_index = new_indices[node];
+        if (new_index == no_node)
+        {
+            continue;
+        }
+        locations_[new_index] = locations_[node];
+        parents_[new_index] = renumber(parents_[node]);
+        first_children_[new_index] = renumber(first_children_[node]);
+        next_siblings_[new_index] = renumber(next_siblings_[node]);
+        last_grounding_locations_[new_index] = last_grounding_locations_[node];
+    }
+    locations_.resize(node_count);
+    parents_.resize(node_count);
+    first_children_.resize(node_count);
+    next_siblings_.resize(node_count);
+    last_grounding_locations_.resize(node_count);
+
+    for (size_t& root : roots)
+    {
+        root = new_indices[root];
+    }
+}
+
+void LightningForest::reroot(const size_t node, const size_t new_parent /*= no_node*/)
+{
+    if (! isRoot(node))
+    {
+        const size_t old_parent = parents_[node];
+        reroot(old_parent, node);
+        parents_[old_parent] = no_node; // Becomes a child of this node, as the last one.
+        next_siblings_[old_parent] = no_node;
+        addChild(node, old_parent);
+    }
+
+    if (new_parent != no_node)
+    {
+        // Take the new parent out of the children of this node.
+        size_t previous_child = no_node;
+        for (size_t child = first_children_[node]; child != no_node; child = next_siblings_[child])
+        {
+            if (child == new_parent)
+            {
+                (previous_child == no_node ? first_children_[node] : next_siblings_[previous_child]) = next_siblings_[child];
+                next_siblings_[child] = no_node;
+                break;
+            }
+            previous_child = child;
+        }
+        parents_[node] = new_parent;
+    }
+    else
+    {
+        parents_[node] = no_node;
+    }
+}
+
+size_t LightningForest::closestNode(const size_t node, const Point2LL& loc) const
+{
+    size_t result = node;
+    coord_t closest_dist2 = vSize2(locations_[node] - loc);
+
+    for (size_t child = first_children_[node]; child != no_node; child = next_siblings_[child])
+    {
+        const size_t candidate_node = closestNode(child, loc);
+        const coord_t child_dist2 = vSize2(locations_[candidate_node] - loc);
+        if (child_dist2 < closest_dist2)
+        {
+            closest_dist2 = child_dist2;
+            result = candidate_node;
+        }
+    }
+
+    return result;
+}
+
+bool LightningForest::realign(const size_t node, const Polygons& outlines, const LocToLineGrid& outline_locator, std::vector<size_t>& rerooted_parts)
+{
+    if (outlines.empty())
+    {
+        return false;
+    }
+
+    if (outlines.inside(locations_[node], true))
+    {
+        // Only keep children that have an unbroken connection to here, realign will put the rest in rerooted parts due to recursion:
+        Point2LL coll;
+        bool reground_me = false;
+        size_t previous_child = no_node;
+        for (size_t child = first_children_[node]; child != no_node;)
+        {
+            bool connect_branch = realign(child, outlines, outline_locator, rerooted_parts);
+            const size_t next_child = next_siblings_[child];
+            if (connect_branch
+                && PolygonUtils::lineSegmentPolygonsIntersection(locations_[child], locations_[node], outlines, outline_locator, coll, outline_locator.getCellSize() * 2))
+            {
+                last_grounding_locations_[child].reset();
+                parents_[child] = no_node;
+                next_siblings_[child] = no_node;
+                rerooted_parts.push_back(child);
+
+                reground_me = true;
+                connect_branch = false;
+            }
+            if (connect_branch)
+            {
+                previous_child = child;
+            }
+            else
+            {
+                (previous_child == no_node ? first_children_[node] : next_siblings_[previous_child]) = next_child;
+            }
+            child = next_child;
+        }
+        if (reground_me)
+        {
+            last_grounding_locations_[node].reset();
+        }
+        return true;
+    }
+
+    // 'Lift' any decendants out of this tree:
+    for (size_t child = first_children_[node]; child != no_node;)
+    {
+        const bool keep_child = realign(child, outlines, outline_locator, rerooted_parts);
+        const size_t next_child = next_siblings_[child];
+        if (keep_child)
+        {
+            last_grounding_locations_[child] = locations_[node];
+            parents_[child] = no_node;
+            next_siblings_[child] = no_node;
+            rerooted_parts.push_back(child);
+        }
+        child = next_child;
+    }
+    first_children_[node] = no_node;
+
+    return false;
+}
+
+void LightningForest::straighten(const size_t node, const coord_t magnitude, const coord_t max_remove_colinear_dist)
+{
+    straighten(node, magnitude, locations_[node], 0, max_remove_colinear_dist * max_remove_colinear_dist);
+}
+
+LightningForest::RectilinearJunction LightningForest::straighten(
+    const size_t node,
+    const coord_t magnitude,
+    const Point2LL& junction_above,
+    const coord_t accumulated_dist,
+    const coord_t max_remove_colinear_dist2)
+{
+    constexpr coord_t junction_magnitude_factor_numerator = 3;
+    constexpr coord_t junction_magnitude_factor_denominator = 4;
+
+    const coord_t junction_magnitude = magnitude * junction_magnitude_factor_numerator / junction_magnitude_factor_denominator;
+    if (first_children_[node] != no_node && next_siblings_[first_children_[node]] == no_node) // Exactly one child.
+    {
+        size_t child = first_children_[node];
+        coord_t child_dist = vSize(locations_[node] - locations_[child]);
+        RectilinearJunction junction_below = straighten(child, magnitude, junction_above, accumulated_dist + child_dist, max_remove_colinear_dist2);
+        coord_t total_dist_to_junction_below = junction_below.total_recti_dist;
+        Point2LL a = junction_above;
+        Point2LL b = junction_below.junction_loc;
+        Point2LL& p = locations_[node];
+        if (a != b) // should always be true!
+        {
+            Point2LL ab = b - a;
+            Point2LL destination = a + ab * accumulated_dist / std::max(coord_t(1), total_dist_to_junction_below);
+            if (shorterThen(destination - p, magnitude))
+            {
+                p = destination;
+            }
+            else
+            {
+                p = p + normal(destination - p, magnitude);
+            }
+        }
+        { // remove nodes on linear segments
+            constexpr coord_t close_enough = 10;
+
+            child = first_children_[node]; // recursive call to straighten might have removed the child
+            const size_t parent_node = parents_[node];
+            if (parent_node != no_node && vSize2(locations_[child] - locations_[parent_node]) < max_remove_colinear_dist2
+                && LinearAlg2D::getDist2FromLineSegment(locations_[parent_node], p, locations_[child]) < close_enough)
+            {
+                parents_[child] = parent_node;
+                // Replace this node by its child among its siblings. This node itself is left out of the tree.
+                next_siblings_[child] = next_siblings_[node];
+                if (first_children_[parent_node] == node)
+                {
+                    first_children_[parent_node] = child;
+                }
+                else
+                {
+                    size_t sibling = first_children_[parent_node];
+                    while (next_siblings_[sibling] != node)
+                    {
+                        sibling = next_siblings_[sibling];
+                    }
+                    next_siblings_[sibling] = child;
+                }
+            }
+        }
+        return junction_below;
+    }
+    else
+    {
+        constexpr coord_t weight = 1000;
+        Point2LL junction_moving_dir = normal(junction_above - locations_[node], weight);
+        bool prevent_junction_moving = false;
+        for (size_t child = first_children_[node]; child != no_node; child = next_siblings_[child])
+        {
+            const coord_t child_dist = vSize(locations_[node] - locations_[child]);
+            RectilinearJunction below = straighten(child, magnitude, locations_[node], child_dist, max_remove_colinear_dist2);
+
+            junction_moving_dir += normal(below.junction_loc - locations_[node], weight);
+            if (below.total_recti_dist < magnitude) // TODO: make configurable?
+            {
+                prevent_junction_moving = true; // prevent flipflopping in branches due to straightening and junctoin moving clashing
+            }
+        }
+        if (junction_moving_dir != Point2LL(0, 0) && first_children_[node] != no_node && ! isRoot(node) && ! prevent_junction_moving)
+        {
+            coord_t junction_moving_dir_len = vSize(junction_moving_dir);
+            if (junction_moving_dir_len > junction_magnitude)
+            {
+                junction_moving_dir = junction_moving_dir * junction_magnitude / junction_moving_dir_len;
+            }
+            locations_[node] += junction_moving_dir;
+        }
+        return RectilinearJunction{ accumulated_dist, locations_[node] };
+    }
+}
+
+// Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
+coord_t LightningForest::prune(const size_t node, const coord_t& pruning_distance)
+{
+    if (pruning_distance <= 0)
+    {
+        return 0;
+    }
+
+    coord_t max_distance_pruned = 0;
+    size_t previous_child = no_node;
+    for (size_t child = first_children_[node]; child != no_node;)
+    {
+        const size_t next_child = next_siblings_[child];
+        coord_t dist_pruned_child = prune(child, pruning_distance);
+        if (dist_pruned_child >= pruning_distance)
+        { // pruning is finished for child; dont modify further
+            max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child);
+            previous_child = child;
+        }
+        else
+        {
+            const Point2LL a = getLocation(node);
+            const Point2LL b = getLocation(child);
+            const Point2LL ba = a - b;
+            const coord_t ab_len = vSize(ba);
+            if (dist_pruned_child + ab_len <= pruning_distance)
+            { // we're still in the process of pruning
+                assert(first_children_[child] == no_node && "when pruning away a node all it's children must already have been pruned away");
+                max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child + ab_len);
+                (previous_child == no_node ? first_children_[node] : next_siblings_[previous_child]) = next_child;
+            }
+            else
+            { // pruning stops in between this node and the child
+                const Point2LL n = b + normal(ba, pruning_distance - dist_pruned_child);
+                assert(std::abs(vSize(n - b) + dist_pruned_child - pruning_distance) < 10 && "total pruned distance must be equal to the pruning_distance");
+                max_distance_pruned = std::max(max_distance_pruned, pruning_distance);
+                setLocation(child, n);
+                previous_child = child;
+            }
+        }
+        child = next_child;
+    }
+
+    return max_distance_pruned;
+}
+
+void LightningForest::convertToPolylines(const size_t root, Polygons& output, const coord_t line_width) const
+{
+    Polygons result;
+    result.newPoly();
+    convertToPolylines(root, 0, result);
+    removeJunctionOverlap(result, line_width);
+    output.add(result);
+}
+
+void LightningForest::convertToPolylines(const size_t node, size_t long_line_idx, Polygons& output) const
+{
+    const size_t child_count = childCount(node);
+    if (child_count == 0)
+    {
+        output[long_line_idx].add(locations_[node]);
+        return;
+    }
+    const auto child_at = [this, node](size_t child_idx)
+    {
+        size_t child = first_children_[node];
+        for (; child_idx > 0; child_idx--)
+        {
+            child = next_siblings_[child];
+        }
+        return child;
+    };
+    size_t first_child_idx = rand() % child_count;
+    convertToPolylines(child_at(first_child_idx), long_line_idx, output);
+    output[long_line_idx].add(locations_[node]);
+
+    for (size_t idx_offset = 1; idx_offset < child_count; idx_offset++)
+    {
+        size_t child_idx = (first_child_idx + idx_offset) % child_count;
+        output.newPoly();
+        size_t child_line_idx = output.size() - 1;
+        convertToPolylines(child_at(child_idx), child_line_idx, output);
+        output[child_line_idx].add(locations_[node]);
+    }
+}
+
+void LightningForest::removeJunctionOverlap(Polygons& result_lines, const coord_t line_width)
+{
+    const coord_t reduction = line_width / 2; // TODO make configurable?
+    for (auto poly_it = result_lines.begin(); poly_it != result_lines.end();)
+    {
+        PolygonRef polyline = *poly_it;
+        if (polyline.size() <= 1)
+        {
+            polyline = std::move(result_lines.back());
+            result_lines.pop_back();
+            continue;
+        }
+
+        coord_t to_be_reduced = reduction;
+        Point2LL a = polyline.back();
+        for (int point_idx = polyline.size() - 2; point_idx >= 0; point_idx--)
+        {
+            const Point2LL b = polyline[point_idx];
+            const Point2LL ab = b - a;
+            const coord_t ab_len = vSize(ab);
+            if (ab_len >= to_be_reduced)
+            {
+                polyline.back() = a + ab * to_be_reduced / ab_len;
+                break;
+            }
+            else
+            {
+                to_be_reduced -= ab_len;
+                polyline.pop_back();
+            }
+            a = b;
+        }
+
+        if (polyline.size() <= 1)
+        {
+            polyline = std::move(result_lines.back());
+            result_lines.pop_back();
+        }
+        else
+        {
+            ++poly_it;
+        }
+    }
+}
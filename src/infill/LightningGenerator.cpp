@@ -4,10 +4,11 @@
 #include "infill/LightningGenerator.h"
 
 #include "ExtruderTrain.h"
+#include "infill/LightningForest.h"
 #include "infill/LightningLayer.h"
-#include "infill/LightningTreeNode.h"
 #include "sliceDataStorage.h"
 #include "utils/SparsePointGridInclusive.h"
+#include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h"
 
 /* Possible future tasks/optimizations,etc.:
@@ -37,34 +38,45 @@ LightningGenerator::LightningGenerator(const SliceMeshStorage& mesh)
     prune_length = layer_thickness * std::tan(infill_extruder.settings_.get<AngleRadians>("lightning_infill_prune_angle"));
     straightening_max_distance = layer_thickness * std::tan(infill_extruder.settings_.get<AngleRadians>("lightning_infill_straightening_angle"));
 
-    generateInitialInternalOverhangs(mesh);
-    generateTrees(mesh);
+    const std::vector<Polygons> infill_outlines = generateInfillOutlines(mesh);
+    generateInitialInternalOverhangs(infill_outlines);
+    generateTrees(infill_outlines);
 }
 
-void LightningGenerator::generateInitialInternalOverhangs(const SliceMeshStorage& mesh)
+std::vector<Polygons> LightningGenerator::generateInfillOutlines(const SliceMeshStorage& mesh)
 {
-    overhang_per_layer.resize(mesh.layers.size());
     const auto infill_wall_line_count = static_cast<coord_t>(mesh.settings.get<size_t>("infill_wall_line_count"));
     const auto infill_line_width = mesh.settings.get<coord_t>("infill_line_width");
     const coord_t infill_wall_offset = -infill_wall_line_count * infill_line_width;
 
-    Polygons infill_area_above;
-    // Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = mesh.layers.size() - 1; layer_nr >= 0; layer_nr--)
-    {
-        const SliceLayer& current_layer = mesh.layers[layer_nr];
-        Polygons infill_area_here;
-        for (auto& part : current_layer.parts)
+    std::vector<Polygons> infill_outlines(mesh.layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
         {
-            infill_area_here.add(part.getOwnInfillArea().offset(infill_wall_offset));
-        }
+            for (const auto& part : mesh.layers[layer_nr].parts)
+            {
+                infill_outlines[layer_nr].add(part.getOwnInfillArea().offset(infill_wall_offset));
+            }
+        });
+    return infill_outlines;
+}
 
-        // Remove the part of the infill area that is already supported by the walls.
-        Polygons overhang = infill_area_here.offset(-wall_supporting_radius).difference(infill_area_above);
+void LightningGenerator::generateInitialInternalOverhangs(const std::vector<Polygons>& infill_outlines)
+{
+    overhang_per_layer.resize(infill_outlines.size());
 
-        overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
-    }
+    // Subtract the infill area above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
+    cura::parallel_for<size_t>(
+        0,
+        infill_outlines.size(),
+        [&](const size_t layer_nr)
+        {
+            // Remove the part of the infill area that is already supported by the walls.
+            const Polygons infill_area_above = layer_nr + 1 < infill_outlines.size() ? infill_outlines[layer_nr + 1] : Polygons();
+            overhang_per_layer[layer_nr] = infill_outlines[layer_nr].offset(-wall_supporting_radius).difference(infill_area_above);
+        });
 }
 
 const LightningLayer& LightningGenerator::getTreesForLayer(const size_t& layer_id) const
@@ -73,56 +85,52 @@ const LightningLayer& LightningGenerator::getTreesForLayer(const size_t& layer_i
     return lightning_layers[layer_id];
 }
 
-void LightningGenerator::generateTrees(const SliceMeshStorage& mesh)
+void LightningGenerator::generateTrees(const std::vector<Polygons>& infill_outlines)
 {
-    lightning_layers.resize(mesh.layers.size());
-    const auto infill_wall_line_count = static_cast<coord_t>(mesh.settings.get<size_t>("infill_wall_line_count"));
-    const auto infill_line_width = mesh.settings.get<coord_t>("infill_line_width");
-    const coord_t infill_wall_offset = -infill_wall_line_count * infill_line_width;
-
-    std::vector<Polygons> infill_outlines;
-    infill_outlines.insert(infill_outlines.end(), mesh.layers.size(), Polygons());
-
-    // For-each layer from top to bottom:
-    for (int layer_id = mesh.layers.size() - 1; layer_id >= 0; layer_id--)
+    lightning_layers.resize(infill_outlines.size());
+    if (infill_outlines.empty())
     {
-        for (const auto& part : mesh.layers[layer_id].parts)
-        {
-            infill_outlines[layer_id].add(part.getOwnInfillArea().offset(infill_wall_offset));
-        }
+        return;
     }
-
-    // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = mesh.layers.size() - 1;
-    auto outlines_locator_ptr = PolygonUtils::createLocToLineGrid(infill_outlines[top_layer_id], locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = top_layer_id; layer_id >= 0; layer_id--)
-    {
-        LightningLayer& current_lightning_layer = lightning_layers[layer_id];
-        Polygons& current_outlines = infill_outlines[layer_id];
-        const auto& outlines_locator = *outlines_locator_ptr;
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<LightningTreeNodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(overhang_per_layer[layer_id], current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
-
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
+    const size_t top_layer_id = infill_outlines.size() - 1;
+
+    size_t layer_id = infill_outlines.size(); // The layer that the trees are generated for, counting down from the top.
+    // For various operations its beneficial to quickly locate nearby features on the polygon.
+    // The locators don't depend on the trees, so the ones of the next layers are made while the trees of this layer are being generated.
+    run_multiple_producers_ordered_consumer(
+        0,
+        infill_outlines.size(),
+        [&infill_outlines, top_layer_id](const ptrdiff_t iteration)
         {
-            return;
-        }
-        const Polygons& below_outlines = infill_outlines[layer_id - 1];
-        outlines_locator_ptr = PolygonUtils::createLocToLineGrid(below_outlines, locator_cell_size);
-        const auto& below_outlines_locator = *outlines_locator_ptr;
-
-        std::vector<LightningTreeNodeSPtr>& lower_trees = lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
+            return PolygonUtils::createLocToLineGrid(infill_outlines[top_layer_id - iteration], locator_cell_size);
+        },
+        [this, &infill_outlines, top_layer_id, &layer_id](std::unique_ptr<LocToLineGrid> outlines_locator_ptr)
         {
-            tree->propagateToNextLayer(lower_trees, below_outlines, below_outlines_locator, prune_length, straightening_max_distance, locator_cell_size / 2);
-        }
-    }
+            // For-each layer from top to bottom:
+            layer_id--;
+            LightningLayer& current_lightning_layer = lightning_layers[layer_id];
+            const Polygons& current_outlines = infill_outlines[layer_id];
+            const auto& outlines_locator = *outlines_locator_ptr;
+
+            // Initialize trees for this layer from the one above.
+            if (layer_id != top_layer_id)
+            {
+                LightningLayer& upper_lightning_layer = lightning_layers[layer_id + 1];
+                current_lightning_layer.forest = upper_lightning_layer.forest.propagateToNextLayer(
+                    upper_lightning_layer.tree_roots,
+                    current_lightning_layer.tree_roots,
+                    current_outlines,
+                    outlines_locator,
+                    prune_length,
+                    straightening_max_distance,
+                    locator_cell_size / 2);
+            }
+
+            // register all trees propagated from the previous layer as to-be-reconnected
+            std::vector<size_t> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+
+            current_lightning_layer.generateNewTrees(overhang_per_layer[layer_id], current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
+
+            current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius);
+        });
 }
@@ -6,7 +6,7 @@
 #include <iterator> // advance
 
 #include "infill/LightningDistanceField.h"
-#include "infill/LightningTreeNode.h"
+#include "infill/LightningForest.h"
 #include "sliceDataStorage.h"
 #include "utils/SVG.h"
 #include "utils/SparsePointGridInclusive.h"
@@ -19,11 +19,11 @@ coord_t LightningLayer::getWeightedDistance(const Point2LL& boundary_loc, const
     return vSize(boundary_loc - unsupported_location);
 }
 
-Point2LL GroundingLocation::p() const
+Point2LL GroundingLocation::p(const LightningForest& forest) const
 {
-    if (tree_node != nullptr)
+    if (tree_node != LightningForest::no_node)
     {
-        return tree_node->getLocation();
+        return forest.getLocation(tree_node);
     }
     else
     {
@@ -34,13 +34,13 @@ Point2LL GroundingLocation::p() const
 
 void LightningLayer::fillLocator(SparseLightningTreeNodeGrid& tree_node_locator)
 {
-    std::function<void(LightningTreeNodeSPtr)> add_node_to_locator_func = [&tree_node_locator](LightningTreeNodeSPtr node)
+    const auto add_node_to_locator_func = [this, &tree_node_locator](const size_t node)
     {
-        tree_node_locator.insert(node->getLocation(), node);
+        tree_node_locator.insert(forest.getLocation(node), node);
     };
-    for (auto& tree : tree_roots)
+    for (const size_t tree : tree_roots)
     {
-        tree->visitNodes(add_node_to_locator_func);
+        forest.visitNodes(tree, add_node_to_locator_func);
     }
 }
 
@@ -64,17 +64,17 @@ void LightningLayer::generateNewTrees(
         GroundingLocation grounding_loc
             = getBestGroundingLocation(unsupported_location, current_outlines, outlines_locator, supporting_radius, wall_supporting_radius, tree_node_locator);
 
-        LightningTreeNodeSPtr new_parent;
-        LightningTreeNodeSPtr new_child;
+        size_t new_parent = LightningForest::no_node;
+        size_t new_child;
         attach(unsupported_location, grounding_loc, new_child, new_parent);
-        tree_node_locator.insert(new_child->getLocation(), new_child);
-        if (new_parent)
+        tree_node_locator.insert(forest.getLocation(new_child), new_child);
+        if (new_parent != LightningForest::no_node)
         {
-            tree_node_locator.insert(new_parent->getLocation(), new_parent);
+            tree_node_locator.insert(forest.getLocation(new_parent), new_parent);
         }
 
         // update distance field
-        distance_field.update(grounding_loc.p(), unsupported_location);
+        distance_field.update(grounding_loc.p(forest), unsupported_location);
     }
 }
 
@@ -85,7 +85,7 @@ GroundingLocation LightningLayer::getBestGroundingLocation(
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius,
     const SparseLightningTreeNodeGrid& tree_node_locator,
-    const LightningTreeNodeSPtr& exclude_tree)
+    const size_t exclude_tree)
 {
     ClosestPolygonPoint cpp = PolygonUtils::findClosest(unsupported_location, current_outlines);
     Point2LL node_location = cpp.p();
@@ -93,18 +93,17 @@ GroundingLocation LightningLayer::getBestGroundingLocation(
 
     PolygonsPointIndex dummy;
 
-    LightningTreeNodeSPtr sub_tree{ nullptr };
+    size_t sub_tree = LightningForest::no_node;
     coord_t current_dist = getWeightedDistance(node_location, unsupported_location);
     if (current_dist >= wall_supporting_radius) // Only reconnect tree roots to other trees if they are not already close to the outlines.
     {
         auto candidate_trees = tree_node_locator.getNearbyVals(unsupported_location, std::min(current_dist, within_dist));
-        for (auto& candidate_wptr : candidate_trees)
+        for (const size_t candidate_sub_tree : candidate_trees)
         {
-            auto candidate_sub_tree = candidate_wptr.lock();
-            if ((candidate_sub_tree && candidate_sub_tree != exclude_tree) && ! (exclude_tree && exclude_tree->hasOffspring(candidate_sub_tree))
-                && ! PolygonUtils::polygonCollidesWithLineSegment(unsupported_location, candidate_sub_tree->getLocation(), outline_locator, &dummy))
+            if (candidate_sub_tree != exclude_tree && ! (exclude_tree != LightningForest::no_node && forest.hasOffspring(exclude_tree, candidate_sub_tree))
+                && ! PolygonUtils::polygonCollidesWithLineSegment(unsupported_location, forest.getLocation(candidate_sub_tree), outline_locator, &dummy))
             {
-                const coord_t candidate_dist = candidate_sub_tree->getWeightedDistance(unsupported_location, supporting_radius);
+                const coord_t candidate_dist = forest.getWeightedDistance(candidate_sub_tree, unsupported_location, supporting_radius);
                 if (candidate_dist < current_dist)
                 {
                     current_dist = candidate_dist;
@@ -114,9 +113,9 @@ GroundingLocation LightningLayer::getBestGroundingLocation(
         }
     }
 
-    if (! sub_tree)
+    if (sub_tree == LightningForest::no_node)
     {
-        return GroundingLocation{ nullptr, cpp };
+        return GroundingLocation{ LightningForest::no_node, cpp };
     }
     else
     {
@@ -124,25 +123,25 @@ GroundingLocation LightningLayer::getBestGroundingLocation(
     }
 }
 
-bool LightningLayer::attach(const Point2LL& unsupported_location, const GroundingLocation& grounding_loc, LightningTreeNodeSPtr& new_child, LightningTreeNodeSPtr& new_root)
+bool LightningLayer::attach(const Point2LL& unsupported_location, const GroundingLocation& grounding_loc, size_t& new_child, size_t& new_root)
 {
     // Update trees & distance fields.
     if (grounding_loc.boundary_location)
     {
-        new_root = LightningTreeNode::create(grounding_loc.p(), std::make_optional(grounding_loc.p()));
-        new_child = new_root->addChild(unsupported_location);
+        new_root = forest.createRoot(grounding_loc.p(forest), std::make_optional(grounding_loc.p(forest)));
+        new_child = forest.addChild(new_root, unsupported_location);
         tree_roots.push_back(new_root);
         return true;
     }
     else
     {
-        new_child = grounding_loc.tree_node->addChild(unsupported_location);
+        new_child = forest.addChild(grounding_loc.tree_node, unsupported_location);
         return false;
     }
 }
 
 void LightningLayer::reconnectRoots(
-    std::vector<LightningTreeNodeSPtr>& to_be_reconnected_tree_roots,
+    const std::vector<size_t>& to_be_reconnected_tree_roots,
     const Polygons& current_outlines,
     const LocToLineGrid& outline_locator,
     const coord_t supporting_radius,
@@ -154,24 +153,24 @@ void LightningLayer::reconnectRoots(
     fillLocator(tree_node_locator);
 
     const coord_t within_max_dist = outline_locator.getCellSize() * 2;
-    for (auto root_ptr : to_be_reconnected_tree_roots)
+    for (const size_t root_ptr : to_be_reconnected_tree_roots)
     {
         auto old_root_it = std::find(tree_roots.begin(), tree_roots.end(), root_ptr);
 
-        if (root_ptr->getLastGroundingLocation())
+        if (forest.getLastGroundingLocation(root_ptr))
         {
-            const Point2LL& ground_loc = root_ptr->getLastGroundingLocation().value();
-            if (ground_loc != root_ptr->getLocation())
+            const Point2LL ground_loc = forest.getLastGroundingLocation(root_ptr).value();
+            if (ground_loc != forest.getLocation(root_ptr))
             {
                 Point2LL new_root_pt;
-                if (PolygonUtils::lineSegmentPolygonsIntersection(root_ptr->getLocation(), ground_loc, current_outlines, outline_locator, new_root_pt, within_max_dist))
+                if (PolygonUtils::lineSegmentPolygonsIntersection(forest.getLocation(root_ptr), ground_loc, current_outlines, outline_locator, new_root_pt, within_max_dist))
                 {
-                    auto new_root = LightningTreeNode::create(new_root_pt, new_root_pt);
-                    root_ptr->addChild(new_root);
-                    new_root->reroot();
+                    const size_t new_root = forest.createRoot(new_root_pt, new_root_pt);
+                    forest.addChild(root_ptr, new_root);
+                    forest.reroot(new_root);
 
-                    tree_node_locator.insert(new_root->getLocation(), new_root);
-                    *old_root_it = std::move(new_root); // replace old root with new root
+                    tree_node_locator.insert(forest.getLocation(new_root), new_root);
+                    *old_root_it = new_root; // replace old root with new root
                     continue;
                 }
             }
@@ -180,37 +179,37 @@ void LightningLayer::reconnectRoots(
         const coord_t tree_connecting_ignore_width
             = wall_supporting_radius - tree_connecting_ignore_offset; // Ideally, the boundary size in which the valence rule is ignored would be configurable.
         GroundingLocation ground
-            = getBestGroundingLocation(root_ptr->getLocation(), current_outlines, outline_locator, supporting_radius, tree_connecting_ignore_width, tree_node_locator, root_ptr);
+            = getBestGroundingLocation(forest.getLocation(root_ptr), current_outlines, outline_locator, supporting_radius, tree_connecting_ignore_width, tree_node_locator, root_ptr);
         if (ground.boundary_location)
         {
-            if (ground.boundary_location.value().p() == root_ptr->getLocation())
+            if (ground.boundary_location.value().p() == forest.getLocation(root_ptr))
             {
                 continue; // Already on the boundary.
             }
 
-            auto new_root = LightningTreeNode::create(ground.p(), ground.p());
-            auto attach_ptr = root_ptr->closestNode(new_root->getLocation());
-            attach_ptr->reroot();
+            const size_t new_root = forest.createRoot(ground.p(forest), ground.p(forest));
+            const size_t attach_ptr = forest.closestNode(root_ptr, forest.getLocation(new_root));
+            forest.reroot(attach_ptr);
 
-            new_root->addChild(attach_ptr);
-            tree_node_locator.insert(new_root->getLocation(), new_root);
+            forest.addChild(new_root, attach_ptr);
+            tree_node_locator.insert(forest.getLocation(new_root), new_root);
 
-            *old_root_it = std::move(new_root); // replace old root with new root
+            *old_root_it = new_root; // replace old root with new root
         }
         else
         {
-            assert(ground.tree_node);
+            assert(ground.tree_node != LightningForest::no_node);
             assert(ground.tree_node != root_ptr);
-            assert(! root_ptr->hasOffspring(ground.tree_node));
-            assert(! ground.tree_node->hasOffspring(root_ptr));
+            assert(! forest.hasOffspring(root_ptr, ground.tree_node));
+            assert(! forest.hasOffspring(ground.tree_node, root_ptr));
 
-            auto attach_ptr = root_ptr->closestNode(ground.tree_node->getLocation());
-            attach_ptr->reroot();
+            const size_t attach_ptr = forest.closestNode(root_ptr, forest.getLocation(ground.tree_node));
+            forest.reroot(attach_ptr);
 
-            ground.tree_node->addChild(attach_ptr);
+            forest.addChild(ground.tree_node, attach_ptr);
 
             // remove old root
-            *old_root_it = std::move(tree_roots.back());
+            *old_root_it = tree_roots.back();
             tree_roots.pop_back();
         }
     }
@@ -225,9 +224,9 @@ Polygons LightningLayer::convertToLines(const Polygons& limit_to_outline, const
         return result_lines;
     }
 
-    for (const auto& tree : tree_roots)
+    for (const size_t tree : tree_roots)
     {
-        tree->convertToPolylines(result_lines, line_width);
+        forest.convertToPolylines(tree, result_lines, line_width);
     }
     result_lines = limit_to_outline.intersectionPolyLines(result_lines);
 
@@ -6,7 +6,6 @@
 #include <algorithm> // swap
 #include <assert.h>
 #include <functional> // function
-#include <iterator> // next, prev
 
 #include <spdlog/spdlog.h>
 
@@ -14,6 +13,7 @@
 #include "infill/UniformDensityProvider.h"
 #include "utils/AABB3D.h"
 #include "utils/SVG.h"
+#include "utils/ThreadPool.h"
 #include "utils/polygon.h"
 
 namespace cura
@@ -26,6 +26,8 @@ static constexpr double allowed_length_error = 0.01;
 
 static constexpr bool deep_debug_checking = false;
 
+static constexpr int parallel_subtree_depth = 6; // The depth of the subtrees of which the statistics are calculated in parallel, giving up to 64 of them.
+
 SierpinskiFill::SierpinskiFill(const DensityProvider& density_provider, const AABB aabb, int max_depth, const coord_t line_width, bool dithering)
     : dithering_(dithering)
     , constraint_error_diffusion_(dithering)
@@ -38,8 +40,9 @@ SierpinskiFill::SierpinskiFill(const DensityProvider& density_provider, const AA
 
     createLowerBoundSequence();
 
-    for (SierpinskiTriangle* node : sequence_)
+    for (const SequenceNode& sequence_node : sequence_)
     {
+        SierpinskiTriangle* node = sequence_node.triangle_;
         if (node->getValueError() < -allowed_length_error)
         {
             spdlog::error(
@@ -79,9 +82,40 @@ void SierpinskiFill::createTree()
     }
 
     // calculate node statistics
-    createTreeStatistics(root_);
+    // The subtrees below the top levels are independent of each other, so they are processed in parallel.
+    std::vector<SierpinskiTriangle*> top_nodes{ &root_ }; // Parents before their children.
+    std::vector<SierpinskiTriangle*> subtree_roots;
+    for (size_t node_idx = 0; node_idx < top_nodes.size(); node_idx++)
+    {
+        for (SierpinskiTriangle& child : top_nodes[node_idx]->children)
+        {
+            if (child.depth_ < parallel_subtree_depth && ! child.children.empty())
+            {
+                top_nodes.emplace_back(&child);
+            }
+            else
+            {
+                subtree_roots.emplace_back(&child);
+            }
+        }
+    }
 
-    createTreeRequestedLengths(root_);
+    for (SierpinskiTriangle* node : top_nodes)
+    {
+        createNodeStatistics(*node);
+    }
+    cura::parallel_for<size_t>(
+        0,
+        subtree_roots.size(),
+        [this, &subtree_roots](const size_t subtree_idx)
+        {
+            createTreeStatistics(*subtree_roots[subtree_idx]);
+            createTreeRequestedLengths(*subtree_roots[subtree_idx]);
+        });
+    for (auto node_it = top_nodes.rbegin(); node_it != top_nodes.rend(); ++node_it)
+    {
+        createNodeRequestedLength(**node_it);
+    }
 }
 
 void SierpinskiFill::createTree(SierpinskiTriangle& sub_root)
@@ -118,6 +152,15 @@ void SierpinskiFill::createTree(SierpinskiTriangle& sub_root)
     }
 }
 void SierpinskiFill::createTreeStatistics(SierpinskiTriangle& triangle)
+{
+    createNodeStatistics(triangle);
+    for (SierpinskiTriangle& child : triangle.children)
+    {
+        createTreeStatistics(child);
+    }
+}
+
+void SierpinskiFill::createNodeStatistics(SierpinskiTriangle& triangle)
 {
     Point2LL ac = triangle.straight_corner_ - triangle.a_;
     double area = 0.5 * INT2MM2(vSize2(ac));
@@ -125,14 +168,19 @@ void SierpinskiFill::createTreeStatistics(SierpinskiTriangle& triangle)
     double long_length = .5 * vSizeMM(triangle.b_ - triangle.a_);
     triangle.area_ = area;
     triangle.realized_length_ = (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_BC) ? long_length : short_length;
+}
+
+
+void SierpinskiFill::createTreeRequestedLengths(SierpinskiTriangle& triangle)
+{
     for (SierpinskiTriangle& child : triangle.children)
     {
-        createTreeStatistics(child);
+        createTreeRequestedLengths(child);
     }
+    createNodeRequestedLength(triangle);
 }
 
-
-void SierpinskiFill::createTreeRequestedLengths(SierpinskiTriangle& triangle)
+void SierpinskiFill::createNodeRequestedLength(SierpinskiTriangle& triangle)
 {
     if (triangle.children.empty())
     { // set requested_length of leaves
@@ -146,10 +194,8 @@ void SierpinskiFill::createTreeRequestedLengths(SierpinskiTriangle& triangle)
     }
     else
     { // bubble total up requested_length and total_child_realized_length
-        for (SierpinskiTriangle& child : triangle.children)
+        for (const SierpinskiTriangle& child : triangle.children)
         {
-            createTreeRequestedLengths(child);
-
             triangle.requested_length_ += child.requested_length_;
             triangle.total_child_realized_length_ += child.realized_length_;
         }
@@ -158,7 +204,8 @@ void SierpinskiFill::createTreeRequestedLengths(SierpinskiTriangle& triangle)
 
 void SierpinskiFill::createLowerBoundSequence()
 {
-    sequence_.emplace_front(&root_);
+    sequence_.emplace_back(SequenceNode{ &root_, no_sequence_idx, no_sequence_idx });
+    sequence_first_ = 0;
 
     if (deep_debug_checking)
         debugCheck();
@@ -184,58 +231,51 @@ void SierpinskiFill::createLowerBoundSequence()
     }
 }
 
-std::vector<std::vector<std::list<SierpinskiFill::SierpinskiTriangle*>::iterator>> SierpinskiFill::getDepthOrdered()
+std::vector<std::vector<size_t>> SierpinskiFill::getDepthOrdered()
 {
-    std::vector<std::vector<std::list<SierpinskiTriangle*>::iterator>> depth_ordered(max_depth_ + 1);
-    depth_ordered.resize(max_depth_);
-    for (std::list<SierpinskiTriangle*>::iterator it = sequence_.begin(); it != sequence_.end(); ++it)
+    std::vector<std::vector<size_t>> depth_ordered(max_depth_ + 1);
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle* node = *it;
-        depth_ordered[node->depth_].emplace_back(it);
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
+        depth_ordered[node->depth_].emplace_back(idx);
     }
     return depth_ordered;
 }
 
 bool SierpinskiFill::subdivideAll()
 {
-    std::vector<std::vector<std::list<SierpinskiTriangle*>::iterator>> depth_ordered = getDepthOrdered();
+    std::vector<std::vector<size_t>> depth_ordered = getDepthOrdered();
 
     bool change = false;
-    for (std::vector<std::list<SierpinskiTriangle*>::iterator>& depth_nodes : depth_ordered)
-        for (std::list<SierpinskiTriangle*>::iterator it : depth_nodes)
+    for (int depth = 0; depth < max_depth_; depth++) // Never subdivide beyond maximum depth.
+        for (size_t idx : depth_ordered[depth])
         {
-            SierpinskiTriangle* node = *it;
+            SierpinskiTriangle* node = sequence_[idx].triangle_;
             SierpinskiTriangle& triangle = *node;
 
             // The range of consecutive triangles to consider for subdivision simultaneously.
             // Two triangles connected to each other via the long edge must be subdivided simultaneously,
             // so then the range will be two long rather than one.
-            std::list<SierpinskiTriangle*>::iterator begin = it;
-            std::list<SierpinskiTriangle*>::iterator end = std::next(it);
-            if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && end != sequence_.end())
+            size_t first_idx = idx;
+            const size_t last_idx = idx;
+            if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && sequence_[idx].next_ != no_sequence_idx)
             {
                 continue; // don't subdivide these two triangles just yet, wait till next iteration
             }
-            if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && begin != sequence_.begin())
-            {
-                begin = std::prev(it);
-                assert((*begin)->depth_ == triangle.depth_ || isConstrainedBackward(it));
-            }
-            else
+            if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && sequence_[idx].prev_ != no_sequence_idx)
             {
-                assert(begin == std::prev(end));
+                first_idx = sequence_[idx].prev_;
+                assert(sequence_[first_idx].triangle_->depth_ == triangle.depth_ || isConstrainedBackward(idx));
             }
-            bool is_constrained = isConstrainedBackward(begin) || isConstrainedForward(std::prev(end));
+            bool is_constrained = isConstrainedBackward(first_idx) || isConstrainedForward(last_idx);
             // Don't check for constraining in between the cells in the range;
             // the range is defined as the range of triangles which are constraining each other simultaneously.
 
-            if (node->depth_ == max_depth_) // Never subdivide beyond maximum depth.
-                continue;
-            double total_subdiv_error = getSubdivisionError(begin, end);
+            double total_subdiv_error = getSubdivisionError(first_idx, last_idx);
             if (! node->children.empty() && total_subdiv_error >= 0 && ! is_constrained)
             {
                 bool redistribute_errors = true;
-                subdivide(begin, end, redistribute_errors);
+                subdivide(first_idx, last_idx, redistribute_errors);
                 change = true;
             }
         }
@@ -244,24 +284,24 @@ bool SierpinskiFill::subdivideAll()
 
 bool SierpinskiFill::bubbleUpConstraintErrors()
 {
-    std::vector<std::vector<std::list<SierpinskiTriangle*>::iterator>> depth_ordered = getDepthOrdered();
+    std::vector<std::vector<size_t>> depth_ordered = getDepthOrdered();
 
     bool redistributed_anything = false;
 
     for (int depth = max_depth_; depth >= 0; depth--)
     {
-        std::vector<std::list<SierpinskiTriangle*>::iterator>& depth_nodes = depth_ordered[depth];
-        for (std::list<SierpinskiTriangle*>::iterator it : depth_nodes)
+        std::vector<size_t>& depth_nodes = depth_ordered[depth];
+        for (size_t idx : depth_nodes)
         {
-            SierpinskiTriangle* node = *it;
+            SierpinskiTriangle* node = sequence_[idx].triangle_;
             SierpinskiTriangle& triangle = *node;
 
             double unresolvable_error = triangle.getValueError();
 
             // If constrained in one direction, resolve the error in the other direction only.
             // If constrained in both directions, divide the error equally over both directions.
-            bool is_constrained_forward = isConstrainedForward(it);
-            bool is_constrained_backward = isConstrainedBackward(it);
+            bool is_constrained_forward = isConstrainedForward(idx);
+            bool is_constrained_backward = isConstrainedBackward(idx);
             if (unresolvable_error > allowed_length_error && (is_constrained_forward || is_constrained_backward))
             {
                 if (is_constrained_forward && is_constrained_backward)
@@ -274,13 +314,13 @@ bool SierpinskiFill::bubbleUpConstraintErrors()
                     debugCheck();
                 if (is_constrained_forward)
                 {
-                    SierpinskiTriangle* next = *std::next(it);
+                    SierpinskiTriangle* next = sequence_[sequence_[idx].next_].triangle_;
                     node->error_right_ -= unresolvable_error;
                     next->error_left_ += unresolvable_error;
                 }
                 if (is_constrained_backward)
                 {
-                    SierpinskiTriangle* prev = *std::prev(it);
+                    SierpinskiTriangle* prev = sequence_[sequence_[idx].prev_].triangle_;
                     node->error_left_ -= unresolvable_error;
                     prev->error_right_ += unresolvable_error;
                 }
@@ -297,39 +337,38 @@ bool SierpinskiFill::bubbleUpConstraintErrors()
 }
 
 
-std::list<SierpinskiFill::SierpinskiTriangle*>::iterator
-    SierpinskiFill::subdivide(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end, bool redistribute_errors)
+size_t SierpinskiFill::subdivide(const size_t first_idx, const size_t last_idx, bool redistribute_errors)
 {
     if (redistribute_errors && deep_debug_checking)
         debugCheck();
     if (redistribute_errors)
     { // move left-over errors
         bool distribute_subdivision_errors = true;
-        redistributeLeftoverErrors(begin, end, distribute_subdivision_errors);
+        redistributeLeftoverErrors(first_idx, last_idx, distribute_subdivision_errors);
 
-        SierpinskiTriangle* first = *begin;
-        SierpinskiTriangle* last = *std::prev(end);
-        (*begin)->children.front().error_left_ += first->error_left_;
-        (*std::prev(end))->children.back().error_right_ += last->error_right_;
+        SierpinskiTriangle* first = sequence_[first_idx].triangle_;
+        SierpinskiTriangle* last = sequence_[last_idx].triangle_;
+        first->children.front().error_left_ += first->error_left_;
+        last->children.back().error_right_ += last->error_right_;
     }
     if (redistribute_errors && deep_debug_checking)
         debugCheck(false);
 
-    std::list<SierpinskiFill::SierpinskiTriangle*>::iterator first_child_it = std::prev(begin);
     // the actual subdivision
-    for (std::list<SierpinskiTriangle*>::iterator it = begin; it != end; ++it)
+    // Each parent is replaced by its first child, after which the other children are inserted.
+    const size_t end_idx = sequence_[last_idx].next_;
+    size_t last_child_idx = first_idx;
+    for (size_t idx = first_idx; idx != end_idx; idx = sequence_[last_child_idx].next_)
     {
-        SierpinskiTriangle* node = *it;
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
         assert(! node->children.empty() && "cannot subdivide node with no children!");
-        for (SierpinskiTriangle& child : node->children)
+        sequence_[idx].triangle_ = &node->children.front();
+        last_child_idx = idx;
+        for (size_t child_idx = 1; child_idx < node->children.size(); child_idx++)
         {
-            sequence_.insert(begin, &child);
+            last_child_idx = insertAfter(last_child_idx, &node->children[child_idx]);
         }
     }
-    first_child_it++;
-    // removal of parents
-    std::list<SierpinskiTriangle*>::iterator last_child_it = std::prev(begin);
-    sequence_.erase(begin, end);
 
     if (redistribute_errors && deep_debug_checking)
         debugCheck(false);
@@ -337,27 +376,42 @@ std::list<SierpinskiFill::SierpinskiTriangle*>::iterator
     if (redistribute_errors)
     { // make positive errors in children well balanced
         // Pass along error from parent
-        balanceErrors(first_child_it, std::next(last_child_it));
+        balanceErrors(first_idx, last_child_idx);
     }
 
     if (redistribute_errors && deep_debug_checking)
         debugCheck();
 
-    return last_child_it;
+    return last_child_idx;
+}
+
+size_t SierpinskiFill::insertAfter(const size_t idx, SierpinskiTriangle* triangle)
+{
+    const size_t new_idx = sequence_.size();
+    const size_t next_idx = sequence_[idx].next_;
+    sequence_.emplace_back(SequenceNode{ triangle, idx, next_idx });
+    sequence_[idx].next_ = new_idx;
+    if (next_idx != no_sequence_idx)
+    {
+        sequence_[next_idx].prev_ = new_idx;
+    }
+    return new_idx;
 }
 
-void SierpinskiFill::redistributeLeftoverErrors(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end, bool distribute_subdivision_errors)
+void SierpinskiFill::redistributeLeftoverErrors(const size_t first_idx, const size_t last_idx, bool distribute_subdivision_errors)
 {
-    SierpinskiTriangle* prev = *std::prev(begin);
-    SierpinskiTriangle* next = *end;
-    SierpinskiTriangle* first = *begin;
-    SierpinskiTriangle* last = *std::prev(end);
+    const size_t prev_idx = sequence_[first_idx].prev_;
+    const size_t next_idx = sequence_[last_idx].next_;
+    SierpinskiTriangle* prev = (prev_idx == no_sequence_idx) ? nullptr : sequence_[prev_idx].triangle_;
+    SierpinskiTriangle* next = (next_idx == no_sequence_idx) ? nullptr : sequence_[next_idx].triangle_;
+    SierpinskiTriangle* first = sequence_[first_idx].triangle_;
+    SierpinskiTriangle* last = sequence_[last_idx].triangle_;
 
     // exchange intermediate errors
-    for (auto it = begin; it != end && std::next(it) != end; ++it)
+    for (size_t idx = first_idx; idx != last_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle* node = *it;
-        SierpinskiTriangle* other = *std::next(it);
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
+        SierpinskiTriangle* other = sequence_[sequence_[idx].next_].triangle_;
         if (std::abs(node->error_right_ + other->error_left_) > allowed_length_error)
         {
             spdlog::warn("Nodes aren't balanced! er: {} other el: {}", node->error_right_, other->error_left_);
@@ -373,9 +427,9 @@ void SierpinskiFill::redistributeLeftoverErrors(std::list<SierpinskiTriangle*>::
     }
 
     double total_superfluous_error = 0;
-    for (auto it = begin; it != end; ++it)
+    for (size_t idx = first_idx; idx != next_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle* node = *it;
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
         total_superfluous_error += (distribute_subdivision_errors) ? node->getSubdivisionError() : node->getValueError();
     }
     if (total_superfluous_error < allowed_length_error)
@@ -387,25 +441,25 @@ void SierpinskiFill::redistributeLeftoverErrors(std::list<SierpinskiTriangle*>::
         }
         return;
     }
-    if (begin != sequence_.begin() && end != sequence_.end() && first->error_left_ > allowed_length_error && last->error_right_ > allowed_length_error)
+    if (prev && next && first->error_left_ > allowed_length_error && last->error_right_ > allowed_length_error)
     {
         double total_error_input = first->error_left_ + last->error_right_;
         total_superfluous_error = std::min(total_superfluous_error, total_error_input); // total superfluous error cannot be more than the influx of error
         double left_spillover = total_superfluous_error * first->error_left_ / total_error_input;
         double right_spillover = total_superfluous_error * last->error_right_ / total_error_input;
-        (*begin)->error_left_ -= left_spillover;
+        first->error_left_ -= left_spillover;
         prev->error_right_ += left_spillover;
-        (*std::prev(end))->error_right_ -= right_spillover;
+        last->error_right_ -= right_spillover;
         next->error_left_ += right_spillover;
     }
-    else if (begin != sequence_.begin() && first->error_left_ > allowed_length_error)
+    else if (prev && first->error_left_ > allowed_length_error)
     {
         total_superfluous_error = std::min(total_superfluous_error, first->error_left_); // total superfluous error cannot be more than the influx of error
-        (*begin)->error_left_ -= total_superfluous_error;
+        first->error_left_ -= total_superfluous_error;
         prev->error_right_ += total_superfluous_error;
         assert(first->error_left_ > -allowed_length_error);
     }
-    else if (end != sequence_.end() && last->error_right_ > allowed_length_error)
+    else if (next && last->error_right_ > allowed_length_error)
     {
         total_superfluous_error = std::min(total_superfluous_error, last->error_right_); // total superfluous error cannot be more than the influx of error
         last->error_right_ -= total_superfluous_error;
@@ -414,13 +468,13 @@ void SierpinskiFill::redistributeLeftoverErrors(std::list<SierpinskiTriangle*>::
     }
 }
 
-void SierpinskiFill::balanceErrors(std::list<SierpinskiFill::SierpinskiTriangle*>::iterator begin, std::list<SierpinskiFill::SierpinskiTriangle*>::iterator end)
+void SierpinskiFill::balanceErrors(const size_t first_idx, const size_t last_idx)
 {
-    // copy sublist to array
+    // copy subsequence to array
     std::vector<SierpinskiFill::SierpinskiTriangle*> nodes;
-    for (std::list<SierpinskiFill::SierpinskiTriangle*>::iterator it = begin; it != end; ++it)
+    for (size_t idx = first_idx; idx != sequence_[last_idx].next_; idx = sequence_[idx].next_)
     {
-        nodes.emplace_back(*it);
+        nodes.emplace_back(sequence_[idx].triangle_);
     }
 
     std::vector<double> node_error_compensation(nodes.size());
@@ -514,13 +568,13 @@ void SierpinskiFill::balanceErrors(std::list<SierpinskiFill::SierpinskiTriangle*
 
 void SierpinskiFill::settleErrors()
 {
-    std::vector<std::vector<std::list<SierpinskiTriangle*>::iterator>> depth_ordered = getDepthOrdered();
+    std::vector<std::vector<size_t>> depth_ordered = getDepthOrdered();
 
-    for (std::vector<std::list<SierpinskiTriangle*>::iterator>& depth_nodes : depth_ordered)
+    for (int depth = 0; depth < max_depth_; depth++)
     {
-        for (std::list<SierpinskiTriangle*>::iterator it : depth_nodes)
+        for (size_t idx : depth_ordered[depth])
         {
-            redistributeLeftoverErrors(it, std::next(it), false);
+            redistributeLeftoverErrors(idx, idx, false);
         }
     }
 }
@@ -532,9 +586,9 @@ void SierpinskiFill::diffuseError()
     int unconstrained_nodes = 0;
     int subdivided_nodes = 0;
     double error = 0;
-    for (std::list<SierpinskiTriangle*>::iterator it = sequence_.begin(); it != sequence_.end(); ++it)
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle& triangle = *(*it);
+        SierpinskiTriangle& triangle = *sequence_[idx].triangle_;
 
         double boundary = (triangle.realized_length_ + triangle.total_child_realized_length_) * 0.5;
 
@@ -542,24 +596,24 @@ void SierpinskiFill::diffuseError()
 
         double boundary_error = nodal_value - boundary + error;
 
-        std::list<SierpinskiTriangle*>::iterator begin = it;
-        std::list<SierpinskiTriangle*>::iterator end = std::next(it);
-        if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && end != sequence_.end())
+        size_t first_idx = idx;
+        const size_t end_idx = sequence_[idx].next_;
+        if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && end_idx != no_sequence_idx)
         {
             pair_constrained_nodes++;
             continue; // don't subdivide these two triangles just yet, wait till next iteration
         }
-        if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && begin != sequence_.begin())
+        if (triangle.dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && sequence_[idx].prev_ != no_sequence_idx)
         {
-            begin = std::prev(it);
-            assert((*begin)->depth_ == triangle.depth_ || isConstrainedBackward(it));
+            first_idx = sequence_[idx].prev_;
+            assert(sequence_[first_idx].triangle_->depth_ == triangle.depth_ || isConstrainedBackward(idx));
         }
 
 
         bool is_constrained = false;
-        for (auto nested_it = begin; nested_it != end; ++nested_it)
+        for (size_t nested_idx = first_idx; nested_idx != end_idx; nested_idx = sequence_[nested_idx].next_)
         {
-            if (isConstrainedBackward(nested_it) || isConstrainedForward(nested_it))
+            if (isConstrainedBackward(nested_idx) || isConstrainedForward(nested_idx))
             {
                 is_constrained = true;
                 constrained_nodes++;
@@ -571,7 +625,7 @@ void SierpinskiFill::diffuseError()
         if (! is_constrained && boundary_error >= 0 && ! triangle.children.empty())
         {
             subdivided_nodes++;
-            it = subdivide(begin, end, false);
+            idx = subdivide(first_idx, idx, false);
             if (dithering_)
                 error += nodal_value - triangle.total_child_realized_length_;
         }
@@ -589,29 +643,29 @@ void SierpinskiFill::diffuseError()
         subdivided_nodes);
 }
 
-bool SierpinskiFill::isConstrainedBackward(std::list<SierpinskiTriangle*>::iterator it)
+bool SierpinskiFill::isConstrainedBackward(const size_t idx) const
 {
-    SierpinskiTriangle* node = *it;
-    SierpinskiTriangle* prev = *std::prev(it);
-    if (it != sequence_.begin() && node->dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && prev->depth_ < node->depth_)
+    SierpinskiTriangle* node = sequence_[idx].triangle_;
+    const size_t prev_idx = sequence_[idx].prev_;
+    if (prev_idx != no_sequence_idx && node->dir_ == SierpinskiTriangle::SierpinskiDirection::AB_TO_BC && sequence_[prev_idx].triangle_->depth_ < node->depth_)
         return true;
     return false;
 }
-bool SierpinskiFill::isConstrainedForward(std::list<SierpinskiTriangle*>::iterator it)
+bool SierpinskiFill::isConstrainedForward(const size_t idx) const
 {
-    SierpinskiTriangle* node = *it;
-    SierpinskiTriangle* next = *std::next(it);
-    if (std::next(it) != sequence_.end() && node->dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && next->depth_ < node->depth_)
+    SierpinskiTriangle* node = sequence_[idx].triangle_;
+    const size_t next_idx = sequence_[idx].next_;
+    if (next_idx != no_sequence_idx && node->dir_ == SierpinskiTriangle::SierpinskiDirection::AC_TO_AB && sequence_[next_idx].triangle_->depth_ < node->depth_)
         return true;
     return false;
 }
 
-double SierpinskiFill::getSubdivisionError(std::list<SierpinskiTriangle*>::iterator begin, std::list<SierpinskiTriangle*>::iterator end)
+double SierpinskiFill::getSubdivisionError(const size_t first_idx, const size_t last_idx) const
 {
     double ret = 0;
-    for (auto it = begin; it != end; ++it)
+    for (size_t idx = first_idx; idx != sequence_[last_idx].next_; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle* node = *it;
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
         ret += node->getSubdivisionError();
     }
     return ret;
@@ -623,9 +677,9 @@ void SierpinskiFill::debugOutput(SVG& svg)
     svg.writePolygon(aabb_.toPolygon(), SVG::Color::RED);
 
     // draw triangles
-    for (SierpinskiTriangle* node : sequence_)
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle& triangle = *node;
+        SierpinskiTriangle& triangle = *sequence_[idx].triangle_;
         svg.writeLine(triangle.a_, triangle.b_, SVG::Color::GRAY);
         svg.writeLine(triangle.a_, triangle.straight_corner_, SVG::Color::GRAY);
         svg.writeLine(triangle.b_, triangle.straight_corner_, SVG::Color::GRAY);
@@ -702,9 +756,9 @@ Polygon SierpinskiFill::generateCross() const
 {
     Polygon ret;
 
-    for (SierpinskiTriangle* max_level_it : sequence_)
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle& triangle = *max_level_it;
+        SierpinskiTriangle& triangle = *sequence_[idx].triangle_;
         Point2LL edge_middle = triangle.a_ + triangle.b_ + triangle.straight_corner_;
         switch (triangle.dir_)
         {
@@ -746,9 +800,9 @@ Polygon SierpinskiFill::generateCross(coord_t z, coord_t min_dist_to_side, coord
     };
 
     SierpinskiTriangle* last_triangle = nullptr;
-    for (SierpinskiTriangle* node : sequence_)
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        SierpinskiTriangle& triangle = *node;
+        SierpinskiTriangle& triangle = *sequence_[idx].triangle_;
 
         /* The length of a side of the triangle is used as the period of
         repetition. That way the edges overhang by not more than 45 degrees.
@@ -813,25 +867,25 @@ Polygon SierpinskiFill::generateCross(coord_t z, coord_t min_dist_to_side, coord
 
 void SierpinskiFill::debugCheck(bool check_subdivision)
 {
-    if (std::abs(sequence_.front()->error_left_) > allowed_length_error)
+    if (std::abs(sequence_[sequence_first_].triangle_->error_left_) > allowed_length_error)
     {
         spdlog::warn("First node has error left!");
         assert(false);
     }
-    if (std::abs(sequence_.back()->error_right_) > allowed_length_error)
-    {
-        spdlog::warn("Last node has error right!");
-        assert(false);
-    }
 
-    for (auto it = sequence_.begin(); it != sequence_.end(); ++it)
+    for (size_t idx = sequence_first_; idx != no_sequence_idx; idx = sequence_[idx].next_)
     {
-        if (std::next(it) == sequence_.end())
+        if (sequence_[idx].next_ == no_sequence_idx)
         {
+            if (std::abs(sequence_[idx].triangle_->error_right_) > allowed_length_error)
+            {
+                spdlog::warn("Last node has error right!");
+                assert(false);
+            }
             break;
         }
-        SierpinskiTriangle* node = *it;
-        SierpinskiTriangle* next = *std::next(it);
+        SierpinskiTriangle* node = sequence_[idx].triangle_;
+        SierpinskiTriangle* next = sequence_[sequence_[idx].next_].triangle_;
 
         if (std::abs(node->error_right_ + next->error_left_) > allowed_length_error)
         {
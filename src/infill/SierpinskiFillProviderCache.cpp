@@ -0,0 +1,130 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "infill/SierpinskiFillProviderCache.h"
+
+#include <filesystem>
+#include <system_error>
+
+#include <spdlog/spdlog.h>
+
+#include "Application.h"
+#include "communication/Communication.h"
+#include "infill/SierpinskiFillProvider.h"
+#include "utils/AABB3D.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * Whether the current communication channel may ask for another slice in this process, i.e. whether it is worth keeping
+ * entries after a slice.
+ */
+bool isPersistent()
+{
+    const Communication* communication = Application::getInstance().communication_;
+    return communication != nullptr && communication->isPersistent();
+}
+
+} // namespace
+
+SierpinskiFillProviderCache& SierpinskiFillProviderCache::getInstance()
+{
+    static SierpinskiFillProviderCache instance;
+    return instance;
+}
+
+std::shared_ptr<SierpinskiFillProvider>
+    SierpinskiFillProviderCache::get(const AABB3D& aabb_3d, const coord_t min_line_distance, const coord_t line_width, const std::string& density_image_file)
+{
+    const uint64_t key = hashInput(aabb_3d, min_line_distance, line_width, density_image_file);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = entries_.find(key);
+        if (entry == entries_.end())
+        {
+            const auto previous_entry = previous_entries_.find(key);
+            if (previous_entry != previous_entries_.end())
+            { // Reused in this slice, so keep it for the next one.
+                spdlog::info("Reusing the cross infill fractal from an earlier slice.");
+                entry = entries_.emplace(key, std::move(previous_entry->second)).first;
+                previous_entries_.erase(previous_entry);
+            }
+        }
+        if (entry != entries_.end())
+        {
+            return entry->second;
+        }
+    }
+
+    // Create the fractal outside of the lock, since it takes a while. If another thread created the same one meanwhile, use theirs.
+    std::shared_ptr<SierpinskiFillProvider> provider = density_image_file.empty()
+                                                         ? std::make_shared<SierpinskiFillProvider>(aabb_3d, min_line_distance, line_width)
+                                                         : std::make_shared<SierpinskiFillProvider>(aabb_3d, min_line_distance, line_width, density_image_file);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.emplace(key, std::move(provider)).first->second;
+}
+
+void SierpinskiFillProviderCache::startSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_ = isPersistent() ? std::move(entries_) : decltype(entries_)();
+    entries_.clear();
+}
+
+void SierpinskiFillProviderCache::finishSlice()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_entries_.clear();
+    if (! isPersistent())
+    {
+        entries_.clear();
+    }
+}
+
+void SierpinskiFillProviderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    previous_entries_.clear();
+}
+
+uint64_t SierpinskiFillProviderCache::hashInput(const AABB3D& aabb_3d, const coord_t min_line_distance, const coord_t line_width, const std::string& density_image_file)
+{
+    // 64-bit FNV-1a style hash, mixing in whole words at a time.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const auto add = [&hash](const uint64_t value)
+    {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    };
+
+    // Only the horizontal extent of the bounding box matters, since the fractal is the same on every layer.
+    add(aabb_3d.min_.x_);
+    add(aabb_3d.min_.y_);
+    add(aabb_3d.max_.x_);
+    add(aabb_3d.max_.y_);
+    add(min_line_distance);
+    add(line_width);
+
+    for (const char character : density_image_file)
+    {
+        add(static_cast<uint64_t>(character));
+    }
+    add(density_image_file.size());
+    if (! density_image_file.empty())
+    {
+        // The image may have been edited between slices.
+        std::error_code error;
+        const auto modification_time = std::filesystem::last_write_time(density_image_file, error);
+        add(error ? 0 : static_cast<uint64_t>(modification_time.time_since_epoch().count()));
+        const uintmax_t file_size = std::filesystem::file_size(density_image_file, error);
+        add(error ? 0 : static_cast<uint64_t>(file_size));
+    }
+
+    return hash;
+}
+
+} // namespace cura
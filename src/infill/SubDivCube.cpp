@@ -3,10 +3,12 @@
 
 #include "infill/SubDivCube.h"
 
+#include <array>
 #include <functional>
 
 #include "settings/types/Angle.h" //For the infill angle.
 #include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
 
@@ -18,12 +20,12 @@
 namespace cura
 {
 
-std::vector<SubDivCube::CubeProperties> SubDivCube::cube_properties_per_recursion_step_;
-coord_t SubDivCube::radius_addition_ = 0;
-Point3Matrix SubDivCube::rotation_matrix_;
-PointMatrix SubDivCube::infill_rotation_matrix_;
-
 void SubDivCube::precomputeOctree(SliceMeshStorage& mesh, const Point2LL& infill_origin)
+{
+    mesh.base_subdiv_cube = std::make_shared<SubDivCube>(mesh, infill_origin);
+}
+
+SubDivCube::SubDivCube(SliceMeshStorage& mesh, const Point2LL& infill_origin)
 {
     radius_addition_ = mesh.settings.get<coord_t>("sub_div_rad_add");
 
@@ -80,18 +82,109 @@ void SubDivCube::precomputeOctree(SliceMeshStorage& mesh, const Point2LL& infill
 
     rotation_matrix_ = infill_angle_mat.compose(tilt);
 
-    mesh.base_subdiv_cube = std::make_shared<SubDivCube>(mesh, center, curr_recursion_depth - 1);
+    if (cube_properties_per_recursion_step_.empty()) // Infill is set to 0%.
+    {
+        return;
+    }
+    root_depth_ = curr_recursion_depth - 1;
+
+    // The infill areas of each layer are tested many times, so collect them once.
+    const coord_t layer_height = mesh.settings.get<coord_t>("layer_height");
+    std::vector<Polygons> layer_infill_areas(mesh.layers.size());
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        {
+            for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
+            {
+                layer_infill_areas[layer_nr].add(part.infill_area);
+            }
+        });
+
+    const std::array<Point3LL, 8> rel_child_centers{
+        Point3LL(1, 1, 1), // top
+        Point3LL(-1, 1, 1), // top three
+        Point3LL(1, -1, 1),
+        Point3LL(1, 1, -1),
+        Point3LL(-1, -1, -1), // bottom
+        Point3LL(1, -1, -1), // bottom three
+        Point3LL(-1, 1, -1),
+        Point3LL(-1, -1, 1),
+    };
+
+    // Build the octree one level at a time. The children of all cubes in a level are tested in parallel, then appended
+    // in the order of their parents.
+    cubes_.emplace_back(Cube{ center, 0, 0 });
+    size_t level_start = 0;
+    for (size_t depth = root_depth_; depth > 0 && level_start < cubes_.size(); depth--) // The lowest layer needs no subdivision.
+    {
+        const size_t level_end = cubes_.size();
+        const CubeProperties& cube_properties = cube_properties_per_recursion_step_[depth];
+        const coord_t radius = double(cube_properties.height) / 4.0 + radius_addition_;
+
+        std::vector<Point3LL> child_centers((level_end - level_start) * rel_child_centers.size());
+        std::vector<uint8_t> child_counts(level_end - level_start, 0);
+        cura::parallel_for<size_t>(
+            level_start,
+            level_end,
+            [&](const size_t cube_idx)
+            {
+                const size_t level_idx = cube_idx - level_start;
+                for (const Point3LL& rel_child_center : rel_child_centers)
+                {
+                    const Point3LL child_center = cubes_[cube_idx].center + rotation_matrix_.apply(rel_child_center * int32_t(cube_properties.side_length / 4));
+                    if (isValidSubdivision(layer_infill_areas, layer_height, child_center, radius))
+                    {
+                        child_centers[level_idx * rel_child_centers.size() + child_counts[level_idx]] = child_center;
+                        child_counts[level_idx]++;
+                    }
+                }
+            });
+
+        for (size_t cube_idx = level_start; cube_idx < level_end; cube_idx++)
+        {
+            const size_t level_idx = cube_idx - level_start;
+            cubes_[cube_idx].first_child = static_cast<uint32_t>(cubes_.size());
+            cubes_[cube_idx].child_count = child_counts[level_idx];
+            for (size_t child_nr = 0; child_nr < child_counts[level_idx]; child_nr++)
+            {
+                cubes_.emplace_back(Cube{ child_centers[level_idx * rel_child_centers.size() + child_nr], 0, 0 });
+            }
+        }
+        level_start = level_end;
+    }
 }
 
-void SubDivCube::generateSubdivisionLines(const coord_t z, Polygons& result)
+void SubDivCube::generateSubdivisionLines(const coord_t z, Polygons& result) const
 {
-    if (cube_properties_per_recursion_step_.empty()) // Infill is set to 0%.
+    if (cubes_.empty()) // Infill is set to 0%.
     {
         return;
     }
     Polygons directional_line_groups[3];
 
-    generateSubdivisionLines(z, directional_line_groups);
+    // Walk the octree depth-first, in the same order as the cubes were subdivided. Cubes that don't touch the layer
+    // can't have children that do, so their subtrees are skipped.
+    std::vector<std::pair<size_t, size_t>> to_visit{ { 0, root_depth_ } }; // Indices of cubes with their recursion depth.
+    while (! to_visit.empty())
+    {
+        const auto [cube_idx, depth] = to_visit.back();
+        to_visit.pop_back();
+        const Cube& cube = cubes_[cube_idx];
+        const CubeProperties& cube_properties = cube_properties_per_recursion_step_[depth];
+
+        const coord_t z_diff = std::abs(z - cube.center.z_); //!< the difference between the cube center and the target layer.
+        if (z_diff > cube_properties.height / 2) //!< this cube does not touch the target layer.
+        {
+            continue;
+        }
+        generateSubdivisionLines(cube, cube_properties, z, directional_line_groups);
+        for (size_t child_idx = cube.first_child + cube.child_count; child_idx > cube.first_child; child_idx--) //!< visits the children in order
+        {
+            to_visit.emplace_back(child_idx - 1, depth - 1);
+        }
+    }
 
     for (int dir_idx = 0; dir_idx < 3; dir_idx++)
     {
@@ -103,31 +196,25 @@ void SubDivCube::generateSubdivisionLines(const coord_t z, Polygons& result)
     }
 }
 
-void SubDivCube::generateSubdivisionLines(const coord_t z, Polygons (&directional_line_groups)[3])
+void SubDivCube::generateSubdivisionLines(const Cube& cube, const CubeProperties& cube_properties, const coord_t z, Polygons (&directional_line_groups)[3]) const
 {
-    CubeProperties cube_properties = cube_properties_per_recursion_step_[depth_];
-
-    const coord_t z_diff = std::abs(z - center_.z_); //!< the difference between the cube center and the target layer.
-    if (z_diff > cube_properties.height / 2) //!< this cube does not touch the target layer. Early exit.
-    {
-        return;
-    }
+    const coord_t z_diff = std::abs(z - cube.center.z_); //!< the difference between the cube center and the target layer.
     if (z_diff < cube_properties.max_draw_z_diff) //!< this cube has lines that need to be drawn.
     {
         Point2LL relative_a, relative_b; //!< relative coordinates of line endpoints around cube center
         Point2LL a, b; //!< absolute coordinates of line endpoints
         relative_a.X = (cube_properties.square_height / 2) * (cube_properties.max_draw_z_diff - z_diff) / cube_properties.max_draw_z_diff;
         relative_b.X = -relative_a.X;
-        relative_a.Y = cube_properties.max_line_offset - ((z - (center_.z_ - cube_properties.max_draw_z_diff)) * ONE_OVER_SQRT_2);
+        relative_a.Y = cube_properties.max_line_offset - ((z - (cube.center.z_ - cube_properties.max_draw_z_diff)) * ONE_OVER_SQRT_2);
         relative_b.Y = relative_a.Y;
         rotatePointInitial(relative_a);
         rotatePointInitial(relative_b);
         for (int dir_idx = 0; dir_idx < 3; dir_idx++) //!< draw the line, then rotate 120 degrees.
         {
-            a.X = center_.x_ + relative_a.X;
-            a.Y = center_.y_ + relative_a.Y;
-            b.X = center_.x_ + relative_b.X;
-            b.Y = center_.y_ + relative_b.Y;
+            a.X = cube.center.x_ + relative_a.X;
+            a.Y = cube.center.y_ + relative_a.Y;
+            b.X = cube.center.x_ + relative_b.X;
+            b.Y = cube.center.y_ + relative_b.Y;
             addLineAndCombine(directional_line_groups[dir_idx], a, b);
             if (dir_idx < 2)
             {
@@ -136,54 +223,9 @@ void SubDivCube::generateSubdivisionLines(const coord_t z, Polygons (&directiona
             }
         }
     }
-    for (int idx = 0; idx < 8; idx++) //!< draws the eight children
-    {
-        if (children_[idx] != nullptr)
-        {
-            children_[idx]->generateSubdivisionLines(z, directional_line_groups);
-        }
-    }
 }
 
-SubDivCube::SubDivCube(SliceMeshStorage& mesh, Point3LL& center, size_t depth)
-    : depth_(depth)
-    , center_(center)
-{
-    if (depth_ == 0) // lowest layer, no need for subdivision, exit.
-    {
-        return;
-    }
-    if (depth_ >= cube_properties_per_recursion_step_.size()) // Depth is out of bounds of what we pre-computed.
-    {
-        return;
-    }
-
-    CubeProperties cube_properties = cube_properties_per_recursion_step_[depth];
-    Point3LL child_center;
-    coord_t radius = double(cube_properties.height) / 4.0 + radius_addition_;
-
-    int child_nr = 0;
-    std::vector<Point3LL> rel_child_centers;
-    rel_child_centers.emplace_back(1, 1, 1); // top
-    rel_child_centers.emplace_back(-1, 1, 1); // top three
-    rel_child_centers.emplace_back(1, -1, 1);
-    rel_child_centers.emplace_back(1, 1, -1);
-    rel_child_centers.emplace_back(-1, -1, -1); // bottom
-    rel_child_centers.emplace_back(1, -1, -1); // bottom three
-    rel_child_centers.emplace_back(-1, 1, -1);
-    rel_child_centers.emplace_back(-1, -1, 1);
-    for (Point3LL rel_child_center : rel_child_centers)
-    {
-        child_center = center + rotation_matrix_.apply(rel_child_center * int32_t(cube_properties.side_length / 4));
-        if (isValidSubdivision(mesh, child_center, radius))
-        {
-            children_[child_nr] = std::make_shared<SubDivCube>(mesh, child_center, depth - 1);
-            child_nr++;
-        }
-    }
-}
-
-bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, coord_t radius)
+bool SubDivCube::isValidSubdivision(const std::vector<Polygons>& layer_infill_areas, const coord_t layer_height, const Point3LL& center, coord_t radius)
 {
     coord_t distance2 = 0;
     coord_t sphere_slice_radius2; //!< squared radius of bounding sphere slice on target layer
@@ -191,7 +233,6 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
     bool outside_somewhere = false;
     int inside;
     Ratio part_dist; // what percentage of the radius the target layer is away from the center along the z axis. 0 - 1
-    const coord_t layer_height = mesh.settings.get<coord_t>("layer_height");
     int bottom_layer = (center.z_ - radius) / layer_height;
     int top_layer = (center.z_ + radius) / layer_height;
     for (int test_layer = bottom_layer; test_layer <= top_layer; test_layer += 3) // steps of three. Low-hanging speed gain.
@@ -200,7 +241,7 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
         sphere_slice_radius2 = radius * radius * (1.0 - (part_dist * part_dist));
         Point2LL loc(center.x_, center.y_);
 
-        inside = distanceFromPointToMesh(mesh, test_layer, loc, &distance2);
+        inside = distanceFromPointToMesh(layer_infill_areas, test_layer, loc, &distance2);
         if (inside == 1)
         {
             inside_somewhere = true;
@@ -221,18 +262,14 @@ bool SubDivCube::isValidSubdivision(SliceMeshStorage& mesh, Point3LL& center, co
     return false;
 }
 
-coord_t SubDivCube::distanceFromPointToMesh(SliceMeshStorage& mesh, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2)
+coord_t SubDivCube::distanceFromPointToMesh(const std::vector<Polygons>& layer_infill_areas, const LayerIndex layer_nr, Point2LL& location, coord_t* distance2)
 {
-    if (layer_nr < 0 || (unsigned int)layer_nr >= mesh.layers.size()) //!< this layer is outside of valid range
+    if (layer_nr < 0 || (unsigned int)layer_nr >= layer_infill_areas.size()) //!< this layer is outside of valid range
     {
         return 2;
         *distance2 = 0;
     }
-    Polygons collide;
-    for (const SliceLayerPart& part : mesh.layers[layer_nr].parts)
-    {
-        collide.add(part.infill_area);
-    }
+    const Polygons& collide = layer_infill_areas[layer_nr];
 
     Point2LL centerpoint = location;
     bool inside = collide.inside(centerpoint);
@@ -247,7 +284,7 @@ coord_t SubDivCube::distanceFromPointToMesh(SliceMeshStorage& mesh, const LayerI
 }
 
 
-void SubDivCube::rotatePointInitial(Point2LL& target)
+void SubDivCube::rotatePointInitial(Point2LL& target) const
 {
     target = infill_rotation_matrix_.apply(target);
 }
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "infill/SupportInfillCache.h"
+
+#include <algorithm>
+
+namespace cura
+{
+
+bool SupportInfillCache::Key::operator==(const Key& other) const
+{
+    return parameters == other.parameters && area.paths == other.area.paths;
+}
+
+SupportInfillCache::SupportInfillCache(const size_t capacity)
+    : capacity_(std::max(size_t(1), capacity))
+{
+}
+
+bool SupportInfillCache::isCacheable(const EFillMethod pattern)
+{
+    switch (pattern)
+    {
+    case EFillMethod::LINES:
+    case EFillMethod::GRID:
+    case EFillMethod::TRIANGLES:
+    case EFillMethod::TRIHEXAGON:
+    case EFillMethod::CONCENTRIC:
+    case EFillMethod::ZIG_ZAG:
+        return true;
+    default: // The 3D patterns shift with the height of the layer, and the others need more than the area.
+        return false;
+    }
+}
+
+std::shared_ptr<const SupportInfillLines> SupportInfillCache::get(Key key, const std::function<std::shared_ptr<const SupportInfillLines>()>& compute) const
+{
+    const uint64_t key_hash = hash(key);
+    std::vector<std::shared_ptr<const Entry>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The newest entries are the most likely to match, since they are of the layers just below.
+        for (auto entry = entries_.rbegin(); entry != entries_.rend(); ++entry)
+        {
+            if ((*entry)->hash == key_hash)
+            {
+                candidates.push_back(*entry);
+            }
+        }
+    }
+    // Compare the areas outside of the lock, so that other threads don't have to wait for that.
+    for (const std::shared_ptr<const Entry>& candidate : candidates)
+    {
+        if (candidate->key == key)
+        {
+            hit_count_.fetch_add(1, std::memory_order_relaxed);
+            return candidate->lines;
+        }
+    }
+    miss_count_.fetch_add(1, std::memory_order_relaxed);
+
+    auto entry = std::make_shared<Entry>(Entry{ .hash = key_hash, .key = std::move(key), .lines = compute() });
+    std::shared_ptr<const SupportInfillLines> lines = entry->lines;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= capacity_)
+    {
+        entries_.pop_front();
+    }
+    entries_.push_back(std::move(entry));
+    return lines;
+}
+
+size_t SupportInfillCache::hitCount() const
+{
+    return hit_count_.load(std::memory_order_relaxed);
+}
+
+size_t SupportInfillCache::missCount() const
+{
+    return miss_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t SupportInfillCache::hash(const Key& key)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    };
+    for (const coord_t parameter : key.parameters)
+    {
+        combine(static_cast<uint64_t>(parameter));
+    }
+    combine(key.area.paths.size());
+    for (const ClipperLib::Path& path : key.area.paths)
+    {
+        combine(path.size());
+        for (const Point2LL& point : path)
+        {
+            combine(static_cast<uint64_t>(point.X));
+            combine(static_cast<uint64_t>(point.Y));
+        }
+    }
+    return hash;
+}
+
+} // namespace cura
@@ -4,6 +4,7 @@
 #include "layerPart.h"
 
 #include "progress/Progress.h"
+#include "progress/StageCostModel.h"
 #include "settings/EnumSettings.h" //For ESurfaceMode.
 #include "settings/Settings.h"
 #include "sliceDataStorage.h"
@@ -93,7 +94,8 @@ void createLayerParts(SliceMeshStorage& mesh, Slicer* slicer)
             SliceLayer& layer_storage = mesh.layers[layer_nr];
             SlicerLayer& slice_layer = slicer->layers[layer_nr];
             createLayerWithParts(mesh.settings, layer_storage, &slice_layer);
-        });
+        },
+        Progress::getCostModel().getChunkSizeFactor(Progress::Stage::PARTS)); // Most layers take too little time to be a chunk on their own.
 
     for (LayerIndex layer_nr = total_layers - 1; layer_nr >= 0; layer_nr--)
     {
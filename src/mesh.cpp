@@ -3,9 +3,14 @@
 
 #include "mesh.h"
 
+#include <atomic>
+#include <mutex>
+
 #include <spdlog/spdlog.h>
 
 #include "utils/Point3D.h"
+#include "utils/RadixSort.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -21,6 +26,17 @@ static inline uint32_t pointHash(const Point3LL& p)
          ^ (((p.z_ + vertex_meld_distance / 2) / vertex_meld_distance) << 20);
 }
 
+/*!
+ * Returns a 64-bit hash for the location, quantized in the same way as pointHash, but with a much lower chance of collisions.
+ */
+static inline uint64_t cellHash(const Point3LL& p)
+{
+    const auto cell_x = static_cast<uint64_t>((p.x_ + vertex_meld_distance / 2) / vertex_meld_distance);
+    const auto cell_y = static_cast<uint64_t>((p.y_ + vertex_meld_distance / 2) / vertex_meld_distance);
+    const auto cell_z = static_cast<uint64_t>((p.z_ + vertex_meld_distance / 2) / vertex_meld_distance);
+    return (cell_x * 73856093ULL) ^ (cell_y * 19349669ULL) ^ (cell_z * 83492791ULL);
+}
+
 Mesh::Mesh(Settings& parent)
     : settings_(parent)
     , has_disconnected_faces(false)
@@ -54,26 +70,277 @@ void Mesh::addFace(Point3LL& v0, Point3LL& v1, Point3LL& v2)
     vertices_[face.vertex_index_[2]].connected_faces_.push_back(idx);
 }
 
+void Mesh::addFaces(const std::vector<Point3LL>& corners)
+{
+    const size_t corner_count = corners.size() - corners.size() % 3;
+    if (! vertices_.empty())
+    { // New corners may need to be welded to the existing vertices, which are only known to the vertex hash map.
+        for (size_t corner_idx = 0; corner_idx < corner_count; corner_idx += 3)
+        {
+            Point3LL v0 = corners[corner_idx];
+            Point3LL v1 = corners[corner_idx + 1];
+            Point3LL v2 = corners[corner_idx + 2];
+            addFace(v0, v1, v2);
+        }
+        return;
+    }
+
+    // Sort the corners by the cell they fall in, keeping the corners within a cell in input order.
+    std::vector<std::pair<uint64_t, uint32_t>> cell_corners(corner_count);
+    cura::parallel_for<size_t>(
+        0,
+        corner_count,
+        [&](size_t corner_idx)
+        {
+            cell_corners[corner_idx] = std::make_pair(cellHash(corners[corner_idx]), static_cast<uint32_t>(corner_idx));
+        },
+        1024);
+    parallel_radix_sort(
+        cell_corners,
+        [](const std::pair<uint64_t, uint32_t>& cell_corner)
+        {
+            return cell_corner.first;
+        });
+
+    // Weld the corners of each cell, in the same way as findIndexOfVertex does: to the first earlier corner within the meld distance.
+    std::vector<size_t> cell_starts;
+    for (size_t sorted_idx = 0; sorted_idx < corner_count; sorted_idx++)
+    {
+        if (sorted_idx == 0 || cell_corners[sorted_idx].first != cell_corners[sorted_idx - 1].first)
+        {
+            cell_starts.push_back(sorted_idx);
+        }
+    }
+    cell_starts.push_back(corner_count);
+    std::vector<uint32_t> welded_to(corner_count); // For each corner, the first corner it is welded to (possibly itself).
+    cura::parallel_for<size_t>(
+        0,
+        cell_starts.size() - 1,
+        [&](size_t cell_idx)
+        {
+            std::vector<uint32_t> cell_vertices;
+            for (size_t sorted_idx = cell_starts[cell_idx]; sorted_idx < cell_starts[cell_idx + 1]; sorted_idx++)
+            {
+                const uint32_t corner_idx = cell_corners[sorted_idx].second;
+                welded_to[corner_idx] = corner_idx;
+                for (const uint32_t vertex_corner_idx : cell_vertices)
+                {
+                    if ((corners[vertex_corner_idx] - corners[corner_idx]).testLength(vertex_meld_distance))
+                    {
+                        welded_to[corner_idx] = vertex_corner_idx;
+                        break;
+                    }
+                }
+                if (welded_to[corner_idx] == corner_idx)
+                {
+                    cell_vertices.push_back(corner_idx);
+                }
+            }
+        },
+        64);
+    cell_corners.clear();
+    cell_corners.shrink_to_fit();
+
+    // Create the vertices and faces in a single pass, numbering the vertices in order of first occurrence.
+    std::vector<uint32_t>& vertex_of_corner = welded_to; // Since corners are only welded to earlier corners, the indices can be replaced in place.
+    vertices_.reserve(vertices_.size() + corner_count / 6); // A closed mesh has about twice as many faces as vertices.
+    faces_.reserve(faces_.size() + corner_count / 3);
+    for (size_t corner_idx = 0; corner_idx < corner_count; corner_idx++)
+    {
+        if (welded_to[corner_idx] == corner_idx)
+        {
+            vertex_of_corner[corner_idx] = vertices_.size();
+            vertices_.emplace_back(corners[corner_idx]);
+            aabb_.include(corners[corner_idx]);
+        }
+        else
+        {
+            vertex_of_corner[corner_idx] = vertex_of_corner[welded_to[corner_idx]];
+        }
+
+        if (corner_idx % 3 == 2)
+        {
+            const int vi0 = vertex_of_corner[corner_idx - 2];
+            const int vi1 = vertex_of_corner[corner_idx - 1];
+            const int vi2 = vertex_of_corner[corner_idx];
+            if (vi0 == vi1 || vi1 == vi2 || vi0 == vi2)
+            {
+                continue; // the face has two vertices which get assigned the same location. Don't add the face.
+            }
+            const int idx = faces_.size();
+            MeshFace& face = faces_.emplace_back();
+            face.vertex_index_[0] = vi0;
+            face.vertex_index_[1] = vi1;
+            face.vertex_index_[2] = vi2;
+            vertices_[vi0].connected_faces_.push_back(idx);
+            vertices_[vi1].connected_faces_.push_back(idx);
+            vertices_[vi2].connected_faces_.push_back(idx);
+        }
+    }
+}
+
+bool Mesh::addIndexedFaces(const std::vector<Point3LL>& vertices, const std::vector<std::array<uint32_t, 3>>& face_vertex_indices)
+{
+    for (const std::array<uint32_t, 3>& face_indices : face_vertex_indices)
+    {
+        if (face_indices[0] >= vertices.size() || face_indices[1] >= vertices.size() || face_indices[2] >= vertices.size())
+        {
+            return false;
+        }
+    }
+
+    const size_t vertex_offset = vertices_.size();
+    vertices_.reserve(vertex_offset + vertices.size());
+    for (const Point3LL& vertex : vertices)
+    {
+        vertices_.emplace_back(vertex);
+        aabb_.include(vertex);
+    }
+
+    faces_.reserve(faces_.size() + face_vertex_indices.size());
+    for (const std::array<uint32_t, 3>& face_indices : face_vertex_indices)
+    {
+        if (face_indices[0] == face_indices[1] || face_indices[1] == face_indices[2] || face_indices[0] == face_indices[2])
+        {
+            continue; // the face has two vertices in the same place. Don't add the face.
+        }
+        const int idx = faces_.size();
+        MeshFace& face = faces_.emplace_back();
+        for (size_t corner_idx = 0; corner_idx < 3; corner_idx++)
+        {
+            face.vertex_index_[corner_idx] = vertex_offset + face_indices[corner_idx];
+            vertices_[face.vertex_index_[corner_idx]].connected_faces_.push_back(idx);
+        }
+    }
+    return true;
+}
+
 void Mesh::clear()
 {
     faces_.clear();
     vertices_.clear();
-    vertex_hash_map_.clear();
+    vertex_hash_map_ = {};
+}
+
+size_t Mesh::releaseGeometry()
+{
+    size_t released_bytes = vertices_.capacity() * sizeof(MeshVertex) + faces_.capacity() * sizeof(MeshFace);
+    for (const MeshVertex& vertex : vertices_)
+    {
+        released_bytes += vertex.connected_faces_.capacity() * sizeof(uint32_t);
+    }
+    // Swap with empty vectors, since clearing them would keep their capacity.
+    std::vector<MeshVertex>().swap(vertices_);
+    std::vector<MeshFace>().swap(faces_);
+    vertex_hash_map_ = {};
+    return released_bytes;
 }
 
 void Mesh::finish()
 {
-    // Finish up the mesh, clear the vertex_hash_map, as it's no longer needed from this point on and uses quite a bit of memory.
-    vertex_hash_map_.clear();
+    // Finish up the mesh, release the vertex_hash_map, as it's no longer needed from this point on and uses quite a bit of memory.
+    vertex_hash_map_ = {};
 
     // For each face, store which other face is connected with it.
-    for (unsigned int i = 0; i < faces_.size(); i++)
+    // Build a table of all the edges of all faces, sorted by the (unordered) pair of vertices of the edge, so that all faces sharing an edge end up next to each other.
+    const size_t half_edge_count = faces_.size() * 3;
+    std::vector<std::pair<uint64_t, uint32_t>> half_edges(half_edge_count); // Vertex pair key, and face_idx * 3 + edge_idx.
+    cura::parallel_for<size_t>(
+        0,
+        half_edge_count,
+        [&](size_t half_edge_idx)
+        {
+            const MeshFace& face = faces_[half_edge_idx / 3];
+            const auto v0 = static_cast<uint32_t>(face.vertex_index_[half_edge_idx % 3]);
+            const auto v1 = static_cast<uint32_t>(face.vertex_index_[(half_edge_idx + 1) % 3]);
+            half_edges[half_edge_idx] = std::make_pair((static_cast<uint64_t>(std::min(v0, v1)) << 32) | std::max(v0, v1), static_cast<uint32_t>(half_edge_idx));
+        },
+        1024);
+    parallel_radix_sort(
+        half_edges,
+        [](const std::pair<uint64_t, uint32_t>& half_edge)
+        {
+            return half_edge.first;
+        });
+
+    std::vector<size_t> edge_starts;
+    for (size_t sorted_idx = 0; sorted_idx < half_edge_count; sorted_idx++)
+    {
+        if (sorted_idx == 0 || half_edges[sorted_idx].first != half_edges[sorted_idx - 1].first)
+        {
+            edge_starts.push_back(sorted_idx);
+        }
+    }
+    edge_starts.push_back(half_edge_count);
+
+    // Edges with one or two faces are resolved in parallel. The (rare) edges with more faces than that need the angle rule, which is done afterwards.
+    std::vector<size_t> non_manifold_edges;
+    std::mutex non_manifold_edges_mutex;
+    std::atomic<size_t> disconnected_edge_count = 0;
+    cura::parallel_for<size_t>(
+        0,
+        edge_starts.size() - 1,
+        [&](size_t edge_idx)
+        {
+            const size_t first = edge_starts[edge_idx];
+            const size_t face_count = edge_starts[edge_idx + 1] - first;
+            if (face_count == 1)
+            {
+                const uint32_t half_edge = half_edges[first].second;
+                spdlog::debug("Couldn't find face connected to face {}", half_edge / 3);
+                faces_[half_edge / 3].connected_face_index_[half_edge % 3] = -1;
+                disconnected_edge_count++;
+            }
+            else if (face_count == 2)
+            {
+                const uint32_t half_edge_a = half_edges[first].second;
+                const uint32_t half_edge_b = half_edges[first + 1].second;
+                faces_[half_edge_a / 3].connected_face_index_[half_edge_a % 3] = half_edge_b / 3;
+                faces_[half_edge_b / 3].connected_face_index_[half_edge_b % 3] = half_edge_a / 3;
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(non_manifold_edges_mutex);
+                non_manifold_edges.push_back(edge_idx);
+            }
+        },
+        64);
+    if (disconnected_edge_count > 0)
+    {
+        if (! has_disconnected_faces)
+        {
+            spdlog::warn("Mesh has disconnected faces!");
+        }
+        has_disconnected_faces = true;
+    }
+
+    std::sort(non_manifold_edges.begin(), non_manifold_edges.end()); // Keep the order of the warnings deterministic.
+    std::vector<int> candidate_faces;
+    for (const size_t edge_idx : non_manifold_edges)
     {
-        MeshFace& face = faces_[i];
-        // faces are connected via the outside
-        face.connected_face_index_[0] = getFaceIdxWithPoints(face.vertex_index_[0], face.vertex_index_[1], i, face.vertex_index_[2]);
-        face.connected_face_index_[1] = getFaceIdxWithPoints(face.vertex_index_[1], face.vertex_index_[2], i, face.vertex_index_[0]);
-        face.connected_face_index_[2] = getFaceIdxWithPoints(face.vertex_index_[2], face.vertex_index_[0], i, face.vertex_index_[1]);
+        for (size_t sorted_idx = edge_starts[edge_idx]; sorted_idx < edge_starts[edge_idx + 1]; sorted_idx++)
+        {
+            const uint32_t face_idx = half_edges[sorted_idx].second / 3;
+            const uint32_t edge_in_face = half_edges[sorted_idx].second % 3;
+            MeshFace& face = faces_[face_idx];
+
+            // The other faces, in order of face index (the half-edges were sorted stably).
+            candidate_faces.clear();
+            for (size_t other_idx = edge_starts[edge_idx]; other_idx < edge_starts[edge_idx + 1]; other_idx++)
+            {
+                if (other_idx != sorted_idx)
+                {
+                    candidate_faces.push_back(half_edges[other_idx].second / 3);
+                }
+            }
+            // faces are connected via the outside
+            face.connected_face_index_[edge_in_face] = getFaceIdxWithPoints(
+                face.vertex_index_[edge_in_face],
+                face.vertex_index_[(edge_in_face + 1) % 3],
+                face_idx,
+                face.vertex_index_[(edge_in_face + 2) % 3],
+                candidate_faces);
+        }
     }
 }
 
@@ -161,22 +428,8 @@ See <a href="http://stackoverflow.com/questions/14066933/direct-way-of-computing
 
 
 */
-int Mesh::getFaceIdxWithPoints(int idx0, int idx1, int notFaceIdx, int notFaceVertexIdx) const
+int Mesh::getFaceIdxWithPoints(int idx0, int idx1, int notFaceIdx, int notFaceVertexIdx, const std::vector<int>& candidateFaces) const
 {
-    std::vector<int> candidateFaces; // in case more than two faces meet at an edge, multiple candidates are generated
-    for (int f : vertices_[idx0].connected_faces_) // search through all faces connected to the first vertex and find those that are also connected to the second
-    {
-        if (f == notFaceIdx)
-        {
-            continue;
-        }
-        if (faces_[f].vertex_index_[0] == idx1 // && faces[f].vertex_index[1] == idx0 // next face should have the right direction!
-            || faces_[f].vertex_index_[1] == idx1 // && faces[f].vertex_index[2] == idx0
-            || faces_[f].vertex_index_[2] == idx1 // && faces[f].vertex_index[0] == idx0
-        )
-            candidateFaces.push_back(f);
-    }
-
     if (candidateFaces.size() == 0)
     {
         spdlog::debug("Couldn't find face connected to face {}", notFaceIdx);
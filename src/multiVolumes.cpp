@@ -4,13 +4,16 @@
 #include "multiVolumes.h"
 
 #include <algorithm>
+#include <optional>
 
 #include "Application.h"
 #include "Slice.h"
 #include "settings/EnumSettings.h"
 #include "settings/types/LayerIndex.h"
 #include "slicer.h"
+#include "utils/AABB.h"
 #include "utils/PolylineStitcher.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -20,38 +23,83 @@ void carveMultipleVolumes(std::vector<Slicer*>& volumes)
     // Go trough all the volumes, and remove the previous volume outlines from our own outline, so we never have overlapped areas.
     const bool alternate_carve_order = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<bool>("alternate_carve_order");
     std::vector<Slicer*> ranked_volumes = volumes;
-    std::sort(
+    std::stable_sort(
         ranked_volumes.begin(),
         ranked_volumes.end(),
         [](Slicer* volume_1, Slicer* volume_2)
         {
             return volume_1->mesh->settings_.get<int>("infill_mesh_order") < volume_2->mesh->settings_.get<int>("infill_mesh_order");
         });
-    for (unsigned int volume_1_idx = 1; volume_1_idx < volumes.size(); volume_1_idx++)
+    const auto is_carved = [](const Slicer& volume)
     {
-        Slicer& volume_1 = *ranked_volumes[volume_1_idx];
-        if (volume_1.mesh->settings_.get<bool>("infill_mesh") || volume_1.mesh->settings_.get<bool>("anti_overhang_mesh") || volume_1.mesh->settings_.get<bool>("support_mesh")
-            || volume_1.mesh->settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
+        const Settings& settings = volume.mesh->settings_;
+        return ! settings.get<bool>("infill_mesh") && ! settings.get<bool>("anti_overhang_mesh") && ! settings.get<bool>("support_mesh")
+            && settings.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::SURFACE;
+    };
+
+    // The pairs of volumes whose bounding boxes overlap, in the order in which they carve each other.
+    struct CarvePair
+    {
+        size_t volume_1_idx; //!< Index into ranked_volumes of the volume that is carved, unless carve_volume_2 is set.
+        size_t volume_2_idx; //!< Index into ranked_volumes of the volume ranked before it.
+        bool same_order; //!< Whether both have the same infill mesh order, so that they alternate which one is carved.
+    };
+    std::vector<CarvePair> pairs;
+    for (size_t volume_1_idx = 1; volume_1_idx < ranked_volumes.size(); volume_1_idx++)
+    {
+        const Slicer& volume_1 = *ranked_volumes[volume_1_idx];
+        if (! is_carved(volume_1))
         {
             continue;
         }
-        for (unsigned int volume_2_idx = 0; volume_2_idx < volume_1_idx; volume_2_idx++)
+        for (size_t volume_2_idx = 0; volume_2_idx < volume_1_idx; volume_2_idx++)
         {
-            Slicer& volume_2 = *ranked_volumes[volume_2_idx];
-            if (volume_2.mesh->settings_.get<bool>("infill_mesh") || volume_2.mesh->settings_.get<bool>("anti_overhang_mesh") || volume_2.mesh->settings_.get<bool>("support_mesh")
-                || volume_2.mesh->settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
+            const Slicer& volume_2 = *ranked_volumes[volume_2_idx];
+            if (! is_carved(volume_2) || ! volume_1.mesh->getAABB().hit(volume_2.mesh->getAABB()))
             {
                 continue;
             }
-            if (! volume_1.mesh->getAABB().hit(volume_2.mesh->getAABB()))
+            const bool same_order = volume_1.mesh->settings_.get<int>("infill_mesh_order") == volume_2.mesh->settings_.get<int>("infill_mesh_order");
+            pairs.push_back(CarvePair{ .volume_1_idx = volume_1_idx, .volume_2_idx = volume_2_idx, .same_order = same_order });
+        }
+    }
+    if (pairs.empty())
+    {
+        return;
+    }
+
+    // Each layer is carved on its own, with the pairs in order. Carving only removes area, so the bounding boxes of the
+    // layers before carving remain valid for skipping the pairs that don't touch on the layer.
+    size_t layer_count = 0;
+    for (const Slicer* volume : ranked_volumes)
+    {
+        layer_count = std::max(layer_count, volume->layers.size());
+    }
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&](const size_t layer_nr)
+        {
+            std::vector<std::optional<AABB>> layer_aabbs(ranked_volumes.size()); // Computed when first needed.
+            const auto get_layer_aabb = [&](const size_t volume_idx) -> const AABB&
             {
-                continue;
-            }
-            for (LayerIndex layerNr = 0; layerNr < volume_1.layers.size(); layerNr++)
+                if (! layer_aabbs[volume_idx])
+                {
+                    layer_aabbs[volume_idx] = AABB(ranked_volumes[volume_idx]->layers[layer_nr].polygons);
+                }
+                return *layer_aabbs[volume_idx];
+            };
+            for (const CarvePair& pair : pairs)
             {
-                SlicerLayer& layer1 = volume_1.layers[layerNr];
-                SlicerLayer& layer2 = volume_2.layers[layerNr];
-                if (alternate_carve_order && layerNr % 2 == 0 && volume_1.mesh->settings_.get<int>("infill_mesh_order") == volume_2.mesh->settings_.get<int>("infill_mesh_order"))
+                Slicer& volume_1 = *ranked_volumes[pair.volume_1_idx];
+                Slicer& volume_2 = *ranked_volumes[pair.volume_2_idx];
+                if (layer_nr >= volume_1.layers.size() || layer_nr >= volume_2.layers.size() || ! get_layer_aabb(pair.volume_1_idx).hit(get_layer_aabb(pair.volume_2_idx)))
+                {
+                    continue;
+                }
+                SlicerLayer& layer1 = volume_1.layers[layer_nr];
+                SlicerLayer& layer2 = volume_2.layers[layer_nr];
+                if (alternate_carve_order && layer_nr % 2 == 0 && pair.same_order)
                 {
                     layer2.polygons = layer2.polygons.difference(layer1.polygons);
                 }
@@ -60,8 +108,7 @@ void carveMultipleVolumes(std::vector<Slicer*>& volumes)
                     layer1.polygons = layer1.polygons.difference(layer2.polygons);
                 }
             }
-        }
-    }
+        });
 }
 
 // Expand each layer a bit and then keep the extra overlapping parts that overlap with other volumes.
@@ -108,76 +155,112 @@ void generateMultipleVolumesOverlap(std::vector<Slicer*>& volumes)
 
 void MultiVolumes::carveCuttingMeshes(std::vector<Slicer*>& volumes, const std::vector<Mesh>& meshes)
 {
-    for (unsigned int carving_mesh_idx = 0; carving_mesh_idx < volumes.size(); carving_mesh_idx++)
+    std::vector<size_t> cutting_mesh_indices;
+    std::vector<size_t> carved_mesh_indices;
+    for (size_t mesh_idx = 0; mesh_idx < volumes.size(); mesh_idx++)
     {
-        const Mesh& cutting_mesh = meshes[carving_mesh_idx];
-        if (! cutting_mesh.settings_.get<bool>("cutting_mesh"))
+        const Settings& settings = meshes[mesh_idx].settings_;
+        if (settings.get<bool>("cutting_mesh"))
         {
-            continue;
+            cutting_mesh_indices.push_back(mesh_idx);
         }
-        Slicer& cutting_mesh_volume = *volumes[carving_mesh_idx];
-        for (LayerIndex layer_nr = 0; layer_nr < cutting_mesh_volume.layers.size(); layer_nr++)
+        // Do not apply cutting_mesh for meshes which have settings (cutting_mesh, anti_overhang_mesh, support_mesh).
+        else if (! settings.get<bool>("anti_overhang_mesh") && ! settings.get<bool>("support_mesh"))
         {
-            Polygons& cutting_mesh_polygons = cutting_mesh_volume.layers[layer_nr].polygons;
-            Polygons& cutting_mesh_polylines = cutting_mesh_volume.layers[layer_nr].openPolylines;
-            Polygons cutting_mesh_area_recomputed;
-            Polygons* cutting_mesh_area;
-            coord_t surface_line_width = cutting_mesh.settings_.get<coord_t>("wall_line_width_0");
-            { // compute cutting_mesh_area
-                if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::BOTH)
+            carved_mesh_indices.push_back(mesh_idx);
+        }
+    }
+    if (cutting_mesh_indices.empty())
+    {
+        return;
+    }
+
+    size_t layer_count = 0;
+    for (const size_t cutting_mesh_idx : cutting_mesh_indices)
+    {
+        layer_count = std::max(layer_count, volumes[cutting_mesh_idx]->layers.size());
+    }
+
+    // The cutting meshes only change their own layers and those of the carved meshes on the same height, so each layer is
+    // carved on its own. Within a layer the cutting meshes carve in order, as a mesh may be carved by several of them.
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&](const size_t layer_nr)
+        {
+            for (const size_t cutting_mesh_idx : cutting_mesh_indices)
+            {
+                const Mesh& cutting_mesh = meshes[cutting_mesh_idx];
+                Slicer& cutting_mesh_volume = *volumes[cutting_mesh_idx];
+                if (layer_nr >= cutting_mesh_volume.layers.size())
                 {
-                    cutting_mesh_area_recomputed = cutting_mesh_polygons.unionPolygons(cutting_mesh_polylines.offsetPolyLine(surface_line_width / 2));
-                    cutting_mesh_area = &cutting_mesh_area_recomputed;
+                    continue;
                 }
-                else if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") == ESurfaceMode::SURFACE)
-                {
-                    // break up polygons into polylines
-                    // they have to be polylines, because they might break up further when doing the cutting
-                    for (PolygonRef poly : cutting_mesh_polygons)
+                const ESurfaceMode surface_mode = cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode");
+                Polygons& cutting_mesh_polygons = cutting_mesh_volume.layers[layer_nr].polygons;
+                Polygons& cutting_mesh_polylines = cutting_mesh_volume.layers[layer_nr].openPolylines;
+                Polygons cutting_mesh_area_recomputed;
+                Polygons* cutting_mesh_area;
+                coord_t surface_line_width = cutting_mesh.settings_.get<coord_t>("wall_line_width_0");
+                { // compute cutting_mesh_area
+                    if (surface_mode == ESurfaceMode::BOTH)
                     {
-                        poly.add(poly[0]);
+                        cutting_mesh_area_recomputed = cutting_mesh_polygons.unionPolygons(cutting_mesh_polylines.offsetPolyLine(surface_line_width / 2));
+                        cutting_mesh_area = &cutting_mesh_area_recomputed;
+                    }
+                    else if (surface_mode == ESurfaceMode::SURFACE)
+                    {
+                        // break up polygons into polylines
+                        // they have to be polylines, because they might break up further when doing the cutting
+                        for (PolygonRef poly : cutting_mesh_polygons)
+                        {
+                            poly.add(poly[0]);
+                        }
+                        cutting_mesh_polylines.add(cutting_mesh_polygons);
+                        cutting_mesh_polygons.clear();
+                        cutting_mesh_area_recomputed = cutting_mesh_polylines.offsetPolyLine(surface_line_width / 2);
+                        cutting_mesh_area = &cutting_mesh_area_recomputed;
+                    }
+                    else
+                    {
+                        cutting_mesh_area = &cutting_mesh_polygons;
                     }
-                    cutting_mesh_polylines.add(cutting_mesh_polygons);
-                    cutting_mesh_polygons.clear();
-                    cutting_mesh_area_recomputed = cutting_mesh_polylines.offsetPolyLine(surface_line_width / 2);
-                    cutting_mesh_area = &cutting_mesh_area_recomputed;
-                }
-                else
-                {
-                    cutting_mesh_area = &cutting_mesh_polygons;
                 }
-            }
+                // Covers the polygons and polylines of the cutting mesh too, so a carved layer that misses it is left as it is.
+                const AABB cutting_mesh_aabb(*cutting_mesh_area);
 
-            Polygons new_outlines;
-            Polygons new_polylines;
-            for (unsigned int carved_mesh_idx = 0; carved_mesh_idx < volumes.size(); carved_mesh_idx++)
-            {
-                const Mesh& carved_mesh = meshes[carved_mesh_idx];
-                // Do not apply cutting_mesh for meshes which have settings (cutting_mesh, anti_overhang_mesh, support_mesh).
-                if (carved_mesh.settings_.get<bool>("cutting_mesh") || carved_mesh.settings_.get<bool>("anti_overhang_mesh") || carved_mesh.settings_.get<bool>("support_mesh"))
+                Polygons new_outlines;
+                Polygons new_polylines;
+                for (const size_t carved_mesh_idx : carved_mesh_indices)
                 {
-                    continue;
-                }
-                Slicer& carved_volume = *volumes[carved_mesh_idx];
-                Polygons& carved_mesh_layer = carved_volume.layers[layer_nr].polygons;
+                    Slicer& carved_volume = *volumes[carved_mesh_idx];
+                    if (layer_nr >= carved_volume.layers.size())
+                    {
+                        continue;
+                    }
+                    Polygons& carved_mesh_layer = carved_volume.layers[layer_nr].polygons;
+                    if (! cutting_mesh_aabb.hit(AABB(carved_mesh_layer)))
+                    {
+                        continue;
+                    }
+
+                    Polygons intersection = cutting_mesh_polygons.intersection(carved_mesh_layer);
+                    new_outlines.add(intersection);
+                    if (surface_mode != ESurfaceMode::NORMAL) // niet te geleuven
+                    {
+                        new_polylines.add(carved_mesh_layer.intersectionPolyLines(cutting_mesh_polylines));
+                    }
 
-                Polygons intersection = cutting_mesh_polygons.intersection(carved_mesh_layer);
-                new_outlines.add(intersection);
-                if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::NORMAL) // niet te geleuven
+                    carved_mesh_layer = carved_mesh_layer.difference(*cutting_mesh_area);
+                }
+                cutting_mesh_polygons = new_outlines.unionPolygons();
+                if (surface_mode != ESurfaceMode::NORMAL)
                 {
-                    new_polylines.add(carved_mesh_layer.intersectionPolyLines(cutting_mesh_polylines));
+                    cutting_mesh_polylines.clear();
+                    PolylineStitcher<Polygons, Polygon, Point2LL>::stitch(new_polylines, cutting_mesh_polylines, cutting_mesh_polygons, surface_line_width);
                 }
-
-                carved_mesh_layer = carved_mesh_layer.difference(*cutting_mesh_area);
-            }
-            cutting_mesh_polygons = new_outlines.unionPolygons();
-            if (cutting_mesh.settings_.get<ESurfaceMode>("magic_mesh_surface_mode") != ESurfaceMode::NORMAL)
-            {
-                cutting_mesh_polylines.clear();
-                PolylineStitcher<Polygons, Polygon, Point2LL>::stitch(new_polylines, cutting_mesh_polylines, cutting_mesh_polygons, surface_line_width);
             }
-        }
-    }
+        });
 }
 
 
@@ -58,6 +58,15 @@ LocToLineGrid& Comb::getModelBoundaryLocToLine(const ExtruderTrain& train)
     return *model_boundary_loc_to_line_[train.extruder_nr_];
 }
 
+const FlatPolygons& Comb::getFlatBoundaryInsideOptimal()
+{
+    if (! flat_boundary_inside_optimal_)
+    {
+        flat_boundary_inside_optimal_.emplace(boundary_inside_optimal_);
+    }
+    return *flat_boundary_inside_optimal_;
+}
+
 Comb::Comb(
     const SliceDataStorage& storage,
     const LayerIndex layer_nr,
@@ -66,6 +75,23 @@ Comb::Comb(
     coord_t comb_boundary_offset,
     coord_t travel_avoid_distance,
     coord_t move_inside_distance)
+    : Comb(
+        storage,
+        layer_nr,
+        std::make_shared<const CombBoundaries>(comb_boundary_inside_minimum, comb_boundary_inside_optimal, comb_boundary_offset),
+        comb_boundary_offset,
+        travel_avoid_distance,
+        move_inside_distance)
+{
+}
+
+Comb::Comb(
+    const SliceDataStorage& storage,
+    const LayerIndex layer_nr,
+    std::shared_ptr<const CombBoundaries> boundaries,
+    coord_t comb_boundary_offset,
+    coord_t travel_avoid_distance,
+    coord_t move_inside_distance)
     : storage_(storage)
     , layer_nr_(layer_nr)
     , travel_avoid_distance_(travel_avoid_distance)
@@ -75,12 +101,13 @@ Comb::Comb(
     , max_crossing_dist2_(
           offset_from_inside_to_outside_ * offset_from_inside_to_outside_
           * 2) // so max_crossing_dist = offset_from_inside_to_outside * sqrt(2) =approx 1.5 to allow for slightly diagonal crossings and slightly inaccurate crossing computation
-    , boundary_inside_minimum_(comb_boundary_inside_minimum) // copy the boundary, because the partsView_inside will reorder the polygons
-    , boundary_inside_optimal_(comb_boundary_inside_optimal) // copy the boundary, because the partsView_inside will reorder the polygons
-    , parts_view_inside_minimum_(boundary_inside_minimum_.splitIntoPartsView()) // WARNING !! changes the order of boundary_inside !!
-    , parts_view_inside_optimal_(boundary_inside_optimal_.splitIntoPartsView()) // WARNING !! changes the order of boundary_inside !!
-    , inside_loc_to_line_minimum_(PolygonUtils::createLocToLineGrid(boundary_inside_minimum_, comb_boundary_offset))
-    , inside_loc_to_line_optimal_(PolygonUtils::createLocToLineGrid(boundary_inside_optimal_, comb_boundary_offset))
+    , boundaries_(std::move(boundaries))
+    , boundary_inside_minimum_(boundaries_->inside_minimum)
+    , boundary_inside_optimal_(boundaries_->inside_optimal)
+    , parts_view_inside_minimum_(boundaries_->parts_view_inside_minimum)
+    , parts_view_inside_optimal_(boundaries_->parts_view_inside_optimal)
+    , inside_loc_to_line_minimum_(*boundaries_->inside_loc_to_line_minimum)
+    , inside_loc_to_line_optimal_(*boundaries_->inside_loc_to_line_optimal)
     , move_inside_distance_(move_inside_distance)
 {
 }
@@ -104,10 +131,10 @@ bool Comb::calc(
     const Point2LL travel_end_point_before_combing = end_point;
     // Move start and end point inside the optimal comb boundary
     size_t start_inside_poly = NO_INDEX;
-    const bool start_inside = moveInside(boundary_inside_optimal_, _start_inside, inside_loc_to_line_optimal_.get(), start_point, start_inside_poly);
+    const bool start_inside = moveInside(boundary_inside_optimal_, _start_inside, &inside_loc_to_line_optimal_, moved_inside_optimal_, start_point, start_inside_poly);
 
     size_t end_inside_poly = NO_INDEX;
-    const bool end_inside = moveInside(boundary_inside_optimal_, _end_inside, inside_loc_to_line_optimal_.get(), end_point, end_inside_poly);
+    const bool end_inside = moveInside(boundary_inside_optimal_, _end_inside, &inside_loc_to_line_optimal_, moved_inside_optimal_, end_point, end_inside_poly);
 
     size_t start_part_boundary_poly_idx = NO_INDEX; // Added initial value to stop MSVC throwing an exception in debug mode
     size_t end_part_boundary_poly_idx = NO_INDEX;
@@ -123,13 +150,14 @@ bool Comb::calc(
         comb_paths.emplace_back();
         const bool combing_succeeded = LinePolygonsCrossings::comb(
             part,
-            *inside_loc_to_line_optimal_,
+            inside_loc_to_line_optimal_,
             start_point,
             end_point,
             comb_paths.back(),
             -offset_dist_to_get_from_on_the_polygon_to_outside_,
             max_comb_distance_ignored,
-            fail_on_unavoidable_obstacles);
+            fail_on_unavoidable_obstacles,
+            &parts_view_inside_optimal_[start_part_idx]);
         // If the endpoint of the travel path changes with combing, then it means that we are moving to an outer wall
         // and we should unretract before the last travel move when travelling to that outer wall
         unretract_before_last_travel_move = combing_succeeded && end_point != travel_end_point_before_combing;
@@ -138,10 +166,10 @@ bool Comb::calc(
 
     // Move start and end point inside the minimum comb boundary
     size_t start_inside_poly_min = NO_INDEX;
-    const bool start_inside_min = moveInside(boundary_inside_minimum_, _start_inside, inside_loc_to_line_minimum_.get(), start_point, start_inside_poly_min);
+    const bool start_inside_min = moveInside(boundary_inside_minimum_, _start_inside, &inside_loc_to_line_minimum_, moved_inside_minimum_, start_point, start_inside_poly_min);
 
     size_t end_inside_poly_min = NO_INDEX;
-    const bool end_inside_min = moveInside(boundary_inside_minimum_, _end_inside, inside_loc_to_line_minimum_.get(), end_point, end_inside_poly_min);
+    const bool end_inside_min = moveInside(boundary_inside_minimum_, _end_inside, &inside_loc_to_line_minimum_, moved_inside_minimum_, end_point, end_inside_poly_min);
 
     size_t start_part_boundary_poly_idx_min{};
     size_t end_part_boundary_poly_idx_min{};
@@ -160,14 +188,15 @@ bool Comb::calc(
 
         comb_result = LinePolygonsCrossings::comb(
             part,
-            *inside_loc_to_line_minimum_,
+            inside_loc_to_line_minimum_,
             start_point,
             end_point,
             result_path,
             -offset_dist_to_get_from_on_the_polygon_to_outside_,
             max_comb_distance_ignored,
-            fail_on_unavoidable_obstacles);
-        Comb::moveCombPathInside(boundary_inside_minimum_, boundary_inside_optimal_, result_path, comb_paths.back()); // add altered result_path to combPaths.back()
+            fail_on_unavoidable_obstacles,
+            &parts_view_inside_minimum_[start_part_idx_min]);
+        Comb::moveCombPathInside(boundary_inside_minimum_, getFlatBoundaryInsideOptimal(), result_path, comb_paths.back()); // add altered result_path to combPaths.back()
         // If the endpoint of the travel path changes with combing, then it means that we are moving to an outer wall
         // and we should unretract before the last travel move when travelling to that outer wall
         unretract_before_last_travel_move = comb_result && end_point != travel_end_point_before_combing;
@@ -188,8 +217,8 @@ bool Comb::calc(
 
     // Find the crossings using the minimum comb boundary, since it's guaranteed to be as close as we can get to the destination.
     // Getting as close as possible prevents exiting the polygon in the wrong direction (e.g. into a hole instead of to the outside).
-    Crossing start_crossing(start_point, start_inside_min, start_part_idx_min, start_part_boundary_poly_idx_min, boundary_inside_minimum_, *inside_loc_to_line_minimum_);
-    Crossing end_crossing(end_point, end_inside_min, end_part_idx_min, end_part_boundary_poly_idx_min, boundary_inside_minimum_, *inside_loc_to_line_minimum_);
+    Crossing start_crossing(start_point, start_inside_min, start_part_idx_min, start_part_boundary_poly_idx_min, boundary_inside_minimum_, inside_loc_to_line_minimum_);
+    Crossing end_crossing(end_point, end_inside_min, end_part_idx_min, end_part_boundary_poly_idx_min, boundary_inside_minimum_, inside_loc_to_line_minimum_);
 
     { // find crossing over the in-between area between inside and outside
         start_crossing.findCrossingInOrMid(parts_view_inside_minimum_, end_point);
@@ -231,7 +260,7 @@ bool Comb::calc(
         bool combing_succeeded = start_inside
                               && LinePolygonsCrossings::comb(
                                      boundary_inside_optimal_,
-                                     *inside_loc_to_line_optimal_,
+                                     inside_loc_to_line_optimal_,
                                      start_point,
                                      start_crossing.in_or_mid_,
                                      comb_paths.back(),
@@ -242,13 +271,14 @@ bool Comb::calc(
         {
             combing_succeeded = LinePolygonsCrossings::comb(
                 start_crossing.dest_part_,
-                *inside_loc_to_line_minimum_,
+                inside_loc_to_line_minimum_,
                 start_point,
                 start_crossing.in_or_mid_,
                 comb_paths.back(),
                 -offset_dist_to_get_from_on_the_polygon_to_outside_,
                 max_comb_distance_ignored,
-                fail_on_unavoidable_obstacles);
+                fail_on_unavoidable_obstacles,
+                &parts_view_inside_minimum_[start_part_idx_min]);
         }
         if (! combing_succeeded)
         { // Couldn't comb between start point and computed crossing from the start part! Happens for very thin parts when the offset_to_get_off_boundary moves points to outside
@@ -318,7 +348,7 @@ bool Comb::calc(
         {
             if (start_inside)
             { // both start and end are inside
-                comb_paths.back().cross_boundary = PolygonUtils::polygonCollidesWithLineSegment(start_point, end_point, *inside_loc_to_line_optimal_);
+                comb_paths.back().cross_boundary = PolygonUtils::polygonCollidesWithLineSegment(start_point, end_point, inside_loc_to_line_optimal_);
             }
             else
             { // both start and end are outside
@@ -341,7 +371,7 @@ bool Comb::calc(
         bool combing_succeeded = end_inside
                               && LinePolygonsCrossings::comb(
                                      boundary_inside_optimal_,
-                                     *inside_loc_to_line_optimal_,
+                                     inside_loc_to_line_optimal_,
                                      end_crossing.in_or_mid_,
                                      end_point,
                                      comb_paths.back(),
@@ -352,13 +382,14 @@ bool Comb::calc(
         {
             combing_succeeded = LinePolygonsCrossings::comb(
                 end_crossing.dest_part_,
-                *inside_loc_to_line_minimum_,
+                inside_loc_to_line_minimum_,
                 end_crossing.in_or_mid_,
                 end_point,
                 comb_paths.back(),
                 -offset_dist_to_get_from_on_the_polygon_to_outside_,
                 max_comb_distance_ignored,
-                fail_on_unavoidable_obstacles);
+                fail_on_unavoidable_obstacles,
+                &parts_view_inside_minimum_[end_part_idx_min]);
         }
         // If the endpoint of the travel path changes with combing, then it means that we are moving to an outer wall
         // and we should unretract before the last travel move when traveling to that outer wall
@@ -374,7 +405,7 @@ bool Comb::calc(
 }
 
 // Try to move comb_path_input points inside by the amount of `move_inside_distance` and see if the points are still in boundary_inside_optimal, add result in comb_path_output
-void Comb::moveCombPathInside(Polygons& boundary_inside, Polygons& boundary_inside_optimal, CombPath& comb_path_input, CombPath& comb_path_output)
+void Comb::moveCombPathInside(const Polygons& boundary_inside, const FlatPolygons& boundary_inside_optimal, CombPath& comb_path_input, CombPath& comb_path_output)
 {
     const coord_t dist = move_inside_distance_;
     const coord_t dist2 = dist * dist;
@@ -424,19 +455,32 @@ Comb::Crossing::Crossing(
     }
 }
 
-bool Comb::moveInside(Polygons& boundary_inside, bool is_inside, LocToLineGrid* inside_loc_to_line, Point2LL& dest_point, size_t& inside_poly)
+bool Comb::moveInside(
+    const Polygons& boundary_inside,
+    bool is_inside,
+    const LocToLineGrid* inside_loc_to_line,
+    std::unordered_map<Point2LL, MovedInside>& moved_inside,
+    Point2LL& dest_point,
+    size_t& inside_poly)
 {
     if (is_inside)
     {
-        ClosestPolygonPoint cpp
-            = PolygonUtils::ensureInsideOrOutside(boundary_inside, dest_point, offset_extra_start_end_, max_moveInside_distance2_, &boundary_inside, inside_loc_to_line);
-        if (! cpp.isValid())
+        auto [it, is_new] = moved_inside.try_emplace(dest_point);
+        MovedInside& result = it->second;
+        if (is_new)
+        {
+            const ClosestPolygonPoint cpp
+                = PolygonUtils::ensureInsideOrOutside(boundary_inside, dest_point, offset_extra_start_end_, max_moveInside_distance2_, &boundary_inside, inside_loc_to_line);
+            result = MovedInside{ .point = dest_point, .inside_poly = cpp.poly_idx_, .moved_inside = cpp.isValid() };
+        }
+        dest_point = result.point;
+        if (! result.moved_inside)
         {
             return false;
         }
         else
         {
-            inside_poly = cpp.poly_idx_;
+            inside_poly = result.inside_poly;
             return true;
         }
     }
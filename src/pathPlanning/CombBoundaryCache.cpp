@@ -0,0 +1,105 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "pathPlanning/CombBoundaryCache.h"
+
+#include <algorithm>
+
+namespace cura
+{
+
+CombBoundaries::CombBoundaries(Polygons minimum, Polygons preferred, const coord_t grid_cell_size)
+    : minimum(std::move(minimum))
+    , preferred(std::move(preferred))
+    , inside_minimum(this->minimum) // copy the boundary, because the parts view will reorder the polygons
+    , inside_optimal(this->preferred) // copy the boundary, because the parts view will reorder the polygons
+    , parts_view_inside_minimum(inside_minimum.splitIntoPartsView()) // WARNING !! changes the order of inside_minimum !!
+    , parts_view_inside_optimal(inside_optimal.splitIntoPartsView()) // WARNING !! changes the order of inside_optimal !!
+    , inside_loc_to_line_minimum(PolygonUtils::createLocToLineGrid(inside_minimum, grid_cell_size))
+    , inside_loc_to_line_optimal(PolygonUtils::createLocToLineGrid(inside_optimal, grid_cell_size))
+{
+}
+
+bool CombBoundaryCache::Key::operator==(const Key& other) const
+{
+    return parameters == other.parameters && polygons.paths == other.polygons.paths;
+}
+
+CombBoundaryCache::CombBoundaryCache(const size_t capacity)
+    : capacity_(std::max(size_t(1), capacity))
+{
+}
+
+std::shared_ptr<const CombBoundaries> CombBoundaryCache::get(Key key, const std::function<std::shared_ptr<const CombBoundaries>()>& compute) const
+{
+    const uint64_t key_hash = hash(key);
+    std::vector<std::shared_ptr<const Entry>> candidates;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The newest entries are the most likely to match, since they are of the layers just below.
+        for (auto entry = entries_.rbegin(); entry != entries_.rend(); ++entry)
+        {
+            if ((*entry)->hash == key_hash)
+            {
+                candidates.push_back(*entry);
+            }
+        }
+    }
+    // Compare the polygons outside of the lock, so that other threads don't have to wait for that.
+    for (const std::shared_ptr<const Entry>& candidate : candidates)
+    {
+        if (candidate->key == key)
+        {
+            hit_count_.fetch_add(1, std::memory_order_relaxed);
+            return candidate->boundaries;
+        }
+    }
+    miss_count_.fetch_add(1, std::memory_order_relaxed);
+
+    auto entry = std::make_shared<Entry>(Entry{ .hash = key_hash, .key = std::move(key), .boundaries = compute() });
+    std::shared_ptr<const CombBoundaries> boundaries = entry->boundaries;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= capacity_)
+    {
+        entries_.pop_front();
+    }
+    entries_.push_back(std::move(entry));
+    return boundaries;
+}
+
+size_t CombBoundaryCache::hitCount() const
+{
+    return hit_count_.load(std::memory_order_relaxed);
+}
+
+size_t CombBoundaryCache::missCount() const
+{
+    return miss_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t CombBoundaryCache::hash(const Key& key)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    };
+    for (const coord_t parameter : key.parameters)
+    {
+        combine(static_cast<uint64_t>(parameter));
+    }
+    combine(key.polygons.paths.size());
+    for (const ClipperLib::Path& path : key.polygons.paths)
+    {
+        combine(path.size());
+        for (const Point2LL& point : path)
+        {
+            combine(static_cast<uint64_t>(point.X));
+            combine(static_cast<uint64_t>(point.Y));
+        }
+    }
+    return hash;
+}
+
+} // namespace cura
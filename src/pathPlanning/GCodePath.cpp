@@ -31,4 +31,13 @@ void GCodePath::setFanSpeed(const double fanspeed) noexcept
     return (fan_speed >= 0 && fan_speed <= 100) ? fan_speed : config.getFanSpeed();
 }
 
+void GCodePath::addPoint(const Point2LL& point)
+{
+    if (! points.empty())
+    {
+        length += vSizeMM(point - points.back());
+    }
+    points.push_back(point);
+}
+
 } // namespace cura
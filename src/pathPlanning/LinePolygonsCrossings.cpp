@@ -4,6 +4,9 @@
 #include "pathPlanning/LinePolygonsCrossings.h"
 
 #include <algorithm>
+#include <tuple>
+
+#include <range/v3/view/enumerate.hpp>
 
 #include "sliceDataStorage.h"
 #include "utils/SVG.h"
@@ -20,40 +23,43 @@ LinePolygonsCrossings::Crossing::Crossing(const size_t poly_idx, const coord_t x
 
 bool LinePolygonsCrossings::calcScanlineCrossings(bool fail_on_unavoidable_obstacles)
 {
-    for (unsigned int poly_idx = 0; poly_idx < boundary_.size(); poly_idx++)
+    size_t poly_crossing_count = 0; // The number of crossings with the polygon of the current line segment.
+    for (const auto [segment_idx, line_start] : scanline_segments_ | ranges::views::enumerate)
     {
-        ConstPolygonRef poly = boundary_[poly_idx];
-        Point2LL p0 = transformation_matrix_.apply(poly[poly.size() - 1]);
-        for (unsigned int point_idx = 0; point_idx < poly.size(); point_idx++)
+        if (segment_idx > 0 && line_start.poly_idx_ != scanline_segments_[segment_idx - 1].poly_idx_)
         {
-            Point2LL p1 = transformation_matrix_.apply(poly[point_idx]);
-            if ((p0.Y >= transformed_start_point_.Y && p1.Y <= transformed_start_point_.Y) || (p1.Y >= transformed_start_point_.Y && p0.Y <= transformed_start_point_.Y))
-            { // if line segment crosses the line through the transformed start and end point (aka scanline)
-                if (p1.Y == p0.Y) // Line segment is parallel with the scanline. That means that both endpoints lie on the scanline, so they will have intersected with the adjacent
-                                  // line.
-                {
-                    p0 = p1;
-                    continue;
-                }
-                const coord_t x = p0.X + (p1.X - p0.X) * (transformed_start_point_.Y - p0.Y) / (p1.Y - p0.Y); // intersection point between line segment and the scanline
-
-                if (x >= transformed_start_point_.X && x <= transformed_end_point_.X)
-                {
-                    if (! ((p1.Y == transformed_start_point_.Y && p1.Y < p0.Y) || (p0.Y == transformed_start_point_.Y && p0.Y < p1.Y)))
-                    { // perform edge case only for line segments on and below the scanline, not for line segments on and above.
-                        // \/ will be no crossings and /\ two, but most importantly | will be one crossing.
-                        crossings_.emplace_back(poly_idx, x, point_idx);
-                    }
-                }
+            if (fail_on_unavoidable_obstacles && poly_crossing_count % 2 == 1)
+            { // if start area and end area are not the same
+                return false;
             }
-            p0 = p1;
+            poly_crossing_count = 0;
         }
+        const Point2LL p0 = transformation_matrix_.apply(line_start.p());
+        const Point2LL p1 = transformation_matrix_.apply(line_start.next().p());
+        if ((p0.Y >= transformed_start_point_.Y && p1.Y <= transformed_start_point_.Y) || (p1.Y >= transformed_start_point_.Y && p0.Y <= transformed_start_point_.Y))
+        { // if line segment crosses the line through the transformed start and end point (aka scanline)
+            if (p1.Y == p0.Y) // Line segment is parallel with the scanline. That means that both endpoints lie on the scanline, so they will have intersected with the adjacent
+                              // line.
+            {
+                continue;
+            }
+            const coord_t x = p0.X + (p1.X - p0.X) * (transformed_start_point_.Y - p0.Y) / (p1.Y - p0.Y); // intersection point between line segment and the scanline
 
-        if (fail_on_unavoidable_obstacles && crossings_.size() % 2 == 1)
-        { // if start area and end area are not the same
-            return false;
+            if (x >= transformed_start_point_.X && x <= transformed_end_point_.X)
+            {
+                if (! ((p1.Y == transformed_start_point_.Y && p1.Y < p0.Y) || (p0.Y == transformed_start_point_.Y && p0.Y < p1.Y)))
+                { // perform edge case only for line segments on and below the scanline, not for line segments on and above.
+                    // \/ will be no crossings and /\ two, but most importantly | will be one crossing.
+                    crossings_.emplace_back(line_start.poly_idx_, x, line_start.next().point_idx_);
+                    poly_crossing_count++;
+                }
+            }
         }
     }
+    if (fail_on_unavoidable_obstacles && poly_crossing_count % 2 == 1)
+    { // if start area and end area are not the same
+        return false;
+    }
     // order crossings by increasing x
     std::sort(
         crossings_.begin(),
@@ -66,6 +72,41 @@ bool LinePolygonsCrossings::calcScanlineCrossings(bool fail_on_unavoidable_obsta
 }
 
 
+std::vector<PolygonsPointIndex> LinePolygonsCrossings::findScanlineSegments() const
+{
+    std::vector<PolygonsPointIndex> segments;
+    loc_to_line_grid_.processLine(
+        std::make_pair(start_point_, end_point_),
+        [this, &segments](const PolygonsPointIndex& line_start)
+        {
+            if (grid_poly_indices_ == nullptr)
+            {
+                if (line_start.polygons_ == &boundary_)
+                {
+                    segments.push_back(line_start);
+                }
+                return true;
+            }
+            // The boundary is a copy of some of the polygons of the grid, so refer to the same line segment in the boundary.
+            const auto boundary_poly = std::find(grid_poly_indices_->begin(), grid_poly_indices_->end(), line_start.poly_idx_);
+            if (boundary_poly != grid_poly_indices_->end())
+            {
+                segments.emplace_back(&boundary_, static_cast<size_t>(std::distance(grid_poly_indices_->begin(), boundary_poly)), line_start.point_idx_);
+            }
+            return true;
+        });
+
+    // A line segment is in every cell that it passes through.
+    const auto boundary_order = [](const PolygonsPointIndex& a, const PolygonsPointIndex& b)
+    {
+        return std::tie(a.poly_idx_, a.point_idx_) < std::tie(b.poly_idx_, b.point_idx_);
+    };
+    std::sort(segments.begin(), segments.end(), boundary_order);
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+    return segments;
+}
+
+
 bool LinePolygonsCrossings::lineSegmentCollidesWithBoundary()
 {
     Point2LL diff = end_point_ - start_point_;
@@ -73,29 +114,26 @@ bool LinePolygonsCrossings::lineSegmentCollidesWithBoundary()
     transformation_matrix_ = PointMatrix(diff);
     transformed_start_point_ = transformation_matrix_.apply(start_point_);
     transformed_end_point_ = transformation_matrix_.apply(end_point_);
+    scanline_segments_ = findScanlineSegments();
 
-    for (ConstPolygonRef poly : boundary_)
+    for (const PolygonsPointIndex& line_start : scanline_segments_)
     {
-        Point2LL p0 = transformation_matrix_.apply(poly.back());
-        for (Point2LL p1_ : poly)
+        const Point2LL p0 = transformation_matrix_.apply(line_start.p());
+        const Point2LL p1 = transformation_matrix_.apply(line_start.next().p());
+        // when the boundary just touches the line don't disambiguate between the boundary moving on to actually cross the line
+        // and the boundary bouncing back, resulting in not a real collision - to keep the algorithm simple.
+        //
+        // disregard overlapping line segments; probably the next or previous line segment is not overlapping, but will give a collision
+        // when the boundary line segment fully overlaps with the line segment this edge case is not viewed as a collision
+        if (p1.Y != p0.Y
+            && ((p0.Y >= transformed_start_point_.Y && p1.Y <= transformed_start_point_.Y) || (p1.Y >= transformed_start_point_.Y && p0.Y <= transformed_start_point_.Y)))
         {
-            Point2LL p1 = transformation_matrix_.apply(p1_);
-            // when the boundary just touches the line don't disambiguate between the boundary moving on to actually cross the line
-            // and the boundary bouncing back, resulting in not a real collision - to keep the algorithm simple.
-            //
-            // disregard overlapping line segments; probably the next or previous line segment is not overlapping, but will give a collision
-            // when the boundary line segment fully overlaps with the line segment this edge case is not viewed as a collision
-            if (p1.Y != p0.Y
-                && ((p0.Y >= transformed_start_point_.Y && p1.Y <= transformed_start_point_.Y) || (p1.Y >= transformed_start_point_.Y && p0.Y <= transformed_start_point_.Y)))
-            {
-                int64_t x = p0.X + (p1.X - p0.X) * (transformed_start_point_.Y - p0.Y) / (p1.Y - p0.Y);
+            int64_t x = p0.X + (p1.X - p0.X) * (transformed_start_point_.Y - p0.Y) / (p1.Y - p0.Y);
 
-                if (x > transformed_start_point_.X && x < transformed_end_point_.X)
-                {
-                    return true;
-                }
+            if (x > transformed_start_point_.X && x < transformed_end_point_.X)
+            {
+                return true;
             }
-            p0 = p1;
         }
     }
 
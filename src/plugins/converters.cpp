@@ -471,13 +471,10 @@ gcode_paths_modify_response::native_value_type
             .fan_speed = gcode_path_msg.fan_speed(),
         };
 
-        path.points = gcode_path_msg.path().path()
-                    | ranges::views::transform(
-                          [](const auto& point_msg)
-                          {
-                              return Point2LL{ point_msg.x(), point_msg.y() };
-                          })
-                    | ranges::to_vector;
+        for (const auto& point_msg : gcode_path_msg.path().path())
+        {
+            path.addPoint(Point2LL{ point_msg.x(), point_msg.y() });
+        }
 
         paths.emplace_back(path);
     }
@@ -0,0 +1,83 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "progress/PrintEstimateExtrapolator.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
+
+namespace cura
+{
+
+PrintEstimateExtrapolator::PrintEstimateExtrapolator(std::vector<double> layer_weights, PrintEstimates at_start)
+    : written_weights_(std::move(layer_weights))
+    , at_start_(std::move(at_start))
+{
+    std::partial_sum(written_weights_.begin(), written_weights_.end(), written_weights_.begin());
+}
+
+std::vector<double> PrintEstimateExtrapolator::getLayerAreas(const SliceDataStorage& storage, const size_t layer_count)
+{
+    std::vector<double> layer_areas(layer_count, 0.0);
+    cura::parallel_for<size_t>(
+        0,
+        layer_count,
+        [&storage, &layer_areas](const size_t layer_nr)
+        {
+            double area = 0.0;
+            for (const std::shared_ptr<SliceMeshStorage>& mesh : storage.meshes)
+            {
+                if (layer_nr >= mesh->layers.size())
+                {
+                    continue;
+                }
+                for (const SliceLayerPart& part : mesh->layers[layer_nr].parts)
+                {
+                    area += INT2MM2(part.outline.area());
+                }
+            }
+            if (layer_nr < storage.support.supportLayers.size())
+            {
+                const SupportLayer& support_layer = storage.support.supportLayers[layer_nr];
+                for (const SupportInfillPart& part : support_layer.support_infill_parts)
+                {
+                    area += INT2MM2(part.outline_.area());
+                }
+                area += INT2MM2(support_layer.support_roof.area()) + INT2MM2(support_layer.support_bottom.area());
+            }
+            layer_areas[layer_nr] = area;
+        });
+    return layer_areas;
+}
+
+std::optional<PrintEstimates> PrintEstimateExtrapolator::extrapolate(const LayerIndex written_layer_nr, const PrintEstimates& written) const
+{
+    if (written_layer_nr < 0 || written_weights_.empty())
+    {
+        return std::nullopt;
+    }
+    const double written_weight = written_weights_[std::min(static_cast<size_t>(written_layer_nr), written_weights_.size() - 1)];
+    if (written_weight <= 0.0)
+    {
+        return std::nullopt;
+    }
+    const double scale = written_weights_.back() / written_weight;
+
+    PrintEstimates estimates = written;
+    for (size_t feature_idx = 0; feature_idx < estimates.print_time_per_feature.size(); feature_idx++)
+    {
+        const double before = feature_idx < at_start_.print_time_per_feature.size() ? static_cast<double>(at_start_.print_time_per_feature[feature_idx]) : 0.0;
+        estimates.print_time_per_feature[feature_idx] = before + (static_cast<double>(written.print_time_per_feature[feature_idx]) - before) * scale;
+    }
+    for (size_t extruder_nr = 0; extruder_nr < estimates.material_per_extruder.size(); extruder_nr++)
+    {
+        const double before = extruder_nr < at_start_.material_per_extruder.size() ? at_start_.material_per_extruder[extruder_nr] : 0.0;
+        estimates.material_per_extruder[extruder_nr] = before + (written.material_per_extruder[extruder_nr] - before) * scale;
+    }
+    return estimates;
+}
+
+} // namespace cura
@@ -3,27 +3,158 @@
 
 #include "progress/Progress.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 #include <range/v3/view/enumerate.hpp>
 #include <spdlog/spdlog.h>
 
 #include "Application.h" //To get the communication channel to send progress through.
 #include "communication/Communication.h" //To send progress through the communication channel.
+#include "progress/StageCostModel.h"
+#include "utils/AllocationStatistics.h"
+#include "utils/MemoryUsage.h"
+#include "utils/ThreadArena.h"
+#include "utils/Trace.h"
 #include "utils/gettime.h"
 
 namespace cura
 {
+std::array<double, N_PROGRESS_STAGES> Progress::stage_weights = Progress::times;
 std::array<double, N_PROGRESS_STAGES> Progress::accumulated_times = { -1 };
 double Progress::total_timing = -1;
 std::optional<LayerIndex> Progress::first_skipped_layer{};
+std::array<Progress::StageTime, N_PROGRESS_STAGES> Progress::stage_times{};
+std::optional<Progress::Stage> Progress::current_stage{};
+Progress::StageTime Progress::current_stage_start{};
+StageCostModel Progress::cost_model{};
+std::optional<std::filesystem::path> Progress::cost_model_file{};
+std::array<double, N_PROGRESS_STAGES> Progress::mesh_group_wall_times{};
+size_t Progress::mesh_group_layer_count = 0;
+
+namespace
+{
+
+//! The wall and processor time since some arbitrary moment, to subtract from each other.
+Progress::StageTime now()
+{
+    const auto wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    const auto cpu_time = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    return { .wall_time = wall_time, .cpu_time = cpu_time };
+}
+
+/*!
+ * Sends the furthest progress that was messaged at a fixed interval, from a thread of its own.
+ *
+ * The threads of the slice only store their progress in an atomic, rather than each sending a message to the front-end.
+ */
+class ProgressReporter
+{
+public:
+    ~ProgressReporter()
+    {
+        stop(false);
+    }
+
+    bool running() const
+    {
+        return running_.load(std::memory_order_relaxed);
+    }
+
+    //! Starts sending the progress, from the start of a slice.
+    void start()
+    {
+        pending_progress_.store(0.0, std::memory_order_relaxed);
+        if (running())
+        {
+            return;
+        }
+#ifdef __EMSCRIPTEN__
+        return; // Without threads, every progress is sent right away.
+#else
+        stopping_ = false;
+        running_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread(
+            [this]()
+            {
+                std::unique_lock lock(mutex_);
+                const auto is_stopping = [this]()
+                {
+                    return stopping_;
+                };
+                while (! stop_requested_.wait_for(lock, Progress::reporting_interval, is_stopping))
+                {
+                    send();
+                }
+            });
+#endif
+    }
+
+    //! Stops sending the progress, but sends what wasn't sent yet if \p send_pending.
+    void stop(const bool send_pending)
+    {
+        if (! thread_.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        stop_requested_.notify_one();
+        thread_.join();
+        running_.store(false, std::memory_order_relaxed);
+        if (send_pending)
+        {
+            send();
+        }
+    }
+
+    //! Keeps the progress to send next, unless it is further already.
+    void update(const double progress)
+    {
+        double pending = pending_progress_.load(std::memory_order_relaxed);
+        while (progress > pending && ! pending_progress_.compare_exchange_weak(pending, progress, std::memory_order_relaxed))
+        {
+        }
+    }
+
+private:
+    void send()
+    {
+        const double progress = pending_progress_.load(std::memory_order_relaxed);
+        if (progress != sent_progress_)
+        {
+            Application::getInstance().communication_->sendProgress(progress);
+            sent_progress_ = progress;
+        }
+    }
+
+    std::atomic<bool> running_{ false };
+    std::atomic<double> pending_progress_{ 0.0 };
+    double sent_progress_ = -1.0; //!< Only used by the thread that sends, or after it stopped.
+    std::mutex mutex_;
+    std::condition_variable stop_requested_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+ProgressReporter progress_reporter;
+
+} // namespace
 
 double Progress::calcOverallProgress(Stage stage, double stage_progress)
 {
     assert(stage_progress <= 1.0);
     assert(stage_progress >= 0.0);
-    return (accumulated_times.at(static_cast<size_t>(stage)) + stage_progress * times.at(static_cast<size_t>(stage))) / total_timing;
+    return (accumulated_times.at(static_cast<size_t>(stage)) + stage_progress * stage_weights.at(static_cast<size_t>(stage))) / total_timing;
 }
 
 void Progress::init()
@@ -32,24 +163,129 @@ void Progress::init()
     for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
     {
         accumulated_times.at(static_cast<size_t>(stage)) = accumulated_time;
-        accumulated_time += times.at(static_cast<size_t>(stage));
+        accumulated_time += stage_weights.at(static_cast<size_t>(stage));
     }
     total_timing = accumulated_time;
 }
 
+void Progress::startCostModel(const Settings& settings)
+{
+    cost_model_file = StageCostModel::getFile(settings);
+    cost_model = cost_model_file ? StageCostModel::load(*cost_model_file) : StageCostModel();
+    mesh_group_wall_times.fill(0.0);
+    mesh_group_layer_count = 0;
+    stage_weights = times;
+    init();
+}
+
+void Progress::setLayerCount(const size_t layer_count)
+{
+    mesh_group_layer_count = layer_count;
+    std::array<double, N_PROGRESS_STAGES> estimated_weights{};
+    double estimated_total = 0.0;
+    for (size_t stage = static_cast<size_t>(Stage::SLICING); stage < static_cast<size_t>(Stage::FINISH); stage++)
+    {
+        const std::optional<double> estimate = cost_model.estimateSeconds(static_cast<Stage>(stage), layer_count);
+        if (! estimate)
+        {
+            return; // Weighing only some of the stages by their costs would put the others out of proportion.
+        }
+        estimated_weights[stage] = *estimate;
+        estimated_total += *estimate;
+    }
+    if (estimated_total <= 0.0)
+    {
+        return;
+    }
+    estimated_weights[static_cast<size_t>(Stage::FINISH)] = estimated_total * times[static_cast<size_t>(Stage::FINISH)] / total_timing;
+    stage_weights = estimated_weights;
+    init();
+    spdlog::info("Expecting the {} layers to take about {:03.3f}s, as on earlier slices for this printer", layer_count, estimated_total);
+}
+
+void Progress::finishCostModel()
+{
+    if (mesh_group_layer_count == 0)
+    {
+        return; // Nothing was sliced.
+    }
+    for (size_t stage = static_cast<size_t>(Stage::SLICING); stage < static_cast<size_t>(Stage::FINISH); stage++)
+    {
+        cost_model.record(static_cast<Stage>(stage), mesh_group_wall_times[stage], mesh_group_layer_count);
+    }
+    if (cost_model_file)
+    {
+        cost_model.save(*cost_model_file);
+    }
+}
+
+const StageCostModel& Progress::getCostModel()
+{
+    return cost_model;
+}
+
 void Progress::messageProgress(Progress::Stage stage, int progress_in_stage, int progress_in_stage_max)
 {
     double percentage = calcOverallProgress(stage, static_cast<double>(progress_in_stage / static_cast<double>(progress_in_stage_max)));
-    Application::getInstance().communication_->sendProgress(percentage);
+    if (progress_reporter.running())
+    {
+        progress_reporter.update(percentage);
+    }
+    else
+    {
+        Application::getInstance().communication_->sendProgress(percentage);
+    }
 }
 
 void Progress::messageProgressStage(Progress::Stage stage, TimeKeeper* time_keeper)
 {
+    const StageTime stage_start = now();
+    const MemoryUsage memory = MemoryUsage::sample();
+    if (current_stage)
+    {
+        StageTime& stage_time = stage_times.at(static_cast<size_t>(*current_stage));
+        stage_time.wall_time += stage_start.wall_time - current_stage_start.wall_time;
+        stage_time.cpu_time += stage_start.cpu_time - current_stage_start.cpu_time;
+        mesh_group_wall_times.at(static_cast<size_t>(*current_stage)) += stage_start.wall_time - current_stage_start.wall_time;
+        stage_time.resident_bytes = memory.resident_bytes;
+        stage_time.peak_resident_bytes = std::max(stage_time.peak_resident_bytes, memory.peak_resident_bytes);
+        if (Trace::enabled())
+        {
+            const auto to_trace_point = [](const double wall_time)
+            {
+                return Trace::clock_t::time_point(std::chrono::duration_cast<Trace::clock_t::duration>(std::chrono::duration<double>(wall_time)));
+            };
+            Trace::record(names.at(static_cast<size_t>(*current_stage)).data(), nullptr, 0, to_trace_point(current_stage_start.wall_time), to_trace_point(stage_start.wall_time));
+        }
+    }
+    MemoryUsage::resetPeak(); // So that the next stage gets its own peak.
+    AllocationStatistics::setStage(stage);
+    ThreadArena::setStage(stage);
+    if (stage == Stage::FINISH)
+    {
+        current_stage.reset(); // Nothing runs after the finish, until the next slice starts.
+        progress_reporter.stop(true);
+    }
+    else
+    {
+        current_stage = stage;
+        if (stage == Stage::SLICING || ! progress_reporter.running()) // A cancelled slice doesn't finish.
+        {
+            progress_reporter.start();
+        }
+    }
+    current_stage_start = stage_start;
+
     if (time_keeper != nullptr)
     {
         if (static_cast<int>(stage) > 0)
         {
-            spdlog::info("Progress: {} accomplished in {:03.3f}s", names.at(static_cast<size_t>(stage) - 1), time_keeper->restart());
+            spdlog::info(
+                "Progress: {} accomplished in {:03.3f}s, holding {} MB of memory, at most {} MB",
+                names.at(static_cast<size_t>(stage) - 1),
+                time_keeper->restart(),
+                memory.resident_bytes / (1024 * 1024),
+                memory.peak_resident_bytes / (1024 * 1024));
         }
         else
         {
@@ -104,4 +340,20 @@ void Progress::messageProgressLayer(LayerIndex layer_nr, size_t total_layers, do
     }
 }
 
+const std::array<Progress::StageTime, N_PROGRESS_STAGES>& Progress::getStageTimes()
+{
+    return stage_times;
+}
+
+void Progress::resetStageTimes()
+{
+    stage_times.fill(StageTime{});
+    current_stage.reset();
+}
+
+std::string_view Progress::getStageName(Stage stage)
+{
+    return names.at(static_cast<size_t>(stage));
+}
+
 } // namespace cura
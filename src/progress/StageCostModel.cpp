@@ -0,0 +1,139 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "progress/StageCostModel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <spdlog/details/os.h>
+#include <spdlog/spdlog.h>
+
+#include "settings/Settings.h"
+
+namespace cura
+{
+
+std::optional<std::filesystem::path> StageCostModel::getFile(const Settings& settings)
+{
+    const std::string directory = spdlog::details::os::getenv("CURA_ENGINE_COST_MODEL");
+    if (directory.empty())
+    {
+        return std::nullopt;
+    }
+    std::string machine_name = settings.has("machine_name") ? settings.get<std::string>("machine_name") : "unknown";
+    std::replace_if(
+        machine_name.begin(),
+        machine_name.end(),
+        [](const unsigned char character)
+        {
+            return ! std::isalnum(character) && character != '-' && character != '_';
+        },
+        '_'); // Any name of a printer makes a valid file name.
+    return std::filesystem::path(directory) / (machine_name + ".costs");
+}
+
+StageCostModel StageCostModel::load(const std::filesystem::path& file)
+{
+    StageCostModel model;
+    std::ifstream stream(file);
+    std::string line;
+    while (std::getline(stream, line)) // A stage per line: its name, the seconds per layer and the number of samples.
+    {
+        std::istringstream fields(line);
+        std::string name;
+        StageCost cost;
+        if (! (fields >> name >> cost.seconds_per_layer >> cost.samples) || ! std::isfinite(cost.seconds_per_layer) || cost.seconds_per_layer < 0.0)
+        {
+            continue;
+        }
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            if (Progress::getStageName(static_cast<Progress::Stage>(stage)) == name)
+            {
+                model.costs_[stage] = cost;
+            }
+        }
+    }
+    return model;
+}
+
+void StageCostModel::save(const std::filesystem::path& file) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+    std::filesystem::path temporary_file = file;
+    temporary_file += fmt::format(".{:08x}.tmp", std::random_device{}()); // Other processes may read or write it at the same time.
+    {
+        std::ofstream stream(temporary_file, std::ios::trunc);
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            if (costs_[stage].samples > 0)
+            {
+                stream << fmt::format("{} {} {}\n", Progress::getStageName(static_cast<Progress::Stage>(stage)), costs_[stage].seconds_per_layer, costs_[stage].samples);
+            }
+        }
+        if (! stream)
+        {
+            spdlog::warn("Couldn't write the cost model {}", file.string());
+            stream.close();
+            std::filesystem::remove(temporary_file, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary_file, file, error);
+    if (error)
+    {
+        spdlog::warn("Couldn't store the cost model {}: {}", file.string(), error.message());
+        std::filesystem::remove(temporary_file, error);
+    }
+}
+
+void StageCostModel::record(const Progress::Stage stage, const double seconds, const size_t layer_count)
+{
+    if (layer_count == 0 || ! std::isfinite(seconds) || seconds < 0.0)
+    {
+        return;
+    }
+    StageCost& cost = costs_.at(static_cast<size_t>(stage));
+    const double seconds_per_layer = seconds / static_cast<double>(layer_count);
+    // The first few slices count as much as each other, until the newest one counts for its fixed weight.
+    const double weight = std::max(newest_weight, 1.0 / static_cast<double>(cost.samples + 1));
+    cost.seconds_per_layer += (seconds_per_layer - cost.seconds_per_layer) * weight;
+    cost.samples++;
+}
+
+const StageCostModel::StageCost& StageCostModel::getCost(const Progress::Stage stage) const
+{
+    return costs_.at(static_cast<size_t>(stage));
+}
+
+std::optional<double> StageCostModel::estimateSeconds(const Progress::Stage stage, const size_t layer_count) const
+{
+    const StageCost& cost = getCost(stage);
+    if (cost.samples == 0)
+    {
+        return std::nullopt;
+    }
+    return cost.seconds_per_layer * static_cast<double>(layer_count);
+}
+
+size_t StageCostModel::getChunkSizeFactor(const Progress::Stage stage, const double min_chunk_seconds) const
+{
+    const StageCost& cost = getCost(stage);
+    if (cost.samples == 0 || cost.seconds_per_layer <= 0.0)
+    {
+        return 1;
+    }
+    constexpr double max_factor = 1024.0; // Even a stage that seems to take no time still gets divided.
+    return static_cast<size_t>(std::clamp(std::floor(min_chunk_seconds / cost.seconds_per_layer), 1.0, max_factor));
+}
+
+} // namespace cura
@@ -3,6 +3,8 @@
 
 #include "raft.h"
 
+#include <array>
+
 #include <polyclipping/clipper.hpp>
 
 #include <spdlog/spdlog.h>
@@ -12,6 +14,7 @@
 #include "Slice.h"
 #include "settings/EnumSettings.h" //For EPlatformAdhesion.
 #include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h"
 
 namespace cura
@@ -29,22 +32,18 @@ void Raft::generate(SliceDataStorage& storage)
     const auto raft_interface_margin = settings.get<coord_t>("raft_interface_margin");
     const auto raft_surface_margin = settings.get<coord_t>("raft_surface_margin");
 
-    storage.raftBaseOutline = storage.raftSurfaceOutline = storage.raftInterfaceOutline = storage.getLayerOutlines(0, include_support, dont_include_prime_tower);
-    storage.raftBaseOutline = storage.raftBaseOutline.offset(raft_base_margin, ClipperLib::jtRound);
-    storage.raftInterfaceOutline = storage.raftInterfaceOutline.offset(raft_interface_margin, ClipperLib::jtRound);
-    storage.raftSurfaceOutline = storage.raftSurfaceOutline.offset(raft_surface_margin, ClipperLib::jtRound);
+    const Polygons footprint = storage.getLayerOutlines(0, include_support, dont_include_prime_tower);
 
     const coord_t shield_line_width_layer0 = settings.get<coord_t>("skirt_brim_line_width");
     const coord_t max_raft_distance = std::max(std::max(raft_base_margin, raft_interface_margin), raft_surface_margin);
+    Polygons shield_raft; // Shared by all raft layers.
     if (storage.draft_protection_shield.size() > 0)
     {
         Polygons draft_shield_raft
             = storage.draft_protection_shield
                   .offset(shield_line_width_layer0) // start half a line width outside shield
                   .difference(storage.draft_protection_shield.offset(-max_raft_distance - shield_line_width_layer0 / 2, ClipperLib::jtRound)); // end distance inside shield
-        storage.raftBaseOutline = storage.raftBaseOutline.unionPolygons(draft_shield_raft);
-        storage.raftSurfaceOutline = storage.raftSurfaceOutline.unionPolygons(draft_shield_raft);
-        storage.raftInterfaceOutline = storage.raftInterfaceOutline.unionPolygons(draft_shield_raft);
+        shield_raft = shield_raft.unionPolygons(draft_shield_raft);
     }
     if (storage.oozeShield.size() > 0 && storage.oozeShield[0].size() > 0)
     {
@@ -52,9 +51,7 @@ void Raft::generate(SliceDataStorage& storage)
         Polygons ooze_shield_raft = ooze_shield
                                         .offset(shield_line_width_layer0) // start half a line width outside shield
                                         .difference(ooze_shield.offset(-max_raft_distance - shield_line_width_layer0 / 2, ClipperLib::jtRound)); // end distance inside shield
-        storage.raftBaseOutline = storage.raftBaseOutline.unionPolygons(ooze_shield_raft);
-        storage.raftSurfaceOutline = storage.raftSurfaceOutline.unionPolygons(ooze_shield_raft);
-        storage.raftInterfaceOutline = storage.raftInterfaceOutline.unionPolygons(ooze_shield_raft);
+        shield_raft = shield_raft.unionPolygons(ooze_shield_raft);
     }
 
     const auto remove_inside_corners = [](Polygons& outline, bool remove_inside_corners, coord_t smoothing, coord_t line_width)
@@ -114,17 +111,39 @@ void Raft::generate(SliceDataStorage& storage)
         }
     };
     const auto nominal_raft_line_width = settings.get<coord_t>("skirt_brim_line_width");
-    remove_inside_corners(storage.raftBaseOutline, settings.get<bool>("raft_base_remove_inside_corners"), settings.get<coord_t>("raft_base_smoothing"), nominal_raft_line_width);
-    remove_inside_corners(
-        storage.raftInterfaceOutline,
-        settings.get<bool>("raft_interface_remove_inside_corners"),
-        settings.get<coord_t>("raft_interface_smoothing"),
-        nominal_raft_line_width);
-    remove_inside_corners(
-        storage.raftSurfaceOutline,
-        settings.get<bool>("raft_surface_remove_inside_corners"),
-        settings.get<coord_t>("raft_surface_smoothing"),
-        nominal_raft_line_width);
+
+    // The outlines of the raft layers only depend on the footprint, so they are generated in parallel.
+    struct RaftLayerOutline
+    {
+        Polygons& outline;
+        coord_t margin;
+        bool remove_inside_corners;
+        coord_t smoothing;
+    };
+    const std::array<RaftLayerOutline, 3> raft_layer_outlines{
+        RaftLayerOutline{ storage.raftBaseOutline, raft_base_margin, settings.get<bool>("raft_base_remove_inside_corners"), settings.get<coord_t>("raft_base_smoothing") },
+        RaftLayerOutline{ storage.raftInterfaceOutline,
+                          raft_interface_margin,
+                          settings.get<bool>("raft_interface_remove_inside_corners"),
+                          settings.get<coord_t>("raft_interface_smoothing") },
+        RaftLayerOutline{ storage.raftSurfaceOutline,
+                          raft_surface_margin,
+                          settings.get<bool>("raft_surface_remove_inside_corners"),
+                          settings.get<coord_t>("raft_surface_smoothing") },
+    };
+    cura::parallel_for<size_t>(
+        0,
+        raft_layer_outlines.size(),
+        [&](const size_t raft_layer_idx)
+        {
+            const RaftLayerOutline& raft_layer = raft_layer_outlines[raft_layer_idx];
+            raft_layer.outline = footprint.offset(raft_layer.margin, ClipperLib::jtRound);
+            if (! shield_raft.empty())
+            {
+                raft_layer.outline = raft_layer.outline.unionPolygons(shield_raft);
+            }
+            remove_inside_corners(raft_layer.outline, raft_layer.remove_inside_corners, raft_layer.smoothing, nominal_raft_line_width);
+        });
 
     if (storage.primeTower.enabled_ && ! storage.primeTower.would_have_actual_tower_)
     {
@@ -6,12 +6,14 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <numeric>
 
 #include "Application.h"
 #include "Slice.h"
 #include "settings/EnumSettings.h"
 #include "settings/types/Angle.h"
 #include "utils/Point3D.h"
+#include "utils/ThreadPool.h"
 
 namespace cura
 {
@@ -64,6 +66,8 @@ void AdaptiveLayerHeights::calculateLayers()
     Settings const& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
     auto slicing_tolerance = mesh_group_settings.get<SlicingTolerance>("slicing_tolerance");
     std::vector<size_t> triangles_of_interest;
+    std::vector<size_t> active_triangles; // The triangles that reach the current z level, of those that start below the thickest layer.
+    auto next_triangle = faces_by_min_z_.begin(); // The first triangle that starts above the thickest layer that was tried.
     const coord_t model_max_z = meshgroup_->max().z_;
     coord_t z_level = 0;
     coord_t previous_layer_height = 0;
@@ -92,17 +96,20 @@ void AdaptiveLayerHeights::calculateLayers()
 
             if (layer_height == allowed_layer_heights_[0])
             {
-                // this is the max layer thickness, search through all of the triangles in the mesh to find those
-                // that intersect with a layer this thick
-                triangles_of_interest.clear();
-
-                for (size_t i = 0; i < face_min_z_values_.size(); ++i)
+                // this is the max layer thickness, find the triangles that intersect with a layer this thick
+                // both bounds only ever go up, so sweep over the triangles in order of their lowest point instead of
+                // searching through all of the triangles in the mesh
+                for (; next_triangle != faces_by_min_z_.end() && face_min_z_values_[*next_triangle] <= upper_bound; ++next_triangle)
                 {
-                    if (face_min_z_values_[i] <= upper_bound && face_max_z_values_[i] >= lower_bound)
-                    {
-                        triangles_of_interest.push_back(i);
-                    }
+                    active_triangles.push_back(*next_triangle);
                 }
+                std::erase_if(
+                    active_triangles,
+                    [this, lower_bound](const size_t i)
+                    {
+                        return face_max_z_values_[i] < lower_bound;
+                    });
+                triangles_of_interest = active_triangles;
             }
             else
             {
@@ -186,7 +193,8 @@ void AdaptiveLayerHeights::calculateLayers()
 
 void AdaptiveLayerHeights::calculateMeshTriangleSlopes()
 {
-    // loop over all mesh faces (triangles) and find their slopes
+    std::vector<const Mesh*> printable_meshes;
+    size_t face_count = 0;
     for (const Mesh& mesh : Application::getInstance().current_slice_->scene.current_mesh_group->meshes)
     {
         // Skip meshes that are not printable
@@ -194,40 +202,65 @@ void AdaptiveLayerHeights::calculateMeshTriangleSlopes()
         {
             continue;
         }
+        printable_meshes.push_back(&mesh);
+        face_count += mesh.faces_.size();
+    }
+    face_min_z_values_.resize(face_count);
+    face_max_z_values_.resize(face_count);
+    face_slopes_.resize(face_count);
 
-        for (const MeshFace& face : mesh.faces_)
-        {
-            const MeshVertex& v0 = mesh.vertices_[face.vertex_index_[0]];
-            const MeshVertex& v1 = mesh.vertices_[face.vertex_index_[1]];
-            const MeshVertex& v2 = mesh.vertices_[face.vertex_index_[2]];
-
-            const Point3D p0 = v0.p_;
-            const Point3D p1 = v1.p_;
-            const Point3D p2 = v2.p_;
-
-            double min_z = p0.z_;
-            min_z = std::min(min_z, p1.z_);
-            min_z = std::min(min_z, p2.z_);
-            double max_z = p0.z_;
-            max_z = std::max(max_z, p1.z_);
-            max_z = std::max(max_z, p2.z_);
-
-            // calculate the angle of this triangle in the z direction
-            const Point3D n = (p1 - p0).cross(p2 - p0);
-            const Point3D normal = n.normalized();
-            AngleRadians z_angle = std::acos(std::abs(normal.z_));
-
-            // prevent flat surfaces from influencing the algorithm
-            if (z_angle == 0)
+    // loop over all mesh faces (triangles) and find their slopes
+    size_t first_face_idx = 0; // Where the faces of each mesh start in the list of all faces.
+    for (const Mesh* mesh : printable_meshes)
+    {
+        cura::parallel_for<size_t>(
+            0,
+            mesh->faces_.size(),
+            [&](const size_t face_idx)
             {
-                z_angle = std::numbers::pi;
-            }
+                const MeshFace& face = mesh->faces_[face_idx];
+                const MeshVertex& v0 = mesh->vertices_[face.vertex_index_[0]];
+                const MeshVertex& v1 = mesh->vertices_[face.vertex_index_[1]];
+                const MeshVertex& v2 = mesh->vertices_[face.vertex_index_[2]];
 
-            face_min_z_values_.push_back(MM2INT(min_z));
-            face_max_z_values_.push_back(MM2INT(max_z));
-            face_slopes_.push_back(z_angle);
-        }
+                const Point3D p0 = v0.p_;
+                const Point3D p1 = v1.p_;
+                const Point3D p2 = v2.p_;
+
+                double min_z = p0.z_;
+                min_z = std::min(min_z, p1.z_);
+                min_z = std::min(min_z, p2.z_);
+                double max_z = p0.z_;
+                max_z = std::max(max_z, p1.z_);
+                max_z = std::max(max_z, p2.z_);
+
+                // calculate the angle of this triangle in the z direction
+                const Point3D n = (p1 - p0).cross(p2 - p0);
+                const Point3D normal = n.normalized();
+                AngleRadians z_angle = std::acos(std::abs(normal.z_));
+
+                // prevent flat surfaces from influencing the algorithm
+                if (z_angle == 0)
+                {
+                    z_angle = std::numbers::pi;
+                }
+
+                face_min_z_values_[first_face_idx + face_idx] = MM2INT(min_z);
+                face_max_z_values_[first_face_idx + face_idx] = MM2INT(max_z);
+                face_slopes_[first_face_idx + face_idx] = z_angle;
+            });
+        first_face_idx += mesh->faces_.size();
     }
+
+    faces_by_min_z_.resize(face_count);
+    std::iota(faces_by_min_z_.begin(), faces_by_min_z_.end(), 0);
+    std::stable_sort(
+        faces_by_min_z_.begin(),
+        faces_by_min_z_.end(),
+        [this](const size_t a, const size_t b)
+        {
+            return face_min_z_values_[a] < face_min_z_values_[b];
+        });
 }
 
 } // namespace cura
@@ -143,4 +143,27 @@ MeshPathConfigs::MeshPathConfigs(const SliceMeshStorage& mesh, const coord_t lay
     }
 }
 
+void MeshPathConfigs::setLayerThickness(const coord_t layer_thickness)
+{
+    for (GCodePathConfig* config : { &inset0_config,
+                                     &insetX_config,
+                                     &inset0_roofing_config,
+                                     &insetX_roofing_config,
+                                     &bridge_inset0_config,
+                                     &bridge_insetX_config,
+                                     &skin_config,
+                                     &bridge_skin_config,
+                                     &bridge_skin_config2,
+                                     &bridge_skin_config3,
+                                     &roofing_config,
+                                     &ironing_config })
+    {
+        config->setLayerThickness(layer_thickness);
+    }
+    for (GCodePathConfig& config : infill_config)
+    {
+        config.setLayerThickness(layer_thickness);
+    }
+}
+
 } // namespace cura
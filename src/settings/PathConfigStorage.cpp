@@ -3,6 +3,9 @@
 
 #include "settings/PathConfigStorage.h"
 
+#include <algorithm>
+#include <cassert>
+
 #include "Application.h"
 #include "ExtruderTrain.h"
 #include "Slice.h"
@@ -154,17 +157,58 @@ PathConfigStorage::PathConfigStorage(const SliceDataStorage& storage, const Laye
     const auto layer_height = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<coord_t>("layer_height");
     const auto support_top_distance = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<coord_t>("support_top_distance");
     const coord_t leftover_support_distance = support_top_distance % layer_height;
+    support_fractional_z_offset = -leftover_support_distance;
+    support_fractional_flow = Ratio(layer_height - leftover_support_distance, layer_height);
+
+    setSupportFractionalConfigs();
+}
+
+PathConfigStorage::PathConfigStorage(const PathConfigStorage& base, const SliceDataStorage& storage, const LayerIndex& layer_nr, const coord_t layer_thickness)
+    : PathConfigStorage(base) // copy
+{
+    assert(layer_nr > 0 && "The first layer and raft layers differ in more than their layer thickness and speeds.");
+
+    for (std::vector<GCodePathConfig>* configs : { &skirt_brim_config_per_extruder, &prime_tower_config_per_extruder, &support_infill_config })
+    {
+        for (GCodePathConfig& config : *configs)
+        {
+            config.setLayerThickness(layer_thickness);
+        }
+    }
+    support_roof_config.setLayerThickness(layer_thickness);
+    support_bottom_config.setLayerThickness(layer_thickness);
+    for (MeshPathConfigs& mesh_config : mesh_configs)
+    {
+        mesh_config.setLayerThickness(layer_thickness);
+    }
+
+    const size_t initial_speedup_layer_count = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<size_t>("speed_slowdown_layers");
+    if (static_cast<size_t>(layer_nr) < initial_speedup_layer_count)
+    {
+        handleInitialLayerSpeedup(storage, layer_nr, initial_speedup_layer_count);
+    }
 
+    setSupportFractionalConfigs();
+}
+
+LayerIndex PathConfigStorage::getFirstFullSpeedLayer()
+{
+    const size_t initial_speedup_layer_count = Application::getInstance().current_slice_->scene.current_mesh_group->settings.get<size_t>("speed_slowdown_layers");
+    return std::max(LayerIndex(1), LayerIndex(initial_speedup_layer_count));
+}
+
+void PathConfigStorage::setSupportFractionalConfigs()
+{
     support_fractional_infill_config = support_infill_config; // copy
     for (auto& config : support_fractional_infill_config)
     {
-        config.z_offset = -leftover_support_distance;
-        config.flow *= Ratio(layer_height - leftover_support_distance, layer_height);
+        config.z_offset = support_fractional_z_offset;
+        config.flow *= support_fractional_flow;
     }
 
     support_fractional_roof_config = support_roof_config; // copy
-    support_fractional_roof_config.z_offset = -leftover_support_distance;
-    support_fractional_roof_config.flow *= Ratio(layer_height - leftover_support_distance, layer_height);
+    support_fractional_roof_config.z_offset = support_fractional_z_offset;
+    support_fractional_roof_config.flow *= support_fractional_flow;
 }
 
 void MeshPathConfigs::smoothAllSpeeds(const SpeedDerivatives& first_layer_config, const LayerIndex layer_nr, const LayerIndex max_speed_layer)
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <regex> // regex parsing for temp flow graph
 #include <sstream> // ostringstream
+#include <stdexcept> // logic_error
 #include <stdio.h>
 #include <string> //Parsing strings (stod, stoul).
 
@@ -41,6 +42,7 @@ Settings::Settings()
 
 void Settings::add(const std::string& key, const std::string value)
 {
+    thaw();
     if (settings.find(key) != settings.end()) // Already exists.
     {
         settings[key] = value;
@@ -51,9 +53,117 @@ void Settings::add(const std::string& key, const std::string value)
     }
 }
 
+/*!
+ * Parse a boolean the way it is written in the settings.
+ */
+static bool parseBool(const std::string& value)
+{
+    if (value == "on" || value == "yes" || value == "true" || value == "True")
+    {
+        return true;
+    }
+    const int num = atoi(value.c_str());
+    return num != 0;
+}
+
+void Settings::freeze()
+{
+    thaw();
+
+    // Some keys may only be known to a child, so gather those of the whole inheritance chain.
+    std::vector<std::string> keys;
+    for (const Settings* container = this; container != nullptr; container = container->parent)
+    {
+        for (const auto& [key, value] : container->settings)
+        {
+            keys.push_back(key);
+        }
+    }
+
+    std::vector<FrozenSetting> frozen;
+    std::unordered_map<std::string, size_t> frozen_index;
+    frozen.reserve(keys.size());
+    frozen_index.reserve(keys.size());
+    for (const std::string& key : keys)
+    {
+        if (! frozen_index.emplace(key, frozen.size()).second)
+        {
+            continue; // Already evaluated.
+        }
+        FrozenSetting frozen_setting;
+        frozen_setting.value = get<std::string>(key);
+        frozen_setting.as_double = atof(frozen_setting.value.c_str());
+        frozen_setting.as_int = atoi(frozen_setting.value.c_str());
+        frozen_setting.as_bool = parseBool(frozen_setting.value);
+        try
+        {
+            frozen_setting.as_size_t = std::stoul(frozen_setting.value);
+        }
+        catch (const std::logic_error&) // Invalid argument or out of range. Let get<size_t> throw it again.
+        {
+        }
+        frozen.push_back(std::move(frozen_setting));
+    }
+
+    std::vector<uint32_t> frozen_key_index(setting_key_count, frozen.size());
+    for (size_t key_idx = 0; key_idx < setting_key_count; key_idx++)
+    {
+        const auto it = frozen_index.find(std::string(setting_key_names[key_idx]));
+        if (it != frozen_index.end())
+        {
+            frozen_key_index[key_idx] = it->second;
+        }
+    }
+
+    frozen_ = std::move(frozen);
+    frozen_index_ = std::move(frozen_index);
+    frozen_key_index_ = std::move(frozen_key_index);
+}
+
+void Settings::thaw()
+{
+    frozen_.clear();
+    frozen_index_.clear();
+    frozen_key_index_.clear();
+}
+
+const Settings::FrozenSetting* Settings::getFrozen(const std::string& key) const
+{
+    if (frozen_.empty())
+    {
+        return nullptr;
+    }
+    const auto it = frozen_index_.find(key);
+    return it == frozen_index_.end() ? nullptr : &frozen_[it->second];
+}
+
+const Settings::FrozenSetting* Settings::getFrozen(const SettingKey key) const
+{
+    if (frozen_.empty())
+    {
+        return nullptr;
+    }
+    const size_t frozen_idx = frozen_key_index_[static_cast<size_t>(key)];
+    return frozen_idx == frozen_.size() ? nullptr : &frozen_[frozen_idx];
+}
+
+/*!
+ * Get the name of a setting key as a string, without constructing it on every call.
+ */
+static const std::string& settingKeyString(const SettingKey key)
+{
+    static const std::vector<std::string> key_strings(setting_key_names.begin(), setting_key_names.end());
+    return key_strings[static_cast<size_t>(key)];
+}
+
 template<>
 std::string Settings::get<std::string>(const std::string& key) const
 {
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->value;
+    }
+
     // If this settings base has a setting value for it, look that up.
     if (settings.find(key) != settings.end())
     {
@@ -78,31 +188,41 @@ std::string Settings::get<std::string>(const std::string& key) const
 template<>
 double Settings::get<double>(const std::string& key) const
 {
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->as_double;
+    }
     return atof(get<std::string>(key).c_str());
 }
 
 template<>
 size_t Settings::get<size_t>(const std::string& key) const
 {
+    if (const FrozenSetting* frozen = getFrozen(key); frozen && frozen->as_size_t)
+    {
+        return *frozen->as_size_t;
+    }
     return std::stoul(get<std::string>(key).c_str());
 }
 
 template<>
 int Settings::get<int>(const std::string& key) const
 {
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->as_int;
+    }
     return atoi(get<std::string>(key).c_str());
 }
 
 template<>
 bool Settings::get<bool>(const std::string& key) const
 {
-    const std::string& value = get<std::string>(key);
-    if (value == "on" || value == "yes" || value == "true" || value == "True")
+    if (const FrozenSetting* frozen = getFrozen(key))
     {
-        return true;
+        return frozen->as_bool;
     }
-    const int num = atoi(value.c_str());
-    return num != 0;
+    return parseBool(get<std::string>(key));
 }
 
 template<>
@@ -770,6 +890,154 @@ std::vector<AngleDegrees> Settings::get<std::vector<AngleDegrees>>(const std::st
     return std::vector<AngleDegrees>(values_doubles.begin(), values_doubles.end()); // Cast them to AngleDegrees.
 }
 
+template<typename A>
+A Settings::get(const SettingKey key) const
+{
+    return get<A>(settingKeyString(key));
+}
+
+template<>
+std::string Settings::get<std::string>(const SettingKey key) const
+{
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->value;
+    }
+    return get<std::string>(settingKeyString(key));
+}
+
+template<>
+double Settings::get<double>(const SettingKey key) const
+{
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->as_double;
+    }
+    return get<double>(settingKeyString(key));
+}
+
+template<>
+size_t Settings::get<size_t>(const SettingKey key) const
+{
+    if (const FrozenSetting* frozen = getFrozen(key); frozen && frozen->as_size_t)
+    {
+        return *frozen->as_size_t;
+    }
+    return get<size_t>(settingKeyString(key));
+}
+
+template<>
+int Settings::get<int>(const SettingKey key) const
+{
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->as_int;
+    }
+    return get<int>(settingKeyString(key));
+}
+
+template<>
+bool Settings::get<bool>(const SettingKey key) const
+{
+    if (const FrozenSetting* frozen = getFrozen(key))
+    {
+        return frozen->as_bool;
+    }
+    return get<bool>(settingKeyString(key));
+}
+
+template<>
+ExtruderTrain& Settings::get<ExtruderTrain&>(const SettingKey key) const
+{
+    int extruder_nr = get<int>(key);
+    if (extruder_nr < 0)
+    {
+        extruder_nr = get<size_t>(SettingKey::extruder_nr);
+    }
+    return Application::getInstance().current_slice_->scene.extruders[extruder_nr];
+}
+
+template<>
+LayerIndex Settings::get<LayerIndex>(const SettingKey key) const
+{
+    // For the user we display layer numbers starting from 1, but we start counting from 0. Still it may be negative for Raft layers.
+    return get<int>(key) - 1;
+}
+
+template<>
+coord_t Settings::get<coord_t>(const SettingKey key) const
+{
+    return MM2INT(get<double>(key)); // The settings are all in millimetres, but we need to interpret them as microns.
+}
+
+template<>
+AngleRadians Settings::get<AngleRadians>(const SettingKey key) const
+{
+    return get<double>(key) * std::numbers::pi / 180; // The settings are all in degrees, but we need to interpret them as radians.
+}
+
+template<>
+AngleDegrees Settings::get<AngleDegrees>(const SettingKey key) const
+{
+    return get<double>(key);
+}
+
+template<>
+Temperature Settings::get<Temperature>(const SettingKey key) const
+{
+    return get<double>(key);
+}
+
+template<>
+Velocity Settings::get<Velocity>(const SettingKey key) const
+{
+    return get<double>(key);
+}
+
+template<>
+Acceleration Settings::get<Acceleration>(const SettingKey key) const
+{
+    return get<double>(key);
+}
+
+template<>
+Ratio Settings::get<Ratio>(const SettingKey key) const
+{
+    return get<double>(key) / 100.0; // The settings are all in percentages.
+}
+
+template<>
+Duration Settings::get<Duration>(const SettingKey key) const
+{
+    return get<double>(key);
+}
+
+// The other types are parsed from the string value by their name.
+template std::vector<ExtruderTrain*> Settings::get<std::vector<ExtruderTrain*>>(const SettingKey key) const;
+template DraftShieldHeightLimitation Settings::get<DraftShieldHeightLimitation>(const SettingKey key) const;
+template FlowTempGraph Settings::get<FlowTempGraph>(const SettingKey key) const;
+template Polygons Settings::get<Polygons>(const SettingKey key) const;
+template Matrix4x3D Settings::get<Matrix4x3D>(const SettingKey key) const;
+template EGCodeFlavor Settings::get<EGCodeFlavor>(const SettingKey key) const;
+template EFillMethod Settings::get<EFillMethod>(const SettingKey key) const;
+template EPlatformAdhesion Settings::get<EPlatformAdhesion>(const SettingKey key) const;
+template ESupportType Settings::get<ESupportType>(const SettingKey key) const;
+template ESupportStructure Settings::get<ESupportStructure>(const SettingKey key) const;
+template EZSeamType Settings::get<EZSeamType>(const SettingKey key) const;
+template EZSeamCornerPrefType Settings::get<EZSeamCornerPrefType>(const SettingKey key) const;
+template ESurfaceMode Settings::get<ESurfaceMode>(const SettingKey key) const;
+template FillPerimeterGapMode Settings::get<FillPerimeterGapMode>(const SettingKey key) const;
+template BuildPlateShape Settings::get<BuildPlateShape>(const SettingKey key) const;
+template CombingMode Settings::get<CombingMode>(const SettingKey key) const;
+template SupportDistPriority Settings::get<SupportDistPriority>(const SettingKey key) const;
+template SlicingTolerance Settings::get<SlicingTolerance>(const SettingKey key) const;
+template InsetDirection Settings::get<InsetDirection>(const SettingKey key) const;
+template PrimeTowerMethod Settings::get<PrimeTowerMethod>(const SettingKey key) const;
+template BrimLocation Settings::get<BrimLocation>(const SettingKey key) const;
+template std::vector<double> Settings::get<std::vector<double>>(const SettingKey key) const;
+template std::vector<int> Settings::get<std::vector<int>>(const SettingKey key) const;
+template std::vector<AngleDegrees> Settings::get<std::vector<AngleDegrees>>(const SettingKey key) const;
+
 const std::string Settings::getAllSettingsString() const
 {
     std::stringstream sstream;
@@ -789,6 +1057,7 @@ bool Settings::has(const std::string& key) const
 
 void Settings::setParent(Settings* new_parent)
 {
+    thaw();
     parent = new_parent;
 }
 
@@ -830,4 +1099,9 @@ std::vector<std::string> Settings::getKeys() const
     return ranges::views::keys(settings) | ranges::to_vector;
 }
 
+const std::unordered_map<std::string, std::string>& Settings::getOwnSettings() const
+{
+    return settings;
+}
+
 } // namespace cura
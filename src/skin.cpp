@@ -7,13 +7,16 @@
 
 #include "Application.h" //To get settings.
 #include "ExtruderTrain.h"
+#include "OutlineIntersectionCache.h"
 #include "Slice.h"
 #include "WallToolPaths.h"
+#include "WallToolPathsCache.h"
 #include "infill.h"
 #include "settings/EnumSettings.h" //For EFillMethod.
 #include "settings/types/Angle.h" //For the infill support angle.
 #include "settings/types/Ratio.h"
 #include "sliceDataStorage.h"
+#include "utils/ThreadPool.h"
 #include "utils/math.h"
 #include "utils/polygonUtils.h"
 
@@ -33,7 +36,7 @@ coord_t SkinInfillAreaComputation::getSkinLineWidth(const SliceMeshStorage& mesh
     return skin_line_width;
 }
 
-SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill)
+SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr, SliceMeshStorage& mesh, bool process_infill, OutlineIntersectionCache& outline_intersections)
     : layer_nr_(layer_nr)
     , mesh_(mesh)
     , bottom_layer_count_(mesh.settings.get<size_t>("bottom_layers"))
@@ -42,6 +45,7 @@ SkinInfillAreaComputation::SkinInfillAreaComputation(const LayerIndex& layer_nr,
     , skin_line_width_(getSkinLineWidth(mesh, layer_nr))
     , no_small_gaps_heuristic_(mesh.settings.get<bool>("skin_no_small_gaps_heuristic"))
     , process_infill_(process_infill)
+    , outline_intersections_(outline_intersections)
     , top_skin_preshrink_(mesh.settings.get<coord_t>("top_skin_preshrink"))
     , bottom_skin_preshrink_(mesh.settings.get<coord_t>("bottom_skin_preshrink"))
     , top_skin_expand_distance_(mesh.settings.get<coord_t>("top_skin_expand_distance"))
@@ -73,6 +77,21 @@ Polygons SkinInfillAreaComputation::getOutlineOnLayer(const SliceLayerPart& part
     return result;
 }
 
+/*
+ * This function is executed in a parallel region based on layer_nr.
+ * When modifying make sure any changes does not introduce data races.
+ *
+ * this function may only read/write the skin and infill from the *current* layer.
+ */
+Polygons SkinInfillAreaComputation::getOutlineOnLayers(const SliceLayerPart& part_here, const LayerIndex first_layer_nr, const LayerIndex last_layer_nr)
+{
+    if (first_layer_nr == last_layer_nr)
+    {
+        return getOutlineOnLayer(part_here, first_layer_nr);
+    }
+    return outline_intersections_.intersection(first_layer_nr, last_layer_nr);
+}
+
 /*
  * This function is executed in a parallel region based on layer_nr.
  * When modifying make sure any changes does not introduce data races.
@@ -182,14 +201,8 @@ void SkinInfillAreaComputation::calculateBottomSkin(const SliceLayerPart& part,
         return; // don't subtract anything form the downskin
     }
     LayerIndex bottom_check_start_layer_idx{ std::max(LayerIndex{ 0 }, LayerIndex{ layer_nr_ - bottom_layer_count_ }) };
-    Polygons not_air = getOutlineOnLayer(part, bottom_check_start_layer_idx);
-    if (! no_small_gaps_heuristic_)
-    {
-        for (int downskin_layer_nr = bottom_check_start_layer_idx + 1; downskin_layer_nr < layer_nr_; downskin_layer_nr++)
-        {
-            not_air = not_air.intersection(getOutlineOnLayer(part, downskin_layer_nr));
-        }
-    }
+    Polygons not_air = no_small_gaps_heuristic_ ? getOutlineOnLayer(part, bottom_check_start_layer_idx)
+                                                : getOutlineOnLayers(part, bottom_check_start_layer_idx, std::max(bottom_check_start_layer_idx, LayerIndex{ layer_nr_ - 1 }));
     const double min_infill_area = mesh_.settings.get<double>("min_infill_area");
     if (min_infill_area > 0.0)
     {
@@ -207,14 +220,8 @@ void SkinInfillAreaComputation::calculateTopSkin(const SliceLayerPart& part, Pol
         return;
     }
 
-    Polygons not_air = getOutlineOnLayer(part, layer_nr_ + top_layer_count_);
-    if (! no_small_gaps_heuristic_)
-    {
-        for (int upskin_layer_nr = layer_nr_ + 1; upskin_layer_nr < layer_nr_ + top_layer_count_; upskin_layer_nr++)
-        {
-            not_air = not_air.intersection(getOutlineOnLayer(part, upskin_layer_nr));
-        }
-    }
+    const LayerIndex top_check_end_layer_idx{ layer_nr_ + top_layer_count_ };
+    Polygons not_air = no_small_gaps_heuristic_ ? getOutlineOnLayer(part, top_check_end_layer_idx) : getOutlineOnLayers(part, layer_nr_ + 1, top_check_end_layer_idx);
 
     const double min_infill_area = mesh_.settings.get<double>("min_infill_area");
     if (min_infill_area > 0.0)
@@ -350,15 +357,9 @@ void SkinInfillAreaComputation::generateRoofingFillAndSkinFill(SliceLayerPart& p
  */
 Polygons SkinInfillAreaComputation::generateFilledAreaAbove(SliceLayerPart& part, size_t roofing_layer_count)
 {
-    Polygons filled_area_above = getOutlineOnLayer(part, layer_nr_ + roofing_layer_count);
-    if (! no_small_gaps_heuristic_)
-    {
-        for (int layer_nr_above = layer_nr_ + 1; layer_nr_above < layer_nr_ + roofing_layer_count; layer_nr_above++)
-        {
-            Polygons outlines_above = getOutlineOnLayer(part, layer_nr_above);
-            filled_area_above = filled_area_above.intersection(outlines_above);
-        }
-    }
+    const LayerIndex highest_roofing_layer{ layer_nr_ + roofing_layer_count };
+    Polygons filled_area_above = no_small_gaps_heuristic_ ? getOutlineOnLayer(part, highest_roofing_layer)
+                                                          : getOutlineOnLayers(part, std::min(LayerIndex{ layer_nr_ + 1 }, highest_roofing_layer), highest_roofing_layer);
     if (layer_nr_ > 0)
     {
         // if the skin has air below it then cutting it into regions could cause a region
@@ -390,19 +391,12 @@ Polygons SkinInfillAreaComputation::generateFilledAreaBelow(SliceLayerPart& part
     {
         return {};
     }
-    const int lowest_flooring_layer = layer_nr_ - flooring_layer_count;
-    Polygons filled_area_below = getOutlineOnLayer(part, lowest_flooring_layer);
-
-    if (! no_small_gaps_heuristic_)
+    const LayerIndex lowest_flooring_layer{ layer_nr_ - flooring_layer_count };
+    if (no_small_gaps_heuristic_)
     {
-        const int next_lowest_flooring_layer = lowest_flooring_layer + 1;
-        for (int layer_nr_below = next_lowest_flooring_layer; layer_nr_below < layer_nr_; layer_nr_below++)
-        {
-            Polygons outlines_below = getOutlineOnLayer(part, layer_nr_below);
-            filled_area_below = filled_area_below.intersection(outlines_below);
-        }
+        return getOutlineOnLayer(part, lowest_flooring_layer);
     }
-    return filled_area_below;
+    return getOutlineOnLayers(part, lowest_flooring_layer, std::max(lowest_flooring_layer, LayerIndex{ layer_nr_ - 1 }));
 }
 
 void SkinInfillAreaComputation::generateInfillSupport(SliceMeshStorage& mesh)
@@ -468,73 +462,100 @@ void SkinInfillAreaComputation::generateGradualInfill(SliceMeshStorage& mesh)
     const auto infill_wall_count = mesh.settings.get<size_t>("infill_wall_line_count");
     const auto infill_wall_width = mesh.settings.get<coord_t>("infill_line_width");
     const auto infill_overlap = mesh.settings.get<coord_t>("infill_overlap_mm");
-    for (LayerIndex layer_idx = 0; layer_idx < static_cast<LayerIndex>(mesh.layers.size()); layer_idx++)
-    { // loop also over layers which don't contain infill cause of bottom_ and top_layer to initialize their infill_area_per_combine_per_density
-        SliceLayer& layer = mesh.layers[layer_idx];
-
-        for (SliceLayerPart& part : layer.parts)
-        {
-            assert((part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is supposed to be uninitialized"));
-
-            const Polygons& infill_area = Infill::generateWallToolPaths(
-                part.infill_wall_toolpaths,
-                part.getOwnInfillArea(),
-                infill_wall_count,
-                infill_wall_width,
-                infill_overlap,
-                mesh.settings,
-                layer_idx,
-                SectionType::SKIN);
-
-            if (infill_area.empty() || layer_idx < mesh_min_layer || layer_idx > mesh_max_layer)
-            { // initialize infill_area_per_combine_per_density empty
-                part.infill_area_per_combine_per_density.emplace_back(); // create a new infill_area_per_combine
-                part.infill_area_per_combine_per_density.back().emplace_back(); // put empty infill area in the newly constructed infill_area_per_combine
-                // note: no need to copy part.infill_area, cause it's the empty vector anyway
-                continue;
-            }
-            Polygons less_dense_infill = infill_area; // one step less dense with each infill_step
-            for (size_t infill_step = 0; infill_step < max_infill_steps; infill_step++)
+    // The infill areas of consecutive layers are often the same, and then so are their walls.
+    WallToolPathsCache infill_walls_cache;
+    // Each layer only writes to its own parts, and only reads the own infill areas of the layers above it.
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        { // loop also over layers which don't contain infill cause of bottom_ and top_layer to initialize their infill_area_per_combine_per_density
+            const LayerIndex layer_idx = layer_nr;
+            SliceLayer& layer = mesh.layers[layer_idx];
+
+            for (SliceLayerPart& part : layer.parts)
             {
-                LayerIndex min_layer = layer_idx + infill_step * gradual_infill_step_layer_count + static_cast<size_t>(layer_skip_count);
-                LayerIndex max_layer = layer_idx + (infill_step + 1) * gradual_infill_step_layer_count;
-
-                for (double upper_layer_idx = min_layer; upper_layer_idx <= max_layer; upper_layer_idx += layer_skip_count)
+                assert((part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is supposed to be uninitialized"));
+
+                const Polygons& infill_area = Infill::generateWallToolPaths(
+                    part.infill_wall_toolpaths,
+                    part.getOwnInfillArea(),
+                    infill_wall_count,
+                    infill_wall_width,
+                    infill_overlap,
+                    mesh.settings,
+                    layer_idx,
+                    SectionType::SKIN,
+                    &infill_walls_cache);
+
+                if (infill_area.empty() || layer_idx < mesh_min_layer || layer_idx > mesh_max_layer)
+                { // initialize infill_area_per_combine_per_density empty
+                    part.infill_area_per_combine_per_density.emplace_back(); // create a new infill_area_per_combine
+                    part.infill_area_per_combine_per_density.back().emplace_back(); // put empty infill area in the newly constructed infill_area_per_combine
+                    // note: no need to copy part.infill_area, cause it's the empty vector anyway
+                    continue;
+                }
+                Polygons less_dense_infill = infill_area; // one step less dense with each infill_step
+                for (size_t infill_step = 0; infill_step < max_infill_steps; infill_step++)
                 {
-                    if (upper_layer_idx >= mesh.layers.size())
-                    {
-                        less_dense_infill.clear();
-                        break;
-                    }
-                    const SliceLayer& upper_layer = mesh.layers[static_cast<size_t>(upper_layer_idx)];
-                    Polygons relevent_upper_polygons;
-                    for (const SliceLayerPart& upper_layer_part : upper_layer.parts)
+                    LayerIndex min_layer = layer_idx + infill_step * gradual_infill_step_layer_count + static_cast<size_t>(layer_skip_count);
+                    LayerIndex max_layer = layer_idx + (infill_step + 1) * gradual_infill_step_layer_count;
+
+                    for (double upper_layer_idx = min_layer; upper_layer_idx <= max_layer; upper_layer_idx += layer_skip_count)
                     {
-                        if (! upper_layer_part.boundaryBox.hit(part.boundaryBox))
+                        if (upper_layer_idx >= mesh.layers.size())
                         {
-                            continue;
+                            less_dense_infill.clear();
+                            break;
                         }
-                        relevent_upper_polygons.add(upper_layer_part.getOwnInfillArea());
+                        const SliceLayer& upper_layer = mesh.layers[static_cast<size_t>(upper_layer_idx)];
+                        Polygons relevent_upper_polygons;
+                        for (const SliceLayerPart& upper_layer_part : upper_layer.parts)
+                        {
+                            if (! upper_layer_part.boundaryBox.hit(part.boundaryBox))
+                            {
+                                continue;
+                            }
+                            relevent_upper_polygons.add(upper_layer_part.getOwnInfillArea());
+                        }
+                        less_dense_infill = less_dense_infill.intersection(relevent_upper_polygons);
+                    }
+                    if (less_dense_infill.empty())
+                    {
+                        break;
                     }
-                    less_dense_infill = less_dense_infill.intersection(relevent_upper_polygons);
+                    // add new infill_area_per_combine for the current density
+                    part.infill_area_per_combine_per_density.emplace_back();
+                    std::vector<Polygons>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
+                    const Polygons more_dense_infill = infill_area.difference(less_dense_infill);
+                    infill_area_per_combine_current_density.push_back(more_dense_infill);
                 }
-                if (less_dense_infill.empty())
+                if (part.infill_area_per_combine_per_density.empty() && ! part.infill_area_own && infill_wall_count == 0)
                 {
-                    break;
+                    continue; // The only area is the infill_area itself, which is copied when the layer is planned.
                 }
-                // add new infill_area_per_combine for the current density
                 part.infill_area_per_combine_per_density.emplace_back();
                 std::vector<Polygons>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
-                const Polygons more_dense_infill = infill_area.difference(less_dense_infill);
-                infill_area_per_combine_current_density.push_back(more_dense_infill);
+                infill_area_per_combine_current_density.push_back(infill_area);
+                assert(! part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is now initialized");
             }
-            part.infill_area_per_combine_per_density.emplace_back();
-            std::vector<Polygons>& infill_area_per_combine_current_density = part.infill_area_per_combine_per_density.back();
-            infill_area_per_combine_current_density.push_back(infill_area);
-            part.infill_area_own = std::nullopt; // clear infill_area_own, it's not needed any more.
-            assert(! part.infill_area_per_combine_per_density.empty() && "infill_area_per_combine_per_density is now initialized");
-        }
-    }
+        });
+
+    // The layers below may still have been reading infill_area_own above, so it can only be cleared once all layers are done.
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
+        {
+            for (SliceLayerPart& part : mesh.layers[layer_nr].parts)
+            {
+                // Only the parts with infill got their densities computed. The ones that were left empty have no own infill area.
+                if (! part.infill_area_per_combine_per_density.empty() && ! part.infill_area_per_combine_per_density.back().front().empty())
+                {
+                    part.infill_area_own = std::nullopt; // clear infill_area_own, it's not needed any more.
+                }
+            }
+        });
 }
 
 void SkinInfillAreaComputation::combineInfillLayers(SliceMeshStorage& mesh)
@@ -565,65 +586,86 @@ void SkinInfillAreaComputation::combineInfillLayers(SliceMeshStorage& mesh)
     min_layer -= min_layer % amount; // Round upwards to the nearest layer divisible by infill_sparse_combine.
     LayerIndex max_layer = static_cast<LayerIndex>(mesh.layers.size()) - 1 - mesh.settings.get<size_t>("top_layers");
     max_layer -= max_layer % amount; // Round downwards to the nearest layer divisible by infill_sparse_combine.
-    for (LayerIndex layer_idx = min_layer; layer_idx <= max_layer; layer_idx += amount) // Skip every few layers, but extrude more.
+    // Each group of combined layers is disjoint from all other groups, so the groups can be combined in parallel.
+    if (min_layer > max_layer)
     {
-        SliceLayer* layer = &mesh.layers[layer_idx];
-        for (size_t combine_count_here = 1; combine_count_here < amount; combine_count_here++)
+        return;
+    }
+    const size_t group_count = (max_layer - min_layer) / amount + 1;
+    // Combining moves areas between the layers, so the areas that were left to be made when planning are needed now.
+    cura::parallel_for<size_t>(
+        0,
+        mesh.layers.size(),
+        [&](const size_t layer_nr)
         {
-            if (layer_idx < static_cast<LayerIndex>(combine_count_here))
+            for (SliceLayerPart& part : mesh.layers[layer_nr].parts)
             {
-                break;
+                part.materializeInfillAreaPerCombinePerDensity();
             }
-
-            LayerIndex lower_layer_idx = layer_idx - combine_count_here;
-            if (lower_layer_idx < min_layer)
-            {
-                break;
-            }
-            SliceLayer* lower_layer = &mesh.layers[lower_layer_idx];
-            for (SliceLayerPart& part : layer->parts)
+        });
+    cura::parallel_for<size_t>(
+        0,
+        group_count,
+        [&](const size_t group_idx) // Skip every few layers, but extrude more.
+        {
+            const LayerIndex layer_idx = min_layer + group_idx * amount;
+            SliceLayer* layer = &mesh.layers[layer_idx];
+            for (size_t combine_count_here = 1; combine_count_here < amount; combine_count_here++)
             {
-                for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
-                { // go over each density of gradual infill (these density areas overlap!)
-                    std::vector<Polygons>& infill_area_per_combine = part.infill_area_per_combine_per_density[density_idx];
-                    Polygons result;
-                    for (SliceLayerPart& lower_layer_part : lower_layer->parts)
-                    {
-                        if (part.boundaryBox.hit(lower_layer_part.boundaryBox))
+                if (layer_idx < static_cast<LayerIndex>(combine_count_here))
+                {
+                    break;
+                }
+
+                LayerIndex lower_layer_idx = layer_idx - combine_count_here;
+                if (lower_layer_idx < min_layer)
+                {
+                    break;
+                }
+                SliceLayer* lower_layer = &mesh.layers[lower_layer_idx];
+                for (SliceLayerPart& part : layer->parts)
+                {
+                    for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density.size(); density_idx++)
+                    { // go over each density of gradual infill (these density areas overlap!)
+                        std::vector<Polygons>& infill_area_per_combine = part.infill_area_per_combine_per_density[density_idx];
+                        Polygons result;
+                        for (SliceLayerPart& lower_layer_part : lower_layer->parts)
                         {
-                            Polygons intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.infill_area).offset(-200).offset(200);
-                            result.add(intersection); // add area to be thickened
-                            infill_area_per_combine[combine_count_here - 1]
-                                = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
-                            unsigned int max_lower_density_idx = density_idx;
-                            // Generally: remove only from *same density* areas on layer below
-                            // If there are no same density areas, then it's ok to print them anyway
-                            // Don't remove other density areas
-                            if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
-                            {
-                                // For the most dense areas on a given layer the density of that area is doubled.
-                                // This means that - if the lower layer has more densities -
-                                // all those lower density lines are included in the most dense of this layer.
-                                // We therefore compare the most dense are on this layer with all densities
-                                // of the lower layer with the same or higher density index
-                                max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density.size() - 1;
-                            }
-                            for (size_t lower_density_idx = density_idx;
-                                 lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density.size();
-                                 lower_density_idx++)
+                            if (part.boundaryBox.hit(lower_layer_part.boundaryBox))
                             {
-                                std::vector<Polygons>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density[lower_density_idx];
-                                lower_infill_area_per_combine[0]
-                                    = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                                Polygons intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.infill_area).offset(-200).offset(200);
+                                result.add(intersection); // add area to be thickened
+                                infill_area_per_combine[combine_count_here - 1]
+                                    = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
+                                unsigned int max_lower_density_idx = density_idx;
+                                // Generally: remove only from *same density* areas on layer below
+                                // If there are no same density areas, then it's ok to print them anyway
+                                // Don't remove other density areas
+                                if (density_idx == part.infill_area_per_combine_per_density.size() - 1)
+                                {
+                                    // For the most dense areas on a given layer the density of that area is doubled.
+                                    // This means that - if the lower layer has more densities -
+                                    // all those lower density lines are included in the most dense of this layer.
+                                    // We therefore compare the most dense are on this layer with all densities
+                                    // of the lower layer with the same or higher density index
+                                    max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density.size() - 1;
+                                }
+                                for (size_t lower_density_idx = density_idx;
+                                     lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density.size();
+                                     lower_density_idx++)
+                                {
+                                    std::vector<Polygons>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density[lower_density_idx];
+                                    lower_infill_area_per_combine[0]
+                                        = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                                }
                             }
                         }
-                    }
 
-                    infill_area_per_combine.push_back(result);
+                        infill_area_per_combine.push_back(result);
+                    }
                 }
             }
-        }
-    }
+        });
 }
 
 /*
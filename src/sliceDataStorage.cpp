@@ -20,6 +20,48 @@
 namespace cura
 {
 
+namespace
+{
+
+//! Free what a vector reserved for more elements than it has, and tell how many bytes that was.
+template<typename T>
+size_t shrinkVector(std::vector<T>& vector)
+{
+    const size_t capacity = vector.capacity();
+    vector.shrink_to_fit();
+    return (capacity - vector.capacity()) * sizeof(T);
+}
+
+size_t shrinkAreasPerCombinePerDensity(std::vector<std::vector<Polygons>>& areas_per_combine_per_density)
+{
+    size_t released_bytes = shrinkVector(areas_per_combine_per_density);
+    for (std::vector<Polygons>& areas_per_combine : areas_per_combine_per_density)
+    {
+        released_bytes += shrinkVector(areas_per_combine);
+        for (Polygons& area : areas_per_combine)
+        {
+            released_bytes += area.shrinkToFit();
+        }
+    }
+    return released_bytes;
+}
+
+size_t shrinkToolpaths(std::vector<VariableWidthLines>& toolpaths)
+{
+    size_t released_bytes = shrinkVector(toolpaths);
+    for (VariableWidthLines& lines : toolpaths)
+    {
+        released_bytes += shrinkVector(lines);
+        for (ExtrusionLine& line : lines)
+        {
+            released_bytes += line.shrinkToFit();
+        }
+    }
+    return released_bytes;
+}
+
+} // namespace
+
 SupportStorage::SupportStorage()
     : generated(false)
     , layer_nr_max_filled_layer(-1)
@@ -64,6 +106,45 @@ bool SliceLayerPart::hasWallAtInsetIndex(size_t inset_idx) const
     return false;
 }
 
+const std::vector<std::vector<Polygons>>& SliceLayerPart::getInfillAreaPerCombinePerDensity() const
+{
+    if (! infill_area_per_combine_per_density.empty())
+    {
+        return infill_area_per_combine_per_density;
+    }
+    if (lazy_infill_area_per_combine_per_density_.empty())
+    {
+        lazy_infill_area_per_combine_per_density_.emplace_back().push_back(infill_area);
+    }
+    return lazy_infill_area_per_combine_per_density_;
+}
+
+void SliceLayerPart::materializeInfillAreaPerCombinePerDensity()
+{
+    if (infill_area_per_combine_per_density.empty())
+    {
+        infill_area_per_combine_per_density = getInfillAreaPerCombinePerDensity();
+        lazy_infill_area_per_combine_per_density_.clear();
+    }
+}
+
+size_t SliceLayerPart::releaseInfillAreaPerCombinePerDensity()
+{
+    size_t released_bytes = 0;
+    for (std::vector<std::vector<Polygons>>* areas : { &infill_area_per_combine_per_density, &lazy_infill_area_per_combine_per_density_ })
+    {
+        for (const std::vector<Polygons>& infill_area_per_combine : *areas)
+        {
+            for (const Polygons& area : infill_area_per_combine)
+            {
+                released_bytes += area.pointCount() * sizeof(Point2LL);
+            }
+        }
+        std::vector<std::vector<Polygons>>().swap(*areas);
+    }
+    return released_bytes;
+}
+
 SliceLayer::~SliceLayer()
 {
 }
@@ -85,9 +166,97 @@ void SliceLayer::getOutlines(Polygons& result, bool external_polys_only) const
         }
         else
         {
-            result.add(part.print_outline);
+            result.add(part.print_outline.toPolygons());
+        }
+    }
+}
+
+size_t SliceLayer::release()
+{
+    const size_t footprint = getMemoryFootprint();
+    std::vector<SliceLayerPart>().swap(parts); // Unlike clear(), this frees the memory of the vector.
+    openPolyLines = Polygons();
+    top_surface = TopSurface();
+    bottom_surface = Polygons();
+    return footprint;
+}
+
+size_t SliceLayer::shrinkToFit()
+{
+    size_t released_bytes = shrinkVector(parts) + openPolyLines.shrinkToFit() + top_surface.areas.shrinkToFit() + bottom_surface.shrinkToFit();
+    for (SliceLayerPart& part : parts)
+    {
+        for (Polygons* area : { static_cast<Polygons*>(&part.outline), &part.spiral_wall, &part.inner_area, &part.infill_area })
+        {
+            released_bytes += area->shrinkToFit();
+        }
+        if (part.infill_area_own)
+        {
+            released_bytes += part.infill_area_own->shrinkToFit();
+        }
+        released_bytes += shrinkAreasPerCombinePerDensity(part.infill_area_per_combine_per_density);
+        released_bytes += shrinkVector(part.skin_parts);
+        for (SkinPart& skin_part : part.skin_parts)
+        {
+            for (Polygons* area : { static_cast<Polygons*>(&skin_part.outline),
+                                    &skin_part.skin_fill,
+                                    &skin_part.roofing_fill,
+                                    &skin_part.top_most_surface_fill,
+                                    &skin_part.bottom_most_surface_fill })
+            {
+                released_bytes += area->shrinkToFit();
+            }
         }
+        released_bytes += shrinkToolpaths(part.wall_toolpaths) + shrinkToolpaths(part.infill_wall_toolpaths);
     }
+    return released_bytes;
+}
+
+size_t SliceLayer::getMemoryFootprint() const
+{
+    size_t footprint = parts.capacity() * sizeof(SliceLayerPart) + (openPolyLines.pointCount() + top_surface.areas.pointCount() + bottom_surface.pointCount()) * sizeof(Point2LL);
+    for (const SliceLayerPart& part : parts)
+    {
+        footprint += part.print_outline.getMemoryFootprint();
+        for (const Polygons* area : { static_cast<const Polygons*>(&part.outline), &part.spiral_wall, &part.inner_area, &part.infill_area })
+        {
+            footprint += area->pointCount() * sizeof(Point2LL);
+        }
+        if (part.infill_area_own)
+        {
+            footprint += part.infill_area_own->pointCount() * sizeof(Point2LL);
+        }
+        for (const std::vector<Polygons>& infill_area_per_combine : part.infill_area_per_combine_per_density)
+        {
+            for (const Polygons& infill_area : infill_area_per_combine)
+            {
+                footprint += infill_area.pointCount() * sizeof(Point2LL);
+            }
+        }
+        footprint += part.skin_parts.capacity() * sizeof(SkinPart);
+        for (const SkinPart& skin_part : part.skin_parts)
+        {
+            for (const Polygons* area : { static_cast<const Polygons*>(&skin_part.outline),
+                                          &skin_part.skin_fill,
+                                          &skin_part.roofing_fill,
+                                          &skin_part.top_most_surface_fill,
+                                          &skin_part.bottom_most_surface_fill })
+            {
+                footprint += area->pointCount() * sizeof(Point2LL);
+            }
+        }
+        for (const std::vector<VariableWidthLines>* toolpaths : { &part.wall_toolpaths, &part.infill_wall_toolpaths })
+        {
+            for (const VariableWidthLines& walls : *toolpaths)
+            {
+                for (const ExtrusionLine& wall : walls)
+                {
+                    footprint += wall.junctions_.capacity() * sizeof(ExtrusionJunction);
+                }
+            }
+        }
+    }
+    return footprint;
 }
 
 SliceMeshStorage::SliceMeshStorage(Mesh* mesh, const size_t slice_layer_count)
@@ -102,6 +271,25 @@ SliceMeshStorage::SliceMeshStorage(Mesh* mesh, const size_t slice_layer_count)
     layers.resize(slice_layer_count);
 }
 
+SliceMeshStorage::SliceMeshStorage(Mesh* mesh, SliceMeshStorage&& previous)
+    : settings(mesh->settings_)
+    , layers(std::move(previous.layers))
+    , mesh_name(mesh->mesh_name_)
+    , layer_nr_max_filled_layer(previous.layer_nr_max_filled_layer)
+    , infill_angles(std::move(previous.infill_angles))
+    , roofing_angles(std::move(previous.roofing_angles))
+    , skin_angles(std::move(previous.skin_angles))
+    , overhang_areas(std::move(previous.overhang_areas))
+    , full_overhang_areas(std::move(previous.full_overhang_areas))
+    , overhang_points(std::move(previous.overhang_points))
+    , bounding_box(previous.bounding_box)
+    , base_subdiv_cube(std::move(previous.base_subdiv_cube))
+    , cross_fill_provider(std::move(previous.cross_fill_provider))
+    , lightning_generator(std::move(previous.lightning_generator))
+    , retraction_wipe_config(previous.retraction_wipe_config)
+{
+}
+
 
 bool SliceMeshStorage::getExtruderIsUsed(const size_t extruder_nr) const
 {
@@ -242,6 +430,61 @@ Point2LL SliceMeshStorage::getZSeamHint() const
     return pos;
 }
 
+size_t SliceDataStorage::releaseMeshLayer(const LayerIndex layer_nr)
+{
+    size_t released_bytes = 0;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        if (layer_nr < LayerIndex(mesh->layers.size()))
+        {
+            released_bytes += mesh->layers[layer_nr].release();
+        }
+    }
+    if (layer_nr < LayerIndex(spiralize_wall_outlines.size()))
+    {
+        spiralize_wall_outlines[layer_nr] = nullptr; // It pointed into the parts of the layer.
+    }
+    if (layer_nr < LayerIndex(oozeShield.size()))
+    {
+        released_bytes += oozeShield[layer_nr].pointCount() * sizeof(Point2LL);
+        oozeShield[layer_nr] = Polygons();
+    }
+    return released_bytes;
+}
+
+size_t SliceDataStorage::releaseInfillAreaPerCombinePerDensity(const LayerIndex layer_nr)
+{
+    size_t released_bytes = 0;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        if (layer_nr >= 0 && layer_nr < LayerIndex(mesh->layers.size()))
+        {
+            for (SliceLayerPart& part : mesh->layers[layer_nr].parts)
+            {
+                released_bytes += part.releaseInfillAreaPerCombinePerDensity();
+            }
+        }
+    }
+    return released_bytes;
+}
+
+size_t SliceDataStorage::getMemoryFootprint() const
+{
+    size_t footprint = 0;
+    for (const std::shared_ptr<SliceMeshStorage>& mesh : meshes)
+    {
+        for (const SliceLayer& layer : mesh->layers)
+        {
+            footprint += layer.getMemoryFootprint();
+        }
+    }
+    for (const SupportLayer& layer : support.supportLayers)
+    {
+        footprint += layer.getMemoryFootprint();
+    }
+    return footprint;
+}
+
 std::vector<RetractionAndWipeConfig> SliceDataStorage::initializeRetractionAndWipeConfigs()
 {
     std::vector<RetractionAndWipeConfig> ret;
@@ -252,6 +495,7 @@ std::vector<RetractionAndWipeConfig> SliceDataStorage::initializeRetractionAndWi
 SliceDataStorage::SliceDataStorage()
     : print_layer_count(0)
     , retraction_wipe_config_per_extruder(initializeRetractionAndWipeConfigs())
+    , model_offsets(*this)
     , max_print_height_second_to_last_extruder(-1)
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
@@ -756,6 +1000,57 @@ void SupportLayer::excludeAreasFromSupportInfillAreas(const Polygons& exclude_po
     }
 }
 
+size_t SupportLayer::getMemoryFootprint() const
+{
+    size_t footprint = support_infill_parts.capacity() * sizeof(SupportInfillPart);
+    for (const Polygons* area : { &support_bottom, &support_roof, &support_fractional_roof, &support_mesh_drop_down, &support_mesh, &anti_overhang })
+    {
+        footprint += area->pointCount() * sizeof(Point2LL);
+    }
+    for (const SupportInfillPart& part : support_infill_parts)
+    {
+        footprint += part.outline_.pointCount() * sizeof(Point2LL);
+        for (const std::vector<Polygons>& infill_area_per_combine : part.infill_area_per_combine_per_density_)
+        {
+            for (const Polygons& infill_area : infill_area_per_combine)
+            {
+                footprint += infill_area.pointCount() * sizeof(Point2LL);
+            }
+        }
+        for (const VariableWidthLines& walls : part.wall_toolpaths_)
+        {
+            for (const ExtrusionLine& wall : walls)
+            {
+                footprint += wall.junctions_.capacity() * sizeof(ExtrusionJunction);
+            }
+        }
+    }
+    return footprint;
+}
+
+size_t SupportLayer::shrinkToFit()
+{
+    size_t released_bytes = shrinkVector(support_infill_parts);
+    for (Polygons* area : { &support_bottom, &support_roof, &support_fractional_roof, &support_mesh_drop_down, &support_mesh, &anti_overhang })
+    {
+        released_bytes += area->shrinkToFit();
+    }
+    for (SupportInfillPart& part : support_infill_parts)
+    {
+        released_bytes += part.outline_.shrinkToFit();
+        released_bytes += shrinkAreasPerCombinePerDensity(part.infill_area_per_combine_per_density_);
+        released_bytes += shrinkToolpaths(part.wall_toolpaths_);
+    }
+    return released_bytes;
+}
+
+size_t SupportLayer::release()
+{
+    const size_t footprint = getMemoryFootprint();
+    *this = SupportLayer(); // Unlike clear(), this frees the memory of the vectors.
+    return footprint;
+}
+
 void SupportLayer::fillInfillParts(
     const LayerIndex layer_nr,
     const std::vector<Polygons>& support_fill_per_layer,
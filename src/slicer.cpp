@@ -5,6 +5,7 @@
 
 #include <algorithm> // remove_if
 #include <numbers>
+#include <set>
 #include <stdio.h>
 
 #include <scripta/logger.h>
@@ -18,6 +19,7 @@
 #include "settings/EnumSettings.h"
 #include "settings/types/LayerIndex.h"
 #include "utils/Simplify.h"
+#include "utils/SparseLineGrid.h"
 #include "utils/SparsePointGridInclusive.h"
 #include "utils/ThreadPool.h"
 #include "utils/gettime.h"
@@ -29,9 +31,43 @@ namespace cura
 constexpr int largest_neglected_gap_first_phase = MM2INT(0.01); //!< distance between two line segments regarded as connected
 constexpr int largest_neglected_gap_second_phase = MM2INT(0.02); //!< distance between two line segments regarded as connected
 constexpr int max_stitch1 = MM2INT(10.0); //!< maximal distance stitched between open polylines to form polygons
+constexpr int64_t max_band_segment_count = 1 << 23; //!< maximal number of segments in memory at once while slicing a mesh (each takes about 60 bytes)
+constexpr coord_t gap_closer_snap_distance = MM2INT(0.1); //!< maximal distance from a polyline end to a polygon for extensive stitching to route over that polygon
+constexpr coord_t gap_closer_cell_size = MM2INT(1.0); //!< cell size of the grid of polygon segments used by extensive stitching
+constexpr int64_t max_extensive_stitch_work = 1 << 25; //!< maximal number of polygon vertices walked over per layer by extensive stitching before falling back to basic stitching
+
+/*!
+ * Whether \p input projects onto the line segment from \p p0 to \p p1, and is
+ * then within the gap_closer_snap_distance from it.
+ */
+static bool isCloseToPolygonSegment(const Point2LL& p0, const Point2LL& p1, const Point2LL& input)
+{
+    // Q = A + Normal( B - A ) * ((( B - A ) dot ( P - A )) / VSize( A - B ));
+    Point2LL pDiff = p1 - p0;
+    int64_t lineLength = vSize(pDiff);
+    if (lineLength > 1)
+    {
+        int64_t distOnLine = dot(pDiff, input - p0) / lineLength;
+        if (distOnLine >= 0 && distOnLine <= lineLength)
+        {
+            Point2LL q = p0 + pDiff * distOnLine / lineLength;
+            return shorterThen(q - input, gap_closer_snap_distance);
+        }
+    }
+    return false;
+}
 
 void SlicerLayer::makeBasicPolygonLoops(Polygons& open_polylines)
 {
+    thread_local std::vector<int> face_indices; // Reused between all layers that are connected by this thread.
+    face_indices.clear();
+    for (const SlicerSegment& segment : segments)
+    {
+        face_indices.push_back(segment.faceIndex);
+    }
+    assert(std::is_sorted(face_indices.begin(), face_indices.end()) && "Slicer::buildSegments creates the segments in order of face index.");
+    segment_face_indices = face_indices;
+
     for (size_t start_segment_idx = 0; start_segment_idx < segments.size(); start_segment_idx++)
     {
         if (! segments[start_segment_idx].addedToPolygon)
@@ -39,8 +75,9 @@ void SlicerLayer::makeBasicPolygonLoops(Polygons& open_polylines)
             makeBasicPolygonLoop(open_polylines, start_segment_idx);
         }
     }
-    // Clear the segmentList to save memory, it is no longer needed after this point.
-    segments.clear();
+    // Release the segmentList to save memory, it is no longer needed after this point.
+    segment_face_indices = {};
+    segments = {};
 }
 
 void SlicerLayer::makeBasicPolygonLoop(Polygons& open_polylines, const size_t start_segment_idx)
@@ -66,12 +103,10 @@ void SlicerLayer::makeBasicPolygonLoop(Polygons& open_polylines, const size_t st
 
 int SlicerLayer::tryFaceNextSegmentIdx(const SlicerSegment& segment, const int face_idx, const size_t start_segment_idx) const
 {
-    decltype(face_idx_to_segment_idx.begin()) it;
-    auto it_end = face_idx_to_segment_idx.end();
-    it = face_idx_to_segment_idx.find(face_idx);
-    if (it != it_end)
+    const auto it = std::lower_bound(segment_face_indices.begin(), segment_face_indices.end(), face_idx);
+    if (it != segment_face_indices.end() && *it == face_idx)
     {
-        const int segment_idx = (*it).second;
+        const int segment_idx = it - segment_face_indices.begin();
         Point2LL p1 = segments[segment_idx].start;
         Point2LL diff = segment.end - p1;
         if (shorterThen(diff, largest_neglected_gap_first_phase))
@@ -541,111 +576,212 @@ void SlicerLayer::stitch_extensive(Polygons& open_polylines)
     //  And generate a path over this shortest bit to link up the 2 open polygons.
     //  (If these 2 open polygons are the same polygon, then the final result is a closed polyon)
 
+    // Index the segments of the polygons, so that finding the polygon that a polyline end touches doesn't have to go over all of them.
+    struct PolygonSegment
+    {
+        ClosePolygonResult location; // The segment runs from the point before pointIdx to pointIdx.
+        Point2LL from;
+        Point2LL to;
+    };
+    struct PolygonSegmentLocator
+    {
+        std::pair<Point2LL, Point2LL> operator()(const PolygonSegment& segment) const
+        {
+            return { segment.from, segment.to };
+        }
+    };
+    SparseLineGrid<PolygonSegment, PolygonSegmentLocator> segment_grid(gap_closer_cell_size);
+    size_t indexed_polygon_count = 0;
+
+    // Same as findPolygonPointClosestTo: the first segment in polygon order that the point is close to.
+    const auto find_closest_polygon_point = [&segment_grid](const Point2LL& input)
+    {
+        std::optional<ClosePolygonResult> result;
+        segment_grid.processNearby(
+            input,
+            2 * gap_closer_snap_distance,
+            [&result, &input](const PolygonSegment& segment)
+            {
+                const bool is_earlier = ! result || segment.location.polygonIdx < result->polygonIdx
+                                     || (segment.location.polygonIdx == result->polygonIdx && segment.location.pointIdx < result->pointIdx);
+                if (is_earlier && isCloseToPolygonSegment(segment.from, segment.to, input))
+                {
+                    result = segment.location;
+                }
+                return true;
+            });
+        return result;
+    };
+
+    // For each polyline, the polygon points that its start and its end are close to.
+    std::vector<std::optional<ClosePolygonResult>> start_closest(open_polylines.size());
+    std::vector<std::optional<ClosePolygonResult>> end_closest(open_polylines.size());
+    // For each polygon, the polylines of which the end is close to it, in order.
+    std::vector<std::set<size_t>> ends_per_polygon;
+
+    const auto update_termini = [&](const size_t polyline_idx)
+    {
+        if (end_closest[polyline_idx])
+        {
+            ends_per_polygon[end_closest[polyline_idx]->polygonIdx].erase(polyline_idx);
+        }
+        ConstPolygonRef polyline = open_polylines[polyline_idx];
+        if (polyline.empty())
+        {
+            start_closest[polyline_idx].reset();
+            end_closest[polyline_idx].reset();
+            return;
+        }
+        start_closest[polyline_idx] = find_closest_polygon_point(polyline[0]);
+        end_closest[polyline_idx] = find_closest_polygon_point(polyline.back());
+        if (end_closest[polyline_idx])
+        {
+            ends_per_polygon[end_closest[polyline_idx]->polygonIdx].insert(polyline_idx);
+        }
+    };
+
+    // Adds the polygons that were added since the last call to the grid. The polyline ends that weren't close to any polygon yet may be close to them.
+    const auto index_new_polygons = [&]()
+    {
+        for (; indexed_polygon_count < polygons.size(); indexed_polygon_count++)
+        {
+            ConstPolygonRef polygon = polygons[indexed_polygon_count];
+            for (size_t point_idx = 0; point_idx < polygon.size(); point_idx++)
+            {
+                segment_grid.insert(PolygonSegment{ { indexed_polygon_count, point_idx }, polygon[(point_idx + polygon.size() - 1) % polygon.size()], polygon[point_idx] });
+            }
+        }
+        ends_per_polygon.resize(polygons.size());
+        for (size_t polyline_idx = 0; polyline_idx < open_polylines.size(); polyline_idx++)
+        {
+            if (! start_closest[polyline_idx] || ! end_closest[polyline_idx])
+            {
+                update_termini(polyline_idx);
+            }
+        }
+    };
+    index_new_polygons();
+
+    int64_t work = 0; // The number of polygon vertices walked over to determine the length of gap closers.
     while (1)
     {
         unsigned int best_polyline_1_idx = -1;
         unsigned int best_polyline_2_idx = -1;
         std::optional<GapCloserResult> best_result;
-
-        for (unsigned int polyline_1_idx = 0; polyline_1_idx < open_polylines.size(); polyline_1_idx++)
+        const auto try_gap_closer = [&](const unsigned int polyline_1_idx, const unsigned int polyline_2_idx)
         {
-            PolygonRef polyline_1 = open_polylines[polyline_1_idx];
-            if (polyline_1.size() < 1)
-                continue;
-
+            const std::optional<GapCloserResult> res
+                = findPolygonGapCloser(open_polylines[polyline_1_idx][0], start_closest[polyline_1_idx], open_polylines[polyline_2_idx].back(), end_closest[polyline_2_idx]);
+            if (res)
             {
-                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_1.back());
-                if (res && (! best_result || res->len < best_result->len))
+                work += polygons[res->polygonIdx].size();
+                if (! best_result || res->len < best_result->len)
                 {
                     best_polyline_1_idx = polyline_1_idx;
-                    best_polyline_2_idx = polyline_1_idx;
+                    best_polyline_2_idx = polyline_2_idx;
                     best_result = res;
                 }
             }
+        };
 
-            for (unsigned int polyline_2_idx = 0; polyline_2_idx < open_polylines.size(); polyline_2_idx++)
-            {
-                PolygonRef polyline_2 = open_polylines[polyline_2_idx];
-                if (polyline_2.size() < 1 || polyline_1_idx == polyline_2_idx)
-                    continue;
+        // Only the polyline ends that are close to the same polygon can be connected.
+        for (unsigned int polyline_1_idx = 0; polyline_1_idx < open_polylines.size() && work <= max_extensive_stitch_work; polyline_1_idx++)
+        {
+            if (! start_closest[polyline_1_idx])
+                continue;
 
-                std::optional<GapCloserResult> res = findPolygonGapCloser(polyline_1[0], polyline_2.back());
-                if (res && (! best_result || res->len < best_result->len))
+            try_gap_closer(polyline_1_idx, polyline_1_idx);
+            for (const size_t polyline_2_idx : ends_per_polygon[start_closest[polyline_1_idx]->polygonIdx])
+            {
+                if (polyline_1_idx != polyline_2_idx)
                 {
-                    best_polyline_1_idx = polyline_1_idx;
-                    best_polyline_2_idx = polyline_2_idx;
-                    best_result = res;
+                    try_gap_closer(polyline_1_idx, polyline_2_idx);
                 }
             }
         }
 
-        if (best_result)
+        if (work > max_extensive_stitch_work)
+        {
+            spdlog::warn("Extensive stitching of the layer at height {} is taking too long. Falling back to basic stitching.", INT2MM(z));
+            stitch(open_polylines);
+            return;
+        }
+        if (! best_result)
+        {
+            break;
+        }
+
+        if (best_polyline_1_idx == best_polyline_2_idx)
         {
-            if (best_polyline_1_idx == best_polyline_2_idx)
+            if (best_result->pointIdxA == best_result->pointIdxB)
             {
-                if (best_result->pointIdxA == best_result->pointIdxB)
-                {
-                    polygons.add(open_polylines[best_polyline_1_idx]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
-                else if (best_result->AtoB)
-                {
-                    PolygonRef poly = polygons.newPoly();
-                    for (unsigned int j = best_result->pointIdxA; j != best_result->pointIdxB; j = (j + 1) % polygons[best_result->polygonIdx].size())
-                        poly.add(polygons[best_result->polygonIdx][j]);
-                    for (unsigned int j = open_polylines[best_polyline_1_idx].size() - 1; int(j) >= 0; j--)
-                        poly.add(open_polylines[best_polyline_1_idx][j]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
-                else
-                {
-                    unsigned int n = polygons.size();
-                    polygons.add(open_polylines[best_polyline_1_idx]);
-                    for (unsigned int j = best_result->pointIdxB; j != best_result->pointIdxA; j = (j + 1) % polygons[best_result->polygonIdx].size())
-                        polygons[n].add(polygons[best_result->polygonIdx][j]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
+                polygons.add(open_polylines[best_polyline_1_idx]);
+                open_polylines[best_polyline_1_idx].clear();
+            }
+            else if (best_result->AtoB)
+            {
+                PolygonRef poly = polygons.newPoly();
+                for (unsigned int j = best_result->pointIdxA; j != best_result->pointIdxB; j = (j + 1) % polygons[best_result->polygonIdx].size())
+                    poly.add(polygons[best_result->polygonIdx][j]);
+                for (unsigned int j = open_polylines[best_polyline_1_idx].size() - 1; int(j) >= 0; j--)
+                    poly.add(open_polylines[best_polyline_1_idx][j]);
+                open_polylines[best_polyline_1_idx].clear();
             }
             else
             {
-                if (best_result->pointIdxA == best_result->pointIdxB)
-                {
-                    for (unsigned int n = 0; n < open_polylines[best_polyline_1_idx].size(); n++)
-                        open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
-                else if (best_result->AtoB)
-                {
-                    Polygon poly;
-                    for (unsigned int n = best_result->pointIdxA; n != best_result->pointIdxB; n = (n + 1) % polygons[best_result->polygonIdx].size())
-                        poly.add(polygons[best_result->polygonIdx][n]);
-                    for (unsigned int n = poly.size() - 1; int(n) >= 0; n--)
-                        open_polylines[best_polyline_2_idx].add(poly[n]);
-                    for (unsigned int n = 0; n < open_polylines[best_polyline_1_idx].size(); n++)
-                        open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
-                else
-                {
-                    for (unsigned int n = best_result->pointIdxB; n != best_result->pointIdxA; n = (n + 1) % polygons[best_result->polygonIdx].size())
-                        open_polylines[best_polyline_2_idx].add(polygons[best_result->polygonIdx][n]);
-                    for (unsigned int n = open_polylines[best_polyline_1_idx].size() - 1; int(n) >= 0; n--)
-                        open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
-                    open_polylines[best_polyline_1_idx].clear();
-                }
+                unsigned int n = polygons.size();
+                polygons.add(open_polylines[best_polyline_1_idx]);
+                for (unsigned int j = best_result->pointIdxB; j != best_result->pointIdxA; j = (j + 1) % polygons[best_result->polygonIdx].size())
+                    polygons[n].add(polygons[best_result->polygonIdx][j]);
+                open_polylines[best_polyline_1_idx].clear();
             }
         }
         else
         {
-            break;
+            if (best_result->pointIdxA == best_result->pointIdxB)
+            {
+                for (unsigned int n = 0; n < open_polylines[best_polyline_1_idx].size(); n++)
+                    open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
+                open_polylines[best_polyline_1_idx].clear();
+            }
+            else if (best_result->AtoB)
+            {
+                Polygon poly;
+                for (unsigned int n = best_result->pointIdxA; n != best_result->pointIdxB; n = (n + 1) % polygons[best_result->polygonIdx].size())
+                    poly.add(polygons[best_result->polygonIdx][n]);
+                for (unsigned int n = poly.size() - 1; int(n) >= 0; n--)
+                    open_polylines[best_polyline_2_idx].add(poly[n]);
+                for (unsigned int n = 0; n < open_polylines[best_polyline_1_idx].size(); n++)
+                    open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
+                open_polylines[best_polyline_1_idx].clear();
+            }
+            else
+            {
+                for (unsigned int n = best_result->pointIdxB; n != best_result->pointIdxA; n = (n + 1) % polygons[best_result->polygonIdx].size())
+                    open_polylines[best_polyline_2_idx].add(polygons[best_result->polygonIdx][n]);
+                for (unsigned int n = open_polylines[best_polyline_1_idx].size() - 1; int(n) >= 0; n--)
+                    open_polylines[best_polyline_2_idx].add(open_polylines[best_polyline_1_idx][n]);
+                open_polylines[best_polyline_1_idx].clear();
+            }
+        }
+
+        update_termini(best_polyline_1_idx);
+        update_termini(best_polyline_2_idx);
+        if (polygons.size() > indexed_polygon_count)
+        {
+            index_new_polygons();
         }
     }
 }
 
 std::optional<GapCloserResult> SlicerLayer::findPolygonGapCloser(Point2LL ip0, Point2LL ip1)
 {
-    std::optional<ClosePolygonResult> c1 = findPolygonPointClosestTo(ip0);
-    std::optional<ClosePolygonResult> c2 = findPolygonPointClosestTo(ip1);
+    return findPolygonGapCloser(ip0, findPolygonPointClosestTo(ip0), ip1, findPolygonPointClosestTo(ip1));
+}
+
+std::optional<GapCloserResult>
+    SlicerLayer::findPolygonGapCloser(Point2LL ip0, const std::optional<ClosePolygonResult>& c1, Point2LL ip1, const std::optional<ClosePolygonResult>& c2) const
+{
     if (! c1 || ! c2 || c1->polygonIdx != c2->polygonIdx)
     {
         return std::nullopt;
@@ -707,24 +843,12 @@ std::optional<ClosePolygonResult> SlicerLayer::findPolygonPointClosestTo(Point2L
         for (size_t i = 0; i < polygons[n].size(); i++)
         {
             Point2LL p1 = polygons[n][i];
-
-            // Q = A + Normal( B - A ) * ((( B - A ) dot ( P - A )) / VSize( A - B ));
-            Point2LL pDiff = p1 - p0;
-            int64_t lineLength = vSize(pDiff);
-            if (lineLength > 1)
+            if (isCloseToPolygonSegment(p0, p1, input))
             {
-                int64_t distOnLine = dot(pDiff, input - p0) / lineLength;
-                if (distOnLine >= 0 && distOnLine <= lineLength)
-                {
-                    Point2LL q = p0 + pDiff * distOnLine / lineLength;
-                    if (shorterThen(q - input, MM2INT(0.1)))
-                    {
-                        ClosePolygonResult ret;
-                        ret.polygonIdx = n;
-                        ret.pointIdx = i;
-                        return ret;
-                    }
-                }
+                ClosePolygonResult ret;
+                ret.polygonIdx = n;
+                ret.pointIdx = i;
+                return ret;
             }
             p0 = p1;
         }
@@ -823,34 +947,167 @@ Slicer::Slicer(Mesh* i_mesh, const coord_t thickness, const size_t slice_layer_c
         mesh->settings_.get<coord_t>("layer_0_z_overlap"),
         Raft::getFillerLayerCount());
 
-    std::vector<std::pair<int32_t, int32_t>> zbbox = buildZHeightsForFaces(*mesh);
+    const std::vector<std::pair<size_t, size_t>> face_layer_ranges = buildLayerRangesForFaces(buildZHeightsForFaces(*mesh), layers);
 
-    buildSegments(*mesh, zbbox, slicing_tolerance, layers);
+    // Slice the model in bands of layers, so that only the segments of one band are in memory at any time.
+    // The segments of a band are connected into polygons (and released) before the next band is sliced.
+    double slice_time = 0.0;
+    double connect_time = 0.0;
+    const std::vector<size_t> band_ends = buildBands(face_layer_ranges, layers.size());
+    for (size_t band_start = 0, band_idx = 0; band_idx < band_ends.size(); band_start = band_ends[band_idx++])
+    {
+        buildSegments(*mesh, face_layer_ranges, slicing_tolerance, layers, band_start, band_ends[band_idx]);
+        slice_time += slice_timer.restart();
 
-    spdlog::info("Slice of mesh took {:03.3f} seconds", slice_timer.restart());
+        cura::parallel_for<size_t>(
+            band_start,
+            band_ends[band_idx],
+            [this, &i_mesh](size_t layer_nr)
+            {
+                layers[layer_nr].makePolygons(i_mesh);
+            });
+        connect_time += slice_timer.restart();
+    }
+    spdlog::info("Slice of mesh took {:03.3f} seconds ({} bands)", slice_time, band_ends.size());
 
     makePolygons(*i_mesh, slicing_tolerance, layers);
     scripta::log("sliced_polygons", layers, SectionType::NA);
-    spdlog::info("Make polygons took {:03.3f} seconds", slice_timer.restart());
+    spdlog::info("Make polygons took {:03.3f} seconds", connect_time + slice_timer.restart());
 }
 
-void Slicer::buildSegments(const Mesh& mesh, const std::vector<std::pair<int32_t, int32_t>>& zbbox, const SlicingTolerance& slicing_tolerance, std::vector<SlicerLayer>& layers)
+std::vector<std::pair<size_t, size_t>> Slicer::buildLayerRangesForFaces(const std::vector<std::pair<int32_t, int32_t>>& zbbox, const std::vector<SlicerLayer>& layers)
 {
-    cura::parallel_for(
-        layers,
-        [&](auto layer_it)
+    // The layers are created bottom to top, so the range of layers that intersect a face can be found with a binary search on the layer heights.
+    std::vector<int32_t> layer_z;
+    layer_z.reserve(layers.size());
+    for (const SlicerLayer& layer : layers)
+    {
+        layer_z.push_back(layer.z);
+    }
+    assert(std::is_sorted(layer_z.begin(), layer_z.end()));
+
+    // For each face, the [first, last) range of layers for which minZ <= layer.z <= maxZ.
+    std::vector<std::pair<size_t, size_t>> face_layer_ranges(zbbox.size());
+    cura::parallel_for<size_t>(
+        0,
+        zbbox.size(),
+        [&](size_t face_idx)
         {
-            SlicerLayer& layer = *layer_it;
+            const auto first = std::lower_bound(layer_z.begin(), layer_z.end(), zbbox[face_idx].first);
+            const auto last = std::upper_bound(first, layer_z.end(), zbbox[face_idx].second);
+            face_layer_ranges[face_idx] = std::make_pair(first - layer_z.begin(), last - layer_z.begin());
+        });
+    return face_layer_ranges;
+}
+
+std::vector<size_t> Slicer::buildBands(const std::vector<std::pair<size_t, size_t>>& face_layer_ranges, const size_t layer_count)
+{
+    // Count the faces active in each layer, as a difference array.
+    std::vector<int64_t> active_face_count(layer_count + 1, 0);
+    for (const auto& [first, last] : face_layer_ranges)
+    {
+        if (first < last)
+        {
+            active_face_count[first]++;
+            active_face_count[last]--;
+        }
+    }
+
+    std::vector<size_t> band_ends;
+    int64_t layer_face_count = 0;
+    int64_t band_face_count = 0;
+    for (size_t layer_nr = 0; layer_nr < layer_count; layer_nr++)
+    {
+        layer_face_count += active_face_count[layer_nr];
+        if (band_face_count > 0 && band_face_count + layer_face_count > max_band_segment_count)
+        {
+            band_ends.push_back(layer_nr);
+            band_face_count = 0;
+        }
+        band_face_count += layer_face_count;
+    }
+    band_ends.push_back(layer_count);
+    return band_ends;
+}
+
+std::vector<size_t> Slicer::buildActiveFacesPerLayer(
+    const std::vector<std::pair<size_t, size_t>>& face_layer_ranges,
+    const size_t first_layer,
+    const size_t last_layer,
+    std::vector<unsigned int>& active_faces)
+{
+    const size_t band_layer_count = last_layer - first_layer;
+
+    // Count the faces active in each layer of the band (as a difference array), then turn the counts into offsets into active_faces.
+    std::vector<size_t> layer_face_offsets(band_layer_count + 1, 0);
+    for (const auto& [first, last] : face_layer_ranges)
+    {
+        const size_t band_first = std::max(first, first_layer) - first_layer;
+        const size_t band_last = std::min(last, last_layer);
+        if (band_first + first_layer < band_last)
+        {
+            layer_face_offsets[band_first + 1]++;
+            if (band_last - first_layer < band_layer_count)
+            {
+                layer_face_offsets[band_last - first_layer + 1]--;
+            }
+        }
+    }
+    for (size_t band_layer_nr = 1; band_layer_nr <= band_layer_count; band_layer_nr++)
+    {
+        layer_face_offsets[band_layer_nr] += layer_face_offsets[band_layer_nr - 1]; // Number of active faces in band layer (band_layer_nr - 1).
+    }
+    for (size_t band_layer_nr = 1; band_layer_nr <= band_layer_count; band_layer_nr++)
+    {
+        layer_face_offsets[band_layer_nr] += layer_face_offsets[band_layer_nr - 1]; // Offset of the end of band layer (band_layer_nr - 1).
+    }
+
+    // Fill the buckets in order of face index, so that every layer sees its faces in the same order as a full scan over the mesh would.
+    active_faces.resize(layer_face_offsets.back());
+    std::vector<size_t> insert_positions(layer_face_offsets.begin(), layer_face_offsets.end() - 1);
+    for (unsigned int face_idx = 0; face_idx < face_layer_ranges.size(); face_idx++)
+    {
+        const size_t band_last = std::min(face_layer_ranges[face_idx].second, last_layer);
+        for (size_t layer_nr = std::max(face_layer_ranges[face_idx].first, first_layer); layer_nr < band_last; layer_nr++)
+        {
+            active_faces[insert_positions[layer_nr - first_layer]++] = face_idx;
+        }
+    }
+    return layer_face_offsets;
+}
+
+Slicer::Slicer(const Mesh* i_mesh, std::vector<SlicerLayer> i_layers)
+    : layers(std::move(i_layers))
+    , mesh(i_mesh)
+{
+}
+
+void Slicer::buildSegments(
+    const Mesh& mesh,
+    const std::vector<std::pair<size_t, size_t>>& face_layer_ranges,
+    const SlicingTolerance& slicing_tolerance,
+    std::vector<SlicerLayer>& layers,
+    const size_t first_layer,
+    const size_t last_layer)
+{
+    // Rather than testing every face against every layer, only visit the faces whose z-range contains the height of the layer.
+    std::vector<unsigned int> active_faces;
+    const std::vector<size_t> layer_face_offsets = buildActiveFacesPerLayer(face_layer_ranges, first_layer, last_layer, active_faces);
+
+    cura::parallel_for<size_t>(
+        first_layer,
+        last_layer,
+        [&](size_t layer_nr)
+        {
+            SlicerLayer& layer = layers[layer_nr];
             const int32_t& z = layer.z;
-            layer.segments.reserve(100);
+            const size_t band_layer_nr = layer_nr - first_layer;
+            layer.segments.reserve(layer_face_offsets[band_layer_nr + 1] - layer_face_offsets[band_layer_nr]);
 
-            // loop over all mesh faces
-            for (unsigned int mesh_idx = 0; mesh_idx < mesh.faces_.size(); mesh_idx++)
+            // loop over all mesh faces that intersect this layer
+            for (size_t active_idx = layer_face_offsets[band_layer_nr]; active_idx < layer_face_offsets[band_layer_nr + 1]; active_idx++)
             {
-                if ((z < zbbox[mesh_idx].first) || (z > zbbox[mesh_idx].second))
-                {
-                    continue;
-                }
+                const unsigned int mesh_idx = active_faces[active_idx];
 
                 // get all vertices per face
                 const MeshFace& face = mesh.faces_[mesh_idx];
@@ -957,7 +1214,6 @@ void Slicer::buildSegments(const Mesh& mesh, const std::vector<std::pair<int32_t
                 }
 
                 // store the segments per layer
-                layer.face_idx_to_segment_idx.insert(std::make_pair(mesh_idx, layer.segments.size()));
                 s.faceIndex = mesh_idx;
                 s.endOtherFaceIdx = face.connected_face_index_[end_edge_idx];
                 s.addedToPolygon = false;
@@ -1009,26 +1265,45 @@ std::vector<SlicerLayer> Slicer::buildLayersWithHeight(
 
 void Slicer::makePolygons(Mesh& mesh, SlicingTolerance slicing_tolerance, std::vector<SlicerLayer>& layers)
 {
-    cura::parallel_for(
-        layers,
-        [&mesh](auto layer_it)
+    // Every layer is combined with the original polygons of the layer above it. The results are written to a separate buffer first, so that no layer is read after it
+    // has been modified, and then moved back.
+    const auto combine_with_next_layer = [&layers](auto combine)
+    {
+        if (layers.size() < 2)
         {
-            layer_it->makePolygons(&mesh);
-        });
-
+            return;
+        }
+        std::vector<Polygons> combined(layers.size() - 1);
+        cura::parallel_for<size_t>(
+            0,
+            combined.size(),
+            [&](size_t layer_nr)
+            {
+                combined[layer_nr] = combine(layers[layer_nr].polygons, layers[layer_nr + 1].polygons);
+            });
+        cura::parallel_for<size_t>(
+            0,
+            combined.size(),
+            [&](size_t layer_nr)
+            {
+                layers[layer_nr].polygons = std::move(combined[layer_nr]);
+            });
+    };
     switch (slicing_tolerance)
     {
     case SlicingTolerance::INCLUSIVE:
-        for (LayerIndex layer_nr = 0; layer_nr + 1 < layers.size(); layer_nr++)
-        {
-            layers[layer_nr].polygons = layers[layer_nr].polygons.unionPolygons(layers[layer_nr + 1].polygons);
-        }
+        combine_with_next_layer(
+            [](const Polygons& polygons, const Polygons& next_polygons)
+            {
+                return polygons.unionPolygons(next_polygons);
+            });
         break;
     case SlicingTolerance::EXCLUSIVE:
-        for (LayerIndex layer_nr = 0; layer_nr + 1 < layers.size(); layer_nr++)
-        {
-            layers[layer_nr].polygons = layers[layer_nr].polygons.intersection(layers[layer_nr + 1].polygons);
-        }
+        combine_with_next_layer(
+            [](const Polygons& polygons, const Polygons& next_polygons)
+            {
+                return polygons.intersection(next_polygons);
+            });
         layers.back().polygons.clear();
         break;
     case SlicingTolerance::MIDDLE:
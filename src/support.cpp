@@ -3,6 +3,8 @@
 
 #include "support.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath> // sqrt, round
 #include <deque>
 #include <fstream> // ifstream.good()
@@ -26,6 +28,7 @@
 #include "Slice.h"
 #include "infill.h"
 #include "infill/SierpinskiFillProvider.h"
+#include "infill/SierpinskiFillProviderCache.h"
 #include "infill/UniformDensityProvider.h"
 #include "progress/Progress.h"
 #include "settings/EnumSettings.h" //For EFillMethod.
@@ -202,112 +205,118 @@ void AreaSupport::generateGradualSupport(SliceDataStorage& storage)
     LayerIndex max_layer = total_layer_count - 1;
 
     // compute different density areas for each support island
-    for (LayerIndex layer_nr = 0; layer_nr < total_layer_count - 1; layer_nr++)
-    {
-        if (layer_nr < min_layer || layer_nr > max_layer)
-        {
-            continue;
-        }
-
-        // generate separate support islands and calculate density areas for each island
-        std::vector<SupportInfillPart>& support_infill_parts = storage.support.supportLayers[layer_nr].support_infill_parts;
-        for (unsigned int part_idx = 0; part_idx < support_infill_parts.size(); ++part_idx)
+    // Each layer only writes to its own parts, and only reads the outlines of the parts of the layers above it.
+    cura::parallel_for<size_t>(
+        0,
+        std::max(total_layer_count, size_t(1)) - 1,
+        [&](const size_t layer_idx)
         {
-            SupportInfillPart& support_infill_part = support_infill_parts[part_idx];
-
-            Polygons original_area = support_infill_part.getInfillArea();
-            if (original_area.empty())
+            const LayerIndex layer_nr = layer_idx;
+            if (layer_nr < min_layer || layer_nr > max_layer)
             {
-                continue;
+                return;
             }
-            // NOTE: This both generates the walls _and_ returns the _actual_ infill area (the one _without_ walls) for use in the rest of the method.
-            const Polygons infill_area = Infill::generateWallToolPaths(
-                support_infill_part.wall_toolpaths_,
-                original_area,
-                support_infill_part.inset_count_to_generate_,
-                wall_width,
-                0,
-                infill_extruder.settings_,
-                layer_nr,
-                SectionType::SUPPORT);
-            const AABB& this_part_boundary_box = support_infill_part.outline_boundary_box_;
-
-            // calculate density areas for this island
-            Polygons less_dense_support = infill_area; // one step less dense with each density_step
-            for (unsigned int density_step = 0; density_step < max_density_steps; ++density_step)
+
+            // generate separate support islands and calculate density areas for each island
+            std::vector<SupportInfillPart>& support_infill_parts = storage.support.supportLayers[layer_nr].support_infill_parts;
+            for (unsigned int part_idx = 0; part_idx < support_infill_parts.size(); ++part_idx)
             {
-                LayerIndex actual_min_layer{ layer_nr + density_step * gradual_support_step_layer_count + static_cast<LayerIndex::value_type>(layer_skip_count) };
-                LayerIndex actual_max_layer{ layer_nr + (density_step + 1) * gradual_support_step_layer_count };
+                SupportInfillPart& support_infill_part = support_infill_parts[part_idx];
 
-                for (double upper_layer_idx = actual_min_layer; upper_layer_idx <= actual_max_layer; upper_layer_idx += layer_skip_count)
+                Polygons original_area = support_infill_part.getInfillArea();
+                if (original_area.empty())
                 {
-                    if (static_cast<unsigned int>(upper_layer_idx) >= total_layer_count)
-                    {
-                        less_dense_support.clear();
-                        break;
-                    }
+                    continue;
+                }
+                // NOTE: This both generates the walls _and_ returns the _actual_ infill area (the one _without_ walls) for use in the rest of the method.
+                const Polygons infill_area = Infill::generateWallToolPaths(
+                    support_infill_part.wall_toolpaths_,
+                    original_area,
+                    support_infill_part.inset_count_to_generate_,
+                    wall_width,
+                    0,
+                    infill_extruder.settings_,
+                    layer_nr,
+                    SectionType::SUPPORT);
+                const AABB& this_part_boundary_box = support_infill_part.outline_boundary_box_;
+
+                // calculate density areas for this island
+                Polygons less_dense_support = infill_area; // one step less dense with each density_step
+                for (unsigned int density_step = 0; density_step < max_density_steps; ++density_step)
+                {
+                    LayerIndex actual_min_layer{ layer_nr + density_step * gradual_support_step_layer_count + static_cast<LayerIndex::value_type>(layer_skip_count) };
+                    LayerIndex actual_max_layer{ layer_nr + (density_step + 1) * gradual_support_step_layer_count };
 
-                    // compute intersections with relevant upper parts
-                    const std::vector<SupportInfillPart> upper_infill_parts = storage.support.supportLayers[upper_layer_idx].support_infill_parts;
-                    Polygons relevant_upper_polygons;
-                    for (unsigned int upper_part_idx = 0; upper_part_idx < upper_infill_parts.size(); ++upper_part_idx)
+                    for (double upper_layer_idx = actual_min_layer; upper_layer_idx <= actual_max_layer; upper_layer_idx += layer_skip_count)
                     {
-                        if (support_infill_part.outline_.empty())
+                        if (static_cast<unsigned int>(upper_layer_idx) >= total_layer_count)
                         {
-                            continue;
+                            less_dense_support.clear();
+                            break;
                         }
 
-                        // we compute intersection based on support infill areas
-                        const AABB& upper_part_boundary_box = upper_infill_parts[upper_part_idx].outline_boundary_box_;
-                        //
-                        // Here we are comparing the **outlines** of the infill areas
-                        //
-                        // legend:
-                        //   ^ support roof
-                        //   | support wall
-                        //   # dense support
-                        //   + less dense support
-                        //
-                        //     comparing infill            comparing with outline (this is our approach)
-                        //    ^^^^^^        ^^^^^^            ^^^^^^            ^^^^^^
-                        //    ####||^^      ####||^^          ####||^^          ####||^^
-                        //    ######||^^    #####||^^         ######||^^        #####||^^
-                        //    ++++####||    ++++##||^         ++++++##||        ++++++||^
-                        //    ++++++####    +++++##||         ++++++++##        +++++++||
-                        //
-                        if (upper_part_boundary_box.hit(this_part_boundary_box))
+                        // compute intersections with relevant upper parts
+                        // Only the outlines of the upper parts are read, which other threads don't write.
+                        const std::vector<SupportInfillPart>& upper_infill_parts = storage.support.supportLayers[upper_layer_idx].support_infill_parts;
+                        Polygons relevant_upper_polygons;
+                        for (unsigned int upper_part_idx = 0; upper_part_idx < upper_infill_parts.size(); ++upper_part_idx)
                         {
-                            relevant_upper_polygons.add(upper_infill_parts[upper_part_idx].outline_);
+                            if (support_infill_part.outline_.empty())
+                            {
+                                continue;
+                            }
+
+                            // we compute intersection based on support infill areas
+                            const AABB& upper_part_boundary_box = upper_infill_parts[upper_part_idx].outline_boundary_box_;
+                            //
+                            // Here we are comparing the **outlines** of the infill areas
+                            //
+                            // legend:
+                            //   ^ support roof
+                            //   | support wall
+                            //   # dense support
+                            //   + less dense support
+                            //
+                            //     comparing infill            comparing with outline (this is our approach)
+                            //    ^^^^^^        ^^^^^^            ^^^^^^            ^^^^^^
+                            //    ####||^^      ####||^^          ####||^^          ####||^^
+                            //    ######||^^    #####||^^         ######||^^        #####||^^
+                            //    ++++####||    ++++##||^         ++++++##||        ++++++||^
+                            //    ++++++####    +++++##||         ++++++++##        +++++++||
+                            //
+                            if (upper_part_boundary_box.hit(this_part_boundary_box))
+                            {
+                                relevant_upper_polygons.add(upper_infill_parts[upper_part_idx].outline_);
+                            }
                         }
+
+                        less_dense_support = less_dense_support.intersection(relevant_upper_polygons);
+                    }
+                    if (less_dense_support.size() == 0)
+                    {
+                        break;
                     }
 
-                    less_dense_support = less_dense_support.intersection(relevant_upper_polygons);
-                }
-                if (less_dense_support.size() == 0)
-                {
-                    break;
+                    // add new infill_area_per_combine_per_density for the current density
+                    support_infill_part.infill_area_per_combine_per_density_.emplace_back();
+                    std::vector<Polygons>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
+                    const Polygons more_dense_support = infill_area.difference(less_dense_support);
+                    support_area_current_density.push_back(more_dense_support);
                 }
 
-                // add new infill_area_per_combine_per_density for the current density
                 support_infill_part.infill_area_per_combine_per_density_.emplace_back();
                 std::vector<Polygons>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
-                const Polygons more_dense_support = infill_area.difference(less_dense_support);
-                support_area_current_density.push_back(more_dense_support);
-            }
-
-            support_infill_part.infill_area_per_combine_per_density_.emplace_back();
-            std::vector<Polygons>& support_area_current_density = support_infill_part.infill_area_per_combine_per_density_.back();
-            support_area_current_density.push_back(infill_area);
+                support_area_current_density.push_back(infill_area);
 
-            assert(support_infill_part.infill_area_per_combine_per_density_.size() != 0 && "support_infill_part.infill_area_per_combine_per_density should now be initialized");
+                assert(support_infill_part.infill_area_per_combine_per_density_.size() != 0 && "support_infill_part.infill_area_per_combine_per_density should now be initialized");
 #ifdef DEBUG
-            for (unsigned int part_i = 0; part_i < support_infill_part.infill_area_per_combine_per_density_.size(); ++part_i)
-            {
-                assert(support_infill_part.infill_area_per_combine_per_density_[part_i].size() != 0);
-            }
+                for (unsigned int part_i = 0; part_i < support_infill_part.infill_area_per_combine_per_density_.size(); ++part_i)
+                {
+                    assert(support_infill_part.infill_area_per_combine_per_density_[part_i].size() != 0);
+                }
 #endif // DEBUG
-        }
-    }
+            }
+        });
 }
 
 
@@ -335,83 +344,88 @@ void AreaSupport::combineSupportInfillLayers(SliceDataStorage& storage)
     max_layer = max_layer - 1;
     max_layer -= max_layer % combine_layers_amount; // Round downwards to the nearest layer divisible by infill_sparse_combine.
 
-    for (size_t layer_idx = min_layer; layer_idx <= max_layer; layer_idx += combine_layers_amount) // Skip every few layers, but extrude more.
+    if (total_layer_count == 0 || storage.support.supportLayers.empty() || min_layer > max_layer)
     {
-        if (layer_idx >= storage.support.supportLayers.size())
-        {
-            break;
-        }
-
-        SupportLayer& layer = storage.support.supportLayers[layer_idx];
-        for (unsigned int combine_count_here = 1; combine_count_here < combine_layers_amount; ++combine_count_here)
+        return;
+    }
+    // Each group of combined layers is disjoint from all other groups, so the groups can be combined in parallel.
+    cura::parallel_for<size_t>(
+        0,
+        (max_layer - min_layer) / combine_layers_amount + 1,
+        [&](const size_t group_idx) // Skip every few layers, but extrude more.
         {
-            if (layer_idx < combine_count_here)
-            {
-                break;
-            }
+            const size_t layer_idx = min_layer + group_idx * combine_layers_amount;
 
-            size_t lower_layer_idx = layer_idx - combine_count_here;
-            if (lower_layer_idx < min_layer)
+            SupportLayer& layer = storage.support.supportLayers[layer_idx];
+            for (unsigned int combine_count_here = 1; combine_count_here < combine_layers_amount; ++combine_count_here)
             {
-                break;
-            }
-            SupportLayer& lower_layer = storage.support.supportLayers[lower_layer_idx];
+                if (layer_idx < combine_count_here)
+                {
+                    break;
+                }
 
-            for (SupportInfillPart& part : layer.support_infill_parts)
-            {
-                if (part.getInfillArea().empty())
+                size_t lower_layer_idx = layer_idx - combine_count_here;
+                if (lower_layer_idx < min_layer)
                 {
-                    continue;
+                    break;
                 }
-                for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density_.size(); ++density_idx)
-                { // go over each density of gradual infill (these density areas overlap!)
-                    std::vector<Polygons>& infill_area_per_combine = part.infill_area_per_combine_per_density_[density_idx];
-                    Polygons result;
-                    for (SupportInfillPart& lower_layer_part : lower_layer.support_infill_parts)
-                    {
-                        if (! part.outline_boundary_box_.hit(lower_layer_part.outline_boundary_box_))
-                        {
-                            continue;
-                        }
+                SupportLayer& lower_layer = storage.support.supportLayers[lower_layer_idx];
 
-                        Polygons intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.getInfillArea()).offset(-200).offset(200);
-                        if (intersection.size() <= 0)
+                for (SupportInfillPart& part : layer.support_infill_parts)
+                {
+                    if (part.getInfillArea().empty())
+                    {
+                        continue;
+                    }
+                    for (unsigned int density_idx = 0; density_idx < part.infill_area_per_combine_per_density_.size(); ++density_idx)
+                    { // go over each density of gradual infill (these density areas overlap!)
+                        std::vector<Polygons>& infill_area_per_combine = part.infill_area_per_combine_per_density_[density_idx];
+                        Polygons result;
+                        for (SupportInfillPart& lower_layer_part : lower_layer.support_infill_parts)
                         {
-                            continue;
+                            if (! part.outline_boundary_box_.hit(lower_layer_part.outline_boundary_box_))
+                            {
+                                continue;
+                            }
+
+                            Polygons intersection = infill_area_per_combine[combine_count_here - 1].intersection(lower_layer_part.getInfillArea()).offset(-200).offset(200);
+                            if (intersection.size() <= 0)
+                            {
+                                continue;
+                            }
+
+                            result.add(intersection); // add area to be thickened
+                            infill_area_per_combine[combine_count_here - 1]
+                                = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
+
+                            unsigned int max_lower_density_idx = density_idx;
+                            // Generally: remove only from *same density* areas on layer below
+                            // If there are no same density areas, then it's ok to print them anyway
+                            // Don't remove other density areas
+                            if (density_idx == part.infill_area_per_combine_per_density_.size() - 1)
+                            {
+                                // For the most dense areas on a given layer the density of that area is doubled.
+                                // This means that - if the lower layer has more densities -
+                                // all those lower density lines are included in the most dense of this layer.
+                                // We therefore compare the most dense are on this layer with all densities
+                                // of the lower layer with the same or higher density index
+                                max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density_.size() - 1;
+                            }
+                            for (unsigned int lower_density_idx = density_idx;
+                                 lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density_.size();
+                                 lower_density_idx++)
+                            {
+                                std::vector<Polygons>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density_[lower_density_idx];
+                                lower_infill_area_per_combine[0]
+                                    = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
+                            }
                         }
 
-                        result.add(intersection); // add area to be thickened
-                        infill_area_per_combine[combine_count_here - 1]
-                            = infill_area_per_combine[combine_count_here - 1].difference(intersection); // remove thickened area from less thick layer here
-
-                        unsigned int max_lower_density_idx = density_idx;
-                        // Generally: remove only from *same density* areas on layer below
-                        // If there are no same density areas, then it's ok to print them anyway
-                        // Don't remove other density areas
-                        if (density_idx == part.infill_area_per_combine_per_density_.size() - 1)
-                        {
-                            // For the most dense areas on a given layer the density of that area is doubled.
-                            // This means that - if the lower layer has more densities -
-                            // all those lower density lines are included in the most dense of this layer.
-                            // We therefore compare the most dense are on this layer with all densities
-                            // of the lower layer with the same or higher density index
-                            max_lower_density_idx = lower_layer_part.infill_area_per_combine_per_density_.size() - 1;
-                        }
-                        for (unsigned int lower_density_idx = density_idx;
-                             lower_density_idx <= max_lower_density_idx && lower_density_idx < lower_layer_part.infill_area_per_combine_per_density_.size();
-                             lower_density_idx++)
-                        {
-                            std::vector<Polygons>& lower_infill_area_per_combine = lower_layer_part.infill_area_per_combine_per_density_[lower_density_idx];
-                            lower_infill_area_per_combine[0]
-                                = lower_infill_area_per_combine[0].difference(intersection); // remove thickened area from lower (single thickness) layer
-                        }
+                        infill_area_per_combine.push_back(result);
                     }
-
-                    infill_area_per_combine.push_back(result);
                 }
             }
-        }
-    }
+        });
 }
 
 void AreaSupport::cleanup(SliceDataStorage& storage)
@@ -736,25 +750,16 @@ void AreaSupport::precomputeCrossInfillTree(SliceDataStorage& storage)
 
         std::string cross_subdisivion_spec_image_file = infill_extruder.settings_.get<std::string>("cross_support_density_image");
         std::ifstream cross_fs(cross_subdisivion_spec_image_file.c_str());
-        if (cross_subdisivion_spec_image_file != "" && cross_fs.good())
+        if (cross_subdisivion_spec_image_file != "" && ! cross_fs.good())
         {
-            storage.support.cross_fill_provider = std::make_shared<SierpinskiFillProvider>(
-                aabb,
-                infill_extruder.settings_.get<coord_t>("support_line_distance"),
-                infill_extruder.settings_.get<coord_t>("support_line_width"),
-                cross_subdisivion_spec_image_file);
-        }
-        else
-        {
-            if (cross_subdisivion_spec_image_file != "")
-            {
-                spdlog::error("Cannot find density image: {}.", cross_subdisivion_spec_image_file);
-            }
-            storage.support.cross_fill_provider = std::make_shared<SierpinskiFillProvider>(
-                aabb,
-                infill_extruder.settings_.get<coord_t>("support_line_distance"),
-                infill_extruder.settings_.get<coord_t>("support_line_width"));
+            spdlog::error("Cannot find density image: {}.", cross_subdisivion_spec_image_file);
+            cross_subdisivion_spec_image_file.clear();
         }
+        storage.support.cross_fill_provider = SierpinskiFillProviderCache::getInstance().get(
+            aabb,
+            infill_extruder.settings_.get<coord_t>("support_line_distance"),
+            infill_extruder.settings_.get<coord_t>("support_line_width"),
+            cross_subdisivion_spec_image_file);
     }
 }
 
@@ -796,12 +801,22 @@ void AreaSupport::generateOverhangAreasForMesh(SliceDataStorage& storage, SliceM
         AreaSupport::detectOverhangPoints(storage, mesh);
     }
 
+    // A layer that lies within the layer of the same mesh below it can't have overhang, if it may stick out past the layer below at all. The outlines
+    // of the other meshes can only add to what's below. Infill meshes and anti-overhang meshes are not part of those outlines though.
+    const double tan_angle = tan(mesh.settings.get<AngleRadians>("support_angle")) - 0.01; // Same as in computeBasicAndFullOverhang.
+    const coord_t max_dist_from_lower_layer = tan_angle * mesh.settings.get<coord_t>("layer_height");
+    const bool skip_supported_layers = max_dist_from_lower_layer > 0 && ! mesh.settings.get<bool>("infill_mesh") && ! mesh.settings.get<bool>("anti_overhang_mesh");
+
     // Generate the actual areas and store them in the mesh.
     cura::parallel_for<size_t>(
         1,
         storage.print_layer_count,
         [&](const size_t layer_idx)
         {
+            if (skip_supported_layers && isSupportedByLayerBelow(mesh, layer_idx))
+            {
+                return; // The overhang areas stay empty.
+            }
             std::pair<Polygons, Polygons> basic_and_full_overhang = computeBasicAndFullOverhang(storage, mesh, layer_idx);
             mesh.overhang_areas[layer_idx] = basic_and_full_overhang.first; // Store the results.
             mesh.full_overhang_areas[layer_idx] = basic_and_full_overhang.second;
@@ -1020,14 +1035,15 @@ void AreaSupport::generateSupportAreasForMesh(
     const coord_t xy_distance_overhang = infill_settings.get<coord_t>("support_xy_distance_overhang");
     const bool use_xy_distance_overhang
         = infill_settings.get<SupportDistPriority>("support_xy_overrides_z") == SupportDistPriority::Z_OVERRIDES_XY; // whether to use a different xy distance at overhangs
-    constexpr bool no_support = false;
-    constexpr bool no_prime_tower = false;
     const coord_t support_line_width = mesh_group_settings.get<ExtruderTrain&>("support_infill_extruder_nr").settings_.get<coord_t>("support_line_width");
     const double sloped_areas_angle = mesh.settings.get<AngleRadians>("support_bottom_stair_step_min_slope");
     const coord_t sloped_area_detection_width = 10 + static_cast<coord_t>(layer_thickness / std::tan(sloped_areas_angle)) / 2;
     const double minimum_support_area = mesh.settings.get<double>("minimum_support_area");
     const coord_t min_even_wall_line_width = mesh.settings.get<coord_t>("min_even_wall_line_width");
-    xy_disallowed_per_layer[0] = storage.getLayerOutlines(0, no_support, no_prime_tower).offset(xy_distance);
+    // The model outlines of a layer are needed by several of the steps below, by the layers around it and by the other meshes.
+    const ModelOffsetCache& model_offsets = storage.model_offsets;
+    constexpr int all_meshes = ModelOffsetCache::all_meshes;
+    xy_disallowed_per_layer[0] = model_offsets.get(0, all_meshes, xy_distance);
 
     // The maximum width of an odd wall = 2 * minimum even wall width.
     auto half_min_feature_width = min_even_wall_line_width + 10;
@@ -1037,14 +1053,14 @@ void AreaSupport::generateSupportAreasForMesh(
         layer_count,
         [&](const size_t layer_idx)
         {
-            const Polygons outlines = storage.getLayerOutlines(layer_idx, no_support, no_prime_tower);
+            const Polygons& outlines = model_offsets.get(layer_idx, all_meshes);
 
             // Build sloped areas. We need this for the stair-stepping later on.
             // Specifically, sloped areass are used in 'moveUpFromModel' to prevent a stair step happening over an area where there isn't a slope.
             // This part here only concerns the slope between two layers. This will be post-processed later on (see the other parallel loop below).
             sloped_areas_per_layer[layer_idx] =
                 // Take the outer areas of the previous layer, where the outer areas are (mostly) just _inside_ the shape.
-                storage.getLayerOutlines(layer_idx - 1, no_support, no_prime_tower)
+                model_offsets.get(layer_idx - 1, all_meshes)
                     .tubeShape(sloped_area_detection_width, 10)
                     // Intersect those with the outer areas of the current layer, where the outer areas are (mostly) _outside_ the shape.
                     // This will detect every slope (and some/most vertical walls) between those two layers.
@@ -1068,7 +1084,7 @@ void AreaSupport::generateSupportAreasForMesh(
                     // we also want to use the min XY distance when the support is resting on a sloped surface so we calculate the area of the
                     // layer below that protrudes beyond the current layer's area and combine it with the current layer's overhang disallowed area
 
-                    Polygons minimum_xy_disallowed_areas = mesh.layers[layer_idx].getOutlines().offset(xy_distance_overhang);
+                    const Polygons& minimum_xy_disallowed_areas = model_offsets.get(layer_idx, mesh_idx, xy_distance_overhang);
                     Polygons varying_xy_disallowed_areas = generateVaryingXYDisallowedArea(mesh, layer_idx);
                     xy_disallowed_per_layer[layer_idx] = minimum_xy_disallowed_areas.unionPolygons(varying_xy_disallowed_areas);
                     scripta::log("support_xy_disallowed_areas", xy_disallowed_per_layer[layer_idx], SectionType::SUPPORT, layer_idx);
@@ -1076,7 +1092,7 @@ void AreaSupport::generateSupportAreasForMesh(
             }
             if (is_support_mesh_place_holder || ! use_xy_distance_overhang)
             {
-                xy_disallowed_per_layer[layer_idx] = outlines.offset(xy_distance);
+                xy_disallowed_per_layer[layer_idx] = model_offsets.get(layer_idx, all_meshes, xy_distance);
             }
         });
 
@@ -1122,36 +1138,53 @@ void AreaSupport::generateSupportAreasForMesh(
             bottom_stair_step_layer_count);
     }
 
-    for (size_t layer_idx = layer_count - 1 - layer_z_distance_top; layer_idx != static_cast<size_t>(-1); layer_idx--)
-    {
-        Polygons layer_this = mesh.full_overhang_areas[layer_idx + layer_z_distance_top];
-
-        if (extension_offset && ! is_support_mesh_place_holder)
+    // Everything of a layer that doesn't depend on the support of the layer above is prepared in parallel first, so
+    // that the support propagating down from layer to layer below only has to wait for the join with the layer above.
+    const size_t top_support_layer_idx = layer_count - 1 - layer_z_distance_top;
+    std::vector<Polygons> overhang_per_layer(top_support_layer_idx + 1);
+    cura::parallel_for<size_t>(
+        0,
+        top_support_layer_idx + 1,
+        [&](const size_t layer_idx)
         {
-            // To avoid that the support is folding around the model, the support horizontal expansion should not cause
-            // the support to grow towards the model. Stepwise applying the support horizontal expansion to both the
-            // model outline and the support is effectively calculating a voronoi. The offset is first applied to
-            // the support and next to the model to ensure that the expanded support area is connected to the original
-            // support area. Please note that the horizontal expansion is rounded down to an integer offset_per_step.
-            Polygons model_outline = storage.getLayerOutlines(layer_idx, no_support, no_prime_tower);
-            const coord_t offset_per_step = support_line_width / 2;
-
-            // perform a small offset we don't enlarge small features of the support
-            Polygons horizontal_expansion = layer_this;
-            for (coord_t offset_cumulative = 0; offset_cumulative <= extension_offset; offset_cumulative += offset_per_step)
+            Polygons overhang = mesh.full_overhang_areas[layer_idx + layer_z_distance_top];
+
+            if (extension_offset && ! is_support_mesh_place_holder)
             {
-                horizontal_expansion = horizontal_expansion.offset(offset_per_step);
-                model_outline = model_outline.difference(horizontal_expansion);
-                model_outline = model_outline.offset(offset_per_step);
-                horizontal_expansion = horizontal_expansion.difference(model_outline);
+                // To avoid that the support is folding around the model, the support horizontal expansion should not cause
+                // the support to grow towards the model. Stepwise applying the support horizontal expansion to both the
+                // model outline and the support is effectively calculating a voronoi. The offset is first applied to
+                // the support and next to the model to ensure that the expanded support area is connected to the original
+                // support area. Please note that the horizontal expansion is rounded down to an integer offset_per_step.
+                Polygons model_outline = model_offsets.get(layer_idx, all_meshes);
+                const coord_t offset_per_step = support_line_width / 2;
+
+                // perform a small offset we don't enlarge small features of the support
+                Polygons horizontal_expansion = overhang;
+                for (coord_t offset_cumulative = 0; offset_cumulative <= extension_offset; offset_cumulative += offset_per_step)
+                {
+                    horizontal_expansion = horizontal_expansion.offset(offset_per_step);
+                    model_outline = model_outline.difference(horizontal_expansion);
+                    model_outline = model_outline.offset(offset_per_step);
+                    horizontal_expansion = horizontal_expansion.difference(model_outline);
+                }
+                overhang = overhang.unionPolygons(horizontal_expansion);
             }
-            layer_this = layer_this.unionPolygons(horizontal_expansion);
-        }
+
+            if (use_towers && ! is_support_mesh_place_holder)
+            {
+                // handle straight walls
+                AreaSupport::handleWallStruts(infill_settings, overhang);
+            }
+            overhang_per_layer[layer_idx] = std::move(overhang);
+        });
+
+    for (size_t layer_idx = top_support_layer_idx; layer_idx != static_cast<size_t>(-1); layer_idx--)
+    {
+        Polygons layer_this = std::move(overhang_per_layer[layer_idx]);
 
         if (use_towers && ! is_support_mesh_place_holder)
         {
-            // handle straight walls
-            AreaSupport::handleWallStruts(infill_settings, layer_this);
             // handle towers
             AreaSupport::handleTowers(infill_settings, xy_disallowed_per_layer[layer_idx], layer_this, tower_roofs, mesh.overhang_points, layer_idx, layer_count);
         }
@@ -1160,8 +1193,7 @@ void AreaSupport::generateSupportAreasForMesh(
         { // join with support from layer up
             const Polygons empty;
             const Polygons* layer_above = (layer_idx < support_areas.size()) ? &support_areas[layer_idx + 1] : &empty;
-            const Polygons model_mesh_on_layer
-                = (layer_idx > 0) && ! is_support_mesh_nondrop_place_holder ? storage.getLayerOutlines(layer_idx, no_support, no_prime_tower) : empty;
+            const Polygons& model_mesh_on_layer = (layer_idx > 0) && ! is_support_mesh_nondrop_place_holder ? model_offsets.get(layer_idx, all_meshes) : empty;
             if (is_support_mesh_nondrop_place_holder)
             {
                 layer_above = &empty;
@@ -1200,7 +1232,7 @@ void AreaSupport::generateSupportAreasForMesh(
 
         // Move up from model, handle stair-stepping.
         moveUpFromModel(
-            storage,
+            model_offsets,
             stair_removal,
             sloped_areas_per_layer[layer_idx],
             layer_this,
@@ -1291,10 +1323,7 @@ void AreaSupport::generateSupportAreasForMesh(
             max_checking_layer_idx,
             [&](const size_t layer_idx)
             {
-                constexpr bool no_support_here = false;
-                constexpr bool no_prime_tower_here = false;
-                support_areas[layer_idx]
-                    = support_areas[layer_idx].difference(storage.getLayerOutlines(layer_idx + layer_z_distance_top - 1, no_support_here, no_prime_tower_here));
+                support_areas[layer_idx] = support_areas[layer_idx].difference(model_offsets.get(layer_idx + layer_z_distance_top - 1, all_meshes));
             });
     }
 
@@ -1325,7 +1354,7 @@ void AreaSupport::generateSupportAreasForMesh(
 }
 
 void AreaSupport::moveUpFromModel(
-    const SliceDataStorage& storage,
+    const ModelOffsetCache& model_offsets,
     Polygons& stair_removal,
     Polygons& sloped_areas,
     Polygons& support_areas,
@@ -1389,9 +1418,7 @@ void AreaSupport::moveUpFromModel(
     }
 
     const size_t bottom_layer_nr = layer_idx - bottom_empty_layer_count;
-    constexpr bool no_support = false;
-    constexpr bool no_prime_tower = false;
-    const Polygons bottom_outline = storage.getLayerOutlines(bottom_layer_nr, no_support, no_prime_tower);
+    const Polygons& bottom_outline = model_offsets.get(bottom_layer_nr, ModelOffsetCache::all_meshes);
 
     Polygons to_be_removed;
     if (bottom_stair_step_layer_count <= 1)
@@ -1403,13 +1430,13 @@ void AreaSupport::moveUpFromModel(
         to_be_removed = stair_removal.unionPolygons(bottom_outline);
         if (layer_idx % bottom_stair_step_layer_count == 0)
         { // update stairs for next step
-            const Polygons supporting_bottom = storage.getLayerOutlines(bottom_layer_nr - 1, no_support, no_prime_tower);
+            const Polygons& supporting_bottom = model_offsets.get(LayerIndex(bottom_layer_nr) - 1, ModelOffsetCache::all_meshes);
             const Polygons allowed_step_width = supporting_bottom.offset(support_bottom_stair_step_width).intersection(sloped_areas);
 
             const int64_t step_bottom_layer_nr = bottom_layer_nr - bottom_stair_step_layer_count + 1;
             if (step_bottom_layer_nr >= 0)
             {
-                const Polygons step_bottom_outline = storage.getLayerOutlines(step_bottom_layer_nr, no_support, no_prime_tower);
+                const Polygons& step_bottom_outline = model_offsets.get(step_bottom_layer_nr, ModelOffsetCache::all_meshes);
                 stair_removal = step_bottom_outline.intersection(allowed_step_width);
             }
             else
@@ -1422,6 +1449,50 @@ void AreaSupport::moveUpFromModel(
 }
 
 
+bool AreaSupport::isSupportedByLayerBelow(const SliceMeshStorage& mesh, const LayerIndex layer_idx)
+{
+    const std::vector<SliceLayerPart>& parts_below = mesh.layers[layer_idx - 1].parts;
+    for (const SliceLayerPart& part : mesh.layers[layer_idx].parts)
+    {
+        if (part.outline.empty())
+        {
+            continue;
+        }
+        double part_area = -1.0; // Only computed when a part below could contain this part.
+        bool is_supported = false;
+        for (const SliceLayerPart& part_below : parts_below)
+        {
+            if (! part_below.boundaryBox.contains(part.boundaryBox))
+            {
+                continue;
+            }
+            if (part_below.outline.paths == part.outline.paths) // Straight walls often slice to exactly the same outline.
+            {
+                is_supported = true;
+                break;
+            }
+            if (part_area < 0.0)
+            {
+                part_area = part.outline.area();
+            }
+            if (part_below.outline.area() < part_area)
+            {
+                continue;
+            }
+            if (part.outline.difference(part_below.outline).empty())
+            {
+                is_supported = true;
+                break;
+            }
+        }
+        if (! is_supported)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 /*            layer 2
  * layer 1 ______________|
  * _______|         ^^^^^ basic overhang
@@ -1436,8 +1507,6 @@ void AreaSupport::moveUpFromModel(
 std::pair<Polygons, Polygons> AreaSupport::computeBasicAndFullOverhang(const SliceDataStorage& storage, const SliceMeshStorage& mesh, const LayerIndex& layer_idx)
 {
     const Polygons outlines = mesh.layers[layer_idx].getOutlines();
-    constexpr bool no_support = false;
-    constexpr bool no_prime_tower = false;
 
     constexpr double smooth_height = 0.4; // mm
     const LayerIndex layers_below{ static_cast<LayerIndex::value_type>(std::round(smooth_height / mesh.settings.get<double>("layer_height"))) };
@@ -1451,10 +1520,10 @@ std::pair<Polygons, Polygons> AreaSupport::computeBasicAndFullOverhang(const Sli
     // To avoids generating support for textures on vertical surfaces, a moving average
     // is taken over smooth_height. The smooth_height is currently an educated guess
     // that we might want to expose to the frontend in the future.
-    Polygons outlines_below = storage.getLayerOutlines(layer_idx - 1, no_support, no_prime_tower).offset(max_dist_from_lower_layer);
+    Polygons outlines_below = storage.model_offsets.get(layer_idx - 1, ModelOffsetCache::all_meshes, max_dist_from_lower_layer);
     for (int layer_idx_offset = 2; layer_idx - layer_idx_offset >= 0 && layer_idx_offset <= layers_below; layer_idx_offset++)
     {
-        auto outlines_below_ = storage.getLayerOutlines(layer_idx - layer_idx_offset, no_support, no_prime_tower).offset(max_dist_from_lower_layer * layer_idx_offset);
+        const Polygons& outlines_below_ = storage.model_offsets.get(layer_idx - layer_idx_offset, ModelOffsetCache::all_meshes, max_dist_from_lower_layer * layer_idx_offset);
         outlines_below = outlines_below.unionPolygons(outlines_below_);
     }
 
@@ -1503,7 +1572,16 @@ void AreaSupport::detectOverhangPoints(const SliceDataStorage& storage, SliceMes
                 continue;
             }
 
-            auto has_support_below = ! layer_below.getOutlines().intersection(part.outline).empty();
+            // Only the parts below that overlap the bounding box of this part can support it.
+            Polygons outlines_below;
+            for (const SliceLayerPart& part_below : layer_below.parts)
+            {
+                if (part_below.boundaryBox.hit(part.boundaryBox))
+                {
+                    outlines_below.add(part_below.outline);
+                }
+            }
+            const bool has_support_below = ! outlines_below.empty() && ! outlines_below.intersection(part.outline).empty();
             if (has_support_below)
             {
                 continue;
@@ -1669,6 +1747,90 @@ void AreaSupport::handleWallStruts(const Settings& settings, Polygons& supportLa
     }
 }
 
+namespace
+{
+
+/*!
+ * \brief The union of the outlines of a mesh over any range of up to a fixed number of consecutive layers.
+ *
+ * The layers are split into blocks of that many layers. For each layer, this keeps the union of the outlines from the
+ * start of its block up to it, and from it up to the end of its block. A range spans at most two blocks, so its union is
+ * the union of two of those. Every layer is only added to two unions, however many layers a range spans.
+ */
+class LayerRangeUnions
+{
+public:
+    /*!
+     * \param mesh The mesh to unite the outlines of.
+     * \param max_range_size The largest number of layers that a range may span.
+     */
+    LayerRangeUnions(const SliceMeshStorage& mesh, const size_t max_range_size)
+        : mesh_(mesh)
+        , block_size_(std::max(max_range_size, size_t(1)))
+        , from_block_start_(mesh.layers.size())
+        , to_block_end_(mesh.layers.size())
+    {
+        const size_t layer_count = mesh.layers.size();
+        cura::parallel_for<size_t>(
+            0,
+            (layer_count + block_size_ - 1) / block_size_,
+            [&](const size_t block_idx)
+            {
+                const size_t block_start = block_idx * block_size_;
+                const size_t block_end = std::min(block_start + block_size_, layer_count) - 1;
+                from_block_start_[block_start] = mesh.layers[block_start].getOutlines().unionPolygons();
+                for (size_t layer_idx = block_start + 1; layer_idx <= block_end; layer_idx++)
+                {
+                    from_block_start_[layer_idx] = from_block_start_[layer_idx - 1].unionPolygons(mesh.layers[layer_idx].getOutlines());
+                }
+                to_block_end_[block_end] = mesh.layers[block_end].getOutlines().unionPolygons();
+                for (size_t layer_idx = block_end; layer_idx > block_start; layer_idx--)
+                {
+                    to_block_end_[layer_idx - 1] = to_block_end_[layer_idx].unionPolygons(mesh.layers[layer_idx - 1].getOutlines());
+                }
+            });
+    }
+
+    /*!
+     * \brief Get the union of the outlines of the layers from \p first_layer_idx up to and including \p last_layer_idx.
+     *
+     * The range may span at most the number of layers given to the constructor.
+     */
+    Polygons get(const size_t first_layer_idx, const size_t last_layer_idx) const
+    {
+        assert(first_layer_idx <= last_layer_idx && last_layer_idx < from_block_start_.size());
+        assert(last_layer_idx - first_layer_idx < block_size_ && "The range may not span more layers than a block.");
+        if (first_layer_idx % block_size_ == 0)
+        {
+            return from_block_start_[last_layer_idx];
+        }
+        if (first_layer_idx / block_size_ == last_layer_idx / block_size_)
+        {
+            const size_t block_end = std::min((first_layer_idx / block_size_ + 1) * block_size_, from_block_start_.size()) - 1;
+            if (last_layer_idx == block_end)
+            {
+                return to_block_end_[first_layer_idx];
+            }
+            // A short range in the middle of a block. Those are rare, so unite its layers directly.
+            Polygons result;
+            for (size_t layer_idx = first_layer_idx; layer_idx <= last_layer_idx; layer_idx++)
+            {
+                result.add(mesh_.layers[layer_idx].getOutlines());
+            }
+            return result.unionPolygons();
+        }
+        return to_block_end_[first_layer_idx].unionPolygons(from_block_start_[last_layer_idx]);
+    }
+
+private:
+    const SliceMeshStorage& mesh_;
+    size_t block_size_;
+    std::vector<Polygons> from_block_start_; //!< For each layer, the union of the outlines from the start of its block up to it.
+    std::vector<Polygons> to_block_end_; //!< For each layer, the union of the outlines from it up to the end of its block.
+};
+
+} // namespace
+
 void AreaSupport::generateSupportBottom(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Polygons>& global_support_areas_per_layer)
 {
     const Settings& mesh_group_settings = Application::getInstance().current_slice_->scene.current_mesh_group->settings;
@@ -1685,19 +1847,24 @@ void AreaSupport::generateSupportBottom(SliceDataStorage& storage, const SliceMe
     const double minimum_bottom_area = mesh.settings.get<double>("minimum_bottom_area");
 
     std::vector<SupportLayer>& support_layers = storage.support.supportLayers;
-    for (LayerIndex layer_idx = support_layers.size() - 1; layer_idx >= static_cast<int>(z_distance_bottom); --layer_idx)
+    if (support_layers.size() <= static_cast<size_t>(z_distance_bottom))
     {
-        const unsigned int bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
-        Polygons mesh_outlines;
-        for (auto layer_idx_below = bottom_layer_idx_below; layer_idx_below < layer_idx - z_distance_bottom + 1; layer_idx_below += 1)
-        {
-            mesh_outlines.add(mesh.layers[layer_idx_below].getOutlines());
-        }
-        Polygons bottoms;
-        generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, bottom_line_width, bottom_outline_offset, minimum_bottom_area, bottoms);
-        support_layers[layer_idx].support_bottom.add(bottoms);
-        scripta::log("support_interface_bottoms", bottoms, SectionType::SUPPORT, layer_idx);
+        return;
     }
+    const LayerRangeUnions mesh_outlines_below(mesh, bottom_layer_count + 1);
+    // Each layer only changes its own support.
+    cura::parallel_for<size_t>(
+        z_distance_bottom,
+        support_layers.size(),
+        [&](const size_t layer_idx)
+        {
+            const unsigned int bottom_layer_idx_below = std::max(0, int(layer_idx) - int(bottom_layer_count) - int(z_distance_bottom));
+            const Polygons mesh_outlines = mesh_outlines_below.get(bottom_layer_idx_below, layer_idx - z_distance_bottom);
+            Polygons bottoms;
+            generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, bottom_line_width, bottom_outline_offset, minimum_bottom_area, bottoms);
+            support_layers[layer_idx].support_bottom.add(bottoms);
+            scripta::log("support_interface_bottoms", bottoms, SectionType::SUPPORT, layer_idx);
+        });
 }
 
 void AreaSupport::generateSupportRoof(SliceDataStorage& storage, const SliceMeshStorage& mesh, std::vector<Polygons>& global_support_areas_per_layer)
@@ -1716,25 +1883,35 @@ void AreaSupport::generateSupportRoof(SliceDataStorage& storage, const SliceMesh
     const double minimum_roof_area = mesh.settings.get<double>("minimum_roof_area");
 
     std::vector<SupportLayer>& support_layers = storage.support.supportLayers;
-    for (LayerIndex layer_idx = static_cast<int>(support_layers.size() - z_distance_top) - 1; layer_idx >= 0; --layer_idx)
+    if (support_layers.size() <= static_cast<size_t>(z_distance_top))
     {
-        const LayerIndex top_layer_idx_above{
-            std::min(LayerIndex{ support_layers.size() - 1 }, LayerIndex{ layer_idx + roof_layer_count + z_distance_top })
-        }; // Maximum layer of the model that generates support roof.
-        Polygons mesh_outlines;
-        for (auto layer_idx_above = top_layer_idx_above; layer_idx_above > layer_idx + z_distance_top - 1; layer_idx_above -= 1)
+        return;
+    }
+    const size_t roof_layer_end = support_layers.size() - z_distance_top;
+    const LayerRangeUnions mesh_outlines_above(mesh, roof_layer_count + 1);
+    // Each layer only changes its own support. The fractional roofs depend on the roofs above, so they're made afterwards.
+    std::vector<Polygons> roofs_per_layer(roof_layer_end);
+    cura::parallel_for<size_t>(
+        0,
+        roof_layer_end,
+        [&](const size_t layer_idx)
         {
-            mesh_outlines.add(mesh.layers[layer_idx_above].getOutlines());
-        }
-        Polygons roofs;
-        generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, roof_line_width, roof_outline_offset, minimum_roof_area, roofs);
-        support_layers[layer_idx].support_roof.add(roofs);
-        if (layer_idx > 0 && layer_idx < support_layers.size() - 1)
+            const LayerIndex top_layer_idx_above{
+                std::min(LayerIndex{ support_layers.size() - 1 }, LayerIndex{ layer_idx + roof_layer_count + z_distance_top })
+            }; // Maximum layer of the model that generates support roof.
+            const Polygons mesh_outlines = mesh_outlines_above.get(layer_idx + z_distance_top, top_layer_idx_above);
+            Polygons& roofs = roofs_per_layer[layer_idx];
+            generateSupportInterfaceLayer(global_support_areas_per_layer[layer_idx], mesh_outlines, roof_line_width, roof_outline_offset, minimum_roof_area, roofs);
+            support_layers[layer_idx].support_roof.add(roofs);
+            scripta::log("support_interface_roofs", roofs, SectionType::SUPPORT, layer_idx);
+        });
+    cura::parallel_for<size_t>(
+        1,
+        std::min(roof_layer_end, support_layers.size() - 1),
+        [&](const size_t layer_idx)
         {
-            support_layers[layer_idx].support_fractional_roof.add(roofs.difference(support_layers[layer_idx + 1].support_roof));
-        }
-        scripta::log("support_interface_roofs", roofs, SectionType::SUPPORT, layer_idx);
-    }
+            support_layers[layer_idx].support_fractional_roof.add(roofs_per_layer[layer_idx].difference(support_layers[layer_idx + 1].support_roof));
+        });
 
     // Remove support in between the support roof and the model. Subtracts the roof polygons from the support polygons on the layers above it.
     for (auto [layer_idx, support_layer] : support_layers | ranges::views::enumerate | ranges::views::drop(1) | ranges::views::drop_last(z_distance_top))
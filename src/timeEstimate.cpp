@@ -58,6 +58,7 @@ void TimeEstimateCalculator::reset()
 {
     extra_time = 0.0;
     blocks.clear();
+    std::fill(finalized_totals.begin(), finalized_totals.end(), Duration(0.0));
 }
 
 // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the
@@ -268,6 +269,30 @@ void TimeEstimateCalculator::plan(Position newPos, Velocity feedrate, PrintFeatu
     calculateTrapezoidForBlock(&block, Ratio(block.entry_speed / block.nominal_feedrate), Ratio(safe_speed / block.nominal_feedrate));
 
     blocks.push_back(block);
+    if (blocks.size() > planner_buffer_size)
+    {
+        finalizeOldestBlock();
+    }
+}
+
+void TimeEstimateCalculator::finalizeOldestBlock()
+{
+    // The passes never change the entry speed of the oldest block, so the block after it keeps the entry speed that
+    // the speed profile of the oldest block ends with.
+    reversePass();
+    forwardPass();
+    recalculateTrapezoids();
+    addBlockTime(blocks.front(), finalized_totals);
+    blocks.pop_front();
+}
+
+void TimeEstimateCalculator::addBlockTime(const Block& block, std::vector<Duration>& totals)
+{
+    const double plateau_distance = block.decelerate_after - block.accelerate_until;
+
+    totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.initial_feedrate, block.accelerate_until, block.acceleration);
+    totals[static_cast<unsigned char>(block.feature)] += plateau_distance / block.nominal_feedrate;
+    totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.final_feedrate, (block.distance - block.decelerate_after), block.acceleration);
 }
 
 std::vector<Duration> TimeEstimateCalculator::calculate()
@@ -276,16 +301,11 @@ std::vector<Duration> TimeEstimateCalculator::calculate()
     forwardPass();
     recalculateTrapezoids();
 
-    std::vector<Duration> totals(static_cast<unsigned char>(PrintFeatureType::NumPrintFeatureTypes), 0.0);
-    totals[static_cast<unsigned char>(PrintFeatureType::NoneType)] = extra_time; // Extra time (pause for minimum layer time, etc) is marked as NoneType
-    for (unsigned int n = 0; n < blocks.size(); n++)
+    std::vector<Duration> totals = finalized_totals;
+    totals[static_cast<unsigned char>(PrintFeatureType::NoneType)] += extra_time; // Extra time (pause for minimum layer time, etc) is marked as NoneType
+    for (const Block& block : blocks)
     {
-        const Block& block = blocks[n];
-        const double plateau_distance = block.decelerate_after - block.accelerate_until;
-
-        totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.initial_feedrate, block.accelerate_until, block.acceleration);
-        totals[static_cast<unsigned char>(block.feature)] += plateau_distance / block.nominal_feedrate;
-        totals[static_cast<unsigned char>(block.feature)] += accelerationTimeFromDistance(block.final_feedrate, (block.distance - block.decelerate_after), block.acceleration);
+        addBlockTime(block, totals);
     }
     return totals;
 }
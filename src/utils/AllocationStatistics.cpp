@@ -0,0 +1,347 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/AllocationStatistics.h"
+
+#ifdef ENABLE_ALLOCATION_STATS
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#endif
+
+namespace cura
+{
+
+#ifdef ENABLE_ALLOCATION_STATS
+
+namespace
+{
+
+struct AtomicCounts
+{
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+};
+
+//! Where a tag was opened. Tags at the same place with the same name share their counts.
+struct TagKey
+{
+    const char* name = nullptr;
+    const char* file = nullptr;
+    uint_least32_t line = 0;
+};
+
+// Nothing here may allocate or need a constructor to run, since operator new uses it, even before main and during the
+// construction of other statics. Tag 0 holds the untagged allocations.
+constexpr size_t no_thread = AllocationStatistics::max_threads;
+std::atomic<size_t> current_stage{ 0 };
+std::atomic<size_t> thread_count{ 0 };
+AtomicCounts counts[AllocationStatistics::max_threads][N_PROGRESS_STAGES][AllocationStatistics::max_tags];
+TagKey tags[AllocationStatistics::max_tags]{ TagKey{ .name = "untagged" } };
+std::atomic<size_t> tag_count{ 1 }; //!< How many tags are registered. Registered tags don't change anymore.
+std::mutex tags_mutex; //!< Only to register a new tag.
+thread_local size_t thread_idx = no_thread;
+thread_local size_t current_tag = 0;
+
+size_t getThreadIdx()
+{
+    if (thread_idx == no_thread)
+    {
+        thread_idx = std::min(thread_count.fetch_add(1, std::memory_order_relaxed), AllocationStatistics::max_threads - 1);
+    }
+    return thread_idx;
+}
+
+size_t findTag(const TagKey& key)
+{
+    const auto matches = [&key](const size_t tag_idx)
+    {
+        return tags[tag_idx].name == key.name && tags[tag_idx].file == key.file && tags[tag_idx].line == key.line;
+    };
+    for (size_t tag_idx = 1; tag_idx < tag_count.load(std::memory_order_acquire); tag_idx++)
+    {
+        if (matches(tag_idx))
+        {
+            return tag_idx;
+        }
+    }
+
+    std::lock_guard lock(tags_mutex);
+    const size_t registered_count = tag_count.load(std::memory_order_relaxed);
+    for (size_t tag_idx = 1; tag_idx < registered_count; tag_idx++) // Another thread may have registered it meanwhile.
+    {
+        if (matches(tag_idx))
+        {
+            return tag_idx;
+        }
+    }
+    if (registered_count == AllocationStatistics::max_tags)
+    {
+        return 0;
+    }
+    tags[registered_count] = key;
+    tag_count.store(registered_count + 1, std::memory_order_release);
+    return registered_count;
+}
+
+std::string tagLabel(const TagKey& key)
+{
+    if (key.file == nullptr)
+    {
+        return key.name;
+    }
+    std::string_view file_name = key.file;
+    file_name = file_name.substr(file_name.find_last_of("/\\") + 1);
+    return fmt::format("{} ({}:{})", key.name, file_name, key.line);
+}
+
+} // namespace
+
+AllocationStatistics::Tag::Tag(const char* name)
+    : previous_tag_(current_tag)
+{
+    current_tag = findTag(TagKey{ .name = name });
+}
+
+AllocationStatistics::Tag::Tag(const char* name, const std::source_location& site)
+    : previous_tag_(current_tag)
+{
+    current_tag = findTag(TagKey{ .name = name, .file = site.file_name(), .line = site.line() });
+}
+
+AllocationStatistics::Tag::~Tag()
+{
+    current_tag = previous_tag_;
+}
+
+void AllocationStatistics::countAllocation(const size_t bytes)
+{
+    AtomicCounts& counter = counts[getThreadIdx()][current_stage.load(std::memory_order_relaxed)][current_tag];
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocationStatistics::setStage(const Progress::Stage stage)
+{
+    current_stage.store(static_cast<size_t>(stage), std::memory_order_relaxed);
+}
+
+std::array<AllocationStatistics::Counts, N_PROGRESS_STAGES> AllocationStatistics::getStageCounts()
+{
+    std::array<Counts, N_PROGRESS_STAGES> stage_counts;
+    for (size_t thread = 0; thread < max_threads; thread++)
+    {
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            for (size_t tag = 0; tag < max_tags; tag++)
+            {
+                stage_counts[stage].allocations += counts[thread][stage][tag].allocations.load(std::memory_order_relaxed);
+                stage_counts[stage].bytes += counts[thread][stage][tag].bytes.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return stage_counts;
+}
+
+void AllocationStatistics::report()
+{
+    // Take everything out of the counters before allocating anything for the report.
+    static Counts snapshot[max_threads][N_PROGRESS_STAGES][max_tags];
+    for (size_t thread = 0; thread < max_threads; thread++)
+    {
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            for (size_t tag = 0; tag < max_tags; tag++)
+            {
+                snapshot[thread][stage][tag].allocations = counts[thread][stage][tag].allocations.exchange(0, std::memory_order_relaxed);
+                snapshot[thread][stage][tag].bytes = counts[thread][stage][tag].bytes.exchange(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const auto add = [](Counts& total, const Counts& counts_to_add)
+    {
+        total.allocations += counts_to_add.allocations;
+        total.bytes += counts_to_add.bytes;
+    };
+    std::array<Counts, N_PROGRESS_STAGES> stage_counts;
+    std::array<Counts, max_threads> thread_counts;
+    std::map<std::string, Counts> tag_counts; // The same literal may have a different address in another translation unit.
+    for (size_t thread = 0; thread < max_threads; thread++)
+    {
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            for (size_t tag = 0; tag < tag_count.load(std::memory_order_acquire); tag++)
+            {
+                const Counts& counted = snapshot[thread][stage][tag];
+                if (counted.allocations == 0)
+                {
+                    continue;
+                }
+                add(stage_counts[stage], counted);
+                add(thread_counts[thread], counted);
+                add(tag_counts[tagLabel(tags[tag])], counted);
+            }
+        }
+    }
+
+    const auto megabytes = [](const uint64_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    };
+    for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+    {
+        if (stage_counts[stage].allocations > 0)
+        {
+            spdlog::info(
+                "Allocations in {}: {} of {:.1f} MB in total",
+                Progress::getStageName(static_cast<Progress::Stage>(stage)),
+                stage_counts[stage].allocations,
+                megabytes(stage_counts[stage].bytes));
+        }
+    }
+    for (size_t thread = 0; thread < max_threads; thread++)
+    {
+        if (thread_counts[thread].allocations > 0)
+        {
+            spdlog::info(
+                "Allocations by thread {}{}: {} of {:.1f} MB in total",
+                thread,
+                thread == max_threads - 1 ? " and later threads" : "",
+                thread_counts[thread].allocations,
+                megabytes(thread_counts[thread].bytes));
+        }
+    }
+
+    constexpr size_t reported_tag_count = 20;
+    std::vector<std::pair<std::string, Counts>> most_allocating(tag_counts.begin(), tag_counts.end());
+    std::sort(
+        most_allocating.begin(),
+        most_allocating.end(),
+        [](const auto& a, const auto& b)
+        {
+            return a.second.allocations > b.second.allocations;
+        });
+    most_allocating.resize(std::min(most_allocating.size(), reported_tag_count));
+    for (const auto& [label, counted] : most_allocating)
+    {
+        spdlog::info("Allocations under {}: {} of {:.1f} MB in total", label, counted.allocations, megabytes(counted.bytes));
+    }
+}
+
+void AllocationStatistics::reset()
+{
+    for (size_t thread = 0; thread < max_threads; thread++)
+    {
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            for (size_t tag = 0; tag < max_tags; tag++)
+            {
+                counts[thread][stage][tag].allocations.store(0, std::memory_order_relaxed);
+                counts[thread][stage][tag].bytes.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+#else // ENABLE_ALLOCATION_STATS
+
+AllocationStatistics::Tag::Tag(const char*)
+{
+}
+
+AllocationStatistics::Tag::Tag(const char*, const std::source_location&)
+{
+}
+
+AllocationStatistics::Tag::~Tag() = default;
+
+void AllocationStatistics::countAllocation(size_t)
+{
+}
+
+void AllocationStatistics::setStage(Progress::Stage)
+{
+}
+
+std::array<AllocationStatistics::Counts, N_PROGRESS_STAGES> AllocationStatistics::getStageCounts()
+{
+    return {};
+}
+
+void AllocationStatistics::report()
+{
+}
+
+void AllocationStatistics::reset()
+{
+}
+
+#endif // ENABLE_ALLOCATION_STATS
+
+} // namespace cura
+
+#ifdef ENABLE_ALLOCATION_STATS
+
+// Count every allocation of the process. The array and nothrow versions go through these.
+void* operator new(std::size_t size)
+{
+    cura::AllocationStatistics::countAllocation(size);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    cura::AllocationStatistics::countAllocation(size);
+    const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* memory = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void* memory = std::aligned_alloc(align, (std::max(size, std::size_t(1)) + align - 1) / align * align); // Must be a multiple of the alignment.
+#endif
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(memory, alignment);
+}
+
+#endif // ENABLE_ALLOCATION_STATS
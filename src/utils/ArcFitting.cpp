@@ -0,0 +1,131 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ArcFitting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <optional>
+
+namespace cura
+{
+
+namespace
+{
+
+constexpr size_t min_arc_points = 3; //!< Replacing fewer points with an arc hardly makes the g-code shorter.
+constexpr size_t max_arc_points = 256; //!< Bounds the time to check a run of points, which grows with the square of its length.
+
+//! Get a point of the polyline, where 0 is the start and 1 is the first point to go to.
+const Point2LL& pointAt(const Point2LL& start, const std::vector<Point2LL>& points, const size_t idx)
+{
+    return idx == 0 ? start : points[idx - 1];
+}
+
+//! Get the center of the circle through three points, if they aren't on a line.
+std::optional<Point2LL> circumcenter(const Point2LL& a, const Point2LL& b, const Point2LL& c)
+{
+    // Relative to a, to keep the squares small.
+    const double bx = static_cast<double>(b.X - a.X);
+    const double by = static_cast<double>(b.Y - a.Y);
+    const double cx = static_cast<double>(c.X - a.X);
+    const double cy = static_cast<double>(c.Y - a.Y);
+    const double determinant = 2.0 * (bx * cy - by * cx);
+    if (std::abs(determinant) < 1.0)
+    {
+        return std::nullopt;
+    }
+    const double b_squared = bx * bx + by * by;
+    const double c_squared = cx * cx + cy * cy;
+    const double center_x = (cy * b_squared - by * c_squared) / determinant;
+    const double center_y = (bx * c_squared - cx * b_squared) / determinant;
+    if (std::abs(center_x) > max_arc_radius * 2.0 || std::abs(center_y) > max_arc_radius * 2.0)
+    {
+        return std::nullopt;
+    }
+    return Point2LL(a.X + std::llround(center_x), a.Y + std::llround(center_y));
+}
+
+/*!
+ * Check whether an arc around a center from one point of the polyline to another is close enough to the points in
+ * between and the segments between them.
+ * \param[out] clockwise Whether the arc goes clockwise, if it fits.
+ */
+bool arcFits(
+    const Point2LL& start,
+    const std::vector<Point2LL>& points,
+    const size_t first,
+    const size_t last,
+    const Point2LL& center,
+    const coord_t max_deviation,
+    bool& clockwise)
+{
+    const double radius = std::sqrt(vSize2f(pointAt(start, points, first) - center));
+    if (radius > max_arc_radius)
+    {
+        return false;
+    }
+    const double deviation = static_cast<double>(max_deviation);
+    double sweep = 0.0;
+    for (size_t idx = first; idx < last; idx++)
+    {
+        const Point2LL from = pointAt(start, points, idx) - center;
+        const Point2LL to = pointAt(start, points, idx + 1) - center;
+        if (std::abs(std::sqrt(vSize2f(to)) - radius) > deviation)
+        {
+            return false;
+        }
+        const double step = std::atan2(static_cast<double>(cross(from, to)), static_cast<double>(dot(from, to)));
+        if (step == 0.0 || (idx > first && (step < 0.0) != (sweep < 0.0)))
+        {
+            return false; // Not going around the center in the same direction.
+        }
+        sweep += step;
+        // How far the middle of the arc between the two points is from the segment between them.
+        const double half_chord = std::sqrt(vSize2f(to - from)) / 2.0;
+        const double sagitta = radius - std::sqrt(std::max(0.0, radius * radius - half_chord * half_chord));
+        if (sagitta > deviation)
+        {
+            return false;
+        }
+    }
+    if (std::abs(sweep) >= 2.0 * std::numbers::pi - 0.01)
+    {
+        return false; // A full circle can't be told apart from not moving at all.
+    }
+    clockwise = sweep < 0.0;
+    return true;
+}
+
+} // namespace
+
+std::vector<FittedArc> fitArcs(const Point2LL& start, const std::vector<Point2LL>& points, const coord_t max_deviation)
+{
+    std::vector<FittedArc> arcs;
+    size_t first = 0; // Where the next arc could start, where 0 is the start of the polyline.
+    while (first + min_arc_points <= points.size())
+    {
+        std::optional<FittedArc> arc;
+        for (size_t last = first + min_arc_points; last <= points.size() && last - first <= max_arc_points; last++)
+        {
+            const std::optional<Point2LL> center = circumcenter(pointAt(start, points, first), pointAt(start, points, (first + last) / 2), pointAt(start, points, last));
+            bool clockwise = false;
+            if (! center || ! arcFits(start, points, first, last, *center, max_deviation, clockwise))
+            {
+                break;
+            }
+            arc = FittedArc{ .first_idx = first, .last_idx = last - 1, .center = *center, .clockwise = clockwise };
+        }
+        if (! arc)
+        {
+            first++;
+            continue;
+        }
+        arcs.push_back(*arc);
+        first = arc->last_idx + 1;
+    }
+    return arcs;
+}
+
+} // namespace cura
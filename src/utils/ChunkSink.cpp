@@ -0,0 +1,113 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ChunkSink.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace cura
+{
+
+BufferPool::BufferPool(const size_t buffer_size, const size_t max_kept)
+    : buffer_size_(buffer_size)
+    , max_kept_(max_kept)
+{
+}
+
+std::string BufferPool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (! buffers_.empty())
+        {
+            std::string buffer = std::move(buffers_.back());
+            buffers_.pop_back();
+            return buffer;
+        }
+    }
+    std::string buffer;
+    buffer.reserve(buffer_size_);
+    return buffer;
+}
+
+void BufferPool::release(std::string&& buffer)
+{
+    if (buffer.capacity() < buffer_size_)
+    {
+        return; // Not one of ours, or it was moved out of.
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffers_.size() < max_kept_)
+    {
+        buffers_.push_back(std::move(buffer));
+    }
+}
+
+size_t BufferPool::bufferSize() const
+{
+    return buffer_size_;
+}
+
+ChunkSink::ChunkSink(Consumer consumer, const size_t chunk_size)
+    : consumer_(std::move(consumer))
+    , pool_(std::max(size_t(1), chunk_size), kept_buffers)
+    , buffer_(pool_.acquire())
+{
+    buffer_.resize(pool_.bufferSize());
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+void ChunkSink::flush()
+{
+    const size_t count = static_cast<size_t>(pptr() - pbase());
+    if (count > 0)
+    {
+        handOn(count);
+    }
+}
+
+void ChunkSink::discard()
+{
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+BufferPool& ChunkSink::getPool()
+{
+    return pool_;
+}
+
+ChunkSink::int_type ChunkSink::overflow(int_type character)
+{
+    // The buffer is full. Hand on the complete lines, or all of it if it is a single line.
+    const std::string_view collected(pbase(), static_cast<size_t>(pptr() - pbase()));
+    const size_t line_end = collected.rfind('\n');
+    handOn(line_end == std::string_view::npos ? collected.size() : line_end + 1);
+    if (! traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(character);
+        pbump(1);
+    }
+    return traits_type::not_eof(character);
+}
+
+void ChunkSink::handOn(const size_t count)
+{
+    const size_t collected = static_cast<size_t>(pptr() - pbase());
+    std::string next = pool_.acquire();
+    next.resize(pool_.bufferSize());
+    const size_t carried = collected - count;
+    std::memcpy(next.data(), buffer_.data() + count, carried);
+
+    std::string chunk = std::move(buffer_);
+    chunk.resize(count);
+    buffer_ = std::move(next);
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    pbump(static_cast<int>(carried));
+
+    consumer_(std::move(chunk));
+}
+
+} // namespace cura
@@ -0,0 +1,158 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/CompactPolygons.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "utils/AABB.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+CompactPolygons::CompactPolygons(const Polygons& polygons)
+{
+    if (polygons.empty())
+    {
+        return;
+    }
+    auto data = std::make_shared<Data>();
+    data->offsets.reserve(polygons.size() + 1);
+    const size_t point_count = polygons.pointCount();
+    bool compact = true;
+    if (point_count > 0)
+    {
+        const AABB bounding_box(polygons);
+        constexpr coord_t max_offset = std::numeric_limits<uint32_t>::max();
+        compact = bounding_box.max_.X - bounding_box.min_.X <= max_offset && bounding_box.max_.Y - bounding_box.min_.Y <= max_offset;
+        if (compact)
+        {
+            origin_ = bounding_box.min_;
+            data->compact_points.reserve(point_count);
+        }
+        else
+        {
+            data->wide_points.reserve(point_count);
+        }
+    }
+    for (ConstPolygonRef polygon : polygons)
+    {
+        for (const Point2LL& point : polygon)
+        {
+            if (compact)
+            {
+                data->compact_points.push_back(Offset{ static_cast<uint32_t>(point.X - origin_.X), static_cast<uint32_t>(point.Y - origin_.Y) });
+            }
+            else
+            {
+                data->wide_points.push_back(point);
+            }
+        }
+        data->offsets.push_back(data->offsets.back() + polygon.size());
+    }
+    data_ = std::move(data);
+}
+
+Point2LL CompactPolygons::getPoint(const size_t poly_idx, const size_t point_idx) const
+{
+    const size_t idx = data_->offsets[poly_idx] + point_idx;
+    if (! isCompact())
+    {
+        return data_->wide_points[idx];
+    }
+    const Offset& offset = data_->compact_points[idx];
+    return Point2LL(origin_.X + static_cast<coord_t>(offset.X), origin_.Y + static_cast<coord_t>(offset.Y));
+}
+
+Polygons CompactPolygons::toPolygons() const
+{
+    Polygons result;
+    result.reserve(size());
+    for (size_t poly_idx = 0; poly_idx < size(); poly_idx++)
+    {
+        const size_t polygon_size = data_->offsets[poly_idx + 1] - data_->offsets[poly_idx];
+        PolygonRef polygon = result.newPoly();
+        polygon.reserve(polygon_size);
+        for (size_t point_idx = 0; point_idx < polygon_size; point_idx++)
+        {
+            polygon.add(getPoint(poly_idx, point_idx));
+        }
+    }
+    return result;
+}
+
+size_t CompactPolygons::getMemoryFootprint() const
+{
+    if (! data_)
+    {
+        return 0;
+    }
+    return data_->compact_points.capacity() * sizeof(Offset) + data_->wide_points.capacity() * sizeof(Point2LL) + data_->offsets.capacity() * sizeof(size_t);
+}
+
+CompactPolygons CompactPolygonsPool::intern(const Polygons& polygons)
+{
+    CompactPolygons result(polygons);
+    if (! result.data_)
+    {
+        return result;
+    }
+    const uint64_t data_hash = hash(*result.data_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto [begin, end] = entries_.equal_range(data_hash);
+    for (auto entry = begin; entry != end; entry++)
+    {
+        std::shared_ptr<const CompactPolygons::Data> data = entry->second.lock();
+        if (data && *data == *result.data_)
+        {
+            result.data_ = std::move(data);
+            hit_count_.fetch_add(1, std::memory_order_relaxed);
+            return result;
+        }
+    }
+    if (entries_.size() >= prune_size_)
+    {
+        std::erase_if(
+            entries_,
+            [](const auto& entry)
+            {
+                return entry.second.expired();
+            });
+        prune_size_ = std::max(prune_size_, entries_.size() * 2);
+    }
+    entries_.emplace(data_hash, result.data_);
+    return result;
+}
+
+size_t CompactPolygonsPool::hitCount() const
+{
+    return hit_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t CompactPolygonsPool::hash(const CompactPolygons::Data& data)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    };
+    for (const size_t offset : data.offsets)
+    {
+        combine(offset);
+    }
+    for (const CompactPolygons::Offset& point : data.compact_points)
+    {
+        combine(static_cast<uint64_t>(point.X) << 32 | point.Y);
+    }
+    for (const Point2LL& point : data.wide_points)
+    {
+        combine(static_cast<uint64_t>(point.X));
+        combine(static_cast<uint64_t>(point.Y));
+    }
+    return hash;
+}
+
+} // namespace cura
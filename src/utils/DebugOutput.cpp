@@ -0,0 +1,124 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/DebugOutput.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/details/os.h>
+
+#include "utils/AABB.h"
+#include "utils/SVG.h"
+
+namespace cura
+{
+
+namespace
+{
+
+struct SvgOutput
+{
+    std::string directory; //!< Empty if no drawings are written.
+    std::vector<std::pair<LayerIndex::value_type, LayerIndex::value_type>> layer_ranges; //!< Inclusive. Empty to draw all layers.
+};
+
+//! Parses a list of layers and ranges of layers, such as "0,10-12".
+std::vector<std::pair<LayerIndex::value_type, LayerIndex::value_type>> parseLayerRanges(std::string_view layers)
+{
+    std::vector<std::pair<LayerIndex::value_type, LayerIndex::value_type>> layer_ranges;
+    while (! layers.empty())
+    {
+        const size_t comma = layers.find(',');
+        const std::string range(layers.substr(0, comma));
+        layers = comma == std::string_view::npos ? std::string_view() : layers.substr(comma + 1);
+
+        const size_t dash = range.find('-', 1); // Not the sign of a negative layer, such as those of the raft.
+        const LayerIndex::value_type first = std::strtoll(range.c_str(), nullptr, 10);
+        const LayerIndex::value_type last = dash == std::string::npos ? first : std::strtoll(range.c_str() + dash + 1, nullptr, 10);
+        layer_ranges.emplace_back(first, last);
+    }
+    return layer_ranges;
+}
+
+SvgOutput readSvgOutput()
+{
+    return SvgOutput{ .directory = spdlog::details::os::getenv("CURA_ENGINE_DEBUG_SVG_DIR"),
+                      .layer_ranges = parseLayerRanges(spdlog::details::os::getenv("CURA_ENGINE_DEBUG_SVG_LAYERS")) };
+}
+
+std::mutex svg_output_mutex;
+
+SvgOutput& svgOutput()
+{
+    static SvgOutput svg_output = readSvgOutput();
+    return svg_output;
+}
+
+//! Whether any drawings are written, so that the layers don't need to be looked up under the mutex when none are.
+std::atomic<bool> svg_enabled{ ! svgOutput().directory.empty() };
+
+std::atomic<size_t> svg_count{ 0 }; //!< To tell the files of drawings of the same name and layer apart.
+
+} // namespace
+
+bool DebugOutput::svgEnabled(const LayerIndex layer_nr)
+{
+    if (! compiled() || ! svg_enabled.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    std::lock_guard lock(svg_output_mutex);
+    const SvgOutput& svg_output = svgOutput();
+    if (svg_output.directory.empty())
+    {
+        return false;
+    }
+    if (svg_output.layer_ranges.empty())
+    {
+        return true;
+    }
+    for (const auto& [first, last] : svg_output.layer_ranges)
+    {
+        if (layer_nr >= first && layer_nr <= last)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DebugOutput::writeSvg(const std::string_view name, const LayerIndex layer_nr, const AABB& aabb, const std::function<void(SVG&)>& draw)
+{
+    std::filesystem::path directory;
+    {
+        std::lock_guard lock(svg_output_mutex);
+        directory = svgOutput().directory;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        spdlog::warn("Can't write debug drawings to {}: {}", directory.string(), error.message());
+        return;
+    }
+    const std::filesystem::path filename = directory / fmt::format("{}_layer{}_{}.svg", name, layer_nr.value, svg_count.fetch_add(1, std::memory_order_relaxed));
+    SVG svg(filename.string(), aabb);
+    draw(svg);
+}
+
+void DebugOutput::setSvgOutput(std::string directory, const std::string_view layers)
+{
+    std::lock_guard lock(svg_output_mutex);
+    SvgOutput& svg_output = svgOutput();
+    svg_enabled.store(! directory.empty(), std::memory_order_relaxed);
+    svg_output.directory = std::move(directory);
+    svg_output.layer_ranges = parseLayerRanges(layers);
+}
+
+} // namespace cura
@@ -32,6 +32,13 @@ coord_t ExtrusionLine::getLength() const
     return len;
 }
 
+size_t ExtrusionLine::shrinkToFit()
+{
+    const size_t capacity = junctions_.capacity();
+    junctions_.shrink_to_fit();
+    return (capacity - junctions_.capacity()) * sizeof(ExtrusionJunction);
+}
+
 coord_t ExtrusionLine::getMinimalWidth() const
 {
     return std::min_element(
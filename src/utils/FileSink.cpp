@@ -0,0 +1,135 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/FileSink.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+FileSink::FileSink(const size_t buffer_size)
+    : buffer_(std::max(size_t(1), buffer_size))
+{
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+FileSink::~FileSink()
+{
+    close();
+}
+
+bool FileSink::open(const char* filename)
+{
+    close();
+    file_ = std::fopen(filename, "w"); // Text mode, like a std::ofstream.
+    if (file_ == nullptr)
+    {
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    return true;
+}
+
+bool FileSink::isOpen() const
+{
+    return file_ != nullptr;
+}
+
+void FileSink::close()
+{
+    if (file_ == nullptr)
+    {
+        return;
+    }
+    writeBuffer();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool FileSink::overwrite(const size_t offset, const std::string_view data)
+{
+    if (file_ == nullptr || ! writeBuffer())
+    {
+        return false;
+    }
+    if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0)
+    {
+        spdlog::error("Failed to go to byte {} of the output file to write over it.", offset);
+        return false;
+    }
+    const bool written = write(data.data(), data.size());
+    if (std::fseek(file_, 0, SEEK_END) != 0)
+    {
+        spdlog::error("Failed to go back to the end of the output file.");
+        return false;
+    }
+    return written;
+}
+
+FileSink::int_type FileSink::overflow(int_type character)
+{
+    if (! writeBuffer())
+    {
+        return traits_type::eof();
+    }
+    if (! traits_type::eq_int_type(character, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(character);
+        pbump(1);
+    }
+    return traits_type::not_eof(character);
+}
+
+std::streamsize FileSink::xsputn(const char* data, std::streamsize count)
+{
+    const size_t size = static_cast<size_t>(count);
+    if (size <= static_cast<size_t>(epptr() - pptr()))
+    {
+        std::memcpy(pptr(), data, size);
+        pbump(static_cast<int>(count));
+        return count;
+    }
+    if (! writeBuffer())
+    {
+        return 0;
+    }
+    if (size >= buffer_.size()) // Doesn't fit in the buffer at all, so don't bother copying it.
+    {
+        return write(data, size) ? count : 0;
+    }
+    std::memcpy(pptr(), data, size);
+    pbump(static_cast<int>(count));
+    return count;
+}
+
+int FileSink::sync()
+{
+    return writeBuffer() ? 0 : -1;
+}
+
+bool FileSink::write(const char* data, size_t count)
+{
+    if (file_ == nullptr)
+    {
+        return false;
+    }
+    if (std::fwrite(data, 1, count, file_) != count)
+    {
+        spdlog::error("Failed to write {} bytes of g-code to the output file.", count);
+        return false;
+    }
+    return true;
+}
+
+bool FileSink::writeBuffer()
+{
+    const size_t count = static_cast<size_t>(pptr() - pbase());
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return count == 0 || write(buffer_.data(), count);
+}
+
+} // namespace cura
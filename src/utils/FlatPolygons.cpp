@@ -0,0 +1,264 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/FlatPolygons.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+namespace
+{
+
+/*!
+ * The same test as ClipperLib::PointInPolygon, on a span instead of a ClipperLib::Path.
+ * \return 0 if the point is outside of the polygon, 1 if it's inside and -1 if it's on the border.
+ */
+int pointInPolygon(const Point2LL& p, std::span<const Point2LL> polygon)
+{
+    if (polygon.size() < 3)
+    {
+        return 0;
+    }
+    int result = 0;
+    Point2LL p0 = polygon.back();
+    for (const Point2LL& p1 : polygon)
+    {
+        if (p1.Y == p.Y && (p1.X == p.X || (p0.Y == p.Y && ((p1.X > p.X) == (p0.X < p.X)))))
+        {
+            return -1;
+        }
+        if ((p0.Y < p.Y) != (p1.Y < p.Y))
+        {
+            if (p0.X >= p.X && p1.X > p.X)
+            {
+                result = 1 - result;
+            }
+            else if (p0.X >= p.X || p1.X > p.X)
+            {
+                const double cross = static_cast<double>(p0.X - p.X) * static_cast<double>(p1.Y - p.Y) - static_cast<double>(p1.X - p.X) * static_cast<double>(p0.Y - p.Y);
+                if (cross == 0.0)
+                {
+                    return -1;
+                }
+                if ((cross > 0.0) == (p1.Y > p0.Y))
+                {
+                    result = 1 - result;
+                }
+            }
+        }
+        p0 = p1;
+    }
+    return result;
+}
+
+/*!
+ * The same test as pointInPolygon, for the edges from (x0, y0) to (x1, y1) of any number of polygons at once.
+ *
+ * Since the polygons are combined with the even-odd rule, only the total count of edges crossed matters. The loop has
+ * no branches, so that the compiler can vectorize it. The coordinates are doubles, since ClipperLib::PointInPolygon
+ * computes the cross product in doubles too, and coordinates are exact in doubles.
+ *
+ * \return 0 if the point is outside of the polygons, 1 if it's inside and -1 if it's on a border.
+ */
+int pointInEdges(const Point2LL& p, const double* x0, const double* y0, const double* x1, const double* y1, const size_t edge_count)
+{
+    const double px = static_cast<double>(p.X);
+    const double py = static_cast<double>(p.Y);
+    int64_t crossings = 0;
+    int64_t on_border = 0;
+    for (size_t edge_idx = 0; edge_idx < edge_count; edge_idx++)
+    {
+        // Relative to the point, like the differences that ClipperLib::PointInPolygon computes.
+        const double dx0 = x0[edge_idx] - px;
+        const double dy0 = y0[edge_idx] - py;
+        const double dx1 = x1[edge_idx] - px;
+        const double dy1 = y1[edge_idx] - py;
+        const bool straddles = (dy0 < 0.0) != (dy1 < 0.0);
+        const bool right0 = dx0 >= 0.0;
+        const bool right1 = dx1 > 0.0;
+        const bool needs_cross = straddles & (right0 != right1);
+        const double cross = dx0 * dy1 - dx1 * dy0;
+        on_border |= ((dy1 == 0.0) & ((dx1 == 0.0) | ((dy0 == 0.0) & (right1 == (dx0 < 0.0))))) | (needs_cross & (cross == 0.0));
+        crossings += (straddles & right0 & right1) | (needs_cross & ((cross > 0.0) == (dy1 > dy0)));
+    }
+    return on_border ? -1 : static_cast<int>(crossings & 1);
+}
+
+} // namespace
+
+FlatPolygons::FlatPolygons(const Polygons& polygons)
+{
+    reserve(polygons.size(), polygons.pointCount());
+    for (ConstPolygonRef polygon : polygons)
+    {
+        add(std::span<const Point2LL>(polygon.begin(), polygon.end()));
+    }
+}
+
+void FlatPolygons::add(std::span<const Point2LL> polygon)
+{
+    points_.insert(points_.end(), polygon.begin(), polygon.end());
+    offsets_.push_back(points_.size());
+}
+
+void FlatPolygons::reserve(size_t polygon_count, size_t point_count)
+{
+    offsets_.reserve(offsets_.size() + polygon_count);
+    points_.reserve(points_.size() + point_count);
+}
+
+void FlatPolygons::clear()
+{
+    points_.clear();
+    offsets_.resize(1);
+}
+
+Polygons FlatPolygons::toPolygons() const
+{
+    Polygons result;
+    result.reserve(size());
+    for (const std::span<const Point2LL> polygon : *this)
+    {
+        result.emplace_back(polygon.begin(), polygon.end());
+    }
+    return result;
+}
+
+bool FlatPolygons::inside(Point2LL p, bool border_result) const
+{
+    int poly_count_inside = 0;
+    for (const std::span<const Point2LL> polygon : *this)
+    {
+        const int is_inside_this_poly = pointInPolygon(p, polygon);
+        if (is_inside_this_poly == -1)
+        {
+            return border_result;
+        }
+        poly_count_inside += is_inside_this_poly;
+    }
+    return (poly_count_inside % 2) == 1;
+}
+
+std::vector<bool> FlatPolygons::inside(std::span<const Point2LL> points, bool border_result) const
+{
+    return EdgeBandIndex(*this).inside(points, border_result);
+}
+
+EdgeBandIndex::EdgeBandIndex(const FlatPolygons& polygons, size_t band_count)
+{
+    // Polygons with fewer than 3 vertices are never inside, see pointInPolygon.
+    size_t edge_count = 0;
+    coord_t max_y = std::numeric_limits<coord_t>::lowest();
+    min_y_ = std::numeric_limits<coord_t>::max();
+    for (const std::span<const Point2LL> polygon : polygons)
+    {
+        if (polygon.size() < 3)
+        {
+            continue;
+        }
+        edge_count += polygon.size();
+        for (const Point2LL& point : polygon)
+        {
+            min_y_ = std::min(min_y_, point.Y);
+            max_y = std::max(max_y, point.Y);
+        }
+    }
+    if (edge_count == 0)
+    {
+        min_y_ = 0;
+        return;
+    }
+
+    if (band_count == 0)
+    {
+        constexpr size_t edges_per_band = 8;
+        constexpr size_t max_band_count = 1024;
+        band_count = std::clamp(edge_count / edges_per_band, size_t(1), max_band_count);
+    }
+    const coord_t height = max_y - min_y_ + 1;
+    band_height_ = std::max(coord_t(1), (height + static_cast<coord_t>(band_count) - 1) / static_cast<coord_t>(band_count));
+    band_count = static_cast<size_t>((height + band_height_ - 1) / band_height_);
+
+    // Count the edges per band first, so that all of them are stored in one allocation.
+    const auto for_each_edge = [&polygons](auto&& function)
+    {
+        for (const std::span<const Point2LL> polygon : polygons)
+        {
+            if (polygon.size() < 3)
+            {
+                continue;
+            }
+            Point2LL p0 = polygon.back();
+            for (const Point2LL& p1 : polygon)
+            {
+                function(p0, p1);
+                p0 = p1;
+            }
+        }
+    };
+    const auto band_of = [this](const coord_t y)
+    {
+        return static_cast<size_t>((y - min_y_) / band_height_);
+    };
+    band_starts_.assign(band_count + 1, 0);
+    for_each_edge(
+        [&](const Point2LL& p0, const Point2LL& p1)
+        {
+            for (size_t band = band_of(std::min(p0.Y, p1.Y)); band <= band_of(std::max(p0.Y, p1.Y)); band++)
+            {
+                band_starts_[band + 1]++;
+            }
+        });
+    for (size_t band = 0; band < band_count; band++)
+    {
+        band_starts_[band + 1] += band_starts_[band];
+    }
+    const size_t stored_edge_count = band_starts_.back();
+    x0_.resize(stored_edge_count);
+    y0_.resize(stored_edge_count);
+    x1_.resize(stored_edge_count);
+    y1_.resize(stored_edge_count);
+    std::vector<size_t> band_ends(band_starts_.begin(), band_starts_.end() - 1);
+    for_each_edge(
+        [&](const Point2LL& p0, const Point2LL& p1)
+        {
+            for (size_t band = band_of(std::min(p0.Y, p1.Y)); band <= band_of(std::max(p0.Y, p1.Y)); band++)
+            {
+                const size_t edge_idx = band_ends[band]++;
+                x0_[edge_idx] = static_cast<double>(p0.X);
+                y0_[edge_idx] = static_cast<double>(p0.Y);
+                x1_[edge_idx] = static_cast<double>(p1.X);
+                y1_[edge_idx] = static_cast<double>(p1.Y);
+            }
+        });
+}
+
+bool EdgeBandIndex::inside(Point2LL p, bool border_result) const
+{
+    // Points above or below all edges can't be on or inside of any of them.
+    if (p.Y < min_y_ || p.Y >= min_y_ + band_height_ * static_cast<coord_t>(band_starts_.size() - 1))
+    {
+        return false;
+    }
+    const size_t band = static_cast<size_t>((p.Y - min_y_) / band_height_);
+    const size_t first = band_starts_[band];
+    const int result = pointInEdges(p, x0_.data() + first, y0_.data() + first, x1_.data() + first, y1_.data() + first, band_starts_[band + 1] - first);
+    return result == -1 ? border_result : result == 1;
+}
+
+std::vector<bool> EdgeBandIndex::inside(std::span<const Point2LL> points, bool border_result) const
+{
+    std::vector<bool> result(points.size());
+    for (size_t point_idx = 0; point_idx < points.size(); point_idx++)
+    {
+        result[point_idx] = inside(points[point_idx], border_result);
+    }
+    return result;
+}
+
+} // namespace cura
@@ -262,4 +262,27 @@ Point2LL LinearAlg2D::getBisectorVector(const Point2LL& intersect, const Point2L
     return (((a0 * vec_len) / std::max(1LL, vSize(a0))) + ((b0 * vec_len) / std::max(1LL, vSize(b0)))) / 2;
 }
 
+void LinearAlg2D::getDist2LowerBoundsToLineSegments(const Point2LL& from, std::span<const Point2LL> points, const Point2LL& next_point, std::span<coord_t> dist2)
+{
+    assert(dist2.size() == points.size());
+    // How far the point is outside of the range of the segment along one axis, or 0 if it's within it.
+    const auto outside = [](const coord_t from_coord, const coord_t start_coord, const coord_t end_coord)
+    {
+        return std::max(coord_t(0), std::max(std::min(start_coord, end_coord) - from_coord, from_coord - std::max(start_coord, end_coord)));
+    };
+    const size_t segment_count = points.size();
+    for (size_t segment_idx = 0; segment_idx + 1 < segment_count; segment_idx++)
+    {
+        const coord_t dx = outside(from.X, points[segment_idx].X, points[segment_idx + 1].X);
+        const coord_t dy = outside(from.Y, points[segment_idx].Y, points[segment_idx + 1].Y);
+        dist2[segment_idx] = dx * dx + dy * dy;
+    }
+    if (segment_count > 0)
+    {
+        const coord_t dx = outside(from.X, points.back().X, next_point.X);
+        const coord_t dy = outside(from.Y, points.back().Y, next_point.Y);
+        dist2.back() = dx * dx + dy * dy;
+    }
+}
+
 } // namespace cura
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/MemoryBudget.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include <spdlog/details/os.h>
+
+#include "utils/MemoryUsage.h"
+
+namespace cura
+{
+
+namespace
+{
+
+size_t readBudgetBytes()
+{
+    const std::string budget_megabytes = spdlog::details::os::getenv("CURA_ENGINE_MEMORY_BUDGET_MB");
+    if (budget_megabytes.empty())
+    {
+        return 0;
+    }
+    return std::strtoull(budget_megabytes.c_str(), nullptr, 10) * 1024 * 1024;
+}
+
+std::atomic<size_t>& budgetBytes()
+{
+    static std::atomic<size_t> budget_bytes{ readBudgetBytes() };
+    return budget_bytes;
+}
+
+// The last sample, shared by all threads. Two threads may both take a new one at the same time, which is harmless.
+std::atomic<size_t> sampled_resident_bytes{ 0 };
+std::atomic<int64_t> sample_time{ std::numeric_limits<int64_t>::min() }; //!< In nanoseconds of the steady clock.
+
+} // namespace
+
+size_t MemoryBudget::getBudgetBytes()
+{
+    return budgetBytes().load(std::memory_order_relaxed);
+}
+
+void MemoryBudget::setBudgetBytes(const size_t budget_bytes)
+{
+    budgetBytes().store(budget_bytes, std::memory_order_relaxed);
+}
+
+MemoryBudget::Pressure MemoryBudget::getPressure()
+{
+    const size_t budget_bytes = getBudgetBytes();
+    if (budget_bytes == 0)
+    {
+        return Pressure::NONE;
+    }
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    const int64_t last_sample_time = sample_time.load(std::memory_order_relaxed);
+    if (last_sample_time == std::numeric_limits<int64_t>::min() || now - last_sample_time >= std::chrono::nanoseconds(sample_interval).count())
+    {
+        sampled_resident_bytes.store(MemoryUsage::sample().resident_bytes, std::memory_order_relaxed);
+        sample_time.store(now, std::memory_order_relaxed);
+    }
+    return getPressure(sampled_resident_bytes.load(std::memory_order_relaxed), budget_bytes);
+}
+
+MemoryBudget::Pressure MemoryBudget::getPressure(const size_t resident_bytes, const size_t budget_bytes)
+{
+    if (budget_bytes == 0)
+    {
+        return Pressure::NONE;
+    }
+    const double used_fraction = static_cast<double>(resident_bytes) / static_cast<double>(budget_bytes);
+    if (used_fraction >= critical_fraction)
+    {
+        return Pressure::CRITICAL;
+    }
+    if (used_fraction >= high_fraction)
+    {
+        return Pressure::HIGH;
+    }
+    return Pressure::NONE;
+}
+
+size_t MemoryBudget::limitParallelism(const size_t thread_count)
+{
+    if (getPressure() == Pressure::CRITICAL)
+    {
+        return std::max(thread_count / 2, size_t(1));
+    }
+    return std::max(thread_count, size_t(1));
+}
+
+} // namespace cura
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/MemoryUsage.h"
+
+#if defined(__linux__)
+#include <fstream>
+#include <string>
+#elif defined(__APPLE__) && defined(__MACH__)
+#include <mach/mach.h>
+#elif defined(_WIN32)
+#if ! defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#if ! defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+// Windows.h has to come first.
+#include <psapi.h>
+#endif
+
+namespace cura
+{
+
+MemoryUsage MemoryUsage::sample()
+{
+    MemoryUsage usage;
+#if defined(__linux__)
+    // Unlike getrusage, the status has the peak since the last reset, besides what the process holds now.
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        // Lines such as "VmRSS:     1234 kB".
+        if (line.starts_with("VmRSS:"))
+        {
+            usage.resident_bytes = std::stoull(line.substr(6)) * 1024;
+        }
+        else if (line.starts_with("VmHWM:"))
+        {
+            usage.peak_resident_bytes = std::stoull(line.substr(6)) * 1024;
+        }
+    }
+#elif defined(__APPLE__) && defined(__MACH__)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    {
+        usage.resident_bytes = info.resident_size;
+        usage.peak_resident_bytes = info.resident_size_max;
+    }
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        usage.resident_bytes = counters.WorkingSetSize;
+        usage.peak_resident_bytes = counters.PeakWorkingSetSize;
+    }
+#endif
+    return usage;
+}
+
+void MemoryUsage::resetPeak()
+{
+#if defined(__linux__)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5"; // Resets the peak to what the process holds now. Fails silently on kernels before 4.0, which keeps the old peak.
+#endif
+}
+
+} // namespace cura
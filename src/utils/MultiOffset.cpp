@@ -0,0 +1,42 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/MultiOffset.h"
+
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+MultiOffset::MultiOffset(const Polygons& polygons, ClipperLib::JoinType join_type, double miter_limit)
+    : polygons_(polygons)
+    , clipper_(miter_limit, 10.0)
+{
+    // The same set-up as Polygons::offset, except that ClipperOffset::Execute can then be called for any number of distances.
+    clipper_.AddPaths(polygons.unionPolygons().paths, join_type, ClipperLib::etClosedPolygon);
+    clipper_.MiterLimit = miter_limit;
+}
+
+Polygons MultiOffset::offset(coord_t distance)
+{
+    if (distance == 0)
+    {
+        return polygons_;
+    }
+    Polygons ret;
+    clipper_.Execute(ret.paths, distance);
+    return ret;
+}
+
+std::vector<Polygons> MultiOffset::offset(const std::vector<coord_t>& distances)
+{
+    std::vector<Polygons> ret;
+    ret.reserve(distances.size());
+    for (const coord_t distance : distances)
+    {
+        ret.push_back(offset(distance));
+    }
+    return ret;
+}
+
+} // namespace cura
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/PackedExtrusionLine.h"
+
+#include "utils/ExtrusionLine.h"
+
+namespace cura
+{
+
+PackedExtrusionLine::PackedExtrusionLine(size_t inset_idx, bool is_odd, bool is_closed)
+    : inset_idx_(inset_idx)
+    , is_odd_(is_odd)
+    , is_closed_(is_closed)
+{
+}
+
+PackedExtrusionLine::PackedExtrusionLine(const ExtrusionLine& line)
+{
+    assign(line);
+}
+
+void PackedExtrusionLine::assign(const ExtrusionLine& line)
+{
+    inset_idx_ = line.inset_idx_;
+    is_odd_ = line.is_odd_;
+    is_closed_ = line.is_closed_;
+    clear();
+    reserve(line.size());
+    for (const ExtrusionJunction& junction : line.junctions_)
+    {
+        push_back(junction);
+    }
+}
+
+ExtrusionLine PackedExtrusionLine::toExtrusionLine() const
+{
+    ExtrusionLine result;
+    toExtrusionLine(result);
+    return result;
+}
+
+void PackedExtrusionLine::toExtrusionLine(ExtrusionLine& line) const
+{
+    line.inset_idx_ = inset_idx_;
+    line.is_odd_ = is_odd_;
+    line.is_closed_ = is_closed_;
+    line.junctions_.clear();
+    line.junctions_.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+    {
+        line.junctions_.emplace_back(points_[i], widths_[i], perimeter_indices_[i]);
+    }
+}
+
+void PackedExtrusionLine::reserve(size_t junction_count)
+{
+    points_.reserve(junction_count);
+    widths_.reserve(junction_count);
+    perimeter_indices_.reserve(junction_count);
+}
+
+void PackedExtrusionLine::clear()
+{
+    points_.clear();
+    widths_.clear();
+    perimeter_indices_.clear();
+}
+
+coord_t PackedExtrusionLine::getLength() const
+{
+    if (points_.empty())
+    {
+        return 0;
+    }
+    coord_t len = 0;
+    for (size_t i = 1; i < points_.size(); ++i)
+    {
+        len += vSize(points_[i] - points_[i - 1]);
+    }
+    if (is_closed_)
+    {
+        len += vSize(points_.front() - points_.back());
+    }
+    return len;
+}
+
+} // namespace cura
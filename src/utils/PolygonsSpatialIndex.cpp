@@ -0,0 +1,365 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/PolygonsSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/linearAlg2D.h"
+#include "utils/polygon.h"
+
+namespace cura
+{
+
+PolygonsSpatialIndex::PolygonsSpatialIndex(const Polygons& polygons)
+    : polygons_(polygons)
+{
+}
+
+void PolygonsSpatialIndex::ensureBuilt() const
+{
+    std::call_once(
+        built_,
+        [this]()
+        {
+            Grid& grid = grid_;
+            Point2LL min(std::numeric_limits<coord_t>::max(), std::numeric_limits<coord_t>::max());
+            Point2LL max(std::numeric_limits<coord_t>::lowest(), std::numeric_limits<coord_t>::lowest());
+            grid.segments.reserve(polygons_.pointCount());
+            for (size_t poly_idx = 0; poly_idx < polygons_.size(); poly_idx++)
+            {
+                ConstPolygonRef poly = polygons_[poly_idx];
+                for (size_t point_idx = 0; point_idx < poly.size(); point_idx++)
+                {
+                    const Point2LL& point = poly[point_idx];
+                    grid.segments.push_back(Segment{ point, poly[(point_idx + 1) % poly.size()], poly_idx, point_idx });
+                    min = Point2LL(std::min(min.X, point.X), std::min(min.Y, point.Y));
+                    max = Point2LL(std::max(max.X, point.X), std::max(max.Y, point.Y));
+                }
+            }
+            if (grid.segments.empty())
+            {
+                return;
+            }
+
+            // Aim for about one segment per cell, without letting long and thin polygons make a grid with many more cells
+            // than that in one direction.
+            const coord_t extent_x = max.X - min.X;
+            const coord_t extent_y = max.Y - min.Y;
+            const double segment_count = static_cast<double>(grid.segments.size());
+            grid.cell_size = std::max(
+                { coord_t(1),
+                  static_cast<coord_t>(std::ceil(std::sqrt(static_cast<double>(extent_x) * static_cast<double>(extent_y) / segment_count))),
+                  static_cast<coord_t>(std::ceil(static_cast<double>(std::max(extent_x, extent_y)) / segment_count)) });
+            grid.origin = min;
+            grid.width = extent_x / grid.cell_size + 1;
+            grid.height = extent_y / grid.cell_size + 1;
+
+            // Count the segments per cell first, so that all of them are stored in one allocation.
+            const size_t cell_count = static_cast<size_t>(grid.width * grid.height);
+            grid.cell_starts.assign(cell_count + 1, 0);
+            for (const Segment& segment : grid.segments)
+            {
+                forEachCell(
+                    grid,
+                    segment.start,
+                    segment.end,
+                    [&grid](const size_t cell_idx)
+                    {
+                        grid.cell_starts[cell_idx + 1]++;
+                    });
+            }
+            for (size_t cell_idx = 0; cell_idx < cell_count; cell_idx++)
+            {
+                grid.cell_starts[cell_idx + 1] += grid.cell_starts[cell_idx];
+            }
+            grid.cell_segments.resize(grid.cell_starts.back());
+            std::vector<size_t> cell_ends(grid.cell_starts.begin(), grid.cell_starts.end() - 1);
+            for (size_t segment_idx = 0; segment_idx < grid.segments.size(); segment_idx++)
+            {
+                forEachCell(
+                    grid,
+                    grid.segments[segment_idx].start,
+                    grid.segments[segment_idx].end,
+                    [&grid, &cell_ends, segment_idx](const size_t cell_idx)
+                    {
+                        grid.cell_segments[cell_ends[cell_idx]++] = segment_idx;
+                    });
+            }
+        });
+}
+
+template<typename Function>
+void PolygonsSpatialIndex::forEachCell(const Grid& grid, const Point2LL& start, const Point2LL& end, Function&& function)
+{
+    const coord_t min_x = std::min(start.X, end.X);
+    const coord_t max_x = std::max(start.X, end.X);
+    const coord_t min_y = std::min(start.Y, end.Y);
+    const coord_t max_y = std::max(start.Y, end.Y);
+    const coord_t dx = end.X - start.X;
+    const double slope = dx == 0 ? 0.0 : static_cast<double>(end.Y - start.Y) / static_cast<double>(dx);
+    const auto y_at = [&start, slope](const coord_t x)
+    {
+        return static_cast<double>(start.Y) + static_cast<double>(x - start.X) * slope;
+    };
+    // Segments that stick out of the grid only cross the cells along its border.
+    const coord_t first_cell_x = std::max(coord_t(0), (min_x - grid.origin.X) / grid.cell_size);
+    const coord_t last_cell_x = std::min(grid.width - 1, (max_x - grid.origin.X) / grid.cell_size);
+    for (coord_t cell_x = first_cell_x; cell_x <= last_cell_x; cell_x++)
+    {
+        coord_t column_min_y = min_y;
+        coord_t column_max_y = max_y;
+        if (dx != 0)
+        {
+            const coord_t column_min_x = std::max(min_x, grid.origin.X + cell_x * grid.cell_size);
+            const coord_t column_max_x = std::min(max_x, grid.origin.X + (cell_x + 1) * grid.cell_size);
+            const double y0 = y_at(column_min_x);
+            const double y1 = y_at(column_max_x);
+            // One unit of margin against the rounding of the doubles.
+            column_min_y = std::max(min_y, static_cast<coord_t>(std::floor(std::min(y0, y1))) - 1);
+            column_max_y = std::min(max_y, static_cast<coord_t>(std::ceil(std::max(y0, y1))) + 1);
+        }
+        const coord_t first_cell_y = std::max(coord_t(0), (column_min_y - grid.origin.Y) / grid.cell_size);
+        const coord_t last_cell_y = std::min(grid.height - 1, (column_max_y - grid.origin.Y) / grid.cell_size);
+        for (coord_t cell_y = first_cell_y; cell_y <= last_cell_y; cell_y++)
+        {
+            function(static_cast<size_t>(cell_y * grid.width + cell_x));
+        }
+    }
+}
+
+template<typename Visitor>
+void PolygonsSpatialIndex::visitOutward(const Point2LL& from, Visitor&& visit) const
+{
+    const Grid& grid = grid_;
+    // Points outside of the grid start from the closest cell on its border.
+    const coord_t center_x = std::clamp((from.X - grid.origin.X) / grid.cell_size, coord_t(0), grid.width - 1);
+    const coord_t center_y = std::clamp((from.Y - grid.origin.Y) / grid.cell_size, coord_t(0), grid.height - 1);
+    int64_t best_dist2 = std::numeric_limits<int64_t>::max();
+    const auto visit_cell = [&](const coord_t cell_x, const coord_t cell_y)
+    {
+        if (cell_x < 0 || cell_x >= grid.width || cell_y < 0 || cell_y >= grid.height)
+        {
+            return;
+        }
+        const size_t cell_idx = static_cast<size_t>(cell_y * grid.width + cell_x);
+        for (size_t entry_idx = grid.cell_starts[cell_idx]; entry_idx < grid.cell_starts[cell_idx + 1]; entry_idx++)
+        {
+            best_dist2 = visit(grid.cell_segments[entry_idx]);
+        }
+    };
+
+    for (coord_t ring = 0;; ring++)
+    {
+        if (ring == 0)
+        {
+            visit_cell(center_x, center_y);
+        }
+        else
+        {
+            for (coord_t cell_x = center_x - ring; cell_x <= center_x + ring; cell_x++)
+            {
+                visit_cell(cell_x, center_y - ring);
+                visit_cell(cell_x, center_y + ring);
+            }
+            for (coord_t cell_y = center_y - ring + 1; cell_y < center_y + ring; cell_y++)
+            {
+                visit_cell(center_x - ring, cell_y);
+                visit_cell(center_x + ring, cell_y);
+            }
+        }
+
+        // Any segment that hasn't been visited yet only crosses cells outside of the rings so far, so it's at least as far
+        // away as the closest side of the rings that still has cells beyond it.
+        coord_t unvisited_dist = std::numeric_limits<coord_t>::max();
+        if (center_x - ring > 0)
+        {
+            unvisited_dist = std::min(unvisited_dist, from.X - (grid.origin.X + (center_x - ring) * grid.cell_size));
+        }
+        if (center_x + ring < grid.width - 1)
+        {
+            unvisited_dist = std::min(unvisited_dist, grid.origin.X + (center_x + ring + 1) * grid.cell_size - from.X);
+        }
+        if (center_y - ring > 0)
+        {
+            unvisited_dist = std::min(unvisited_dist, from.Y - (grid.origin.Y + (center_y - ring) * grid.cell_size));
+        }
+        if (center_y + ring < grid.height - 1)
+        {
+            unvisited_dist = std::min(unvisited_dist, grid.origin.Y + (center_y + ring + 1) * grid.cell_size - from.Y);
+        }
+        if (unvisited_dist == std::numeric_limits<coord_t>::max())
+        {
+            return; // All cells have been visited.
+        }
+        unvisited_dist = std::max(coord_t(0), unvisited_dist);
+        if (best_dist2 <= unvisited_dist * unvisited_dist)
+        {
+            return;
+        }
+    }
+}
+
+ClosestPolygonPoint PolygonsSpatialIndex::findClosest(Point2LL from) const
+{
+    ensureBuilt();
+    if (grid_.segments.empty())
+    {
+        return ClosestPolygonPoint();
+    }
+    size_t best_segment_idx = grid_.segments.size();
+    Point2LL best_location;
+    int64_t best_dist2 = std::numeric_limits<int64_t>::max();
+    visitOutward(
+        from,
+        [&](const size_t segment_idx)
+        {
+            const Segment& segment = grid_.segments[segment_idx];
+            const Point2LL closest_here = LinearAlg2D::getClosestOnLineSegment(from, segment.start, segment.end);
+            const int64_t dist2 = vSize2(from - closest_here);
+            // Of equally close segments, take the first one, like PolygonUtils::findClosest does.
+            if (dist2 < best_dist2 || (dist2 == best_dist2 && segment_idx < best_segment_idx))
+            {
+                best_dist2 = dist2;
+                best_location = closest_here;
+                best_segment_idx = segment_idx;
+            }
+            return best_dist2;
+        });
+    const Segment& best = grid_.segments[best_segment_idx];
+    return ClosestPolygonPoint(best_location, best.point_idx, polygons_[best.poly_idx], best.poly_idx);
+}
+
+PolygonsPointIndex PolygonsSpatialIndex::findNearestVert(Point2LL from) const
+{
+    ensureBuilt();
+    if (grid_.segments.empty())
+    {
+        return PolygonsPointIndex();
+    }
+    // Every vertex is the start of a segment, and that segment crosses the cell of the vertex.
+    size_t best_segment_idx = grid_.segments.size();
+    int64_t best_dist2 = std::numeric_limits<int64_t>::max();
+    visitOutward(
+        from,
+        [&](const size_t segment_idx)
+        {
+            const int64_t dist2 = vSize2(grid_.segments[segment_idx].start - from);
+            if (dist2 < best_dist2 || (dist2 == best_dist2 && segment_idx < best_segment_idx))
+            {
+                best_dist2 = dist2;
+                best_segment_idx = segment_idx;
+            }
+            return best_dist2;
+        });
+    const Segment& best = grid_.segments[best_segment_idx];
+    return PolygonsPointIndex(&polygons_, best.poly_idx, best.point_idx);
+}
+
+bool PolygonsSpatialIndex::inside(Point2LL p, bool border_result) const
+{
+    ensureBuilt();
+    const Grid& grid = grid_;
+    if (grid.segments.empty() || p.Y < grid.origin.Y || p.Y >= grid.origin.Y + grid.height * grid.cell_size)
+    {
+        return false;
+    }
+
+    // Only the segments that cross the ray from the point to the right can change the outcome, and those are in the row
+    // of cells of the point, from its cell onward.
+    std::vector<size_t> ray_segments;
+    const coord_t cell_y = (p.Y - grid.origin.Y) / grid.cell_size;
+    for (coord_t cell_x = std::max(coord_t(0), (p.X - grid.origin.X) / grid.cell_size); cell_x < grid.width; cell_x++)
+    {
+        const size_t cell_idx = static_cast<size_t>(cell_y * grid.width + cell_x);
+        ray_segments.insert(ray_segments.end(), grid.cell_segments.begin() + grid.cell_starts[cell_idx], grid.cell_segments.begin() + grid.cell_starts[cell_idx + 1]);
+    }
+    std::sort(ray_segments.begin(), ray_segments.end());
+    ray_segments.erase(std::unique(ray_segments.begin(), ray_segments.end()), ray_segments.end());
+
+    // This is ClipperLib::PointInPolygon, one edge at a time. Its outcome for each polygon is the parity of the edges that
+    // the ray crosses, unless the point is on an edge, so Polygons::inside takes the parity of all of them together.
+    bool is_inside = false;
+    for (const size_t segment_idx : ray_segments)
+    {
+        const Segment& segment = grid.segments[segment_idx];
+        if (polygons_[segment.poly_idx].size() < 3)
+        {
+            continue; // ClipperLib skips these polygons.
+        }
+        const Point2LL& ip = segment.start;
+        const Point2LL& ip_next = segment.end;
+        if (ip_next.Y == p.Y && (ip_next.X == p.X || (ip.Y == p.Y && ((ip_next.X > p.X) == (ip.X < p.X)))))
+        {
+            return border_result;
+        }
+        if ((ip.Y < p.Y) == (ip_next.Y < p.Y))
+        {
+            continue;
+        }
+        if (ip.X >= p.X && ip_next.X > p.X)
+        {
+            is_inside = ! is_inside;
+        }
+        else if (ip.X >= p.X || ip_next.X > p.X)
+        {
+            const double d = static_cast<double>(ip.X - p.X) * static_cast<double>(ip_next.Y - p.Y) - static_cast<double>(ip_next.X - p.X) * static_cast<double>(ip.Y - p.Y);
+            if (d == 0)
+            {
+                return border_result;
+            }
+            if ((d > 0) == (ip_next.Y > ip.Y))
+            {
+                is_inside = ! is_inside;
+            }
+        }
+    }
+    return is_inside;
+}
+
+bool PolygonsSpatialIndex::collidesWithLineSegment(Point2LL start, Point2LL end) const
+{
+    if (end == start)
+    {
+        return false; // Zero-length line segments never collide.
+    }
+    ensureBuilt();
+    if (grid_.segments.empty())
+    {
+        return false;
+    }
+
+    const PointMatrix transformation_matrix(end - start);
+    const Point2LL transformed_start = transformation_matrix.apply(start);
+    const Point2LL transformed_end = transformation_matrix.apply(end);
+    bool collides = false;
+    forEachCell(
+        grid_,
+        start,
+        end,
+        [&](const size_t cell_idx)
+        {
+            for (size_t entry_idx = grid_.cell_starts[cell_idx]; ! collides && entry_idx < grid_.cell_starts[cell_idx + 1]; entry_idx++)
+            {
+                const Segment& segment = grid_.segments[grid_.cell_segments[entry_idx]];
+                const Point2LL transformed_segment_start = transformation_matrix.apply(segment.start);
+                const Point2LL transformed_segment_end = transformation_matrix.apply(segment.end);
+                collides = LinearAlg2D::lineSegmentsCollide(transformed_start, transformed_end, transformed_segment_start, transformed_segment_end);
+            }
+        });
+    return collides;
+}
+
+ClosestPolygonPoint PolygonsSpatialIndex::moveInside2(Point2LL& from, const int distance, const int64_t max_dist2) const
+{
+    return PolygonUtils::_moveInside2(findClosest(from), distance, from, max_dist2);
+}
+
+ClosestPolygonPoint PolygonsSpatialIndex::ensureInsideOrOutside(Point2LL& from, const int preferred_dist_inside, const int64_t max_dist2) const
+{
+    const ClosestPolygonPoint closest_polygon_point = moveInside2(from, preferred_dist_inside, max_dist2);
+    return PolygonUtils::ensureInsideOrOutside(polygons_, from, closest_polygon_point, preferred_dist_inside, &polygons_);
+}
+
+} // namespace cura
@@ -8,6 +8,7 @@
 #include <spdlog/spdlog.h>
 
 #include "utils/ExtrusionLine.h"
+#include "utils/FlatPolygons.h"
 #include "utils/Point3D.h"
 #include "utils/polygon.h"
 
@@ -347,9 +348,32 @@ void SVG::writePolygons(const Polygons& polys, const ColorObject color, const do
     }
 }
 
+void SVG::writePolygons(const FlatPolygons& polys, const ColorObject color, const double stroke_width, const bool flush) const
+{
+    for (const std::span<const Point2LL> poly : polys)
+    {
+        writeClosedPath(poly, color, stroke_width);
+    }
+
+    if (flush)
+    {
+        fflush(out_);
+    }
+}
+
 void SVG::writePolygon(ConstPolygonRef poly, const ColorObject color, const double stroke_width, const bool flush) const
 {
-    if (poly.size() == 0)
+    writeClosedPath(std::span<const Point2LL>(poly.begin(), poly.end()), color, stroke_width);
+
+    if (flush)
+    {
+        fflush(out_);
+    }
+}
+
+void SVG::writeClosedPath(std::span<const Point2LL> poly, const ColorObject color, const double stroke_width) const
+{
+    if (poly.empty())
     {
         return;
     }
@@ -379,11 +403,6 @@ void SVG::writePolygon(ConstPolygonRef poly, const ColorObject color, const doub
         p0 = p1;
         i++;
     }
-
-    if (flush)
-    {
-        fflush(out_);
-    }
 }
 
 
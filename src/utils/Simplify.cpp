@@ -4,7 +4,6 @@
 #include "utils/Simplify.h"
 
 #include <limits>
-#include <queue> //Priority queue to prioritise removing unimportant vertices.
 
 namespace cura
 {
@@ -23,64 +22,106 @@ Simplify::Simplify(const Settings& settings)
 {
 }
 
+void Simplify::Scratch::reset(const size_t size)
+{
+    deleted_.assign(size, false);
+    previous_.resize(size);
+    next_.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        previous_[i] = (i + size - 1) % size;
+        next_[i] = (i + 1) % size;
+    }
+    by_importance_.clear();
+}
+
+void Simplify::Scratch::erase(const size_t vertex)
+{
+    deleted_[vertex] = true;
+    next_[previous_[vertex]] = next_[vertex];
+    previous_[next_[vertex]] = previous_[vertex];
+}
+
 Polygons Simplify::polygon(const Polygons& polygons) const
 {
+    Scratch scratch;
     Polygons result;
     for (size_t i = 0; i < polygons.size(); ++i)
     {
-        result.addIfNotEmpty(polygon(polygons[i]));
+        result.addIfNotEmpty(polygon(polygons[i], scratch));
     }
     return result;
 }
 
 Polygon Simplify::polygon(const Polygon& polygon) const
+{
+    Scratch scratch;
+    return this->polygon(polygon, scratch);
+}
+
+Polygon Simplify::polygon(const Polygon& polygon, Scratch& scratch) const
 {
     constexpr bool is_closed = true;
-    return simplify(polygon, is_closed);
+    return simplify(polygon, is_closed, scratch);
 }
 
 ExtrusionLine Simplify::polygon(const ExtrusionLine& polygon) const
+{
+    Scratch scratch;
+    return this->polygon(polygon, scratch);
+}
+
+ExtrusionLine Simplify::polygon(const ExtrusionLine& polygon, Scratch& scratch) const
+{
+    constexpr bool is_closed = true;
+    return simplify(polygon, is_closed, scratch);
+}
+
+PackedExtrusionLine Simplify::polygon(const PackedExtrusionLine& polygon, Scratch& scratch) const
 {
     constexpr bool is_closed = true;
-    return simplify(polygon, is_closed);
+    return simplify(polygon, is_closed, scratch);
 }
 
 Polygons Simplify::polyline(const Polygons& polylines) const
 {
+    Scratch scratch;
     Polygons result;
     for (size_t i = 0; i < polylines.size(); ++i)
     {
-        result.addIfNotEmpty(polyline(polylines[i]));
+        result.addIfNotEmpty(polyline(polylines[i], scratch));
     }
     return result;
 }
 
 Polygon Simplify::polyline(const Polygon& polyline) const
+{
+    Scratch scratch;
+    return this->polyline(polyline, scratch);
+}
+
+Polygon Simplify::polyline(const Polygon& polyline, Scratch& scratch) const
 {
     constexpr bool is_closed = false;
-    return simplify(polyline, is_closed);
+    return simplify(polyline, is_closed, scratch);
 }
 
 ExtrusionLine Simplify::polyline(const ExtrusionLine& polyline) const
 {
-    constexpr bool is_closed = false;
-    return simplify(polyline, is_closed);
+    Scratch scratch;
+    return this->polyline(polyline, scratch);
 }
 
-size_t Simplify::nextNotDeleted(size_t index, const std::vector<bool>& to_delete) const
+ExtrusionLine Simplify::polyline(const ExtrusionLine& polyline, Scratch& scratch) const
 {
-    const size_t size = to_delete.size();
-    for (index = (index + 1) % size; to_delete[index]; index = (index + 1) % size)
-        ; // Changes the index variable in-place until we found one that is not deleted.
-    return index;
+    constexpr bool is_closed = false;
+    return simplify(polyline, is_closed, scratch);
 }
 
-size_t Simplify::previousNotDeleted(size_t index, const std::vector<bool>& to_delete) const
+PackedExtrusionLine Simplify::polyline(const PackedExtrusionLine& polyline, Scratch& scratch) const
 {
-    const size_t size = to_delete.size();
-    for (index = (index + size - 1) % size; to_delete[index]; index = (index + size - 1) % size)
-        ; // Changes the index variable in-place until we found one that is not deleted.
-    return index;
+    constexpr bool is_closed = false;
+    return simplify(polyline, is_closed, scratch);
 }
 
 Polygon Simplify::createEmpty([[maybe_unused]] const Polygon& original) const
@@ -95,6 +136,11 @@ ExtrusionLine Simplify::createEmpty(const ExtrusionLine& original) const
     return result;
 }
 
+PackedExtrusionLine Simplify::createEmpty(const PackedExtrusionLine& original) const
+{
+    return PackedExtrusionLine(original.inset_idx_, original.is_odd_, original.is_closed_);
+}
+
 void Simplify::appendVertex(Polygon& polygon, const Point2LL& vertex) const
 {
     polygon.add(vertex);
@@ -105,6 +151,11 @@ void Simplify::appendVertex(ExtrusionLine& extrusion_line, const ExtrusionJuncti
     extrusion_line.junctions_.push_back(vertex);
 }
 
+void Simplify::appendVertex(PackedExtrusionLine& extrusion_line, const PackedExtrusionLine::ConstJunctionReference vertex) const
+{
+    extrusion_line.push_back(vertex.junction());
+}
+
 const Point2LL& Simplify::getPosition(const Point2LL& vertex) const
 {
     return vertex;
@@ -115,6 +166,11 @@ const Point2LL& Simplify::getPosition(const ExtrusionJunction& vertex) const
     return vertex.p_;
 }
 
+const Point2LL& Simplify::getPosition(const PackedExtrusionLine::ConstJunctionReference vertex) const
+{
+    return vertex.position();
+}
+
 Point2LL Simplify::createIntersection([[maybe_unused]] const Point2LL& before, const Point2LL intersection, [[maybe_unused]] const Point2LL& after) const
 {
     return intersection;
@@ -128,6 +184,14 @@ ExtrusionJunction Simplify::createIntersection(const ExtrusionJunction& before,
     return ExtrusionJunction(intersection, (before.w_ + after.w_) / 2, before.perimeter_index_);
 }
 
+ExtrusionJunction Simplify::createIntersection(
+    const PackedExtrusionLine::ConstJunctionReference before,
+    const Point2LL intersection,
+    const PackedExtrusionLine::ConstJunctionReference after) const
+{
+    return createIntersection(before.junction(), intersection, after.junction());
+}
+
 coord_t Simplify::getAreaDeviation([[maybe_unused]] const Point2LL& before, [[maybe_unused]] const Point2LL& vertex, [[maybe_unused]] const Point2LL& after) const
 {
     return 0; // Fixed-width polygons don't have any deviation.
@@ -176,4 +240,12 @@ coord_t Simplify::getAreaDeviation(const ExtrusionJunction& before, const Extrus
     }
 }
 
+coord_t Simplify::getAreaDeviation(
+    const PackedExtrusionLine::ConstJunctionReference before,
+    const PackedExtrusionLine::ConstJunctionReference vertex,
+    const PackedExtrusionLine::ConstJunctionReference after) const
+{
+    return getAreaDeviation(before.junction(), vertex.junction(), after.junction());
+}
+
 } // namespace cura
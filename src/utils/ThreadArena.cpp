@@ -0,0 +1,195 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ThreadArena.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include <spdlog/details/os.h>
+
+namespace cura
+{
+
+Arena::Arena(size_t block_size, size_t retained_size)
+    : block_size_(block_size)
+    , retained_size_(retained_size)
+{
+}
+
+Arena::~Arena()
+{
+    for (const Block& block : blocks_)
+    {
+        ::operator delete(block.data, std::align_val_t{ alignof(std::max_align_t) });
+    }
+}
+
+void Arena::reset()
+{
+    // Keep the first blocks, as many as fit in the retained size.
+    size_t retained = 0;
+    size_t kept_count = 0;
+    while (kept_count < blocks_.size() && retained + blocks_[kept_count].size <= retained_size_)
+    {
+        retained += blocks_[kept_count].size;
+        kept_count++;
+    }
+    for (size_t block_idx = kept_count; block_idx < blocks_.size(); block_idx++)
+    {
+        ::operator delete(blocks_[block_idx].data, std::align_val_t{ alignof(std::max_align_t) });
+    }
+    blocks_.resize(kept_count);
+    current_block_ = 0;
+    used_ = 0;
+}
+
+size_t Arena::capacity() const
+{
+    size_t result = 0;
+    for (const Block& block : blocks_)
+    {
+        result += block.size;
+    }
+    return result;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+    while (current_block_ < blocks_.size())
+    {
+        const Block& block = blocks_[current_block_];
+        const uintptr_t start = reinterpret_cast<uintptr_t>(block.data) + used_;
+        const size_t padding = (alignment - start % alignment) % alignment;
+        if (used_ + padding + bytes <= block.size)
+        {
+            used_ += padding + bytes;
+            return block.data + used_ - bytes;
+        }
+        current_block_++; // The rest of this block is lost until the next reset.
+        used_ = 0;
+    }
+
+    // Blocks are aligned for any type, so a new one always fits after no padding for the usual alignments.
+    const size_t size = std::max(block_size_, bytes + alignment);
+    std::byte* data = static_cast<std::byte*>(::operator new(size, std::align_val_t{ alignof(std::max_align_t) }));
+    blocks_.push_back(Block{ data, size });
+    current_block_ = blocks_.size() - 1;
+    used_ = 0;
+    return do_allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, size_t, size_t)
+{
+    // Freed all at once by reset().
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+namespace
+{
+
+struct ThreadArenaState
+{
+    Arena arena;
+    size_t scope_depth = 0;
+};
+
+ThreadArenaState& getThreadArenaState()
+{
+    thread_local ThreadArenaState state;
+    return state;
+}
+
+bool isListed(std::string_view list, const std::string_view name)
+{
+    while (! list.empty())
+    {
+        const size_t comma = list.find(',');
+        if (list.substr(0, comma) == name)
+        {
+            return true;
+        }
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+    return false;
+}
+
+struct StagePolicies
+{
+    std::array<std::atomic<ThreadArena::Policy>, N_PROGRESS_STAGES> policies;
+    std::atomic<size_t> current_stage{ 0 };
+
+    StagePolicies()
+    {
+        const std::string arena_stages = spdlog::details::os::getenv("CURA_ENGINE_ARENA_STAGES");
+        for (size_t stage = 0; stage < N_PROGRESS_STAGES; stage++)
+        {
+            const bool use_arena = arena_stages.empty() || isListed(arena_stages, Progress::getStageName(static_cast<Progress::Stage>(stage)));
+            policies[stage].store(use_arena ? ThreadArena::Policy::TASK_ARENA : ThreadArena::Policy::SYSTEM, std::memory_order_relaxed);
+        }
+    }
+};
+
+StagePolicies& getStagePolicies()
+{
+    static StagePolicies stage_policies;
+    return stage_policies;
+}
+
+} // namespace
+
+ThreadArena::Scope::Scope()
+{
+    getThreadArenaState().scope_depth++;
+}
+
+ThreadArena::Scope::~Scope()
+{
+    ThreadArenaState& state = getThreadArenaState();
+    if (--state.scope_depth == 0)
+    {
+        state.arena.reset();
+    }
+}
+
+std::pmr::memory_resource* ThreadArena::resource()
+{
+#ifdef ENABLE_THREAD_ARENA
+    ThreadArenaState& state = getThreadArenaState();
+    if (state.scope_depth > 0)
+    {
+        const StagePolicies& stage_policies = getStagePolicies();
+        if (stage_policies.policies[stage_policies.current_stage.load(std::memory_order_relaxed)].load(std::memory_order_relaxed) == Policy::TASK_ARENA)
+        {
+            return &state.arena;
+        }
+    }
+#endif
+    return std::pmr::get_default_resource();
+}
+
+void ThreadArena::setStage(const Progress::Stage stage)
+{
+    getStagePolicies().current_stage.store(static_cast<size_t>(stage), std::memory_order_relaxed);
+}
+
+ThreadArena::Policy ThreadArena::getPolicy(const Progress::Stage stage)
+{
+    return getStagePolicies().policies[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+}
+
+void ThreadArena::setPolicy(const Progress::Stage stage, const Policy policy)
+{
+    getStagePolicies().policies[static_cast<size_t>(stage)].store(policy, std::memory_order_relaxed);
+}
+
+} // namespace cura
@@ -3,29 +3,210 @@
 
 #include "utils/ThreadPool.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 namespace cura
 {
 
-ThreadPool::ThreadPool(size_t nthreads)
-  : wait_for_new_tasks(true)
+namespace
+{
+
+thread_local size_t current_numa_node = 0; //!< The node that a thread pool pinned this thread to.
+thread_local size_t current_thread_idx = 0; //!< The index of this thread in its thread pool, counting from 1, or 0 outside of one.
+
+#ifdef __linux__
+/*!
+ * Parses a list of CPUs in the format of the Linux sysfs, like "0-3,8,10-11".
+ */
+std::vector<int> parseCpuList(const std::string& cpu_list)
+{
+    std::vector<int> cpus;
+    std::istringstream stream(cpu_list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        const size_t dash = range.find('-');
+        try
+        {
+            const int range_first = std::stoi(range.substr(0, dash));
+            const int range_last = dash == std::string::npos ? range_first : std::stoi(range.substr(dash + 1));
+            for (int cpu = range_first; cpu <= range_last; cpu++)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Whitespace such as the line ending.
+        }
+    }
+    return cpus;
+}
+
+/*!
+ * Finds the CPUs that this process may run on, grouped by NUMA node.
+ */
+std::vector<std::vector<int>> getCpusPerNode()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return {};
+    }
+
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || name.find_first_not_of("0123456789", 4) != std::string::npos)
+        {
+            continue;
+        }
+        std::ifstream cpu_list_file(entry.path() / "cpulist");
+        std::string cpu_list;
+        std::getline(cpu_list_file, cpu_list);
+        std::vector<int> cpus = parseCpuList(cpu_list);
+        std::erase_if(
+            cpus,
+            [&allowed](const int cpu)
+            {
+                return ! CPU_ISSET(cpu, &allowed);
+            });
+        if (! cpus.empty())
+        {
+            nodes.emplace_back(std::stoi(name.substr(4)), std::move(cpus));
+        }
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    std::vector<std::vector<int>> cpus_per_node;
+    for (auto& [node, cpus] : nodes)
+    {
+        cpus_per_node.push_back(std::move(cpus));
+    }
+    if (cpus_per_node.empty())
+    { // No NUMA information, such as in some containers: all CPUs are in one node.
+        cpus_per_node.emplace_back();
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpus_per_node.back().push_back(cpu);
+            }
+        }
+    }
+    return cpus_per_node;
+}
+
+void pinCurrentThread(const int cpu)
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+    {
+        spdlog::warn("Couldn't pin a thread to CPU {}.", cpu);
+    }
+}
+#endif
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t nthreads, bool pin_threads, bool collect_statistics)
+  : tasks(1)
+  , wait_for_new_tasks(true)
+  , statistics_(collect_statistics ? std::make_unique<ThreadPoolStatistics>(nthreads + 1) : nullptr)
 {
+    // The CPU and node of each thread, the calling thread first.
+    std::vector<std::pair<std::optional<int>, size_t>> placements(nthreads + 1, { std::nullopt, 0 });
+    if (pin_threads)
+    {
+#ifdef __linux__
+        std::vector<std::pair<int, size_t>> cpus;
+        const std::vector<std::vector<int>> cpus_per_node = getCpusPerNode();
+        for (size_t node = 0; node < cpus_per_node.size(); node++)
+        {
+            for (const int cpu : cpus_per_node[node])
+            {
+                cpus.emplace_back(cpu, node);
+            }
+        }
+        if (! cpus.empty())
+        {
+            for (size_t thread_idx = 0; thread_idx < placements.size(); thread_idx++)
+            {
+                const auto& [cpu, node] = cpus[thread_idx % cpus.size()];
+                placements[thread_idx] = { cpu, node };
+            }
+            tasks.resize(cpus_per_node.size());
+            pinned_ = true;
+            spdlog::debug("Pinning {} threads to CPUs on {} NUMA nodes.", placements.size(), cpus_per_node.size());
+        }
+#else
+        spdlog::warn("Pinning threads to CPUs is not supported on this platform.");
+#endif
+    }
+
+#ifdef __linux__
+    if (placements[0].first)
+    {
+        pinCurrentThread(*placements[0].first);
+    }
+#endif
+    current_numa_node = placements[0].second;
     for (size_t i = 0 ; i < nthreads; i++)
     {
-        threads.emplace_back(&ThreadPool::worker, this);
+        threads.emplace_back(&ThreadPool::worker, this, placements[i + 1].first, placements[i + 1].second, i + 1);
     }
 }
 
-void ThreadPool::worker()
+size_t ThreadPool::current_node()
+{
+    return current_numa_node;
+}
+
+size_t ThreadPool::current_thread_index()
 {
+    return current_thread_idx;
+}
+
+void ThreadPool::worker(std::optional<int> cpu [[maybe_unused]], size_t node, size_t thread_idx)
+{
+#ifdef __linux__
+    if (cpu)
+    {
+        pinCurrentThread(*cpu);
+    }
+#endif
+    current_numa_node = node;
+    current_thread_idx = thread_idx;
+
     lock_t lock = get_lock();
     work_while(lock, [this, &lock]()
         {
-            while(tasks.empty() && wait_for_new_tasks)
+            while(! has_tasks() && wait_for_new_tasks)
             {  // Wait for a task. Signaled by ThreadPool::push() and ThreadPool::join()
+               const auto idle_start = statistics_ ? ThreadPoolStatistics::clock_t::now() : ThreadPoolStatistics::clock_t::time_point{};
                condition.wait(lock);
+               if (statistics_)
+               {
+                   statistics_->addIdle(current_thread_idx, ThreadPoolStatistics::clock_t::now() - idle_start);
+               }
             }
             // Returns false if the queue is empty and the pool is being disposed
-            return !tasks.empty() || wait_for_new_tasks;
+            return has_tasks() || wait_for_new_tasks;
         });
 }
 
@@ -37,7 +218,7 @@ void ThreadPool::join()
         condition.notify_all();
         work_while(lock, []{ return true; });
     }
-    assert(tasks.empty());
+    assert(! has_tasks());
     for (auto& thread : threads)
     {
         thread.join();
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ThreadPoolStatistics.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+ThreadPoolStatistics::ThreadPoolStatistics(size_t thread_count)
+    : start_(clock_t::now())
+    , idle_times_(thread_count)
+{
+}
+
+void ThreadPoolStatistics::addTask(duration_t queue_wait, duration_t run_time)
+{
+    task_count_++;
+    queue_wait_sum_ += queue_wait;
+    queue_wait_max_ = std::max(queue_wait_max_, queue_wait);
+    const auto microseconds = static_cast<uint64_t>(std::max(run_time.count(), 0.0) * 1e6);
+    task_duration_histogram_[std::min(static_cast<size_t>(std::bit_width(microseconds)), histogram_size - 1)]++;
+}
+
+void ThreadPoolStatistics::addIdle(size_t thread_idx, duration_t idle_time)
+{
+    idle_times_[std::min(thread_idx, idle_times_.size() - 1)] += idle_time;
+}
+
+void ThreadPoolStatistics::addLoop(const std::source_location& site, duration_t wall_time, size_t item_count, const std::vector<duration_t>& busy_times)
+{
+    std::string_view file_name = site.file_name();
+    file_name = file_name.substr(file_name.find_last_of("/\\") + 1); // The full path only makes the report harder to read.
+    LoopSite& loop_site = loop_sites_[fmt::format("{}:{}", file_name, site.line())];
+    loop_site.call_count++;
+    loop_site.item_count += item_count;
+    loop_site.wall_time += wall_time;
+
+    double imbalance = 1.0;
+    if (! busy_times.empty())
+    {
+        const double busy_max = std::max_element(busy_times.begin(), busy_times.end())->count();
+        const double busy_mean = std::accumulate(busy_times.begin(), busy_times.end(), duration_t{}).count() / busy_times.size();
+        if (busy_mean > 0.0)
+        {
+            imbalance = busy_max / busy_mean;
+        }
+    }
+    loop_site.imbalance_sum += imbalance;
+    loop_site.worst_imbalance = std::max(loop_site.worst_imbalance, imbalance);
+}
+
+size_t ThreadPoolStatistics::loopCallCount() const
+{
+    size_t call_count = 0;
+    for (const auto& [site, loop_site] : loop_sites_)
+    {
+        call_count += loop_site.call_count;
+    }
+    return call_count;
+}
+
+void ThreadPoolStatistics::report() const
+{
+    const double elapsed = duration_t(clock_t::now() - start_).count();
+    spdlog::info(
+        "Thread pool ran {} tasks in {:.3f}s. Tasks waited in the queue for {:.3f}ms on average and {:.3f}ms at most.",
+        task_count_,
+        elapsed,
+        task_count_ == 0 ? 0.0 : queue_wait_sum_.count() * 1e3 / task_count_,
+        queue_wait_max_.count() * 1e3);
+
+    std::string histogram;
+    for (size_t bucket = 0; bucket < histogram_size; bucket++)
+    {
+        if (task_duration_histogram_[bucket] == 0)
+        {
+            continue;
+        }
+        const uint64_t upper_bound = uint64_t(1) << bucket;
+        histogram += bucket + 1 < histogram_size ? fmt::format(" <{}µs: {}", upper_bound, task_duration_histogram_[bucket])
+                                                 : fmt::format(" >={}µs: {}", upper_bound / 2, task_duration_histogram_[bucket]);
+    }
+    spdlog::info("Task durations:{}", histogram.empty() ? " none" : histogram);
+
+    std::string idle;
+    for (size_t thread_idx = 0; thread_idx < idle_times_.size(); thread_idx++)
+    {
+        const double idle_percentage = elapsed > 0.0 ? idle_times_[thread_idx].count() * 100.0 / elapsed : 0.0;
+        idle += fmt::format(" {}: {:.1f}%", thread_idx == 0 ? std::string("other") : std::to_string(thread_idx), idle_percentage);
+    }
+    spdlog::info("Idle time per thread:{}", idle);
+
+    std::vector<std::pair<std::string, LoopSite>> loop_sites(loop_sites_.begin(), loop_sites_.end());
+    std::sort(
+        loop_sites.begin(),
+        loop_sites.end(),
+        [](const auto& a, const auto& b)
+        {
+            return a.second.wall_time > b.second.wall_time;
+        });
+    for (const auto& [site, loop_site] : loop_sites)
+    {
+        spdlog::info(
+            "parallel_for at {}: {} calls over {} items took {:.3f}s. The busiest participant ran {:.2f} times as long as the mean, {:.2f} at worst.",
+            site,
+            loop_site.call_count,
+            loop_site.item_count,
+            loop_site.wall_time.count(),
+            loop_site.imbalance_sum / loop_site.call_count,
+            loop_site.worst_imbalance);
+    }
+}
+
+void ThreadPoolStatistics::reset()
+{
+    *this = ThreadPoolStatistics(idle_times_.size());
+}
+
+} // namespace cura
@@ -0,0 +1,175 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/Trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/writer.h>
+#include <spdlog/spdlog.h>
+
+namespace cura
+{
+
+namespace
+{
+
+struct Event
+{
+    const char* name;
+    const char* file;
+    uint_least32_t line;
+    Trace::clock_t::time_point start;
+    Trace::clock_t::time_point end;
+};
+
+//! The events of one thread. Only that thread adds to it, and only while no events are written.
+struct ThreadBuffer
+{
+    std::unique_ptr<Event[]> events = std::make_unique<Event[]>(Trace::buffer_size);
+    std::atomic<size_t> count{ 0 }; //!< How many events were recorded, including the ones that were overwritten.
+};
+
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers; //!< The buffers of all threads that recorded anything, in order of their first event.
+Trace::clock_t::time_point trace_start;
+thread_local ThreadBuffer* thread_buffer = nullptr;
+
+ThreadBuffer& getThreadBuffer()
+{
+    if (thread_buffer == nullptr)
+    {
+        std::lock_guard lock(buffers_mutex);
+        thread_buffer = buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+    }
+    return *thread_buffer;
+}
+
+} // namespace
+
+void Trace::enable()
+{
+    {
+        std::lock_guard lock(buffers_mutex);
+        for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            buffer->count.store(0, std::memory_order_relaxed);
+        }
+        trace_start = clock_t::now();
+    }
+    enabled_.store(true, std::memory_order_release);
+}
+
+void Trace::disable()
+{
+    enabled_.store(false, std::memory_order_release);
+}
+
+void Trace::record(const char* name, const char* file, uint_least32_t line, clock_t::time_point start, clock_t::time_point end)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    const size_t count = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[count % buffer_size] = Event{ .name = name, .file = file, .line = line, .start = start, .end = end };
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+bool Trace::write(const std::filesystem::path& file)
+{
+    std::ofstream stream(file);
+    if (! stream)
+    {
+        spdlog::error("Failed to open {} for the trace.", file.string());
+        return false;
+    }
+    rapidjson::OStreamWrapper stream_wrapper(stream);
+    rapidjson::Writer<rapidjson::OStreamWrapper> writer(stream_wrapper);
+    const auto microseconds = [](const clock_t::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    std::lock_guard lock(buffers_mutex);
+    size_t event_count = 0;
+    size_t overwritten_count = 0;
+    writer.StartObject();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("traceEvents");
+    writer.StartArray();
+    for (size_t thread_idx = 0; thread_idx < buffers.size(); thread_idx++)
+    {
+        ThreadBuffer& buffer = *buffers[thread_idx];
+        const size_t count = buffer.count.load(std::memory_order_acquire);
+        if (count == 0)
+        {
+            continue;
+        }
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("thread_name");
+        writer.Key("ph");
+        writer.String("M");
+        writer.Key("pid");
+        writer.Uint(1);
+        writer.Key("tid");
+        writer.Uint64(thread_idx);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(fmt::format("thread {}", thread_idx).c_str());
+        writer.EndObject();
+        writer.EndObject();
+
+        for (size_t event_idx = count > buffer_size ? count - buffer_size : 0; event_idx < count; event_idx++)
+        {
+            const Event& event = buffer.events[event_idx % buffer_size];
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(event.name);
+            writer.Key("ph");
+            writer.String("X"); // A complete event, with its begin and its duration.
+            writer.Key("ts");
+            writer.Double(microseconds(event.start - trace_start));
+            writer.Key("dur");
+            writer.Double(microseconds(event.end - event.start));
+            writer.Key("pid");
+            writer.Uint(1);
+            writer.Key("tid");
+            writer.Uint64(thread_idx);
+            if (event.file != nullptr)
+            {
+                std::string_view file_name = event.file;
+                file_name = file_name.substr(file_name.find_last_of("/\\") + 1); // The full path only makes the trace harder to read.
+                writer.Key("args");
+                writer.StartObject();
+                writer.Key("site");
+                writer.String(fmt::format("{}:{}", file_name, event.line).c_str());
+                writer.EndObject();
+            }
+            writer.EndObject();
+        }
+        event_count += std::min(count, buffer_size);
+        overwritten_count += count - std::min(count, buffer_size);
+        buffer.count.store(0, std::memory_order_relaxed);
+    }
+    writer.EndArray();
+    writer.EndObject();
+    stream << '\n';
+
+    if (overwritten_count > 0)
+    {
+        spdlog::warn("The trace lost the oldest {} events of threads that recorded more than {}.", overwritten_count, buffer_size);
+    }
+    spdlog::info("Wrote {} events to the trace {}.", event_count, file.string());
+    return static_cast<bool>(stream);
+}
+
+} // namespace cura
@@ -3,6 +3,8 @@
 
 #include "utils/VoronoiUtils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <optional>
 #include <stack>
 
@@ -117,7 +119,14 @@ const VoronoiUtils::Segment& VoronoiUtils::getSourceSegment(const vd_t::cell_typ
 }
 
 
-std::vector<Point2LL> VoronoiUtils::discretizeParabola(const Point2LL& p, const Segment& segment, Point2LL s, Point2LL e, coord_t approximate_step_size, double transitioning_angle)
+std::vector<Point2LL> VoronoiUtils::discretizeParabola(
+    const Point2LL& p,
+    const Segment& segment,
+    Point2LL s,
+    Point2LL e,
+    coord_t approximate_step_size,
+    double transitioning_angle,
+    coord_t max_deviation)
 {
     std::vector<Point2LL> discretized;
     // x is distance of point projected on the segment ab
@@ -174,7 +183,10 @@ std::vector<Point2LL> VoronoiUtils::discretizeParabola(const Point2LL& p, const
         RUN_ONCE(spdlog::warn("Failing to discretize parabola! Must add an apex or one of the endpoints."));
     }
 
-    const coord_t step_count = static_cast<coord_t>(static_cast<double>(std::abs(ex - sx)) / approximate_step_size + 0.5);
+    // The height of the parabola over the segment has a second derivative of 1 / d everywhere, so a step of length L deviates at most L^2 / (8 d) from it.
+    const coord_t max_deviation_step_size = static_cast<coord_t>(std::sqrt(8.0 * static_cast<double>(d) * static_cast<double>(max_deviation)));
+    const coord_t step_size = std::max(approximate_step_size, max_deviation_step_size);
+    const coord_t step_count = static_cast<coord_t>(static_cast<double>(std::abs(ex - sx)) / step_size + 0.5);
 
     discretized.emplace_back(s);
     for (coord_t step = 1; step < step_count; step++)
@@ -3,55 +3,30 @@
 
 #include "utils/VoxelUtils.h"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
 #include "utils/polygonUtils.h"
 
 namespace cura
 {
 
-DilationKernel::DilationKernel(GridPoint3 kernel_size, DilationKernel::Type type)
-    : kernel_size_(kernel_size)
-    , type_(type)
+namespace
 {
-    coord_t mult = kernel_size.x_ * kernel_size.y_ * kernel_size.z_; // multiplier for division to avoid rounding and to avoid use of floating point numbers
-    relative_cells_.reserve(mult);
-    GridPoint3 half_kernel = kernel_size / 2;
-
-    GridPoint3 start = -half_kernel;
-    GridPoint3 end = kernel_size - half_kernel;
-    for (coord_t x = start.x_; x < end.x_; x++)
-    {
-        for (coord_t y = start.y_; y < end.y_; y++)
-        {
-            for (coord_t z = start.z_; z < end.z_; z++)
-            {
-                GridPoint3 current(x, y, z);
-                if (type != Type::CUBE)
-                {
-                    GridPoint3 limit((x < 0) ? start.x_ : end.x_ - 1, (y < 0) ? start.y_ : end.y_ - 1, (z < 0) ? start.z_ : end.z_ - 1);
-                    if (limit.x_ == 0)
-                        limit.x_ = 1;
-                    if (limit.y_ == 0)
-                        limit.y_ = 1;
-                    if (limit.z_ == 0)
-                        limit.z_ = 1;
-                    const GridPoint3 rel_dists = mult * current / limit;
-                    if ((type == Type::DIAMOND && rel_dists.x_ + rel_dists.y_ + rel_dists.z_ > mult) || (type == Type::PRISM && rel_dists.x_ + rel_dists.y_ > mult))
-                    {
-                        continue; // don't consider this cell
-                    }
-                }
-                relative_cells_.emplace_back(x, y, z);
-            }
-        }
-    }
-}
 
-bool VoxelUtils::walkLine(Point3LL start, Point3LL end, const std::function<bool(GridPoint3)>& process_cell_func) const
+/*!
+ * Process voxels which a line segment crosses, without the indirection of a std::function.
+ * \see VoxelUtils::walkLine
+ */
+template<typename ProcessCell>
+bool walkLineCells(const VoxelUtils& vu, const Point3LL start, const Point3LL end, ProcessCell&& process_cell_func)
 {
     Point3LL diff = end - start;
 
-    const GridPoint3 start_cell = toGridPoint(start);
-    const GridPoint3 end_cell = toGridPoint(end);
+    const GridPoint3 start_cell = vu.toGridPoint(start);
+    const GridPoint3 end_cell = vu.toGridPoint(end);
     if (start_cell == end_cell)
     {
         return process_cell_func(start_cell);
@@ -75,7 +50,7 @@ bool VoxelUtils::walkLine(Point3LL start, Point3LL end, const std::function<bool
             {
                 continue;
             }
-            coord_t crossing_boundary = toLowerCoord(current_cell[dim], dim) + (diff[dim] > 0) * cell_size_[dim];
+            coord_t crossing_boundary = vu.toLowerCoord(current_cell[dim], dim) + (diff[dim] > 0) * vu.cell_size_[dim];
             double percentage_along_line_here = (crossing_boundary - start[dim]) / static_cast<double>(diff[dim]);
             if (percentage_along_line_here < percentage_along_line)
             {
@@ -94,6 +69,101 @@ bool VoxelUtils::walkLine(Point3LL start, Point3LL end, const std::function<bool
     return true;
 }
 
+//! Sorts runs of voxels by z, y and x, and merges those that overlap or touch.
+std::vector<VoxelSpan> mergeSpans(std::vector<VoxelSpan> spans)
+{
+    std::sort(
+        spans.begin(),
+        spans.end(),
+        [](const VoxelSpan& a, const VoxelSpan& b)
+        {
+            return std::tie(a.z, a.y, a.x_min) < std::tie(b.z, b.y, b.x_min);
+        });
+    std::vector<VoxelSpan> merged;
+    for (const VoxelSpan& span : spans)
+    {
+        if (! merged.empty() && merged.back().z == span.z && merged.back().y == span.y && span.x_min <= merged.back().x_max + 1)
+        {
+            merged.back().x_max = std::max(merged.back().x_max, span.x_max);
+        }
+        else
+        {
+            merged.push_back(span);
+        }
+    }
+    return merged;
+}
+
+//! The runs of voxels that a kernel covers around each of some voxels.
+std::vector<VoxelSpan> dilateToSpans(const std::vector<GridPoint3>& cells, const std::vector<VoxelSpan>& relative_spans)
+{
+    std::vector<VoxelSpan> spans;
+    spans.reserve(cells.size() * relative_spans.size());
+    for (const GridPoint3& cell : cells)
+    {
+        for (const VoxelSpan& rel : relative_spans)
+        {
+            spans.push_back(VoxelSpan{ .x_min = cell.x_ + rel.x_min, .x_max = cell.x_ + rel.x_max, .y = cell.y_ + rel.y, .z = cell.z_ + rel.z });
+        }
+    }
+    return mergeSpans(std::move(spans));
+}
+
+//! A kernel that only covers the voxel itself.
+const std::vector<VoxelSpan> single_cell_spans{ VoxelSpan{ .x_min = 0, .x_max = 0, .y = 0, .z = 0 } };
+
+} // namespace
+
+DilationKernel::DilationKernel(GridPoint3 kernel_size, DilationKernel::Type type)
+    : kernel_size_(kernel_size)
+    , type_(type)
+{
+    coord_t mult = kernel_size.x_ * kernel_size.y_ * kernel_size.z_; // multiplier for division to avoid rounding and to avoid use of floating point numbers
+    relative_cells_.reserve(mult);
+    GridPoint3 half_kernel = kernel_size / 2;
+
+    GridPoint3 start = -half_kernel;
+    GridPoint3 end = kernel_size - half_kernel;
+    for (coord_t x = start.x_; x < end.x_; x++)
+    {
+        for (coord_t y = start.y_; y < end.y_; y++)
+        {
+            for (coord_t z = start.z_; z < end.z_; z++)
+            {
+                GridPoint3 current(x, y, z);
+                if (type != Type::CUBE)
+                {
+                    GridPoint3 limit((x < 0) ? start.x_ : end.x_ - 1, (y < 0) ? start.y_ : end.y_ - 1, (z < 0) ? start.z_ : end.z_ - 1);
+                    if (limit.x_ == 0)
+                        limit.x_ = 1;
+                    if (limit.y_ == 0)
+                        limit.y_ = 1;
+                    if (limit.z_ == 0)
+                        limit.z_ = 1;
+                    const GridPoint3 rel_dists = mult * current / limit;
+                    if ((type == Type::DIAMOND && rel_dists.x_ + rel_dists.y_ + rel_dists.z_ > mult) || (type == Type::PRISM && rel_dists.x_ + rel_dists.y_ > mult))
+                    {
+                        continue; // don't consider this cell
+                    }
+                }
+                relative_cells_.emplace_back(x, y, z);
+            }
+        }
+    }
+
+    std::vector<VoxelSpan> cell_spans;
+    cell_spans.reserve(relative_cells_.size());
+    for (const GridPoint3& rel : relative_cells_)
+    {
+        cell_spans.push_back(VoxelSpan{ .x_min = rel.x_, .x_max = rel.x_, .y = rel.y_, .z = rel.z_ });
+    }
+    relative_spans_ = mergeSpans(std::move(cell_spans));
+}
+
+bool VoxelUtils::walkLine(Point3LL start, Point3LL end, const std::function<bool(GridPoint3)>& process_cell_func) const
+{
+    return walkLineCells(*this, start, end, process_cell_func);
+}
 
 bool VoxelUtils::walkPolygons(const Polygons& polys, coord_t z, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
@@ -161,6 +231,79 @@ bool VoxelUtils::walkDilatedAreas(const Polygons& polys, coord_t z, const Dilati
     return _walkAreas(translated, z + translation.z_, dilate(kernel, process_cell_func));
 }
 
+std::vector<GridPoint3> VoxelUtils::polygonCells(const Polygons& polys, coord_t z) const
+{
+    std::vector<GridPoint3> cells;
+    const auto add_cell = [&cells](const GridPoint3& cell)
+    {
+        if (cells.empty() || cells.back() != cell) // Consecutive segments share their end cells.
+        {
+            cells.push_back(cell);
+        }
+        return true;
+    };
+    for (ConstPolygonRef poly : polys)
+    {
+        Point2LL last = poly.back();
+        for (Point2LL p : poly)
+        {
+            walkLineCells(*this, Point3LL(last.X, last.Y, z), Point3LL(p.X, p.Y, z), add_cell);
+            last = p;
+        }
+    }
+    return cells;
+}
+
+std::vector<GridPoint3> VoxelUtils::areaCells(const Polygons& polys, coord_t z) const
+{
+    std::vector<Point2LL> skin_points = PolygonUtils::spreadDotsArea(polys, Point2LL(cell_size_.x_, cell_size_.y_));
+    std::vector<GridPoint3> cells;
+    cells.reserve(skin_points.size());
+    for (Point2LL p : skin_points)
+    {
+        cells.push_back(toGridPoint(Point3LL(p.X + cell_size_.x_ / 2, p.Y + cell_size_.y_ / 2, z)));
+    }
+    return cells;
+}
+
+std::vector<VoxelSpan> VoxelUtils::rasterizePolygons(const Polygons& polys, coord_t z) const
+{
+    return dilateToSpans(polygonCells(polys, z), single_cell_spans);
+}
+
+std::vector<VoxelSpan> VoxelUtils::rasterizeDilatedPolygons(const Polygons& polys, coord_t z, const DilationKernel& kernel) const
+{
+    Polygons translated = polys;
+    const Point3LL translation = (Point3LL(1, 1, 1) - kernel.kernel_size_ % 2) * cell_size_ / 2;
+    if (translation.x_ && translation.y_)
+    {
+        translated.translate(Point2LL(translation.x_, translation.y_));
+    }
+    return dilateToSpans(polygonCells(translated, z + translation.z_), kernel.relative_spans_);
+}
+
+std::vector<VoxelSpan> VoxelUtils::rasterizeAreas(const Polygons& polys, coord_t z) const
+{
+    Polygons translated = polys;
+    const Point3LL translation = -cell_size_ / 2;
+    if (translation.x_ && translation.y_)
+    {
+        translated.translate(Point2LL(translation.x_, translation.y_));
+    }
+    return dilateToSpans(areaCells(translated, z), single_cell_spans);
+}
+
+std::vector<VoxelSpan> VoxelUtils::rasterizeDilatedAreas(const Polygons& polys, coord_t z, const DilationKernel& kernel) const
+{
+    Polygons translated = polys;
+    const Point3LL translation = (Point3LL(1, 1, 1) - kernel.kernel_size_ % 2) * cell_size_ / 2 - cell_size_ / 2;
+    if (translation.x_ && translation.y_)
+    {
+        translated.translate(Point2LL(translation.x_, translation.y_));
+    }
+    return dilateToSpans(areaCells(translated, z + translation.z_), kernel.relative_spans_);
+}
+
 std::function<bool(GridPoint3)> VoxelUtils::dilate(const DilationKernel& kernel, const std::function<bool(GridPoint3)>& process_cell_func) const
 {
     return [&process_cell_func, &kernel](GridPoint3 loc)
@@ -22,6 +22,7 @@
 #include <range/v3/view/zip.hpp>
 #include <spdlog/spdlog.h>
 
+#include "utils/AABB.h"
 #include "utils/ListPolyIt.h"
 #include "utils/PolylineStitcher.h"
 #include "utils/linearAlg2D.h" // pointLiesOnTheRightOfLine
@@ -29,6 +30,113 @@
 namespace cura
 {
 
+namespace
+{
+
+/*!
+ * Leaves out the paths of which the bounding box doesn't overlap with \p bounds.
+ *
+ * Within those bounds, the area covered by closed paths with either the even-odd or the non-zero rule is the same
+ * without them, and open paths don't cross those bounds, so they can be left out of a boolean operation of which the
+ * result lies within those bounds. The paths are only copied if any are left out.
+ *
+ * \param paths The paths to filter.
+ * \param bounds The bounds of the other operand.
+ * \param filtered Where to store the remaining paths, if any paths were left out.
+ * \return Either \p paths or \p filtered, whichever holds the remaining paths.
+ */
+const ClipperLib::Paths& pathsHitting(const ClipperLib::Paths& paths, const AABB& bounds, ClipperLib::Paths& filtered)
+{
+    std::vector<bool> hits(paths.size());
+    bool all_hit = true;
+    for (size_t path_idx = 0; path_idx < paths.size(); path_idx++)
+    {
+        hits[path_idx] = AABB(paths[path_idx]).hit(bounds);
+        all_hit &= hits[path_idx];
+    }
+    if (all_hit)
+    {
+        return paths;
+    }
+    for (size_t path_idx = 0; path_idx < paths.size(); path_idx++)
+    {
+        if (hits[path_idx])
+        {
+            filtered.push_back(paths[path_idx]);
+        }
+    }
+    return filtered;
+}
+
+/*!
+ * Removes the vertices of a path where it turns back onto itself, like Polygons::_removeDegenerateVerts does for each
+ * of its polygons.
+ *
+ * The vertices that are kept are moved towards the front of the path. At most one vertex is kept for each vertex that
+ * is visited, so that never overwrites a vertex that still has to be visited.
+ *
+ * \param path The path to remove the vertices from, in place.
+ * \param for_polyline Whether to leave the endpoints of the path in place.
+ * 
+eturn Whether any vertices were removed.
+ */
+bool removeDegenerateVertsInPlace(ClipperLib::Path& path, const bool for_polyline)
+{
+    if (path.size() < (for_polyline ? 3 : 1))
+    {
+        return false;
+    }
+    const auto is_degenerate = [](const Point2LL& last, const Point2LL& now, const Point2LL& next)
+    {
+        Point2LL last_line = now - last;
+        Point2LL next_line = next - now;
+        return dot(last_line, next_line) == -1 * vSize(last_line) * vSize(next_line);
+    };
+
+    // With polylines, skip the first and last vertex.
+    const size_t start_vertex = for_polyline ? 1 : 0;
+    const size_t end_vertex = for_polyline ? path.size() - 1 : path.size();
+    const Point2LL original_back = path.back();
+    size_t kept = start_vertex; // Everything before the start vertex is kept where it is.
+    bool is_changed = false;
+    for (size_t idx = start_vertex; idx < end_vertex; idx++)
+    {
+        const Point2LL now = path[idx];
+        const Point2LL& last = (kept == 0) ? original_back : path[kept - 1];
+        if (idx + 1 >= path.size() && kept == 0)
+        {
+            break;
+        }
+        const Point2LL& next = (idx + 1 >= path.size()) ? path[0] : path[idx + 1];
+        if (is_degenerate(last, now, next))
+        { // lines are in the opposite direction
+            // don't keep the vert
+            is_changed = true;
+            while (kept > 1 && is_degenerate(path[kept - 2], path[kept - 1], next))
+            {
+                kept--;
+            }
+        }
+        else
+        {
+            path[kept++] = now;
+        }
+    }
+
+    for (size_t idx = end_vertex; idx < path.size(); ++idx)
+    {
+        path[kept++] = path[idx]; // Keep everything after the end vertex.
+    }
+
+    if (is_changed)
+    {
+        path.resize(kept);
+    }
+    return is_changed;
+}
+
+} // namespace
+
 size_t ConstPolygonRef::size() const
 {
     return path->size();
@@ -171,6 +279,20 @@ size_t Polygons::pointCount() const
     return count;
 }
 
+size_t Polygons::shrinkToFit()
+{
+    size_t released_bytes = paths.capacity() * sizeof(ClipperLib::Path);
+    paths.shrink_to_fit();
+    released_bytes -= paths.capacity() * sizeof(ClipperLib::Path);
+    for (ClipperLib::Path& path : paths)
+    {
+        released_bytes += path.capacity() * sizeof(Point2LL);
+        path.shrink_to_fit();
+        released_bytes -= path.capacity() * sizeof(Point2LL);
+    }
+    return released_bytes;
+}
+
 bool Polygons::inside(Point2LL p, bool border_result) const
 {
     int poly_count_inside = 0;
@@ -301,13 +423,53 @@ size_t Polygons::findInside(Point2LL p, bool border_result)
     return ret;
 }
 
+Polygons Polygons::difference(const Polygons& other) const
+{
+    ClipperLib::Paths other_filtered;
+    const ClipperLib::Paths& other_paths = pathsHitting(other.paths, AABB(*this), other_filtered);
+
+    Polygons ret;
+    ClipperLib::Clipper clipper(clipper_init);
+    clipper.AddPaths(paths, ClipperLib::ptSubject, true);
+    clipper.AddPaths(other_paths, ClipperLib::ptClip, true);
+    clipper.Execute(ClipperLib::ctDifference, ret.paths);
+    return ret;
+}
+
+Polygons Polygons::intersection(const Polygons& other) const
+{
+    const AABB bounds(*this);
+    const AABB other_bounds(other);
+    if (! bounds.hit(other_bounds))
+    {
+        return Polygons();
+    }
+    ClipperLib::Paths filtered;
+    const ClipperLib::Paths& these_paths = pathsHitting(paths, other_bounds, filtered);
+    ClipperLib::Paths other_filtered;
+    const ClipperLib::Paths& other_paths = pathsHitting(other.paths, bounds, other_filtered);
+    if (these_paths.empty() || other_paths.empty())
+    {
+        return Polygons();
+    }
+
+    Polygons ret;
+    ClipperLib::Clipper clipper(clipper_init);
+    clipper.AddPaths(these_paths, ClipperLib::ptSubject, true);
+    clipper.AddPaths(other_paths, ClipperLib::ptClip, true);
+    clipper.Execute(ClipperLib::ctIntersection, ret.paths);
+    return ret;
+}
+
 Polygons Polygons::intersectionPolyLines(const Polygons& polylines, bool restitch, const coord_t max_stitch_distance) const
 {
     Polygons split_polylines = polylines.splitPolylinesIntoSegments();
+    ClipperLib::Paths filtered;
+    const ClipperLib::Paths& segments = pathsHitting(split_polylines.paths, AABB(*this), filtered); // Segments away from the area can't intersect it.
 
     ClipperLib::PolyTree result;
     ClipperLib::Clipper clipper(clipper_init);
-    clipper.AddPaths(split_polylines.paths, ClipperLib::ptSubject, false);
+    clipper.AddPaths(segments, ClipperLib::ptSubject, false);
     clipper.AddPaths(paths, ClipperLib::ptClip, true);
     clipper.Execute(ClipperLib::ctIntersection, result);
     Polygons ret;
@@ -463,51 +625,58 @@ Polygons ConstPolygonRef::offset(int distance, ClipperLib::JoinType join_type, d
 
 void PolygonRef::removeColinearEdges(const AngleRadians max_deviation_angle)
 {
-    // TODO: Can be made more efficient (for example, use pointer-types for process-/skip-indices, so we can swap them without copy).
+    ClipperLib::Path& rpath = *path;
+    // The flags are kept between iterations, to reuse their memory.
+    std::vector<bool> process_indices;
+    std::vector<bool> skip_indices;
 
     size_t num_removed_in_iteration = 0;
     do
     {
         num_removed_in_iteration = 0;
 
-        std::vector<bool> process_indices(path->size(), true);
+        process_indices.assign(rpath.size(), true);
 
         bool go = true;
         while (go)
         {
             go = false;
 
-            const auto& rpath = *path;
             const size_t pathlen = rpath.size();
             if (pathlen <= 3)
             {
                 return;
             }
 
-            std::vector<bool> skip_indices(path->size(), false);
+            skip_indices.assign(pathlen, false);
 
-            ClipperLib::Path new_path;
+            // The points that are kept are moved towards the front of the path, in place. That never overwrites a point that still has to be visited, so only the
+            // first point and the point before the current one need to be remembered from before they were overwritten.
+            const Point2LL first = rpath.front();
+            Point2LL prev = rpath.back();
+            size_t kept = 0;
             for (size_t point_idx = 0; point_idx < pathlen; ++point_idx)
             {
+                const Point2LL pt = rpath[point_idx];
+
                 // Don't iterate directly over process-indices, but do it this way, because there are points _in_ process-indices that should nonetheless be skipped:
                 if (! process_indices[point_idx])
                 {
-                    new_path.push_back(rpath[point_idx]);
+                    rpath[kept++] = pt;
+                    prev = pt;
                     continue;
                 }
 
                 // Should skip the last point for this iteration if the old first was removed (which can be seen from the fact that the new first was skipped):
                 if (point_idx == (pathlen - 1) && skip_indices[0])
                 {
-                    skip_indices[new_path.size()] = true;
+                    skip_indices[kept] = true;
                     go = true;
-                    new_path.push_back(rpath[point_idx]);
+                    rpath[kept++] = pt;
                     break;
                 }
 
-                const Point2LL& prev = rpath[(point_idx - 1 + pathlen) % pathlen];
-                const Point2LL& pt = rpath[point_idx];
-                const Point2LL& next = rpath[(point_idx + 1) % pathlen];
+                const Point2LL next = (point_idx + 1 < pathlen) ? rpath[point_idx + 1] : first;
 
                 double angle = LinearAlg2D::getAngleLeft(prev, pt, next); // [0 : 2 * pi]
                 if (angle >= std::numbers::pi)
@@ -519,22 +688,23 @@ void PolygonRef::removeColinearEdges(const AngleRadians max_deviation_angle)
                 // If the angle indicates near-parallel segments ignore the point 'pt'
                 if (angle > max_deviation_angle && angle < std::numbers::pi - max_deviation_angle)
                 {
-                    new_path.push_back(pt);
+                    rpath[kept++] = pt;
+                    prev = pt;
                 }
                 else if (point_idx != (pathlen - 1))
                 {
                     // Skip the next point, since the current one was removed:
-                    skip_indices[new_path.size()] = true;
+                    skip_indices[kept] = true;
                     go = true;
-                    new_path.push_back(next);
+                    rpath[kept++] = next;
+                    prev = next;
                     ++point_idx;
                 }
             }
-            *path = new_path;
-            num_removed_in_iteration += pathlen - path->size();
+            rpath.resize(kept);
+            num_removed_in_iteration += pathlen - kept;
 
-            process_indices.clear();
-            process_indices.insert(process_indices.end(), skip_indices.begin(), skip_indices.end());
+            std::swap(process_indices, skip_indices);
         }
     } while (num_removed_in_iteration > 0);
 }
@@ -711,69 +881,38 @@ void Polygons::removeDegenerateVertsPolyline()
 
 void Polygons::_removeDegenerateVerts(const bool for_polyline)
 {
-    Polygons& thiss = *this;
     for (size_t poly_idx = 0; poly_idx < size(); poly_idx++)
     {
-        PolygonRef poly = thiss[poly_idx];
-        Polygon result;
-
-        auto isDegenerate = [](const Point2LL& last, const Point2LL& now, const Point2LL& next)
-        {
-            Point2LL last_line = now - last;
-            Point2LL next_line = next - now;
-            return dot(last_line, next_line) == -1 * vSize(last_line) * vSize(next_line);
-        };
-
-        // With polylines, skip the first and last vertex.
-        const size_t start_vertex = for_polyline ? 1 : 0;
-        const size_t end_vertex = for_polyline ? poly.size() - 1 : poly.size();
-        for (size_t i = 0; i < start_vertex; ++i)
+        if (removeDegenerateVertsInPlace(paths[poly_idx], for_polyline) && ! for_polyline && paths[poly_idx].size() <= 2)
         {
-            result.add(poly[i]); // Add everything before the start vertex.
+            remove(poly_idx);
+            poly_idx--; // effectively the next iteration has the same poly_idx (referring to a new poly which is not yet processed)
         }
+    }
+}
 
-        bool isChanged = false;
-        for (size_t idx = start_vertex; idx < end_vertex; idx++)
+void Polygons::cleanUp(const AngleRadians max_deviation_angle, const double min_area_size)
+{
+    size_t kept = 0;
+    for (size_t poly_idx = 0; poly_idx < paths.size(); poly_idx++)
+    {
+        ClipperLib::Path& path = paths[poly_idx];
+        if (removeDegenerateVertsInPlace(path, false) && path.size() <= 2)
         {
-            const Point2LL& last = (result.size() == 0) ? poly.back() : result.back();
-            if (idx + 1 >= poly.size() && result.size() == 0)
-            {
-                break;
-            }
-            const Point2LL& next = (idx + 1 >= poly.size()) ? result[0] : poly[idx + 1];
-            if (isDegenerate(last, poly[idx], next))
-            { // lines are in the opposite direction
-                // don't add vert to the result
-                isChanged = true;
-                while (result.size() > 1 && isDegenerate(result[result.size() - 2], result.back(), next))
-                {
-                    result.pop_back();
-                }
-            }
-            else
-            {
-                result.add(poly[idx]);
-            }
+            continue;
         }
-
-        for (size_t i = end_vertex; i < poly.size(); ++i)
+        PolygonRef(path).removeColinearEdges(max_deviation_angle);
+        if (path.size() < 3 || std::abs(INT2MM2(ClipperLib::Area(path))) < min_area_size)
         {
-            result.add(poly[i]); // Add everything after the end vertex.
+            continue;
         }
-
-        if (isChanged)
+        if (kept != poly_idx)
         {
-            if (for_polyline || result.size() > 2)
-            {
-                *poly = *result;
-            }
-            else
-            {
-                thiss.remove(poly_idx);
-                poly_idx--; // effectively the next iteration has the same poly_idx (referring to a new poly which is not yet processed)
-            }
+            std::swap(paths[kept], path); // Swapping hands the buffer of the removed polygon to the back, where it is freed.
         }
+        kept++;
     }
+    paths.resize(kept);
 }
 
 Polygons Polygons::toPolygons(ClipperLib::PolyTree& poly_tree)
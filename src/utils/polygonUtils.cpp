@@ -3,6 +3,7 @@
 
 #include "utils/polygonUtils.h"
 
+#include <algorithm>
 #include <array>
 #include <list>
 #include <sstream>
@@ -11,19 +12,54 @@
 #include <range/v3/view/enumerate.hpp>
 
 #include "infill.h"
+#include "utils/AABB.h"
 #include "utils/SparsePointGridInclusive.h"
+#include "utils/ThreadPool.h"
 #include "utils/linearAlg2D.h"
 
 #ifdef DEBUG
 #include <spdlog/spdlog.h>
 
-#include "utils/AABB.h"
 #include "utils/SVG.h"
 #endif
 
 namespace cura
 {
 
+namespace
+{
+
+//! The number of cells along each side of the grid that hilbertIndex works on.
+constexpr uint32_t hilbert_curve_size = 1 << 16;
+
+/*!
+ * The position of a cell along a Hilbert curve through a square grid of hilbert_curve_size by hilbert_curve_size cells.
+ * Cells that are close along the curve are close on the grid too.
+ */
+uint64_t hilbertIndex(uint32_t x, uint32_t y)
+{
+    uint64_t index = 0;
+    for (uint32_t half = hilbert_curve_size / 2; half > 0; half /= 2)
+    {
+        const uint32_t right = (x & half) > 0 ? 1 : 0;
+        const uint32_t top = (y & half) > 0 ? 1 : 0;
+        index += static_cast<uint64_t>(half) * half * ((3 * right) ^ top);
+        // Rotate the quadrant, so that the curve through it connects to the curve through the neighbouring quadrants.
+        if (top == 0)
+        {
+            if (right == 1)
+            {
+                x = hilbert_curve_size - 1 - x;
+                y = hilbert_curve_size - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+} // namespace
+
 const std::function<int(Point2LL)> PolygonUtils::no_penalty_function = [](Point2LL)
 {
     return 0;
@@ -918,6 +954,41 @@ ClosestPolygonPoint PolygonUtils::findClosest(Point2LL from, ConstPolygonRef pol
     int64_t closestDist2_score = vSize2(from - best) + penalty_function(best);
     int bestPos = 0;
 
+    if (&penalty_function == &no_penalty_function)
+    {
+        // Without a penalty the score is the distance, so segments that are further away than the closest point found so
+        // far are skipped by their lower bound, in blocks so that the bounds of a block are computed in one go.
+        constexpr size_t block_size = 64;
+        std::array<coord_t, block_size> lower_bounds;
+        const ClipperLib::Path& points = *polygon;
+        for (size_t block_start = 0; block_start < points.size(); block_start += block_size)
+        {
+            const size_t block_end = std::min(points.size(), block_start + block_size);
+            const Point2LL& next_point = points[block_end == points.size() ? 0 : block_end];
+            LinearAlg2D::getDist2LowerBoundsToLineSegments(
+                from,
+                std::span<const Point2LL>(points.data() + block_start, block_end - block_start),
+                next_point,
+                std::span<coord_t>(lower_bounds.data(), block_end - block_start));
+            for (size_t p = block_start; p < block_end; p++)
+            {
+                if (lower_bounds[p - block_start] >= closestDist2_score)
+                {
+                    continue;
+                }
+                const Point2LL closest_here = LinearAlg2D::getClosestOnLineSegment(from, points[p], points[p + 1 == points.size() ? 0 : p + 1]);
+                const int64_t dist2_score = vSize2(from - closest_here);
+                if (dist2_score < closestDist2_score)
+                {
+                    best = closest_here;
+                    closestDist2_score = dist2_score;
+                    bestPos = p;
+                }
+            }
+        }
+        return ClosestPolygonPoint(best, bestPos, polygon);
+    }
+
     for (unsigned int p = 0; p < polygon.size(); p++)
     {
         const Point2LL& p1 = polygon[p];
@@ -1569,19 +1640,72 @@ void PolygonUtils::fixSelfIntersections(const coord_t epsilon, Polygons& thiss)
 
 Polygons PolygonUtils::unionManySmall(const Polygons& p)
 {
-    if (p.paths.size() < 8)
+    // The leaves have a fixed size rather than one that depends on the number of threads, so that the result doesn't either.
+    constexpr size_t leaf_size = 64;
+    if (p.paths.size() <= leaf_size)
     {
         return p.unionPolygons();
     }
+    // Unioning parts separately only gives the same result as unioning all of them at once as long as none of them
+    // subtracts from the others. A hole on its own would be filled instead of cutting out of its outline.
+    for (const ClipperLib::Path& path : p.paths)
+    {
+        if (! ClipperLib::Orientation(path))
+        {
+            return p.unionPolygons();
+        }
+    }
 
-    Polygons a, b;
-    a.paths.reserve(p.paths.size() / 2);
-    b.paths.reserve(a.paths.size() + 1);
-    for (const auto& [i, path] : p.paths | ranges::views::enumerate)
+    // Union polygons that are near each other first, so that the leaves overlap each other as little as possible. The
+    // order of their bounding boxes' centres along a Hilbert curve keeps them together better than a raster order would.
+    const AABB bounds(p);
+    const double scale = static_cast<double>(hilbert_curve_size - 1) / static_cast<double>(std::max(coord_t(1), std::max(bounds.max_.X - bounds.min_.X, bounds.max_.Y - bounds.min_.Y)));
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(p.paths.size());
+    for (const auto& [path_idx, path] : p.paths | ranges::views::enumerate)
     {
-        (i % 2 == 0 ? b : a).paths.push_back(path);
+        const AABB path_bounds(path);
+        const Point2LL middle = (path_bounds.min_ + path_bounds.max_) / 2 - bounds.min_;
+        order.emplace_back(hilbertIndex(static_cast<uint32_t>(static_cast<double>(middle.X) * scale), static_cast<uint32_t>(static_cast<double>(middle.Y) * scale)), path_idx);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<Polygons> level(round_up_divide(p.paths.size(), leaf_size));
+    cura::parallel_for<size_t>(
+        0,
+        level.size(),
+        [&](const size_t leaf_idx)
+        {
+            Polygons leaf;
+            const size_t end = std::min((leaf_idx + 1) * leaf_size, order.size());
+            leaf.paths.reserve(end - leaf_idx * leaf_size);
+            for (size_t order_idx = leaf_idx * leaf_size; order_idx < end; order_idx++)
+            {
+                leaf.paths.push_back(p.paths[order[order_idx].second]);
+            }
+            level[leaf_idx] = leaf.unionPolygons();
+        });
+    // Merge neighbouring unions pairwise, until one is left.
+    while (level.size() > 1)
+    {
+        std::vector<Polygons> next_level(round_up_divide(level.size(), size_t(2)));
+        cura::parallel_for<size_t>(
+            0,
+            next_level.size(),
+            [&](const size_t merged_idx)
+            {
+                if (merged_idx * 2 + 1 < level.size())
+                {
+                    next_level[merged_idx] = level[merged_idx * 2].unionPolygons(level[merged_idx * 2 + 1]);
+                }
+                else
+                {
+                    next_level[merged_idx] = std::move(level[merged_idx * 2]);
+                }
+            });
+        level = std::move(next_level);
     }
-    return unionManySmall(a).unionPolygons(unionManySmall(b));
+    return std::move(level.front());
 }
 
 Polygons PolygonUtils::clipPolygonWithAABB(const Polygons& src, const AABB& aabb)
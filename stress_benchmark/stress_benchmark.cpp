@@ -1,12 +1,16 @@
 // Copyright (c) 2023 UltiMaker
 // CuraEngine is released under the terms of the AGPLv3 or higher
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <csignal>
 #include <docopt/docopt.h>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <string_view>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -33,7 +37,7 @@ constexpr std::string_view USAGE = R"(Stress Benchmark.
 Executes a Stress Benchmark on CuraEngine.
 
 Usage:
-  stress_benchmark -o FILE
+  stress_benchmark -o FILE [-n REPETITIONS] [--baseline FILE] [--tolerance PERCENT]
   stress_benchmark (-h | --help)
   stress_benchmark --version
 
@@ -41,8 +45,27 @@ Options:
   -h --help                      Show this screen.
   --version                      Show version.
   -o FILE                        Specify the output Json file.
+  -n REPETITIONS                 How many times to generate the walls of each test case [default: 1].
+  --baseline FILE                The output Json file of an earlier run, to compare the time and output of each test case with.
+  --tolerance PERCENT            How much slower or different than the baseline a test case may be [default: 10].
 )";
 
+//! What one generation of the walls of a test case measured.
+struct Measurement
+{
+    double seconds;
+    size_t junction_count; //!< The size of the output, as the number of junctions of all walls.
+};
+
+//! The measurements of all repetitions of a test case that didn't crash.
+struct CaseResult
+{
+    std::string name;
+    double median_ms;
+    double p95_ms;
+    size_t junction_count;
+};
+
 struct Resource
 {
     std::filesystem::path wkt_file;
@@ -142,7 +165,7 @@ std::vector<Resource> getResources()
     return resources;
 }
 
-void handleChildProcess(const auto& shapes, const auto& settings)
+void handleChildProcess(const auto& shapes, const auto& settings, const int result_pipe)
 {
     cura::SliceLayer layer;
     for (const cura::Polygons& shape : shapes)
@@ -153,22 +176,88 @@ void handleChildProcess(const auto& shapes, const auto& settings)
     }
     cura::LayerIndex layer_idx(100);
     cura::WallsComputation walls_computation(settings, layer_idx);
+    const auto start = std::chrono::steady_clock::now();
     walls_computation.generateWalls(&layer, cura::SectionType::WALL);
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    Measurement measurement{ .seconds = duration.count(), .junction_count = 0 };
+    for (const cura::SliceLayerPart& part : layer.parts)
+    {
+        for (const cura::VariableWidthLines& inset : part.wall_toolpaths)
+        {
+            for (const cura::ExtrusionLine& line : inset)
+            {
+                measurement.junction_count += line.size();
+            }
+        }
+    }
+    if (write(result_pipe, &measurement, sizeof(measurement)) != sizeof(measurement))
+    {
+        exit(EXIT_FAILURE);
+    }
     exit(EXIT_SUCCESS);
 }
 
-size_t checkCrashCount(size_t crashCount, int status, const auto& resource)
+/*!
+ * Generate the walls of a test case in a separate process, so that a crash or a hang doesn't take the benchmark along.
+ * \return What it measured, or nothing if it crashed.
+ */
+std::optional<Measurement> measureInChildProcess(const auto& shapes, const auto& settings)
 {
-    if (WIFSIGNALED(status))
+    int result_pipe[2];
+    if (pipe(result_pipe) == -1)
+    {
+        spdlog::critical("Unable to create a pipe");
+        exit(EXIT_FAILURE);
+    }
+    pid_t engine_pid = fork();
+    if (engine_pid == -1)
+    {
+        spdlog::critical("Unable to fork - engine");
+        exit(EXIT_FAILURE);
+    }
+    else if (engine_pid == 0)
     {
-        ++crashCount;
-        spdlog::error("# Crash detected for: {}", resource.stem());
+        close(result_pipe[0]);
+        handleChildProcess(shapes, settings, result_pipe[1]);
     }
-    else
+    close(result_pipe[1]);
+
+    pid_t waiter_pid = fork();
+    if (waiter_pid == -1)
+    {
+        spdlog::critical("Unable to fork - waiter");
+        exit(EXIT_FAILURE);
+    }
+    else if (waiter_pid == 0)
     {
-        spdlog::info("+ Test case {} processed normally", resource.stem());
+        sleep(30);
+        kill(engine_pid, SIGKILL);
+        exit(EXIT_SUCCESS);
     }
-    return crashCount;
+
+    int status;
+    waitpid(engine_pid, &status, 0);
+    kill(waiter_pid, SIGKILL); // Not to kill another process that gets the same pid later.
+    waitpid(waiter_pid, nullptr, 0);
+
+    Measurement measurement;
+    const bool measured = read(result_pipe[0], &measurement, sizeof(measurement)) == sizeof(measurement);
+    close(result_pipe[0]);
+    if (WIFSIGNALED(status) || ! measured)
+    {
+        return std::nullopt;
+    }
+    return measurement;
+}
+
+//! Gets the value below which \p percent percent of the values are, of values that are sorted.
+double percentile(const std::vector<double>& sorted_values, const double percent)
+{
+    const double rank = percent / 100.0 * static_cast<double>(sorted_values.size() - 1);
+    const auto lower = static_cast<size_t>(std::floor(rank));
+    const auto upper = static_cast<size_t>(std::ceil(rank));
+    return sorted_values[lower] + (sorted_values[upper] - sorted_values[lower]) * (rank - static_cast<double>(lower));
 }
 
 rapidjson::Value
@@ -190,7 +279,83 @@ rapidjson::Value
     return obj;
 }
 
-void createAndWriteJson(const std::filesystem::path& out_file, double stress_level, const std::string& extra_info, const size_t no_test_cases)
+std::string medianName(const std::string& case_name)
+{
+    return fmt::format("Wall generation {} (median)", case_name);
+}
+
+std::string junctionsName(const std::string& case_name)
+{
+    return fmt::format("Wall junctions {}", case_name);
+}
+
+//! Reads the values of an earlier output Json file by their name.
+std::map<std::string, double> readBaseline(const std::filesystem::path& baseline_file)
+{
+    std::ifstream file{ baseline_file };
+    if (! file)
+    {
+        spdlog::critical("Failed to open the baseline: {}", baseline_file.string());
+        exit(EXIT_FAILURE);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    rapidjson::Document doc;
+    doc.Parse(buffer.str().c_str());
+    if (doc.HasParseError() || ! doc.IsArray())
+    {
+        spdlog::critical("The baseline is not an output of the stress benchmark: {}", baseline_file.string());
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<std::string, double> values;
+    for (const auto& obj : doc.GetArray())
+    {
+        if (obj.IsObject() && obj.HasMember("name") && obj["name"].IsString() && obj.HasMember("value") && obj["value"].IsNumber())
+        {
+            values[obj["name"].GetString()] = obj["value"].GetDouble();
+        }
+    }
+    return values;
+}
+
+/*!
+ * Compare the median time and the output of each test case with the baseline, for the ones that it has.
+ * \return The names of the test cases that are slower, or whose output differs, by more than the tolerance.
+ */
+std::vector<std::string> findRegressions(const std::vector<CaseResult>& results, const std::map<std::string, double>& baseline, const double tolerance_percent)
+{
+    const double tolerance = tolerance_percent / 100.0;
+    std::vector<std::string> regressions;
+    for (const CaseResult& result : results)
+    {
+        bool regressed = false;
+        if (const auto median = baseline.find(medianName(result.name)); median != baseline.end() && result.median_ms > median->second * (1.0 + tolerance))
+        {
+            spdlog::error("# Test case {} took {:.2f} ms, where the baseline took {:.2f} ms", result.name, result.median_ms, median->second);
+            regressed = true;
+        }
+        if (const auto junctions = baseline.find(junctionsName(result.name));
+            junctions != baseline.end() && std::abs(static_cast<double>(result.junction_count) - junctions->second) > junctions->second * tolerance)
+        {
+            spdlog::error("# Test case {} made {} junctions, where the baseline made {}", result.name, result.junction_count, junctions->second);
+            regressed = true;
+        }
+        if (regressed)
+        {
+            regressions.push_back(result.name);
+        }
+    }
+    return regressions;
+}
+
+void createAndWriteJson(
+    const std::filesystem::path& out_file,
+    double stress_level,
+    const std::string& extra_info,
+    const size_t no_test_cases,
+    const std::vector<CaseResult>& results,
+    const std::optional<std::vector<std::string>>& regressions)
 {
     rapidjson::Document doc;
     doc.SetArray();
@@ -201,6 +366,23 @@ void createAndWriteJson(const std::filesystem::path& out_file, double stress_lev
     auto stress_obj = createRapidJSONObject(allocator, "General Stress Level", stress_level, "%", extra_info);
     doc.PushBack(stress_obj, allocator);
 
+    if (regressions)
+    {
+        const std::string regressions_info = fmt::format("Regressions in: {}", fmt::join(*regressions, ", "));
+        auto regressions_obj = createRapidJSONObject(allocator, "Number of regressions", regressions->size(), "-", regressions_info);
+        doc.PushBack(regressions_obj, allocator);
+    }
+
+    for (const CaseResult& result : results)
+    {
+        auto median_obj = createRapidJSONObject(allocator, medianName(result.name), result.median_ms, "ms", "");
+        doc.PushBack(median_obj, allocator);
+        auto p95_obj = createRapidJSONObject(allocator, fmt::format("Wall generation {} (p95)", result.name), result.p95_ms, "ms", "");
+        doc.PushBack(p95_obj, allocator);
+        auto junctions_obj = createRapidJSONObject(allocator, junctionsName(result.name), result.junction_count, "-", "");
+        doc.PushBack(junctions_obj, allocator);
+    }
+
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
     doc.Accept(writer);
@@ -219,12 +401,15 @@ void createAndWriteJson(const std::filesystem::path& out_file, double stress_lev
 int main(int argc, const char** argv)
 {
     constexpr bool show_help = true;
-    constexpr std::string_view version = "0.1.0";
+    constexpr std::string_view version = "0.2.0";
     const std::map<std::string, docopt::value> args = docopt::docopt(fmt::format("{}", USAGE), { argv + 1, argv + argc }, show_help, fmt::format("{}", version));
+    const size_t repetitions = std::max(1L, args.at("-n").asLong());
+    const double tolerance_percent = std::stod(args.at("--tolerance").asString());
 
     const auto resources = getResources();
     size_t crash_count = 0;
     std::vector<std::string> extra_infos;
+    std::vector<CaseResult> results;
 
     for (const auto& resource : resources)
     {
@@ -232,47 +417,48 @@ int main(int argc, const char** argv)
         const auto& settings = resource.settings();
 
         spdlog::critical("Starting test case {}", resource.stem());
-        pid_t engine_pid = fork();
-        if (engine_pid == -1)
+        std::vector<double> times_ms;
+        size_t junction_count = 0;
+        for (size_t repetition = 0; repetition < repetitions; repetition++)
         {
-            spdlog::critical("Unable to fork - engine");
-            return EXIT_FAILURE;
-        }
-        else if (engine_pid == 0)
-        {
-            handleChildProcess(shapes, settings);
-            return EXIT_SUCCESS;
-        }
-        else
-        {
-            pid_t waiter_pid = fork();
-            if (waiter_pid == -1)
-            {
-                spdlog::critical("Unable to fork - waiter");
-                return EXIT_FAILURE;
-            }
-            else if (waiter_pid == 0)
-            {
-                sleep(30);
-                kill(engine_pid, SIGKILL);
-                return EXIT_SUCCESS;
-            }
-            else
+            const std::optional<Measurement> measurement = measureInChildProcess(shapes, settings);
+            if (! measurement)
             {
-                int status;
-                waitpid(engine_pid, &status, 0);
-                const auto old_crash_count = crash_count;
-                crash_count = checkCrashCount(crash_count, status, resource);
-                if (old_crash_count != crash_count)
-                {
-                    extra_infos.emplace_back(resource.stem());
-                }
+                times_ms.clear(); // A test case that crashes doesn't get a time.
+                break;
             }
+            times_ms.push_back(measurement->seconds * 1000.0);
+            junction_count = measurement->junction_count;
         }
+
+        if (times_ms.empty())
+        {
+            ++crash_count;
+            extra_infos.emplace_back(resource.stem());
+            spdlog::error("# Crash detected for: {}", resource.stem());
+            continue;
+        }
+        std::sort(times_ms.begin(), times_ms.end());
+        const CaseResult& result = results.emplace_back(
+            CaseResult{ .name = resource.stem(), .median_ms = percentile(times_ms, 50.0), .p95_ms = percentile(times_ms, 95.0), .junction_count = junction_count });
+        spdlog::info("+ Test case {} processed normally in {:.2f} ms (median), {:.2f} ms (p95)", result.name, result.median_ms, result.p95_ms);
     }
     const double stress_level = static_cast<double>(crash_count) / static_cast<double>(resources.size()) * 100.0;
     spdlog::info("Stress level: {:.2f} [%]", stress_level);
 
-    createAndWriteJson(std::filesystem::path{ args.at("-o").asString() }, stress_level, fmt::format("Crashes in: {}", fmt::join(extra_infos, ", ")), resources.size());
-    return EXIT_SUCCESS;
+    std::optional<std::vector<std::string>> regressions;
+    if (args.at("--baseline"))
+    {
+        regressions = findRegressions(results, readBaseline(args.at("--baseline").asString()), tolerance_percent);
+        spdlog::info("Regressions against the baseline: {}", regressions->size());
+    }
+
+    createAndWriteJson(
+        std::filesystem::path{ args.at("-o").asString() },
+        stress_level,
+        fmt::format("Crashes in: {}", fmt::join(extra_infos, ", ")),
+        resources.size(),
+        results,
+        regressions);
+    return regressions && ! regressions->empty() ? EXIT_FAILURE : EXIT_SUCCESS;
 }
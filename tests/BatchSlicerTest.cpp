@@ -0,0 +1,50 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "BatchSlicer.h" // The class under test.
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(BatchSlicerTest, SplitArguments)
+{
+    EXPECT_EQ(BatchSlicer::splitArguments("  -j printer.def.json\t-l part.stl  "), (std::vector<std::string>{ "-j", "printer.def.json", "-l", "part.stl" }));
+    EXPECT_EQ(BatchSlicer::splitArguments(R"(-o "my part.gcode" -s "" )"), (std::vector<std::string>{ "-o", "my part.gcode", "-s", "" })) << "Quotes must keep whitespace and empty arguments.";
+    EXPECT_TRUE(BatchSlicer::splitArguments("   ").empty());
+}
+
+TEST(BatchSlicerTest, ReadManifest)
+{
+    const std::filesystem::path manifest_path = std::filesystem::temp_directory_path() / "BatchSlicerTest.manifest";
+    std::ofstream(manifest_path) << "# Two parts.\n"
+                                    "-j printer.def.json -l a.stl -o a.gcode\n"
+                                    "\n"
+                                    "-j printer.def.json -l b.stl -o b.gcode\n";
+
+    const std::optional<std::vector<BatchSlicer::Job>> jobs = BatchSlicer::readManifest(manifest_path);
+    std::filesystem::remove(manifest_path);
+    ASSERT_TRUE(jobs);
+    ASSERT_EQ(jobs->size(), 2);
+    EXPECT_EQ((*jobs)[0].line_nr, 2);
+    EXPECT_EQ((*jobs)[1].line_nr, 4);
+    EXPECT_EQ((*jobs)[1].arguments.back(), "b.gcode");
+
+    EXPECT_FALSE(BatchSlicer::readManifest(manifest_path)) << "A missing manifest must be reported.";
+}
+
+#ifndef _WIN32
+TEST(BatchSlicerTest, CountsFailedJobs)
+{
+    const std::vector<BatchSlicer::Job> jobs = { { 1, { "-l", "a.stl" } }, { 2, { "-l", "b.stl" } }, { 3, { "-l", "c.stl" } } };
+    EXPECT_EQ(BatchSlicer("true", 2, 0).run(jobs), 0);
+    EXPECT_EQ(BatchSlicer("false", 2, 0).run(jobs), 3);
+}
+#endif
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "pathPlanning/CombBoundaryCache.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class CombBoundaryCacheTest : public testing::Test
+{
+public:
+    Polygons square;
+    size_t compute_count = 0;
+
+    void SetUp() override
+    {
+        square = makeSquare(Point2LL(1000, 2000), 10000);
+        compute_count = 0;
+    }
+
+    static Polygons makeSquare(const Point2LL& corner, const coord_t size)
+    {
+        Polygons result;
+        result.emplace_back();
+        result.back().emplace_back(corner);
+        result.back().emplace_back(corner + Point2LL(size, 0));
+        result.back().emplace_back(corner + Point2LL(size, size));
+        result.back().emplace_back(corner + Point2LL(0, size));
+        return result;
+    }
+
+    CombBoundaryCache::Key makeKey(const Polygons& outline, const coord_t offset = 400) const
+    {
+        return CombBoundaryCache::Key{ .parameters = { offset, static_cast<coord_t>(outline.size()) }, .polygons = outline };
+    }
+
+    std::shared_ptr<const CombBoundaries> get(const CombBoundaryCache& cache, const Polygons& outline, const coord_t offset = 400)
+    {
+        return cache.get(
+            makeKey(outline, offset),
+            [this, &outline, offset]()
+            {
+                compute_count++;
+                return std::make_shared<const CombBoundaries>(outline.offset(-offset), outline.offset(-offset * 2), offset);
+            });
+    }
+};
+
+TEST_F(CombBoundaryCacheTest, ReuseSameOutline)
+{
+    CombBoundaryCache cache;
+    const std::shared_ptr<const CombBoundaries> first = get(cache, square);
+    const std::shared_ptr<const CombBoundaries> second = get(cache, square);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(compute_count, 1);
+    EXPECT_EQ(cache.hitCount(), 1);
+    EXPECT_EQ(cache.missCount(), 1);
+
+    ASSERT_EQ(first->inside_minimum.size(), 1);
+    EXPECT_EQ(first->parts_view_inside_minimum.size(), 1);
+    EXPECT_TRUE(first->inside_minimum.inside(Point2LL(6000, 7000)));
+    EXPECT_NE(first->inside_loc_to_line_minimum, nullptr);
+    EXPECT_NE(first->inside_loc_to_line_optimal, nullptr);
+}
+
+TEST_F(CombBoundaryCacheTest, ComputeDifferentOutline)
+{
+    CombBoundaryCache cache;
+    const std::shared_ptr<const CombBoundaries> first = get(cache, square);
+    Polygons moved_square = square;
+    moved_square.translate(Point2LL(10, 0));
+    const std::shared_ptr<const CombBoundaries> second = get(cache, moved_square);
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(compute_count, 2);
+    EXPECT_EQ(cache.hitCount(), 0);
+    EXPECT_EQ(cache.missCount(), 2);
+}
+
+TEST_F(CombBoundaryCacheTest, ComputeDifferentParameters)
+{
+    CombBoundaryCache cache;
+    get(cache, square, 400);
+    get(cache, square, 500);
+
+    EXPECT_EQ(compute_count, 2);
+    EXPECT_EQ(cache.hitCount(), 0);
+}
+
+TEST_F(CombBoundaryCacheTest, ForgetOldestWhenFull)
+{
+    CombBoundaryCache cache(2);
+    const Polygons second_square = makeSquare(Point2LL(20000, 0), 5000);
+    const Polygons third_square = makeSquare(Point2LL(40000, 0), 5000);
+    get(cache, square);
+    get(cache, second_square);
+    get(cache, third_square);
+    EXPECT_EQ(compute_count, 3);
+
+    get(cache, third_square);
+    get(cache, second_square);
+    EXPECT_EQ(compute_count, 3);
+
+    get(cache, square);
+    EXPECT_EQ(compute_count, 4);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
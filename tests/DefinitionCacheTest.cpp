@@ -0,0 +1,89 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "communication/DefinitionCache.h" // The class under test.
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class DefinitionCacheTest : public testing::Test
+{
+public:
+    std::filesystem::path directory;
+    std::filesystem::path definition_file;
+
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        definition_file = directory / "printer.def.json";
+        std::ofstream(definition_file) << "{}";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    DefinitionCache::Entry makeEntry() const
+    {
+        DefinitionCache::Entry entry;
+        entry.dependencies.push_back(*DefinitionCache::getDependency(definition_file));
+        entry.search_directories.push_back(directory.string());
+        entry.operations.push_back({ DefinitionCache::Entry::Operation::Type::ADD_EXTRUDER, 1, {}, {} });
+        entry.operations.push_back({ DefinitionCache::Entry::Operation::Type::ADD_SETTING, -1, "layer_height", "0.2" });
+        entry.operations.push_back({ DefinitionCache::Entry::Operation::Type::ADD_SETTING, 1, "machine_nozzle_size", "0.4" });
+        return entry;
+    }
+};
+
+TEST_F(DefinitionCacheTest, RoundTrip)
+{
+    const DefinitionCache cache(directory / "cache");
+    const DefinitionCache::Entry entry = makeEntry();
+    cache.store("key", entry);
+
+    const DefinitionCache next_run(directory / "cache"); // Without the entries in memory, so that they are read from the file.
+    const std::optional<DefinitionCache::Entry> loaded = next_run.load("key");
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ(loaded->search_directories, entry.search_directories);
+    ASSERT_EQ(loaded->operations.size(), entry.operations.size());
+    for (size_t operation_idx = 0; operation_idx < entry.operations.size(); operation_idx++)
+    {
+        EXPECT_EQ(loaded->operations[operation_idx].type, entry.operations[operation_idx].type);
+        EXPECT_EQ(loaded->operations[operation_idx].extruder_nr, entry.operations[operation_idx].extruder_nr);
+        EXPECT_EQ(loaded->operations[operation_idx].key, entry.operations[operation_idx].key);
+        EXPECT_EQ(loaded->operations[operation_idx].value, entry.operations[operation_idx].value);
+    }
+    EXPECT_FALSE(next_run.load("other key")) << "Entries are only found by their own key.";
+}
+
+TEST_F(DefinitionCacheTest, MemoryOnly)
+{
+    const DefinitionCache cache;
+    cache.store("key", makeEntry());
+    const std::optional<DefinitionCache::Entry> loaded = cache.load("key");
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->operations.size(), makeEntry().operations.size());
+
+    std::ofstream(definition_file) << R"({"inherits": "fdmprinter"})";
+    EXPECT_FALSE(cache.load("key")) << "Entries in memory must not be used after the definition file changed either.";
+}
+
+TEST_F(DefinitionCacheTest, OutdatedWhenDependencyChanges)
+{
+    const DefinitionCache cache(directory / "cache");
+    cache.store("key", makeEntry());
+
+    std::ofstream(definition_file) << R"({"inherits": "fdmprinter"})";
+    EXPECT_FALSE(cache.load("key")) << "The entry must not be used after the definition file changed.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,50 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "DraftEstimator.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(DraftEstimatorTest, SampleWeightsEveryLayer)
+{
+    const std::vector<std::pair<size_t, double>> samples = DraftEstimator::getSampleWeights(5, 1);
+
+    ASSERT_EQ(samples.size(), 5);
+    for (size_t layer_nr = 0; layer_nr < samples.size(); layer_nr++)
+    {
+        EXPECT_EQ(samples[layer_nr].first, layer_nr);
+        EXPECT_DOUBLE_EQ(samples[layer_nr].second, 1.0) << "When looking at every layer, each layer only stands for itself.";
+    }
+}
+
+TEST(DraftEstimatorTest, SampleWeightsInterpolate)
+{
+    const std::vector<std::pair<size_t, double>> samples = DraftEstimator::getSampleWeights(10, 4);
+
+    const std::vector<std::pair<size_t, double>> expected = { { 0, 1.0 }, { 1, 2.5 }, { 5, 4.0 }, { 9, 2.5 } };
+    EXPECT_EQ(samples, expected) << "The first two layers and the last one are always looked at, and the layers in between are split between their samples.";
+}
+
+TEST(DraftEstimatorTest, SampleWeightsSumToLayerCount)
+{
+    for (size_t layer_count = 0; layer_count < 50; layer_count++)
+    {
+        for (size_t layer_step = 1; layer_step < 12; layer_step++)
+        {
+            double total_weight = 0.0;
+            for (const auto& [layer_nr, weight] : DraftEstimator::getSampleWeights(layer_count, layer_step))
+            {
+                EXPECT_LT(layer_nr, layer_count);
+                total_weight += weight;
+            }
+            EXPECT_DOUBLE_EQ(total_weight, static_cast<double>(layer_count));
+        }
+    }
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -482,5 +482,31 @@ TEST_F(ExtruderPlanTest, BackPressureCompensationEmptyPlan)
 
     EXPECT_TRUE(extruder_plan.paths_.empty()) << "The paths in the extruder plan should remain empty. Also it shouldn't crash.";
 }
+
+/*!
+ * Tests that the naive time estimates count the move onto each path as well as
+ * the moves between its points.
+ */
+TEST_F(ExtruderPlanTest, NaiveTimeEstimates)
+{
+    extruder_plan.paths_ = path_collection.lines;
+    for (GCodePath& path : extruder_plan.paths_)
+    {
+        const std::pmr::vector<Point2LL> points = path.points;
+        path.points.clear();
+        for (const Point2LL& point : points)
+        {
+            path.addPoint(point);
+        }
+    }
+    EXPECT_NEAR(extruder_plan.paths_[0].length, 1.0, 0.0001) << "The length of a path doesn't include the move to its first point.";
+
+    const TimeMaterialEstimates estimates = extruder_plan.computeNaiveTimeEstimates(Point2LL(0, 0));
+
+    // The lines are 1mm long and the travel moves 0.4mm. The moves onto each path are 0 long, since each path starts where the previous one ends.
+    EXPECT_NEAR(estimates.extrude_time, 3 * 1.0 / 50.0, 0.0001);
+    EXPECT_NEAR(estimates.unretracted_travel_time, 2 * 0.4 / 120.0, 0.0001);
+    EXPECT_NEAR(estimates.material, 3 * 1.0 * 0.1 * 0.4, 0.0001);
+}
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "GCodeBinaryFormat.h" // The functions under test.
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "GCodeOutputWriter.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(GCodeBinaryFormatTest, RoundTripMatchesText)
+{
+    std::string text;
+    std::vector<std::pair<size_t, GCodeOutputWriter::Move>> moves;
+    std::ostringstream expected;
+    for (coord_t line = 0; line < 1000; line++)
+    {
+        const GCodeOutputWriter::Move move{ .x = line * 17 - 5000,
+                                            .y = -line * 3,
+                                            .z = 300 + line / 100,
+                                            .f = 1500.0 + line * 0.37,
+                                            .e = line * 0.0123456789 - 2.0,
+                                            .e_character = line % 2 == 0 ? 'E' : 'A',
+                                            .write_f = line % 3 == 0,
+                                            .write_z = line % 100 == 0,
+                                            .write_e = line % 4 != 0 };
+        text += "G1";
+        moves.emplace_back(text.size(), move);
+        text += "\n";
+        expected << "G1";
+        GCodeOutputWriter::formatMove(expected, move);
+        expected << "\n";
+    }
+    text += ";END\n";
+    expected << ";END\n";
+
+    const std::optional<BinaryGCode> decoded = decodeBinaryGCode(encodeBinaryGCodeFileHeader() + encodeBinaryGCodeBlock(text, moves));
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->gcode, expected.str());
+    EXPECT_TRUE(decoded->metadata.empty());
+}
+
+TEST(GCodeBinaryFormatTest, ValuesWithoutPlainNumber)
+{
+    // These can't be stored as a whole number of units, so they are stored as text.
+    const std::vector<std::pair<size_t, GCodeOutputWriter::Move>> moves{
+        { 2,
+          GCodeOutputWriter::Move{
+              .x = 0, .y = 0, .z = 0, .f = -0.0, .e = std::numeric_limits<double>::infinity(), .e_character = 'E', .write_f = true, .write_z = false, .write_e = true } },
+        { 5, GCodeOutputWriter::Move{ .x = 10, .y = 20, .z = 0, .f = 1e30, .e = -0.000001, .e_character = 'E', .write_f = true, .write_z = false, .write_e = true } },
+    };
+    const std::optional<BinaryGCode> decoded = decodeBinaryGCode(encodeBinaryGCodeFileHeader() + encodeBinaryGCodeBlock("G1\nG1\n", moves));
+    ASSERT_TRUE(decoded);
+
+    std::ostringstream expected;
+    expected << "G1";
+    GCodeOutputWriter::formatMove(expected, moves[0].second);
+    expected << "\nG1";
+    GCodeOutputWriter::formatMove(expected, moves[1].second);
+    expected << "\n";
+    EXPECT_EQ(decoded->gcode, expected.str());
+}
+
+TEST(GCodeBinaryFormatTest, Metadata)
+{
+    const std::string header = ";START_OF_HEADER\r\n;FLAVOR:Griffin\r\n;PRINT.TIME:6666\r\n;SLICE_UUID:a:b\r\n;END_OF_HEADER\r\n";
+    const std::optional<BinaryGCode> decoded = decodeBinaryGCode(encodeBinaryGCodeFileHeader() + encodeBinaryGCodeMetadata(header));
+    ASSERT_TRUE(decoded);
+    const std::vector<std::pair<std::string, std::string>> expected{ { "FLAVOR", "Griffin" }, { "PRINT.TIME", "6666" }, { "SLICE_UUID", "a:b" } };
+    EXPECT_EQ(decoded->metadata, expected);
+    EXPECT_EQ(decoded->gcode, "");
+}
+
+TEST(GCodeBinaryFormatTest, CorruptedDataIsRejected)
+{
+    const std::string file = encodeBinaryGCodeFileHeader() + encodeBinaryGCodeBlock(";LAYER:0\nG1 X10 Y10\n", {});
+    ASSERT_TRUE(decodeBinaryGCode(file));
+
+    for (size_t byte_idx = 0; byte_idx < file.size(); byte_idx++)
+    {
+        std::string corrupted = file;
+        corrupted[byte_idx] ^= 0x10;
+        EXPECT_FALSE(decodeBinaryGCode(corrupted)) << "Byte " << byte_idx << " was changed.";
+    }
+    EXPECT_FALSE(decodeBinaryGCode(file.substr(0, file.size() - 1)));
+}
+
+TEST(GCodeBinaryFormatTest, OutputWriterWritesBinary)
+{
+    std::ostringstream target;
+    std::ostringstream expected;
+    {
+        GCodeOutputWriter writer(&target, 2);
+        writer.buffer() << ";TEXT\n";
+        expected << ";TEXT\n";
+        writer.setBinary(true);
+        writer.submitMetadata(";FLAVOR:Marlin\n");
+        for (coord_t line = 0; line < 100; line++)
+        {
+            const GCodeOutputWriter::Move move{ .x = line * 100, .y = 0, .z = 0, .f = 0, .e = line * 0.1, .e_character = 'E', .write_f = false, .write_z = false, .write_e = true };
+            writer.buffer() << "G1";
+            writer.writeMove(move);
+            writer.buffer() << "\n";
+            expected << "G1";
+            GCodeOutputWriter::formatMove(expected, move);
+            expected << "\n";
+            if (line % 10 == 0)
+            {
+                writer.submit();
+            }
+        }
+    }
+
+    const std::string output = target.str();
+    ASSERT_TRUE(output.starts_with(";TEXT\n"));
+    const std::optional<BinaryGCode> decoded = decodeBinaryGCode(std::string_view(output).substr(6));
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(";TEXT\n" + decoded->gcode, expected.str());
+    const std::vector<std::pair<std::string, std::string>> expected_metadata{ { "FLAVOR", "Marlin" } };
+    EXPECT_EQ(decoded->metadata, expected_metadata);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -449,6 +449,20 @@ TEST_F(GCodeExportTest, EVsMmLinear)
                                                                     "need to multiply by cross-sectional area to convert length to volume.";
 }
 
+TEST_F(GCodeExportTest, DisableOutput)
+{
+    gcode.extruder_attr_[0].filament_area_ = 10.0;
+    gcode.is_volumetric_ = false;
+    gcode.disableOutput();
+
+    gcode.writeComment("Nobody reads this");
+    gcode.writeExtrusion(Point3LL(MM2INT(10), 0, MM2INT(20)), Velocity(50), 1.0, PrintFeatureType::OuterWall);
+
+    EXPECT_TRUE(output.str().empty()) << "No g-code should be written anywhere.";
+    EXPECT_DOUBLE_EQ(gcode.current_e_value_, 1.0) << "The extrusion should still be kept track of, to estimate the material.";
+    EXPECT_EQ(gcode.current_position_, Point3LL(MM2INT(10), 0, MM2INT(20)));
+}
+
 /*
  * Switch extruders, with the following special cases:
  * - No retraction distance.
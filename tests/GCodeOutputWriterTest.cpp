@@ -0,0 +1,124 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "GCodeOutputWriter.h" // The class under test.
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(GCodeOutputWriterTest, WritesChunksInOrder)
+{
+    std::ostringstream target;
+    GCodeOutputWriter writer(&target);
+    std::string expected;
+    for (size_t line = 0; line < 1000; line++)
+    {
+        const std::string code = "G1 X" + std::to_string(line) + "\n";
+        writer.buffer() << code;
+        expected += code;
+        if (line % 10 == 0)
+        {
+            writer.submit();
+        }
+    }
+    writer.flush();
+    EXPECT_EQ(target.str(), expected);
+}
+
+TEST(GCodeOutputWriterTest, FormatsMovesInPlace)
+{
+    std::ostringstream target;
+    std::ostringstream expected;
+    expected << std::fixed;
+    GCodeOutputWriter writer(&target, 3);
+    writer.buffer() << std::fixed;
+    for (coord_t line = 0; line < 1000; line++)
+    {
+        const GCodeOutputWriter::Move move{
+            .x = line * 17, .y = -line * 3, .z = 300, .f = 1500.0 + line, .e = line * 0.0123456789, .e_character = 'E', .write_f = line % 3 == 0, .write_z = line % 5 == 0, .write_e = line % 2 == 0
+        };
+        writer.buffer() << "G1";
+        writer.writeMove(move);
+        writer.buffer() << "\n";
+        expected << "G1";
+        GCodeOutputWriter::formatMove(expected, move);
+        expected << "\n";
+        if (line % 100 == 0)
+        {
+            writer.buffer() << ";LAYER:" << line << "\n";
+            expected << ";LAYER:" << line << "\n";
+            writer.submit();
+        }
+    }
+    writer.flush();
+    EXPECT_EQ(target.str(), expected.str());
+}
+
+TEST(GCodeOutputWriterTest, FormatMove)
+{
+    std::ostringstream out;
+    GCodeOutputWriter::formatMove(out, GCodeOutputWriter::Move{ .x = 10500, .y = 20000, .z = 300, .f = 1500, .e = 1.23456, .e_character = 'E', .write_f = true, .write_z = true, .write_e = true });
+    EXPECT_EQ(out.str(), " F1500 X10.5 Y20 Z0.3 E1.23456");
+}
+
+TEST(GCodeOutputWriterTest, NothingWrittenBeforeSubmit)
+{
+    std::ostringstream target;
+    GCodeOutputWriter writer(&target);
+    writer.buffer() << ";LAYER:0\n";
+    EXPECT_EQ(target.str(), "");
+
+    writer.submit();
+    writer.flush();
+    EXPECT_EQ(target.str(), ";LAYER:0\n");
+}
+
+TEST(GCodeOutputWriterTest, DiscardDropsBuffer)
+{
+    std::ostringstream target;
+    GCodeOutputWriter writer(&target);
+    writer.buffer() << ";LAYER:0\n";
+    writer.flush();
+    writer.buffer() << ";LAYER:1\n";
+    writer.discard();
+    writer.flush();
+    EXPECT_EQ(target.str(), ";LAYER:0\n");
+}
+
+TEST(GCodeOutputWriterTest, SetTargetFlushesPreviousTarget)
+{
+    std::ostringstream first_target;
+    std::ostringstream second_target;
+    {
+        GCodeOutputWriter writer(&first_target);
+        writer.buffer() << ";FIRST\n";
+        writer.submit();
+        writer.setTarget(&second_target);
+        writer.buffer() << ";SECOND\n";
+    } // The destructor writes what is left.
+    EXPECT_EQ(first_target.str(), ";FIRST\n");
+    EXPECT_EQ(second_target.str(), ";SECOND\n");
+}
+
+TEST(GCodeOutputWriterTest, NoTargetDropsOutput)
+{
+    std::ostringstream target;
+    GCodeOutputWriter writer(&target);
+    writer.buffer() << ";BEFORE\n";
+    writer.setTarget(nullptr);
+    writer.buffer() << "G1";
+    writer.writeMove(GCodeOutputWriter::Move{ .x = 1000, .y = 2000, .z = 0, .f = 0.0, .e = 0.0, .e_character = 'E', .write_f = false, .write_z = false, .write_e = false });
+    writer.buffer() << "\n";
+    writer.setBinary(true);
+    writer.flush();
+    EXPECT_EQ(target.str(), ";BEFORE\n") << "Without a target, nothing should be written anywhere.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "mesh.h" // The class under test.
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Application.h" // To start the thread pool.
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class MeshTest : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        Application::getInstance().startThreadPool();
+    }
+
+    /*!
+     * Creates a triangle soup of a grid of squares, where the squares share
+     * their corners (up to some noise below the meld distance), plus a few
+     * degenerate triangles.
+     */
+    static std::vector<Point3LL> gridSoup()
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<coord_t> noise(-5, 5);
+        const auto corner = [&](coord_t x, coord_t y)
+        {
+            return Point3LL(x * 990 + noise(generator), y * 990 + noise(generator), (x * y) % 7 * 90 + noise(generator)); // Multiples of the meld distance, so the noise never crosses a cell border.
+        };
+
+        std::vector<Point3LL> soup;
+        for (coord_t x = -10; x < 10; x++)
+        {
+            for (coord_t y = -10; y < 10; y++)
+            {
+                soup.insert(soup.end(), { corner(x, y), corner(x + 1, y), corner(x + 1, y + 1) });
+                soup.insert(soup.end(), { corner(x, y), corner(x + 1, y + 1), corner(x, y + 1) });
+            }
+            soup.insert(soup.end(), { corner(x, 0), corner(x, 0), corner(x + 1, 0) }); // Will be removed.
+        }
+        return soup;
+    }
+};
+
+TEST_F(MeshTest, AddFacesWeldsLikeAddFace)
+{
+    const std::vector<Point3LL> soup = gridSoup();
+
+    Mesh expected;
+    for (size_t corner_idx = 0; corner_idx < soup.size(); corner_idx += 3)
+    {
+        Point3LL v0 = soup[corner_idx];
+        Point3LL v1 = soup[corner_idx + 1];
+        Point3LL v2 = soup[corner_idx + 2];
+        expected.addFace(v0, v1, v2);
+    }
+    expected.finish();
+
+    Mesh welded;
+    welded.addFaces(soup);
+    welded.finish();
+
+    ASSERT_EQ(welded.vertices_.size(), 21 * 21) << "Corners that are shared between squares must be welded.";
+    ASSERT_EQ(welded.vertices_.size(), expected.vertices_.size());
+    ASSERT_EQ(welded.faces_.size(), expected.faces_.size());
+    for (size_t vertex_idx = 0; vertex_idx < welded.vertices_.size(); vertex_idx++)
+    {
+        EXPECT_EQ(welded.vertices_[vertex_idx].p_, expected.vertices_[vertex_idx].p_) << "Vertices must be created in order of first occurrence.";
+        EXPECT_EQ(welded.vertices_[vertex_idx].connected_faces_, expected.vertices_[vertex_idx].connected_faces_);
+    }
+    for (size_t face_idx = 0; face_idx < welded.faces_.size(); face_idx++)
+    {
+        for (size_t i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(welded.faces_[face_idx].vertex_index_[i], expected.faces_[face_idx].vertex_index_[i]);
+            EXPECT_EQ(welded.faces_[face_idx].connected_face_index_[i], expected.faces_[face_idx].connected_face_index_[i]);
+        }
+    }
+    EXPECT_EQ(welded.min(), expected.min());
+    EXPECT_EQ(welded.max(), expected.max());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
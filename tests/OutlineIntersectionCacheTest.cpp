@@ -0,0 +1,95 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "OutlineIntersectionCache.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "sliceDataStorage.h"
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class OutlineIntersectionCacheTest : public testing::Test
+{
+public:
+    std::vector<SliceLayer> layers;
+
+    void SetUp() override
+    {
+        // A stack of squares that shift to the right and shrink a bit on every layer, with two parts on every third layer.
+        layers.resize(20);
+        for (size_t layer_nr = 0; layer_nr < layers.size(); layer_nr++)
+        {
+            const coord_t shift = layer_nr * 300;
+            addPart(layers[layer_nr], makeSquare(Point2LL(shift, 0), 10000 - layer_nr * 100));
+            if (layer_nr % 3 == 0)
+            {
+                addPart(layers[layer_nr], makeSquare(Point2LL(20000 + shift, 0), 5000));
+            }
+        }
+    }
+
+    static Polygons makeSquare(const Point2LL& corner, const coord_t size)
+    {
+        Polygons result;
+        result.emplace_back();
+        result.back().emplace_back(corner);
+        result.back().emplace_back(corner + Point2LL(size, 0));
+        result.back().emplace_back(corner + Point2LL(size, size));
+        result.back().emplace_back(corner + Point2LL(0, size));
+        return result;
+    }
+
+    static void addPart(SliceLayer& layer, const Polygons& outline)
+    {
+        layer.parts.emplace_back();
+        layer.parts.back().outline.add(outline);
+        layer.parts.back().boundaryBox.calculate(outline);
+    }
+
+    Polygons intersectOneByOne(const LayerIndex first_layer_nr, const LayerIndex last_layer_nr) const
+    {
+        Polygons result = layers[first_layer_nr].getOutlines();
+        for (LayerIndex layer_nr = first_layer_nr + 1; layer_nr <= last_layer_nr; ++layer_nr)
+        {
+            result = result.intersection(layers[layer_nr].getOutlines());
+        }
+        return result;
+    }
+};
+
+TEST_F(OutlineIntersectionCacheTest, SameAsOneByOne)
+{
+    constexpr size_t max_layer_count = 7;
+    OutlineIntersectionCache cache(layers, max_layer_count);
+    for (LayerIndex first_layer_nr = 0; first_layer_nr < LayerIndex(layers.size()); ++first_layer_nr)
+    {
+        for (LayerIndex last_layer_nr = first_layer_nr; last_layer_nr < std::min(LayerIndex(layers.size()), first_layer_nr + max_layer_count); ++last_layer_nr)
+        {
+            const Polygons expected = intersectOneByOne(first_layer_nr, last_layer_nr);
+            const Polygons result = cache.intersection(first_layer_nr, last_layer_nr);
+            EXPECT_NEAR(result.area(), expected.area(), 10.0) << "Layers " << first_layer_nr << " to " << last_layer_nr;
+            EXPECT_NEAR(result.difference(expected).area(), 0.0, 10.0) << "Layers " << first_layer_nr << " to " << last_layer_nr;
+        }
+    }
+}
+
+TEST_F(OutlineIntersectionCacheTest, AirAboveMesh)
+{
+    OutlineIntersectionCache cache(layers, 4);
+    EXPECT_TRUE(cache.intersection(LayerIndex(layers.size()) - 2, LayerIndex(layers.size())).empty());
+    EXPECT_TRUE(cache.intersection(LayerIndex(layers.size()), LayerIndex(layers.size())).empty());
+}
+
+TEST_F(OutlineIntersectionCacheTest, EmptyMesh)
+{
+    std::vector<SliceLayer> no_layers;
+    OutlineIntersectionCache cache(no_layers, 4);
+    EXPECT_TRUE(cache.intersection(0, 3).empty());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -210,6 +210,48 @@ TEST_P(PathOrderMonotonicTest, SectionsTest)
     }
 }
 
+TEST(PathOrderMonotonicManyLinesTest, TenThousandLines)
+{
+    // A hundred columns of a hundred lines each, like the skin of a large plate with many small gaps in it.
+    // Each line is adjacent to the line in the same row of the next column only.
+    constexpr coord_t num_columns = 100;
+    constexpr coord_t num_rows = 100;
+    constexpr coord_t column_spacing = 350;
+    constexpr coord_t row_spacing = 2000;
+    constexpr coord_t line_length = 1500;
+    Polygons polylines;
+    for (coord_t column = 0; column < num_columns; ++column)
+    {
+        for (coord_t row = 0; row < num_rows; ++row)
+        {
+            Polygon line;
+            line.add(Point2LL(column * column_spacing, row * row_spacing));
+            line.add(Point2LL(column * column_spacing, row * row_spacing + line_length));
+            polylines.add(line);
+        }
+    }
+
+    constexpr coord_t max_adjacent_distance = column_spacing + 1;
+    PathOrderMonotonic<ConstPolygonPointer> object_under_test(std::numbers::pi, max_adjacent_distance, Point2LL(-column_spacing, 0)); // Monotonic in the +X direction.
+    for (const auto& polyline : polylines)
+    {
+        object_under_test.addPolyline(ConstPolygonPointer(polyline));
+    }
+    object_under_test.optimize();
+
+    ASSERT_EQ(object_under_test.paths_.size(), static_cast<size_t>(num_columns * num_rows));
+    std::vector<coord_t> last_x_in_row(num_rows, -1);
+    for (const auto& path : object_under_test.paths_)
+    {
+        const Point2LL start = startVertex(path);
+        const coord_t row = std::min(start.Y, endVertex(path).Y) / row_spacing;
+        ASSERT_GE(row, 0);
+        ASSERT_LT(row, num_rows);
+        EXPECT_GT(start.X, last_x_in_row[row]) << "Adjacent lines must be printed in the monotonic direction.";
+        last_x_in_row[row] = start.X;
+    }
+}
+
 const std::vector<std::string> polygon_filenames = {
     std::filesystem::path(__FILE__).parent_path().append("resources/polygon_concave.txt").string(),   std::filesystem::path(__FILE__).parent_path().append("resources/polygon_concave_hole.txt").string(),
     std::filesystem::path(__FILE__).parent_path().append("resources/polygon_square.txt").string(),    std::filesystem::path(__FILE__).parent_path().append("resources/polygon_square_hole.txt").string(),
@@ -3,6 +3,9 @@
 
 #include "PathOrderOptimizer.h" //The code under test.
 
+#include <cstdlib>
+#include <vector>
+
 #include <gtest/gtest.h> //To run the tests.
 
 // NOLINTBEGIN(*-magic-numbers)
@@ -73,5 +76,73 @@ TEST_F(PathOrderOptimizerTest, ThreeTrianglesShortestOrder)
     EXPECT_EQ(optimizer.paths_[2].vertices_->front(), Point2LL(1000, 1000)) << "Far triangle last.";
 }
 
+/*!
+ * Tests ordering many lines on a row with gaps between them that are wider
+ * than the snap radius, so that each next line has to be searched further away.
+ */
+TEST_F(PathOrderOptimizerTest, ManyLinesNearestFirst)
+{
+    constexpr size_t line_count = 100;
+    std::vector<Polygon> lines(line_count);
+    for (size_t line_idx = 0; line_idx < line_count; ++line_idx)
+    {
+        lines[line_idx].add(Point2LL(line_idx * 1000, 0));
+        lines[line_idx].add(Point2LL(line_idx * 1000 + 500, 0));
+    }
+    for (size_t line_idx = 0; line_idx < line_count; ++line_idx)
+    {
+        optimizer.addPolyline(ConstPolygonPointer(lines[(line_idx * 37) % line_count])); // Add them out of order.
+    }
+
+    optimizer.optimize();
+
+    ASSERT_EQ(optimizer.paths_.size(), line_count);
+    for (size_t line_idx = 0; line_idx < line_count; ++line_idx)
+    {
+        const PathOrdering<ConstPolygonPointer>& path = optimizer.paths_[line_idx];
+        EXPECT_EQ((*path.converted_)[path.start_vertex_], Point2LL(line_idx * 1000, 0)) << "Each next line is the closest one, started from its closest end.";
+    }
+}
+
+/*!
+ * Tests that taking time to improve the order doesn't make the travel moves
+ * longer than they are with just picking the closest line each time.
+ */
+TEST_F(PathOrderOptimizerTest, ImprovedOrderTravelsLess)
+{
+    std::vector<Polygon> lines(200);
+    srand(42);
+    for (Polygon& line : lines)
+    {
+        const Point2LL start(rand() % 100000, rand() % 100000);
+        line.add(start);
+        line.add(start + Point2LL(rand() % 5000, rand() % 5000));
+    }
+    const auto travel_length = [](const PathOrderOptimizer<ConstPolygonPointer>& ordered)
+    {
+        coord_t length = 0;
+        Point2LL position = ordered.start_point_;
+        for (const PathOrdering<ConstPolygonPointer>& path : ordered.paths_)
+        {
+            length += vSize((*path.converted_)[path.start_vertex_] - position);
+            position = path.start_vertex_ == 0 ? path.converted_->back() : path.converted_->front();
+        }
+        return length;
+    };
+
+    PathOrderOptimizer<ConstPolygonPointer> improved(Point2LL(0, 0));
+    improved.improvement_time_ = 1.0;
+    for (const Polygon& line : lines)
+    {
+        optimizer.addPolyline(ConstPolygonPointer(line));
+        improved.addPolyline(ConstPolygonPointer(line));
+    }
+    optimizer.optimize();
+    improved.optimize();
+
+    ASSERT_EQ(improved.paths_.size(), lines.size());
+    EXPECT_LE(travel_length(improved), travel_length(optimizer));
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -0,0 +1,53 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "communication/PayloadCompression.h" // The functions under test.
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(PayloadCompressionTest, DeflateRoundTrip)
+{
+    std::string gcode;
+    for (int line = 0; line < 1000; line++)
+    {
+        gcode += "G1 X" + std::to_string(line % 200) + " Y" + std::to_string(line / 7) + " E0.0123\n";
+    }
+    const std::string compressed = deflatePayload(gcode);
+    ASSERT_FALSE(compressed.empty());
+    EXPECT_LT(compressed.size(), gcode.size() / 2) << "Repetitive g-code must compress well.";
+
+    std::string decompressed(gcode.size(), '\0');
+    uLongf decompressed_size = decompressed.size();
+    ASSERT_EQ(uncompress(reinterpret_cast<Bytef*>(decompressed.data()), &decompressed_size, reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()), Z_OK);
+    decompressed.resize(decompressed_size);
+    EXPECT_EQ(decompressed, gcode);
+}
+
+TEST(PayloadCompressionTest, CoordinateDeltasRoundTrip)
+{
+    const std::vector<float> coordinates = { 0.0F, 0.0F, 150.5F, 20.001F, 150.4F, -20.0F, 310.0F, 310.0F, -0.015F, 0.002F };
+    const std::string encoded = encodeCoordinateDeltas(coordinates, 2);
+    EXPECT_LT(encoded.size(), coordinates.size() * sizeof(float));
+
+    const std::vector<float> decoded = decodeCoordinateDeltas(encoded, 2);
+    ASSERT_EQ(decoded.size(), coordinates.size());
+    for (size_t i = 0; i < coordinates.size(); i++)
+    {
+        EXPECT_NEAR(decoded[i], coordinates[i], 0.0005) << "Coordinate " << i << " must survive to the micrometre.";
+    }
+}
+
+TEST(PayloadCompressionTest, CoordinateDeltasMalformed)
+{
+    const std::string encoded = encodeCoordinateDeltas({ 1.0F, 2.0F, 3.0F }, 3);
+    EXPECT_TRUE(decodeCoordinateDeltas(encoded.substr(0, encoded.size() - 1), 3).empty()) << "A truncated array must be rejected.";
+    EXPECT_TRUE(decodeCoordinateDeltas(encoded, 2).empty()) << "An incomplete last point must be rejected.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "progress/PrintEstimateExtrapolator.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(PrintEstimateExtrapolatorTest, NothingWrittenYet)
+{
+    const PrintEstimateExtrapolator extrapolator({ 1.0, 1.0 }, PrintEstimates{ { 0.0, 0.0 }, { 0.0 } });
+    EXPECT_FALSE(extrapolator.extrapolate(-1, PrintEstimates{ { 5.0, 0.0 }, { 1.0 } }).has_value()) << "Only the raft was written, which tells nothing about the layers.";
+
+    const PrintEstimateExtrapolator empty_bottom({ 0.0, 1.0 }, PrintEstimates{ { 0.0, 0.0 }, { 0.0 } });
+    EXPECT_FALSE(empty_bottom.extrapolate(0, PrintEstimates{ { 5.0, 0.0 }, { 1.0 } }).has_value()) << "The written layers print nothing to scale from.";
+}
+
+TEST(PrintEstimateExtrapolatorTest, ScalesByLayerWeights)
+{
+    const PrintEstimateExtrapolator extrapolator({ 1.0, 3.0, 4.0 }, PrintEstimates{ { 0.0, 0.0 }, { 0.0 } });
+
+    const std::optional<PrintEstimates> estimates = extrapolator.extrapolate(1, PrintEstimates{ { 10.0, 2.0 }, { 100.0 } });
+    ASSERT_TRUE(estimates.has_value());
+    EXPECT_DOUBLE_EQ(estimates->print_time_per_feature[0], 20.0) << "The layers written so far print half of the total.";
+    EXPECT_DOUBLE_EQ(estimates->print_time_per_feature[1], 4.0);
+    EXPECT_DOUBLE_EQ(estimates->material_per_extruder[0], 200.0);
+
+    const std::optional<PrintEstimates> last = extrapolator.extrapolate(2, PrintEstimates{ { 21.0, 4.0 }, { 210.0 } });
+    ASSERT_TRUE(last.has_value());
+    EXPECT_DOUBLE_EQ(last->print_time_per_feature[0], 21.0) << "Once all layers are written, the estimate is what was written.";
+}
+
+TEST(PrintEstimateExtrapolatorTest, EarlierMeshGroupsAreExact)
+{
+    const PrintEstimateExtrapolator extrapolator({ 1.0, 1.0 }, PrintEstimates{ { 50.0 }, { 500.0 } });
+
+    const std::optional<PrintEstimates> estimates = extrapolator.extrapolate(0, PrintEstimates{ { 60.0 }, { 530.0 } });
+    ASSERT_TRUE(estimates.has_value());
+    EXPECT_DOUBLE_EQ(estimates->print_time_per_feature[0], 70.0);
+    EXPECT_DOUBLE_EQ(estimates->material_per_extruder[0], 560.0);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,70 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "progress/StageCostModel.h" // The class under test.
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(StageCostModelTest, UnknownWithoutRecords)
+{
+    const StageCostModel model;
+    EXPECT_FALSE(model.estimateSeconds(Progress::Stage::SLICING, 100).has_value());
+    EXPECT_EQ(model.getChunkSizeFactor(Progress::Stage::PARTS), 1U);
+}
+
+TEST(StageCostModelTest, FollowsRecords)
+{
+    StageCostModel model;
+    model.record(Progress::Stage::SUPPORT, 10.0, 100);
+    EXPECT_DOUBLE_EQ(*model.estimateSeconds(Progress::Stage::SUPPORT, 200), 20.0);
+
+    model.record(Progress::Stage::SUPPORT, 30.0, 100); // The second slice counts as much as the first.
+    EXPECT_DOUBLE_EQ(*model.estimateSeconds(Progress::Stage::SUPPORT, 100), 20.0);
+
+    for (size_t slice = 0; slice < 50; slice++)
+    {
+        model.record(Progress::Stage::SUPPORT, 50.0, 100);
+    }
+    EXPECT_NEAR(*model.estimateSeconds(Progress::Stage::SUPPORT, 100), 50.0, 0.01);
+    EXPECT_FALSE(model.estimateSeconds(Progress::Stage::EXPORT, 100).has_value());
+}
+
+TEST(StageCostModelTest, ChunksTakeTheMinimumTime)
+{
+    StageCostModel model;
+    model.record(Progress::Stage::PARTS, 0.01, 100); // 0.1 ms per layer.
+    EXPECT_EQ(model.getChunkSizeFactor(Progress::Stage::PARTS, 0.001), 10U);
+    model.record(Progress::Stage::INSET_SKIN, 10.0, 100);
+    EXPECT_EQ(model.getChunkSizeFactor(Progress::Stage::INSET_SKIN, 0.001), 1U);
+}
+
+TEST(StageCostModelTest, SaveAndLoad)
+{
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "stage_cost_model_test" / "printer.costs";
+    StageCostModel model;
+    model.record(Progress::Stage::SLICING, 1.5, 10);
+    model.record(Progress::Stage::INSET_SKIN, 12.0, 10);
+    model.save(file);
+
+    const StageCostModel loaded = StageCostModel::load(file);
+    EXPECT_DOUBLE_EQ(loaded.getCost(Progress::Stage::SLICING).seconds_per_layer, 0.15);
+    EXPECT_EQ(loaded.getCost(Progress::Stage::INSET_SKIN).samples, 1U);
+    EXPECT_EQ(loaded.getCost(Progress::Stage::SUPPORT).samples, 0U);
+    std::filesystem::remove_all(file.parent_path());
+}
+
+TEST(StageCostModelTest, LoadMissingFile)
+{
+    const StageCostModel model = StageCostModel::load(std::filesystem::temp_directory_path() / "stage_cost_model_test_missing.costs");
+    EXPECT_EQ(model.getCost(Progress::Stage::SLICING).samples, 0U);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "infill/SupportInfillCache.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class SupportInfillCacheTest : public testing::Test
+{
+public:
+    Polygons square;
+    size_t compute_count = 0;
+
+    void SetUp() override
+    {
+        square = makeSquare(Point2LL(1000, 2000), 10000);
+        compute_count = 0;
+    }
+
+    static Polygons makeSquare(const Point2LL& corner, const coord_t size)
+    {
+        Polygons result;
+        result.emplace_back();
+        result.back().emplace_back(corner);
+        result.back().emplace_back(corner + Point2LL(size, 0));
+        result.back().emplace_back(corner + Point2LL(size, size));
+        result.back().emplace_back(corner + Point2LL(0, size));
+        return result;
+    }
+
+    std::shared_ptr<const SupportInfillLines> get(const SupportInfillCache& cache, const Polygons& area, const coord_t angle = 45)
+    {
+        return cache.get(
+            SupportInfillCache::Key{ .parameters = { static_cast<coord_t>(EFillMethod::LINES), angle, 400 }, .area = area },
+            [this, &area]()
+            {
+                compute_count++;
+                auto lines = std::make_shared<SupportInfillLines>();
+                lines->lines = area;
+                return lines;
+            });
+    }
+};
+
+TEST_F(SupportInfillCacheTest, ReuseSameArea)
+{
+    SupportInfillCache cache;
+    const std::shared_ptr<const SupportInfillLines> first = get(cache, square);
+    const std::shared_ptr<const SupportInfillLines> second = get(cache, square);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(compute_count, 1);
+    EXPECT_EQ(cache.hitCount(), 1);
+    EXPECT_EQ(cache.missCount(), 1);
+    EXPECT_EQ(second->lines.size(), 1);
+}
+
+TEST_F(SupportInfillCacheTest, GenerateMovedArea)
+{
+    SupportInfillCache cache;
+    const std::shared_ptr<const SupportInfillLines> first = get(cache, square);
+    Polygons moved_square = square;
+    moved_square.translate(Point2LL(10, 0));
+    const std::shared_ptr<const SupportInfillLines> second = get(cache, moved_square);
+
+    EXPECT_NE(first, second) << "The lines of the pattern are aligned to the build plate, not to the area, so they can't be moved along.";
+    EXPECT_EQ(compute_count, 2);
+}
+
+TEST_F(SupportInfillCacheTest, AlternatingAngles)
+{
+    SupportInfillCache cache;
+    for (size_t layer_nr = 0; layer_nr < 10; layer_nr++)
+    {
+        get(cache, square, layer_nr % 2 == 0 ? 45 : 135);
+    }
+
+    EXPECT_EQ(compute_count, 2) << "Each angle only needs to be generated once.";
+    EXPECT_EQ(cache.hitCount(), 8);
+}
+
+TEST_F(SupportInfillCacheTest, ForgetOldestWhenFull)
+{
+    SupportInfillCache cache(2);
+    const Polygons second_square = makeSquare(Point2LL(20000, 0), 5000);
+    const Polygons third_square = makeSquare(Point2LL(40000, 0), 5000);
+    get(cache, square);
+    get(cache, second_square);
+    get(cache, third_square);
+    EXPECT_EQ(compute_count, 3);
+
+    get(cache, third_square);
+    get(cache, second_square);
+    EXPECT_EQ(compute_count, 3);
+
+    get(cache, square);
+    EXPECT_EQ(compute_count, 4);
+}
+
+TEST_F(SupportInfillCacheTest, OnlyPatternsThatDontChangeWithHeight)
+{
+    EXPECT_TRUE(SupportInfillCache::isCacheable(EFillMethod::LINES));
+    EXPECT_TRUE(SupportInfillCache::isCacheable(EFillMethod::GRID));
+    EXPECT_TRUE(SupportInfillCache::isCacheable(EFillMethod::ZIG_ZAG));
+    EXPECT_FALSE(SupportInfillCache::isCacheable(EFillMethod::GYROID));
+    EXPECT_FALSE(SupportInfillCache::isCacheable(EFillMethod::CROSS));
+    EXPECT_FALSE(SupportInfillCache::isCacheable(EFillMethod::LIGHTNING));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -5,6 +5,7 @@
 #include "settings/Settings.h" //To set firmware settings.
 #include "settings/types/Duration.h"
 #include "timeEstimate.h" //The unit under test.
+#include "TimeEstimatePipeline.h"
 #include <cmath>
 #include <gtest/gtest.h>
 #include <numeric>
@@ -430,4 +431,83 @@ TEST_F(TimeEstimateCalculatorTest, StraightAnglePartialJerk)
     EXPECT_NEAR(Duration(first_accelerate_t + first_cruise_distance / 50.0 + first_decelerate_t + second_accelerate_t + second_cruise_distance / 50.0 + second_decelerate_t), result[static_cast<size_t>(PrintFeatureType::Infill)], EPSILON);
 }
 
+TEST_F(TimeEstimateCalculatorTest, ManyLinesLookAhead)
+{
+    calculator.setFirmwareDefaults(jerkless);
+
+    /*
+     * Many more lines than the planner looks ahead, all in the same direction. Each line is longer than the distance
+     * needed to decelerate, so the window of the planner is long enough to cruise through all of them, like a single
+     * line of the same total length.
+     */
+    constexpr size_t line_count = TimeEstimateCalculator::planner_buffer_size * 10;
+    for (size_t line = 1; line <= line_count; line++)
+    {
+        calculator.plan(TimeEstimateCalculator::Position(100.0 * line, 0, 0, 0), 50.0, PrintFeatureType::Infill);
+    }
+
+    const double accelerate_distance = 0.5 * 50 * 1 * 1 + 0 * 1;
+    const double decelerate_t = (50.0 - MINIMUM_PLANNER_SPEED) / 50.0;
+    const double decelerate_distance = 0.5 * 50.0 * decelerate_t * decelerate_t + MINIMUM_PLANNER_SPEED * decelerate_t;
+    const double cruise_distance = 100.0 * line_count - accelerate_distance - decelerate_distance;
+
+    const std::vector<Duration> result = calculator.calculate();
+    EXPECT_NEAR(Duration(1.0 + cruise_distance / 50.0 + decelerate_t), // Accelerate, cruise, decelerate.
+                result[static_cast<size_t>(PrintFeatureType::Infill)],
+                EPSILON);
+    EXPECT_EQ(result, calculator.calculate()) << "Calculating must not change what was planned.";
+}
+
+TEST_F(TimeEstimateCalculatorTest, ShortLinesLimitedByLookAhead)
+{
+    calculator.setFirmwareDefaults(jerkless);
+
+    /*
+     * Lines that are so short that the planner can't look ahead far enough to get up to full speed: with only the
+     * lines in the window to decelerate on, it can't go faster than it could stop within them.
+     */
+    constexpr double line_length = 1.0;
+    constexpr size_t line_count = 1000;
+    for (size_t line = 1; line <= line_count; line++)
+    {
+        calculator.plan(TimeEstimateCalculator::Position(line_length * line, 0, 0, 0), 50.0, PrintFeatureType::Infill);
+    }
+
+    const double window_length = line_length * TimeEstimateCalculator::planner_buffer_size;
+    const double max_speed = std::sqrt(2 * 50.0 * window_length); // Speed from which it can stop within the window.
+    ASSERT_LT(max_speed, 50.0);
+    const std::vector<Duration> result = calculator.calculate();
+    EXPECT_GT(result[static_cast<size_t>(PrintFeatureType::Infill)], Duration(line_length * line_count / max_speed));
+}
+
+TEST_F(TimeEstimateCalculatorTest, PipelineMatchesCalculator)
+{
+    TimeEstimatePipeline pipeline;
+    calculator.setFirmwareDefaults(um3);
+    pipeline.setFirmwareDefaults(um3);
+    for (size_t layer = 0; layer < 3; layer++)
+    {
+        for (size_t move = 0; move < 10000; move++)
+        {
+            const TimeEstimateCalculator::Position destination((move * 37) % 200, (move * 53) % 200, layer * 0.2, move * 0.01);
+            const Velocity speed(50.0 + move % 30);
+            const PrintFeatureType feature = move % 2 == 0 ? PrintFeatureType::Infill : PrintFeatureType::MoveCombing;
+            calculator.plan(destination, speed, feature);
+            pipeline.plan(destination, speed, feature);
+            if (move % 1000 == 0)
+            {
+                calculator.setAcceleration(Acceleration(1000.0 + move));
+                pipeline.setAcceleration(Acceleration(1000.0 + move));
+                calculator.setMaxXyJerk(Velocity(10.0 + move / 1000));
+                pipeline.setMaxXyJerk(Velocity(10.0 + move / 1000));
+                calculator.addTime(0.5);
+                pipeline.addTime(0.5);
+            }
+        }
+        EXPECT_EQ(calculator.calculate(), pipeline.calculate()) << "The estimate of layer " << layer << " must be the same on the estimation thread.";
+        calculator.reset();
+        pipeline.reset();
+    }
+}
+
 } // namespace cura
\ No newline at end of file
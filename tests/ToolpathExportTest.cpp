@@ -0,0 +1,85 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "ToolpathExport.h" // The class under test.
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class ToolpathExportTest : public testing::Test
+{
+public:
+    std::filesystem::path directory;
+
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / ("ToolpathExportTest_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    template<typename T>
+    std::vector<T> readColumn(const char* filename) const
+    {
+        std::ifstream file(directory / filename, std::ios::binary);
+        std::vector<T> values(std::filesystem::file_size(directory / filename) / sizeof(T));
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        return values;
+    }
+};
+
+TEST_F(ToolpathExportTest, WriteLayers)
+{
+    ToolpathExport toolpaths;
+    ASSERT_TRUE(toolpaths.open(directory));
+    EXPECT_TRUE(toolpaths.isOpen());
+
+    toolpaths.beginLayer(LayerIndex(0), 200, 200, Point3LL(0, 0, 0));
+    toolpaths.addPath(PrintFeatureType::MoveCombing, 0, { Point2LL(10000, 10000) }, 200, 0, 200, Velocity(150), 0.0);
+    toolpaths.addPath(PrintFeatureType::OuterWall, 1, { Point2LL(20000, 10000), Point2LL(20000, 20000) }, 200, 400, 200, Velocity(30), 0.08);
+    toolpaths.beginLayer(LayerIndex(1), 400, 200, Point3LL(20000, 20000, 200));
+    toolpaths.addPath(PrintFeatureType::Infill, 0, { Point2LL(0, 0) }, 400, 450, 200, Velocity(60), 0.09);
+    toolpaths.close();
+    EXPECT_FALSE(toolpaths.isOpen());
+
+    EXPECT_EQ(readColumn<int32_t>("layer_index.i32"), (std::vector<int32_t>{ 0, 1 }));
+    EXPECT_EQ(readColumn<float>("layer_z.f32"), (std::vector<float>{ 0.2F, 0.4F }));
+    EXPECT_EQ(readColumn<float>("layer_start.f32"), (std::vector<float>{ 0.0F, 0.0F, 0.0F, 20.0F, 20.0F, 0.2F }));
+    EXPECT_EQ(readColumn<uint64_t>("layer_segment_offset.u64"), (std::vector<uint64_t>{ 0, 3, 4 })) << "The offsets should have one element more than the layers.";
+
+    EXPECT_EQ(readColumn<float>("points.f32"), (std::vector<float>{ 10.0F, 10.0F, 0.2F, 20.0F, 10.0F, 0.2F, 20.0F, 20.0F, 0.2F, 0.0F, 0.0F, 0.4F }));
+    EXPECT_EQ(
+        readColumn<uint8_t>("line_type.u8"),
+        (std::vector<uint8_t>{ static_cast<uint8_t>(PrintFeatureType::MoveCombing),
+                               static_cast<uint8_t>(PrintFeatureType::OuterWall),
+                               static_cast<uint8_t>(PrintFeatureType::OuterWall),
+                               static_cast<uint8_t>(PrintFeatureType::Infill) }));
+    EXPECT_EQ(readColumn<uint8_t>("extruder.u8"), (std::vector<uint8_t>{ 0, 1, 1, 0 }));
+    EXPECT_EQ(readColumn<float>("line_width.f32"), (std::vector<float>{ 0.0F, 0.4F, 0.4F, 0.45F }));
+    EXPECT_EQ(readColumn<float>("line_feedrate.f32"), (std::vector<float>{ 150.0F, 30.0F, 30.0F, 60.0F }));
+    EXPECT_EQ(readColumn<float>("line_flow.f32"), (std::vector<float>{ 0.0F, 0.08F, 0.08F, 0.09F }));
+}
+
+TEST_F(ToolpathExportTest, NothingWhenClosed)
+{
+    ToolpathExport toolpaths;
+    toolpaths.beginLayer(LayerIndex(0), 200, 200, Point3LL(0, 0, 0));
+    toolpaths.addPath(PrintFeatureType::Infill, 0, { Point2LL(0, 0) }, 200, 400, 200, Velocity(60), 0.08);
+    toolpaths.close();
+    EXPECT_FALSE(std::filesystem::exists(directory));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,146 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "WallToolPathsCache.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/ExtrusionLine.h"
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class WallToolPathsCacheTest : public testing::Test
+{
+public:
+    Polygons square;
+    std::vector<VariableWidthLines> toolpaths;
+    Polygons inner_contour;
+    WallToolPathsCache::Parameters parameters{ 400, 400, 2, 0, SectionType::WALL };
+
+    void SetUp() override
+    {
+        square = makeSquare(Point2LL(1000, 2000), 10000);
+        ExtrusionLine wall(0, false);
+        wall.emplace_back(Point2LL(1200, 2200), 400, 0);
+        wall.emplace_back(Point2LL(10800, 2200), 400, 0);
+        wall.emplace_back(Point2LL(10800, 11800), 400, 0);
+        wall.emplace_back(Point2LL(1200, 11800), 400, 0);
+        wall.is_closed_ = true;
+        toolpaths = { { wall } };
+        inner_contour = makeSquare(Point2LL(1400, 2400), 9200);
+    }
+
+    static Polygons makeSquare(const Point2LL& corner, const coord_t size)
+    {
+        Polygons result;
+        result.emplace_back();
+        result.back().emplace_back(corner);
+        result.back().emplace_back(corner + Point2LL(size, 0));
+        result.back().emplace_back(corner + Point2LL(size, size));
+        result.back().emplace_back(corner + Point2LL(0, size));
+        return result;
+    }
+};
+
+TEST_F(WallToolPathsCacheTest, FindSameOutline)
+{
+    WallToolPathsCache cache;
+    std::vector<VariableWidthLines> found_toolpaths;
+    Polygons found_inner_contour;
+    EXPECT_FALSE(cache.find(square, parameters, found_toolpaths, found_inner_contour));
+
+    cache.insert(square, parameters, toolpaths, inner_contour);
+    ASSERT_TRUE(cache.find(square, parameters, found_toolpaths, found_inner_contour));
+    ASSERT_EQ(found_toolpaths.size(), 1);
+    ASSERT_EQ(found_toolpaths[0].size(), 1);
+    ASSERT_EQ(found_toolpaths[0][0].size(), toolpaths[0][0].size());
+    for (size_t junction_idx = 0; junction_idx < toolpaths[0][0].size(); junction_idx++)
+    {
+        EXPECT_EQ(found_toolpaths[0][0][junction_idx].p_, toolpaths[0][0][junction_idx].p_);
+        EXPECT_EQ(found_toolpaths[0][0][junction_idx].w_, toolpaths[0][0][junction_idx].w_);
+    }
+    EXPECT_TRUE(found_toolpaths[0][0].is_closed_);
+    EXPECT_EQ(found_inner_contour.paths, inner_contour.paths);
+    EXPECT_EQ(cache.hitCount(), 1);
+    EXPECT_EQ(cache.missCount(), 1);
+}
+
+TEST_F(WallToolPathsCacheTest, FindTranslatedOutline)
+{
+    WallToolPathsCache cache;
+    cache.insert(square, parameters, toolpaths, inner_contour);
+
+    const Point2LL offset(-3000, 500);
+    Polygons moved_square = square;
+    moved_square.translate(offset);
+    std::vector<VariableWidthLines> found_toolpaths;
+    Polygons found_inner_contour;
+    ASSERT_TRUE(cache.find(moved_square, parameters, found_toolpaths, found_inner_contour));
+    ASSERT_EQ(found_toolpaths[0][0].size(), toolpaths[0][0].size());
+    for (size_t junction_idx = 0; junction_idx < toolpaths[0][0].size(); junction_idx++)
+    {
+        EXPECT_EQ(found_toolpaths[0][0][junction_idx].p_, toolpaths[0][0][junction_idx].p_ + offset);
+    }
+    Polygons moved_inner_contour = inner_contour;
+    moved_inner_contour.translate(offset);
+    EXPECT_EQ(found_inner_contour.paths, moved_inner_contour.paths);
+}
+
+TEST_F(WallToolPathsCacheTest, MissDifferentOutlineOrParameters)
+{
+    WallToolPathsCache cache;
+    cache.insert(square, parameters, toolpaths, inner_contour);
+    std::vector<VariableWidthLines> found_toolpaths;
+    Polygons found_inner_contour;
+
+    Polygons bigger_square = makeSquare(Point2LL(1000, 2000), 10001);
+    EXPECT_FALSE(cache.find(bigger_square, parameters, found_toolpaths, found_inner_contour));
+
+    WallToolPathsCache::Parameters more_walls = parameters;
+    more_walls.inset_count = 3;
+    EXPECT_FALSE(cache.find(square, more_walls, found_toolpaths, found_inner_contour));
+
+    WallToolPathsCache::Parameters support = parameters;
+    support.section_type = SectionType::SUPPORT;
+    EXPECT_FALSE(cache.find(square, support, found_toolpaths, found_inner_contour));
+    EXPECT_EQ(cache.hitCount(), 0);
+    EXPECT_EQ(cache.missCount(), 3);
+}
+
+TEST_F(WallToolPathsCacheTest, ForgetOldest)
+{
+    WallToolPathsCache cache(2);
+    cache.insert(square, parameters, toolpaths, inner_contour);
+    cache.insert(makeSquare(Point2LL(0, 0), 500), parameters, {}, {});
+    cache.insert(makeSquare(Point2LL(0, 0), 600), parameters, {}, {});
+    std::vector<VariableWidthLines> found_toolpaths;
+    Polygons found_inner_contour;
+    EXPECT_FALSE(cache.find(square, parameters, found_toolpaths, found_inner_contour));
+    EXPECT_TRUE(cache.find(makeSquare(Point2LL(100, 100), 600), parameters, found_toolpaths, found_inner_contour));
+}
+
+TEST_F(WallToolPathsCacheTest, SetCapacity)
+{
+    WallToolPathsCache cache(3);
+    cache.insert(square, parameters, toolpaths, inner_contour);
+    cache.insert(makeSquare(Point2LL(0, 0), 500), parameters, {}, {});
+    cache.insert(makeSquare(Point2LL(0, 0), 600), parameters, {}, {});
+    std::vector<VariableWidthLines> found_toolpaths;
+    Polygons found_inner_contour;
+
+    cache.setCapacity(4); // Growing keeps all outlines.
+    cache.insert(makeSquare(Point2LL(0, 0), 700), parameters, {}, {});
+    EXPECT_TRUE(cache.find(square, parameters, found_toolpaths, found_inner_contour));
+
+    cache.setCapacity(2); // Shrinking forgets the oldest.
+    EXPECT_FALSE(cache.find(square, parameters, found_toolpaths, found_inner_contour));
+    EXPECT_FALSE(cache.find(makeSquare(Point2LL(0, 0), 500), parameters, found_toolpaths, found_inner_contour));
+    EXPECT_TRUE(cache.find(makeSquare(Point2LL(0, 0), 600), parameters, found_toolpaths, found_inner_contour));
+    EXPECT_TRUE(cache.find(makeSquare(Point2LL(0, 0), 700), parameters, found_toolpaths, found_inner_contour));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -8,6 +8,7 @@
 #include "slicer.h"
 #include "utils/polygon.h" //To create example polygons.
 #include <gtest/gtest.h>
+#include <cmath>
 #include <range/v3/view/join.hpp>
 #include <unordered_set>
 
@@ -111,8 +112,8 @@ TEST_F(WallsComputationTest, GenerateWallsForLayerSinglePart)
 
     // Verify that something was generated.
     EXPECT_FALSE(part.wall_toolpaths.empty()) << "There must be some walls.";
-    EXPECT_GT(part.print_outline.area(), 0) << "The print outline must encompass the outer wall, so it must be more than 0.";
-    EXPECT_LE(part.print_outline.area(), square_shape.area()) << "The print outline must stay within the bounds of the original part.";
+    EXPECT_GT(part.print_outline.toPolygons().area(), 0) << "The print outline must encompass the outer wall, so it must be more than 0.";
+    EXPECT_LE(part.print_outline.toPolygons().area(), square_shape.area()) << "The print outline must stay within the bounds of the original part.";
     EXPECT_GT(part.inner_area.area(), 0) << "The inner area must be within the innermost wall. There are not enough walls to fill the entire part, so there is a positive inner area.";
     EXPECT_EQ(layer.parts.size(), 1) << "There is still just 1 part.";
 }
@@ -133,7 +134,7 @@ TEST_F(WallsComputationTest, GenerateWallsZeroWalls)
 
     // Verify that there is still an inner area, outline and parts.
     EXPECT_EQ(part.inner_area.area(), square_shape.area()) << "There are no walls, so the inner area (for infill/skin) needs to be the entire part.";
-    EXPECT_EQ(part.print_outline.area(), square_shape.area()) << "There are no walls, so the print outline encompasses the inner area exactly.";
+    EXPECT_EQ(part.print_outline.toPolygons().area(), square_shape.area()) << "There are no walls, so the print outline encompasses the inner area exactly.";
     EXPECT_EQ(part.outline.area(), square_shape.area()) << "The outline is not modified.";
     EXPECT_EQ(layer.parts.size(), 1) << "There is still just 1 part.";
 }
@@ -162,8 +163,8 @@ TEST_F(WallsComputationTest, WallToolPathsGetWeakOrder)
 
     // Verify that something was generated.
     EXPECT_FALSE(part.wall_toolpaths.empty()) << "There must be some walls.";
-    EXPECT_GT(part.print_outline.area(), 0) << "The print outline must encompass the outer wall, so it must be more than 0.";
-    EXPECT_LE(part.print_outline.area(), ff_holes.area()) << "The print outline must stay within the bounds of the original part.";
+    EXPECT_GT(part.print_outline.toPolygons().area(), 0) << "The print outline must encompass the outer wall, so it must be more than 0.";
+    EXPECT_LE(part.print_outline.toPolygons().area(), ff_holes.area()) << "The print outline must stay within the bounds of the original part.";
     EXPECT_GE(part.inner_area.area(), 0) << "The inner area can never have negative area.";
     EXPECT_EQ(layer.parts.size(), 1) << "There is still just 1 part.";
 
@@ -221,5 +222,34 @@ TEST_F(WallsComputationTest, WallToolPathsGetWeakOrder)
     EXPECT_EQ(has_order_info.size(), n_paths) << "Every path should have order information.";
 }
 
+/*!
+ * Tests that the walls of a shape that is thick enough everywhere follow the outline at constant width.
+ */
+TEST_F(WallsComputationTest, GenerateWallsUniformSquare)
+{
+    SliceLayer layer;
+    layer.parts.emplace_back();
+    SliceLayerPart& part = layer.parts.back();
+    part.outline.add(square_shape);
+
+    walls_computation.generateWalls(&layer, SectionType::WALL);
+
+    ASSERT_EQ(part.wall_toolpaths.size(), 2) << "There are two walls.";
+    for (size_t inset_idx = 0; inset_idx < part.wall_toolpaths.size(); inset_idx++)
+    {
+        ASSERT_EQ(part.wall_toolpaths[inset_idx].size(), 1) << "Each wall is a single closed line around the square.";
+        const ExtrusionLine& line = part.wall_toolpaths[inset_idx].front();
+        EXPECT_TRUE(line.is_closed_);
+        EXPECT_EQ(line.inset_idx_, inset_idx);
+        for (const ExtrusionJunction& junction : line)
+        {
+            EXPECT_EQ(junction.w_, MM2INT(0.4)) << "All of the square is thick enough for walls at their nominal width.";
+            const coord_t distance_to_outline = std::min({ junction.p_.X, junction.p_.Y, MM2INT(20) - junction.p_.X, MM2INT(20) - junction.p_.Y });
+            EXPECT_NEAR(distance_to_outline, MM2INT(0.2) + inset_idx * MM2INT(0.4), 1);
+        }
+    }
+    EXPECT_NEAR(part.inner_area.area(), std::pow(MM2INT(20) - 2 * MM2INT(0.8), 2), MM2INT(20) * 4 * 10) << "The inner area starts at the inside of the inner wall.";
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -35,6 +35,7 @@ public:
         instance = new ArcusCommunication::Private();
         instance->socket = new MockSocket();
         Application::getInstance().current_slice_ = new Slice(GK_TEST_NUM_MESH_GROUPS);
+        Application::getInstance().startThreadPool(); // The meshes are loaded in parallel.
     }
 
     void TearDown() override
@@ -4,6 +4,7 @@
 #include "FffProcessor.h"
 #include "MockSocket.h" //To mock out the communication with the front-end.
 #include "communication/ArcusCommunicationPrivate.h" //To access the private fields of this communication class.
+#include "communication/PayloadCompression.h" //To check compressed messages.
 #include "settings/types/LayerIndex.h"
 #include "utils/Coord_t.h"
 #include "utils/polygon.h" //Create test shapes to send over the socket.
@@ -105,6 +106,45 @@ TEST_F(ArcusCommunicationTest, FlushGCodeTest)
     EXPECT_EQ(test_gcode, message->data());
 }
 
+TEST_F(ArcusCommunicationTest, FlushCompressedGCodeTest)
+{
+    ac->private_data->payload_compression = proto::Deflate;
+    const std::string test_gcode = "G1 X10 Y10\nG1 X20 Y10\nG1 X20 Y20\n";
+    ac->private_data->gcode_output_stream.write(test_gcode.c_str(), test_gcode.size());
+
+    ac->flushGCode();
+
+    ASSERT_EQ(size_t(1), socket->sent_messages.size());
+    const proto::GCodeLayer* message = dynamic_cast<proto::GCodeLayer*>(socket->sent_messages.back().get());
+    EXPECT_EQ(proto::Deflate, message->compression());
+    EXPECT_EQ(deflatePayload(test_gcode), message->data());
+}
+
+TEST_F(ArcusCommunicationTest, FlushGCodeInChunks)
+{
+    std::string test_gcode;
+    while (test_gcode.size() < ChunkSink::default_chunk_size * 2)
+    {
+        test_gcode += "G1 X" + std::to_string(test_gcode.size()) + " Y10 E0.0123\n";
+    }
+    ac->private_data->gcode_output_stream.write(test_gcode.c_str(), test_gcode.size());
+    EXPECT_EQ(size_t(2), socket->sent_messages.size()) << "Every full chunk should be sent right away.";
+
+    ac->flushGCode();
+
+    ASSERT_EQ(size_t(3), socket->sent_messages.size());
+    std::string received;
+    for (const auto& sent_message : socket->sent_messages)
+    {
+        const proto::GCodeLayer* message = dynamic_cast<proto::GCodeLayer*>(sent_message.get());
+        ASSERT_NE(nullptr, message);
+        EXPECT_LE(message->data().size(), ChunkSink::default_chunk_size);
+        EXPECT_EQ('\n', message->data().back()) << "The g-code should be split at the end of a line.";
+        received += message->data();
+    }
+    EXPECT_EQ(test_gcode, received);
+}
+
 TEST_F(ArcusCommunicationTest, IsSequential)
 {
     EXPECT_FALSE(ac->isSequential());
@@ -154,6 +194,56 @@ TEST_F(ArcusCommunicationTest, SendLayerComplete)
     EXPECT_EQ(static_cast<float>(layer_thickness), message->thickness());
 }
 
+TEST_F(ArcusCommunicationTest, StreamLayers)
+{
+    ac->setLayerStreaming(true);
+
+    ac->setLayerForSend(0);
+    ac->sendLayerComplete(0, 100, 100);
+    EXPECT_TRUE(socket->sent_messages.empty()) << "The layer that is being written must not be sent yet.";
+
+    ac->setLayerForSend(1);
+    ac->sendLayerComplete(1, 200, 100);
+    ASSERT_EQ(size_t(1), socket->sent_messages.size()) << "Starting on the next layer must send the previous one.";
+    const auto* message = dynamic_cast<proto::LayerOptimized*>(socket->sent_messages.back().get());
+    ASSERT_NE(message, nullptr);
+    EXPECT_EQ(0, message->id());
+    EXPECT_EQ(size_t(1), ac->private_data->optimized_layers.slice_data.size()) << "The sent layer must not be kept in memory.";
+
+    ac->sendOptimizedLayerData();
+    ASSERT_EQ(size_t(2), socket->sent_messages.size()) << "The last layer must be sent at the end.";
+    message = dynamic_cast<proto::LayerOptimized*>(socket->sent_messages.back().get());
+    ASSERT_NE(message, nullptr);
+    EXPECT_EQ(1, message->id());
+    EXPECT_TRUE(ac->private_data->optimized_layers.slice_data.empty());
+}
+
+TEST_F(ArcusCommunicationTest, SendLinesWithinPreviewTolerance)
+{
+    const auto sent_point_count = [this]()
+    {
+        ac->setLayerForSend(0);
+        ac->sendCurrentPosition(Point2LL(0, 0));
+        ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(1000, 5), 400, 200, 30);
+        ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(2000, 0), 400, 200, 30);
+        ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(3000, -5), 400, 200, 30);
+        ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(3000, 1000), 400, 200, 30); // A corner.
+        ac->sendLineTo(PrintFeatureType::OuterWall, Point2LL(3000, 0), 400, 200, 30); // Straight back.
+        ac->sendLineTo(PrintFeatureType::InnerWall, Point2LL(3000, -1000), 400, 200, 30); // Printed differently.
+        ac->setLayerForSend(1); // Flushes the path segments of layer 0.
+        const std::shared_ptr<proto::LayerOptimized> layer = ac->private_data->getOptimizedLayerById(0);
+        EXPECT_EQ(1, layer->path_segment_size());
+        const size_t point_count = layer->path_segment(0).points().size() / (2 * sizeof(float));
+        ac->private_data->optimized_layers.slice_data.clear();
+        return point_count;
+    };
+
+    EXPECT_EQ(size_t(7), sent_point_count()) << "Without a preview tolerance, every point must be sent.";
+
+    ac->private_data->preview_tolerance = 10;
+    EXPECT_EQ(size_t(5), sent_point_count()) << "The points within the tolerance of a line must be left out, but corners, reversals and changes of feature kept.";
+}
+
 TEST_F(ArcusCommunicationTest, SendProgress)
 {
     ac->private_data->object_count = 2; // If there are two objects, all progress should get halved.
@@ -7,6 +7,7 @@
 #include <gmock/gmock.h>
 
 #include "communication/Communication.h" //The interface we're implementing.
+#include "progress/PrintEstimateExtrapolator.h" //In the signature of Communication.
 #include "settings/types/LayerIndex.h"
 #include "utils/Coord_t.h"
 #include "utils/polygon.h" //In the signature of Communication.
@@ -22,6 +23,7 @@ class MockCommunication : public Communication
 public:
     MOCK_CONST_METHOD0(hasSlice, bool());
     MOCK_CONST_METHOD0(isSequential, bool());
+    MOCK_CONST_METHOD0(isPersistent, bool());
     MOCK_CONST_METHOD1(sendProgress, void(double progress));
     MOCK_METHOD3(sendLayerComplete, void(const LayerIndex::value_type& layer_nr, const coord_t& z, const coord_t& thickness));
     MOCK_METHOD5(sendPolygons, void(const PrintFeatureType& type, const Polygons& polygons, const coord_t& line_width, const coord_t& line_thickness, const Velocity& velocity));
@@ -34,6 +36,7 @@ public:
     MOCK_METHOD1(setLayerForSend, void(const LayerIndex::value_type& layer_nr));
     MOCK_METHOD0(sendOptimizedLayerData, void());
     MOCK_CONST_METHOD0(sendPrintTimeMaterialEstimates, void());
+    MOCK_CONST_METHOD1(sendRunningEstimates, void(const PrintEstimates& estimates));
     MOCK_METHOD0(beginGCode, void());
     MOCK_METHOD0(flushGCode, void());
     MOCK_CONST_METHOD1(sendGCodePrefix, void(const std::string& prefix));
@@ -255,6 +255,55 @@ TEST_F(SettingsTest, LimitToExtruder)
     EXPECT_EQ(limit_extruder_value, settings.get<std::string>("test_setting"));
 }
 
+TEST_F(SettingsTest, Freeze)
+{
+    std::shared_ptr<Slice> current_slice = std::make_shared<Slice>(0);
+    Application::getInstance().current_slice_ = current_slice.get();
+
+    Settings parent;
+    parent.add("inherited_setting", "12.5");
+    parent.add("overridden_setting", "1");
+    parent.add("unsigned_setting", "not a number");
+    settings.setParent(&parent);
+    settings.add("overridden_setting", "yes");
+    settings.freeze();
+
+    EXPECT_DOUBLE_EQ(12.5, settings.get<double>("inherited_setting"));
+    EXPECT_EQ(12, settings.get<int>("inherited_setting"));
+    EXPECT_EQ(MM2INT(12.5), settings.get<coord_t>("inherited_setting"));
+    EXPECT_EQ(std::string("yes"), settings.get<std::string>("overridden_setting"));
+    EXPECT_TRUE(settings.get<bool>("overridden_setting"));
+    EXPECT_THROW(settings.get<size_t>("unsigned_setting"), std::invalid_argument) << "Values that can't be parsed must fail the same way as without the snapshot.";
+
+    settings.add("inherited_setting", "3");
+    EXPECT_DOUBLE_EQ(3.0, settings.get<double>("inherited_setting")) << "Adding a setting thaws the container.";
+}
+
+TEST_F(SettingsTest, SettingKey)
+{
+    std::shared_ptr<Slice> current_slice = std::make_shared<Slice>(0);
+    Application::getInstance().current_slice_ = current_slice.get();
+
+    Settings parent;
+    parent.add("infill_line_distance", "2.5");
+    parent.add("infill_pattern", "grid");
+    settings.setParent(&parent);
+    settings.add("wall_line_count", "3");
+
+    EXPECT_EQ(MM2INT(2.5), settings.get<coord_t>(SettingKey::infill_line_distance));
+    EXPECT_EQ(EFillMethod::GRID, settings.get<EFillMethod>(SettingKey::infill_pattern));
+    EXPECT_EQ(size_t(3), settings.get<size_t>(SettingKey::wall_line_count));
+
+    settings.freeze();
+    EXPECT_EQ(MM2INT(2.5), settings.get<coord_t>(SettingKey::infill_line_distance)) << "The frozen value must be the same as the evaluated one.";
+    EXPECT_EQ(EFillMethod::GRID, settings.get<EFillMethod>(SettingKey::infill_pattern));
+    EXPECT_EQ(size_t(3), settings.get<size_t>(SettingKey::wall_line_count));
+
+    EXPECT_EQ(findSettingKey("wall_line_count"), SettingKey::wall_line_count);
+    EXPECT_EQ(settingKeyName(SettingKey::wall_line_count), "wall_line_count");
+    EXPECT_FALSE(findSettingKey("not_a_setting_the_engine_reads"));
+}
+
 TEST_F(SettingsTest, PluginExtendedEnum)
 {
     settings.add("infill_type", "PLUGIN::plugin_1::MOZAIC");
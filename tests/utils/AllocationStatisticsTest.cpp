@@ -0,0 +1,64 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/AllocationStatistics.h" // The class under test.
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+#ifdef ENABLE_ALLOCATION_STATS
+
+TEST(AllocationStatisticsTest, CountsPerStage)
+{
+    AllocationStatistics::setStage(Progress::Stage::SUPPORT);
+    AllocationStatistics::reset();
+    {
+        AllocationStatistics::Tag tag("test");
+        auto block = std::make_unique<char[]>(1000);
+        auto other_block = std::make_unique<char[]>(3000);
+    }
+    const auto counts = AllocationStatistics::getStageCounts();
+    const AllocationStatistics::Counts& support = counts[static_cast<size_t>(Progress::Stage::SUPPORT)];
+    EXPECT_GE(support.allocations, 2U);
+    EXPECT_GE(support.bytes, 4000U);
+    EXPECT_EQ(counts[static_cast<size_t>(Progress::Stage::EXPORT)].allocations, 0U);
+    AllocationStatistics::setStage(Progress::Stage::START);
+}
+
+TEST(AllocationStatisticsTest, CountsOtherThreads)
+{
+    AllocationStatistics::setStage(Progress::Stage::EXPORT);
+    AllocationStatistics::reset();
+    std::thread thread(
+        []()
+        {
+            AllocationStatistics::Tag tag("test thread");
+            auto block = std::make_unique<char[]>(5000);
+        });
+    thread.join();
+    EXPECT_GE(AllocationStatistics::getStageCounts()[static_cast<size_t>(Progress::Stage::EXPORT)].bytes, 5000U);
+    AllocationStatistics::setStage(Progress::Stage::START);
+}
+
+#else
+
+TEST(AllocationStatisticsTest, CountsNothingWhenDisabled)
+{
+    EXPECT_FALSE(AllocationStatistics::enabled());
+    auto block = std::make_unique<char[]>(1000);
+    for (const AllocationStatistics::Counts& counts : AllocationStatistics::getStageCounts())
+    {
+        EXPECT_EQ(counts.allocations, 0U);
+    }
+}
+
+#endif
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
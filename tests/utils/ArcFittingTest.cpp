@@ -0,0 +1,94 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ArcFitting.h"
+
+#include <cmath>
+#include <numbers>
+
+#include <gtest/gtest.h>
+
+namespace cura
+{
+// NOLINTBEGIN(*-magic-numbers)
+
+//! Points on a circle around the origin, from one angle to another, where the first point is left out.
+std::vector<Point2LL> circlePoints(const coord_t radius, const double from_angle, const double to_angle, const size_t count)
+{
+    std::vector<Point2LL> points;
+    for (size_t idx = 1; idx <= count; idx++)
+    {
+        const double angle = from_angle + (to_angle - from_angle) * idx / count;
+        points.emplace_back(std::llround(radius * std::cos(angle)), std::llround(radius * std::sin(angle)));
+    }
+    return points;
+}
+
+TEST(ArcFittingTest, HalfCircle)
+{
+    const coord_t radius = 10000;
+    const Point2LL start(radius, 0);
+    const std::vector<Point2LL> points = circlePoints(radius, 0.0, std::numbers::pi, 32);
+
+    const std::vector<FittedArc> arcs = fitArcs(start, points, 25);
+
+    ASSERT_EQ(arcs.size(), 1) << "The points are all on one circle, so they should make one arc.";
+    EXPECT_EQ(arcs[0].first_idx, 0);
+    EXPECT_EQ(arcs[0].last_idx, points.size() - 1);
+    EXPECT_LE(vSize(arcs[0].center), 5) << "The arc should go around the center of the circle.";
+    EXPECT_FALSE(arcs[0].clockwise);
+}
+
+TEST(ArcFittingTest, Clockwise)
+{
+    const coord_t radius = 5000;
+    const Point2LL start(0, radius);
+    const std::vector<Point2LL> points = circlePoints(radius, std::numbers::pi / 2.0, -std::numbers::pi / 2.0, 20);
+
+    const std::vector<FittedArc> arcs = fitArcs(start, points, 25);
+
+    ASSERT_EQ(arcs.size(), 1);
+    EXPECT_TRUE(arcs[0].clockwise);
+}
+
+TEST(ArcFittingTest, StraightLine)
+{
+    std::vector<Point2LL> points;
+    for (coord_t x = 1000; x <= 20000; x += 1000)
+    {
+        points.emplace_back(x, 0);
+    }
+
+    EXPECT_TRUE(fitArcs(Point2LL(0, 0), points, 25).empty()) << "Points on a line don't make an arc.";
+}
+
+TEST(ArcFittingTest, ArcBetweenLines)
+{
+    const coord_t radius = 10000;
+    std::vector<Point2LL> points{ Point2LL(radius, -5000), Point2LL(radius, 0) };
+    for (const Point2LL& point : circlePoints(radius, 0.0, std::numbers::pi / 2.0, 16))
+    {
+        points.push_back(point);
+    }
+    points.emplace_back(-5000, radius);
+
+    const std::vector<FittedArc> arcs = fitArcs(Point2LL(radius, -10000), points, 25);
+
+    ASSERT_EQ(arcs.size(), 1);
+    EXPECT_EQ(arcs[0].first_idx, 2) << "The arc should start at the point where the circle starts.";
+    EXPECT_EQ(arcs[0].last_idx, 17) << "The arc should end where the circle ends.";
+}
+
+TEST(ArcFittingTest, MaximumDeviation)
+{
+    // Few points on a small circle: the arc between two of them bulges out further than allowed.
+    const coord_t radius = 2000;
+    const std::vector<Point2LL> points = circlePoints(radius, 0.0, std::numbers::pi, 6);
+    const coord_t bulge = radius - std::llround(radius * std::cos(std::numbers::pi / 12.0));
+
+    EXPECT_TRUE(fitArcs(Point2LL(radius, 0), points, bulge - 5).empty()) << "The arc may not be further from the segments than the maximum deviation.";
+    EXPECT_EQ(fitArcs(Point2LL(radius, 0), points, bulge + 5).size(), 1);
+}
+
+// NOLINTEND(*-magic-numbers)
+} // namespace cura
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ChunkSink.h" // The class under test.
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class ChunkSinkTest : public testing::Test
+{
+public:
+    std::vector<std::string> chunks;
+
+    ChunkSink::Consumer collect()
+    {
+        return [this](std::string&& chunk)
+        {
+            chunks.push_back(std::move(chunk));
+        };
+    }
+};
+
+TEST_F(ChunkSinkTest, NothingUntilFlushed)
+{
+    ChunkSink sink(collect(), 64);
+    std::ostream stream(&sink);
+    stream << "G1 X10 Y10\n";
+    stream.flush();
+    EXPECT_TRUE(chunks.empty()) << "A chunk that isn't full yet should only be handed on when flushing the sink.";
+
+    sink.flush();
+    ASSERT_EQ(chunks.size(), 1);
+    EXPECT_EQ(chunks[0], "G1 X10 Y10\n");
+
+    sink.flush();
+    EXPECT_EQ(chunks.size(), 1) << "Flushing an empty sink shouldn't hand on an empty chunk.";
+}
+
+TEST_F(ChunkSinkTest, ChunksEndAtLines)
+{
+    constexpr size_t chunk_size = 64;
+    ChunkSink sink(collect(), chunk_size);
+    std::ostream stream(&sink);
+    std::string written;
+    for (int line = 0; line < 100; line++)
+    {
+        const std::string text = "G1 X" + std::to_string(line) + " Y" + std::to_string(line * 7) + "\n";
+        stream << text;
+        written += text;
+    }
+    sink.flush();
+
+    ASSERT_GT(chunks.size(), 1);
+    std::string received;
+    for (const std::string& chunk : chunks)
+    {
+        EXPECT_LE(chunk.size(), chunk_size);
+        EXPECT_EQ(chunk.back(), '\n') << "No chunk should end halfway a line.";
+        received += chunk;
+    }
+    EXPECT_EQ(received, written);
+}
+
+TEST_F(ChunkSinkTest, LongLine)
+{
+    ChunkSink sink(collect(), 16);
+    std::ostream stream(&sink);
+    const std::string line = ";" + std::string(40, 'x') + "\n";
+    stream << line << "G28\n";
+    sink.flush();
+
+    std::string received;
+    for (const std::string& chunk : chunks)
+    {
+        EXPECT_LE(chunk.size(), 16) << "A line longer than a chunk is split over several chunks.";
+        received += chunk;
+    }
+    EXPECT_EQ(received, line + "G28\n");
+}
+
+TEST_F(ChunkSinkTest, Discard)
+{
+    ChunkSink sink(collect(), 64);
+    std::ostream stream(&sink);
+    stream << "G1 X10\n";
+    sink.discard();
+    stream << "G1 X20\n";
+    sink.flush();
+
+    ASSERT_EQ(chunks.size(), 1);
+    EXPECT_EQ(chunks[0], "G1 X20\n");
+}
+
+TEST_F(ChunkSinkTest, ReuseBuffers)
+{
+    BufferPool pool(1024, 2);
+    std::string buffer = pool.acquire();
+    EXPECT_GE(buffer.capacity(), 1024);
+    buffer = "some g-code";
+    const char* const data = buffer.data();
+    pool.release(std::move(buffer));
+
+    const std::string reused = pool.acquire();
+    EXPECT_EQ(reused.data(), data) << "The buffer that was given back should be handed out again.";
+    EXPECT_TRUE(reused.empty());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
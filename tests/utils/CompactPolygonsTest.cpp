@@ -0,0 +1,123 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/CompactPolygons.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class CompactPolygonsTest : public testing::Test
+{
+public:
+    Polygons donut;
+
+    void SetUp() override
+    {
+        PolygonRef outer = donut.newPoly();
+        outer.emplace_back(-5000, -5000);
+        outer.emplace_back(1000, -5000);
+        outer.emplace_back(1000, 1000);
+        outer.emplace_back(-5000, 1000);
+        PolygonRef hole = donut.newPoly();
+        hole.emplace_back(250, 250);
+        hole.emplace_back(250, 750);
+        hole.emplace_back(750, 750);
+        hole.emplace_back(750, 250);
+    }
+};
+
+TEST_F(CompactPolygonsTest, RoundTrip)
+{
+    const CompactPolygons compact(donut);
+    EXPECT_TRUE(compact.isCompact());
+    ASSERT_EQ(compact.size(), donut.size());
+    EXPECT_EQ(compact.pointCount(), donut.pointCount());
+    for (size_t poly_idx = 0; poly_idx < donut.size(); poly_idx++)
+    {
+        for (size_t point_idx = 0; point_idx < donut[poly_idx].size(); point_idx++)
+        {
+            EXPECT_EQ(compact.getPoint(poly_idx, point_idx), donut[poly_idx][point_idx]);
+        }
+    }
+
+    const Polygons back = compact.toPolygons();
+    ASSERT_EQ(back.size(), donut.size());
+    for (size_t poly_idx = 0; poly_idx < donut.size(); poly_idx++)
+    {
+        EXPECT_EQ(*back[poly_idx], *donut[poly_idx]);
+    }
+}
+
+TEST_F(CompactPolygonsTest, HalvesVertexMemory)
+{
+    const CompactPolygons compact(donut);
+    EXPECT_LE(compact.getMemoryFootprint(), donut.pointCount() * sizeof(Point2LL) / 2 + (donut.size() + 1) * sizeof(size_t));
+}
+
+TEST_F(CompactPolygonsTest, TooWideForOffsets)
+{
+    constexpr coord_t far = 3'000'000'000;
+    Polygons wide;
+    PolygonRef triangle = wide.newPoly();
+    triangle.emplace_back(-far, 0);
+    triangle.emplace_back(far, 0);
+    triangle.emplace_back(0, far);
+
+    const CompactPolygons compact(wide);
+    EXPECT_FALSE(compact.isCompact());
+    EXPECT_EQ(compact.getPoint(0, 1), Point2LL(far, 0));
+    EXPECT_EQ(*compact.toPolygons()[0], *wide[0]);
+}
+
+TEST_F(CompactPolygonsTest, Empty)
+{
+    const CompactPolygons compact{ Polygons() };
+    EXPECT_TRUE(compact.empty());
+    EXPECT_EQ(compact.pointCount(), 0U);
+    EXPECT_TRUE(compact.toPolygons().empty());
+    EXPECT_TRUE(CompactPolygons().empty());
+}
+
+TEST_F(CompactPolygonsTest, CopiesShareVertices)
+{
+    const CompactPolygons compact(donut);
+    const CompactPolygons copy = compact; // NOLINT(performance-unnecessary-copy-initialization)
+    EXPECT_TRUE(copy.sharesWith(compact));
+    EXPECT_FALSE(CompactPolygons(donut).sharesWith(compact));
+}
+
+TEST_F(CompactPolygonsTest, PoolSharesSameShapes)
+{
+    CompactPolygonsPool pool;
+    const CompactPolygons first = pool.intern(donut);
+    Polygons moved = donut;
+    moved.translate(Point2LL(12345, -678));
+    const CompactPolygons second = pool.intern(moved);
+    EXPECT_TRUE(second.sharesWith(first));
+    EXPECT_EQ(pool.hitCount(), 1U);
+    EXPECT_EQ(*second.toPolygons()[0], *moved[0]);
+    EXPECT_EQ(*first.toPolygons()[0], *donut[0]);
+
+    Polygons other = donut;
+    other[1][0] = Point2LL(300, 250);
+    EXPECT_FALSE(pool.intern(other).sharesWith(first));
+    EXPECT_EQ(pool.hitCount(), 1U);
+}
+
+TEST_F(CompactPolygonsTest, PoolDoesNotKeepVerticesAlive)
+{
+    CompactPolygonsPool pool;
+    {
+        const CompactPolygons freed = pool.intern(donut);
+    }
+    pool.intern(donut);
+    EXPECT_EQ(pool.hitCount(), 0U);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,66 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/CounterRandom.h" // The class under test.
+
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+namespace
+{
+
+std::vector<uint64_t> draw(CounterRandom random, const size_t count)
+{
+    std::vector<uint64_t> result;
+    for (size_t i = 0; i < count; i++)
+    {
+        result.push_back(random());
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(CounterRandomTest, SameSeedSameNumbers)
+{
+    EXPECT_EQ(draw(CounterRandom(42), 100), draw(CounterRandom(42), 100));
+}
+
+TEST(CounterRandomTest, DifferentSeedsDifferentNumbers)
+{
+    const std::vector<uint64_t> first = draw(CounterRandom(1), 100);
+    const std::vector<uint64_t> second = draw(CounterRandom(2), 100);
+    EXPECT_NE(first, second);
+
+    // Neighbouring seeds shouldn't give the same numbers shifted by one either.
+    EXPECT_NE(std::vector<uint64_t>(first.begin() + 1, first.end()), std::vector<uint64_t>(second.begin(), second.end() - 1));
+}
+
+TEST(CounterRandomTest, NumbersAreSpread)
+{
+    const std::vector<uint64_t> numbers = draw(CounterRandom(0), 1000);
+    EXPECT_EQ(std::set<uint64_t>(numbers.begin(), numbers.end()).size(), numbers.size()) << "A thousand 64-bit numbers should all differ.";
+}
+
+TEST(CounterRandomTest, BelowBound)
+{
+    CounterRandom random(7);
+    std::set<int64_t> seen;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        const int64_t number = random.below(10);
+        ASSERT_GE(number, 0);
+        ASSERT_LT(number, 10);
+        seen.insert(number);
+    }
+    EXPECT_EQ(seen.size(), 10) << "Every number below the bound should come up in a thousand draws.";
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,54 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/DebugOutput.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/AABB.h"
+#include "utils/SVG.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(DebugOutputTest, SvgLayers)
+{
+    DebugOutput::setSvgOutput("", "");
+    EXPECT_FALSE(DebugOutput::svgEnabled(LayerIndex(0))) << "Without a directory, nothing is drawn.";
+
+    DebugOutput::setSvgOutput("debug_svg", "");
+    EXPECT_EQ(DebugOutput::svgEnabled(LayerIndex(0)), DebugOutput::compiled());
+    EXPECT_EQ(DebugOutput::svgEnabled(LayerIndex(1234)), DebugOutput::compiled());
+
+    DebugOutput::setSvgOutput("debug_svg", "-2,5,10-12");
+    if (DebugOutput::compiled())
+    {
+        EXPECT_TRUE(DebugOutput::svgEnabled(LayerIndex(-2)));
+        EXPECT_TRUE(DebugOutput::svgEnabled(LayerIndex(5)));
+        EXPECT_TRUE(DebugOutput::svgEnabled(LayerIndex(10)));
+        EXPECT_TRUE(DebugOutput::svgEnabled(LayerIndex(12)));
+    }
+    EXPECT_FALSE(DebugOutput::svgEnabled(LayerIndex(0)));
+    EXPECT_FALSE(DebugOutput::svgEnabled(LayerIndex(6)));
+    EXPECT_FALSE(DebugOutput::svgEnabled(LayerIndex(13)));
+
+    DebugOutput::setSvgOutput("", "");
+}
+
+TEST(DebugOutputTest, ArgumentsOnlyEvaluatedWhenWanted)
+{
+    DebugOutput::setSvgOutput("", "");
+    int evaluated = 0;
+    CURA_DEBUG_SVG("unused", LayerIndex(0), (evaluated++, AABB()), [](SVG&) {});
+    EXPECT_EQ(evaluated, 0);
+
+    const spdlog::level::level_enum original_level = spdlog::get_level();
+    spdlog::set_level(spdlog::level::info);
+    CURA_LOG_DEBUG("Not logged: {}", evaluated++);
+    EXPECT_EQ(evaluated, 0);
+    spdlog::set_level(original_level);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
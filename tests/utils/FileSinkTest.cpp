@@ -0,0 +1,105 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/FileSink.h" // The class under test.
+
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class FileSinkTest : public testing::Test
+{
+public:
+    std::filesystem::path filename;
+
+    void SetUp() override
+    {
+        filename = std::filesystem::temp_directory_path() / ("FileSinkTest_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()) + ".gcode");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(filename);
+    }
+
+    std::string readFile() const
+    {
+        std::ifstream file(filename);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+};
+
+TEST_F(FileSinkTest, WritesEverything)
+{
+    std::string expected;
+    {
+        FileSink sink(64); // Small, so that the buffer runs full many times.
+        ASSERT_TRUE(sink.open(filename.string().c_str()));
+        std::ostream out(&sink);
+        for (size_t line = 0; line < 1000; line++)
+        {
+            const std::string code = "G1 X" + std::to_string(line) + '\n';
+            out << code;
+            expected += code;
+            if (line % 100 == 0)
+            {
+                const std::string chunk(200, ';'); // Larger than the buffer.
+                out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                expected += chunk;
+            }
+        }
+        out.put('\n');
+        expected += '\n';
+    } // The destructor writes what is left.
+    EXPECT_EQ(readFile(), expected);
+}
+
+TEST_F(FileSinkTest, FlushWritesBuffer)
+{
+    FileSink sink;
+    ASSERT_TRUE(sink.open(filename.string().c_str()));
+    std::ostream out(&sink);
+    out << ";LAYER:0\n";
+    out.flush();
+    EXPECT_EQ(readFile(), ";LAYER:0\n");
+}
+
+TEST_F(FileSinkTest, OverwriteHeader)
+{
+    {
+        FileSink sink(64);
+        ASSERT_TRUE(sink.open(filename.string().c_str()));
+        std::ostream out(&sink);
+        out << ";TIME:6666\n;      \n";
+        for (size_t line = 0; line < 100; line++)
+        {
+            out << "G1 X" << line << '\n';
+        }
+        out.flush();
+        ASSERT_TRUE(sink.overwrite(0, ";TIME:123456\n;    "));
+        out << ";END\n";
+    }
+    const std::string contents = readFile();
+    EXPECT_TRUE(contents.starts_with(";TIME:123456\n;    \nG1 X0\n"));
+    EXPECT_TRUE(contents.ends_with("G1 X99\n;END\n"));
+}
+
+TEST_F(FileSinkTest, OpenFails)
+{
+    FileSink sink;
+    EXPECT_FALSE(sink.open((filename / "not_a_directory" / "output.gcode").string().c_str()));
+    EXPECT_FALSE(sink.isOpen());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/FlatPolygons.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/polygon.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class FlatPolygonsTest : public testing::Test
+{
+public:
+    Polygons donut;
+
+    void SetUp() override
+    {
+        PolygonRef outer = donut.newPoly();
+        outer.emplace_back(0, 0);
+        outer.emplace_back(1000, 0);
+        outer.emplace_back(1000, 1000);
+        outer.emplace_back(0, 1000);
+        PolygonRef hole = donut.newPoly();
+        hole.emplace_back(250, 250);
+        hole.emplace_back(250, 750);
+        hole.emplace_back(750, 750);
+        hole.emplace_back(750, 250);
+        PolygonRef triangle = donut.newPoly();
+        triangle.emplace_back(400, 400);
+        triangle.emplace_back(600, 400);
+        triangle.emplace_back(500, 600);
+    }
+};
+
+TEST_F(FlatPolygonsTest, RoundTrip)
+{
+    const FlatPolygons flat(donut);
+    ASSERT_EQ(flat.size(), donut.size());
+    EXPECT_EQ(flat.pointCount(), donut.pointCount());
+    for (size_t poly_idx = 0; poly_idx < donut.size(); poly_idx++)
+    {
+        ASSERT_EQ(flat[poly_idx].size(), donut[poly_idx].size());
+        for (size_t point_idx = 0; point_idx < donut[poly_idx].size(); point_idx++)
+        {
+            EXPECT_EQ(flat[poly_idx][point_idx], donut[poly_idx][point_idx]);
+        }
+    }
+
+    const Polygons back = flat.toPolygons();
+    ASSERT_EQ(back.size(), donut.size());
+    for (size_t poly_idx = 0; poly_idx < donut.size(); poly_idx++)
+    {
+        EXPECT_EQ(*back[poly_idx], *donut[poly_idx]);
+    }
+}
+
+TEST_F(FlatPolygonsTest, Empty)
+{
+    FlatPolygons flat(donut);
+    flat.clear();
+    EXPECT_TRUE(flat.empty());
+    EXPECT_EQ(flat.pointCount(), 0);
+    EXPECT_EQ(flat.begin(), flat.end());
+    EXPECT_FALSE(flat.inside(Point2LL(100, 100)));
+    EXPECT_TRUE(flat.toPolygons().empty());
+}
+
+TEST_F(FlatPolygonsTest, InsideMatchesPolygons)
+{
+    const FlatPolygons flat(donut);
+    for (coord_t x = -100; x <= 1100; x += 50)
+    {
+        for (coord_t y = -100; y <= 1100; y += 50)
+        {
+            const Point2LL point(x, y);
+            EXPECT_EQ(flat.inside(point, false), donut.inside(point, false)) << "At " << x << ", " << y;
+            EXPECT_EQ(flat.inside(point, true), donut.inside(point, true)) << "At " << x << ", " << y;
+        }
+    }
+    EXPECT_TRUE(flat.inside(Point2LL(100, 100)));
+    EXPECT_FALSE(flat.inside(Point2LL(300, 300)));
+    EXPECT_TRUE(flat.inside(Point2LL(500, 450)));
+    EXPECT_TRUE(flat.inside(Point2LL(0, 500), true));
+    EXPECT_FALSE(flat.inside(Point2LL(0, 500), false));
+}
+
+TEST_F(FlatPolygonsTest, BatchedInsideMatchesSingle)
+{
+    const FlatPolygons flat(donut);
+    std::vector<Point2LL> points;
+    for (coord_t x = -100; x <= 1100; x += 25)
+    {
+        for (coord_t y = -100; y <= 1100; y += 25)
+        {
+            points.emplace_back(x, y);
+        }
+    }
+    for (const size_t band_count : { 0, 1, 3, 100 })
+    {
+        const EdgeBandIndex index(flat, band_count);
+        for (const bool border_result : { false, true })
+        {
+            const std::vector<bool> result = index.inside(points, border_result);
+            ASSERT_EQ(result.size(), points.size());
+            for (size_t point_idx = 0; point_idx < points.size(); point_idx++)
+            {
+                EXPECT_EQ(result[point_idx], flat.inside(points[point_idx], border_result)) << "At " << points[point_idx].X << ", " << points[point_idx].Y << " with " << band_count << " bands";
+            }
+        }
+    }
+    EXPECT_EQ(flat.inside(points, true), EdgeBandIndex(flat).inside(points, true));
+    EXPECT_EQ(EdgeBandIndex(FlatPolygons()).inside(points), std::vector<bool>(points.size(), false));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -3,7 +3,9 @@
 
 #include "utils/linearAlg2D.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -359,5 +361,36 @@ TEST(Temp, LineDistTests)
     }
 }
 
+TEST(LinearAlg2DTest, Dist2LowerBoundsToLineSegments)
+{
+    std::srand(123);
+    std::vector<Point2LL> points;
+    for (int point_idx = 0; point_idx < 150; ++point_idx)
+    {
+        points.emplace_back((std::rand() % 20000) - 10000, (std::rand() % 20000) - 10000);
+    }
+    points.emplace_back(points.back()); // A segment of length 0.
+    std::vector<coord_t> lower_bounds(points.size());
+    for (int from_idx = 0; from_idx < 100; ++from_idx)
+    {
+        const Point2LL from((std::rand() % 30000) - 15000, (std::rand() % 30000) - 15000);
+        LinearAlg2D::getDist2LowerBoundsToLineSegments(from, points, points.front(), lower_bounds);
+        for (size_t segment_idx = 0; segment_idx < points.size(); segment_idx++)
+        {
+            const Point2LL& start = points[segment_idx];
+            const Point2LL& end = points[(segment_idx + 1) % points.size()];
+            // Exactly the squared distance to the bounding box of the segment.
+            const coord_t dx = std::max({ coord_t(0), std::min(start.X, end.X) - from.X, from.X - std::max(start.X, end.X) });
+            const coord_t dy = std::max({ coord_t(0), std::min(start.Y, end.Y) - from.Y, from.Y - std::max(start.Y, end.Y) });
+            ASSERT_EQ(lower_bounds[segment_idx], dx * dx + dy * dy);
+            // Never further away than the closest point on the segment.
+            ASSERT_LE(lower_bounds[segment_idx], vSize2(from - LinearAlg2D::getClosestOnLineSegment(from, start, end)));
+        }
+    }
+
+    // An empty run doesn't touch anything.
+    LinearAlg2D::getDist2LowerBoundsToLineSegments(Point2LL(0, 0), std::span<const Point2LL>(), Point2LL(0, 0), std::span<coord_t>());
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
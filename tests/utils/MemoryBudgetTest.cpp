@@ -0,0 +1,51 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/MemoryBudget.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/MemoryUsage.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(MemoryBudgetTest, PressureByFraction)
+{
+    constexpr size_t budget = 1000;
+    EXPECT_EQ(MemoryBudget::getPressure(100, budget), MemoryBudget::Pressure::NONE);
+    EXPECT_EQ(MemoryBudget::getPressure(749, budget), MemoryBudget::Pressure::NONE);
+    EXPECT_EQ(MemoryBudget::getPressure(750, budget), MemoryBudget::Pressure::HIGH);
+    EXPECT_EQ(MemoryBudget::getPressure(900, budget), MemoryBudget::Pressure::CRITICAL);
+    EXPECT_EQ(MemoryBudget::getPressure(5000, budget), MemoryBudget::Pressure::CRITICAL);
+}
+
+TEST(MemoryBudgetTest, NoBudgetNoPressure)
+{
+    EXPECT_EQ(MemoryBudget::getPressure(size_t(1) << 40, 0), MemoryBudget::Pressure::NONE);
+
+    const size_t original_budget = MemoryBudget::getBudgetBytes();
+    MemoryBudget::setBudgetBytes(0);
+    EXPECT_EQ(MemoryBudget::getPressure(), MemoryBudget::Pressure::NONE);
+    EXPECT_EQ(MemoryBudget::limitParallelism(8), 8U);
+    EXPECT_EQ(MemoryBudget::limitParallelism(0), 1U);
+    MemoryBudget::setBudgetBytes(original_budget);
+}
+
+TEST(MemoryBudgetTest, FewerThreadsOverBudget)
+{
+    if (MemoryUsage::sample().resident_bytes == 0)
+    {
+        GTEST_SKIP() << "The memory of the process can't be found out on this platform.";
+    }
+    const size_t original_budget = MemoryBudget::getBudgetBytes();
+    MemoryBudget::setBudgetBytes(1); // Any process holds more than that.
+    EXPECT_EQ(MemoryBudget::getPressure(), MemoryBudget::Pressure::CRITICAL);
+    EXPECT_EQ(MemoryBudget::limitParallelism(8), 4U);
+    EXPECT_EQ(MemoryBudget::limitParallelism(1), 1U);
+    MemoryBudget::setBudgetBytes(original_budget);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
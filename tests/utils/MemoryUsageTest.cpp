@@ -0,0 +1,40 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/MemoryUsage.h" // The class under test.
+
+#include <cstring>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+#if defined(__linux__) || (defined(__APPLE__) && defined(__MACH__)) || defined(_WIN32)
+
+TEST(MemoryUsageTest, PeakIsAtLeastResident)
+{
+    const MemoryUsage usage = MemoryUsage::sample();
+    EXPECT_GT(usage.resident_bytes, 0);
+    EXPECT_GE(usage.peak_resident_bytes, usage.resident_bytes);
+}
+
+TEST(MemoryUsageTest, PeakIncludesFreedMemory)
+{
+    constexpr size_t size = 64 * 1024 * 1024;
+    MemoryUsage::resetPeak();
+    const MemoryUsage before = MemoryUsage::sample();
+    {
+        auto block = std::make_unique<char[]>(size);
+        std::memset(block.get(), 1, size); // Only memory that is written to is resident.
+    }
+    const MemoryUsage after = MemoryUsage::sample();
+    EXPECT_GE(after.peak_resident_bytes, before.resident_bytes + size / 2); // Other allocations may have been freed in the meantime.
+}
+
+#endif
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
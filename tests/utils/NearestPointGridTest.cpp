@@ -0,0 +1,98 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/NearestPointGrid.h"
+
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+/*!
+ * Find the nearest point by visiting the grid nearest first and stopping as soon as the rest is further.
+ */
+size_t findNearest(const NearestPointGrid<size_t>& grid, const std::vector<Point2LL>& points, const Point2LL& query)
+{
+    coord_t best_distance2 = std::numeric_limits<coord_t>::max();
+    size_t best = std::numeric_limits<size_t>::max();
+    grid.processNearestFirst(
+        query,
+        [&](const Point2LL& point, const size_t idx)
+        {
+            EXPECT_EQ(point, points[idx]) << "Each point must be stored with its own value.";
+            const coord_t distance2 = vSize2(point - query);
+            if (distance2 < best_distance2 || (distance2 == best_distance2 && idx < best))
+            {
+                best_distance2 = distance2;
+                best = idx;
+            }
+        },
+        [&best_distance2](const coord_t min_distance)
+        {
+            return min_distance * min_distance <= best_distance2;
+        });
+    return best;
+}
+
+TEST(NearestPointGridTest, EmptyVisitsNothing)
+{
+    NearestPointGrid<size_t> grid(100);
+    EXPECT_TRUE(grid.empty());
+    bool visited = false;
+    grid.processNearestFirst(
+        Point2LL(0, 0),
+        [&visited](const Point2LL&, const size_t)
+        {
+            visited = true;
+        },
+        [](const coord_t)
+        {
+            return true;
+        });
+    EXPECT_FALSE(visited);
+}
+
+TEST(NearestPointGridTest, NearestWhileRemoving)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<coord_t> coord(-50000, 50000);
+    std::vector<Point2LL> points;
+    NearestPointGrid<size_t> grid(1000);
+    for (size_t idx = 0; idx < 500; ++idx)
+    {
+        points.emplace_back(coord(rng), coord(rng));
+        grid.insert(points.back(), idx);
+    }
+    std::vector<bool> removed(points.size(), false);
+
+    // Walk from point to nearest point, removing each, like ordering paths does. This also makes the cells grow.
+    Point2LL query(-60000, 70000); // Outside of all points.
+    for (size_t step = 0; step < points.size(); ++step)
+    {
+        ASSERT_EQ(grid.size(), points.size() - step);
+        size_t expected = std::numeric_limits<size_t>::max();
+        for (size_t idx = 0; idx < points.size(); ++idx)
+        {
+            if (! removed[idx] && (expected == std::numeric_limits<size_t>::max() || vSize2(points[idx] - query) < vSize2(points[expected] - query)))
+            {
+                expected = idx;
+            }
+        }
+        const size_t nearest = findNearest(grid, points, query);
+        ASSERT_EQ(vSize2(points[nearest] - query), vSize2(points[expected] - query)) << "Step " << step << " must find a nearest point.";
+        EXPECT_TRUE(grid.remove(points[nearest], nearest));
+        EXPECT_FALSE(grid.remove(points[nearest], nearest)) << "A removed point is no longer in the grid.";
+        removed[nearest] = true;
+        query = points[nearest];
+    }
+    EXPECT_TRUE(grid.empty());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -6,6 +6,7 @@
 #include <gtest/gtest.h>
 
 #include "utils/Coord_t.h"
+#include "utils/MultiOffset.h"
 #include "utils/SVG.h" // helper functions
 #include "utils/polygonUtils.h" // helper functions
 
@@ -141,6 +142,66 @@ TEST_F(PolygonTest, polygonOffsetBugTest)
     }
 }
 
+TEST_F(PolygonTest, multiOffsetMatchesOffsetTest)
+{
+    Polygons polys;
+    polys.add(clockwise_donut);
+    polys.add(pointy_square);
+    const std::vector<coord_t> distances = { -40, -10, 0, 10, 25, 100 };
+    for (const ClipperLib::JoinType join_type : { ClipperLib::jtMiter, ClipperLib::jtRound })
+    {
+        MultiOffset multi_offset(polys, join_type);
+        const std::vector<Polygons> offsets = multi_offset.offset(distances);
+        ASSERT_EQ(offsets.size(), distances.size());
+        for (size_t distance_idx = 0; distance_idx < distances.size(); distance_idx++)
+        {
+            const Polygons expected = polys.offset(distances[distance_idx], join_type);
+            ASSERT_EQ(offsets[distance_idx].size(), expected.size()) << "Offset by " << distances[distance_idx];
+            for (size_t poly_idx = 0; poly_idx < expected.size(); poly_idx++)
+            {
+                EXPECT_EQ(*offsets[distance_idx][poly_idx], *expected[poly_idx]) << "Offset by " << distances[distance_idx];
+            }
+        }
+        EXPECT_EQ(multi_offset.offset(25).pointCount(), polys.offset(25, join_type).pointCount()) << "Offsetting again should give the same result.";
+    }
+}
+
+TEST_F(PolygonTest, booleansWithDisjointPartsTest)
+{
+    Polygons squares;
+    squares.add(test_square);
+    Polygon far_square;
+    for (const Point2LL& point : test_square)
+    {
+        far_square.add(point + Point2LL(1000, 0));
+    }
+    squares.add(far_square);
+
+    Polygons far_away;
+    Polygon far_away_square;
+    for (const Point2LL& point : test_square)
+    {
+        far_away_square.add(point + Point2LL(0, 5000));
+    }
+    far_away.add(far_away_square);
+
+    EXPECT_TRUE(squares.intersection(far_away).empty()) << "Polygons with disjoint bounding boxes don't intersect.";
+    EXPECT_TRUE(far_away.intersection(squares).empty()) << "Polygons with disjoint bounding boxes don't intersect.";
+    EXPECT_DOUBLE_EQ(squares.difference(far_away).area(), squares.area()) << "Subtracting something far away changes nothing.";
+
+    Polygons clip;
+    Polygon half_square;
+    half_square.emplace_back(50, -10);
+    half_square.emplace_back(200, -10);
+    half_square.emplace_back(200, 110);
+    half_square.emplace_back(50, 110);
+    clip.add(half_square);
+    clip.add(far_away_square);
+    EXPECT_DOUBLE_EQ(squares.intersection(clip).area(), 50.0 * 100.0) << "Only the overlapping half of the first square remains.";
+    EXPECT_DOUBLE_EQ(clip.intersection(squares).area(), 50.0 * 100.0) << "Intersecting is symmetric.";
+    EXPECT_DOUBLE_EQ(squares.difference(clip).area(), 50.0 * 100.0 + 100.0 * 100.0) << "Half of the first square and the second square remain.";
+}
+
 TEST_F(PolygonTest, isOutsideTest)
 {
     Polygons test_triangle;
@@ -557,5 +618,67 @@ TEST_F(PolygonTest, removeSmallAreas_complex)
     act_polygons.removeSmallAreas(1e-3, true);
     twoPolygonsAreEqual(act_polygons, exp_polygons);
 }
+
+/*
+ * Check that cleanUp removes the same vertices and polygons as the separate cleanup passes do one after the other.
+ */
+TEST_F(PolygonTest, cleanUpMatchesSeparatePassesTest)
+{
+    Polygons polygons;
+    polygons.add(pointy_square);
+    PolygonRef spiky = polygons.newPoly(); // With a spike back onto itself and a colinear vertex.
+    spiky.emplace_back(200, 0);
+    spiky.emplace_back(300, 0);
+    spiky.emplace_back(300, 50);
+    spiky.emplace_back(350, 50);
+    spiky.emplace_back(300, 50);
+    spiky.emplace_back(300, 100);
+    spiky.emplace_back(250, 100);
+    spiky.emplace_back(200, 100);
+    PolygonRef flat = polygons.newPoly(); // Nothing left after removing the degenerate vertices.
+    flat.emplace_back(0, 500);
+    flat.emplace_back(100, 500);
+    flat.emplace_back(50, 500);
+    Polygon small_hole = small_area;
+    small_hole.reverse();
+    small_hole.translate(Point2LL(20, 20));
+    polygons.add(small_hole);
+    polygons.add(test_square);
+
+    for (const double min_area_size : { 0.0, 1e-3 })
+    {
+        Polygons expected = polygons;
+        expected.removeDegenerateVerts();
+        expected.removeColinearEdges(AngleRadians(0.01));
+        expected.removeSmallAreas(min_area_size, true);
+
+        Polygons result = polygons;
+        result.cleanUp(AngleRadians(0.01), min_area_size);
+        EXPECT_EQ(result.size(), expected.size());
+        twoPolygonsAreEqual(result, expected);
+    }
+
+    Polygons result = polygons;
+    result.cleanUp(AngleRadians(0.01), 1e-3);
+    ASSERT_EQ(result.size(), 3);
+    EXPECT_EQ(result[1].size(), 4); // The spike and the vertex on the straight top edge are gone.
+}
+
+TEST_F(PolygonTest, shrinkToFitKeepsPoints)
+{
+    Polygons polygons;
+    polygons.paths.reserve(16);
+    polygons.add(test_square);
+    polygons.paths.back().reserve(100);
+    const size_t reserved_bytes = 15 * sizeof(ClipperLib::Path) + (100 - test_square.size()) * sizeof(Point2LL);
+
+    EXPECT_EQ(polygons.shrinkToFit(), reserved_bytes);
+    EXPECT_EQ(polygons.paths.capacity(), 1U);
+    EXPECT_EQ(polygons.paths.back().capacity(), test_square.size());
+    Polygons expected;
+    expected.add(test_square);
+    twoPolygonsAreEqual(polygons, expected);
+    EXPECT_EQ(polygons.shrinkToFit(), 0U) << "Nothing is left to free the second time.";
+}
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 
+#include "Application.h" // To run unionManySmall on the thread pool.
 #include "utils/Coord_t.h"
 #include "utils/Point2LL.h" // Creating and testing with points.
 #include "utils/polygon.h" // Creating polygons to test with.
@@ -518,5 +519,37 @@ TEST_F(PolygonUtilsTest, DISABLED_RelativeHammingLineLineDifferentVerts) // Disa
     ASSERT_EQ(PolygonUtils::relativeHammingDistance(test_line, test_line_extra_vertices), 0.0) << "Even though the exact vertices are different, the actual outline is the same.";
 }
 
+TEST(UnionManySmallTest, SameAsSingleUnion)
+{
+    Application::getInstance().startThreadPool();
+
+    // A grid of overlapping squares, in a shuffled order, with a few islands.
+    Polygons squares;
+    for (coord_t i = 0; i < 500; i++)
+    {
+        const coord_t x = (i * 37) % 25 * 80;
+        const coord_t y = (i * 37) / 25 % 20 * 80 + (i % 7 == 0 ? 10000 : 0);
+        PolygonRef square = squares.newPoly();
+        square.emplace_back(x, y);
+        square.emplace_back(x + 100, y);
+        square.emplace_back(x + 100, y + 100);
+        square.emplace_back(x, y + 100);
+    }
+    const Polygons expected = squares.unionPolygons();
+    const Polygons result = PolygonUtils::unionManySmall(squares);
+    EXPECT_EQ(result.size(), expected.size());
+    EXPECT_DOUBLE_EQ(result.area(), expected.area());
+    EXPECT_EQ(result.xorPolygons(expected).area(), 0.0);
+
+    // A hole on its own would be filled, so polygons with holes are unioned at once.
+    Polygons with_hole = squares;
+    PolygonRef hole = with_hole.newPoly();
+    hole.emplace_back(500, 500);
+    hole.emplace_back(500, 900);
+    hole.emplace_back(900, 900);
+    hole.emplace_back(900, 500);
+    EXPECT_EQ(PolygonUtils::unionManySmall(with_hole).xorPolygons(with_hole.unionPolygons()).area(), 0.0);
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
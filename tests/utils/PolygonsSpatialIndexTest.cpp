@@ -0,0 +1,126 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/PolygonsSpatialIndex.h" // The class under test.
+
+#include <gtest/gtest.h>
+
+#include "utils/polygon.h"
+#include "utils/polygonUtils.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class PolygonsSpatialIndexTest : public testing::Test
+{
+public:
+    Polygons shapes;
+
+    void SetUp() override
+    {
+        PolygonRef square = shapes.newPoly();
+        square.emplace_back(0, 0);
+        square.emplace_back(1000, 0);
+        square.emplace_back(1000, 1000);
+        square.emplace_back(0, 1000);
+        PolygonRef hole = shapes.newPoly();
+        hole.emplace_back(250, 250);
+        hole.emplace_back(250, 750);
+        hole.emplace_back(750, 750);
+        hole.emplace_back(750, 250);
+        PolygonRef far_triangle = shapes.newPoly();
+        far_triangle.emplace_back(5000, 5000);
+        far_triangle.emplace_back(5600, 5100);
+        far_triangle.emplace_back(5100, 5900);
+        PolygonRef sliver = shapes.newPoly(); // Long and diagonal, so that it crosses many cells.
+        sliver.emplace_back(-3000, 6000);
+        sliver.emplace_back(4000, -1000);
+        sliver.emplace_back(4010, -990);
+    }
+};
+
+TEST_F(PolygonsSpatialIndexTest, FindClosestMatchesPolygonUtils)
+{
+    const PolygonsSpatialIndex index(shapes);
+    for (coord_t x = -4000; x <= 7000; x += 130)
+    {
+        for (coord_t y = -2000; y <= 7000; y += 170)
+        {
+            const Point2LL from(x, y);
+            const ClosestPolygonPoint expected = PolygonUtils::findClosest(from, shapes);
+            const ClosestPolygonPoint result = index.findClosest(from);
+            ASSERT_TRUE(result.isValid());
+            EXPECT_EQ(vSize2(result.location_ - from), vSize2(expected.location_ - from)) << "At " << x << ", " << y;
+            EXPECT_TRUE(result.poly_ == ConstPolygonPointer(shapes[result.poly_idx_]));
+
+            const PolygonsPointIndex expected_vert = PolygonUtils::findNearestVert(from, shapes);
+            const PolygonsPointIndex result_vert = index.findNearestVert(from);
+            EXPECT_EQ(vSize2(result_vert.p() - from), vSize2(expected_vert.p() - from)) << "At " << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(PolygonsSpatialIndexTest, MoveInside)
+{
+    const PolygonsSpatialIndex index(shapes);
+    Point2LL from(100, -50);
+    const ClosestPolygonPoint closest = index.moveInside2(from, 20);
+    ASSERT_TRUE(closest.isValid());
+    EXPECT_EQ(closest.location_, Point2LL(100, 0));
+    EXPECT_EQ(from, Point2LL(100, 20));
+
+    Point2LL too_far(100, -5000);
+    EXPECT_FALSE(index.moveInside2(too_far, 20, 1000 * 1000).isValid());
+    EXPECT_EQ(too_far, Point2LL(100, -5000));
+
+    Point2LL in_hole(500, 740);
+    EXPECT_TRUE(index.ensureInsideOrOutside(in_hole, 20).isValid());
+    EXPECT_TRUE(shapes.inside(in_hole));
+}
+
+TEST_F(PolygonsSpatialIndexTest, InsideMatchesPolygons)
+{
+    const PolygonsSpatialIndex index(shapes);
+    // The steps hit vertices and edges of the shapes, to check the points on the border too.
+    for (coord_t x = -4000; x <= 7000; x += 50)
+    {
+        for (coord_t y = -2000; y <= 7000; y += 50)
+        {
+            const Point2LL p(x, y);
+            EXPECT_EQ(index.inside(p, true), shapes.inside(p, true)) << "At " << x << ", " << y;
+            EXPECT_EQ(index.inside(p, false), shapes.inside(p, false)) << "At " << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(PolygonsSpatialIndexTest, CollidesWithLineSegmentMatchesPolygonUtils)
+{
+    const PolygonsSpatialIndex index(shapes);
+    const Point2LL start(500, 500);
+    for (coord_t x = -4000; x <= 7000; x += 250)
+    {
+        for (coord_t y = -2000; y <= 7000; y += 250)
+        {
+            const Point2LL end(x, y);
+            EXPECT_EQ(index.collidesWithLineSegment(start, end), PolygonUtils::polygonCollidesWithLineSegment(shapes, start, end)) << "To " << x << ", " << y;
+            const Point2LL short_start(x + 40, y - 30);
+            EXPECT_EQ(index.collidesWithLineSegment(short_start, end), PolygonUtils::polygonCollidesWithLineSegment(shapes, short_start, end)) << "At " << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(PolygonsSpatialIndexTest, Empty)
+{
+    const Polygons empty;
+    const PolygonsSpatialIndex index(empty);
+    EXPECT_FALSE(index.findClosest(Point2LL(0, 0)).isValid());
+    Point2LL from(10, 10);
+    EXPECT_FALSE(index.moveInside2(from, 10).isValid());
+    EXPECT_EQ(from, Point2LL(10, 10));
+    EXPECT_FALSE(index.inside(Point2LL(10, 10), true));
+    EXPECT_FALSE(index.collidesWithLineSegment(Point2LL(0, 0), Point2LL(10, 10)));
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
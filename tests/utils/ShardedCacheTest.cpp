@@ -0,0 +1,93 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ShardedCache.h"
+
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(ShardedCacheTest, FindInserted)
+{
+    ShardedCache<int, std::string> cache;
+    EXPECT_FALSE(cache.find(1)) << "An empty cache has no entries.";
+
+    cache.insert(std::vector<std::pair<int, std::string>>{ { 1, "one" }, { 2, "two" } });
+
+    ASSERT_TRUE(cache.find(1));
+    EXPECT_EQ(cache.find(1).value().get(), "one");
+    ASSERT_TRUE(cache.find(2));
+    EXPECT_EQ(cache.find(2).value().get(), "two");
+    EXPECT_FALSE(cache.contains(3)) << "Keys that weren't inserted have no entry.";
+}
+
+TEST(ShardedCacheTest, KeepsFirstEntry)
+{
+    ShardedCache<int, std::string> cache;
+    cache.insert(std::unordered_map<int, std::string>{ { 1, "first" } });
+    const std::string& first = cache.find(1).value().get();
+
+    cache.insert(std::unordered_map<int, std::string>{ { 1, "second" } });
+
+    EXPECT_EQ(cache.find(1).value().get(), "first") << "Entries that exist already must not be replaced.";
+    EXPECT_EQ(&cache.find(1).value().get(), &first) << "References to entries must stay valid.";
+}
+
+TEST(ShardedCacheTest, Erase)
+{
+    ShardedCache<int, std::string> cache;
+    cache.insert(std::vector<std::pair<int, std::string>>{ { 1, "one" }, { 2, "two" } });
+
+    const std::optional<std::string> erased = cache.erase(1);
+
+    ASSERT_TRUE(erased) << "Erasing an entry returns its value.";
+    EXPECT_EQ(*erased, "one");
+    EXPECT_FALSE(cache.contains(1)) << "Erased entries are no longer found.";
+    EXPECT_TRUE(cache.contains(2)) << "Other entries are kept.";
+    EXPECT_FALSE(cache.erase(1)) << "Erasing a key without an entry does nothing.";
+
+    cache.insert(std::vector<std::pair<int, std::string>>{ { 1, "uno" } });
+    EXPECT_EQ(cache.find(1).value().get(), "uno") << "An erased entry can be added again.";
+}
+
+TEST(ShardedCacheTest, ConcurrentInsertAndFind)
+{
+    ShardedCache<int, int> cache;
+    constexpr int thread_count = 4;
+    constexpr int keys_per_thread = 1000;
+
+    std::vector<std::thread> threads;
+    for (int thread_idx = 0; thread_idx < thread_count; thread_idx++)
+    {
+        threads.emplace_back(
+            [&cache, thread_idx]()
+            {
+                for (int key = thread_idx * keys_per_thread; key < (thread_idx + 1) * keys_per_thread; key++)
+                {
+                    cache.insert(std::vector<std::pair<int, int>>{ { key, key * 2 } });
+                    cache.find(key - 1); // Lookups of other threads' keys must be safe too.
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int key = 0; key < thread_count * keys_per_thread; key++)
+    {
+        ASSERT_TRUE(cache.find(key)) << "Every inserted key must be found.";
+        EXPECT_EQ(cache.find(key).value().get(), key * 2);
+    }
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
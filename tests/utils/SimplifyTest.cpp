@@ -3,7 +3,9 @@
 
 #include "utils/Simplify.h" // The unit under test.
 
+#include <cmath>
 #include <gtest/gtest.h>
+#include <numbers>
 
 #include "utils/Coord_t.h"
 #include "utils/polygonUtils.h" // Helper functions for testing deviation.
@@ -403,5 +405,74 @@ TEST_F(SimplifyTest, ToDegenerate)
     EXPECT_EQ(segment.size(), 0) << "The segment got removed entirely, because simplification would reduce its vertices to less than 2, making it degenerate.";
 }
 
+/*!
+ * Tests that reusing the same scratch memory for several polygons of different
+ * sizes gives the same results as simplifying each of them on its own.
+ */
+TEST_F(SimplifyTest, ReuseScratch)
+{
+    Simplify::Scratch scratch;
+    for (const size_t vertex_count : { 5000, 12, 800, 3 })
+    {
+        Polygon circle;
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            const double angle = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(vertex_count);
+            circle.add(Point2LL(std::llrint(std::cos(angle) * 20000), std::llrint(std::sin(angle) * 20000)));
+        }
+
+        const Polygon expected = simplifier.polygon(circle);
+        const Polygon reused = simplifier.polygon(circle, scratch);
+        ASSERT_EQ(reused.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(reused[i], expected[i]);
+        }
+
+        const Polygon expected_polyline = simplifier.polyline(circle);
+        const Polygon reused_polyline = simplifier.polyline(circle, scratch);
+        ASSERT_EQ(reused_polyline.size(), expected_polyline.size());
+        for (size_t i = 0; i < expected_polyline.size(); ++i)
+        {
+            EXPECT_EQ(reused_polyline[i], expected_polyline[i]);
+        }
+    }
+}
+
+/*!
+ * Tests that a variable-width line with the same width everywhere is
+ * simplified the same as a polygon with the same vertices, whether its
+ * junctions are packed or not.
+ */
+TEST_F(SimplifyTest, ConstantWidthLineLikePolygon)
+{
+    for (const bool is_closed : { true, false })
+    {
+        Polygon& shape = is_closed ? circle : spiral;
+        ExtrusionLine line(1, false, is_closed);
+        for (const Point2LL& point : shape)
+        {
+            line.emplace_back(point, 400, 1);
+        }
+        const PackedExtrusionLine packed(line);
+        ASSERT_EQ(packed.toExtrusionLine().junctions_, line.junctions_);
+
+        Simplify::Scratch scratch;
+        const Polygon expected = is_closed ? simplifier.polygon(shape) : simplifier.polyline(shape);
+        const ExtrusionLine simplified = is_closed ? simplifier.polygon(line, scratch) : simplifier.polyline(line, scratch);
+        const PackedExtrusionLine simplified_packed = is_closed ? simplifier.polygon(packed, scratch) : simplifier.polyline(packed, scratch);
+        ASSERT_EQ(simplified.size(), expected.size());
+        ASSERT_EQ(simplified_packed.size(), expected.size());
+        EXPECT_EQ(simplified.inset_idx_, 1);
+        EXPECT_EQ(simplified.is_closed_, is_closed);
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(simplified[i].p_, expected[i]);
+            EXPECT_EQ(simplified[i].w_, 400);
+            EXPECT_EQ(simplified_packed[i].junction(), simplified[i]);
+        }
+    }
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
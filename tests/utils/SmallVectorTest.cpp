@@ -0,0 +1,78 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/SmallVector.h" // The class under test.
+
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "utils/Point2LL.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(SmallVectorTest, InlineUntilFull)
+{
+    SmallVector<Point2LL, 2> points;
+    EXPECT_TRUE(points.empty());
+    points.emplace_back(1, 2);
+    points.push_back(Point2LL(3, 4));
+    EXPECT_TRUE(points.isInline());
+    EXPECT_EQ(points.capacity(), 2U);
+
+    points.emplace_back(5, 6);
+    EXPECT_FALSE(points.isInline());
+    ASSERT_EQ(points.size(), 3U);
+    EXPECT_EQ(points.front(), Point2LL(1, 2));
+    EXPECT_EQ(points[1], Point2LL(3, 4));
+    EXPECT_EQ(points.back(), Point2LL(5, 6));
+
+    points.pop_back();
+    EXPECT_EQ(points.back(), Point2LL(3, 4));
+    points.clear();
+    EXPECT_TRUE(points.empty());
+}
+
+TEST(SmallVectorTest, PushBackOwnElementWhileGrowing)
+{
+    SmallVector<int, 1> numbers{ 42 };
+    for (size_t i = 0; i < 10; i++)
+    {
+        numbers.push_back(numbers.front());
+    }
+    ASSERT_EQ(numbers.size(), 11U);
+    for (const int number : numbers)
+    {
+        EXPECT_EQ(number, 42);
+    }
+}
+
+TEST(SmallVectorTest, CopyAndMove)
+{
+    for (const size_t count : { 2, 20 }) // Inline and on the heap.
+    {
+        SmallVector<int, 4> original;
+        for (size_t i = 0; i < count; i++)
+        {
+            original.push_back(static_cast<int>(i));
+        }
+
+        SmallVector<int, 4> copy = original;
+        EXPECT_EQ(copy, original);
+
+        SmallVector<int, 4> moved = std::move(copy);
+        EXPECT_EQ(moved, original);
+        EXPECT_TRUE(copy.empty()); // NOLINT(bugprone-use-after-move)
+
+        SmallVector<int, 4> assigned{ 7, 8, 9, 10, 11 };
+        assigned = original;
+        EXPECT_EQ(assigned, original);
+        assigned = std::move(moved);
+        EXPECT_EQ(assigned, original);
+    }
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -4,12 +4,15 @@
 #include "utils/SparseGrid.h"
 
 #include <algorithm>
+#include <random>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "utils/Coord_t.h"
+#include "utils/FlatGridMap.h"
 #include "utils/SparsePointGridInclusive.h"
 
 namespace cura
@@ -300,4 +303,74 @@ TEST_F(GetNearestTest, Equal)
         << ")."; // FIXME: simplify once fmt or we use C++20 is added as a dependency
 }
 
+/*!
+ * Tests that the flat map of cells gives the same elements in each cell as the
+ * std::unordered_multimap that the grids used before, and that the grid gives
+ * the same elements near a point as looking at every element.
+ */
+TEST(FlatGridMapTest, SameAsUnorderedMultimap)
+{
+    std::mt19937 random(42);
+    std::uniform_int_distribution<coord_t> coordinate(-5000, 5000);
+    constexpr coord_t grid_size = 100;
+    std::vector<Point2LL> points;
+    for (size_t i = 0; i < 5000; i++)
+    {
+        points.emplace_back(coordinate(random), coordinate(random));
+    }
+    points.insert(points.end(), points.begin(), points.begin() + 500); // Also some duplicates.
+
+    FlatGridMap<size_t> flat;
+    std::unordered_multimap<Point2LL, size_t> multimap;
+    SparsePointGridInclusive<size_t> grid(grid_size);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const Point2LL cell(points[i].X / grid_size, points[i].Y / grid_size);
+        flat.emplace(cell, i);
+        multimap.emplace(cell, i);
+        grid.insert(points[i], i);
+    }
+    ASSERT_EQ(flat.size(), multimap.size());
+
+    for (coord_t x = -60; x <= 60; x++)
+    {
+        for (coord_t y = -60; y <= 60; y++)
+        {
+            const Point2LL cell(x, y);
+            std::vector<size_t> flat_cell;
+            const auto flat_range = flat.equal_range(cell);
+            for (auto it = flat_range.first; it != flat_range.second; ++it)
+            {
+                EXPECT_EQ(it->first, cell);
+                flat_cell.push_back(it->second);
+            }
+            std::vector<size_t> multimap_cell;
+            const auto multimap_range = multimap.equal_range(cell);
+            for (auto it = multimap_range.first; it != multimap_range.second; ++it)
+            {
+                multimap_cell.push_back(it->second);
+            }
+            std::sort(flat_cell.begin(), flat_cell.end());
+            std::sort(multimap_cell.begin(), multimap_cell.end());
+            EXPECT_EQ(flat_cell, multimap_cell) << "Cell " << cell << " should have the same elements.";
+        }
+    }
+
+    for (size_t query_idx = 0; query_idx < 200; query_idx++)
+    {
+        const Point2LL target(coordinate(random), coordinate(random));
+        const coord_t radius = 50 + query_idx;
+        std::vector<size_t> result = grid.getNearbyVals(target, radius);
+        std::sort(result.begin(), result.end());
+        EXPECT_EQ(std::adjacent_find(result.begin(), result.end()), result.end()) << "Every element should be found only once.";
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            if (vSize(points[i] - target) <= radius)
+            {
+                EXPECT_TRUE(std::binary_search(result.begin(), result.end(), i)) << "Point " << points[i] << " is near " << target << ", but getNearby didn't find it.";
+            }
+        }
+    }
+}
+
 } // namespace cura
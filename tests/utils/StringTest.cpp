@@ -86,5 +86,41 @@ INSTANTIATE_TEST_SUITE_P(WriteDoubleToStreamTestInstantiation,
                                          std::numeric_limits<double>::lowest(),
                                          -std::numeric_limits<double>::lowest()));
 
+TEST(GCodeLineBuilderTest, WritesLikeStream)
+{
+    std::ostringstream expected;
+    GCodeLineBuilder line;
+    for (int coord : { -10000, -1000, -999, -100, -10, -1, 0, 1, 10, 100, 1000, 10000, 123456789 })
+    {
+        expected << " X" << MMtoStream{ coord } << " E" << PrecisionedDouble{ 5, coord / 7.0 } << " F" << PrecisionedDouble{ 1, coord * 60.0 };
+        line << " X" << MMtoStream{ coord } << " E" << PrecisionedDouble{ 5, coord / 7.0 } << " F" << PrecisionedDouble{ 1, coord * 60.0 };
+    }
+    expected << '\n';
+    line << '\n';
+
+    std::ostringstream out;
+    out << line;
+    EXPECT_EQ(out.str(), expected.str());
+    std::string appended = ";";
+    line.appendTo(appended);
+    EXPECT_EQ(appended, ";" + expected.str());
+}
+
+TEST(GCodeLineBuilderTest, LongLine)
+{
+    const std::string comment(5000, 'x');
+    std::ostringstream expected;
+    GCodeLineBuilder line;
+    for (size_t i = 0; i < 100; i++)
+    {
+        expected << "G1 E" << PrecisionedDouble{ 5, std::numeric_limits<double>::max() } << ';' << comment;
+        line << "G1 E" << PrecisionedDouble{ 5, std::numeric_limits<double>::max() } << ';' << comment;
+    }
+
+    std::ostringstream out;
+    out << line;
+    EXPECT_EQ(out.str(), expected.str());
+}
+
 } // namespace cura
 // NOLINTEND(*-magic-numbers)
@@ -0,0 +1,98 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ThreadArena.h" // The classes under test.
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+TEST(ArenaTest, AllocationsAreAlignedAndDisjoint)
+{
+    Arena arena(1024);
+    std::vector<std::pair<uintptr_t, size_t>> allocations;
+    for (size_t size : { 1, 3, 8, 100, 2000, 16, 7 })
+    {
+        for (size_t alignment : { 1, 8, 16 })
+        {
+            void* pointer = arena.allocate(size, alignment);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0);
+            allocations.emplace_back(reinterpret_cast<uintptr_t>(pointer), size);
+        }
+    }
+    for (size_t a = 0; a < allocations.size(); a++)
+    {
+        for (size_t b = a + 1; b < allocations.size(); b++)
+        {
+            const bool disjoint = allocations[a].first + allocations[a].second <= allocations[b].first || allocations[b].first + allocations[b].second <= allocations[a].first;
+            EXPECT_TRUE(disjoint) << "Allocations " << a << " and " << b << " overlap.";
+        }
+    }
+}
+
+TEST(ArenaTest, ResetReusesBlocks)
+{
+    Arena arena(1024, 4096);
+    void* first = arena.allocate(100, 8);
+    for (size_t i = 0; i < 20; i++)
+    {
+        arena.allocate(500, 8);
+    }
+    EXPECT_GT(arena.capacity(), 4096);
+
+    arena.reset();
+    EXPECT_LE(arena.capacity(), 4096) << "Only the retained size is kept.";
+    EXPECT_GT(arena.capacity(), 0);
+    EXPECT_EQ(arena.allocate(100, 8), first) << "After a reset, allocation starts over in the first block.";
+}
+
+TEST(ThreadArenaTest, ResourceWithinScope)
+{
+    EXPECT_EQ(ThreadArena::resource(), std::pmr::get_default_resource()) << "Outside of a scope, nothing comes from the arena.";
+    {
+        ThreadArena::Scope scope;
+        std::pmr::memory_resource* resource = ThreadArena::resource();
+#ifdef ENABLE_THREAD_ARENA
+        EXPECT_NE(resource, std::pmr::get_default_resource());
+#endif
+        {
+            ThreadArena::Scope nested_scope;
+            EXPECT_EQ(ThreadArena::resource(), resource) << "Nested scopes share the arena of the thread.";
+        }
+
+        std::pmr::list<int> list(resource);
+        for (int i = 0; i < 1000; i++)
+        {
+            list.push_back(i);
+        }
+        EXPECT_EQ(list.size(), 1000);
+    }
+    EXPECT_EQ(ThreadArena::resource(), std::pmr::get_default_resource());
+}
+
+TEST(ThreadArenaTest, StagePolicy)
+{
+    const ThreadArena::Policy original_policy = ThreadArena::getPolicy(Progress::Stage::SLICING);
+    ThreadArena::setStage(Progress::Stage::SLICING);
+    ThreadArena::setPolicy(Progress::Stage::SLICING, ThreadArena::Policy::SYSTEM);
+    {
+        ThreadArena::Scope scope;
+        EXPECT_EQ(ThreadArena::resource(), std::pmr::get_default_resource()) << "The stage doesn't use the arenas.";
+
+        ThreadArena::setPolicy(Progress::Stage::SLICING, ThreadArena::Policy::TASK_ARENA);
+#ifdef ENABLE_THREAD_ARENA
+        EXPECT_NE(ThreadArena::resource(), std::pmr::get_default_resource());
+#endif
+    }
+    ThreadArena::setPolicy(Progress::Stage::SLICING, original_policy);
+    ThreadArena::setStage(Progress::Stage::START);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,351 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/ThreadPool.h" // The functions under test.
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Application.h"
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class ThreadPoolTest : public testing::TestWithParam<int>
+{
+public:
+    void SetUp() override
+    {
+        Application::getInstance().startThreadPool(GetParam());
+    }
+};
+
+TEST_P(ThreadPoolTest, ParallelForVisitsEveryIndexOnce)
+{
+    for (const size_t item_count : { size_t(1), size_t(7), size_t(1000), size_t(100003) })
+    {
+        std::vector<std::atomic<int>> visits(item_count);
+        cura::parallel_for<size_t>(
+            0,
+            item_count,
+            [&visits](const size_t index)
+            {
+                visits[index]++;
+            });
+        for (size_t index = 0; index < item_count; index++)
+        {
+            ASSERT_EQ(visits[index], 1) << "Index " << index << " of " << item_count;
+        }
+    }
+}
+
+TEST_P(ThreadPoolTest, ParallelForChunkSizeFactor)
+{
+    std::vector<std::atomic<int>> visits(1001);
+    cura::parallel_for<int>(
+        0,
+        1001,
+        [&visits](const int index)
+        {
+            visits[index]++;
+        },
+        64);
+    for (const std::atomic<int>& visit : visits)
+    {
+        ASSERT_EQ(visit, 1);
+    }
+}
+
+TEST_P(ThreadPoolTest, ParallelForGuidedVisitsEveryIndexOnce)
+{
+    for (const size_t item_count : { size_t(1), size_t(7), size_t(1000), size_t(100003) })
+    {
+        std::vector<std::atomic<int>> visits(item_count);
+        cura::parallel_for_guided<size_t>(
+            0,
+            item_count,
+            [&visits](const size_t index)
+            {
+                visits[index]++;
+            });
+        for (size_t index = 0; index < item_count; index++)
+        {
+            ASSERT_EQ(visits[index], 1) << "Index " << index << " of " << item_count;
+        }
+    }
+}
+
+TEST_P(ThreadPoolTest, ParallelForGuidedCostHint)
+{
+    // Very uneven costs, including items without any cost and a loop without any cost at all.
+    for (const int cost_scale : { 0, 1 })
+    {
+        std::vector<std::atomic<int>> visits(5000);
+        cura::parallel_for_guided<int>(
+            0,
+            5000,
+            [&visits](const int index)
+            {
+                visits[index]++;
+            },
+            [cost_scale](const int index)
+            {
+                return index < 10 ? cost_scale * 10000.0 : (index % 3 == 0 ? 0.0 : cost_scale * 1.0);
+            });
+        for (const std::atomic<int>& visit : visits)
+        {
+            ASSERT_EQ(visit, 1);
+        }
+    }
+}
+
+TEST_P(ThreadPoolTest, NestedParallelFor)
+{
+    std::atomic<size_t> sum = 0;
+    cura::parallel_for<size_t>(
+        0,
+        50,
+        [&sum](const size_t outer)
+        {
+            cura::parallel_for<size_t>(
+                0,
+                100,
+                [&sum, outer](const size_t inner)
+                {
+                    sum += outer * 100 + inner;
+                });
+        });
+    EXPECT_EQ(sum, size_t(5000 * 4999 / 2));
+}
+
+TEST_P(ThreadPoolTest, OrderedConsumer)
+{
+    std::vector<ptrdiff_t> consumed;
+    run_multiple_producers_ordered_consumer(
+        0,
+        500,
+        [](const ptrdiff_t index)
+        {
+            return std::optional<ptrdiff_t>(index);
+        },
+        [&consumed](std::optional<ptrdiff_t> item)
+        {
+            consumed.push_back(*item);
+        });
+    ASSERT_EQ(consumed.size(), 500);
+    for (size_t index = 0; index < consumed.size(); index++)
+    {
+        ASSERT_EQ(consumed[index], static_cast<ptrdiff_t>(index));
+    }
+}
+
+TEST_P(ThreadPoolTest, OrderedConsumerMemoryBudget)
+{
+    constexpr size_t item_bytes = 1000;
+    constexpr size_t max_pending_bytes = 3 * item_bytes;
+    std::vector<ptrdiff_t> consumed;
+    const OrderedConsumerStatistics statistics = run_multiple_producers_ordered_consumer(
+        0,
+        200,
+        [](const ptrdiff_t index)
+        {
+            return std::optional<ptrdiff_t>(index);
+        },
+        [&consumed](std::optional<ptrdiff_t> item)
+        {
+            consumed.push_back(*item);
+        },
+        [](const std::optional<ptrdiff_t>&)
+        {
+            return item_bytes;
+        },
+        max_pending_bytes);
+    ASSERT_EQ(consumed.size(), 200);
+    for (size_t index = 0; index < consumed.size(); index++)
+    {
+        ASSERT_EQ(consumed[index], static_cast<ptrdiff_t>(index));
+    }
+    const size_t worker_count = Application::getInstance().thread_pool_->thread_count() + 1;
+    EXPECT_GE(statistics.peak_pending_bytes, item_bytes);
+    EXPECT_LT(statistics.peak_pending_bytes, max_pending_bytes + worker_count * item_bytes) << "Only the items being produced may exceed the budget.";
+    EXPECT_EQ(statistics.peak_pending_bytes, statistics.peak_pending_count * item_bytes);
+}
+
+TEST_P(ThreadPoolTest, ParallelForRethrows)
+{
+    std::atomic<int> visits = 0;
+    EXPECT_THROW(
+        cura::parallel_for<int>(
+            0,
+            10000,
+            [&visits](const int index)
+            {
+                visits++;
+                if (index == 5000)
+                {
+                    throw std::runtime_error("Failed in the loop body.");
+                }
+            }),
+        std::runtime_error);
+    EXPECT_GT(visits, 0);
+}
+
+TEST_P(ThreadPoolTest, ParallelForCancelled)
+{
+    std::atomic<int> visits = 0;
+    Cancellation::beginSlice();
+    EXPECT_THROW(
+        cura::parallel_for<int>(
+            0,
+            100000,
+            [&visits](const int index)
+            {
+                visits++;
+                if (index == 0) // The first item of the calling thread.
+                {
+                    Cancellation::requestIfSlicing();
+                }
+                while (! Cancellation::isRequested()) // So that the other threads can't finish all their chunks first.
+                {
+                    std::this_thread::yield();
+                }
+            }),
+        SliceCancelled);
+    Cancellation::endSlice();
+    EXPECT_LT(visits, 100000) << "The participants should stop taking chunks once the slice is cancelled.";
+
+    Cancellation::requestIfSlicing(); // Not slicing, so this is ignored.
+    visits = 0;
+    cura::parallel_for<int>(
+        0,
+        1000,
+        [&visits](const int)
+        {
+            visits++;
+        });
+    EXPECT_EQ(visits, 1000);
+}
+
+TEST_P(ThreadPoolTest, OrderedConsumerCancelled)
+{
+    std::vector<ptrdiff_t> consumed;
+    Cancellation::beginSlice();
+    EXPECT_THROW(
+        run_multiple_producers_ordered_consumer(
+            0,
+            100000,
+            [](const ptrdiff_t index)
+            {
+                return std::make_optional(std::make_unique<ptrdiff_t>(index)); // Items that are never consumed must still be freed.
+            },
+            [&consumed](std::optional<std::unique_ptr<ptrdiff_t>> item)
+            {
+                consumed.push_back(**item);
+                if (consumed.size() == 10)
+                {
+                    Cancellation::requestIfSlicing();
+                }
+            }),
+        SliceCancelled);
+    Cancellation::endSlice();
+    ASSERT_GE(consumed.size(), 10);
+    EXPECT_LT(consumed.size(), 100000);
+    for (size_t index = 0; index < consumed.size(); index++)
+    {
+        ASSERT_EQ(consumed[index], static_cast<ptrdiff_t>(index));
+    }
+}
+
+TEST_P(ThreadPoolTest, OrderedConsumerRethrows)
+{
+    EXPECT_THROW(
+        run_multiple_producers_ordered_consumer(
+            0,
+            1000,
+            [](const ptrdiff_t index)
+            {
+                if (index == 500)
+                {
+                    throw std::runtime_error("Failed to produce.");
+                }
+                return std::optional<ptrdiff_t>(index);
+            },
+            [](std::optional<ptrdiff_t>)
+            {
+            }),
+        std::runtime_error);
+}
+
+TEST_P(ThreadPoolTest, Statistics)
+{
+    EXPECT_EQ(Application::getInstance().thread_pool_->statistics(), nullptr) << "Statistics are only collected when asked for.";
+    setenv("CURA_ENGINE_THREAD_STATS", "1", 1);
+    Application::getInstance().startThreadPool(GetParam());
+    unsetenv("CURA_ENGINE_THREAD_STATS");
+    ThreadPool* thread_pool = Application::getInstance().thread_pool_;
+    ASSERT_NE(thread_pool->statistics(), nullptr);
+
+    for (int loop = 0; loop < 3; loop++)
+    {
+        cura::parallel_for<int>(
+            0,
+            1000,
+            [](const int)
+            {
+            });
+    }
+    {
+        const ThreadPool::lock_t lock = thread_pool->get_lock();
+        EXPECT_EQ(thread_pool->statistics()->loopCallCount(), 3);
+        EXPECT_EQ(thread_pool->statistics()->taskCount() > 0, thread_pool->thread_count() > 0) << "Only the other participants are tasks.";
+    }
+    thread_pool->reportStatistics();
+    {
+        const ThreadPool::lock_t lock = thread_pool->get_lock();
+        EXPECT_EQ(thread_pool->statistics()->loopCallCount(), 0) << "Reporting starts over.";
+    }
+
+    Application::getInstance().startThreadPool(GetParam()); // Stop collecting for the other tests.
+    EXPECT_EQ(Application::getInstance().thread_pool_->statistics(), nullptr);
+}
+
+#ifdef __linux__
+TEST_P(ThreadPoolTest, PinnedThreads)
+{
+    setenv("CURA_ENGINE_PIN_THREADS", "1", 1);
+    Application::getInstance().startThreadPool(GetParam());
+    unsetenv("CURA_ENGINE_PIN_THREADS");
+    ThreadPool* thread_pool = Application::getInstance().thread_pool_;
+    EXPECT_TRUE(thread_pool->pinned());
+    EXPECT_LT(ThreadPool::current_node(), thread_pool->node_count());
+
+    std::vector<std::atomic<int>> visits(10000);
+    cura::parallel_for<size_t>(
+        0,
+        visits.size(),
+        [&visits](const size_t index)
+        {
+            visits[index]++;
+        });
+    for (const std::atomic<int>& visit_count : visits)
+    {
+        ASSERT_EQ(visit_count, 1);
+    }
+
+    Application::getInstance().startThreadPool(GetParam()); // Unpin the threads for the other tests.
+    EXPECT_FALSE(Application::getInstance().thread_pool_->pinned());
+}
+#endif
+
+INSTANTIATE_TEST_SUITE_P(ThreadCounts, ThreadPoolTest, testing::Values(1, 2, 8));
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/Trace.h" // The class under test.
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <rapidjson/document.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+class TraceTest : public testing::Test
+{
+public:
+    std::filesystem::path trace_file;
+
+    void SetUp() override
+    {
+        trace_file = std::filesystem::temp_directory_path() / "trace_test.json";
+    }
+
+    void TearDown() override
+    {
+        Trace::disable();
+        std::error_code error;
+        std::filesystem::remove(trace_file, error);
+    }
+
+    //! Write the trace and read it back.
+    rapidjson::Document writeAndRead() const
+    {
+        EXPECT_TRUE(Trace::write(trace_file));
+        std::ifstream file(trace_file);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        rapidjson::Document trace;
+        trace.Parse(contents.str().c_str());
+        EXPECT_FALSE(trace.HasParseError());
+        return trace;
+    }
+
+    //! The number of complete events with a name.
+    static size_t countEvents(const rapidjson::Document& trace, const std::string& name)
+    {
+        size_t count = 0;
+        for (const auto& event : trace["traceEvents"].GetArray())
+        {
+            count += std::string(event["ph"].GetString()) == "X" && name == event["name"].GetString();
+        }
+        return count;
+    }
+};
+
+TEST_F(TraceTest, OnlyRecordsWhileEnabled)
+{
+    {
+        CURA_TRACE_SCOPE("before");
+    }
+    Trace::enable();
+    {
+        CURA_TRACE_SCOPE("during");
+    }
+    Trace::disable();
+    {
+        CURA_TRACE_SCOPE("after");
+    }
+
+    const rapidjson::Document trace = writeAndRead();
+    EXPECT_EQ(countEvents(trace, "before"), 0);
+    EXPECT_EQ(countEvents(trace, "during"), 1);
+    EXPECT_EQ(countEvents(trace, "after"), 0);
+}
+
+TEST_F(TraceTest, RecordsEveryThread)
+{
+    Trace::enable();
+    std::thread first(
+        []()
+        {
+            CURA_TRACE_SCOPE("work");
+        });
+    std::thread second(
+        []()
+        {
+            CURA_TRACE_SCOPE("work");
+        });
+    first.join();
+    second.join();
+    Trace::disable();
+
+    const rapidjson::Document trace = writeAndRead();
+    EXPECT_EQ(countEvents(trace, "work"), 2);
+    size_t thread_names = 0;
+    for (const auto& event : trace["traceEvents"].GetArray())
+    {
+        thread_names += std::string(event["ph"].GetString()) == "M";
+    }
+    EXPECT_EQ(thread_names, 2);
+}
+
+TEST_F(TraceTest, KeepsTheNewestEvents)
+{
+    Trace::enable();
+    for (size_t event_idx = 0; event_idx < Trace::buffer_size + 10; event_idx++)
+    {
+        CURA_TRACE_SCOPE(event_idx < 10 ? "old" : "new");
+    }
+    Trace::disable();
+
+    const rapidjson::Document trace = writeAndRead();
+    EXPECT_EQ(countEvents(trace, "old"), 0);
+    EXPECT_EQ(countEvents(trace, "new"), Trace::buffer_size);
+}
+
+TEST_F(TraceTest, WritingForgetsTheEvents)
+{
+    Trace::enable();
+    {
+        CURA_TRACE_SCOPE("once");
+    }
+    Trace::disable();
+
+    EXPECT_EQ(countEvents(writeAndRead(), "once"), 1);
+    EXPECT_EQ(countEvents(writeAndRead(), "once"), 0);
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
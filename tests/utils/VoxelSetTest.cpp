@@ -0,0 +1,153 @@
+// Copyright (c) 2024 UltiMaker
+// CuraEngine is released under the terms of the AGPLv3 or higher.
+
+#include "utils/VoxelSet.h" // The class under test.
+
+#include <set>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// NOLINTBEGIN(*-magic-numbers)
+namespace cura
+{
+
+namespace
+{
+
+std::set<std::tuple<coord_t, coord_t, coord_t>> toSet(const VoxelSet& voxels)
+{
+    std::set<std::tuple<coord_t, coord_t, coord_t>> result;
+    voxels.forEach(
+        [&result](const Point3LL& voxel)
+        {
+            result.emplace(voxel.x_, voxel.y_, voxel.z_);
+        });
+    return result;
+}
+
+} // namespace
+
+TEST(VoxelSetTest, InsertAndErase)
+{
+    VoxelSet voxels;
+    EXPECT_TRUE(voxels.empty());
+
+    const std::vector<Point3LL> inserted{ Point3LL(0, 0, 0), Point3LL(7, 7, 7), Point3LL(8, 0, 0), Point3LL(-1, -1, -1), Point3LL(-9, 3, 100), Point3LL(7, 7, 7) };
+    for (const Point3LL& voxel : inserted)
+    {
+        voxels.insert(voxel);
+    }
+    EXPECT_EQ(voxels.size(), 5U);
+    for (const Point3LL& voxel : inserted)
+    {
+        EXPECT_TRUE(voxels.contains(voxel));
+    }
+    EXPECT_FALSE(voxels.contains(Point3LL(1, 0, 0)));
+    EXPECT_FALSE(voxels.contains(Point3LL(-8, 3, 100)));
+
+    const std::set<std::tuple<coord_t, coord_t, coord_t>> expected{ { 0, 0, 0 }, { 7, 7, 7 }, { 8, 0, 0 }, { -1, -1, -1 }, { -9, 3, 100 } };
+    EXPECT_EQ(toSet(voxels), expected);
+
+    for (const Point3LL& voxel : inserted)
+    {
+        voxels.erase(voxel);
+    }
+    voxels.erase(Point3LL(1000, 1000, 1000));
+    EXPECT_TRUE(voxels.empty());
+    EXPECT_EQ(voxels.size(), 0U);
+}
+
+TEST(VoxelSetTest, InsertSpan)
+{
+    const std::vector<VoxelSpan> spans{ { .x_min = -20, .x_max = 20, .y = 3, .z = 1 }, { .x_min = 5, .x_max = 5, .y = -4, .z = -9 }, { .x_min = 8, .x_max = 15, .y = 0, .z = 0 } };
+    VoxelSet by_span;
+    VoxelSet by_voxel;
+    for (const VoxelSpan& span : spans)
+    {
+        by_span.insertSpan(span);
+        for (coord_t x = span.x_min; x <= span.x_max; x++)
+        {
+            by_voxel.insert(Point3LL(x, span.y, span.z));
+        }
+    }
+    EXPECT_EQ(by_span.size(), 41U + 1U + 8U);
+    EXPECT_EQ(toSet(by_span), toSet(by_voxel));
+}
+
+TEST(VoxelSetTest, SetAlgebraMatchesUnorderedSet)
+{
+    VoxelSet a;
+    VoxelSet b;
+    std::unordered_set<Point3LL> reference_a;
+    std::unordered_set<Point3LL> reference_b;
+    for (coord_t x = -12; x < 12; x++)
+    {
+        for (coord_t y = -5; y < 10; y++)
+        {
+            for (coord_t z = 0; z < 20; z += 3)
+            {
+                const Point3LL voxel(x, y, z);
+                if ((x + y + z) % 3 == 0)
+                {
+                    a.insert(voxel);
+                    reference_a.insert(voxel);
+                }
+                if ((x * y + z) % 4 == 0)
+                {
+                    b.insert(voxel);
+                    reference_b.insert(voxel);
+                }
+            }
+        }
+    }
+
+    const auto to_reference = [](const std::unordered_set<Point3LL>& voxels)
+    {
+        std::set<std::tuple<coord_t, coord_t, coord_t>> result;
+        for (const Point3LL& voxel : voxels)
+        {
+            result.emplace(voxel.x_, voxel.y_, voxel.z_);
+        }
+        return result;
+    };
+
+    VoxelSet united = a;
+    united.unite(b);
+    std::unordered_set<Point3LL> reference_united = reference_a;
+    reference_united.insert(reference_b.begin(), reference_b.end());
+    EXPECT_EQ(toSet(united), to_reference(reference_united));
+    EXPECT_EQ(united.size(), reference_united.size());
+
+    VoxelSet intersected = a;
+    intersected.intersect(b);
+    std::unordered_set<Point3LL> reference_intersected;
+    for (const Point3LL& voxel : reference_a)
+    {
+        if (reference_b.contains(voxel))
+        {
+            reference_intersected.insert(voxel);
+        }
+    }
+    EXPECT_EQ(toSet(intersected), to_reference(reference_intersected));
+
+    VoxelSet subtracted = a;
+    subtracted.subtract(b);
+    std::unordered_set<Point3LL> reference_subtracted;
+    for (const Point3LL& voxel : reference_a)
+    {
+        if (! reference_b.contains(voxel))
+        {
+            reference_subtracted.insert(voxel);
+        }
+    }
+    EXPECT_EQ(toSet(subtracted), to_reference(reference_subtracted));
+
+    subtracted.subtract(a);
+    EXPECT_TRUE(subtracted.empty());
+}
+
+} // namespace cura
+// NOLINTEND(*-magic-numbers)
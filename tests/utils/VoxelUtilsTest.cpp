@@ -1,16 +1,19 @@
 //Copyright (c) 2022 Ultimaker B.V.
 //CuraEngine is released under the terms of the AGPLv3 or higher.
 
+#include <array>
+#include <set>
+#include <tuple>
 #include <unordered_set>
 
 #include <gtest/gtest.h>
-#include <../src/utils/VoxelUtils.h>
+#include "utils/VoxelUtils.h"
 
 // #define TEST_SVG_OUTPUT
 #ifdef TEST_SVG_OUTPUT
-#include "../src/utils/polygon.h"
+#include "utils/polygon.h"
 #include <cstdlib>
-#include "../src/utils/SVG.h"
+#include "utils/SVG.h"
 #endif //TEST_SVG_OUTPUT
 
 namespace cura
@@ -32,7 +35,7 @@ public:
 
     void SetUp()
     {
-        Point3 cell_size = Point3(30, 20, 1);
+        Point3LL cell_size = Point3LL(30, 20, 1);
 
         VoxelUtils vu(cell_size);
         for (int seed = 0; seed < n_tests; seed++)
@@ -64,11 +67,11 @@ public:
 
 TEST_F(VoxelUtilsTest, TestWalkLine)
 {
-    Point3 start(22, 16, 0);
-    Point3 end(0, 20, 0);
-    Point3 cell_size(30, 20, 1);
+    Point3LL start(22, 16, 0);
+    Point3LL end(0, 20, 0);
+    Point3LL cell_size(30, 20, 1);
     VoxelUtils vu(cell_size);
-    std::unordered_set<Point3> voxels;
+    std::unordered_set<Point3LL> voxels;
     vu.walkLine(start, end, [&voxels](GridPoint3 v) { voxels.emplace(v); return true; } );
     ASSERT_LE(voxels.size(), 4)
         << "A line ending in the cross-section between 4 voxels can cover 1 to 4 voxels at that end point";
@@ -78,16 +81,16 @@ TEST_F(VoxelUtilsTest, TestWalkBasic)
     
     for (size_t poly_idx = 0; poly_idx < test_polys.size(); poly_idx++)
     {
-        Point3 cell_size;
+        Point3LL cell_size;
         switch (poly_idx * 5 / test_polys.size())
         {
-            case 0: cell_size = Point3(30, 20, 1); break;
-            case 1: cell_size = Point3(40, 40, 1); break;
-            case 2: cell_size = Point3(25, 40, 1); break;
-            case 3: cell_size = Point3(400, 400, 1); break;
-            default: cell_size = Point3(poly_size, poly_size, 1); break;
+            case 0: cell_size = Point3LL(30, 20, 1); break;
+            case 1: cell_size = Point3LL(40, 40, 1); break;
+            case 2: cell_size = Point3LL(25, 40, 1); break;
+            case 3: cell_size = Point3LL(400, 400, 1); break;
+            default: cell_size = Point3LL(poly_size, poly_size, 1); break;
         }
-        coord_t max_dist_from_poly = vSize(Point(cell_size.x, cell_size.y)) + e;
+        coord_t max_dist_from_poly = vSize(Point2LL(cell_size.x_, cell_size.y_)) + e;
 
         VoxelUtils vu(cell_size);
         
@@ -185,22 +188,22 @@ TEST_F(VoxelUtilsTest, TestWalkDilated)
 {
     for (size_t poly_idx = 0; poly_idx < test_polys.size(); poly_idx++)
     {
-        Point3 cell_size;
+        Point3LL cell_size;
         switch (poly_idx * 5 / test_polys.size())
         {
-            case 0: cell_size = Point3(30, 20, 1); break;
-            case 1: cell_size = Point3(40, 40, 1); break;
-            case 2: cell_size = Point3(25, 40, 1); break;
-            case 3: cell_size = Point3(400, 400, 1); break;
-            default: cell_size = Point3(poly_size, poly_size, 1); break;
+            case 0: cell_size = Point3LL(30, 20, 1); break;
+            case 1: cell_size = Point3LL(40, 40, 1); break;
+            case 2: cell_size = Point3LL(25, 40, 1); break;
+            case 3: cell_size = Point3LL(400, 400, 1); break;
+            default: cell_size = Point3LL(poly_size, poly_size, 1); break;
         }
         coord_t kernel_s = 1 + (poly_idx % 5);
         GridPoint3 kernel_size(kernel_s, kernel_s, 1);
         DilationKernel kernel(kernel_size, DilationKernel::Type::CUBE);
 
-        Point3 applied_offset = cell_size * kernel_size / 2 - cell_size / 2;
-        coord_t max_dist_from_poly = vSize(Point(cell_size.x, cell_size.y) + Point(applied_offset.x, applied_offset.y)) + e;
-        coord_t min_dist_from_poly = std::min(applied_offset.x, applied_offset.y);
+        Point3LL applied_offset = cell_size * kernel_size / 2 - cell_size / 2;
+        coord_t max_dist_from_poly = vSize(Point2LL(cell_size.x_, cell_size.y_) + Point2LL(applied_offset.x_, applied_offset.y_)) + e;
+        coord_t min_dist_from_poly = std::min(applied_offset.x_, applied_offset.y_);
         // divide by 2, because the kernel is centered around the points in the poly
         // again divided by 2, because 
 
@@ -238,9 +241,9 @@ TEST_F(VoxelUtilsTest, TestWalkDilated)
             svg.writePolygons(polys);
             svg.nextLayer();
             // reference polygon on which the walk is performed
-            const Point3 translation = (Point3(1,1,1) - kernel.kernel_size % 2) * cell_size / 2;
+            const Point3LL translation = (Point3LL(1,1,1) - kernel.kernel_size_ % 2) * cell_size / 2;
             Polygons translated = polys;
-            translated.translate(Point(translation.x, translation.y));
+            translated.translate(Point2LL(translation.x_, translation.y_));
             svg.writePolygons(translated, SVG::Color::GREEN);
             svg.nextLayer();
             svg.writePolygons(voxel_area, SVG::Color::MAGENTA);
@@ -300,4 +303,89 @@ TEST_F(VoxelUtilsTest, TestWalkDilated)
     }
 }
 
+using VoxelTuple = std::tuple<coord_t, coord_t, coord_t>;
+
+std::set<VoxelTuple> toSet(const std::vector<VoxelSpan>& spans)
+{
+    std::set<VoxelTuple> voxels;
+    for (const VoxelSpan& span : spans)
+    {
+        for (coord_t x = span.x_min; x <= span.x_max; x++)
+        {
+            voxels.emplace(x, span.y, span.z);
+        }
+    }
+    return voxels;
+}
+
+void expectSortedWithoutOverlap(const std::vector<VoxelSpan>& spans)
+{
+    for (size_t span_idx = 1; span_idx < spans.size(); span_idx++)
+    {
+        const VoxelSpan& previous = spans[span_idx - 1];
+        const VoxelSpan& span = spans[span_idx];
+        EXPECT_LE(span.x_min, span.x_max);
+        EXPECT_LT(std::tie(previous.z, previous.y, previous.x_max), std::tie(span.z, span.y, span.x_min)) << "Spans should be sorted and should not overlap.";
+    }
+}
+
+TEST_F(VoxelUtilsTest, RasterizeMatchesWalk)
+{
+    for (size_t poly_idx = 0; poly_idx < test_polys.size(); poly_idx++)
+    {
+        const Point3LL cell_size = poly_idx % 2 == 0 ? Point3LL(30, 20, 1) : Point3LL(400, 400, 1);
+        const VoxelUtils vu(cell_size);
+        const Polygons& polys = test_polys[poly_idx];
+
+        std::set<VoxelTuple> walked;
+        const auto add_voxel = [&walked](GridPoint3 v)
+        {
+            walked.emplace(v.x_, v.y_, v.z_);
+            return true;
+        };
+
+        vu.walkPolygons(polys, z, add_voxel);
+        const std::vector<VoxelSpan> polygon_spans = vu.rasterizePolygons(polys, z);
+        expectSortedWithoutOverlap(polygon_spans);
+        EXPECT_EQ(toSet(polygon_spans), walked) << "rasterizePolygons should give the voxels that walkPolygons visits. Seed: " << poly_idx;
+
+        walked.clear();
+        vu.walkAreas(polys, z, add_voxel);
+        const std::vector<VoxelSpan> area_spans = vu.rasterizeAreas(polys, z);
+        expectSortedWithoutOverlap(area_spans);
+        EXPECT_EQ(toSet(area_spans), walked) << "rasterizeAreas should give the voxels that walkAreas visits. Seed: " << poly_idx;
+    }
+}
+
+TEST_F(VoxelUtilsTest, RasterizeDilatedMatchesWalk)
+{
+    for (size_t poly_idx = 0; poly_idx < test_polys.size(); poly_idx++)
+    {
+        const Point3LL cell_size(40, 40, 1);
+        const VoxelUtils vu(cell_size);
+        const Polygons& polys = test_polys[poly_idx];
+        const coord_t kernel_s = 1 + (poly_idx % 4);
+        const DilationKernel::Type type = std::array{ DilationKernel::Type::CUBE, DilationKernel::Type::DIAMOND, DilationKernel::Type::PRISM }[poly_idx % 3];
+        const DilationKernel kernel(GridPoint3(kernel_s, kernel_s, kernel_s), type);
+
+        std::set<VoxelTuple> walked;
+        const auto add_voxel = [&walked](GridPoint3 v)
+        {
+            walked.emplace(v.x_, v.y_, v.z_);
+            return true;
+        };
+
+        vu.walkDilatedPolygons(polys, z, kernel, add_voxel);
+        const std::vector<VoxelSpan> polygon_spans = vu.rasterizeDilatedPolygons(polys, z, kernel);
+        expectSortedWithoutOverlap(polygon_spans);
+        EXPECT_EQ(toSet(polygon_spans), walked) << "rasterizeDilatedPolygons should give the voxels that walkDilatedPolygons visits. Seed: " << poly_idx;
+
+        walked.clear();
+        vu.walkDilatedAreas(polys, z, kernel, add_voxel);
+        const std::vector<VoxelSpan> area_spans = vu.rasterizeDilatedAreas(polys, z, kernel);
+        expectSortedWithoutOverlap(area_spans);
+        EXPECT_EQ(toSet(area_spans), walked) << "rasterizeDilatedAreas should give the voxels that walkDilatedAreas visits. Seed: " << poly_idx;
+    }
+}
+
 } // namespace cura